@@ -0,0 +1,26 @@
+// Sprite animation clips (src/render/sprite_animation.h), uploaded once and read by every
+// ANIMATED variant; only animationTime changes from frame to frame. std140: the time has
+// a 16-byte slot of its own, then one 16-byte Clip each, in the C++ order.
+// Pulled in with #include "animation.glsl" (src/render/shader_preprocessor.h).
+struct Clip {
+    uint first;    // array layer of frame 0
+    uint frames;   // consecutive layers, at least 1
+    float fps;
+    uint loop;     // 0: stops on the last frame
+};
+
+layout (std140, binding = 1) uniform AnimationClips {
+    float animationTime;  // seconds, the clock SpriteRef.start is on
+    Clip clips[256];      // AnimationClipTable::kMaxClips
+};
+
+// The array layer to draw: `sprite` itself, or (bit 15 set: animatedSprite(clip)) the
+// frame its clip is on, started at animation.x and played at animation.y times its fps.
+uint animatedLayer(uint sprite, vec2 animation) {
+    if ((sprite & 0x8000u) == 0u) {
+        return sprite;
+    }
+    Clip clip = clips[min(sprite & 0x7fffu, 255u)];
+    uint frame = uint(max((animationTime - animation.x) * animation.y * clip.fps, 0.0));
+    return clip.first + (clip.loop != 0u ? frame % clip.frames : min(frame, clip.frames - 1u));
+}
@@ -0,0 +1,12 @@
+// Per-frame camera data, shared by every draw and every program.
+// Lives in a Uniform Buffer Object (UBO) that the C++ side uploads ONCE per frame
+// (see src/render/camera_ubo.h). std140 gives a fixed, portable memory layout so the
+// C++ struct can mirror it exactly: each mat4 is 64 bytes, members in this order.
+// Pulled in with #include "camera.glsl" (src/render/shader_preprocessor.h).
+layout (std140, binding = 0) uniform Camera {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection; // projection * view, precomputed on the CPU
+    mat4 relativeViewProjection; // viewProjection * translate(origin): for instances
+                                 // placed relative to the frame's origin (the camera)
+};
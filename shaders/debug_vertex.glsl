@@ -0,0 +1,19 @@
+#version 330 core
+
+// Debug shape vertex shader
+// -------------------------
+// Used by DebugDrawRenderer (src/render/debug_draw.h): lines and triangles already in
+// world space, one colour per vertex. Its fragment stage is fragment.glsl built with
+// VERTEX_COLOR.
+
+layout (location = 0) in vec2 aPos;    // world space
+layout (location = 1) in vec4 aColor;  // RGBA8, normalized to 0..1 by glVertexAttribPointer
+
+#include "camera.glsl"
+
+out vec4 vColor;
+
+void main(){
+    vColor = aColor;
+    gl_Position = viewProjection * vec4(aPos, 0.0, 1.0);
+}
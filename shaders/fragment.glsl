@@ -1,13 +1,324 @@
 #version 330 core
 
+// Variants (src/render/shader_preprocessor.h):
+//
+// | Define         | Output                                    | Paired with               |
+// | -------------- | ----------------------------------------- | ------------------------- |
+// | (none)         | constant orange                           | vertex.glsl               |
+// | INSTANCE_COLOR | vColor: the instance's packed colour      | vertex.glsl INSTANCE_     |
+// |                |                                           | COLOR                     |
+// | TEXTURED       | texture(uTexture, vUV) * vColor           | sprite_vertex.glsl        |
+// | + SDF          | vColor, alpha cut at the distance field's | sprite_vertex.glsl        |
+// |                | 0.5 outline (text, render/sdf_font.h)     | SCREEN_SPACE              |
+// | TEXTURE_ARRAY  | texture(uTextures, (vUV, layer)) * vColor | vertex.glsl TEXTURE_ARRAY |
+// | + DEPTH_LAYERS | same; opaque tints (alpha 1) discard below | vertex.glsl DEPTH_LAYERS  |
+// |                | kAlphaCutoff so corners don't write depth |                           |
+// | + OIT          | the same colour, weighted by its alpha    | vertex.glsl DEPTH_LAYERS  |
+// |                | and z-layer, into the two OIT targets     |                           |
+// | + PICK_ID      | the quad's uint id (no colour) into an    | vertex.glsl PICK_ID       |
+// |                | R32UI target; the same cutout, unless     |                           |
+// |                | its layer is 0xffff (solid quads)         |                           |
+// | + TILE_INDEX   | the tile layers under vUV (in tiles),     | vertex.glsl TILEMAP +     |
+// |                | looked up in uTileIndex, composited       | TEXTURE_ARRAY             |
+// | VIRTUAL_       | the page table's slot for vUV's page and  | vertex.glsl TILEMAP +     |
+// | TEXTURE        | level, sampled in the uPhysical cache     | VIRTUAL_TEXTURE           |
+// | + FEEDBACK     | the page id it would sample (R32UI)       | same                      |
+// | LIGHT          | the light's colour x intensity x falloff  | vertex.glsl LIGHT         |
+// |                | (added into the light target)             |                           |
+// | + COMPOSITE    | half the light target under the pixel,    | fullscreen_vertex.glsl    |
+// |                | blended as a 2x multiply                  |                           |
+// | + TILED        | the same, summed from the pixel's tile's  | fullscreen_vertex.glsl    |
+// |                | light list instead of a light target      |                           |
+// | OIT +          | the OIT targets' weighted average, alpha  | fullscreen_vertex.glsl    |
+// | COMPOSITE      | its coverage (render/oit_buffer.h)        |                           |
+// | POST + BRIGHT  | the scene's bright part, 4 bilinear taps  | fullscreen_vertex.glsl    |
+// |                | (post_process.h: 1/2 resolution)          |                           |
+// | POST + BLUR    | 9-tap Gaussian along uBlurStep, as 5      | fullscreen_vertex.glsl    |
+// |                | bilinear taps (1/4 resolution)            |                           |
+// | POST           | the scene with the fused per-pixel        | fullscreen_vertex.glsl    |
+// |                | effects: BLOOM, GRADE, VIGNETTE           |                           |
+// | NOISE          | (height, moisture): two fBm fields at the | fullscreen_vertex.glsl    |
+// |                | pixel's tile centre (render/gpu_noise.h)  |                           |
+// | VERTEX_COLOR   | vColor                                    | debug_vertex.glsl,        |
+// |                |                                           | fullscreen_vertex.glsl,   |
+// |                |                                           | vertex.glsl SKINNED       |
+
+#ifdef PICK_ID
+// The ID buffer (src/render/gpu_picker.h): an integer target takes an integer output.
+out uint PickId;
+flat in uint vPickId;
+#elif defined(VIRTUAL_TEXTURE) && defined(FEEDBACK)
+// Which page each pixel needs (src/render/virtual_texture.h), read back by the CPU.
+out uint PageRequest;
+#elif defined(OIT) && !defined(COMPOSITE)
+// Weighted blended OIT (src/render/oit_buffer.h): premultiplied colour x weight and the
+// alpha to multiply the revealage by, then alpha x weight into the second target.
+layout(location = 0) out vec4 OitAccum;
+layout(location = 1) out float OitWeight;
+#else
 out vec4 FragColor;
+#endif
 // declares main output of fragment shader
 // Every fragment (a pixel candidate generated from rasterizing the triangle) will call 
 // main(), and your shader must assign a final RGBA color to this output.
 
+#if defined(TEXTURE_ARRAY)
+// The third texture coordinate selects the layer. All sprites share the one array
+// texture, so a whole frame of different images is still a single draw with no texture
+// rebinds, and the layers' mipmaps never blend one image into the next.
+in vec2 vUV;
+flat in uint vLayer;
+in vec4 vColor;
+
+layout (binding = 0) uniform sampler2DArray uTextures;
+#ifdef DEPTH_LAYERS
+// Opaque quads are drawn unsorted with depth writes: a transparent corner must not
+// write depth, or it would hide whatever is drawn behind it later.
+const float kAlphaCutoff = 0.5;
+#endif
+#elif defined(TEXTURED)
+// Texture * vertex colour. Untextured sprites are bound to a 1x1 white texture by the
+// batcher, so "flat colour" and "textured" sprites use the same program and can batch.
+in vec2 vUV;
+in vec4 vColor;
+
+layout (binding = 0) uniform sampler2D uTexture;
+#elif defined(POST)
+// A post-processing pass (src/render/post_process.h): uSource on unit 0 (linear, clamped),
+// read at the pass's own pixel centres.
+layout (binding = 0) uniform sampler2D uSource;
+uniform vec2 uInvSize;         // 1 / this pass's target size
+#if defined(BRIGHT)
+uniform vec2 uSourceTexel;     // 1 / the scene's size
+uniform float uThreshold;
+#elif defined(BLUR)
+uniform vec2 uBlurStep;        // one target texel along the blur's axis
+#else
+#ifdef BLOOM
+layout (binding = 7) uniform sampler2D uBloom;
+uniform float uBloomIntensity;
+#endif
+#ifdef GRADE
+uniform vec3 uGrade;           // exposure, contrast, saturation
+uniform vec3 uGradeTint;
+#endif
+#ifdef VIGNETTE
+uniform float uVignette;       // the corners' darkening
+#endif
+#endif
+#elif defined(NOISE)
+// Procedural fields (src/render/gpu_noise.h): each pixel of a batch cell is a tile, and
+// gl_FragCoord + uNoiseOrigin is that tile's centre. Written to an RG32F target.
+#include "noise.glsl"
+uniform vec2 uNoiseOrigin;     // the cell's first tile minus its first pixel
+uniform vec4 uNoiseFields[2];  // per field: frequency, lacunarity, gain, octaves
+uniform vec2 uNoiseOffsets[2];
+#elif defined(OIT) && defined(COMPOSITE)
+// The OIT targets, the scene's size: the pixel's own texel of each.
+layout (binding = 0) uniform sampler2D uAccum;
+layout (binding = 1) uniform sampler2D uAccumWeight;
+#elif defined(LIGHT) && defined(COMPOSITE) && defined(TILED)
+// The tiled light lists (src/render/light_buffer.h): uTileGrid finds the pixel's tile's
+// [first, count] in uTileLights, whose entries index uLights (two texels per light, in
+// target pixels: (x, y, radius), (rgb, intensity)).
+layout (binding = 5) uniform samplerBuffer uLights;
+layout (binding = 6) uniform usamplerBuffer uTileLights;
+uniform ivec4 uTileGrid;     // view origin x, y (pixels); tiles per row; its table's texel
+uniform vec3 uAmbient;
+const int kTileSize = 16;    // LightBuffer::kTileSize
+const float kLightIntensity = 2.0;
+#elif defined(LIGHT) && defined(COMPOSITE)
+// The light target (src/render/light_buffer.h) covers the whole scene target at a lower
+// resolution: the pixel's position scaled to 0..1 finds its light, bilinearly filtered.
+layout (binding = 0) uniform sampler2D uLight;
+uniform vec2 uLightScale;    // 1 / the scene target's size
+#elif defined(LIGHT)
+in vec2 vLightPos;
+in vec4 vColor;
+const float kLightIntensity = 2.0;  // alpha 1: doubles what it lights at its centre
+#elif defined(VERTEX_COLOR) || defined(INSTANCE_COLOR)
+// Debug shapes (src/render/debug_draw.h) and the overdraw heatmap: just the colour the
+// vertices carry. Instanced quads with INSTANCE_COLOR: the colour their instance carries.
+in vec4 vColor;
+#endif
+
+#ifdef TILE_INDEX
+// The tile ids themselves: one R16UI texel per tile, one array layer per tile layer
+// (src/render/tilemap.h, Mode::IndexTexture), on unit 1.
+layout (binding = 1) uniform usampler2DArray uTileIndex;
+#endif
+
+#ifdef VIRTUAL_TEXTURE
+// vUV: 0..1 over the image. uPageTable: one RGBA8UI texel per page and a mip level per
+// image level, (slot x, slot y, the level it holds, resident). uPhysical (unit 0): the
+// cache of bordered pages.
+in vec2 vUV;
+layout (binding = 4) uniform usampler2D uPageTable;
+layout (binding = 0) uniform sampler2D uPhysical;
+uniform vec4 uVirtual;         // image texels x, y; top level; level bias (feedback)
+uniform vec4 uPhysicalLayout;  // page texels, border, slot texels, cache texels
+
+// The level a mipmapped image this size would sample here.
+float virtualLevel() {
+    vec2 dx = dFdx(vUV * uVirtual.xy);
+    vec2 dy = dFdy(vUV * uVirtual.xy);
+    float level = 0.5 * log2(max(max(dot(dx, dx), dot(dy, dy)), 1e-8)) + uVirtual.w;
+    return clamp(level, 0.0, uVirtual.z);
+}
+#endif
+
 void main(){
+#if defined(VIRTUAL_TEXTURE) && defined(FEEDBACK)
+    // Bit 31 marks a page: 0 is the clear colour, "nothing here".
+    vec2 uv = clamp(vUV, vec2(0.0), vec2(0.99999));
+    uint level = uint(virtualLevel());
+    uvec2 page = uvec2(uv * uVirtual.xy / uPhysicalLayout.x) >> level;
+    PageRequest = 0x80000000u | (level << 24) | (page.y << 12) | page.x;
+#elif defined(VIRTUAL_TEXTURE)
+    // The table already points a missing page at its nearest resident ancestor; entry.b
+    // is the level the slot really holds, so the position inside it uses that level's grid.
+    vec2 uv = clamp(vUV, vec2(0.0), vec2(0.99999));
+    int level = int(virtualLevel());
+    uvec4 entry = texelFetch(uPageTable, ivec2(uv * vec2(textureSize(uPageTable, level))), level);
+    if (entry.a == 0u) {
+        FragColor = vec4(0.0);
+        return;
+    }
+    vec2 inPage = fract(uv * vec2(textureSize(uPageTable, int(entry.b))));
+    vec2 texel = vec2(entry.rg) * uPhysicalLayout.z + uPhysicalLayout.y + inPage * uPhysicalLayout.x;
+    FragColor = textureLod(uPhysical, texel / uPhysicalLayout.w, 0.0);
+#elif defined(TEXTURE_ARRAY) && defined(TILE_INDEX)
+    // vUV runs over the map in tiles: the integer part picks the tile, the fraction is
+    // the position inside it. The gradients come from vUV itself, which is continuous;
+    // fract() jumps at every tile edge, and implicit derivatives there would pick the
+    // smallest mip and draw a seam.
+    ivec3 tiles = textureSize(uTileIndex, 0);
+    ivec2 cell = clamp(ivec2(floor(vUV)), ivec2(0), tiles.xy - 1);
+    vec2 local = fract(vUV);
+    vec2 dx = dFdx(vUV);
+    vec2 dy = dFdy(vUV);
+    uint images = uint(textureSize(uTextures, 0).z);
+    vec4 color = vec4(0.0);  // premultiplied while compositing, layer 0 at the bottom
+    for (int layer = 0; layer < tiles.z; ++layer) {
+        uint id = texelFetch(uTileIndex, ivec3(cell, layer), 0).r;
+        if (id != 0u) {
+            vec4 c = textureGrad(uTextures, vec3(local, float(id % images)), dx, dy);
+            color = vec4(c.rgb * c.a, c.a) + color * (1.0 - c.a);
+        }
+    }
+    // Straight alpha again, for the same blending as the chunk meshes.
+    FragColor = color.a > 0.0 ? vec4(color.rgb / color.a, color.a) : vec4(0.0);
+#elif defined(TEXTURE_ARRAY) && defined(PICK_ID)
+    // The same cutout the scene applies to opaque sprites; layer 0xffff: a solid quad.
+    if (vLayer != 0xffffu && texture(uTextures, vec3(vUV, float(vLayer))).a < kAlphaCutoff) {
+        discard;
+    }
+    PickId = vPickId;
+#elif defined(TEXTURE_ARRAY) && defined(OIT)
+    // The weight grows with the z-layer (depth back to it, as vertex.glsl made it), so a
+    // layer over another dominates the average as it would the sorted blend. Capped so
+    // dozens of overlaps stay inside half floats.
+    vec4 color = texture(uTextures, vec3(vUV, float(vLayer))) * vColor;
+    float zLayer = (1.0 - gl_FragCoord.z) * 65537.0 - 1.0;
+    float weight = color.a * clamp(pow(1.0 + 0.5 * zLayer, 2.0), 1.0, 64.0);
+    OitAccum = vec4(color.rgb * weight, color.a);
+    OitWeight = weight;
+#elif defined(TEXTURE_ARRAY) && defined(DEPTH_LAYERS)
+    FragColor = texture(uTextures, vec3(vUV, float(vLayer))) * vColor;
+    if (vColor.a >= 1.0 && FragColor.a < kAlphaCutoff) {
+        discard;
+    }
+#elif defined(TEXTURE_ARRAY)
+    FragColor = texture(uTextures, vec3(vUV, float(vLayer))) * vColor;
+#elif defined(TEXTURED) && defined(SDF)
+    // 0.5 is the outline. fwidth(): how much the distance changes over one pixel here,
+    // so the edge is a one-pixel ramp at every text size (no blur, no stair steps).
+    float distance = texture(uTexture, vUV).r;
+    float ramp = max(fwidth(distance), 1e-4);
+    FragColor = vec4(vColor.rgb, vColor.a * smoothstep(0.5 - ramp, 0.5 + ramp, distance));
+#elif defined(TEXTURED)
+    FragColor = texture(uTexture, vUV) * vColor;
+#elif defined(POST)
+    vec2 uv = gl_FragCoord.xy * uInvSize;
+#if defined(BRIGHT)
+    // Four bilinear taps a scene texel off centre: a smooth 4x4 average, so single bright
+    // pixels don't flicker in and out of the bloom as they move.
+    vec3 c = (texture(uSource, uv + vec2(-uSourceTexel.x, -uSourceTexel.y)).rgb +
+              texture(uSource, uv + vec2(uSourceTexel.x, -uSourceTexel.y)).rgb +
+              texture(uSource, uv + vec2(-uSourceTexel.x, uSourceTexel.y)).rgb +
+              texture(uSource, uv + vec2(uSourceTexel.x, uSourceTexel.y)).rgb) * 0.25;
+    float peak = max(c.r, max(c.g, c.b));
+    FragColor = vec4(c * (max(peak - uThreshold, 0.0) / max(peak, 1e-4)), 1.0);
+#elif defined(BLUR)
+    // Binomial 1 8 28 56 70 56 28 8 1 / 256: neighbouring pairs merged into one bilinear
+    // fetch each, at their weighted offset.
+    vec3 c = texture(uSource, uv).rgb * 0.2734375;
+    c += (texture(uSource, uv + uBlurStep * 1.3333333).rgb + texture(uSource, uv - uBlurStep * 1.3333333).rgb) *
+         0.328125;
+    c += (texture(uSource, uv + uBlurStep * 3.1111111).rgb + texture(uSource, uv - uBlurStep * 3.1111111).rgb) *
+         0.03515625;
+    FragColor = vec4(c, 1.0);
+#else
+    vec3 color = texture(uSource, uv).rgb;
+#ifdef BLOOM
+    color += texture(uBloom, uv).rgb * uBloomIntensity;
+#endif
+#ifdef GRADE
+    color *= uGrade.x * uGradeTint;
+    color = (color - 0.5) * uGrade.y + 0.5;
+    color = mix(vec3(dot(color, vec3(0.2126, 0.7152, 0.0722))), color, uGrade.z);
+#endif
+#ifdef VIGNETTE
+    // 1 at the centre, 1 - uVignette in the corners (|uv - 0.5|² = 0.5).
+    vec2 d = uv - 0.5;
+    color *= 1.0 - uVignette * 2.0 * dot(d, d);
+#endif
+    FragColor = vec4(clamp(color, 0.0, 1.0), 1.0);
+#endif
+#elif defined(NOISE)
+    vec2 p = gl_FragCoord.xy + uNoiseOrigin;
+    FragColor = vec4(fbm(uNoiseFields[0], uNoiseOffsets[0], p), fbm(uNoiseFields[1], uNoiseOffsets[1], p), 0.0, 1.0);
+#elif defined(OIT) && defined(COMPOSITE)
+    // Blended GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA: the scene shows through by the
+    // revealage, the product of every layer's (1 - alpha).
+    ivec2 texel = ivec2(gl_FragCoord.xy);
+    vec4 accum = texelFetch(uAccum, texel, 0);
+    if (accum.a >= 1.0) {
+        discard;                   // nothing translucent here
+    }
+    float weight = texelFetch(uAccumWeight, texel, 0).r;
+    FragColor = vec4(accum.rgb / max(weight, 1e-5), 1.0 - accum.a);
+#elif defined(LIGHT) && defined(COMPOSITE) && defined(TILED)
+    // The LIGHT falloff per light in the tile's list, on top of the ambient, then blended
+    // as below.
+    ivec2 tile = (ivec2(gl_FragCoord.xy) - uTileGrid.xy) / kTileSize;
+    int entry = uTileGrid.w + 2 * (tile.y * uTileGrid.z + tile.x);
+    int first = int(texelFetch(uTileLights, entry).r);
+    int count = int(texelFetch(uTileLights, entry + 1).r);
+    vec3 light = uAmbient;
+    for (int i = 0; i < count; ++i) {
+        int l = 2 * int(texelFetch(uTileLights, first + i).r);
+        vec4 disc = texelFetch(uLights, l);
+        vec4 color = texelFetch(uLights, l + 1);
+        vec2 d = (gl_FragCoord.xy - disc.xy) / disc.z;
+        float falloff = max(1.0 - dot(d, d), 0.0);
+        light += color.rgb * (color.a * kLightIntensity * falloff * falloff);
+    }
+    FragColor = vec4(min(light, vec3(2.0)) * 0.5, 1.0);
+#elif defined(LIGHT) && defined(COMPOSITE)
+    // Blended GL_DST_COLOR, GL_SRC_COLOR: scene * 2 * this, so 0.5 leaves it as it is.
+    vec3 light = texture(uLight, gl_FragCoord.xy * uLightScale).rgb;
+    FragColor = vec4(min(light, vec3(2.0)) * 0.5, 1.0);
+#elif defined(LIGHT)
+    // Smooth to 0 at the radius: (1 - d²)², no discard (the corners add nothing).
+    float falloff = max(1.0 - dot(vLightPos, vLightPos), 0.0);
+    FragColor = vec4(vColor.rgb * (vColor.a * kLightIntensity * falloff * falloff), 1.0);
+#elif defined(VERTEX_COLOR) || defined(INSTANCE_COLOR)
+    FragColor = vColor;
+#else
     FragColor = vec4(1.0, 0.5, 0.2, 1.0); // Orange
     // This simply outputs a constant color for every pixel in the triangle
     // There’s no lighting, no textures, no per-fragment computation yet—this is a 
     // minimal shader.
-}
\ No newline at end of file
+#endif
+}
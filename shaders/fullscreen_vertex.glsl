@@ -0,0 +1,20 @@
+#version 330 core
+
+// Full-screen vertex shader
+// -------------------------
+// One triangle that covers the whole viewport, with no vertex buffer: drawn with
+// glDrawArrays(GL_TRIANGLES, 0, 3) and an empty VAO, gl_VertexID 0, 1, 2 become
+// (-1, -1), (3, -1), (-1, 3). One flat colour; its fragment stage is fragment.glsl built
+// with VERTEX_COLOR. Used by the overdraw heatmap (src/render/overdraw.h), and with
+// fragment.glsl LIGHT + COMPOSITE by the light pass (src/render/light_buffer.h), and with
+// fragment.glsl POST by the post-processing passes (src/render/post_process.h), and with
+// fragment.glsl NOISE by the procedural fields (src/render/gpu_noise.h).
+
+uniform vec4 uColor;
+
+out vec4 vColor;
+
+void main(){
+    vColor = uColor;
+    gl_Position = vec4(float((gl_VertexID & 1) * 4 - 1), float((gl_VertexID >> 1) * 4 - 1), 0.0, 1.0);
+}
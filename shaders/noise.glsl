@@ -0,0 +1,43 @@
+// 2D simplex noise and its fBm (src/core/noise.h on the CPU). simplex() is glm::simplex
+// (glm/gtc/noise.hpp), which is this same code: lattice, hash, gradients and the order of
+// the operations, so the two agree up to the GPU's float rounding.
+// Pulled in with #include "noise.glsl" (src/render/shader_preprocessor.h).
+
+vec3 noiseMod289(vec3 x) { return x - floor(x * (1.0 / 289.0)) * 289.0; }
+vec2 noiseMod289(vec2 x) { return x - floor(x * (1.0 / 289.0)) * 289.0; }
+vec3 noisePermute(vec3 x) { return noiseMod289((x * 34.0 + 1.0) * x); }
+
+float simplex(vec2 v) {
+    const vec4 C = vec4(0.211324865405187, 0.366025403784439, -0.577350269189626, 0.024390243902439);
+    // First corner, then the other two.
+    vec2 i = floor(v + dot(v, C.yy));
+    vec2 x0 = v - i + dot(i, C.xx);
+    vec2 i1 = x0.x > x0.y ? vec2(1.0, 0.0) : vec2(0.0, 1.0);
+    vec4 x12 = x0.xyxy + C.xxzz;
+    x12.xy -= i1;
+    // Permutations, and the corners' falloff.
+    i = noiseMod289(i);
+    vec3 p = noisePermute(noisePermute(i.y + vec3(0.0, i1.y, 1.0)) + i.x + vec3(0.0, i1.x, 1.0));
+    vec3 m = max(0.5 - vec3(dot(x0, x0), dot(x12.xy, x12.xy), dot(x12.zw, x12.zw)), 0.0);
+    m = m * m;
+    m = m * m;
+    // Gradients from 41 points on a line mapped onto a diamond, normalised.
+    vec3 x = 2.0 * fract(p * C.www) - 1.0;
+    vec3 h = abs(x) - 0.5;
+    vec3 a0 = x - floor(x + 0.5);
+    m *= 1.79284291400159 - 0.85373472095314 * (a0 * a0 + h * h);
+    vec3 g = vec3(a0.x * x0.x + h.x * x0.y, a0.yz * x12.xz + h.yz * x12.yw);
+    return 130.0 * dot(m, g);
+}
+
+// noise::fbm(): `field` is (frequency, lacunarity, gain, octaves), `offset` the Fbm's.
+float fbm(vec4 field, vec2 offset, vec2 p) {
+    float sum = 0.0, weight = 0.0, amplitude = 1.0, frequency = field.x;
+    for (int o = 0; o < int(field.w); ++o) {
+        sum += amplitude * simplex((p + offset) * frequency);
+        weight += amplitude;
+        amplitude *= field.z;
+        frequency *= field.y;
+    }
+    return weight > 0.0 ? sum / weight : 0.0;
+}
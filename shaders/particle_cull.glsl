@@ -0,0 +1,67 @@
+#version 430 core
+
+// Particle culling pass (src/render/particle_system.h, GL 4.3 only). One invocation per
+// particle: the ones alive and inside the view rectangle are appended to the visible
+// list, and the draw's instance count is their number. The draw that follows reads both
+// straight from the GPU (glDrawElementsIndirect), so the CPU never learns how many there
+// were, let alone which:
+//
+//     state ──cull──▶ visible list + DrawElementsIndirectCommand ──indirect draw
+//
+// The list is in no particular order (whichever invocation gets its atomicAdd first).
+// The particles blend additively, so the order doesn't show.
+
+layout (local_size_x = 256) in;
+
+// One 24-byte Particle, as the C++ side lays it out (std430 packs it the same).
+struct Particle {
+    vec2 position;
+    vec2 velocity;
+    float age;
+    float lifetime;
+};
+
+// What vertex.glsl PARTICLES reads per instance: aParticlePos, aParticleAge.
+struct Visible {
+    vec2 position;
+    vec2 ageLifetime;
+};
+
+layout (std430, binding = 0) readonly buffer State {
+    Particle particles[];
+};
+
+layout (std430, binding = 1) writeonly buffer VisibleList {
+    Visible visible[];
+};
+
+// DrawElementsIndirectCommand; the CPU resets instanceCount to 0 before each dispatch.
+layout (std430, binding = 2) buffer Command {
+    uint count;
+    uint instanceCount;
+    uint firstIndex;
+    int baseVertex;
+    uint baseInstance;
+};
+
+uniform vec2 uViewMin;
+uniform vec2 uViewMax;
+uniform float uRadius;      // the largest a particle is drawn, half its width
+uniform int uCount;
+
+void main() {
+    uint i = gl_GlobalInvocationID.x;
+    if (i >= uint(uCount)) {
+        return;
+    }
+    Particle p = particles[i];
+    // Not yet emitted or expired: drawn with no area anyway.
+    if (p.age < 0.0 || p.age >= p.lifetime) {
+        return;
+    }
+    if (any(lessThan(p.position + uRadius, uViewMin)) || any(greaterThan(p.position - uRadius, uViewMax))) {
+        return;
+    }
+    uint slot = atomicAdd(instanceCount, 1u);
+    visible[slot] = Visible(p.position, vec2(p.age, p.lifetime));
+}
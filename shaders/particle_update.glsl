@@ -0,0 +1,64 @@
+#version 330 core
+
+// Particle update pass (src/render/particle_system.h). One vertex per particle, drawn as
+// GL_POINTS with GL_RASTERIZER_DISCARD on: nothing is rasterized, the outputs below are
+// captured by transform feedback straight into the OTHER state buffer, which the next
+// frame reads back in here (ping-pong). The CPU never sees a particle.
+//
+//     frame N:    state A ──update──▶ state B ──draw (instances)
+//     frame N+1:  state B ──update──▶ state A ──draw
+//
+// Paired with fragment.glsl only because a program needs one; it never runs.
+
+// One 24-byte Particle, as the C++ side lays it out.
+layout (location = 0) in vec2 aPosition;
+layout (location = 1) in vec2 aVelocity;
+layout (location = 2) in float aAge;       // seconds; negative: not emitted yet
+layout (location = 3) in float aLifetime;
+
+// Captured interleaved in this order (ParticleSystem::feedbackVaryings()): the same layout.
+out vec2 tfPosition;
+out vec2 tfVelocity;
+out float tfAge;
+out float tfLifetime;
+
+uniform float uDeltaTime;
+uniform float uTime;        // seeds the respawns, so every frame's differ
+uniform vec2 uEmitter;
+uniform vec2 uGravity;
+
+// Integer hash (lowbias32), advanced per call: [0, 1).
+float random(inout uint state) {
+    state ^= state >> 16;
+    state *= 0x7feb352du;
+    state ^= state >> 15;
+    state *= 0x846ca68bu;
+    state ^= state >> 16;
+    return float(state >> 8) * (1.0 / 16777216.0);
+}
+
+void main() {
+    vec2 position = aPosition;
+    vec2 velocity = aVelocity;
+    float lifetime = aLifetime;
+    float age = aAge + uDeltaTime;
+
+    if (age >= lifetime || (aAge < 0.0 && age >= 0.0)) {
+        // Dead (or due for its first emission): start over at the emitter.
+        uint seed = uint(gl_VertexID) * 747796405u + floatBitsToUint(uTime);
+        float angle = random(seed) * 6.2831853;
+        float speed = mix(0.2, 1.0, random(seed));
+        position = uEmitter;
+        velocity = vec2(cos(angle), sin(angle)) * speed;
+        lifetime = mix(0.8, 2.0, random(seed));
+        age = 0.0;
+    } else if (age >= 0.0) {
+        velocity += uGravity * uDeltaTime;
+        position += velocity * uDeltaTime;
+    }
+
+    tfPosition = position;
+    tfVelocity = velocity;
+    tfAge = age;
+    tfLifetime = lifetime;
+}
@@ -0,0 +1,30 @@
+#version 330 core
+
+// Sprite batch vertex shader
+// --------------------------
+// Used by SpriteBatch (src/render/sprite_batch.h). Unlike vertex.glsl there is no model
+// matrix at all: the CPU already transformed every corner into world space while
+// batching, so many differently-placed sprites can share ONE draw call. Its fragment
+// stage is fragment.glsl built with TEXTURED.
+//
+// SCREEN_SPACE (TextBatch, src/render/text_batch.h): the corners are already in clip
+// space, so the HUD stays put whatever the camera does.
+
+layout (location = 0) in vec2 aPos;    // world-space corner (same slot as the quad's aPos)
+layout (location = 1) in vec2 aUV;     // texture coordinate
+layout (location = 2) in vec4 aColor;  // RGBA8, normalized to 0..1 by glVertexAttribPointer
+
+#include "camera.glsl"
+
+out vec2 vUV;
+out vec4 vColor;
+
+void main(){
+    vUV = aUV;
+    vColor = aColor;
+#ifdef SCREEN_SPACE
+    gl_Position = vec4(aPos, 0.0, 1.0);
+#else
+    gl_Position = viewProjection * vec4(aPos, 0.0, 1.0);
+#endif
+}
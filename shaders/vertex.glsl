@@ -1,5 +1,37 @@
 #version 330 core // declares GLSL version being used: 3.30 -> 330
 
+// Every instanced-quad program is a variant of this file: the C++ side picks the
+// features (src/render/shader_preprocessor.h), which arrive here as #defines.
+//
+// | Define        | Per-instance input                     | Program              |
+// | ------------- | -------------------------------------- | -------------------- |
+// | INSTANCED     | mat4 aModel (locations 1..4)           | shaderProgram        |
+// | + AFFINE_2D   | vec3 aRow0, aRow1 (1, 2)               | affineProgram        |
+// | + INSTANCE_   | + vec4 aInstanceColor (5): RGBA8,      | shaderProgram,       |
+// |   COLOR       | normalized, after the transforms       | affineProgram        |
+// | + TEXTURE_    | + uint aLayer (3), vec4 aColor (4)     | —                    |
+// |   ARRAY       |                                        |                      |
+// | + DEPTH_      | same; aLayer's high 16 bits: z-layer   | layeredProgram       |
+// |   LAYERS      | → gl_Position.z (higher in front)      |                      |
+// | + PICK_ID     | same; aColor's bytes are an object id  | pickProgram          |
+// |               | (src/render/gpu_picker.h)              | (--gpu-pick)         |
+// | + ANIMATED    | + vec2 aAnimation (5): start, rate;    | animatedProgram      |
+// |               | aLayer may be a clip (animation.glsl)  | (--sprite-animation) |
+// | + INSTANCE_   | the same values, fetched by gl_Inst-   | layeredProgram       |
+// |   FETCH       | anceID from uInstances (no attributes) | (--instance-fetch)   |
+// | (none)        | — : uModel / uRow0 + uRow1 uniforms    | one quad per draw    |
+// | TILEMAP +     | — : per vertex: tile-grid aPos (short),| tilemapProgram       |
+// | TEXTURE_ARRAY | vec2 aUV (1, unorm16), uint aLayer (3) | (one draw per chunk) |
+// | + TILE_INDEX  | same; aPos is the UV, the rest unused  | tileIndexProgram     |
+// |               |                                        | (one quad per map)   |
+// | PARTICLES +   | vec2 aParticlePos (1), vec2 aParticle- | particleProgram      |
+// | TEXTURE_ARRAY | Age (2): the GPU-written state buffer  |                      |
+// | SKINNED       | — : per vertex: uvec2 aBones (1),      | skinnedProgram       |
+// |               | aWeight (2), aVertexColor (3); bones   | (--critters)         |
+// |               | from the uPalette texture buffer       |                      |
+// | LIGHT         | vec3 aLight (1): position, radius;     | lightProgram         |
+// |               | vec4 aLightColor (2)                   | (--lights)           |
+
 layout (location = 0) in vec2 aPos;
 // declares input attribute to vertex shader
 // location = 0 must match index in glVertexAttribPointer
@@ -29,8 +61,147 @@ layout (location = 0) in vec2 aPos;
 // glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)offset2);
 // glEnableVertexAttribArray(2);
 
+#if defined(TILEMAP)
+// Baked tile chunks (src/render/tilemap.h): aPos is a corner of the tile grid (whole
+// numbers, sent as shorts), placed in the world by the map's origin and tile size;
+// every vertex brings its own UV (unorm16).
+layout (location = 1) in vec2 aUV;
+uniform vec3 uTileGrid;  // origin.xy, tile size
+#elif defined(PARTICLES)
+// GPU particles (src/render/particle_system.h): the state buffer the update pass just
+// wrote IS the instance buffer, two attributes out of each 24-byte particle (divisor 1).
+layout (location = 1) in vec2 aParticlePos;
+layout (location = 2) in vec2 aParticleAge;  // (age, lifetime) in seconds
+const float kParticleScale = 0.12;           // the 0.5-wide quad → 0.06 world units
+const uint kParticleImage = 1u;              // a disc (sprite ids: src/main.cpp)
+#elif defined(SKINNED)
+// Rigged characters (src/render/skinned_mesh.h): the mesh is in its bind pose, every
+// vertex on up to two bones. Each instance is one character; its bones are in the
+// palette texture buffer, two RGBA32F texels (the Affine2D rows) per bone, bone-major.
+layout (location = 1) in uvec2 aBones;
+layout (location = 2) in float aWeight;       // aBones.x's share; aBones.y has the rest
+layout (location = 3) in vec4 aVertexColor;
+layout (binding = 2) uniform samplerBuffer uPalette;
+uniform int uPaletteBase;                     // this draw's first texel
+uniform int uCharacters;                      // instances per bone row
+out vec4 vColor;
+
+// Bind pose → world, by one bone of this instance.
+vec2 skin(uint bone, vec3 p) {
+    int texel = uPaletteBase + 2 * (int(bone) * uCharacters + gl_InstanceID);
+    return vec2(dot(texelFetch(uPalette, texel).xyz, p), dot(texelFetch(uPalette, texel + 1).xyz, p));
+}
+#elif defined(LIGHT)
+// 2D point lights (src/render/light_buffer.h), drawn additively into the light target:
+// the quad's corners (±1) at one radius around each light.
+layout (location = 1) in vec3 aLight;        // position.xy, radius
+layout (location = 2) in vec4 aLightColor;   // rgb, a: intensity
+out vec2 vLightPos;                          // -1..1 across the light's square
+out vec4 vColor;
+#elif defined(INSTANCED) && defined(INSTANCE_FETCH)
+// The instances are in a texture buffer instead of attributes (src/render/instanced_quads.h,
+// Storage::TextureBuffer): RGBA32UI texels, bit-cast back to what the C++ struct holds.
+// fetchInstance() fills the same names the attributes would have, so everything below
+// reads them unchanged. Mat4: four texels (columns); LayeredInstance: two.
+layout (binding = 3) uniform usamplerBuffer uInstances;
+uniform int uInstanceBase;                    // this draw's instance 0, in texels
+#if defined(AFFINE_2D) && defined(TEXTURE_ARRAY)
+vec3 aRow0;
+vec3 aRow1;
+uint aLayer;
+vec4 aColor;
+
+void fetchInstance() {
+    int texel = uInstanceBase + 2 * gl_InstanceID;
+    uvec4 a = texelFetch(uInstances, texel);      // row0.xyz, row1.x
+    uvec4 b = texelFetch(uInstances, texel + 1);  // row1.yz, layer, color
+    aRow0 = uintBitsToFloat(a.xyz);
+    aRow1 = uintBitsToFloat(uvec3(a.w, b.xy));
+    aLayer = b.z;
+    aColor = vec4((uvec4(b.w) >> uvec4(0u, 8u, 16u, 24u)) & 0xffu) / 255.0;  // RGBA8, as normalized
+}
+#elif !defined(AFFINE_2D)
+mat4 aModel;
+
+void fetchInstance() {
+    int texel = uInstanceBase + 4 * gl_InstanceID;
+    aModel = mat4(uintBitsToFloat(texelFetch(uInstances, texel)), uintBitsToFloat(texelFetch(uInstances, texel + 1)),
+                  uintBitsToFloat(texelFetch(uInstances, texel + 2)), uintBitsToFloat(texelFetch(uInstances, texel + 3)));
+}
+#endif
+#elif defined(AFFINE_2D) && defined(INSTANCED)
+// Flat 2D instances: the per-instance transform is a 3x2 affine matrix (6 floats,
+// 24 bytes) instead of a full mat4 (16 floats, 64 bytes). Produced on the CPU by
+// composeAffine2D()/toAffine2D() (src/core/batch_transform.h).
+// The two non-constant rows of the affine transform, one vec3 each (divisor 1):
+//     | aRow0.x  aRow0.y  aRow0.z |   | c*sx  -s*sy  x |
+//     | aRow1.x  aRow1.y  aRow1.z | = | s*sx   c*sy  y |
+//     |    0        0        1    |   |  0      0    1 |
+layout (location = 1) in vec3 aRow0;
+layout (location = 2) in vec3 aRow1;
+#elif defined(AFFINE_2D)
+uniform vec3 uRow0;
+uniform vec3 uRow1;
+#define aRow0 uRow0
+#define aRow1 uRow1
+#elif defined(INSTANCED)
+// Per-instance model matrix (instanced rendering).
+// A mat4 attribute occupies 4 consecutive locations (1, 2, 3, 4), one per column.
+// glVertexAttribDivisor(loc, 1) on the C++ side makes it advance once per instance
+// instead of once per vertex, so every copy of the quad gets its own transform.
+layout (location = 1) in mat4 aModel;
+#else
+uniform mat4 uModel;
+#define aModel uModel
+#endif
+
+#if defined(INSTANCE_COLOR) && !defined(TEXTURE_ARRAY)
+// A packed colour per instance (src/render/instanced_quads.h): quads of every colour
+// still go out in one draw, where a colour uniform would need one draw per colour.
+layout (location = 5) in vec4 aInstanceColor;
+out vec4 vColor;
+#endif
+
+#ifdef TEXTURE_ARRAY
+// Texture-array path: which layer of the TextureArray to sample and a tint, after the
+// Affine2D rows: one 32-byte LayeredInstance per quad (src/render/instanced_quads.h).
+#if !defined(PARTICLES) && !defined(INSTANCE_FETCH)
+layout (location = 3) in uint aLayer;  // glVertexAttribIPointer: stays an integer
+#endif
+#if !defined(TILEMAP) && !defined(PARTICLES) && !defined(INSTANCE_FETCH)
+layout (location = 4) in vec4 aColor;  // RGBA8, normalized to 0..1
+#endif
+
+#ifdef ANIMATED
+// An AnimatedInstance (src/render/instanced_quads.h): when its clip started and how fast
+// it plays. The frame is picked here, so the instance stays the same while it plays.
+layout (location = 5) in vec2 aAnimation;
+#include "animation.glsl"
+#endif
+
+out vec2 vUV;
+flat out uint vLayer;  // integers can't be interpolated: flat, same for the whole quad
+out vec4 vColor;
+#endif
+
+#if defined(VIRTUAL_TEXTURE)
+// A virtual texture's quad (src/render/virtual_texture.h): the fragments find their
+// page from vUV, over the whole image.
+out vec2 vUV;
+#endif
+
+#ifdef PICK_ID
+// The id rides in the colour's four bytes (little endian); a normalized unorm8 comes back
+// as exactly n / 255, so rounding recovers each byte. The scene's clip space is zoomed so
+// the few pixels around the cursor fill the (tiny) target: ndc' = (ndc - xy) * zw.
+uniform vec4 uPickRegion;
+flat out uint vPickId;
+#endif
+
 // uniform mat4 model; // using GLM for transformations
-uniform mat4 MVP;
+// uniform mat4 MVP;   // replaced: model now comes per instance
+
+#include "camera.glsl"
 
 // uniform float xOffset, yOffset;  // Allows for control of position of shape
 // uniform - set once per frame or per object, value is same for all vertices
@@ -46,6 +217,79 @@ void main(){
     // defines the position of the current vertex in clip space (NDC: Normalized Device 
     // Coordinates).
     // gl_Position = vec4(aPos.x + xOffset, aPos.y + yOffset, 0.0, 1.0);
+#ifdef INSTANCE_FETCH
+    fetchInstance();
+#endif
+#if defined(TILEMAP)
+    gl_Position = viewProjection * vec4(uTileGrid.xy + aPos * uTileGrid.z, 0.0, 1.0);
+#elif defined(PARTICLES)
+    // Shrinks as it ages. Not yet emitted (age < 0): all four corners on one point, so
+    // the quad has no area and produces no fragments.
+    float t = aParticleAge.x / aParticleAge.y;
+    float size = t >= 0.0 && t < 1.0 ? kParticleScale * (1.0 - 0.6 * t) : 0.0;
+    gl_Position = viewProjection * vec4(aParticlePos + aPos * size, 0.0, 1.0);
+#elif defined(SKINNED)
+    // Linear blend skinning: the point as each bone would place it, weighted.
+    vec3 bind = vec3(aPos, 1.0);
+    vec2 world = mix(skin(aBones.y, bind), skin(aBones.x, bind), aWeight);
+    gl_Position = viewProjection * vec4(world, 0.0, 1.0);
+    vColor = aVertexColor;
+#elif defined(LIGHT)
+    gl_Position = viewProjection * vec4(aLight.xy + aPos * aLight.z, 0.0, 1.0);
+    vLightPos = aPos;
+    vColor = aLightColor;
+#elif defined(AFFINE_2D)
+    // Homogeneous 2D point: the third component picks up the translation column. The
+    // transforms are relative to the frame's origin (src/core/world_position.h), so the
+    // result is small near the camera, and so is every float on the way to clip space.
+    vec3 local = vec3(aPos, 1.0);
+    vec2 relative = vec2(dot(aRow0, local), dot(aRow1, local));
+    gl_Position = relativeViewProjection * vec4(relative, 0.0, 1.0);
+#else
     vec4 pos = vec4(aPos, 0.0, 1.0);
-    gl_Position = MVP * pos;          // apply transform
-}
\ No newline at end of file
+    gl_Position = relativeViewProjection * aModel * pos; // apply transform (P * V * M), origin-relative M
+#endif
+
+#if defined(INSTANCE_COLOR) && !defined(TEXTURE_ARRAY)
+    vColor = aInstanceColor;
+#endif
+
+#if defined(TILEMAP) && defined(VIRTUAL_TEXTURE)
+    vUV = aUV;
+#elif defined(TEXTURE_ARRAY) && defined(TILEMAP) && defined(TILE_INDEX)
+    vUV = aPos;          // the map quad: tile coordinates are what the fragments look up
+    vLayer = 0u;
+    vColor = vec4(1.0);
+#elif defined(TEXTURE_ARRAY) && defined(TILEMAP)
+    vUV = aUV;
+    vLayer = aLayer;
+    vColor = vec4(1.0);  // tiles are drawn untinted
+#elif defined(TEXTURE_ARRAY) && defined(PARTICLES)
+    vUV = aPos * 2.0 + 0.5;
+    vLayer = kParticleImage;
+    // Yellow → red, fading out (blended additively: overlapping sparks glow).
+    vColor = vec4(1.0, mix(0.9, 0.2, t), mix(0.4, 0.05, t), 1.0 - t);
+#elif defined(TEXTURE_ARRAY)
+    // The quad spans [-0.25, 0.25]: map it to [0, 1] texture space.
+    vUV = aPos * 2.0 + 0.5;
+    vLayer = aLayer;
+    vColor = aColor;
+#ifdef DEPTH_LAYERS
+    // layeredLayer() (src/render/instanced_quads.h): array layer low, z-layer high.
+    // z-layer 0..65535 → depth just inside (1, 0), so the depth test (GL_LEQUAL, after a
+    // clear to 1) sorts the opaque quads whatever order they are drawn in.
+    vLayer = aLayer & 0xffffu;
+#ifdef ANIMATED
+    vLayer = animatedLayer(vLayer, aAnimation);
+#endif
+    float depth = 1.0 - float((aLayer >> 16) + 1u) / 65537.0;
+    gl_Position.z = (depth * 2.0 - 1.0) * gl_Position.w;
+#endif
+#endif
+
+#ifdef PICK_ID
+    uvec4 idBytes = uvec4(round(aColor * 255.0));
+    vPickId = idBytes.x | (idBytes.y << 8) | (idBytes.z << 16) | (idBytes.w << 24);
+    gl_Position.xy = (gl_Position.xy - uPickRegion.xy * gl_Position.w) * uPickRegion.zw;
+#endif
+}
@@ -0,0 +1,93 @@
+#include "asset/bitmap_font.h"
+
+#include <algorithm>
+
+#include "core/vfs.h"
+
+namespace {
+
+bool fail(std::string* error, const std::string& message) {
+    if (error) *error = message;
+    return false;
+}
+
+int hexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+} // namespace
+
+bool BitmapFont::parseHex(const char* text, std::size_t size, std::string* error) {
+    glyphs_.clear();
+    std::size_t line = 0;
+    for (std::size_t i = 0; i < size;) {
+        std::size_t end = i;
+        while (end < size && text[end] != '\n') {
+            ++end;
+        }
+        ++line;
+        std::size_t length = end - i;
+        if (length > 0 && text[i + length - 1] == '\r') {
+            --length;
+        }
+        const char* p = text + i;
+        i = end + 1;
+        if (length == 0 || hexDigit(p[0]) < 0) {
+            continue;                      // blank, or a comment
+        }
+        Glyph glyph;
+        std::size_t k = 0;
+        for (; k < length && hexDigit(p[k]) >= 0; ++k) {
+            glyph.codepoint = glyph.codepoint << 4 | static_cast<std::uint32_t>(hexDigit(p[k]));
+        }
+        const std::size_t digits = length - k - 1;
+        if (k > 6 || k == length || p[k] != ':' || (digits != 2 * kRows && digits != 4 * kRows)) {
+            return fail(error, "line " + std::to_string(line) + ": not a glyph");
+        }
+        const std::size_t perRow = digits / kRows;
+        glyph.width = static_cast<std::uint8_t>(perRow * 4);
+        const char* bits = p + k + 1;
+        for (int row = 0; row < kRows; ++row) {
+            std::uint32_t value = 0;
+            for (std::size_t d = 0; d < perRow; ++d) {
+                const int digit = hexDigit(bits[row * perRow + d]);
+                if (digit < 0) {
+                    return fail(error, "line " + std::to_string(line) + ": not a hex digit");
+                }
+                value = value << 4 | static_cast<std::uint32_t>(digit);
+            }
+            glyph.rows[row] = static_cast<std::uint16_t>(perRow == 2 ? value << 8 : value);
+        }
+        glyphs_.push_back(glyph);
+    }
+    // Files are sorted already; a later line of the same code point wins.
+    std::stable_sort(glyphs_.begin(), glyphs_.end(),
+                     [](const Glyph& a, const Glyph& b) { return a.codepoint < b.codepoint; });
+    std::reverse(glyphs_.begin(), glyphs_.end());   // unique() keeps the first of a run
+    glyphs_.erase(std::unique(glyphs_.begin(), glyphs_.end(),
+                              [](const Glyph& a, const Glyph& b) { return a.codepoint == b.codepoint; }),
+                  glyphs_.end());
+    std::reverse(glyphs_.begin(), glyphs_.end());
+    if (glyphs_.empty()) {
+        return fail(error, "no glyphs");
+    }
+    return true;
+}
+
+bool BitmapFont::loadHex(const std::string& path, std::string* error) {
+    std::string text;
+    if (!vfs::readFile(path, text)) {
+        glyphs_.clear();
+        return fail(error, "cannot open file");
+    }
+    return parseHex(text.data(), text.size(), error);
+}
+
+const BitmapFont::Glyph* BitmapFont::find(std::uint32_t codepoint) const {
+    const auto it = std::lower_bound(glyphs_.begin(), glyphs_.end(), codepoint,
+                                     [](const Glyph& g, std::uint32_t c) { return g.codepoint < c; });
+    return it != glyphs_.end() && it->codepoint == codepoint ? &*it : nullptr;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// BitmapFont
+// ----------
+// A pixel font in GNU Unifont's .hex format: one line per character,
+//
+//     0041:0000000018242442427E424242420000      (8 x 16: 32 hex digits)
+//     4E2D:0100010001003FF8210821082108...      (16 x 16: 64 hex digits)
+//
+// the code point, then the glyph's rows top to bottom, each 2 (8 wide) or 4 (16 wide)
+// hex digits, most significant bit leftmost. Unifont covers the whole Basic
+// Multilingual Plane this way, which is what text beyond SdfFont's ASCII needs; the
+// glyphs are only bits here, turned into distance fields on demand by GlyphCache
+// (render/glyph_cache.h).
+//
+// | Rows (of kRows) | What                                                            |
+// | --------------- | --------------------------------------------------------------- |
+// | 0 .. 3          | above capitals (accents)                                        |
+// | 4 .. 13         | capitals: kCapRows, the top one kCapTop                         |
+// | 14, 15          | descenders: the baseline is between rows 13 and 14              |
+//
+// Plain CPU code with no GL or global state. Lines that are not glyphs (comments, blank
+// lines) are skipped; a malformed glyph line fails the whole parse.
+class BitmapFont {
+public:
+    static constexpr int kRows = 16;
+    static constexpr int kCapTop = 4;
+    static constexpr int kCapRows = 10;
+
+    struct Glyph {
+        std::uint32_t codepoint = 0;
+        std::uint8_t width = 0;            // 8 or 16 pixels
+        std::uint16_t rows[kRows] = {};    // top to bottom; bit 15 - x is pixel x
+        bool pixel(int x, int y) const { return (rows[y] >> (15 - x) & 1u) != 0; }
+    };
+
+    bool parseHex(const char* text, std::size_t size, std::string* error = nullptr);
+    // Reads the whole file (through the vfs), then parseHex. Blocking.
+    bool loadHex(const std::string& path, std::string* error = nullptr);
+
+    // The character's glyph, or null when the font lacks it.
+    const Glyph* find(std::uint32_t codepoint) const;
+    std::size_t size() const { return glyphs_.size(); }
+
+private:
+    std::vector<Glyph> glyphs_;            // by code point
+};
@@ -0,0 +1,267 @@
+#include "asset/block_decode.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+std::uint32_t rgba(int r, int g, int b, int a) {
+    return static_cast<std::uint32_t>(r) | (static_cast<std::uint32_t>(g) << 8) |
+           (static_cast<std::uint32_t>(b) << 16) | (static_cast<std::uint32_t>(a) << 24);
+}
+
+int clamp255(int v) { return std::min(255, std::max(0, v)); }
+
+// Bit-replicating widening: the top bits fill the new low bits, so 0 → 0 and max → 255.
+int expand4(int v) { return v * 17; }
+int expand5(int v) { return (v << 3) | (v >> 2); }
+int expand6(int v) { return (v << 2) | (v >> 4); }
+int expand7(int v) { return (v << 1) | (v >> 6); }
+
+// BC1 / BC3 colour half. fourColour forces the c0 > c1 mode (BC3 ignores the ordering).
+void decodeBcColour(const unsigned char* block, bool fourColour, bool alpha, std::uint32_t* out) {
+    const int c0 = block[0] | (block[1] << 8);
+    const int c1 = block[2] | (block[3] << 8);
+    int r[4], g[4], b[4];
+    int a[4] = {255, 255, 255, 255};
+    r[0] = expand5(c0 >> 11), g[0] = expand6((c0 >> 5) & 63), b[0] = expand5(c0 & 31);
+    r[1] = expand5(c1 >> 11), g[1] = expand6((c1 >> 5) & 63), b[1] = expand5(c1 & 31);
+    if (fourColour || c0 > c1) {
+        r[2] = (2 * r[0] + r[1]) / 3, g[2] = (2 * g[0] + g[1]) / 3, b[2] = (2 * b[0] + b[1]) / 3;
+        r[3] = (r[0] + 2 * r[1]) / 3, g[3] = (g[0] + 2 * g[1]) / 3, b[3] = (b[0] + 2 * b[1]) / 3;
+    } else {
+        r[2] = (r[0] + r[1]) / 2, g[2] = (g[0] + g[1]) / 2, b[2] = (b[0] + b[1]) / 2;
+        r[3] = g[3] = b[3] = 0;
+        a[3] = alpha ? 0 : 255;
+    }
+    std::uint32_t indices;
+    std::memcpy(&indices, block + 4, 4);
+    for (int i = 0; i < 16; ++i) {
+        const int k = (indices >> (2 * i)) & 3;
+        out[i] = rgba(r[k], g[k], b[k], a[k]);
+    }
+}
+
+// ETC1 luminance modifiers {a, b}; a pixel index picks +a, +b, -a or -b.
+constexpr int kEtcModifiers[8][2] = {{2, 8}, {5, 17}, {9, 29}, {13, 42}, {18, 60}, {24, 80}, {33, 106}, {47, 183}};
+// T / H mode paint-colour distances.
+constexpr int kEtcDistances[8] = {3, 6, 11, 16, 23, 32, 41, 64};
+
+constexpr int kEacModifiers[16][8] = {
+    {-3, -6, -9, -15, 2, 5, 8, 14}, {-3, -7, -10, -13, 2, 6, 9, 12}, {-2, -5, -8, -13, 1, 4, 7, 12},
+    {-2, -4, -6, -13, 1, 3, 5, 12}, {-3, -6, -8, -12, 2, 5, 7, 11}, {-3, -7, -9, -11, 2, 6, 8, 10},
+    {-4, -7, -8, -11, 3, 6, 7, 10}, {-3, -5, -8, -11, 2, 4, 7, 10}, {-2, -6, -8, -10, 1, 5, 7, 9},
+    {-2, -5, -8, -10, 1, 4, 7, 9},  {-2, -4, -8, -10, 1, 3, 7, 9},  {-2, -5, -7, -10, 1, 4, 6, 9},
+    {-3, -4, -7, -10, 2, 3, 6, 9},  {-1, -2, -3, -10, 0, 1, 2, 9},  {-4, -6, -8, -9, 3, 5, 7, 8},
+    {-3, -5, -7, -9, 2, 4, 6, 8},
+};
+
+std::uint64_t readBigEndian64(const unsigned char* p) {
+    std::uint64_t v = 0;
+    for (int i = 0; i < 8; ++i) v = (v << 8) | p[i];
+    return v;
+}
+
+int bits(std::uint64_t v, int high, int low) {
+    return static_cast<int>((v >> low) & ((std::uint64_t{1} << (high - low + 1)) - 1));
+}
+
+// ETC pixel indices are column-major (i = x * 4 + y), msb plane above the lsb plane.
+int etcIndex(std::uint64_t block, int x, int y) {
+    const int i = x * 4 + y;
+    return (bits(block, 16 + i, 16 + i) << 1) | bits(block, i, i);
+}
+
+void etcPaint(std::uint64_t block, const int (&r)[4], const int (&g)[4], const int (&b)[4], std::uint32_t* out) {
+    for (int y = 0; y < 4; ++y) {
+        for (int x = 0; x < 4; ++x) {
+            const int k = etcIndex(block, x, y);
+            out[y * 4 + x] = rgba(r[k], g[k], b[k], 255);
+        }
+    }
+}
+
+} // namespace
+
+void decodeBc1Block(const unsigned char* block, bool alpha, std::uint32_t* out) {
+    decodeBcColour(block, false, alpha, out);
+}
+
+void decodeBc3Block(const unsigned char* block, std::uint32_t* out) {
+    decodeBcColour(block + 8, true, false, out);
+    int a[8];
+    a[0] = block[0];
+    a[1] = block[1];
+    if (a[0] > a[1]) {
+        for (int k = 2; k < 8; ++k) a[k] = ((8 - k) * a[0] + (k - 1) * a[1]) / 7;
+    } else {
+        for (int k = 2; k < 6; ++k) a[k] = ((6 - k) * a[0] + (k - 1) * a[1]) / 5;
+        a[6] = 0;
+        a[7] = 255;
+    }
+    std::uint64_t indices = 0;
+    for (int i = 7; i >= 2; --i) indices = (indices << 8) | block[i];
+    for (int i = 0; i < 16; ++i) {
+        const int k = static_cast<int>((indices >> (3 * i)) & 7);
+        out[i] = (out[i] & 0x00FFFFFFu) | (static_cast<std::uint32_t>(a[k]) << 24);
+    }
+}
+
+void decodeEtc2Block(const unsigned char* data, std::uint32_t* out) {
+    const std::uint64_t block = readBigEndian64(data);
+    const bool differential = bits(block, 33, 33) != 0;
+    const bool flip = bits(block, 32, 32) != 0;
+
+    int base[2][3];
+    if (!differential) {
+        for (int c = 0; c < 3; ++c) {
+            base[0][c] = expand4(bits(block, 63 - c * 8, 60 - c * 8));
+            base[1][c] = expand4(bits(block, 59 - c * 8, 56 - c * 8));
+        }
+    } else {
+        int value[3], second[3];
+        for (int c = 0; c < 3; ++c) {
+            value[c] = bits(block, 63 - c * 8, 59 - c * 8);
+            const int delta = bits(block, 58 - c * 8, 56 - c * 8);
+            second[c] = value[c] + (delta >= 4 ? delta - 8 : delta);
+        }
+        // An out-of-range second colour is how ETC2 signals its extra modes.
+        if (second[0] < 0 || second[0] > 31) {
+            // T mode: one colour, plus a second one moved ± a distance.
+            const int c1[3] = {expand4((bits(block, 60, 59) << 2) | bits(block, 57, 56)),
+                               expand4(bits(block, 55, 52)), expand4(bits(block, 51, 48))};
+            const int c2[3] = {expand4(bits(block, 47, 44)), expand4(bits(block, 43, 40)),
+                               expand4(bits(block, 39, 36))};
+            const int d = kEtcDistances[(bits(block, 35, 34) << 1) | bits(block, 32, 32)];
+            int r[4], g[4], b[4];
+            for (int k = 0; k < 4; ++k) {
+                const int offset = k == 1 ? d : k == 3 ? -d : 0;
+                const int* c = k == 0 ? c1 : c2;
+                r[k] = clamp255(c[0] + offset), g[k] = clamp255(c[1] + offset), b[k] = clamp255(c[2] + offset);
+            }
+            etcPaint(block, r, g, b, out);
+            return;
+        }
+        if (second[1] < 0 || second[1] > 31) {
+            // H mode: two colours, each moved ± a distance; their order holds a distance bit.
+            const int r1 = bits(block, 62, 59), g1 = (bits(block, 58, 56) << 1) | bits(block, 52, 52);
+            const int b1 = (bits(block, 51, 51) << 3) | bits(block, 49, 47);
+            const int r2 = bits(block, 46, 43), g2 = bits(block, 42, 39), b2 = bits(block, 38, 35);
+            const int order = ((r1 << 8) | (g1 << 4) | b1) >= ((r2 << 8) | (g2 << 4) | b2) ? 1 : 0;
+            const int d = kEtcDistances[(bits(block, 34, 34) << 2) | (bits(block, 32, 32) << 1) | order];
+            const int c[2][3] = {{expand4(r1), expand4(g1), expand4(b1)}, {expand4(r2), expand4(g2), expand4(b2)}};
+            int r[4], g[4], b[4];
+            for (int k = 0; k < 4; ++k) {
+                const int* colour = c[k >> 1];
+                const int offset = (k & 1) ? -d : d;
+                r[k] = clamp255(colour[0] + offset), g[k] = clamp255(colour[1] + offset),
+                b[k] = clamp255(colour[2] + offset);
+            }
+            etcPaint(block, r, g, b, out);
+            return;
+        }
+        if (second[2] < 0 || second[2] > 31) {
+            // Planar: a colour gradient from three corner colours, no indices.
+            const int origin[3] = {expand6(bits(block, 62, 57)),
+                                   expand7((bits(block, 56, 56) << 6) | bits(block, 54, 49)),
+                                   expand6((bits(block, 48, 48) << 5) | (bits(block, 44, 43) << 3) |
+                                           bits(block, 41, 39))};
+            const int horizontal[3] = {expand6((bits(block, 38, 34) << 1) | bits(block, 32, 32)),
+                                       expand7(bits(block, 31, 25)), expand6(bits(block, 24, 19))};
+            const int vertical[3] = {expand6(bits(block, 18, 13)), expand7(bits(block, 12, 6)),
+                                     expand6(bits(block, 5, 0))};
+            for (int y = 0; y < 4; ++y) {
+                for (int x = 0; x < 4; ++x) {
+                    int c[3];
+                    for (int i = 0; i < 3; ++i) {
+                        c[i] = clamp255((x * (horizontal[i] - origin[i]) + y * (vertical[i] - origin[i]) +
+                                         4 * origin[i] + 2) >> 2);
+                    }
+                    out[y * 4 + x] = rgba(c[0], c[1], c[2], 255);
+                }
+            }
+            return;
+        }
+        for (int c = 0; c < 3; ++c) {
+            base[0][c] = expand5(value[c]);
+            base[1][c] = expand5(second[c]);
+        }
+    }
+
+    // Individual / differential: two 2x4 (or 4x2 when flipped) halves, each a base
+    // colour shifted by a luminance modifier from its table.
+    const int table[2] = {bits(block, 39, 37), bits(block, 36, 34)};
+    for (int y = 0; y < 4; ++y) {
+        for (int x = 0; x < 4; ++x) {
+            const int half = flip ? (y >= 2) : (x >= 2);
+            const int k = etcIndex(block, x, y);
+            const int magnitude = kEtcModifiers[table[half]][k & 1];
+            const int modifier = (k & 2) ? -magnitude : magnitude;
+            out[y * 4 + x] = rgba(clamp255(base[half][0] + modifier), clamp255(base[half][1] + modifier),
+                                  clamp255(base[half][2] + modifier), 255);
+        }
+    }
+}
+
+void decodeEtc2EacBlock(const unsigned char* data, std::uint32_t* out) {
+    decodeEtc2Block(data + 8, out);
+    const std::uint64_t alpha = readBigEndian64(data);
+    const int base = bits(alpha, 63, 56);
+    const int multiplier = bits(alpha, 55, 52);
+    const int* modifiers = kEacModifiers[bits(alpha, 51, 48)];
+    for (int y = 0; y < 4; ++y) {
+        for (int x = 0; x < 4; ++x) {
+            const int i = x * 4 + y; // column-major like the colour indices, first pixel in the MSBs
+            const int k = bits(alpha, 47 - 3 * i, 45 - 3 * i);
+            const int a = clamp255(base + modifiers[k] * multiplier);
+            std::uint32_t& texel = out[y * 4 + x];
+            texel = (texel & 0x00FFFFFFu) | (static_cast<std::uint32_t>(a) << 24);
+        }
+    }
+}
+
+bool canTranscode(PixelFormat format) {
+    return format != PixelFormat::BC7;
+}
+
+bool transcodeToRgba8(TextureData& texture, std::string* error) {
+    if (texture.format == PixelFormat::RGBA8) {
+        return true;
+    }
+    if (!canTranscode(texture.format)) {
+        if (error) *error = std::string("no CPU decoder for ") + pixelFormatName(texture.format);
+        return false;
+    }
+    const PixelFormat format = texture.format;
+    const std::size_t stride = blockBytes(format);
+    for (TextureLevel& level : texture.levels) {
+        std::vector<unsigned char> rgba8(static_cast<std::size_t>(level.width) * level.height * 4);
+        const int blocksX = (level.width + 3) / 4;
+        const int blocksY = (level.height + 3) / 4;
+        std::uint32_t texels[16];
+        for (int by = 0; by < blocksY; ++by) {
+            for (int bx = 0; bx < blocksX; ++bx) {
+                const unsigned char* block = level.bytes.data() + (static_cast<std::size_t>(by) * blocksX + bx) * stride;
+                switch (format) {
+                    case PixelFormat::BC1_RGB:    decodeBc1Block(block, false, texels); break;
+                    case PixelFormat::BC1_RGBA:   decodeBc1Block(block, true, texels); break;
+                    case PixelFormat::BC3:        decodeBc3Block(block, texels); break;
+                    case PixelFormat::ETC2_RGB8:  decodeEtc2Block(block, texels); break;
+                    case PixelFormat::ETC2_RGBA8: decodeEtc2EacBlock(block, texels); break;
+                    default: break;
+                }
+                // Edge blocks overhang a non-multiple-of-4 level: keep the texels inside.
+                const int w = std::min(4, level.width - bx * 4);
+                const int h = std::min(4, level.height - by * 4);
+                for (int y = 0; y < h; ++y) {
+                    const std::size_t row = static_cast<std::size_t>(by * 4 + y) * level.width + bx * 4;
+                    std::memcpy(rgba8.data() + row * 4, texels + y * 4, static_cast<std::size_t>(w) * 4);
+                }
+            }
+        }
+        level.bytes = std::move(rgba8);
+    }
+    texture.format = PixelFormat::RGBA8;
+    return true;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "asset/texture_data.h"
+
+// Block decoders
+// --------------
+// CPU fallback for GPUs without a compressed format: each 4x4 block is expanded to 16
+// RGBA8 texels (0xAABBGGRR, packColor's layout), texel (x, y) at out[y * 4 + x], rows in
+// the block's own order.
+//
+// | Format     | Decoder             | Notes                                             |
+// | ---------- | ------------------- | ------------------------------------------------- |
+// | BC1        | decodeBc1Block      | 2 RGB565 endpoints + 2-bit indices; c0 <= c1 is   |
+// |            |                     | the 3-colour mode (index 3 = transparent black)   |
+// | BC3        | decodeBc3Block      | BC1 colour (always 4-colour) + 8-bit alpha block  |
+// | ETC2 RGB8  | decodeEtc2Block     | ETC1 individual / differential + T, H and planar  |
+// | ETC2 RGBA8 | decodeEtc2EacBlock  | EAC alpha block + the ETC2 RGB block              |
+// | BC7        | —                   | 8 modes and 128 partition shapes: not worth a CPU |
+// |            |                     | path; every GL 4.2+ GPU samples it natively       |
+void decodeBc1Block(const unsigned char* block, bool alpha, std::uint32_t* out);
+void decodeBc3Block(const unsigned char* block, std::uint32_t* out);
+void decodeEtc2Block(const unsigned char* block, std::uint32_t* out);
+void decodeEtc2EacBlock(const unsigned char* block, std::uint32_t* out);
+
+bool canTranscode(PixelFormat format);
+
+// Replaces every level of `texture` with its RGBA8 expansion (texel rows in the same
+// order, so topDown is unchanged). false: no decoder for the format (texture untouched).
+bool transcodeToRgba8(TextureData& texture, std::string* error = nullptr);
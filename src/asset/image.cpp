@@ -0,0 +1,417 @@
+#include "asset/image.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <utility>
+
+#include "core/vfs.h"
+
+namespace {
+
+constexpr int kMaxDimension = 16384;
+
+bool fail(std::string* error, const char* message) {
+    if (error) *error = message;
+    return false;
+}
+
+std::uint32_t rgba(unsigned r, unsigned g, unsigned b, unsigned a) {
+    return r | (g << 8) | (b << 16) | (a << 24);
+}
+
+void flipRows(Image& image) {
+    const std::size_t w = static_cast<std::size_t>(image.width);
+    for (int top = 0, bottom = image.height - 1; top < bottom; ++top, --bottom) {
+        std::uint32_t* a = image.pixels.data() + top * w;
+        std::uint32_t* b = image.pixels.data() + bottom * w;
+        for (std::size_t x = 0; x < w; ++x) {
+            std::swap(a[x], b[x]);
+        }
+    }
+}
+
+// TGA: 18-byte header, optional id field, then BGR(A) pixels, bottom-left origin unless
+// bit 5 of the descriptor is set. RLE packets: a count byte (bit 7 = run) and either one
+// pixel repeated or `count` raw pixels.
+bool decodeTga(const unsigned char* data, std::size_t size, Image& out, std::string* error) {
+    if (size < 18) {
+        return fail(error, "TGA: truncated header");
+    }
+    const int idLength = data[0];
+    const int colorMapType = data[1];
+    const int type = data[2];
+    const int width = data[12] | (data[13] << 8);
+    const int height = data[14] | (data[15] << 8);
+    const int bpp = data[16];
+    const bool topDown = (data[17] & 0x20) != 0;
+    if (colorMapType != 0 || (type != 2 && type != 10)) {
+        return fail(error, "TGA: only true-colour (type 2 / 10) images are supported");
+    }
+    if (bpp != 24 && bpp != 32) {
+        return fail(error, "TGA: only 24 and 32 bits per pixel are supported");
+    }
+    if (width <= 0 || height <= 0 || width > kMaxDimension || height > kMaxDimension) {
+        return fail(error, "TGA: bad dimensions");
+    }
+
+    const std::size_t channels = static_cast<std::size_t>(bpp / 8);
+    const std::size_t count = static_cast<std::size_t>(width) * height;
+    const unsigned char* p = data + 18 + idLength;
+    const unsigned char* end = data + size;
+    auto pixel = [channels](const unsigned char* s) {
+        return rgba(s[2], s[1], s[0], channels == 4 ? s[3] : 255u);
+    };
+
+    out.pixels.resize(count);
+    if (type == 2) {
+        if (static_cast<std::size_t>(end - p) < count * channels) {
+            return fail(error, "TGA: truncated pixel data");
+        }
+        for (std::size_t i = 0; i < count; ++i, p += channels) {
+            out.pixels[i] = pixel(p);
+        }
+    } else {
+        std::size_t i = 0;
+        while (i < count) {
+            if (p >= end) {
+                return fail(error, "TGA: truncated RLE data");
+            }
+            const unsigned header = *p++;
+            const std::size_t run = (header & 0x7f) + 1;
+            if (i + run > count) {
+                return fail(error, "TGA: RLE packet overruns the image");
+            }
+            if (header & 0x80) {
+                if (static_cast<std::size_t>(end - p) < channels) {
+                    return fail(error, "TGA: truncated RLE data");
+                }
+                const std::uint32_t value = pixel(p);
+                p += channels;
+                for (std::size_t k = 0; k < run; ++k) out.pixels[i++] = value;
+            } else {
+                if (static_cast<std::size_t>(end - p) < run * channels) {
+                    return fail(error, "TGA: truncated RLE data");
+                }
+                for (std::size_t k = 0; k < run; ++k, p += channels) out.pixels[i++] = pixel(p);
+            }
+        }
+    }
+    out.width = width;
+    out.height = height;
+    if (topDown) {
+        flipRows(out);
+    }
+    return true;
+}
+
+// Netpbm header tokens: whitespace-separated, '#' starts a comment to the end of line.
+bool nextToken(const unsigned char*& p, const unsigned char* end, std::string& token) {
+    token.clear();
+    while (p < end) {
+        if (*p == '#') {
+            while (p < end && *p != '\n') ++p;
+        } else if (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') {
+            ++p;
+        } else {
+            break;
+        }
+    }
+    while (p < end && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n') {
+        token.push_back(static_cast<char>(*p++));
+    }
+    return !token.empty();
+}
+
+// P6: "P6 width height maxval" + one whitespace byte + RGB rows, top first.
+// P7 (PAM): "WIDTH w / HEIGHT h / DEPTH d / MAXVAL m / TUPLTYPE t / ENDHDR" lines.
+bool decodeNetpbm(const unsigned char* data, std::size_t size, Image& out, std::string* error) {
+    const unsigned char* p = data + 2;
+    const unsigned char* end = data + size;
+    const bool pam = data[1] == '7';
+    int width = 0, height = 0, maxval = 0, depth = 3;
+    std::string token;
+    if (pam) {
+        while (true) {
+            if (!nextToken(p, end, token)) {
+                return fail(error, "PAM: truncated header");
+            }
+            if (token == "ENDHDR") {
+                break;
+            }
+            std::string value;
+            if (!nextToken(p, end, value)) {
+                return fail(error, "PAM: truncated header");
+            }
+            if (token == "WIDTH") width = std::atoi(value.c_str());
+            else if (token == "HEIGHT") height = std::atoi(value.c_str());
+            else if (token == "DEPTH") depth = std::atoi(value.c_str());
+            else if (token == "MAXVAL") maxval = std::atoi(value.c_str());
+            // TUPLTYPE is implied by DEPTH for the two layouts read here.
+        }
+    } else {
+        std::string w, h, m;
+        if (!nextToken(p, end, w) || !nextToken(p, end, h) || !nextToken(p, end, m)) {
+            return fail(error, "PPM: truncated header");
+        }
+        width = std::atoi(w.c_str());
+        height = std::atoi(h.c_str());
+        maxval = std::atoi(m.c_str());
+    }
+    if (p >= end) {
+        return fail(error, "Netpbm: no pixel data");
+    }
+    ++p; // the single whitespace byte that ends the header
+    if (width <= 0 || height <= 0 || width > kMaxDimension || height > kMaxDimension) {
+        return fail(error, "Netpbm: bad dimensions");
+    }
+    if (maxval != 255 || (depth != 3 && depth != 4)) {
+        return fail(error, "Netpbm: only 8-bit RGB / RGBA is supported");
+    }
+
+    const std::size_t count = static_cast<std::size_t>(width) * height;
+    if (static_cast<std::size_t>(end - p) < count * depth) {
+        return fail(error, "Netpbm: truncated pixel data");
+    }
+    out.pixels.resize(count);
+    for (std::size_t i = 0; i < count; ++i, p += depth) {
+        out.pixels[i] = rgba(p[0], p[1], p[2], depth == 4 ? p[3] : 255u);
+    }
+    out.width = width;
+    out.height = height;
+    flipRows(out); // stored top row first
+    return true;
+}
+
+std::uint32_t bigEndian(const unsigned char* p) {
+    return (static_cast<std::uint32_t>(p[0]) << 24) | (static_cast<std::uint32_t>(p[1]) << 16) |
+           (static_cast<std::uint32_t>(p[2]) << 8) | p[3];
+}
+
+int paeth(int a, int b, int c) {
+    const int p = a + b - c;
+    const int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+    return pa <= pb && pa <= pc ? a : (pb <= pc ? b : c);
+}
+
+// PNG: the signature, chunks (length, type, data, CRC; the CRCs are not checked), the
+// IDATs together one zlib stream. Only stored deflate blocks are read: enough for
+// encodePng's files without an inflater. Each scanline is a filter byte and the row,
+// filters 0-4 undone in place against the previous row.
+bool decodePng(const unsigned char* data, std::size_t size, Image& out, std::string* error) {
+    std::size_t at = 8;
+    int width = 0, height = 0, channels = 0;
+    std::vector<unsigned char> zlib;
+    bool ended = false;
+    while (!ended) {
+        if (size - at < 12) {
+            return fail(error, "PNG: truncated chunk");
+        }
+        const std::size_t length = bigEndian(data + at);
+        const unsigned char* type = data + at + 4;
+        const unsigned char* body = data + at + 8;
+        if (length > size - at - 12) {
+            return fail(error, "PNG: truncated chunk");
+        }
+        if (std::equal(type, type + 4, "IHDR")) {
+            if (length < 13) {
+                return fail(error, "PNG: bad header");
+            }
+            width = static_cast<int>(bigEndian(body));
+            height = static_cast<int>(bigEndian(body + 4));
+            if (body[8] != 8 || (body[9] != 2 && body[9] != 6) || body[12] != 0) {
+                return fail(error, "PNG: only 8-bit RGB / RGBA, not interlaced, is supported");
+            }
+            channels = body[9] == 6 ? 4 : 3;
+        } else if (std::equal(type, type + 4, "IDAT")) {
+            zlib.insert(zlib.end(), body, body + length);
+        } else if (std::equal(type, type + 4, "IEND")) {
+            ended = true;
+        }
+        at += length + 12;
+    }
+    if (width <= 0 || height <= 0 || width > kMaxDimension || height > kMaxDimension) {
+        return fail(error, "PNG: bad dimensions");
+    }
+
+    // zlib: 2-byte header, then stored blocks (BTYPE 00): LEN, NLEN, LEN bytes.
+    const std::size_t rowBytes = static_cast<std::size_t>(width) * channels;
+    std::vector<unsigned char> raw;
+    raw.reserve((rowBytes + 1) * static_cast<std::size_t>(height));
+    std::size_t z = 2;
+    for (bool last = false; !last;) {
+        if (zlib.size() < z + 5) {
+            return fail(error, "PNG: truncated image data");
+        }
+        if ((zlib[z] & 0x06) != 0) {
+            return fail(error, "PNG: compressed image data (only stored deflate blocks are read)");
+        }
+        last = (zlib[z] & 1) != 0;
+        const std::size_t length = zlib[z + 1] | (zlib[z + 2] << 8);
+        if (zlib.size() - z - 5 < length) {
+            return fail(error, "PNG: truncated image data");
+        }
+        raw.insert(raw.end(), zlib.begin() + static_cast<std::ptrdiff_t>(z + 5),
+                   zlib.begin() + static_cast<std::ptrdiff_t>(z + 5 + length));
+        z += 5 + length;
+    }
+    if (raw.size() < (rowBytes + 1) * static_cast<std::size_t>(height)) {
+        return fail(error, "PNG: truncated image data");
+    }
+
+    const std::size_t count = static_cast<std::size_t>(width) * height;
+    out.pixels.resize(count);
+    unsigned char* previous = nullptr;
+    for (int y = 0; y < height; ++y) {
+        unsigned char* line = raw.data() + static_cast<std::size_t>(y) * (rowBytes + 1);
+        const int filter = line[0];
+        unsigned char* row = line + 1;
+        if (filter > 4) {
+            return fail(error, "PNG: bad filter");
+        }
+        for (std::size_t i = 0; i < rowBytes; ++i) {
+            const int a = i >= static_cast<std::size_t>(channels) ? row[i - channels] : 0;
+            const int b = previous ? previous[i] : 0;
+            const int c = previous && i >= static_cast<std::size_t>(channels) ? previous[i - channels] : 0;
+            const int predictor = filter == 1 ? a : filter == 2 ? b : filter == 3 ? (a + b) / 2
+                                : filter == 4 ? paeth(a, b, c) : 0;
+            row[i] = static_cast<unsigned char>(row[i] + predictor);
+        }
+        std::uint32_t* dst = out.pixels.data() + static_cast<std::size_t>(y) * width;
+        for (int x = 0; x < width; ++x) {
+            const unsigned char* p = row + static_cast<std::size_t>(x) * channels;
+            dst[x] = rgba(p[0], p[1], p[2], channels == 4 ? p[3] : 255);
+        }
+        previous = row;
+    }
+    out.width = width;
+    out.height = height;
+    flipRows(out); // stored top row first
+    return true;
+}
+
+} // namespace
+
+bool decodeImage(const unsigned char* data, std::size_t size, Image& out, std::string* error) {
+    out = Image{};
+    bool ok = false;
+    if (size >= 8 && data[0] == 0x89 && data[1] == 'P' && data[2] == 'N' && data[3] == 'G') {
+        ok = decodePng(data, size, out, error);
+    } else if (size >= 3 && data[0] == 'P' && (data[1] == '6' || data[1] == '7')) {
+        ok = decodeNetpbm(data, size, out, error);
+    } else {
+        ok = decodeTga(data, size, out, error); // TGA has no magic number: try it last
+    }
+    if (!ok) {
+        out = Image{};
+    }
+    return ok;
+}
+
+bool loadImageFile(const std::string& path, Image& out, std::string* error) {
+    std::vector<unsigned char> bytes;
+    if (!vfs::readFile(path, bytes)) {
+        out = Image{};
+        return fail(error, "cannot open file");
+    }
+    return decodeImage(bytes.data(), bytes.size(), out, error);
+}
+
+namespace {
+
+std::uint32_t crc32(const unsigned char* data, std::size_t size) {
+    static const std::array<std::uint32_t, 256> table = [] {
+        std::array<std::uint32_t, 256> t{};
+        for (std::uint32_t n = 0; n < 256; ++n) {
+            std::uint32_t c = n;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            t[n] = c;
+        }
+        return t;
+    }();
+    std::uint32_t crc = ~0u;
+    for (std::size_t i = 0; i < size; ++i) {
+        crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+std::uint32_t adler32(const unsigned char* data, std::size_t size) {
+    std::uint32_t a = 1, b = 0;
+    while (size > 0) {
+        // 5552 bytes is the most that can be summed before b could overflow 32 bits.
+        const std::size_t n = std::min<std::size_t>(size, 5552);
+        for (std::size_t i = 0; i < n; ++i) {
+            a += data[i];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+        data += n;
+        size -= n;
+    }
+    return (b << 16) | a;
+}
+
+void putBigEndian(std::vector<unsigned char>& out, std::uint32_t value) {
+    out.push_back(static_cast<unsigned char>(value >> 24));
+    out.push_back(static_cast<unsigned char>(value >> 16));
+    out.push_back(static_cast<unsigned char>(value >> 8));
+    out.push_back(static_cast<unsigned char>(value));
+}
+
+// Length, type, data, CRC of type + data. `data` must not point into `out`.
+void putChunk(std::vector<unsigned char>& out, const char* type, const unsigned char* data, std::size_t size) {
+    putBigEndian(out, static_cast<std::uint32_t>(size));
+    const std::size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data, data + size);
+    putBigEndian(out, crc32(out.data() + start, size + 4));
+}
+
+} // namespace
+
+void encodePng(const Image& image, std::vector<unsigned char>& out) {
+    static const unsigned char kSignature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    out.insert(out.end(), kSignature, kSignature + 8);
+
+    std::vector<unsigned char> header;
+    putBigEndian(header, static_cast<std::uint32_t>(image.width));
+    putBigEndian(header, static_cast<std::uint32_t>(image.height));
+    const unsigned char rest[5] = {8, 6, 0, 0, 0};      // 8 bits, RGBA, deflate, no filter, no interlace
+    header.insert(header.end(), rest, rest + 5);
+    putChunk(out, "IHDR", header.data(), header.size());
+
+    // The scanlines, top first (our row 0 is the bottom), each behind filter byte 0.
+    const std::size_t rowBytes = static_cast<std::size_t>(image.width) * 4;
+    std::vector<unsigned char> raw;
+    raw.reserve((rowBytes + 1) * static_cast<std::size_t>(image.height));
+    for (int y = image.height - 1; y >= 0; --y) {
+        raw.push_back(0);
+        const auto* row = reinterpret_cast<const unsigned char*>(image.pixels.data() + static_cast<std::size_t>(y) * image.width);
+        raw.insert(raw.end(), row, row + rowBytes);
+    }
+
+    // zlib: header, stored deflate blocks of at most 65535 bytes, Adler-32 of the data.
+    std::vector<unsigned char> zlib;
+    zlib.reserve(raw.size() + raw.size() / 65535 * 5 + 16);
+    zlib.push_back(0x78);
+    zlib.push_back(0x01);
+    std::size_t offset = 0;
+    do {
+        const std::size_t size = std::min<std::size_t>(raw.size() - offset, 65535);
+        zlib.push_back(offset + size == raw.size() ? 1 : 0);   // BFINAL, BTYPE 00
+        zlib.push_back(static_cast<unsigned char>(size));
+        zlib.push_back(static_cast<unsigned char>(size >> 8));
+        zlib.push_back(static_cast<unsigned char>(~size));
+        zlib.push_back(static_cast<unsigned char>(~size >> 8));
+        zlib.insert(zlib.end(), raw.begin() + static_cast<std::ptrdiff_t>(offset),
+                    raw.begin() + static_cast<std::ptrdiff_t>(offset + size));
+        offset += size;
+    } while (offset < raw.size());
+    putBigEndian(zlib, adler32(raw.data(), raw.size()));
+    putChunk(out, "IDAT", zlib.data(), zlib.size());
+    putChunk(out, "IEND", nullptr, 0);
+}
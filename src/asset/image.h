@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Image
+// -----
+// Decoded RGBA8 pixels, 0xAABBGGRR per texel (packColor's layout, which is what GL reads
+// for GL_RGBA / GL_UNSIGNED_BYTE), row 0 at the BOTTOM—GL's convention, so a texture
+// upload needs no flip. Decoders flip files stored top-down.
+struct Image {
+    int width = 0;
+    int height = 0;
+    std::vector<std::uint32_t> pixels;
+
+    bool valid() const { return width > 0 && height > 0; }
+    std::size_t bytes() const { return pixels.size() * sizeof(std::uint32_t); }
+};
+
+// Image decoding
+// --------------
+// Plain CPU code with no GL or global state, so worker threads can call it freely.
+// The formats are the ones a tool can write without a compression library:
+//
+// | Format          | Variants                                    | Alpha           |
+// | --------------- | ------------------------------------------- | --------------- |
+// | TGA             | type 2 (raw) and 10 (RLE), 24 / 32 bpp,     | 32 bpp: yes     |
+// |                 | either origin                               |                 |
+// | PPM (P6) / PAM  | binary, maxval 255; PAM: RGB or RGB_ALPHA   | PAM RGB_ALPHA   |
+// | PNG             | 8-bit RGB / RGBA, not interlaced, deflate   | RGBA: yes       |
+// |                 | in stored blocks only (encodePng's own and  |                 |
+// |                 | the captures'; a recompressed file fails)   |                 |
+//
+// On failure the functions return false and set `error` (if given); `out` is left invalid.
+bool decodeImage(const unsigned char* data, std::size_t size, Image& out, std::string* error = nullptr);
+
+// Reads the whole file, then decodeImage. Blocking: call it off the frame threads.
+bool loadImageFile(const std::string& path, Image& out, std::string* error = nullptr);
+
+// Image encoding
+// --------------
+// PNG (RGBA8, row 0 of the image written as the file's bottom row) with the deflate
+// stream in stored blocks: valid for every PNG reader, no compression library, but no
+// smaller than the pixels (for captures, render/frame_capture.h; a tool can recompress).
+// Appends to `out`.
+void encodePng(const Image& image, std::vector<unsigned char>& out);
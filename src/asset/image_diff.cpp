@@ -0,0 +1,129 @@
+#include "asset/image_diff.h"
+
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+constexpr float kMaxDistance = 35215.0f;   // black vs white
+constexpr float kInv255 = 1.0f / 255.0f;
+
+// RGB → YIQ rows, and each axis's weight in the distance.
+constexpr float kY[3] = {0.29889531f, 0.58662247f, 0.11448223f};
+constexpr float kI[3] = {0.59597799f, -0.27417610f, -0.32180189f};
+constexpr float kQ[3] = {0.21147017f, -0.52261711f, 0.31114694f};
+constexpr float kWeightY = 0.5053f, kWeightI = 0.299f, kWeightQ = 0.1957f;
+
+// A channel over white: 255 + (c - 255) * a / 255.
+inline float overWhite(std::uint32_t pixel, int shift) {
+    const float c = static_cast<float>((pixel >> shift) & 0xFFu);
+    const float a = static_cast<float>(pixel >> 24) * kInv255;
+    return 255.0f + (c - 255.0f) * a;
+}
+
+inline float distance(std::uint32_t p, std::uint32_t q) {
+    const float dr = overWhite(p, 0) - overWhite(q, 0);
+    const float dg = overWhite(p, 8) - overWhite(q, 8);
+    const float db = overWhite(p, 16) - overWhite(q, 16);
+    const float y = dr * kY[0] + dg * kY[1] + db * kY[2];
+    const float i = dr * kI[0] + dg * kI[1] + db * kI[2];
+    const float iq = dr * kQ[0] + dg * kQ[1] + db * kQ[2];
+    return kWeightY * y * y + kWeightI * i * i + kWeightQ * iq * iq;
+}
+
+#if defined(__SSE2__)
+inline __m128 channel(__m128i pixels, int shift) {
+    return _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(pixels, shift), _mm_set1_epi32(0xFF)));
+}
+
+inline __m128 overWhite4(__m128i pixels, __m128 alpha, int shift) {
+    const __m128 white = _mm_set1_ps(255.0f);
+    return _mm_add_ps(white, _mm_mul_ps(_mm_sub_ps(channel(pixels, shift), white), alpha));
+}
+
+inline __m128 dot3(__m128 r, __m128 g, __m128 b, const float (&row)[3]) {
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(r, _mm_set1_ps(row[0])), _mm_mul_ps(g, _mm_set1_ps(row[1]))),
+                      _mm_mul_ps(b, _mm_set1_ps(row[2])));
+}
+
+inline __m128 distance4(__m128i p, __m128i q) {
+    const __m128 inv = _mm_set1_ps(kInv255);
+    const __m128 ap = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(p, 24)), inv);
+    const __m128 aq = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(q, 24)), inv);
+    const __m128 dr = _mm_sub_ps(overWhite4(p, ap, 0), overWhite4(q, aq, 0));
+    const __m128 dg = _mm_sub_ps(overWhite4(p, ap, 8), overWhite4(q, aq, 8));
+    const __m128 db = _mm_sub_ps(overWhite4(p, ap, 16), overWhite4(q, aq, 16));
+    const __m128 y = dot3(dr, dg, db, kY);
+    const __m128 i = dot3(dr, dg, db, kI);
+    const __m128 iq = dot3(dr, dg, db, kQ);
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_mul_ps(_mm_set1_ps(kWeightY), y), y),
+                                 _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(kWeightI), i), i)),
+                      _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(kWeightQ), iq), iq));
+}
+#endif
+
+// The faded background of the visual diff: the pixel's luma over white at 10%.
+std::uint32_t faded(std::uint32_t pixel) {
+    const float y = overWhite(pixel, 0) * kY[0] + overWhite(pixel, 8) * kY[1] + overWhite(pixel, 16) * kY[2];
+    const auto v = static_cast<std::uint32_t>(std::clamp(255.0f + (y - 255.0f) * 0.1f, 0.0f, 255.0f));
+    return v | (v << 8) | (v << 16) | 0xFF000000u;
+}
+
+} // namespace
+
+bool diffImages(const Image& expected, const Image& actual, float threshold, ImageDiff& out, Image* visual) {
+    out = ImageDiff{};
+    if (expected.width != actual.width || expected.height != actual.height ||
+        expected.pixels.size() != actual.pixels.size()) {
+        return false;
+    }
+    const float limit = kMaxDistance * threshold * threshold;
+    const std::uint32_t* p = expected.pixels.data();
+    const std::uint32_t* q = actual.pixels.data();
+    const std::size_t count = expected.pixels.size();
+    std::uint64_t different = 0;
+    float largest = 0.0f;
+    std::size_t i = 0;
+#if defined(__SSE2__)
+    const __m128 limit4 = _mm_set1_ps(limit);
+    __m128 largest4 = _mm_setzero_ps();
+    for (; i + 4 <= count; i += 4) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(q + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(a, b)) == 0xFFFF) {
+            continue;                  // the common case: four identical pixels
+        }
+        const __m128 d = distance4(a, b);
+        largest4 = _mm_max_ps(largest4, d);
+        different += static_cast<std::uint64_t>(__builtin_popcount(
+            static_cast<unsigned>(_mm_movemask_ps(_mm_cmpgt_ps(d, limit4)))));
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, largest4);
+    largest = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+#endif
+    for (; i < count; ++i) {
+        if (p[i] == q[i]) {
+            continue;
+        }
+        const float d = distance(p[i], q[i]);
+        largest = std::max(largest, d);
+        different += d > limit ? 1 : 0;
+    }
+    out.pixels = count;
+    out.different = different;
+    out.maxDistance = largest / kMaxDistance;
+
+    if (visual) {
+        visual->width = expected.width;
+        visual->height = expected.height;
+        visual->pixels.resize(count);
+        for (std::size_t k = 0; k < count; ++k) {
+            visual->pixels[k] = p[k] != q[k] && distance(p[k], q[k]) > limit ? 0xFF0000FFu : faded(p[k]);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+
+#include "asset/image.h"
+
+// Perceptual image diff
+// ---------------------
+// Whether two renders of the same scene look the same, for the golden-frame regression
+// run (src/tools/golden_runner.cpp): not byte equality, which a driver update or a
+// different GPU's rounding breaks on edge pixels nobody can see, but a per-pixel color
+// distance weighted the way the eye is.
+//
+// | Step          | Per pixel                                                         |
+// | ------------- | ----------------------------------------------------------------- |
+// | alpha         | both pixels blended over white (a transparent pixel looks white)  |
+// | distance      | YIQ difference, 0.5053 dY² + 0.299 dI² + 0.1957 dQ²: brightness   |
+// |               | counts most, the blue-yellow axis least (pixelmatch's metric)     |
+// | different     | distance over threshold² of the largest one (35215, black vs      |
+// |               | white): threshold 0.1 passes what a glance can't tell apart       |
+//
+// SSE2 path (every x86-64 CPU): four pixels per iteration, the channels widened to float
+// lanes; the tail and other targets take the scalar loop, the same float operations in
+// the same order, so both count the same pixels. About a millisecond per 1080p frame.
+struct ImageDiff {
+    std::uint64_t pixels = 0;          // compared
+    std::uint64_t different = 0;       // over the threshold
+    float maxDistance = 0.0f;          // the largest, as a fraction of black vs white's
+};
+
+// false: the sizes differ (nothing compared). `visual`, if given, becomes the diff as a
+// picture: the different pixels red, the rest `expected` faded to a light gray.
+bool diffImages(const Image& expected, const Image& actual, float threshold, ImageDiff& out,
+                Image* visual = nullptr);
@@ -0,0 +1,126 @@
+#include "asset/ktx2.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+
+constexpr unsigned char kIdentifier[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+constexpr std::size_t kHeaderBytes = 80;     // identifier + header + index
+constexpr std::size_t kLevelIndexBytes = 24; // byteOffset, byteLength, uncompressedByteLength
+
+bool fail(std::string* error, const char* message) {
+    if (error) *error = message;
+    return false;
+}
+
+std::uint32_t read32(const unsigned char* p) {
+    return static_cast<std::uint32_t>(p[0]) | (static_cast<std::uint32_t>(p[1]) << 8) |
+           (static_cast<std::uint32_t>(p[2]) << 16) | (static_cast<std::uint32_t>(p[3]) << 24);
+}
+
+std::uint64_t read64(const unsigned char* p) {
+    return static_cast<std::uint64_t>(read32(p)) | (static_cast<std::uint64_t>(read32(p + 4)) << 32);
+}
+
+// VkFormat values (vulkan_core.h) → ours. SRGB variants map to the same format.
+bool fromVkFormat(std::uint32_t vkFormat, PixelFormat& format) {
+    switch (vkFormat) {
+        case 37:  case 43:  format = PixelFormat::RGBA8; return true;      // R8G8B8A8_UNORM / _SRGB
+        case 131: case 132: format = PixelFormat::BC1_RGB; return true;    // BC1_RGB_*_BLOCK
+        case 133: case 134: format = PixelFormat::BC1_RGBA; return true;   // BC1_RGBA_*_BLOCK
+        case 137: case 138: format = PixelFormat::BC3; return true;        // BC3_*_BLOCK
+        case 145: case 146: format = PixelFormat::BC7; return true;        // BC7_*_BLOCK
+        case 147: case 148: format = PixelFormat::ETC2_RGB8; return true;  // ETC2_R8G8B8_*_BLOCK
+        case 151: case 152: format = PixelFormat::ETC2_RGBA8; return true; // ETC2_R8G8B8A8_*_BLOCK
+        default: return false;
+    }
+}
+
+// Key/value data: repeated { uint32 length; key NUL value; padding to 4 }.
+bool orientationIsTopDown(const unsigned char* kvd, std::size_t length) {
+    std::size_t at = 0;
+    while (at + 4 <= length) {
+        const std::uint32_t entry = read32(kvd + at);
+        at += 4;
+        if (entry > length - at) {
+            break;
+        }
+        const char* key = reinterpret_cast<const char*>(kvd + at);
+        const std::size_t keyLength = strnlen(key, entry);
+        if (keyLength < entry && std::strcmp(key, "KTXorientation") == 0) {
+            // "rd" / "ru": the second character is the y direction.
+            const char* value = key + keyLength + 1;
+            const std::size_t valueLength = entry - keyLength - 1;
+            return !(valueLength >= 2 && value[1] == 'u');
+        }
+        at += (entry + 3) & ~std::size_t{3};
+    }
+    return true;
+}
+
+} // namespace
+
+bool isKtx2(const unsigned char* data, std::size_t size) {
+    return size >= sizeof(kIdentifier) && std::memcmp(data, kIdentifier, sizeof(kIdentifier)) == 0;
+}
+
+bool decodeKtx2(const unsigned char* data, std::size_t size, TextureData& out, std::string* error) {
+    out = TextureData{};
+    if (!isKtx2(data, size)) {
+        return fail(error, "KTX2: bad identifier");
+    }
+    if (size < kHeaderBytes) {
+        return fail(error, "KTX2: truncated header");
+    }
+    const unsigned char* h = data + 12;
+    const std::uint32_t vkFormat = read32(h + 0);
+    const std::uint32_t width = read32(h + 8);
+    const std::uint32_t height = read32(h + 12);
+    const std::uint32_t depth = read32(h + 16);
+    const std::uint32_t layers = read32(h + 20);
+    const std::uint32_t faces = read32(h + 24);
+    const std::uint32_t levelCount = read32(h + 28);
+    const std::uint32_t supercompression = read32(h + 32);
+    const std::uint32_t kvdOffset = read32(h + 44);
+    const std::uint32_t kvdLength = read32(h + 48);
+
+    PixelFormat format;
+    if (!fromVkFormat(vkFormat, format)) {
+        return fail(error, "KTX2: unsupported vkFormat");
+    }
+    if (supercompression != 0) {
+        return fail(error, "KTX2: supercompressed (Basis / zstd) files are not supported");
+    }
+    if (depth != 0 || layers > 1 || faces != 1) {
+        return fail(error, "KTX2: only plain 2D textures are supported");
+    }
+    if (width == 0 || height == 0 || width > 16384 || height > 16384) {
+        return fail(error, "KTX2: bad dimensions");
+    }
+    const std::uint32_t levels = levelCount == 0 ? 1 : levelCount;
+    if (levels > 15 || kHeaderBytes + levels * kLevelIndexBytes > size) {
+        return fail(error, "KTX2: bad level index");
+    }
+
+    out.format = format;
+    out.topDown = kvdLength == 0 || kvdOffset > size || kvdLength > size - kvdOffset
+                      ? true
+                      : orientationIsTopDown(data + kvdOffset, kvdLength);
+    out.levels.resize(levels);
+    for (std::uint32_t i = 0; i < levels; ++i) {
+        const unsigned char* entry = data + kHeaderBytes + i * kLevelIndexBytes;
+        const std::uint64_t offset = read64(entry);
+        const std::uint64_t length = read64(entry + 8);
+        TextureLevel& level = out.levels[i];
+        level.width = std::max<int>(1, static_cast<int>(width >> i));
+        level.height = std::max<int>(1, static_cast<int>(height >> i));
+        if (length != imageBytes(format, level.width, level.height) || offset > size || length > size - offset) {
+            out = TextureData{};
+            return fail(error, "KTX2: level data out of range or of the wrong size");
+        }
+        level.bytes.assign(data + offset, data + offset + length);
+    }
+    return true;
+}
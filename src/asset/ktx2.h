@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "asset/texture_data.h"
+
+// KTX2
+// ----
+// Khronos' texture container: a fixed header, an index of mip levels, then the level
+// data (smallest level first in the file, any order in the index). Only the parts a 2D
+// sprite texture needs are read:
+//
+// | Header field           | Accepted                                                 |
+// | ---------------------- | -------------------------------------------------------- |
+// | vkFormat               | R8G8B8A8 (UNORM/SRGB), BC1 RGB/RGBA, BC3, BC7, ETC2 RGB8 |
+// |                        | and RGBA8, each UNORM or SRGB                            |
+// | pixelDepth, layerCount | 0 (a plain 2D texture)                                   |
+// | faceCount              | 1 (no cube maps)                                         |
+// | levelCount             | 0 (= one level, mips to be generated) or the full count  |
+// | supercompression       | 0: Basis / zstd would need their transcoders             |
+//
+// The KTXorientation key/value entry decides TextureData::topDown ("rd", the default,
+// is top-down). *_SRGB formats are read as their UNORM twins: this renderer has no sRGB
+// framebuffer and treats every texture's bytes as display values.
+bool decodeKtx2(const unsigned char* data, std::size_t size, TextureData& out, std::string* error = nullptr);
+
+bool isKtx2(const unsigned char* data, std::size_t size);
@@ -0,0 +1,204 @@
+#include "asset/mesh_optimize.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// Forsyth's scoring: the modelled LRU cache, and a bonus for vertices with few
+// triangles left so none are stranded until the end.
+constexpr int kCacheSize = 32;
+constexpr float kLastTriangleScore = 0.75f;
+constexpr float kCacheDecayPower = 1.5f;
+constexpr float kValenceScale = 2.0f;
+constexpr float kValencePower = 0.5f;
+constexpr std::uint32_t kUnused = ~0u;
+
+float vertexScore(int cachePosition, std::uint32_t remaining) {
+    if (remaining == 0) {
+        return -1.0f;                  // no triangles left to pull in
+    }
+    float score = 0.0f;
+    if (cachePosition >= 0) {
+        // The last triangle's three vertices score the same: which of them is
+        // evicted first doesn't depend on the order it was drawn in.
+        score = cachePosition < 3 ? kLastTriangleScore
+                                  : std::pow(1.0f - static_cast<float>(cachePosition - 3) / (kCacheSize - 3),
+                                             kCacheDecayPower);
+    }
+    return score + kValenceScale * std::pow(static_cast<float>(remaining), -kValencePower);
+}
+
+} // namespace
+
+namespace meshopt {
+
+void optimizeVertexCache(std::uint32_t* indices, std::size_t indexCount, std::size_t vertexCount) {
+    const std::size_t triangleCount = indexCount / 3;
+    if (triangleCount < 2 || vertexCount == 0) {
+        return;
+    }
+
+    // Each vertex's triangles not yet emitted: adjacency[offsets[v], + remaining[v]).
+    std::vector<std::uint32_t> remaining(vertexCount, 0);
+    for (std::size_t i = 0; i < triangleCount * 3; ++i) {
+        ++remaining[indices[i]];
+    }
+    std::vector<std::uint32_t> offsets(vertexCount, 0);
+    for (std::size_t v = 1; v < vertexCount; ++v) {
+        offsets[v] = offsets[v - 1] + remaining[v - 1];
+    }
+    std::vector<std::uint32_t> adjacency(triangleCount * 3);
+    std::vector<std::uint32_t> filled(offsets);
+    for (std::size_t t = 0; t < triangleCount; ++t) {
+        for (std::size_t k = 0; k < 3; ++k) {
+            adjacency[filled[indices[t * 3 + k]]++] = static_cast<std::uint32_t>(t);
+        }
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> score(vertexCount);
+    for (std::size_t v = 0; v < vertexCount; ++v) {
+        score[v] = vertexScore(-1, remaining[v]);
+    }
+    std::vector<float> triangleScore(triangleCount);
+    std::vector<char> emitted(triangleCount, 0);
+    std::size_t best = 0;
+    for (std::size_t t = 0; t < triangleCount; ++t) {
+        const std::uint32_t* tri = indices + t * 3;
+        triangleScore[t] = score[tri[0]] + score[tri[1]] + score[tri[2]];
+        if (triangleScore[t] > triangleScore[best]) {
+            best = t;
+        }
+    }
+
+    std::vector<std::uint32_t> out;
+    out.reserve(triangleCount * 3);
+    std::uint32_t cache[kCacheSize + 3];
+    std::uint32_t next[kCacheSize + 3];
+    std::size_t cached = 0;
+    std::size_t scan = 0;              // triangles before it are all emitted
+    for (std::size_t n = 0; n < triangleCount; ++n) {
+        if (best == triangleCount) {
+            // Nothing in the cache has triangles left: start over at the next one.
+            while (emitted[scan]) {
+                ++scan;
+            }
+            best = scan;
+        }
+        const std::uint32_t* tri = indices + best * 3;
+        const std::uint32_t corners[3] = {tri[0], tri[1], tri[2]};
+        emitted[best] = 1;
+        out.insert(out.end(), corners, corners + 3);
+
+        for (const std::uint32_t v : corners) {
+            std::uint32_t* list = adjacency.data() + offsets[v];
+            std::uint32_t* end = list + remaining[v];
+            std::uint32_t* it = std::find(list, end, static_cast<std::uint32_t>(best));
+            if (it != end) {
+                *it = end[-1];
+                --remaining[v];
+            }
+        }
+
+        // The triangle's vertices move to the front; what falls past kCacheSize leaves.
+        std::size_t count = 0;
+        for (const std::uint32_t v : corners) {
+            if (std::find(next, next + count, v) == next + count) {
+                next[count++] = v;
+            }
+        }
+        for (std::size_t i = 0; i < cached; ++i) {
+            if (std::find(next, next + count, cache[i]) == next + count) {
+                next[count++] = cache[i];
+            }
+        }
+        for (std::size_t i = 0; i < count; ++i) {
+            const std::uint32_t v = next[i];
+            cachePosition[v] = i < static_cast<std::size_t>(kCacheSize) ? static_cast<int>(i) : -1;
+            score[v] = vertexScore(cachePosition[v], remaining[v]);
+        }
+
+        // Only triangles around those vertices changed score.
+        best = triangleCount;
+        float bestScore = -1.0f;
+        for (std::size_t i = 0; i < count; ++i) {
+            const std::uint32_t v = next[i];
+            for (std::uint32_t k = 0; k < remaining[v]; ++k) {
+                const std::uint32_t t = adjacency[offsets[v] + k];
+                const std::uint32_t* other = indices + std::size_t(t) * 3;
+                triangleScore[t] = score[other[0]] + score[other[1]] + score[other[2]];
+                if (triangleScore[t] > bestScore) {
+                    bestScore = triangleScore[t];
+                    best = t;
+                }
+            }
+        }
+        cached = std::min<std::size_t>(count, kCacheSize);
+        std::copy(next, next + cached, cache);
+    }
+    std::copy(out.begin(), out.end(), indices);
+}
+
+std::size_t optimizeVertexFetch(void* vertices, std::size_t stride, std::size_t vertexCount, std::uint32_t* indices,
+                                std::size_t indexCount) {
+    std::vector<std::uint32_t> remap(vertexCount, kUnused);
+    std::uint32_t used = 0;
+    for (std::size_t i = 0; i < indexCount; ++i) {
+        std::uint32_t& slot = remap[indices[i]];
+        if (slot == kUnused) {
+            slot = used++;
+        }
+        indices[i] = slot;
+    }
+    unsigned char* bytes = static_cast<unsigned char*>(vertices);
+    const std::vector<unsigned char> source(bytes, bytes + vertexCount * stride);
+    for (std::size_t v = 0; v < vertexCount; ++v) {
+        if (remap[v] != kUnused) {
+            std::memcpy(bytes + std::size_t(remap[v]) * stride, source.data() + v * stride, stride);
+        }
+    }
+    return used;
+}
+
+float acmr(const std::uint32_t* indices, std::size_t indexCount, std::size_t vertexCount) {
+    const std::size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0) {
+        return 0.0f;
+    }
+    // Vertex v is in the FIFO while fewer than kFifoSize misses happened since its own.
+    std::vector<std::size_t> insertedAt(vertexCount, 0);
+    std::size_t misses = 0;
+    for (std::size_t i = 0; i < triangleCount * 3; ++i) {
+        std::size_t& at = insertedAt[indices[i]];
+        if (at == 0 || misses + 1 - at > kFifoSize) {
+            ++misses;
+            at = misses;
+        }
+    }
+    return static_cast<float>(misses) / static_cast<float>(triangleCount);
+}
+
+Report optimize(std::vector<unsigned char>& vertices, std::size_t stride, std::size_t& vertexCount,
+                std::vector<std::uint32_t>& indices) {
+    Report report;
+    report.verticesBefore = vertexCount;
+    report.acmrBefore = acmr(indices.data(), indices.size(), vertexCount);
+    optimizeVertexCache(indices.data(), indices.size(), vertexCount);
+    vertexCount = optimizeVertexFetch(vertices.data(), stride, vertexCount, indices.data(), indices.size());
+    vertices.resize(vertexCount * stride);
+    report.acmrAfter = acmr(indices.data(), indices.size(), vertexCount);
+    report.verticesAfter = vertexCount;
+    return report;
+}
+
+bool narrowIndices(const std::uint32_t* indices, std::size_t indexCount, std::vector<std::uint16_t>& out) {
+    if (std::any_of(indices, indices + indexCount, [](std::uint32_t i) { return i > 0xffff; })) {
+        return false;
+    }
+    out.assign(indices, indices + indexCount);
+    return true;
+}
+
+} // namespace meshopt
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Mesh optimization
+// -----------------
+// Load-time passes for imported triangle meshes (polygons, decals: anything past the
+// 4-vertex quad), run once before the mesh goes into a MeshPool:
+//
+// | Pass                 | What it reorders            | Why                                  |
+// | -------------------- | --------------------------- | ------------------------------------ |
+// | optimizeVertexCache  | triangles (the index list)  | consecutive triangles share vertices |
+// |                      |                             | still in the post-transform cache    |
+// | optimizeVertexFetch  | vertices, indices remapped  | vertices in first-use order: each    |
+// |                      |                             | fetch reads the next bytes, not a    |
+// |                      |                             | random cache line; unused ones go    |
+// | narrowIndices        | 32-bit to 16-bit            | half the index bytes, and the format |
+// |                      |                             | MeshPool draws (GL_UNSIGNED_SHORT)   |
+//
+// Cache order first: fetch order follows the triangle order it is given. Importers
+// produce 32-bit indices; a mesh of more than 65536 vertices keeps them (split it, or
+// draw it from its own buffers with GL_UNSIGNED_INT).
+//
+//     meshopt::Report report = meshopt::optimize(vertices, stride, vertexCount, indices);
+//     std::vector<std::uint16_t> narrow;
+//     if (meshopt::narrowIndices(indices.data(), indices.size(), narrow)) {
+//         mesh = pool.add(vertices.data(), vertexCount, narrow.data(), narrow.size());
+//     }
+namespace meshopt {
+
+// Entries of the FIFO that acmr() simulates: the order of what GPUs keep of
+// recently shaded vertices.
+constexpr std::size_t kFifoSize = 16;
+
+struct Report {
+    float acmrBefore = 0.0f;           // vertex shader runs per triangle, kFifoSize FIFO
+    float acmrAfter = 0.0f;
+    std::size_t verticesBefore = 0;
+    std::size_t verticesAfter = 0;     // without the unreferenced ones
+};
+
+// Reorders the triangles of `indices` (a triangle list, indices < vertexCount) for the
+// post-transform cache: Forsyth's linear-speed greedy order, each next triangle the best
+// scoring among those touching cached vertices.
+void optimizeVertexCache(std::uint32_t* indices, std::size_t indexCount, std::size_t vertexCount);
+
+// Moves the vertices (stride bytes each) into the order the indices first use them and
+// rewrites the indices to match. Returns the new vertex count: unreferenced vertices
+// are dropped from the end.
+std::size_t optimizeVertexFetch(void* vertices, std::size_t stride, std::size_t vertexCount, std::uint32_t* indices,
+                                std::size_t indexCount);
+
+// Average cache miss ratio: misses of a kFifoSize FIFO per triangle, 0.5 (a perfect
+// grid) to 3 (nothing shared).
+float acmr(const std::uint32_t* indices, std::size_t indexCount, std::size_t vertexCount);
+
+// Both passes; `vertexCount` becomes the new count and `vertices` is shrunk to it.
+Report optimize(std::vector<unsigned char>& vertices, std::size_t stride, std::size_t& vertexCount,
+                std::vector<std::uint32_t>& indices);
+
+// `out` = the indices as 16-bit. false (out untouched): one of them is past 65535.
+bool narrowIndices(const std::uint32_t* indices, std::size_t indexCount, std::vector<std::uint16_t>& out);
+
+} // namespace meshopt
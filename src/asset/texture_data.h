@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// PixelFormat
+// -----------
+// What a TextureData's bytes are. The block-compressed formats store 4x4 texel blocks
+// that the GPU samples directly, so they stay compressed in VRAM too:
+//
+// | Format      | Bytes / 4x4 block | Bits / texel | Alpha        | GL needs                 |
+// | ----------- | ----------------- | ------------ | ------------ | ------------------------ |
+// | RGBA8       | 64 (not blocked)  | 32           | 8 bit        | —                        |
+// | BC1_RGB     | 8                 | 4            | none         | EXT_texture_compression_ |
+// | BC1_RGBA    | 8                 | 4            | 1 bit        | s3tc                     |
+// | BC3         | 16                | 8            | 8 bit        | (same)                   |
+// | BC7         | 16                | 8            | 8 bit        | GL 4.2 / ARB_texture_    |
+// |             |                   |              |              | compression_bptc         |
+// | ETC2_RGB8   | 8                 | 4            | none         | GL 4.3 / ARB_ES3_        |
+// | ETC2_RGBA8  | 16                | 8            | 8 bit (EAC)  | compatibility            |
+enum class PixelFormat : std::uint8_t {
+    RGBA8,
+    BC1_RGB,
+    BC1_RGBA,
+    BC3,
+    BC7,
+    ETC2_RGB8,
+    ETC2_RGBA8,
+};
+
+inline const char* pixelFormatName(PixelFormat format) {
+    switch (format) {
+        case PixelFormat::RGBA8:      return "RGBA8";
+        case PixelFormat::BC1_RGB:    return "BC1 RGB";
+        case PixelFormat::BC1_RGBA:   return "BC1 RGBA";
+        case PixelFormat::BC3:        return "BC3";
+        case PixelFormat::BC7:        return "BC7";
+        case PixelFormat::ETC2_RGB8:  return "ETC2 RGB8";
+        case PixelFormat::ETC2_RGBA8: return "ETC2 RGBA8";
+    }
+    return "?";
+}
+
+inline bool isBlockCompressed(PixelFormat format) { return format != PixelFormat::RGBA8; }
+
+// 8 or 16 for block formats; 4 (one texel) for RGBA8.
+inline std::size_t blockBytes(PixelFormat format) {
+    switch (format) {
+        case PixelFormat::RGBA8:      return 4;
+        case PixelFormat::BC1_RGB:
+        case PixelFormat::BC1_RGBA:
+        case PixelFormat::ETC2_RGB8:  return 8;
+        case PixelFormat::BC3:
+        case PixelFormat::BC7:
+        case PixelFormat::ETC2_RGBA8: return 16;
+    }
+    return 4;
+}
+
+// Texels per block edge: 4, or 1 for RGBA8.
+inline int blockSize(PixelFormat format) { return isBlockCompressed(format) ? 4 : 1; }
+
+// Bytes of one width x height image (partial blocks at the edges count as whole blocks).
+inline std::size_t imageBytes(PixelFormat format, int width, int height) {
+    const int b = blockSize(format);
+    return static_cast<std::size_t>((width + b - 1) / b) * static_cast<std::size_t>((height + b - 1) / b) *
+           blockBytes(format);
+}
+
+// TextureData
+// -----------
+// One 2D texture's mip chain, level 0 first. Each level's bytes are tightly packed rows
+// of blocks (or texels for RGBA8) as the GL upload calls expect them.
+//
+// topDown: the first stored row is the TOP of the image (KTX2's default orientation).
+// RGBA8 data can be flipped on load, compressed blocks can't be cheaply, so such
+// textures are uploaded as they are and sampled with v flipped instead.
+struct TextureLevel {
+    int width = 0;
+    int height = 0;
+    std::vector<unsigned char> bytes;
+};
+
+struct TextureData {
+    PixelFormat format = PixelFormat::RGBA8;
+    bool topDown = false;
+    std::vector<TextureLevel> levels;
+
+    bool valid() const { return !levels.empty() && levels[0].width > 0 && levels[0].height > 0; }
+    int width() const { return levels.empty() ? 0 : levels[0].width; }
+    int height() const { return levels.empty() ? 0 : levels[0].height; }
+    std::size_t bytes() const {
+        std::size_t n = 0;
+        for (const TextureLevel& level : levels) n += level.bytes.size();
+        return n;
+    }
+};
@@ -0,0 +1,191 @@
+#include "audio/audio_device.h"
+
+#include <dlfcn.h>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <type_traits>
+
+namespace {
+
+// The part of libasound's ABI used here (alsa/asoundlib.h), resolved once.
+constexpr int kStreamPlayback = 0;            // SND_PCM_STREAM_PLAYBACK
+constexpr int kFormatS16LE = 2;               // SND_PCM_FORMAT_S16_LE
+constexpr int kAccessRwInterleaved = 3;       // SND_PCM_ACCESS_RW_INTERLEAVED
+
+struct Alsa {
+    int (*pcmOpen)(void** pcm, const char* name, int stream, int mode) = nullptr;
+    int (*pcmSetParams)(void* pcm, int format, int access, unsigned channels, unsigned rate, int softResample,
+                        unsigned latencyUs) = nullptr;
+    long (*pcmWritei)(void* pcm, const void* buffer, unsigned long frames) = nullptr;
+    int (*pcmRecover)(void* pcm, int err, int silent) = nullptr;
+    int (*pcmDrain)(void* pcm) = nullptr;
+    int (*pcmClose)(void* pcm) = nullptr;
+    const char* (*strerror)(int err) = nullptr;
+    bool loaded = false;
+};
+
+const Alsa& alsa() {
+    static const Alsa api = [] {
+        Alsa a;
+        void* lib = dlopen("libasound.so.2", RTLD_NOW | RTLD_LOCAL);
+        if (!lib) {
+            return a;
+        }
+        auto load = [lib](auto& fn, const char* name) {
+            fn = reinterpret_cast<std::remove_reference_t<decltype(fn)>>(dlsym(lib, name));
+            return fn != nullptr;
+        };
+        a.loaded = load(a.pcmOpen, "snd_pcm_open") && load(a.pcmSetParams, "snd_pcm_set_params") &&
+                   load(a.pcmWritei, "snd_pcm_writei") && load(a.pcmRecover, "snd_pcm_recover") &&
+                   load(a.pcmDrain, "snd_pcm_drain") && load(a.pcmClose, "snd_pcm_close") &&
+                   load(a.strerror, "snd_strerror");
+        return a;   // the library stays loaded for the process
+    }();
+    return api;
+}
+
+void put16(std::FILE* f, std::uint16_t v) { std::fwrite(&v, 2, 1, f); }
+void put32(std::FILE* f, std::uint32_t v) { std::fwrite(&v, 4, 1, f); }
+
+// RIFF / WAVE, PCM, 16-bit stereo; the sizes are patched in at close().
+void writeWavHeader(std::FILE* f, int rate, std::uint32_t dataBytes) {
+    std::fwrite("RIFF", 1, 4, f);
+    put32(f, 36 + dataBytes);
+    std::fwrite("WAVEfmt ", 1, 8, f);
+    put32(f, 16);
+    put16(f, 1);                                   // PCM
+    put16(f, 2);                                   // channels
+    put32(f, static_cast<std::uint32_t>(rate));
+    put32(f, static_cast<std::uint32_t>(rate) * 4);
+    put16(f, 4);                                   // bytes per frame
+    put16(f, 16);
+    std::fwrite("data", 1, 4, f);
+    put32(f, dataBytes);
+}
+
+} // namespace
+
+const char* AudioDevice::name(Kind kind) {
+    switch (kind) {
+        case Kind::Alsa: return "ALSA";
+        case Kind::Wav: return "WAV file";
+        case Kind::Null: return "none";
+    }
+    return "?";
+}
+
+bool AudioDevice::open(Kind kind, int rate, int latencyFrames, const std::string& path) {
+    close();
+    kind_ = kind;
+    rate_ = rate;
+    xruns_ = 0;
+    framesWritten_ = 0;
+    start_ = std::chrono::steady_clock::now();
+    switch (kind) {
+        case Kind::Alsa: open_ = openAlsa(latencyFrames); break;
+        case Kind::Wav: open_ = openWav(path); break;
+        case Kind::Null: open_ = true; break;
+    }
+    return open_;
+}
+
+bool AudioDevice::openAlsa(int latencyFrames) {
+    const Alsa& a = alsa();
+    if (!a.loaded) {
+        std::cerr << "Audio: libasound.so.2 not found\n";
+        return false;
+    }
+    if (const int err = a.pcmOpen(&pcmHandle_, "default", kStreamPlayback, 0); err < 0) {
+        std::cerr << "Audio: can't open the ALSA device: " << a.strerror(err) << "\n";
+        pcmHandle_ = nullptr;
+        return false;
+    }
+    const unsigned latencyUs = static_cast<unsigned>(1000000.0 * latencyFrames / rate_);
+    if (const int err = a.pcmSetParams(pcmHandle_, kFormatS16LE, kAccessRwInterleaved, 2,
+                                       static_cast<unsigned>(rate_), 1, latencyUs);
+        err < 0) {
+        std::cerr << "Audio: ALSA refused 16-bit stereo at " << rate_ << " Hz: " << a.strerror(err) << "\n";
+        a.pcmClose(pcmHandle_);
+        pcmHandle_ = nullptr;
+        return false;
+    }
+    return true;
+}
+
+bool AudioDevice::openWav(const std::string& path) {
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) {
+        std::cerr << "Audio: can't create " << path << "\n";
+        return false;
+    }
+    dataBytes_ = 0;
+    writeWavHeader(file_, rate_, 0);
+    return true;
+}
+
+void AudioDevice::close() {
+    if (!open_) {
+        return;
+    }
+    if (pcmHandle_) {
+        alsa().pcmDrain(pcmHandle_);
+        alsa().pcmClose(pcmHandle_);
+        pcmHandle_ = nullptr;
+    }
+    if (file_) {
+        std::fseek(file_, 0, SEEK_SET);
+        writeWavHeader(file_, rate_, static_cast<std::uint32_t>(std::min<std::uint64_t>(dataBytes_, 0xffffffd0u)));
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+    open_ = false;
+}
+
+void AudioDevice::pace(std::size_t frames) {
+    framesWritten_ += frames;
+    // Stay one period ahead of real time at most, as a device's buffer would.
+    const auto due = start_ + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                  std::chrono::duration<double>(static_cast<double>(framesWritten_ - frames) / rate_));
+    std::this_thread::sleep_until(due);
+}
+
+bool AudioDevice::write(const float* frames, std::size_t count) {
+    if (!open_) {
+        return false;
+    }
+    if (kind_ == Kind::Null) {
+        pace(count);
+        return true;
+    }
+    pcm_.resize(count * 2);
+    for (std::size_t i = 0; i < count * 2; ++i) {
+        const float s = std::clamp(frames[i], -1.0f, 1.0f);
+        pcm_[i] = static_cast<std::int16_t>(s * 32767.0f);
+    }
+    if (kind_ == Kind::Wav) {
+        const std::size_t written = std::fwrite(pcm_.data(), 4, count, file_);
+        dataBytes_ += written * 4;
+        pace(count);
+        return written == count;
+    }
+
+    const Alsa& a = alsa();
+    const std::int16_t* at = pcm_.data();
+    std::size_t left = count;
+    while (left > 0) {
+        const long n = a.pcmWritei(pcmHandle_, at, left);
+        if (n < 0) {
+            // -EPIPE: it ran dry; -ESTRPIPE: suspended. recover() re-prepares the stream.
+            ++xruns_;
+            if (a.pcmRecover(pcmHandle_, static_cast<int>(n), 1) < 0) {
+                return false;
+            }
+            continue;
+        }
+        at += n * 2;
+        left -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
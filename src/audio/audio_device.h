@@ -0,0 +1,66 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// AudioDevice
+// -----------
+// Where the mixer's output goes: interleaved stereo float frames, one period at a time.
+// write() blocks until the output has room, and that is what paces the mixer thread
+// (audio/mixer.h): it mixes a period, hands it over, and sleeps in write() until the
+// next one is due.
+//
+// | Kind | Output                                                                    |
+// | ---- | ------------------------------------------------------------------------- |
+// | Alsa | the default ALSA device, 16-bit. libasound is loaded at run time (dlopen, |
+// |      | like the GL functions): the game links and runs on machines without it    |
+// | Wav  | a 16-bit WAV file (--audio-out=FILE), paced in real time like the device  |
+// | Null | nothing, paced in real time: the mixer runs the same without a sound card |
+//
+// open(Alsa) falls back to nothing: the caller decides whether Null will do.
+class AudioDevice {
+public:
+    enum class Kind : std::uint8_t { Alsa, Wav, Null };
+
+    AudioDevice() = default;
+    AudioDevice(const AudioDevice&) = delete;
+    AudioDevice& operator=(const AudioDevice&) = delete;
+    ~AudioDevice() { close(); }
+
+    // latencyFrames: how far ahead of the speaker the output may run (ALSA's buffer).
+    bool open(Kind kind, int rate, int latencyFrames, const std::string& path = std::string());
+    void close();
+    bool isOpen() const { return open_; }
+
+    // Mixer thread. Blocks while the output is full; false if the device failed.
+    bool write(const float* frames, std::size_t count);
+
+    Kind kind() const { return kind_; }
+    int rate() const { return rate_; }
+    static const char* name(Kind kind);
+    // Output the device had to recover from (ALSA: it ran dry, an underrun).
+    std::uint64_t xruns() const { return xruns_; }
+
+private:
+    bool openAlsa(int latencyFrames);
+    bool openWav(const std::string& path);
+    void pace(std::size_t frames);     // Wav / Null: sleep until these frames are due
+
+    Kind kind_ = Kind::Null;
+    bool open_ = false;
+    int rate_ = 48000;
+    std::vector<std::int16_t> pcm_;    // write()'s conversion, kept
+    std::uint64_t xruns_ = 0;
+    // Alsa
+    void* pcmHandle_ = nullptr;
+    // Wav
+    std::FILE* file_ = nullptr;
+    std::uint64_t dataBytes_ = 0;
+    // Wav / Null: when the next period is due
+    std::chrono::steady_clock::time_point start_;
+    std::uint64_t framesWritten_ = 0;
+};
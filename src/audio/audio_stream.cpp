@@ -0,0 +1,237 @@
+#include "audio/audio_stream.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include "profile/trace.h"
+
+namespace {
+
+std::uint32_t read32(const unsigned char* p) {
+    return std::uint32_t(p[0]) | std::uint32_t(p[1]) << 8 | std::uint32_t(p[2]) << 16 | std::uint32_t(p[3]) << 24;
+}
+std::uint16_t read16(const unsigned char* p) {
+    return static_cast<std::uint16_t>(p[0] | p[1] << 8);
+}
+
+bool fail(std::string* error, const std::string& why) {
+    if (error) *error = why;
+    return false;
+}
+
+} // namespace
+
+bool WavReader::open(const std::string& path, std::string* error) {
+    close();
+    file_ = std::fopen(path.c_str(), "rb");
+    if (!file_) {
+        return fail(error, "can't open " + path);
+    }
+    unsigned char riff[12];
+    if (std::fread(riff, 1, 12, file_) != 12 || std::memcmp(riff, "RIFF", 4) != 0 || std::memcmp(riff + 8, "WAVE", 4) != 0) {
+        close();
+        return fail(error, path + ": not a WAV file");
+    }
+    // Chunks until "data"; "fmt " must come before it.
+    int format = 0, bits = 0;
+    for (;;) {
+        unsigned char chunk[8];
+        if (std::fread(chunk, 1, 8, file_) != 8) {
+            close();
+            return fail(error, path + ": no data chunk");
+        }
+        const std::uint32_t size = read32(chunk + 4);
+        if (std::memcmp(chunk, "fmt ", 4) == 0 && size >= 16) {
+            unsigned char fmt[16];
+            if (std::fread(fmt, 1, 16, file_) != 16) break;
+            format = read16(fmt);
+            channels_ = read16(fmt + 2);
+            rate_ = static_cast<int>(read32(fmt + 4));
+            bits = read16(fmt + 14);
+            std::fseek(file_, static_cast<long>(size - 16 + (size & 1)), SEEK_CUR);
+        } else if (std::memcmp(chunk, "data", 4) == 0) {
+            isFloat_ = format == 3 && bits == 32;
+            if (!(format == 1 && bits == 16) && !isFloat_) {
+                close();
+                return fail(error, path + ": only 16-bit PCM and 32-bit float WAVs are read");
+            }
+            if (channels_ < 1 || channels_ > 2 || rate_ <= 0) {
+                close();
+                return fail(error, path + ": mono or stereo only");
+            }
+            dataOffset_ = std::ftell(file_);
+            frames_ = size / (static_cast<std::uint32_t>(channels_) * (bits / 8));
+            position_ = 0;
+            return true;
+        } else {
+            std::fseek(file_, static_cast<long>(size + (size & 1)), SEEK_CUR);
+        }
+    }
+    close();
+    return fail(error, path + ": truncated");
+}
+
+void WavReader::close() {
+    if (file_) {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+}
+
+void WavReader::rewind() {
+    if (file_) {
+        std::fseek(file_, dataOffset_, SEEK_SET);
+        position_ = 0;
+    }
+}
+
+std::size_t WavReader::read(float* stereo, std::size_t count) {
+    if (!file_) {
+        return 0;
+    }
+    count = static_cast<std::size_t>(std::min<std::uint64_t>(count, frames_ - position_));
+    const std::size_t sampleBytes = isFloat_ ? 4 : 2;
+    const std::size_t frameBytes = sampleBytes * static_cast<std::size_t>(channels_);
+    raw_.resize(count * frameBytes);
+    const std::size_t got = std::fread(raw_.data(), frameBytes, count, file_);
+    position_ += got;
+    for (std::size_t i = 0; i < got; ++i) {
+        float s[2] = {};
+        for (int c = 0; c < channels_; ++c) {
+            const unsigned char* p = raw_.data() + i * frameBytes + static_cast<std::size_t>(c) * sampleBytes;
+            if (isFloat_) {
+                const std::uint32_t bits = read32(p);
+                std::memcpy(&s[c], &bits, 4);
+            } else {
+                s[c] = static_cast<float>(static_cast<std::int16_t>(read16(p))) * (1.0f / 32768.0f);
+            }
+        }
+        stereo[2 * i] = s[0];
+        stereo[2 * i + 1] = channels_ == 2 ? s[1] : s[0];
+    }
+    return got;
+}
+
+bool AudioStream::open(const std::string& path, int rate, bool loop, std::string* error) {
+    close();
+    if (!reader_.open(path, error)) {
+        return false;
+    }
+    rate_ = rate;
+    loop_ = loop;
+    step_ = static_cast<double>(reader_.rate()) / rate;
+    phase_ = 0.0;
+    source_.clear();
+    sourceAt_ = 0;
+    sourceEnded_ = false;
+    ring_.reset(new float[kRingFrames * 2]);
+    head_.store(0, std::memory_order_relaxed);
+    tail_.store(0, std::memory_order_relaxed);
+    stopping_.store(false, std::memory_order_relaxed);
+    ended_.store(false, std::memory_order_relaxed);
+    finished_.store(false, std::memory_order_relaxed);
+    underruns_.store(0, std::memory_order_relaxed);
+
+    // Fill the ring here, so the first periods the mixer asks for are all there.
+    std::size_t tail = 0;
+    while (tail < kRingFrames && !sourceEnded_) {
+        tail += decode(ring_.get() + tail * 2, std::min(kDecodeFrames, kRingFrames - tail));
+    }
+    tail_.store(tail, std::memory_order_release);
+    ended_.store(sourceEnded_, std::memory_order_release);
+    decoder_ = std::thread(&AudioStream::decodeLoop, this);
+    return true;
+}
+
+void AudioStream::close() {
+    if (decoder_.joinable()) {
+        stopping_.store(true, std::memory_order_release);
+        decoder_.join();
+    }
+    reader_.close();
+}
+
+std::size_t AudioStream::decode(float* stereo, std::size_t count) {
+    // Linear interpolation between source frames sourceAt_ and sourceAt_ + 1; source_
+    // is refilled a block at a time (the unconsumed frames kept at its front).
+    std::size_t out = 0;
+    while (out < count && !sourceEnded_) {
+        while (sourceAt_ + 2 > source_.size() / 2) {
+            // Downsampling can step past what was read: drop what's consumed, read on.
+            const std::size_t consumed = std::min(sourceAt_, source_.size() / 2);
+            source_.erase(source_.begin(), source_.begin() + static_cast<std::ptrdiff_t>(consumed * 2));
+            sourceAt_ -= consumed;
+            const std::size_t have = source_.size() / 2;
+            source_.resize((have + kDecodeFrames) * 2);
+            std::size_t got = reader_.read(source_.data() + have * 2, kDecodeFrames);
+            if (got == 0 && loop_) {
+                reader_.rewind();
+                got = reader_.read(source_.data() + have * 2, kDecodeFrames);
+            }
+            source_.resize((have + got) * 2);
+            if (got == 0) {
+                sourceEnded_ = true;    // the track's very last frame isn't blended: inaudible
+                break;
+            }
+        }
+        if (sourceEnded_) {
+            break;
+        }
+        const float* a = &source_[sourceAt_ * 2];
+        const float t = static_cast<float>(phase_);
+        stereo[out * 2] = a[0] + (a[2] - a[0]) * t;
+        stereo[out * 2 + 1] = a[1] + (a[3] - a[1]) * t;
+        ++out;
+        phase_ += step_;
+        const std::size_t advance = static_cast<std::size_t>(phase_);
+        phase_ -= static_cast<double>(advance);
+        sourceAt_ += advance;
+    }
+    return out;
+}
+
+void AudioStream::decodeLoop() {
+    trace::setThreadName("audio decode");
+    while (!stopping_.load(std::memory_order_acquire)) {
+        const std::size_t tail = tail_.load(std::memory_order_relaxed);
+        const std::size_t head = head_.load(std::memory_order_acquire);
+        const std::size_t free = kRingFrames - (tail - head);
+        if (ended_.load(std::memory_order_relaxed) || free < kDecodeFrames) {
+            // A full ring lasts ~0.7 s: a few wakeups per second keep it topped up.
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            continue;
+        }
+        // In at most two pieces: the ring wraps.
+        const std::size_t at = tail & (kRingFrames - 1);
+        const std::size_t first = std::min(kDecodeFrames, kRingFrames - at);
+        std::size_t written = decode(ring_.get() + at * 2, first);
+        if (written == first && first < kDecodeFrames && !sourceEnded_) {
+            written += decode(ring_.get(), kDecodeFrames - first);
+        }
+        tail_.store(tail + written, std::memory_order_release);
+        if (sourceEnded_) {
+            ended_.store(true, std::memory_order_release);
+        }
+    }
+}
+
+std::size_t AudioStream::mix(float* left, float* right, std::size_t count, float gain) {
+    const std::size_t head = head_.load(std::memory_order_relaxed);
+    const std::size_t tail = tail_.load(std::memory_order_acquire);
+    const std::size_t available = std::min(count, tail - head);
+    for (std::size_t i = 0; i < available; ++i) {
+        const float* frame = ring_.get() + ((head + i) & (kRingFrames - 1)) * 2;
+        left[i] += frame[0] * gain;
+        right[i] += frame[1] * gain;
+    }
+    head_.store(head + available, std::memory_order_release);
+    if (available < count) {
+        if (ended_.load(std::memory_order_acquire)) {
+            finished_.store(true, std::memory_order_release);
+        } else {
+            underruns_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    return available;
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// WavReader
+// ---------
+// Blocks of a WAV file (RIFF; PCM 16-bit or IEEE float 32-bit; mono or stereo) as
+// interleaved stereo float, read from disk as they are asked for. Blocking file I/O:
+// never on the mixer thread.
+class WavReader {
+public:
+    WavReader() = default;
+    WavReader(const WavReader&) = delete;
+    WavReader& operator=(const WavReader&) = delete;
+    ~WavReader() { close(); }
+
+    bool open(const std::string& path, std::string* error = nullptr);
+    void close();
+
+    int rate() const { return rate_; }
+    int channels() const { return channels_; }
+    std::uint64_t frames() const { return frames_; }
+
+    // Up to `count` frames into stereo[0 .. 2 * count) (mono is duplicated); 0 at the end.
+    std::size_t read(float* stereo, std::size_t count);
+    void rewind();
+
+private:
+    std::FILE* file_ = nullptr;
+    int rate_ = 0;
+    int channels_ = 0;
+    bool isFloat_ = false;
+    long dataOffset_ = 0;
+    std::uint64_t frames_ = 0;
+    std::uint64_t position_ = 0;
+    std::vector<unsigned char> raw_;
+};
+
+// AudioStream
+// -----------
+// A long track (music, ambience) played while it is decoded: a decode thread keeps a
+// ring of kRingFrames stereo frames (~0.7 s at 48 kHz) topped up, the mixer thread takes
+// from it. The file is never all in memory, and the mixer never waits on the disk.
+//
+//     decode thread: WavReader block → resample to the mixer's rate → ring (writes tail)
+//     mixer thread:  ring (reads head) → mixed in with the stream's gain
+//
+// The ring is single-producer / single-consumer with one atomic index per side, like
+// SpscRing (core/spsc_ring.h), but moves whole blocks of frames. If it ever runs dry the
+// mixer plays silence for what is missing and counts an underrun, rather than waiting.
+//
+// Rates other than the mixer's are linearly resampled on the decode thread.
+class AudioStream {
+public:
+    static constexpr std::size_t kRingFrames = 32768;     // power of two
+    static constexpr std::size_t kDecodeFrames = 4096;    // per WavReader::read
+
+    AudioStream() = default;
+    AudioStream(const AudioStream&) = delete;
+    AudioStream& operator=(const AudioStream&) = delete;
+    ~AudioStream() { close(); }
+
+    // Starts decoding (the ring is filled before this returns, so playback starts clean).
+    bool open(const std::string& path, int rate, bool loop, std::string* error = nullptr);
+    void close();
+    bool isOpen() const { return decoder_.joinable(); }
+
+    // Mixer thread: adds `count` frames, times gain, into left[] and right[]. Returns the
+    // frames that were there; the rest were an underrun.
+    std::size_t mix(float* left, float* right, std::size_t count, float gain);
+    // The whole track has been played (never, when looping).
+    bool finished() const { return finished_.load(std::memory_order_acquire); }
+
+    std::uint64_t underruns() const { return underruns_.load(std::memory_order_relaxed); }
+
+private:
+    void decodeLoop();
+    std::size_t decode(float* stereo, std::size_t count);  // resampled
+
+    WavReader reader_;
+    int rate_ = 48000;
+    bool loop_ = false;
+    double step_ = 1.0;                // source frames per output frame
+    double phase_ = 0.0;               // between source[0] and source[1] of the window
+    std::vector<float> source_;        // decoded source frames not consumed yet
+    std::size_t sourceAt_ = 0;
+    bool sourceEnded_ = false;
+
+    std::unique_ptr<float[]> ring_;    // kRingFrames stereo frames
+    alignas(64) std::atomic<std::size_t> head_{0};   // mixer
+    alignas(64) std::atomic<std::size_t> tail_{0};   // decoder
+    std::atomic<bool> stopping_{false};
+    std::atomic<bool> ended_{false};   // the decoder wrote its last frame
+    std::atomic<bool> finished_{false};
+    std::atomic<std::uint64_t> underruns_{0};
+    std::thread decoder_;
+};
@@ -0,0 +1,264 @@
+#include "audio/mixer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <xmmintrin.h>
+#endif
+
+#include "core/thread_affinity.h"
+#include "profile/trace.h"
+
+namespace {
+
+// dst[i] += src[i] * (gain + step * i), i < n (n a multiple of 8).
+void mixRamp(float* dst, const float* src, std::size_t n, float gain, float step) {
+#if defined(__AVX__)
+    __m256 g = _mm256_add_ps(_mm256_set1_ps(gain),
+                             _mm256_mul_ps(_mm256_set_ps(7, 6, 5, 4, 3, 2, 1, 0), _mm256_set1_ps(step)));
+    const __m256 g8 = _mm256_set1_ps(step * 8.0f);
+    for (std::size_t i = 0; i < n; i += 8) {
+        const __m256 s = _mm256_loadu_ps(src + i);
+        _mm256_storeu_ps(dst + i, _mm256_add_ps(_mm256_loadu_ps(dst + i), _mm256_mul_ps(s, g)));
+        g = _mm256_add_ps(g, g8);
+    }
+#elif defined(__SSE2__)
+    __m128 g = _mm_add_ps(_mm_set1_ps(gain), _mm_mul_ps(_mm_set_ps(3, 2, 1, 0), _mm_set1_ps(step)));
+    const __m128 g4 = _mm_set1_ps(step * 4.0f);
+    for (std::size_t i = 0; i < n; i += 4) {
+        const __m128 s = _mm_loadu_ps(src + i);
+        _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(s, g)));
+        g = _mm_add_ps(g, g4);
+    }
+#else
+    for (std::size_t i = 0; i < n; ++i) {
+        dst[i] += src[i] * (gain + step * static_cast<float>(i));
+    }
+#endif
+}
+
+// out[2i] = left[i] * g, out[2i + 1] = right[i] * g, g ramping like mixRamp's.
+void interleave(float* out, const float* left, const float* right, std::size_t n, float gain, float step) {
+#if defined(__SSE2__)
+    __m128 g = _mm_add_ps(_mm_set1_ps(gain), _mm_mul_ps(_mm_set_ps(3, 2, 1, 0), _mm_set1_ps(step)));
+    const __m128 g4 = _mm_set1_ps(step * 4.0f);
+    for (std::size_t i = 0; i < n; i += 4) {
+        const __m128 l = _mm_mul_ps(_mm_loadu_ps(left + i), g);
+        const __m128 r = _mm_mul_ps(_mm_loadu_ps(right + i), g);
+        _mm_storeu_ps(out + 2 * i, _mm_unpacklo_ps(l, r));
+        _mm_storeu_ps(out + 2 * i + 4, _mm_unpackhi_ps(l, r));
+        g = _mm_add_ps(g, g4);
+    }
+#else
+    for (std::size_t i = 0; i < n; ++i) {
+        const float g = gain + step * static_cast<float>(i);
+        out[2 * i] = left[i] * g;
+        out[2 * i + 1] = right[i] * g;
+    }
+#endif
+}
+
+// Constant-power pan: the sum of the squares stays `gain` squared.
+void panGains(float gain, float pan, float& left, float& right) {
+    const float angle = (std::clamp(pan, -1.0f, 1.0f) + 1.0f) * 0.78539816f;   // 0 .. pi/2
+    left = gain * std::cos(angle);
+    right = gain * std::sin(angle);
+}
+
+} // namespace
+
+AudioMixer::AudioMixer() : commands_(std::make_unique<SpscRing<Command, kCommandCapacity>>()) {}
+
+AudioMixer::~AudioMixer() {
+    stop();
+}
+
+SoundId AudioMixer::add(Sound sound) {
+    if (sound.length == 0 && !sound.samples.empty()) {
+        sound.pad();
+    }
+    sounds_.push_back(std::move(sound));
+    return static_cast<SoundId>(sounds_.size() - 1);
+}
+
+void AudioMixer::setStream(std::unique_ptr<AudioStream> stream, float gain) {
+    stream_ = std::move(stream);
+    streamGain_ = gain;
+}
+
+bool AudioMixer::start(const Settings& settings) {
+    stop();
+    settings_ = settings;
+    settings_.periodFrames = std::max(8, (settings.periodFrames + 7) / 8 * 8);
+    settings_.voices = std::max(1, settings.voices);
+    if (!device_.open(settings_.device, settings_.rate, settings_.periodFrames * std::max(2, settings_.latencyPeriods),
+                      settings_.wavPath)) {
+        return false;
+    }
+    const std::size_t period = static_cast<std::size_t>(settings_.periodFrames);
+    voices_.assign(static_cast<std::size_t>(settings_.voices), Voice{});
+    left_.assign(period, 0.0f);
+    right_.assign(period, 0.0f);
+    out_.assign(period * 2, 0.0f);
+    master_ = masterTarget_;
+    stopping_.store(false, std::memory_order_relaxed);
+    thread_ = std::thread(&AudioMixer::threadMain, this);
+    return true;
+}
+
+void AudioMixer::stop() {
+    if (thread_.joinable()) {
+        stopping_.store(true, std::memory_order_release);
+        thread_.join();
+    }
+    device_.close();
+    if (stream_) {
+        stream_->close();
+    }
+}
+
+VoiceId AudioMixer::play(SoundId sound, float gain, float pan) {
+    if (sound >= sounds_.size()) {
+        return 0;
+    }
+    const VoiceId id = nextVoice_++;
+    if (!commands_->push(Command{Command::Type::Play, sound, id, gain, pan})) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return 0;
+    }
+    return id;
+}
+
+void AudioMixer::stop(VoiceId voice) {
+    if (voice != 0 && !commands_->push(Command{Command::Type::Stop, 0, voice, 0.0f, 0.0f})) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void AudioMixer::setMasterGain(float gain) {
+    if (!commands_->push(Command{Command::Type::MasterGain, 0, 0, gain, 0.0f})) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void AudioMixer::apply(const Command& command) {
+    switch (command.type) {
+        case Command::Type::Play: {
+            Voice* voice = nullptr;
+            for (Voice& v : voices_) {
+                if (!v.sound) {
+                    voice = &v;
+                    break;
+                }
+                if (!voice || v.started < voice->started) {
+                    voice = &v;   // the oldest so far, if none is free
+                }
+            }
+            if (voice->sound) {
+                stolen_.fetch_add(1, std::memory_order_relaxed);
+            }
+            *voice = Voice{};
+            voice->sound = &sounds_[command.sound];
+            voice->id = command.voice;
+            voice->started = ++startedCount_;
+            panGains(command.gain, command.pan, voice->targetLeft, voice->targetRight);
+            // Sounds start at their own attack: no ramp in.
+            voice->left = voice->targetLeft;
+            voice->right = voice->targetRight;
+            played_.fetch_add(1, std::memory_order_relaxed);
+            break;
+        }
+        case Command::Type::Stop:
+            for (Voice& v : voices_) {
+                if (v.sound && v.id == command.voice) {
+                    v.targetLeft = v.targetRight = 0.0f;
+                    v.stopping = true;
+                }
+            }
+            break;
+        case Command::Type::MasterGain:
+            masterTarget_ = command.gain;
+            break;
+    }
+}
+
+void AudioMixer::mixPeriod() {
+    const std::size_t period = left_.size();
+    const float inverse = 1.0f / static_cast<float>(period);
+    std::fill(left_.begin(), left_.end(), 0.0f);
+    std::fill(right_.begin(), right_.end(), 0.0f);
+
+    std::uint32_t active = 0;
+    for (Voice& v : voices_) {
+        if (!v.sound) {
+            continue;
+        }
+        const Sound& sound = *v.sound;
+        // Whole vectors: the samples are padded, and positions advance by whole periods.
+        const std::size_t n = std::min(period, sound.samples.size() - v.position);
+        const float* samples = sound.samples.data() + v.position;
+        mixRamp(left_.data(), samples, n, v.left, (v.targetLeft - v.left) * inverse);
+        mixRamp(right_.data(), samples, n, v.right, (v.targetRight - v.right) * inverse);
+        v.left = v.targetLeft;
+        v.right = v.targetRight;
+        v.position += n;
+        if (v.position >= sound.length || v.stopping) {
+            v.sound = nullptr;
+        } else {
+            ++active;
+        }
+    }
+    if (stream_ && stream_->isOpen() && !stream_->finished()) {
+        stream_->mix(left_.data(), right_.data(), period, streamGain_);
+    }
+    interleave(out_.data(), left_.data(), right_.data(), period, master_, (masterTarget_ - master_) * inverse);
+    master_ = masterTarget_;
+    active_.store(active, std::memory_order_relaxed);
+}
+
+void AudioMixer::threadMain() {
+    trace::setThreadName("audio mixer");
+    affinity::pinThisThread(affinity::Role::Audio);
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point windowStart = Clock::now();
+    float slowest = 0.0f;
+    while (!stopping_.load(std::memory_order_acquire)) {
+        const Clock::time_point begin = Clock::now();
+        Command command;
+        while (commands_->pop(command)) {
+            apply(command);
+        }
+        mixPeriod();
+        const Clock::time_point end = Clock::now();
+        slowest = std::max(slowest, std::chrono::duration<float, std::micro>(end - begin).count());
+        if (end - windowStart >= std::chrono::seconds(1)) {
+            mixMicros_.store(slowest, std::memory_order_relaxed);
+            slowest = 0.0f;
+            windowStart = end;
+        }
+        periods_.fetch_add(1, std::memory_order_relaxed);
+        if (!device_.write(out_.data(), left_.size())) {
+            std::cerr << "Audio: the device stopped taking output\n";
+            break;
+        }
+        xruns_.store(device_.xruns(), std::memory_order_relaxed);
+    }
+}
+
+AudioMixer::Stats AudioMixer::stats() const {
+    Stats stats;
+    stats.played = played_.load(std::memory_order_relaxed);
+    stats.dropped = dropped_.load(std::memory_order_relaxed);
+    stats.stolen = stolen_.load(std::memory_order_relaxed);
+    stats.periods = periods_.load(std::memory_order_relaxed);
+    stats.xruns = xruns_.load(std::memory_order_relaxed);
+    stats.streamUnderruns = stream_ ? stream_->underruns() : 0;
+    stats.voices = active_.load(std::memory_order_relaxed);
+    stats.mixMicros = mixMicros_.load(std::memory_order_relaxed);
+    return stats;
+}
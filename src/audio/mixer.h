@@ -0,0 +1,139 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "audio/audio_device.h"
+#include "audio/audio_stream.h"
+#include "audio/sound.h"
+#include "core/spsc_ring.h"
+
+using SoundId = std::uint32_t;
+using VoiceId = std::uint32_t;         // 0: none (the command was dropped)
+
+// AudioMixer
+// ----------
+// Sound effects and one streamed track, mixed on their own thread and written to an
+// AudioDevice (audio/audio_device.h) a period at a time. The game thread never mixes,
+// never locks and never waits: play() is one push onto a lock-free ring.
+//
+//     game thread                  mixer thread (every periodFrames, ~5 ms at 48 kHz)
+//     play / stop / gain ──ring──▶ drain commands → voices
+//                                  mix every voice into planar L / R (SIMD)
+//                                  + the stream's ring (audio/audio_stream.h)
+//                                  master gain, interleave ─▶ device.write (blocks: pacing)
+//
+// | Piece        | How                                                                |
+// | ------------ | ------------------------------------------------------------------ |
+// | commands     | SpscRing (core/spsc_ring.h) of kCommandCapacity; full: the command |
+// |              | is dropped and counted, the game thread never blocks               |
+// | voices       | a fixed pool (Settings::voices). Full: the OLDEST voice is stolen  |
+// |              | (its sound has decayed the most, so the cut is the least audible)  |
+// | mixing       | per voice, period-long runs of mono samples times a gain ramp, into |
+// |              | left and right: 8 (__AVX__) or 4 (__SSE2__) samples per iteration  |
+// | gain changes | ramped over one period (stop, pan, master): no clicks              |
+// | sounds       | registered with add() BEFORE start(), immutable while it runs, so  |
+// |              | the mixer reads them without synchronization                        |
+//
+// Sounds are padded to a multiple of 8 samples and periods are a multiple of 8 frames,
+// so every run the SIMD loop sees is whole vectors.
+class AudioMixer {
+public:
+    static constexpr std::size_t kCommandCapacity = 4096;
+
+    struct Settings {
+        AudioDevice::Kind device = AudioDevice::Kind::Alsa;
+        std::string wavPath;           // Kind::Wav
+        int rate = 48000;
+        int periodFrames = 256;        // rounded up to a multiple of 8
+        int latencyPeriods = 4;        // the device's buffer
+        int voices = 64;
+    };
+
+    struct Stats {
+        std::uint64_t played = 0;      // voices started
+        std::uint64_t dropped = 0;     // commands lost to a full ring
+        std::uint64_t stolen = 0;      // voices cut short for a new one
+        std::uint64_t periods = 0;
+        std::uint64_t xruns = 0;       // the device ran dry (the mixer was late)
+        std::uint64_t streamUnderruns = 0;
+        std::uint32_t voices = 0;      // playing, as of the last period
+        float mixMicros = 0.0f;        // the slowest period of the last second
+    };
+
+    AudioMixer();
+    ~AudioMixer();
+    AudioMixer(const AudioMixer&) = delete;
+    AudioMixer& operator=(const AudioMixer&) = delete;
+
+    // Before start(). The sound must be at the rate start() will use.
+    SoundId add(Sound sound);
+    // Before start(): the track mixed in under the effects, at `gain`.
+    void setStream(std::unique_ptr<AudioStream> stream, float gain);
+
+    // Opens the device and starts the mixer thread.
+    bool start(const Settings& settings);
+    void stop();
+    bool running() const { return thread_.joinable(); }
+    const char* deviceName() const { return AudioDevice::name(device_.kind()); }
+
+    // Game thread (one thread: the ring has one producer). pan: -1 left .. 1 right.
+    VoiceId play(SoundId sound, float gain = 1.0f, float pan = 0.0f);
+    void stop(VoiceId voice);
+    void setMasterGain(float gain);
+
+    Stats stats() const;
+
+private:
+    struct Command {
+        enum class Type : std::uint8_t { Play, Stop, MasterGain };
+        Type type;
+        SoundId sound;
+        VoiceId voice;
+        float gain;
+        float pan;
+    };
+    struct Voice {
+        const Sound* sound = nullptr;  // nullptr: free
+        VoiceId id = 0;
+        std::size_t position = 0;
+        std::uint64_t started = 0;     // for stealing the oldest
+        float left = 0.0f, right = 0.0f;             // gains now
+        float targetLeft = 0.0f, targetRight = 0.0f; // by the end of this period
+        bool stopping = false;         // free once the ramp to 0 has played
+    };
+
+    void threadMain();
+    void apply(const Command& command);
+    void mixPeriod();
+
+    std::vector<Sound> sounds_;
+    std::unique_ptr<AudioStream> stream_;
+    float streamGain_ = 1.0f;
+    Settings settings_;
+    AudioDevice device_;
+    std::unique_ptr<SpscRing<Command, kCommandCapacity>> commands_;
+    std::thread thread_;
+    std::atomic<bool> stopping_{false};
+    VoiceId nextVoice_ = 1;            // game thread
+
+    // Mixer thread only.
+    std::vector<Voice> voices_;
+    std::vector<float> left_, right_, out_;   // planar accumulators, interleaved output
+    float master_ = 1.0f, masterTarget_ = 1.0f;
+    std::uint64_t startedCount_ = 0;
+
+    // Written by the mixer thread (dropped_: the game thread), read by stats().
+    std::atomic<std::uint64_t> played_{0};
+    std::atomic<std::uint64_t> dropped_{0};
+    std::atomic<std::uint64_t> stolen_{0};
+    std::atomic<std::uint64_t> periods_{0};
+    std::atomic<std::uint64_t> xruns_{0};
+    std::atomic<std::uint32_t> active_{0};
+    std::atomic<float> mixMicros_{0.0f};
+};
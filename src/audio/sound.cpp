@@ -0,0 +1,65 @@
+#include "audio/sound.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "audio/audio_stream.h"
+
+namespace {
+constexpr float kTwoPi = 6.2831853f;
+} // namespace
+
+Sound synthTock(int rate, float hz, float seconds) {
+    Sound sound;
+    const std::size_t n = static_cast<std::size_t>(seconds * static_cast<float>(rate));
+    sound.samples.resize(n);
+    float phase = 0.0f;
+    for (std::size_t i = 0; i < n; ++i) {
+        const float t = static_cast<float>(i) / static_cast<float>(rate);
+        const float f = hz * (0.5f + 0.5f * std::exp(-t * 40.0f));     // the pitch drops
+        phase += kTwoPi * f / static_cast<float>(rate);
+        const float attack = std::min(1.0f, static_cast<float>(i) / (0.002f * static_cast<float>(rate)));
+        sound.samples[i] = std::sin(phase) * attack * std::exp(-t * 60.0f);
+    }
+    sound.pad();
+    return sound;
+}
+
+Sound synthBlip(int rate, float hz, float seconds) {
+    Sound sound;
+    const std::size_t n = static_cast<std::size_t>(seconds * static_cast<float>(rate));
+    sound.samples.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        const float t = static_cast<float>(i) / static_cast<float>(rate);
+        // Soft squares: a sine through tanh, so the edges don't alias into a buzz.
+        const float a = std::tanh(4.0f * std::sin(kTwoPi * hz * t));
+        const float b = std::tanh(4.0f * std::sin(kTwoPi * hz * 1.5f * t));
+        const float envelope = std::min(1.0f, t / 0.003f) * std::max(0.0f, 1.0f - t / seconds);
+        sound.samples[i] = 0.35f * (a + b) * envelope;
+    }
+    sound.pad();
+    return sound;
+}
+
+bool loadWavSound(const std::string& path, int rate, Sound& out, std::string* error) {
+    WavReader reader;
+    if (!reader.open(path, error)) {
+        return false;
+    }
+    std::vector<float> stereo(static_cast<std::size_t>(reader.frames()) * 2);
+    const std::size_t frames = reader.read(stereo.data(), static_cast<std::size_t>(reader.frames()));
+    const double step = static_cast<double>(reader.rate()) / rate;
+    const std::size_t n = frames < 2 ? frames : static_cast<std::size_t>(static_cast<double>(frames - 1) / step) + 1;
+    out.samples.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        const double at = static_cast<double>(i) * step;
+        const std::size_t k = std::min(static_cast<std::size_t>(at), frames - 1);
+        const std::size_t k1 = std::min(k + 1, frames - 1);
+        const float t = static_cast<float>(at - static_cast<double>(k));
+        const float a = 0.5f * (stereo[2 * k] + stereo[2 * k + 1]);
+        const float b = 0.5f * (stereo[2 * k1] + stereo[2 * k1 + 1]);
+        out.samples[i] = a + (b - a) * t;
+    }
+    out.pad();
+    return true;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Sound
+// -----
+// A short effect, fully decoded: mono float samples at the mixer's rate, padded with
+// silence to a multiple of kSoundPadding so the mixer's SIMD loop never needs a tail.
+// Long tracks are streamed instead (audio/audio_stream.h).
+struct Sound {
+    static constexpr std::size_t kSoundPadding = 8;
+
+    std::vector<float> samples;
+    std::size_t length = 0;            // samples before the padding
+
+    void pad() {
+        length = samples.size();
+        samples.resize((length + kSoundPadding - 1) / kSoundPadding * kSoundPadding, 0.0f);
+    }
+};
+
+// Generated sounds
+// ----------------
+// There are no sound files yet, so the effects are synthesized, like the sprites:
+//
+// | Function    | Sound                                                               |
+// | ----------- | ------------------------------------------------------------------- |
+// | synthTock   | a short knock: a sine dropping from `hz` to half of it, fast decay  |
+// | synthBlip   | a UI blip: two square-ish tones a fifth apart                        |
+Sound synthTock(int rate, float hz, float seconds = 0.06f);
+Sound synthBlip(int rate, float hz, float seconds = 0.09f);
+
+// WAV (RIFF PCM 16-bit or float 32-bit, mono or stereo) decoded to the mixer's rate:
+// stereo is averaged down, other rates are linearly resampled. For effects; use
+// WavStream for anything long.
+bool loadWavSound(const std::string& path, int rate, Sound& out, std::string* error = nullptr);
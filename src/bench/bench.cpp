@@ -0,0 +1,236 @@
+#include "bench/bench.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ostream>
+
+#include "core/alloc_counter.h"
+
+bool parseBenchOption(const char* arg, BenchOptions& options) {
+    if (std::strcmp(arg, "--bench") == 0) {
+        options.enabled = true;
+    } else if (std::strncmp(arg, "--bench-quads=", 14) == 0) {
+        options.quads = std::max(1, std::atoi(arg + 14));
+    } else if (std::strncmp(arg, "--bench-frames=", 15) == 0) {
+        options.frames = std::max(1, std::atoi(arg + 15));
+    } else if (std::strncmp(arg, "--bench-warmup=", 15) == 0) {
+        options.warmup = std::max(0, std::atoi(arg + 15));
+    } else if (std::strncmp(arg, "--bench-world=", 14) == 0) {
+        options.world = std::max(1.0f, static_cast<float>(std::atof(arg + 14)));
+    } else if (std::strcmp(arg, "--bench-cull") == 0 || std::strcmp(arg, "--bench-cull=linear") == 0) {
+        options.cull = BenchCull::Linear;
+    } else if (std::strcmp(arg, "--bench-cull=grid") == 0) {
+        options.cull = BenchCull::Grid;
+    } else if (std::strcmp(arg, "--bench-cull=quadtree") == 0) {
+        options.cull = BenchCull::Quadtree;
+    } else if (std::strcmp(arg, "--bench-zero-alloc") == 0) {
+        options.zeroAlloc = true;
+    } else if (std::strcmp(arg, "--bench-path=instanced") == 0) {
+        options.path = BenchPath::Instanced;
+    } else if (std::strcmp(arg, "--bench-path=affine") == 0) {
+        options.path = BenchPath::Affine;
+    } else if (std::strcmp(arg, "--bench-path=layered") == 0) {
+        options.path = BenchPath::Layered;
+    } else if (std::strcmp(arg, "--bench-path=batched") == 0) {
+        options.path = BenchPath::Batched;
+    } else if (std::strcmp(arg, "--bench-scene=moving") == 0) {
+        options.scene = BenchSceneKind::Moving;
+    } else if (std::strcmp(arg, "--bench-scene=static") == 0) {
+        options.scene = BenchSceneKind::Static;
+    } else if (std::strcmp(arg, "--bench-scene=overlap") == 0) {
+        options.scene = BenchSceneKind::Overlap;
+    } else if (std::strcmp(arg, "--bench-scene=tilemap") == 0) {
+        options.scene = BenchSceneKind::Tilemap;
+    } else if (std::strcmp(arg, "--bench-scene=particles") == 0) {
+        options.scene = BenchSceneKind::Particles;
+    } else if (std::strncmp(arg, "--bench-tiles=", 14) == 0) {
+        int w = 0, h = 0;
+        if (std::sscanf(arg + 14, "%dx%d", &w, &h) != 2 || w < 1 || h < 1) {
+            return false;
+        }
+        options.tilesX = w;
+        options.tilesY = h;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* benchPathName(BenchPath path) {
+    switch (path) {
+        case BenchPath::Instanced: return "instanced";
+        case BenchPath::Affine:    return "affine";
+        case BenchPath::Layered:   return "layered";
+        case BenchPath::Batched:   return "batched";
+    }
+    return "?";
+}
+
+const char* benchCullName(BenchCull cull) {
+    switch (cull) {
+        case BenchCull::None:   return "none";
+        case BenchCull::Linear: return "linear";
+        case BenchCull::Grid:   return "grid";
+        case BenchCull::Quadtree: return "quadtree";
+    }
+    return "?";
+}
+
+const char* benchSceneName(BenchSceneKind scene) {
+    switch (scene) {
+        case BenchSceneKind::Moving:    return "moving";
+        case BenchSceneKind::Static:    return "static";
+        case BenchSceneKind::Overlap:   return "overlap";
+        case BenchSceneKind::Tilemap:   return "tilemap";
+        case BenchSceneKind::Particles: return "particles";
+    }
+    return "?";
+}
+
+int benchSceneQuads(const BenchOptions& options) {
+    return options.scene == BenchSceneKind::Tilemap || options.scene == BenchSceneKind::Particles ? 0
+                                                                                                 : options.quads;
+}
+
+void BenchScene::init(int quadCount, float aspect, float worldScreens, BenchSceneKind kind, std::uint32_t seed) {
+    kind_ = kind;
+    placed_ = false;
+    base_.resize(quadCount);
+    phase_.resize(quadCount);
+    transforms_.resize(quadCount);
+    panExtent_ = glm::vec2(aspect * worldScreens - aspect, worldScreens - 1.0f); // view stays inside the world
+    if (quadCount == 0) {
+        return;
+    }
+
+    // Square-ish grid over the world; quads sized to ~80% of a cell.
+    const float halfW = aspect * worldScreens;
+    const float halfH = worldScreens;
+    const int columns = std::max(1, static_cast<int>(std::ceil(std::sqrt(quadCount * aspect))));
+    const int rows = (quadCount + columns - 1) / columns;
+    const float cellW = 2.0f * halfW / columns;
+    const float cellH = 2.0f * halfH / rows;
+    scale_ = 0.8f * std::min(cellW, cellH) / 0.5f; // main()'s quad is 0.5 wide
+
+    BenchRng rng{seed};
+    if (kind == BenchSceneKind::Overlap) {
+        // Anywhere in the middle half of the view (where the camera stays: it doesn't pan
+        // off them), each a fifth of the screen's height: the pile deepens with N.
+        scale_ = 0.4f / 0.5f;
+        for (int i = 0; i < quadCount; ++i) {
+            const float x = rng.next() - 0.5f;
+            const float y = rng.next() - 0.5f;
+            base_[i] = glm::vec2(x * aspect, y);
+            phase_[i] = rng.next() * 6.2831853f;
+        }
+        return;
+    }
+    for (int i = 0; i < quadCount; ++i) {
+        const int cx = i % columns;
+        const int cy = i / columns;
+        base_[i] = glm::vec2(-halfW + (cx + 0.5f) * cellW, -halfH + (cy + 0.5f) * cellH);
+        phase_[i] = rng.next() * 6.2831853f;
+    }
+}
+
+void BenchScene::update(std::uint64_t frame) {
+    if (kind_ == BenchSceneKind::Static) {
+        if (placed_) {
+            return;
+        }
+        frame = 0;
+        placed_ = true;
+    }
+    const float t = static_cast<float>(frame) * (1.0f / 60.0f); // simulated 60 Hz time
+    const float amplitude = 0.1f * scale_;
+    for (std::size_t i = 0; i < base_.size(); ++i) {
+        transforms_.x[i] = base_[i].x + std::sin(t + phase_[i]) * amplitude;
+        transforms_.y[i] = base_[i].y + std::cos(t * 1.3f + phase_[i]) * amplitude;
+        transforms_.rotation[i] = phase_[i] + t * 0.5f;
+        transforms_.scaleX[i] = scale_;
+        transforms_.scaleY[i] = scale_;
+    }
+}
+
+glm::vec2 BenchScene::cameraPosition(std::uint64_t frame) const {
+    if (kind_ == BenchSceneKind::Overlap) {
+        return glm::vec2(0.0f);
+    }
+    // Slow Lissajous sweep: covers the whole world, never the same path twice in a row.
+    const float t = static_cast<float>(frame) * (1.0f / 60.0f);
+    return glm::vec2(std::sin(t * 0.31f), std::sin(t * 0.23f)) * panExtent_;
+}
+
+void BenchReport::addFrame(double frameMs, const RenderStats& render, std::size_t triangles,
+                           const FrameAllocations& allocations) {
+    frameMs_.push_back(frameMs);
+    render_ += render;
+    triangles_ += triangles;
+    allocations_.main += allocations.main;
+    allocations_.render += allocations.render;
+    allocations_.all += allocations.all;
+    allocations_.mainBytes += allocations.mainBytes;
+    allocations_.allBytes += allocations.allBytes;
+    if (allocations.all > 0) {
+        ++allocatingFrames_;
+    }
+}
+
+void BenchReport::print(std::ostream& out, const char* label) const {
+    if (frameMs_.empty()) {
+        out << "bench: no frames measured\n";
+        return;
+    }
+    std::vector<double> sorted = frameMs_;
+    std::sort(sorted.begin(), sorted.end());
+    auto percentile = [&](double p) {
+        std::size_t index = static_cast<std::size_t>(p * (sorted.size() - 1) + 0.5);
+        return sorted[index];
+    };
+
+    double totalMs = 0.0;
+    for (double ms : frameMs_) {
+        totalMs += ms;
+    }
+    const double frames = static_cast<double>(frameMs_.size());
+    const double seconds = totalMs / 1000.0;
+
+    char line[256];
+    out << "bench: " << label << "\n";
+    std::snprintf(line, sizeof(line), "  frames          %zu\n", frameMs_.size());
+    out << line;
+    std::snprintf(line, sizeof(line), "  frame ms        avg %.3f  p50 %.3f  p90 %.3f  p99 %.3f  max %.3f\n",
+                  totalMs / frames, percentile(0.50), percentile(0.90), percentile(0.99), sorted.back());
+    out << line;
+    std::snprintf(line, sizeof(line), "  fps             %.1f\n", frames / seconds);
+    out << line;
+    std::snprintf(line, sizeof(line), "  draw calls      %.1f / frame, %.1f commands, %.1f sprite batches\n",
+                  render_.drawCalls / frames, render_.commands / frames, render_.batches / frames);
+    out << line;
+    std::snprintf(line, sizeof(line), "  batch breaks    program %.1f  texture %.1f  pipeline %.1f  full %.1f / frame\n",
+                  render_.programBreaks / frames, render_.textureBreaks / frames, render_.pipelineBreaks / frames,
+                  render_.capacityBreaks / frames);
+    out << line;
+    std::snprintf(line, sizeof(line), "  uploaded        %.1f KiB / frame\n", render_.uploadBytes / frames / 1024.0);
+    out << line;
+    std::snprintf(line, sizeof(line), "  state calls     %.0f issued  %.0f filtered / frame\n",
+                  render_.stateIssued / frames, render_.stateFiltered / frames);
+    out << line;
+    std::snprintf(line, sizeof(line), "  triangles       %.0f / frame, %.2f M/s\n",
+                  triangles_ / frames, triangles_ / seconds * 1e-6);
+    out << line;
+    if (!alloccount::enabled()) {
+        out << "  heap allocs     n/a (built with ALLOC_HOOK=0)\n";
+        return;
+    }
+    std::snprintf(line, sizeof(line), "  heap allocs     main %.2f  render %.2f  all %.2f / frame, %zu frames allocated\n",
+                  allocations_.main / frames, allocations_.render / frames, allocations_.all / frames,
+                  allocatingFrames_);
+    out << line;
+    std::snprintf(line, sizeof(line), "  heap bytes      main %.0f  all %.0f / frame\n", allocations_.mainBytes / frames,
+                  allocations_.allBytes / frames);
+    out << line;
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+#include "core/batch_transform.h"
+#include "render/render_stats.h"
+
+// BenchOptions
+// ------------
+// --bench                 run the benchmark instead of the game (hidden window, vsync off)
+// --bench-quads=N         number of quads (particles) in the scene   (default 10000)
+// --bench-scene=moving|static|overlap|tilemap|particles   what is drawn (default moving)
+// --bench-tiles=WxH       --bench-scene=tilemap's size in tiles      (default 128x128)
+// --bench-frames=N        measured frames                       (default 1000)
+// --bench-warmup=N        frames run before measuring starts    (default 60)
+// --bench-path=instanced|affine|layered|batched   renderer path under test (default instanced)
+// --bench-world=K         scene spans K x K screens; the camera pans across it (default 1)
+// --bench-cull[=linear|grid|quadtree]  cull against the view rectangle before drawing
+//                         linear: test every object (SIMD); grid / quadtree: query a
+//                         UniformGrid / LooseQuadtree kept up to date as objects move
+// --bench-zero-alloc      fail (exit 1) if any measured frame allocated from the heap
+//
+// | Path      | CPU work per quad                | Draws     | Bytes/quad |
+// | --------- | -------------------------------- | --------- | ---------- |
+// | instanced | SoA → mat4 into the stream       | 1         | 64         |
+// | affine    | SoA → Affine2D into the stream   | 1         | 24         |
+// | layered   | affine + array layer + tint      | 1         | 32         |
+// | batched   | SoA → mat4 → 4 vertices on CPU   | per batch | 4 x 20     |
+//
+// Scenes, each a curve of frame time against its N for a path (and cull):
+//
+// | Scene     | N                | Drawn                                               |
+// | --------- | ---------------- | --------------------------------------------------- |
+// | moving    | --bench-quads    | quads on a grid, each bobbing and spinning          |
+// | static    | --bench-quads    | the same grid, still: the scene costs nothing after |
+// |           |                  | frame 0, what is left is the path's own per-frame   |
+// | overlap   | --bench-quads    | quads piled on the middle of the screen, alpha 3/8: |
+// |           |                  | overdraw grows with N (blended on the layered path, |
+// |           |                  | opaque on the others)                               |
+// | tilemap   | --bench-tiles    | a WxH tilemap, the camera panning across all of it; |
+// |           |                  | no quads                                            |
+// | particles | --bench-quads    | that many particles (--particles, on the GPU unless |
+// |           |                  | --particles-cpu); no quads                          |
+enum class BenchPath { Instanced, Affine, Layered, Batched };
+enum class BenchCull { None, Linear, Grid, Quadtree };
+enum class BenchSceneKind { Moving, Static, Overlap, Tilemap, Particles };
+
+struct BenchOptions {
+    bool enabled = false;
+    int quads = 10000;
+    int frames = 1000;
+    int warmup = 60;
+    BenchPath path = BenchPath::Instanced;
+    BenchSceneKind scene = BenchSceneKind::Moving;
+    int tilesX = 128;
+    int tilesY = 128;
+    float world = 1.0f;
+    BenchCull cull = BenchCull::None;
+    bool zeroAlloc = false;
+};
+
+const char* benchPathName(BenchPath path);
+const char* benchCullName(BenchCull cull);
+const char* benchSceneName(BenchSceneKind scene);
+// Quads the scene draws: 0 for the tilemap and particle scenes.
+int benchSceneQuads(const BenchOptions& options);
+
+// Parses one --bench* argument. Returns false if `arg` isn't a bench option.
+bool parseBenchOption(const char* arg, BenchOptions& options);
+
+// BenchRng
+// --------
+// The benches' random numbers: a small LCG, so the sequence for a seed is the same on
+// every compiler and standard library (std::random's distributions are not).
+struct BenchRng {
+    std::uint32_t state;
+
+    std::uint32_t bits() { // 24 random bits
+        state = state * 1664525u + 1013904223u;
+        return state >> 8;
+    }
+    float next() { return static_cast<float>(bits()) * (1.0f / 16777216.0f); } // [0, 1)
+    float range(float lo, float hi) { return lo + (hi - lo) * next(); }
+};
+
+// BenchScene
+// ----------
+// Deterministic scene of N quads on a grid covering K x K screens of the default ortho
+// view ([-aspect, aspect] x [-1, 1] at K = 1), each bobbing and spinning on its own
+// phase (moving), or not (static); or piled on the view's middle half, overlapping
+// (overlap). With K > 1 the camera pans over the whole world (a scrolling level), so most
+// objects are off-screen at any time. The tilemap and particle scenes have no quads: the
+// camera pan is all there is of them here.
+//
+// Everything is a pure function of (seed, frame index)—no wall-clock time, no
+// std::random distributions (whose output differs between standard libraries)—so every
+// run on every machine renders exactly the same frames.
+class BenchScene {
+public:
+    void init(int quadCount, float aspect, float worldScreens = 1.0f,
+              BenchSceneKind kind = BenchSceneKind::Moving, std::uint32_t seed = 1234u);
+    void update(std::uint64_t frame);
+    glm::vec2 cameraPosition(std::uint64_t frame) const;
+
+    // SoA transforms of this frame, scaled for the quad in main() (extent [-0.25, 0.25]).
+    const Transforms2D& transforms() const { return transforms_; }
+    std::size_t size() const { return transforms_.size(); }
+
+
+private:
+    BenchSceneKind kind_ = BenchSceneKind::Moving;
+    bool placed_ = false;              // static: the transforms are written once
+    std::vector<glm::vec2> base_;
+    std::vector<float> phase_;
+    Transforms2D transforms_;
+    glm::vec2 panExtent_{0.0f, 0.0f};  // camera travels within ± this
+    float scale_ = 1.0f;
+};
+
+// Heap allocations during one frame (core/alloc_counter.h). main and render are each
+// thread's own count; all is every thread's, job workers included.
+struct FrameAllocations {
+    std::uint64_t main = 0;
+    std::uint64_t render = 0;
+    std::uint64_t all = 0;
+    std::uint64_t mainBytes = 0;
+    std::uint64_t allBytes = 0;
+};
+
+// BenchReport
+// -----------
+// Collects per-frame results and prints percentiles and throughput at the end.
+class BenchReport {
+public:
+    void reserve(int frames) { frameMs_.reserve(frames); }
+    void addFrame(double frameMs, const RenderStats& render, std::size_t triangles,
+                  const FrameAllocations& allocations = FrameAllocations{});
+    void print(std::ostream& out, const char* label) const;
+
+    std::size_t frames() const { return frameMs_.size(); }
+    // Measured frames with at least one heap allocation on any thread.
+    std::size_t allocatingFrames() const { return allocatingFrames_; }
+
+private:
+    std::vector<double> frameMs_;
+    RenderStats render_;               // summed
+    std::uint64_t triangles_ = 0;
+    FrameAllocations allocations_;     // summed
+    std::size_t allocatingFrames_ = 0;
+};
@@ -0,0 +1,211 @@
+// GLM micro-benchmarks
+// --------------------
+// Times the math main() does every frame, at a scale where it matters (millions of
+// objects instead of one quad):
+//
+// | Benchmark        | What main() does with it                                   |
+// | ---------------- | ---------------------------------------------------------- |
+// | translate+scale  | builds each object's model matrix                          |
+// | ortho            | builds the 2D projection                                   |
+// | perspective      | builds the 3D projection                                   |
+// | viewProj * model | CPU-side MVP: camera combined with each object             |
+// | inverse          | picking: screen → world through inverse(projection * view) |
+// | inverse <kind>   | the same per matrix kind: glm::inverse vs the closed form  |
+// |                  | (core/matrix_inverse.h), with the worst |m * m⁻¹ - I|       |
+//
+// Standalone: no window, no GL context. `make glm-bench` builds and runs one binary per
+// GLM configuration so the vendored include/glm can be tuned for this machine:
+//
+// | Binary            | Defines                                                       |
+// | ----------------- | ------------------------------------------------------------- |
+// | glm_bench         | (none) — scalar GLM, packed types only                        |
+// | glm_bench_sse     | GLM_FORCE_INTRINSICS — what the game is built with            |
+// | glm_bench_avx2    | GLM_FORCE_AVX2 (implies INTRINSICS), -mavx2 -mfma             |
+//
+// GLM only routes mat4/vec4 through its SSE/AVX code (include/glm/simd) for ALIGNED
+// types (`aligned_highp`, core/aligned_math.h); glm::mat4 stays packed_highp. So the SIMD
+// binaries run every benchmark twice—the packed types the render loop uses, then the
+// aligned ones—and the difference is what GLM's SIMD path is worth.
+//
+// Usage: glm_bench [objects=1048576] [repeats=5]
+// Reports the best of `repeats` runs per benchmark (least disturbed by the OS).
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#if GLM_CONFIG_ALIGNED_GENTYPES == GLM_ENABLE
+#include <glm/gtc/type_aligned.hpp>
+#endif
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "core/matrix_inverse.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Consumes a result so the optimizer can't delete the loop that produced it.
+volatile float gSink = 0.0f;
+
+template <typename Fn>
+double bestNsPerOp(int repeats, std::size_t ops, Fn&& body) {
+    double best = 1e300;
+    for (int r = 0; r < repeats; ++r) {
+        Clock::time_point start = Clock::now();
+        body();
+        std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+        double perOp = elapsed.count() / static_cast<double>(ops);
+        if (perOp < best) best = perOp;
+    }
+    return best;
+}
+
+void printRow(const char* name, const char* types, double nsPerOp) {
+    std::printf("%-18s %-8s %9.2f ns/op %10.1f Mops/s\n", name, types, nsPerOp, 1e3 / nsPerOp);
+}
+
+const char* configName() {
+#if defined(GLM_FORCE_AVX2)
+    return "GLM_FORCE_INTRINSICS + GLM_FORCE_AVX2";
+#elif defined(GLM_FORCE_INTRINSICS)
+    return "GLM_FORCE_INTRINSICS (SSE)";
+#else
+    return "default (scalar)";
+#endif
+}
+
+// Every benchmark with one GLM qualifier: packed_highp (glm::mat4, what the game uses)
+// or aligned_highp (GLM's SIMD path when GLM_FORCE_INTRINSICS is on).
+template <glm::qualifier Q>
+void runAll(const char* types, std::size_t count, int repeats) {
+    using Vec3 = glm::vec<3, float, Q>;
+    using Mat4 = glm::mat<4, 4, float, Q>;
+
+    // Deterministic inputs (same in every configuration).
+    std::vector<Vec3> positions(count);
+    std::vector<Vec3> scales(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        float f = static_cast<float>(i);
+        positions[i] = Vec3(f * 0.001f, -f * 0.002f, 0.0f);
+        scales[i] = Vec3(1.0f + (i % 7) * 0.1f, 1.0f + (i % 5) * 0.1f, 1.0f);
+    }
+    std::vector<Mat4> models(count);
+    std::vector<Mat4> mvps(count);
+
+    // Model matrices: translate(identity, p) then scale, exactly as in main().
+    printRow("translate+scale", types, bestNsPerOp(repeats, count, [&] {
+        for (std::size_t i = 0; i < count; ++i) {
+            Mat4 m = glm::translate(Mat4(1.0f), positions[i]);
+            models[i] = glm::scale(m, scales[i]);
+        }
+        gSink = gSink + models[count / 2][3][0];
+    }));
+
+    // Projections: rebuilt every frame in main() (aspect can change on resize).
+    printRow("ortho", types, bestNsPerOp(repeats, count, [&] {
+        Mat4 acc(0.0f);
+        for (std::size_t i = 0; i < count; ++i) {
+            float aspect = 1.0f + static_cast<float>(i & 255) * (1.0f / 256.0f);
+            acc += Mat4(glm::ortho(-aspect, aspect, -1.0f, 1.0f));
+        }
+        gSink = gSink + acc[0][0];
+    }));
+
+    printRow("perspective", types, bestNsPerOp(repeats, count, [&] {
+        Mat4 acc(0.0f);
+        for (std::size_t i = 0; i < count; ++i) {
+            float aspect = 1.0f + static_cast<float>(i & 255) * (1.0f / 256.0f);
+            acc += Mat4(glm::perspective(glm::radians(45.0f), aspect, 0.1f, 100.0f));
+        }
+        gSink = gSink + acc[0][0];
+    }));
+
+    // projection * view * model with one shared view-projection (the CPU-side MVP path).
+    const Mat4 projection(glm::ortho(-1.0f, 1.0f, -1.0f, 1.0f));
+    const Mat4 view = glm::translate(Mat4(1.0f), Vec3(-0.3f, 0.2f, 0.0f));
+    const Mat4 viewProjection = projection * view;
+    printRow("viewProj * model", types, bestNsPerOp(repeats, count, [&] {
+        for (std::size_t i = 0; i < count; ++i) {
+            mvps[i] = viewProjection * models[i];
+        }
+        gSink = gSink + mvps[count / 2][3][1];
+    }));
+
+    // Inverse: one per frame in main() (only when the camera moved), timed per call here.
+    printRow("inverse", types, bestNsPerOp(repeats, count, [&] {
+        Mat4 acc(0.0f);
+        for (std::size_t i = 0; i < count; ++i) {
+            acc += glm::inverse(mvps[i]);
+        }
+        gSink = gSink + acc[3][3];
+    }));
+}
+
+// One kind of matrix inverted `count` times by glm::inverse and by inverseOf(kind). The
+// inputs are 1024 matrices that stay in L1, so this times the math, not memory (which
+// the "inverse" row above is bound by).
+template <typename Make>
+void runInverse(const char* name, MatrixKind kind, std::size_t count, int repeats, Make&& make) {
+    constexpr std::size_t kInputs = 1024;
+    std::vector<glm::mat4> in(kInputs);
+    for (std::size_t i = 0; i < kInputs; ++i) {
+        in[i] = make(static_cast<float>(i) / kInputs);
+    }
+    auto timeAndError = [&](auto&& invert, float& worst) {
+        worst = 0.0f;
+        for (const glm::mat4& m : in) {
+            const glm::mat4 identity = m * invert(m);
+            for (int c = 0; c < 4; ++c)
+                for (int r = 0; r < 4; ++r)
+                    worst = std::fmax(worst, std::fabs(identity[c][r] - (c == r ? 1.0f : 0.0f)));
+        }
+        return bestNsPerOp(repeats, count, [&] {
+            glm::mat4 acc(0.0f);
+            for (std::size_t i = 0; i < count; ++i) acc += invert(in[i & (kInputs - 1)]);
+            gSink = gSink + acc[3][3];
+        });
+    };
+    float generalError = 0.0f;
+    float closedError = 0.0f;
+    const double general = timeAndError([](const glm::mat4& m) { return glm::inverse(m); }, generalError);
+    const double closed = timeAndError([kind](const glm::mat4& m) { return inverseOf(m, kind); }, closedError);
+    std::printf("%-20s glm %6.2f ns  err %.1e | closed form %6.2f ns  err %.1e  (%.1fx)\n", name, general,
+                generalError, closed, closedError, general / closed);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : (1u << 20);
+    const int repeats = argc > 2 ? std::atoi(argv[2]) : 5;
+
+    std::printf("GLM %d.%d.%d, %s, SIMD %s, %zu objects, best of %d\n",
+                GLM_VERSION_MAJOR, GLM_VERSION_MINOR, GLM_VERSION_PATCH, configName(),
+                GLM_CONFIG_SIMD == GLM_ENABLE ? "on" : "off", count, repeats);
+
+    runAll<glm::packed_highp>("packed", count, repeats);
+#if GLM_CONFIG_ALIGNED_GENTYPES == GLM_ENABLE
+    runAll<glm::aligned_highp>("aligned", count, repeats);
+#endif
+
+    const glm::vec3 up(0.0f, 1.0f, 0.0f);
+    runInverse("inverse rigid", MatrixKind::Rigid, count, repeats, [&](float t) {
+        return glm::lookAt(glm::vec3(std::sin(t * 6.0f), t, 3.0f), glm::vec3(0.0f), up);
+    });
+    runInverse("inverse affine", MatrixKind::Affine, count, repeats, [](float t) {
+        const glm::mat4 m = glm::rotate(glm::translate(glm::mat4(1.0f), glm::vec3(t, -t, 0.5f)), t * 6.0f,
+                                        glm::vec3(0.0f, 0.0f, 1.0f));
+        return glm::scale(m, glm::vec3(1.0f + t, 2.0f - t, 1.0f));
+    });
+    runInverse("inverse ortho", MatrixKind::ScaleTranslate, count, repeats, [](float t) {
+        return glm::ortho(-1.0f - t, 1.0f + t, -1.0f, 1.0f) * glm::translate(glm::mat4(1.0f), glm::vec3(t, 2.0f * t, 0.0f));
+    });
+    runInverse("inverse perspective", MatrixKind::Perspective, count, repeats, [](float t) {
+        return glm::perspective(glm::radians(45.0f), 1.0f + t, 0.1f, 100.0f);
+    });
+
+    return 0;
+}
@@ -0,0 +1,388 @@
+// Infrastructure benchmark
+// ------------------------
+// The job system (core/job_system.h) and the allocators (core/frame_arena.h,
+// core/block_pool.h) on their own. A regression in them shows up here as a number
+// before it shows up as frame time somewhere else:
+//
+// | Benchmark       | Measures                                                              |
+// | --------------- | --------------------------------------------------------------------- |
+// | jobs            | parallelFor of 0 / 1 / 10 / 100 us jobs on 1, 2, 4 .. N threads: ns   |
+// |                 | per job, and the speedup over the same work in a plain loop. Every    |
+// |                 | job starts in the main thread's deque: the workers' share is stolen   |
+// | latency         | run() to the job starting on a worker, p50 / p99: back to back (the   |
+// |                 | workers still spinning) and 1 ms apart (asleep on the condition       |
+// |                 | variable: the wake-up is in the number)                               |
+// | arena           | a frame of 4096 allocations of 16..256 bytes: FrameArena's bump and   |
+// |                 | reset() against malloc and free; vectors grown by push_back on each   |
+// | pool            | bursts of 128 allocations and frees of 64-byte blocks on 1 .. N       |
+// |                 | threads at once, BlockPool against malloc: each thread freeing its    |
+// |                 | own blocks, then its neighbour's (the remote free the ECS does)       |
+//
+// The jobs rows are the ones to watch for the scheduler: the 0 us column is pure
+// overhead (queue, steal, counter), and the speedup of the 10 and 100 us columns should
+// stay close to the thread count. For the allocators, the arena should stay far below
+// malloc, and BlockPool's ns per pair should barely move as threads are added (its
+// thread caches touch no shared line); malloc's usually does. FrameVector is not expected
+// to beat std::vector: each growth leaves the old buffer behind in the arena, where
+// malloc would hand it back. It is there to catch the allocator making growth slower.
+//
+// Standalone: no window, no GL context. `make infra-bench` builds and runs it.
+// Usage: infra_bench [repeats=5]
+// Reports the best of `repeats` runs, except the latencies (percentiles of every sample).
+// Build optimized (the Makefile does): an -O0 job system measures function calls.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "bench/bench.h"
+#include "core/block_pool.h"
+#include "core/frame_arena.h"
+#include "core/job_system.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::size_t kBatchJobs = 1024;        // per parallelFor: well under kJobsPerThread
+constexpr double kJobSizesUs[] = {0.0, 1.0, 10.0, 100.0};
+constexpr double kWorkMsPerRun = 20.0;          // serial work per measured run, sized jobs
+constexpr int kLatencySamples = 2000;
+constexpr std::size_t kFrameAllocations = 4096;
+constexpr std::size_t kBurst = 128;             // pool: blocks held at once per thread
+constexpr std::size_t kBlockBytes = 64;
+constexpr int kBurstsPerThread = 2000;
+
+std::atomic<std::uint32_t> gSink{0};            // keeps the work loops from being optimized out
+
+// `iterations` steps of a dependent chain: work the compiler can neither skip nor vectorize.
+std::uint32_t spin(std::uint32_t iterations) {
+    std::uint32_t x = iterations;
+    for (std::uint32_t i = 0; i < iterations; ++i) {
+        x = x * 1664525u + 1013904223u;
+    }
+    return x;
+}
+
+void consume(std::uint32_t value) {
+    if (value == 0x12345678u) {
+        gSink.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+template <typename Fn>
+double bestMs(int repeats, Fn&& body) {
+    double best = 1e300;
+    for (int r = 0; r < repeats; ++r) {
+        const Clock::time_point start = Clock::now();
+        body();
+        const std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+// spin() iterations per microsecond on this machine.
+double calibrate() {
+    const std::uint32_t iterations = 1u << 22;
+    const double ms = bestMs(3, [&] { consume(spin(iterations)); });
+    return static_cast<double>(iterations) / (ms * 1000.0);
+}
+
+// Thread counts to try: 1, 2, 4, ... and the machine's own.
+std::vector<unsigned> threadCounts() {
+    const unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned> counts;
+    for (unsigned t = 1; t < hardware; t *= 2) {
+        counts.push_back(t);
+    }
+    counts.push_back(hardware);
+    return counts;
+}
+
+// ---- jobs ----
+
+struct JobResult {
+    double nsPerJob;
+    double speedup;
+};
+
+JobResult jobThroughput(JobSystem& jobs, std::uint32_t iterations, std::size_t count, double serialMs, int repeats) {
+    auto work = [iterations](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            consume(spin(iterations));
+        }
+    };
+    const double ms = bestMs(repeats, [&] {
+        for (std::size_t done = 0; done < count; done += kBatchJobs) {
+            jobs.parallelFor(std::min(kBatchJobs, count - done), 1, work);
+        }
+    });
+    return JobResult{ms * 1e6 / static_cast<double>(count), serialMs / ms};
+}
+
+void benchJobs(double iterationsPerUs, int repeats) {
+    std::printf("jobs: ns per job, speedup over a plain loop of the same work\n");
+    std::printf("%7s", "threads");
+    for (double us : kJobSizesUs) {
+        std::printf(" %11.0f us job", us);
+    }
+    std::printf("\n");
+
+    // Per size: how many jobs and how long the same work takes in a plain loop.
+    std::uint32_t iterations[std::size(kJobSizesUs)];
+    std::size_t counts[std::size(kJobSizesUs)];
+    double serialMs[std::size(kJobSizesUs)];
+    for (std::size_t s = 0; s < std::size(kJobSizesUs); ++s) {
+        iterations[s] = static_cast<std::uint32_t>(kJobSizesUs[s] * iterationsPerUs);
+        const double jobs = kJobSizesUs[s] > 0.0 ? kWorkMsPerRun * 1000.0 / kJobSizesUs[s] : 64.0 * kBatchJobs;
+        counts[s] = std::max<std::size_t>(kBatchJobs, static_cast<std::size_t>(jobs) / kBatchJobs * kBatchJobs);
+        serialMs[s] = bestMs(repeats, [&] {
+            for (std::size_t i = 0; i < counts[s]; ++i) {
+                consume(spin(iterations[s]));
+            }
+        });
+    }
+    for (unsigned threads : threadCounts()) {
+        JobSystem jobs;
+        jobs.init(static_cast<int>(threads) - 1);
+        std::printf("%7u", jobs.threadCount());
+        for (std::size_t s = 0; s < std::size(kJobSizesUs); ++s) {
+            const JobResult r = jobThroughput(jobs, iterations[s], counts[s], serialMs[s], repeats);
+            std::printf(" %9.0f ns %5.2fx", r.nsPerJob, r.speedup);
+        }
+        std::printf("\n");
+        jobs.shutdown();
+    }
+    std::printf("\n");
+}
+
+struct LatencyProbe {
+    Clock::time_point queued;
+    std::atomic<std::int64_t> startedNs{-1};    // since `queued`
+};
+
+void markStarted(void* context, std::size_t, std::size_t) {
+    LatencyProbe& probe = *static_cast<LatencyProbe*>(context);
+    probe.startedNs.store(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - probe.queued).count(),
+                          std::memory_order_release);
+}
+
+// run() from the main thread, which then only watches: the job can only start on a worker.
+void latencySamples(JobSystem& jobs, std::chrono::microseconds gap, std::vector<double>& out) {
+    out.clear();
+    for (int i = 0; i < kLatencySamples; ++i) {
+        if (gap.count() > 0) {
+            std::this_thread::sleep_for(gap);
+        }
+        LatencyProbe probe;
+        JobCounter counter;
+        probe.queued = Clock::now();
+        jobs.run(&markStarted, &probe, 0, 1, &counter);
+        std::int64_t ns;
+        while ((ns = probe.startedNs.load(std::memory_order_acquire)) < 0) {
+        }
+        jobs.wait(counter);
+        out.push_back(static_cast<double>(ns));
+    }
+    std::sort(out.begin(), out.end());
+}
+
+double percentile(const std::vector<double>& sorted, double p) {
+    return sorted[std::min(sorted.size() - 1, static_cast<std::size_t>(p * static_cast<double>(sorted.size())))];
+}
+
+void benchLatency() {
+    const unsigned hardware = std::max(2u, std::thread::hardware_concurrency());
+    JobSystem jobs;
+    jobs.init(static_cast<int>(hardware) - 1);
+    std::vector<double> hot, cold;
+    latencySamples(jobs, std::chrono::microseconds(0), hot);
+    latencySamples(jobs, std::chrono::microseconds(1000), cold);
+    std::printf("latency: run() to a worker starting the job, %u workers, %d samples\n", jobs.workerCount(),
+                kLatencySamples);
+    std::printf("  back to back  p50 %7.0f ns  p99 %7.0f ns\n", percentile(hot, 0.5), percentile(hot, 0.99));
+    std::printf("  1 ms apart    p50 %7.0f ns  p99 %7.0f ns\n\n", percentile(cold, 0.5), percentile(cold, 0.99));
+    jobs.shutdown();
+}
+
+// ---- allocators ----
+
+void benchArena(int repeats) {
+    std::vector<std::size_t> sizes(kFrameAllocations);
+    BenchRng rng{42u};
+    for (std::size_t& s : sizes) {
+        s = 16 + rng.bits() % 241;
+    }
+    std::vector<void*> pointers(kFrameAllocations);
+
+    FrameArena arena;
+    arena.init(1 << 20);
+    const double arenaMs = bestMs(repeats, [&] {
+        for (int frame = 0; frame < 100; ++frame) {
+            for (std::size_t i = 0; i < kFrameAllocations; ++i) {
+                unsigned char* p = static_cast<unsigned char*>(arena.allocate(sizes[i]));
+                p[0] = static_cast<unsigned char>(i);
+                pointers[i] = p;
+            }
+            arena.reset();
+        }
+    });
+    const double mallocMs = bestMs(repeats, [&] {
+        for (int frame = 0; frame < 100; ++frame) {
+            for (std::size_t i = 0; i < kFrameAllocations; ++i) {
+                unsigned char* p = static_cast<unsigned char*>(std::malloc(sizes[i]));
+                p[0] = static_cast<unsigned char>(i);
+                pointers[i] = p;
+            }
+            for (void* p : pointers) {
+                std::free(p);
+            }
+        }
+    });
+    const double perAllocation = 1e6 / (100.0 * kFrameAllocations);
+    std::printf("arena: %zu allocations of 16..256 bytes a frame\n", kFrameAllocations);
+    std::printf("  FrameArena    %6.1f ns/alloc (reset included)\n", arenaMs * perAllocation);
+    std::printf("  malloc/free   %6.1f ns/alloc (free included)\n", mallocMs * perAllocation);
+
+    // 64 vectors of 1000 ints grown one push_back at a time: the growth a frame's lists go through.
+    const double frameVectorMs = bestMs(repeats, [&] {
+        for (int frame = 0; frame < 100; ++frame) {
+            for (int v = 0; v < 64; ++v) {
+                FrameVector<int> list{FrameAllocator<int>(arena)};
+                for (int i = 0; i < 1000; ++i) {
+                    list.push_back(i);
+                }
+                consume(static_cast<std::uint32_t>(list.back()));
+            }
+            arena.reset();
+        }
+    });
+    const double stdVectorMs = bestMs(repeats, [&] {
+        for (int frame = 0; frame < 100; ++frame) {
+            for (int v = 0; v < 64; ++v) {
+                std::vector<int> list;
+                for (int i = 0; i < 1000; ++i) {
+                    list.push_back(i);
+                }
+                consume(static_cast<std::uint32_t>(list.back()));
+            }
+        }
+    });
+    std::printf("  FrameVector   %6.1f us per 64 x 1000 push_back\n", frameVectorMs * 1e3 / 100.0);
+    std::printf("  std::vector   %6.1f us per 64 x 1000 push_back\n\n", stdVectorMs * 1e3 / 100.0);
+    arena.shutdown();
+}
+
+// Sense-reversing spin barrier: the pool threads meet between allocating and freeing.
+class SpinBarrier {
+public:
+    explicit SpinBarrier(unsigned count) : count_(count) {}
+
+    void arrive(bool& sense) {
+        sense = !sense;
+        if (arrived_.fetch_add(1, std::memory_order_acq_rel) + 1 == count_) {
+            arrived_.store(0, std::memory_order_relaxed);
+            sense_.store(sense, std::memory_order_release);
+        } else {
+            while (sense_.load(std::memory_order_acquire) != sense) {
+            }
+        }
+    }
+
+private:
+    const unsigned count_;
+    std::atomic<unsigned> arrived_{0};
+    std::atomic<bool> sense_{false};
+};
+
+// ns per allocate + deallocate pair, every thread counted. `remote`: each thread frees
+// the blocks its neighbour allocated in the same burst.
+template <typename Allocate, typename Free>
+double poolPairs(unsigned threads, bool remote, Allocate allocate, Free release) {
+    std::vector<std::vector<void*>> held(threads, std::vector<void*>(kBurst));
+    SpinBarrier barrier(threads);
+    Clock::time_point start, end;
+    auto body = [&](unsigned t) {
+        bool sense = false;
+        barrier.arrive(sense);
+        if (t == 0) {
+            start = Clock::now();
+        }
+        std::vector<void*>& mine = held[t];
+        std::vector<void*>& freed = held[remote ? (t + 1) % threads : t];
+        for (int burst = 0; burst < kBurstsPerThread; ++burst) {
+            for (std::size_t i = 0; i < kBurst; ++i) {
+                void* p = allocate();
+                *static_cast<unsigned char*>(p) = static_cast<unsigned char>(i);
+                mine[i] = p;
+            }
+            if (remote) {
+                barrier.arrive(sense);  // the neighbour's blocks are all there
+            }
+            for (void* p : freed) {
+                release(p);
+            }
+            if (remote) {
+                barrier.arrive(sense);  // and all freed before it refills the array
+            }
+        }
+        barrier.arrive(sense);
+        if (t == 0) {
+            end = Clock::now();
+        }
+    };
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < threads; ++t) {
+        workers.emplace_back(body, t);
+    }
+    body(0);
+    for (std::thread& w : workers) {
+        w.join();
+    }
+    const std::chrono::duration<double, std::nano> elapsed = end - start;
+    return elapsed.count() / (static_cast<double>(kBurstsPerThread) * kBurst);   // every thread ran as many
+}
+
+void benchPool(int repeats) {
+    std::printf("pool: %zu-byte blocks, bursts of %zu, ns per allocate + free pair (per thread)\n", kBlockBytes, kBurst);
+    std::printf("%7s %13s %13s %13s %13s %8s\n", "threads", "BlockPool", "malloc", "pool remote", "malloc remote",
+                "refills");
+    for (unsigned threads : threadCounts()) {
+        BlockPool pool;
+        pool.init(kBlockBytes, alignof(std::max_align_t), 1024);
+        auto poolAllocate = [&pool] { return pool.allocate(); };
+        auto poolFree = [&pool](void* p) { pool.deallocate(p); };
+        auto heapAllocate = [] { return std::malloc(kBlockBytes); };
+        auto heapFree = [](void* p) { std::free(p); };
+        double best[4] = {1e300, 1e300, 1e300, 1e300};
+        for (int r = 0; r < repeats; ++r) {
+            best[0] = std::min(best[0], poolPairs(threads, false, poolAllocate, poolFree));
+            best[1] = std::min(best[1], poolPairs(threads, false, heapAllocate, heapFree));
+            best[2] = std::min(best[2], poolPairs(threads, true, poolAllocate, poolFree));
+            best[3] = std::min(best[3], poolPairs(threads, true, heapAllocate, heapFree));
+        }
+        std::printf("%7u %10.1f ns %10.1f ns %10.1f ns %10.1f ns %8llu\n", threads, best[0], best[1], best[2],
+                    best[3], static_cast<unsigned long long>(pool.stats().refills));
+        pool.shutdown();
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const int repeats = argc > 1 ? std::max(1, std::atoi(argv[1])) : 5;
+    const double iterationsPerUs = calibrate();
+    std::printf("Infrastructure benchmark: %u hardware threads, best of %d\n\n",
+                std::thread::hardware_concurrency(), repeats);
+    benchJobs(iterationsPerUs, repeats);
+    benchLatency();
+    benchArena(repeats);
+    benchPool(repeats);
+    return gSink.load() == 0xffffffffu ? 1 : 0;
+}
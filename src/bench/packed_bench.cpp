@@ -0,0 +1,217 @@
+// Packed storage benchmark
+// ------------------------
+// Full-float SoA vs the packed encodings (core/packed_storage.h) for the cold per-entity
+// arrays of a big world:
+//
+// | Field         | Full float          | Packed                               |
+// | ------------- | ------------------- | ------------------------------------ |
+// | rest position | x, y: 8 bytes       | unorm16 x, y over the world: 4 bytes |
+// | colour        | r, g, b, a: 16      | RGBA8: 4                             |
+// | animation     | phase, rate: 8      | half, half: 4                        |
+// | total         | 32 bytes            | 12 bytes                             |
+//
+// | Benchmark | What                                                                  |
+// | --------- | --------------------------------------------------------------------- |
+// | pack      | full -> packed, every array (a level bake, a save)                    |
+// | unpack    | packed -> full, every array (a load)                                  |
+// | scan      | one pass reading every field: the full arrays directly; the packed   |
+// |           | ones decoded kBlock entities at a time into L1-sized scratch arrays, |
+// |           | the way a system would consume them. The same arithmetic for both    |
+// |           | (and the same sum, to the encodings' error)                          |
+//
+// GB/s is of the stored arrays; "max error" is each field's worst round trip. What it
+// showed on a Xeon with a 105 MiB L3 (1M entities, one thread):
+//
+// | Build  | Full scan | Packed scan | Of which decoding | Pack / unpack      |
+// | ------ | --------- | ----------- | ----------------- | ------------------ |
+// | SSE2   | 1.70 ms   | 2.13 ms     | ~1.6 ms           | 4.3 / 3.5 ns each  |
+// | F16C   | 1.58 ms   | 1.41 ms     | ~1.1 ms           | 3.3 / 3.5 ns each  |
+//
+// One thread reading 19 GB/s isn't starved for bandwidth, so the decode (its stores to
+// the scratch arrays, mostly) eats most of the 2.7x fewer bytes read: packing is about
+// footprint, and about bandwidth when it is shared (every worker scanning, the GPU
+// streaming), not a free speed-up for a lone scan.
+//
+// Standalone: no window, no GL context. `make packed-bench` builds and runs it twice:
+// packed_bench (SSE2 half conversion) and packed_bench_f16c (-mf16c).
+// Usage: packed_bench [entities=1000000] [repeats=5]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include "bench/bench.h"
+#include "core/aligned_math.h"
+#include "core/packed_storage.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr float kWorldHalf = 64.0f;
+constexpr std::size_t kBlock = 512;    // 8 scratch arrays of it: 16 KiB
+
+struct FullState {
+    AlignedVector<float> x, y;
+    AlignedVector<float> r, g, b, a;
+    AlignedVector<float> phase, rate;
+
+    std::size_t size() const { return x.size(); }
+    void resize(std::size_t count) {
+        for (AlignedVector<float>* v : {&x, &y, &r, &g, &b, &a, &phase, &rate}) {
+            v->resize(count);
+        }
+    }
+};
+
+struct PackedState {
+    AlignedVector<std::uint16_t> x, y;
+    AlignedVector<std::uint32_t> color;
+    AlignedVector<std::uint16_t> phase, rate;
+
+    void resize(std::size_t count) {
+        x.resize(count);
+        y.resize(count);
+        color.resize(count);
+        phase.resize(count);
+        rate.resize(count);
+    }
+};
+
+constexpr double kFullBytes = 8 * sizeof(float);
+constexpr double kPackedBytes = 4 * sizeof(std::uint16_t) + sizeof(std::uint32_t);
+
+void pack(const FullState& in, PackedState& out) {
+    const std::size_t n = in.size();
+    packUnorm16(in.x.data(), n, -kWorldHalf, kWorldHalf, out.x.data());
+    packUnorm16(in.y.data(), n, -kWorldHalf, kWorldHalf, out.y.data());
+    packRgba8(in.r.data(), in.g.data(), in.b.data(), in.a.data(), n, out.color.data());
+    packHalf(in.phase.data(), n, out.phase.data());
+    packHalf(in.rate.data(), n, out.rate.data());
+}
+
+// [first, first + count) of `in` into out[0 .. count).
+void unpack(const PackedState& in, std::size_t first, std::size_t count, FullState& out) {
+    unpackUnorm16(in.x.data() + first, count, -kWorldHalf, kWorldHalf, out.x.data());
+    unpackUnorm16(in.y.data() + first, count, -kWorldHalf, kWorldHalf, out.y.data());
+    unpackRgba8(in.color.data() + first, count, out.r.data(), out.g.data(), out.b.data(), out.a.data());
+    unpackHalf(in.phase.data() + first, count, out.phase.data());
+    unpackHalf(in.rate.data() + first, count, out.rate.data());
+}
+
+// The scan's work on entities [first, first + count) of `s`: something of every field,
+// eight independent sums so it vectorizes and stays memory-bound.
+void accumulate(const FullState& s, std::size_t first, std::size_t count, double& total) {
+    float sums[8] = {};
+    std::size_t i = first;
+    const std::size_t end = first + count;
+    for (; i + 8 <= end; i += 8) {
+        for (std::size_t j = 0; j < 8; ++j) {
+            const std::size_t k = i + j;
+            const float luma = (s.r[k] * 0.299f + s.g[k] * 0.587f + s.b[k] * 0.114f) * s.a[k];
+            sums[j] += s.x[k] + s.y[k] + luma + s.phase[k] * s.rate[k];
+        }
+    }
+    for (; i < end; ++i) {
+        const float luma = (s.r[i] * 0.299f + s.g[i] * 0.587f + s.b[i] * 0.114f) * s.a[i];
+        sums[0] += s.x[i] + s.y[i] + luma + s.phase[i] * s.rate[i];
+    }
+    for (float sum : sums) {
+        total += sum;
+    }
+}
+
+template <typename Fn>
+double bestMs(int repeats, Fn&& body) {
+    double best = 1e300;
+    for (int r = 0; r < repeats; ++r) {
+        Clock::time_point start = Clock::now();
+        body();
+        std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+        if (elapsed.count() < best) best = elapsed.count();
+    }
+    return best;
+}
+
+float maxError(const AlignedVector<float>& a, const AlignedVector<float>& b) {
+    float worst = 0.0f;
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        worst = std::max(worst, std::fabs(a[i] - b[i]));
+    }
+    return worst;
+}
+
+double gbPerSecond(double bytes, double ms) { return bytes / (ms * 1e6); }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    const int repeats = argc > 2 ? std::atoi(argv[2]) : 5;
+#if defined(__F16C__)
+    const char* build = "F16C";
+#elif defined(__SSE2__)
+    const char* build = "SSE2";
+#else
+    const char* build = "scalar";
+#endif
+    std::printf("Packed storage benchmark: %zu entities, best of %d, half conversion: %s\n\n", count, repeats, build);
+
+    FullState full;
+    full.resize(count);
+    BenchRng rng{42u};
+    for (std::size_t i = 0; i < count; ++i) {
+        full.x[i] = rng.range(-kWorldHalf, kWorldHalf);
+        full.y[i] = rng.range(-kWorldHalf, kWorldHalf);
+        full.r[i] = rng.next();
+        full.g[i] = rng.next();
+        full.b[i] = rng.next();
+        full.a[i] = rng.range(0.5f, 1.0f);
+        full.phase[i] = rng.next();
+        full.rate[i] = rng.range(0.5f, 2.0f);
+    }
+    PackedState packed;
+    packed.resize(count);
+    FullState unpacked;
+    unpacked.resize(count);
+
+    const double packMs = bestMs(repeats, [&] { pack(full, packed); });
+    const double unpackMs = bestMs(repeats, [&] { unpack(packed, 0, count, unpacked); });
+
+    double fullSum = 0.0, packedSum = 0.0;
+    const double fullScanMs = bestMs(repeats, [&] {
+        fullSum = 0.0;
+        accumulate(full, 0, count, fullSum);
+    });
+    FullState scratch;
+    scratch.resize(kBlock);
+    const double packedScanMs = bestMs(repeats, [&] {
+        packedSum = 0.0;
+        for (std::size_t first = 0; first < count; first += kBlock) {
+            const std::size_t n = std::min(kBlock, count - first);
+            unpack(packed, first, n, scratch);
+            accumulate(scratch, 0, n, packedSum);
+        }
+    });
+
+    const double fullMb = kFullBytes * static_cast<double>(count) / (1024.0 * 1024.0);
+    const double packedMb = kPackedBytes * static_cast<double>(count) / (1024.0 * 1024.0);
+    std::printf("%-8s %8s %8s %10s %10s\n", "", "bytes", "MiB", "scan", "GB/s");
+    std::printf("%-8s %8.0f %8.1f %7.2f ms %10.2f\n", "full", kFullBytes, fullMb, fullScanMs,
+                gbPerSecond(kFullBytes * static_cast<double>(count), fullScanMs));
+    std::printf("%-8s %8.0f %8.1f %7.2f ms %10.2f   (%.2fx the full scan)\n", "packed", kPackedBytes, packedMb,
+                packedScanMs, gbPerSecond(kPackedBytes * static_cast<double>(count), packedScanMs),
+                fullScanMs / packedScanMs);
+    std::printf("\npack %.2f ms, unpack %.2f ms (%.1f / %.1f ns per entity)\n", packMs, unpackMs,
+                packMs * 1e6 / static_cast<double>(count), unpackMs * 1e6 / static_cast<double>(count));
+    std::printf("max error: position %.5f, colour %.5f, phase %.5f, rate %.5f\n",
+                std::max(maxError(full.x, unpacked.x), maxError(full.y, unpacked.y)),
+                std::max({maxError(full.r, unpacked.r), maxError(full.g, unpacked.g), maxError(full.b, unpacked.b),
+                          maxError(full.a, unpacked.a)}),
+                maxError(full.phase, unpacked.phase), maxError(full.rate, unpacked.rate));
+    std::printf("scan sums: full %.1f, packed %.1f\n", fullSum, packedSum);
+    return 0;
+}
@@ -0,0 +1,128 @@
+// Software rasterizer benchmark
+// -----------------------------
+// The bench scenes (bench/bench.h) drawn by SoftRasterizer (render/soft_raster.h): the
+// same deterministic quads and camera pan as `game --bench`, with no window, no GL
+// context and no GPU. Two uses:
+//
+// | Use                 | How                                                           |
+// | ------------------- | ------------------------------------------------------------- |
+// | CI without a GPU    | the scenes still run, and --out=FILE.png writes the last      |
+// |                     | frame for a visual regression diff (same frames every run)    |
+// | CPU-side cost alone | compose + cull-free draw per frame, nothing of the driver's:  |
+// |                     | frame times next to --bench's show what the driver adds       |
+//
+// Standalone: `make soft-bench` builds and runs it with the defaults.
+// Usage: soft_bench [--bench-quads=N] [--bench-scene=moving|static|overlap]
+//                   [--bench-frames=N] [--bench-warmup=N] [--bench-world=K]
+//                   [--size=WxH] [--out=FILE.png]
+// The tilemap and particle scenes have no quads: they are refused. Quads are opaque but
+// on the overlap scene, alpha 3/8 and blended, as on the layered path.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "asset/image.h"
+#include "bench/bench.h"
+#include "core/batch_transform.h"
+#include "render/ortho_2d.h"
+#include "render/soft_raster.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// main's bench colors (packColor: 0xAABBGGRR) and a dark clear.
+constexpr std::uint32_t kQuadColor = 0xFF3380FFu;
+constexpr std::uint32_t kOverlapColor = 0x603380FFu;
+constexpr std::uint32_t kClearColor = 0xFF261A1Au;
+
+bool writePng(const Image& image, const char* path) {
+    std::vector<unsigned char> png;
+    encodePng(image, png);
+    std::FILE* file = std::fopen(path, "wb");
+    if (!file) {
+        return false;
+    }
+    const bool written = std::fwrite(png.data(), 1, png.size(), file) == png.size();
+    return std::fclose(file) == 0 && written;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    int width = 1280, height = 720;
+    const char* out = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--size=", 7) == 0) {
+            if (std::sscanf(argv[i] + 7, "%dx%d", &width, &height) != 2 || width < 1 || height < 1) {
+                std::cerr << "soft_bench: bad size " << argv[i] << "\n";
+                return 1;
+            }
+        } else if (std::strncmp(argv[i], "--out=", 6) == 0) {
+            out = argv[i] + 6;
+        } else if (!parseBenchOption(argv[i], options)) {
+            std::cerr << "soft_bench: unknown option " << argv[i] << "\n";
+            return 1;
+        }
+    }
+    if (benchSceneQuads(options) == 0) {
+        std::cerr << "soft_bench: --bench-scene=" << benchSceneName(options.scene) << " has no quads\n";
+        return 1;
+    }
+
+    const float aspect = static_cast<float>(width) / static_cast<float>(height);
+    BenchScene scene;
+    scene.init(options.quads, aspect, options.world, options.scene);
+    SoftRasterizer raster;
+    raster.resize(width, height);
+    const bool overlap = options.scene == BenchSceneKind::Overlap;
+    const SoftRasterizer::Blend blend = overlap ? SoftRasterizer::Blend::Alpha : SoftRasterizer::Blend::Opaque;
+    std::vector<Affine2D> models(scene.size());
+    std::vector<std::uint32_t> colors(scene.size(), overlap ? kOverlapColor : kQuadColor);
+
+    BenchReport report;
+    report.reserve(options.frames);
+    SoftRasterizer::Stats pixels;
+    const int total = options.warmup + options.frames;
+    for (int frame = 0; frame < total; ++frame) {
+        const Clock::time_point start = Clock::now();
+        scene.update(static_cast<std::uint64_t>(frame));
+        composeAffine2D(scene.transforms(), models.data());
+        const glm::vec2 camera = scene.cameraPosition(static_cast<std::uint64_t>(frame));
+        raster.setCamera(Ortho2D::projection(aspect, 1.0f) * Ortho2D::translation(-camera.x, -camera.y));
+        raster.resetStats();
+        raster.clear(kClearColor);
+        raster.drawQuads(models.data(), colors.data(), models.size(), blend);
+        const std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+        if (frame >= options.warmup) {
+            RenderStats stats;
+            stats.drawCalls = 1;
+            stats.instances = raster.stats().quads;
+            stats.vertices = raster.stats().quads * RenderStats::kQuadVertices;
+            report.addFrame(elapsed.count(), stats, models.size() * 2);
+            pixels.pixelsTested += raster.stats().pixelsTested;
+            pixels.pixelsCovered += raster.stats().pixelsCovered;
+        }
+    }
+
+    char label[128];
+    std::snprintf(label, sizeof label, "software, %s, %d quads, %dx%d", benchSceneName(options.scene), options.quads,
+                  width, height);
+    report.print(std::cout, label);
+    const double frames = static_cast<double>(options.frames);
+    std::printf("  pixels per frame: %.0f tested, %.0f covered\n", static_cast<double>(pixels.pixelsTested) / frames,
+                static_cast<double>(pixels.pixelsCovered) / frames);
+    if (out != nullptr) {
+        if (!writePng(raster.image(), out)) {
+            std::cerr << "soft_bench: can't write " << out << "\n";
+            return 1;
+        }
+        std::printf("  last frame: %s\n", out);
+    }
+    return 0;
+}
@@ -0,0 +1,248 @@
+// Spatial index benchmark
+// -----------------------
+// UniformGrid vs LooseQuadtree (core/spatial_index.h) on the operations the game does:
+//
+// | Benchmark  | What the game does with it                                        |
+// | ---------- | ----------------------------------------------------------------- |
+// | rebuild    | level load: every object inserted at once                         |
+// | update     | every object moved a little (one frame of motion), then update()  |
+// | queryRect  | culling: the objects under a view-sized rectangle                 |
+// | queryPoint | picking: the objects under the cursor                             |
+// | raycast    | shots: the first object along a random 8-unit segment             |
+// | sight      | line of sight between nearby object pairs (core/spatial_query.h), |
+// |            | one thread and then the whole job system                          |
+//
+// The two sweeps run on about 1024 of the scene's objects: with all of them the world is
+// solid and every sweep stops at once.
+//
+// Two scenes with the same object count:
+//
+// | Scene     | Layout                                                                |
+// | --------- | --------------------------------------------------------------------- |
+// | uniform   | objects spread evenly over a 32 x 32 world                            |
+// | clustered | 90% packed into 8 small clusters, the rest spread out; 1% are big     |
+//
+// The clustered scene is the one the quadtree exists for: the grid's cells there are
+// sized for the average density, so cluster cells hold hundreds of objects and the big
+// objects sit in dozens of cells each.
+//
+// Standalone: no window, no GL context. `make spatial-bench` builds and runs it.
+// Usage: spatial_bench [objects=100000] [repeats=5]
+// Reports the best of `repeats` runs per benchmark. "hits" (average results per query),
+// and the raycast hit and sight blocked percentages, must match between the two
+// indexes—a quick check that both return the same sets.
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "bench/bench.h"
+#include "core/job_system.h"
+#include "core/loose_quadtree.h"
+#include "core/spatial_query.h"
+#include "core/uniform_grid.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr float kWorldHalf = 16.0f;
+constexpr int kQueries = 1024;
+constexpr int kSweeps = 16384;               // rays, and agent pairs for line of sight
+constexpr float kRayLength = 8.0f;
+constexpr float kSightRange = 3.0f;
+constexpr std::size_t kSweepObjects = 1024;  // the sweeps' scene: see runSweeps()
+const glm::vec2 kViewHalf(16.0f / 9.0f, 1.0f); // default ortho view at 16:9
+
+struct Scene {
+    const char* name;
+    std::vector<glm::vec2> center;
+    std::vector<float> radius;
+    std::vector<glm::vec2> velocity;
+};
+
+Scene makeUniform(std::size_t count) {
+    Scene s{"uniform", {}, {}, {}};
+    BenchRng rng{42u};
+    for (std::size_t i = 0; i < count; ++i) {
+        s.center.emplace_back(rng.range(-kWorldHalf, kWorldHalf), rng.range(-kWorldHalf, kWorldHalf));
+        s.radius.push_back(rng.range(0.02f, 0.08f));
+        s.velocity.emplace_back(rng.range(-0.01f, 0.01f), rng.range(-0.01f, 0.01f));
+    }
+    return s;
+}
+
+Scene makeClustered(std::size_t count) {
+    Scene s{"clustered", {}, {}, {}};
+    BenchRng rng{7u};
+    glm::vec2 clusters[8];
+    for (glm::vec2& c : clusters) {
+        c = glm::vec2(rng.range(-kWorldHalf, kWorldHalf) * 0.8f, rng.range(-kWorldHalf, kWorldHalf) * 0.8f);
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        glm::vec2 p;
+        if (i % 10 != 0) {
+            p = clusters[i % 8] + glm::vec2(rng.range(-1.0f, 1.0f), rng.range(-1.0f, 1.0f));
+        } else {
+            p = glm::vec2(rng.range(-kWorldHalf, kWorldHalf), rng.range(-kWorldHalf, kWorldHalf));
+        }
+        s.center.push_back(p);
+        s.radius.push_back(i % 100 == 0 ? rng.range(0.5f, 2.0f) : rng.range(0.005f, 0.02f));
+        s.velocity.emplace_back(rng.range(-0.005f, 0.005f), rng.range(-0.005f, 0.005f));
+    }
+    return s;
+}
+
+void boundsOf(const Scene& s, std::vector<Aabb>& out) {
+    out.resize(s.center.size());
+    for (std::size_t i = 0; i < out.size(); ++i) {
+        out[i] = Aabb::around(s.center[i], s.radius[i]);
+    }
+}
+
+template <typename Fn>
+double bestMs(int repeats, Fn&& body) {
+    double best = 1e300;
+    for (int r = 0; r < repeats; ++r) {
+        Clock::time_point start = Clock::now();
+        body();
+        std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+        if (elapsed.count() < best) best = elapsed.count();
+    }
+    return best;
+}
+
+struct SweepResults {
+    double rayNs, sightNs, sightParallelNs;
+    double rayHitPercent, blockedPercent;
+};
+
+// After run(): rebuilds `index` with every stride-th object of the moved scene, about
+// kSweepObjects of them. At the full count the world is solid (the uniform scene has an
+// object under every point, the clustered one's big objects cover it several times
+// over): every sight line would be blocked at once, only the early out timed and the
+// indexes' answers compared on nothing.
+SweepResults runSweeps(SpatialIndex& index, const Scene& scene, JobSystem& jobs, int repeats) {
+    const std::size_t stride = std::max<std::size_t>(1, scene.center.size() / kSweepObjects);
+    std::vector<glm::vec2> center;
+    std::vector<Aabb> bounds;
+    for (std::size_t i = 0; i < scene.center.size(); i += stride) {
+        center.push_back(scene.center[i]);
+        bounds.push_back(Aabb::around(scene.center[i], scene.radius[i]));
+    }
+    index.rebuild(bounds.data(), bounds.size());
+    const std::size_t n = center.size();
+    std::vector<SweepQuery> rays(kSweeps), sight(kSweeps);
+    BenchRng rng{123u};
+    for (SweepQuery& q : rays) {
+        const float angle = rng.range(0.0f, 6.2831853f);
+        const glm::vec2 from(rng.range(-kWorldHalf, kWorldHalf), rng.range(-kWorldHalf, kWorldHalf));
+        q = SweepQuery::segment(from, from + glm::vec2(std::cos(angle), std::sin(angle)) * kRayLength);
+    }
+    // An agent looking at another within kSightRange: neither blocks the view itself.
+    for (SweepQuery& q : sight) {
+        const ObjectId a = static_cast<ObjectId>(rng.next() * static_cast<float>(n)) % n;
+        const glm::vec2 offset(rng.range(-kSightRange, kSightRange), rng.range(-kSightRange, kSightRange));
+        ObjectId b = a;
+        for (int tries = 0; tries < 64 && (b == a || glm::length(center[b] - center[a]) > kSightRange);
+             ++tries) {
+            b = static_cast<ObjectId>(rng.next() * static_cast<float>(n)) % n;
+        }
+        q = SweepQuery::segment(center[a], b == a ? center[a] + offset : center[b]);
+        q.ignore[0] = a;
+        q.ignore[1] = b;
+    }
+    std::vector<SweepHit> hits(kSweeps);
+    std::vector<std::uint8_t> blocked(kSweeps);
+    SweepResults r{};
+    r.rayNs = bestMs(repeats, [&] { sweepClosest(index, rays.data(), rays.size(), hits.data()); }) * 1e6 / kSweeps;
+    r.sightNs =
+        bestMs(repeats, [&] { sweepBlocked(index, sight.data(), sight.size(), blocked.data()); }) * 1e6 / kSweeps;
+    std::size_t rayHits = 0, sightBlocked = 0;
+    for (const SweepHit& h : hits) rayHits += h.hit() ? 1 : 0;
+    for (std::uint8_t b : blocked) sightBlocked += b;
+    r.sightParallelNs = bestMs(repeats, [&] {
+        sweepBlockedParallel(jobs, index, sight.data(), sight.size(), blocked.data());
+    }) * 1e6 / kSweeps;
+    r.rayHitPercent = 100.0 * static_cast<double>(rayHits) / kSweeps;
+    r.blockedPercent = 100.0 * static_cast<double>(sightBlocked) / kSweeps;
+    return r;
+}
+
+void run(const char* indexName, SpatialIndex& index, Scene scene, JobSystem& jobs, int repeats) {
+    const std::size_t n = scene.center.size();
+    std::vector<Aabb> bounds;
+    boundsOf(scene, bounds);
+
+    const double rebuildMs = bestMs(repeats, [&] { index.rebuild(bounds.data(), n); });
+
+    // One frame of motion per repeat; objects drift, most stay in their cell/node.
+    const double updateMs = bestMs(repeats, [&] {
+        for (std::size_t i = 0; i < n; ++i) {
+            scene.center[i] += scene.velocity[i];
+            index.update(static_cast<ObjectId>(i), Aabb::around(scene.center[i], scene.radius[i]));
+        }
+    });
+
+    // Same query positions for both indexes (fixed seed).
+    std::vector<glm::vec2> at(kQueries);
+    BenchRng rng{99u};
+    for (glm::vec2& p : at) {
+        p = glm::vec2(rng.range(-kWorldHalf, kWorldHalf), rng.range(-kWorldHalf, kWorldHalf));
+    }
+    std::vector<ObjectId> hits;
+    std::size_t rectHits = 0, pointHits = 0;
+    const double rectMs = bestMs(repeats, [&] {
+        rectHits = 0;
+        for (const glm::vec2& p : at) {
+            hits.clear();
+            index.queryRect(Aabb{p - kViewHalf, p + kViewHalf}, hits);
+            rectHits += hits.size();
+        }
+    });
+    const double pointMs = bestMs(repeats, [&] {
+        pointHits = 0;
+        for (const glm::vec2& p : at) {
+            hits.clear();
+            index.queryPoint(p, hits);
+            pointHits += hits.size();
+        }
+    });
+
+    std::printf("%-9s %-9s %8.2f ms %8.1f ns/obj %8.1f us/q %6.1f hits %7.0f ns/q %5.2f hits %7.2f MB\n",
+                scene.name, indexName, rebuildMs, updateMs * 1e6 / static_cast<double>(n),
+                rectMs * 1e3 / kQueries, static_cast<double>(rectHits) / kQueries,
+                pointMs * 1e6 / kQueries, static_cast<double>(pointHits) / kQueries,
+                static_cast<double>(index.memoryBytes()) / (1024.0 * 1024.0));
+
+    const SweepResults sweeps = runSweeps(index, scene, jobs, repeats);
+    std::printf("%-9s %-9s raycast %7.0f ns/q %5.1f%% hit   sight %7.0f ns/q %5.1f%% blocked, %3u threads %6.0f ns/q\n",
+                "", "", sweeps.rayNs, sweeps.rayHitPercent, sweeps.sightNs, sweeps.blockedPercent,
+                jobs.threadCount(), sweeps.sightParallelNs);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    const int repeats = argc > 2 ? std::atoi(argv[2]) : 5;
+    std::printf("Spatial index benchmark: %zu objects, best of %d\n\n", count, repeats);
+    std::printf("%-9s %-9s %11s %15s %26s %23s %10s\n", "scene", "index", "rebuild", "update",
+                "queryRect (view)", "queryPoint", "memory");
+
+    JobSystem jobs;
+    jobs.init();
+    const Scene scenes[] = {makeUniform(count), makeClustered(count)};
+    for (const Scene& scene : scenes) {
+        UniformGrid grid(0.25f);
+        LooseQuadtree tree(Aabb{glm::vec2(-kWorldHalf), glm::vec2(kWorldHalf)}, 10);
+        run("grid", grid, scene, jobs, repeats);
+        run("quadtree", tree, scene, jobs, repeats);
+    }
+    return 0;
+}
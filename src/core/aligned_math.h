@@ -0,0 +1,87 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#if GLM_CONFIG_ALIGNED_GENTYPES == GLM_ENABLE
+#include <glm/gtc/type_aligned.hpp>
+#endif
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// Aligned math
+// ------------
+// Two kinds of "aligned" for the hot paths:
+//
+// | What                  | For                                                          |
+// | --------------------- | ------------------------------------------------------------ |
+// | AlignedVector<T>      | SoA arrays (Transforms2D, ParticlesSoA, CollisionBodies...): |
+// |                       | element 0 on a 32-byte boundary, so an SSE (16) or AVX (32)  |
+// |                       | load of elements [8k, 8k + 8) never splits a cache line      |
+// | AlignedVec4/Mat4      | GLM's aligned_highp types: the ones GLM_FORCE_INTRINSICS     |
+// |                       | (Makefile) sends through its SSE code in include/glm/simd    |
+//
+// glm::vec4/mat4 stay packed_highp everywhere else, and that's deliberate: they are laid
+// out for the GPU (CameraBlock, instance buffers, vertex formats), and the
+// GLM_FORCE_DEFAULT_ALIGNED_GENTYPES that would make them aligned also pads glm::vec3 to
+// 16 bytes, which breaks Affine2D and every vec3 vertex attribute. Aligned types are for
+// CPU-only math; convert at the edges (`AlignedMat4(m)`, `glm::mat4(a)`).
+//
+// `make glm-bench` (src/bench/glm_bench.cpp) measures both. What GLM's SIMD is worth on
+// this machine, aligned vs packed:
+//
+// | Operation         | Aligned vs packed                                           |
+// | ----------------- | ----------------------------------------------------------- |
+// | inverse           | ~1.8x faster (inverseOf(m, General), core/matrix_inverse.h) |
+// | mat4 * mat4       | the same: a million of them are memory-bound either way     |
+// | translate, scale  | the same or slower; batch_transform's SSE kernel beats both |
+//
+// Without aligned gentypes (a tool built without the Makefile's GLM flags) the aliases
+// fall back to the packed types, so code using them compiles everywhere.
+
+// The SoA alignment: one AVX register, two SSE ones.
+constexpr std::size_t kSimdAlign = 32;
+
+#if GLM_CONFIG_ALIGNED_GENTYPES == GLM_ENABLE
+using AlignedVec4 = glm::aligned_vec4;
+using AlignedMat4 = glm::aligned_mat4;
+#else
+using AlignedVec4 = glm::vec4;
+using AlignedMat4 = glm::mat4;
+#endif
+
+// AlignedAllocator<T, Align>
+// --------------------------
+// STL allocator whose storage starts on an Align-byte boundary (C++17 aligned new).
+template <typename T, std::size_t Align = kSimdAlign>
+class AlignedAllocator {
+public:
+    static_assert(Align >= alignof(T) && (Align & (Align - 1)) == 0, "Align: a power of two, at least alignof(T)");
+    using value_type = T;
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Align>;
+    };
+    using is_always_equal = std::true_type;
+
+    AlignedAllocator() = default;
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Align>&) {}
+
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Align)));
+    }
+    void deallocate(T* p, std::size_t) { ::operator delete(p, std::align_val_t(Align)); }
+};
+
+template <typename T, typename U, std::size_t Align>
+bool operator==(const AlignedAllocator<T, Align>&, const AlignedAllocator<U, Align>&) {
+    return true;
+}
+template <typename T, typename U, std::size_t Align>
+bool operator!=(const AlignedAllocator<T, Align>&, const AlignedAllocator<U, Align>&) {
+    return false;
+}
+
+template <typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+
+// Heap allocation counters
+// ------------------------
+// alloc_counter.cpp replaces the global operator new / delete (all the C++17 forms:
+// sized, aligned, nothrow, arrays) with ones that count before calling malloc / free.
+// Everything that allocates through new—std::vector, std::string, std::function,
+// make_shared...—is counted; direct malloc calls (C libraries, the GL driver) are not.
+//
+// Counting is two thread_local increments and two relaxed atomic adds, so it is on in
+// every config by default. A frame's count is the difference of two reads:
+//
+//     const std::uint64_t before = alloccount::thread();
+//     ... one frame ...
+//     const std::uint64_t allocations = alloccount::thread() - before;  // want: 0
+//
+// The per-frame numbers end up in the bench report (bench/bench.h), which with
+// --bench-zero-alloc fails the run if a steady-state frame allocated at all, and per
+// profiler section in Profiler::report() / reportAllocations(): a std::string built in
+// the draw section shows up as "draw 1.00 allocs".
+//
+// Built with ALLOC_HOOK=0 (make ALLOC_HOOK=0) the replacement operators are left out,
+// every counter stays 0 and enabled() is false.
+#ifndef ALLOC_HOOK
+#define ALLOC_HOOK 1
+#endif
+
+namespace alloccount {
+
+constexpr bool enabled() { return ALLOC_HOOK != 0; }
+
+std::uint64_t thread();       // allocations made by the calling thread so far
+std::uint64_t threadBytes();  // bytes they requested
+std::uint64_t total();        // allocations by every thread
+std::uint64_t totalBytes();   // bytes requested, every thread
+
+} // namespace alloccount
@@ -0,0 +1,190 @@
+#include "core/batch_transform.h"
+
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+void composeScalar(const Transforms2D& t, std::size_t begin, std::size_t end, glm::mat4* out,
+                   const WorldPosition& origin) {
+    for (std::size_t i = begin; i < end; ++i) {
+        const float c = std::cos(t.rotation[i]);
+        const float s = std::sin(t.rotation[i]);
+        glm::mat4& m = *out++;
+        m[0] = glm::vec4(c * t.scaleX[i], s * t.scaleX[i], 0.0f, 0.0f);
+        m[1] = glm::vec4(-s * t.scaleY[i], c * t.scaleY[i], 0.0f, 0.0f);
+        m[2] = glm::vec4(0.0f, 0.0f, 1.0f, 0.0f);
+        m[3] = glm::vec4(origin.relative(glm::vec2(t.x[i], t.y[i])), 0.0f, 1.0f);
+    }
+}
+
+void composeAffineScalar(const Transforms2D& t, std::size_t begin, std::size_t end, Affine2D* out,
+                         const WorldPosition& origin) {
+    for (std::size_t i = begin; i < end; ++i) {
+        const float c = std::cos(t.rotation[i]);
+        const float s = std::sin(t.rotation[i]);
+        const glm::vec2 p = origin.relative(glm::vec2(t.x[i], t.y[i]));
+        out->row0 = glm::vec3(c * t.scaleX[i], -s * t.scaleY[i], p.x);
+        out->row1 = glm::vec3(s * t.scaleX[i], c * t.scaleY[i], p.y);
+        ++out;
+    }
+}
+
+#if defined(__SSE2__)
+
+// Four sines and cosines at once (Cephes sinf/cosf polynomials, ~1 ulp for |x| < ~8000).
+//   1. j = round(x / (pi/2))          which quarter turn x falls in
+//   2. r = x - j * pi/2               remainder in [-pi/4, pi/4] (pi/2 split in 3 parts
+//                                     so the subtraction stays exact)
+//   3. polynomial sin(r), cos(r)
+//   4. quadrant j & 3 swaps and/or negates them
+void sinCos4(__m128 x, __m128& sinOut, __m128& cosOut) {
+    const __m128i j = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(0.63661977236f))); // 2/pi
+    const __m128 jf = _mm_cvtepi32_ps(j);
+    __m128 r = _mm_sub_ps(x, _mm_mul_ps(jf, _mm_set1_ps(1.5703125f)));
+    r = _mm_sub_ps(r, _mm_mul_ps(jf, _mm_set1_ps(4.837512969970703125e-4f)));
+    r = _mm_sub_ps(r, _mm_mul_ps(jf, _mm_set1_ps(7.54978995489188216e-8f)));
+    const __m128 r2 = _mm_mul_ps(r, r);
+
+    __m128 s = _mm_set1_ps(-1.9515295891e-4f);
+    s = _mm_add_ps(_mm_mul_ps(s, r2), _mm_set1_ps(8.3321608736e-3f));
+    s = _mm_add_ps(_mm_mul_ps(s, r2), _mm_set1_ps(-1.6666654611e-1f));
+    s = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(s, r2), r), r);
+
+    __m128 c = _mm_set1_ps(2.443315711809948e-5f);
+    c = _mm_add_ps(_mm_mul_ps(c, r2), _mm_set1_ps(-1.388731625493765e-3f));
+    c = _mm_add_ps(_mm_mul_ps(c, r2), _mm_set1_ps(4.166664568298827e-2f));
+    c = _mm_mul_ps(_mm_mul_ps(c, r2), r2);
+    c = _mm_add_ps(_mm_sub_ps(c, _mm_mul_ps(r2, _mm_set1_ps(0.5f))), _mm_set1_ps(1.0f));
+
+    // | j & 3 | sin(x) | cos(x) |
+    // | ----- | ------ | ------ |
+    // | 0     |  s     |  c     |
+    // | 1     |  c     | -s     |
+    // | 2     | -s     | -c     |
+    // | 3     | -c     |  s     |
+    const __m128i one = _mm_set1_epi32(1);
+    const __m128i two = _mm_set1_epi32(2);
+    const __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(j, one), one));
+    const __m128 sinSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(j, two), 30));
+    const __m128 cosSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(j, one), two), 30));
+
+    sinOut = _mm_or_ps(_mm_and_ps(swap, c), _mm_andnot_ps(swap, s));
+    cosOut = _mm_or_ps(_mm_and_ps(swap, s), _mm_andnot_ps(swap, c));
+    sinOut = _mm_xor_ps(sinOut, sinSign);
+    cosOut = _mm_xor_ps(cosOut, cosSign);
+}
+
+// Four positions relative to the origin on one axis, in the order relative() rounds:
+// the sector corner first (exact), then the offset within the sector.
+__m128 relative4(__m128 p, __m128 base, __m128 offset) {
+    return _mm_sub_ps(_mm_sub_ps(p, base), offset);
+}
+
+// Four objects per iteration. Columns are built by interleaving the SoA lanes:
+//     unpacklo(A, B) = A0 B0 A1 B1   →   movelh(.., 0) = A0 B0 0 0 (object 0)
+//                                         movehl(0, ..) = A1 B1 0 0 (object 1)
+std::size_t composeSse2(const Transforms2D& t, std::size_t begin, std::size_t end, glm::mat4* out,
+                        const WorldPosition& origin) {
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 baseX = _mm_set1_ps(origin.base().x), baseY = _mm_set1_ps(origin.base().y);
+    const __m128 offsetX = _mm_set1_ps(origin.offset.x), offsetY = _mm_set1_ps(origin.offset.y);
+    const __m128 zeroOne = _mm_set_ps(1.0f, 0.0f, 1.0f, 0.0f);   // lanes: 0 1 0 1
+    const __m128 col2 = _mm_set_ps(0.0f, 1.0f, 0.0f, 0.0f);      // 0 0 1 0
+    float* dst = &(*out)[0][0];
+
+    std::size_t i = begin;
+    for (; i + 4 <= end; i += 4, dst += 64) {
+        __m128 s, c;
+        sinCos4(_mm_loadu_ps(&t.rotation[i]), s, c);
+        const __m128 sx = _mm_loadu_ps(&t.scaleX[i]);
+        const __m128 sy = _mm_loadu_ps(&t.scaleY[i]);
+
+        const __m128 a = _mm_mul_ps(c, sx);                  // m[0][0]
+        const __m128 b = _mm_mul_ps(s, sx);                  // m[0][1]
+        const __m128 d = _mm_sub_ps(zero, _mm_mul_ps(s, sy)); // m[1][0]
+        const __m128 e = _mm_mul_ps(c, sy);                  // m[1][1]
+        const __m128 px = relative4(_mm_loadu_ps(&t.x[i]), baseX, offsetX);
+        const __m128 py = relative4(_mm_loadu_ps(&t.y[i]), baseY, offsetY);
+
+        const __m128 col0[2] = {_mm_unpacklo_ps(a, b), _mm_unpackhi_ps(a, b)};
+        const __m128 col1[2] = {_mm_unpacklo_ps(d, e), _mm_unpackhi_ps(d, e)};
+        const __m128 col3[2] = {_mm_unpacklo_ps(px, py), _mm_unpackhi_ps(px, py)};
+
+        for (int half = 0; half < 2; ++half) {
+            float* m0 = dst + 32 * half;  // objects 2*half and 2*half + 1
+            float* m1 = m0 + 16;
+            _mm_storeu_ps(m0 + 0, _mm_movelh_ps(col0[half], zero));
+            _mm_storeu_ps(m0 + 4, _mm_movelh_ps(col1[half], zero));
+            _mm_storeu_ps(m0 + 8, col2);
+            _mm_storeu_ps(m0 + 12, _mm_movelh_ps(col3[half], zeroOne));
+            _mm_storeu_ps(m1 + 0, _mm_movehl_ps(zero, col0[half]));
+            _mm_storeu_ps(m1 + 4, _mm_movehl_ps(zero, col1[half]));
+            _mm_storeu_ps(m1 + 8, col2);
+            _mm_storeu_ps(m1 + 12, _mm_movehl_ps(zeroOne, col3[half]));
+        }
+    }
+    return i;
+}
+
+// 4 objects = 24 floats = exactly six 16-byte stores. The matrix terms are computed
+// 4-wide, then interleaved through a small aligned block (6 floats per object don't map
+// onto SSE lanes as neatly as mat4 columns do).
+std::size_t composeAffineSse2(const Transforms2D& t, std::size_t begin, std::size_t end, Affine2D* out,
+                              const WorldPosition& origin) {
+    const __m128 baseX = _mm_set1_ps(origin.base().x), baseY = _mm_set1_ps(origin.base().y);
+    const __m128 offsetX = _mm_set1_ps(origin.offset.x), offsetY = _mm_set1_ps(origin.offset.y);
+    alignas(16) float terms[6][4];
+    alignas(16) float packed[24];
+    float* dst = &out->row0.x;
+
+    std::size_t i = begin;
+    for (; i + 4 <= end; i += 4, dst += 24) {
+        __m128 s, c;
+        sinCos4(_mm_loadu_ps(&t.rotation[i]), s, c);
+        const __m128 sx = _mm_loadu_ps(&t.scaleX[i]);
+        const __m128 sy = _mm_loadu_ps(&t.scaleY[i]);
+        _mm_store_ps(terms[0], _mm_mul_ps(c, sx));
+        _mm_store_ps(terms[1], _mm_sub_ps(_mm_setzero_ps(), _mm_mul_ps(s, sy)));
+        _mm_store_ps(terms[2], relative4(_mm_loadu_ps(&t.x[i]), baseX, offsetX));
+        _mm_store_ps(terms[3], _mm_mul_ps(s, sx));
+        _mm_store_ps(terms[4], _mm_mul_ps(c, sy));
+        _mm_store_ps(terms[5], relative4(_mm_loadu_ps(&t.y[i]), baseY, offsetY));
+        for (int object = 0; object < 4; ++object) {
+            for (int term = 0; term < 6; ++term) {
+                packed[object * 6 + term] = terms[term][object];
+            }
+        }
+        for (int v = 0; v < 6; ++v) {
+            _mm_storeu_ps(dst + 4 * v, _mm_load_ps(packed + 4 * v));
+        }
+    }
+    return i;
+}
+
+#endif // __SSE2__
+
+} // namespace
+
+void composeModelMatrices(const Transforms2D& transforms, std::size_t first, std::size_t count,
+                          glm::mat4* out, const WorldPosition& origin) {
+    std::size_t i = first;
+    const std::size_t end = first + count;
+#if defined(__SSE2__)
+    i = composeSse2(transforms, first, end, out, origin);
+#endif
+    composeScalar(transforms, i, end, out + (i - first), origin); // tail (or everything without SSE2)
+}
+
+void composeAffine2D(const Transforms2D& transforms, std::size_t first, std::size_t count,
+                     Affine2D* out, const WorldPosition& origin) {
+    std::size_t i = first;
+    const std::size_t end = first + count;
+#if defined(__SSE2__)
+    i = composeAffineSse2(transforms, first, end, out, origin);
+#endif
+    composeAffineScalar(transforms, i, end, out + (i - first), origin);
+}
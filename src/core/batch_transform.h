@@ -0,0 +1,130 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <vector>
+
+#include "core/aligned_math.h"
+#include "core/world_position.h"
+
+// Transforms2D
+// ------------
+// Position / rotation / scale of many 2D objects, stored as a structure of arrays (SoA):
+// one array per component instead of one struct per object.
+//
+//     AoS:  x y r sx sy | x y r sx sy | x y r sx sy | ...
+//     SoA:  x x x x ... | y y y y ... | r r r r ... | ...
+//
+// With SoA, four consecutive objects' x values are one 16-byte load, so the kernel below
+// processes four objects per SSE instruction instead of one. Each array is an
+// AlignedVector (core/aligned_math.h): those loads never straddle a cache line.
+struct Transforms2D {
+    AlignedVector<float> x, y;            // world position
+    AlignedVector<float> rotation;        // radians, counter-clockwise
+    AlignedVector<float> scaleX, scaleY;
+
+    std::size_t size() const { return x.size(); }
+    void resize(std::size_t count) {
+        x.resize(count);
+        y.resize(count);
+        rotation.resize(count, 0.0f);
+        scaleX.resize(count, 1.0f);
+        scaleY.resize(count, 1.0f);
+    }
+};
+
+// composeModelMatrices
+// --------------------
+// out[i] = translate(x, y) * rotateZ(rotation) * scale(scaleX, scaleY) for objects
+// [first, first + count), the translation relative to `origin` (origin.relative(x, y):
+// 0, the default, leaves it in world space; core/world_position.h). Same result as the glm::translate/rotate/scale chain, without
+// building and multiplying three full mat4s per object:
+//
+//     | c*sx  -s*sy  0  x |      c = cos(rotation)
+//     | s*sx   c*sy  0  y |      s = sin(rotation)
+//     |  0      0    1  0 |
+//     |  0      0    0  1 |
+//
+// SSE2 path (every x86-64 CPU): four objects per iteration, sin/cos evaluated with a
+// 4-wide polynomial, 16-byte stores. Other targets use the scalar loop.
+//
+// `out` may point straight into mapped GPU memory (InstancedQuadRenderer::mapInstances):
+// every matrix is written once, front to back, and never read back—what write-combined
+// memory wants.
+void composeModelMatrices(const Transforms2D& transforms, std::size_t first, std::size_t count,
+                          glm::mat4* out, const WorldPosition& origin = WorldPosition{});
+
+inline void composeModelMatrices(const Transforms2D& transforms, glm::mat4* out,
+                                 const WorldPosition& origin = WorldPosition{}) {
+    composeModelMatrices(transforms, 0, transforms.size(), out, origin);
+}
+
+// Affine2D
+// --------
+// The two rows of a 2D affine transform that aren't constant (3x2, 6 floats, 24 bytes):
+//
+//     | row0.x  row0.y  row0.z |   | c*sx  -s*sy  x |
+//     | row1.x  row1.y  row1.z | = | s*sx   c*sy  y |
+//     |   0       0       1    |   |  0      0    1 |
+//
+//     world = vec2(dot(row0, vec3(p, 1)), dot(row1, vec3(p, 1)))
+//
+// Everything in this game is flat (vec2 aPos, z = 0), so the other 10 floats of a mat4
+// are always 0 or 1. Per instance that's 24 bytes instead of 64 (-62%) of upload and
+// vertex-fetch bandwidth. Consumed by shaders/vertex.glsl built with AFFINE_2D.
+struct Affine2D {
+    glm::vec3 row0;
+    glm::vec3 row1;
+};
+static_assert(sizeof(Affine2D) == 24, "Affine2D must stay tightly packed (vertex attribute stride)");
+
+// Drops the constant parts of a flat (z-free) model matrix.
+inline Affine2D toAffine2D(const glm::mat4& m) {
+    return Affine2D{glm::vec3(m[0][0], m[1][0], m[3][0]), glm::vec3(m[0][1], m[1][1], m[3][1])};
+}
+
+// The other way: a flat model matrix from its two rows.
+inline glm::mat4 fromAffine2D(const Affine2D& a) {
+    glm::mat4 m(1.0f);
+    m[0][0] = a.row0.x;
+    m[1][0] = a.row0.y;
+    m[3][0] = a.row0.z;
+    m[0][1] = a.row1.x;
+    m[1][1] = a.row1.y;
+    m[3][1] = a.row1.z;
+    return m;
+}
+
+// parent * child, both with the implied third row (0 0 1): child first, then parent.
+inline Affine2D combineAffine2D(const Affine2D& p, const Affine2D& c) {
+    return Affine2D{glm::vec3(p.row0.x * c.row0.x + p.row0.y * c.row1.x, p.row0.x * c.row0.y + p.row0.y * c.row1.y,
+                              p.row0.x * c.row0.z + p.row0.y * c.row1.z + p.row0.z),
+                    glm::vec3(p.row1.x * c.row0.x + p.row1.y * c.row1.x, p.row1.x * c.row0.y + p.row1.y * c.row1.y,
+                              p.row1.x * c.row0.z + p.row1.y * c.row1.z + p.row1.z)};
+}
+
+// The transform that undoes `a`: the 2x2 part inverted, the translation sent back through it.
+inline Affine2D inverseAffine2D(const Affine2D& a) {
+    const float inv = 1.0f / (a.row0.x * a.row1.y - a.row0.y * a.row1.x);
+    const float m00 = a.row1.y * inv, m01 = -a.row0.y * inv;
+    const float m10 = -a.row1.x * inv, m11 = a.row0.x * inv;
+    return Affine2D{glm::vec3(m00, m01, -(m00 * a.row0.z + m01 * a.row1.z)),
+                    glm::vec3(m10, m11, -(m10 * a.row0.z + m11 * a.row1.z))};
+}
+
+// `a` with its translation relative to `origin`: what composeAffine2D would have made of
+// it, for transforms composed elsewhere (a hierarchy, a pick made before the frame's
+// origin was known).
+inline Affine2D relativeAffine2D(const Affine2D& a, const WorldPosition& origin) {
+    const glm::vec2 p = origin.relative(glm::vec2(a.row0.z, a.row1.z));
+    return Affine2D{glm::vec3(a.row0.x, a.row0.y, p.x), glm::vec3(a.row1.x, a.row1.y, p.y)};
+}
+
+// Same as composeModelMatrices, compact output. Same SSE2 sin/cos path, same origin.
+void composeAffine2D(const Transforms2D& transforms, std::size_t first, std::size_t count,
+                     Affine2D* out, const WorldPosition& origin = WorldPosition{});
+
+inline void composeAffine2D(const Transforms2D& transforms, Affine2D* out,
+                            const WorldPosition& origin = WorldPosition{}) {
+    composeAffine2D(transforms, 0, transforms.size(), out, origin);
+}
@@ -0,0 +1,200 @@
+#include "core/block_pool.h"
+
+#include <iostream>
+
+struct BlockPool::Cache {
+    FreeBlock* head = nullptr;
+    std::size_t count = 0;
+    std::uint64_t epoch = 0;           // of the pool the blocks came from
+};
+
+namespace {
+
+// Which pool owns each id right now: a thread flushing its caches at exit must not hand
+// blocks to a pool that was shut down (or to a newer one that reused the id).
+struct Registry {
+    std::mutex mutex;
+    BlockPool* pools[BlockPool::kMaxPools] = {};
+    std::uint64_t epochs[BlockPool::kMaxPools] = {};
+    std::uint64_t nextEpoch = 0;
+};
+
+Registry& registry() {
+    static Registry r;
+    return r;
+}
+
+} // namespace
+
+struct BlockPool::ThreadCaches {
+    Cache caches[kMaxPools];
+
+    ~ThreadCaches() {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        for (int id = 0; id < kMaxPools; ++id) {
+            Cache& c = caches[id];
+            if (c.count > 0 && r.pools[id] != nullptr && r.epochs[id] == c.epoch) {
+                r.pools[id]->flush(c.head, c.count);
+            }
+        }
+    }
+};
+
+bool BlockPool::init(std::size_t blockSize, std::size_t blockAlign, std::size_t blocksPerSlab) {
+    if (id_ >= 0) {
+        return true;
+    }
+    if (blockAlign < sizeof(FreeBlock) || (blockAlign & (blockAlign - 1)) != 0) {
+        std::cerr << "BlockPool: alignment " << blockAlign << " is not a power of two >= a pointer\n";
+        return false;
+    }
+    blockSize = blockSize < sizeof(FreeBlock) ? sizeof(FreeBlock) : blockSize;
+    blockSize_ = (blockSize + blockAlign - 1) / blockAlign * blockAlign;
+    blockAlign_ = blockAlign;
+    blocksPerSlab_ = blocksPerSlab > 0 ? blocksPerSlab : 1;
+
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (int id = 0; id < kMaxPools; ++id) {
+        if (r.pools[id] == nullptr) {
+            r.pools[id] = this;
+            r.epochs[id] = ++r.nextEpoch;
+            id_ = id;
+            epoch_ = r.epochs[id];
+            return true;
+        }
+    }
+    std::cerr << "BlockPool: more than " << kMaxPools << " pools\n";
+    return false;
+}
+
+void BlockPool::shutdown() {
+    if (id_ < 0) {
+        return;
+    }
+    {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.pools[id_] = nullptr;        // from now on, exiting threads drop their caches
+    }
+    // Caches still pointing into the slabs (this thread's too) are dropped by the epoch
+    // check the next time a pool with this id uses them.
+    id_ = -1;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (void* slab : slabs_) {
+        ::operator delete(slab, std::align_val_t(blockAlign_));
+    }
+    slabs_.clear();
+    free_ = nullptr;
+    freeCount_ = 0;
+    handedOut_ = 0;
+}
+
+BlockPool::Cache& BlockPool::cache() {
+    thread_local ThreadCaches threadCaches;
+    Cache& c = threadCaches.caches[id_];
+    if (c.epoch != epoch_) {
+        c = Cache{nullptr, 0, epoch_}; // blocks of a pool that no longer exists
+    }
+    return c;
+}
+
+bool BlockPool::addSlab() {
+    void* slab = ::operator new(blockSize_ * blocksPerSlab_, std::align_val_t(blockAlign_), std::nothrow);
+    if (slab == nullptr) {
+        std::cerr << "BlockPool: cannot allocate a slab of " << blockSize_ * blocksPerSlab_ << " bytes\n";
+        return false;
+    }
+    slabs_.push_back(slab);
+    unsigned char* bytes = static_cast<unsigned char*>(slab);
+    for (std::size_t i = blocksPerSlab_; i-- > 0;) {
+        FreeBlock* block = reinterpret_cast<FreeBlock*>(bytes + i * blockSize_);
+        block->next = free_;
+        free_ = block;
+    }
+    freeCount_ += blocksPerSlab_;
+    return true;
+}
+
+BlockPool::FreeBlock* BlockPool::refill(std::size_t& count) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (free_ == nullptr && !addSlab()) {
+        count = 0;
+        return nullptr;
+    }
+    FreeBlock* head = free_;
+    FreeBlock* tail = head;
+    count = 1;
+    while (count < kBatch && tail->next != nullptr) {
+        tail = tail->next;
+        ++count;
+    }
+    free_ = tail->next;
+    tail->next = nullptr;
+    freeCount_ -= count;
+    handedOut_ += count;
+    ++refills_;
+    return head;
+}
+
+void BlockPool::flush(FreeBlock* list, std::size_t count) {
+    FreeBlock* tail = list;
+    while (tail->next != nullptr) {
+        tail = tail->next;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    tail->next = free_;
+    free_ = list;
+    freeCount_ += count;
+    handedOut_ -= count;
+    ++refills_;
+}
+
+void* BlockPool::allocate() {
+    Cache& c = cache();
+    if (c.head == nullptr) {
+        c.head = refill(c.count);
+        if (c.head == nullptr) {
+            return nullptr;
+        }
+    }
+    FreeBlock* block = c.head;
+    c.head = block->next;
+    --c.count;
+    return block;
+}
+
+void BlockPool::deallocate(void* block) {
+    if (block == nullptr) {
+        return;
+    }
+    Cache& c = cache();
+    FreeBlock* freed = static_cast<FreeBlock*>(block);
+    freed->next = c.head;
+    c.head = freed;
+    if (++c.count <= kCacheBlocks) {
+        return;
+    }
+    // Full: the newest kBatch go back, the rest stay for this thread's next allocations.
+    FreeBlock* batch = c.head;
+    FreeBlock* tail = batch;
+    for (std::size_t i = 1; i < kBatch; ++i) {
+        tail = tail->next;
+    }
+    c.head = tail->next;
+    tail->next = nullptr;
+    c.count -= kBatch;
+    flush(batch, kBatch);
+}
+
+BlockPool::Stats BlockPool::stats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats s;
+    s.slabs = slabs_.size();
+    s.blocks = slabs_.size() * blocksPerSlab_;
+    s.inUse = handedOut_;
+    s.refills = refills_;
+    return s;
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+// BlockPool
+// ---------
+// Fixed-size blocks for long-lived objects that come and go all session: ECS chunks,
+// records, request structs. Memory is taken from the heap in SLABS of many blocks and
+// never given back until shutdown(), so however objects churn, the heap sees the same
+// few large allocations (no fragmentation) and allocate() / deallocate() cost a pointer
+// pop / push (predictable latency):
+//
+//     slab:  [block][block][block][block] ...     blocksPerSlab x blockSize, aligned
+//     free:  block → block → block → null         the next pointer lives in the free block
+//
+// Every thread keeps a small cache of free blocks per pool, so the common case touches no
+// lock and no shared cache line:
+//
+// | Call         | Thread cache                 | Else                                   |
+// | ------------ | ---------------------------- | -------------------------------------- |
+// | allocate()   | pop one                      | lock, move kBatch blocks from the      |
+// |              |                              | shared list (a new slab if it's empty) |
+// | deallocate() | push (any pool thread may    | cache at kCacheBlocks: lock, move      |
+// |              | free any block)              | kBatch back to the shared list         |
+//
+// A thread's cached blocks go back to the shared list when the thread exits. Blocks are
+// raw memory; ObjectPool<T> below constructs and destroys objects in them.
+class BlockPool {
+public:
+    struct Stats {
+        std::size_t slabs = 0;
+        std::size_t blocks = 0;        // in all slabs
+        std::size_t inUse = 0;         // off the shared list: in use, or in a thread's cache
+        std::uint64_t refills = 0;     // thread caches refilled from / flushed to the shared list
+    };
+
+    static constexpr std::size_t kCacheBlocks = 64;
+    static constexpr std::size_t kBatch = 32;
+    static constexpr int kMaxPools = 32;
+
+    BlockPool() = default;
+    ~BlockPool() { shutdown(); }
+    BlockPool(const BlockPool&) = delete;
+    BlockPool& operator=(const BlockPool&) = delete;
+
+    // blockSize is rounded up to blockAlign (a power of two, at least a pointer's).
+    bool init(std::size_t blockSize, std::size_t blockAlign = alignof(std::max_align_t),
+              std::size_t blocksPerSlab = 256);
+    // Frees every slab: blocks still in use become invalid.
+    void shutdown();
+
+    void* allocate();                  // nullptr only if the heap is exhausted
+    void deallocate(void* block);
+
+    std::size_t blockSize() const { return blockSize_; }
+    Stats stats();
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+    struct Cache;                      // one thread's free blocks of one pool
+    struct ThreadCaches;               // a thread's Cache per pool id; flushed at thread exit
+
+    Cache& cache();
+    FreeBlock* refill(std::size_t& count); // up to kBatch blocks, linked
+    void flush(FreeBlock* list, std::size_t count);
+    bool addSlab();                    // locked
+
+    std::size_t blockSize_ = 0;
+    std::size_t blockAlign_ = 0;
+    std::size_t blocksPerSlab_ = 0;
+    int id_ = -1;                      // index into every thread's cache table
+    std::uint64_t epoch_ = 0;          // changes on init: caches of an earlier pool are dropped
+
+    std::mutex mutex_;
+    std::vector<void*> slabs_;
+    FreeBlock* free_ = nullptr;
+    std::size_t freeCount_ = 0;        // on the shared list
+    std::size_t handedOut_ = 0;        // to thread caches or callers
+    std::uint64_t refills_ = 0;
+};
+
+// ObjectPool<T>
+// -------------
+// A BlockPool of sizeof(T) blocks with construction on top:
+//
+//     ObjectPool<Request> requests;
+//     requests.init();
+//     Request* r = requests.create(path, priority);   // no malloc once warmed up
+//     ...
+//     requests.destroy(r);                            // any thread
+template <typename T>
+class ObjectPool {
+public:
+    bool init(std::size_t blocksPerSlab = 256) {
+        return pool_.init(sizeof(T), alignof(T) > sizeof(void*) ? alignof(T) : sizeof(void*), blocksPerSlab);
+    }
+    void shutdown() { pool_.shutdown(); }
+
+    template <typename... Args>
+    T* create(Args&&... args) {
+        void* block = pool_.allocate();
+        return block ? new (block) T(std::forward<Args>(args)...) : nullptr;
+    }
+    void destroy(T* object) {
+        if (object) {
+            object->~T();
+            pool_.deallocate(object);
+        }
+    }
+
+    BlockPool::Stats stats() { return pool_.stats(); }
+
+private:
+    BlockPool pool_;
+};
@@ -0,0 +1,219 @@
+#include "core/boids.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "core/job_system.h"
+#include "core/radix_sort.h"
+
+namespace {
+
+constexpr float kMinDistance2 = 1e-6f;     // separation's 1 / d² never divides by ~0
+
+#if defined(__SSE2__)
+float horizontalSum(__m128 v) {
+    __m128 shuffled = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+    v = _mm_add_ps(v, shuffled);
+    shuffled = _mm_movehl_ps(shuffled, v);
+    return _mm_cvtss_f32(_mm_add_ss(v, shuffled));
+}
+#endif
+
+} // namespace
+
+// One boid's neighbourhood: counts and sums over the neighbours within radius.
+struct Flock::Sums {
+    float count = 0.0f;
+    float vx = 0.0f, vy = 0.0f;        // their velocities
+    float dx = 0.0f, dy = 0.0f;        // their offsets from the boid
+    float sepX = 0.0f, sepY = 0.0f;    // -offset / d², the close ones
+    std::uint64_t tested = 0;
+};
+
+void Flock::resize(std::size_t count) {
+    x.resize(count);
+    y.resize(count);
+    vx.resize(count);
+    vy.resize(count);
+    maxSpeed.resize(count);
+}
+
+void Flock::step(JobSystem& jobs, float dt) {
+    const std::size_t n = size();
+    stats_.boids = n;
+    stats_.cells = 0;
+    if (n == 0) {
+        return;
+    }
+    ++stats_.steps;
+
+    // The grid: radius-wide cells over the bounds, coarser if that would be too many.
+    const glm::vec2 extent = glm::max(settings_.bounds.max - settings_.bounds.min, glm::vec2(1e-3f));
+    float cell = std::max(settings_.radius, 1e-3f);
+    while ((std::ceil(extent.x / cell) + 1.0f) * (std::ceil(extent.y / cell) + 1.0f) > static_cast<float>(kMaxCells)) {
+        cell *= 2.0f;
+    }
+    invCell_ = 1.0f / cell;
+    cellsX_ = static_cast<int>(std::ceil(extent.x * invCell_)) + 1;
+    cellsY_ = static_cast<int>(std::ceil(extent.y * invCell_)) + 1;
+    const std::size_t cells = static_cast<std::size_t>(cellsX_) * static_cast<std::size_t>(cellsY_);
+    stats_.cells = cells;
+
+    // Bin: (cell << 32 | index), then sorted on the cell's bytes only.
+    keys_.resize(n);
+    sortScratch_.resize(n);
+    const glm::vec2 origin = settings_.bounds.min;
+    jobs.parallelFor(n, 8192, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            const int cx = std::clamp(static_cast<int>(std::floor((x[i] - origin.x) * invCell_)), 0, cellsX_ - 1);
+            const int cy = std::clamp(static_cast<int>(std::floor((y[i] - origin.y) * invCell_)), 0, cellsY_ - 1);
+            const std::uint64_t c = static_cast<std::uint64_t>(cy) * static_cast<std::uint64_t>(cellsX_) +
+                                    static_cast<std::uint64_t>(cx);
+            keys_[i] = c << 32 | static_cast<std::uint64_t>(i);
+        }
+    });
+    int cellBytes = 1;
+    while (cellBytes < 4 && (cells >> (8 * cellBytes)) != 0) {
+        ++cellBytes;
+    }
+    sorted_ = radixSort(jobs, keys_.data(), sortScratch_.data(), n, 4, 4 + cellBytes);
+
+    cellStart_.assign(cells + 1, 0);
+    for (std::size_t k = 0; k < n; ++k) {
+        ++cellStart_[(sorted_[k] >> 32) + 1];
+    }
+    for (std::size_t c = 0; c < cells; ++c) {
+        cellStart_[c + 1] += cellStart_[c];
+    }
+
+    // Copy: the boids in cell order.
+    sx_.resize(n);
+    sy_.resize(n);
+    svx_.resize(n);
+    svy_.resize(n);
+    jobs.parallelFor(n, 8192, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t k = begin; k < end; ++k) {
+            const std::size_t i = static_cast<std::size_t>(sorted_[k] & 0xffffffffu);
+            sx_[k] = x[i];
+            sy_[k] = y[i];
+            svx_[k] = vx[i];
+            svy_[k] = vy[i];
+        }
+    });
+
+    // Steer: each job a run of the sorted boids, each boid its own velocity.
+    const std::size_t ranges = (n + kSteerGrain - 1) / kSteerGrain;
+    jobTested_.assign(ranges, 0);
+    jobNeighbours_.assign(ranges, 0);
+    jobs.parallelFor(ranges, 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t r = begin; r < end; ++r) {
+            steer(r * kSteerGrain, std::min(n, (r + 1) * kSteerGrain), dt, jobTested_[r], jobNeighbours_[r]);
+        }
+    });
+    for (std::size_t r = 0; r < ranges; ++r) {
+        stats_.tested += jobTested_[r];
+        stats_.neighbours += jobNeighbours_[r];
+    }
+}
+
+void Flock::steer(std::size_t begin, std::size_t end, float dt, std::uint64_t& tested, std::uint64_t& neighbours) {
+    const Settings& s = settings_;
+    const float r2 = s.radius * s.radius;
+    const float sep2 = s.separation * s.separation;
+    const Aabb& bounds = s.bounds;
+    for (std::size_t k = begin; k < end; ++k) {
+        const std::uint64_t key = sorted_[k];
+        const std::size_t index = static_cast<std::size_t>(key & 0xffffffffu);
+        const int cell = static_cast<int>(key >> 32);
+        const int cx = cell % cellsX_;
+        const int cy = cell / cellsX_;
+        const float px = sx_[k], py = sy_[k];
+        const float pvx = svx_[k], pvy = svy_[k];
+
+        Sums sums;
+        const int left = std::max(cx - 1, 0);
+        const int right = std::min(cx + 1, cellsX_ - 1);
+        for (int row = std::max(cy - 1, 0); row <= std::min(cy + 1, cellsY_ - 1); ++row) {
+            std::size_t j = cellStart_[static_cast<std::size_t>(row) * cellsX_ + left];
+            const std::size_t last = cellStart_[static_cast<std::size_t>(row) * cellsX_ + right + 1];
+            sums.tested += last - j;
+#if defined(__SSE2__)
+            const __m128 x4 = _mm_set1_ps(px), y4 = _mm_set1_ps(py);
+            const __m128 r24 = _mm_set1_ps(r2), sep24 = _mm_set1_ps(sep2);
+            const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f), tiny = _mm_set1_ps(kMinDistance2);
+            __m128 count = zero, vxs = zero, vys = zero, dxs = zero, dys = zero, sepX = zero, sepY = zero;
+            for (; j + 4 <= last; j += 4) {
+                const __m128 dx = _mm_sub_ps(_mm_loadu_ps(&sx_[j]), x4);
+                const __m128 dy = _mm_sub_ps(_mm_loadu_ps(&sy_[j]), y4);
+                const __m128 d2 = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+                const __m128 in = _mm_and_ps(_mm_cmplt_ps(d2, r24), _mm_cmpgt_ps(d2, zero));  // not itself
+                const __m128 close = _mm_and_ps(in, _mm_cmplt_ps(d2, sep24));
+                count = _mm_add_ps(count, _mm_and_ps(in, one));
+                vxs = _mm_add_ps(vxs, _mm_and_ps(in, _mm_loadu_ps(&svx_[j])));
+                vys = _mm_add_ps(vys, _mm_and_ps(in, _mm_loadu_ps(&svy_[j])));
+                dxs = _mm_add_ps(dxs, _mm_and_ps(in, dx));
+                dys = _mm_add_ps(dys, _mm_and_ps(in, dy));
+                const __m128 inv = _mm_div_ps(one, _mm_max_ps(d2, tiny));
+                sepX = _mm_sub_ps(sepX, _mm_and_ps(close, _mm_mul_ps(dx, inv)));
+                sepY = _mm_sub_ps(sepY, _mm_and_ps(close, _mm_mul_ps(dy, inv)));
+            }
+            sums.count += horizontalSum(count);
+            sums.vx += horizontalSum(vxs);
+            sums.vy += horizontalSum(vys);
+            sums.dx += horizontalSum(dxs);
+            sums.dy += horizontalSum(dys);
+            sums.sepX += horizontalSum(sepX);
+            sums.sepY += horizontalSum(sepY);
+#endif
+            for (; j < last; ++j) {
+                const float dx = sx_[j] - px, dy = sy_[j] - py;
+                const float d2 = dx * dx + dy * dy;
+                if (d2 >= r2 || d2 <= 0.0f) {
+                    continue;
+                }
+                sums.count += 1.0f;
+                sums.vx += svx_[j];
+                sums.vy += svy_[j];
+                sums.dx += dx;
+                sums.dy += dy;
+                if (d2 < sep2) {
+                    const float inv = 1.0f / std::max(d2, kMinDistance2);
+                    sums.sepX -= dx * inv;
+                    sums.sepY -= dy * inv;
+                }
+            }
+        }
+        tested += sums.tested;
+        neighbours += static_cast<std::uint64_t>(sums.count);
+
+        glm::vec2 force(0.0f);
+        if (sums.count > 0.0f) {
+            const float inv = 1.0f / sums.count;
+            force += s.separationWeight * glm::vec2(sums.sepX, sums.sepY);
+            force += s.alignmentWeight * (glm::vec2(sums.vx, sums.vy) * inv - glm::vec2(pvx, pvy));
+            force += s.cohesionWeight * glm::vec2(sums.dx, sums.dy) * inv;
+        }
+        // Back inside, harder the further out.
+        force.x += s.boundsWeight * (std::max(bounds.min.x - px, 0.0f) - std::max(px - bounds.max.x, 0.0f));
+        force.y += s.boundsWeight * (std::max(bounds.min.y - py, 0.0f) - std::max(py - bounds.max.y, 0.0f));
+        const float f = glm::length(force);
+        if (f > s.maxForce) {
+            force *= s.maxForce / f;
+        }
+
+        glm::vec2 v = glm::vec2(pvx, pvy) + force * dt;
+        const float speed = glm::length(v);
+        const float top = maxSpeed[index];
+        if (speed > top) {
+            v *= top / speed;
+        } else if (speed < s.minSpeed) {
+            v = speed > 0.0f ? v * (s.minSpeed / speed) : glm::vec2(s.minSpeed, 0.0f);
+        }
+        vx[index] = v.x;
+        vy[index] = v.y;
+    }
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "core/aligned_math.h"
+#include "core/spatial_index.h"
+
+class JobSystem;
+
+// Flock
+// -----
+// Boids: each agent steers by the neighbours within `radius`, three rules summed:
+//
+//     separation  away from the ones closer than `separation` (harder the closer)
+//     alignment   toward their mean velocity
+//     cohesion    toward their centroid
+//
+// plus a push back into `bounds`, the force clamped to maxForce and the speed to
+// [minSpeed, its maxSpeed]. The caller fills the SoA arrays (x, y, vx, vy, maxSpeed)
+// by its own index; step() leaves the new velocities in vx, vy.
+//
+// | Pass  | Work                                                       | On          |
+// | ----- | ---------------------------------------------------------- | ----------- |
+// | bin   | key (cell << 32 | index) per boid, over a grid of radius-  | jobs        |
+// |       | sized cells on `bounds` (outside: clamped to the border)   |             |
+// | sort  | radixSort on the cell bytes only; cell starts by a count   | jobs / main |
+// | copy  | x, y, vx, vy into sorted order: a cell's boids contiguous  | jobs        |
+// | steer | per boid, its 3x3 cells are 3 CONTIGUOUS runs (cells are   | jobs, SSE2  |
+// |       | row-major, so a row of 3 is adjacent in the sorted order), |             |
+// |       | read 4 neighbours per iteration                            |             |
+//
+// Every boid writes only its own velocity, from the previous velocities of the sorted
+// copy, so the result doesn't depend on the thread count. Cells at least `radius` wide
+// mean the 3x3 block holds every neighbour; a grid over `bounds` instead of a hash means
+// a cell is an index, and the sort keeps neighbours next to each other in memory.
+class Flock {
+public:
+    static constexpr std::size_t kSteerGrain = 1024;    // boids per steer job
+    static constexpr std::size_t kMaxCells = 1u << 22;  // the grid coarsens past this
+
+    struct Settings {
+        float radius = 0.3f;           // neighbours within this see each other
+        float separation = 0.1f;       // ... and push apart within this
+        float separationWeight = 0.02f;
+        float alignmentWeight = 1.0f;
+        float cohesionWeight = 1.5f;
+        float boundsWeight = 4.0f;
+        float minSpeed = 0.2f;
+        float maxForce = 3.0f;         // world units per second²
+        Aabb bounds{glm::vec2(-4.0f, -2.0f), glm::vec2(4.0f, 2.0f)};
+    };
+
+    struct Stats {
+        std::uint64_t steps = 0;
+        std::size_t boids = 0;         // last step
+        std::size_t cells = 0;
+        std::uint64_t tested = 0;      // neighbour candidates read
+        std::uint64_t neighbours = 0;  // ... within radius
+    };
+
+    AlignedVector<float> x, y;
+    AlignedVector<float> vx, vy;
+    AlignedVector<float> maxSpeed;
+
+    void setSettings(const Settings& settings) { settings_ = settings; }
+    const Settings& settings() const { return settings_; }
+    std::size_t size() const { return x.size(); }
+    void resize(std::size_t count);
+
+    void step(JobSystem& jobs, float dt);
+
+    const Stats& stats() const { return stats_; }
+    void resetStats() { stats_ = Stats{}; }
+
+private:
+    struct Sums;
+    void steer(std::size_t begin, std::size_t end, float dt, std::uint64_t& tested, std::uint64_t& neighbours);
+
+    Settings settings_{};
+    int cellsX_ = 0, cellsY_ = 0;
+    float invCell_ = 0.0f;
+    std::vector<std::uint64_t> keys_;
+    std::vector<std::uint64_t> sortScratch_;
+    const std::uint64_t* sorted_ = nullptr;
+    std::vector<std::uint32_t> cellStart_;     // cells + 1: sorted boids of cell c
+    AlignedVector<float> sx_, sy_, svx_, svy_;  // sorted copies
+    std::vector<std::uint64_t> jobTested_, jobNeighbours_;
+    Stats stats_;
+};
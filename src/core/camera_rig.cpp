@@ -0,0 +1,99 @@
+#include "core/camera_rig.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Below these the spring is done (about a thousandth of the view's height, and a
+// thousandth of a zoom step): snap instead of creeping forever.
+constexpr float kSnapDistance = 1e-3f;
+constexpr float kSnapLogZoom = 1e-4f;
+
+// One step of the critically damped spring towards `target`; `velocity` carries over.
+// 1 / (1 + x + 0.48x² + 0.235x³) stands in for exp(-x): within a fraction of a percent
+// for the x = 2 dt / smoothTime of a fixed step, and no exp per step.
+template <typename T>
+T smoothDamp(const T& current, const T& target, T& velocity, float smoothTime, float dt) {
+    const float omega = 2.0f / std::max(smoothTime, 1e-4f);
+    const float x = omega * dt;
+    const float decay = 1.0f / (1.0f + x + 0.48f * x * x + 0.235f * x * x * x);
+    const T change = current - target;
+    const T temp = (velocity + omega * change) * dt;
+    velocity = (velocity - omega * temp) * decay;
+    return target + (change + temp) * decay;
+}
+
+} // namespace
+
+void CameraRig::teleport(const CameraView& view) {
+    target_ = view;
+    target_.zoom = std::clamp(view.zoom, settings_.minZoom, settings_.maxZoom);
+    target_.position = clampToBounds(view.position, target_.zoom);
+    current_ = previous_ = target_;
+    velocity_ = glm::vec2(0.0f);
+    zoomVelocity_ = 0.0f;
+    settled_ = true;
+}
+
+void CameraRig::step(const Controls& controls, float dt) {
+    previous_ = current_;
+
+    if (controls.zoom != 0.0f) {
+        target_.zoom = std::clamp(target_.zoom * std::pow(settings_.zoomRate, controls.zoom * dt), settings_.minZoom,
+                                  settings_.maxZoom);
+    }
+    if (controls.follow) {
+        target_.position = *controls.follow;
+    } else {
+        target_.position += controls.pan * (settings_.panSpeed / target_.zoom * dt);
+    }
+    // Clamped where it is kept, so holding a direction against the edge doesn't wind up a
+    // target the camera then has to travel back from.
+    target_.position = clampToBounds(target_.position, target_.zoom);
+
+    const float targetLogZoom = std::log(target_.zoom);
+    const float logZoom = smoothDamp(std::log(current_.zoom), targetLogZoom, zoomVelocity_,
+                                     settings_.zoomSmoothTime, dt);
+    glm::vec2 position = smoothDamp(current_.position, target_.position, velocity_, settings_.smoothTime, dt);
+
+    const bool zoomDone = std::fabs(logZoom - targetLogZoom) < kSnapLogZoom && std::fabs(zoomVelocity_) < kSnapLogZoom;
+    current_.zoom = zoomDone ? target_.zoom : std::exp(logZoom);
+    if (zoomDone) {
+        zoomVelocity_ = 0.0f;
+    }
+    // Snap distances are in view heights: a thousandth of the screen at any zoom.
+    const float snap = kSnapDistance / current_.zoom;
+    const bool positionDone = glm::length(position - target_.position) < snap && glm::length(velocity_) < snap;
+    if (positionDone) {
+        position = target_.position;
+        velocity_ = glm::vec2(0.0f);
+    }
+    current_.position = clampToBounds(position, current_.zoom);
+    settled_ = zoomDone && positionDone;
+}
+
+CameraView CameraRig::interpolate(float alpha) const {
+    if (previous_.position == current_.position && previous_.zoom == current_.zoom) {
+        return current_;               // exactly: a resting camera stays bit-identical
+    }
+    CameraView view;
+    view.position = glm::mix(previous_.position, current_.position, alpha);
+    // Geometric: the same zoom speed throughout the step.
+    view.zoom = previous_.zoom * std::pow(current_.zoom / previous_.zoom, alpha);
+    return view;
+}
+
+glm::vec2 CameraRig::clampToBounds(glm::vec2 position, float zoom) const {
+    if (!settings_.bounded) {
+        return position;
+    }
+    const glm::vec2 half = glm::vec2(aspect_, 1.0f) / zoom;
+    const Aabb& b = settings_.bounds;
+    for (int axis = 0; axis < 2; ++axis) {
+        const float lo = b.min[axis] + half[axis];
+        const float hi = b.max[axis] - half[axis];
+        position[axis] = lo <= hi ? std::clamp(position[axis], lo, hi) : 0.5f * (b.min[axis] + b.max[axis]);
+    }
+    return position;
+}
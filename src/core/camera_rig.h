@@ -0,0 +1,92 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include "core/spatial_index.h"
+
+// CameraView
+// ----------
+// What the render camera (render/camera.h) is built from: the point it centres on and
+// how far it is zoomed in (2: everything twice as large, half as much world visible).
+struct CameraView {
+    glm::vec2 position{0.0f};
+    float zoom = 1.0f;
+};
+
+// CameraRig
+// ---------
+// The camera as part of the simulation: stepped with the fixed dt next to everything else
+// (so recordings replay it exactly), and drawn like everything else, interpolated between
+// the last two steps:
+//
+//     step(controls, dt)        target ← pan / follow / zoom input, clamped to the bounds;
+//                               current ← critically damped towards target
+//     interpolate(alpha)        mix(previous, current, alpha) → Camera::setPosition/setZoom
+//
+// | Input                 | Moves                                                     |
+// | --------------------- | --------------------------------------------------------- |
+// | pan (-1..1 per axis)  | the target, panSpeed / zoom world units per second: the   |
+// |                       | same speed on screen at any zoom                          |
+// | follow (a position)   | the target onto it; pan is ignored meanwhile              |
+// | zoom (-1..1)          | the target zoom by zoomRate^±1 per second, within         |
+// |                       | [minZoom, maxZoom]                                        |
+//
+// Smoothing is the critically damped spring of "Critically Damped Ease-In/Ease-Out
+// Smoothing" (Game Programming Gems 4): as fast as possible without overshooting, about
+// smoothTime behind a moving target. Zoom is smoothed as log(zoom), so zooming in and out
+// feel the same.
+//
+// Bounds keep the whole visible area inside them (half extent (aspect, 1) / zoom), or
+// centre the view on them when they are smaller than it.
+//
+// A spring only ever approaches its target. Once the remaining distance is below a
+// fraction of a pixel and the velocity is negligible, the rig snaps onto the target and
+// stops, so a resting camera produces the same view every step and Camera's dirty flags
+// (and everything keyed on its version) stay clean.
+class CameraRig {
+public:
+    struct Settings {
+        float panSpeed = 1.0f;         // world units per second at zoom 1
+        float smoothTime = 0.12f;      // seconds of lag behind the target
+        float zoomRate = 2.0f;         // zoom factor per second of zoom input
+        float zoomSmoothTime = 0.08f;
+        float minZoom = 0.25f;
+        float maxZoom = 4.0f;
+        bool bounded = false;
+        Aabb bounds{glm::vec2(0.0f), glm::vec2(0.0f)};
+    };
+
+    struct Controls {
+        glm::vec2 pan{0.0f};
+        float zoom = 0.0f;             // > 0: in
+        const glm::vec2* follow = nullptr;
+    };
+
+    CameraRig() = default;
+    explicit CameraRig(const Settings& settings) : settings_(settings) {}
+
+    // Width / height of the view, for the bounds (Camera::aspect()).
+    void setAspect(float aspect) { aspect_ = aspect; }
+    // Jumps there: no smoothing, nothing to interpolate from.
+    void teleport(const CameraView& view);
+
+    void step(const Controls& controls, float dt);
+    CameraView interpolate(float alpha) const;
+
+    const CameraView& current() const { return current_; }
+    const CameraView& target() const { return target_; }
+    bool settled() const { return settled_; }
+    const Settings& settings() const { return settings_; }
+
+private:
+    glm::vec2 clampToBounds(glm::vec2 position, float zoom) const;
+
+    Settings settings_;
+    float aspect_ = 1.0f;
+    CameraView target_;
+    CameraView current_;
+    CameraView previous_;
+    glm::vec2 velocity_{0.0f};
+    float zoomVelocity_ = 0.0f;        // of log(zoom)
+    bool settled_ = true;
+};
@@ -0,0 +1,20 @@
+#include "core/clock.h"
+
+namespace {
+
+// Static initialization: before main, so before anything could read the clock.
+const monoclock::Clock::time_point start = monoclock::Clock::now();
+
+} // namespace
+
+namespace monoclock {
+
+Ticks now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+}
+
+double seconds() {
+    return toSeconds(now());
+}
+
+} // namespace monoclock
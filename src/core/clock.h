@@ -0,0 +1,41 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+// Monotonic clock
+// ---------------
+// Every frame-loop timestamp as 64-bit integer ticks (nanoseconds) of steady_clock,
+// counted from the process's start. Integers don't lose resolution as they grow: a
+// server up for weeks steps its simulation by the same nanoseconds as on its first frame,
+// where a float of seconds is down to 1/128 s steps after a day and a double drifts when
+// it is the accumulator everything is added to.
+//
+// | Use                          | Kept as                                               |
+// | ---------------------------- | ----------------------------------------------------- |
+// | frame start, frame-to-frame  | Ticks; the difference converted once, to seconds      |
+// | fixed-step accumulator       | Ticks (core/fixed_timestep.h): steps are whole ticks  |
+// | event / latency timestamps   | seconds(): double seconds since start, exact to well  |
+// |                              | under a microsecond for years; GLFW callbacks, pads,  |
+// |                              | the render thread and workers all read the same clock |
+// | profiler sections, trace     | Clock (steady_clock) time points, already 64-bit      |
+//
+// steady_clock, not glfwGetTimerValue: GLFW's timer is only to be read once glfwInit has
+// run, and the headless server, worker threads and tools have no window.
+namespace monoclock {
+
+using Clock = std::chrono::steady_clock;
+using Ticks = std::int64_t;
+
+constexpr Ticks kTicksPerSecond = 1'000'000'000;
+
+Ticks now();                  // since start, on any thread
+double seconds();             // now(), in seconds
+
+constexpr double toSeconds(Ticks ticks) { return static_cast<double>(ticks) / static_cast<double>(kTicksPerSecond); }
+constexpr double toMs(Ticks ticks) { return static_cast<double>(ticks) / 1e6; }
+constexpr Ticks fromSeconds(double seconds) {
+    return static_cast<Ticks>(seconds * static_cast<double>(kTicksPerSecond) + (seconds < 0.0 ? -0.5 : 0.5));
+}
+
+} // namespace monoclock
@@ -0,0 +1,157 @@
+#include "core/collision.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#include "core/job_system.h"
+
+namespace {
+
+// Islands per job: most are a pair or two, so one each would be all overhead.
+constexpr std::size_t kIslandsPerJob = 64;
+
+// One pair of resolveContacts; true if they were in contact.
+bool resolvePair(CollisionBodies& b, ObjectId i, ObjectId j, float restitution) {
+    const float inverseI = b.inverseMass[i];
+    const float inverseJ = b.inverseMass[j];
+    const float totalInverseMass = inverseI + inverseJ;
+    if (totalInverseMass <= 0.0f) {
+        return false;                  // two immovable bodies
+    }
+    const float dx = b.x[j] - b.x[i];
+    const float dy = b.y[j] - b.y[i];
+    const float penX = b.halfX[i] + b.halfX[j] - std::fabs(dx);
+    const float penY = b.halfY[i] + b.halfY[j] - std::fabs(dy);
+    if (penX <= 0.0f || penY <= 0.0f) {
+        return false;                  // an earlier pair already pushed them apart
+    }
+    float nx = 0.0f, ny = 0.0f, penetration;
+    if (penX < penY) {
+        nx = dx < 0.0f ? -1.0f : 1.0f;
+        penetration = penX;
+    } else {
+        ny = dy < 0.0f ? -1.0f : 1.0f;
+        penetration = penY;
+    }
+    const float closing = (b.vx[j] - b.vx[i]) * nx + (b.vy[j] - b.vy[i]) * ny;
+    const float impulse = closing < 0.0f ? -(1.0f + restitution) * closing / totalInverseMass : 0.0f;
+    // Immovable bodies are never written: other islands may be reading them right now.
+    if (inverseI > 0.0f) {
+        const float share = inverseI / totalInverseMass;
+        b.x[i] -= nx * penetration * share;
+        b.y[i] -= ny * penetration * share;
+        b.vx[i] -= impulse * inverseI * nx;
+        b.vy[i] -= impulse * inverseI * ny;
+    }
+    if (inverseJ > 0.0f) {
+        const float share = inverseJ / totalInverseMass;
+        b.x[j] += nx * penetration * share;
+        b.y[j] += ny * penetration * share;
+        b.vx[j] += impulse * inverseJ * nx;
+        b.vy[j] += impulse * inverseJ * ny;
+    }
+    return true;
+}
+
+} // namespace
+
+void CollisionBodies::resize(std::size_t count) {
+    x.resize(count);
+    y.resize(count);
+    vx.resize(count);
+    vy.resize(count);
+    halfX.resize(count);
+    halfY.resize(count);
+    inverseMass.resize(count);
+}
+
+std::size_t resolveContacts(CollisionBodies& b, const CollisionPair* pairs, std::size_t count, float restitution) {
+    std::size_t contacts = 0;
+    for (std::size_t p = 0; p < count; ++p) {
+        contacts += resolvePair(b, pairs[p].a, pairs[p].b, restitution);
+    }
+    return contacts;
+}
+
+std::uint32_t ContactIslands::find(std::uint32_t body) {
+    while (parent_[body] != body) {
+        parent_[body] = parent_[parent_[body]];   // path halving
+        body = parent_[body];
+    }
+    return body;
+}
+
+void ContactIslands::build(const CollisionBodies& bodies, const CollisionPair* pairs, std::size_t count) {
+    const std::size_t n = bodies.size();
+    parent_.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        parent_[i] = static_cast<std::uint32_t>(i);
+    }
+    for (std::size_t p = 0; p < count; ++p) {
+        const CollisionPair& pair = pairs[p];
+        if (bodies.inverseMass[pair.a] > 0.0f && bodies.inverseMass[pair.b] > 0.0f) {
+            const std::uint32_t ra = find(pair.a), rb = find(pair.b);
+            if (ra != rb) {
+                // The smaller root wins: the same pairs always give the same trees.
+                parent_[std::max(ra, rb)] = std::min(ra, rb);
+            }
+        }
+    }
+
+    // Number the islands by first appearance; pairs of two immovable bodies join none.
+    islandOf_.assign(n, 0u);
+    pairIsland_.resize(count);
+    offsets_.assign(1, 0u);
+    std::uint32_t islands = 0;
+    for (std::size_t p = 0; p < count; ++p) {
+        const CollisionPair& pair = pairs[p];
+        const ObjectId movable = bodies.inverseMass[pair.a] > 0.0f ? pair.a : pair.b;
+        if (bodies.inverseMass[movable] <= 0.0f) {
+            pairIsland_[p] = ~0u;
+            continue;
+        }
+        std::uint32_t& island = islandOf_[find(movable)];
+        if (island == 0) {
+            island = ++islands;
+            offsets_.push_back(0u);
+        }
+        pairIsland_[p] = island - 1;
+        ++offsets_[island];
+    }
+    // Counts → offsets, then a stable scatter: each island's pairs keep their order.
+    for (std::uint32_t k = 1; k <= islands; ++k) {
+        offsets_[k] += offsets_[k - 1];
+    }
+    order_.resize(offsets_[islands]);
+    std::vector<std::uint32_t>& next = islandOf_;   // reused as the write cursors
+    next.assign(offsets_.begin(), offsets_.end() - 1);
+    std::size_t largest = 0;
+    for (std::uint32_t k = 0; k < islands; ++k) {
+        largest = std::max<std::size_t>(largest, offsets_[k + 1] - offsets_[k]);
+    }
+    for (std::size_t p = 0; p < count; ++p) {
+        if (pairIsland_[p] != ~0u) {
+            order_[next[pairIsland_[p]]++] = static_cast<std::uint32_t>(p);
+        }
+    }
+    stats_.islands = islands;
+    stats_.largest = largest;
+}
+
+std::size_t resolveContactsParallel(JobSystem& jobs, CollisionBodies& bodies, const CollisionPair* pairs,
+                                    const ContactIslands& islands, float restitution) {
+    std::atomic<std::size_t> contacts{0};
+    jobs.parallelFor(islands.size(), kIslandsPerJob, [&](std::size_t begin, std::size_t end) {
+        std::size_t local = 0;
+        const std::uint32_t* order = islands.order();
+        for (std::size_t k = begin; k < end; ++k) {
+            for (std::size_t o = islands.begin(k); o < islands.end(k); ++o) {
+                const CollisionPair& pair = pairs[order[o]];
+                local += resolvePair(bodies, pair.a, pair.b, restitution);
+            }
+        }
+        contacts.fetch_add(local, std::memory_order_relaxed);
+    });
+    return contacts.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "core/aligned_math.h"
+#include "core/sweep_and_prune.h"
+
+class JobSystem;
+
+// CollisionBodies
+// ---------------
+// The colliding objects of one step as arrays: gathered from the components before the
+// broadphase, resolved in place, written back afterwards. Index = broadphase id.
+struct CollisionBodies {
+    AlignedVector<float> x, y;            // box centre
+    AlignedVector<float> vx, vy;
+    AlignedVector<float> halfX, halfY;
+    AlignedVector<float> inverseMass;     // 0: immovable
+
+    std::size_t size() const { return x.size(); }
+    void resize(std::size_t count);
+    Aabb bounds(std::size_t i) const {
+        return Aabb{glm::vec2(x[i] - halfX[i], y[i] - halfY[i]), glm::vec2(x[i] + halfX[i], y[i] + halfY[i])};
+    }
+};
+
+// resolveContacts
+// ---------------
+// The narrowphase for the broadphase's pairs. For boxes the exact test is the overlap
+// itself, so per pair:
+//
+//     penetration = (halfA + halfB) - |centreB - centreA|, on x and on y
+//     none on either axis (just touching): skip
+//     normal = the axis with the smaller penetration, pointing from a to b
+//     positions: pushed apart along it, shared by inverse mass
+//     velocities: if closing along it, an impulse with `restitution` (1: elastic)
+//
+// Pairs are resolved one after the other with the positions updated as it goes, so a
+// body pushed by one pair is seen pushed by the next; a pile settles over a few steps
+// rather than in one. Immovable bodies are only read. Returns how many pairs were
+// actually in contact.
+std::size_t resolveContacts(CollisionBodies& bodies, const CollisionPair* pairs, std::size_t count,
+                            float restitution = 1.0f);
+
+// ContactIslands
+// --------------
+// The pairs split into groups that share no movable body: union-find over the pairs,
+// joining the two bodies of each pair unless one is immovable (an immovable body is
+// only read, so it doesn't tie the bodies resting on it together).
+//
+//     pairs:   (0,1) (5,6) (1,2) (7,W) (6,W)        W immovable
+//     islands: {(0,1) (1,2)}  {(5,6) (6,W)}  {(7,W)}
+//
+// Islands are numbered in the order their first pair appears, and each keeps its pairs
+// in their original order. No two islands write the same body, so resolving them in any
+// order, on any threads, gives exactly what resolveContacts over the whole list gives,
+// bit for bit: replays stay deterministic however many workers there are.
+class ContactIslands {
+public:
+    struct Stats {
+        std::size_t islands = 0;
+        std::size_t largest = 0;       // pairs in the biggest island
+    };
+
+    void build(const CollisionBodies& bodies, const CollisionPair* pairs, std::size_t count);
+
+    std::size_t size() const { return offsets_.empty() ? 0 : offsets_.size() - 1; }
+    // Island k's pairs: indices into the pair list, [begin(k), end(k)) of order().
+    std::size_t begin(std::size_t island) const { return offsets_[island]; }
+    std::size_t end(std::size_t island) const { return offsets_[island + 1]; }
+    const std::uint32_t* order() const { return order_.data(); }
+    const Stats& stats() const { return stats_; }
+
+private:
+    std::uint32_t find(std::uint32_t body);
+
+    std::vector<std::uint32_t> parent_;    // per body
+    std::vector<std::uint32_t> islandOf_;  // per body root: island + 1; 0: none yet
+    std::vector<std::uint32_t> pairIsland_;
+    std::vector<std::uint32_t> offsets_;   // size() + 1
+    std::vector<std::uint32_t> order_;
+    Stats stats_;
+};
+
+// resolveContacts island by island across the job system's threads (`islands` built from
+// the same pairs). Same result as the serial call.
+std::size_t resolveContactsParallel(JobSystem& jobs, CollisionBodies& bodies, const CollisionPair* pairs,
+                                    const ContactIslands& islands, float restitution = 1.0f);
@@ -0,0 +1,128 @@
+#include "core/config.h"
+
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+std::string trim(const std::string& text, std::size_t begin, std::size_t end) {
+    while (begin < end && std::isspace(static_cast<unsigned char>(text[begin]))) ++begin;
+    while (end > begin && std::isspace(static_cast<unsigned char>(text[end - 1]))) --end;
+    return text.substr(begin, end - begin);
+}
+
+std::string lower(std::string text) {
+    for (char& c : text) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return text;
+}
+
+} // namespace
+
+namespace config {
+
+bool parseInt(const std::string& text, int& out) {
+    if (text.empty()) {
+        return false;
+    }
+    char* end = nullptr;
+    errno = 0;
+    const long v = std::strtol(text.c_str(), &end, 10);
+    if (*end != '\0' || errno != 0 || v < -2147483647L || v > 2147483647L) {
+        return false;
+    }
+    out = static_cast<int>(v);
+    return true;
+}
+
+bool parseFloat(const std::string& text, float& out) {
+    if (text.empty()) {
+        return false;
+    }
+    char* end = nullptr;
+    const float v = std::strtof(text.c_str(), &end);
+    if (*end != '\0' || v != v) {
+        return false;
+    }
+    out = v;
+    return true;
+}
+
+bool parseBool(const std::string& text, bool& out) {
+    const std::string v = lower(text);
+    if (v == "on" || v == "true" || v == "yes" || v == "1") {
+        out = true;
+    } else if (v == "off" || v == "false" || v == "no" || v == "0") {
+        out = false;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+int parseFloats(const std::string& text, float* out, int max) {
+    int count = 0;
+    std::size_t i = 0;
+    while (i < text.size()) {
+        if (std::isspace(static_cast<unsigned char>(text[i])) || text[i] == ',') {
+            ++i;
+            continue;
+        }
+        if (count == max) {
+            return -1;
+        }
+        const char* start = text.c_str() + i;
+        char* end = nullptr;
+        out[count++] = std::strtof(start, &end);
+        if (end == start) {
+            return -1;
+        }
+        i += static_cast<std::size_t>(end - start);
+    }
+    return count;
+}
+
+void forEachSetting(const std::string& text, std::vector<std::string>& errors,
+                    const std::function<void(int line, const std::string& name, const std::string& value)>& fn) {
+    std::string section;
+    int line = 0;
+    std::size_t start = 0;
+    while (start < text.size()) {
+        std::size_t end = text.find('\n', start);
+        if (end == std::string::npos) {
+            end = text.size();
+        }
+        ++line;
+        std::size_t content = text.find('#', start);
+        if (content == std::string::npos || content > end) {
+            content = end;
+        }
+        const std::string trimmed = trim(text, start, content);
+        start = end + 1;
+        if (trimmed.empty()) {
+            continue;
+        }
+        if (trimmed.front() == '[') {
+            if (trimmed.back() != ']') {
+                errors.push_back("line " + std::to_string(line) + ": expected [section]");
+                continue;
+            }
+            section = trim(trimmed, 1, trimmed.size() - 1);
+            if (!section.empty()) {
+                section += '.';
+            }
+            continue;
+        }
+        const std::size_t equals = trimmed.find('=');
+        if (equals == std::string::npos) {
+            errors.push_back("line " + std::to_string(line) + ": expected name = value");
+            continue;
+        }
+        fn(line, section + trim(trimmed, 0, equals), trim(trimmed, equals + 1, trimmed.size()));
+    }
+}
+
+} // namespace config
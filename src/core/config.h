@@ -0,0 +1,98 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+// Config files
+// ------------
+// Plain `name = value` lines, parsed ONCE into a flat struct: whatever reads a setting
+// afterwards reads a struct member, never a string lookup.
+//
+//     # game.cfg
+//     [window]                     names below are "window.<name>"
+//     width = 1000
+//     [render]
+//     clear_color = 0.2 0.3 0.3    r g b [a], 0..1
+//     vsync = on
+//
+// A ConfigSchema<S> lists the names S understands and how each one's value goes into
+// an S. parse() starts from whatever `out` holds (the defaults, or the config in use), so
+// a file only needs the lines it changes.
+//
+// | Line                   | parse()                                                  |
+// | ---------------------- | -------------------------------------------------------- |
+// | blank, `# comment`     | skipped                                                  |
+// | [section]              | prefixes the names after it ("section.")                 |
+// | known name, good value | stored in out                                            |
+// | known name, bad value  | "line N: ..." in errors; that member keeps its value     |
+// | unknown name           | likewise (a typo should not silently do nothing)         |
+//
+// The value is everything after the `=`, trimmed; a `#` in it starts a comment.
+namespace config {
+
+bool parseInt(const std::string& text, int& out);
+bool parseFloat(const std::string& text, float& out);
+bool parseBool(const std::string& text, bool& out);       // on/off, true/false, yes/no, 1/0
+// Whitespace- or comma-separated fields ("0.2 0.3 0.3"), at most `max` floats.
+int parseFloats(const std::string& text, float* out, int max);
+
+// Splits text into (line number, name, value) and calls fn for each setting; bad lines
+// (no '=', unclosed section) go to errors. Used by ConfigSchema::parse.
+void forEachSetting(const std::string& text, std::vector<std::string>& errors,
+                    const std::function<void(int line, const std::string& name, const std::string& value)>& fn);
+
+} // namespace config
+
+template <typename S>
+class ConfigSchema {
+public:
+    // Stores the value in out, or returns false to report it as invalid.
+    using Parse = std::function<bool(const std::string& value, S& out)>;
+
+    void field(const char* name, Parse parse) { fields_.push_back(Field{name, std::move(parse)}); }
+    void field(const char* name, int S::*member, int min, int max) {
+        field(name, [member, min, max](const std::string& value, S& out) {
+            int v = 0;
+            if (!config::parseInt(value, v) || v < min || v > max) return false;
+            out.*member = v;
+            return true;
+        });
+    }
+    void field(const char* name, float S::*member, float min, float max) {
+        field(name, [member, min, max](const std::string& value, S& out) {
+            float v = 0.0f;
+            if (!config::parseFloat(value, v) || v < min || v > max) return false;
+            out.*member = v;
+            return true;
+        });
+    }
+    void field(const char* name, bool S::*member) {
+        field(name, [member](const std::string& value, S& out) { return config::parseBool(value, out.*member); });
+    }
+
+    // true when every line was understood; errors gets one "line N: ..." per other line.
+    bool parse(const std::string& text, S& out, std::vector<std::string>& errors) const {
+        const std::size_t before = errors.size();
+        config::forEachSetting(text, errors, [&](int line, const std::string& name, const std::string& value) {
+            for (const Field& f : fields_) {
+                if (f.name == name) {
+                    if (!f.parse(value, out)) {
+                        errors.push_back("line " + std::to_string(line) + ": bad value for " + name + ": '" +
+                                         value + "'");
+                    }
+                    return;
+                }
+            }
+            errors.push_back("line " + std::to_string(line) + ": unknown setting '" + name + "'");
+        });
+        return errors.size() == before;
+    }
+
+private:
+    struct Field {
+        std::string name;
+        Parse parse;
+    };
+    std::vector<Field> fields_;
+};
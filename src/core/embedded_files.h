@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+
+// Embedded files
+// --------------
+// Files compiled into the executable as constant byte arrays. tools/embed_tool.cpp
+// writes the arrays and a table, sorted by path, into a generated .cpp; `make
+// EMBED_SHADERS=1` generates one for shaders/*.glsl and links it in. vfs::mountEmbedded
+// (core/vfs.h) puts the table in front of every pack and the disk.
+//
+// Each array has a '\0' after its `size` bytes, so text can also be used as a C string.
+struct EmbeddedFile {
+    const char* path;           // "shaders/vertex.glsl": the name loaders ask the VFS for
+    const unsigned char* data;
+    std::size_t size;
+};
+
+#ifdef EMBED_SHADERS
+// Defined in the generated source (src/generated/embedded_shaders.cpp).
+extern const EmbeddedFile kEmbeddedShaders[];
+extern const std::size_t kEmbeddedShadersCount;
+#endif
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+
+// EntityHandle
+// ------------
+// Stable reference to an entity: a slot in the store's indirection table plus the
+// generation that slot had when the entity was created. Destroying an entity bumps the
+// slot's generation, so old handles to it stop resolving instead of silently pointing
+// at whatever reuses the slot later.
+struct EntityHandle {
+    static constexpr std::uint32_t kInvalidSlot = 0xffffffffu;
+
+    std::uint32_t slot = kInvalidSlot;
+    std::uint32_t generation = 0;
+
+    bool operator==(const EntityHandle& o) const { return slot == o.slot && generation == o.generation; }
+    bool operator!=(const EntityHandle& o) const { return !(*this == o); }
+};
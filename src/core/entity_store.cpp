@@ -0,0 +1,160 @@
+#include "core/entity_store.h"
+
+void EntityStore::reserve(std::size_t count) {
+    transforms_.x.reserve(count);
+    transforms_.y.reserve(count);
+    transforms_.rotation.reserve(count);
+    transforms_.scaleX.reserve(count);
+    transforms_.scaleY.reserve(count);
+    previousX_.reserve(count);
+    previousY_.reserve(count);
+    velocityX_.reserve(count);
+    velocityY_.reserve(count);
+    color_.reserve(count);
+    sprite_.reserve(count);
+    owner_.reserve(count);
+    slots_.reserve(count);
+}
+
+void EntityStore::clear() {
+    // Generations must survive: handles from before clear() must not resolve to the
+    // entities created after it. Every slot goes onto the free list instead.
+    transforms_.resize(0);
+    previousX_.clear();
+    previousY_.clear();
+    velocityX_.clear();
+    velocityY_.clear();
+    color_.clear();
+    sprite_.clear();
+    owner_.clear();
+    freeHead_ = kEndOfFreeList;
+    for (std::size_t s = slots_.size(); s-- > 0;) {
+        ++slots_[s].generation;
+        slots_[s].index = freeHead_;
+        freeHead_ = static_cast<std::uint32_t>(s);
+    }
+}
+
+EntityHandle EntityStore::create(const glm::vec2& position, const glm::vec2& scale,
+                                 std::uint32_t color, std::uint32_t sprite) {
+    std::uint32_t slot;
+    if (freeHead_ != kEndOfFreeList) {
+        slot = freeHead_;
+        freeHead_ = slots_[slot].index;
+    } else {
+        slot = static_cast<std::uint32_t>(slots_.size());
+        slots_.push_back(Slot{});
+    }
+    const std::uint32_t index = static_cast<std::uint32_t>(size());
+    slots_[slot].index = index;
+
+    transforms_.x.push_back(position.x);
+    transforms_.y.push_back(position.y);
+    transforms_.rotation.push_back(0.0f);
+    transforms_.scaleX.push_back(scale.x);
+    transforms_.scaleY.push_back(scale.y);
+    previousX_.push_back(position.x);
+    previousY_.push_back(position.y);
+    velocityX_.push_back(0.0f);
+    velocityY_.push_back(0.0f);
+    color_.push_back(color);
+    sprite_.push_back(sprite);
+    owner_.push_back(slot);
+    return EntityHandle{slot, slots_[slot].generation};
+}
+
+std::size_t EntityStore::indexOf(EntityHandle handle) const {
+    if (handle.slot >= slots_.size()) {
+        return kNoIndex;
+    }
+    const Slot& s = slots_[handle.slot];
+    if (s.generation != handle.generation) {
+        return kNoIndex;
+    }
+    return s.index;
+}
+
+EntityHandle EntityStore::handleAt(std::size_t index) const {
+    const std::uint32_t slot = owner_[index];
+    return EntityHandle{slot, slots_[slot].generation};
+}
+
+namespace {
+template <typename T, typename A>
+void swapRemove(std::vector<T, A>& v, std::size_t i) {
+    v[i] = v.back();
+    v.pop_back();
+}
+} // namespace
+
+bool EntityStore::destroy(EntityHandle handle) {
+    const std::size_t index = indexOf(handle);
+    if (index == kNoIndex) {
+        return false;
+    }
+
+    // The last entity takes the hole; its slot must point at the new position.
+    const std::uint32_t movedSlot = owner_.back();
+    slots_[movedSlot].index = static_cast<std::uint32_t>(index);
+
+    swapRemove(transforms_.x, index);
+    swapRemove(transforms_.y, index);
+    swapRemove(transforms_.rotation, index);
+    swapRemove(transforms_.scaleX, index);
+    swapRemove(transforms_.scaleY, index);
+    swapRemove(previousX_, index);
+    swapRemove(previousY_, index);
+    swapRemove(velocityX_, index);
+    swapRemove(velocityY_, index);
+    swapRemove(color_, index);
+    swapRemove(sprite_, index);
+    swapRemove(owner_, index);
+
+    Slot& s = slots_[handle.slot];
+    ++s.generation;
+    s.index = freeHead_;
+    freeHead_ = handle.slot;
+    return true;
+}
+
+void EntityStore::beginStep() {
+    previousX_ = transforms_.x; // same size, so these copies never allocate
+    previousY_ = transforms_.y;
+}
+
+void EntityStore::integrate(float dt, std::size_t first, std::size_t count) {
+    float* x = transforms_.x.data();
+    float* y = transforms_.y.data();
+    const float* vx = velocityX_.data();
+    const float* vy = velocityY_.data();
+    for (std::size_t i = first; i < first + count; ++i) {
+        x[i] += vx[i] * dt;
+        y[i] += vy[i] * dt;
+    }
+}
+
+void EntityStore::bounce(const Aabb& bounds, std::size_t first, std::size_t count) {
+    const float* x = transforms_.x.data();
+    const float* y = transforms_.y.data();
+    float* vx = velocityX_.data();
+    float* vy = velocityY_.data();
+    for (std::size_t i = first; i < first + count; ++i) {
+        // Branch-free: flip the sign only when outside AND heading further out.
+        const bool flipX = (x[i] < bounds.min.x && vx[i] < 0.0f) || (x[i] > bounds.max.x && vx[i] > 0.0f);
+        const bool flipY = (y[i] < bounds.min.y && vy[i] < 0.0f) || (y[i] > bounds.max.y && vy[i] > 0.0f);
+        vx[i] = flipX ? -vx[i] : vx[i];
+        vy[i] = flipY ? -vy[i] : vy[i];
+    }
+}
+
+void EntityStore::interpolate(float alpha, Transforms2D& out) const {
+    const std::size_t n = size();
+    out.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        out.x[i] = previousX_[i] + (transforms_.x[i] - previousX_[i]) * alpha;
+        out.y[i] = previousY_[i] + (transforms_.y[i] - previousY_[i]) * alpha;
+    }
+    out.rotation = transforms_.rotation;
+    out.scaleX = transforms_.scaleX;
+    out.scaleY = transforms_.scaleY;
+}
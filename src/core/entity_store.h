@@ -0,0 +1,92 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "core/aligned_math.h"
+#include "core/batch_transform.h"
+#include "core/entity_handle.h"
+#include "core/spatial_index.h"
+
+// EntityStore
+// -----------
+// Every entity's components, as a structure of arrays. Index i of every array is the
+// i-th LIVE entity: the arrays are always dense, so kernels run over [0, size()) with no
+// holes and no per-entity "alive" checks.
+//
+//     handle ──► slots_[handle.slot] ──► dense index ──► x[i], y[i], velocityX[i], ...
+//
+// | Operation     | Cost                                                            |
+// | ------------- | --------------------------------------------------------------- |
+// | create        | append to every array (+ reuse a free slot)                     |
+// | destroy       | swap-remove: the LAST entity moves into the hole, O(1)          |
+// | handle lookup | two array reads + generation compare                            |
+//
+// Swap-remove keeps the arrays dense but reorders them: dense indices are only valid
+// until the next destroy(). Hold EntityHandles across frames, not indices.
+//
+// Positions, rotation and scale are a Transforms2D, so composeModelMatrices,
+// composeAffine2D and cullTransforms consume the store as is.
+class EntityStore {
+public:
+    static constexpr std::size_t kNoIndex = static_cast<std::size_t>(-1);
+
+    void reserve(std::size_t count);
+    void clear();
+
+    EntityHandle create(const glm::vec2& position, const glm::vec2& scale = glm::vec2(1.0f),
+                        std::uint32_t color = 0xffffffffu, std::uint32_t sprite = 0);
+    bool destroy(EntityHandle handle); // false if the handle is stale
+
+    bool alive(EntityHandle handle) const { return indexOf(handle) != kNoIndex; }
+    std::size_t indexOf(EntityHandle handle) const;   // dense index, or kNoIndex
+    EntityHandle handleAt(std::size_t index) const;
+
+    std::size_t size() const { return transforms_.size(); }
+
+    // Components (dense arrays, see above).
+    Transforms2D& transforms() { return transforms_; }
+    const Transforms2D& transforms() const { return transforms_; }
+    AlignedVector<float>& velocityX() { return velocityX_; }
+    AlignedVector<float>& velocityY() { return velocityY_; }
+    std::vector<std::uint32_t>& color() { return color_; }         // packed RGBA8 (packColor)
+    std::vector<std::uint32_t>& sprite() { return sprite_; }       // texture layer / atlas id
+    const std::vector<std::uint32_t>& color() const { return color_; }
+    const std::vector<std::uint32_t>& sprite() const { return sprite_; }
+
+    // Kernels. Each is one pass over contiguous arrays; the loops are simple enough for
+    // the compiler to vectorize at -O2.
+
+    // Start of a fixed simulation step: remember positions for interpolate().
+    void beginStep();
+
+    // position += velocity * dt for entities [first, first + count).
+    void integrate(float dt, std::size_t first, std::size_t count);
+    void integrate(float dt) { integrate(dt, 0, size()); }
+
+    // Reflect the velocity of entities [first, first + count) that left `bounds` moving
+    // outward, so they stay inside.
+    void bounce(const Aabb& bounds, std::size_t first, std::size_t count);
+
+    // out = the transforms with positions blended from the previous step to the current
+    // one (alpha from FixedTimestep). Rotation and scale are taken as they are now.
+    void interpolate(float alpha, Transforms2D& out) const;
+
+private:
+    struct Slot {
+        std::uint32_t index = 0;      // dense index while alive, next free slot while free
+        std::uint32_t generation = 0;
+    };
+    static constexpr std::uint32_t kEndOfFreeList = 0xffffffffu;
+
+    Transforms2D transforms_;
+    AlignedVector<float> previousX_, previousY_;
+    AlignedVector<float> velocityX_, velocityY_;
+    std::vector<std::uint32_t> color_, sprite_;
+    std::vector<std::uint32_t> owner_; // dense index → slot (to fix up swap-removes)
+
+    std::vector<Slot> slots_;
+    std::uint32_t freeHead_ = kEndOfFreeList; // free slots form a list through Slot::index
+};
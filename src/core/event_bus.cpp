@@ -0,0 +1,21 @@
+#include "core/event_bus.h"
+
+std::uint32_t EventBus::nextTypeId() {
+    static std::atomic<std::uint32_t> next{0};
+    return next.fetch_add(1, std::memory_order_relaxed);
+}
+
+void EventBus::dispatch(FrameArena& arena) {
+    for (ChannelBase* channel : order_) {
+        dispatched_ += channel->drain(arena, batches_);
+    }
+}
+
+EventBus::Stats EventBus::stats() const {
+    Stats stats;
+    stats.published = published_.load(std::memory_order_relaxed);
+    stats.dropped = dropped_.load(std::memory_order_relaxed);
+    stats.dispatched = dispatched_;
+    stats.batches = batches_;
+    return stats;
+}
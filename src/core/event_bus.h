@@ -0,0 +1,154 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "core/frame_arena.h"
+#include "core/mpsc_ring.h"
+
+// EventBus
+// --------
+// Typed messages between subsystems that may live on different threads (input callbacks,
+// gameplay systems on the JobSystem, audio, rendering), instead of globals each side
+// reads and writes. One channel per event type:
+//
+//     bus.declare<PauseToggled, 16>();                           // setup, main thread
+//     bus.subscribe<PauseToggled>([&](const PauseToggled*, std::size_t n) { ... });
+//     bus.publish(PauseToggled{});                               // any thread
+//     bus.dispatch(FrameArena::thisThread());                    // main, once per phase
+//
+// | Step      | Where       | Cost                                                        |
+// | --------- | ----------- | ----------------------------------------------------------- |
+// | publish   | any thread  | one MpscRing push (core/mpsc_ring.h): a CAS, no lock, no    |
+// |           |             | allocation; a full channel drops the event (counted)        |
+// | dispatch  | main        | per channel with events: drained into one array on the      |
+// |           |             | frame arena, then each handler called ONCE with the batch   |
+//
+// Handlers see a type's events as one array (publish order per producer; producers
+// interleave), so a consumer that does the same thing to each loops over it without a
+// call per event. The array lives until the arena's reset(). Events are copied around
+// with the ring and never destroyed: they must be trivially copyable. Channels are
+// dispatched in declaration order.
+//
+// declare() and subscribe() are setup calls on the dispatching thread, before anything
+// publishes; publishing an undeclared type is a programming error (counted as dropped).
+class EventBus {
+public:
+    struct Stats {
+        std::uint64_t published = 0;   // accepted into a channel
+        std::uint64_t dropped = 0;     // channel full (or not declared)
+        std::uint64_t dispatched = 0;  // handed to handlers
+        std::uint64_t batches = 0;     // handler calls
+    };
+
+    EventBus() = default;
+    EventBus(const EventBus&) = delete;
+    EventBus& operator=(const EventBus&) = delete;
+
+    // A channel for E holding up to Capacity (a power of two) events between dispatches.
+    template <typename E, std::size_t Capacity>
+    void declare() {
+        static_assert(std::is_trivially_copyable<E>::value, "events are copied through a ring");
+        const std::uint32_t id = eventTypeId<E>();
+        if (channels_.size() <= id) {
+            channels_.resize(id + 1);
+        }
+        if (!channels_[id]) {
+            channels_[id] = std::make_unique<TypedChannel<E, Capacity>>();
+            order_.push_back(channels_[id].get());
+        }
+    }
+
+    template <typename E>
+    void subscribe(std::function<void(const E* events, std::size_t count)> handler) {
+        if (Channel<E>* channel = find<E>()) {
+            channel->handlers.push_back(std::move(handler));
+        }
+    }
+
+    // Any thread.
+    template <typename E>
+    bool publish(const E& event) {
+        Channel<E>* channel = find<E>();
+        if (channel == nullptr || !channel->push(event)) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        published_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // The subscribing thread: every channel's events so far, batched per type.
+    void dispatch(FrameArena& arena);
+
+    Stats stats() const;
+
+private:
+    struct ChannelBase {
+        virtual ~ChannelBase() = default;
+        // Events drained and handler calls made.
+        virtual std::size_t drain(FrameArena& arena, std::uint64_t& batches) = 0;
+    };
+
+    template <typename E>
+    struct Channel : ChannelBase {
+        std::vector<std::function<void(const E*, std::size_t)>> handlers;
+        virtual bool push(const E& event) = 0;
+    };
+
+    template <typename E, std::size_t Capacity>
+    struct TypedChannel final : Channel<E> {
+        MpscRing<E, Capacity> ring;
+
+        bool push(const E& event) override {
+            return ring.push([&event](E& slot) { slot = event; });
+        }
+
+        std::size_t drain(FrameArena& arena, std::uint64_t& batches) override {
+            E first;
+            if (!ring.pop([&first](const E& e) { first = e; })) {
+                return 0;
+            }
+            // At most Capacity are in the ring; ones published while draining wait for
+            // the next dispatch.
+            E* batch = static_cast<E*>(arena.allocate(sizeof(E) * Capacity, alignof(E)));
+            batch[0] = first;
+            std::size_t count = 1;
+            while (count < Capacity && ring.pop([&](const E& e) { batch[count] = e; })) {
+                ++count;
+            }
+            for (const auto& handler : this->handlers) {
+                handler(batch, count);
+                ++batches;
+            }
+            return count;
+        }
+    };
+
+    static std::uint32_t nextTypeId();
+
+    // Id of event type E, assigned on first use (like ECS componentId()).
+    template <typename E>
+    static std::uint32_t eventTypeId() {
+        static const std::uint32_t id = nextTypeId();
+        return id;
+    }
+
+    template <typename E>
+    Channel<E>* find() {
+        const std::uint32_t id = eventTypeId<E>();
+        return id < channels_.size() ? static_cast<Channel<E>*>(channels_[id].get()) : nullptr;
+    }
+
+    std::vector<std::unique_ptr<ChannelBase>> channels_;   // by event type id
+    std::vector<ChannelBase*> order_;                      // declaration order
+    std::atomic<std::uint64_t> published_{0};
+    std::atomic<std::uint64_t> dropped_{0};
+    std::uint64_t dispatched_ = 0;
+    std::uint64_t batches_ = 0;
+};
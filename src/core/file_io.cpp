@@ -0,0 +1,53 @@
+#include "core/file_io.h"
+
+#include <cstdio>
+
+namespace {
+
+// Both overloads: any contiguous container of char-sized elements.
+template <typename Buffer>
+bool readInto(const std::string& path, Buffer& out) {
+    out.clear();
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    bool ok = false;
+    long size = -1;
+    if (std::fseek(file, 0, SEEK_END) == 0) {
+        size = std::ftell(file);
+        std::rewind(file);
+    }
+    if (size >= 0) {
+        out.resize(static_cast<std::size_t>(size));
+        ok = size == 0 || std::fread(&out[0], 1, out.size(), file) == out.size();
+    } else {
+        constexpr std::size_t kChunk = 64 * 1024;
+        std::size_t used = 0;
+        for (;;) {
+            out.resize(used + kChunk);
+            const std::size_t got = std::fread(&out[used], 1, kChunk, file);
+            used += got;
+            if (got < kChunk) {
+                break;
+            }
+        }
+        out.resize(used);
+        ok = !std::ferror(file);
+    }
+    std::fclose(file);
+    if (!ok) {
+        out.clear();
+    }
+    return ok;
+}
+
+} // namespace
+
+bool readFile(const std::string& path, std::string& out) {
+    return readInto(path, out);
+}
+
+bool readFile(const std::string& path, std::vector<unsigned char>& out) {
+    return readInto(path, out);
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// readFile(...)
+// -------------
+// The whole file into `out` with one allocation and no stream layer:
+//
+//     fopen → seek to the end for the size → resize(out) once → one fread into it
+//
+// The usual ifstream → stringstream → std::string route copies every byte twice (into
+// the stream's buffer, then out of it) and grows the buffer several times on the way.
+// Files whose size can't be known upfront (pipes) are read in chunks instead.
+//
+// false (out empty) if the file can't be opened or read. Blocking.
+bool readFile(const std::string& path, std::string& out);
+bool readFile(const std::string& path, std::vector<unsigned char>& out);
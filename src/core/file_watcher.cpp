@@ -0,0 +1,121 @@
+#include "core/file_watcher.h"
+
+#include <algorithm>
+#include <iostream>
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+void addOnce(std::vector<std::string>& names, std::string name) {
+    if (std::find(names.begin(), names.end(), name) == names.end()) {
+        names.push_back(std::move(name));
+    }
+}
+
+} // namespace
+
+#ifdef __linux__
+
+bool FileWatcher::init(const std::string& directory) {
+    shutdown();
+    directory_ = directory;
+    fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd_ < 0) {
+        std::cerr << "FileWatcher: inotify_init1 failed: " << std::strerror(errno) << "\n";
+        return false;
+    }
+    if (inotify_add_watch(fd_, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        std::cerr << "FileWatcher: cannot watch " << directory << ": " << std::strerror(errno) << "\n";
+        shutdown();
+        return false;
+    }
+    return true;
+}
+
+void FileWatcher::shutdown() {
+    if (fd_ >= 0) {
+        close(fd_); // removes the watch with it
+        fd_ = -1;
+    }
+}
+
+std::vector<std::string> FileWatcher::poll() {
+    std::vector<std::string> changed;
+    if (fd_ < 0) {
+        return changed;
+    }
+    // Events are variable-length: header + NUL-padded name. EAGAIN = nothing (more) queued.
+    alignas(inotify_event) char buffer[4096];
+    while (true) {
+        const ssize_t length = read(fd_, buffer, sizeof(buffer));
+        if (length <= 0) {
+            break;
+        }
+        for (ssize_t at = 0; at < length;) {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + at);
+            if (event->len > 0 && (event->mask & IN_ISDIR) == 0) {
+                addOnce(changed, event->name);
+            }
+            at += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+        }
+    }
+    return changed;
+}
+
+#else
+
+bool FileWatcher::init(const std::string& directory) {
+    shutdown();
+    directory_ = directory;
+    std::error_code ec;
+    if (!std::filesystem::is_directory(directory, ec)) {
+        std::cerr << "FileWatcher: cannot watch " << directory << ": not a directory\n";
+        return false;
+    }
+    scan(nullptr); // the current times: what's already there isn't a change
+    nextScan_ = std::chrono::steady_clock::now() + kScanInterval;
+    return true;
+}
+
+void FileWatcher::shutdown() {
+    times_.clear();
+}
+
+bool FileWatcher::scan(std::vector<std::string>* changed) {
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(directory_, ec)) {
+        if (!entry.is_regular_file(ec)) {
+            continue;
+        }
+        const auto time = entry.last_write_time(ec);
+        if (ec) {
+            continue;
+        }
+        const std::string name = entry.path().filename().string();
+        auto it = times_.find(name);
+        if (it == times_.end() || it->second != time) {
+            times_[name] = time;
+            if (changed) addOnce(*changed, name);
+        }
+    }
+    return !ec;
+}
+
+std::vector<std::string> FileWatcher::poll() {
+    std::vector<std::string> changed;
+    const auto now = std::chrono::steady_clock::now();
+    if (directory_.empty() || now < nextScan_) {
+        return changed;
+    }
+    nextScan_ = now + kScanInterval;
+    scan(&changed);
+    return changed;
+}
+
+#endif
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#ifndef __linux__
+#include <chrono>
+#include <filesystem>
+#include <unordered_map>
+#endif
+
+// FileWatcher
+// -----------
+// Reports which files in ONE directory (not its subdirectories) were written since the
+// last poll(). poll() never blocks, so it can run once per frame:
+//
+// | Platform | Mechanism                                 | poll() cost                   |
+// | -------- | ----------------------------------------- | ----------------------------- |
+// | Linux    | inotify, IN_CLOSE_WRITE | IN_MOVED_TO     | one non-blocking read()       |
+// | other    | last_write_time of every file, compared   | a directory scan, at most     |
+// |          | with the previous scan                    | every kScanInterval           |
+//
+// IN_CLOSE_WRITE fires once a writer closes the file, so a half-written file is never
+// reported; IN_MOVED_TO catches editors that save to a temporary file and rename it
+// over the original. Names are relative to the directory ("vertex.glsl"), each listed
+// once per poll however many events it produced.
+class FileWatcher {
+public:
+    FileWatcher() = default;
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+    ~FileWatcher() { shutdown(); }
+
+    bool init(const std::string& directory);
+    void shutdown();
+
+    std::vector<std::string> poll();
+
+    const std::string& directory() const { return directory_; }
+
+private:
+    std::string directory_;
+#ifdef __linux__
+    int fd_ = -1;
+#else
+    static constexpr std::chrono::milliseconds kScanInterval{250};
+    std::unordered_map<std::string, std::filesystem::file_time_type> times_;
+    std::chrono::steady_clock::time_point nextScan_{};
+    bool scan(std::vector<std::string>* changed);
+#endif
+};
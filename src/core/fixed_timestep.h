@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+
+#include "core/clock.h"
+
+// FixedTimestep
+// -------------
+// Decouples SIMULATION rate from RENDER rate ("fix your timestep").
+//
+// Each frame the real elapsed time is added to an accumulator; the simulation then runs
+// as many whole steps of `dt` as fit, and the leftover fraction becomes alpha() for
+// interpolating between the previous and current simulation states when rendering.
+//
+//     frame time ──► accumulator ──► N x update(dt) ──► render(lerp(prev, curr, alpha))
+//
+// | Render rate | Sim rate | Steps per frame          |
+// | ----------- | -------- | ------------------------ |
+// | 240 Hz      | 60 Hz    | 0 or 1 (mostly 0)        |
+// | 60 Hz       | 60 Hz    | 1                        |
+// | 30 Hz       | 60 Hz    | 2                        |
+//
+// Behaviour no longer depends on frame rate, and a fast renderer doesn't redo sim work.
+// Time is kept in integer ticks (core/clock.h): the accumulator takes from and gives back
+// exact amounts, so weeks of uptime leave no rounding behind. A step is dt() rounded to a
+// whole nanosecond (60 Hz: 16666667 ns); dt() reports that rounded step, so the
+// simulation integrates exactly the time the accumulator consumed.
+class FixedTimestep {
+public:
+    explicit FixedTimestep(double hz = 60.0, int maxStepsPerFrame = 8) {
+        setRate(hz);
+        maxSteps_ = maxStepsPerFrame;
+    }
+
+    void setRate(double hz) {
+        hz_ = hz > 0.0 ? hz : 60.0;
+        dtTicks_ = monoclock::fromSeconds(1.0 / hz_);
+    }
+
+    // Feed real frame time (clock ticks); returns the number of sim steps to run now.
+    // Clamped to maxStepsPerFrame so a long stall (debugger, window drag) can't cause a
+    // "spiral of death" where catching up takes longer than the time it covers.
+    int advance(monoclock::Ticks frameTicks) {
+        if (frameTicks < 0) {
+            frameTicks = 0;
+        }
+        accumulator_ += frameTicks;
+        monoclock::Ticks steps = accumulator_ / dtTicks_;
+        if (steps > maxSteps_) {
+            steps = maxSteps_;
+            accumulator_ = 0; // drop the backlog instead of fast-forwarding
+        } else {
+            accumulator_ -= steps * dtTicks_;
+        }
+        ticks_ += static_cast<std::uint64_t>(steps);
+        return static_cast<int>(steps);
+    }
+
+    double dt() const { return monoclock::toSeconds(dtTicks_); }
+    monoclock::Ticks dtTicks() const { return dtTicks_; }
+    double rate() const { return hz_; }
+    // 0..1: how far the render time is between the last two simulation states.
+    double alpha() const { return static_cast<double>(accumulator_) / static_cast<double>(dtTicks_); }
+    // Total simulation steps taken; simulation time = ticks() * dt().
+    std::uint64_t ticks() const { return ticks_; }
+    double simulationTime() const { return monoclock::toSeconds(static_cast<monoclock::Ticks>(ticks_) * dtTicks_); }
+
+private:
+    double hz_ = 60.0;
+    monoclock::Ticks dtTicks_ = monoclock::kTicksPerSecond / 60;
+    monoclock::Ticks accumulator_ = 0;
+    int maxSteps_ = 8;
+    std::uint64_t ticks_ = 0;
+};
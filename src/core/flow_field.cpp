@@ -0,0 +1,186 @@
+#include "core/flow_field.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "core/job_system.h"
+
+namespace {
+
+// PathGrid's step order: the straights, then the diagonals.
+constexpr int kStepX[8] = {1, -1, 0, 0, 1, 1, -1, -1};
+constexpr int kStepY[8] = {0, 0, 1, -1, 1, -1, 1, -1};
+constexpr std::int32_t kStepCost[8] = {PathGrid::kStraight, PathGrid::kStraight, PathGrid::kStraight,
+                                       PathGrid::kStraight, PathGrid::kDiagonal, PathGrid::kDiagonal,
+                                       PathGrid::kDiagonal, PathGrid::kDiagonal};
+// Diagonal 4 + k crosses the corner between straights kSides[k][0] and kSides[k][1].
+constexpr int kSides[4][2] = {{0, 2}, {0, 3}, {1, 2}, {1, 3}};
+
+const glm::vec2 kDirections[8] = {
+    {1.0f, 0.0f}, {-1.0f, 0.0f}, {0.0f, 1.0f}, {0.0f, -1.0f},
+    {0.70710678f, 0.70710678f}, {0.70710678f, -0.70710678f},
+    {-0.70710678f, 0.70710678f}, {-0.70710678f, -0.70710678f},
+};
+
+} // namespace
+
+void FlowField::build(const PathGrid& grid, glm::ivec2 goal, JobSystem& jobs) {
+    options_ = grid.options();
+    const int width = options_.width;
+    const int height = options_.height;
+    stride_ = static_cast<std::size_t>(width) + 2;
+    for (int d = 0; d < 8; ++d) {
+        offsets_[d] = static_cast<std::ptrdiff_t>(kStepY[d]) * static_cast<std::ptrdiff_t>(stride_) + kStepX[d];
+    }
+    const std::size_t padded = stride_ * (static_cast<std::size_t>(height) + 2);
+    open_.assign(padded, 0);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            open_[index(x, y)] = !grid.blocked(x, y);
+        }
+    }
+    integration_.assign(padded, kUnreachable);
+    directions_.assign(static_cast<std::size_t>(width) * height, kNone);
+    goal_ = goal;
+    valid_ = goal.x >= 0 && goal.x < width && goal.y >= 0 && goal.y < height && open_[index(goal.x, goal.y)];
+    ++stats_.builds;
+    stats_.reached = 0;
+    if (!valid_) {
+        return;
+    }
+    integrate(index(goal.x, goal.y));
+
+    const std::size_t bands = static_cast<std::size_t>((height + kBandRows - 1) / kBandRows);
+    jobs.parallelFor(bands, 1, [this, height](std::size_t begin, std::size_t end) {
+        for (std::size_t band = begin; band < end; ++band) {
+            const int y0 = static_cast<int>(band) * kBandRows;
+            directRows(y0, std::min(height, y0 + kBandRows));
+        }
+    });
+}
+
+// Dial's algorithm: bucket c % 16 holds the tiles reached at cost c. Every step costs
+// less than 16, so a pushed tile never lands in the bucket being drained.
+void FlowField::integrate(std::size_t goal) {
+    for (std::vector<std::uint32_t>& bucket : buckets_) {
+        bucket.clear();
+    }
+    integration_[goal] = 0;
+    buckets_[0].push_back(static_cast<std::uint32_t>(goal));
+    std::size_t queued = 1;
+    for (std::int32_t cost = 0; queued > 0; ++cost) {
+        std::vector<std::uint32_t>& bucket = buckets_[cost & 15];
+        for (std::size_t k = 0; k < bucket.size(); ++k) {
+            const std::size_t c = bucket[k];
+            if (integration_[c] != cost) {
+                continue;                      // reached cheaper since it was queued
+            }
+            ++stats_.reached;
+            for (int d = 0; d < 8; ++d) {
+                const std::size_t n = static_cast<std::size_t>(static_cast<std::ptrdiff_t>(c) + offsets_[d]);
+                if (!open_[n]) {
+                    continue;
+                }
+                if (d >= 4 && (!open_[c + offsets_[kSides[d - 4][0]]] || !open_[c + offsets_[kSides[d - 4][1]]])) {
+                    continue;                  // no cutting a blocked corner
+                }
+                const std::int32_t next = cost + kStepCost[d];
+                if (next < integration_[n]) {
+                    integration_[n] = next;
+                    buckets_[next & 15].push_back(static_cast<std::uint32_t>(n));
+                    ++queued;
+                }
+            }
+        }
+        queued -= bucket.size();
+        bucket.clear();
+    }
+}
+
+// The step whose neighbour's cost plus the step is smallest (the first on ties, so the
+// SSE2 and scalar versions agree). Only called for reachable tiles other than the goal,
+// whose open straight neighbours are all reachable too: a diagonal's corner is open
+// exactly when both its straights have a cost.
+std::uint8_t FlowField::directTile(std::size_t c) const {
+    const std::int32_t own = integration_[c];
+    if (own == 0 || own >= kUnreachable) {
+        return kNone;
+    }
+    std::int32_t best = kUnreachable;
+    std::uint8_t dir = kNone;
+    for (int d = 0; d < 8; ++d) {
+        if (d >= 4 && (integration_[c + offsets_[kSides[d - 4][0]]] >= kUnreachable ||
+                       integration_[c + offsets_[kSides[d - 4][1]]] >= kUnreachable)) {
+            continue;
+        }
+        const std::int32_t through = integration_[c + offsets_[d]] + kStepCost[d];
+        if (through < best) {
+            best = through;
+            dir = static_cast<std::uint8_t>(d);
+        }
+    }
+    return dir;
+}
+
+void FlowField::directRows(int y0, int y1) {
+    const int width = options_.width;
+    for (int y = y0; y < y1; ++y) {
+        const std::size_t row = index(0, y);
+        std::uint8_t* out = &directions_[static_cast<std::size_t>(y) * width];
+        int x = 0;
+#if defined(__SSE2__)
+        const __m128i unreachable = _mm_set1_epi32(kUnreachable);
+        const __m128i none = _mm_set1_epi32(kNone);
+        const __m128i zero = _mm_setzero_si128();
+        for (; x + 4 <= width; x += 4) {
+            const std::int32_t* c = &integration_[row + static_cast<std::size_t>(x)];
+            __m128i n[8];
+            for (int d = 0; d < 8; ++d) {
+                n[d] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c + offsets_[d]));
+            }
+            __m128i best = unreachable;
+            __m128i dir = none;
+            for (int d = 0; d < 8; ++d) {
+                __m128i through = _mm_add_epi32(n[d], _mm_set1_epi32(kStepCost[d]));
+                __m128i better = _mm_cmplt_epi32(through, best);
+                if (d >= 4) {
+                    // Both straights open (they have a cost) or the corner is cut.
+                    better = _mm_and_si128(better, _mm_cmplt_epi32(n[kSides[d - 4][0]], unreachable));
+                    better = _mm_and_si128(better, _mm_cmplt_epi32(n[kSides[d - 4][1]], unreachable));
+                }
+                best = _mm_or_si128(_mm_and_si128(better, through), _mm_andnot_si128(better, best));
+                dir = _mm_or_si128(_mm_and_si128(better, _mm_set1_epi32(d)), _mm_andnot_si128(better, dir));
+            }
+            // The goal and unreachable tiles point nowhere.
+            const __m128i own = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c));
+            const __m128i nowhere = _mm_or_si128(_mm_cmpeq_epi32(own, zero),
+                                                 _mm_cmpeq_epi32(_mm_cmplt_epi32(own, unreachable), zero));
+            dir = _mm_or_si128(_mm_and_si128(nowhere, none), _mm_andnot_si128(nowhere, dir));
+            const __m128i bytes = _mm_packus_epi16(_mm_packs_epi32(dir, dir), zero);
+            const std::int32_t packed = _mm_cvtsi128_si32(bytes);
+            std::memcpy(out + x, &packed, 4);
+        }
+#endif
+        for (; x < width; ++x) {
+            out[x] = directTile(row + static_cast<std::size_t>(x));
+        }
+    }
+}
+
+glm::vec2 FlowField::direction(const glm::vec2& world) const {
+    if (!valid_) {
+        return glm::vec2(0.0f);
+    }
+    const glm::vec2 t = glm::floor((world - options_.origin) / options_.tileSize);
+    if (t.x < 0.0f || t.y < 0.0f || t.x >= static_cast<float>(options_.width) ||
+        t.y >= static_cast<float>(options_.height)) {
+        return glm::vec2(0.0f);
+    }
+    const std::uint8_t d = directions_[static_cast<std::size_t>(t.y) * options_.width + static_cast<std::size_t>(t.x)];
+    return d == kNone ? glm::vec2(0.0f) : kDirections[d];
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "core/path_grid.h"
+
+class JobSystem;
+
+// FlowField
+// ---------
+// Every tile's way to one goal tile over a PathGrid's walkability (core/path_grid.h), for
+// crowds that share the goal: built once per goal (or map edit), then any number of
+// agents steer with one lookup each instead of a path query each.
+//
+// | Field       | Per tile                               | Built by                       |
+// | ----------- | -------------------------------------- | ------------------------------ |
+// | integration | cost to the goal (kStraight a step,    | a wavefront out of the goal:   |
+// |             | kDiagonal a diagonal), or kUnreachable | Dial's bucket queue, the costs |
+// |             |                                        | being small integers: O(tiles) |
+// | direction   | the step (0..7) into the neighbour the | row bands on the JobSystem, 4  |
+// |             | cost came through, or kNone            | tiles per SSE2 compare         |
+//
+// The wavefront is serial (its order is what makes it right), but it only touches each
+// tile once; the direction pass is the one with 8 reads per tile, and each tile's is
+// independent. The integration field has a border of unreachable tiles, so those reads
+// need no bounds checks, 4 neighbours at a time. Diagonals follow PathGrid's rule: no
+// cutting a blocked corner.
+class FlowField {
+public:
+    static constexpr std::int32_t kUnreachable = 0x3fffffff;  // + a step still fits an int32
+    static constexpr std::uint8_t kNone = 0xff;               // the goal, blocked, or unreachable
+    static constexpr int kBandRows = 16;                      // rows per direction job
+
+    struct Stats {
+        std::uint64_t builds = 0;
+        std::size_t reached = 0;       // tiles with a way to the goal, last build
+    };
+
+    // Both fields for `goal` (tile coordinates); an open goal inside the grid makes the
+    // field valid().
+    void build(const PathGrid& grid, glm::ivec2 goal, JobSystem& jobs);
+
+    bool valid() const { return valid_; }
+    glm::ivec2 goal() const { return goal_; }
+    // Unit vector toward the goal from a world position; zero on the goal's tile, off the
+    // map, or where the goal can't be reached.
+    glm::vec2 direction(const glm::vec2& world) const;
+    std::int32_t cost(int x, int y) const { return integration_[index(x, y)]; }
+
+    const Stats& stats() const { return stats_; }
+
+private:
+    std::size_t index(int x, int y) const {
+        return static_cast<std::size_t>(y + 1) * stride_ + static_cast<std::size_t>(x + 1);
+    }
+    void integrate(std::size_t goal);
+    void directRows(int y0, int y1);
+    std::uint8_t directTile(std::size_t c) const;
+
+    PathGrid::Options options_;
+    std::size_t stride_ = 0;                   // width + 2: the border columns
+    std::ptrdiff_t offsets_[8] = {};           // the 8 neighbours' index deltas
+    bool valid_ = false;
+    glm::ivec2 goal_{0};
+    std::vector<std::uint8_t> open_;           // padded like integration_
+    std::vector<std::int32_t> integration_;    // (width + 2) x (height + 2)
+    std::vector<std::uint8_t> directions_;     // width x height
+    std::vector<std::uint32_t> buckets_[16];   // cost % 16: steps cost at most 14
+    Stats stats_;
+};
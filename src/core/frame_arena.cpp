@@ -0,0 +1,92 @@
+#include "core/frame_arena.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+namespace {
+
+constexpr std::size_t kBlockAlign = 64;          // a cache line; covers every kDefaultAlign
+constexpr std::size_t kMinOverflowBytes = 64 * 1024;
+
+std::size_t alignUp(std::size_t value, std::size_t align) { return (value + align - 1) & ~(align - 1); }
+
+} // namespace
+
+bool FrameArena::init(std::size_t bytes) {
+    if (bytes <= stats_.capacity) {
+        return true;
+    }
+    return grow(bytes);
+}
+
+void FrameArena::shutdown() {
+    reset();
+    ::operator delete(block_, std::align_val_t(kBlockAlign));
+    block_ = nullptr;
+    stats_.capacity = 0;
+}
+
+bool FrameArena::grow(std::size_t bytes) {
+    bytes = alignUp(bytes, kBlockAlign);
+    void* block = ::operator new(bytes, std::align_val_t(kBlockAlign), std::nothrow);
+    if (block == nullptr) {
+        std::cerr << "FrameArena: cannot allocate " << bytes << " bytes\n";
+        return false;
+    }
+    ::operator delete(block_, std::align_val_t(kBlockAlign));
+    block_ = static_cast<unsigned char*>(block);
+    stats_.capacity = bytes;
+    return true;
+}
+
+void* FrameArena::allocate(std::size_t bytes, std::size_t align) {
+    std::size_t start = alignUp(offset_, align);
+    if (block_ != nullptr && start + bytes <= stats_.capacity) {
+        stats_.used += start - offset_ + bytes; // padding included
+        offset_ = start + bytes;
+        return block_ + start;
+    }
+    // Doesn't fit: bump through the newest overflow block, or start another one. The
+    // next reset() frees them all.
+    unsigned char* overflow = reinterpret_cast<unsigned char*>(overflow_);
+    start = alignUp(overflowOffset_, align);
+    if (overflow == nullptr || align > overflow_->align || start + bytes > overflow_->size) {
+        const std::size_t blockAlign = align > kBlockAlign ? align : kBlockAlign;
+        const std::size_t header = alignUp(sizeof(Overflow), blockAlign);
+        const std::size_t size = header + (bytes > kMinOverflowBytes ? bytes : kMinOverflowBytes);
+        overflow = static_cast<unsigned char*>(::operator new(size, std::align_val_t(blockAlign)));
+        overflow_ = new (overflow) Overflow{overflow_, size, blockAlign};
+        ++stats_.overflows;
+        start = header;
+        overflowOffset_ = header;
+    }
+    stats_.used += start - overflowOffset_ + bytes;
+    overflowOffset_ = start + bytes;
+    return overflow + start;
+}
+
+void FrameArena::reset() {
+    bool overflowed = false;
+    while (overflow_ != nullptr) {
+        Overflow* next = overflow_->next;
+        ::operator delete(overflow_, std::align_val_t(overflow_->align));
+        overflow_ = next;
+        overflowed = true;
+    }
+    if (stats_.used > stats_.peak) {
+        stats_.peak = stats_.used;
+    }
+    if (overflowed && stats_.peak > stats_.capacity) {
+        // Headroom, so a frame slightly bigger than the last one still fits.
+        grow(stats_.peak + stats_.peak / 4);
+    }
+    offset_ = 0;
+    overflowOffset_ = 0;
+    stats_.used = 0;
+}
+
+FrameArena& FrameArena::thisThread() {
+    thread_local FrameArena arena;
+    return arena;
+}
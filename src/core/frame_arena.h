@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// FrameArena
+// ----------
+// Linear allocator for data that lives exactly one frame. allocate() bumps an offset into
+// one block; reset() at the frame boundary rewinds it, and every allocation of the frame
+// is gone at once. Nothing is freed individually and nothing is destroyed: only trivially
+// destructible data (or containers whose storage is released before reset()) belongs here.
+//
+//     arena.reset();                                 // start of the frame
+//     FrameVector<glm::mat4> models(FrameAllocator<glm::mat4>(arena));
+//     models.resize(visible);                         // a bump, no malloc
+//
+// When a frame needs more than the block holds, the rest comes from overflow blocks on
+// the heap (counted in stats(), and by alloccount). The next reset() frees them and
+// regrows the main block to the frame's peak, so after the first big frame the arena no
+// longer touches the heap:
+//
+// | Frame          | Heap allocations                                        |
+// | -------------- | ------------------------------------------------------- |
+// | first          | one per overflow block (the arena starts empty)         |
+// | reset() after  | one: the main block, regrown to the peak                |
+// | steady state   | none, as long as no frame needs more than the peak      |
+//
+// Not thread-safe: an arena belongs to one thread at a time. FrameArena::thisThread() is
+// the calling thread's own; FramePacket carries one more per packet, handed between main
+// and the render thread together with the packet (render/frame_packet.h).
+class FrameArena {
+public:
+    struct Stats {
+        std::size_t capacity = 0;  // bytes in the main block
+        std::size_t used = 0;      // bytes allocated this frame, overflow included
+        std::size_t peak = 0;      // most bytes any frame used
+        std::uint64_t overflows = 0; // overflow blocks allocated so far
+    };
+
+    static constexpr std::size_t kDefaultAlign = alignof(std::max_align_t);
+
+    FrameArena() = default;
+    ~FrameArena() { shutdown(); }
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // Preallocates the main block (optional: the first reset() sizes it to the peak).
+    bool init(std::size_t bytes);
+    void shutdown();
+
+    // Never fails short of the heap failing; align must be a power of two.
+    void* allocate(std::size_t bytes, std::size_t align = kDefaultAlign);
+    // Rewinds to empty. Frees overflow blocks and grows the main block if the frame needed them.
+    void reset();
+
+    const Stats& stats() const { return stats_; }
+
+    // The calling thread's arena: main resets its own at the top of the loop, the render
+    // thread its own at the start of each packet. Created empty on first use.
+    static FrameArena& thisThread();
+
+private:
+    struct Overflow {
+        Overflow* next;
+        std::size_t size;      // bytes, this header included
+        std::size_t align;     // what it was allocated with
+    };
+
+    bool grow(std::size_t bytes);
+
+    unsigned char* block_ = nullptr;
+    std::size_t offset_ = 0;
+    Overflow* overflow_ = nullptr; // this frame's extra blocks, newest first
+    std::size_t overflowOffset_ = 0; // into overflow_
+    Stats stats_;
+};
+
+// FrameAllocator<T>
+// -----------------
+// STL allocator on a FrameArena. deallocate() does nothing: the arena's reset() reclaims
+// everything. Default-constructed, it uses FrameArena::thisThread(), so a container that
+// is created and dropped within one frame on one thread needs no arena argument at all:
+//
+//     FrameVector<ObjectId> picked;     // this thread's arena
+//
+// A container that outlives reset() must give its storage back first—frameRelease(c)—or
+// it keeps pointers into memory the next frame overwrites.
+template <typename T>
+class FrameAllocator {
+public:
+    using value_type = T;
+    // Moving or swapping a container moves its storage, which stays in its arena.
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    FrameAllocator() : arena_(&FrameArena::thisThread()) {}
+    explicit FrameAllocator(FrameArena& arena) : arena_(&arena) {}
+    template <typename U>
+    FrameAllocator(const FrameAllocator<U>& other) : arena_(other.arena()) {}
+
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T) > FrameArena::kDefaultAlign
+                                                                   ? alignof(T)
+                                                                   : FrameArena::kDefaultAlign));
+    }
+    void deallocate(T*, std::size_t) {}
+
+    FrameArena* arena() const { return arena_; }
+
+private:
+    FrameArena* arena_;
+};
+
+template <typename T, typename U>
+bool operator==(const FrameAllocator<T>& a, const FrameAllocator<U>& b) {
+    return a.arena() == b.arena();
+}
+template <typename T, typename U>
+bool operator!=(const FrameAllocator<T>& a, const FrameAllocator<U>& b) {
+    return a.arena() != b.arena();
+}
+
+template <typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+using FrameString = std::basic_string<char, std::char_traits<char>, FrameAllocator<char>>;
+using FrameStringStream = std::basic_ostringstream<char, std::char_traits<char>, FrameAllocator<char>>;
+
+// Drops a container's storage and keeps its allocator, so it can be refilled from the
+// same arena after reset().
+template <typename Container>
+void frameRelease(Container& container) {
+    Container(container.get_allocator()).swap(container);
+}
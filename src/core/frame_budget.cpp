@@ -0,0 +1,95 @@
+#include "core/frame_budget.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+namespace {
+
+constexpr double kAverageWeight = 0.1;   // of the newest frame in the moving average
+constexpr double kOverrun = 1.1;         // of the budget
+
+} // namespace
+
+void FrameBudget::add(const char* name, double weight, Slice slice) {
+    Subsystem s;
+    s.name = name;
+    s.weight = std::max(weight, 0.0);
+    subsystems_.push_back(s);
+    slices_.push_back(std::move(slice));
+}
+
+bool FrameBudget::runSlices(std::size_t i, monoclock::Ticks until, bool first) {
+    Subsystem& s = subsystems_[i];
+    const monoclock::Ticks start = monoclock::now();
+    monoclock::Ticks now = start;
+    bool more = true;
+    while (more && (first || now < until)) {
+        more = slices_[i]();
+        ++s.slices;
+        first = false;
+        now = monoclock::now();
+    }
+    s.ms += monoclock::toMs(now - start);
+    spent_ += now - start;
+    s.more = more;
+    return more;
+}
+
+void FrameBudget::run(monoclock::Ticks frameStart) {
+    frameStart_ = frameStart;
+    spent_ = 0;
+    const monoclock::Ticks start = monoclock::now();
+    // The frame's share, less what main's other work took lately (the larger of the last
+    // frame and the average: a slow frame is believed at once, a fast one slowly).
+    const double other = std::max(otherAverageMs_, otherLastMs_);
+    const double budgetMs = std::max(settings_.minMs, period_ * 1000.0 * settings_.headroom - other);
+    const monoclock::Ticks deadline = settings_.unlimited ? std::numeric_limits<monoclock::Ticks>::max()
+                                                          : start + monoclock::fromSeconds(budgetMs / 1000.0);
+    stats_.budgetMs = settings_.unlimited ? 0.0 : budgetMs;
+    ++stats_.frames;
+
+    // Each subsystem its weighted share of the budget, at least a slice.
+    double totalWeight = 0.0;
+    for (const Subsystem& s : subsystems_) {
+        totalWeight += s.weight;
+    }
+    for (std::size_t i = 0; i < subsystems_.size(); ++i) {
+        const double share = totalWeight > 0.0 ? subsystems_[i].weight / totalWeight : 0.0;
+        const monoclock::Ticks until =
+            settings_.unlimited ? deadline
+                                : std::min(deadline, monoclock::now() + monoclock::fromSeconds(budgetMs * share / 1000.0));
+        runSlices(i, until, true);
+    }
+    // What the ones done early left: a slice at a time to those with work, in turn.
+    bool any = true;
+    while (any && monoclock::now() < deadline) {
+        any = false;
+        for (std::size_t i = 0; i < subsystems_.size() && monoclock::now() < deadline; ++i) {
+            if (subsystems_[i].more) {
+                any |= runSlices(i, 0, true);       // exactly one
+            }
+        }
+    }
+
+    bool deferred = false;
+    for (Subsystem& s : subsystems_) {
+        s.deferred += s.more ? 1 : 0;
+        deferred |= s.more;
+    }
+    stats_.deferred += deferred ? 1 : 0;
+    // The last slice always ends a little past the deadline; a tenth over is a real overrun.
+    stats_.overruns += !settings_.unlimited && monoclock::toMs(spent_) > budgetMs * kOverrun ? 1 : 0;
+    stats_.spentMs += monoclock::toMs(spent_);
+}
+
+void FrameBudget::endFrame(monoclock::Ticks now) {
+    if (frameStart_ == 0) {
+        return;                        // no run() this frame
+    }
+    otherLastMs_ = std::max(0.0, monoclock::toMs(now - frameStart_ - spent_));
+    otherAverageMs_ = stats_.frames <= 1 ? otherLastMs_
+                                         : otherAverageMs_ + (otherLastMs_ - otherAverageMs_) * kAverageWeight;
+    stats_.otherMs = std::max(otherAverageMs_, otherLastMs_);
+    frameStart_ = 0;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "core/clock.h"
+
+// FrameBudget
+// -----------
+// Work that doesn't have to finish this frame (spawning streamed regions, agents
+// re-planning, path answers) in slices, run on the main thread only while the frame can
+// afford them: under load the backlog waits a frame or two instead of the frame being
+// late. The budget nests:
+//
+// | Level     | Time                                                                   |
+// | --------- | ---------------------------------------------------------------------- |
+// | frame     | the target period (the refresh rate with vsync, --fps-cap, else 60 Hz) |
+// |           | x headroom, what main's whole frame may take                           |
+// | budgeted  | that less main's other work (cull, compose, ...): the larger of its    |
+// |           | last frame and its moving average, measured by endFrame()              |
+// | subsystem | the budgeted time split by weight, in the order add() was called; a    |
+// |           | subsystem done early leaves its rest to those still with work          |
+// | slice     | one call: whatever unit the subsystem picks (a region, 256 agents)     |
+//
+// Every subsystem gets one slice a frame even when the budget is gone, so nothing
+// starves: a frame can only be late by the slices' sizes (Stats::overruns). A slice
+// returns whether its subsystem has more work left; one with nothing to do returns false
+// at once. Settings::unlimited runs every slice until none has work (offline rendering,
+// benchmarks and replays: the same frames whatever the machine's speed).
+//
+// Main thread only; the slices are called inside run().
+class FrameBudget {
+public:
+    // Runs one slice of its subsystem's work if there is any; true while more is left.
+    using Slice = std::function<bool()>;
+
+    struct Settings {
+        double headroom = 0.8;         // of the period, for main's whole frame
+        double minMs = 0.25;           // the budgeted work's floor, however full the frame
+        bool unlimited = false;        // every slice, no deadline
+    };
+
+    struct Subsystem {
+        const char* name = "";
+        double weight = 1.0;
+        std::uint64_t slices = 0;
+        std::uint64_t deferred = 0;    // frames it ended with work left
+        double ms = 0.0;               // in its slices, in total
+        bool more = false;             // work left after the last run()
+    };
+
+    struct Stats {
+        std::uint64_t frames = 0;
+        std::uint64_t deferred = 0;    // frames that left work for later
+        std::uint64_t overruns = 0;    // frames whose slices took a tenth over the budget
+        double budgetMs = 0.0;         // the last frame's
+        double spentMs = 0.0;          // in all slices, in total
+        double otherMs = 0.0;          // main's other work, as the next budget assumes it
+    };
+
+    void setSettings(const Settings& settings) { settings_ = settings; }
+    // The frame's target period, seconds: at startup and when vsync or the cap change.
+    void setPeriod(double seconds) { period_ = seconds; }
+
+    // name: a string literal. weight: its share of the budgeted time, against the others'.
+    void add(const char* name, double weight, Slice slice);
+
+    // Main, once a frame: slices until the budget is spent. frameStart: the frame's start.
+    void run(monoclock::Ticks frameStart);
+    // Main, when the frame's own work is done (before presenting): main's other work,
+    // measured for the next frame's budget.
+    void endFrame(monoclock::Ticks now);
+
+    double periodMs() const { return period_ * 1000.0; }
+    const std::vector<Subsystem>& subsystems() const { return subsystems_; }
+    const Stats& stats() const { return stats_; }
+
+private:
+    // Slices of subsystem i until `until` (at least one if `first`); false: it is done.
+    bool runSlices(std::size_t i, monoclock::Ticks until, bool first);
+
+    Settings settings_;
+    double period_ = 1.0 / 60.0;
+    std::vector<Subsystem> subsystems_;
+    std::vector<Slice> slices_;
+    monoclock::Ticks frameStart_ = 0;
+    monoclock::Ticks spent_ = 0;       // this frame's slices
+    double otherAverageMs_ = 0.0;
+    double otherLastMs_ = 0.0;
+    Stats stats_;
+};
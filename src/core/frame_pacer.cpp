@@ -0,0 +1,69 @@
+#include "core/frame_pacer.h"
+
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+void FramePacer::init(const Settings& settings) {
+    settings_ = settings;
+    setVsync(settings_.vsync);
+    nextDeadline_ = Clock::now();
+}
+
+void FramePacer::setVsync(VsyncMode mode) {
+    settings_.vsync = mode;
+    effectiveVsync_ = mode;
+    if (mode == VsyncMode::Adaptive &&
+        !glfwExtensionSupported("WGL_EXT_swap_control_tear") &&
+        !glfwExtensionSupported("GLX_EXT_swap_control_tear")) {
+        std::cerr << "Adaptive vsync not supported, using vsync on\n";
+        effectiveVsync_ = VsyncMode::On;
+    }
+
+    switch (effectiveVsync_) {
+        case VsyncMode::Off:      glfwSwapInterval(0); break;
+        case VsyncMode::On:       glfwSwapInterval(1); break;
+        case VsyncMode::Adaptive: glfwSwapInterval(-1); break;
+    }
+}
+
+void FramePacer::waitForNextFrame() {
+    if (settings_.fpsCap <= 0.0) {
+        return;
+    }
+    const auto period = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(1.0 / settings_.fpsCap));
+
+    nextDeadline_ += period;
+    Clock::time_point now = Clock::now();
+    if (nextDeadline_ < now) {
+        // We're late (slow frame or first call): restart the schedule from now instead of
+        // trying to "catch up" with a burst of uncapped frames.
+        nextDeadline_ = now;
+        return;
+    }
+
+    // Coarse sleep, then spin for the last stretch.
+    if (nextDeadline_ - now > kSpinMargin) {
+        std::this_thread::sleep_for(nextDeadline_ - now - kSpinMargin);
+    }
+    while (Clock::now() < nextDeadline_) {
+        std::this_thread::yield();
+    }
+}
+
+const char* FramePacer::name(VsyncMode mode) {
+    switch (mode) {
+        case VsyncMode::Off:      return "off";
+        case VsyncMode::On:       return "on";
+        case VsyncMode::Adaptive: return "adaptive";
+    }
+    return "?";
+}
+
+bool FramePacer::parse(const char* text, VsyncMode& out) {
+    if (std::strcmp(text, "off") == 0)      { out = VsyncMode::Off; return true; }
+    if (std::strcmp(text, "on") == 0)       { out = VsyncMode::On; return true; }
+    if (std::strcmp(text, "adaptive") == 0) { out = VsyncMode::Adaptive; return true; }
+    return false;
+}
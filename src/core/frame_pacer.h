@@ -0,0 +1,64 @@
+#pragma once
+
+#include <GLFW/glfw3.h>
+#include <chrono>
+
+// VsyncMode
+// ---------
+// | Mode     | glfwSwapInterval | Behaviour                                                |
+// | -------- | ---------------- | -------------------------------------------------------- |
+// | Off      | 0                | Present immediately: lowest latency, tearing, max power  |
+// | On       | 1                | Wait for vblank: no tearing, +latency                    |
+// | Adaptive | -1               | Vsync when on time, tear instead of stalling when late   |
+//
+// Adaptive needs WGL/GLX_EXT_swap_control_tear; without it On is used.
+enum class VsyncMode { Off, On, Adaptive };
+
+// FramePacer
+// ----------
+// Owns the swap interval and an optional frame-rate cap.
+//
+// The cap waits with a coarse sleep until ~kSpinMargin before the deadline and then
+// spins for the rest: OS sleeps overshoot by 0.1–2 ms, which is too imprecise on its
+// own for e.g. a 240 fps cap (4.17 ms frames).
+//
+// Low-latency mode changes WHERE the wait happens in the loop:
+//
+//     normal:       poll → simulate → render → swap → [wait]
+//     low-latency:  [wait] → poll → simulate → render → swap
+//
+// In low-latency mode input is sampled right before it's used, instead of a whole
+// frame earlier, so the cap's idle time no longer adds to input latency.
+class FramePacer {
+public:
+    struct Settings {
+        VsyncMode vsync = VsyncMode::On;
+        double fpsCap = 0.0;       // 0 = uncapped
+        bool lowLatency = false;
+    };
+
+    // Applies the swap interval; the window's context must be current.
+    void init(const Settings& settings);
+    void setVsync(VsyncMode mode);
+    void setFpsCap(double fps) { settings_.fpsCap = fps; }
+
+    // Call once per frame at the position given by lowLatency() (see above).
+    // Blocks until the next frame deadline if a cap is set.
+    void waitForNextFrame();
+
+    bool lowLatency() const { return settings_.lowLatency; }
+    const Settings& settings() const { return settings_; }
+    VsyncMode effectiveVsync() const { return effectiveVsync_; }
+
+    static const char* name(VsyncMode mode);
+    // Parses "off" / "on" / "adaptive"; returns false on anything else.
+    static bool parse(const char* text, VsyncMode& out);
+
+private:
+    using Clock = std::chrono::steady_clock;
+    static constexpr std::chrono::microseconds kSpinMargin{1500};
+
+    Settings settings_;
+    VsyncMode effectiveVsync_ = VsyncMode::On;
+    Clock::time_point nextDeadline_{};
+};
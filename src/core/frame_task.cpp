@@ -0,0 +1,180 @@
+#include "core/frame_task.h"
+
+#include <atomic>
+#include <exception>
+#include <new>
+
+#include "core/block_pool.h"
+
+namespace {
+
+// Coroutine frame sizes the pools serve; anything bigger goes to the heap.
+constexpr std::size_t kFrameClasses = 3;
+constexpr std::size_t kFrameBytes[kFrameClasses] = {256, 1024, 4096};
+constexpr std::size_t kFramesPerSlab[kFrameClasses] = {64, 32, 16};
+
+std::atomic<std::uint64_t> heapFrames{0};
+
+int frameClass(std::size_t size) {
+    for (std::size_t c = 0; c < kFrameClasses; ++c) {
+        if (size <= kFrameBytes[c]) {
+            return static_cast<int>(c);
+        }
+    }
+    return -1;
+}
+
+BlockPool& framePool(int c) {
+    static BlockPool pools[kFrameClasses];
+    static const bool ready = [] {
+        for (std::size_t k = 0; k < kFrameClasses; ++k) {
+            pools[k].init(kFrameBytes[k], alignof(std::max_align_t), kFramesPerSlab[k]);
+        }
+        return true;
+    }();
+    (void)ready;
+    return pools[c];
+}
+
+} // namespace
+
+void* FrameTask::promise_type::operator new(std::size_t size) {
+    const int c = frameClass(size);
+    if (c < 0) {
+        heapFrames.fetch_add(1, std::memory_order_relaxed);
+        return ::operator new(size);
+    }
+    void* frame = framePool(c).allocate();
+    if (frame == nullptr) {
+        throw std::bad_alloc();
+    }
+    return frame;
+}
+
+void FrameTask::promise_type::operator delete(void* frame, std::size_t size) {
+    const int c = frameClass(size);
+    if (c < 0) {
+        ::operator delete(frame);
+    } else {
+        framePool(c).deallocate(frame);
+    }
+}
+
+void FrameTask::promise_type::unhandled_exception() {
+    std::terminate();
+}
+
+FrameTask& FrameTask::operator=(FrameTask&& other) noexcept {
+    if (this != &other) {
+        if (handle_) {
+            handle_.destroy();
+        }
+        handle_ = other.handle_;
+        other.handle_ = nullptr;
+    }
+    return *this;
+}
+
+FrameTask::~FrameTask() {
+    if (handle_) {
+        handle_.destroy();     // never spawned
+    }
+}
+
+TaskScheduler::~TaskScheduler() {
+    for (Waiting& w : waiting_) {
+        if (w.kind == Waiting::Kind::Load) {
+            jobs_.wait(w.load->counter);   // the worker writes into the frame
+        }
+    }
+    for (Waiting& w : waiting_) {
+        w.task.destroy();
+    }
+}
+
+void TaskScheduler::spawn(FrameTask task) {
+    FrameTask::Handle handle = task.release();
+    if (!handle) {
+        return;
+    }
+    handle.promise().scheduler = this;
+    ++stats_.spawned;
+    ++stats_.active;
+    resume(handle);
+}
+
+void TaskScheduler::update(double dt) {
+    ++frame_;
+    time_ += dt;
+    ready_.clear();
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < waiting_.size(); ++i) {
+        const Waiting& w = waiting_[i];
+        bool over = false;
+        switch (w.kind) {
+            case Waiting::Kind::Frame: over = frame_ > w.frame; break;
+            case Waiting::Kind::Time:  over = time_ >= w.time; break;
+            case Waiting::Kind::Load:
+                jobs_.poll(w.load->counter);   // no workers: queued jobs only run in a wait()
+                over = w.load->counter.done();
+                break;
+        }
+        if (over) {
+            ready_.push_back(w.task);
+        } else {
+            waiting_[kept++] = w;
+        }
+    }
+    waiting_.resize(kept);
+    // Resumed tasks wait again by appending to waiting_, for a later update().
+    for (FrameTask::Handle task : ready_) {
+        resume(task);
+    }
+}
+
+TaskScheduler::Stats TaskScheduler::stats() const {
+    Stats stats = stats_;
+    stats.heapFrames = heapFrames.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void TaskScheduler::waitFrame(FrameTask::Handle task) {
+    Waiting w;
+    w.kind = Waiting::Kind::Frame;
+    w.task = task;
+    w.frame = frame_;
+    waiting_.push_back(w);
+}
+
+void TaskScheduler::waitUntil(FrameTask::Handle task, double time) {
+    Waiting w;
+    w.kind = Waiting::Kind::Time;
+    w.task = task;
+    w.time = time;
+    waiting_.push_back(w);
+}
+
+void TaskScheduler::waitLoad(FrameTask::Handle task, LoadRequest& request) {
+    ++stats_.loads;
+    jobs_.run(&TaskScheduler::loadJob, &request, 0, 1, &request.counter);
+    Waiting w;
+    w.kind = Waiting::Kind::Load;
+    w.task = task;
+    w.load = &request;
+    waiting_.push_back(w);
+}
+
+void TaskScheduler::loadJob(void* context, std::size_t, std::size_t) {
+    LoadRequest* request = static_cast<LoadRequest*>(context);
+    request->result.ok = vfs::read(request->path, request->result.data);
+}
+
+void TaskScheduler::resume(FrameTask::Handle task) {
+    ++stats_.resumes;
+    task.resume();
+    if (task.done()) {
+        task.destroy();
+        ++stats_.finished;
+        --stats_.active;
+    }
+}
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "core/job_system.h"
+#include "core/vfs.h"
+
+class TaskScheduler;
+
+// FrameTask
+// ---------
+// A C++20 coroutine that runs on the main thread across frames: what would otherwise be a
+// state machine (or a thread) written top to bottom, suspended at each co_await and
+// resumed by TaskScheduler::update() once what it waits for is there:
+//
+//     FrameTask fadeIn(Sprite* s) {
+//         vfs::Blob image = (co_await load("textures/logo.tga")).data;  // on a worker
+//         for (int i = 0; i < 30; ++i) { s->alpha = i / 30.0f; co_await nextFrame(); }
+//         co_await seconds(2.0);
+//     }
+//     tasks.spawn(fadeIn(&logo));
+//
+// | co_await        | Resumes                                                          |
+// | --------------- | ---------------------------------------------------------------- |
+// | nextFrame()     | at the next update()                                             |
+// | seconds(s)      | at the first update() at least s of the scheduler's time later   |
+// | load(path)      | at the first update() after a JobSystem worker read the file     |
+// |                 | (vfs::read: embedded, packs, disk); gives a LoadResult           |
+//
+// Those three are the only things a FrameTask may co_await. Its coroutine frame comes
+// from a few BlockPools by size (core/block_pool.h), not the heap: spawning, suspending
+// and finishing a task allocate nothing once the pools have grown. (Not the FrameArena:
+// a task outlives the frame it started in.) Frames over the largest block size fall back
+// to the heap and are counted.
+//
+// A task starts inside spawn(), up to its first co_await, and is destroyed when it
+// returns. Arguments are copied into the frame, but what a pointer or reference argument
+// points at must outlive the task (the scheduler destroys unfinished tasks with itself).
+// An exception escaping a task terminates the program.
+class FrameTask {
+public:
+    struct promise_type {
+        TaskScheduler* scheduler = nullptr;
+
+        static void* operator new(std::size_t size);
+        static void operator delete(void* frame, std::size_t size);
+
+        FrameTask get_return_object() {
+            return FrameTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception();
+    };
+    using Handle = std::coroutine_handle<promise_type>;
+
+    FrameTask(FrameTask&& other) noexcept : handle_(other.handle_) { other.handle_ = nullptr; }
+    FrameTask& operator=(FrameTask&& other) noexcept;
+    FrameTask(const FrameTask&) = delete;
+    FrameTask& operator=(const FrameTask&) = delete;
+    ~FrameTask();
+
+    // Ownership passes to the scheduler (spawn()).
+    Handle release() {
+        Handle h = handle_;
+        handle_ = nullptr;
+        return h;
+    }
+
+private:
+    explicit FrameTask(Handle handle) : handle_(handle) {}
+    Handle handle_;
+};
+
+struct LoadResult {
+    bool ok = false;               // false: found nowhere (or a corrupt pack entry)
+    vfs::Blob data;
+};
+
+// TaskScheduler
+// -------------
+// The FrameTasks of a frame loop. Every waiting task is one entry in a flat list that
+// update() sweeps once: a frame costs a compare per waiting task plus the resumes, and
+// nothing is allocated once the lists have grown.
+class TaskScheduler {
+public:
+    struct Stats {
+        std::uint64_t spawned = 0;
+        std::uint64_t finished = 0;
+        std::uint64_t resumes = 0;
+        std::uint64_t loads = 0;
+        std::uint64_t heapFrames = 0;  // coroutine frames too big for the pools
+        std::size_t active = 0;        // spawned and not finished
+    };
+
+    explicit TaskScheduler(JobSystem& jobs) : jobs_(jobs) {}
+    ~TaskScheduler();
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    void spawn(FrameTask task);
+
+    // Main thread, once per frame: `dt` seconds more on the scheduler's clock, then every
+    // task whose wait is over resumes (in the order it started waiting).
+    void update(double dt);
+
+    std::uint64_t frame() const { return frame_; }
+    double time() const { return time_; }
+    Stats stats() const;
+
+    // The awaitables' side; not for direct use.
+    struct LoadRequest {
+        std::string path;
+        LoadResult result;
+        JobCounter counter;
+    };
+    void waitFrame(FrameTask::Handle task);
+    void waitUntil(FrameTask::Handle task, double time);
+    void waitLoad(FrameTask::Handle task, LoadRequest& request);
+
+private:
+    struct Waiting {
+        enum class Kind { Frame, Time, Load } kind = Kind::Frame;
+        FrameTask::Handle task;
+        std::uint64_t frame = 0;       // Frame: resume once frame_ passes it
+        double time = 0.0;             // Time: resume once time_ reaches it
+        LoadRequest* load = nullptr;   // Load: resume once its job is done
+    };
+
+    static void loadJob(void* context, std::size_t, std::size_t);
+    void resume(FrameTask::Handle task);
+
+    JobSystem& jobs_;
+    std::uint64_t frame_ = 0;
+    double time_ = 0.0;
+    std::vector<Waiting> waiting_;
+    std::vector<FrameTask::Handle> ready_;
+    Stats stats_;
+};
+
+namespace task_detail {
+
+struct NextFrame {
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(FrameTask::Handle task) { task.promise().scheduler->waitFrame(task); }
+    void await_resume() const noexcept {}
+};
+
+struct Seconds {
+    double seconds;
+    bool await_ready() const noexcept { return seconds <= 0.0; }
+    void await_suspend(FrameTask::Handle task) {
+        TaskScheduler* scheduler = task.promise().scheduler;
+        scheduler->waitUntil(task, scheduler->time() + seconds);
+    }
+    void await_resume() const noexcept {}
+};
+
+// Lives in the suspended task's frame: the worker writes the result into it.
+struct Load {
+    TaskScheduler::LoadRequest request;
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(FrameTask::Handle task) { task.promise().scheduler->waitLoad(task, request); }
+    LoadResult await_resume() { return std::move(request.result); }
+};
+
+} // namespace task_detail
+
+inline task_detail::NextFrame nextFrame() { return {}; }
+inline task_detail::Seconds seconds(double s) { return task_detail::Seconds{s}; }
+inline task_detail::Load load(std::string path) {
+    return task_detail::Load{TaskScheduler::LoadRequest{std::move(path), {}, {}}};  // built in place
+}
@@ -0,0 +1,260 @@
+#include "core/job_system.h"
+
+#include <algorithm>
+#include <iostream>
+#include <system_error>
+
+#include "core/thread_affinity.h"
+#include "profile/sampling.h"
+#include "profile/trace.h"
+
+namespace {
+// Which JobSystem thread this is. Set for the thread that calls init() (index 0) and
+// for every worker; run()/wait() may only be called from these threads.
+struct ThreadIdentity {
+    const void* system = nullptr;
+    unsigned index = 0;
+};
+thread_local ThreadIdentity tlsIdentity;
+
+// AdaptiveGrain's ceiling: items whose data fills half of L2 (1 MiB assumed if unknown).
+std::size_t cacheGrain(const AdaptiveGrain& site) {
+    const std::size_t l2 = affinity::cacheBytes(2);
+    return std::max<std::size_t>(1, (l2 > 0 ? l2 : std::size_t{1} << 20) / 2 / std::max<std::size_t>(1, site.bytesPerItem));
+}
+} // namespace
+
+bool JobSystem::init(int workers) {
+    if (running_.load()) {
+        return true;
+    }
+    if (workers < 0) {
+        const unsigned hardware = std::thread::hardware_concurrency();
+        workers = hardware > 1 ? static_cast<int>(hardware) - 1 : 0;
+    }
+
+    data_.clear();
+    for (int i = 0; i <= workers; ++i) {
+        data_.push_back(std::make_unique<ThreadData>());
+        data_.back()->rng = 0x9e3779b9u * static_cast<std::uint32_t>(i + 1);
+    }
+    tlsIdentity = ThreadIdentity{this, 0};
+
+    running_.store(true);
+    try {
+        for (int i = 1; i <= workers; ++i) {
+            threads_.emplace_back(&JobSystem::workerMain, this, static_cast<unsigned>(i));
+        }
+    } catch (const std::system_error& e) {
+        // Fewer workers than asked for still works (down to none: wait() runs everything).
+        std::cerr << "JobSystem: could only start " << threads_.size() << " of " << workers
+                  << " workers (" << e.what() << ")\n";
+    }
+    return true;
+}
+
+void JobSystem::shutdown() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        workEpoch_.fetch_add(1);
+    }
+    wake_.notify_all();
+    for (std::thread& t : threads_) {
+        t.join();
+    }
+    threads_.clear();
+    data_.clear();
+    tlsIdentity = ThreadIdentity{};
+}
+
+unsigned JobSystem::threadIndex() const {
+    return tlsIdentity.system == this ? tlsIdentity.index : 0;
+}
+
+JobSystem::ThreadData& JobSystem::self() {
+    return *data_[tlsIdentity.system == this ? tlsIdentity.index : 0];
+}
+
+void JobSystem::run(JobFn fn, void* context, std::size_t begin, std::size_t end, JobCounter* counter) {
+    if (counter) {
+        counter->pending.fetch_add(1, std::memory_order_relaxed);
+    }
+    ThreadData& me = self();
+    Job* job = &me.jobs[me.nextJob & (kJobsPerThread - 1)];
+    if (job->busy.load(std::memory_order_acquire)) {
+        // The ring has come round to a job that hasn't started: don't overwrite it.
+        invoke(me, fn, context, begin, end, counter);
+        return;
+    }
+    ++me.nextJob;
+    job->fn = fn;
+    job->context = context;
+    job->begin = begin;
+    job->end = end;
+    job->counter = counter;
+    job->busy.store(true, std::memory_order_release);   // publishes the fields to execute()
+    if (!me.deque.push(job)) {
+        execute(me, job); // deque full: no point queueing, do it now
+        return;
+    }
+
+    // Wake a sleeper, if there is one. The fence orders the push before the sleeping_
+    // load; workerMain orders its sleeping_ increment before its last look at the deques.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping_.load(std::memory_order_relaxed) > 0) {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex_);
+            workEpoch_.fetch_add(1, std::memory_order_relaxed);
+        }
+        wake_.notify_one();
+    }
+}
+
+void JobSystem::execute(ThreadData& me, Job* job) {
+    job->busy.load(std::memory_order_acquire);          // always true here: the fields are run()'s
+    const JobFn fn = job->fn;
+    void* const context = job->context;
+    const std::size_t begin = job->begin;
+    const std::size_t end = job->end;
+    JobCounter* const counter = job->counter;
+    job->busy.store(false, std::memory_order_release);  // copied: its owner may reuse the slot
+    invoke(me, fn, context, begin, end, counter);
+}
+
+void JobSystem::invoke(ThreadData& me, JobFn fn, void* context, std::size_t begin, std::size_t end,
+                       JobCounter* counter) {
+    {
+        SAMPLING_ZONE("job");   // a sampling profiler's samples inside jobs, grouped
+        fn(context, begin, end);
+    }
+    me.executed.fetch_add(1, std::memory_order_relaxed);
+    if (counter) {
+        counter->pending.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+bool JobSystem::tryRunOne(ThreadData& me) {
+    Job* job = nullptr;
+    if (me.deque.pop(job)) {
+        execute(me, job);
+        return true;
+    }
+    // Own deque empty: steal, starting from a random victim so thieves spread out.
+    const std::size_t n = data_.size();
+    if (n < 2) {
+        return false;
+    }
+    me.rng = me.rng * 1664525u + 1013904223u;
+    const std::size_t start = (me.rng >> 8) % n;
+    for (std::size_t k = 0; k < n; ++k) {
+        ThreadData& victim = *data_[(start + k) % n];
+        if (&victim != &me && victim.deque.steal(job)) {
+            execute(me, job);
+            return true;
+        }
+    }
+    return false;
+}
+
+std::size_t JobSystem::beginAdaptive(AdaptiveGrain& site, std::size_t count) const {
+    if (site.fixed > 0) {
+        return site.fixed;
+    }
+    if (site.grain_ == 0) {
+        site.grain_ = cacheGrain(site);
+    }
+    // At least 4 jobs per thread, so every core gets some and stealing can even them out;
+    // at most a quarter of a thread's job ring.
+    const std::size_t jobs = 4 * static_cast<std::size_t>(threadCount());
+    const std::size_t balanced = std::max<std::size_t>(1, (count + jobs - 1) / jobs);
+    const std::size_t ring = kJobsPerThread / 4;
+    return std::max(std::min(site.grain_, balanced), (count + ring - 1) / ring);
+}
+
+void JobSystem::recordAdaptive(AdaptiveGrain& site, std::chrono::steady_clock::duration elapsed) {
+    const std::uint64_t ns =
+        static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    site.ns_.fetch_add(ns, std::memory_order_relaxed);
+    site.jobs_.fetch_add(1, std::memory_order_relaxed);
+    std::uint64_t slowest = site.slowestNs_.load(std::memory_order_relaxed);
+    while (ns > slowest && !site.slowestNs_.compare_exchange_weak(slowest, ns, std::memory_order_relaxed)) {
+    }
+}
+
+void JobSystem::endAdaptive(AdaptiveGrain& site, std::size_t grain) const {
+    // wait() has returned: every job's record is visible (their counter release, our acquire).
+    const std::uint64_t jobs = site.jobs_.exchange(0, std::memory_order_relaxed);
+    const std::uint64_t ns = site.ns_.exchange(0, std::memory_order_relaxed);
+    const std::uint64_t slowest = site.slowestNs_.exchange(0, std::memory_order_relaxed);
+    site.stats_.grain = grain;
+    site.stats_.jobs = jobs;
+    site.stats_.meanUs = jobs > 0 ? static_cast<double>(ns) / static_cast<double>(jobs) / 1000.0 : 0.0;
+    site.stats_.slowestUs = static_cast<double>(slowest) / 1000.0;
+    if (site.fixed > 0 || jobs == 0 || ns == 0) {
+        return;
+    }
+    // Per item, so a call whose jobs were capped for balance still says what a job of the
+    // adapted size would take.
+    const double usPerItem = site.stats_.meanUs / static_cast<double>(grain);
+    const double wanted = kTargetJobUs / usPerItem;
+    const double current = static_cast<double>(site.grain_);
+    std::size_t next = static_cast<std::size_t>(std::clamp(wanted, current * 0.5, current * 2.0));
+    if (jobs >= threadCount() && site.stats_.slowestUs > 4.0 * site.stats_.meanUs) {
+        next = std::min(next, site.grain_ / 2);
+    }
+    site.grain_ = std::clamp<std::size_t>(next, 1, cacheGrain(site));
+}
+
+void JobSystem::wait(JobCounter& counter) {
+    ThreadData& me = self();
+    while (!counter.done()) {
+        if (!tryRunOne(me)) {
+            // The remaining jobs are running on other threads: let them finish.
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::workerMain(unsigned index) {
+    tlsIdentity = ThreadIdentity{this, index};
+    trace::setThreadName("worker");
+    affinity::pinThisThread(affinity::Role::Workers);   // --affinity; a no-op without it
+    ThreadData& me = *data_[index];
+    while (running_.load(std::memory_order_acquire)) {
+        // Spin a little before sleeping: frames come in bursts of jobs.
+        bool ran = false;
+        for (int spin = 0; spin < 64 && !ran; ++spin) {
+            ran = tryRunOne(me);
+        }
+        if (ran) {
+            continue;
+        }
+
+        // Announce the sleep, THEN look once more. A run() that pushed after this last
+        // look sees sleeping_ > 0 and bumps the epoch, so the wait below can't miss it.
+        const std::uint64_t epoch = workEpoch_.load(std::memory_order_seq_cst);
+        sleeping_.fetch_add(1, std::memory_order_seq_cst);
+        if (tryRunOne(me)) {
+            sleeping_.fetch_sub(1, std::memory_order_seq_cst);
+            continue;
+        }
+        {
+            std::unique_lock<std::mutex> lock(sleepMutex_);
+            wake_.wait(lock, [&] {
+                return workEpoch_.load(std::memory_order_relaxed) != epoch || !running_.load();
+            });
+        }
+        sleeping_.fetch_sub(1, std::memory_order_seq_cst);
+    }
+}
+
+std::vector<std::uint64_t> JobSystem::executedPerThread() const {
+    std::vector<std::uint64_t> counts;
+    for (const std::unique_ptr<ThreadData>& d : data_) {
+        counts.push_back(d->executed.load(std::memory_order_relaxed));
+    }
+    return counts;
+}
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "core/work_stealing_deque.h"
+
+// JobCounter
+// ----------
+// Number of jobs in a group that haven't finished. run() increments it, the job's
+// completion decrements it, wait() returns when it reaches zero.
+struct JobCounter {
+    std::atomic<std::int32_t> pending{0};
+    bool done() const { return pending.load(std::memory_order_acquire) == 0; }
+};
+
+// AdaptiveGrain
+// -------------
+// One parallelFor call site's job size, for parallelFor(count, site, body). The first
+// call sizes jobs from the cache: as many items as fill half of L2 with `bytesPerItem`
+// (what one item reads and writes), so a job streams through its slice without evicting
+// it. Every call times its jobs, and the next one resizes them:
+//
+// | Last call's jobs               | Next call                                         |
+// | ------------------------------ | ------------------------------------------------- |
+// | mean under kTargetJobUs        | larger (up to 2x a call, never over the cache     |
+// |                                | size): the run/steal overhead was a visible share |
+// | mean over it                   | smaller (down to 1/2 a call)                      |
+// | slowest > 4x the mean          | halved: uneven items, more jobs to steal          |
+//
+// Whatever the size, a call makes at least 4 jobs per thread when the count allows, so
+// a small count still reaches every core. `fixed` > 0 is the override: that many items a
+// job, always (timings are still kept). One site, one calling thread at a time.
+struct AdaptiveGrain {
+    explicit AdaptiveGrain(std::size_t bytesPerItem, std::size_t fixed = 0) : bytesPerItem(bytesPerItem), fixed(fixed) {}
+
+    std::size_t bytesPerItem;
+    std::size_t fixed;
+
+    struct Stats {
+        std::size_t grain = 0;         // items per job, last call
+        std::uint64_t jobs = 0;
+        double meanUs = 0.0;
+        double slowestUs = 0.0;
+    };
+    const Stats& stats() const { return stats_; }
+
+private:
+    friend class JobSystem;
+    std::size_t grain_ = 0;            // the adapted size; 0: not sized yet
+    std::atomic<std::uint64_t> ns_{0};
+    std::atomic<std::uint64_t> jobs_{0};
+    std::atomic<std::uint64_t> slowestNs_{0};
+    Stats stats_;
+};
+
+// JobSystem
+// ---------
+// Work-stealing thread pool. Every thread (the main thread is thread 0, workers 1..N)
+// owns a WorkStealingDeque: jobs it creates go to the bottom of its own deque; idle
+// threads steal from the top of a random other one. Load balances itself—a thread that
+// finishes early takes work from the busiest—without a shared queue or lock.
+//
+// | Call                             | Does                                              |
+// | -------------------------------- | ------------------------------------------------- |
+// | run(fn, ctx, begin, end, &c)     | queue one job: fn(ctx, begin, end)                 |
+// | parallelFor(count, grain, f, c)  | queue ceil(count / grain) jobs f(begin, end)       |
+// | wait(c)                          | run queued jobs (own first, then steal) until c=0 |
+//
+// wait() never just blocks: the waiting thread executes jobs, and with 0 workers
+// everything still runs—on the caller, inside wait(). Waiting from inside a job (nested
+// parallelism) works, but whatever jobs the waiting thread picks up run on top of its
+// stack: one that blocks on something the waiter holds (a lock, a future) deadlocks,
+// and deep nesting grows the stack.
+//
+// Jobs are taken from the creating thread's ring of kJobsPerThread slots. A slot is
+// busy from run() until its job starts (on whichever thread): when the next one still
+// is—that many of the thread's jobs queued or being stolen at once—run() executes the
+// new job inline instead of queueing it. One frame of this game creates a few hundred.
+// Idle workers sleep on a condition variable; run() wakes one only if any are asleep.
+class JobSystem {
+public:
+    using JobFn = void (*)(void* context, std::size_t begin, std::size_t end);
+
+    static constexpr std::size_t kJobsPerThread = 4096;
+    static constexpr double kTargetJobUs = 20.0;   // AdaptiveGrain's aim: 20 us a job
+
+    JobSystem() = default;
+    ~JobSystem() { shutdown(); }
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // workers < 0: one per hardware thread, minus the calling (main) thread.
+    bool init(int workers = -1);
+    void shutdown();
+
+    unsigned workerCount() const { return static_cast<unsigned>(threads_.size()); }
+    unsigned threadCount() const { return workerCount() + 1; }  // workers + main
+    // The calling thread's index in [0, threadCount()): 0 for the thread that called init()
+    // (and for any thread this system doesn't know), 1..N for the workers.
+    unsigned threadIndex() const;
+
+    void run(JobFn fn, void* context, std::size_t begin, std::size_t end, JobCounter* counter);
+
+    // body(begin, end) over [0, count) in pieces of `grain`. `body` must stay alive until
+    // wait(counter) returns.
+    template <typename Body>
+    void parallelFor(std::size_t count, std::size_t grain, Body& body, JobCounter& counter) {
+        if (grain == 0) grain = 1;
+        for (std::size_t begin = 0; begin < count; begin += grain) {
+            const std::size_t end = begin + grain < count ? begin + grain : count;
+            run(&invokeRange<Body>, &body, begin, end, &counter);
+        }
+    }
+    // parallelFor + wait, for the common "split this loop across the cores" case.
+    template <typename Body>
+    void parallelFor(std::size_t count, std::size_t grain, Body&& body) {
+        JobCounter counter;
+        parallelFor(count, grain, body, counter);
+        wait(counter);
+    }
+    // Same, jobs sized by `site` (AdaptiveGrain above) and timed for its next call.
+    template <typename Body>
+    void parallelFor(std::size_t count, AdaptiveGrain& site, Body&& body) {
+        const std::size_t grain = beginAdaptive(site, count);
+        auto timed = [&site, &body](std::size_t begin, std::size_t end) {
+            const auto start = std::chrono::steady_clock::now();
+            body(begin, end);
+            recordAdaptive(site, std::chrono::steady_clock::now() - start);
+        };
+        JobCounter counter;
+        parallelFor(count, grain, timed, counter);
+        wait(counter);
+        endAdaptive(site, grain);
+    }
+
+    void wait(JobCounter& counter);
+    // For owners that check counter.done() once a frame instead of waiting: with 0 workers
+    // nothing but a wait() runs a queued job, so this is one; with workers it returns at
+    // once and the jobs finish in the background.
+    void poll(JobCounter& counter) {
+        if (threads_.empty()) wait(counter);
+    }
+
+    // Jobs executed by each thread since init() (index 0 = main), for profiling/balance.
+    std::vector<std::uint64_t> executedPerThread() const;
+
+private:
+    struct Job {
+        JobFn fn;
+        void* context;
+        std::size_t begin, end;
+        JobCounter* counter;
+        std::atomic<bool> busy{false};  // queued, not started: the slot can't be reused
+    };
+    struct alignas(64) ThreadData {
+        WorkStealingDeque<Job*, kJobsPerThread> deque;
+        Job jobs[kJobsPerThread];
+        std::size_t nextJob = 0;
+        std::atomic<std::uint64_t> executed{0};
+        std::uint32_t rng = 0;
+    };
+
+    template <typename Body>
+    static void invokeRange(void* context, std::size_t begin, std::size_t end) {
+        (*static_cast<Body*>(context))(begin, end);
+    }
+
+    std::size_t beginAdaptive(AdaptiveGrain& site, std::size_t count) const;
+    static void recordAdaptive(AdaptiveGrain& site, std::chrono::steady_clock::duration elapsed);
+    void endAdaptive(AdaptiveGrain& site, std::size_t grain) const;
+
+    ThreadData& self();
+    bool tryRunOne(ThreadData& me);
+    void execute(ThreadData& me, Job* job);
+    void invoke(ThreadData& me, JobFn fn, void* context, std::size_t begin, std::size_t end, JobCounter* counter);
+    void workerMain(unsigned index);
+
+    std::vector<std::unique_ptr<ThreadData>> data_;   // [0] = main thread
+    std::vector<std::thread> threads_;
+    std::atomic<bool> running_{false};
+
+    std::mutex sleepMutex_;
+    std::condition_variable wake_;
+    std::atomic<std::uint64_t> workEpoch_{0};        // bumped by every run()
+    std::atomic<int> sleeping_{0};
+};
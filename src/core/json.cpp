@@ -0,0 +1,165 @@
+#include "core/json.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+class JsonParser {
+public:
+    explicit JsonParser(const std::string& text) : text_(text) {}
+
+    bool parse(Json& out, std::string& error) {
+        if (!value(out, 0) || (skip(), pos_ != text_.size())) {
+            error = (error_.empty() ? std::string("trailing characters") : error_) + " at byte " + std::to_string(pos_);
+            return false;
+        }
+        return true;
+    }
+
+private:
+    static constexpr int kMaxDepth = 64;
+
+    void skip() {
+        while (pos_ < text_.size() &&
+               (text_[pos_] == ' ' || text_[pos_] == '\t' || text_[pos_] == '\r' || text_[pos_] == '\n')) {
+            ++pos_;
+        }
+    }
+    bool fail(const char* why) {
+        if (error_.empty()) error_ = why;
+        return false;
+    }
+    bool literal(const char* word) {
+        const std::size_t n = std::strlen(word);
+        if (text_.compare(pos_, n, word) != 0) return fail("bad literal");
+        pos_ += n;
+        return true;
+    }
+
+    bool value(Json& out, int depth) {
+        if (depth > kMaxDepth) return fail("nested too deeply");
+        skip();
+        if (pos_ >= text_.size()) return fail("unexpected end");
+        switch (text_[pos_]) {
+        case '{': return object(out, depth);
+        case '[': return array(out, depth);
+        case '"': out.type = Json::Type::String; return string(out.string);
+        case 't': out.type = Json::Type::Bool; out.boolean = true; return literal("true");
+        case 'f': out.type = Json::Type::Bool; out.boolean = false; return literal("false");
+        case 'n': out.type = Json::Type::Null; return literal("null");
+        default: break;
+        }
+        const char* begin = text_.c_str() + pos_;
+        char* end = nullptr;
+        out.type = Json::Type::Number;
+        out.number = std::strtod(begin, &end);
+        if (end == begin) return fail("unexpected character");
+        pos_ += static_cast<std::size_t>(end - begin);
+        return true;
+    }
+
+    bool object(Json& out, int depth) {
+        out.type = Json::Type::Object;
+        ++pos_;
+        skip();
+        if (pos_ < text_.size() && text_[pos_] == '}') return ++pos_, true;
+        for (;;) {
+            skip();
+            std::pair<std::string, Json> member;
+            if (pos_ >= text_.size() || text_[pos_] != '"' || !string(member.first)) return fail("expected a key");
+            skip();
+            if (pos_ >= text_.size() || text_[pos_++] != ':') return fail("expected ':'");
+            if (!value(member.second, depth + 1)) return false;
+            out.object.push_back(std::move(member));
+            skip();
+            if (pos_ < text_.size() && text_[pos_] == ',') { ++pos_; continue; }
+            if (pos_ < text_.size() && text_[pos_] == '}') return ++pos_, true;
+            return fail("expected ',' or '}'");
+        }
+    }
+
+    bool array(Json& out, int depth) {
+        out.type = Json::Type::Array;
+        ++pos_;
+        skip();
+        if (pos_ < text_.size() && text_[pos_] == ']') return ++pos_, true;
+        for (;;) {
+            out.array.emplace_back();
+            if (!value(out.array.back(), depth + 1)) return false;
+            skip();
+            if (pos_ < text_.size() && text_[pos_] == ',') { ++pos_; continue; }
+            if (pos_ < text_.size() && text_[pos_] == ']') return ++pos_, true;
+            return fail("expected ',' or ']'");
+        }
+    }
+
+    bool string(std::string& out) {
+        ++pos_;
+        while (pos_ < text_.size()) {
+            const char c = text_[pos_++];
+            if (c == '"') return true;
+            if (c != '\\') { out += c; continue; }
+            if (pos_ >= text_.size()) break;
+            const char e = text_[pos_++];
+            switch (e) {
+            case 'n': out += '\n'; break;
+            case 't': out += '\t'; break;
+            case 'r': out += '\r'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'u': {
+                if (pos_ + 4 > text_.size()) return fail("bad \\u escape");
+                const unsigned long code = std::strtoul(text_.substr(pos_, 4).c_str(), nullptr, 16);
+                pos_ += 4;
+                if (code < 0x80) {
+                    out += static_cast<char>(code);
+                } else if (code < 0x800) {
+                    out += static_cast<char>(0xc0 | code >> 6);
+                    out += static_cast<char>(0x80 | (code & 0x3f));
+                } else {
+                    out += static_cast<char>(0xe0 | code >> 12);
+                    out += static_cast<char>(0x80 | (code >> 6 & 0x3f));
+                    out += static_cast<char>(0x80 | (code & 0x3f));
+                }
+                break;
+            }
+            default: out += e; break;   // \" \\ \/
+            }
+        }
+        return fail("unterminated string");
+    }
+
+    const std::string& text_;
+    std::size_t pos_ = 0;
+    std::string error_;
+};
+
+} // namespace
+
+bool parseJson(const std::string& text, Json& out, std::string& error) {
+    return JsonParser(text).parse(out, error);
+}
+
+void appendJsonString(std::string& out, const std::string& value) {
+    out += '"';
+    for (const char c : value) {
+        switch (c) {
+        case '"':  out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\t': out += "\\t"; break;
+        case '\r': out += "\\r"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char escape[8];
+                std::snprintf(escape, sizeof(escape), "\\u%04x", static_cast<unsigned>(c));
+                out += escape;
+            } else {
+                out += c;
+            }
+        }
+    }
+    out += '"';
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+// Json
+// ----
+// Just enough JSON for the tools' inputs and outputs (Tiled maps, bench baselines): a
+// DOM, numbers as double, members in file order. Not for the frame loop: every value
+// owns its strings and vectors.
+struct Json {
+    enum class Type { Null, Bool, Number, String, Array, Object };
+    Type type = Type::Null;
+    bool boolean = false;
+    double number = 0.0;
+    std::string string;
+    std::vector<Json> array;
+    std::vector<std::pair<std::string, Json>> object;
+
+    const Json* find(const char* key) const {
+        for (const auto& member : object) {
+            if (member.first == key) return &member.second;
+        }
+        return nullptr;
+    }
+    double numberOr(const char* key, double fallback) const {
+        const Json* value = find(key);
+        return value && value->type == Type::Number ? value->number : fallback;
+    }
+    std::string stringOr(const char* key, const std::string& fallback) const {
+        const Json* value = find(key);
+        return value && value->type == Type::String ? value->string : fallback;
+    }
+    const std::vector<Json>& arrayOf(const char* key) const {
+        static const std::vector<Json> empty;
+        const Json* value = find(key);
+        return value && value->type == Type::Array ? value->array : empty;
+    }
+};
+
+// The whole of `text` as one value; false with `error` ("expected ':' at byte 12") if it
+// isn't JSON. Escapes: the usual ones; \uXXXX to UTF-8 (surrogate pairs are not joined).
+bool parseJson(const std::string& text, Json& out, std::string& error);
+
+// `value` as a JSON string literal (quotes and escapes added), appended to `out`.
+void appendJsonString(std::string& out, const std::string& value);
@@ -0,0 +1,302 @@
+#include "core/level_file.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <numeric>
+
+namespace {
+
+constexpr char kMagic[4] = {'L', 'V', 'L', '1'};
+constexpr std::uint32_t kMaxRegions = 1u << 20;
+
+std::size_t alignUp(std::size_t n) {
+    return (n + LevelFile::kAlignment - 1) & ~(LevelFile::kAlignment - 1);
+}
+
+// Where each array of a region block starts, from the block's start; the reader and the
+// writer share it, so they can't disagree.
+struct BlockLayout {
+    std::size_t x, y, rotation, scaleX, scaleY, color, asset, zLayer, tiles;
+    std::size_t size;
+};
+
+BlockLayout blockLayout(std::size_t entities, std::size_t tilesPerRegion, std::size_t tileLayers) {
+    BlockLayout layout;
+    std::size_t offset = 0;
+    auto take = [&offset](std::size_t bytes) {
+        const std::size_t at = offset;
+        offset = alignUp(offset + bytes);
+        return at;
+    };
+    layout.x = take(entities * sizeof(float));
+    layout.y = take(entities * sizeof(float));
+    layout.rotation = take(entities * sizeof(float));
+    layout.scaleX = take(entities * sizeof(float));
+    layout.scaleY = take(entities * sizeof(float));
+    layout.color = take(entities * sizeof(std::uint32_t));
+    layout.asset = take(entities * sizeof(std::uint32_t));
+    layout.zLayer = take(entities * sizeof(std::uint16_t));
+    layout.tiles = take(tileLayers * tilesPerRegion * tilesPerRegion * sizeof(std::uint16_t));
+    layout.size = offset;
+    return layout;
+}
+
+} // namespace
+
+std::uint32_t LevelFile::checksum(const unsigned char* bytes, std::size_t size) {
+    std::uint32_t hash = 0x811c9dc5u;
+    for (std::size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 0x01000193u;
+    }
+    return hash;
+}
+
+bool LevelFile::open(const std::string& path) {
+    close();
+    if (!file_.open(path)) {
+        std::cerr << "Level: cannot read " << path << "\n";
+        return false;
+    }
+    path_ = path;
+    const unsigned char* base = file_.data();
+    const std::size_t size = file_.size();
+    auto fail = [&](const char* why) {
+        std::cerr << "Level: " << path << ": " << why << "\n";
+        close();
+        return false;
+    };
+
+    if (size < sizeof(LevelHeader)) {
+        return fail("too short");
+    }
+    const LevelHeader* header = reinterpret_cast<const LevelHeader*>(base);
+    if (std::memcmp(header->magic, kMagic, 4) != 0 || header->version != kVersion) {
+        std::cerr << "Level: " << path << " is not a version " << kVersion << " level\n";
+        close();
+        return false;
+    }
+    if (header->fileSize != size) {
+        return fail("truncated (or its header is damaged)");
+    }
+    const std::uint64_t regions = std::uint64_t(header->regionsX) * header->regionsY;
+    if (regions == 0 || regions > kMaxRegions || !(header->regionSize > 0.0f) ||
+        header->tileLayers > 16 || header->tilesPerRegion > 1024) {
+        return fail("bad region grid");
+    }
+    const std::uint64_t tableBytes = regions * sizeof(LevelRegion);
+    const std::uint64_t assetBytes = std::uint64_t(header->assetCount) * sizeof(LevelAsset);
+    if (header->regionTableOffset % kAlignment != 0 || header->regionTableOffset > size ||
+        tableBytes > size - header->regionTableOffset || header->assetTableOffset % kAlignment != 0 ||
+        header->assetTableOffset > size || assetBytes > size - header->assetTableOffset) {
+        return fail("tables out of bounds");
+    }
+    regions_ = reinterpret_cast<const LevelRegion*>(base + header->regionTableOffset);
+    assets_ = reinterpret_cast<const LevelAsset*>(base + header->assetTableOffset);
+    names_ = reinterpret_cast<const char*>(base + header->assetTableOffset + assetBytes);
+    namesSize_ = size - static_cast<std::size_t>(header->assetTableOffset + assetBytes);
+
+    for (std::uint32_t a = 0; a < header->assetCount; ++a) {
+        if (std::uint64_t(assets_[a].nameOffset) + assets_[a].nameLength > namesSize_) {
+            return fail("damaged asset table");
+        }
+    }
+    for (std::uint64_t r = 0; r < regions; ++r) {
+        const LevelRegion& region = regions_[r];
+        const BlockLayout layout = blockLayout(region.entityCount, header->tilesPerRegion, header->tileLayers);
+        if (region.offset % kAlignment != 0 || region.offset > size || region.size > size - region.offset ||
+            region.size != layout.size) {
+            std::cerr << "Level: " << path << " has a damaged region table (region " << r << ")\n";
+            close();
+            return false;
+        }
+    }
+    header_ = header;
+    return true;
+}
+
+Aabb LevelFile::bounds() const {
+    const glm::vec2 origin(header_->originX, header_->originY);
+    return Aabb{origin, origin + header_->regionSize * glm::vec2(regionsX(), regionsY())};
+}
+
+Aabb LevelFile::regionBounds(int index) const {
+    const glm::vec2 origin(header_->originX, header_->originY);
+    const glm::vec2 min = origin + header_->regionSize * glm::vec2(index % regionsX(), index / regionsX());
+    return Aabb{min, min + glm::vec2(header_->regionSize)};
+}
+
+LevelEntities LevelFile::entities(int index) const {
+    const LevelRegion& region = regions_[index];
+    const BlockLayout layout = blockLayout(region.entityCount, header_->tilesPerRegion, header_->tileLayers);
+    const unsigned char* block = file_.data() + region.offset;
+    LevelEntities e;
+    e.count = region.entityCount;
+    e.x = reinterpret_cast<const float*>(block + layout.x);
+    e.y = reinterpret_cast<const float*>(block + layout.y);
+    e.rotation = reinterpret_cast<const float*>(block + layout.rotation);
+    e.scaleX = reinterpret_cast<const float*>(block + layout.scaleX);
+    e.scaleY = reinterpret_cast<const float*>(block + layout.scaleY);
+    e.color = reinterpret_cast<const std::uint32_t*>(block + layout.color);
+    e.asset = reinterpret_cast<const std::uint32_t*>(block + layout.asset);
+    e.zLayer = reinterpret_cast<const std::uint16_t*>(block + layout.zLayer);
+    return e;
+}
+
+const std::uint16_t* LevelFile::tiles(int index, int layer) const {
+    if (header_->tilesPerRegion == 0 || layer < 0 || layer >= header_->tileLayers) {
+        return nullptr;
+    }
+    const LevelRegion& region = regions_[index];
+    const BlockLayout layout = blockLayout(region.entityCount, header_->tilesPerRegion, header_->tileLayers);
+    const std::size_t perLayer = std::size_t(header_->tilesPerRegion) * header_->tilesPerRegion;
+    return reinterpret_cast<const std::uint16_t*>(file_.data() + region.offset + layout.tiles) + layer * perLayer;
+}
+
+std::string LevelFile::assetName(std::size_t asset) const {
+    if (asset >= header_->assetCount) {
+        return std::string();
+    }
+    return std::string(names_ + assets_[asset].nameOffset, assets_[asset].nameLength);
+}
+
+bool LevelFile::verify(int index) const {
+    const LevelRegion& region = regions_[index];
+    return checksum(file_.data() + region.offset, static_cast<std::size_t>(region.size)) == region.checksum;
+}
+
+void LevelFile::prefetch(int index) const {
+    const LevelRegion& region = regions_[index];
+    file_.willNeed(static_cast<std::size_t>(region.offset), static_cast<std::size_t>(region.size));
+}
+
+LevelWriter::LevelWriter(int regionsX, int regionsY, float regionSize, glm::vec2 origin, int tilesPerRegion,
+                         int tileLayers)
+    : regionsX_(regionsX), regionsY_(regionsY), regionSize_(regionSize), origin_(origin),
+      tilesPerRegion_(tilesPerRegion), tileLayers_(tilesPerRegion > 0 ? tileLayers : 0),
+      regions_(static_cast<std::size_t>(regionsX) * regionsY) {
+    for (Region& region : regions_) {
+        region.tiles.assign(static_cast<std::size_t>(tileLayers_) * tilesPerRegion_ * tilesPerRegion_, 0);
+    }
+}
+
+std::uint32_t LevelWriter::asset(const std::string& name) {
+    const auto it = std::find(assets_.begin(), assets_.end(), name);
+    if (it != assets_.end()) {
+        return static_cast<std::uint32_t>(it - assets_.begin());
+    }
+    assets_.push_back(name);
+    return static_cast<std::uint32_t>(assets_.size() - 1);
+}
+
+void LevelWriter::add(const Entity& entity) {
+    const glm::vec2 cell = (entity.position - origin_) / regionSize_;
+    const int x = std::clamp(static_cast<int>(std::floor(cell.x)), 0, regionsX_ - 1);
+    const int y = std::clamp(static_cast<int>(std::floor(cell.y)), 0, regionsY_ - 1);
+    regions_[static_cast<std::size_t>(y) * regionsX_ + x].entities.push_back(entity);
+}
+
+void LevelWriter::setTile(int layer, int x, int y, std::uint16_t tile) {
+    const int t = tilesPerRegion_;
+    if (t == 0 || layer < 0 || layer >= tileLayers_ || x < 0 || y < 0 || x >= regionsX_ * t || y >= regionsY_ * t) {
+        return;
+    }
+    Region& region = regions_[static_cast<std::size_t>(y / t) * regionsX_ + x / t];
+    region.tiles[(static_cast<std::size_t>(layer) * t + y % t) * t + x % t] = tile;
+}
+
+bool LevelWriter::write(const std::string& path, std::string* error) const {
+    auto fail = [&](const std::string& why) {
+        if (error) *error = why;
+        return false;
+    };
+    // Header, tables and names first; then every block, each aligned.
+    std::vector<unsigned char> out(sizeof(LevelHeader));
+    auto pad = [&out] { out.resize(alignUp(out.size()), 0); };
+
+    pad();
+    const std::size_t regionTable = out.size();
+    out.resize(out.size() + regions_.size() * sizeof(LevelRegion));
+    pad();
+    const std::size_t assetTable = out.size();
+    out.resize(out.size() + assets_.size() * sizeof(LevelAsset));
+    std::uint32_t nameOffset = 0;
+    for (std::size_t a = 0; a < assets_.size(); ++a) {
+        const LevelAsset asset{nameOffset, static_cast<std::uint32_t>(assets_[a].size())};
+        std::memcpy(out.data() + assetTable + a * sizeof(LevelAsset), &asset, sizeof(asset));
+        nameOffset += asset.nameLength;
+    }
+    for (const std::string& name : assets_) {
+        out.insert(out.end(), name.begin(), name.end());
+    }
+
+    std::vector<std::uint32_t> order;
+    for (std::size_t r = 0; r < regions_.size(); ++r) {
+        const Region& region = regions_[r];
+        const std::size_t n = region.entities.size();
+        if (n > 0xffffffffu) {
+            return fail("too many entities in one region");
+        }
+        pad();
+        const std::size_t block = out.size();
+        const BlockLayout layout = blockLayout(n, static_cast<std::size_t>(tilesPerRegion_),
+                                               static_cast<std::size_t>(tileLayers_));
+        out.resize(block + layout.size, 0);
+        unsigned char* base = out.data() + block;
+        // Stored in draw order, (zLayer, asset): spawned front to back of the arrays, the
+        // region's entities arrive in the World already grouped the way batches want them.
+        order.resize(n);
+        std::iota(order.begin(), order.end(), 0u);
+        std::stable_sort(order.begin(), order.end(), [&region](std::uint32_t a, std::uint32_t b) {
+            const Entity& ea = region.entities[a];
+            const Entity& eb = region.entities[b];
+            return ea.zLayer != eb.zLayer ? ea.zLayer < eb.zLayer : ea.asset < eb.asset;
+        });
+        for (std::size_t i = 0; i < n; ++i) {
+            const Entity& e = region.entities[order[i]];
+            std::memcpy(base + layout.x + i * sizeof(float), &e.position.x, sizeof(float));
+            std::memcpy(base + layout.y + i * sizeof(float), &e.position.y, sizeof(float));
+            std::memcpy(base + layout.rotation + i * sizeof(float), &e.rotation, sizeof(float));
+            std::memcpy(base + layout.scaleX + i * sizeof(float), &e.scale.x, sizeof(float));
+            std::memcpy(base + layout.scaleY + i * sizeof(float), &e.scale.y, sizeof(float));
+            std::memcpy(base + layout.color + i * sizeof(std::uint32_t), &e.color, sizeof(std::uint32_t));
+            std::memcpy(base + layout.asset + i * sizeof(std::uint32_t), &e.asset, sizeof(std::uint32_t));
+            std::memcpy(base + layout.zLayer + i * sizeof(std::uint16_t), &e.zLayer, sizeof(std::uint16_t));
+        }
+        if (!region.tiles.empty()) {
+            std::memcpy(base + layout.tiles, region.tiles.data(), region.tiles.size() * sizeof(std::uint16_t));
+        }
+        const LevelRegion entry{block, layout.size, static_cast<std::uint32_t>(n),
+                                LevelFile::checksum(base, layout.size)};
+        std::memcpy(out.data() + regionTable + r * sizeof(LevelRegion), &entry, sizeof(entry));
+    }
+
+    LevelHeader header{};
+    std::memcpy(header.magic, kMagic, 4);
+    header.version = LevelFile::kVersion;
+    header.regionsX = static_cast<std::uint32_t>(regionsX_);
+    header.regionsY = static_cast<std::uint32_t>(regionsY_);
+    header.regionSize = regionSize_;
+    header.originX = origin_.x;
+    header.originY = origin_.y;
+    header.tilesPerRegion = static_cast<std::uint16_t>(tilesPerRegion_);
+    header.tileLayers = static_cast<std::uint16_t>(tileLayers_);
+    header.assetCount = static_cast<std::uint32_t>(assets_.size());
+    header.regionTableOffset = regionTable;
+    header.assetTableOffset = assetTable;
+    header.fileSize = out.size();
+    std::memcpy(out.data(), &header, sizeof(header));
+
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return fail("cannot create " + path);
+    }
+    const bool written = std::fwrite(out.data(), 1, out.size(), file) == out.size();
+    if (std::fclose(file) != 0 || !written) {
+        return fail("cannot write " + path);
+    }
+    return true;
+}
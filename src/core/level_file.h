@@ -0,0 +1,187 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "core/mapped_file.h"
+#include "core/spatial_index.h"
+
+// Level file
+// ----------
+// A world cut into a grid of square REGIONS, stored the way the game uses it: the file is
+// memory-mapped and every array is read where it lies. Opening one checks the header and
+// the tables; there is no parsing, no per-entity allocation, and a region nobody goes
+// near is never even paged in.
+//
+//     | header (64 B) | region table | asset table | asset names | region blocks ... |
+//
+// | Part         | Contents                                                            |
+// | ------------ | ------------------------------------------------------------------- |
+// | header       | "LVL1", version, region grid (count, size, origin), tiles per       |
+// |              | region side and tile layers, table offsets, the file's own size     |
+// | region table | LevelRegion per region, row by row from the lower-left: where its   |
+// |              | block is, how many entities, a checksum of the block                |
+// | asset table  | LevelAsset per asset: a name ("shape/12") the game resolves once    |
+// | region block | the region's entities as arrays (SoA), then its tile layers         |
+//
+// A region block, every array starting at a multiple of kAlignment:
+//
+//     x[n] y[n] rotation[n] scaleX[n] scaleY[n]   float, world space
+//     color[n]                                    0xAABBGGRR, as Color
+//     asset[n]                                    index into the asset table
+//     zLayer[n]                                   uint16, as ZLayer
+//     tiles[layers][T * T]                        uint16: asset index + 1, 0 = empty;
+//                                                 row by row from the lower-left
+//
+// Entities are stored sorted by (zLayer, asset), the order the sprite batches group them.
+//
+// The entity arrays are exactly the columns of a Transforms2D (core/batch_transform.h),
+// so a region can be culled or composed straight from the mapping too.
+//
+// Versioned: a reader refuses other versions rather than guessing. Everything is
+// little-endian (hosts are assumed to be, like pack files' and ProgramCache's).
+struct LevelHeader {
+    char magic[4];                     // "LVL1"
+    std::uint32_t version;
+    std::uint32_t regionsX, regionsY;
+    float regionSize;                  // world units per region side
+    float originX, originY;            // region (0, 0)'s lower-left corner
+    std::uint16_t tilesPerRegion;      // tiles per region side; 0: no tiles
+    std::uint16_t tileLayers;
+    std::uint32_t assetCount;
+    std::uint32_t reserved;
+    std::uint64_t regionTableOffset;
+    std::uint64_t assetTableOffset;
+    std::uint64_t fileSize;            // a truncated file is caught at open()
+};
+static_assert(sizeof(LevelHeader) == 64, "level header layout");
+
+struct LevelRegion {
+    std::uint64_t offset;              // of its block, from the start of the file
+    std::uint64_t size;                // bytes in the block
+    std::uint32_t entityCount;
+    std::uint32_t checksum;            // FNV-1a of the block's bytes
+};
+static_assert(sizeof(LevelRegion) == 24, "level region layout");
+
+struct LevelAsset {
+    std::uint32_t nameOffset;          // from the asset table's names
+    std::uint32_t nameLength;
+};
+
+// One region's entities, pointing into the mapping.
+struct LevelEntities {
+    std::size_t count = 0;
+    const float* x = nullptr;
+    const float* y = nullptr;
+    const float* rotation = nullptr;
+    const float* scaleX = nullptr;
+    const float* scaleY = nullptr;
+    const std::uint32_t* color = nullptr;
+    const std::uint32_t* asset = nullptr;
+    const std::uint16_t* zLayer = nullptr;
+};
+
+// LevelFile
+// ---------
+// Reader. Every pointer it hands out is into the mapping, valid until close().
+//
+// The region table and the asset table are checked at open() (bounds, alignment,
+// sizes that match the entity counts); region blocks are not read at all until asked
+// for. verify() is the checksum, which also pages the whole block in: LevelStreamer
+// (core/level_streamer.h) runs it on a worker so the main thread then touches warm pages.
+class LevelFile {
+public:
+    static constexpr std::uint32_t kVersion = 1;
+    static constexpr std::size_t kAlignment = 16;
+
+    LevelFile() = default;
+    LevelFile(const LevelFile&) = delete;
+    LevelFile& operator=(const LevelFile&) = delete;
+
+    // false (and why, on stderr) if it isn't a valid level of this version.
+    bool open(const std::string& path);
+    void close() { file_.close(); header_ = nullptr; }
+    bool isOpen() const { return header_ != nullptr; }
+
+    const LevelHeader& header() const { return *header_; }
+    int regionsX() const { return static_cast<int>(header_->regionsX); }
+    int regionsY() const { return static_cast<int>(header_->regionsY); }
+    std::size_t regionCount() const { return std::size_t(header_->regionsX) * header_->regionsY; }
+    int regionIndex(int x, int y) const { return y * regionsX() + x; }
+    // The whole world, and one region's part of it.
+    Aabb bounds() const;
+    Aabb regionBounds(int index) const;
+    // Tiles per side of the whole world (regions * tiles per region).
+    int tilesX() const { return regionsX() * header_->tilesPerRegion; }
+    int tilesY() const { return regionsY() * header_->tilesPerRegion; }
+
+    const LevelRegion& region(int index) const { return regions_[index]; }
+    LevelEntities entities(int index) const;
+    // tilesPerRegion² values of one layer (nullptr without tiles).
+    const std::uint16_t* tiles(int index, int layer) const;
+
+    std::size_t assetCount() const { return header_->assetCount; }
+    std::string assetName(std::size_t asset) const;
+
+    // Reads the whole block (checksum): true if it is intact.
+    bool verify(int index) const;
+    // MappedFile::willNeed on the region's block.
+    void prefetch(int index) const;
+
+    const std::string& path() const { return path_; }
+
+    static std::uint32_t checksum(const unsigned char* bytes, std::size_t size);
+
+private:
+    MappedFile file_;
+    std::string path_;
+    const LevelHeader* header_ = nullptr;
+    const LevelRegion* regions_ = nullptr;
+    const LevelAsset* assets_ = nullptr;
+    const char* names_ = nullptr;
+    std::size_t namesSize_ = 0;
+};
+
+// LevelWriter
+// -----------
+// Builds a level in memory (tools/level_tool.cpp). Entities go to the region their
+// position falls in, clamped to the grid.
+class LevelWriter {
+public:
+    struct Entity {
+        glm::vec2 position{0.0f};
+        float rotation = 0.0f;
+        glm::vec2 scale{1.0f};
+        std::uint32_t color = 0xffffffffu;
+        std::uint32_t asset = 0;
+        std::uint16_t zLayer = 0;
+    };
+
+    LevelWriter(int regionsX, int regionsY, float regionSize, glm::vec2 origin, int tilesPerRegion,
+                int tileLayers);
+
+    // The asset's index (added on first use).
+    std::uint32_t asset(const std::string& name);
+    void add(const Entity& entity);
+    // World tile (x, y) of `layer`: asset + 1, or 0 for none. Out of range: ignored.
+    void setTile(int layer, int x, int y, std::uint16_t tile);
+
+    bool write(const std::string& path, std::string* error = nullptr) const;
+
+private:
+    struct Region {
+        std::vector<Entity> entities;
+        std::vector<std::uint16_t> tiles;   // layers * T * T
+    };
+
+    int regionsX_, regionsY_;
+    float regionSize_;
+    glm::vec2 origin_;
+    int tilesPerRegion_, tileLayers_;
+    std::vector<Region> regions_;
+    std::vector<std::string> assets_;
+};
@@ -0,0 +1,101 @@
+#include "core/level_streamer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "core/log.h"
+
+namespace {
+
+float distanceTo(const Aabb& box, const glm::vec2& point) {
+    const glm::vec2 outside = glm::max(glm::max(box.min - point, point - box.max), glm::vec2(0.0f));
+    return glm::length(outside);
+}
+
+} // namespace
+
+LevelStreamer::LevelStreamer(const LevelFile& level, JobSystem& jobs, const Settings& settings)
+    : level_(level), jobs_(jobs), settings_(settings),
+      states_(new std::atomic<State>[level.regionCount()]) {
+    settings_.unloadRadius = std::max(settings_.unloadRadius, settings_.loadRadius);
+    for (std::size_t r = 0; r < level.regionCount(); ++r) {
+        states_[r].store(State::Unloaded, std::memory_order_relaxed);
+    }
+}
+
+LevelStreamer::~LevelStreamer() {
+    jobs_.wait(pending_);   // they write states_
+}
+
+void LevelStreamer::loadJob(void* context, std::size_t begin, std::size_t end) {
+    LevelStreamer& self = *static_cast<LevelStreamer*>(context);
+    for (std::size_t r = begin; r < end; ++r) {
+        const int region = static_cast<int>(r);
+        self.level_.prefetch(region);
+        const bool intact = self.level_.verify(region);   // reads every byte: pages are in
+        self.states_[r].store(intact ? State::Ready : State::Failed, std::memory_order_release);
+    }
+}
+
+void LevelStreamer::update(const glm::vec2& focus, std::vector<int>& spawn, std::vector<int>& despawn) {
+    // Queue every unloaded region in reach: only the grid cells under focus ± loadRadius.
+    const LevelHeader& header = level_.header();
+    const glm::vec2 origin(header.originX, header.originY);
+    const glm::vec2 lo = (focus - settings_.loadRadius - origin) / header.regionSize;
+    const glm::vec2 hi = (focus + settings_.loadRadius - origin) / header.regionSize;
+    const int x0 = std::max(0, static_cast<int>(std::floor(lo.x)));
+    const int y0 = std::max(0, static_cast<int>(std::floor(lo.y)));
+    const int x1 = std::min(level_.regionsX() - 1, static_cast<int>(std::floor(hi.x)));
+    const int y1 = std::min(level_.regionsY() - 1, static_cast<int>(std::floor(hi.y)));
+    for (int y = y0; y <= y1; ++y) {
+        for (int x = x0; x <= x1; ++x) {
+            const int region = level_.regionIndex(x, y);
+            if (states_[region].load(std::memory_order_acquire) == State::Unloaded &&
+                distanceTo(level_.regionBounds(region), focus) <= settings_.loadRadius) {
+                states_[region].store(State::Loading, std::memory_order_relaxed);
+                jobs_.run(&LevelStreamer::loadJob, this, static_cast<std::size_t>(region),
+                          static_cast<std::size_t>(region) + 1, &pending_);
+                active_.push_back(region);
+                ++stats_.loads;
+            }
+        }
+    }
+    jobs_.poll(pending_);   // --jobs=0: the loads run here, or never
+
+    // Everything in flight or in the game: hand out, drop, or leave alone.
+    std::size_t budget = settings_.spawnBudget;
+    stats_.live = 0;
+    stats_.loading = 0;
+    for (std::size_t i = 0; i < active_.size();) {
+        const int region = active_[i];
+        const State state = states_[region].load(std::memory_order_acquire);
+        const bool inReach = distanceTo(level_.regionBounds(region), focus) <= settings_.unloadRadius;
+        bool keep = true;
+        if (state == State::Failed) {
+            logging::warn("Level: region %d of %s is damaged (checksum), skipped", region, level_.path().c_str());
+            ++stats_.failed;
+            keep = false;
+        } else if (!inReach && (state == State::Ready || state == State::Live)) {
+            if (state == State::Live) {
+                despawn.push_back(region);
+                ++stats_.despawned;
+            }
+            states_[region].store(State::Unloaded, std::memory_order_relaxed);
+            keep = false;
+        } else if (state == State::Ready && budget > 0) {
+            --budget;
+            states_[region].store(State::Live, std::memory_order_relaxed);
+            spawn.push_back(region);
+            ++stats_.spawned;
+        }
+        if (keep) {
+            const State now = states_[region].load(std::memory_order_relaxed);
+            stats_.live += now == State::Live;
+            stats_.loading += now == State::Loading || now == State::Ready;
+            ++i;
+        } else {
+            active_[i] = active_.back();
+            active_.pop_back();
+        }
+    }
+}
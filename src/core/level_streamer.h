@@ -0,0 +1,80 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "core/job_system.h"
+#include "core/level_file.h"
+
+// LevelStreamer
+// -------------
+// Which regions of a LevelFile (core/level_file.h) are in the game, around a focus point
+// (the camera). Each region moves through:
+//
+//     Unloaded ──in loadRadius──▶ Loading ──job: prefetch + checksum──▶ Ready
+//     Ready ──update() hands it out (spawnBudget per call)──▶ Live
+//     Live / Ready ──outside unloadRadius──▶ Unloaded (Live ones handed out to despawn)
+//     Loading ──checksum failed──▶ Failed (reported once, never retried)
+//
+// | Thread        | Does                                                              |
+// | ------------- | ----------------------------------------------------------------- |
+// | main, update  | distance tests over the region grid, queues load jobs, hands out  |
+// |               | Ready regions to spawn and Live ones to despawn                   |
+// | worker (job)  | madvise WILLNEED on the block, then the checksum: every page is   |
+// |               | faulted in here, not in the frame that spawns the region          |
+//
+// The caller does the spawning: the World is main's. Reading a Ready region's arrays is
+// then reading warm memory. Distances are from the focus to the region's rectangle, and
+// unloadRadius > loadRadius keeps a camera wobbling on a border from reloading a region
+// every frame.
+//
+// A region's state is an atomic: the job's release store publishes "its pages are in",
+// update()'s acquire load sees it. Load jobs stay queued across frames (the main thread
+// never waits on them, unless there are no workers to run them: JobSystem::poll), and
+// the destructor waits for whichever are still running.
+class LevelStreamer {
+public:
+    enum class State : std::uint8_t { Unloaded, Loading, Ready, Live, Failed };
+
+    struct Settings {
+        float loadRadius = 2.0f;       // world units beyond the focus
+        float unloadRadius = 3.0f;
+        std::size_t spawnBudget = 4;   // regions handed out to spawn per update()
+    };
+
+    struct Stats {
+        std::uint64_t loads = 0;       // jobs queued
+        std::uint64_t spawned = 0;
+        std::uint64_t despawned = 0;
+        std::uint64_t failed = 0;
+        std::size_t live = 0;
+        std::size_t loading = 0;
+    };
+
+    LevelStreamer(const LevelFile& level, JobSystem& jobs, const Settings& settings);
+    ~LevelStreamer();
+    LevelStreamer(const LevelStreamer&) = delete;
+    LevelStreamer& operator=(const LevelStreamer&) = delete;
+
+    // Main thread, once per frame. Appends region indices to `spawn` (now Live: create
+    // their entities) and `despawn` (no longer Live: destroy them).
+    void update(const glm::vec2& focus, std::vector<int>& spawn, std::vector<int>& despawn);
+
+    State state(int region) const { return states_[region].load(std::memory_order_acquire); }
+    const Stats& stats() const { return stats_; }
+
+private:
+    static void loadJob(void* context, std::size_t begin, std::size_t end);
+
+    const LevelFile& level_;
+    JobSystem& jobs_;
+    Settings settings_;
+    std::unique_ptr<std::atomic<State>[]> states_;
+    std::vector<int> active_;          // regions not Unloaded (nor Failed)
+    JobCounter pending_;
+    Stats stats_;
+};
@@ -0,0 +1,165 @@
+#include "core/log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+#include "core/mpsc_ring.h"
+
+namespace logging {
+
+namespace detail {
+std::atomic<Level> gLevel{Level::Info};
+}
+
+namespace {
+
+struct Message {
+    Level level;
+    std::uint16_t length;
+    char text[kMessageSize];
+};
+
+MpscRing<Message, kCapacity> gRing;
+std::atomic<bool> gActive{false};
+std::atomic<bool> gStopRequested{false};
+std::atomic<std::uint64_t> gDropped{0};
+
+void output(Level level, const char* text, std::size_t length) {
+    std::FILE* file = level >= Level::Warning ? stderr : stdout;
+    std::fwrite(text, 1, length, file);
+    std::fputc('\n', file);
+}
+
+// Writer side: everything published so far, then one flush for all of it.
+bool drain() {
+    bool any = false;
+    while (gRing.pop([](const Message& m) { output(m.level, m.text, m.length); })) {
+        any = true;
+    }
+    if (any) {
+        std::fflush(stdout);
+    }
+    return any;
+}
+
+void writerMain() {
+    while (!gStopRequested.load(std::memory_order_acquire)) {
+        if (!drain()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    }
+    drain();
+}
+
+// Joins the writer at exit if main returned without stop() (a joinable std::thread
+// would terminate the process from its destructor).
+struct Writer {
+    std::thread thread;
+    ~Writer() { stop(); }
+};
+Writer gWriter;
+
+void vwrite(Level level, const char* format, std::va_list args) {
+    if (!gActive.load(std::memory_order_acquire)) {
+        char text[kMessageSize];
+        const int length = std::vsnprintf(text, sizeof text, format, args);
+        output(level, text, length < 0 ? 0 : std::min<std::size_t>(length, sizeof text - 1));
+        return;
+    }
+    const bool queued = gRing.push([&](Message& m) {
+        const int length = std::vsnprintf(m.text, sizeof m.text, format, args);
+        m.level = level;
+        m.length = static_cast<std::uint16_t>(length < 0 ? 0 : std::min<std::size_t>(length, sizeof m.text - 1));
+    });
+    if (!queued) {
+        gDropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+} // namespace
+
+void start(Level minimum) {
+    setLevel(minimum);
+    if (gActive.load()) {
+        return;
+    }
+    gStopRequested.store(false);
+    gWriter.thread = std::thread(writerMain);
+    gActive.store(true, std::memory_order_release);
+}
+
+void stop() {
+    if (!gActive.exchange(false)) {
+        return;
+    }
+    gStopRequested.store(true, std::memory_order_release);
+    gWriter.thread.join();
+    // A producer that saw gActive just before it went false may still be publishing.
+    drain();
+    if (const std::uint64_t lost = gDropped.load(std::memory_order_relaxed)) {
+        std::fprintf(stderr, "log: %llu messages dropped (queue full)\n", static_cast<unsigned long long>(lost));
+    }
+}
+
+void setLevel(Level minimum) {
+    detail::gLevel.store(minimum, std::memory_order_relaxed);
+}
+
+Level level() {
+    return detail::gLevel.load(std::memory_order_relaxed);
+}
+
+bool parse(const char* text, Level& out) {
+    if (std::strcmp(text, "debug") == 0) {
+        out = Level::Debug;
+    } else if (std::strcmp(text, "info") == 0) {
+        out = Level::Info;
+    } else if (std::strcmp(text, "warn") == 0 || std::strcmp(text, "warning") == 0) {
+        out = Level::Warning;
+    } else if (std::strcmp(text, "error") == 0) {
+        out = Level::Error;
+    } else if (std::strcmp(text, "off") == 0) {
+        out = Level::Off;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void write(Level level, const char* format, ...) {
+    if (!enabled(level)) {
+        return;
+    }
+    std::va_list args;
+    va_start(args, format);
+    vwrite(level, format, args);
+    va_end(args);
+}
+
+#define LOGGING_LEVEL_FUNCTION(name, level)      \
+    void name(const char* format, ...) {         \
+        if (!enabled(level)) {                   \
+            return;                              \
+        }                                        \
+        std::va_list args;                       \
+        va_start(args, format);                  \
+        vwrite(level, format, args);             \
+        va_end(args);                            \
+    }
+
+LOGGING_LEVEL_FUNCTION(debug, Level::Debug)
+LOGGING_LEVEL_FUNCTION(info, Level::Info)
+LOGGING_LEVEL_FUNCTION(warn, Level::Warning)
+LOGGING_LEVEL_FUNCTION(error, Level::Error)
+
+#undef LOGGING_LEVEL_FUNCTION
+
+std::uint64_t dropped() {
+    return gDropped.load(std::memory_order_relaxed);
+}
+
+} // namespace logging
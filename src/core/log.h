@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Non-blocking log
+// ----------------
+// printf-style messages from any thread, written to the terminal by a background
+// thread. std::cout from a key callback or the frame loop is a synchronous write(): on
+// a slow terminal (or a paused pager, or a full pipe) it stalls the thread that draws.
+// Here the calling thread never touches a file:
+//
+// | Step                               | Where             | Cost                       |
+// | ---------------------------------- | ----------------- | -------------------------- |
+// | level check                        | caller            | one relaxed load; a        |
+// |                                    |                   | filtered message ends here |
+// | claim a slot, snprintf into it,    | caller            | a CAS + the formatting; no |
+// | publish                            |                   | lock, no allocation        |
+// | fwrite to stdout / stderr          | writer thread     | whatever the terminal costs|
+//
+// The queue is a lock-free MpscRing (core/mpsc_ring.h) of kCapacity messages of up to
+// kMessageSize - 1 characters (longer ones are cut). If it is full—the writer fell that
+// far behind—the message is dropped and counted, never waited for; stop() reports how
+// many were. Warnings and errors go to stderr, the rest to stdout, in the order they
+// were queued.
+//
+// Before start() and after stop() messages are written directly by the calling thread,
+// so startup and shutdown output is never lost.
+//
+// Usage:
+//     logging::start(logging::Level::Info);           // once, early in main
+//     logging::info("Renderer path: %s", name);       // any thread
+//     logging::stop();                                // flushes, joins the writer
+namespace logging {
+
+enum class Level : std::uint8_t { Debug, Info, Warning, Error, Off };
+
+constexpr int kCapacity = 1024;        // messages in flight
+constexpr int kMessageSize = 240;      // bytes per message, the terminating 0 included
+
+// Starts the writer thread; messages below `minimum` are discarded from then on.
+void start(Level minimum = Level::Info);
+// Writes out everything still queued and joins the writer. Safe to call twice.
+void stop();
+
+void setLevel(Level minimum);
+Level level();
+// "debug", "info", "warn"/"warning", "error", "off". False for anything else.
+bool parse(const char* text, Level& out);
+
+namespace detail {
+extern std::atomic<Level> gLevel;
+}
+
+// Inline so that a filtered message costs the caller a load and a compare.
+inline bool enabled(Level level) {
+    return level >= detail::gLevel.load(std::memory_order_relaxed);
+}
+
+void write(Level level, const char* format, ...) __attribute__((format(printf, 2, 3)));
+void debug(const char* format, ...) __attribute__((format(printf, 1, 2)));
+void info(const char* format, ...) __attribute__((format(printf, 1, 2)));
+void warn(const char* format, ...) __attribute__((format(printf, 1, 2)));
+void error(const char* format, ...) __attribute__((format(printf, 1, 2)));
+
+std::uint64_t dropped();       // messages lost to a full queue so far
+
+} // namespace logging
@@ -0,0 +1,321 @@
+#include "core/loose_quadtree.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "core/spatial_query.h"
+
+LooseQuadtree::LooseQuadtree(const Aabb& world, int maxDepth) : maxDepth_(std::max(0, maxDepth)) {
+    reset(world);
+}
+
+void LooseQuadtree::reset(const Aabb& world) {
+    // Square root cell around the requested region; a degenerate region still gets a
+    // usable (tiny) root.
+    const glm::vec2 center = (world.min + world.max) * 0.5f;
+    const glm::vec2 extent = world.max - world.min;
+    rootSize_ = std::max(std::max(extent.x, extent.y), 1e-6f);
+    world_ = Aabb::around(center, rootSize_ * 0.5f);
+
+    nodes_.clear();
+    Node root;
+    root.center = center;
+    root.halfSize = rootSize_ * 0.5f;
+    root.parent = kNone;
+    nodes_.push_back(std::move(root));
+}
+
+void LooseQuadtree::clear() {
+    reset(world_);
+    overflow_.clear();
+    records_.clear();
+    count_ = 0;
+}
+
+void LooseQuadtree::rebuild(const Aabb* bounds, std::size_t count) {
+    // Fit the root to the data so nothing lands in the overflow list.
+    Aabb world = world_;
+    if (count > 0) {
+        world = bounds[0];
+        for (std::size_t i = 1; i < count; ++i) {
+            world.min = glm::min(world.min, bounds[i].min);
+            world.max = glm::max(world.max, bounds[i].max);
+        }
+    }
+    reset(world);
+    overflow_.clear();
+    records_.assign(count, Record{});
+    count_ = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        insert(static_cast<ObjectId>(i), bounds[i]);
+    }
+}
+
+std::int32_t LooseQuadtree::nodeFor(const Aabb& bounds) {
+    const glm::vec2 center = (bounds.min + bounds.max) * 0.5f;
+    if (!world_.contains(center)) {
+        return kOverflow;
+    }
+
+    // Deepest level whose cells are still at least twice the object's size.
+    const glm::vec2 extent = bounds.max - bounds.min;
+    const float size = std::max(extent.x, extent.y);
+    int depth = maxDepth_;
+    if (size > 0.0f) {
+        depth = std::min(maxDepth_, static_cast<int>(std::floor(std::log2(rootSize_ / (2.0f * size)))));
+        // log2 rounding must never pick cells too small for the object (it would poke out
+        // of the loose bounds and queries would miss it).
+        while (depth > 0 && std::ldexp(rootSize_, -depth) < 2.0f * size) {
+            --depth;
+        }
+    }
+    if (depth <= 0) {
+        // Too big for a child of the root: only the root's loose bounds can hold it.
+        const Aabb loose = Aabb::around(nodes_[0].center, rootSize_ * 0.5f * kLooseness);
+        const bool fits = bounds.min.x >= loose.min.x && bounds.min.y >= loose.min.y &&
+                          bounds.max.x <= loose.max.x && bounds.max.y <= loose.max.y;
+        return fits ? 0 : kOverflow;
+    }
+
+    // Walk down to that level through the cells containing the center, creating the
+    // missing nodes on the way. Indices, not references: push_back may reallocate.
+    std::int32_t node = 0;
+    for (int level = 0; level < depth; ++level) {
+        const glm::vec2 c = nodes_[node].center;
+        const int quadrant = (center.x > c.x ? 1 : 0) | (center.y > c.y ? 2 : 0);
+        std::int32_t child = nodes_[node].children[quadrant];
+        if (child == kNone) {
+            const float half = nodes_[node].halfSize * 0.5f;
+            Node n;
+            n.center = c + glm::vec2((quadrant & 1) ? half : -half, (quadrant & 2) ? half : -half);
+            n.halfSize = half;
+            n.parent = node;
+            n.depth = level + 1;
+            child = static_cast<std::int32_t>(nodes_.size());
+            nodes_.push_back(std::move(n));
+            nodes_[node].children[quadrant] = child;
+        }
+        node = child;
+    }
+    return node;
+}
+
+bool LooseQuadtree::fitsExactly(const Node& node, const Aabb& bounds) const {
+    // nodeFor() would pick this node again: center inside its cell, and the object's
+    // size within [cell / 4, cell / 2]—smaller ones belong deeper, unless already at the
+    // bottom. (The root also takes everything too big for its children.)
+    const glm::vec2 center = (bounds.min + bounds.max) * 0.5f;
+    const glm::vec2 extent = bounds.max - bounds.min;
+    const float size = std::max(extent.x, extent.y);
+    const float cell = node.halfSize * 2.0f;
+    return std::fabs(center.x - node.center.x) <= node.halfSize &&
+           std::fabs(center.y - node.center.y) <= node.halfSize &&
+           size * 2.0f <= cell && node.depth > 0 &&
+           (node.depth == maxDepth_ || size * 4.0f > cell);
+}
+
+void LooseQuadtree::link(ObjectId id, const Aabb& bounds, std::int32_t node) {
+    Record& r = records_[id];
+    r.node = node;
+    if (node == kOverflow) {
+        r.slot = static_cast<std::uint32_t>(overflow_.size());
+        overflow_.push_back(Entry{bounds, id});
+        return;
+    }
+    r.slot = static_cast<std::uint32_t>(nodes_[node].objects.size());
+    nodes_[node].objects.push_back(Entry{bounds, id});
+    for (std::int32_t n = node; n != kNone; n = nodes_[n].parent) {
+        ++nodes_[n].subtreeCount;
+    }
+}
+
+void LooseQuadtree::unlink(ObjectId id) {
+    Record& r = records_[id];
+    std::vector<Entry>& list = r.node == kOverflow ? overflow_ : nodes_[r.node].objects;
+    // Swap-remove; the object moved into the hole gets its new slot.
+    list[r.slot] = list.back();
+    records_[list[r.slot].id].slot = r.slot;
+    list.pop_back();
+    if (r.node != kOverflow) {
+        for (std::int32_t n = r.node; n != kNone; n = nodes_[n].parent) {
+            --nodes_[n].subtreeCount;
+        }
+    }
+    r.node = kNone;
+}
+
+void LooseQuadtree::insert(ObjectId id, const Aabb& bounds) {
+    if (id >= records_.size()) {
+        records_.resize(id + 1);
+    }
+    if (records_[id].node != kNone) {
+        update(id, bounds);
+        return;
+    }
+    link(id, bounds, nodeFor(bounds));
+    ++count_;
+}
+
+void LooseQuadtree::update(ObjectId id, const Aabb& bounds) {
+    if (id >= records_.size() || records_[id].node == kNone) {
+        insert(id, bounds);
+        return;
+    }
+    Record& r = records_[id];
+    if (r.node >= 0 && fitsExactly(nodes_[r.node], bounds)) {
+        nodes_[r.node].objects[r.slot].bounds = bounds;
+        return; // same node: the common case for anything moving less than a cell
+    }
+    const std::int32_t node = nodeFor(bounds);
+    if (node == r.node) {
+        (node == kOverflow ? overflow_ : nodes_[node].objects)[r.slot].bounds = bounds;
+        return;
+    }
+    unlink(id);
+    link(id, bounds, node);
+}
+
+void LooseQuadtree::remove(ObjectId id) {
+    if (id >= records_.size() || records_[id].node == kNone) {
+        return;
+    }
+    unlink(id);
+    --count_;
+}
+
+void LooseQuadtree::appendSubtree(std::int32_t index, std::vector<ObjectId>& out) const {
+    const Node& node = nodes_[index];
+    if (node.subtreeCount == 0) {
+        return;
+    }
+    for (const Entry& e : node.objects) {
+        out.push_back(e.id);
+    }
+    for (std::int32_t child : node.children) {
+        if (child != kNone) {
+            appendSubtree(child, out);
+        }
+    }
+}
+
+void LooseQuadtree::queryRectNode(std::int32_t index, const Aabb& rect, std::vector<ObjectId>& out) const {
+    const Node& node = nodes_[index];
+    if (node.subtreeCount == 0) {
+        return;
+    }
+    const Aabb loose = Aabb::around(node.center, node.halfSize * kLooseness);
+    if (rect.contains(loose.min) && rect.contains(loose.max)) {
+        // Everything in this subtree lies inside the query: no per-object tests.
+        appendSubtree(index, out);
+        return;
+    }
+    for (const Entry& e : node.objects) {
+        if (e.bounds.overlaps(rect)) {
+            out.push_back(e.id);
+        }
+    }
+    for (int q = 0; q < 4; ++q) {
+        if (node.children[q] != kNone && childLoose(node, q).overlaps(rect)) {
+            queryRectNode(node.children[q], rect, out);
+        }
+    }
+}
+
+Aabb LooseQuadtree::childLoose(const Node& node, int quadrant) {
+    const float half = node.halfSize * 0.5f;
+    const glm::vec2 center = node.center + glm::vec2((quadrant & 1) ? half : -half, (quadrant & 2) ? half : -half);
+    return Aabb::around(center, half * kLooseness);
+}
+
+void LooseQuadtree::queryRect(const Aabb& rect, std::vector<ObjectId>& out) const {
+    if (Aabb::around(nodes_[0].center, nodes_[0].halfSize * kLooseness).overlaps(rect)) {
+        queryRectNode(0, rect, out);
+    }
+    for (const Entry& e : overflow_) {
+        if (e.bounds.overlaps(rect)) {
+            out.push_back(e.id);
+        }
+    }
+}
+
+void LooseQuadtree::queryPointNode(std::int32_t index, const glm::vec2& point, std::vector<ObjectId>& out) const {
+    const Node& node = nodes_[index];
+    if (node.subtreeCount == 0) {
+        return;
+    }
+    for (const Entry& e : node.objects) {
+        if (e.bounds.contains(point)) {
+            out.push_back(e.id);
+        }
+    }
+    // Loose bounds overlap, so near a cell's center lines up to four children contain
+    // the point; elsewhere just one. A child's bounds follow from this node's, so they are
+    // tested here, before touching (cache-missing on) the child itself.
+    for (int q = 0; q < 4; ++q) {
+        if (node.children[q] != kNone && childLoose(node, q).contains(point)) {
+            queryPointNode(node.children[q], point, out);
+        }
+    }
+}
+
+void LooseQuadtree::queryPoint(const glm::vec2& point, std::vector<ObjectId>& out) const {
+    if (Aabb::around(nodes_[0].center, nodes_[0].halfSize * kLooseness).contains(point)) {
+        queryPointNode(0, point, out);
+    }
+    for (const Entry& e : overflow_) {
+        if (e.bounds.contains(point)) {
+            out.push_back(e.id);
+        }
+    }
+}
+
+void LooseQuadtree::sweepNode(std::int32_t index, SweepTester& tester) const {
+    const Node& node = nodes_[index];
+    if (node.subtreeCount == 0) {
+        return;
+    }
+    for (const Entry& e : node.objects) {
+        tester.test(e.id, e.bounds);
+    }
+    tester.flush();
+    // The children the sweep crosses, nearest first: a hit in a near one makes the far
+    // ones start past it more often than not.
+    std::int32_t order[4];
+    float enter[4];
+    int count = 0;
+    for (int q = 0; q < 4; ++q) {
+        float t = 0.0f;
+        if (node.children[q] != kNone && tester.crosses(childLoose(node, q), t)) {
+            int k = count++;
+            for (; k > 0 && enter[k - 1] > t; --k) {
+                order[k] = order[k - 1];
+                enter[k] = enter[k - 1];
+            }
+            order[k] = node.children[q];
+            enter[k] = t;
+        }
+    }
+    for (int k = 0; k < count && !tester.done() && enter[k] < tester.limit(); ++k) {
+        sweepNode(order[k], tester);
+    }
+}
+
+void LooseQuadtree::sweep(SweepTester& tester) const {
+    float enter = 0.0f;
+    if (tester.crosses(Aabb::around(nodes_[0].center, nodes_[0].halfSize * kLooseness), enter)) {
+        sweepNode(0, tester);
+    }
+    for (const Entry& e : overflow_) {
+        tester.test(e.id, e.bounds);
+    }
+    tester.flush();
+}
+
+std::size_t LooseQuadtree::memoryBytes() const {
+    std::size_t bytes = nodes_.capacity() * sizeof(Node) + records_.capacity() * sizeof(Record) +
+                        overflow_.capacity() * sizeof(Entry);
+    for (const Node& node : nodes_) {
+        bytes += node.objects.capacity() * sizeof(Entry);
+    }
+    return bytes;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "core/spatial_index.h"
+
+// LooseQuadtree
+// -------------
+// Quadtree whose nodes accept objects overlapping their edges: each node's LOOSE bounds
+// are its cell grown by a quarter cell on every side (looseness 1.5). An object then
+// fits the node at the depth matching its size—cell size ≥ 2 x object size—that contains
+// its CENTER, which is a direct computation instead of a descent with fit tests:
+//
+//     depth = floor(log2(rootSize / (2 * objectSize)))      (clamped to maxDepth)
+//     cell  = floor((center - rootMin) / cellSize(depth))
+//
+// Why 1.5 and not the classic 2: at 2, the four children's loose bounds each cover the
+// whole parent cell, so a point query must descend into all of them at every level.
+// At 1.5 they only overlap in a strip around the parent's center lines.
+//
+// | vs. UniformGrid  | LooseQuadtree                              | UniformGrid            |
+// | ---------------- | ------------------------------------------ | ---------------------- |
+// | empty space      | no nodes                                   | no cells               |
+// | dense clusters   | deeper nodes, few objects per node         | long per-cell lists    |
+// | mixed sizes      | each size at its own depth                 | big objects many cells |
+// | object stored in | exactly one node (no duplicates)           | every cell it touches  |
+// | query cost       | descent: skips empty / out-of-view subtrees | cells under the rect   |
+//
+// Nodes are pooled in one vector and never freed until clear()/rebuild(); each keeps a
+// count of the objects in its subtree so queries skip emptied branches. Objects outside
+// the root's loose bounds go to an overflow list that every query checks, so nothing is
+// lost if something wanders off the level—rebuild() re-fits the root to the data.
+class LooseQuadtree : public SpatialIndex {
+public:
+    // `world`: region the tree subdivides (made square). `maxDepth`: deepest level; leaf
+    // cells are rootSize / 2^maxDepth wide.
+    explicit LooseQuadtree(const Aabb& world = Aabb{glm::vec2(-1.0f), glm::vec2(1.0f)}, int maxDepth = 8);
+
+    void clear() override;
+    void rebuild(const Aabb* bounds, std::size_t count) override;
+    void insert(ObjectId id, const Aabb& bounds) override;
+    void update(ObjectId id, const Aabb& bounds) override;
+    void remove(ObjectId id) override;
+
+    void queryRect(const Aabb& rect, std::vector<ObjectId>& out) const override;
+    void queryPoint(const glm::vec2& point, std::vector<ObjectId>& out) const override;
+    void sweep(SweepTester& tester) const override;
+
+    std::size_t size() const override { return count_; }
+    std::size_t memoryBytes() const override;
+
+    std::size_t nodeCount() const { return nodes_.size(); }
+
+private:
+    static constexpr std::int32_t kNone = -1;
+    static constexpr std::int32_t kOverflow = -2; // Record::node for overflow objects
+    static constexpr float kLooseness = 1.5f;     // loose half size = kLooseness * halfSize
+
+    // Bounds are stored next to the id in the node's list, so a query reads them in the
+    // same cache lines instead of chasing each id into records_.
+    struct Entry {
+        Aabb bounds;
+        ObjectId id;
+    };
+    struct Node {
+        glm::vec2 center;      // of the (tight) cell
+        float halfSize;        // of the (tight) cell; loose bounds are ± kLooseness * halfSize
+        std::int32_t parent;
+        int depth = 0;
+        std::int32_t children[4] = {kNone, kNone, kNone, kNone}; // quadrant = (x > c) | (y > c) << 1
+        std::uint32_t subtreeCount = 0;
+        std::vector<Entry> objects;
+    };
+    struct Record {
+        std::int32_t node = kNone; // kNone = not present
+        std::uint32_t slot = 0;    // position in the node's (or overflow) list
+    };
+
+    void reset(const Aabb& world);
+    std::int32_t nodeFor(const Aabb& bounds);
+    bool fitsExactly(const Node& node, const Aabb& bounds) const;
+    void link(ObjectId id, const Aabb& bounds, std::int32_t node);
+    void unlink(ObjectId id);
+    static Aabb childLoose(const Node& node, int quadrant);
+    void appendSubtree(std::int32_t node, std::vector<ObjectId>& out) const;
+    void queryRectNode(std::int32_t node, const Aabb& rect, std::vector<ObjectId>& out) const;
+    void queryPointNode(std::int32_t node, const glm::vec2& point, std::vector<ObjectId>& out) const;
+    void sweepNode(std::int32_t node, SweepTester& tester) const;
+
+    Aabb world_;
+    float rootSize_ = 2.0f;
+    int maxDepth_;
+    std::vector<Node> nodes_;     // nodes_[0] is the root
+    std::vector<Entry> overflow_;
+    std::vector<Record> records_; // indexed by id
+    std::size_t count_ = 0;
+};
@@ -0,0 +1,145 @@
+#include "core/lz4.h"
+
+#include <cstdint>
+#include <cstring>
+
+namespace {
+
+constexpr std::size_t kMinMatch = 4;
+constexpr std::size_t kLastLiterals = 5;  // the block always ends with this many literals
+constexpr std::size_t kMatchStartLimit = 12; // no match may start in the last 12 bytes
+constexpr std::size_t kMaxOffset = 65535;
+constexpr int kHashBits = 14;             // 16384 entries * 4 bytes = 64 KB
+
+std::uint32_t read32(const unsigned char* p) {
+    std::uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+std::uint32_t hash4(std::uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - kHashBits); // Knuth's multiplicative hash
+}
+
+// 15 in the token, then 255s, then the remainder.
+void writeLength(std::vector<unsigned char>& out, std::size_t length) {
+    while (length >= 255) {
+        out.push_back(255);
+        length -= 255;
+    }
+    out.push_back(static_cast<unsigned char>(length));
+}
+
+void writeSequence(std::vector<unsigned char>& out, const unsigned char* literals, std::size_t literalCount,
+                   std::size_t offset, std::size_t matchLength) {
+    const std::size_t matchCode = matchLength - kMinMatch;
+    out.push_back(static_cast<unsigned char>(((literalCount < 15 ? literalCount : 15) << 4) |
+                                             (matchCode < 15 ? matchCode : 15)));
+    if (literalCount >= 15) writeLength(out, literalCount - 15);
+    out.insert(out.end(), literals, literals + literalCount);
+    out.push_back(static_cast<unsigned char>(offset & 0xFF));
+    out.push_back(static_cast<unsigned char>(offset >> 8));
+    if (matchCode >= 15) writeLength(out, matchCode - 15);
+}
+
+void writeLastLiterals(std::vector<unsigned char>& out, const unsigned char* literals, std::size_t count) {
+    out.push_back(static_cast<unsigned char>((count < 15 ? count : 15) << 4));
+    if (count >= 15) writeLength(out, count - 15);
+    out.insert(out.end(), literals, literals + count);
+}
+
+// Reads a continued length (after a 15 nibble). false if the input ends first.
+bool readLength(const unsigned char*& in, const unsigned char* end, std::size_t& length) {
+    unsigned char b;
+    do {
+        if (in == end) return false;
+        b = *in++;
+        length += b;
+    } while (b == 255);
+    return true;
+}
+
+} // namespace
+
+void lz4Compress(const unsigned char* src, std::size_t size, std::vector<unsigned char>& out) {
+    out.clear();
+    out.reserve(size + size / 255 + 16); // worst case: incompressible
+    std::size_t anchor = 0;              // start of the literals not yet written
+    if (size > kMatchStartLimit) {
+        std::vector<std::int32_t> table(std::size_t(1) << kHashBits, -1);
+        const std::size_t matchStartEnd = size - kMatchStartLimit;
+        const std::size_t matchEnd = size - kLastLiterals;
+        std::size_t i = 0;
+        while (i < matchStartEnd) {
+            const std::uint32_t sequence = read32(src + i);
+            const std::uint32_t h = hash4(sequence);
+            const std::int32_t candidate = table[h];
+            table[h] = static_cast<std::int32_t>(i);
+            if (candidate < 0 || i - candidate > kMaxOffset || read32(src + candidate) != sequence) {
+                ++i;
+                continue;
+            }
+            std::size_t match = static_cast<std::size_t>(candidate);
+            std::size_t length = kMinMatch;
+            while (i + length < matchEnd && src[match + length] == src[i + length]) {
+                ++length;
+            }
+            // The bytes before may match as well: move them from the literals into the match.
+            while (i > anchor && match > 0 && src[i - 1] == src[match - 1]) {
+                --i;
+                --match;
+                ++length;
+            }
+            writeSequence(out, src + anchor, i - anchor, i - match, length);
+            i += length;
+            anchor = i;
+        }
+    }
+    writeLastLiterals(out, src + anchor, size - anchor);
+}
+
+bool lz4Decompress(const unsigned char* src, std::size_t srcSize, unsigned char* dst, std::size_t dstSize) {
+    const unsigned char* in = src;
+    const unsigned char* const inEnd = src + srcSize;
+    std::size_t written = 0;
+    while (in < inEnd) {
+        const unsigned char token = *in++;
+        std::size_t literals = token >> 4;
+        if (literals == 15 && !readLength(in, inEnd, literals)) {
+            return false;
+        }
+        if (literals > static_cast<std::size_t>(inEnd - in) || literals > dstSize - written) {
+            return false;
+        }
+        std::memcpy(dst + written, in, literals);
+        in += literals;
+        written += literals;
+        if (in == inEnd) {
+            break; // the last sequence has no match
+        }
+
+        if (inEnd - in < 2) {
+            return false;
+        }
+        const std::size_t offset = in[0] | (std::size_t(in[1]) << 8);
+        in += 2;
+        std::size_t length = token & 15;
+        if (length == 15 && !readLength(in, inEnd, length)) {
+            return false;
+        }
+        length += kMinMatch;
+        if (offset == 0 || offset > written || length > dstSize - written) {
+            return false;
+        }
+        // Byte by byte: a match may overlap its own output (offset < length repeats a run).
+        const unsigned char* from = dst + written - offset;
+        unsigned char* to = dst + written;
+        if (offset >= length) {
+            std::memcpy(to, from, length);
+        } else {
+            for (std::size_t k = 0; k < length; ++k) to[k] = from[k];
+        }
+        written += length;
+    }
+    return written == dstSize;
+}
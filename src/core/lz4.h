@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// LZ4 block format
+// ----------------
+// The byte-oriented LZ77 codec behind the pack file's compressed entries
+// (core/pack_file.h). Decoding is a loop of copies with no entropy stage, which is why
+// it is used for assets: it runs at several GB/s, faster than the disk it saves reads from.
+//
+// A block is a run of sequences:
+//
+//     token (1 byte)   high 4 bits: literal count,   low 4 bits: match length - 4
+//     [+255 bytes...]  literal count continues while 15 / 255 bytes are read
+//     literals         copied as they are
+//     offset (2 bytes) little-endian distance back into the output (1..65535)
+//     [+255 bytes...]  match length continues likewise
+//
+// The last sequence is literals only: the last 5 bytes are always literals and the last
+// match starts at least 12 bytes before the end (the rules of the reference format, so
+// the output is readable by any LZ4 block decoder, e.g. LZ4_decompress_safe).
+//
+// Blocks carry no sizes: whoever stores one keeps the original size next to it.
+
+// Greedy single-probe compressor (one 64 KB hash table of 4-byte sequences), close to
+// the reference LZ4's fast mode. Runs offline (pack_tool) and on a worker for the
+// snapshot history's deltas (ecs/snapshot.h), which are mostly zeros: long matches.
+// Replaces `out` with the compressed block.
+void lz4Compress(const unsigned char* src, std::size_t size, std::vector<unsigned char>& out);
+
+// Decodes exactly `dstSize` bytes. false on a malformed or truncated block, or one that
+// doesn't decode to exactly dstSize; never reads or writes out of bounds.
+bool lz4Decompress(const unsigned char* src, std::size_t srcSize, unsigned char* dst, std::size_t dstSize);
@@ -0,0 +1,73 @@
+#include "core/mapped_file.h"
+
+#include "core/file_io.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MAPPED_FILE_MMAP 1
+#endif
+
+bool MappedFile::openAs(const std::string& path, bool writable) {
+    close();
+#ifdef MAPPED_FILE_MMAP
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        // MAP_PRIVATE either way: with PROT_WRITE, written pages are copied, not stored.
+        void* mapping = mmap(nullptr, static_cast<std::size_t>(st.st_size),
+                             writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED) {
+            base_ = static_cast<const unsigned char*>(mapping);
+            size_ = static_cast<std::size_t>(st.st_size);
+            mapped_ = true;
+        }
+    }
+    ::close(fd); // the mapping stays valid without the descriptor
+#endif
+    if (!mapped_) {
+        if (!readFile(path, owned_) || owned_.empty()) {
+            owned_.clear();
+            return false;
+        }
+        base_ = owned_.data();
+        size_ = owned_.size();
+    }
+    writable_ = writable;
+    return true;
+}
+
+void MappedFile::close() {
+#ifdef MAPPED_FILE_MMAP
+    if (mapped_) {
+        munmap(const_cast<unsigned char*>(base_), size_);
+    }
+#endif
+    mapped_ = false;
+    writable_ = false;
+    owned_.clear();
+    owned_.shrink_to_fit();
+    base_ = nullptr;
+    size_ = 0;
+}
+
+void MappedFile::willNeed(std::size_t offset, std::size_t size) const {
+#ifdef MAPPED_FILE_MMAP
+    if (!mapped_ || offset >= size_ || size == 0) {
+        return;
+    }
+    // madvise wants a page-aligned start.
+    const std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    const std::size_t start = offset / page * page;
+    const std::size_t end = offset + size < size_ ? offset + size : size_;
+    madvise(const_cast<unsigned char*>(base_) + start, end - start, MADV_WILLNEED);
+#else
+    (void)offset;
+    (void)size;
+#endif
+}
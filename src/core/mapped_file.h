@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// MappedFile
+// ----------
+// A whole file as read-only bytes that stay put until close(): an mmap where the
+// platform has one (pages come in on first touch, nothing is copied), else the file
+// read into memory once (core/file_io.h). Pack files (core/pack_file.h) and levels
+// (core/level_file.h) are both used in place through one of these.
+//
+// openCopyOnWrite() maps the file writable but private: a page written to becomes this
+// process's own copy, and the file itself never changes. Save files (ecs/save_file.h)
+// become the World's chunks this way, and the simulation writes straight into them.
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() { close(); }
+
+    // false if the file can't be opened or read (or is empty).
+    bool open(const std::string& path) { return openAs(path, false); }
+    bool openCopyOnWrite(const std::string& path) { return openAs(path, true); }
+    void close();
+
+    const unsigned char* data() const { return base_; }
+    // openCopyOnWrite() only (nullptr otherwise).
+    unsigned char* writableData() { return writable_ ? const_cast<unsigned char*>(base_) : nullptr; }
+    std::size_t size() const { return size_; }
+    bool mapped() const { return mapped_; }
+
+    // Tells the OS [offset, offset + size) is about to be read, so it can start paging it
+    // in (madvise WILLNEED). A hint only; nothing to do for a file read into memory.
+    void willNeed(std::size_t offset, std::size_t size) const;
+
+private:
+    bool openAs(const std::string& path, bool writable);
+
+    const unsigned char* base_ = nullptr;
+    std::size_t size_ = 0;
+    bool mapped_ = false;                  // base_ is an mmap (else it points into owned_)
+    bool writable_ = false;                // openCopyOnWrite(): base_ may be written
+    std::vector<unsigned char> owned_;     // the whole file, where mmap isn't available
+};
@@ -0,0 +1,47 @@
+#include "core/matrix_inverse.h"
+
+namespace {
+
+// [A⁻¹ | -A⁻¹ t] with last row (0 0 0 1).
+glm::mat4 withTranslation(const glm::mat3& inverse, const glm::vec3& translation) {
+    glm::mat4 out(inverse);
+    out[3] = glm::vec4(-(inverse * translation), 1.0f);
+    return out;
+}
+
+} // namespace
+
+glm::mat4 inverseAffine(const glm::mat4& m) {
+    return withTranslation(glm::inverse(glm::mat3(m)), glm::vec3(m[3]));
+}
+
+glm::mat4 inverseRigid(const glm::mat4& m) {
+    return withTranslation(glm::transpose(glm::mat3(m)), glm::vec3(m[3]));
+}
+
+glm::mat4 inverseScaleTranslate(const glm::mat4& m) {
+    const glm::vec3 s(1.0f / m[0][0], 1.0f / m[1][1], 1.0f / m[2][2]);
+    glm::mat4 out(1.0f);
+    out[0][0] = s.x;
+    out[1][1] = s.y;
+    out[2][2] = s.z;
+    out[3] = glm::vec4(-glm::vec3(m[3]) * s, 1.0f);
+    return out;
+}
+
+glm::mat4 inversePerspective(const glm::mat4& m) {
+    // glm::perspective (right-handed, clip z in [-1, 1]), rows:
+    //     | x 0 0 0 |              | 1/x  0    0    0   |
+    //     | 0 y 0 0 |   inverse:   | 0    1/y  0    0   |
+    //     | 0 0 c d |              | 0    0    0   -1   |
+    //     | 0 0 -1 0 |             | 0    0    1/d  c/d |
+    const float c = m[2][2];
+    const float d = m[3][2];
+    glm::mat4 out(0.0f);
+    out[0][0] = 1.0f / m[0][0];
+    out[1][1] = 1.0f / m[1][1];
+    out[3][2] = -1.0f;
+    out[2][3] = 1.0f / d;
+    out[3][3] = c / d;
+    return out;
+}
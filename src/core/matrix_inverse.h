@@ -0,0 +1,44 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include "core/aligned_math.h"
+
+// Closed-form matrix inverses
+// ---------------------------
+// glm::inverse inverts any 4x4 by cofactors: ~200 floating-point operations, and the
+// rounding of a general method even when the answer is simple. Most matrices this game
+// inverts have a known shape, and each shape has a cheaper, exact inverse:
+//
+// | MatrixKind      | Shape (column-major, glm)                   | Inverse                     |
+// | --------------- | ------------------------------------------- | --------------------------- |
+// | General         | anything invertible                         | glm::inverse (SSE, aligned) |
+// | Affine          | 3x3 A + translation t, last row (0 0 0 1)   | A⁻¹, -A⁻¹ t                 |
+// | Rigid           | rotation R + t (lookAt, a camera's view)    | Rᵀ, -Rᵀ t (no divides)      |
+// | ScaleTranslate  | diagonal + t: glm::ortho, translate, scale  | 1/s, -t/s per axis          |
+// | Perspective     | glm::perspective (right-handed, z in ±1)    | 4 reciprocals, rearranged   |
+//
+// The kind is a promise by the caller; nothing checks that the matrix has that shape (a
+// debug assert would cost what the fast path saves). Camera knows its matrices' kinds:
+//
+//     inverse(projection * view) = inverseOf(view, Rigid) * inverseOf(projection, Perspective)
+//
+// `make glm-bench` times each one against glm::inverse.
+enum class MatrixKind { General, Affine, Rigid, ScaleTranslate, Perspective };
+
+glm::mat4 inverseAffine(const glm::mat4& m);
+glm::mat4 inverseRigid(const glm::mat4& m);
+glm::mat4 inverseScaleTranslate(const glm::mat4& m);
+glm::mat4 inversePerspective(const glm::mat4& m);
+
+inline glm::mat4 inverseOf(const glm::mat4& m, MatrixKind kind) {
+    switch (kind) {
+        case MatrixKind::Affine:         return inverseAffine(m);
+        case MatrixKind::Rigid:          return inverseRigid(m);
+        case MatrixKind::ScaleTranslate: return inverseScaleTranslate(m);
+        case MatrixKind::Perspective:    return inversePerspective(m);
+        case MatrixKind::General:        break;
+    }
+    // GLM's SSE inverse works on aligned types only (core/aligned_math.h).
+    return glm::mat4(glm::inverse(AlignedMat4(m)));
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+// MpscRing<T, Capacity>
+// ---------------------
+// Fixed-size lock-free queue for ANY number of producer threads and ONE consumer thread
+// (the SpscRing's shape, for when every thread has to be able to push into the same
+// queue—log messages, see core/log.h).
+//
+// - No locks, no allocation after construction. A push is one compare-and-swap on the
+//   tail to claim a slot, then the element is built IN the slot and published; a pop
+//   reads it in place and hands the slot back. Neither ever waits for the other side.
+// - Capacity must be a power of two.
+// - When full, push() fails instead of blocking; the caller decides whether to drop.
+//
+// Each slot carries a sequence number (bounded MPMC queue, D. Vyukov), which is what
+// lets producers claim slots out of order and publish them independently:
+//
+//     sequence == position             free: a producer at `position` may claim it
+//     sequence == position + 1         published: the consumer at `position` may read it
+//     sequence == position + Capacity  read: free again for the next lap
+//
+// A producer that claimed a slot but hasn't published it yet holds up the consumer at
+// that slot only (pop() reports empty); the slots after it wait their turn.
+template <typename T, std::size_t Capacity>
+class MpscRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    MpscRing() {
+        for (std::size_t i = 0; i < Capacity; ++i) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // Any thread. `fill(T&)` writes the element into its slot before it is published.
+    template <typename Fill>
+    bool push(Fill&& fill) {
+        std::size_t position = tail_.load(std::memory_order_relaxed);
+        Slot* slot;
+        for (;;) {
+            slot = &slots_[position & (Capacity - 1)];
+            const std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            const std::ptrdiff_t lag = static_cast<std::ptrdiff_t>(sequence - position);
+            if (lag == 0) {
+                if (tail_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;                  // claimed
+                }
+            } else if (lag < 0) {
+                return false;               // full: the consumer hasn't read this slot yet
+            } else {
+                position = tail_.load(std::memory_order_relaxed); // another producer got it
+            }
+        }
+        fill(slot->value);
+        slot->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // The consumer thread only. `read(const T&)` sees the element before its slot is reused.
+    template <typename Read>
+    bool pop(Read&& read) {
+        Slot& slot = slots_[head_ & (Capacity - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != head_ + 1) {
+            return false;                   // empty, or the next one isn't published yet
+        }
+        read(static_cast<const T&>(slot.value));
+        slot.sequence.store(head_ + Capacity, std::memory_order_release);
+        ++head_;
+        return true;
+    }
+
+    static constexpr std::size_t capacity() { return Capacity; }
+
+private:
+    struct Slot {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+
+    // Producers share tail_; head_ is the consumer's alone. Separate cache lines.
+    alignas(64) std::atomic<std::size_t> tail_{0};
+    alignas(64) std::size_t head_ = 0;
+    alignas(64) Slot slots_[Capacity];
+};
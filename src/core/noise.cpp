@@ -0,0 +1,156 @@
+#include "core/noise.h"
+
+#include <glm/gtc/noise.hpp>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+#if defined(__SSE2__)
+// floor() without SSE4.1: truncate, then step down where that rounded up (negatives).
+// Exact for |x| < 2^31, far beyond any coordinate the lattice sees.
+inline __m128 floor4(__m128 x) {
+    const __m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+    return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, x), _mm_set1_ps(1.0f)));
+}
+
+inline __m128 mod289(__m128 x) {
+    return _mm_sub_ps(x, _mm_mul_ps(floor4(_mm_mul_ps(x, _mm_set1_ps(1.0f / 289.0f))), _mm_set1_ps(289.0f)));
+}
+
+inline __m128 permute(__m128 x) {
+    return mod289(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(34.0f)), _mm_set1_ps(1.0f)), x));
+}
+
+inline __m128 abs4(__m128 x) {
+    return _mm_andnot_ps(_mm_set1_ps(-0.0f), x);
+}
+
+// glm::simplex(vec2) for four points, one per lane; the comments name glm's variables.
+__m128 simplex4(__m128 vx, __m128 vy) {
+    const __m128 cx = _mm_set1_ps(0.211324865405187f);
+    const __m128 cy = _mm_set1_ps(0.366025403784439f);
+    const __m128 cz = _mm_set1_ps(-0.577350269189626f);
+    const __m128 cw = _mm_set1_ps(0.024390243902439f);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+
+    // First corner: i = floor(v + dot(v, C.yy)), x0 = v - i + dot(i, C.xx).
+    const __m128 s = _mm_add_ps(_mm_mul_ps(vx, cy), _mm_mul_ps(vy, cy));   // as glm's dot()
+    __m128 ix = floor4(_mm_add_ps(vx, s));
+    __m128 iy = floor4(_mm_add_ps(vy, s));
+    const __m128 t = _mm_add_ps(_mm_mul_ps(ix, cx), _mm_mul_ps(iy, cx));
+    const __m128 x0x = _mm_add_ps(_mm_sub_ps(vx, ix), t);
+    const __m128 x0y = _mm_add_ps(_mm_sub_ps(vy, iy), t);
+
+    // Other corners: i1 = x0.x > x0.y ? (1, 0) : (0, 1).
+    const __m128 i1x = _mm_and_ps(_mm_cmpgt_ps(x0x, x0y), one);
+    const __m128 i1y = _mm_sub_ps(one, i1x);
+    const __m128 x12x = _mm_sub_ps(_mm_add_ps(x0x, cx), i1x);
+    const __m128 x12y = _mm_sub_ps(_mm_add_ps(x0y, cx), i1y);
+    const __m128 x12z = _mm_add_ps(x0x, cz);
+    const __m128 x12w = _mm_add_ps(x0y, cz);
+
+    // Permutations of the three corners.
+    ix = mod289(ix);
+    iy = mod289(iy);
+    const __m128 p0 = permute(_mm_add_ps(permute(iy), ix));
+    const __m128 p1 = permute(_mm_add_ps(_mm_add_ps(permute(_mm_add_ps(iy, i1y)), ix), i1x));
+    const __m128 p2 = permute(_mm_add_ps(_mm_add_ps(permute(_mm_add_ps(iy, one)), ix), one));
+
+    // m = max(0.5 - |corner offset|^2, 0)^4, per corner.
+    const __m128 zero = _mm_setzero_ps();
+    __m128 m0 = _mm_max_ps(_mm_sub_ps(half, _mm_add_ps(_mm_mul_ps(x0x, x0x), _mm_mul_ps(x0y, x0y))), zero);
+    __m128 m1 = _mm_max_ps(_mm_sub_ps(half, _mm_add_ps(_mm_mul_ps(x12x, x12x), _mm_mul_ps(x12y, x12y))), zero);
+    __m128 m2 = _mm_max_ps(_mm_sub_ps(half, _mm_add_ps(_mm_mul_ps(x12z, x12z), _mm_mul_ps(x12w, x12w))), zero);
+    m0 = _mm_mul_ps(m0, m0);
+    m0 = _mm_mul_ps(m0, m0);
+    m1 = _mm_mul_ps(m1, m1);
+    m1 = _mm_mul_ps(m1, m1);
+    m2 = _mm_mul_ps(m2, m2);
+    m2 = _mm_mul_ps(m2, m2);
+
+    // Gradients: x = 2 fract(p / 41) - 1, h = |x| - 0.5, a0 = x - floor(x + 0.5); the
+    // corner's contribution is m * taylorInvSqrt(a0^2 + h^2) * dot((a0, h), offset).
+    const __m128 two = _mm_set1_ps(2.0f);
+    const auto corner = [&](__m128 p, __m128 m, __m128 ox, __m128 oy) {
+        const __m128 q = _mm_mul_ps(p, cw);
+        const __m128 x = _mm_sub_ps(_mm_mul_ps(two, _mm_sub_ps(q, floor4(q))), one);
+        const __m128 h = _mm_sub_ps(abs4(x), half);
+        const __m128 a0 = _mm_sub_ps(x, floor4(_mm_add_ps(x, half)));
+        const __m128 norm = _mm_sub_ps(_mm_set1_ps(1.79284291400159f),
+                                       _mm_mul_ps(_mm_set1_ps(0.85373472095314f),
+                                                  _mm_add_ps(_mm_mul_ps(a0, a0), _mm_mul_ps(h, h))));
+        return _mm_mul_ps(_mm_mul_ps(m, norm), _mm_add_ps(_mm_mul_ps(a0, ox), _mm_mul_ps(h, oy)));
+    };
+    const __m128 sum = _mm_add_ps(_mm_add_ps(corner(p0, m0, x0x, x0y), corner(p1, m1, x12x, x12y)),
+                                  corner(p2, m2, x12z, x12w));
+    return _mm_mul_ps(_mm_set1_ps(130.0f), sum);
+}
+#endif
+
+} // namespace
+
+namespace noise {
+
+float simplex(float x, float y) {
+    return glm::simplex(glm::vec2(x, y));
+}
+
+void simplexRow(float x0, float dx, float y, std::size_t count, float* out) {
+    std::size_t i = 0;
+#if defined(__SSE2__)
+    // x0 + i * dx per lane, not a running sum: the same inputs as the scalar tail.
+    const __m128 lanes = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+    const __m128 vy = _mm_set1_ps(y);
+    for (; i + 4 <= count; i += 4) {
+        const __m128 index = _mm_add_ps(_mm_set1_ps(static_cast<float>(i)), lanes);
+        _mm_storeu_ps(out + i, simplex4(_mm_add_ps(_mm_set1_ps(x0), _mm_mul_ps(index, _mm_set1_ps(dx))), vy));
+    }
+#endif
+    for (; i < count; ++i) {
+        out[i] = simplex(x0 + static_cast<float>(i) * dx, y);
+    }
+}
+
+float fbm(const Fbm& settings, float x, float y) {
+    float sum = 0.0f, weight = 0.0f, amplitude = 1.0f, frequency = settings.frequency;
+    for (int o = 0; o < settings.octaves; ++o) {
+        sum += amplitude * simplex((x + settings.offset.x) * frequency, (y + settings.offset.y) * frequency);
+        weight += amplitude;
+        amplitude *= settings.gain;
+        frequency *= settings.lacunarity;
+    }
+    return weight > 0.0f ? sum / weight : 0.0f;
+}
+
+void fbmRow(const Fbm& settings, float x0, float dx, float y, std::size_t count, float* out) {
+    constexpr std::size_t kBlock = 64;  // points per pass: the octave scratch stays on the stack
+    float octave[kBlock];
+    float weight = 0.0f, total = 1.0f;
+    for (int o = 0; o < settings.octaves; ++o, total *= settings.gain) {
+        weight += total;
+    }
+    const float scale = weight > 0.0f ? 1.0f / weight : 0.0f;
+    for (std::size_t begin = 0; begin < count; begin += kBlock) {
+        const std::size_t n = count - begin < kBlock ? count - begin : kBlock;
+        float* dst = out + begin;
+        for (std::size_t i = 0; i < n; ++i) {
+            dst[i] = 0.0f;
+        }
+        const float bx = x0 + static_cast<float>(begin) * dx + settings.offset.x;
+        float amplitude = scale, frequency = settings.frequency;
+        for (int o = 0; o < settings.octaves; ++o) {
+            simplexRow(bx * frequency, dx * frequency, (y + settings.offset.y) * frequency, n, octave);
+            for (std::size_t i = 0; i < n; ++i) {
+                dst[i] += amplitude * octave[i];
+            }
+            amplitude *= settings.gain;
+            frequency *= settings.lacunarity;
+        }
+    }
+}
+
+} // namespace noise
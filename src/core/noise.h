@@ -0,0 +1,49 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+
+// Noise
+// -----
+// 2D simplex noise and fractal sums of it (fBm) for procedural content. simplex() is
+// glm::simplex (glm/gtc/noise.hpp): the same lattice, hash and gradients, so a value
+// seen in a shader or a glm call is the one generated here. simplexRow() evaluates a row
+// of points four at a time with SSE2, lane for lane the same operations in the same
+// order (floor and mod 289 included), so it returns glm::simplex's floats exactly.
+//
+//     noise::Fbm terrain;                 // 5 octaves, each twice the frequency and
+//     terrain.frequency = 1.0f / 64.0f;   // half the amplitude of the one before
+//     float heights[32];
+//     noise::fbmRow(terrain, x0, 1.0f, y, 32, heights);   // heights[i] at (x0 + i, y)
+//
+// | Function                  | Points per call | Per point, 5 octaves                 |
+// | ------------------------- | --------------- | ------------------------------------ |
+// | fbm(settings, x, y)       | 1               | 5 glm::simplex calls                 |
+// | fbmRow(settings, ...)     | a row           | 5 / 4 SSE2 simplex evaluations, plus |
+// |                           |                 | the scalar tail (count % 4)          |
+//
+// Rows are what tiles and texels come in; column-wise callers pass dx = 0 and vary y
+// themselves. Results are in about [-1, 1]; fbm is normalised by the octaves' total
+// amplitude, so it stays in that range whatever the settings.
+namespace noise {
+
+// glm::simplex(glm::vec2(x, y)).
+float simplex(float x, float y);
+
+// out[i] = simplex(x0 + i * dx, y) for i in [0, count).
+void simplexRow(float x0, float dx, float y, std::size_t count, float* out);
+
+struct Fbm {
+    int octaves = 5;
+    float frequency = 1.0f;            // of the first octave, per input unit
+    float lacunarity = 2.0f;           // frequency factor per octave
+    float gain = 0.5f;                 // amplitude factor per octave
+    glm::vec2 offset{0.0f};            // added to the input (in input units): the seed
+};
+
+float fbm(const Fbm& settings, float x, float y);
+
+// out[i] = fbm(settings, x0 + i * dx, y) for i in [0, count).
+void fbmRow(const Fbm& settings, float x0, float dx, float y, std::size_t count, float* out);
+
+} // namespace noise
@@ -0,0 +1,180 @@
+#include "core/pack_file.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#include "core/lz4.h"
+
+namespace {
+
+constexpr char kMagic[4] = {'P', 'A', 'K', '1'};
+constexpr std::uint32_t kVersion = 1;
+constexpr std::size_t kAlignment = 16;
+
+struct Header {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t count;
+    std::uint32_t reserved;
+    std::uint64_t tocOffset;
+    std::uint64_t namesOffset;
+};
+static_assert(sizeof(Header) == 32, "pack header layout");
+static_assert(sizeof(PackFile::Entry) == 32, "pack TOC entry layout");
+
+std::size_t alignUp(std::size_t n) {
+    return (n + kAlignment - 1) & ~(kAlignment - 1);
+}
+
+} // namespace
+
+std::uint64_t PackFile::hashPath(const std::string& path) {
+    std::uint64_t hash = 0xcbf29ce484222325ull;
+    for (unsigned char c : path) {
+        hash ^= c;
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+bool PackFile::open(const std::string& path) {
+    close();
+    if (!file_.open(path)) {
+        std::cerr << "Pack: cannot read " << path << "\n";
+        return false;
+    }
+    base_ = file_.data();
+    size_ = file_.size();
+    path_ = path;
+
+    Header header;
+    if (size_ < sizeof(Header)) {
+        std::cerr << "Pack: " << path << " is too short\n";
+        close();
+        return false;
+    }
+    std::memcpy(&header, base_, sizeof(header));
+    const std::uint64_t tocBytes = std::uint64_t(header.count) * sizeof(Entry);
+    if (std::memcmp(header.magic, kMagic, 4) != 0 || header.version != kVersion ||
+        header.tocOffset % kAlignment != 0 || header.tocOffset > size_ || tocBytes > size_ - header.tocOffset ||
+        header.namesOffset > size_) {
+        std::cerr << "Pack: " << path << " is not a version " << kVersion << " pack\n";
+        close();
+        return false;
+    }
+    entries_ = reinterpret_cast<const Entry*>(base_ + header.tocOffset);
+    count_ = header.count;
+    names_ = reinterpret_cast<const char*>(base_ + header.namesOffset);
+    const std::uint64_t namesBytes = size_ - header.namesOffset;
+    for (std::size_t i = 0; i < count_; ++i) {
+        const Entry& e = entries_[i];
+        const bool compressed = (e.flags & kCompressed) != 0;
+        if (e.offset > size_ || e.storedSize > size_ - e.offset || (!compressed && e.storedSize != e.size) ||
+            std::uint64_t(e.nameOffset) + e.nameLength > namesBytes || (i > 0 && entries_[i - 1].hash > e.hash)) {
+            std::cerr << "Pack: " << path << " has a damaged table of contents (entry " << i << ")\n";
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void PackFile::close() {
+    file_.close();
+    base_ = nullptr;
+    size_ = 0;
+    entries_ = nullptr;
+    count_ = 0;
+    names_ = nullptr;
+    path_.clear();
+}
+
+const PackFile::Entry* PackFile::find(const std::string& path) const {
+    const std::uint64_t hash = hashPath(path);
+    const Entry* end = entries_ + count_;
+    const Entry* it = std::lower_bound(entries_, end, hash,
+                                       [](const Entry& e, std::uint64_t h) { return e.hash < h; });
+    for (; it != end && it->hash == hash; ++it) {
+        if (it->nameLength == path.size() && std::memcmp(names_ + it->nameOffset, path.data(), path.size()) == 0) {
+            return it;
+        }
+    }
+    return nullptr;
+}
+
+const unsigned char* PackFile::data(const Entry& entry) const {
+    return (entry.flags & kCompressed) ? nullptr : base_ + entry.offset;
+}
+
+bool PackFile::read(const Entry& entry, unsigned char* out) const {
+    if (entry.flags & kCompressed) {
+        return lz4Decompress(base_ + entry.offset, entry.storedSize, out, entry.size);
+    }
+    std::memcpy(out, base_ + entry.offset, entry.size);
+    return true;
+}
+
+void PackWriter::add(const std::string& path, std::vector<unsigned char> bytes, bool compress) {
+    File file{path, std::move(bytes), 0, false};
+    file.size = static_cast<std::uint32_t>(file.stored.size());
+    if (compress && !file.stored.empty()) {
+        std::vector<unsigned char> packed;
+        lz4Compress(file.stored.data(), file.stored.size(), packed);
+        if (packed.size() + file.stored.size() / 16 <= file.stored.size()) {
+            file.stored = std::move(packed);
+            file.compressed = true;
+        }
+    }
+    files_.push_back(std::move(file));
+}
+
+bool PackWriter::write(const std::string& path, std::string* error) const {
+    std::vector<const File*> order;
+    for (const File& f : files_) order.push_back(&f);
+    std::sort(order.begin(), order.end(), [](const File* a, const File* b) {
+        return PackFile::hashPath(a->path) < PackFile::hashPath(b->path);
+    });
+
+    std::vector<unsigned char> out(sizeof(Header), 0);
+    std::vector<PackFile::Entry> toc;
+    std::string names;
+    for (const File* f : order) {
+        out.resize(alignUp(out.size()), 0);
+        PackFile::Entry e{};
+        e.hash = PackFile::hashPath(f->path);
+        e.offset = out.size();
+        e.storedSize = static_cast<std::uint32_t>(f->stored.size());
+        e.size = f->size;
+        e.nameOffset = static_cast<std::uint32_t>(names.size());
+        e.nameLength = static_cast<std::uint16_t>(f->path.size());
+        e.flags = f->compressed ? PackFile::kCompressed : 0;
+        out.insert(out.end(), f->stored.begin(), f->stored.end());
+        names += f->path;
+        toc.push_back(e);
+    }
+    out.resize(alignUp(out.size()), 0);
+    Header header{};
+    std::memcpy(header.magic, kMagic, 4);
+    header.version = kVersion;
+    header.count = static_cast<std::uint32_t>(toc.size());
+    header.tocOffset = out.size();
+    const unsigned char* tocBytes = reinterpret_cast<const unsigned char*>(toc.data());
+    out.insert(out.end(), tocBytes, tocBytes + toc.size() * sizeof(PackFile::Entry));
+    header.namesOffset = out.size();
+    out.insert(out.end(), names.begin(), names.end());
+    std::memcpy(out.data(), &header, sizeof(header));
+
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        if (error) *error = "cannot create " + path;
+        return false;
+    }
+    const bool ok = std::fwrite(out.data(), 1, out.size(), file) == out.size();
+    if (std::fclose(file) != 0 || !ok) {
+        if (error) *error = "cannot write " + path;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "core/mapped_file.h"
+
+// Pack file
+// ---------
+// Many asset files in one archive, opened once and memory-mapped: looking a file up is
+// a binary search in a table of contents, reading it is a pointer into the mapping. No
+// open()/stat()/read() per asset, and the OS pages data in on first touch.
+//
+//     | header (32 B) | entry data, each 16-byte aligned ... | TOC | names |
+//
+// | Part   | Contents                                                                 |
+// | ------ | ------------------------------------------------------------------------ |
+// | header | "PAK1", version, entry count, offsets of the TOC and the names           |
+// | TOC    | Entry × count, sorted by the path's 64-bit FNV-1a hash                   |
+// | names  | the paths, for telling apart (unlikely) hash collisions                  |
+//
+// An entry is stored as it is, or as one LZ4 block (core/lz4.h) when that saves space.
+// Stored entries can be read in place (zero copy); compressed ones decode into a buffer.
+//
+// Paths are relative and use '/', exactly as loaders ask for them: "shaders/vertex.glsl".
+// Everything is little-endian (hosts are assumed to be, like ProgramCache's files).
+class PackFile {
+public:
+    struct Entry {
+        std::uint64_t hash;
+        std::uint64_t offset;      // from the start of the file
+        std::uint32_t storedSize;  // bytes in the file
+        std::uint32_t size;        // bytes once decompressed
+        std::uint32_t nameOffset;  // into the names block
+        std::uint16_t nameLength;
+        std::uint16_t flags;       // kCompressed
+    };
+    static constexpr std::uint16_t kCompressed = 1;
+
+    PackFile() = default;
+    PackFile(const PackFile&) = delete;
+    PackFile& operator=(const PackFile&) = delete;
+    ~PackFile() { close(); }
+
+    // Maps the file and checks the header and every entry's bounds. false (and why, on
+    // stderr) if it isn't a valid pack.
+    bool open(const std::string& path);
+    void close();
+
+    const Entry* find(const std::string& path) const;
+
+    // Stored entries only: the bytes inside the mapping, valid until close().
+    const unsigned char* data(const Entry& entry) const;
+    // Any entry, decompressed if needed. false if the LZ4 block is corrupt.
+    bool read(const Entry& entry, unsigned char* out) const;
+
+    std::size_t entryCount() const { return count_; }
+    const std::string& path() const { return path_; }
+
+    static std::uint64_t hashPath(const std::string& path);
+
+private:
+    std::string path_;
+    const unsigned char* base_ = nullptr;
+    std::size_t size_ = 0;
+    const Entry* entries_ = nullptr;
+    std::size_t count_ = 0;
+    const char* names_ = nullptr;
+    MappedFile file_;                      // base_, size_: its bytes
+};
+
+// PackWriter
+// ----------
+// Builds a pack in memory (tools/pack_tool.cpp). Paths must be unique.
+class PackWriter {
+public:
+    // compress: try LZ4 and keep it if it saves at least 1/16 of the size.
+    void add(const std::string& path, std::vector<unsigned char> bytes, bool compress);
+    bool write(const std::string& path, std::string* error = nullptr) const;
+
+    std::size_t entryCount() const { return files_.size(); }
+
+private:
+    struct File {
+        std::string path;
+        std::vector<unsigned char> stored;
+        std::uint32_t size;
+        bool compressed;
+    };
+    std::vector<File> files_;
+};
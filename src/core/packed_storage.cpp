@@ -0,0 +1,236 @@
+#include "core/packed_storage.h"
+
+#include <cstring>
+
+#if defined(__F16C__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// float <-> half by integer arithmetic (F. Giesen's round-to-nearest-even conversion).
+constexpr std::uint32_t kSignBit = 0x80000000u;
+constexpr std::uint32_t kF32Infinity = 255u << 23;
+constexpr std::uint32_t kF16Overflow = (127u + 16u) << 23;           // 65536: infinity from here
+constexpr std::uint32_t kF16MinNormal = 113u << 23;                  // 2^-14
+constexpr std::uint32_t kDenormMagic = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+constexpr std::uint32_t kRebias = ((15u - 127u) << 23) + 0xfffu;     // exponent, and half of rounding
+constexpr std::uint32_t kShiftedExponent = 0x7c00u << 13;
+
+std::uint32_t bits(float f) {
+    std::uint32_t u;
+    std::memcpy(&u, &f, sizeof u);
+    return u;
+}
+
+float fromBits(std::uint32_t u) {
+    float f;
+    std::memcpy(&f, &u, sizeof f);
+    return f;
+}
+
+// As _mm_max_ps then _mm_min_ps: a NaN becomes 0 on every path.
+float clamp01(float v) {
+    const float t = v > 0.0f ? v : 0.0f;
+    return t < 1.0f ? t : 1.0f;
+}
+
+#if defined(__SSE2__)
+
+#if !defined(__F16C__)
+__m128i splat(std::uint32_t u) { return _mm_set1_epi32(static_cast<int>(u)); }
+
+__m128i select(__m128i mask, __m128i a, __m128i b) {
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+// toHalf on four lanes: the result in the low 16 bits of each.
+__m128i toHalf4(__m128 v) {
+    const __m128i sign = _mm_and_si128(_mm_castps_si128(v), splat(kSignBit));
+    const __m128i u = _mm_xor_si128(_mm_castps_si128(v), sign);      // |v|: signed compares work
+    const __m128i special = _mm_cmpgt_epi32(u, splat(kF16Overflow - 1));
+    const __m128i nan = _mm_cmpgt_epi32(u, splat(kF32Infinity));
+    const __m128i infOrNan = _mm_or_si128(splat(0x7c00u), _mm_and_si128(nan, splat(0x0200u)));
+    const __m128i subnormal = _mm_cmplt_epi32(u, splat(kF16MinNormal));
+    const __m128i aligned = _mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(u), _mm_castsi128_ps(splat(kDenormMagic))));
+    const __m128i small = _mm_sub_epi32(aligned, splat(kDenormMagic));
+    const __m128i odd = _mm_and_si128(_mm_srli_epi32(u, 13), splat(1u));
+    const __m128i normal = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(u, splat(kRebias)), odd), 13);
+    const __m128i h = select(special, infOrNan, select(subnormal, small, normal));
+    return _mm_or_si128(h, _mm_srli_epi32(sign, 16));
+}
+
+// fromHalf on four lanes, each a half in its low 16 bits. One float multiply by 2^112
+// rebiases the exponent and renormalizes the subnormals at once; infinity and NaN get
+// the all-ones exponent ORed in.
+__m128 fromHalf4(__m128i h) {
+    const __m128i magnitude = _mm_and_si128(h, splat(0x7fffu));
+    const __m128i sign = _mm_slli_epi32(_mm_xor_si128(h, magnitude), 16);
+    const __m128 scaled =
+        _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(magnitude, 13)), _mm_castsi128_ps(splat((254u - 15u) << 23)));
+    const __m128i infOrNan = _mm_and_si128(_mm_cmpgt_epi32(magnitude, splat(0x7bffu)), splat(kF32Infinity));
+    return _mm_or_ps(scaled, _mm_castsi128_ps(_mm_or_si128(sign, infOrNan)));
+}
+#endif
+
+// Eight 32-bit lanes of 16-bit values into eight 16-bit ones (SSE2 has only the signed
+// saturating pack: sign-extend first, and it packs exactly).
+__m128i narrow(__m128i lo, __m128i hi) {
+    return _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(lo, 16), 16), _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16));
+}
+
+#endif // __SSE2__
+
+} // namespace
+
+std::uint16_t toHalf(float value) {
+    std::uint32_t u = bits(value);
+    const std::uint32_t sign = u & kSignBit;
+    u ^= sign;
+    std::uint32_t h;
+    if (u >= kF16Overflow) {
+        h = u > kF32Infinity ? 0x7e00u : 0x7c00u;                    // NaN stays NaN, the rest infinity
+    } else if (u < kF16MinNormal) {
+        // Half's subnormals: the magic number lines the 10 mantissa bits up at the bottom,
+        // and the float add rounds them to nearest even.
+        h = bits(fromBits(u) + fromBits(kDenormMagic)) - kDenormMagic;
+    } else {
+        h = (u + kRebias + ((u >> 13) & 1u)) >> 13;
+    }
+    return static_cast<std::uint16_t>(h | (sign >> 16));
+}
+
+float fromHalf(std::uint16_t half) {
+    std::uint32_t o = (half & 0x7fffu) << 13;
+    const std::uint32_t exponent = o & kShiftedExponent;
+    o += (127u - 15u) << 23;
+    if (exponent == kShiftedExponent) {
+        o += (128u - 16u) << 23;                                     // infinity / NaN
+    } else if (exponent == 0) {
+        o = bits(fromBits(o + (1u << 23)) - fromBits(kF16MinNormal)); // zero / subnormal
+    }
+    return fromBits(o | (static_cast<std::uint32_t>(half & 0x8000u) << 16));
+}
+
+void packHalf(const float* in, std::size_t count, std::uint16_t* out) {
+    std::size_t i = 0;
+#if defined(__F16C__)
+    for (; i + 8 <= count; i += 8) {
+        const __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), h);
+    }
+#elif defined(__SSE2__)
+    for (; i + 8 <= count; i += 8) {
+        const __m128i h = narrow(toHalf4(_mm_loadu_ps(in + i)), toHalf4(_mm_loadu_ps(in + i + 4)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), h);
+    }
+#endif
+    for (; i < count; ++i) {
+        out[i] = toHalf(in[i]);
+    }
+}
+
+void unpackHalf(const std::uint16_t* in, std::size_t count, float* out) {
+    std::size_t i = 0;
+#if defined(__F16C__)
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(out + i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i))));
+    }
+#elif defined(__SSE2__)
+    for (; i + 8 <= count; i += 8) {
+        const __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        _mm_storeu_ps(out + i, fromHalf4(_mm_unpacklo_epi16(h, _mm_setzero_si128())));
+        _mm_storeu_ps(out + i + 4, fromHalf4(_mm_unpackhi_epi16(h, _mm_setzero_si128())));
+    }
+#endif
+    for (; i < count; ++i) {
+        out[i] = fromHalf(in[i]);
+    }
+}
+
+// The same operations in the same order on every path, so they round alike: the scale
+// first, the clamp, then +0.5 and truncation.
+void packUnorm16(const float* in, std::size_t count, float lo, float hi, std::uint16_t* out) {
+    const float scale = hi > lo ? 1.0f / (hi - lo) : 0.0f;
+    std::size_t i = 0;
+#if defined(__SSE2__)
+    const __m128 vlo = _mm_set1_ps(lo), vscale = _mm_set1_ps(scale);
+    const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+    const __m128 max = _mm_set1_ps(65535.0f), half = _mm_set1_ps(0.5f);
+    auto quantize = [&](__m128 v) {
+        const __m128 t = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_sub_ps(v, vlo), vscale), zero), one);
+        return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(t, max), half));
+    };
+    for (; i + 8 <= count; i += 8) {
+        const __m128i q = narrow(quantize(_mm_loadu_ps(in + i)), quantize(_mm_loadu_ps(in + i + 4)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), q);
+    }
+#endif
+    for (; i < count; ++i) {
+        const float t = clamp01((in[i] - lo) * scale);
+        out[i] = static_cast<std::uint16_t>(t * 65535.0f + 0.5f);
+    }
+}
+
+void unpackUnorm16(const std::uint16_t* in, std::size_t count, float lo, float hi, float* out) {
+    const float step = (hi - lo) / 65535.0f;
+    std::size_t i = 0;
+#if defined(__SSE2__)
+    const __m128 vlo = _mm_set1_ps(lo), vstep = _mm_set1_ps(step);
+    for (; i + 8 <= count; i += 8) {
+        const __m128i q = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        const __m128 q0 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(q, _mm_setzero_si128()));
+        const __m128 q1 = _mm_cvtepi32_ps(_mm_unpackhi_epi16(q, _mm_setzero_si128()));
+        _mm_storeu_ps(out + i, _mm_add_ps(vlo, _mm_mul_ps(q0, vstep)));
+        _mm_storeu_ps(out + i + 4, _mm_add_ps(vlo, _mm_mul_ps(q1, vstep)));
+    }
+#endif
+    for (; i < count; ++i) {
+        out[i] = lo + static_cast<float>(in[i]) * step;
+    }
+}
+
+void packRgba8(const float* r, const float* g, const float* b, const float* a, std::size_t count, std::uint32_t* out) {
+    std::size_t i = 0;
+#if defined(__SSE2__)
+    const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+    const __m128 max = _mm_set1_ps(255.0f), half = _mm_set1_ps(0.5f);
+    auto quantize = [&](const float* c) {
+        const __m128 t = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(c), zero), one);
+        return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(t, max), half));
+    };
+    for (; i + 4 <= count; i += 4) {
+        const __m128i rg = _mm_or_si128(quantize(r + i), _mm_slli_epi32(quantize(g + i), 8));
+        const __m128i ba = _mm_or_si128(_mm_slli_epi32(quantize(b + i), 16), _mm_slli_epi32(quantize(a + i), 24));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_or_si128(rg, ba));
+    }
+#endif
+    for (; i < count; ++i) {
+        auto quantize = [](float c) { return static_cast<std::uint32_t>(clamp01(c) * 255.0f + 0.5f); };
+        out[i] = quantize(r[i]) | quantize(g[i]) << 8 | quantize(b[i]) << 16 | quantize(a[i]) << 24;
+    }
+}
+
+void unpackRgba8(const std::uint32_t* in, std::size_t count, float* r, float* g, float* b, float* a) {
+    constexpr float kScale = 1.0f / 255.0f;
+    std::size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i mask = _mm_set1_epi32(0xff);
+    const __m128 scale = _mm_set1_ps(kScale);
+    for (; i + 4 <= count; i += 4) {
+        const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        _mm_storeu_ps(r + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(c, mask)), scale));
+        _mm_storeu_ps(g + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(c, 8), mask)), scale));
+        _mm_storeu_ps(b + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(c, 16), mask)), scale));
+        _mm_storeu_ps(a + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(c, 24)), scale));
+    }
+#endif
+    for (; i < count; ++i) {
+        r[i] = static_cast<float>(in[i] & 0xffu) * kScale;
+        g[i] = static_cast<float>(in[i] >> 8 & 0xffu) * kScale;
+        b[i] = static_cast<float>(in[i] >> 16 & 0xffu) * kScale;
+        a[i] = static_cast<float>(in[i] >> 24) * kScale;
+    }
+}
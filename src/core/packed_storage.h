@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Packed storage
+// --------------
+// Narrow encodings for big, COLD arrays: what a world keeps per entity for millions of
+// them but reads rarely, or in one streaming pass (rest positions, colours, animation
+// parameters), where memory and bandwidth cost more than the few cycles to decode.
+// glm/gtc/packing.hpp converts one value at a time; these convert whole arrays:
+//
+// | Encoding | Bytes | Of                          | Error                  | Functions        |
+// | -------- | ----- | --------------------------- | ---------------------- | ---------------- |
+// | half     | 2     | any float (IEEE binary16)   | 2^-11 relative, under  | packHalf,        |
+// |          |       |                             | 65520 (over: infinity) | unpackHalf       |
+// | unorm16  | 2     | a float in [lo, hi]         | (hi - lo) / 131070     | packUnorm16,     |
+// |          |       |                             |                        | unpackUnorm16    |
+// | RGBA8    | 4     | four [0, 1] channels, as    | 1 / 510                | packRgba8,       |
+// |          |       | packColor (0xAABBGGRR)      |                        | unpackRgba8      |
+//
+// Positions want unorm16 over the world's bounds, not half: half's step grows with the
+// value (1/64 of a unit at 16), unorm16's is the same everywhere (32 / 65535 for a world
+// 32 units across). Half suits values near a known scale: rates, phases, scales.
+//
+// | Build              | Per iteration                                                   |
+// | ------------------ | --------------------------------------------------------------- |
+// | __F16C__ (-mf16c)  | half: 8 values, one vcvtps2ph / vcvtph2ps                       |
+// | __SSE2__           | half: 8 values, the scalar code's bit manipulation in 32-bit    |
+// |                    | lanes; unorm16 and RGBA8: 8 and 4 values (every x86-64 build)   |
+// | otherwise          | 1                                                               |
+//
+// Every path gives the same bits: half rounds to nearest even (as F16C and GPUs do) and
+// goes through half's subnormals to zero; a NaN stays a NaN (its payload may not). The
+// arrays needn't be aligned; `in` and `out` must not overlap.
+
+void packHalf(const float* in, std::size_t count, std::uint16_t* out);
+void unpackHalf(const std::uint16_t* in, std::size_t count, float* out);
+std::uint16_t toHalf(float value);
+float fromHalf(std::uint16_t half);
+
+// Outside [lo, hi] clamps to it.
+void packUnorm16(const float* in, std::size_t count, float lo, float hi, std::uint16_t* out);
+void unpackUnorm16(const std::uint16_t* in, std::size_t count, float lo, float hi, float* out);
+
+// Four channel arrays into one array of colours, and back.
+void packRgba8(const float* r, const float* g, const float* b, const float* a, std::size_t count, std::uint32_t* out);
+void unpackRgba8(const std::uint32_t* in, std::size_t count, float* r, float* g, float* b, float* a);
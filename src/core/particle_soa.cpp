@@ -0,0 +1,204 @@
+#include "core/particle_soa.h"
+
+#include <cmath>
+#include <cstring>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#include <xmmintrin.h>
+#endif
+
+#include "core/job_system.h"
+
+void ParticlesSoA::reset(std::size_t count, float emitSeconds) {
+    x.assign(count, 0.0f);
+    y.assign(count, 0.0f);
+    vx.assign(count, 0.0f);
+    vy.assign(count, 0.0f);
+    lifetime.assign(count, 1.0f);
+    age.resize(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        age[i] = -static_cast<float>(i + 1) / static_cast<float>(count) * emitSeconds;
+    }
+}
+
+namespace {
+
+// lowbias32, advanced per call: [0, 1). Bit for bit the shader's random().
+float random(std::uint32_t& state) {
+    state ^= state >> 16;
+    state *= 0x7feb352du;
+    state ^= state >> 15;
+    state *= 0x846ca68bu;
+    state ^= state >> 16;
+    return static_cast<float>(state >> 8) * (1.0f / 16777216.0f);
+}
+
+float mix(float a, float b, float t) { return a + (b - a) * t; }
+
+// Starts particle i over at the emitter, seeded like the shader (gl_VertexID = i).
+void respawn(ParticlesSoA& p, std::size_t i, const ParticleStep& step) {
+    std::uint32_t timeBits;
+    std::memcpy(&timeBits, &step.time, sizeof timeBits);
+    std::uint32_t seed = static_cast<std::uint32_t>(i) * 747796405u + timeBits;
+    const float angle = random(seed) * 6.2831853f;
+    const float speed = mix(0.2f, 1.0f, random(seed));
+    p.x[i] = step.emitter.x;
+    p.y[i] = step.emitter.y;
+    p.vx[i] = std::cos(angle) * speed;
+    p.vy[i] = std::sin(angle) * speed;
+    p.lifetime[i] = mix(0.8f, 2.0f, random(seed));
+    p.age[i] = 0.0f;
+}
+
+void simulateScalar(ParticlesSoA& p, std::size_t begin, std::size_t end, const ParticleStep& step,
+                    ParticleInstance* out) {
+    for (std::size_t i = begin; i < end; ++i) {
+        const float previous = p.age[i];
+        const float age = previous + step.dt;
+        if (age >= p.lifetime[i] || (previous < 0.0f && age >= 0.0f)) {
+            respawn(p, i, step);
+        } else {
+            p.age[i] = age;
+            if (age >= 0.0f) {
+                p.vx[i] += step.gravity.x * step.dt;
+                p.vy[i] += step.gravity.y * step.dt;
+                p.x[i] += p.vx[i] * step.dt;
+                p.y[i] += p.vy[i] * step.dt;
+            }
+        }
+        *out++ = ParticleInstance{glm::vec2(p.x[i], p.y[i]), p.age[i], p.lifetime[i]};
+    }
+}
+
+#if defined(__SSE2__)
+
+// x, y, age, lifetime of 4 particles (one register each) -> 4 interleaved instances.
+inline void storeInstances4(__m128 x, __m128 y, __m128 age, __m128 life, ParticleInstance* out) {
+    _MM_TRANSPOSE4_PS(x, y, age, life);
+    float* dst = reinterpret_cast<float*>(out);
+    _mm_storeu_ps(dst + 0, x);
+    _mm_storeu_ps(dst + 4, y);
+    _mm_storeu_ps(dst + 8, age);
+    _mm_storeu_ps(dst + 12, life);
+}
+
+#endif
+
+#if defined(__AVX__)
+
+// 8 particles per iteration: the update in 256-bit registers, the output as two 4x4
+// transposes of the low and high halves.
+std::size_t simulateWide(ParticlesSoA& p, std::size_t begin, std::size_t end, const ParticleStep& step,
+                         ParticleInstance* out) {
+    const __m256 dt = _mm256_set1_ps(step.dt);
+    const __m256 gdx = _mm256_set1_ps(step.gravity.x * step.dt);
+    const __m256 gdy = _mm256_set1_ps(step.gravity.y * step.dt);
+    const __m256 zero = _mm256_setzero_ps();
+    std::size_t i = begin;
+    for (; i + 8 <= end; i += 8, out += 8) {
+        const __m256 previous = _mm256_loadu_ps(&p.age[i]);
+        const __m256 age = _mm256_add_ps(previous, dt);
+        const __m256 life = _mm256_loadu_ps(&p.lifetime[i]);
+        const __m256 emitted = _mm256_cmp_ps(age, zero, _CMP_GE_OQ);
+        // Unemitted lanes add 0 (the mask clears the step).
+        const __m256 vx = _mm256_add_ps(_mm256_loadu_ps(&p.vx[i]), _mm256_and_ps(emitted, gdx));
+        const __m256 vy = _mm256_add_ps(_mm256_loadu_ps(&p.vy[i]), _mm256_and_ps(emitted, gdy));
+        const __m256 x = _mm256_add_ps(_mm256_loadu_ps(&p.x[i]), _mm256_and_ps(emitted, _mm256_mul_ps(vx, dt)));
+        const __m256 y = _mm256_add_ps(_mm256_loadu_ps(&p.y[i]), _mm256_and_ps(emitted, _mm256_mul_ps(vy, dt)));
+        _mm256_storeu_ps(&p.vx[i], vx);
+        _mm256_storeu_ps(&p.vy[i], vy);
+        _mm256_storeu_ps(&p.x[i], x);
+        _mm256_storeu_ps(&p.y[i], y);
+        _mm256_storeu_ps(&p.age[i], age);
+
+        const __m256 dead = _mm256_or_ps(_mm256_cmp_ps(age, life, _CMP_GE_OQ),
+                                         _mm256_and_ps(_mm256_cmp_ps(previous, zero, _CMP_LT_OQ), emitted));
+        int mask = _mm256_movemask_ps(dead);
+        if (mask == 0) {
+            storeInstances4(_mm256_castps256_ps128(x), _mm256_castps256_ps128(y),
+                            _mm256_castps256_ps128(age), _mm256_castps256_ps128(life), out);
+            storeInstances4(_mm256_extractf128_ps(x, 1), _mm256_extractf128_ps(y, 1),
+                            _mm256_extractf128_ps(age, 1), _mm256_extractf128_ps(life, 1), out + 4);
+            continue;
+        }
+        for (std::size_t lane = 0; mask != 0; ++lane, mask >>= 1) {
+            if (mask & 1) {
+                respawn(p, i + lane, step);
+            }
+        }
+        for (std::size_t half = 0; half < 8; half += 4) {
+            storeInstances4(_mm_loadu_ps(&p.x[i + half]), _mm_loadu_ps(&p.y[i + half]),
+                            _mm_loadu_ps(&p.age[i + half]), _mm_loadu_ps(&p.lifetime[i + half]), out + half);
+        }
+    }
+    return i;
+}
+
+#elif defined(__SSE2__)
+
+std::size_t simulateWide(ParticlesSoA& p, std::size_t begin, std::size_t end, const ParticleStep& step,
+                         ParticleInstance* out) {
+    const __m128 dt = _mm_set1_ps(step.dt);
+    const __m128 gdx = _mm_set1_ps(step.gravity.x * step.dt);
+    const __m128 gdy = _mm_set1_ps(step.gravity.y * step.dt);
+    const __m128 zero = _mm_setzero_ps();
+    std::size_t i = begin;
+    for (; i + 4 <= end; i += 4, out += 4) {
+        const __m128 previous = _mm_loadu_ps(&p.age[i]);
+        const __m128 age = _mm_add_ps(previous, dt);
+        const __m128 life = _mm_loadu_ps(&p.lifetime[i]);
+        const __m128 emitted = _mm_cmpge_ps(age, zero);
+        // Unemitted lanes add 0 (the mask clears the step).
+        const __m128 vx = _mm_add_ps(_mm_loadu_ps(&p.vx[i]), _mm_and_ps(emitted, gdx));
+        const __m128 vy = _mm_add_ps(_mm_loadu_ps(&p.vy[i]), _mm_and_ps(emitted, gdy));
+        const __m128 x = _mm_add_ps(_mm_loadu_ps(&p.x[i]), _mm_and_ps(emitted, _mm_mul_ps(vx, dt)));
+        const __m128 y = _mm_add_ps(_mm_loadu_ps(&p.y[i]), _mm_and_ps(emitted, _mm_mul_ps(vy, dt)));
+        _mm_storeu_ps(&p.vx[i], vx);
+        _mm_storeu_ps(&p.vy[i], vy);
+        _mm_storeu_ps(&p.x[i], x);
+        _mm_storeu_ps(&p.y[i], y);
+        _mm_storeu_ps(&p.age[i], age);
+
+        const __m128 dead = _mm_or_ps(_mm_cmpge_ps(age, life),
+                                      _mm_and_ps(_mm_cmplt_ps(previous, zero), emitted));
+        int mask = _mm_movemask_ps(dead);
+        if (mask == 0) {
+            storeInstances4(x, y, age, life, out);
+            continue;
+        }
+        for (std::size_t lane = 0; mask != 0; ++lane, mask >>= 1) {
+            if (mask & 1) {
+                respawn(p, i + lane, step);
+            }
+        }
+        storeInstances4(_mm_loadu_ps(&p.x[i]), _mm_loadu_ps(&p.y[i]),
+                        _mm_loadu_ps(&p.age[i]), _mm_loadu_ps(&p.lifetime[i]), out);
+    }
+    return i;
+}
+
+#endif
+
+} // namespace
+
+void simulateParticles(ParticlesSoA& particles, std::size_t first, std::size_t count,
+                       const ParticleStep& step, ParticleInstance* out) {
+    const std::size_t end = first + count;
+    std::size_t i = first;
+#if defined(__SSE2__)
+    i = simulateWide(particles, first, end, step, out);
+#endif
+    simulateScalar(particles, i, end, step, out + (i - first));
+}
+
+void simulateParticlesParallel(JobSystem& jobs, ParticlesSoA& particles, const ParticleStep& step,
+                               ParticleInstance* out, std::size_t grain) {
+    // Whole vectors per job, so only the very last one has a scalar tail.
+    grain = (grain + 7) & ~static_cast<std::size_t>(7);
+    jobs.parallelFor(particles.size(), grain, [&](std::size_t begin, std::size_t end) {
+        simulateParticles(particles, begin, end - begin, step, out + begin);
+    });
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "core/aligned_math.h"
+
+class JobSystem;
+
+// ParticlesSoA
+// ------------
+// The CPU twin of ParticleSystem (render/particle_system.h): the same particles and the
+// same update rule as shaders/particle_update.glsl, for drivers where transform feedback
+// is slow or missing. One array per field, like Transforms2D (core/batch_transform.h), so
+// one 16- or 32-byte load is 4 or 8 particles' x:
+//
+//     x  x  x  x ... | y  y  y  y ... | vx vx ... | vy vy ... | age ... | lifetime ...
+struct ParticlesSoA {
+    AlignedVector<float> x, y;
+    AlignedVector<float> vx, vy;
+    AlignedVector<float> age;             // seconds; negative: not emitted yet
+    AlignedVector<float> lifetime;
+
+    std::size_t size() const { return x.size(); }
+    // Everything waits at the origin with a staggered negative age, as ParticleSystem::init
+    // does: the first particles are emitted on the first step, the last emitSeconds later.
+    void reset(std::size_t count, float emitSeconds = 2.0f);
+};
+
+// What the PARTICLES variant of shaders/vertex.glsl reads per instance. 16 bytes, the
+// part of a particle the picture needs (InstancedQuadRenderer::Format::Particle).
+struct ParticleInstance {
+    glm::vec2 position;
+    float age;
+    float lifetime;
+};
+static_assert(sizeof(ParticleInstance) == 16, "ParticleInstance must stay tightly packed (vertex attribute stride)");
+
+struct ParticleStep {
+    float dt = 0.0f;
+    float time = 0.0f;                  // seeds the respawns (the shader's uTime)
+    glm::vec2 emitter{0.0f};
+    glm::vec2 gravity{0.0f, -0.6f};
+};
+
+// simulateParticles
+// -----------------
+// One step for particles [first, first + count), then their instances into
+// out[0 .. count):
+//
+//     age += dt
+//     dead, or due for its first emission:  respawn at the emitter (hashed like the shader)
+//     else if emitted:                      v += gravity * dt, p += v * dt
+//
+// | Build       | Particles per iteration | Instances written as                      |
+// | ----------- | ----------------------- | ----------------------------------------- |
+// | __AVX__     | 8 (256-bit)             | two 4x4 transposes -> 8 x 16 bytes        |
+// | __SSE2__    | 4 (every x86-64 CPU)    | one 4x4 transpose  -> 4 x 16 bytes        |
+// | otherwise   | 1                       | field by field                            |
+//
+// Integration is branch-free (a mask instead of `if (age >= 0)`); respawns are rare
+// (about one particle in lifetime / dt per step), so the few lanes that need one go
+// through the scalar hash. Like composeModelMatrices, `out` is written once, front to
+// back, and never read: it may be mapped (write-combined) GPU memory.
+void simulateParticles(ParticlesSoA& particles, std::size_t first, std::size_t count,
+                       const ParticleStep& step, ParticleInstance* out);
+
+// The same over every particle, split across the job system's threads (out[0 .. size)).
+// Each job owns a disjoint range of the arrays and of `out`, so nothing is shared.
+void simulateParticlesParallel(JobSystem& jobs, ParticlesSoA& particles, const ParticleStep& step,
+                               ParticleInstance* out, std::size_t grain = 4096);
@@ -0,0 +1,417 @@
+#include "core/path_grid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace {
+
+constexpr std::uint32_t kNoPath = 0xffffffffu;
+constexpr int kClusterArea = PathGrid::kClusterTiles * PathGrid::kClusterTiles;
+static_assert(kClusterArea <= 65536, "tile parents are 16-bit local indices");
+
+// The 8 steps, straights first.
+constexpr int kStepX[8] = {1, -1, 0, 0, 1, 1, -1, -1};
+constexpr int kStepY[8] = {0, 0, 1, -1, 1, -1, 1, -1};
+
+std::uint32_t octile(glm::ivec2 a, glm::ivec2 b) {
+    const int dx = std::abs(a.x - b.x);
+    const int dy = std::abs(a.y - b.y);
+    const int diagonal = std::min(dx, dy);
+    return static_cast<std::uint32_t>(PathGrid::kDiagonal * diagonal + PathGrid::kStraight * (dx + dy - 2 * diagonal));
+}
+
+// Min-heap on f over Scratch::open.
+bool later(const PathGrid::Scratch::Open& a, const PathGrid::Scratch::Open& b) {
+    return a.f > b.f;
+}
+
+} // namespace
+
+bool PathGrid::init(const Options& options) {
+    if (options.width <= 0 || options.height <= 0 || options.tileSize <= 0.0f) {
+        std::cerr << "PathGrid: invalid size " << options.width << "x" << options.height << "\n";
+        return false;
+    }
+    options_ = options;
+    clustersX_ = (options.width + kClusterTiles - 1) / kClusterTiles;
+    clustersY_ = (options.height + kClusterTiles - 1) / kClusterTiles;
+    layers_.assign(static_cast<std::size_t>(options.width) * options.height, 0);
+    clusters_.assign(static_cast<std::size_t>(clustersX_) * clustersY_, Cluster{});
+    dirty_.clear();
+    for (int c = 0; c < static_cast<int>(clusters_.size()); ++c) {
+        clusters_[c].dirty = true;
+        dirty_.push_back(c);
+    }
+    stats_ = Stats{};
+    stats_.clusters = clusters_.size();
+    rebuild();
+    return true;
+}
+
+void PathGrid::setTile(int layer, int x, int y, bool occupied) {
+    if (layer < 0 || layer >= 8 || x < 0 || x >= options_.width || y < 0 || y >= options_.height) {
+        return;
+    }
+    std::uint8_t& bits = layers_[static_cast<std::size_t>(y) * options_.width + x];
+    const bool before = bits != 0;
+    const std::uint8_t bit = static_cast<std::uint8_t>(1u << layer);
+    bits = occupied ? static_cast<std::uint8_t>(bits | bit) : static_cast<std::uint8_t>(bits & ~bit);
+    if ((bits != 0) == before) {
+        return;
+    }
+    // Its own cluster's paths change; a border tile also changes the entrances, which the
+    // cluster across shares.
+    auto mark = [this](int cx, int cy) {
+        if (cx < 0 || cx >= clustersX_ || cy < 0 || cy >= clustersY_) {
+            return;
+        }
+        Cluster& c = clusters_[static_cast<std::size_t>(cy) * clustersX_ + cx];
+        if (!c.dirty) {
+            c.dirty = true;
+            dirty_.push_back(cy * clustersX_ + cx);
+        }
+    };
+    const int cx = x / kClusterTiles;
+    const int cy = y / kClusterTiles;
+    mark(cx, cy);
+    if (x % kClusterTiles == 0) mark(cx - 1, cy);
+    if (x % kClusterTiles == kClusterTiles - 1) mark(cx + 1, cy);
+    if (y % kClusterTiles == 0) mark(cx, cy - 1);
+    if (y % kClusterTiles == kClusterTiles - 1) mark(cx, cy + 1);
+}
+
+bool PathGrid::blocked(int x, int y) const {
+    return layers_[static_cast<std::size_t>(y) * options_.width + x] != 0;
+}
+
+void PathGrid::rebuild() {
+    for (const int c : dirty_) {
+        rebuildCluster(c, rebuildScratch_);
+        clusters_[c].dirty = false;
+    }
+    stats_.rebuilds += dirty_.size();
+    dirty_.clear();
+}
+
+bool PathGrid::tileAt(const glm::vec2& world, int& x, int& y) const {
+    const glm::vec2 t = glm::floor((world - options_.origin) / options_.tileSize);
+    if (t.x < 0.0f || t.y < 0.0f || t.x >= static_cast<float>(options_.width) ||
+        t.y >= static_cast<float>(options_.height)) {
+        return false;
+    }
+    x = static_cast<int>(t.x);
+    y = static_cast<int>(t.y);
+    return true;
+}
+
+glm::vec2 PathGrid::center(int x, int y) const {
+    return options_.origin + (glm::vec2(static_cast<float>(x), static_cast<float>(y)) + 0.5f) * options_.tileSize;
+}
+
+void PathGrid::clusterRect(int cluster, int& x0, int& y0, int& x1, int& y1) const {
+    x0 = cluster % clustersX_ * kClusterTiles;
+    y0 = cluster / clustersX_ * kClusterTiles;
+    x1 = std::min(options_.width, x0 + kClusterTiles);
+    y1 = std::min(options_.height, y0 + kClusterTiles);
+}
+
+// Both clusters of a border scan it the same way (increasing coordinate), so they find
+// the same runs and the same transitions, each from its own side.
+void PathGrid::addEntrances(int cluster, int neighbour, bool vertical, std::vector<Node>& out) const {
+    int x0, y0, x1, y1;
+    clusterRect(cluster, x0, y0, x1, y1);
+    const int width = options_.width;
+    int inside, across, first, last;
+    if (vertical) {                            // neighbour left or right: a column
+        const bool right = neighbour == cluster + 1;
+        inside = right ? x1 - 1 : x0;
+        across = right ? x1 : x0 - 1;
+        first = y0;
+        last = y1;
+    } else {                                   // below or above: a row
+        const bool above = neighbour == cluster + clustersX_;
+        inside = above ? y1 - 1 : y0;
+        across = above ? y1 : y0 - 1;
+        first = x0;
+        last = x1;
+    }
+    auto tileOf = [&](int line, int i) {
+        return vertical ? static_cast<std::uint32_t>(i * width + line) : static_cast<std::uint32_t>(line * width + i);
+    };
+    auto open = [&](int i) {
+        return layers_[tileOf(inside, i)] == 0 && layers_[tileOf(across, i)] == 0;
+    };
+    for (int i = first; i < last;) {
+        if (!open(i)) {
+            ++i;
+            continue;
+        }
+        int end = i + 1;
+        while (end < last && open(end)) {
+            ++end;
+        }
+        if (end - i >= kLongEntrance) {
+            out.push_back(Node{tileOf(inside, i), tileOf(across, i)});
+            out.push_back(Node{tileOf(inside, end - 1), tileOf(across, end - 1)});
+        } else {
+            const int mid = (i + end - 1) / 2;
+            out.push_back(Node{tileOf(inside, mid), tileOf(across, mid)});
+        }
+        i = end;
+    }
+}
+
+void PathGrid::rebuildCluster(int cluster, Scratch& scratch) {
+    Cluster& c = clusters_[cluster];
+    stats_.nodes -= c.nodes.size();
+    c.nodes.clear();
+    const int cx = cluster % clustersX_;
+    const int cy = cluster / clustersX_;
+    if (cx > 0) addEntrances(cluster, cluster - 1, true, c.nodes);
+    if (cx + 1 < clustersX_) addEntrances(cluster, cluster + 1, true, c.nodes);
+    if (cy > 0) addEntrances(cluster, cluster - clustersX_, false, c.nodes);
+    if (cy + 1 < clustersY_) addEntrances(cluster, cluster + clustersX_, false, c.nodes);
+    stats_.nodes += c.nodes.size();
+
+    // Every node to every other, inside the cluster: one Dijkstra per node.
+    const std::size_t n = c.nodes.size();
+    c.cost.assign(n * n, kNoPath);
+    const int width = options_.width;
+    for (std::size_t i = 0; i < n; ++i) {
+        const glm::ivec2 from(static_cast<int>(c.nodes[i].tile) % width, static_cast<int>(c.nodes[i].tile) / width);
+        searchCluster(cluster, from, nullptr, scratch);
+        for (std::size_t j = 0; j < n; ++j) {
+            const glm::ivec2 to(static_cast<int>(c.nodes[j].tile) % width, static_cast<int>(c.nodes[j].tile) / width);
+            c.cost[i * n + j] = costAt(cluster, to, scratch);
+        }
+    }
+}
+
+std::uint32_t PathGrid::searchCluster(int cluster, glm::ivec2 from, const glm::ivec2* to, Scratch& scratch) const {
+    int x0, y0, x1, y1;
+    clusterRect(cluster, x0, y0, x1, y1);
+    if (scratch.tileCost.size() != static_cast<std::size_t>(kClusterArea)) {
+        scratch.tileCost.assign(kClusterArea, kNoPath);
+        scratch.tileParent.assign(kClusterArea, 0);
+        scratch.tileStamp.assign(kClusterArea, 0);
+    }
+    if (++scratch.tileEpoch == 0) {            // wrapped: every stamp is stale again
+        std::fill(scratch.tileStamp.begin(), scratch.tileStamp.end(), 0u);
+        scratch.tileEpoch = 1;
+    }
+    const std::uint32_t epoch = scratch.tileEpoch;
+    auto local = [&](int x, int y) { return static_cast<std::uint32_t>((y - y0) * kClusterTiles + (x - x0)); };
+    auto heuristic = [&](int x, int y) { return to ? octile(glm::ivec2(x, y), *to) : 0u; };
+
+    const std::uint32_t start = local(from.x, from.y);
+    scratch.tileStamp[start] = epoch;
+    scratch.tileCost[start] = 0;
+    scratch.tileParent[start] = static_cast<std::uint16_t>(start);
+    scratch.open.clear();
+    scratch.open.push_back(Scratch::Open{heuristic(from.x, from.y), start});
+    while (!scratch.open.empty()) {
+        std::pop_heap(scratch.open.begin(), scratch.open.end(), later);
+        const Scratch::Open top = scratch.open.back();
+        scratch.open.pop_back();
+        const int x = x0 + static_cast<int>(top.id) % kClusterTiles;
+        const int y = y0 + static_cast<int>(top.id) / kClusterTiles;
+        const std::uint32_t g = scratch.tileCost[top.id];
+        if (g + heuristic(x, y) < top.f) {
+            continue;                          // a cheaper way got here since
+        }
+        if (to && x == to->x && y == to->y) {
+            return g;
+        }
+        for (int d = 0; d < 8; ++d) {
+            const int nx = x + kStepX[d];
+            const int ny = y + kStepY[d];
+            if (nx < x0 || nx >= x1 || ny < y0 || ny >= y1 || blocked(nx, ny)) {
+                continue;
+            }
+            if (d >= 4 && (blocked(nx, y) || blocked(x, ny))) {
+                continue;                      // no cutting a blocked corner
+            }
+            const std::uint32_t cost = g + (d < 4 ? kStraight : kDiagonal);
+            const std::uint32_t n = local(nx, ny);
+            if (scratch.tileStamp[n] == epoch && scratch.tileCost[n] <= cost) {
+                continue;
+            }
+            scratch.tileStamp[n] = epoch;
+            scratch.tileCost[n] = cost;
+            scratch.tileParent[n] = static_cast<std::uint16_t>(top.id);
+            scratch.open.push_back(Scratch::Open{cost + heuristic(nx, ny), n});
+            std::push_heap(scratch.open.begin(), scratch.open.end(), later);
+        }
+    }
+    return kNoPath;
+}
+
+std::uint32_t PathGrid::costAt(int cluster, glm::ivec2 tile, const Scratch& scratch) const {
+    int x0, y0, x1, y1;
+    clusterRect(cluster, x0, y0, x1, y1);
+    const std::uint32_t n = static_cast<std::uint32_t>((tile.y - y0) * kClusterTiles + (tile.x - x0));
+    return scratch.tileStamp[n] == scratch.tileEpoch ? scratch.tileCost[n] : kNoPath;
+}
+
+void PathGrid::tracePath(int cluster, glm::ivec2 from, glm::ivec2 to, Scratch& scratch,
+                         std::vector<glm::ivec2>& out) const {
+    int x0, y0, x1, y1;
+    clusterRect(cluster, x0, y0, x1, y1);
+    const std::uint32_t start = static_cast<std::uint32_t>((from.y - y0) * kClusterTiles + (from.x - x0));
+    std::uint32_t n = static_cast<std::uint32_t>((to.y - y0) * kClusterTiles + (to.x - x0));
+    scratch.segment.clear();
+    while (n != start) {
+        scratch.segment.push_back(glm::ivec2(x0 + static_cast<int>(n) % kClusterTiles,
+                                             y0 + static_cast<int>(n) / kClusterTiles));
+        n = scratch.tileParent[n];
+    }
+    out.insert(out.end(), scratch.segment.rbegin(), scratch.segment.rend());
+}
+
+int PathGrid::findNode(int cluster, std::uint32_t tile, std::uint32_t partner) const {
+    const std::vector<Node>& nodes = clusters_[cluster].nodes;
+    for (std::size_t k = 0; k < nodes.size(); ++k) {
+        if (nodes[k].tile == tile && nodes[k].partner == partner) {
+            return static_cast<int>(k);
+        }
+    }
+    return -1;
+}
+
+bool PathGrid::findPath(glm::ivec2 from, glm::ivec2 to, Scratch& scratch, std::vector<glm::ivec2>& out) const {
+    auto inside = [this](glm::ivec2 t) { return t.x >= 0 && t.x < options_.width && t.y >= 0 && t.y < options_.height; };
+    if (!inside(from) || !inside(to) || blocked(from.x, from.y) || blocked(to.x, to.y)) {
+        return false;
+    }
+    const int startCluster = clusterOf(from.x, from.y);
+    const int goalCluster = clusterOf(to.x, to.y);
+    if (from == to) {
+        out.push_back(from);
+        return true;
+    }
+    if (startCluster == goalCluster && searchCluster(startCluster, from, &to, scratch) != kNoPath) {
+        out.push_back(from);
+        tracePath(startCluster, from, to, scratch, out);
+        return true;
+    }
+
+    // Start and goal into the graph: their costs to their clusters' nodes.
+    const int width = options_.width;
+    auto tileXY = [width](std::uint32_t tile) {
+        return glm::ivec2(static_cast<int>(tile) % width, static_cast<int>(tile) / width);
+    };
+    const Cluster& sc = clusters_[startCluster];
+    const Cluster& gc = clusters_[goalCluster];
+    searchCluster(startCluster, from, nullptr, scratch);
+    scratch.startCost.resize(sc.nodes.size());
+    for (std::size_t j = 0; j < sc.nodes.size(); ++j) {
+        scratch.startCost[j] = costAt(startCluster, tileXY(sc.nodes[j].tile), scratch);
+    }
+    searchCluster(goalCluster, to, nullptr, scratch);
+    scratch.goalCost.resize(gc.nodes.size());
+    for (std::size_t j = 0; j < gc.nodes.size(); ++j) {
+        scratch.goalCost[j] = costAt(goalCluster, tileXY(gc.nodes[j].tile), scratch);
+    }
+
+    // A* over the nodes: id cluster * kMaxNodes + k; the start and the goal after them.
+    const std::uint32_t startId = static_cast<std::uint32_t>(clusters_.size() * kMaxNodes);
+    const std::uint32_t goalId = startId + 1;
+    if (scratch.nodeCost.size() != startId + 2) {
+        scratch.nodeCost.assign(startId + 2, kNoPath);
+        scratch.nodeParent.assign(startId + 2, 0);
+        scratch.nodeStamp.assign(startId + 2, 0);
+        scratch.nodeEpoch = 0;
+    }
+    if (++scratch.nodeEpoch == 0) {
+        std::fill(scratch.nodeStamp.begin(), scratch.nodeStamp.end(), 0u);
+        scratch.nodeEpoch = 1;
+    }
+    const std::uint32_t epoch = scratch.nodeEpoch;
+    auto tileOfId = [&](std::uint32_t id) {
+        if (id == startId) return from;
+        if (id == goalId) return to;
+        return tileXY(clusters_[id / kMaxNodes].nodes[id % kMaxNodes].tile);
+    };
+    scratch.open.clear();
+    auto relax = [&](std::uint32_t id, std::uint32_t parent, std::uint32_t cost) {
+        if (scratch.nodeStamp[id] == epoch && scratch.nodeCost[id] <= cost) {
+            return;
+        }
+        scratch.nodeStamp[id] = epoch;
+        scratch.nodeCost[id] = cost;
+        scratch.nodeParent[id] = parent;
+        scratch.open.push_back(Scratch::Open{cost + octile(tileOfId(id), to), id});
+        std::push_heap(scratch.open.begin(), scratch.open.end(), later);
+    };
+    relax(startId, startId, 0);
+    bool found = false;
+    while (!scratch.open.empty()) {
+        std::pop_heap(scratch.open.begin(), scratch.open.end(), later);
+        const Scratch::Open top = scratch.open.back();
+        scratch.open.pop_back();
+        const std::uint32_t g = scratch.nodeCost[top.id];
+        if (g + octile(tileOfId(top.id), to) < top.f) {
+            continue;
+        }
+        if (top.id == goalId) {
+            found = true;
+            break;
+        }
+        if (top.id == startId) {
+            for (std::size_t j = 0; j < sc.nodes.size(); ++j) {
+                if (scratch.startCost[j] != kNoPath) {
+                    relax(static_cast<std::uint32_t>(startCluster * kMaxNodes + j), startId, scratch.startCost[j]);
+                }
+            }
+            continue;
+        }
+        const int cluster = static_cast<int>(top.id / kMaxNodes);
+        const std::size_t i = top.id % kMaxNodes;
+        const Cluster& c = clusters_[cluster];
+        const std::size_t n = c.nodes.size();
+        for (std::size_t j = 0; j < n; ++j) {
+            const std::uint32_t cost = c.cost[i * n + j];
+            if (j != i && cost != kNoPath) {
+                relax(static_cast<std::uint32_t>(cluster * kMaxNodes + j), top.id, g + cost);
+            }
+        }
+        const Node& node = c.nodes[i];
+        const glm::ivec2 across = tileXY(node.partner);
+        const int other = clusterOf(across.x, across.y);
+        const int k = findNode(other, node.partner, node.tile);
+        if (k >= 0) {
+            relax(static_cast<std::uint32_t>(other * kMaxNodes + k), top.id, g + kStraight);
+        }
+        if (cluster == goalCluster && scratch.goalCost[i] != kNoPath) {
+            relax(goalId, top.id, g + scratch.goalCost[i]);
+        }
+    }
+    if (!found) {
+        return false;
+    }
+
+    // Refine: the abstract steps inside a cluster become tile paths; the ones across a
+    // border are a single step already.
+    scratch.abstractPath.clear();
+    for (std::uint32_t id = goalId; id != startId; id = scratch.nodeParent[id]) {
+        scratch.abstractPath.push_back(id);
+    }
+    out.push_back(from);
+    glm::ivec2 at = from;
+    for (auto it = scratch.abstractPath.rbegin(); it != scratch.abstractPath.rend(); ++it) {
+        const glm::ivec2 next = tileOfId(*it);
+        if (next == at) {
+            continue;
+        }
+        const int cluster = clusterOf(at.x, at.y);
+        if (cluster == clusterOf(next.x, next.y)) {
+            searchCluster(cluster, at, &next, scratch);
+            tracePath(cluster, at, next, scratch, out);
+        } else {
+            out.push_back(next);
+        }
+        at = next;
+    }
+    return true;
+}
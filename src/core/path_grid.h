@@ -0,0 +1,136 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// PathGrid
+// --------
+// A tile map's walkability and its hierarchical path graph (HPA*). The map is cut into
+// kClusterTiles² clusters; where two clusters' border tiles are walkable on both sides,
+// each run of them is an ENTRANCE, and its transition tiles (the middle of a short run,
+// both ends of a long one) are the graph's nodes:
+//
+//     ┌────────┬────────┐        node: a border tile + its partner across the border
+//     │   ●────┼─●      │        intra edge: the cost between two nodes of a cluster,
+//     │  /     │  \     │          found once by searching inside the cluster
+//     │ ●      │   ●────┼──      inter edge: a node to its partner, one step
+//     └─┼──────┴────────┘
+//
+// | Query step                     | Searches                                         |
+// | ------------------------------ | ------------------------------------------------ |
+// | start and goal in one cluster  | A* inside it first (the common short path)       |
+// | start / goal into the graph    | Dijkstra inside their clusters to its nodes      |
+// | abstract path                  | A* over the nodes: a few per cluster, not tiles  |
+// | refine                         | A* inside one cluster per abstract step          |
+//
+// Every tile search is bounded by one cluster, so a query's work grows with the
+// clusters it crosses, not the tiles. Paths are 8-connected (no corner cutting) and near-
+// optimal: they go through transition tiles.
+//
+// An edit only marks its cluster (and the neighbours sharing its borders) dirty;
+// rebuild() re-derives their entrances and intra edges, nothing else. findPath() is
+// const and reads only the grid, so any number of threads may run it at once, each with
+// its own Scratch, as long as nobody edits or rebuilds meanwhile (core/path_service.h
+// keeps them apart).
+//
+// A tile is blocked while any layer holds something on it (setTile): a tile map's upper
+// layers are its obstacles.
+class PathGrid {
+public:
+    static constexpr int kClusterTiles = 16;
+    static constexpr int kMaxNodes = 32;       // per cluster: 4 borders x at most 8 transitions
+    static constexpr int kLongEntrance = 6;    // runs this long get a transition at each end
+    static constexpr int kStraight = 10;       // step costs; a diagonal is ~ sqrt(2) of a straight
+    static constexpr int kDiagonal = 14;
+
+    struct Options {
+        int width = 0;                 // in tiles
+        int height = 0;
+        float tileSize = 0.25f;        // world units per tile
+        glm::vec2 origin{0.0f};        // world position of tile (0, 0)'s lower-left corner
+    };
+
+    struct Stats {
+        std::size_t clusters = 0;
+        std::size_t nodes = 0;         // transition nodes now
+        std::uint64_t rebuilds = 0;    // clusters rebuilt so far
+    };
+
+    // One search's working memory; reuse it across queries (one per thread).
+    struct Scratch {
+        struct Open {
+            std::uint32_t f;
+            std::uint32_t id;
+        };
+        // Tiles of the cluster being searched (local index).
+        std::vector<std::uint32_t> tileCost;
+        std::vector<std::uint16_t> tileParent;
+        std::vector<std::uint32_t> tileStamp;
+        std::uint32_t tileEpoch = 0;
+        // Graph nodes (cluster * kMaxNodes + local), plus the start and the goal.
+        std::vector<std::uint32_t> nodeCost;
+        std::vector<std::uint32_t> nodeParent;
+        std::vector<std::uint32_t> nodeStamp;
+        std::uint32_t nodeEpoch = 0;
+        std::vector<Open> open;
+        std::vector<std::uint32_t> startCost;  // start / goal to their cluster's nodes
+        std::vector<std::uint32_t> goalCost;
+        std::vector<std::uint32_t> abstractPath;
+        std::vector<glm::ivec2> segment;
+    };
+
+    bool init(const Options& options);
+
+    // Layer `layer` (0..7) of tile (x, y) holds something (blocks) or not. Out-of-range
+    // coordinates are ignored.
+    void setTile(int layer, int x, int y, bool occupied);
+    bool blocked(int x, int y) const;
+    // Dirty clusters' entrances and intra edges; what findPath then sees.
+    void rebuild();
+    bool dirty() const { return !dirty_.empty(); }
+
+    // The tile under a world position (false outside the map), and a tile's centre.
+    bool tileAt(const glm::vec2& world, int& x, int& y) const;
+    glm::vec2 center(int x, int y) const;
+
+    // Tiles from `from` to `to` inclusive, appended to `out`; false (out untouched) if
+    // either is blocked or outside the map, or no path joins them.
+    bool findPath(glm::ivec2 from, glm::ivec2 to, Scratch& scratch, std::vector<glm::ivec2>& out) const;
+
+    const Options& options() const { return options_; }
+    const Stats& stats() const { return stats_; }
+
+private:
+    struct Node {
+        std::uint32_t tile;            // y * width + x, in this cluster
+        std::uint32_t partner;         // the tile across the border
+    };
+    struct Cluster {
+        std::vector<Node> nodes;
+        std::vector<std::uint32_t> cost;   // nodes x nodes; kNoPath: no way inside the cluster
+        bool dirty = false;
+    };
+
+    int clusterOf(int x, int y) const { return (y / kClusterTiles) * clustersX_ + x / kClusterTiles; }
+    void clusterRect(int cluster, int& x0, int& y0, int& x1, int& y1) const;
+    void addEntrances(int cluster, int neighbour, bool vertical, std::vector<Node>& out) const;
+    void rebuildCluster(int cluster, Scratch& scratch);
+    // Searches inside `cluster` from tile `from`: to `to` (A*, parents kept for
+    // tracePath), or to every tile (Dijkstra, to == nullptr). Returns to's cost or kNoPath.
+    std::uint32_t searchCluster(int cluster, glm::ivec2 from, const glm::ivec2* to, Scratch& scratch) const;
+    std::uint32_t costAt(int cluster, glm::ivec2 tile, const Scratch& scratch) const;
+    void tracePath(int cluster, glm::ivec2 from, glm::ivec2 to, Scratch& scratch,
+                   std::vector<glm::ivec2>& out) const;
+    int findNode(int cluster, std::uint32_t tile, std::uint32_t partner) const;
+
+    Options options_;
+    int clustersX_ = 0;
+    int clustersY_ = 0;
+    std::vector<std::uint8_t> layers_;     // per tile: a bit per occupied layer
+    std::vector<Cluster> clusters_;
+    std::vector<int> dirty_;               // clusters waiting for rebuild(), each once
+    Scratch rebuildScratch_;
+    Stats stats_;
+};
@@ -0,0 +1,89 @@
+#include "core/path_service.h"
+
+#include <algorithm>
+#include <utility>
+
+PathService::PathService(PathGrid& grid, JobSystem& jobs, const Settings& settings)
+    : grid_(grid), jobs_(jobs), settings_(settings),
+      scratch_(jobs.threadCount()), tiles_(jobs.threadCount()) {
+    settings_.queriesPerJob = std::max<std::size_t>(1, settings_.queriesPerJob);
+    settings_.maxBatch = std::max<std::size_t>(1, settings_.maxBatch);
+}
+
+PathService::~PathService() {
+    jobs_.wait(pending_);   // they read the grid and write results_
+}
+
+std::uint32_t PathService::request(const glm::vec2& from, const glm::vec2& to, Callback callback) {
+    const std::uint32_t id = nextId_++;
+    queued_.push_back(Query{id, from, to, std::move(callback)});
+    return id;
+}
+
+void PathService::setTile(int layer, int x, int y, bool occupied) {
+    edits_.push_back(Edit{layer, x, y, occupied});
+}
+
+void PathService::queryJob(void* context, std::size_t begin, std::size_t end) {
+    PathService& self = *static_cast<PathService*>(context);
+    const unsigned thread = self.jobs_.threadIndex();
+    PathGrid::Scratch& scratch = self.scratch_[thread];
+    std::vector<glm::ivec2>& tiles = self.tiles_[thread];
+    const PathGrid& grid = self.grid_;
+    for (std::size_t q = begin; q < end; ++q) {
+        const Query& query = self.batch_[q];
+        Result& result = self.results_[q];
+        result.id = query.id;
+        result.points.clear();
+        glm::ivec2 from, to;
+        tiles.clear();
+        result.found = grid.tileAt(query.from, from.x, from.y) && grid.tileAt(query.to, to.x, to.y) &&
+                       grid.findPath(from, to, scratch, tiles);
+        for (const glm::ivec2& tile : tiles) {
+            result.points.push_back(grid.center(tile.x, tile.y));
+        }
+    }
+}
+
+void PathService::update() {
+    jobs_.poll(pending_);   // --jobs=0: last frame's batch runs here, or never
+    if (!pending_.done()) {
+        return;
+    }
+
+    // The finished batch: callbacks may request again, which queues for the next one.
+    for (std::size_t q = 0; q < batch_.size(); ++q) {
+        const Result& result = results_[q];
+        ++stats_.queries;
+        ++(result.found ? stats_.found : stats_.failed);
+        if (batch_[q].callback) {
+            batch_[q].callback(result);
+        }
+    }
+    batch_.clear();
+
+    // The map catches up while nothing reads it.
+    for (const Edit& edit : edits_) {
+        grid_.setTile(edit.layer, edit.x, edit.y, edit.occupied);
+    }
+    stats_.edits += edits_.size();
+    edits_.clear();
+    grid_.rebuild();
+
+    // The next batch: the oldest queries first.
+    const std::size_t count = std::min(queued_.size(), settings_.maxBatch);
+    if (count > 0) {
+        batch_.assign(std::make_move_iterator(queued_.begin()),
+                      std::make_move_iterator(queued_.begin() + static_cast<std::ptrdiff_t>(count)));
+        queued_.erase(queued_.begin(), queued_.begin() + static_cast<std::ptrdiff_t>(count));
+        if (results_.size() < count) {
+            results_.resize(count);
+        }
+        for (std::size_t begin = 0; begin < count; begin += settings_.queriesPerJob) {
+            jobs_.run(&PathService::queryJob, this, begin, std::min(count, begin + settings_.queriesPerJob), &pending_);
+        }
+        ++stats_.batches;
+    }
+    stats_.queued = queued_.size();
+    stats_.inFlight = batch_.size();
+}
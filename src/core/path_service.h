@@ -0,0 +1,101 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "core/job_system.h"
+#include "core/path_grid.h"
+
+// PathService
+// -----------
+// Asynchronous path queries over a PathGrid (core/path_grid.h): callers ask from the main
+// thread, workers search in batches, answers come back as callbacks on the main thread.
+//
+//     request() ──▶ queued ──update(): batch starts──▶ workers (queriesPerJob each)
+//     update() once the batch is done ──▶ callbacks, in request order
+//
+// | update() (main, once per frame)  | Does                                              |
+// | -------------------------------- | ------------------------------------------------- |
+// | batch still running              | nothing: the grid stays frozen under it           |
+// | batch done                       | 1. the batch's callbacks                          |
+// |                                  | 2. the setTile() edits since, then grid.rebuild() |
+// |                                  |    (only the clusters they touched)               |
+// |                                  | 3. the next batch (up to maxBatch queries) starts |
+//
+// Edits wait for the batch in flight, so workers read the grid without a lock, and a
+// path reflects the map as it was when its batch started; one edited since is at most a
+// frame or two old. Like LevelStreamer's loads, a batch's jobs are never waited on by
+// the frame, unless there are no workers: then update() runs the last frame's batch
+// before it hands out the answers (JobSystem::poll). The destructor waits for the
+// running batch.
+//
+// Each worker thread searches with its own PathGrid::Scratch (by JobSystem::threadIndex).
+class PathService {
+public:
+    struct Settings {
+        std::size_t queriesPerJob = 16;
+        std::size_t maxBatch = 4096;       // queries per batch; the rest wait a batch
+    };
+
+    struct Result {
+        std::uint32_t id = 0;              // request()'s
+        bool found = false;
+        std::vector<glm::vec2> points;     // tile centres, start to goal
+    };
+    using Callback = std::function<void(const Result&)>;
+
+    struct Stats {
+        std::uint64_t queries = 0;         // answered
+        std::uint64_t found = 0;
+        std::uint64_t failed = 0;
+        std::uint64_t batches = 0;
+        std::uint64_t edits = 0;           // setTile() calls applied
+        std::size_t queued = 0;            // waiting for a batch now
+        std::size_t inFlight = 0;          // in the running batch
+    };
+
+    PathService(PathGrid& grid, JobSystem& jobs, const Settings& settings);
+    ~PathService();
+    PathService(const PathService&) = delete;
+    PathService& operator=(const PathService&) = delete;
+
+    // A path between two world positions (snapped to their tiles); `callback` runs in a
+    // later update(). Returns the query's id.
+    std::uint32_t request(const glm::vec2& from, const glm::vec2& to, Callback callback);
+    // PathGrid::setTile, applied by the next update() that finds no batch running.
+    void setTile(int layer, int x, int y, bool occupied);
+
+    void update();
+
+    const PathGrid& grid() const { return grid_; }
+    const Stats& stats() const { return stats_; }
+
+private:
+    struct Query {
+        std::uint32_t id;
+        glm::vec2 from, to;
+        Callback callback;
+    };
+    struct Edit {
+        int layer, x, y;
+        bool occupied;
+    };
+
+    static void queryJob(void* context, std::size_t begin, std::size_t end);
+
+    PathGrid& grid_;
+    JobSystem& jobs_;
+    Settings settings_;
+    std::uint32_t nextId_ = 1;
+    std::vector<Query> queued_;
+    std::vector<Query> batch_;             // the running batch, and its answers
+    std::vector<Result> results_;
+    std::vector<Edit> edits_;
+    std::vector<PathGrid::Scratch> scratch_;   // per thread
+    std::vector<std::vector<glm::ivec2>> tiles_;
+    JobCounter pending_;
+    Stats stats_;
+};
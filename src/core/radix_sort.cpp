@@ -0,0 +1,100 @@
+#include "core/radix_sort.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "core/job_system.h"
+
+namespace {
+
+constexpr std::size_t kMinChunk = 16384;   // items; below it a chunk costs more than it saves
+constexpr std::size_t kMaxChunks = 16;     // histograms on the stack: 16 x 256 counts
+
+} // namespace
+
+std::uint64_t* radixSort(JobSystem& jobs, std::uint64_t* items, std::uint64_t* scratch, std::size_t n,
+                         int firstByte, int lastByte) {
+    if (n < 2) {
+        return items;
+    }
+    const std::size_t chunks =
+        jobs.workerCount() == 0
+            ? 1
+            : std::min({kMaxChunks, std::size_t{jobs.threadCount()} * 2, std::max<std::size_t>(1, n / kMinChunk)});
+    const std::size_t chunkSize = (n + chunks - 1) / chunks;
+    auto forChunks = [&](auto&& body) {
+        if (chunks == 1) {
+            body(0, n);
+            return;
+        }
+        jobs.parallelFor(chunks, 1, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t c = begin; c < end; ++c) {
+                body(c * chunkSize, std::min(n, (c + 1) * chunkSize));
+            }
+        });
+    };
+
+    // The bits that differ from the first item anywhere: the passes worth running. Unsplit,
+    // the same read counts every pass's digits too (no later pass moves an item between
+    // chunks when there is only one).
+    std::uint64_t differs[kMaxChunks] = {};
+    std::uint32_t serialCounts[8][256] = {};
+    forChunks([&](std::size_t begin, std::size_t end) {
+        std::uint64_t bits = 0;
+        if (chunks == 1) {
+            for (std::size_t i = begin; i < end; ++i) {
+                bits |= items[i] ^ items[0];
+                for (int byte = firstByte; byte < lastByte; ++byte) {
+                    ++serialCounts[byte][(items[i] >> (byte * 8)) & 0xff];
+                }
+            }
+        } else {
+            for (std::size_t i = begin; i < end; ++i) {
+                bits |= items[i] ^ items[0];
+            }
+        }
+        differs[begin / chunkSize] = bits;
+    });
+    std::uint64_t varying = 0;
+    for (std::size_t c = 0; c < chunks; ++c) {
+        varying |= differs[c];
+    }
+
+    std::uint32_t counts[kMaxChunks][256];
+    std::uint64_t* src = items;
+    std::uint64_t* dst = scratch;
+    for (int byte = firstByte; byte < lastByte; ++byte) {
+        const int shift = byte * 8;
+        if (((varying >> shift) & 0xff) == 0) {
+            continue;
+        }
+        if (chunks == 1) {
+            std::copy(serialCounts[byte], serialCounts[byte] + 256, counts[0]);
+        } else {
+            forChunks([&](std::size_t begin, std::size_t end) {
+                std::uint32_t* count = counts[begin / chunkSize];
+                std::fill(count, count + 256, 0u);
+                for (std::size_t i = begin; i < end; ++i) {
+                    ++count[(src[i] >> shift) & 0xff];
+                }
+            });
+        }
+        // Digit-major, chunk-minor: chunk c's 7s go after chunk c-1's, before chunk 0's 8s.
+        std::uint32_t offset = 0;
+        for (int digit = 0; digit < 256; ++digit) {
+            for (std::size_t c = 0; c < chunks; ++c) {
+                const std::uint32_t count = counts[c][digit];
+                counts[c][digit] = offset;
+                offset += count;
+            }
+        }
+        forChunks([&](std::size_t begin, std::size_t end) {
+            std::uint32_t* slot = counts[begin / chunkSize];
+            for (std::size_t i = begin; i < end; ++i) {
+                dst[slot[(src[i] >> shift) & 0xff]++] = src[i];
+            }
+        });
+        std::swap(src, dst);
+    }
+    return src;
+}
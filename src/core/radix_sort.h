@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+class JobSystem;
+
+// radixSort
+// ---------
+// Stable LSD radix sort of 64-bit items on bytes [firstByte, lastByte) of each (byte 0
+// the lowest): the other bytes ride along, so a payload (an index) in the low bytes
+// costs no passes. Each pass is split across the job system:
+//
+//     1. every chunk of the items counts its 256 digits          (parallel)
+//     2. a prefix sum over (digit, chunk) gives each chunk, for   (serial, 256 x chunks)
+//        each digit, where its items go
+//     3. every chunk scatters into the other buffer              (parallel)
+//
+// Chunks are contiguous and handed their slots in order, so the parallel pass is as
+// stable as the serial one: equal keys keep their order. Before the passes, one parallel
+// read finds the bytes that differ anywhere; the others would move nothing and are
+// skipped (sprites on one z-layer: its two bytes never cost a pass).
+//
+// | Items  | Passes (of 8 bits) | Work                                          |
+// | ------ | ------------------ | --------------------------------------------- |
+// | n      | p varying bytes    | 1 read + p x (1 read + 1 scattered write)     |
+//
+// Small inputs (or a job system without workers) run on the caller, unsplit.
+// `scratch` holds n items (n < 2^32). Returns whichever of items / scratch holds the result.
+std::uint64_t* radixSort(JobSystem& jobs, std::uint64_t* items, std::uint64_t* scratch, std::size_t n,
+                         int firstByte = 0, int lastByte = 8);
@@ -0,0 +1,119 @@
+#include "core/skeleton_2d.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "core/job_system.h"
+
+int Skeleton2D::addBone(int parent, const LocalTransform2D& bind) {
+    if (parents_.size() >= static_cast<std::size_t>(kMaxBones) || parent >= static_cast<int>(parents_.size())) {
+        return -1;
+    }
+    parents_.push_back(parent < 0 ? -1 : parent);
+    bind_.push_back(bind);
+    return static_cast<int>(parents_.size() - 1);
+}
+
+void SkeletonPoses::init(const Skeleton2D& skeleton, const SkeletonClip2D& clip, std::size_t characters) {
+    const std::size_t bones = skeleton.size();
+    characters_ = characters;
+    clip_ = clip;
+    clip_.keys = std::max(clip_.keys, 1);
+    clip_.rotations.resize(bones * static_cast<std::size_t>(clip_.keys), 0.0f);
+    parents_.resize(bones);
+    bindRotation_.resize(bones);
+    inverseBind_.resize(bones);
+
+    placements_.resize(characters);
+    start_.assign(characters, 0.0f);
+    rate_.assign(characters, 1.0f);
+    key_.assign(characters, 0);
+    blend_.assign(characters, 0.0f);
+
+    // The bind pose's position and scale never change: written once, here.
+    locals_.resize(bones * characters);
+    for (std::size_t b = 0; b < bones; ++b) {
+        parents_[b] = skeleton.parent(b);
+        const LocalTransform2D& bind = skeleton.bind(b);
+        bindRotation_[b] = bind.rotation;
+        const std::size_t row = b * characters;
+        std::fill_n(locals_.x.begin() + row, characters, bind.position.x);
+        std::fill_n(locals_.y.begin() + row, characters, bind.position.y);
+        std::fill_n(locals_.rotation.begin() + row, characters, bind.rotation);
+        std::fill_n(locals_.scaleX.begin() + row, characters, bind.scale.x);
+        std::fill_n(locals_.scaleY.begin() + row, characters, bind.scale.y);
+    }
+
+    // Each bone's bind pose in character space, parents first, then inverted.
+    std::vector<Affine2D> bindWorld(bones);
+    for (std::size_t b = 0; b < bones; ++b) {
+        Transforms2D one;
+        one.resize(1);
+        const LocalTransform2D& bind = skeleton.bind(b);
+        one.x[0] = bind.position.x;
+        one.y[0] = bind.position.y;
+        one.rotation[0] = bind.rotation;
+        one.scaleX[0] = bind.scale.x;
+        one.scaleY[0] = bind.scale.y;
+        Affine2D local;
+        composeAffine2D(one, &local);
+        bindWorld[b] = parents_[b] < 0 ? local : combineAffine2D(bindWorld[static_cast<std::size_t>(parents_[b])], local);
+        inverseBind_[b] = inverseAffine2D(bindWorld[b]);
+    }
+
+    local_.resize(bones * characters);
+    placed_.resize(characters);
+    world_.resize(bones * characters);
+    palette_.resize(bones * characters);
+}
+
+void SkeletonPoses::evaluate(float time, JobSystem* jobs, std::size_t grain) {
+    if (jobs && characters_ >= 2 * grain) {
+        jobs->parallelFor(characters_, grain,
+                          [this, time](std::size_t begin, std::size_t end) { evaluateRange(time, begin, end); });
+    } else {
+        evaluateRange(time, 0, characters_);
+    }
+}
+
+void SkeletonPoses::evaluateRange(float time, std::size_t begin, std::size_t end) {
+    const std::size_t n = characters_;
+    const std::size_t count = end - begin;
+    const int keys = clip_.keys;
+    const float keysPerSecond = static_cast<float>(keys) / clip_.duration;
+
+    // Where in the clip each character is: one key index and blend for all its bones.
+    for (std::size_t c = begin; c < end; ++c) {
+        float k = (time - start_[c]) * rate_[c] * keysPerSecond;
+        k -= std::floor(k / static_cast<float>(keys)) * static_cast<float>(keys);   // [0, keys)
+        const std::int32_t key = std::min(static_cast<std::int32_t>(k), keys - 1);
+        key_[c] = key;
+        blend_[c] = k - static_cast<float>(key);
+    }
+
+    composeAffine2D(placements_, begin, count, placed_.data() + begin);
+    for (std::size_t b = 0; b < parents_.size(); ++b) {
+        const std::size_t row = b * n;
+        const float* track = clip_.rotations.data() + b * static_cast<std::size_t>(keys);
+        const float bind = bindRotation_[b];
+        float* rotation = locals_.rotation.data() + row;
+        for (std::size_t c = begin; c < end; ++c) {
+            const std::int32_t k0 = key_[c];
+            const std::int32_t k1 = k0 + 1 == keys ? 0 : k0 + 1;
+            rotation[c] = bind + track[k0] + (track[k1] - track[k0]) * blend_[c];
+        }
+        composeAffine2D(locals_, row + begin, count, local_.data() + row + begin);
+
+        // Parents come first: their row of world_ is final by now.
+        const int parent = parents_[b];
+        const Affine2D* above = parent < 0 ? placed_.data() : world_.data() + static_cast<std::size_t>(parent) * n;
+        const Affine2D* local = local_.data() + row;
+        const Affine2D& inverseBind = inverseBind_[b];
+        Affine2D* world = world_.data() + row;
+        Affine2D* out = palette_.data() + row;
+        for (std::size_t c = begin; c < end; ++c) {
+            world[c] = combineAffine2D(above[c], local[c]);
+            out[c] = combineAffine2D(world[c], inverseBind);
+        }
+    }
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "core/aligned_math.h"
+#include "core/batch_transform.h"
+#include "core/transform_hierarchy.h"
+
+class JobSystem;
+
+// Skeleton2D
+// ----------
+// A rig: bones in parent-first order (a bone's parent has a smaller index), each with its
+// bind pose relative to the parent (to the character, for a root).
+class Skeleton2D {
+public:
+    static constexpr int kMaxBones = 64;
+
+    // The bone's index, or -1 (parent not added yet, or kMaxBones reached).
+    int addBone(int parent, const LocalTransform2D& bind);
+
+    std::size_t size() const { return parents_.size(); }
+    int parent(std::size_t bone) const { return parents_[bone]; }
+    const LocalTransform2D& bind(std::size_t bone) const { return bind_[bone]; }
+
+private:
+    std::vector<int> parents_;
+    std::vector<LocalTransform2D> bind_;
+};
+
+// SkeletonClip2D
+// --------------
+// A looping clip: per bone, `keys` rotations (radians, added to the bind pose's) evenly
+// spaced over `duration` seconds; between two keys the rotation is interpolated linearly,
+// and the last key runs into the first.
+struct SkeletonClip2D {
+    float duration = 1.0f;
+    int keys = 1;
+    std::vector<float> rotations;       // [bone * keys + key]
+};
+
+// SkeletonPoses
+// -------------
+// Every character of one rig, posed as a batch. Each evaluate() samples the clip for all
+// of them and produces a palette: for every bone of every character, the transform that
+// takes a vertex from the bind pose to where that bone now has it in the world
+// (world * inverse(bind world)), which is what skinning blends.
+//
+// Everything is bone-major—bone 0 of every character, then bone 1 of every character—so
+// each step is a loop over contiguous arrays, one bone at a time:
+//
+// | Step      | Per character, per bone                              | How                     |
+// | --------- | ---------------------------------------------------- | ----------------------- |
+// | sample    | key index + fraction (per character), then the       | flat loops over SoA     |
+// |           | rotation lerp → the locals' rotation array           |                         |
+// | compose   | locals → Affine2D (sin/cos, scale, translate)        | composeAffine2D: SSE2,  |
+// |           |                                                      | 4 characters at a time  |
+// | hierarchy | world[bone] = world[parent] * local, roots under the | combineAffine2D; parent |
+// |           | character's placement                                | rows are done already   |
+// | palette   | world[bone] * inverse bind (computed once, in init)  | combineAffine2D         |
+//
+// The characters are independent, so with a JobSystem evaluate() splits them into ranges
+// (every bone of a range in one job) and never waits between bones.
+//
+// The palette is what a SKINNED vertex.glsl reads (render/skinned_mesh.h): bone b of
+// character c is palette()[b * characters() + c].
+class SkeletonPoses {
+public:
+    void init(const Skeleton2D& skeleton, const SkeletonClip2D& clip, std::size_t characters);
+
+    std::size_t characters() const { return characters_; }
+    std::size_t bones() const { return parents_.size(); }
+
+    // Where each character is: position, rotation, scale in the world.
+    Transforms2D& placements() { return placements_; }
+    const Transforms2D& placements() const { return placements_; }
+    // When character c's clip started (on evaluate()'s clock) and how fast it plays.
+    void setPlayback(std::size_t c, float start, float rate) {
+        start_[c] = start;
+        rate_[c] = rate;
+    }
+
+    // jobs: split the characters `grain` at a time across it; null: all on this thread.
+    void evaluate(float time, JobSystem* jobs = nullptr, std::size_t grain = 64);
+
+    const Affine2D* palette() const { return palette_.data(); }
+    std::size_t paletteSize() const { return palette_.size(); }
+
+private:
+    void evaluateRange(float time, std::size_t begin, std::size_t end);
+
+    std::size_t characters_ = 0;
+    std::vector<int> parents_;
+    std::vector<float> bindRotation_;
+    SkeletonClip2D clip_;
+
+    Transforms2D placements_;
+    AlignedVector<float> start_, rate_;
+    AlignedVector<std::int32_t> key_;   // per character: this evaluate()'s key
+    AlignedVector<float> blend_;        // ... and how far it is towards the next one
+    Transforms2D locals_;               // [bone * characters + c]; only rotation changes
+    std::vector<Affine2D> local_;       // the same, composed
+    std::vector<Affine2D> placed_;      // placements_, composed
+    std::vector<Affine2D> inverseBind_; // per bone: character space → the bone's bind space
+    std::vector<Affine2D> world_;       // [bone * characters + c]
+    std::vector<Affine2D> palette_;     // the same, times inverseBind_
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Aabb
+// ----
+// World-space axis-aligned bounding box of one object (or of a query region).
+struct Aabb {
+    glm::vec2 min;
+    glm::vec2 max;
+
+    bool overlaps(const Aabb& o) const {
+        return min.x <= o.max.x && max.x >= o.min.x && min.y <= o.max.y && max.y >= o.min.y;
+    }
+    bool contains(const glm::vec2& p) const {
+        return p.x >= min.x && p.x <= max.x && p.y >= min.y && p.y <= max.y;
+    }
+    static Aabb around(const glm::vec2& center, float radius) {
+        return Aabb{center - glm::vec2(radius), center + glm::vec2(radius)};
+    }
+};
+
+using ObjectId = std::uint32_t;
+constexpr ObjectId kNoObject = 0xffffffffu;
+
+class SweepTester;
+
+// SpatialIndex
+// ------------
+// "Which objects are near here?" without looking at every object.
+//
+// | Query              | Used for                               |
+// | ------------------ | -------------------------------------- |
+// | queryRect(view)    | visible set (culling)                  |
+// | queryPoint(cursor) | picking: candidates under the mouse    |
+// | sweep(tester)      | rays, line of sight, moving boxes      |
+//
+// Results are CANDIDATES whose bounding box overlaps the query; callers do any exact
+// test (rotated quad, pixel alpha) themselves. Both queries append to `out` and never
+// report the same id twice. sweep() hands the boxes along a SweepQuery to the tester
+// (core/spatial_query.h), maybe some twice, and touches nothing mutable: unlike the
+// other two it is safe from several threads at once.
+//
+// Objects are identified by the caller's ids (e.g. the index in Transforms2D). Moving
+// objects call update() every time their bounds change; implementations make that cheap
+// when an object stays in the same place in the structure, which is nearly every frame.
+// rebuild() replaces everything at once (level load), ids 0..count-1.
+class SpatialIndex {
+public:
+    virtual ~SpatialIndex() = default;
+
+    virtual void clear() = 0;
+    virtual void rebuild(const Aabb* bounds, std::size_t count) = 0;
+    virtual void insert(ObjectId id, const Aabb& bounds) = 0;
+    virtual void update(ObjectId id, const Aabb& bounds) = 0;
+    virtual void remove(ObjectId id) = 0;
+
+    virtual void queryRect(const Aabb& rect, std::vector<ObjectId>& out) const = 0;
+    virtual void queryPoint(const glm::vec2& point, std::vector<ObjectId>& out) const = 0;
+    virtual void sweep(SweepTester& tester) const = 0;
+
+    virtual std::size_t size() const = 0;
+    virtual std::size_t memoryBytes() const = 0; // approximate heap footprint
+};
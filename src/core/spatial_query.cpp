@@ -0,0 +1,147 @@
+#include "core/spatial_query.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "core/job_system.h"
+
+namespace {
+
+constexpr std::size_t kQueriesPerJob = 64;  // a few microseconds of rays each
+
+// 1 / d, kept finite: a segment parallel to an axis gives ±1e30 instead of inf, so the
+// slab products stay numbers (0 * inf would be NaN) and still land far outside [0, 1].
+float safeInverse(float d) {
+    constexpr float kTiny = 1e-30f;
+    return 1.0f / (std::fabs(d) < kTiny ? std::copysign(kTiny, d) : d);
+}
+
+} // namespace
+
+SweepTester::SweepTester(const SweepQuery& query, Mode mode)
+    : query_(query), mode_(mode), inverse_(safeInverse(query.delta.x), safeInverse(query.delta.y)) {}
+
+void SweepTester::accept(ObjectId id, float enter, float enterX, float enterY) {
+    hit_.id = id;
+    hit_.t = std::max(enter, 0.0f);
+    if (enter < 0.0f) {
+        hit_.normal = glm::vec2(0.0f);  // started inside it
+    } else if (enterX > enterY) {
+        hit_.normal = glm::vec2(query_.delta.x > 0.0f ? -1.0f : 1.0f, 0.0f);
+    } else {
+        hit_.normal = glm::vec2(0.0f, query_.delta.y > 0.0f ? -1.0f : 1.0f);
+    }
+    done_ = mode_ == Mode::Any;
+}
+
+void SweepTester::flush() {
+    const int n = count_;
+    count_ = 0;
+    if (done_) {
+        return;
+    }
+    // Grown box relative to the origin: min - half - origin, max + half - origin.
+    const glm::vec2 lo = -query_.half - query_.origin;
+    const glm::vec2 hi = query_.half - query_.origin;
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128 loX = _mm_set1_ps(lo.x), loY = _mm_set1_ps(lo.y);
+    const __m128 hiX = _mm_set1_ps(hi.x), hiY = _mm_set1_ps(hi.y);
+    const __m128 invX = _mm_set1_ps(inverse_.x), invY = _mm_set1_ps(inverse_.y);
+    const __m128 zero = _mm_setzero_ps();
+    for (; i + 4 <= n; i += 4) {
+        const __m128 x0 = _mm_mul_ps(_mm_add_ps(_mm_load_ps(minX_ + i), loX), invX);
+        const __m128 x1 = _mm_mul_ps(_mm_add_ps(_mm_load_ps(maxX_ + i), hiX), invX);
+        const __m128 y0 = _mm_mul_ps(_mm_add_ps(_mm_load_ps(minY_ + i), loY), invY);
+        const __m128 y1 = _mm_mul_ps(_mm_add_ps(_mm_load_ps(maxY_ + i), hiY), invY);
+        const __m128 enterX = _mm_min_ps(x0, x1), enterY = _mm_min_ps(y0, y1);
+        const __m128 enter = _mm_max_ps(enterX, enterY);
+        const __m128 exit = _mm_min_ps(_mm_max_ps(x0, x1), _mm_max_ps(y0, y1));
+        const __m128 in = _mm_and_ps(_mm_cmple_ps(enter, exit), _mm_cmpge_ps(exit, zero));
+        // The limit shrinks as lanes are accepted, so it is compared per lane below.
+        int mask = _mm_movemask_ps(_mm_and_ps(in, _mm_cmplt_ps(enter, _mm_set1_ps(hit_.t))));
+        if (mask == 0) {
+            continue;   // the common case: four misses, one branch
+        }
+        alignas(16) float e[4], ex[4], ey[4];
+        _mm_store_ps(e, enter);
+        _mm_store_ps(ex, enterX);
+        _mm_store_ps(ey, enterY);
+        while (mask) {
+            const int lane = __builtin_ctz(mask);
+            if (std::max(e[lane], 0.0f) < hit_.t) {
+                accept(ids_[i + lane], e[lane], ex[lane], ey[lane]);
+                if (done_) {
+                    return;
+                }
+            }
+            mask &= mask - 1;
+        }
+    }
+#endif
+    for (; i < n; ++i) {
+        const float x0 = (minX_[i] + lo.x) * inverse_.x, x1 = (maxX_[i] + hi.x) * inverse_.x;
+        const float y0 = (minY_[i] + lo.y) * inverse_.y, y1 = (maxY_[i] + hi.y) * inverse_.y;
+        const float enterX = std::min(x0, x1), enterY = std::min(y0, y1);
+        const float enter = std::max(enterX, enterY);
+        const float exit = std::min(std::max(x0, x1), std::max(y0, y1));
+        if (enter <= exit && exit >= 0.0f && std::max(enter, 0.0f) < hit_.t) {
+            accept(ids_[i], enter, enterX, enterY);
+            if (done_) {
+                return;
+            }
+        }
+    }
+}
+
+bool SweepTester::crosses(const Aabb& bounds, float& enter) const {
+    const float x0 = (bounds.min.x - query_.half.x - query_.origin.x) * inverse_.x;
+    const float x1 = (bounds.max.x + query_.half.x - query_.origin.x) * inverse_.x;
+    const float y0 = (bounds.min.y - query_.half.y - query_.origin.y) * inverse_.y;
+    const float y1 = (bounds.max.y + query_.half.y - query_.origin.y) * inverse_.y;
+    enter = std::max(std::max(std::min(x0, x1), std::min(y0, y1)), 0.0f);
+    const float exit = std::min(std::max(x0, x1), std::max(y0, y1));
+    return enter <= exit && enter < hit_.t;
+}
+
+SweepHit sweepClosest(const SpatialIndex& index, const SweepQuery& query) {
+    SweepTester tester(query, SweepTester::Mode::Closest);
+    index.sweep(tester);
+    return tester.result();
+}
+
+bool sweepBlocked(const SpatialIndex& index, const SweepQuery& query) {
+    SweepTester tester(query, SweepTester::Mode::Any);
+    index.sweep(tester);
+    return tester.result().hit();
+}
+
+void sweepClosest(const SpatialIndex& index, const SweepQuery* queries, std::size_t count, SweepHit* out) {
+    for (std::size_t i = 0; i < count; ++i) {
+        out[i] = sweepClosest(index, queries[i]);
+    }
+}
+
+void sweepBlocked(const SpatialIndex& index, const SweepQuery* queries, std::size_t count, std::uint8_t* blocked) {
+    for (std::size_t i = 0; i < count; ++i) {
+        blocked[i] = sweepBlocked(index, queries[i]) ? 1 : 0;
+    }
+}
+
+void sweepClosestParallel(JobSystem& jobs, const SpatialIndex& index, const SweepQuery* queries, std::size_t count,
+                          SweepHit* out) {
+    jobs.parallelFor(count, kQueriesPerJob, [&](std::size_t begin, std::size_t end) {
+        sweepClosest(index, queries + begin, end - begin, out + begin);
+    });
+}
+
+void sweepBlockedParallel(JobSystem& jobs, const SpatialIndex& index, const SweepQuery* queries, std::size_t count,
+                          std::uint8_t* blocked) {
+    jobs.parallelFor(count, kQueriesPerJob, [&](std::size_t begin, std::size_t end) {
+        sweepBlocked(index, queries + begin, end - begin, blocked + begin);
+    });
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+
+#include "core/spatial_index.h"
+
+class JobSystem;
+
+// Spatial queries
+// ---------------
+// Rays, segments and moving boxes against the bounds in a SpatialIndex:
+//
+// | Query        | Answers                                       | Used for                  |
+// | ------------ | --------------------------------------------- | ------------------------- |
+// | sweepClosest | the first box in the way, where and which     | shots, a move's stop      |
+// |              | face                                          | point                     |
+// | sweepBlocked | whether anything is in the way at all; stops  | line of sight (every      |
+// |              | at the first box found                        | agent, every tick)        |
+//
+// A SweepQuery is a segment, origin to origin + delta (a ray is a segment as long as its
+// range), optionally carrying a box of half size `half`. A box hits another exactly when
+// its centre's segment hits the other grown by `half` (their Minkowski sum), so the three
+// kinds are one test: the slab test, per axis the t where the segment enters and leaves
+// the grown box's two planes,
+//
+//     enter = max(min(tx0, tx1), min(ty0, ty1))    exit = min(max(tx0, tx1), max(ty0, ty1))
+//     hit  <=>  enter <= exit, exit >= 0, enter < the closest hit so far (1 to start)
+//
+// run on four boxes at once (SSE2) as the index hands them over. The index only finds
+// candidates, nearest first where it can (SpatialIndex::sweep): UniformGrid walks the
+// cells under the swept box column by column, LooseQuadtree descends into the children
+// whose loose bounds the sweep crosses, nearest first. Both stop once everything left
+// starts beyond the closest hit.
+//
+// sweep() only reads the index, so any number of threads can query one that no thread is
+// updating: the *Parallel batches split the queries across a JobSystem. Nothing allocates;
+// results go to the caller's arrays.
+struct SweepQuery {
+    glm::vec2 origin{0.0f};
+    glm::vec2 delta{0.0f};                            // the end is origin + delta
+    glm::vec2 half{0.0f};                             // the moving box's; 0: a ray
+    ObjectId ignore[2] = {kNoObject, kNoObject};      // never hit: the caster, its target
+
+    static SweepQuery segment(const glm::vec2& from, const glm::vec2& to) {
+        return SweepQuery{from, to - from, glm::vec2(0.0f), {kNoObject, kNoObject}};
+    }
+    // `box` moved by `delta`.
+    static SweepQuery box(const Aabb& box, const glm::vec2& delta) {
+        return SweepQuery{(box.min + box.max) * 0.5f, delta, (box.max - box.min) * 0.5f, {kNoObject, kNoObject}};
+    }
+};
+
+struct SweepHit {
+    ObjectId id = kNoObject;
+    float t = 1.0f;             // of delta travelled: contact at origin + delta * t
+    glm::vec2 normal{0.0f};     // of the face hit; 0 when the sweep starts inside (t = 0)
+
+    bool hit() const { return id != kNoObject; }
+};
+
+// One query's state while an index feeds it candidates: test() buffers a box, every
+// kBatch of them go through the slab test together. Indexes call flush() before
+// consulting limit() or done(), so pruning sees every box handed over so far.
+class SweepTester {
+public:
+    enum class Mode { Closest, Any };
+
+    SweepTester(const SweepQuery& query, Mode mode);
+
+    const SweepQuery& query() const { return query_; }
+    // Boxes entered at or past this t can't change the result.
+    float limit() const { return hit_.t; }
+    // Any: something was hit, the answer can't change.
+    bool done() const { return done_; }
+
+    void test(ObjectId id, const Aabb& bounds) {
+        if (id == query_.ignore[0] || id == query_.ignore[1]) {
+            return;
+        }
+        minX_[count_] = bounds.min.x;
+        minY_[count_] = bounds.min.y;
+        maxX_[count_] = bounds.max.x;
+        maxY_[count_] = bounds.max.y;
+        ids_[count_] = id;
+        if (++count_ == kBatch) {
+            flush();
+        }
+    }
+    void flush();
+
+    // Whether the sweep reaches `bounds` (grown by half) before limit(); `enter` is where,
+    // clamped to 0. For a node's or a cell's bounds: is it worth looking inside.
+    bool crosses(const Aabb& bounds, float& enter) const;
+
+    SweepHit result() {
+        flush();
+        return hit_;
+    }
+
+private:
+    static constexpr int kBatch = 8;
+
+    void accept(ObjectId id, float enter, float enterX, float enterY);
+
+    SweepQuery query_;
+    Mode mode_;
+    glm::vec2 inverse_;         // 1 / delta, a huge finite value for a zero component
+    SweepHit hit_;
+    bool done_ = false;
+    int count_ = 0;
+    alignas(16) float minX_[kBatch];
+    alignas(16) float minY_[kBatch];
+    alignas(16) float maxX_[kBatch];
+    alignas(16) float maxY_[kBatch];
+    ObjectId ids_[kBatch];
+};
+
+SweepHit sweepClosest(const SpatialIndex& index, const SweepQuery& query);
+bool sweepBlocked(const SpatialIndex& index, const SweepQuery& query);
+
+// Batches: out[i] / blocked[i] (1: something in the way) for queries[i].
+void sweepClosest(const SpatialIndex& index, const SweepQuery* queries, std::size_t count, SweepHit* out);
+void sweepBlocked(const SpatialIndex& index, const SweepQuery* queries, std::size_t count, std::uint8_t* blocked);
+
+// The same across the job system's threads; the index must not change until they return.
+void sweepClosestParallel(JobSystem& jobs, const SpatialIndex& index, const SweepQuery* queries, std::size_t count,
+                          SweepHit* out);
+void sweepBlockedParallel(JobSystem& jobs, const SpatialIndex& index, const SweepQuery* queries, std::size_t count,
+                          std::uint8_t* blocked);
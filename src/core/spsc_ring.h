@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+// SpscRing<T, Capacity>
+// ---------------------
+// Fixed-size lock-free queue for exactly ONE producer thread and ONE consumer thread.
+//
+// - No locks, no allocation after construction: push/pop are a couple of atomic loads
+//   and one atomic store each.
+// - Capacity must be a power of two (index wrap is a bit mask, not a modulo).
+// - When full, push() fails instead of blocking; the caller decides whether to drop.
+//
+// head_ is only written by the consumer, tail_ only by the producer. Each side reads the
+// other's index with acquire and publishes its own with release, which is what makes the
+// element written before the tail_ store visible to the consumer after its tail_ load.
+template <typename T, std::size_t Capacity>
+class SpscRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    bool push(const T& value) {
+        const std::size_t tail = tail_.load(std::memory_order_relaxed);
+        const std::size_t head = head_.load(std::memory_order_acquire);
+        if (tail - head == Capacity) {
+            return false; // full
+        }
+        items_[tail & (Capacity - 1)] = value;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& out) {
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+        const std::size_t tail = tail_.load(std::memory_order_acquire);
+        if (head == tail) {
+            return false; // empty
+        }
+        out = items_[head & (Capacity - 1)];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate when called concurrently; exact from either side when the other is idle.
+    std::size_t size() const {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+    bool empty() const { return size() == 0; }
+    static constexpr std::size_t capacity() { return Capacity; }
+
+private:
+    // Separate cache lines so producer and consumer don't false-share.
+    alignas(64) std::atomic<std::size_t> head_{0};
+    alignas(64) std::atomic<std::size_t> tail_{0};
+    alignas(64) T items_[Capacity];
+};
@@ -0,0 +1,111 @@
+#include "core/sweep_and_prune.h"
+
+#include <limits>
+
+void SweepAndPrune::clear() {
+    minX_.clear();
+    maxX_.clear();
+    minY_.clear();
+    maxY_.clear();
+    ids_.clear();
+    slots_.clear();
+    stats_ = Stats{};
+}
+
+void SweepAndPrune::resize(std::size_t count) {
+    const std::size_t n = ids_.size();
+    if (count < n) {
+        // Drop ids >= count, keeping the survivors' order.
+        std::size_t out = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            if (ids_[i] >= count) {
+                continue;
+            }
+            minX_[out] = minX_[i];
+            maxX_[out] = maxX_[i];
+            minY_[out] = minY_[i];
+            maxY_[out] = maxY_[i];
+            ids_[out] = ids_[i];
+            slots_[ids_[out]] = static_cast<std::uint32_t>(out);
+            ++out;
+        }
+        minX_.resize(count);
+        maxX_.resize(count);
+        minY_.resize(count);
+        maxY_.resize(count);
+        ids_.resize(count);
+        slots_.resize(count);
+    } else if (count > n) {
+        // At the far end until their first update(); the sort moves them into place.
+        constexpr float kFar = std::numeric_limits<float>::max();
+        minX_.resize(count, kFar);
+        maxX_.resize(count, kFar);
+        minY_.resize(count, kFar);
+        maxY_.resize(count, kFar);
+        ids_.resize(count);
+        slots_.resize(count);
+        for (std::size_t i = n; i < count; ++i) {
+            ids_[i] = static_cast<ObjectId>(i);
+            slots_[i] = static_cast<std::uint32_t>(i);
+        }
+    }
+    stats_.objects = count;
+}
+
+void SweepAndPrune::update(ObjectId id, const Aabb& bounds) {
+    const std::uint32_t s = slots_[id];
+    minX_[s] = bounds.min.x;
+    maxX_[s] = bounds.max.x;
+    minY_[s] = bounds.min.y;
+    maxY_[s] = bounds.max.y;
+}
+
+void SweepAndPrune::sort() {
+    std::uint64_t moves = 0;
+    const std::size_t n = ids_.size();
+    for (std::size_t i = 1; i < n; ++i) {
+        const float key = minX_[i];
+        if (minX_[i - 1] <= key) {
+            continue;                  // already in order: the common case
+        }
+        const float maxX = maxX_[i], minY = minY_[i], maxY = maxY_[i];
+        const ObjectId id = ids_[i];
+        std::size_t j = i;
+        do {
+            minX_[j] = minX_[j - 1];
+            maxX_[j] = maxX_[j - 1];
+            minY_[j] = minY_[j - 1];
+            maxY_[j] = maxY_[j - 1];
+            ids_[j] = ids_[j - 1];
+            slots_[ids_[j]] = static_cast<std::uint32_t>(j);
+            --j;
+            ++moves;
+        } while (j > 0 && minX_[j - 1] > key);
+        minX_[j] = key;
+        maxX_[j] = maxX;
+        minY_[j] = minY;
+        maxY_[j] = maxY;
+        ids_[j] = id;
+        slots_[id] = static_cast<std::uint32_t>(j);
+    }
+    stats_.moves = moves;
+}
+
+void SweepAndPrune::findPairs(std::vector<CollisionPair>& out) {
+    sort();
+    std::uint64_t tests = 0;
+    const std::size_t before = out.size();
+    const std::size_t n = ids_.size();
+    for (std::size_t i = 0; i < n; ++i) {
+        const float maxX = maxX_[i], minY = minY_[i], maxY = maxY_[i];
+        for (std::size_t j = i + 1; j < n && minX_[j] <= maxX; ++j) {
+            ++tests;
+            if (minY_[j] <= maxY && maxY_[j] >= minY) {
+                const ObjectId a = ids_[i], b = ids_[j];
+                out.push_back(a < b ? CollisionPair{a, b} : CollisionPair{b, a});
+            }
+        }
+    }
+    stats_.tests = tests;
+    stats_.pairs = out.size() - before;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "core/aligned_math.h"
+#include "core/spatial_index.h"
+
+// Two objects whose bounds overlap, a < b.
+struct CollisionPair {
+    ObjectId a;
+    ObjectId b;
+};
+
+// SweepAndPrune
+// -------------
+// Collision broadphase: every pair of overlapping boxes among many moving ones, without
+// testing all n² pairs. The boxes are kept sorted by min.x, one array per field:
+//
+//     minX  minX  minX ... | maxX ... | minY ... | maxY ... | id ...     (sorted by minX)
+//
+// and findPairs() sweeps them once: box i can only overlap the boxes after it whose
+// minX is <= its maxX, so the inner loop stops at the first one that starts further
+// right, and only those candidates get the y test.
+//
+// | Step           | Cost                                                           |
+// | -------------- | -------------------------------------------------------------- |
+// | update(id)     | O(1): new bounds written in place, order left to findPairs    |
+// | sort           | insertion sort: O(n + moves). Objects move a little per step, |
+// |                | so the order is nearly right and few of them move             |
+// | sweep          | O(n + candidates along x)                                      |
+//
+// The insertion sort is what makes this incremental: a full sort each step would cost
+// O(n log n) whatever happened, this one costs what actually changed order since the
+// last step (temporal coherence). A teleport or a new object costs its distance in the
+// order once.
+//
+// Ids are dense, 0..size()-1, e.g. the rows of a component query; resize() adds or drops
+// ids at the end. An id keeps its place in the order across steps, so it must keep
+// naming the same object for the sort to stay cheap (it is still correct if it doesn't).
+// Ids added by resize() must be update()d before the next findPairs().
+//
+// Boxes spread mostly along y sweep worse than along x; this game's worlds are wider
+// than tall.
+class SweepAndPrune {
+public:
+    struct Stats {
+        std::size_t objects = 0;
+        std::uint64_t moves = 0;       // insertion sort shifts, last findPairs
+        std::uint64_t tests = 0;       // candidate pairs (x overlaps) tested on y
+        std::size_t pairs = 0;         // ... of which overlapped
+    };
+
+    void clear();
+    void resize(std::size_t count);
+    void update(ObjectId id, const Aabb& bounds);
+
+    // Sorts, then appends every overlapping pair to `out` (each once, a < b, in sweep order).
+    void findPairs(std::vector<CollisionPair>& out);
+
+    std::size_t size() const { return ids_.size(); }
+    const Stats& stats() const { return stats_; }
+
+private:
+    void sort();
+
+    AlignedVector<float> minX_, maxX_, minY_, maxY_;
+    std::vector<ObjectId> ids_;
+    std::vector<std::uint32_t> slots_;     // id → index in the sorted arrays
+    Stats stats_;
+};
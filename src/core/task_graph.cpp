@@ -0,0 +1,48 @@
+#include "core/task_graph.h"
+
+#include "profile/trace.h"
+
+TaskGraph::Task TaskGraph::add(const char* name, Body body) {
+    tasks_.emplace_back(name, std::move(body));
+    return static_cast<Task>(tasks_.size() - 1);
+}
+
+void TaskGraph::depend(Task task, Task prerequisite) {
+    tasks_[prerequisite].successors.push_back(task);
+    ++tasks_[task].dependencies;
+}
+
+void TaskGraph::schedule(Task task) {
+    jobs_->run(&TaskGraph::runTask, this, task, task + 1, &counter_);
+}
+
+void TaskGraph::runTask(void* context, std::size_t task, std::size_t) {
+    TaskGraph& graph = *static_cast<TaskGraph*>(context);
+    Node& node = graph.tasks_[task];
+    {
+        trace::Scope span(node.name);
+        node.body(*graph.jobs_);
+    }
+    // The last prerequisite to finish starts the successor. The acq_rel decrement makes
+    // every predecessor's writes visible to it.
+    for (Task next : node.successors) {
+        if (graph.tasks_[next].remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            graph.schedule(next);
+        }
+    }
+}
+
+void TaskGraph::run(JobSystem& jobs) {
+    jobs_ = &jobs;
+    for (Node& node : tasks_) {
+        node.remaining.store(node.dependencies, std::memory_order_relaxed);
+    }
+    // Successors are scheduled from inside their last prerequisite's job, before that job
+    // completes, so the counter can't reach zero while work is still pending.
+    for (Task t = 0; t < tasks_.size(); ++t) {
+        if (tasks_[t].dependencies == 0) {
+            schedule(t);
+        }
+    }
+    jobs.wait(counter_);
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "core/job_system.h"
+
+// TaskGraph
+// ---------
+// The frame's stages and what each one needs finished first, built ONCE and run every
+// frame:
+//
+//     TaskGraph graph;
+//     TaskGraph::Task extract = graph.add("extract", [&](JobSystem& jobs) { ... });
+//     TaskGraph::Task cull    = graph.add("cull",    [&](JobSystem& jobs) { ... });
+//     graph.depend(cull, extract);        // cull starts when extract has finished
+//     ...
+//     graph.run(jobs);                    // per frame; returns when every task is done
+//
+// Each task runs as one job as soon as its last dependency completes; tasks with no
+// path between them run at the same time. Inside, a task is free to fan out further
+// with jobs.parallelFor(...)—that's where the per-entity parallelism comes from. The
+// calling thread helps execute until the graph is done.
+//
+// Task bodies are std::function, created once: running the graph allocates nothing.
+// Each task is a named span in the trace (profile/trace.h); names must be literals.
+class TaskGraph {
+public:
+    using Task = std::uint32_t;
+    using Body = std::function<void(JobSystem& jobs)>;
+
+    Task add(const char* name, Body body);
+    void depend(Task task, Task prerequisite);   // `task` waits for `prerequisite`
+
+    void run(JobSystem& jobs);
+
+    std::size_t size() const { return tasks_.size(); }
+
+private:
+    struct Node {
+        const char* name;
+        Body body;
+        std::vector<Task> successors;
+        std::uint32_t dependencies = 0;         // static count
+        std::atomic<std::uint32_t> remaining{0}; // this run's countdown
+        TaskGraph* graph = nullptr;
+
+        Node(const char* n, Body b) : name(n), body(std::move(b)) {}
+        Node(Node&& o) noexcept
+            : name(o.name), body(std::move(o.body)), successors(std::move(o.successors)),
+              dependencies(o.dependencies), graph(o.graph) {}
+    };
+
+    static void runTask(void* context, std::size_t task, std::size_t);
+    void schedule(Task task);
+
+    std::vector<Node> tasks_;
+    JobSystem* jobs_ = nullptr;
+    JobCounter counter_;
+};
@@ -0,0 +1,267 @@
+#include "core/thread_affinity.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <thread>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#define THREAD_AFFINITY_LINUX 1
+#endif
+
+namespace affinity {
+
+namespace {
+
+Plan gPlan;
+
+#ifdef THREAD_AFFINITY_LINUX
+std::string readLine(const std::string& path) {
+    std::ifstream file(path);
+    std::string line;
+    std::getline(file, line);
+    return line;
+}
+
+int readInt(const std::string& path, int fallback) {
+    const std::string line = readLine(path);
+    return line.empty() ? fallback : std::atoi(line.c_str());
+}
+
+// Which of `topology.cpus` are E-cores, or false when nothing says.
+bool markEfficiencyCores(Topology& topology) {
+    CpuList atom;
+    if (!readLine("/sys/devices/cpu_core/cpus").empty() && parseCpuList(readLine("/sys/devices/cpu_atom/cpus"), atom) &&
+        !atom.empty()) {
+        for (Cpu& cpu : topology.cpus) {
+            cpu.efficiency = std::find(atom.begin(), atom.end(), cpu.id) != atom.end();
+        }
+        return true;
+    }
+    std::vector<int> capacity;
+    int highest = 0;
+    for (const Cpu& cpu : topology.cpus) {
+        capacity.push_back(readInt("/sys/devices/system/cpu/cpu" + std::to_string(cpu.id) + "/cpu_capacity", 0));
+        highest = std::max(highest, capacity.back());
+    }
+    if (highest == 0) {
+        return false;
+    }
+    for (std::size_t i = 0; i < topology.cpus.size(); ++i) {
+        topology.cpus[i].efficiency = capacity[i] > 0 && capacity[i] < highest;
+    }
+    return true;
+}
+#endif
+
+} // namespace
+
+int Topology::performanceCores() const {
+    int count = 0;
+    for (int core = 0; core < static_cast<int>(cores.size()); ++core) {
+        count += efficiencyCore(core) ? 0 : 1;
+    }
+    return count;
+}
+
+bool Topology::efficiencyCore(int core) const {
+    for (const Cpu& cpu : cpus) {
+        if (cpu.core == core) {
+            return cpu.efficiency;
+        }
+    }
+    return false;
+}
+
+Topology detect() {
+    Topology topology;
+    std::vector<std::pair<int, int>> keys;   // (package, core_id) of each core
+#ifdef THREAD_AFFINITY_LINUX
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    if (sched_getaffinity(0, sizeof(mask), &mask) == 0) {
+        for (int id = 0; id < CPU_SETSIZE; ++id) {
+            if (!CPU_ISSET(id, &mask)) {
+                continue;
+            }
+            const std::string dir = "/sys/devices/system/cpu/cpu" + std::to_string(id) + "/topology/";
+            Cpu cpu;
+            cpu.id = id;
+            cpu.package = readInt(dir + "physical_package_id", 0);
+            const std::pair<int, int> key{cpu.package, readInt(dir + "core_id", id)};
+            const auto found = std::find(keys.begin(), keys.end(), key);
+            cpu.core = static_cast<int>(found - keys.begin());
+            if (found == keys.end()) {
+                keys.push_back(key);
+                topology.cores.emplace_back();
+            }
+            topology.cores[static_cast<std::size_t>(cpu.core)].push_back(id);
+            topology.cpus.push_back(cpu);
+        }
+        markEfficiencyCores(topology);
+    }
+#endif
+    if (topology.cpus.empty()) {
+        const int count = std::max(1u, std::thread::hardware_concurrency());
+        for (int id = 0; id < count; ++id) {
+            topology.cpus.push_back(Cpu{id, 0, id, false});
+            topology.cores.push_back(CpuList{id});
+        }
+    }
+    bool performance = false, efficiency = false;
+    for (const Cpu& cpu : topology.cpus) {
+        (cpu.efficiency ? efficiency : performance) = true;
+    }
+    topology.hybrid = performance && efficiency;
+    topology.smt = topology.cores.size() < topology.cpus.size();
+    return topology;
+}
+
+std::size_t cacheBytes(int level) {
+    static std::atomic<std::size_t> cached[4] = {};   // + 1, so 0 means "not read yet"
+    if (level < 1 || level > 3) {
+        return 0;
+    }
+    const std::size_t known = cached[level].load(std::memory_order_relaxed);
+    if (known > 0) {
+        return known - 1;
+    }
+    std::size_t bytes = 0;
+#ifdef THREAD_AFFINITY_LINUX
+    // index0 / index1 are L1 data / instruction; index2 L2, index3 L3.
+    const std::string dir = "/sys/devices/system/cpu/cpu0/cache/index" + std::to_string(level == 1 ? 0 : level) + "/";
+    const std::string size = readLine(dir + "size");
+    if (readInt(dir + "level", 0) == level && !size.empty()) {
+        bytes = static_cast<std::size_t>(std::atol(size.c_str()));
+        bytes *= size.back() == 'K' ? 1024 : size.back() == 'M' ? 1024 * 1024 : 1;
+    }
+#endif
+    cached[level].store(bytes + 1, std::memory_order_relaxed);
+    return bytes;
+}
+
+const char* roleName(Role role) {
+    switch (role) {
+    case Role::Render: return "render";
+    case Role::Main: return "main";
+    case Role::Audio: return "audio";
+    case Role::Workers: return "workers";
+    case Role::Count: break;
+    }
+    return "?";
+}
+
+bool Plan::empty() const {
+    for (const CpuList& list : cpus) {
+        if (!list.empty()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+Plan automatic(const Topology& topology) {
+    // P-cores first, in the order the OS numbers them; E-cores after.
+    std::vector<int> order;
+    for (int pass = 0; pass < 2; ++pass) {
+        for (int core = 0; core < static_cast<int>(topology.cores.size()); ++core) {
+            if (topology.efficiencyCore(core) == (pass == 1)) {
+                order.push_back(core);
+            }
+        }
+    }
+    Plan plan;
+    if (order.size() < 4) {
+        return plan;
+    }
+    const auto cpusOf = [&](int core) { return topology.cores[static_cast<std::size_t>(core)]; };
+    plan[Role::Render] = cpusOf(order[0]);
+    plan[Role::Main] = cpusOf(order[1]);
+    plan[Role::Audio] = cpusOf(order.back());   // an E-core when there are any: it is last
+    for (std::size_t i = 2; i + 1 < order.size(); ++i) {
+        const CpuList cpus = cpusOf(order[i]);
+        plan[Role::Workers].insert(plan[Role::Workers].end(), cpus.begin(), cpus.end());
+    }
+    std::sort(plan[Role::Workers].begin(), plan[Role::Workers].end());
+    return plan;
+}
+
+bool parseCpuList(const std::string& text, CpuList& out) {
+    out.clear();
+    std::size_t i = 0;
+    while (i < text.size()) {
+        char* end = nullptr;
+        const long first = std::strtol(text.c_str() + i, &end, 10);
+        if (end == text.c_str() + i || first < 0) {
+            return false;
+        }
+        long last = first;
+        i = static_cast<std::size_t>(end - text.c_str());
+        if (i < text.size() && text[i] == '-') {
+            ++i;
+            last = std::strtol(text.c_str() + i, &end, 10);
+            if (end == text.c_str() + i || last < first) {
+                return false;
+            }
+            i = static_cast<std::size_t>(end - text.c_str());
+        }
+        for (long id = first; id <= last; ++id) {
+            out.push_back(static_cast<int>(id));
+        }
+        if (i < text.size() && text[i] != ',') {
+            return false;
+        }
+        i += i < text.size() ? 1 : 0;
+    }
+    return !out.empty();
+}
+
+std::string formatCpuList(const CpuList& cpus) {
+    CpuList sorted = cpus;
+    std::sort(sorted.begin(), sorted.end());
+    std::string text;
+    for (std::size_t i = 0; i < sorted.size();) {
+        std::size_t j = i;
+        while (j + 1 < sorted.size() && sorted[j + 1] <= sorted[j] + 1) {
+            ++j;
+        }
+        text += (text.empty() ? "" : ",") + std::to_string(sorted[i]);
+        if (sorted[j] != sorted[i]) {
+            text += "-" + std::to_string(sorted[j]);
+        }
+        i = j + 1;
+    }
+    return text;
+}
+
+void setPlan(const Plan& plan) {
+    gPlan = plan;
+}
+
+const Plan& plan() {
+    return gPlan;
+}
+
+bool pinThisThread(Role role) {
+    const CpuList& cpus = gPlan[role];
+    if (cpus.empty()) {
+        return true;
+    }
+#ifdef THREAD_AFFINITY_LINUX
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int id : cpus) {
+        if (id >= 0 && id < CPU_SETSIZE) {
+            CPU_SET(id, &set);
+        }
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
+
+} // namespace affinity
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Thread affinity
+// ---------------
+// Which cores the game's long-lived threads run on. The scheduler moves a thread whenever
+// it likes: the render thread waking on a core a worker is busy on, or on an SMT sibling
+// of one, loses a slice of its frame. Pinned, each latency-bound thread has a physical
+// core to itself and the workers share the rest.
+//
+// | Role    | Threads                                 | --affinity=auto                      |
+// | ------- | --------------------------------------- | ------------------------------------ |
+// | render  | RenderThread (GL submission)            | the first P-core, SMT siblings and   |
+// |         |                                         | all                                  |
+// | main    | the simulation / frame loop             | the next P-core                      |
+// | audio   | AudioMixer (a period every few ms)      | a core of its own: the last E-core   |
+// |         |                                         | on a hybrid CPU, else the last core  |
+// | workers | JobSystem workers, the render jobs      | every CPU of the remaining cores     |
+//
+// Other threads (loaders, log and trace writers, decoders) are left to the scheduler.
+// `auto` needs four physical cores the process may use; with fewer it pins nothing, as
+// taking two away from the workers would cost more than the jitter it saves. A role
+// given its own list (--affinity-render=0,16 ...) uses it instead of the automatic one.
+//
+// Topology (Linux sysfs): a physical core is a (package, core_id) pair of logical CPUs;
+// P/E cores come from /sys/devices/cpu_core and cpu_atom (Intel hybrid) or, failing
+// those, a cpu_capacity below the maximum (big.LITTLE). Only the CPUs in the process's
+// own affinity mask count, so `taskset` / cgroup limits are respected. Elsewhere
+// detect() sees one core per hardware thread and pinning is a no-op.
+namespace affinity {
+
+using CpuList = std::vector<int>;
+
+struct Cpu {
+    int id = 0;                 // logical CPU number, as the OS counts them
+    int package = 0;
+    int core = 0;               // index into Topology::cores
+    bool efficiency = false;    // an E-core / LITTLE core
+};
+
+struct Topology {
+    std::vector<Cpu> cpus;              // the usable ones, by id
+    std::vector<CpuList> cores;         // physical cores: their logical CPUs
+    bool hybrid = false;                // both P- and E-cores
+    bool smt = false;                   // some core has more than one CPU
+
+    int performanceCores() const;
+    bool efficiencyCore(int core) const;
+};
+
+Topology detect();
+
+// Size of CPU 0's data cache at `level` (1, 2, 3) in bytes; 0 when unknown. Read once
+// per level. On a hybrid CPU the E-cores' may differ; CPU 0 is a P-core.
+std::size_t cacheBytes(int level);
+
+enum class Role : std::uint8_t { Render, Main, Audio, Workers, Count };
+constexpr int kRoles = static_cast<int>(Role::Count);
+const char* roleName(Role role);
+
+// A CPU list per role; empty = not pinned.
+struct Plan {
+    CpuList cpus[kRoles];
+
+    CpuList& operator[](Role role) { return cpus[static_cast<int>(role)]; }
+    const CpuList& operator[](Role role) const { return cpus[static_cast<int>(role)]; }
+    bool empty() const;
+};
+
+// The layout in the table above; empty when the topology has too few cores.
+Plan automatic(const Topology& topology);
+
+// "0-3,8,10-11" (the kernel's cpulist format) and back.
+bool parseCpuList(const std::string& text, CpuList& out);
+std::string formatCpuList(const CpuList& cpus);
+
+// The process-wide plan. Set once at startup, before the threads it names are started.
+void setPlan(const Plan& plan);
+const Plan& plan();
+
+// Pins the calling thread to its role's CPUs; true when it was (or the role has none).
+// Threads call it first thing in their thread function.
+bool pinThisThread(Role role);
+
+} // namespace affinity
@@ -0,0 +1,139 @@
+#include "core/timer_wheel.h"
+
+#include <utility>
+
+TimerWheel::Handle TimerWheel::schedule(std::uint64_t delay, Callback callback, std::uint64_t interval) {
+    std::uint32_t n;
+    if (!free_.empty()) {
+        n = free_.back();
+        free_.pop_back();
+    } else {
+        n = static_cast<std::uint32_t>(nodes_.size());
+        nodes_.emplace_back();
+    }
+    Node& node = nodes_[n];
+    node.due = now_ + (delay > 0 ? delay : 1);
+    node.interval = interval;
+    node.callback = std::move(callback);
+    file(n);
+    ++stats_.scheduled;
+    ++stats_.active;
+    return Handle{n + 1, node.generation};
+}
+
+const TimerWheel::Node* TimerWheel::find(Handle handle) const {
+    if (handle.node == 0 || handle.node > nodes_.size()) {
+        return nullptr;
+    }
+    const Node& node = nodes_[handle.node - 1];
+    return node.generation == handle.generation && node.slot != kNil ? &node : nullptr;
+}
+
+bool TimerWheel::pending(Handle handle) const {
+    return find(handle) != nullptr;
+}
+
+bool TimerWheel::cancel(Handle handle) {
+    if (find(handle) == nullptr) {
+        return false;
+    }
+    unlink(handle.node - 1);
+    release(handle.node - 1);
+    ++stats_.cancelled;
+    --stats_.active;
+    return true;
+}
+
+// The lowest level whose span (the parent's slot) holds both now and the due tick: the
+// slot index there is then still ahead of now's, and comes round before the due tick.
+void TimerWheel::file(std::uint32_t n) {
+    Node& node = nodes_[n];
+    int level = 0;
+    while (level < kLevels - 1 && (node.due >> (kSlotBits * (level + 1))) != (now_ >> (kSlotBits * (level + 1)))) {
+        ++level;
+    }
+    const int shift = kSlotBits * level;
+    std::uint64_t index = node.due >> shift;
+    if (level == kLevels - 1 && index - (now_ >> shift) >= kSlots) {
+        index = (now_ >> shift) + kSlots - 1;   // past the wheel: re-filed from the last slot
+    }
+    const std::uint32_t slot = static_cast<std::uint32_t>(level) * kSlots + static_cast<std::uint32_t>(index & (kSlots - 1));
+    node.slot = slot;
+    node.prev = kNil;
+    node.next = heads_[slot];
+    if (node.next != kNil) {
+        nodes_[node.next].prev = n;
+    }
+    heads_[slot] = n;
+}
+
+void TimerWheel::unlink(std::uint32_t n) {
+    Node& node = nodes_[n];
+    if (node.prev != kNil) {
+        nodes_[node.prev].next = node.next;
+    } else {
+        heads_[node.slot] = node.next;
+    }
+    if (node.next != kNil) {
+        nodes_[node.next].prev = node.prev;
+    }
+    node.prev = node.next = node.slot = kNil;
+}
+
+void TimerWheel::release(std::uint32_t n) {
+    Node& node = nodes_[n];
+    node.callback = nullptr;
+    ++node.generation;                 // outstanding handles go stale
+    free_.push_back(n);
+}
+
+void TimerWheel::advance(std::uint64_t ticks) {
+    for (std::uint64_t t = 0; t < ticks; ++t) {
+        ++now_;
+        // A span ended at each level whose low bits all wrapped: its next slot comes down
+        // a level, the highest first (what it re-files may land in a lower one's slot).
+        int top = 0;
+        while (top < kLevels - 1 && (now_ & ((std::uint64_t{1} << (kSlotBits * (top + 1))) - 1)) == 0) {
+            ++top;
+        }
+        for (int level = top; level >= 1; --level) {
+            const std::uint32_t slot = static_cast<std::uint32_t>(level) * kSlots +
+                                       static_cast<std::uint32_t>((now_ >> (kSlotBits * level)) & (kSlots - 1));
+            std::uint32_t n = heads_[slot];
+            heads_[slot] = kNil;
+            while (n != kNil) {
+                const std::uint32_t next = nodes_[n].next;
+                file(n);
+                ++stats_.cascaded;
+                n = next;
+            }
+        }
+
+        // Everything in now's level-0 slot is due now. Taken one at a time from the head:
+        // a callback may cancel (unlink) any of the others.
+        const std::uint32_t slot = static_cast<std::uint32_t>(now_ & (kSlots - 1));
+        while (heads_[slot] != kNil) {
+            const std::uint32_t n = heads_[slot];
+            unlink(n);
+            Node& node = nodes_[n];
+            Callback callback = std::move(node.callback);   // nodes_ may grow under it
+            const std::uint64_t interval = node.interval;
+            std::uint32_t generation = 0;
+            if (interval > 0) {
+                node.due += interval;
+                generation = node.generation;
+                file(n);
+            } else {
+                release(n);
+                --stats_.active;
+            }
+            ++stats_.fired;
+            if (callback) {
+                callback();
+            }
+            if (interval > 0 && nodes_[n].generation == generation && nodes_[n].slot != kNil) {
+                nodes_[n].callback = std::move(callback);
+            }
+        }
+    }
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// TimerWheel
+// ----------
+// Gameplay timers on the fixed-step tick: "in 90 ticks", "every 30 ticks", without a
+// countdown per entity checked every step. A hierarchical timing wheel: kLevels wheels
+// of kSlots slots, level L's slots kSlots^L ticks wide.
+//
+//     level 0: 64 slots x 1 tick       due in this 64-tick span: on its tick
+//     level 1: 64 slots x 64 ticks     ... in this 4096-tick span: on its 64-tick span
+//     level 2: 64 slots x 4096 ticks
+//     level 3: 64 slots x 262144 ticks (2^24 ticks, 77 hours at 60 Hz; later ones wait
+//                                      in the slot before now's and are re-filed)
+//
+// | Operation   | Cost                                                               |
+// | ----------- | ------------------------------------------------------------------ |
+// | schedule    | O(1): a slot from the due tick's bits, a push onto its list        |
+// | cancel      | O(1): unlink (the lists are doubly linked through a node pool)     |
+// | advance     | one level-0 slot per tick: only the timers due fire; every 64      |
+// |             | ticks the next level's slot is re-filed one level down (cascade)   |
+//
+// A timer is re-filed at most kLevels - 1 times however long its delay, so a step costs
+// what expires (plus the cascades' share), not what is pending.
+//
+// Callbacks run inside advance(); those due on one tick run in no promised order (the
+// same one every run, so replays agree). They may schedule and cancel freely (including their own timer, and others due on the same
+// tick). A repeating timer is re-scheduled before its callback runs, so cancelling it
+// from there stops it. Handles are (node, generation): a stale one cancels nothing.
+class TimerWheel {
+public:
+    static constexpr int kLevels = 4;
+    static constexpr int kSlotBits = 6;
+    static constexpr std::uint32_t kSlots = 1u << kSlotBits;
+
+    using Callback = std::function<void()>;
+
+    struct Handle {
+        std::uint32_t node = 0;        // index + 1; 0: none
+        std::uint32_t generation = 0;
+        explicit operator bool() const { return node != 0; }
+    };
+
+    struct Stats {
+        std::uint64_t scheduled = 0;
+        std::uint64_t cancelled = 0;
+        std::uint64_t fired = 0;
+        std::uint64_t cascaded = 0;    // re-filings one level down
+        std::size_t active = 0;        // pending now
+    };
+
+    // `callback` after `delay` ticks (at least 1: the next advance), then every `interval`
+    // ticks if that is not 0.
+    Handle schedule(std::uint64_t delay, Callback callback, std::uint64_t interval = 0);
+    // False if it already fired (and doesn't repeat) or was cancelled.
+    bool cancel(Handle handle);
+    bool pending(Handle handle) const;
+
+    // One fixed step per tick.
+    void advance(std::uint64_t ticks = 1);
+    std::uint64_t now() const { return now_; }
+
+    const Stats& stats() const { return stats_; }
+
+private:
+    static constexpr std::uint32_t kNil = 0xffffffffu;
+
+    struct Node {
+        std::uint64_t due = 0;
+        std::uint64_t interval = 0;
+        Callback callback;
+        std::uint32_t prev = kNil, next = kNil;
+        std::uint32_t slot = kNil;     // level * kSlots + slot; kNil: not filed
+        std::uint32_t generation = 1;
+    };
+
+    void file(std::uint32_t node);
+    void unlink(std::uint32_t node);
+    void release(std::uint32_t node);
+    const Node* find(Handle handle) const;
+
+    std::vector<Node> nodes_;
+    std::vector<std::uint32_t> free_;
+    std::vector<std::uint32_t> heads_ = std::vector<std::uint32_t>(kLevels * kSlots, kNil);
+    std::uint64_t now_ = 0;
+    Stats stats_;
+};
@@ -0,0 +1,216 @@
+#include "core/transform_hierarchy.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "core/job_system.h"
+
+namespace {
+
+constexpr std::uint32_t kUnknown = TransformHierarchy::kNone - 1;
+constexpr std::uint32_t kDead = TransformHierarchy::kNone;
+
+const Affine2D kIdentity{glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f)};
+
+Affine2D toAffine(const TransformHierarchy::Local& local) {
+    const float c = std::cos(local.rotation);
+    const float s = std::sin(local.rotation);
+    return Affine2D{glm::vec3(c * local.scale.x, -s * local.scale.y, local.position.x),
+                    glm::vec3(s * local.scale.x, c * local.scale.y, local.position.y)};
+}
+
+} // namespace
+
+TransformHierarchy::NodeId TransformHierarchy::create(NodeId parent, const Local& local) {
+    NodeId id;
+    if (!free_.empty()) {
+        id = free_.back();
+        free_.pop_back();
+    } else {
+        id = static_cast<NodeId>(slots_.size());
+        slots_.push_back(kNone);
+    }
+    slots_[id] = static_cast<std::uint32_t>(ids_.size());
+    ids_.push_back(id);
+    parents_.push_back(alive(parent) ? slots_[parent] : kNone);
+    depths_.push_back(0);
+    local_.push_back(local);
+    world_.push_back(kIdentity);
+    dirty_.push_back(1);
+    layoutDirty_ = true;
+    return id;
+}
+
+void TransformHierarchy::destroy(NodeId node) {
+    if (!alive(node)) {
+        return;
+    }
+    // Its descendants still point at this index; rebuild() finds them through it.
+    ids_[slots_[node]] = kNone;
+    slots_[node] = kNone;
+    free_.push_back(node);
+    layoutDirty_ = true;
+}
+
+bool TransformHierarchy::setParent(NodeId node, NodeId parent) {
+    if (!alive(node) || (parent != kNone && !alive(parent))) {
+        return false;
+    }
+    const std::uint32_t index = slots_[node];
+    if (parent != kNone) {
+        for (std::uint32_t i = slots_[parent]; i != kNone; i = parents_[i]) {
+            if (i == index) {
+                return false;             // parent is in node's subtree: a cycle
+            }
+        }
+    }
+    parents_[index] = parent == kNone ? kNone : slots_[parent];
+    dirty_[index] = 1;
+    layoutDirty_ = true;
+    return true;
+}
+
+void TransformHierarchy::setLocal(NodeId node, const Local& local) {
+    const std::uint32_t index = slots_[node];
+    local_[index] = local;
+    dirty_[index] = 1;
+    if (!layoutDirty_) {
+        levelDirty_[depths_[index]] = 1;  // otherwise rebuild() recomputes them all
+    }
+}
+
+TransformHierarchy::NodeId TransformHierarchy::parent(NodeId node) const {
+    const std::uint32_t p = parents_[slots_[node]];
+    return p == kNone ? kNone : ids_[p];
+}
+
+void TransformHierarchy::rebuild() {
+    const std::size_t n = ids_.size();
+
+    // Depth of every node, by walking up to the first ancestor whose depth is known.
+    // A destroyed node (or one under it) is kDead.
+    std::vector<std::uint32_t> depth(n, kUnknown);
+    std::vector<std::uint32_t> chain;
+    std::uint32_t levels = 0;
+    for (std::uint32_t i = 0; i < n; ++i) {
+        std::uint32_t j = i;
+        while (j != kNone && depth[j] == kUnknown && ids_[j] != kNone) {
+            chain.push_back(j);
+            j = parents_[j];
+        }
+        if (j != kNone && depth[j] == kUnknown) {
+            depth[j] = kDead;             // ids_[j] == kNone: destroyed
+        }
+        const std::uint32_t base = j == kNone ? 0 : depth[j] == kDead ? kDead : depth[j] + 1;
+        for (std::size_t k = chain.size(); k-- > 0;) {
+            const std::uint32_t d = base == kDead ? kDead : base + static_cast<std::uint32_t>(chain.size() - 1 - k);
+            depth[chain[k]] = d;
+            if (d != kDead) levels = std::max(levels, d + 1);
+        }
+        chain.clear();
+    }
+
+    // Counting sort by depth (stable: siblings keep their order); the dead are dropped.
+    levelStart_.assign(levels + 1, 0);
+    for (std::uint32_t i = 0; i < n; ++i) {
+        if (depth[i] != kDead) {
+            ++levelStart_[depth[i] + 1];
+        } else if (ids_[i] != kNone) {
+            slots_[ids_[i]] = kNone;      // under a destroyed node: destroyed with it
+            free_.push_back(ids_[i]);
+        }
+    }
+    for (std::uint32_t l = 0; l < levels; ++l) {
+        levelStart_[l + 1] += levelStart_[l];
+    }
+    const std::uint32_t live = levelStart_[levels];
+    std::vector<std::uint32_t> next(levelStart_.begin(), levelStart_.end() - 1);
+    std::vector<std::uint32_t> moved(n, kNone);
+    for (std::uint32_t i = 0; i < n; ++i) {
+        if (depth[i] != kDead) {
+            moved[i] = next[depth[i]]++;
+        }
+    }
+
+    std::vector<NodeId> ids(live);
+    std::vector<std::uint32_t> parents(live);
+    std::vector<std::uint32_t> depths(live);
+    std::vector<Local> local(live);
+    std::vector<Affine2D> world(live);
+    std::vector<std::uint8_t> dirty(live);
+    levelDirty_.assign(levels, 0);
+    for (std::uint32_t i = 0; i < n; ++i) {
+        const std::uint32_t to = moved[i];
+        if (to == kNone) {
+            continue;
+        }
+        ids[to] = ids_[i];
+        parents[to] = parents_[i] == kNone ? kNone : moved[parents_[i]];
+        depths[to] = depth[i];
+        local[to] = local_[i];
+        world[to] = world_[i];
+        dirty[to] = dirty_[i];
+        slots_[ids_[i]] = to;
+        levelDirty_[depth[i]] |= dirty_[i];
+    }
+    ids_.swap(ids);
+    parents_.swap(parents);
+    depths_.swap(depths);
+    local_.swap(local);
+    world_.swap(world);
+    dirty_.swap(dirty);
+    layoutDirty_ = false;
+}
+
+void TransformHierarchy::updateRange(std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+        const std::uint32_t p = parents_[i];
+        if (p != kNone && dirty_[p]) {
+            dirty_[i] = 1;
+        }
+        if (dirty_[i]) {
+            world_[i] = p == kNone ? toAffine(local_[i]) : combineAffine2D(world_[p], toAffine(local_[i]));
+        }
+    }
+}
+
+void TransformHierarchy::update(JobSystem* jobs, std::size_t grain) {
+    if (layoutDirty_) {
+        rebuild();
+    }
+    const std::size_t levels = levelStart_.size() - 1;
+    stats_.nodes = ids_.size();
+    stats_.levels = levels;
+    stats_.updated = 0;
+    stats_.levelsSkipped = 0;
+
+    // A level is looked at only if something in it was set dirty or the level above it
+    // had dirty nodes (which make their children dirty).
+    bool above = false;
+    for (std::size_t l = 0; l < levels; ++l) {
+        const std::size_t begin = levelStart_[l];
+        const std::size_t end = levelStart_[l + 1];
+        if (!levelDirty_[l] && !above) {
+            ++stats_.levelsSkipped;
+            continue;
+        }
+        if (jobs && end - begin >= 2 * grain) {
+            jobs->parallelFor(end - begin, grain,
+                              [this, begin](std::size_t b, std::size_t e) { updateRange(begin + b, begin + e); });
+        } else {
+            updateRange(begin, end);
+        }
+        const std::size_t dirty = static_cast<std::size_t>(std::count(
+            dirty_.begin() + static_cast<std::ptrdiff_t>(begin), dirty_.begin() + static_cast<std::ptrdiff_t>(end), 1));
+        stats_.updated += dirty;
+        above = dirty > 0;
+        levelDirty_[l] = 1;               // looked at: its flags are cleared below
+    }
+    // Clear only after the last level: each level reads its parents' flags.
+    for (std::size_t l = 0; l < levels; ++l) {
+        if (levelDirty_[l]) {
+            std::fill(dirty_.begin() + levelStart_[l], dirty_.begin() + levelStart_[l + 1], 0);
+            levelDirty_[l] = 0;
+        }
+    }
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "core/batch_transform.h"
+
+class JobSystem;
+
+// A node's transform relative to its parent (to the world, for a root).
+struct LocalTransform2D {
+    glm::vec2 position{0.0f};
+    float rotation = 0.0f;              // radians, counter-clockwise
+    glm::vec2 scale{1.0f};
+};
+
+// TransformHierarchy
+// ------------------
+// Parent/child 2D transforms: a node's world transform is its parent's world transform
+// times its own local one (position, rotation, scale). Stored as flat arrays sorted by
+// depth—every root, then every child of a root, then their children...—so parents always
+// come before their children and one front-to-back pass computes every world transform:
+//
+//     index   0    1    2  |  3    4    5    6  |  7    8
+//     depth   0    0    0  |  1    1    1    1  |  2    2
+//     parent  -    -    -  |  0    0    2    2  |  3    6
+//
+// Only what changed is recomputed. setLocal marks a node dirty; update() carries the
+// flag down (a child of a dirty node is dirty) and skips every level with nothing dirty
+// in it or above it, so moving one root costs its subtree, not the whole hierarchy:
+//
+// | Call                      | Effect                                                  |
+// | ------------------------- | ------------------------------------------------------- |
+// | setLocal(node, local)     | node dirty: it and its subtree recompute on update()     |
+// | create / setParent        | re-sorts the arrays on the next update() (one O(n) pass) |
+// | destroy(node)             | node and its subtree go away on the next update()        |
+// | update(jobs)              | level by level; a level's nodes are independent (their   |
+// |                           | parents are all in earlier levels), so a big level is    |
+// |                           | split across the JobSystem, then the next one starts     |
+//
+// world() and worldMatrix() are valid after update(); a node created since then reads
+// the identity. NodeIds are reused after destroy: like an index, drop it with the node.
+class TransformHierarchy {
+public:
+    using NodeId = std::uint32_t;
+    static constexpr NodeId kNone = ~0u;
+
+    using Local = LocalTransform2D;
+
+    struct Stats {
+        std::size_t nodes = 0;
+        std::size_t levels = 0;
+        std::size_t updated = 0;        // world transforms recomputed by the last update()
+        std::size_t levelsSkipped = 0;  // levels it didn't look at (nothing dirty)
+    };
+
+    NodeId create(NodeId parent = kNone, const Local& local = Local{});
+    void destroy(NodeId node);
+    // false (and nothing changes) if parent is node or one of its descendants.
+    bool setParent(NodeId node, NodeId parent);
+    void setLocal(NodeId node, const Local& local);
+
+    bool alive(NodeId node) const { return node < slots_.size() && slots_[node] != kNone; }
+    const Local& local(NodeId node) const { return local_[slots_[node]]; }
+    NodeId parent(NodeId node) const;
+
+    // jobs: split levels of at least `grain` nodes across it; null: all on this thread.
+    void update(JobSystem* jobs = nullptr, std::size_t grain = 2048);
+
+    const Affine2D& world(NodeId node) const { return world_[slots_[node]]; }
+    glm::mat4 worldMatrix(NodeId node) const { return fromAffine2D(world(node)); }
+
+    // Every node's world transform in depth order (parents first), valid after update().
+    std::size_t size() const { return ids_.size(); }
+    const Affine2D* worlds() const { return world_.data(); }
+    const Stats& stats() const { return stats_; }
+
+private:
+    void rebuild();
+    void updateRange(std::size_t begin, std::size_t end);
+
+    // Sorted by depth; index = position in these arrays.
+    std::vector<NodeId> ids_;             // kNone: destroyed, dropped by rebuild()
+    std::vector<std::uint32_t> parents_;  // index of the parent, kNone for roots
+    std::vector<std::uint32_t> depths_;
+    std::vector<Local> local_;
+    std::vector<Affine2D> world_;
+    std::vector<std::uint8_t> dirty_;
+
+    std::vector<std::uint32_t> slots_;    // NodeId → index, kNone: free
+    std::vector<NodeId> free_;
+    std::vector<std::uint32_t> levelStart_{0};  // level L: [levelStart_[L], levelStart_[L + 1])
+    std::vector<std::uint8_t> levelDirty_;      // something in level L was set dirty
+    bool layoutDirty_ = false;
+    Stats stats_;
+};
@@ -0,0 +1,77 @@
+#include "core/triangulate.h"
+
+namespace {
+
+// > 0: a, b, c turn left (counter-clockwise).
+float cross(const glm::vec2& a, const glm::vec2& b, const glm::vec2& c) {
+    return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+}
+
+// Inside or on the edge of the counter-clockwise triangle a, b, c: a vertex touching the
+// ear's diagonal blocks it too.
+bool inTriangle(const glm::vec2& p, const glm::vec2& a, const glm::vec2& b, const glm::vec2& c) {
+    return cross(a, b, p) >= 0.0f && cross(b, c, p) >= 0.0f && cross(c, a, p) >= 0.0f;
+}
+
+} // namespace
+
+bool triangulatePolygon(const glm::vec2* points, std::size_t count, std::vector<std::uint16_t>& indices) {
+    indices.clear();
+    if (count < 3 || count > 65536) {
+        return false;
+    }
+    float area = 0.0f;
+    for (std::size_t i = 0, j = count - 1; i < count; j = i++) {
+        area += points[j].x * points[i].y - points[i].x * points[j].y;
+    }
+    if (area == 0.0f) {
+        return false;
+    }
+
+    // The remaining outline as a ring, always counter-clockwise.
+    std::vector<std::uint16_t> ring(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        ring[i] = static_cast<std::uint16_t>(area > 0.0f ? i : count - 1 - i);
+    }
+    indices.reserve((count - 2) * 3);
+    bool simple = true;
+    std::size_t i = 0;
+    std::size_t misses = 0;            // vertices tried since the last clip
+    while (ring.size() > 3) {
+        const std::size_t n = ring.size();
+        i %= n;
+        const std::uint16_t a = ring[(i + n - 1) % n];
+        const std::uint16_t b = ring[i];
+        const std::uint16_t c = ring[(i + 1) % n];
+        const float turn = cross(points[a], points[b], points[c]);
+        bool ear = turn > 0.0f;
+        for (std::size_t k = 0; ear && k < n; ++k) {
+            const std::uint16_t v = ring[k];
+            if (v == a || v == b || v == c || points[v] == points[a] || points[v] == points[b] ||
+                points[v] == points[c]) {
+                continue;
+            }
+            const bool reflex = cross(points[ring[(k + n - 1) % n]], points[v], points[ring[(k + 1) % n]]) <= 0.0f;
+            ear = !(reflex && inTriangle(points[v], points[a], points[b], points[c]));
+        }
+        if (turn == 0.0f || ear || misses >= n) {
+            if (turn == 0.0f) {
+                // Collinear: no triangle, the vertex just goes.
+            } else if (turn > 0.0f) {
+                indices.insert(indices.end(), {a, b, c});
+                simple = simple && ear;
+            } else {
+                simple = false;        // nothing clips cleanly: drop a reflex vertex
+            }
+            ring.erase(ring.begin() + static_cast<std::ptrdiff_t>(i));
+            misses = 0;
+            continue;
+        }
+        ++i;
+        ++misses;
+    }
+    if (cross(points[ring[0]], points[ring[1]], points[ring[2]]) > 0.0f) {
+        indices.insert(indices.end(), {ring[0], ring[1], ring[2]});
+    }
+    return simple;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// triangulatePolygon
+// ------------------
+// Ear clipping for one simple polygon, convex or concave, in either winding: `indices`
+// gets (count - 2) triangles into `points`, counter-clockwise, fewer if some vertices
+// are collinear (they are dropped, not turned into slivers).
+//
+//     repeat until 3 vertices are left:
+//         find an ear: a convex vertex whose triangle with its two neighbours holds no
+//                      other remaining vertex (reflex ones are the only candidates)
+//         emit that triangle, unlink the vertex
+//
+// O(n^2) in the outline's vertices: meant for shapes of tens to a few hundred, done once
+// at load and cached (render/shape_cache.h), not per frame. false: the outline crosses
+// itself or is degenerate, so at some point no vertex was an ear; the rest is clipped
+// anyway (something gets drawn) but may overlap. Under 3 points, or more than 16-bit
+// indices hold: false and nothing.
+bool triangulatePolygon(const glm::vec2* points, std::size_t count, std::vector<std::uint16_t>& indices);
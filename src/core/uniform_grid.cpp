@@ -0,0 +1,219 @@
+#include "core/uniform_grid.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "core/spatial_query.h"
+
+int UniformGrid::cellOf(float v) const {
+    return static_cast<int>(std::floor(v * invCellSize_));
+}
+
+UniformGrid::CellRange UniformGrid::rangeOf(const Aabb& bounds) const {
+    return CellRange{cellOf(bounds.min.x), cellOf(bounds.min.y), cellOf(bounds.max.x), cellOf(bounds.max.y)};
+}
+
+void UniformGrid::clear() {
+    cells_.clear();
+    records_.clear();
+    seen_.clear();
+    count_ = 0;
+}
+
+void UniformGrid::rebuild(const Aabb* bounds, std::size_t count) {
+    clear();
+    records_.resize(count);
+    cells_.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        insert(static_cast<ObjectId>(i), bounds[i]);
+    }
+}
+
+void UniformGrid::link(ObjectId id, const CellRange& range) {
+    for (int cy = range.y0; cy <= range.y1; ++cy) {
+        for (int cx = range.x0; cx <= range.x1; ++cx) {
+            cells_[key(cx, cy)].push_back(id);
+        }
+    }
+}
+
+void UniformGrid::unlink(ObjectId id, const CellRange& range) {
+    for (int cy = range.y0; cy <= range.y1; ++cy) {
+        for (int cx = range.x0; cx <= range.x1; ++cx) {
+            auto it = cells_.find(key(cx, cy));
+            if (it == cells_.end()) {
+                continue;
+            }
+            // Order inside a cell doesn't matter: swap with the last entry and pop.
+            std::vector<ObjectId>& list = it->second;
+            auto pos = std::find(list.begin(), list.end(), id);
+            if (pos != list.end()) {
+                *pos = list.back();
+                list.pop_back();
+            }
+        }
+    }
+}
+
+void UniformGrid::insert(ObjectId id, const Aabb& bounds) {
+    if (id >= records_.size()) {
+        records_.resize(id + 1);
+    }
+    Record& r = records_[id];
+    if (r.present) {
+        update(id, bounds);
+        return;
+    }
+    r.bounds = bounds;
+    r.cells = rangeOf(bounds);
+    r.present = true;
+    link(id, r.cells);
+    ++count_;
+}
+
+void UniformGrid::update(ObjectId id, const Aabb& bounds) {
+    if (id >= records_.size() || !records_[id].present) {
+        insert(id, bounds);
+        return;
+    }
+    Record& r = records_[id];
+    r.bounds = bounds;
+    const CellRange range = rangeOf(bounds);
+    if (range == r.cells) {
+        return; // still in the same cells: nothing to relink
+    }
+    unlink(id, r.cells);
+    link(id, range);
+    r.cells = range;
+}
+
+void UniformGrid::remove(ObjectId id) {
+    if (id >= records_.size() || !records_[id].present) {
+        return;
+    }
+    unlink(id, records_[id].cells);
+    records_[id].present = false;
+    --count_;
+}
+
+void UniformGrid::queryRect(const Aabb& rect, std::vector<ObjectId>& out) const {
+    if (seen_.size() < records_.size()) {
+        seen_.resize(records_.size(), 0);
+    }
+    if (++stamp_ == 0) { // wrapped: old stamps could collide, start over
+        std::fill(seen_.begin(), seen_.end(), 0);
+        stamp_ = 1;
+    }
+
+    auto visit = [&](const std::vector<ObjectId>& list) {
+        for (ObjectId id : list) {
+            if (seen_[id] != stamp_ && records_[id].bounds.overlaps(rect)) {
+                seen_[id] = stamp_;
+                out.push_back(id);
+            }
+        }
+    };
+
+    const CellRange range = rangeOf(rect);
+    const double span = (static_cast<double>(range.x1) - range.x0 + 1) *
+                        (static_cast<double>(range.y1) - range.y0 + 1);
+    if (span > static_cast<double>(cells_.size())) {
+        // Query covers more cells than exist (zoomed far out): walk the occupied ones.
+        for (const auto& cell : cells_) {
+            visit(cell.second);
+        }
+        return;
+    }
+    for (int cy = range.y0; cy <= range.y1; ++cy) {
+        for (int cx = range.x0; cx <= range.x1; ++cx) {
+            auto it = cells_.find(key(cx, cy));
+            if (it != cells_.end()) {
+                visit(it->second);
+            }
+        }
+    }
+}
+
+void UniformGrid::queryPoint(const glm::vec2& point, std::vector<ObjectId>& out) const {
+    // A point lies in exactly one cell, so no duplicates are possible here.
+    auto it = cells_.find(key(cellOf(point.x), cellOf(point.y)));
+    if (it == cells_.end()) {
+        return;
+    }
+    for (ObjectId id : it->second) {
+        if (records_[id].bounds.contains(point)) {
+            out.push_back(id);
+        }
+    }
+}
+
+void UniformGrid::sweep(SweepTester& tester) const {
+    // Walk the cells under the swept box one column of the major axis (the one the sweep
+    // moves along most) at a time, in the direction of travel. Column c is crossed for
+    // t in [enter, leave]; the rows the box covers meanwhile are the minor extent of the
+    // segment over that t range, grown by half. Columns come in increasing `enter`, and a
+    // box first touched at t lies in a column crossed at t, so once a column starts past
+    // the closest hit nothing further can be nearer.
+    const SweepQuery& q = tester.query();
+    const int a = std::fabs(q.delta.x) >= std::fabs(q.delta.y) ? 0 : 1;
+    const int b = 1 - a;
+    const float lo = std::min(q.origin[a], q.origin[a] + q.delta[a]) - q.half[a];
+    const float hi = std::max(q.origin[a], q.origin[a] + q.delta[a]) + q.half[a];
+    const int c0 = cellOf(lo), c1 = cellOf(hi);
+    // The rows of one column: its width plus the two halves, and at most as much again
+    // along the minor axis (|delta[b]| <= |delta[a]|).
+    const double rows = std::ceil((2.0 * cellSize_ + 2.0 * q.half[a] + 2.0 * q.half[b]) * invCellSize_) + 1.0;
+    if ((static_cast<double>(c1) - c0 + 1.0) * rows > static_cast<double>(cells_.size())) {
+        // Longer than there are occupied cells (a ray across the level): test those.
+        for (const auto& cell : cells_) {
+            for (ObjectId id : cell.second) {
+                tester.test(id, records_[id].bounds);
+            }
+            tester.flush();
+            if (tester.done()) {
+                return;
+            }
+        }
+        return;
+    }
+    const bool forward = q.delta[a] >= 0.0f;
+    const float inverse = std::fabs(q.delta[a]) > 1e-30f ? 1.0f / q.delta[a] : 0.0f;
+    for (int step = 0; step <= c1 - c0; ++step) {
+        const int c = forward ? c0 + step : c1 - step;
+        float enter = 0.0f, leave = 1.0f;
+        if (inverse != 0.0f) {
+            const float t0 = (static_cast<float>(c) * cellSize_ - q.half[a] - q.origin[a]) * inverse;
+            const float t1 = (static_cast<float>(c + 1) * cellSize_ + q.half[a] - q.origin[a]) * inverse;
+            enter = std::max(std::min(t0, t1), 0.0f);
+            leave = std::min(std::max(t0, t1), 1.0f);
+        }
+        if (enter >= tester.limit()) {
+            return;
+        }
+        const float m0 = q.origin[b] + q.delta[b] * enter;
+        const float m1 = q.origin[b] + q.delta[b] * leave;
+        const int r0 = cellOf(std::min(m0, m1) - q.half[b]), r1 = cellOf(std::max(m0, m1) + q.half[b]);
+        for (int r = r0; r <= r1; ++r) {
+            auto it = cells_.find(a == 0 ? key(c, r) : key(r, c));
+            if (it == cells_.end()) {
+                continue;
+            }
+            for (ObjectId id : it->second) {
+                tester.test(id, records_[id].bounds);
+            }
+        }
+        tester.flush();
+        if (tester.done()) {
+            return;
+        }
+    }
+}
+
+std::size_t UniformGrid::memoryBytes() const {
+    std::size_t bytes = records_.capacity() * sizeof(Record) + seen_.capacity() * sizeof(std::uint32_t);
+    bytes += cells_.bucket_count() * sizeof(void*);
+    for (const auto& cell : cells_) {
+        bytes += sizeof(cell) + 2 * sizeof(void*) + cell.second.capacity() * sizeof(ObjectId);
+    }
+    return bytes;
+}
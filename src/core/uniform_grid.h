@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "core/spatial_index.h"
+
+// UniformGrid
+// -----------
+// Spatial hash: the plane is cut into square cells of `cellSize` world units, and each
+// cell that contains anything has a list of the objects overlapping it. Cells live in a
+// hash map keyed by their integer coordinates, so the world is unbounded and empty space
+// costs nothing.
+//
+//     cell(x, y) = (floor(x / cellSize), floor(y / cellSize))
+//
+// | Operation       | Cost                                                          |
+// | --------------- | ------------------------------------------------------------- |
+// | queryRect       | cells under the rect + their objects (≈ visible objects)       |
+// | queryPoint      | one cell                                                      |
+// | update (moved)  | O(1) if the object still covers the same cells (most frames)  |
+//
+// Pick cellSize around the typical object size (1-4x): much smaller and objects sit in
+// many cells; much larger and each cell holds many objects a query has to reject.
+// Very uneven density (crowds here, emptiness there) is what LooseQuadtree is for.
+class UniformGrid : public SpatialIndex {
+public:
+    explicit UniformGrid(float cellSize = 0.25f) : cellSize_(cellSize), invCellSize_(1.0f / cellSize) {}
+
+    void clear() override;
+    void rebuild(const Aabb* bounds, std::size_t count) override;
+    void insert(ObjectId id, const Aabb& bounds) override;
+    void update(ObjectId id, const Aabb& bounds) override;
+    void remove(ObjectId id) override;
+
+    void queryRect(const Aabb& rect, std::vector<ObjectId>& out) const override;
+    void queryPoint(const glm::vec2& point, std::vector<ObjectId>& out) const override;
+    void sweep(SweepTester& tester) const override;
+
+    std::size_t size() const override { return count_; }
+    std::size_t memoryBytes() const override;
+
+    float cellSize() const { return cellSize_; }
+    std::size_t cellCount() const { return cells_.size(); }
+
+private:
+    struct CellRange {
+        int x0, y0, x1, y1;
+        bool operator==(const CellRange& o) const {
+            return x0 == o.x0 && y0 == o.y0 && x1 == o.x1 && y1 == o.y1;
+        }
+    };
+    struct Record {
+        Aabb bounds;
+        CellRange cells;
+        bool present = false;
+    };
+
+    static std::uint64_t key(int cx, int cy) {
+        return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(cx)) << 32) |
+               static_cast<std::uint32_t>(cy);
+    }
+    int cellOf(float v) const;
+    CellRange rangeOf(const Aabb& bounds) const;
+    void link(ObjectId id, const CellRange& range);
+    void unlink(ObjectId id, const CellRange& range);
+
+    float cellSize_;
+    float invCellSize_;
+    std::unordered_map<std::uint64_t, std::vector<ObjectId>> cells_;
+    std::vector<Record> records_;              // indexed by id
+    std::size_t count_ = 0;
+
+    // Objects spanning several cells are found once per cell: a per-query stamp
+    // filters the repeats without a set or a sort.
+    mutable std::vector<std::uint32_t> seen_;
+    mutable std::uint32_t stamp_ = 0;
+};
@@ -0,0 +1,158 @@
+#include "core/vfs.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <sys/stat.h>
+
+#include "core/file_io.h"
+#include "core/pack_file.h"
+
+namespace vfs {
+
+namespace {
+
+std::vector<std::unique_ptr<PackFile>> gPacks; // newest last; written by mount() only
+const EmbeddedFile* gEmbedded = nullptr;
+std::size_t gEmbeddedCount = 0;
+
+std::atomic<std::uint64_t> gEmbeddedReads{0};
+std::atomic<std::uint64_t> gPackReads{0};
+std::atomic<std::uint64_t> gZeroCopy{0};
+std::atomic<std::uint64_t> gLooseReads{0};
+std::atomic<std::uint64_t> gMisses{0};
+
+const EmbeddedFile* findEmbedded(const std::string& path) {
+    const EmbeddedFile* end = gEmbedded + gEmbeddedCount;
+    const EmbeddedFile* it = std::lower_bound(gEmbedded, end, path, [](const EmbeddedFile& f, const std::string& p) {
+        return std::strcmp(f.path, p.c_str()) < 0;
+    });
+    return it != end && path == it->path ? it : nullptr;
+}
+
+// The pack entry for a normalized path, newest pack first.
+const PackFile::Entry* findPacked(const std::string& path, const PackFile** pack) {
+    for (auto it = gPacks.rbegin(); it != gPacks.rend(); ++it) {
+        if (const PackFile::Entry* entry = (*it)->find(path)) {
+            *pack = it->get();
+            return entry;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace
+
+bool mount(const std::string& packPath) {
+    auto pack = std::make_unique<PackFile>();
+    if (!pack->open(packPath)) {
+        return false;
+    }
+    gPacks.push_back(std::move(pack));
+    return true;
+}
+
+void mountEmbedded(const EmbeddedFile* files, std::size_t count) {
+    gEmbedded = files;
+    gEmbeddedCount = count;
+}
+
+void unmountAll() {
+    gPacks.clear();
+    gEmbedded = nullptr;
+    gEmbeddedCount = 0;
+}
+
+std::size_t mountedPacks() {
+    return gPacks.size();
+}
+
+std::size_t embeddedFiles() {
+    return gEmbeddedCount;
+}
+
+std::string normalize(const std::string& path) {
+    std::size_t start = 0;
+    while (path.compare(start, 2, "./") == 0) {
+        start += 2;
+    }
+    return path.substr(start);
+}
+
+bool exists(const std::string& path) {
+    const std::string name = normalize(path);
+    const PackFile* pack = nullptr;
+    if (findEmbedded(name) || findPacked(name, &pack)) {
+        return true;
+    }
+    struct stat st;
+    return stat(name.c_str(), &st) == 0;
+}
+
+bool read(const std::string& path, Blob& out) {
+    const std::string name = normalize(path);
+    if (const EmbeddedFile* file = findEmbedded(name)) {
+        gEmbeddedReads.fetch_add(1, std::memory_order_relaxed);
+        out.setView(file->data, file->size);
+        return true;
+    }
+    const PackFile* pack = nullptr;
+    if (const PackFile::Entry* entry = findPacked(name, &pack)) {
+        gPackReads.fetch_add(1, std::memory_order_relaxed);
+        if (const unsigned char* data = pack->data(*entry)) {
+            gZeroCopy.fetch_add(1, std::memory_order_relaxed);
+            out.setView(data, entry->size);
+            return true;
+        }
+        std::vector<unsigned char>& buffer = out.owned();
+        buffer.resize(entry->size);
+        if (!pack->read(*entry, buffer.data())) {
+            buffer.clear();
+            return false;
+        }
+        return true;
+    }
+    if (!::readFile(name, out.owned())) {
+        gMisses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    gLooseReads.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool readFile(const std::string& path, std::string& out) {
+    Blob blob;
+    if (!read(path, blob)) {
+        out.clear();
+        return false;
+    }
+    out.assign(reinterpret_cast<const char*>(blob.data()), blob.size());
+    return true;
+}
+
+bool readFile(const std::string& path, std::vector<unsigned char>& out) {
+    Blob blob;
+    if (!read(path, blob)) {
+        out.clear();
+        return false;
+    }
+    if (blob.zeroCopy()) {
+        out.assign(blob.data(), blob.data() + blob.size());
+    } else {
+        out = std::move(blob.owned());
+    }
+    return true;
+}
+
+Stats stats() {
+    Stats s;
+    s.embeddedReads = gEmbeddedReads.load(std::memory_order_relaxed);
+    s.packReads = gPackReads.load(std::memory_order_relaxed);
+    s.zeroCopy = gZeroCopy.load(std::memory_order_relaxed);
+    s.looseReads = gLooseReads.load(std::memory_order_relaxed);
+    s.misses = gMisses.load(std::memory_order_relaxed);
+    return s;
+}
+
+} // namespace vfs
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "core/embedded_files.h"
+
+// Virtual file system
+// -------------------
+// The one place loaders (shaders, textures, ...) get file contents from. A path is looked
+// up in the files compiled into the executable first (core/embedded_files.h), then the
+// mounted packs (core/pack_file.h), newest mount first, then on disk relative to the
+// working directory:
+//
+// | Source            | open() calls | Copy                                            |
+// | ----------------- | ------------ | ----------------------------------------------- |
+// | embedded          | none         | none: a Blob points at the constant array       |
+// | pack, stored      | none         | none: a Blob points into the mapping            |
+// | pack, LZ4         | none         | one: decoded straight into the Blob's buffer    |
+// | loose file        | one          | one: readFile (core/file_io.h)                  |
+//
+// Without a pack everything comes from loose files, exactly as before; with one, files
+// it lacks still do (handy for a patch on top of a shipped pack).
+//
+// mount() happens at startup, before loader threads start; lookups after that only
+// read, so any thread may call them concurrently.
+namespace vfs {
+
+// File contents: either a view into a mapped pack or an owned buffer.
+class Blob {
+public:
+    const unsigned char* data() const { return view_ ? view_ : owned_.data(); }
+    std::size_t size() const { return view_ ? viewSize_ : owned_.size(); }
+    bool zeroCopy() const { return view_ != nullptr; }
+
+    void setView(const unsigned char* data, std::size_t size) {
+        owned_.clear();
+        view_ = data;
+        viewSize_ = size;
+    }
+    std::vector<unsigned char>& owned() {
+        view_ = nullptr;
+        viewSize_ = 0;
+        return owned_;
+    }
+
+private:
+    const unsigned char* view_ = nullptr;
+    std::size_t viewSize_ = 0;
+    std::vector<unsigned char> owned_;
+};
+
+struct Stats {
+    std::uint64_t embeddedReads = 0; // compiled into the executable
+    std::uint64_t packReads = 0;   // found in a pack
+    std::uint64_t zeroCopy = 0;    // ...of which stored, read in place
+    std::uint64_t looseReads = 0;  // from disk
+    std::uint64_t misses = 0;      // found nowhere
+};
+
+// Opens a pack (which stays mapped until unmountAll) and puts it in front of the others.
+bool mount(const std::string& packPath);
+// Puts a table of embedded files (sorted by path, as embed_tool writes it) before all packs.
+void mountEmbedded(const EmbeddedFile* files, std::size_t count);
+void unmountAll();
+std::size_t mountedPacks();
+std::size_t embeddedFiles();
+
+// "./shaders/x.glsl" → "shaders/x.glsl": the form pack paths are stored in.
+std::string normalize(const std::string& path);
+
+bool exists(const std::string& path);
+
+// false (and the Blob empty) if the path is nowhere or a packed entry is corrupt.
+bool read(const std::string& path, Blob& out);
+// The same, always copied into the caller's container.
+bool readFile(const std::string& path, std::string& out);
+bool readFile(const std::string& path, std::vector<unsigned char>& out);
+
+Stats stats();
+
+} // namespace vfs
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// WorkStealingDeque<T, Capacity>
+// ------------------------------
+// Chase-Lev deque: ONE owner thread pushes and pops at the bottom (LIFO, so it keeps
+// working on what it just created—still in cache), any number of other threads steal
+// from the top (FIFO, the oldest and usually biggest pieces of work).
+//
+//          steal() ──► top │ job │ job │ job │ job │ bottom ◄── push() / pop()
+//                          (thieves)                  (owner only)
+//
+// Owner push/pop touch only `bottom_` in the common case; the single contended
+// operation is the CAS on `top_` when owner and thief race for the LAST element (or two
+// thieves for the same one). Memory orders follow Lê, Pop, Cohen & Zappa Nardelli,
+// "Correct and Efficient Work-Stealing for Weak Memory Models" (PPoPP 2013).
+//
+// Fixed capacity (power of two): push() fails when full and the caller runs the work
+// itself. T must be trivially copyable and lock-free as an atomic (pointers are).
+template <typename T, std::size_t Capacity>
+class WorkStealingDeque {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    // Owner only.
+    bool push(T item) {
+        const std::int64_t b = bottom_.load(std::memory_order_relaxed);
+        const std::int64_t t = top_.load(std::memory_order_acquire);
+        if (b - t >= static_cast<std::int64_t>(Capacity)) {
+            return false; // full
+        }
+        items_[b & kMask].store(item, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(b + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Owner only.
+    bool pop(T& out) {
+        const std::int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t t = top_.load(std::memory_order_relaxed);
+        if (t > b) {
+            bottom_.store(b + 1, std::memory_order_relaxed); // was empty
+            return false;
+        }
+        out = items_[b & kMask].load(std::memory_order_relaxed);
+        if (t == b) {
+            // Last element: a thief may be taking it right now; whoever moves top_ wins.
+            const bool won = top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                                          std::memory_order_relaxed);
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    // Any thread.
+    bool steal(T& out) {
+        std::int64_t t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const std::int64_t b = bottom_.load(std::memory_order_acquire);
+        if (t >= b) {
+            return false; // empty
+        }
+        out = items_[t & kMask].load(std::memory_order_relaxed);
+        // Lost to the owner or another thief: report empty, the caller tries elsewhere.
+        return top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    }
+
+    // Approximate (racy) size, for heuristics and stats only.
+    std::size_t size() const {
+        const std::int64_t n = bottom_.load(std::memory_order_relaxed) - top_.load(std::memory_order_relaxed);
+        return n > 0 ? static_cast<std::size_t>(n) : 0;
+    }
+
+private:
+    static constexpr std::int64_t kMask = static_cast<std::int64_t>(Capacity) - 1;
+
+    // top_ (thieves) and bottom_ (owner) on separate cache lines.
+    alignas(64) std::atomic<std::int64_t> top_{0};
+    alignas(64) std::atomic<std::int64_t> bottom_{0};
+    alignas(64) std::atomic<T> items_[Capacity];
+};
@@ -0,0 +1,178 @@
+#include "core/world_gen.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace {
+
+std::uint32_t hashTile(std::uint32_t seed, int x, int y) {
+    std::uint32_t h = seed * 0x9e3779b9u ^ static_cast<std::uint32_t>(x) * 374761393u ^
+                      static_cast<std::uint32_t>(y) * 668265263u;
+    h = (h ^ (h >> 13)) * 1274126177u;
+    return h ^ (h >> 16);
+}
+
+// Distance from `point` to the box [lo, hi].
+float distanceTo(const glm::vec2& lo, const glm::vec2& hi, const glm::vec2& point) {
+    return glm::length(glm::max(glm::max(lo - point, point - hi), glm::vec2(0.0f)));
+}
+
+} // namespace
+
+WorldGenerator::WorldGenerator(JobSystem& jobs, const Settings& settings)
+    : jobs_(jobs), settings_(settings) {
+    chunksX_ = (std::max(settings.width, 1) + kChunkTiles - 1) / kChunkTiles;
+    chunksY_ = (std::max(settings.height, 1) + kChunkTiles - 1) / kChunkTiles;
+    chunks_.reset(new Chunk[static_cast<std::size_t>(chunksX_) * chunksY_]);
+    // The seed picks where in the (endless) noise plane the map lies: a few thousand tiles
+    // apart per seed, each field at its own place.
+    const float shift = static_cast<float>(hashTile(settings.seed, 0, 0) % 4096u) * 37.0f;
+    height_.octaves = 5;
+    height_.frequency = 1.0f / std::max(settings.featureTiles, 1.0f);
+    height_.offset = glm::vec2(shift, 0.5f * shift);
+    moisture_.octaves = 3;
+    moisture_.frequency = 2.0f * height_.frequency;
+    moisture_.offset = glm::vec2(-0.5f * shift, shift + 1000.0f);
+}
+
+WorldGenerator::~WorldGenerator() {
+    jobs_.wait(pending_);   // they write the chunks
+}
+
+void WorldGenerator::generate(int chunk, std::uint16_t* ground, std::uint16_t* decoration) const {
+    const int x0 = chunkX(chunk);
+    const int y0 = chunkY(chunk);
+    float fields[2 * kChunkTiles];     // (height, moisture) per tile, as supplyFields() takes them
+    float height[kChunkTiles];
+    float moisture[kChunkTiles];
+    for (int row = 0; row < kChunkTiles; ++row) {
+        const float centreY = static_cast<float>(y0 + row) + 0.5f;     // tile centres
+        noise::fbmRow(height_, static_cast<float>(x0) + 0.5f, 1.0f, centreY, kChunkTiles, height);
+        noise::fbmRow(moisture_, static_cast<float>(x0) + 0.5f, 1.0f, centreY, kChunkTiles, moisture);
+        for (int i = 0; i < kChunkTiles; ++i) {
+            fields[2 * i] = height[i];
+            fields[2 * i + 1] = moisture[i];
+        }
+        classifyRow(chunk, row, fields, ground + row * kChunkTiles, decoration + row * kChunkTiles);
+    }
+}
+
+void WorldGenerator::classifyRow(int chunk, int row, const float* fields, std::uint16_t* ground,
+                                 std::uint16_t* decoration) const {
+    const Palette& palette = settings_.palette;
+    const int y = chunkY(chunk) + row;
+    for (int i = 0; i < kChunkTiles; ++i) {
+        const int x = chunkX(chunk) + i;
+        if (x >= settings_.width || y >= settings_.height) {
+            ground[i] = decoration[i] = 0;
+            continue;
+        }
+        const float e = fields[2 * i];
+        const std::uint32_t hash = hashTile(settings_.seed, x, y);
+        ground[i] = e < -0.12f ? 0 : e < -0.06f ? palette.sand : e < 0.25f ? palette.grass : palette.rock;
+        decoration[i] = ground[i] == palette.grass && fields[2 * i + 1] > 0.15f && hash % 8u == 0u ? palette.tree
+                        : ground[i] == palette.rock && hash % 12u == 0u                           ? palette.boulder
+                                                                                                   : 0;
+    }
+}
+
+void WorldGenerator::supplyFields(int chunk, const float* fields, std::size_t stride) {
+    const auto start = std::chrono::steady_clock::now();
+    Chunk& c = chunks_[chunk];
+    constexpr std::size_t kTiles = static_cast<std::size_t>(kChunkTiles) * kChunkTiles;
+    for (int row = 0; row < kChunkTiles; ++row) {
+        classifyRow(chunk, row, fields + static_cast<std::size_t>(row) * stride, c.tiles.data() + row * kChunkTiles,
+                    c.tiles.data() + kTiles + row * kChunkTiles);
+    }
+    c.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    c.state.store(State::Ready, std::memory_order_release);
+}
+
+void WorldGenerator::generateJob(void* context, std::size_t begin, std::size_t end) {
+    WorldGenerator& self = *static_cast<WorldGenerator*>(context);
+    constexpr std::size_t kTiles = static_cast<std::size_t>(kChunkTiles) * kChunkTiles;
+    for (std::size_t c = begin; c < end; ++c) {
+        const auto start = std::chrono::steady_clock::now();
+        Chunk& chunk = self.chunks_[c];
+        self.generate(static_cast<int>(c), chunk.tiles.data(), chunk.tiles.data() + kTiles);
+        chunk.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        chunk.state.store(State::Ready, std::memory_order_release);
+    }
+}
+
+const std::uint16_t* WorldGenerator::tiles(int chunk, int layer) const {
+    return chunks_[chunk].tiles.data() + static_cast<std::size_t>(layer) * kChunkTiles * kChunkTiles;
+}
+
+void WorldGenerator::update(const glm::vec2& focus, const glm::vec2& velocity, std::vector<int>& placed,
+                            std::vector<int>* fieldRequests) {
+    // The chunks handed out last time have been read.
+    for (int c : handedOut_) {
+        std::vector<std::uint16_t>().swap(chunks_[c].tiles);
+    }
+    handedOut_.clear();
+
+    // Queue the empty chunks in reach of the focus or of where it is heading, nearest first.
+    const float chunkWorld = static_cast<float>(kChunkTiles) * settings_.tileSize;
+    const glm::vec2 lead = focus + velocity * settings_.leadSeconds;
+    const float radius = settings_.loadRadius;
+    const glm::vec2 lo = (glm::min(focus, lead) - radius - settings_.origin) / chunkWorld;
+    const glm::vec2 hi = (glm::max(focus, lead) + radius - settings_.origin) / chunkWorld;
+    const int cx0 = std::max(0, static_cast<int>(std::floor(lo.x)));
+    const int cy0 = std::max(0, static_cast<int>(std::floor(lo.y)));
+    const int cx1 = std::min(chunksX_ - 1, static_cast<int>(std::floor(hi.x)));
+    const int cy1 = std::min(chunksY_ - 1, static_cast<int>(std::floor(hi.y)));
+    candidates_.clear();
+    for (int cy = cy0; cy <= cy1; ++cy) {
+        for (int cx = cx0; cx <= cx1; ++cx) {
+            const int c = cy * chunksX_ + cx;
+            if (chunks_[c].state.load(std::memory_order_relaxed) != State::Empty) {
+                continue;
+            }
+            const glm::vec2 min = settings_.origin + glm::vec2(static_cast<float>(cx), static_cast<float>(cy)) * chunkWorld;
+            const glm::vec2 max = min + chunkWorld;
+            const float d = std::min(distanceTo(min, max, focus), distanceTo(min, max, lead));
+            if (d <= radius) {
+                candidates_.emplace_back(d, c);
+            }
+        }
+    }
+    std::sort(candidates_.begin(), candidates_.end());
+    constexpr std::size_t kTiles = static_cast<std::size_t>(kLayers) * kChunkTiles * kChunkTiles;
+    for (const auto& candidate : candidates_) {
+        if (inFlight_.size() >= settings_.maxInFlight) {
+            break;
+        }
+        const int c = candidate.second;
+        chunks_[c].tiles.resize(kTiles);   // here, not in the job: main owns the allocations
+        chunks_[c].state.store(State::Generating, std::memory_order_relaxed);
+        if (fieldRequests) {
+            fieldRequests->push_back(c);   // supplyFields() makes it Ready
+        } else {
+            jobs_.run(&WorldGenerator::generateJob, this, static_cast<std::size_t>(c), static_cast<std::size_t>(c) + 1,
+                      &pending_);
+        }
+        inFlight_.push_back(c);
+        ++stats_.generated;
+    }
+    jobs_.poll(pending_);   // --jobs=0: the chunks generate here, or never
+
+    // Hand out the finished ones, in the order they were queued.
+    std::size_t budget = settings_.budget;
+    for (std::size_t i = 0; i < inFlight_.size() && budget > 0;) {
+        const int c = inFlight_[i];
+        if (chunks_[c].state.load(std::memory_order_acquire) != State::Ready) {
+            ++i;
+            continue;
+        }
+        chunks_[c].state.store(State::Placed, std::memory_order_relaxed);
+        placed.push_back(c);
+        handedOut_.push_back(c);
+        stats_.generateMs += chunks_[c].ms;
+        ++stats_.placed;
+        --budget;
+        inFlight_.erase(inFlight_.begin() + static_cast<std::ptrdiff_t>(i));
+    }
+    stats_.generating = inFlight_.size();
+}
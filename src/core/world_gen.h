@@ -0,0 +1,141 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "core/job_system.h"
+#include "core/noise.h"
+
+// WorldGenerator
+// --------------
+// A tile world that does not exist until the camera comes near it. The map is a grid of
+// chunks (the tilemap's, 32² tiles); each chunk's tiles are a pure function of the seed
+// and its position, worked out on the job system when the camera's reach first touches
+// it, and handed to the caller a few chunks per frame:
+//
+//     Empty ──in reach of focus + lead──▶ Generating ──job: noise rows──▶ Ready
+//     Ready ──update() hands it out (budget per call)──▶ Placed
+//
+// | Thread        | Does                                                              |
+// | ------------- | ----------------------------------------------------------------- |
+// | main, update  | chunks in reach, nearest first, queued (at most maxInFlight jobs  |
+// |               | at once); Ready ones handed out, their buffers then freed         |
+// | worker (job)  | one chunk: per tile row, a fbmRow of height and one of moisture   |
+// |               | (SSE2, core/noise.h), classified into ground and decoration tiles |
+// | GL, --procgen | supplyFields(): the fields the GPU rendered and read back for a   |
+// | -gpu          | chunk, classified the same way                                    |
+//
+// Reach is a radius around the focus moved `leadSeconds` ahead along its velocity, so a
+// camera panning east gets the chunks east of the screen first. A Placed chunk stays:
+// the tilemap keeps its tiles (its chunk slots are fixed; nothing to give back), and a
+// second visit costs nothing. Generating everything is never needed, so the map can be
+// far larger than anything loaded at startup; it is bounded only by the tilemap's.
+//
+// Layer 0 is the ground: water (empty), sand, grass or rock by height. Layer 1 is
+// decoration: trees on wet grass, boulders on rock, hashed sparse per tile. Which tile
+// id each of those is comes from the Palette. The decoration is deterministic too, so
+// whatever needs the map before it is placed (pathfinding) follows the chunks' tiles as
+// they are handed out, like a level's regions.
+//
+// The noise can come from the GPU instead (--procgen-gpu, render/gpu_noise.h): update()
+// then lists the chunks it queues in `fieldRequests` rather than running jobs, and
+// whoever computed a chunk's height and moisture fields passes them to supplyFields(),
+// which only classifies them into tiles. Either way the fields are the same fBm
+// (heightField(), moistureField()), up to float rounding.
+//
+// A chunk's state is an atomic: the job's (or supplyFields()'s) release store publishes
+// its tiles, update()'s acquire load sees them. The main thread never waits on the
+// jobs, unless there are no workers to run them (JobSystem::poll); the destructor waits
+// for the ones still running.
+class WorldGenerator {
+public:
+    static constexpr int kChunkTiles = 32;
+    static constexpr int kLayers = 2;
+
+    enum class State : std::uint8_t { Empty, Generating, Ready, Placed };
+
+    struct Palette {
+        std::uint16_t sand = 0, grass = 0, rock = 0;   // layer 0; water is 0 (no tile)
+        std::uint16_t tree = 0, boulder = 0;           // layer 1
+    };
+
+    struct Settings {
+        std::uint32_t seed = 1;
+        int width = 1024;              // tiles; a multiple of kChunkTiles
+        int height = 1024;
+        float tileSize = 0.25f;        // world units per tile
+        glm::vec2 origin{0.0f};        // world position of tile (0, 0)'s lower-left corner
+        float featureTiles = 96.0f;    // size of the largest landmasses, in tiles
+        float loadRadius = 3.0f;       // world units around the led focus
+        float leadSeconds = 0.5f;      // how far ahead of a moving focus to look
+        std::size_t budget = 4;        // chunks handed out per update()
+        std::size_t maxInFlight = 32;  // generation jobs queued at once
+        Palette palette;
+    };
+
+    struct Stats {
+        std::uint64_t generated = 0;   // chunks queued
+        std::uint64_t placed = 0;
+        std::size_t generating = 0;    // queued or ready, not handed out
+        double generateMs = 0.0;       // summed over the placed chunks' jobs (or classifying)
+    };
+
+    WorldGenerator(JobSystem& jobs, const Settings& settings);
+    ~WorldGenerator();
+    WorldGenerator(const WorldGenerator&) = delete;
+    WorldGenerator& operator=(const WorldGenerator&) = delete;
+
+    // Main thread, once per frame. Appends chunks whose tiles are now ready to `placed`;
+    // read them with tiles() before the next update(). With `fieldRequests`, the chunks
+    // queued are appended there instead of generated on the job system.
+    void update(const glm::vec2& focus, const glm::vec2& velocity, std::vector<int>& placed,
+                std::vector<int>* fieldRequests = nullptr);
+    // Any thread, once per requested chunk: its fields, (height, moisture) per tile,
+    // kChunkTiles pairs per row from its lower-left, rows `stride` floats apart.
+    void supplyFields(int chunk, const float* fields, std::size_t stride);
+
+    // A handed-out chunk's tiles of `layer`, kChunkTiles² row-major from its lower-left.
+    const std::uint16_t* tiles(int chunk, int layer) const;
+    // A chunk's first tile.
+    int chunkX(int chunk) const { return chunk % chunksX_ * kChunkTiles; }
+    int chunkY(int chunk) const { return chunk / chunksX_ * kChunkTiles; }
+
+    int chunkCount() const { return chunksX_ * chunksY_; }
+    State state(int chunk) const { return chunks_[chunk].state.load(std::memory_order_acquire); }
+    const Settings& settings() const { return settings_; }
+    // The fBm of each field, in tiles: sampled at tile centres (x + 0.5, y + 0.5).
+    const noise::Fbm& heightField() const { return height_; }
+    const noise::Fbm& moistureField() const { return moisture_; }
+    const Stats& stats() const { return stats_; }
+
+    // The tiles of a chunk, straight away, on the calling thread: what its job does.
+    void generate(int chunk, std::uint16_t* ground, std::uint16_t* decoration) const;
+
+private:
+    struct Chunk {
+        std::atomic<State> state{State::Empty};
+        std::vector<std::uint16_t> tiles;      // kLayers x kChunkTiles², while Generating / Ready
+        double ms = 0.0;                       // the job's time
+    };
+
+    static void generateJob(void* context, std::size_t begin, std::size_t end);
+    // One row of a chunk's fields into its ground and decoration tiles.
+    void classifyRow(int chunk, int row, const float* fields, std::uint16_t* ground, std::uint16_t* decoration) const;
+
+    JobSystem& jobs_;
+    Settings settings_;
+    noise::Fbm height_;
+    noise::Fbm moisture_;
+    int chunksX_ = 0;
+    int chunksY_ = 0;
+    std::unique_ptr<Chunk[]> chunks_;
+    std::vector<int> inFlight_;                // Generating or Ready
+    std::vector<int> handedOut_;               // the last update()'s: buffers freed next call
+    std::vector<std::pair<float, int>> candidates_;
+    JobCounter pending_;
+    Stats stats_;
+};
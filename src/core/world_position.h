@@ -0,0 +1,54 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cmath>
+
+// WorldPosition
+// -------------
+// A point anywhere in a large world: which sector it is in (integers, 1024 units on a
+// side) and where inside that sector (a float, always under 1024, so never coarser than
+// 1/16384 of a unit).
+//
+// A float world position is only as fine as its magnitude allows. Ten kilometres out,
+// adjacent floats are a millimetre apart. That is fine for the simulation, but not for
+// the GPU. viewProjection * model * vertex multiplies those large numbers together and
+// only then subtracts the camera's equally large position. The rounding that is left
+// over shows up as vertices jittering by a pixel whenever the camera moves. Drawing
+// camera-relative avoids that subtraction on the GPU:
+//
+// | Where                                 | In                                          |
+// | ------------------------------------- | ------------------------------------------- |
+// | FramePacket::origin                   | the main camera's position, as a            |
+// |                                       | WorldPosition (0 on the sprite batch path)  |
+// | composeModelMatrices, composeAffine2D | instance translations minus the origin:     |
+// | (core/batch_transform.h)              | small floats near the camera                |
+// | CameraBlock::relativeViewProjection   | viewProjection * translate(origin), built   |
+// |                                       | in double: the camera-to-origin offset is   |
+// |                                       | exact, and small too                        |
+// | shaders/vertex.glsl, INSTANCED        | relativeViewProjection * aModel             |
+//
+// relative() is the kernels' subtraction. The point minus the sector's corner is exact
+// (the two are close, and the corner, a power-of-two multiple, is exactly a float).
+// Subtracting the in-sector offset then rounds once, at the result's small magnitude.
+struct WorldPosition {
+    static constexpr float kSectorSize = 1024.0f;  // a power of two: sector * size is exact
+
+    glm::ivec2 sector{0};
+    glm::vec2 offset{0.0f};                        // [0, kSectorSize) on each axis
+
+    static WorldPosition at(const glm::dvec2& world) {
+        const glm::dvec2 sector = glm::floor(world / static_cast<double>(kSectorSize));
+        return WorldPosition{glm::ivec2(sector),
+                             glm::vec2(world - sector * static_cast<double>(kSectorSize))};
+    }
+
+    // The sector's lower-left corner.
+    glm::vec2 base() const { return glm::vec2(sector) * kSectorSize; }
+    glm::dvec2 world() const { return glm::dvec2(sector) * static_cast<double>(kSectorSize) + glm::dvec2(offset); }
+
+    // A float world point relative to this one.
+    glm::vec2 relative(const glm::vec2& point) const { return (point - base()) - offset; }
+
+    bool operator==(const WorldPosition& other) const { return sector == other.sector && offset == other.offset; }
+    bool operator!=(const WorldPosition& other) const { return !(*this == other); }
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+
+#include "core/spatial_index.h"
+
+// Game components
+// ---------------
+// Plain data, one struct per concern; an entity is whatever set of these it was created
+// with (see ecs/world.h). Systems select entities by the components they touch:
+//
+// | System    | Reads                          | Writes           |
+// | --------- | ------------------------------ | ---------------- |
+// | snapshot  | Position                       | PreviousPosition |
+// | movement  | Controllable, PlayerInput      | Velocity, Scale  |
+// | integrate | Velocity                       | Position         |
+// | collide   | Position, Velocity, Scale,     | Position,        |
+// |           | Collider                       | Velocity         |
+// | flow      | Position, FlowFollower         | Velocity         |
+// | boids     | Position, Velocity, Boid       | Velocity         |
+// | bounce    | Position, BounceArea           | Velocity         |
+// | (render)  | Position, PreviousPosition, Rotation, Scale, Color, SpriteRef, | — |
+// |           | ZLayer                         |                  |
+struct Position { glm::vec2 value; };
+struct PreviousPosition { glm::vec2 value; };  // last step's Position, for interpolation
+struct Velocity { glm::vec2 value; };          // world units per second
+struct Rotation { float radians; };
+struct Scale { glm::vec2 value; };
+struct Color { std::uint32_t rgba; };          // packColor
+// TextureAtlas image id (render/texture_atlas.h), or animatedSprite(clip): a clip of the
+// AnimationClipTable (render/sprite_animation.h) playing since SimState::time `start`.
+struct SpriteRef {
+    std::uint32_t id;
+    float start = 0.0f;
+    float rate = 1.0f;                         // times the clip's own fps
+};
+struct ZLayer { std::uint16_t value; };        // draw order, higher in front (texture-array path)
+struct Controllable { float speed; };          // moved by the movement keys
+struct PlayerInput { std::uint64_t actions; };  // this step's ActionMask (the keys, or a client's)
+struct BounceArea { Aabb area; };              // velocity reflects at the edges
+struct Collider { float inverseMass; };        // pushed apart from other Colliders; 0: immovable
+struct FlowFollower { float speed; };         // steered down the flow field (core/flow_field.h)
+struct Boid { float maxSpeed; };               // flocks with the other Boids (core/boids.h)
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <tuple>
+#include <vector>
+
+#include "core/job_system.h"
+#include "ecs/world.h"
+
+// Parallel chunk iteration
+// ------------------------
+// forEachChunk's chunks, spread over the JobSystem's threads:
+//
+//     parallelForEachChunk<Position, Velocity>(world, jobs, [dt](std::size_t n, Position* p, Velocity* v) {
+//         for (std::size_t i = 0; i < n; ++i) p[i].value += v[i].value * dt;
+//     });
+//
+// A chunk is the unit of work: one thread owns it for the call, so a system that only
+// writes the arrays it was handed needs no synchronization. fn runs concurrently on
+// different chunks—it must not touch shared state (or the World's structure) itself.
+//
+// ChunkSpan also carries each chunk's FIRST row in iteration order (the running total of
+// the counts before it), so a pass that writes one output element per entity—render
+// extraction—can give every chunk its own slice of a single output array.
+
+template <typename... Ts>
+struct ChunkSpan {
+    std::size_t first;                // rows in all the chunks before this one
+    std::size_t count;
+    const EntityHandle* handles;
+    std::tuple<Ts*...> arrays;
+};
+
+// The chunks forEachChunk<Ts...> would visit, in the same order. Returns the row total.
+template <typename... Ts>
+std::size_t collectChunks(World& world, std::vector<ChunkSpan<Ts...>>& out) {
+    out.clear();
+    std::size_t rows = 0;
+    world.forEachChunkWithHandles<Ts...>([&](std::size_t n, const EntityHandle* h, Ts*... arrays) {
+        out.push_back(ChunkSpan<Ts...>{rows, n, h, std::tuple<Ts*...>(arrays...)});
+        rows += n;
+    });
+    return rows;
+}
+
+// fn(count, Ts*... arrays) per chunk, `chunksPerJob` chunks per job; returns when every
+// chunk is done. The chunk list is a per-thread scratch vector (no allocation once it has
+// grown), so calls must not nest for the same Ts.
+template <typename... Ts, typename Fn>
+void parallelForEachChunk(World& world, JobSystem& jobs, Fn&& fn, std::size_t chunksPerJob = 4) {
+    static thread_local std::vector<ChunkSpan<Ts...>> scratch;
+    std::vector<ChunkSpan<Ts...>>& chunks = scratch; // the jobs must see THIS thread's list
+    collectChunks<Ts...>(world, chunks);
+    jobs.parallelFor(chunks.size(), chunksPerJob, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t c = begin; c < end; ++c) {
+            std::apply([&](Ts*... arrays) { fn(chunks[c].count, arrays...); }, chunks[c].arrays);
+        }
+    });
+}
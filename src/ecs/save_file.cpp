@@ -0,0 +1,387 @@
+#include "ecs/save_file.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "core/mapped_file.h"
+
+namespace {
+
+constexpr char kMagic[4] = {'S', 'A', 'V', '1'};
+constexpr std::size_t kAlignment = 16;
+
+struct SaveHeader {
+    char magic[4];                     // "SAV1"
+    std::uint32_t version;
+    std::uint32_t chunkBytes;          // kChunkBytes of the writer
+    std::uint32_t componentCount;
+    std::uint32_t archetypeCount;
+    std::uint32_t freeHead;
+    std::uint32_t namesSize;
+    std::uint32_t reserved;
+    std::uint64_t slotCount;
+    std::uint64_t chunkCount;
+    std::uint64_t alive;
+    std::uint64_t tick;
+    std::uint64_t chunksOffset;        // chunk i is at chunksOffset + i * chunkBytes
+    std::uint64_t fileSize;            // a truncated file is caught at load()
+};
+static_assert(sizeof(SaveHeader) == 80, "save header layout");
+
+struct SaveComponent {
+    std::uint32_t nameOffset;          // into the names
+    std::uint32_t nameLength;
+    std::uint32_t size;
+    std::uint32_t align;
+};
+
+struct SaveArchetype {
+    ComponentMask mask;                // of the saved component ids
+    std::uint64_t size;                // rows
+    std::uint32_t capacity;            // rows per chunk
+    std::uint32_t firstChunk;          // its chunks are consecutive in the chunk table
+    std::uint32_t chunkCount;
+    std::uint32_t reserved;
+    std::uint32_t offset[kMaxComponents];   // per saved component id, as Archetype::offset
+};
+static_assert(sizeof(SaveArchetype) == 32 + 4 * kMaxComponents, "save archetype layout");
+
+struct SaveChunk {
+    std::uint64_t offset;              // from the start of the file
+    std::uint32_t archetype;
+    std::uint32_t count;
+};
+
+struct SaveSlot {
+    std::uint32_t archetype, chunk, row;
+    std::uint32_t generation;
+    std::uint32_t nextFree;
+    std::uint32_t alive;
+};
+
+std::size_t alignUp(std::size_t n, std::size_t a) { return (n + a - 1) / a * a; }
+
+// Where each table starts; the reader and the writer share it, so they can't disagree.
+struct TableLayout {
+    std::size_t components, archetypes, chunks, slots, names, end;
+};
+
+TableLayout tableLayout(const SaveHeader& h) {
+    TableLayout layout;
+    layout.components = alignUp(sizeof(SaveHeader), kAlignment);
+    layout.archetypes = alignUp(layout.components + h.componentCount * sizeof(SaveComponent), kAlignment);
+    layout.chunks = alignUp(layout.archetypes + h.archetypeCount * sizeof(SaveArchetype), kAlignment);
+    layout.slots = alignUp(layout.chunks + h.chunkCount * sizeof(SaveChunk), kAlignment);
+    layout.names = alignUp(layout.slots + h.slotCount * sizeof(SaveSlot), kAlignment);
+    layout.end = layout.names + h.namesSize;
+    return layout;
+}
+
+} // namespace
+
+namespace savefile {
+
+// World's side: its private parts, for the two functions below.
+struct Access {
+    static bool write(const World& world, std::uint64_t tick, const std::string& path, std::string* error);
+    static bool load(World& world, const std::string& path, std::uint64_t* tick, LoadStats* stats,
+                     std::string* error);
+};
+
+bool Access::write(const World& world, std::uint64_t tick, const std::string& path, std::string* error) {
+    auto fail = [&](const std::string& why) {
+        if (error) *error = why;
+        return false;
+    };
+    SaveHeader header{};
+    std::memcpy(header.magic, kMagic, 4);
+    header.version = kVersion;
+    header.chunkBytes = static_cast<std::uint32_t>(kChunkBytes);
+    header.componentCount = ecs_detail::componentCount();
+    header.archetypeCount = static_cast<std::uint32_t>(world.archetypes_.size());
+    header.freeHead = world.freeHead_;
+    header.slotCount = world.slots_.size();
+    header.chunkCount = world.chunkCount();
+    header.alive = world.alive_;
+    header.tick = tick;
+    std::string names;
+    for (ComponentId id = 0; id < header.componentCount; ++id) {
+        names += ecs_detail::componentName(id);
+    }
+    header.namesSize = static_cast<std::uint32_t>(names.size());
+    const TableLayout layout = tableLayout(header);
+    header.chunksOffset = alignUp(layout.end, kChunkBytes);
+    header.fileSize = header.chunksOffset + header.chunkCount * kChunkBytes;
+
+    // Everything before the chunks is built here; the chunks go out as they are.
+    std::vector<unsigned char> out(header.chunksOffset, 0);
+    std::memcpy(out.data(), &header, sizeof(header));
+    std::uint32_t nameOffset = 0;
+    for (ComponentId id = 0; id < header.componentCount; ++id) {
+        const std::uint32_t length = static_cast<std::uint32_t>(std::strlen(ecs_detail::componentName(id)));
+        const SaveComponent component{nameOffset, length, static_cast<std::uint32_t>(ecs_detail::componentSize(id)),
+                                      static_cast<std::uint32_t>(ecs_detail::componentAlign(id))};
+        std::memcpy(out.data() + layout.components + id * sizeof(SaveComponent), &component, sizeof(component));
+        nameOffset += length;
+    }
+    std::uint32_t chunk = 0;
+    for (std::size_t i = 0; i < world.archetypes_.size(); ++i) {
+        const World::Archetype& a = world.archetypes_[i];
+        SaveArchetype record{};
+        record.mask = a.mask;
+        record.size = a.size;
+        record.capacity = a.capacity;
+        record.firstChunk = chunk;
+        record.chunkCount = static_cast<std::uint32_t>(a.chunks.size());
+        std::copy(std::begin(a.offset), std::end(a.offset), record.offset);
+        std::memcpy(out.data() + layout.archetypes + i * sizeof(SaveArchetype), &record, sizeof(record));
+        for (const World::Chunk& c : a.chunks) {
+            const SaveChunk entry{header.chunksOffset + std::uint64_t(chunk) * kChunkBytes,
+                                  static_cast<std::uint32_t>(i), c.count};
+            std::memcpy(out.data() + layout.chunks + chunk * sizeof(SaveChunk), &entry, sizeof(entry));
+            ++chunk;
+        }
+    }
+    for (std::size_t s = 0; s < world.slots_.size(); ++s) {
+        const World::Slot& slot = world.slots_[s];
+        const SaveSlot record{slot.location.archetype, slot.location.chunk, slot.location.row, slot.generation,
+                              slot.nextFree, slot.alive ? 1u : 0u};
+        std::memcpy(out.data() + layout.slots + s * sizeof(SaveSlot), &record, sizeof(record));
+    }
+    std::memcpy(out.data() + layout.names, names.data(), names.size());
+
+    const std::string temporary = path + ".tmp";
+    std::FILE* file = std::fopen(temporary.c_str(), "wb");
+    if (!file) {
+        return fail("cannot create " + temporary);
+    }
+    bool written = std::fwrite(out.data(), 1, out.size(), file) == out.size();
+    for (const World::Archetype& a : world.archetypes_) {
+        for (const World::Chunk& c : a.chunks) {
+            written = written && std::fwrite(c.data.get(), 1, kChunkBytes, file) == kChunkBytes;
+        }
+    }
+    if (std::fclose(file) != 0 || !written) {
+        std::remove(temporary.c_str());
+        return fail("cannot write " + temporary);
+    }
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        return fail("cannot replace " + path);
+    }
+    return true;
+}
+
+bool Access::load(World& world, const std::string& path, std::uint64_t* tick, LoadStats* stats,
+                  std::string* error) {
+    auto fail = [&](const std::string& why) {
+        if (error) *error = path + ": " + why;
+        return false;
+    };
+    auto file = std::make_shared<MappedFile>();
+    if (!file->openCopyOnWrite(path)) {
+        return fail("cannot read it");
+    }
+    unsigned char* base = file->writableData();
+    const std::size_t size = file->size();
+
+    // Check every table before touching the World.
+    SaveHeader header;
+    if (size < sizeof(header)) {
+        return fail("too short");
+    }
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, kMagic, 4) != 0 || header.version != kVersion) {
+        return fail("not a version " + std::to_string(kVersion) + " save");
+    }
+    if (header.chunkBytes != kChunkBytes || header.componentCount > kMaxComponents || header.fileSize != size) {
+        return fail("written by another build, or truncated");
+    }
+    if (header.slotCount > size / sizeof(SaveSlot) || header.chunkCount > size / kChunkBytes ||
+        header.archetypeCount > size / sizeof(SaveArchetype)) {
+        return fail("corrupt tables");
+    }
+    const TableLayout layout = tableLayout(header);
+    if (layout.end > header.chunksOffset || header.chunksOffset % kChunkBytes != 0 ||
+        header.chunksOffset + header.chunkCount * kChunkBytes != size) {
+        return fail("corrupt tables");
+    }
+
+    // Saved component id → this process's, by type name.
+    ComponentId remap[kMaxComponents];
+    const char* names = reinterpret_cast<const char*>(base + layout.names);
+    for (std::uint32_t c = 0; c < header.componentCount; ++c) {
+        SaveComponent component;
+        std::memcpy(&component, base + layout.components + c * sizeof(SaveComponent), sizeof(component));
+        if (std::size_t(component.nameOffset) + component.nameLength > header.namesSize) {
+            return fail("corrupt component table");
+        }
+        const std::string name(names + component.nameOffset, component.nameLength);
+        remap[c] = ecs_detail::findComponent(name.c_str());
+        if (remap[c] == kMaxComponents) {
+            continue;           // only an error if an archetype uses it (below)
+        }
+        if (ecs_detail::componentSize(remap[c]) != component.size ||
+            ecs_detail::componentAlign(remap[c]) != component.align) {
+            return fail("component " + name + " has changed");
+        }
+    }
+    const SaveArchetype* archetypes = reinterpret_cast<const SaveArchetype*>(base + layout.archetypes);
+    const SaveChunk* chunks = reinterpret_cast<const SaveChunk*>(base + layout.chunks);
+    const SaveSlot* slots = reinterpret_cast<const SaveSlot*>(base + layout.slots);
+    std::vector<ComponentMask> masks(header.archetypeCount);
+    for (std::uint32_t i = 0; i < header.archetypeCount; ++i) {
+        const SaveArchetype& record = archetypes[i];
+        if (record.capacity == 0 || std::uint64_t(record.firstChunk) + record.chunkCount > header.chunkCount ||
+            record.size > header.alive) {
+            return fail("corrupt archetype table");
+        }
+        for (ComponentId c = 0; c < kMaxComponents; ++c) {
+            if ((record.mask >> c) & 1) {
+                if (c >= header.componentCount || remap[c] == kMaxComponents) {
+                    return fail("a component this build hasn't registered");
+                }
+                const std::size_t bytes = ecs_detail::componentSize(remap[c]);
+                if (record.offset[c] + bytes * record.capacity > kChunkBytes) {
+                    return fail("corrupt archetype table");
+                }
+                masks[i] |= ComponentMask{1} << remap[c];
+            }
+        }
+        std::uint64_t rows = 0;
+        for (std::uint32_t k = record.firstChunk; k < record.firstChunk + record.chunkCount; ++k) {
+            if (chunks[k].archetype != i || chunks[k].count == 0 || chunks[k].count > record.capacity ||
+                chunks[k].offset != header.chunksOffset + std::uint64_t(k) * kChunkBytes) {
+                return fail("corrupt chunk table");
+            }
+            rows += chunks[k].count;
+        }
+        if (rows != record.size) {
+            return fail("corrupt chunk table");
+        }
+    }
+    std::vector<ComponentMask> sorted(masks);
+    std::sort(sorted.begin(), sorted.end());
+    if (std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end()) {
+        return fail("corrupt archetype table");    // two archetypes would become one
+    }
+    for (std::uint64_t s = 0; s < header.slotCount; ++s) {
+        const SaveSlot& slot = slots[s];
+        if (slot.alive && (slot.archetype >= header.archetypeCount ||
+                           slot.chunk >= archetypes[slot.archetype].chunkCount ||
+                           slot.row >= chunks[archetypes[slot.archetype].firstChunk + slot.chunk].count)) {
+            return fail("corrupt slot table");
+        }
+    }
+
+    // The archetypes: in place where this process lays them out the same way.
+    LoadStats loaded;
+    loaded.bytes = size;
+    loaded.mapped = file->mapped();
+    for (World::Archetype& a : world.archetypes_) {
+        a.chunks.clear();
+        a.size = 0;
+    }
+    world.backing_.reset();
+    std::vector<std::uint32_t> index(header.archetypeCount);
+    std::vector<bool> copied(header.archetypeCount, false);
+    for (std::uint32_t i = 0; i < header.archetypeCount; ++i) {
+        const SaveArchetype& record = archetypes[i];
+        index[i] = world.archetypeFor(masks[i]);
+        World::Archetype& a = world.archetypes_[index[i]];
+        bool sameLayout = loaded.mapped && a.capacity == record.capacity;
+        for (ComponentId c = 0; c < header.componentCount && sameLayout; ++c) {
+            sameLayout = ((record.mask >> c) & 1) == 0 || a.offset[remap[c]] == record.offset[c];
+        }
+        const SaveChunk* first = chunks + record.firstChunk;
+        if (sameLayout) {
+            for (std::uint32_t k = 0; k < record.chunkCount; ++k) {
+                World::Chunk chunk;
+                chunk.data = std::unique_ptr<unsigned char, World::ChunkDeleter>(base + first[k].offset,
+                                                                                 World::ChunkDeleter{true});
+                chunk.count = first[k].count;
+                a.chunks.push_back(std::move(chunk));
+            }
+            a.size = static_cast<std::size_t>(record.size);
+            loaded.mappedChunks += record.chunkCount;
+            continue;
+        }
+        // Laid out differently: the rows into chunks of this archetype's layout, like
+        // World::restore (and their slots' locations from the handles, below).
+        copied[i] = true;
+        loaded.copiedChunks += record.chunkCount;
+        for (std::uint32_t k = 0; k < record.chunkCount; ++k) {
+            const unsigned char* from = base + first[k].offset;
+            for (std::uint32_t row = 0; row < first[k].count;) {
+                if (a.chunks.empty() || a.chunks.back().count == a.capacity) {
+                    a.chunks.push_back(World::pooledChunk());
+                }
+                World::Chunk& to = a.chunks.back();
+                const std::uint32_t n = std::min(first[k].count - row, a.capacity - to.count);
+                std::memcpy(to.data.get() + to.count * sizeof(EntityHandle), from + row * sizeof(EntityHandle),
+                            n * sizeof(EntityHandle));
+                for (ComponentId c = 0; c < header.componentCount; ++c) {
+                    if ((record.mask >> c) & 1) {
+                        const std::size_t bytes = ecs_detail::componentSize(remap[c]);
+                        std::memcpy(to.data.get() + a.offset[remap[c]] + to.count * bytes,
+                                    from + record.offset[c] + row * bytes, n * bytes);
+                    }
+                }
+                to.count += n;
+                row += n;
+            }
+        }
+        a.size = static_cast<std::size_t>(record.size);
+    }
+
+    // The slots, with the archetype indices relocated; copied archetypes' rows moved.
+    world.slots_.resize(static_cast<std::size_t>(header.slotCount));
+    for (std::size_t s = 0; s < world.slots_.size(); ++s) {
+        const SaveSlot& record = slots[s];
+        World::Slot& slot = world.slots_[s];
+        slot.location = World::Location{record.alive ? index[record.archetype] : 0, record.chunk, record.row};
+        slot.generation = record.generation;
+        slot.nextFree = record.nextFree;
+        slot.alive = record.alive != 0;
+    }
+    for (std::uint32_t i = 0; i < header.archetypeCount; ++i) {
+        if (!copied[i]) {
+            continue;
+        }
+        const World::Archetype& a = world.archetypes_[index[i]];
+        for (std::uint32_t c = 0; c < a.chunks.size(); ++c) {
+            const EntityHandle* handles = reinterpret_cast<const EntityHandle*>(a.chunks[c].data.get());
+            for (std::uint32_t r = 0; r < a.chunks[c].count; ++r) {
+                if (handles[r].slot < world.slots_.size()) {
+                    world.slots_[handles[r].slot].location = World::Location{index[i], c, r};
+                }
+            }
+        }
+    }
+    world.freeHead_ = header.freeHead;
+    world.alive_ = static_cast<std::size_t>(header.alive);
+    if (loaded.mappedChunks > 0) {
+        world.backing_ = std::move(file);   // the chunks point into it from now on
+    }
+    loaded.entities = world.alive_;
+    if (tick) {
+        *tick = header.tick;
+    }
+    if (stats) {
+        *stats = loaded;
+    }
+    return true;
+}
+
+bool write(const World& world, std::uint64_t tick, const std::string& path, std::string* error) {
+    return Access::write(world, tick, path, error);
+}
+
+bool load(World& world, const std::string& path, std::uint64_t* tick, LoadStats* stats, std::string* error) {
+    return Access::load(world, path, tick, stats, error);
+}
+
+} // namespace savefile
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "ecs/world.h"
+
+// Save files
+// ----------
+// A World on disk as the World holds it in memory. The file is mostly the chunks
+// themselves, each 16 KB and page-aligned. Loading one maps the file copy-on-write
+// (core/mapped_file.h) and points the World's chunks into the mapping. No row is copied
+// or parsed, and a chunk nobody touches is never read from disk. A 500 MB world loads
+// in the time it takes to read its tables; after that, the cost is page faults, spread
+// over the frames that first touch each chunk.
+//
+//     | header (80 B) | components | archetypes | chunk table | slots | names | pad | chunks ... |
+//
+// | Part        | Contents                                                             |
+// | ----------- | -------------------------------------------------------------------- |
+// | header      | "SAV1", version, kChunkBytes, the counts, the tick, where the chunks |
+// |             | start (a multiple of kChunkBytes), the file's own size               |
+// | components  | per component id when saved: its type's name, size and alignment     |
+// | archetypes  | mask, rows, rows per chunk, each column's byte offset, its chunks    |
+// | chunk table | the relocation table: per chunk, its offset in the file, archetype   |
+// |             | and row count. Loading turns each entry into a chunk pointer         |
+// | slots       | the entity slots: generation, free list, and location (archetype,    |
+// |             | chunk, row), so no chunk is read to find an entity                   |
+//
+// The fix-up on load works on the tables only:
+//
+// | Saved                   | Here                                     | Fixed up                    |
+// | ----------------------- | ---------------------------------------- | --------------------------- |
+// | component ids           | ids by first use: may be numbered apart  | matched by type name        |
+// | archetype index         | the World's own, archetypeFor(mask)      | remapped in every slot      |
+// | chunk offsets           | mapping base + offset                    | the chunk pointers          |
+// | column offsets, rows    | the same when ids sort the same way (the | else that archetype's rows  |
+// | per chunk               | usual case)                              | are copied out, as restore  |
+//
+// Chunks in the mapping are written in place: the first write to a page copies it, and
+// the file never changes. They are not returned to the chunk pool, and the World keeps
+// the mapping until its chunks are cleared or restored. Without mmap the file is read
+// whole and every archetype goes through the copy.
+//
+// write() saves to PATH.tmp and renames it over PATH. A World mapped from PATH can
+// therefore save back to PATH: its mapping keeps the old file.
+//
+// A save belongs to the build that wrote it: component types are known by their
+// typeid names, and a component's layout must not have changed. load() refuses anything
+// else and leaves the World untouched.
+namespace savefile {
+
+constexpr std::uint32_t kVersion = 1;
+
+struct LoadStats {
+    std::size_t bytes = 0;             // the file's size
+    std::size_t entities = 0;
+    std::size_t mappedChunks = 0;      // used where they lie in the file
+    std::size_t copiedChunks = 0;      // of archetypes laid out differently here
+    bool mapped = false;               // false: no mmap, the file was read into memory
+};
+
+// false (and why, in *error) if the file can't be written.
+bool write(const World& world, std::uint64_t tick, const std::string& path, std::string* error = nullptr);
+
+// The World as saved: every handle resolves as it did. `tick` is the one write() was
+// given. false (why, in *error) leaves the World as it was.
+bool load(World& world, const std::string& path, std::uint64_t* tick = nullptr, LoadStats* stats = nullptr,
+          std::string* error = nullptr);
+
+} // namespace savefile
@@ -0,0 +1,17 @@
+#include "ecs/scheduler.h"
+
+#include <utility>
+
+#include "ecs/world.h"
+#include "profile/trace.h"
+
+void SystemScheduler::add(const char* name, System system) {
+    systems_.push_back(Entry{name, std::move(system)});
+}
+
+void SystemScheduler::run(World& world, float dt) {
+    for (Entry& entry : systems_) {
+        trace::Scope span(entry.name);
+        entry.system(world, dt);
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+class World;
+
+// SystemScheduler
+// ---------------
+// Runs the registered systems in order, once per simulation step:
+//
+//     scheduler.add("movement", movementSystem);
+//     scheduler.add("integrate", integrateSystem);
+//     ...
+//     scheduler.run(world, dt);       // inside the fixed-step loop
+//
+// A system is a function over the World that does its work with forEachChunk<...>, so
+// each one streams through exactly the component arrays it reads and writes. Order is
+// the registration order: a system sees everything the earlier ones wrote this step.
+// Each run is a named span in the trace (profile/trace.h).
+//
+// Names must be string literals (the trace stores the pointer).
+class SystemScheduler {
+public:
+    using System = std::function<void(World& world, float dt)>;
+
+    void add(const char* name, System system);
+    void run(World& world, float dt);
+
+    std::size_t size() const { return systems_.size(); }
+
+private:
+    struct Entry {
+        const char* name;
+        System system;
+    };
+    std::vector<Entry> systems_;
+};
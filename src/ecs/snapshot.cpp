@@ -0,0 +1,158 @@
+#include "ecs/snapshot.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "core/lz4.h"
+#include "ecs/world.h"
+
+namespace {
+
+// dst ^= src over n bytes; 8 at a time (the images are 16-byte padded throughout).
+void xorInto(unsigned char* dst, const unsigned char* src, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        std::uint64_t a, b;
+        std::memcpy(&a, dst + i, 8);
+        std::memcpy(&b, src + i, 8);
+        a ^= b;
+        std::memcpy(dst + i, &a, 8);
+    }
+    for (; i < n; ++i) {
+        dst[i] ^= src[i];
+    }
+}
+
+} // namespace
+
+SnapshotHistory::SnapshotHistory(JobSystem& jobs, const Settings& settings)
+    : jobs_(jobs), settings_(settings) {
+    settings_.capacity = std::max<std::size_t>(1, settings_.capacity);
+    ring_.resize(settings_.capacity);
+}
+
+SnapshotHistory::~SnapshotHistory() {
+    finish();
+}
+
+void SnapshotHistory::finish() {
+    jobs_.wait(pending_);
+    writing_ = nullptr;
+}
+
+void SnapshotHistory::deltaJob(void* context, std::size_t, std::size_t) {
+    SnapshotHistory& self = *static_cast<SnapshotHistory*>(context);
+    // Both images zero-padded to the larger one; the image kept as latest_ is the new one.
+    const std::size_t newSize = self.next_.size();
+    const std::size_t oldSize = self.latest_.size();
+    const std::size_t size = std::max(newSize, oldSize);
+    self.scratch_.assign(size, 0);
+    std::memcpy(self.scratch_.data(), self.next_.data(), newSize);
+    xorInto(self.scratch_.data(), self.latest_.data(), oldSize);
+    // Compressed into packed_ first: lz4Compress reserves the worst case, which every
+    // ring entry keeping would cost an image per entry.
+    lz4Compress(self.scratch_.data(), size, self.packed_);
+    self.writing_->compressed.assign(self.packed_.begin(), self.packed_.end());
+    self.writing_->size = size;
+    self.writing_->previousSize = oldSize;
+    self.latest_.swap(self.next_);
+}
+
+void SnapshotHistory::capture(const World& world, std::uint64_t tick) {
+    finish();
+    ++captures_;
+    if (!hasLatest_) {
+        // The first image is the base: nothing to rewind to from it.
+        world.snapshot(latest_);
+        imageBytes_ = latest_.size();
+        latestTick_ = tick;
+        hasLatest_ = true;
+        return;
+    }
+    world.snapshot(next_);
+    imageBytes_ = next_.size();
+    if (count_ == ring_.size()) {
+        head_ = (head_ + 1) % ring_.size();   // the oldest goes
+        --count_;
+    }
+    Delta& delta = ring_[(head_ + count_) % ring_.size()];
+    ++count_;
+    delta.tick = latestTick_;
+    latestTick_ = tick;
+    writing_ = &delta;
+    jobs_.run(&SnapshotHistory::deltaJob, this, 0, 1, &pending_);
+}
+
+bool SnapshotHistory::rewind(World& world, std::uint64_t* tick) {
+    finish();
+    if (count_ == 0) {
+        return false;
+    }
+    const std::size_t newest = (head_ + count_ - 1) % ring_.size();
+    Delta& delta = ring_[newest];
+    scratch_.resize(delta.size);
+    if (!lz4Decompress(delta.compressed.data(), delta.compressed.size(), scratch_.data(), delta.size)) {
+        return false;
+    }
+    latest_.resize(delta.size, 0);
+    xorInto(latest_.data(), scratch_.data(), delta.size);
+    latest_.resize(delta.previousSize);
+    imageBytes_ = latest_.size();
+    --count_;
+    latestTick_ = delta.tick;
+    ++rewinds_;
+    if (tick) {
+        *tick = latestTick_;
+    }
+    return world.restore(latest_.data(), latest_.size());
+}
+
+bool SnapshotHistory::save() {
+    finish();
+    if (!hasLatest_) {
+        return false;
+    }
+    lz4Compress(latest_.data(), latest_.size(), packed_);
+    savedImage_.assign(packed_.begin(), packed_.end());
+    savedSize_ = latest_.size();
+    savedTick_ = latestTick_;
+    return true;
+}
+
+bool SnapshotHistory::load(World& world, std::uint64_t* tick) {
+    finish();
+    if (savedImage_.empty()) {
+        return false;
+    }
+    latest_.resize(savedSize_);
+    if (!lz4Decompress(savedImage_.data(), savedImage_.size(), latest_.data(), savedSize_) ||
+        !world.restore(latest_.data(), latest_.size())) {
+        hasLatest_ = false;   // latest_ is no base any more: the next capture starts over
+        count_ = 0;
+        return false;
+    }
+    head_ = 0;
+    count_ = 0;
+    latestTick_ = savedTick_;
+    imageBytes_ = latest_.size();
+    hasLatest_ = true;
+    if (tick) {
+        *tick = latestTick_;
+    }
+    return true;
+}
+
+SnapshotHistory::Stats SnapshotHistory::stats() const {
+    Stats stats;
+    stats.deltas = count_;
+    stats.imageBytes = imageBytes_;
+    for (std::size_t i = 0; i < count_; ++i) {
+        const Delta& delta = ring_[(head_ + i) % ring_.size()];
+        if (&delta != writing_) {      // the job may still be filling that one
+            stats.keptBytes += delta.compressed.size();
+        }
+    }
+    stats.captures = captures_;
+    stats.rewinds = rewinds_;
+    return stats;
+}
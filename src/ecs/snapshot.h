@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "core/job_system.h"
+
+class World;
+
+// SnapshotHistory
+// ---------------
+// Rewind and quick-save for a World (ecs/world.h). Every capture() is a World::snapshot
+// image; what is KEPT is its XOR against the image before it, LZ4-compressed
+// (core/lz4.h) on a worker:
+//
+//     main, capture(tick N)        worker job                          kept
+//     snapshot → next_             delta = next_ ⊕ latest_            ring[N] = lz4(delta)
+//     (memcpy per column)          (zeros wherever nothing changed)   latest_ = image N
+//
+// XOR undoes itself, so going back a tick is one delta: image N-1 = image N ⊕ delta N,
+// decompressed and applied to latest_. rewind() does that and restores the World; held
+// down, it walks back through the ring one tick per call. Nothing ever decodes forward,
+// so there are no keyframes: when the ring is full the oldest delta is dropped and
+// rewinding stops there.
+//
+// | Call           | Thread | Cost                                                   |
+// | -------------- | ------ | ------------------------------------------------------ |
+// | capture        | main   | the snapshot copy (waits for the previous job first,   |
+// |                |        | which had a whole tick to finish)                      |
+// | rewind         | main   | one decompress + XOR + World::restore                  |
+// | save / load    | main   | save: compress the latest image; load: the reverse    |
+//
+// Delta and image sizes differ when entities come or go; both are zero-padded to the
+// larger, which keeps the XOR symmetric. The static bulk of a World (props that never
+// move) then costs nothing per tick, and a moving entity costs its changed bytes.
+//
+// A rewind or load makes the restored image the new latest_: later captures continue
+// from there, and what was ahead of it is gone (load also empties the ring).
+class SnapshotHistory {
+public:
+    struct Settings {
+        std::size_t capacity = 600;    // deltas kept: 10 s at 60 steps per second
+    };
+
+    struct Stats {
+        std::size_t deltas = 0;        // in the ring
+        std::size_t imageBytes = 0;    // the latest image, uncompressed
+        std::size_t keptBytes = 0;     // every delta in the ring, compressed
+        std::uint64_t captures = 0;
+        std::uint64_t rewinds = 0;
+    };
+
+    SnapshotHistory(JobSystem& jobs, const Settings& settings);
+    ~SnapshotHistory();
+    SnapshotHistory(const SnapshotHistory&) = delete;
+    SnapshotHistory& operator=(const SnapshotHistory&) = delete;
+
+    // Once per simulation step, after it.
+    void capture(const World& world, std::uint64_t tick);
+    // The World back one capture: false (World untouched) when the ring is empty. Its
+    // tick in *tick.
+    bool rewind(World& world, std::uint64_t* tick = nullptr);
+
+    // Quick-save slot: the latest image, compressed whole. load() restores it and starts
+    // the history over from it.
+    bool save();
+    bool load(World& world, std::uint64_t* tick = nullptr);
+    bool saved() const { return !savedImage_.empty(); }
+
+    // Main thread; the delta still being compressed is not counted yet.
+    Stats stats() const;
+
+private:
+    struct Delta {
+        std::vector<unsigned char> compressed;
+        std::uint64_t tick = 0;        // of the image BEFORE it: where rewinding lands
+        std::size_t size = 0;          // uncompressed (the larger of the two images)
+        std::size_t previousSize = 0;  // that image's own size
+    };
+
+    static void deltaJob(void* context, std::size_t begin, std::size_t end);
+    void finish();                     // waits for the job in flight
+
+    JobSystem& jobs_;
+    Settings settings_;
+    std::vector<Delta> ring_;          // capacity entries, oldest at head_
+    std::size_t head_ = 0;
+    std::size_t count_ = 0;
+    std::vector<unsigned char> latest_;
+    std::vector<unsigned char> next_;
+    std::vector<unsigned char> scratch_;   // the uncompressed delta
+    std::vector<unsigned char> packed_;    // lz4Compress's output, before it is kept
+    std::size_t imageBytes_ = 0;
+    std::uint64_t latestTick_ = 0;
+    bool hasLatest_ = false;
+    JobCounter pending_;
+    Delta* writing_ = nullptr;         // the job's output
+    std::vector<unsigned char> savedImage_;
+    std::size_t savedSize_ = 0;
+    std::uint64_t savedTick_ = 0;
+    std::uint64_t captures_ = 0;
+    std::uint64_t rewinds_ = 0;
+};
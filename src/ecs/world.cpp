@@ -0,0 +1,427 @@
+#include "ecs/world.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <new>
+
+#include "core/block_pool.h"
+
+namespace ecs_detail {
+namespace {
+struct ComponentInfo {
+    std::size_t size;
+    std::size_t align;
+    const char* name;
+};
+// A type registers on its first componentId<T>(), which may be on a job worker (a
+// parallel system, a snapshot): registrations take the lock, and an entry is written
+// before `count` publishes it, so reads never lock and never see it move.
+struct Registry {
+    std::mutex mutex;
+    ComponentInfo infos[kMaxComponents];
+    std::atomic<ComponentId> count{0};
+};
+Registry& registry() {
+    static Registry r;
+    return r;
+}
+} // namespace
+
+ComponentId registerComponent(std::size_t size, std::size_t align, const char* name) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    const ComponentId id = r.count.load(std::memory_order_relaxed);
+    if (id >= kMaxComponents) {
+        std::cerr << "ECS: more than " << kMaxComponents << " component types\n";
+        std::abort();
+    }
+    r.infos[id] = ComponentInfo{size, align, name};
+    r.count.store(id + 1, std::memory_order_release);
+    return id;
+}
+
+std::size_t componentSize(ComponentId id) { return registry().infos[id].size; }
+std::size_t componentAlign(ComponentId id) { return registry().infos[id].align; }
+const char* componentName(ComponentId id) { return registry().infos[id].name; }
+ComponentId componentCount() { return registry().count.load(std::memory_order_acquire); }
+
+ComponentId findComponent(const char* name) {
+    const Registry& r = registry();
+    const ComponentId count = r.count.load(std::memory_order_acquire);
+    for (ComponentId id = 0; id < count; ++id) {
+        if (std::strcmp(r.infos[id].name, name) == 0) {
+            return id;
+        }
+    }
+    return kMaxComponents;
+}
+} // namespace ecs_detail
+
+namespace {
+constexpr std::size_t kChunkAlign = 64; // cache line: each chunk starts on one
+
+constexpr std::size_t kChunksPerSlab = 64; // 1 MiB at a time
+
+std::size_t alignUp(std::size_t v, std::size_t a) { return (v + a - 1) / a * a; }
+
+// Every World's chunks: an archetype at a chunk boundary frees and takes one per entity
+// destroyed / created, which with the pool is a pointer push / pop, not malloc.
+BlockPool& chunkPool() {
+    static BlockPool pool;
+    static const bool ready = pool.init(kChunkBytes, kChunkAlign, kChunksPerSlab);
+    (void)ready;
+    return pool;
+}
+} // namespace
+
+void World::ChunkDeleter::operator()(unsigned char* p) const {
+    if (!mapped) {
+        chunkPool().deallocate(p);
+    }
+}
+
+World::Chunk World::pooledChunk() {
+    Chunk chunk;
+    chunk.data.reset(static_cast<unsigned char*>(chunkPool().allocate()));
+    if (!chunk.data) {
+        throw std::bad_alloc();
+    }
+    return chunk;
+}
+
+std::uint32_t World::archetypeFor(ComponentMask mask) {
+    auto it = archetypeIndex_.find(mask);
+    if (it != archetypeIndex_.end()) {
+        return it->second;
+    }
+
+    Archetype a;
+    a.mask = mask;
+    std::fill(std::begin(a.offset), std::end(a.offset), kNoOffset);
+    std::size_t rowBytes = sizeof(EntityHandle);
+    for (ComponentId id = 0; id < kMaxComponents; ++id) {
+        if (mask & (ComponentMask{1} << id)) {
+            a.components.push_back(id);
+            rowBytes += ecs_detail::componentSize(id);
+        }
+    }
+
+    // Layout: handles, then one array per component, each 16-byte aligned (SSE loads).
+    // Start from the ideal row count and shrink until the padding fits too.
+    auto layout = [&](std::uint32_t capacity) {
+        std::size_t at = alignUp(sizeof(EntityHandle) * capacity, 16);
+        for (ComponentId id : a.components) {
+            at = alignUp(at, std::max<std::size_t>(16, ecs_detail::componentAlign(id)));
+            a.offset[id] = static_cast<std::uint32_t>(at);
+            at += ecs_detail::componentSize(id) * capacity;
+        }
+        return at;
+    };
+    std::uint32_t capacity = static_cast<std::uint32_t>(std::max<std::size_t>(1, kChunkBytes / rowBytes));
+    while (capacity > 1 && layout(capacity) > kChunkBytes) {
+        --capacity;
+    }
+    layout(capacity);
+    a.capacity = capacity;
+
+    const std::uint32_t index = static_cast<std::uint32_t>(archetypes_.size());
+    archetypes_.push_back(std::move(a));
+    archetypeIndex_.emplace(mask, index);
+    return index;
+}
+
+EntityHandle World::createHandle() {
+    std::uint32_t slot;
+    if (freeHead_ != kEndOfFreeList) {
+        slot = freeHead_;
+        freeHead_ = slots_[slot].nextFree;
+    } else {
+        slot = static_cast<std::uint32_t>(slots_.size());
+        slots_.push_back(Slot{});
+    }
+    slots_[slot].alive = true;
+    ++alive_;
+    return EntityHandle{slot, slots_[slot].generation};
+}
+
+World::Location World::allocate(EntityHandle handle, std::uint32_t archetype) {
+    Archetype& a = archetypes_[archetype];
+    if (a.chunks.empty() || a.chunks.back().count == a.capacity) {
+        a.chunks.push_back(pooledChunk());
+    }
+    Chunk& c = a.chunks.back();
+    const Location loc{archetype, static_cast<std::uint32_t>(a.chunks.size() - 1), c.count++};
+    reinterpret_cast<EntityHandle*>(c.data.get())[loc.row] = handle;
+    ++a.size;
+    slots_[handle.slot].location = loc;
+    return loc;
+}
+
+void World::release(const Location& loc) {
+    // The archetype's LAST row fills the hole, so every chunk but the last stays full.
+    Archetype& a = archetypes_[loc.archetype];
+    Chunk& last = a.chunks.back();
+    const std::uint32_t lastRow = last.count - 1;
+    const std::uint32_t lastChunk = static_cast<std::uint32_t>(a.chunks.size() - 1);
+    if (loc.chunk != lastChunk || loc.row != lastRow) {
+        Chunk& hole = a.chunks[loc.chunk];
+        EntityHandle* holeHandles = reinterpret_cast<EntityHandle*>(hole.data.get());
+        const EntityHandle moved = reinterpret_cast<EntityHandle*>(last.data.get())[lastRow];
+        holeHandles[loc.row] = moved;
+        for (ComponentId id : a.components) {
+            const std::size_t size = ecs_detail::componentSize(id);
+            std::memcpy(hole.data.get() + a.offset[id] + size * loc.row,
+                        last.data.get() + a.offset[id] + size * lastRow, size);
+        }
+        slots_[moved.slot].location = loc;
+    }
+    if (--last.count == 0) {
+        a.chunks.pop_back();
+    }
+    --a.size;
+}
+
+World::Location World::migrate(EntityHandle handle, ComponentMask mask) {
+    const Location from = slots_[handle.slot].location;
+    const std::uint32_t target = archetypeFor(mask); // may grow archetypes_: use indices
+    const Location to = allocate(handle, target);
+
+    // Copy the components both archetypes have; new ones are filled in by the caller.
+    for (ComponentId id : archetypes_[from.archetype].components) {
+        if (mask & (ComponentMask{1} << id)) {
+            std::memcpy(columnAt(to, id), columnAt(from, id), ecs_detail::componentSize(id));
+        }
+    }
+    release(from);
+    // release() moves a row into the hole—this entity's own new row if the archetype
+    // didn't change—so read the location back.
+    return slots_[handle.slot].location;
+}
+
+bool World::destroy(EntityHandle handle) {
+    if (!locate(handle)) {
+        return false;
+    }
+    Slot& s = slots_[handle.slot];
+    release(s.location);
+    s.alive = false;
+    ++s.generation;
+    s.nextFree = freeHead_;
+    freeHead_ = handle.slot;
+    --alive_;
+    return true;
+}
+
+void World::clear() {
+    // Keep the archetypes (their layouts are still valid) but drop every chunk; bump all
+    // generations so no old handle resolves.
+    for (Archetype& a : archetypes_) {
+        a.chunks.clear();
+        a.size = 0;
+    }
+    backing_.reset();
+    freeHead_ = kEndOfFreeList;
+    for (std::size_t s = slots_.size(); s-- > 0;) {
+        if (slots_[s].alive) {
+            ++slots_[s].generation;
+        }
+        slots_[s].alive = false;
+        slots_[s].nextFree = freeHead_;
+        freeHead_ = static_cast<std::uint32_t>(s);
+    }
+    alive_ = 0;
+}
+
+const World::Location* World::locate(EntityHandle handle) const {
+    if (handle.slot >= slots_.size()) {
+        return nullptr;
+    }
+    const Slot& s = slots_[handle.slot];
+    return s.alive && s.generation == handle.generation ? &s.location : nullptr;
+}
+
+EntityHandle World::handleAt(const Location& loc) const {
+    const Chunk& c = archetypes_[loc.archetype].chunks[loc.chunk];
+    return reinterpret_cast<const EntityHandle*>(c.data.get())[loc.row];
+}
+
+void* World::columnAt(const Location& loc, ComponentId id) {
+    const Archetype& a = archetypes_[loc.archetype];
+    if (a.offset[id] == kNoOffset) {
+        return nullptr;
+    }
+    return a.chunks[loc.chunk].data.get() + a.offset[id] + ecs_detail::componentSize(id) * loc.row;
+}
+
+namespace {
+constexpr std::uint32_t kSnapshotMagic = 0x314e5357u; // "WSN1"
+
+struct SnapshotHeader {
+    std::uint32_t magic;
+    std::uint32_t archetypes;
+    std::uint32_t slots;
+    std::uint32_t freeHead;
+    std::uint64_t alive;
+    std::uint64_t reserved;
+};
+struct SnapshotSlot {
+    std::uint32_t generation;
+    std::uint32_t nextFree;
+    std::uint32_t alive;
+};
+struct SnapshotArchetype {
+    ComponentMask mask;
+    std::uint64_t size;
+};
+
+// Every part of an image starts 16-byte aligned (the column copies stay aligned).
+std::size_t snapshotAlign(std::size_t v) { return alignUp(v, 16); }
+} // namespace
+
+void World::snapshot(std::vector<unsigned char>& out) const {
+    std::size_t total = snapshotAlign(sizeof(SnapshotHeader)) + snapshotAlign(slots_.size() * sizeof(SnapshotSlot));
+    for (const Archetype& a : archetypes_) {
+        total += snapshotAlign(sizeof(SnapshotArchetype)) + snapshotAlign(a.size * sizeof(EntityHandle));
+        for (ComponentId id : a.components) {
+            total += snapshotAlign(a.size * ecs_detail::componentSize(id));
+        }
+    }
+    out.resize(total);   // keeps its capacity: no allocation once it has grown
+    unsigned char* at = out.data();
+
+    const SnapshotHeader header{kSnapshotMagic, static_cast<std::uint32_t>(archetypes_.size()),
+                                static_cast<std::uint32_t>(slots_.size()), freeHead_, alive_, 0};
+    std::memcpy(at, &header, sizeof(header));
+    at += snapshotAlign(sizeof(header));
+    for (std::size_t s = 0; s < slots_.size(); ++s) {
+        const SnapshotSlot slot{slots_[s].generation, slots_[s].nextFree, slots_[s].alive ? 1u : 0u};
+        std::memcpy(at + s * sizeof(SnapshotSlot), &slot, sizeof(slot));
+    }
+    at += snapshotAlign(slots_.size() * sizeof(SnapshotSlot));
+
+    for (const Archetype& a : archetypes_) {
+        const SnapshotArchetype record{a.mask, a.size};
+        std::memcpy(at, &record, sizeof(record));
+        at += snapshotAlign(sizeof(record));
+        // Column by column: each one's rows are contiguous in the image, chunk after chunk.
+        std::size_t row = 0;
+        for (const Chunk& c : a.chunks) {
+            std::memcpy(at + row * sizeof(EntityHandle), c.data.get(), c.count * sizeof(EntityHandle));
+            row += c.count;
+        }
+        at += snapshotAlign(a.size * sizeof(EntityHandle));
+        for (ComponentId id : a.components) {
+            const std::size_t size = ecs_detail::componentSize(id);
+            row = 0;
+            for (const Chunk& c : a.chunks) {
+                std::memcpy(at + row * size, c.data.get() + a.offset[id], c.count * size);
+                row += c.count;
+            }
+            at += snapshotAlign(a.size * size);
+        }
+    }
+}
+
+bool World::restore(const unsigned char* data, std::size_t size) {
+    SnapshotHeader header;
+    if (size < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    std::size_t at = snapshotAlign(sizeof(header));
+    if (header.magic != kSnapshotMagic || header.slots > (size - at) / sizeof(SnapshotSlot)) {
+        return false;
+    }
+    const unsigned char* slotData = data + at;
+    at += snapshotAlign(header.slots * sizeof(SnapshotSlot));
+
+    // Check the whole image before touching anything.
+    std::size_t check = at;
+    for (std::uint32_t i = 0; i < header.archetypes; ++i) {
+        SnapshotArchetype record;
+        if (check + sizeof(record) > size) {
+            return false;
+        }
+        std::memcpy(&record, data + check, sizeof(record));
+        check += snapshotAlign(sizeof(record)) + snapshotAlign(record.size * sizeof(EntityHandle));
+        for (ComponentId id = 0; id < kMaxComponents; ++id) {
+            if (record.mask & (ComponentMask{1} << id)) {
+                if (id >= ecs_detail::componentCount()) {
+                    return false;
+                }
+                check += snapshotAlign(record.size * ecs_detail::componentSize(id));
+            }
+        }
+        if (record.size > header.alive || check > size) {
+            return false;
+        }
+    }
+
+    for (Archetype& a : archetypes_) {
+        a.chunks.clear();   // back to the pool, and straight out again below
+        a.size = 0;
+    }
+    backing_.reset();
+    slots_.resize(header.slots);
+    for (std::size_t s = 0; s < slots_.size(); ++s) {
+        SnapshotSlot slot;
+        std::memcpy(&slot, slotData + s * sizeof(SnapshotSlot), sizeof(slot));
+        slots_[s].generation = slot.generation;
+        slots_[s].nextFree = slot.nextFree;
+        slots_[s].alive = slot.alive != 0;
+    }
+    freeHead_ = header.freeHead;
+    alive_ = static_cast<std::size_t>(header.alive);
+
+    for (std::uint32_t i = 0; i < header.archetypes; ++i) {
+        SnapshotArchetype record;
+        std::memcpy(&record, data + at, sizeof(record));
+        at += snapshotAlign(sizeof(record));
+        const std::uint32_t index = archetypeFor(record.mask);
+        Archetype& a = archetypes_[index];
+        const std::size_t rows = static_cast<std::size_t>(record.size);
+        for (std::size_t first = 0; first < rows; first += a.capacity) {
+            Chunk chunk = pooledChunk();
+            chunk.count = static_cast<std::uint32_t>(std::min<std::size_t>(a.capacity, rows - first));
+            a.chunks.push_back(std::move(chunk));
+        }
+        a.size = rows;
+
+        const unsigned char* handles = data + at;
+        std::size_t row = 0;
+        for (std::uint32_t c = 0; c < a.chunks.size(); ++c) {
+            Chunk& chunk = a.chunks[c];
+            std::memcpy(chunk.data.get(), handles + row * sizeof(EntityHandle), chunk.count * sizeof(EntityHandle));
+            const EntityHandle* chunkHandles = reinterpret_cast<const EntityHandle*>(chunk.data.get());
+            for (std::uint32_t r = 0; r < chunk.count; ++r) {
+                if (chunkHandles[r].slot < slots_.size()) {
+                    slots_[chunkHandles[r].slot].location = Location{index, c, r};
+                }
+            }
+            row += chunk.count;
+        }
+        at += snapshotAlign(rows * sizeof(EntityHandle));
+        for (ComponentId id : a.components) {
+            const std::size_t size = ecs_detail::componentSize(id);
+            row = 0;
+            for (Chunk& chunk : a.chunks) {
+                std::memcpy(chunk.data.get() + a.offset[id], data + at + row * size, chunk.count * size);
+                row += chunk.count;
+            }
+            at += snapshotAlign(rows * size);
+        }
+    }
+    return true;
+}
+
+std::size_t World::chunkCount() const {
+    std::size_t n = 0;
+    for (const Archetype& a : archetypes_) {
+        n += a.chunks.size();
+    }
+    return n;
+}
@@ -0,0 +1,262 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+#include "core/entity_handle.h"
+
+// Archetype ECS
+// -------------
+// Entities with the SAME set of component types share an ARCHETYPE, and each archetype
+// stores its entities in fixed-size CHUNKS (kChunkBytes = 16 KB). Inside a chunk every
+// component type has its own contiguous array:
+//
+//     archetype {Position, Velocity, Controllable}
+//     ┌──────────────── chunk (16 KB) ─────────────────┐
+//     │ handles[cap] │ Position[cap] │ Velocity[cap] │ Controllable[cap] │
+//     └────────────────────────────────────────────────┘
+//     ┌──────────────── chunk ─────────────────────────┐   (next 'cap' entities)
+//
+// A system asks for the components it needs (forEachChunk<Position, Velocity>) and gets,
+// for every matching chunk, plain arrays of `count` elements: linear, prefetch-friendly
+// loops with no per-entity lookup and nothing loaded that the system doesn't use.
+//
+// | vs. EntityStore (core/entity_store.h) | EntityStore        | World                    |
+// | ------------------------------------- | ------------------ | ------------------------ |
+// | component set                         | fixed, every entity| per entity, can change   |
+// | arrays                                | one per component  | one per component/chunk  |
+// | "entities that have X"                | all of them        | only matching archetypes |
+//
+// Rows are swap-removed like EntityStore's, so chunks stay dense (only the LAST chunk of
+// an archetype is partly filled) and handles (slot + generation) stay the way to refer
+// to an entity across frames.
+//
+// Components must be trivially copyable structs: rows are moved with memcpy. Up to
+// kMaxComponents distinct types. Chunks come from one BlockPool (core/block_pool.h) shared
+// by every World, so entity churn recycles chunks instead of going to the heap.
+using ComponentId = std::uint32_t;
+using ComponentMask = std::uint64_t;
+
+constexpr std::size_t kChunkBytes = 16 * 1024;
+constexpr ComponentId kMaxComponents = 64;
+
+namespace ecs_detail {
+ComponentId registerComponent(std::size_t size, std::size_t align, const char* name);
+std::size_t componentSize(ComponentId id);
+std::size_t componentAlign(ComponentId id);
+const char* componentName(ComponentId id);
+ComponentId componentCount();
+// The id registered under `name`, or kMaxComponents.
+ComponentId findComponent(const char* name);
+} // namespace ecs_detail
+
+namespace savefile {
+struct Access;
+} // namespace savefile
+
+// Id of component type T, assigned on first use from any thread (stable for the process
+// lifetime). The type's name (typeid's) identifies it across processes of one build:
+// save files.
+template <typename T>
+ComponentId componentId() {
+    static_assert(std::is_trivially_copyable<T>::value, "components are moved with memcpy");
+    static const ComponentId id = ecs_detail::registerComponent(sizeof(T), alignof(T), typeid(T).name());
+    return id;
+}
+
+template <typename... Ts>
+ComponentMask componentMask() {
+    return (ComponentMask{0} | ... | (ComponentMask{1} << componentId<Ts>()));
+}
+
+class World {
+public:
+    World() = default;
+    World(const World&) = delete;
+    World& operator=(const World&) = delete;
+
+    // New entity with exactly these components, initialized to `values`.
+    template <typename... Ts>
+    EntityHandle create(const Ts&... values) {
+        const Location loc = allocate(createHandle(), archetypeFor(componentMask<Ts...>()));
+        (std::memcpy(columnAt(loc, componentId<Ts>()), &values, sizeof(Ts)), ...);
+        return handleAt(loc);
+    }
+    bool destroy(EntityHandle handle); // false if the handle is stale
+    bool alive(EntityHandle handle) const { return locate(handle) != nullptr; }
+    void clear();
+
+    // Pointer to the entity's T, or nullptr if it is dead or has no T. Valid until the next
+    // structural change (create/destroy/add/remove).
+    template <typename T>
+    T* get(EntityHandle handle) {
+        const Location* loc = locate(handle);
+        return loc ? static_cast<T*>(columnAt(*loc, componentId<T>())) : nullptr;
+    }
+    template <typename T>
+    bool has(EntityHandle handle) const {
+        const Location* loc = locate(handle);
+        return loc && (archetypes_[loc->archetype].mask & componentMask<T>()) != 0;
+    }
+
+    // Structural changes: move the entity to the archetype with T added / removed.
+    template <typename T>
+    bool add(EntityHandle handle, const T& value) {
+        const Location* loc = locate(handle);
+        if (!loc) {
+            return false;
+        }
+        const Location moved = migrate(handle, archetypes_[loc->archetype].mask | componentMask<T>());
+        std::memcpy(columnAt(moved, componentId<T>()), &value, sizeof(T));
+        return true;
+    }
+    template <typename T>
+    bool remove(EntityHandle handle) {
+        const Location* loc = locate(handle);
+        if (!loc || (archetypes_[loc->archetype].mask & componentMask<T>()) == 0) {
+            return false;
+        }
+        migrate(handle, archetypes_[loc->archetype].mask & ~componentMask<T>());
+        return true;
+    }
+
+    // Calls fn(count, Ts*... arrays) once per chunk of every archetype that has ALL of Ts
+    // (it may have more). Element i of each array belongs to the same entity. Systems
+    // must not create/destroy/add/remove inside fn; collect the handles and do it after.
+    template <typename... Ts, typename Fn>
+    void forEachChunk(Fn&& fn) {
+        const ComponentMask required = componentMask<Ts...>();
+        for (Archetype& a : archetypes_) {
+            if ((a.mask & required) != required || a.size == 0) {
+                continue;
+            }
+            for (Chunk& c : a.chunks) {
+                fn(static_cast<std::size_t>(c.count),
+                   reinterpret_cast<Ts*>(c.data.get() + a.offset[componentId<Ts>()])...);
+            }
+        }
+    }
+    // The entities of a chunk being visited (same order as the component arrays).
+    template <typename... Ts, typename Fn>
+    void forEachChunkWithHandles(Fn&& fn) {
+        const ComponentMask required = componentMask<Ts...>();
+        for (Archetype& a : archetypes_) {
+            if ((a.mask & required) != required || a.size == 0) {
+                continue;
+            }
+            for (Chunk& c : a.chunks) {
+                fn(static_cast<std::size_t>(c.count), reinterpret_cast<const EntityHandle*>(c.data.get()),
+                   reinterpret_cast<Ts*>(c.data.get() + a.offset[componentId<Ts>()])...);
+            }
+        }
+    }
+
+    // forEachChunk for component sets known only at run time (script/script.h): fn(count,
+    // columns) with columns[k] the array of ids[k], as bytes.
+    template <typename Fn>
+    void forEachChunkOf(const ComponentId* ids, std::size_t idCount, Fn&& fn) {
+        ComponentMask required = 0;
+        for (std::size_t k = 0; k < idCount; ++k) {
+            required |= ComponentMask{1} << ids[k];
+        }
+        unsigned char* columns[kMaxComponents];
+        for (Archetype& a : archetypes_) {
+            if ((a.mask & required) != required || a.size == 0) {
+                continue;
+            }
+            for (Chunk& c : a.chunks) {
+                for (std::size_t k = 0; k < idCount; ++k) {
+                    columns[k] = c.data.get() + a.offset[ids[k]];
+                }
+                fn(static_cast<std::size_t>(c.count), static_cast<unsigned char* const*>(columns));
+            }
+        }
+    }
+
+    template <typename... Ts>
+    std::size_t count() const {
+        const ComponentMask required = componentMask<Ts...>();
+        std::size_t n = 0;
+        for (const Archetype& a : archetypes_) {
+            if ((a.mask & required) == required) {
+                n += a.size;
+            }
+        }
+        return n;
+    }
+
+    std::size_t size() const { return alive_; }
+    std::size_t archetypeCount() const { return archetypes_.size(); }
+    std::size_t chunkCount() const;
+
+    // The whole World as one contiguous image, and back (ecs/snapshot.h keeps a history
+    // of them). Taking one is a memcpy per column per chunk: no per-entity work.
+    //
+    //     | header | slots | archetype: mask, size, handles[size], column[size]... | ...
+    //
+    // Archetypes go in index order, empty ones too, and the slots in slot order, so two
+    // images of a World that only moved differ only in the bytes that moved: what the
+    // history's XOR deltas rely on. Only valid in this process (component ids are
+    // assigned at first use). restore() keeps the archetypes and reuses chunks; handles
+    // resolve exactly as they did when the image was taken. false: not an image.
+    // Save files (ecs/save_file.h) keep the chunks themselves instead, mapped back in place.
+    void snapshot(std::vector<unsigned char>& out) const;
+    bool restore(const unsigned char* data, std::size_t size);
+
+private:
+    friend struct savefile::Access;            // ecs/save_file.h: chunks in and out whole
+
+    static constexpr std::uint32_t kNoOffset = 0xffffffffu;
+    static constexpr std::uint32_t kEndOfFreeList = 0xffffffffu;
+
+    struct ChunkDeleter {
+        bool mapped;                                    // in a save file's mapping (value-initialized: false)
+        void operator()(unsigned char* p) const;
+    };
+    struct Chunk {
+        std::unique_ptr<unsigned char, ChunkDeleter> data; // kChunkBytes, 64-byte aligned, pooled
+        std::uint32_t count = 0;
+    };
+    struct Archetype {
+        ComponentMask mask = 0;
+        std::uint32_t capacity = 0;                     // rows per chunk
+        std::uint32_t offset[kMaxComponents];           // byte offset of each column, or kNoOffset
+        std::vector<ComponentId> components;
+        std::vector<Chunk> chunks;                      // all full except the last
+        std::size_t size = 0;
+    };
+    struct Location {
+        std::uint32_t archetype = 0;
+        std::uint32_t chunk = 0;
+        std::uint32_t row = 0;
+    };
+    struct Slot {
+        Location location;
+        std::uint32_t generation = 0;
+        std::uint32_t nextFree = kEndOfFreeList;
+        bool alive = false;
+    };
+
+    static Chunk pooledChunk();                   // an empty one from the chunk pool
+    std::uint32_t archetypeFor(ComponentMask mask);
+    EntityHandle createHandle();
+    Location allocate(EntityHandle handle, std::uint32_t archetype);
+    void release(const Location& loc);            // swap-remove a row
+    Location migrate(EntityHandle handle, ComponentMask mask);
+    const Location* locate(EntityHandle handle) const;
+    EntityHandle handleAt(const Location& loc) const;
+    void* columnAt(const Location& loc, ComponentId id);
+
+    std::vector<Archetype> archetypes_;
+    std::unordered_map<ComponentMask, std::uint32_t> archetypeIndex_;
+    std::vector<Slot> slots_;
+    std::uint32_t freeHead_ = kEndOfFreeList;
+    std::size_t alive_ = 0;
+    std::shared_ptr<void> backing_;                // a loaded save file's mapping, while chunks point into it
+};
@@ -0,0 +1,177 @@
+#include "game/game_config.h"
+
+#include <algorithm>
+
+#include "core/config.h"
+#include "core/file_io.h"
+#include "core/log.h"
+#include "input/key_names.h"
+
+namespace {
+
+// How long a reload waits after the last change seen (ConfigReload).
+constexpr double kConfigSettleSeconds = 0.1;
+
+ConfigSchema<GameConfig> gameConfigSchema() {
+    ConfigSchema<GameConfig> schema;
+    schema.field("window.width", &GameConfig::windowWidth, 64, 16384);
+    schema.field("window.height", &GameConfig::windowHeight, 64, 16384);
+    schema.field("render.clear_color", [](const std::string& value, GameConfig& out) {
+        float c[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+        const int n = config::parseFloats(value, c, 4);
+        if (n < 3) return false;
+        out.clearColor = glm::clamp(glm::vec4(c[0], c[1], c[2], c[3]), 0.0f, 1.0f);
+        return true;
+    });
+    schema.field("render.vsync", [](const std::string& value, GameConfig& out) {
+        return FramePacer::parse(value.c_str(), out.vsync);
+    });
+    schema.field("render.scale", &GameConfig::renderScale, 0.25f, 1.0f);
+    schema.field("render.msaa", &GameConfig::msaa, 1, 16);
+    schema.field("player.speed", &GameConfig::playerSpeed, 0.0f, 100.0f);
+    schema.field("player.sprint", &GameConfig::sprint, 0.0f, 100.0f);
+    schema.field("camera.speed", &GameConfig::cameraSpeed, 0.0f, 100.0f);
+    schema.field("camera.sprint", &GameConfig::cameraSprint, 0.0f, 100.0f);
+    schema.field("gamepad.dead_zone", &GameConfig::padDeadZone, 0.0f, 0.9f);
+    schema.field("gamepad.trigger_dead_zone", &GameConfig::padTriggerDeadZone, 0.0f, 0.9f);
+    schema.field("gamepad.curve", &GameConfig::padCurve, 0.0f, 1.0f);
+    schema.field("lod.square_px", &GameConfig::lodSquarePx, 0.0f, 1024.0f);
+    schema.field("lod.disc_px", &GameConfig::lodDiscPx, 0.0f, 1024.0f);
+    schema.field("lod.ring_px", &GameConfig::lodRingPx, 0.0f, 1024.0f);
+    schema.field("lod.diamond_px", &GameConfig::lodDiamondPx, 0.0f, 1024.0f);
+    schema.field("lod.cluster_px", &GameConfig::lodClusterPx, 0.0f, 256.0f);
+    schema.field("lod.cluster_min", &GameConfig::lodClusterMin, 2, 1024);
+    // [keys] Sprint = LeftShift RightShift: up to kKeysPerAction names (input/key_names.h).
+    for (int a = 0; a < kGameActionCount; ++a) {
+        schema.field((std::string("keys.") + kGameActionNames[a]).c_str(), [a](const std::string& value, GameConfig& out) {
+            GameConfig::KeyList keys;
+            keys.fill(-1);
+            std::size_t count = 0, at = 0;
+            while (at < value.size()) {
+                const std::size_t end = std::min(value.find_first_of(" \t,", at), value.size());
+                if (end > at) {
+                    const int key = keynames::fromName(value.substr(at, end - at));
+                    if (key < 0 || count == keys.size()) return false;
+                    keys[count++] = key;
+                }
+                at = end + 1;
+            }
+            out.keys[static_cast<std::size_t>(a)] = keys;
+            return true;
+        });
+    }
+    // [commands] Pause = Escape Ctrl+P: up to kKeysPerAction chords (input/command_map.h).
+    for (int c = 0; c < kGameCommandCount; ++c) {
+        schema.field((std::string("commands.") + kGameCommandNames[c]).c_str(), [c](const std::string& value, GameConfig& out) {
+            GameConfig::ChordList chords{};
+            std::size_t count = 0, at = 0;
+            while (at < value.size()) {
+                const std::size_t end = std::min(value.find_first_of(" \t,", at), value.size());
+                if (end > at) {
+                    KeyChord chord;
+                    if (!parseKeyChord(value.substr(at, end - at), chord) || count == chords.size()) return false;
+                    chords[count++] = chord;
+                }
+                at = end + 1;
+            }
+            out.commands[static_cast<std::size_t>(c)] = chords;
+            return true;
+        });
+    }
+    return schema;
+}
+
+} // namespace
+
+// Parses config text over `out`. false with a reason per bad line in errors (the good
+// ones are still in out).
+bool parseGameConfig(const std::string& text, GameConfig& out, std::vector<std::string>& errors) {
+    static const ConfigSchema<GameConfig> schema = gameConfigSchema();
+    return schema.parse(text, out, errors);
+}
+
+// The same from a file; a missing file is no error: what out held stands.
+bool loadGameConfig(const std::string& path, GameConfig& out, std::vector<std::string>& errors) {
+    std::string text;
+    if (!readFile(path, text)) {
+        return true;
+    }
+    return parseGameConfig(text, out, errors);
+}
+
+FrameTask reloadConfig(ConfigReload* reload, std::uint64_t generation) {
+    co_await seconds(kConfigSettleSeconds);
+    if (generation != reload->generation) {
+        co_return;                     // changed again meanwhile: that one's task reloads
+    }
+    const LoadResult file = co_await load(reload->path);
+    if (generation != reload->generation) {
+        co_return;
+    }
+    // From the defaults: a line taken out of the file goes back to its default (and a
+    // file that's gone, to all of them).
+    GameConfig next;
+    std::vector<std::string> errors;
+    const std::string text = file.ok ? std::string(reinterpret_cast<const char*>(file.data.data()), file.data.size())
+                                     : std::string();
+    if (parseGameConfig(text, next, errors)) {
+        reload->apply(next);
+        logging::info("Config: reloaded %s", reload->path.c_str());
+    } else {
+        for (const std::string& e : errors) {
+            logging::warn("Config %s: %s", reload->path.c_str(), e.c_str());
+        }
+        logging::warn("Config: keeping the previous settings");
+    }
+}
+
+void bindKeys(InputState& keys, const GameConfig& c) {
+    keys.clearBindings();
+    for (int a = 0; a < kGameActionCount; ++a) {
+        for (int key : c.keys[static_cast<std::size_t>(a)]) {
+            if (key >= 0) {
+                keys.bind(key, static_cast<ActionId>(a));
+            }
+        }
+    }
+}
+
+// Recompiles the command table: a reload rebinds without touching the handlers.
+void bindCommands(CommandMap& map, const GameConfig& c) {
+    map.clearBindings();
+    for (int command = 0; command < kGameCommandCount; ++command) {
+        for (const KeyChord& chord : c.commands[static_cast<std::size_t>(command)]) {
+            if (chord.key >= 0) {
+                map.bind(chord, static_cast<CommandId>(command));
+            }
+        }
+    }
+    map.compile();
+}
+
+// Gamepads drive the same actions: left stick and d-pad move, the right stick pans the
+// camera (analog: InputState::axis), the triggers zoom, A or a stick click sprints.
+void bindGamepads(Gamepads& pads, const GameConfig& c) {
+    Gamepads::Settings settings;
+    settings.stickDeadZone = c.padDeadZone;
+    settings.triggerDeadZone = c.padTriggerDeadZone;
+    settings.curve = c.padCurve;
+    pads.setSettings(settings);
+    pads.clearBindings();
+    pads.bindAxis(GLFW_GAMEPAD_AXIS_LEFT_X, false, MoveLeft);
+    pads.bindAxis(GLFW_GAMEPAD_AXIS_LEFT_X, true, MoveRight);
+    pads.bindAxis(GLFW_GAMEPAD_AXIS_LEFT_Y, false, MoveUp);        // GLFW's y is down
+    pads.bindAxis(GLFW_GAMEPAD_AXIS_LEFT_Y, true, MoveDown);
+    pads.bindButton(GLFW_GAMEPAD_BUTTON_DPAD_LEFT, MoveLeft);
+    pads.bindButton(GLFW_GAMEPAD_BUTTON_DPAD_RIGHT, MoveRight);
+    pads.bindButton(GLFW_GAMEPAD_BUTTON_DPAD_UP, MoveUp);
+    pads.bindButton(GLFW_GAMEPAD_BUTTON_DPAD_DOWN, MoveDown);
+    pads.bindAxis(GLFW_GAMEPAD_AXIS_RIGHT_X, false, CameraLeft);
+    pads.bindAxis(GLFW_GAMEPAD_AXIS_RIGHT_X, true, CameraRight);
+    pads.bindAxis(GLFW_GAMEPAD_AXIS_RIGHT_Y, false, CameraUp);
+    pads.bindAxis(GLFW_GAMEPAD_AXIS_RIGHT_Y, true, CameraDown);
+    pads.bindAxis(GLFW_GAMEPAD_AXIS_RIGHT_TRIGGER, true, ZoomIn);
+    pads.bindAxis(GLFW_GAMEPAD_AXIS_LEFT_TRIGGER, true, ZoomOut);
+    pads.bindButton(GLFW_GAMEPAD_BUTTON_A, Sprint);
+    pads.bindButton(GLFW_GAMEPAD_BUTTON_LEFT_THUMB, Sprint);
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "core/frame_pacer.h"
+#include "core/frame_task.h"
+#include "input/command_map.h"
+#include "input/gamepad.h"
+#include "input/input_state.h"
+
+// Gameplay actions (see input/input_state.h). Keys are bound to these by bindKeys().
+enum GameAction : ActionId {
+    MoveLeft, MoveRight, MoveUp, MoveDown,
+    CameraLeft, CameraRight, CameraUp, CameraDown,
+    Sprint,
+    ZoomIn, ZoomOut,
+    kGameActionCount
+};
+const char* const kGameActionNames[kGameActionCount] = {
+    "MoveLeft", "MoveRight", "MoveUp", "MoveDown",
+    "CameraLeft", "CameraRight", "CameraUp", "CameraDown",
+    "Sprint",
+    "ZoomIn", "ZoomOut",
+};
+
+// One-shot commands (see input/command_map.h): keyCallback dispatches them through
+// `commands`, bound in main() from game.cfg's [commands].
+enum GameCommand : CommandId {
+    TogglePause, ToggleScale, ToggleProjection, CyclePath, ToggleFollow,
+    Rewind, QuickSave, QuickLoad,
+    ToggleHud, ToggleTools, ToggleDebugDraw,
+    kGameCommandCount
+};
+const char* const kGameCommandNames[kGameCommandCount] = {
+    "Pause", "Scale", "Projection", "CyclePath", "Follow",
+    "Rewind", "QuickSave", "QuickLoad",
+    "Hud", "Tools", "DebugDraw",
+};
+
+// Game config
+// -----------
+// What game.cfg (--config=FILE; core/config.h) can change, parsed once into this flat
+// struct: the frame reads members, never the file. The defaults are what the game does
+// with no file at all. Saving the file reloads it between frames (applyConfig); the
+// command line's --vsync / --render-scale / --msaa win at startup, and until the file's
+// line for that setting changes.
+struct GameConfig {
+    static constexpr int kKeysPerAction = 4;
+    using KeyList = std::array<int, kKeysPerAction>;    // GLFW keys, -1: unused
+    using ChordList = std::array<KeyChord, kKeysPerAction>;   // key -1: unused
+
+    int windowWidth = 1000;
+    int windowHeight = 1000;
+    glm::vec4 clearColor{0.2f, 0.3f, 0.3f, 1.0f};     // dark teal
+    VsyncMode vsync = VsyncMode::On;
+    float renderScale = 1.0f;          // 0.25..1 of the window's resolution
+    int msaa = 1;
+    float playerSpeed = 1.0f;          // world units per second
+    float sprint = 2.0f;               // speed factor while Sprint is held
+    float cameraSpeed = 1.0f;          // pan, view heights per second
+    float cameraSprint = 2.0f;
+    // [gamepad] (input/gamepad.h)
+    float padDeadZone = 0.2f;          // sticks, of full deflection
+    float padTriggerDeadZone = 0.1f;
+    float padCurve = 0.5f;             // 0: linear .. 1: cubic
+    // [lod] (render/sprite_lod.h): screen sizes, in pixels, below which each sprite type
+    // is drawn as a flat quad (0: never), and the impostor cells over crowds of those.
+    float lodSquarePx = 0.0f;          // sprite 0: the player
+    float lodDiscPx = 3.0f;
+    float lodRingPx = 4.0f;            // thin: it turns to mush sooner
+    float lodDiamondPx = 3.0f;
+    float lodClusterPx = 8.0f;         // 0: no impostors
+    int lodClusterMin = 4;
+    std::array<KeyList, kGameActionCount> keys = {{
+        {GLFW_KEY_LEFT, -1, -1, -1}, {GLFW_KEY_RIGHT, -1, -1, -1}, {GLFW_KEY_UP, -1, -1, -1},
+        {GLFW_KEY_DOWN, -1, -1, -1}, {GLFW_KEY_A, -1, -1, -1},     {GLFW_KEY_D, -1, -1, -1},
+        {GLFW_KEY_W, -1, -1, -1},    {GLFW_KEY_S, -1, -1, -1},     {GLFW_KEY_LEFT_SHIFT, -1, -1, -1},
+        {GLFW_KEY_E, -1, -1, -1},    {GLFW_KEY_Q, -1, -1, -1},
+    }};
+    std::array<ChordList, kGameCommandCount> commands = {{
+        {{{GLFW_KEY_ESCAPE, 0}}}, {{{GLFW_KEY_R, 0}}},  {{{GLFW_KEY_P, 0}}},         {{{GLFW_KEY_B, 0}}},
+        {{{GLFW_KEY_F, 0}}},      {{{GLFW_KEY_BACKSPACE, 0}}}, {{{GLFW_KEY_F5, 0}}}, {{{GLFW_KEY_F9, 0}}},
+        {{{GLFW_KEY_F2, 0}}},     {{{GLFW_KEY_F4, 0}}}, {{{GLFW_KEY_F3, 0}}},
+    }};
+};
+
+// Parses config text over `out`. false with a reason per bad line in errors (the good
+// ones are still in out).
+bool parseGameConfig(const std::string& text, GameConfig& out, std::vector<std::string>& errors);
+
+// The same from a file; a missing file is no error: what out held stands.
+bool loadGameConfig(const std::string& path, GameConfig& out, std::vector<std::string>& errors);
+
+// Saving the config file reloads it. Editors often write a file in more than one go
+// (truncate, then write), so a reload waits a moment after the LAST change seen, has a
+// worker read the file, and parses and applies it on main: one FrameTask
+// (core/frame_task.h) per change, the older ones giving way.
+struct ConfigReload {
+    std::string path;
+    std::uint64_t generation = 0;      // changes seen so far
+    std::function<void(const GameConfig&)> apply;
+};
+
+// The reload for change `generation`: gives way if reload->generation has moved on.
+FrameTask reloadConfig(ConfigReload* reload, std::uint64_t generation);
+
+// Rebinds every action to its keys in c.keys.
+void bindKeys(InputState& keys, const GameConfig& c);
+
+// Recompiles the command table: a reload rebinds without touching the handlers.
+void bindCommands(CommandMap& map, const GameConfig& c);
+
+// Gamepads drive the same actions: left stick and d-pad move, the right stick pans the
+// camera (analog: InputState::axis), the triggers zoom, A or a stick click sprints.
+void bindGamepads(Gamepads& pads, const GameConfig& c);
@@ -0,0 +1,306 @@
+#include "game/options.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#include "net/replication.h"
+#include "profile/hitch_detector.h"
+#include "profile/telemetry.h"
+#include "render/dynamic_resolution.h"
+#include "render/post_process.h"
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--config=", 0) == 0) {
+            // read before the other options (configPath)
+        } else if (arg.rfind("--vsync=", 0) == 0) {
+            if (!FramePacer::parse(arg.c_str() + 8, options.pacing.vsync)) {
+                std::cerr << "Unknown vsync mode: " << arg << "\n";
+                return false;
+            }
+        } else if (arg.rfind("--gl-tier=", 0) == 0) {
+            if (!glext::parseTier(arg.c_str() + 10, &options.glTier)) {
+                std::cerr << "Unknown GL tier: " << arg << "\n";
+                return false;
+            }
+        } else if (arg == "--gl-debug") {
+            options.glDebug = gldebug::Mode::On;
+        } else if (arg.rfind("--gl-debug=", 0) == 0) {
+            if (!gldebug::parse(arg.c_str() + 11, options.glDebug)) {
+                std::cerr << "Unknown GL debug mode: " << arg << "\n";
+                return false;
+            }
+        } else if (arg.rfind("--stall-ms=", 0) == 0) {
+            options.stallMs = std::atof(arg.c_str() + 11);
+        } else if (arg.rfind("--fps-cap=", 0) == 0) {
+            options.pacing.fpsCap = std::atof(arg.c_str() + 10);
+        } else if (arg == "--low-latency") {
+            options.pacing.lowLatency = true;
+        } else if (arg == "--profile") {
+            options.profile = true;
+        } else if (arg.rfind("--trace=", 0) == 0) {
+            options.tracePath = arg.substr(8);
+        } else if (arg == "--flight-recorder") {
+            options.flightRecorder = true;
+        } else if (arg == "--hitch-capture") {
+            options.hitchMultiple = HitchDetector::Settings{}.multiple;
+        } else if (arg.rfind("--hitch-capture=", 0) == 0) {
+            options.hitchMultiple = std::max(1.0, std::atof(arg.c_str() + 16));
+        } else if (arg.rfind("--entities=", 0) == 0) {
+            options.entities = std::max(0, std::atoi(arg.c_str() + 11));
+        } else if (arg.rfind("--jobs=", 0) == 0) {
+            options.jobs = std::max(0, std::atoi(arg.c_str() + 7));
+        } else if (arg == "--affinity" || arg == "--affinity=auto" || arg == "--affinity=off") {
+            options.affinity = arg != "--affinity=off";
+        } else if (arg.rfind("--affinity-", 0) == 0 && arg.find('=') != std::string::npos) {
+            const std::string role = arg.substr(11, arg.find('=') - 11);
+            int r = 0;
+            while (r < affinity::kRoles && role != affinity::roleName(static_cast<affinity::Role>(r))) {
+                ++r;
+            }
+            if (r == affinity::kRoles || !affinity::parseCpuList(arg.substr(arg.find('=') + 1), options.affinityCpus.cpus[r])) {
+                std::cerr << "Unknown affinity option: " << arg << "\n";
+                return false;
+            }
+        } else if (arg == "--no-idle-wait") {
+            options.idleWait = false;
+        } else if (arg == "--no-frame-budget") {
+            options.frameBudget = false;
+        } else if (arg == "--no-damage-tracking") {
+            options.damageTracking = false;
+        } else if (arg == "--startup-bench") {
+            options.startupBench = true;
+        } else if (arg.rfind("--startup-bench=", 0) == 0) {
+            options.startupBench = true;
+            options.startupBenchCsv = arg.substr(16);
+        } else if (arg.rfind("--render-jobs=", 0) == 0) {
+            options.renderJobs = std::max(0, std::atoi(arg.c_str() + 14));
+        } else if (arg == "--no-render-thread") {
+            options.renderThread = false;
+        } else if (arg.rfind("--shader-cache=", 0) == 0) {
+            options.shaderCache = arg.substr(15);
+        } else if (arg == "--no-shader-cache") {
+            options.shaderCache.clear();
+        } else if (arg == "--no-shader-reload") {
+            options.shaderReload = false;
+        } else if (arg == "--tilemap" || arg == "--tilemap=chunks") {
+            options.tilemap = true;
+        } else if (arg == "--tilemap=index") {
+            options.tilemap = true;
+            options.tilemapMode = Tilemap::Mode::IndexTexture;
+        } else if (arg == "--procgen") {
+            options.procgenWidth = options.procgenHeight = 1024;
+        } else if (arg.rfind("--procgen=", 0) == 0) {
+            if (std::sscanf(arg.c_str() + 10, "%dx%d", &options.procgenWidth, &options.procgenHeight) != 2 ||
+                options.procgenWidth < 1 || options.procgenHeight < 1 || options.procgenWidth > Tilemap::kMaxTiles ||
+                options.procgenHeight > Tilemap::kMaxTiles) {
+                std::cerr << "Unknown world size: " << arg << "\n";
+                return false;
+            }
+        } else if (arg.rfind("--procgen-seed=", 0) == 0) {
+            options.procgenSeed = static_cast<std::uint32_t>(std::strtoul(arg.c_str() + 15, nullptr, 10));
+        } else if (arg == "--procgen-gpu") {
+            options.procgenGpu = true;
+        } else if (arg == "--virtual-background") {
+            options.virtualPages = 512;
+        } else if (arg.rfind("--virtual-background=", 0) == 0) {
+            options.virtualPages = std::max(1, std::atoi(arg.c_str() + 21));
+        } else if (arg == "--no-audio") {
+            options.audio = false;
+        } else if (arg.rfind("--audio-out=", 0) == 0) {
+            options.audioOut = arg.substr(12);
+        } else if (arg.rfind("--music=", 0) == 0) {
+            options.musicPath = arg.substr(8);
+        } else if (arg.rfind("--rewind=", 0) == 0) {
+            options.rewindSeconds = std::atof(arg.c_str() + 9);
+        } else if (arg.rfind("--save-file=", 0) == 0) {
+            options.saveFile = arg.substr(12);
+        } else if (arg == "--host") {
+            options.hostPort = ReplicationServer::Settings{}.port;
+        } else if (arg.rfind("--host=", 0) == 0) {
+            options.hostPort = std::atoi(arg.c_str() + 7);
+        } else if (arg.rfind("--connect=", 0) == 0) {
+            options.connectTo = arg.substr(10);
+        } else if (arg == "--telemetry") {
+            options.telemetry = std::to_string(Telemetry::kDefaultPort);
+        } else if (arg.rfind("--telemetry=", 0) == 0) {
+            options.telemetry = arg.substr(12);
+        } else if (arg == "--scripts") {
+            options.scriptsDir = "scripts";
+        } else if (arg.rfind("--scripts=", 0) == 0) {
+            options.scriptsDir = arg.substr(10);
+        } else if (arg.rfind("--level=", 0) == 0) {
+            options.levelPath = arg.substr(8);
+        } else if (arg.rfind("--thumbnails=", 0) == 0) {
+            std::stringstream list(arg.substr(13));
+            for (std::string path; std::getline(list, path, ',');) {
+                if (!path.empty()) {
+                    options.thumbnails.push_back(path);
+                }
+            }
+        } else if (arg.rfind("--thumbnail-size=", 0) == 0) {
+            options.thumbnailSize = std::clamp(std::atoi(arg.c_str() + 17), 16, 4096);
+        } else if (arg.rfind("--thumbnail-contexts=", 0) == 0) {
+            options.thumbnailContexts = std::clamp(std::atoi(arg.c_str() + 21), 1, 32);
+        } else if (arg.rfind("--thumbnail-dir=", 0) == 0) {
+            options.thumbnailDir = arg.substr(16);
+        } else if (arg == "--no-static-batch") {
+            options.staticBatch = false;
+        } else if (arg == "--no-lod") {
+            options.lod = false;
+        } else if (arg.rfind("--record=", 0) == 0) {
+            options.recordPath = arg.substr(9);
+        } else if (arg.rfind("--replay=", 0) == 0) {
+            options.replayPath = arg.substr(9);
+        } else if (arg == "--sim-bench") {
+            const int hardware = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+            options.simBenchThreads.clear();
+            for (int n = 1; n < hardware; n *= 2) {
+                options.simBenchThreads.push_back(n);
+            }
+            options.simBenchThreads.push_back(hardware);
+        } else if (arg.rfind("--sim-bench=", 0) == 0) {
+            options.simBenchThreads.clear();
+            std::stringstream list(arg.substr(12));
+            for (std::string n; std::getline(list, n, ',');) {
+                if (std::atoi(n.c_str()) < 1) {
+                    std::cerr << "--sim-bench: thread counts are 1 or more, not " << n << "\n";
+                    return false;
+                }
+                options.simBenchThreads.push_back(std::atoi(n.c_str()));
+            }
+        } else if (arg == "--collisions") {
+            options.collisions = true;
+        } else if (arg.rfind("--particles=", 0) == 0) {
+            options.particles = std::max(0, std::atoi(arg.c_str() + 12));
+        } else if (arg.rfind("--orbiters=", 0) == 0) {
+            options.orbiters = std::max(0, std::atoi(arg.c_str() + 11));
+        } else if (arg.rfind("--critters=", 0) == 0) {
+            options.critters = std::max(0, std::atoi(arg.c_str() + 11));
+        } else if (arg.rfind("--path-agents=", 0) == 0) {
+            options.pathAgents = std::max(0, std::atoi(arg.c_str() + 14));
+        } else if (arg.rfind("--flow-agents=", 0) == 0) {
+            options.flowAgents = std::max(0, std::atoi(arg.c_str() + 14));
+        } else if (arg == "--turn-timers") {
+            options.turnTimers = true;
+        } else if (arg.rfind("--boids=", 0) == 0) {
+            options.boids = std::max(0, std::atoi(arg.c_str() + 8));
+        } else if (arg.rfind("--lights=", 0) == 0) {
+            options.lights = std::max(0, std::atoi(arg.c_str() + 9));
+        } else if (arg == "--light-tiles") {
+            options.lightTiles = true;
+        } else if (arg == "--oit") {
+            options.oit = true;
+        } else if (arg == "--instance-fetch") {
+            options.instanceFetch = true;
+        } else if (arg == "--sprite-animation") {
+            options.spriteAnimation = true;
+        } else if (arg == "--particles-cpu") {
+            options.particlesCpu = true;
+        } else if (arg == "--gpu-cull") {
+            options.gpuCull = true;
+        } else if (arg == "--gpu-pick") {
+            options.gpuPick = true;
+        } else if (arg == "--split") {
+            options.split = true;
+        } else if (arg == "--minimap") {
+            options.minimap = true;
+        } else if (arg == "--debug-draw") {
+            options.debugDraw = true;
+        } else if (arg == "--hud") {
+            options.hud = true;
+        } else if (arg == "--ui") {
+            options.ui = true;
+        } else if (arg == "--shapes") {
+            options.shapes = true;
+        } else if (arg == "--profiler-window") {
+            options.profilerWindow = true;
+        } else if (arg.rfind("--font=", 0) == 0) {
+            options.fontPath = arg.substr(7);
+        } else if (arg.rfind("--render-scale=", 0) == 0) {
+            options.renderScale = std::min(1.0f, std::max(0.25f, static_cast<float>(std::atof(arg.c_str() + 15))));
+        } else if (arg == "--dynamic-resolution") {
+            options.dynamicResolutionMs = DynamicResolution::Settings{}.targetMs;
+        } else if (arg.rfind("--dynamic-resolution=", 0) == 0) {
+            options.dynamicResolutionMs = std::max(1.0, std::atof(arg.c_str() + 21));
+        } else if (arg == "--quality-governor") {
+            options.qualityGovernor = true;
+        } else if (arg.rfind("--msaa=", 0) == 0) {
+            options.msaa = std::max(1, std::atoi(arg.c_str() + 7));
+        } else if (arg == "--overdraw") {
+            options.overdraw = true;
+        } else if (arg.rfind("--overdraw=", 0) == 0) {
+            if (!OverdrawMeter::parse(arg.c_str() + 11, options.overdrawCount)) {
+                std::cerr << "Unknown overdraw count: " << arg << "\n";
+                return false;
+            }
+            options.overdraw = true;
+        } else if (arg == "--post") {
+            options.post = PostProcessChain::kAllEffects;
+        } else if (arg.rfind("--post=", 0) == 0) {
+            if (!PostProcessChain::parse(arg.c_str() + 7, options.post)) {
+                std::cerr << "Unknown post effect: " << arg << "\n";
+                return false;
+            }
+        } else if (arg == "--capture") {
+            options.capture = true;
+        } else if (arg.rfind("--capture=", 0) == 0) {
+            if (!FrameCapture::parse(arg.c_str() + 10, options.captureSettings.format)) {
+                std::cerr << "Unknown capture format: " << arg << "\n";
+                return false;
+            }
+            options.capture = true;
+        } else if (arg.rfind("--capture-dir=", 0) == 0) {
+            options.captureSettings.directory = arg.substr(14);
+            options.capture = true;
+        } else if (arg.rfind("--capture-every=", 0) == 0) {
+            options.captureSettings.every = std::max(1, std::atoi(arg.c_str() + 16));
+            options.capture = true;
+        } else if (arg.rfind("--capture-frames=", 0) == 0) {
+            options.captureSettings.limit = static_cast<std::uint64_t>(std::max(0, std::atoi(arg.c_str() + 17)));
+            options.capture = true;
+        } else if (arg.rfind("--capture-pipe=", 0) == 0) {
+            options.captureSettings.pipe = arg.substr(15);
+            options.capture = true;
+        } else if (arg == "--offline") {
+            options.offlineFrames = 0;
+        } else if (arg.rfind("--offline=", 0) == 0) {
+            options.offlineFrames = std::max(1, std::atoi(arg.c_str() + 10));
+        } else if (arg.rfind("--log=", 0) == 0) {
+            if (!logging::parse(arg.c_str() + 6, options.logLevel)) {
+                std::cerr << "Unknown log level: " << arg << "\n";
+                return false;
+            }
+        } else if (arg.rfind("--pack=", 0) == 0) {
+            options.packs.push_back(arg.substr(7));
+        } else if (arg.rfind("--player-texture=", 0) == 0) {
+            options.playerTexture = arg.substr(17);
+        } else if (arg.rfind("--texture-budget=", 0) == 0) {
+            options.textureBudgetMb = std::strtoul(arg.c_str() + 17, nullptr, 10);
+        } else if (arg.rfind("--texture-cache=", 0) == 0) {
+            options.textureCacheMb = std::strtoul(arg.c_str() + 16, nullptr, 10);
+        } else if (parseBenchOption(arg.c_str(), options.bench)) {
+            // handled
+        } else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string configPath(int argc, char** argv) {
+    std::string path = "game.cfg";
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--config=", 9) == 0) {
+            path = argv[i] + 9;
+        }
+    }
+    return path;
+}
@@ -0,0 +1,332 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "bench/bench.h"
+#include "core/frame_pacer.h"
+#include "core/log.h"
+#include "core/thread_affinity.h"
+#include "render/frame_capture.h"
+#include "render/gl_debug.h"
+#include "render/gl_ext.h"
+#include "render/gl_stall.h"
+#include "render/overdraw.h"
+#include "render/tilemap.h"
+
+// Command-line options
+// --------------------
+//   --config=FILE             settings and key bindings (default: game.cfg, if it exists);
+//                             reloaded when saved. See GameConfig and game.cfg
+//   --vsync=off|on|adaptive   swap interval (default: on)
+//   --fps-cap=N               cap the frame rate with sleep + spin (default: uncapped)
+//   --low-latency             wait BEFORE sampling input instead of after presenting
+//   --profile                 print rolling CPU/GPU section timings every 2 seconds
+//                             (and each shader program's compile + link time at startup)
+//   --trace=FILE              stream profiler sections into a Chrome/Perfetto JSON trace
+//   --flight-recorder         keep the last seconds of every thread's sections, GL stalls,
+//                             keys and frame times in memory; write them out as a trace on
+//                             a crash or on SIGUSR1 (profile/flight_recorder.h)
+//   --hitch-capture[=X]       the flight recorder, plus a dump around every frame over X
+//                             times the rolling median (default 3; profile/hitch_detector.h)
+//   --entities=N              N extra wandering quads
+//   --jobs=N                  N worker threads (0: everything on the main thread)
+//   --affinity[=auto|off]     pin the render, main and audio threads to cores of their own
+//                             and the workers to the rest, P-cores first (default: off;
+//                             core/thread_affinity.h). --jobs then defaults to the rest's CPUs
+//   --affinity-render|-main|-audio|-workers=LIST   that role's CPUs, e.g. 0,16 or 2-14
+//   --no-idle-wait            keep drawing every frame while paused or in the background
+//   --no-damage-tracking      present every frame, even one identical to the last
+//   --no-frame-budget         run all of the deferrable work (streamed regions spawning,
+//                             path agents re-planning) every frame, however long it takes,
+//                             instead of what fits the frame (core/frame_budget.h)
+//   --startup-bench[=FILE]    exit after the first presented frame and print the startup
+//                             steps' times; FILE: also append them to it as a CSV row
+//   --render-jobs=N           N workers of the render thread's own, which record the views'
+//                             commands and sort the translucent sprites (default 2; 0: the
+//                             render thread alone)
+//   --record=FILE             write the session's input, per simulation tick, to FILE
+//                             (input/input_recording.h)
+//   --replay=FILE             re-run a recorded session as a benchmark: hidden window, no
+//                             vsync, one recorded tick per frame; frame times at the end
+//   --sim-bench[=N,N,...]     with --replay: its ticks alone, no window, GL or renderer,
+//                             as fast as they go, once per thread count (default 1, 2,
+//                             4, ... up to the hardware's); ticks/s, speedup and a state
+//                             checksum that must not depend on the count
+//   --rewind=SECONDS          how much the snapshot history keeps (default 10; 0: off).
+//                             Every simulation step snapshots the World; hold Backspace
+//                             to run it backwards, F5 / F9 quick-save / quick-load
+//                             (ecs/snapshot.h). Off with --record, --replay and --level
+//   --save-file=FILE          F5 / F9 save the World to FILE and load it back instead:
+//                             the chunks as they are, memory-mapped on load
+//                             (ecs/save_file.h)
+//   --no-audio                no sound. Otherwise a mixer thread plays the effects the
+//                             game queues to it lock-free: wanderers tock when they
+//                             bounce, picks blip (audio/mixer.h)
+//   --audio-out=FILE          mix into a 16-bit WAV file instead of the sound card
+//   --music=FILE              a WAV track under the effects, looped, decoded on its own
+//                             thread as it plays (audio/audio_stream.h)
+//   --collisions              the player and the wanderers collide: sweep-and-prune
+//                             broadphase, box narrowphase, every simulation step
+//                             (core/sweep_and_prune.h, core/collision.h)
+//   --no-render-thread        make the GL calls on the main thread (no sim/render overlap)
+//   --gl-tier=baseline|streaming|gpu-driven
+//                             use no faster paths than that tier's, whatever the driver
+//                             offers (render/gl_ext.h); baseline also asks for GL 3.3 only
+//   --gl-debug[=sync]         a debug context: driver errors and performance warnings
+//                             (stalls, recompiles) logged once each (render/gl_debug.h);
+//                             sync: on the offending call. Not in release builds
+//   --stall-ms=MS             a map, readback or fence wait longer than that is a GPU
+//                             stall: traced, logged per call site (render/gl_stall.h)
+//   --shader-cache=DIR        where linked program binaries are kept (default: shader_cache)
+//   --no-shader-cache         always compile the shaders from source
+//   --no-shader-reload        don't watch shaders/ for saved files
+//   --pack=FILE               read assets from a pack built by `make pack` (repeatable; later
+//                             packs win, loose files fill in what no pack has)
+//   --player-texture=FILE     TGA / PPM / PAM / KTX2 loaded in the background; the sprite batch
+//                             path draws the player with it once it's uploaded
+//   --texture-budget=MB       VRAM for loaded textures: over it, the ones nobody references
+//                             go, least recently drawn first (default 0: no limit)
+//   --texture-cache=MB        keep decoded textures LZ4-compressed in memory, so an evicted
+//                             one reloads without the file (default 64; 0: off)
+//   --host[=PORT]             serve this game's World to --connect clients (default port
+//                             27960): delta snapshots of what each one sees, over UDP
+//                             (net/replication.h)
+//   --connect=HOST:PORT       join a --host game: the World is the server's, as it sends it,
+//                             plus a player of this window's own, moved at once by its keys
+//                             and corrected when the server disagrees (net/prediction.h)
+//   --telemetry[=PORT|HOST:PORT]
+//                             frame time percentiles, GPU time, memory and render stats
+//                             for a monitoring agent, once a second as "key value" text:
+//                             sent back to whoever asks on PORT (default 27962), or
+//                             pushed to HOST:PORT (profile/telemetry.h)
+//   --scripts[=DIR]           run the *.script files in DIR (default: scripts) every step,
+//                             over the component arrays in bulk, and reload them when saved
+//                             (script/script.h); each shows as a "script:" profiler section
+//   --level=FILE              stream a level built by `make level` (core/level_file.h):
+//                             regions around the camera are paged in and checked on the
+//                             job system, then their props and tiles appear
+//                             (core/level_streamer.h); with --tilemap=index for its tiles
+//                             in index-texture mode
+//   --thumbnails=FILE,...     render each level's tiles as a PNG into --thumbnail-dir
+//                             (default thumbnails/), several at once on hidden contexts that
+//                             share the programs and the sprite array, then exit
+//                             (render/context_pool.h)
+//   --thumbnail-size=N        ... N pixels on the map's longer side (default 256)
+//   --thumbnail-contexts=N    ... N contexts, a thread each (default 4)
+//   --thumbnail-dir=DIR       ... into DIR
+//   --no-static-batch         with --level: props become entities (pickable, depth-sorted)
+//                             instead of baked per region into static vertex buffers
+//                             (render/static_batch.h)
+//   --no-lod                  draw every sprite as it is however small on screen, instead
+//                             of flat quads and impostors when zoomed out ([lod] in the
+//                             config; render/sprite_lod.h)
+//   --tilemap[=chunks|index]  a generated two-layer tile background (render/tilemap.h):
+//                             chunk meshes (default) or one quad reading a tile index
+//                             texture; right click paints a tile on the upper layer
+//   --procgen[=WxH]           instead, a WxH-tile (default 1024x1024) noise world, its
+//                             chunks generated on the job system as the camera nears them
+//                             and streamed into the tilemap (core/world_gen.h); with
+//                             --tilemap=index for worlds past a few thousand tiles a side
+//   --procgen-seed=N          its seed (default 1)
+//   --procgen-gpu             its noise rendered on the GPU in batches of chunks and read
+//                             back asynchronously (render/gpu_noise.h), not on the workers
+//   --virtual-background[=PAGES]  a PAGES² page (default 512: 64K² texels) generated
+//                             terrain image under the world, streamed into a fixed cache
+//                             by what a feedback pass says is on screen
+//                             (render/virtual_texture.h)
+//   --lights=N                N coloured point lights and one on the player, added into a
+//                             quarter-resolution light target and multiplied over the
+//                             world (render/light_buffer.h)
+//   --light-tiles             with --lights: bin the lights into 16x16 pixel tiles on the
+//                             job system and sum each pixel's tile list at full
+//                             resolution instead of the light target
+//   --oit                     the texture array path's translucent sprites blended without
+//                             sorting: weighted blended transparency into two targets,
+//                             composited over the scene (render/oit_buffer.h); needs a
+//                             single-sampled scene (not with --msaa), sorts as before
+//                             for --sprite-animation clips
+//   --orbiters=N              N satellites (each with a moon) circling the player, placed
+//                             by a parent/child transform hierarchy
+//                             (core/transform_hierarchy.h)
+//   --critters=N              N skinned critters waving their arms: one batch of 2D
+//                             skeletons posed on the job system (core/skeleton_2d.h),
+//                             one instanced draw bent on the GPU (render/skinned_mesh.h)
+//   --path-agents=N           N agents walking the --tilemap (or the --level's tiles)
+//                             between random open tiles, on paths queried in batches
+//                             on the job system (core/path_service.h)
+//   --flow-agents=N           N agents on the same tiles streaming toward the player,
+//                             steered by one flow field (core/flow_field.h)
+//   --turn-timers             every wanderer turns around every 2-6 seconds, on its own
+//                             repeating timer in a timing wheel (core/timer_wheel.h)
+//   --boids=N                 N quads flocking (separation, alignment, cohesion) over
+//                             the wanderers' area: a cell-sorted grid and SSE2 neighbour
+//                             sums on the job system (core/boids.h)
+//   --instance-fetch          the texture array path's instances go in a texture buffer
+//                             the vertex shader indexes by gl_InstanceID, not in
+//                             instance attributes (render/instanced_quads.h)
+//   --sprite-animation        the --entities play sprite clips; on the texture array path
+//                             the vertex shader picks their frames from a clip table
+//                             (render/sprite_animation.h), elsewhere the CPU does
+//   --particles=N             N particles simulated on the GPU (render/particle_system.h),
+//                             emitted from the camera position
+//   --particles-cpu           ... simulated on the CPU instead: SIMD over SoA arrays on the
+//                             job system (core/particle_soa.h), streamed as instances
+//   --gpu-cull                cull the GPU particles against the view in a compute pass and
+//                             draw the survivors indirectly (GL 4.3; ignored without it)
+//   --split                   split-screen: the camera on the left half, a second one that
+//                             always follows the player on the right
+//   --minimap                 the whole world in a corner, over the main view
+//                             (both: one cull and one instance stream for every view,
+//                             render/frame_packet.h FrameView)
+//   --gpu-pick                clicks are also resolved pixel-exactly: the objects around the
+//                             cursor drawn as ids into a tiny target, read back a frame or
+//                             two later (render/gpu_picker.h)
+//   --hud                     start with the HUD on (F2 toggles it): frame-time graph, both
+//                             threads' section timings, draws, instances, state calls and
+//                             allocations (profile/perf_hud.h), drawn as SDF text
+//                             (render/sdf_font.h, render/text_batch.h)
+//   --profiler-window         the HUD in a second window of its own, whether F2 shows it
+//                             over the game or not; its context shares the main one's
+//                             textures, buffers and programs (nothing is uploaded twice)
+//   --font=FILE.hex           the HUD's text in a GNU Unifont .hex bitmap font, UTF-8, each
+//                             character made a distance field the first time it shows
+//                             (asset/bitmap_font.h, render/glyph_cache.h)
+//   --ui                      start with the tools panel on (F4 toggles it): the HUD, debug
+//                             shapes, camera and renderer path as immediate-mode widgets
+//                             whose quads are kept until they change (ui/immediate_ui.h,
+//                             render/ui_renderer.h)
+//   --shapes                  the sprite batch path draws the wanderers as concave stars:
+//                             triangulated once, cached by outline, in the same batch as
+//                             the sprites (core/triangulate.h, render/shape_cache.h)
+//   --debug-draw              start with the debug shapes on (F3 toggles them): every
+//                             visible object's bounds, the last pick (render/debug_draw.h);
+//                             not in release builds
+//   --render-scale=F          draw the world at F (0.25..1) times the window's resolution into
+//                             an offscreen target and upscale it: fewer pixels on weak GPUs
+//   --msaa=N                  ... with N samples per pixel, resolved when presenting
+//                             (render/render_target.h); the UI stays at full resolution
+//   --dynamic-resolution[=MS] pick the render scale every frame to keep the GPU frame time
+//                             under MS (default 14), between --render-scale (default
+//                             0.5) and 1 (render/dynamic_resolution.h)
+//   --quality-governor        hold the frame rate by lowering quality when the CPU or GPU
+//                             frame time runs over the frame's period and raising it when
+//                             there is room again: render scale, particles and lights drawn,
+//                             LOD sizes, MSAA (render/quality_governor.h); not headless
+//   --overdraw[=shaded]       count the fragments each scene pixel gets and draw them as a
+//                             heatmap; the HUD and --profile show mean and max. shaded:
+//                             only those that pass the depth test (render/overdraw.h)
+//   --post[=bloom,grade,vignette]  post-process the scene on its way to the window (all
+//                             three by default): bloom at 1/2 and 1/4 resolution, the
+//                             per-pixel effects fused into one pass (render/post_process.h)
+//   --capture[=png|raw]       write every finished frame to --capture-dir (default
+//                             captures/), read back asynchronously (render/frame_capture.h)
+//   --capture-dir=DIR         ... into DIR
+//   --capture-every=N         ... only every Nth frame
+//   --capture-frames=N        ... stop after N
+//   --capture-pipe=CMD        ... as raw RGBA frames into CMD's stdin (an encoder) instead
+//   --offline[=FRAMES]        render FRAMES frames (default: to the end of the --replay,
+//                             else one, a thumbnail) in a hidden window, one simulation step
+//                             each on simulated time, as fast as the GPU goes, and capture
+//                             every one: the queue waits for the writer, never drops
+//   --log=debug|info|warn|error|off   least severe message printed from the frame loop and
+//                             the callbacks (default: info); they are written by a
+//                             background thread, never by the one drawing (core/log.h)
+//   --bench[-quads|-frames|-warmup|-path|-scene|-tiles]=...   headless benchmark, see bench/bench.h
+struct Options {
+    FramePacer::Settings pacing;
+    bool profile = false;
+    std::string tracePath;
+    bool flightRecorder = false; // --flight-recorder
+    double hitchMultiple = 0.0;  // --hitch-capture[=X]; 0: off
+    BenchOptions bench;
+    int entities = 0; // --entities=N: extra wandering quads next to the player
+    int jobs = -1;    // --jobs=N: worker threads (default: one per core, minus main)
+    bool affinity = false;      // --affinity[=auto]: the automatic pinning plan
+    affinity::Plan affinityCpus; // --affinity-ROLE=LIST: a role's own CPUs
+    int renderJobs = 2; // --render-jobs=N: workers recording views and sorting sprites
+    bool idleWait = true;        // --no-idle-wait: paused / background frames drawn anyway
+    bool damageTracking = true;  // --no-damage-tracking: unchanged frames drawn anyway
+    bool frameBudget = true;     // --no-frame-budget: deferrable work never deferred
+    bool startupBench = false;   // --startup-bench[=FILE]: quit after the first frame
+    std::string startupBenchCsv; // ... and FILE
+    bool renderThread = true; // --no-render-thread: GL calls inline on the main thread
+    glext::Tier glTier = glext::Tier::GpuDriven; // --gl-tier=NAME: the highest one to use
+    gldebug::Mode glDebug = gldebug::Mode::Off;  // --gl-debug[=sync]
+    double stallMs = glstall::kDefaultThresholdMs;  // --stall-ms=MS
+    std::string playerTexture;  // --player-texture=FILE
+    std::size_t textureBudgetMb = 0;  // --texture-budget=MB
+    std::size_t textureCacheMb = 64;  // --texture-cache=MB
+    std::string shaderCache = "shader_cache"; // --shader-cache=DIR; empty: --no-shader-cache
+    bool shaderReload = true;   // --no-shader-reload
+    std::vector<std::string> packs; // --pack=FILE, in mount order
+    bool tilemap = false;       // --tilemap
+    Tilemap::Mode tilemapMode = Tilemap::Mode::Chunks; // --tilemap=index
+    int procgenWidth = 0;       // --procgen[=WxH]; 0: none
+    int procgenHeight = 0;
+    std::uint32_t procgenSeed = 1; // --procgen-seed=N
+    bool procgenGpu = false;    // --procgen-gpu
+    int virtualPages = 0;       // --virtual-background[=PAGES]; 0: none
+    bool collisions = false;    // --collisions
+    std::string recordPath;     // --record=FILE
+    std::string replayPath;     // --replay=FILE
+    std::vector<int> simBenchThreads; // --sim-bench[=N,N,...]; empty: off
+    std::string levelPath;      // --level=FILE
+    std::vector<std::string> thumbnails; // --thumbnails=FILE,...: levels
+    std::string thumbnailDir = "thumbnails";
+    int thumbnailSize = 256;
+    int thumbnailContexts = 4;
+    bool staticBatch = true;    // --no-static-batch
+    bool lod = true;            // --no-lod
+    int hostPort = 0;           // --host[=PORT]
+    std::string connectTo;      // --connect=HOST:PORT
+    std::string telemetry;      // --telemetry[=PORT|HOST:PORT]; empty: off
+    std::string scriptsDir;     // --scripts[=DIR]
+    double rewindSeconds = 10.0; // --rewind=SECONDS
+    std::string saveFile;       // --save-file=FILE
+    bool audio = true;          // --no-audio
+    std::string audioOut;       // --audio-out=FILE
+    std::string musicPath;      // --music=FILE
+    int particles = 0;          // --particles=N
+    int orbiters = 0;           // --orbiters=N
+    int critters = 0;           // --critters=N
+    int pathAgents = 0;         // --path-agents=N
+    int flowAgents = 0;         // --flow-agents=N
+    int boids = 0;              // --boids=N
+    bool turnTimers = false;    // --turn-timers
+    int lights = 0;             // --lights=N
+    bool lightTiles = false;    // --light-tiles
+    bool oit = false;           // --oit
+    bool spriteAnimation = false; // --sprite-animation
+    bool instanceFetch = false; // --instance-fetch
+    bool particlesCpu = false;  // --particles-cpu
+    bool gpuCull = false;       // --gpu-cull
+    bool gpuPick = false;       // --gpu-pick
+    bool split = false;         // --split
+    bool minimap = false;       // --minimap
+    bool debugDraw = false;     // --debug-draw
+    bool hud = false;           // --hud
+    bool ui = false;            // --ui
+    bool shapes = false;        // --shapes
+    bool profilerWindow = false; // --profiler-window
+    std::string fontPath;       // --font=FILE.hex; empty: the built-in SDF font
+    logging::Level logLevel = logging::Level::Info; // --log=LEVEL
+    float renderScale = 1.0f;   // --render-scale=F
+    int msaa = 1;               // --msaa=N
+    bool overdraw = false;      // --overdraw[=rasterized|shaded]
+    OverdrawMeter::Count overdrawCount = OverdrawMeter::Count::Rasterized;
+    std::uint32_t post = 0;     // --post[=bloom,grade,vignette]: PostProcessChain effects
+    double dynamicResolutionMs = 0.0; // --dynamic-resolution[=MS]; 0: fixed scale
+    bool qualityGovernor = false;       // --quality-governor
+    bool capture = false;       // --capture[=png|raw]
+    FrameCapture::Settings captureSettings; // --capture-dir, --capture-every, --capture-frames
+    int offlineFrames = -1;     // --offline[=FRAMES]; < 0: off, 0: to the end of the replay
+};
+
+// Every option in argv into `options`; false, with the reason on stderr, at the first
+// one it doesn't know. --config is skipped: configPath() reads it first.
+bool parseOptions(int argc, char** argv, Options& options);
+// --config=FILE, or the default.
+std::string configPath(int argc, char** argv);
@@ -0,0 +1,109 @@
+#include "game/sprites.h"
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+
+#include "render/sprite_batch.h"
+
+void defineSpriteClips(AnimationClipTable& clips) {
+    for (std::uint32_t c = 0; c < kSpriteClips; ++c) {
+        AnimationClip clip;
+        clip.firstLayer = 1 + 3 * c;
+        clip.frames = 3;
+        clip.fps = 3.0f + static_cast<float>(c);
+        clips.add(clip);
+    }
+}
+
+// Image `id` at size x size texels into `pixels`.
+void paintSprite(std::uint32_t id, int size, std::vector<std::uint32_t>& pixels) {
+    if (id == 0) {
+        pixels.assign(static_cast<std::size_t>(size) * size, 0xffffffffu);
+        return;
+    }
+    const std::uint32_t shape = id - 1;
+    pixels.assign(static_cast<std::size_t>(size) * size, 0u);
+    const float half = 0.5f * static_cast<float>(size);
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            const float dx = (static_cast<float>(x) + 0.5f - half) / half; // -1..1
+            const float dy = (static_cast<float>(y) + 0.5f - half) / half;
+            const float radius = std::sqrt(dx * dx + dy * dy);
+            bool inside = false;
+            switch (shape % 3) {
+                case 0: inside = radius <= 1.0f; break;                        // disc
+                case 1: inside = radius <= 1.0f && radius >= 0.55f; break;     // ring
+                default: inside = std::fabs(dx) + std::fabs(dy) <= 1.0f; break; // diamond
+            }
+            // Fades a little towards the edge so the shapes read as sprites, not squares.
+            const float shade = 1.0f - 0.35f * std::min(radius, 1.0f);
+            if (inside) {
+                pixels[static_cast<std::size_t>(y) * size + x] = packColor(glm::vec4(shade, shade, shade, 1.0f));
+            }
+        }
+    }
+}
+
+void buildSpriteAtlas(TextureAtlas& atlas) {
+    std::vector<std::uint32_t> pixels;
+    paintSprite(0, 8, pixels);
+    atlas.add(8, 8, pixels.data());
+    for (std::uint32_t id = 1; id <= kSpriteShapes; ++id) {
+        const int size = 12 + static_cast<int>((id - 1) * 7 % 53);   // 12..64 texels
+        paintSprite(id, size, pixels);
+        atlas.add(size, size, pixels.data());
+    }
+}
+
+// Every sprite at kSpriteArraySize², one after the other: the array's layers (CPU only).
+std::vector<std::uint32_t> paintSpriteLayers() {
+    const std::size_t texels = static_cast<std::size_t>(kSpriteArraySize) * kSpriteArraySize;
+    std::vector<std::uint32_t> layers;
+    layers.reserve(texels * (kSpriteShapes + 1));
+    std::vector<std::uint32_t> pixels;
+    for (std::uint32_t id = 0; id <= kSpriteShapes; ++id) {
+        paintSprite(id, kSpriteArraySize, pixels);
+        layers.insert(layers.end(), pixels.begin(), pixels.end());
+    }
+    return layers;
+}
+
+// layers: paintSpriteLayers(); painted here if empty.
+bool buildSpriteArray(TextureArray& array, std::vector<std::uint32_t> layers) {
+    if (!array.init(kSpriteArraySize, kSpriteArraySize, static_cast<int>(kSpriteShapes + 1))) {
+        return false;
+    }
+    if (layers.empty()) {
+        layers = paintSpriteLayers();
+    }
+    const std::size_t texels = static_cast<std::size_t>(kSpriteArraySize) * kSpriteArraySize;
+    for (std::uint32_t id = 0; id <= kSpriteShapes; ++id) {
+        array.setLayer(static_cast<int>(id), layers.data() + id * texels);
+    }
+    array.finish();
+    return true;
+}
+
+// What each image looks like from afar (its coverage and average colour), and from what
+// size on screen each type is drawn flat: the config's [lod] section.
+void describeSpriteLod(SpriteLod& lod) {
+    std::vector<std::uint32_t> pixels;
+    for (std::uint32_t id = 0; id <= kSpriteShapes; ++id) {
+        paintSprite(id, 16, pixels);
+        lod.describe(id, pixels.data(), 16, 16);
+    }
+}
+
+// scale: the quality governor's (render/quality_governor.h), on every size.
+void configureSpriteLod(SpriteLod& lod, const AnimationClipTable& clips, const GameConfig& config, float scale) {
+    lod.setFlatPx(0, config.lodSquarePx * scale);
+    const float shapes[3] = {config.lodDiscPx, config.lodRingPx, config.lodDiamondPx};  // paintSprite's order
+    for (std::uint32_t id = 1; id <= kSpriteShapes; ++id) {
+        lod.setFlatPx(id, shapes[(id - 1) % 3] * scale);
+    }
+    for (std::uint32_t c = 0; c < clips.size(); ++c) {
+        lod.setClip(c, clips.clip(c).firstLayer);
+    }
+    lod.setClustering(config.lodClusterPx * scale, config.lodClusterMin);
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "game/game_config.h"
+#include "render/sprite_animation.h"
+#include "render/sprite_lod.h"
+#include "render/texture_array.h"
+#include "render/texture_atlas.h"
+
+// Sprite images
+// -------------
+// There are no image files yet, so the atlas is filled with generated shapes: id 0 is a
+// solid white square (the player: its Color alone decides how it looks), ids
+// 1..kSpriteShapes are discs, rings and diamonds. Wanderers cycle through those.
+//
+// The same ids are used twice: as TextureAtlas images of assorted sizes (sprite batch
+// path; one draw because every image lives on the same page) and as layers of a
+// kSpriteArraySize² TextureArray (texture array path; one draw, mipmapped).
+constexpr std::uint32_t kSpriteShapes = 96;
+constexpr int kSpriteArraySize = 64;
+
+// Draw order on the texture array path (ZLayer; shaders/vertex.glsl DEPTH_LAYERS): the
+// wanderers spread over a few layers, the player above them all. Every fourth wanderer
+// is tinted translucent, so both the depth-tested and the sorted draws are exercised.
+constexpr std::uint16_t kWandererZLayers = 8;
+constexpr std::uint16_t kPlayerZLayer = 0xffff;
+
+// --sprite-animation: clips over the same images. Consecutive ids go disc, ring, diamond,
+// so clip c plays ids 1 + 3c .. 3 + 3c, each clip a little faster than the one before.
+constexpr std::uint32_t kSpriteClips = 8;
+
+// kSpriteClips clips into `clips`.
+void defineSpriteClips(AnimationClipTable& clips);
+
+// Image `id` at size x size texels into `pixels`.
+void paintSprite(std::uint32_t id, int size, std::vector<std::uint32_t>& pixels);
+
+// Every image into `atlas`, at assorted sizes.
+void buildSpriteAtlas(TextureAtlas& atlas);
+
+// Every sprite at kSpriteArraySize², one after the other: the array's layers (CPU only).
+std::vector<std::uint32_t> paintSpriteLayers();
+
+// layers: paintSpriteLayers(); painted here if empty.
+bool buildSpriteArray(TextureArray& array, std::vector<std::uint32_t> layers);
+
+// What each image looks like from afar (its coverage and average colour), and from what
+// size on screen each type is drawn flat: the config's [lod] section.
+void describeSpriteLod(SpriteLod& lod);
+
+// scale: the quality governor's (render/quality_governor.h), on every size.
+void configureSpriteLod(SpriteLod& lod, const AnimationClipTable& clips, const GameConfig& config,
+                        float scale = 1.0f);
@@ -0,0 +1,301 @@
+#include "game/tile_maps.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+#include "asset/image.h"
+#include "core/clock.h"
+#include "core/log.h"
+#include "game/sprites.h"
+#include "render/camera_ubo.h"
+#include "render/context_pool.h"
+#include "render/culling.h"
+#include "render/gl_resource.h"
+#include "render/gl_state.h"
+#include "render/multi_draw.h"
+#include "render/shader_layout.h"
+#include "render/sprite_batch.h"
+#include "render/virtual_texture.h"
+
+namespace {
+
+float backgroundNoise(int x, int y) {
+    std::uint32_t h = static_cast<std::uint32_t>(x) * 374761393u + static_cast<std::uint32_t>(y) * 668265263u;
+    h = (h ^ (h >> 13)) * 1274126177u;
+    return static_cast<float>((h ^ (h >> 16)) & 0xffffu) / 65535.0f;
+}
+
+// --thumbnails: one ContextPool context's state, made by its first job and destroyed by
+// the pool's teardown, both in that context. The target is a framebuffer of its own (not
+// shared between contexts); the color texture is sized for the largest thumbnail.
+struct ThumbnailWorker {
+    bool ready = false;
+    VertexArrayCache vaos;
+    MultiDraw draws;
+    CameraUniformBuffer camera;
+    GlTexture color;
+    GLuint framebuffer = 0;
+
+    bool init(int size) {
+        draws.init();
+        camera.init(1);
+        color = GlTexture::create();
+        glstate::activeTexture(GL_TEXTURE0);
+        glstate::bindTexture(GL_TEXTURE_2D, color.get());
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glGenFramebuffers(1, &framebuffer);
+        glstate::bindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, color.get(), 0);
+        ready = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        return ready;
+    }
+    void shutdown() {
+        glstate::deleteFramebuffer(framebuffer);
+        color.reset();
+        camera.shutdown();
+        draws.shutdown();
+        vaos.shutdown();
+        ready = false;
+    }
+};
+
+// --thumbnails: a level's tiles, the whole map fitted into `size` pixels on its longer
+// side, as DIR/NAME.png, on a pool thread. The map is laid out in tile units (origin 0,
+// tile size 1: the uTileGrid main set on the shared program before the pool started), so
+// every worker draws with the same program state.
+bool renderLevelThumbnail(const std::string& path, const std::string& outPath, int size, GLuint program,
+                          const TextureArray& array, Tilemap::Mode mode, const glm::vec4& clear,
+                          ThumbnailWorker& worker) {
+    LevelFile level;
+    if (!level.open(path) || level.header().tilesPerRegion == 0) {
+        return false;
+    }
+    Tilemap tilemap;
+    Tilemap::Options options;
+    options.mode = mode;
+    options.width = level.tilesX();
+    options.height = level.tilesY();
+    options.layers = std::min<int>(level.header().tileLayers, Tilemap::kMaxLayers);
+    options.tileSize = 1.0f;
+    if (!tilemap.init(options, worker.vaos)) {
+        return false;
+    }
+    const std::vector<std::uint32_t> sprites = resolveLevelSprites(level);
+    std::vector<TileEdit> edits;
+    for (std::size_t region = 0; region < level.regionCount(); ++region) {
+        edits.clear();
+        levelRegionTiles(level, static_cast<int>(region), sprites, false, edits);
+        tilemap.apply(edits.data(), edits.size());
+    }
+    tilemap.update(static_cast<std::uint32_t>(array.layers()));
+
+    const float tilesX = static_cast<float>(options.width), tilesY = static_cast<float>(options.height);
+    const float scale = static_cast<float>(size) / std::max(tilesX, tilesY);
+    Image image;
+    image.width = std::max(1, static_cast<int>(tilesX * scale + 0.5f));
+    image.height = std::max(1, static_cast<int>(tilesY * scale + 0.5f));
+    worker.camera.upload(glm::mat4(1.0f), glm::ortho(0.0f, tilesX, 0.0f, tilesY, -1.0f, 1.0f));
+    worker.camera.bindView(0);
+    glstate::bindFramebuffer(GL_FRAMEBUFFER, worker.framebuffer);
+    glstate::viewport(0, 0, image.width, image.height);
+    glstate::disable(GL_DEPTH_TEST);
+    glstate::disable(GL_CULL_FACE);
+    glstate::disable(GL_SCISSOR_TEST);
+    glClearColor(clear.r, clear.g, clear.b, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glstate::enable(GL_BLEND);
+    glstate::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glstate::useProgram(program);
+    glstate::activeTexture(GL_TEXTURE0);
+    glstate::bindTexture(GL_TEXTURE_2D_ARRAY, array.texture());
+    tilemap.draw(CullRect{glm::vec2(0.0f), glm::vec2(tilesX, tilesY)}, worker.draws);
+    worker.draws.flush();
+    worker.draws.endFrame();
+
+    // Synchronous: the other contexts keep the GPU busy meanwhile.
+    image.pixels.resize(static_cast<std::size_t>(image.width) * static_cast<std::size_t>(image.height));
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glstate::bindFramebuffer(GL_READ_FRAMEBUFFER, worker.framebuffer);
+    glReadPixels(0, 0, image.width, image.height, GL_RGBA, GL_UNSIGNED_BYTE, image.pixels.data());
+    tilemap.shutdown();
+
+    std::vector<unsigned char> png;
+    encodePng(image, png);
+    std::FILE* file = std::fopen(outPath.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    const bool written = std::fwrite(png.data(), 1, png.size(), file) == png.size();
+    return std::fclose(file) == 0 && written;
+}
+
+} // namespace
+
+// The generated map's tile at (x, y) of `layer` (0 or 1), or Tilemap::kEmpty.
+std::uint16_t generatedTile(int layer, int x, int y) {
+    if (layer == 0) {
+        return ((x + y) & 1) ? 2 : 3;
+    }
+    const std::uint32_t hash = (static_cast<std::uint32_t>(x) * 73856093u) ^
+                               (static_cast<std::uint32_t>(y) * 19349663u);
+    return (hash >> 4) % 16 == 0 ? static_cast<std::uint16_t>(1 + 3 * (hash % 32)) : Tilemap::kEmpty;
+}
+
+bool buildTilemap(Tilemap& tilemap, Tilemap::Mode mode, VertexArrayCache& vaos, int width, int height) {
+    Tilemap::Options options;
+    options.mode = mode;
+    options.width = width;
+    options.height = height;
+    options.layers = 2;
+    options.origin = -0.5f * options.tileSize * glm::vec2(static_cast<float>(width), static_cast<float>(height));
+    if (!tilemap.init(options, vaos)) {
+        return false;
+    }
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            tilemap.setTile(0, x, y, generatedTile(0, x, y));
+            tilemap.setTile(1, x, y, generatedTile(1, x, y));
+        }
+    }
+    return true;
+}
+
+void paintBackgroundPage(int pages, int level, int x0, int y0, std::uint32_t* texels) {
+    const int size = VirtualTexture::kSlotSize;
+    const int levelTexels = pages * VirtualTexture::kPageSize >> level;
+    const int finest = 2 << level;                  // level 0 texels per two of this level's
+    for (int ty = 0; ty < size; ++ty) {
+        for (int tx = 0; tx < size; ++tx) {
+            // Level 0 texel coordinates of this texel's centre (clamped at the image's edge).
+            const float u = (static_cast<float>(std::clamp(x0 + tx, 0, levelTexels - 1)) + 0.5f) *
+                            static_cast<float>(1 << level);
+            const float v = (static_cast<float>(std::clamp(y0 + ty, 0, levelTexels - 1)) + 0.5f) *
+                            static_cast<float>(1 << level);
+            float height = 0.0f, weight = 0.0f, amplitude = 1.0f;
+            for (int period = 8192; period >= finest && period >= 4; period /= 2, amplitude *= 0.55f) {
+                const float fx = u / static_cast<float>(period), fy = v / static_cast<float>(period);
+                const int ix = static_cast<int>(fx), iy = static_cast<int>(fy);
+                const float sx = fx - static_cast<float>(ix), sy = fy - static_cast<float>(iy);
+                // Offset by the period: each octave its own lattice values.
+                const float a = backgroundNoise(ix + period, iy), b = backgroundNoise(ix + 1 + period, iy);
+                const float c = backgroundNoise(ix + period, iy + 1), d = backgroundNoise(ix + 1 + period, iy + 1);
+                const float wx = sx * sx * (3.0f - 2.0f * sx), wy = sy * sy * (3.0f - 2.0f * sy);
+                const float bottom = a + (b - a) * wx, top = c + (d - c) * wx;
+                height += amplitude * (bottom + (top - bottom) * wy);
+                weight += amplitude;
+            }
+            height = weight > 0.0f ? height / weight : 0.5f;
+            glm::vec3 color = height < 0.45f   ? glm::vec3(0.10f, 0.22f, 0.45f) * (0.6f + height)
+                              : height < 0.48f ? glm::vec3(0.76f, 0.70f, 0.50f)
+                              : height < 0.62f ? glm::vec3(0.20f, 0.50f, 0.18f) * (1.4f - height)
+                              : height < 0.72f ? glm::vec3(0.45f, 0.40f, 0.35f)
+                                               : glm::vec3(0.92f, 0.92f, 0.95f);
+            texels[static_cast<std::size_t>(ty) * size + tx] = packColor(glm::vec4(color, 1.0f));
+        }
+    }
+}
+
+bool buildLevelTilemap(Tilemap& tilemap, Tilemap::Mode mode, VertexArrayCache& vaos, const LevelFile& level) {
+    const LevelHeader& header = level.header();
+    Tilemap::Options options;
+    options.mode = mode;
+    options.width = level.tilesX();
+    options.height = level.tilesY();
+    options.layers = std::min<int>(header.tileLayers, Tilemap::kMaxLayers);
+    options.tileSize = header.regionSize / header.tilesPerRegion;
+    options.origin = glm::vec2(header.originX, header.originY);
+    return tilemap.init(options, vaos);
+}
+
+std::vector<std::uint32_t> resolveLevelSprites(const LevelFile& level) {
+    std::vector<std::uint32_t> sprites(level.assetCount(), 0u);
+    for (std::size_t a = 0; a < sprites.size(); ++a) {
+        const std::string name = level.assetName(a);
+        const unsigned long id = name.rfind("shape/", 0) == 0 ? std::strtoul(name.c_str() + 6, nullptr, 10) : 0;
+        if (id >= 1 && id <= kSpriteShapes) {
+            sprites[a] = static_cast<std::uint32_t>(id);
+        } else {
+            logging::warn("Level: unknown asset '%s', drawn as sprite 0", name.c_str());
+        }
+    }
+    return sprites;
+}
+
+// A region's tiles as edits for the render side's tilemap: its sprites, or (clear) empty.
+void levelRegionTiles(const LevelFile& level, int region, const std::vector<std::uint32_t>& sprites, bool clear,
+                      std::vector<TileEdit>& edits) {
+    const int tiles = level.header().tilesPerRegion;
+    const int layers = std::min<int>(level.header().tileLayers, Tilemap::kMaxLayers);
+    const int x0 = region % level.regionsX() * tiles;
+    const int y0 = region / level.regionsX() * tiles;
+    for (int layer = 0; layer < layers; ++layer) {
+        const std::uint16_t* values = level.tiles(region, layer);
+        for (int i = 0; i < tiles * tiles; ++i) {
+            if (values[i] == 0) {
+                continue;
+            }
+            TileEdit edit;
+            edit.x = x0 + i % tiles;
+            edit.y = y0 + i / tiles;
+            edit.layer = static_cast<std::uint16_t>(layer);
+            edit.tile = clear || values[i] > sprites.size() ? Tilemap::kEmpty
+                                                             : static_cast<std::uint16_t>(sprites[values[i] - 1u]);
+            edits.push_back(edit);
+        }
+    }
+}
+
+void renderThumbnails(const Options& options, GLFWwindow* window, GLuint program, const TextureArray& array,
+                      const glm::vec4& clear) {
+    std::error_code ec;
+    std::filesystem::create_directories(options.thumbnailDir, ec);
+    if (ec) {
+        std::cerr << "Thumbnails: can't create " << options.thumbnailDir << ": " << ec.message() << "\n";
+        return;
+    }
+    // Shared program state, the same for every job: tile units (see renderLevelThumbnail).
+    glstate::useProgram(program);
+    const GLint grid = glGetUniformLocation(program, shaderlayout::vertex::uTileGrid.name);
+    if (grid >= 0) {
+        glUniform3f(grid, 0.0f, 0.0f, 1.0f);
+    }
+    glFinish();                        // the atlas and programs are complete before others use them
+
+    const double start = monoclock::seconds();
+    ContextPool pool;
+    const int contexts = std::min<int>(options.thumbnailContexts, static_cast<int>(options.thumbnails.size()));
+    if (pool.start(window, contexts) == 0) {
+        std::cerr << "Thumbnails: no shared context\n";
+        return;
+    }
+    std::vector<ThumbnailWorker> workers(static_cast<std::size_t>(pool.size()));
+    std::atomic<int> written{0};
+    const int size = options.thumbnailSize;
+    for (const std::string& path : options.thumbnails) {
+        const std::string outPath =
+            options.thumbnailDir + "/" + std::filesystem::path(path).stem().string() + ".png";
+        pool.submit([&, path, outPath](int w) {
+            ThumbnailWorker& worker = workers[static_cast<std::size_t>(w)];
+            if (!worker.ready && !worker.init(size)) {
+                logging::warn("Thumbnails: no render target on context %d", w);
+                return;
+            }
+            if (renderLevelThumbnail(path, outPath, size, program, array, options.tilemapMode, clear, worker)) {
+                written.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                logging::warn("Thumbnails: %s failed", path.c_str());
+            }
+        });
+    }
+    pool.stop([&workers](int w) { workers[static_cast<std::size_t>(w)].shutdown(); });
+    glstate::invalidate();             // the pool deleted names this thread's cache may hold
+    std::cout << "Thumbnails: " << written.load() << " of " << options.thumbnails.size() << " levels to "
+              << options.thumbnailDir << "/ on " << contexts << " contexts in "
+              << (monoclock::seconds() - start) * 1000.0 << " ms\n";
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+#include "core/level_file.h"
+#include "game/options.h"
+#include "render/texture_array.h"
+#include "render/tilemap.h"
+#include "render/vertex_array_cache.h"
+
+// --tilemap: kTilemapSize² tiles centred on the origin (--bench-scene=tilemap: its
+// --bench-tiles). Layer 0 is a checkerboard of rings and diamonds; on layer 1 about one
+// tile in 16 gets a disc (tile ids are sprite ids: the array layer they sample).
+constexpr int kTilemapSize = 128;
+constexpr std::uint16_t kTilePaint = 1;        // right click: a disc on layer 1
+
+// The generated map's tile at (x, y) of `layer` (0 or 1), or Tilemap::kEmpty.
+std::uint16_t generatedTile(int layer, int x, int y);
+
+bool buildTilemap(Tilemap& tilemap, Tilemap::Mode mode, VertexArrayCache& vaos, int width = kTilemapSize,
+                  int height = kTilemapSize);
+
+// --virtual-background[=PAGES]: a PAGES² page terrain image (128² texels a page: 64K²
+// by default, 16 GB as RGBA8) under everything, paged in by a VirtualTexture. Its pages
+// are painted on the loader thread from value noise, the octaves finer than two of the
+// level's texels left out, so every level is the filtered version of the one below.
+constexpr float kBackgroundPageWorldSize = 0.05f;
+
+// The VirtualTexture::kSlotSize² texels from (x0, y0) of mip `level` into `texels`.
+void paintBackgroundPage(int pages, int level, int x0, int y0, std::uint32_t* texels);
+
+// --level=FILE: a level file (core/level_file.h) streamed in around the camera. Its tile
+// layers become the tilemap, empty until their regions arrive; its "shape/K" assets are
+// the sprite ids buildSpriteAtlas generates (anything else draws as sprite 0).
+bool buildLevelTilemap(Tilemap& tilemap, Tilemap::Mode mode, VertexArrayCache& vaos, const LevelFile& level);
+
+// Each of the level's assets as a sprite id.
+std::vector<std::uint32_t> resolveLevelSprites(const LevelFile& level);
+
+// A region's tiles as edits for the render side's tilemap: its sprites, or (clear) empty.
+void levelRegionTiles(const LevelFile& level, int region, const std::vector<std::uint32_t>& sprites, bool clear,
+                      std::vector<TileEdit>& edits);
+
+// --thumbnails: every level as a job on a ContextPool. Runs on the main thread with the
+// game's context current, before the render thread starts.
+void renderThumbnails(const Options& options, GLFWwindow* window, GLuint program, const TextureArray& array,
+                      const glm::vec4& clear);
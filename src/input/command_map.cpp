@@ -0,0 +1,118 @@
+#include "input/command_map.h"
+
+#include <cctype>
+
+#include "input/key_names.h"
+
+namespace {
+
+struct NamedMod {
+    const char* name;
+    int mod;
+};
+
+const NamedMod kMods[] = {
+    {"shift", GLFW_MOD_SHIFT}, {"ctrl", GLFW_MOD_CONTROL}, {"control", GLFW_MOD_CONTROL},
+    {"alt", GLFW_MOD_ALT},     {"super", GLFW_MOD_SUPER},
+};
+
+std::string lower(const std::string& text) {
+    std::string out = text;
+    for (char& c : out) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return out;
+}
+
+} // namespace
+
+bool parseKeyChord(const std::string& text, KeyChord& out) {
+    KeyChord chord;
+    std::size_t at = 0;
+    // Every part but the last is a modifier ("Ctrl+Shift+S"; "Shift+Equal", not "+").
+    for (std::size_t plus = text.find('+'); plus != std::string::npos; plus = text.find('+', at)) {
+        const std::string part = lower(text.substr(at, plus - at));
+        int mod = 0;
+        for (const NamedMod& m : kMods) {
+            if (part == m.name) {
+                mod = m.mod;
+            }
+        }
+        if (mod == 0) {
+            return false;
+        }
+        chord.mods |= mod;
+        at = plus + 1;
+    }
+    chord.key = keynames::fromName(text.substr(at));
+    if (chord.key < 0) {
+        return false;
+    }
+    out = chord;
+    return true;
+}
+
+void CommandMap::define(CommandId command, Handler handler, Trigger trigger) {
+    if (command >= kMaxCommands) {
+        return;
+    }
+    handlers_[command] = handler;
+    triggers_[command] = trigger;
+}
+
+void CommandMap::bind(KeyChord chord, CommandId command) {
+    if (!valid(chord.key) || command >= kMaxCommands) {
+        return;
+    }
+    chord.mods &= kModMask;
+    bindings_.push_back(Binding{chord, command});
+}
+
+void CommandMap::compile() {
+    table_.fill(0);
+    // Bare keys first, over every modifier combination; then the chords with modifiers,
+    // each over its own combination only, so "Ctrl+R" beats "R" with Ctrl held.
+    for (const Binding& b : bindings_) {
+        if (b.chord.mods == 0) {
+            for (int mods = 0; mods < kModCombos; ++mods) {
+                table_[static_cast<std::size_t>(b.chord.key * kModCombos + mods)] =
+                    static_cast<std::uint8_t>(b.command + 1);
+            }
+        }
+    }
+    for (const Binding& b : bindings_) {
+        if (b.chord.mods != 0) {
+            table_[static_cast<std::size_t>(b.chord.key * kModCombos + b.chord.mods)] =
+                static_cast<std::uint8_t>(b.command + 1);
+        }
+    }
+}
+
+int CommandMap::lookup(int key, int mods) const {
+    if (!valid(key)) {
+        return -1;
+    }
+    return table_[static_cast<std::size_t>(key * kModCombos + (mods & kModMask))] - 1;
+}
+
+bool CommandMap::dispatch(int key, int action, int mods) {
+    if (!valid(key) || action == GLFW_REPEAT) {
+        return false;
+    }
+    if (action == GLFW_RELEASE) {
+        const int held = held_[static_cast<std::size_t>(key)] - 1;
+        held_[static_cast<std::size_t>(key)] = 0;
+        if (held < 0 || triggers_[static_cast<std::size_t>(held)] != Trigger::PressRelease) {
+            return false;
+        }
+        handlers_[static_cast<std::size_t>(held)](false);
+        return true;
+    }
+    const int command = lookup(key, mods);
+    if (command < 0 || !handlers_[static_cast<std::size_t>(command)]) {
+        return false;
+    }
+    held_[static_cast<std::size_t>(key)] = static_cast<std::uint8_t>(command + 1);
+    handlers_[static_cast<std::size_t>(command)](true);
+    return true;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <GLFW/glfw3.h>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// CommandId
+// ---------
+// One-shot COMMANDS ("pause", "quick save"), as opposed to held actions (ActionId,
+// input/input_state.h): something that happens when a key goes down, not a state read
+// every step. The game defines its own enum of command ids (0..kMaxCommands-1).
+using CommandId = std::uint8_t;
+constexpr int kMaxCommands = 32;
+
+// A key and the modifiers held with it (GLFW_MOD_SHIFT | GLFW_MOD_CONTROL | ...), written
+// "Ctrl+Shift+S" in a config file: modifier names Shift, Ctrl (Control), Alt, Super, then
+// a key name (input/key_names.h). mods 0: the key whatever modifiers are held, unless a
+// chord of the same key with those modifiers is bound too.
+struct KeyChord {
+    int key = -1;
+    int mods = 0;
+
+    bool operator==(const KeyChord& o) const { return key == o.key && mods == o.mods; }
+    bool operator!=(const KeyChord& o) const { return !(*this == o); }
+};
+
+// false for text that isn't a chord; case doesn't matter.
+bool parseKeyChord(const std::string& text, KeyChord& out);
+
+// CommandMap
+// ----------
+// The key callback's commands, from a table instead of an if/else chain per key:
+//
+// | Data                       | Size            | Meaning                                  |
+// | -------------------------- | --------------- | ---------------------------------------- |
+// | bindings_                  | per chord       | what config / rebinding said, as given   |
+// | table_[key * 16 + mods]    | 349 x 16 bytes  | command + 1 (0: none), every modifier    |
+// |                            |                 | combination resolved by compile()        |
+// | handlers_[c], triggers_[c] | per command     | what it calls, on press or press+release |
+// | held_[key]                 | 349 bytes       | the command a key's press ran, for its   |
+// |                            |                 | release (the modifiers may be up by then)|
+//
+// dispatch() is one index and one call through the handler table whatever the number of
+// bindings; CapsLock / NumLock (GLFW_MOD_CAPS_LOCK, GLFW_MOD_NUM_LOCK) are masked off.
+// Repeats never dispatch. Rebinding (bind / clearBindings, then compile) is cheap enough
+// for a config reload: nothing is recompiled but the table. Of two bindings of the same
+// chord the later wins. Main thread only.
+class CommandMap {
+public:
+    static constexpr int kKeyCount = GLFW_KEY_LAST + 1;
+    static constexpr int kModMask = GLFW_MOD_SHIFT | GLFW_MOD_CONTROL | GLFW_MOD_ALT | GLFW_MOD_SUPER;
+    static constexpr int kModCombos = kModMask + 1;
+
+    enum class Trigger : std::uint8_t { Press, PressRelease };
+    // pressed: false only for a Trigger::PressRelease command's key coming back up.
+    using Handler = void (*)(bool pressed);
+
+    // The game's commands, once at startup.
+    void define(CommandId command, Handler handler, Trigger trigger = Trigger::Press);
+
+    // Startup or rebinding; the table follows at compile().
+    void bind(KeyChord chord, CommandId command);
+    void clearBindings() { bindings_.clear(); }
+    void compile();
+
+    // The key callback's event: true if a command ran.
+    bool dispatch(int key, int action, int mods);
+    // The command the chord runs, or -1.
+    int lookup(int key, int mods) const;
+
+private:
+    static bool valid(int key) { return key >= 0 && key < kKeyCount; }
+
+    struct Binding {
+        KeyChord chord;
+        CommandId command;
+    };
+    std::vector<Binding> bindings_;
+    std::array<std::uint8_t, kKeyCount * kModCombos> table_{};
+    std::array<Handler, kMaxCommands> handlers_{};
+    std::array<Trigger, kMaxCommands> triggers_{};
+    std::array<std::uint8_t, kKeyCount> held_{};   // command + 1 of a held key; 0: none
+};
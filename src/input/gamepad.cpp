@@ -0,0 +1,153 @@
+#include "input/gamepad.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+constexpr int kLanes = Gamepads::kMaxPads * 2;   // sticks (or triggers) over all pads
+
+float curved(float v, float curve) {
+    return v * (1.0f - curve) + v * v * v * curve;
+}
+
+} // namespace
+
+void Gamepads::bindButton(int button, ActionId action) {
+    if (button >= 0 && button < kButtons && action < kMaxActions) {
+        buttonActions_[static_cast<std::size_t>(button)] |= ActionMask(1) << action;
+    }
+}
+
+void Gamepads::bindAxis(int axis, bool positive, ActionId action) {
+    if (axis >= 0 && axis < kAxes && action < kMaxActions) {
+        axisActions_[static_cast<std::size_t>(axis * 2 + (positive ? 1 : 0))] |= ActionMask(1) << action;
+    }
+}
+
+void Gamepads::clearBindings() {
+    buttonActions_.fill(0);
+    axisActions_.fill(0);
+}
+
+void Gamepads::poll(double now) {
+    ++stats_.polls;
+    stats_.connected = 0;
+    std::uint32_t buttons[kMaxPads] = {};
+    for (int p = 0; p < kMaxPads; ++p) {
+        GLFWgamepadstate state;
+        const bool connected = glfwJoystickIsGamepad(GLFW_JOYSTICK_1 + p) &&
+                               glfwGetGamepadState(GLFW_JOYSTICK_1 + p, &state);
+        pads_[p].connected = connected;
+        if (!connected) {
+            stickX_[p] = stickY_[p] = stickX_[kMaxPads + p] = stickY_[kMaxPads + p] = 0.0f;
+            triggers_[p] = triggers_[kMaxPads + p] = -1.0f;     // released
+            continue;
+        }
+        ++stats_.connected;
+        for (int b = 0; b < kButtons; ++b) {
+            buttons[p] |= static_cast<std::uint32_t>(state.buttons[b] == GLFW_PRESS) << b;
+        }
+        stickX_[p] = state.axes[GLFW_GAMEPAD_AXIS_LEFT_X];
+        stickY_[p] = state.axes[GLFW_GAMEPAD_AXIS_LEFT_Y];
+        stickX_[kMaxPads + p] = state.axes[GLFW_GAMEPAD_AXIS_RIGHT_X];
+        stickY_[kMaxPads + p] = state.axes[GLFW_GAMEPAD_AXIS_RIGHT_Y];
+        triggers_[p] = state.axes[GLFW_GAMEPAD_AXIS_LEFT_TRIGGER];
+        triggers_[kMaxPads + p] = state.axes[GLFW_GAMEPAD_AXIS_RIGHT_TRIGGER];
+    }
+    process();
+
+    ActionMask actions = 0;
+    analog_.fill(0.0f);
+    bool buttonsChanged = false;
+    for (int p = 0; p < kMaxPads; ++p) {
+        Pad& pad = pads_[p];
+        buttonsChanged |= pad.buttons != buttons[p];
+        pad.buttons = buttons[p];
+        pad.axes[GLFW_GAMEPAD_AXIS_LEFT_X] = stickX_[p];
+        pad.axes[GLFW_GAMEPAD_AXIS_LEFT_Y] = stickY_[p];
+        pad.axes[GLFW_GAMEPAD_AXIS_RIGHT_X] = stickX_[kMaxPads + p];
+        pad.axes[GLFW_GAMEPAD_AXIS_RIGHT_Y] = stickY_[kMaxPads + p];
+        pad.axes[GLFW_GAMEPAD_AXIS_LEFT_TRIGGER] = triggers_[p];
+        pad.axes[GLFW_GAMEPAD_AXIS_RIGHT_TRIGGER] = triggers_[kMaxPads + p];
+        if (!pad.connected) {
+            continue;
+        }
+        std::uint32_t held = pad.buttons;
+        while (held) {
+            const int b = __builtin_ctz(held);
+            held &= held - 1;
+            ActionMask mask = buttonActions_[static_cast<std::size_t>(b)];
+            actions |= mask;
+            while (mask) {
+                analog_[static_cast<std::size_t>(__builtin_ctzll(mask))] = 1.0f;
+                mask &= mask - 1;
+            }
+        }
+        for (int a = 0; a < kAxes; ++a) {
+            const float v = pad.axes[a];
+            ActionMask mask = axisActions_[static_cast<std::size_t>(a * 2 + (v > 0.0f ? 1 : 0))];
+            const float magnitude = std::fabs(v);
+            if (magnitude <= 0.0f || mask == 0) {
+                continue;
+            }
+            if (magnitude >= settings_.threshold) {
+                actions |= mask;
+            }
+            while (mask) {
+                float& out = analog_[static_cast<std::size_t>(__builtin_ctzll(mask))];
+                out = std::max(out, magnitude);
+                mask &= mask - 1;
+            }
+        }
+    }
+    if (actions != actions_ || buttonsChanged) {
+        changedAt_ = now;
+        ++stats_.changes;
+    }
+    actions_ = actions;
+}
+
+// Dead zones and the curve, in place on the gathered lanes.
+void Gamepads::process() {
+    const float stickZone = std::clamp(settings_.stickDeadZone, 0.0f, 0.99f);
+    const float triggerZone = std::clamp(settings_.triggerDeadZone, 0.0f, 0.99f);
+    const float curve = std::clamp(settings_.curve, 0.0f, 1.0f);
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f), half = _mm_set1_ps(0.5f);
+    const __m128 zone = _mm_set1_ps(stickZone), stickScale = _mm_set1_ps(1.0f / (1.0f - stickZone));
+    const __m128 tZone = _mm_set1_ps(triggerZone), triggerScale = _mm_set1_ps(1.0f / (1.0f - triggerZone));
+    const __m128 linear = _mm_set1_ps(1.0f - curve), cubic = _mm_set1_ps(curve);
+    const __m128 tiny = _mm_set1_ps(1e-12f);
+    for (; i + 4 <= kLanes; i += 4) {
+        // Sticks: magnitude past the zone, rescaled and curved, along the same direction.
+        const __m128 x = _mm_load_ps(&stickX_[i]);
+        const __m128 y = _mm_load_ps(&stickY_[i]);
+        const __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)));
+        __m128 v = _mm_min_ps(_mm_mul_ps(_mm_max_ps(_mm_sub_ps(length, zone), zero), stickScale), one);
+        v = _mm_add_ps(_mm_mul_ps(v, linear), _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(v, v), v), cubic));
+        const __m128 scale = _mm_div_ps(v, _mm_max_ps(length, tiny));
+        _mm_store_ps(&stickX_[i], _mm_mul_ps(x, scale));
+        _mm_store_ps(&stickY_[i], _mm_mul_ps(y, scale));
+        // Triggers: GLFW's -1 (released) .. 1 to 0..1, then the same.
+        const __m128 t = _mm_mul_ps(_mm_add_ps(_mm_load_ps(&triggers_[i]), one), half);
+        __m128 tv = _mm_min_ps(_mm_mul_ps(_mm_max_ps(_mm_sub_ps(t, tZone), zero), triggerScale), one);
+        tv = _mm_add_ps(_mm_mul_ps(tv, linear), _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(tv, tv), tv), cubic));
+        _mm_store_ps(&triggers_[i], tv);
+    }
+#endif
+    for (; i < kLanes; ++i) {
+        const float length = std::sqrt(stickX_[i] * stickX_[i] + stickY_[i] * stickY_[i]);
+        const float v = curved(std::min(std::max(length - stickZone, 0.0f) / (1.0f - stickZone), 1.0f), curve);
+        const float scale = v / std::max(length, 1e-12f);
+        stickX_[i] *= scale;
+        stickY_[i] *= scale;
+        const float t = (triggers_[i] + 1.0f) * 0.5f;
+        triggers_[i] = curved(std::min(std::max(t - triggerZone, 0.0f) / (1.0f - triggerZone), 1.0f), curve);
+    }
+}
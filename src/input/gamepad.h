@@ -0,0 +1,94 @@
+#pragma once
+
+#include <GLFW/glfw3.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "input/input_state.h"
+
+// Gamepads
+// --------
+// Every connected gamepad (GLFW's SDL-style mapping: glfwGetGamepadState), read once per
+// frame by poll() into the same actions the keys drive (input/input_state.h), so
+// gameplay never asks which device an action came from:
+//
+// | Step     | Work                                                                    |
+// | -------- | ----------------------------------------------------------------------- |
+// | gather   | one glfwGetGamepadState per joystick slot up to kMaxPads; the raw axes  |
+// |          | into SoA arrays: all sticks' x, all sticks' y, all triggers             |
+// | process  | every stick and trigger at once, 4 per SSE2 op: radial dead zone for    |
+// |          | sticks (the direction kept, the magnitude rescaled from the zone's edge |
+// |          | to 1), a linear one for triggers, then the response curve               |
+// | map      | bound buttons → 1, bound axis directions → their processed value; an    |
+// |          | action's analog value is its largest, and it is ACTIVE from threshold  |
+//
+// The curve blends linear and cubic, (1 - curve) v + curve v³: 0 is linear, 1 gives fine
+// control near the centre and full speed at the edge. Stick y is GLFW's: down is +1.
+//
+// A state changing shows in changedAt(): the time of the poll that first saw it (GLFW
+// has no per-event timestamps for pads, so that is the raw input time, at most a frame
+// late). Pads connect and disconnect by themselves: a slot without one reads as idle.
+class Gamepads {
+public:
+    static constexpr int kMaxPads = 4;
+    static constexpr int kButtons = GLFW_GAMEPAD_BUTTON_LAST + 1;
+    static constexpr int kAxes = GLFW_GAMEPAD_AXIS_LAST + 1;
+
+    struct Settings {
+        float stickDeadZone = 0.2f;    // of full deflection: below it a stick reads 0
+        float triggerDeadZone = 0.1f;
+        float curve = 0.5f;            // 0: linear .. 1: cubic
+        float threshold = 0.5f;        // processed value at which an axis action is active
+    };
+
+    struct Pad {
+        bool connected = false;
+        std::uint32_t buttons = 0;     // bit per GLFW_GAMEPAD_BUTTON_*
+        float axes[kAxes] = {};        // processed: sticks -1..1, triggers 0..1
+    };
+
+    struct Stats {
+        std::uint64_t polls = 0;
+        std::uint64_t changes = 0;     // polls whose actions or buttons differed
+        int connected = 0;             // last poll
+    };
+
+    void setSettings(const Settings& settings) { settings_ = settings; }
+    const Settings& settings() const { return settings_; }
+
+    // Startup or rebinding, like InputState::bind.
+    void bindButton(int button, ActionId action);
+    // `positive`: the axis's + direction (right, down, trigger pulled), else its - one.
+    void bindAxis(int axis, bool positive, ActionId action);
+    void clearBindings();
+
+    // Main thread (GLFW's rule), once per frame; `now` is monoclock::seconds().
+    void poll(double now);
+
+    const Pad& pad(int index) const { return pads_[static_cast<std::size_t>(index)]; }
+    ActionMask actions() const { return actions_; }
+    // Per action: 0..1, the largest bound button or axis value over all pads.
+    const std::array<float, kMaxActions>& analog() const { return analog_; }
+    // When the latest change was first seen (0: never).
+    double changedAt() const { return changedAt_; }
+
+    const Stats& stats() const { return stats_; }
+
+private:
+    void process();
+
+    Settings settings_{};
+    std::array<ActionMask, kButtons> buttonActions_{};
+    std::array<ActionMask, kAxes * 2> axisActions_{};  // [axis * 2 + positive]
+    std::array<Pad, kMaxPads> pads_{};
+    // Gathered raw, processed in place: left sticks then right sticks, and triggers
+    // likewise (left triggers, then right).
+    alignas(16) float stickX_[kMaxPads * 2] = {};
+    alignas(16) float stickY_[kMaxPads * 2] = {};
+    alignas(16) float triggers_[kMaxPads * 2] = {};
+    ActionMask actions_ = 0;
+    std::array<float, kMaxActions> analog_{};
+    double changedAt_ = 0.0;
+    Stats stats_;
+};
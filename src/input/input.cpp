@@ -0,0 +1,88 @@
+#include "input/input.h"
+
+#include "core/clock.h"
+
+void Input::install(GLFWwindow* window, GLFWkeyfun forwardKey) {
+    forwardKey_ = forwardKey;
+
+    // The window's user pointer is how the static callbacks find this object again.
+    glfwSetWindowUserPointer(window, this);
+    glfwSetKeyCallback(window, &Input::keyCallback);
+    glfwSetMouseButtonCallback(window, &Input::mouseButtonCallback);
+    glfwSetCursorPosCallback(window, &Input::cursorPosCallback);
+    glfwSetScrollCallback(window, &Input::scrollCallback);
+    glfwSetFramebufferSizeCallback(window, &Input::framebufferSizeCallback);
+    glfwSetWindowSizeCallback(window, &Input::windowSizeCallback);
+    updateScale(window);
+}
+
+Input* Input::fromWindow(GLFWwindow* window) {
+    return static_cast<Input*>(glfwGetWindowUserPointer(window));
+}
+
+void Input::updateScale(GLFWwindow* window) {
+    int windowWidth = 0, windowHeight = 0, width = 0, height = 0;
+    glfwGetWindowSize(window, &windowWidth, &windowHeight);
+    glfwGetFramebufferSize(window, &width, &height);
+    // Minimized: both are 0. Keep the last scale rather than collapse the cursor to 0.
+    if (windowWidth > 0 && windowHeight > 0 && width > 0 && height > 0) {
+        scaleX_ = static_cast<double>(width) / windowWidth;
+        scaleY_ = static_cast<double>(height) / windowHeight;
+    }
+}
+
+void Input::push(InputEvent event) {
+    event.time = monoclock::seconds();
+    if (!queue_.push(event)) {
+        ++dropped_;
+    }
+}
+
+void Input::keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+    Input* input = fromWindow(window);
+    if (!input) {
+        return;
+    }
+    input->state_.onKey(key, action);
+    input->push(InputEvent{InputEvent::Key, key, action, mods, 0.0, 0.0});
+    if (input->forwardKey_) {
+        input->forwardKey_(window, key, scancode, action, mods);
+    }
+}
+
+void Input::mouseButtonCallback(GLFWwindow* window, int button, int action, int mods) {
+    Input* input = fromWindow(window);
+    if (!input) {
+        return;
+    }
+    // Capture the cursor position now; by the time the frame consumes the event the
+    // cursor may have moved on.
+    double x = 0.0, y = 0.0;
+    glfwGetCursorPos(window, &x, &y);
+    input->push(InputEvent{InputEvent::MouseButton, button, action, mods, x * input->scaleX_, y * input->scaleY_});
+}
+
+void Input::cursorPosCallback(GLFWwindow* window, double x, double y) {
+    if (Input* input = fromWindow(window)) {
+        input->push(InputEvent{InputEvent::CursorMove, 0, 0, 0, x * input->scaleX_, y * input->scaleY_});
+    }
+}
+
+void Input::scrollCallback(GLFWwindow* window, double dx, double dy) {
+    if (Input* input = fromWindow(window)) {
+        input->push(InputEvent{InputEvent::Scroll, 0, 0, 0, dx, dy});
+    }
+}
+
+void Input::framebufferSizeCallback(GLFWwindow* window, int width, int height) {
+    if (Input* input = fromWindow(window)) {
+        input->updateScale(window);
+        input->push(InputEvent{InputEvent::FramebufferResize, width, height, 0, 0.0, 0.0});
+    }
+}
+
+void Input::windowSizeCallback(GLFWwindow* window, int, int) {
+    if (Input* input = fromWindow(window)) {
+        input->updateScale(window);
+    }
+}
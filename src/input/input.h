@@ -0,0 +1,94 @@
+#pragma once
+
+#include <GLFW/glfw3.h>
+#include <cstddef>
+#include <cstdint>
+
+#include "core/spsc_ring.h"
+#include "input/input_state.h"
+
+// InputEvent
+// ----------
+// Compact copy of one GLFW callback invocation. Callbacks only record what happened;
+// the game consumes events once per frame, where it already has all its state at hand.
+struct InputEvent {
+    enum Type : std::uint8_t {
+        Key,
+        MouseButton,
+        CursorMove,
+        Scroll,
+        FramebufferResize,
+    };
+
+    Type type;
+    int code;        // key (GLFW_KEY_*), mouse button (GLFW_MOUSE_BUTTON_*) or new width
+    int action;      // GLFW_PRESS / GLFW_RELEASE / GLFW_REPEAT, or new height (resize)
+    int mods;        // GLFW_MOD_* bitmask
+    double x, y;     // cursor position (framebuffer pixels, origin top-left) or scroll offsets
+    double time = 0.0; // monoclock::seconds() when the callback ran: the raw input's timestamp
+};
+
+// Input
+// -----
+// Owns the window's input callbacks. install(...) registers them ONCE at startup—never
+// inside the render loop. Each callback pushes an InputEvent into a lock-free ring, and
+// the frame drains the ring with poll(...).
+//
+// | Step               | Where                         | Cost                          |
+// | ------------------ | ----------------------------- | ----------------------------- |
+// | install(window)    | startup                       | 6 glfwSet*Callback calls      |
+// | callback fires     | inside glfwPollEvents()       | one ring push                 |
+// | poll(event)        | once per frame, per event     | one ring pop                  |
+//
+// Only one key callback can be registered per window, so install() takes an optional
+// GLFWkeyfun to forward key events to (e.g. main's keyCallback for toggles).
+//
+// Key events also update state() immediately, so held-key queries ("is W down?") are
+// bit tests on InputState instead of glfwGetKey calls.
+//
+// Framebuffer size changes arrive the same way (FramebufferResize, size in px in code /
+// action), so the frame never has to ask the window system for its size.
+//
+// GLFW reports the cursor in window coordinates, which on a HiDPI or scaled display
+// (Retina, scaled Wayland) are not the framebuffer's pixels. The callbacks scale it by
+// framebuffer size / window size, kept up to date by the two size callbacks, so every
+// consumer (Camera::screenToWorld, the picker, the UI) works in the pixels it draws in.
+class Input {
+public:
+    static constexpr std::size_t kQueueCapacity = 256;
+
+    void install(GLFWwindow* window, GLFWkeyfun forwardKey = nullptr);
+
+    // Pops the next queued event. Returns false when the queue is empty.
+    bool poll(InputEvent& event) { return queue_.pop(event); }
+    // Nothing queued since the last poll()s.
+    bool empty() const { return queue_.empty(); }
+
+    // Held keys / actions. Call newFrame() once per frame before glfwPollEvents().
+    InputState& state() { return state_; }
+    const InputState& state() const { return state_; }
+    void newFrame() { state_.newFrame(); }
+
+    // Events lost because more than kQueueCapacity arrived in one frame.
+    std::size_t droppedEvents() const { return dropped_; }
+
+    static Input* fromWindow(GLFWwindow* window);
+
+private:
+    void push(InputEvent event);
+    void updateScale(GLFWwindow* window);
+
+    static void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
+    static void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
+    static void cursorPosCallback(GLFWwindow* window, double x, double y);
+    static void scrollCallback(GLFWwindow* window, double dx, double dy);
+    static void framebufferSizeCallback(GLFWwindow* window, int width, int height);
+    static void windowSizeCallback(GLFWwindow* window, int width, int height);
+
+    SpscRing<InputEvent, kQueueCapacity> queue_;
+    InputState state_;
+    GLFWkeyfun forwardKey_ = nullptr;
+    std::size_t dropped_ = 0;
+    double scaleX_ = 1.0;              // framebuffer pixels per window coordinate
+    double scaleY_ = 1.0;
+};
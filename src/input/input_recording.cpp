@@ -0,0 +1,188 @@
+#include "input/input_recording.h"
+
+#include <cstring>
+#include <iostream>
+
+#include "core/file_io.h"
+
+namespace {
+
+constexpr char kMagic[4] = {'I', 'N', 'P', 'R'};
+constexpr std::uint32_t kVersion = 1;
+constexpr std::size_t kHeaderSize = 12;
+
+enum Opcode : std::uint8_t {
+    End = 0,
+    Ticks = 1,
+    Actions = 2,
+    Key = 3,
+};
+
+void putVarint(std::vector<std::uint8_t>& out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<std::uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<std::uint8_t>(value));
+}
+
+void putU32(std::vector<std::uint8_t>& out, std::uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+    }
+}
+
+std::uint32_t getU32(const unsigned char* in) {
+    return static_cast<std::uint32_t>(in[0]) | static_cast<std::uint32_t>(in[1]) << 8 |
+           static_cast<std::uint32_t>(in[2]) << 16 | static_cast<std::uint32_t>(in[3]) << 24;
+}
+
+} // namespace
+
+bool InputRecorder::open(const std::string& path, std::uint32_t ticksPerSecond) {
+    close();
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) {
+        std::cerr << "Input recording: can't write " << path << "\n";
+        return false;
+    }
+    buffer_.resize(sizeof(kMagic));
+    std::memcpy(buffer_.data(), kMagic, sizeof(kMagic));
+    putU32(buffer_, kVersion);
+    putU32(buffer_, ticksPerSecond);
+    actions_ = 0;
+    run_ = 0;
+    ticks_ = 0;
+    written_ = 0;
+    return true;
+}
+
+void InputRecorder::close() {
+    if (!file_) {
+        return;
+    }
+    endRun();
+    buffer_.push_back(End);
+    flush();
+    std::fclose(file_);
+    file_ = nullptr;
+}
+
+void InputRecorder::key(int key, int action, int mods) {
+    if (!file_) {
+        return;
+    }
+    endRun();
+    buffer_.push_back(Key);
+    putVarint(buffer_, static_cast<std::uint64_t>(key < 0 ? 0 : key));
+    buffer_.push_back(static_cast<std::uint8_t>(action));
+    buffer_.push_back(static_cast<std::uint8_t>(mods));
+}
+
+void InputRecorder::tick(ActionMask actions) {
+    if (!file_) {
+        return;
+    }
+    if (actions != actions_) {
+        endRun();
+        buffer_.push_back(Actions);
+        putVarint(buffer_, actions);
+        actions_ = actions;
+    }
+    ++run_;
+    ++ticks_;
+    if (buffer_.size() >= kFlushBytes) {
+        endRun();
+        flush();
+    }
+}
+
+void InputRecorder::endRun() {
+    if (run_ > 0) {
+        buffer_.push_back(Ticks);
+        putVarint(buffer_, run_);
+        run_ = 0;
+    }
+}
+
+void InputRecorder::flush() {
+    if (!buffer_.empty()) {
+        std::fwrite(buffer_.data(), 1, buffer_.size(), file_);
+        std::fflush(file_);
+        written_ += buffer_.size();
+        buffer_.clear();
+    }
+}
+
+bool InputReplay::open(const std::string& path) {
+    *this = InputReplay{};
+    if (!readFile(path, data_)) {
+        std::cerr << "Input replay: can't read " << path << "\n";
+        return false;
+    }
+    if (data_.size() < kHeaderSize || std::memcmp(data_.data(), kMagic, 4) != 0) {
+        std::cerr << "Input replay: " << path << " is not an input recording\n";
+        return false;
+    }
+    if (getU32(data_.data() + 4) != kVersion) {
+        std::cerr << "Input replay: " << path << " is version " << getU32(data_.data() + 4) << ", expected "
+                  << kVersion << "\n";
+        return false;
+    }
+    ticksPerSecond_ = getU32(data_.data() + 8);
+    position_ = kHeaderSize;
+    return true;
+}
+
+bool InputReplay::varint(std::uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && position_ < data_.size(); shift += 7) {
+        const unsigned char byte = data_[position_++];
+        value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool InputReplay::next(KeyFn onKey, ActionMask& actions) {
+    while (run_ == 0) {
+        if (position_ >= data_.size()) {
+            return false;              // cut short: recorded up to a crash
+        }
+        std::uint64_t value = 0;
+        switch (data_[position_++]) {
+            case Ticks:
+                if (!varint(run_)) {
+                    return false;
+                }
+                break;
+            case Actions:
+                if (!varint(value)) {
+                    return false;
+                }
+                actions_ = value;
+                break;
+            case Key:
+                if (!varint(value) || position_ + 2 > data_.size()) {
+                    return false;
+                }
+                onKey(static_cast<int>(value), data_[position_], data_[position_ + 1]);
+                position_ += 2;
+                break;
+            case End:
+                complete_ = true;
+                position_ = data_.size();
+                return false;
+            default:
+                std::cerr << "Input replay: unknown record at byte " << position_ - 1 << "\n";
+                position_ = data_.size();
+                return false;
+        }
+    }
+    --run_;
+    ++tick_;
+    actions = actions_;
+    return true;
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "input/input_state.h"
+
+// Input recordings
+// ----------------
+// Everything the simulation takes from the player, per fixed simulation tick, in a
+// compact binary log: replaying it re-runs the same session step for step, which makes a
+// real play session a repeatable benchmark (--record=FILE, then --replay=FILE).
+//
+// | What                              | Recorded as                                   |
+// | --------------------------------- | --------------------------------------------- |
+// | held actions (arrows, WASD,       | the ActionMask each tick ran with; only       |
+// | shift: InputState::active/axis)   | changes are stored, plus run lengths          |
+// | keyCallback events (the toggles:  | key, action, mods, before the tick they came  |
+// | pause, scale, projection, path)   | in front of                                   |
+//
+// The stream after the header is a sequence of records, one opcode byte each:
+//
+// | Opcode  | Operands                   | Meaning                                       |
+// | ------- | -------------------------- | --------------------------------------------- |
+// | Ticks   | varint n                   | n ticks with the current mask                 |
+// | Actions | varint mask                | the mask from the next tick on                |
+// | Key     | varint key, u8 action,     | call the key callback with it                 |
+// |         | u8 mods                    |                                               |
+// | End     |                            | the recording is complete                     |
+//
+// Varints are LEB128 (7 bits per byte, low first). Holding a direction for ten seconds
+// is two or three bytes, so a ten-minute session is a few KiB. The header is the magic
+// "INPR", a u32 version and the simulation rate (u32 ticks per second), little endian.
+
+// InputRecorder
+// -------------
+// Main thread. Records go to a buffer written out every kFlushBytes and at close(), so a
+// crash loses at most the last few seconds (without an End record: replay stops there).
+class InputRecorder {
+public:
+    static constexpr std::size_t kFlushBytes = 4096;
+
+    InputRecorder() = default;
+    InputRecorder(const InputRecorder&) = delete;
+    InputRecorder& operator=(const InputRecorder&) = delete;
+    ~InputRecorder() { close(); }
+
+    bool open(const std::string& path, std::uint32_t ticksPerSecond);
+    void close();
+    bool recording() const { return file_ != nullptr; }
+
+    // A key callback event; it applies before the next tick().
+    void key(int key, int action, int mods);
+    // One simulation step, run with `actions` held.
+    void tick(ActionMask actions);
+
+    std::uint64_t ticks() const { return ticks_; }
+    std::uint64_t bytes() const { return written_ + buffer_.size(); }
+
+private:
+    void endRun();
+    void flush();
+
+    std::FILE* file_ = nullptr;
+    std::vector<std::uint8_t> buffer_;
+    ActionMask actions_ = 0;           // the mask of the open run
+    std::uint64_t run_ = 0;            // ticks in it
+    std::uint64_t ticks_ = 0;
+    std::uint64_t written_ = 0;
+};
+
+// InputReplay
+// -----------
+// The whole recording read at open(), then handed out tick by tick:
+//
+//     while (replay.next(onKey, actions)) {  // onKey for the keys recorded before it
+//         state.setActions(actions);
+//         updateSimulation(...);             // exactly one step
+//     }
+class InputReplay {
+public:
+    using KeyFn = void (*)(int key, int action, int mods);
+
+    // false (and why on stderr) if the file is missing, not a recording or of another version.
+    bool open(const std::string& path);
+
+    // The next tick's actions, after calling onKey for the key events in front of it;
+    // false once the recording is over (or corrupt from here on).
+    bool next(KeyFn onKey, ActionMask& actions);
+
+    std::uint32_t ticksPerSecond() const { return ticksPerSecond_; }
+    std::uint64_t tick() const { return tick_; }        // ticks handed out so far
+    bool complete() const { return complete_; }          // an End record was reached
+
+private:
+    bool varint(std::uint64_t& value);
+
+    std::vector<unsigned char> data_;
+    std::size_t position_ = 0;
+    std::uint32_t ticksPerSecond_ = 0;
+    ActionMask actions_ = 0;
+    std::uint64_t run_ = 0;            // ticks left with actions_
+    std::uint64_t tick_ = 0;
+    bool complete_ = false;
+};
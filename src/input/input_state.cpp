@@ -0,0 +1,68 @@
+#include "input/input_state.h"
+
+void InputState::bind(int key, ActionId action) {
+    if (!valid(key) || action >= kMaxActions) {
+        return;
+    }
+    const ActionMask bit = ActionMask(1) << action;
+    if (actionsForKey_[key] & bit) {
+        return;
+    }
+    actionsForKey_[key] |= bit;
+    // Keep counts consistent if the key is already held while binding.
+    recomputeActions();
+}
+
+void InputState::unbind(int key, ActionId action) {
+    if (!valid(key) || action >= kMaxActions) {
+        return;
+    }
+    actionsForKey_[key] &= ~(ActionMask(1) << action);
+    recomputeActions();
+}
+
+void InputState::clearBindings() {
+    actionsForKey_.fill(0);
+    recomputeActions();
+}
+
+void InputState::onKey(int key, int action) {
+    if (!valid(key) || action == GLFW_REPEAT) {
+        return; // repeats don't change held state
+    }
+    const bool isDown = action == GLFW_PRESS;
+    if (keys_.test(key) == isDown) {
+        return;
+    }
+    keys_.set(key, isDown);
+
+    // Update every action bound to this key. Usually 0 or 1 bits are set.
+    ActionMask mask = actionsForKey_[key];
+    while (mask) {
+        const int a = __builtin_ctzll(mask);
+        mask &= mask - 1;
+        if (isDown) {
+            if (actionKeyCount_[a]++ == 0) actions_ |= ActionMask(1) << a;
+        } else {
+            if (--actionKeyCount_[a] == 0) actions_ &= ~(ActionMask(1) << a);
+        }
+    }
+}
+
+// Rebuilds counts from scratch. Only used when bindings change.
+void InputState::recomputeActions() {
+    actionKeyCount_.fill(0);
+    actions_ = 0;
+    for (int key = 0; key < kKeyCount; ++key) {
+        if (!keys_.test(key)) {
+            continue;
+        }
+        ActionMask mask = actionsForKey_[key];
+        while (mask) {
+            const int a = __builtin_ctzll(mask);
+            mask &= mask - 1;
+            actionKeyCount_[a]++;
+            actions_ |= ActionMask(1) << a;
+        }
+    }
+}
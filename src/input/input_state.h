@@ -0,0 +1,92 @@
+#pragma once
+
+#include <GLFW/glfw3.h>
+#include <array>
+#include <bitset>
+#include <cstdint>
+
+// ActionId / ActionMask
+// ---------------------
+// Gameplay talks about ACTIONS ("move left", "sprint"), not keys. The game defines its
+// own enum of action ids (0..kMaxActions-1); several keys may map to the same action.
+using ActionId = std::uint8_t;
+using ActionMask = std::uint64_t;
+constexpr int kMaxActions = 64;
+
+// InputState
+// ----------
+// Compact keyboard + action state, updated from key events (never by calling glfwGetKey)
+// and once a frame from the gamepads (input/gamepad.h).
+//
+// | Data                  | Size       | Meaning                                        |
+// | --------------------- | ---------- | ---------------------------------------------- |
+// | keys_ / prevKeys_     | 349 bits   | Key held now / at the start of this frame      |
+// | actionsForKey_[key]   | 64-bit     | Which actions this key is bound to             |
+// | actionKeyCount_[a]    | 1 byte     | How many bound keys of action `a` are held     |
+// | actions_              | 64 bits    | Action active by a key                         |
+// | padActions_           | 64 bits    | ... by a gamepad                               |
+// | padAnalog_[a]         | float      | The gamepads' 0..1 for action `a`              |
+// | prevActions_          | 64 bits    | Either, at the start of this frame             |
+//
+// Every query is a bit test. Binding more keys only changes the lookup tables; the
+// per-frame cost stays one 64-bit copy in newFrame(). axis() is where the pads' analog
+// values show: a held key counts 1, a half-tilted stick 0.5.
+class InputState {
+public:
+    static constexpr int kKeyCount = GLFW_KEY_LAST + 1;
+
+    // Bind a key to an action. Call at startup or when rebinding (not per frame).
+    void bind(int key, ActionId action);
+    void unbind(int key, ActionId action);
+    void clearBindings();
+
+    // Snapshot current state as "previous"; call once per frame BEFORE glfwPollEvents().
+    void newFrame() {
+        prevKeys_ = keys_;
+        prevActions_ = actions();
+    }
+
+    // Fed by the key callback.
+    void onKey(int key, int action);
+    // Replay (input/input_recording.h): the actions a recording ran with, whatever keys are
+    // held (or pads pushed). The next onKey recomputes only the actions bound to its key.
+    void setActions(ActionMask actions) {
+        actions_ = actions;
+        padActions_ = 0;
+        padAnalog_.fill(0.0f);
+    }
+    // The gamepads' actions and analog values, once a frame (Gamepads::poll).
+    void setPad(ActionMask actions, const std::array<float, kMaxActions>& analog) {
+        padActions_ = actions;
+        padAnalog_ = analog;
+    }
+
+    // Keys
+    bool down(int key) const { return valid(key) && keys_.test(key); }
+    bool pressed(int key) const { return valid(key) && keys_.test(key) && !prevKeys_.test(key); }
+    bool released(int key) const { return valid(key) && !keys_.test(key) && prevKeys_.test(key); }
+
+    // Actions
+    bool active(ActionId a) const { return (actions() >> a) & 1u; }
+    bool started(ActionId a) const { return ((actions() & ~prevActions_) >> a) & 1u; }
+    bool stopped(ActionId a) const { return ((~actions() & prevActions_) >> a) & 1u; }
+    ActionMask actions() const { return actions_ | padActions_; }
+
+    // 0..1: 1 while a bound key is held, else the gamepads' value.
+    float value(ActionId a) const { return ((actions_ >> a) & 1u) ? 1.0f : padAnalog_[a]; }
+    // -1..+1 from two opposing actions, e.g. axis(MoveLeft, MoveRight).
+    float axis(ActionId negative, ActionId positive) const { return value(positive) - value(negative); }
+
+private:
+    static bool valid(int key) { return key >= 0 && key < kKeyCount; }
+    void recomputeActions();
+
+    std::bitset<kKeyCount> keys_;
+    std::bitset<kKeyCount> prevKeys_;
+    std::array<ActionMask, kKeyCount> actionsForKey_{};
+    std::array<std::uint8_t, kMaxActions> actionKeyCount_{};
+    ActionMask actions_ = 0;
+    ActionMask padActions_ = 0;
+    std::array<float, kMaxActions> padAnalog_{};
+    ActionMask prevActions_ = 0;
+};
@@ -0,0 +1,95 @@
+#include "input/key_names.h"
+
+#include <GLFW/glfw3.h>
+#include <cctype>
+#include <cstring>
+
+namespace {
+
+struct NamedKey {
+    const char* name;
+    int key;
+};
+
+// Letters and digits are handled before this table: GLFW uses their ASCII codes.
+const NamedKey kNamedKeys[] = {
+    {"Space", GLFW_KEY_SPACE},           {"Apostrophe", GLFW_KEY_APOSTROPHE},
+    {"Comma", GLFW_KEY_COMMA},           {"Minus", GLFW_KEY_MINUS},
+    {"Period", GLFW_KEY_PERIOD},         {"Slash", GLFW_KEY_SLASH},
+    {"Semicolon", GLFW_KEY_SEMICOLON},   {"Equal", GLFW_KEY_EQUAL},
+    {"LeftBracket", GLFW_KEY_LEFT_BRACKET}, {"RightBracket", GLFW_KEY_RIGHT_BRACKET},
+    {"Backslash", GLFW_KEY_BACKSLASH},   {"Grave", GLFW_KEY_GRAVE_ACCENT},
+    {"Escape", GLFW_KEY_ESCAPE},         {"Enter", GLFW_KEY_ENTER},
+    {"Tab", GLFW_KEY_TAB},               {"Backspace", GLFW_KEY_BACKSPACE},
+    {"Insert", GLFW_KEY_INSERT},         {"Delete", GLFW_KEY_DELETE},
+    {"Right", GLFW_KEY_RIGHT},           {"Left", GLFW_KEY_LEFT},
+    {"Down", GLFW_KEY_DOWN},             {"Up", GLFW_KEY_UP},
+    {"PageUp", GLFW_KEY_PAGE_UP},        {"PageDown", GLFW_KEY_PAGE_DOWN},
+    {"Home", GLFW_KEY_HOME},             {"End", GLFW_KEY_END},
+    {"LeftShift", GLFW_KEY_LEFT_SHIFT},  {"LeftControl", GLFW_KEY_LEFT_CONTROL},
+    {"LeftAlt", GLFW_KEY_LEFT_ALT},      {"RightShift", GLFW_KEY_RIGHT_SHIFT},
+    {"RightControl", GLFW_KEY_RIGHT_CONTROL}, {"RightAlt", GLFW_KEY_RIGHT_ALT},
+};
+
+const char* const kFunctionKeys[] = {"F1", "F2", "F3", "F4", "F5", "F6", "F7", "F8", "F9", "F10", "F11", "F12"};
+const char* const kKeypadKeys[] = {"Keypad0", "Keypad1", "Keypad2", "Keypad3", "Keypad4",
+                                   "Keypad5", "Keypad6", "Keypad7", "Keypad8", "Keypad9"};
+
+bool equalNoCase(const std::string& a, const char* b) {
+    if (a.size() != std::strlen(b)) {
+        return false;
+    }
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+namespace keynames {
+
+int fromName(const std::string& name) {
+    if (name.size() == 1) {
+        const unsigned char c = static_cast<unsigned char>(std::toupper(static_cast<unsigned char>(name[0])));
+        if ((c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')) {
+            return c;               // GLFW_KEY_A.. / GLFW_KEY_0..
+        }
+    }
+    for (const NamedKey& k : kNamedKeys) {
+        if (equalNoCase(name, k.name)) {
+            return k.key;
+        }
+    }
+    for (int i = 0; i < 12; ++i) {
+        if (equalNoCase(name, kFunctionKeys[i])) {
+            return GLFW_KEY_F1 + i;
+        }
+    }
+    for (int i = 0; i < 10; ++i) {
+        if (equalNoCase(name, kKeypadKeys[i])) {
+            return GLFW_KEY_KP_0 + i;
+        }
+    }
+    return -1;
+}
+
+const char* name(int key) {
+    static const char* const kLetters[] = {"A", "B", "C", "D", "E", "F", "G", "H", "I", "J", "K", "L", "M",
+                                           "N", "O", "P", "Q", "R", "S", "T", "U", "V", "W", "X", "Y", "Z"};
+    static const char* const kDigits[] = {"0", "1", "2", "3", "4", "5", "6", "7", "8", "9"};
+    if (key >= GLFW_KEY_A && key <= GLFW_KEY_Z) return kLetters[key - GLFW_KEY_A];
+    if (key >= GLFW_KEY_0 && key <= GLFW_KEY_9) return kDigits[key - GLFW_KEY_0];
+    if (key >= GLFW_KEY_F1 && key <= GLFW_KEY_F12) return kFunctionKeys[key - GLFW_KEY_F1];
+    if (key >= GLFW_KEY_KP_0 && key <= GLFW_KEY_KP_9) return kKeypadKeys[key - GLFW_KEY_KP_0];
+    for (const NamedKey& k : kNamedKeys) {
+        if (k.key == key) {
+            return k.name;
+        }
+    }
+    return "?";
+}
+
+} // namespace keynames
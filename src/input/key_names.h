@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+
+// Key names
+// ---------
+// GLFW key codes by the names a config file uses for them, and back. Letters and digits
+// are themselves ("A", "7"); the rest are spelled out. Case doesn't matter.
+//
+// | Names                                                  | Keys                      |
+// | ------------------------------------------------------ | ------------------------- |
+// | A..Z, 0..9                                             | printable keys            |
+// | Space, Minus, Equal, Comma, Period, Slash, Semicolon,  | punctuation               |
+// | Apostrophe, LeftBracket, RightBracket, Backslash, Grave|                           |
+// | Left, Right, Up, Down, Escape, Enter, Tab, Backspace,  | navigation and editing    |
+// | Insert, Delete, Home, End, PageUp, PageDown            |                           |
+// | F1..F12                                                | function keys             |
+// | LeftShift, RightShift, LeftControl, RightControl,      | modifiers                 |
+// | LeftAlt, RightAlt                                      |                           |
+// | Keypad0..Keypad9                                       | the number pad            |
+namespace keynames {
+
+// GLFW_KEY_..., or -1 for a name that isn't one.
+int fromName(const std::string& name);
+// The name fromName() takes, or "?" for a key without one.
+const char* name(int key);
+
+} // namespace keynames
@@ -7,13 +7,187 @@
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <thread>
+
+#include "asset/bitmap_font.h"
+#include "asset/image.h"
+#include "audio/mixer.h"
+#include "bench/bench.h"
+#include "core/job_system.h"
+#include "core/loose_quadtree.h"
+#include "core/task_graph.h"
+#include "core/uniform_grid.h"
+#include "core/world_gen.h"
+#include "ecs/components.h"
+#include "ecs/parallel.h"
+#include "ecs/save_file.h"
+#include "ecs/scheduler.h"
+#include "ecs/snapshot.h"
+#include "ecs/world.h"
+#include "game/game_config.h"
+#include "game/options.h"
+#include "game/sprites.h"
+#include "game/tile_maps.h"
+#include "core/entity_handle.h"
+#include "core/alloc_counter.h"
+#include "core/boids.h"
+#include "core/camera_rig.h"
+#include "core/clock.h"
+#include "core/collision.h"
+#include "core/config.h"
+#include "core/event_bus.h"
+#include "core/file_io.h"
+#include "core/file_watcher.h"
+#include "core/fixed_timestep.h"
+#include "core/flow_field.h"
+#include "core/frame_arena.h"
+#include "core/frame_budget.h"
+#include "core/frame_pacer.h"
+#include "core/frame_task.h"
+#include "core/level_file.h"
+#include "core/level_streamer.h"
+#include "core/log.h"
+#include "core/particle_soa.h"
+#include "core/path_service.h"
+#include "core/radix_sort.h"
+#include "core/skeleton_2d.h"
+#include "core/sweep_and_prune.h"
+#include "core/thread_affinity.h"
+#include "core/timer_wheel.h"
+#include "core/transform_hierarchy.h"
+#include "core/vfs.h"
+#include "input/command_map.h"
+#include "input/gamepad.h"
+#include "input/input.h"
+#include "input/input_recording.h"
+#include "input/key_names.h"
+#include "net/prediction.h"
+#include "net/replication.h"
+#include "profile/flight_recorder.h"
+#include "profile/hitch_detector.h"
+#include "profile/input_latency.h"
+#include "profile/perf_hud.h"
+#include "profile/profiler.h"
+#include "profile/sampling.h"
+#include "profile/shader_timings.h"
+#include "profile/startup_timeline.h"
+#include "profile/telemetry.h"
+#include "profile/trace.h"
+#include "render/gl_buffer.h"
+#include "render/gl_debug.h"
+#include "render/gl_ext.h"
+#include "render/gl_framebuffer.h"
+#include "render/gl_resource.h"
+#include "render/gl_state.h"
+#include "render/gl_stall.h"
+#include "render/glyph_cache.h"
+#include "render/gpu_memory.h"
+#include "render/frame_packet.h"
+#include "render/frame_renderer.h"
+#include "render/instanced_quads.h"
+#include "render/light_buffer.h"
+#include "render/mesh_pool.h"
+#include "render/frame_capture.h"
+#include "render/gpu_noise.h"
+#include "render/gpu_picker.h"
+#include "render/oit_buffer.h"
+#include "render/overdraw.h"
+#include "render/pipeline_state.h"
+#include "render/post_process.h"
+#include "render/picker.h"
+#include "render/particle_system.h"
+#include "render/program_cache.h"
+#include "render/quality_governor.h"
+#include "render/render_graph.h"
+#include "render/render_target.h"
+#include "render/render_thread.h"
+#include "render/shader_build.h"
+#include "render/shader_program.h"
+#include "render/shader_reloader.h"
+#include "render/shape_cache.h"
+#include "render/skinned_mesh.h"
+#include "render/sprite_animation.h"
+#include "render/sprite_batch.h"
+#include "render/sprite_lod.h"
+#include "render/static_batch.h"
+#include "render/texture_array.h"
+#include "render/texture_atlas.h"
+#include "render/texture_loader.h"
+#include "render/tilemap.h"
+#include "render/vertex_array_cache.h"
+#include "render/virtual_texture.h"
+#include "render/visible_set.h"
+#include "render/vertex_layout.h"
+#include "render/camera.h"
+#include "render/camera_ubo.h"
+#include "render/command_bucket.h"
+#include "render/context_pool.h"
+#include "render/culling.h"
+#include "render/debug_draw.h"
+#include "render/dynamic_resolution.h"
+#include "render/sdf_font.h"
+#include "render/text_batch.h"
+#include "render/ui_renderer.h"
+#include "script/script_host.h"
+#include "ui/immediate_ui.h"
+
+// Between subsystems (core/event_bus.h): keyCallback's toggles, the bounce system's jobs.
+// Dispatched on main before a frame's steps and after them.
+EventBus events;
+struct PauseToggled {};      // Escape
+struct ScaleToggled {};      // R
+struct ProjectionToggled {}; // P
+bool debugShapes = false;    // F3 toggles (or --debug-draw): culling and picking drawn on top
+bool hudVisible = false;     // F2 toggles (or --hud): frame-time graph, timings and counters
+bool toolsVisible = false;   // F4 toggles (or --ui): the tools panel (ui/immediate_ui.h)
+bool cameraFollow = false;   // F toggles: the camera follows the player instead of WASD
+bool rewinding = false;      // Backspace held: steps go back through the snapshot history
+bool quickSave = false;      // F5 pressed: keep the latest snapshot (handled per frame)
+bool quickLoad = false;      // F9 pressed: back to it
+bool windowDamaged = false;  // the window system asked for a repaint (idle frames need one)
+InputRecorder inputRecorder; // --record=FILE: keyCallback's events and every tick's actions
+// B cycles how the game draws its entities: instanced mat4 quads (flat colour), the CPU
+// sprite batcher (atlas images), or instanced quads sampling the sprite texture array.
+enum class GamePath { Instanced, Sprites, Layered };
+GamePath gamePath = GamePath::Instanced;
+
+const char* gamePathName(GamePath path) {
+    switch (path) {
+        case GamePath::Instanced: return "Instanced";
+        case GamePath::Sprites:   return "Sprite batch";
+        case GamePath::Layered:   return "Texture array";
+    }
+    return "?";
+}
+
+void cycleGamePath() {
+    gamePath = gamePath == GamePath::Instanced ? GamePath::Sprites
+             : gamePath == GamePath::Sprites   ? GamePath::Layered
+                                               : GamePath::Instanced;
+    logging::info("Renderer path: %s", gamePathName(gamePath));
+}
 
-bool isPaused = false;
-bool scaleUp = false;
-bool useOrtho = true; // Start in orthographic mode
+// Position, projection mode (P toggles, starts orthographic) and viewport size; builds
+// view/projection only when one of them changes. See render/camera.h.
+Camera camera;
 
-int width, height;
-glm::mat4 currentMVP;
+// The one-shot commands' table (GameCommand, game/game_config.h): keyCallback dispatches
+// through it, bindCommands() fills it from game.cfg's [commands].
+CommandMap commands;
+
+// game.cfg as the frame reads it (game/game_config.h); applyConfig swaps in a reload.
+GameConfig gameConfig;
 
 
 // Key Callback Function (GLFW Required Signature)
@@ -36,17 +210,35 @@ glm::mat4 currentMVP;
 // - mods:       Bitmask for modifier keys (GLFW_MOD_SHIFT, GLFW_MOD_CONTROL, etc.)
 
 void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods){
-    if(key == GLFW_KEY_ESCAPE && action == GLFW_PRESS){
-        isPaused = !isPaused;
-        std::cout << (isPaused ? "Game Paused\n" : "Game Unpaused\n");
-    } else if(key == GLFW_KEY_R && action == GLFW_PRESS){
-        scaleUp = !scaleUp;
-        // std::cout << "Triggering scale transformation\n";
-    } else if (key == GLFW_KEY_P && action == GLFW_PRESS) {
-        useOrtho = !useOrtho;
-        std::cout << "Projection mode: " << (useOrtho ? "Orthographic" : "Perspective") << "\n";
-    }
+    inputRecorder.key(key, action, mods);   // no-op unless recording
+    flightrec::input(key, action);          // likewise
+    commands.dispatch(key, action, mods);   // one table lookup, one call: see defineCommands
+}
 
+// The commands' handlers: the function table keyCallback dispatches through. The keys
+// are game.cfg's (bindCommands), rebound when it is saved.
+void defineCommands(CommandMap& map) {
+    map.define(TogglePause, [](bool) { events.publish(PauseToggled{}); });
+    map.define(ToggleScale, [](bool) { events.publish(ScaleToggled{}); });
+    map.define(ToggleProjection, [](bool) { events.publish(ProjectionToggled{}); });
+    map.define(CyclePath, [](bool) { cycleGamePath(); });
+    map.define(ToggleFollow, [](bool) {
+        cameraFollow = !cameraFollow;
+        logging::info("Camera: %s", cameraFollow ? "following the player" : "free (WASD)");
+    });
+    map.define(Rewind, [](bool pressed) { rewinding = pressed; }, CommandMap::Trigger::PressRelease);
+    map.define(QuickSave, [](bool) { quickSave = true; });
+    map.define(QuickLoad, [](bool) { quickLoad = true; });
+    map.define(ToggleHud, [](bool) { hudVisible = !hudVisible; });
+    map.define(ToggleTools, [](bool) { toolsVisible = !toolsVisible; });
+    map.define(ToggleDebugDraw, [](bool) {
+        if (debugdraw::enabled()) {
+            debugShapes = !debugShapes;
+            logging::info("Debug draw: %s", debugShapes ? "on" : "off");
+        } else {
+            logging::warn("Debug draw: not in this build (DEBUG_DRAW=0)");
+        }
+    });
 }
 
 // void cursorPositionCallback(GLFWwindow* window, double xpos, double ypos) {
@@ -79,491 +271,3749 @@ void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods
 //     }
 // }
 
-// If I wanted to handle multiple different inputs via a callback event, I would
-// do so within the *single* keyCallback function. Only ONE callback function can
-// be registered for key presses. One implementation would be to use a switch block
-// to determine the input to be handled out of all inputs registered in the callback.
-// The callback is essentially an event router.
-
-std::string loadShaderSource(const char* filePath){
-    std::ifstream file(filePath);
-    std::stringstream buffer;
-
-    if(!file.is_open()){
-        std::cerr<< "Failed to open shader file: " << filePath <<". Load aborting...\n";
-        return "";
-    }
-
-    buffer << file.rdbuf();
-    return buffer.str();
+// Simulation state and fixed-step update
+// --------------------------------------
+// Everything that moves lives in SimState and is ONLY changed by updateSimulation(...),
+// which always runs with the same dt (1 / kSimulationHz). Rendering reads positions
+// interpolated between the last two steps, so movement looks smooth at any frame rate.
+//
+// Entities (the player, plus --entities=N wanderers) live in an archetype World
+// (ecs/world.h) and are moved by systems (below) that the scheduler runs once per step,
+// each streaming through the chunks of the entities that have its components. The
+// movement keys drive every Controllable entity, not one hard-coded quad.
+constexpr double kSimulationHz = 60.0;
+
+// Which build a --startup-bench CSV row came from: when this file was compiled.
+constexpr const char* kBuildStamp = __DATE__ " " __TIME__;
+
+// --collisions: one step's collider boxes, broadphase and contacts. Kept across steps:
+// the broadphase's order is what makes its next sort cheap (core/sweep_and_prune.h), and
+// the arrays keep their capacity.
+struct CollisionStep {
+    std::vector<ChunkSpan<Position, Velocity, Scale, Collider>> chunks;
+    CollisionBodies bodies;
+    SweepAndPrune broadphase;
+    std::vector<CollisionPair> pairs;
+    ContactIslands islands;             // the pairs split for the workers
+    std::size_t contacts = 0;           // last step
+};
+
+// --boids: the flock's arrays and chunk list, kept across steps (capacity, no
+// allocations once grown).
+struct FlockStep {
+    std::vector<ChunkSpan<Position, Velocity, Boid>> chunks;
+    Flock flock;
+};
+
+// The camera may look a little past where the wanderers roam, never further.
+CameraRig::Settings cameraRigSettings(const Aabb& wanderBounds) {
+    CameraRig::Settings settings;
+    settings.bounded = true;
+    settings.bounds = Aabb{wanderBounds.min - glm::vec2(1.0f), wanderBounds.max + glm::vec2(1.0f)};
+    return settings;
 }
-// Note: TECHNICALLY, you could just directly hardcode shader code as a set of strings.
-// This would work perfectly fine. However:
-// External files let you:
-//     Reload shaders on the fly (especially during development)
-//     Swap shaders without touching your engine code
-//     Compile tools that preprocess or validate your shader files
 
-// compileShader(...)
-// ------------------
-// source:      Pointer to C-style string containing GLSL source code.
-//              Usually passed as .c_str() from a std::string.
-// shaderType:  Type of shader to compile (e.g. GL_VERTEX_SHADER or GL_FRAGMENT_SHADER)
-//
-// Purpose: Creates, attaches, and compiles a shader of the given type using the provided GLSL source.
-// Returns: GLuint ID of the compiled shader object.
-
-GLuint compileShader(const char* source, GLenum shaderType){
-    // | `shaderType`         | Meaning                               |
-    // | -------------------- | ------------------------------------- |
-    // | `GL_VERTEX_SHADER`   | Vertex shader stage (runs per vertex) |
-    // | `GL_FRAGMENT_SHADER` | Fragment (pixel) shader               |
-    // | `GL_GEOMETRY_SHADER` | Optional stage (more advanced)        |
-    // | etc.                 | (e.g., tessellation, compute)         |
-
-    GLuint shader = glCreateShader(shaderType);
-    glShaderSource(shader, 1, &source, nullptr);
-    // void glShaderSource(GLuint shader,
-    //     GLsizei count,
-    //     const GLchar* const* string,
-    //     const GLint* length);
-
-    // | Parameter | Meaning                                                      |
-    // | --------- | ------------------------------------------------------------ |
-    // | `shader`  | The shader object to attach source code to                   |
-    // | `count`   | Number of strings passed (usually 1)                         |
-    // | `string`  | An array of `char*` pointers (C-strings holding GLSL source) |
-    // | `length`  | Optional: array of lengths for each string                   |
-
-    // If you pass nullptr for length, OpenGL assumes:
-
-    // “Each string in string[] is null-terminated. I’ll keep reading until I hit \0.”
-
-    // | Question                         | Answer                                                                       |
-    // | -------------------------------- | ---------------------------------------------------------------------------- |
-    // | Why pass `nullptr` for `length`? | It tells OpenGL “just treat this as a null-terminated C-string.”             |
-    // | Is that safe?                    | ✅ Yes—*if* the source string is cleanly null-terminated (as from `.c_str()`) |
-    // | When would I pass real lengths?  | When using multiple strings or substrings, or embedded nulls                 |
-
-    glCompileShader(shader);
-    // Check for compile success
-    int pass;
-    // Checks status of a shader 
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &pass);
-
-    // | Parameter | Type     | Purpose                                                |
-    // | --------- | -------- | ------------------------------------------------------ |
-    // | `shader`  | `GLuint` | The ID of the shader object you want to query          |
-    // | `pname`   | `GLenum` | What property you want to query (e.g., compile status) |
-    // | `params`  | `GLint*` | Pointer to an integer where the result will be stored  |
-
-    // | `pname`                   | Meaning                                                                  |
-    // | ------------------------- | ------------------------------------------------------------------------ |
-    // | `GL_COMPILE_STATUS`       | Whether the shader compiled successfully (`GL_TRUE` or `GL_FALSE`)       |
-    // | `GL_SHADER_TYPE`          | Whether it's a vertex, fragment, geometry shader, etc.                   |
-    // | `GL_DELETE_STATUS`        | Whether the shader has been flagged for deletion                         |
-    // | `GL_INFO_LOG_LENGTH`      | Number of characters in the shader’s info log (compile errors, warnings) |
-    // | `GL_SHADER_SOURCE_LENGTH` | Length of the source code (if stored)                                    |
-
-    if(!pass){
-        // Compile failed
-        char infoLog[512];
-        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
-        std::cerr << "Shader compilation failed:\n" << infoLog << "\n";
-    }
-
-    return shader;
-}
-
-// linkProgram(...)
+// Where a wanderer bounced off its area's edge, for its sound: published by the bounce
+// system's jobs. A frame's steps fill at most kBounceEvents; the rest go unheard.
+struct BounceEvent {
+    glm::vec2 at;
+};
+constexpr std::size_t kBounceEvents = 64;
+
+struct SimState {
+    World world;
+    SystemScheduler systems;
+    EntityHandle player;
+    Aabb wanderBounds{glm::vec2(-4.0f, -2.0f), glm::vec2(4.0f, 2.0f)};
+    CameraRig camera{cameraRigSettings(wanderBounds)};  // interpolated like everything else
+    CameraRig playerCamera;     // --split: the right half's, always on the player
+    CollisionStep collisions;
+    bool scaleUp = false;       // R toggles: the player entity's scale is 1.5 while set
+    float time = 0.0f;          // simulated seconds: the clock SpriteRef.start is on
+    const FlowField* flow = nullptr;  // --flow-agents: what the flow system steers by
+    FlockStep boids;
+    TimerWheel timers;          // gameplay callbacks, one tick per step (core/timer_wheel.h)
+};
+
+// Startup prefetch
 // ----------------
-// vertexShader:   ID of a compiled vertex shader (from glCreateShader + glCompileShader)
-// fragmentShader: ID of a compiled fragment shader
+// What startup needs that takes no GL context, run as jobs while the main thread creates
+// the window and the context (glfwInit, glfwCreateWindow, gladLoadGL: main-thread only,
+// and tens to hundreds of ms on some drivers):
 //
-// Purpose:
-//   - Creates a shader program object.
-//   - Attaches the provided shaders.
-//   - Links them into a single executable GPU pipeline.
-//   - Checks for link errors and logs them.
-//   - Deletes the individual shaders (they're no longer needed after linking).
+// | Job              | Produces                                          | Used by            |
+// | ---------------- | ------------------------------------------------- | ------------------ |
+// | one per program  | its preprocessed stages: file reads, #includes,   | beginProgram       |
+// |                  | defines (render/shader_build.h, prepareProgram)   |                    |
+// | atlas            | the sprite images painted, added, packed          | TextureAtlas upload|
+// | array            | the sprite array's layers painted                 | buildSpriteArray   |
 //
-// Returns: GLuint ID of the final linked shader program.
-//          Pass to glUseProgram(...) to activate it before drawing.
-
-GLuint linkProgram(GLuint vertexShader, GLuint fragmentShader) {
-    // Create a program object to link shaders into.
-    // Think of this like allocating a "pipeline object" that will represent your final shader program.
-    GLuint program = glCreateProgram();
-
-    // Attach the already compiled vertex and fragment shaders to the program.
-    // These are just attachments at this stage—the actual linking hasn't happened yet.
-    glAttachShader(program, vertexShader);
-    glAttachShader(program, fragmentShader);
-    // This doesn’t copy its contents—it’s still a reference to the original shader.
+// main waits for them (jobs.wait(counter)) just before the first GL upload that needs
+// one. A program asked for that wasn't prefetched, or whose variant changed once the
+// driver was known (--instance-fetch without texture buffers), is preprocessed then.
+struct StartupPrefetch {
+    std::vector<ProgramDesc> programs;
+    std::vector<ProgramSources> sources;  // [i]: programs[i]'s
+    TextureAtlas* atlas = nullptr;        // filled and packed; upload() is main's
+    TextureAtlas::Options atlasOptions;
+    bool atlasPacked = false;
+    std::vector<std::uint32_t> spriteLayers;
+    JobCounter counter;
+
+    void start(JobSystem& jobs) {
+        sources.resize(programs.size());
+        for (std::size_t i = 0; i < programs.size() + 2; ++i) {
+            jobs.run(&StartupPrefetch::run, this, i, i + 1, &counter);
+        }
+    }
 
-    // Link the attached shader stages into a final shader program.
-    // This performs validation, matches inputs/outputs, resolves locations, and finalizes GPU-side code.
-    glLinkProgram(program);
-    // If linking fails, it's usually because:
+    const ProgramSources* find(const ProgramDesc& desc) const {
+        for (std::size_t i = 0; i < programs.size(); ++i) {
+            const ProgramDesc& p = programs[i];
+            if (p.vertexPath == desc.vertexPath && p.fragmentPath == desc.fragmentPath &&
+                p.variant.features == desc.variant.features && p.variant.defines == desc.variant.defines &&
+                p.feedbackVaryings == desc.feedbackVaryings) {
+                return &sources[i];
+            }
+        }
+        return nullptr;
+    }
+    // The sources are compiled: nothing needs them any more.
+    void releasePrograms() {
+        programs.clear();
+        sources.clear();
+    }
 
-    // Vertex shader outputs don’t match fragment shader inputs
-    // Multiple main() definitions
-    // Using variables or functions inconsistently
+private:
+    static void run(void* context, std::size_t job, std::size_t) {
+        StartupPrefetch& self = *static_cast<StartupPrefetch*>(context);
+        const std::size_t programCount = self.programs.size();
+        if (job < programCount) {
+            self.sources[job] = prepareProgram(self.programs[job]);
+        } else if (job == programCount) {
+            buildSpriteAtlas(*self.atlas);
+            self.atlasPacked = self.atlas->pack(self.atlasOptions);
+        } else {
+            self.spriteLayers = paintSpriteLayers();
+        }
+    }
+};
+
+// A region the streamer handed out: its props straight from the mapped arrays (pages a
+// load job already faulted in), their handles kept for despawning. With `scenery`, the
+// props are baked on the render side instead (render/static_batch.h): no entities.
+void spawnLevelRegion(SimState& state, const LevelFile& level, int region, const std::vector<std::uint32_t>& sprites,
+                      std::vector<EntityHandle>& handles, std::vector<TileEdit>& tileEdits,
+                      std::vector<StaticBatchEdit>* scenery) {
+    levelRegionTiles(level, region, sprites, false, tileEdits);
+    if (scenery != nullptr) {
+        scenery->push_back(StaticBatchEdit{region, true});
+        return;
+    }
+    const LevelEntities e = level.entities(region);
+    handles.reserve(handles.size() + e.count);
+    for (std::size_t i = 0; i < e.count; ++i) {
+        const glm::vec2 p(e.x[i], e.y[i]);
+        const std::uint32_t sprite = e.asset[i] < sprites.size() ? sprites[e.asset[i]] : 0u;
+        handles.push_back(state.world.create(Position{p}, PreviousPosition{p}, Rotation{e.rotation[i]},
+                                             Scale{glm::vec2(e.scaleX[i], e.scaleY[i])}, Color{e.color[i]},
+                                             SpriteRef{sprite}, ZLayer{e.zLayer[i]}));
+    }
+}
 
-    // | Term                        | Summary 
-    // | --------------------------- | -------------------------------------------------------------------------------------------- |
-    // | **Attaching**               | Adds compiled shader stages to a program object. No validation.                              |
-    // | **Linking**                 | Finalizes the GPU pipeline by stitching stages together. Must be done before `glUseProgram`. |
-    // | When is the program usable? | **Only after linking succeeds**                                                              |
+void despawnLevelRegion(SimState& state, const LevelFile& level, int region, const std::vector<std::uint32_t>& sprites,
+                        std::vector<EntityHandle>& handles, std::vector<TileEdit>& tileEdits,
+                        std::vector<StaticBatchEdit>* scenery) {
+    for (EntityHandle handle : handles) {
+        state.world.destroy(handle);
+    }
+    handles.clear();
+    levelRegionTiles(level, region, sprites, true, tileEdits);
+    if (scenery != nullptr) {
+        scenery->push_back(StaticBatchEdit{region, false});
+    }
+}
 
-    // Shader Program Stages Summary:
-    // ------------------------------
-    // glAttachShader → Stage compiled shader(s) for linking (not usable yet)
-    // glLinkProgram  → Validate & finalize the shader pipeline (now usable)
-    // Must glUseProgram(...) after linking to activate
+// A quad the movement keys drive (through its PlayerInput): the local player, a network
+// client's on the server, or a client's own, predicted. A collider pushes the
+// wanderers and is never pushed back.
+EntityHandle spawnPlayer(World& world, std::uint32_t color, bool collider) {
+    const EntityHandle player = world.create(Position{glm::vec2(0.0f)}, PreviousPosition{glm::vec2(0.0f)},
+                                             Velocity{glm::vec2(0.0f)}, Rotation{0.0f}, Scale{glm::vec2(1.0f)},
+                                             Color{color}, SpriteRef{0}, ZLayer{kPlayerZLayer},
+                                             Controllable{gameConfig.playerSpeed}, PlayerInput{0});
+    if (collider) {
+        world.add(player, Collider{0.0f});
+    }
+    return player;
+}
 
+// --entities=N: N quads drifting around wanderBounds (deterministic LCG layout). With
+// `colliders` they bounce off each other too, heavier the bigger they are. `animated`:
+// each plays one of the sprite clips, from its own point in it, at its own speed.
+void spawnWanderers(SimState& state, int count, bool colliders, bool animated) {
+    std::uint32_t rng = 1234u;
+    auto next = [&rng] { // [0, 1)
+        rng = rng * 1664525u + 1013904223u;
+        return static_cast<float>(rng >> 8) * (1.0f / 16777216.0f);
+    };
+    const glm::vec2 extent = state.wanderBounds.max - state.wanderBounds.min;
+    for (int i = 0; i < count; ++i) {
+        const glm::vec2 p = state.wanderBounds.min + glm::vec2(next(), next()) * extent;
+        const float scale = 0.05f + 0.1f * next();
+        const glm::vec2 velocity(next() - 0.5f, next() - 0.5f);
+        const float rotation = next() * 6.2831853f;
+        const float alpha = i % 4 == 3 ? 0.6f : 1.0f;
+        const glm::vec4 color(next(), next(), 1.0f, alpha);
+        SpriteRef sprite{1u + static_cast<std::uint32_t>(i) % kSpriteShapes};
+        if (animated) {
+            sprite.id = animatedSprite(static_cast<std::uint32_t>(i) % kSpriteClips);
+            sprite.start = state.time - next();
+            sprite.rate = 0.5f + next();
+        }
+        const EntityHandle wanderer = state.world.create(
+            Position{p}, PreviousPosition{p}, Velocity{velocity}, Rotation{rotation}, Scale{glm::vec2(scale)},
+            Color{packColor(color)}, sprite,
+            ZLayer{static_cast<std::uint16_t>(i % kWandererZLayers)}, BounceArea{state.wanderBounds});
+        if (colliders) {
+            state.world.add(wanderer, Collider{1.0f / (scale * scale)});   // mass ~ area
+        }
+    }
+}
 
-    // Check whether the program linking was successful.
-    int success;
-    glGetProgramiv(program, GL_LINK_STATUS, &success); // similar to Shaderiv
+// --turn-timers: every wanderer turns around now and then, each on its own repeating
+// timer (2 to 6 seconds) in the sim's TimerWheel: no per-entity countdown, a step only
+// pays for the turns due in it. A wanderer that is gone leaves its timer a no-op.
+void scheduleWandererTurns(SimState& state) {
+    std::uint32_t rng = 0x3c6ef372u;
+    std::vector<EntityHandle> wanderers;
+    state.world.forEachChunkWithHandles<BounceArea>([&wanderers](std::size_t n, const EntityHandle* h, BounceArea*) {
+        wanderers.insert(wanderers.end(), h, h + n);
+    });
+    for (const EntityHandle wanderer : wanderers) {
+        rng = rng * 1664525u + 1013904223u;
+        const std::uint64_t interval = static_cast<std::uint64_t>(kSimulationHz) * 2 + (rng >> 8) % 241u;
+        World& world = state.world;
+        state.timers.schedule(interval, [&world, wanderer] {
+            if (Velocity* v = world.get<Velocity>(wanderer)) {
+                v->value = -v->value;
+            }
+        }, interval);
+    }
+}
 
-    // If linking failed, retrieve the error log from the GPU and output it to the console.
-    if (!success) {
-        char infoLog[512]; // Stores any linker output (errors, warnings, etc.)
-        glGetProgramInfoLog(program, 512, nullptr, infoLog);
-        std::cerr << "Shader linking failed:\n" << infoLog << '\n';
+// --boids=N: N small quads flocking over wanderBounds (core/boids.h), from random
+// positions and headings; each a little faster or slower than the next.
+void spawnBoids(SimState& state, int count) {
+    std::uint32_t rng = 0x51ed270bu;
+    auto next = [&rng] { // [0, 1)
+        rng = rng * 1664525u + 1013904223u;
+        return static_cast<float>(rng >> 8) * (1.0f / 16777216.0f);
+    };
+    Flock::Settings settings = state.boids.flock.settings();
+    settings.bounds = state.wanderBounds;
+    state.boids.flock.setSettings(settings);
+    const glm::vec2 extent = state.wanderBounds.max - state.wanderBounds.min;
+    for (int i = 0; i < count; ++i) {
+        const glm::vec2 p = state.wanderBounds.min + glm::vec2(next(), next()) * extent;
+        const float heading = next() * 6.2831853f;
+        const float speed = 0.6f + 0.4f * next();
+        const glm::vec2 velocity = glm::vec2(std::cos(heading), std::sin(heading)) * speed;
+        const glm::vec4 color(0.9f, 0.8f + 0.2f * next(), 0.3f, 1.0f);
+        state.world.create(Position{p}, PreviousPosition{p}, Velocity{velocity}, Rotation{heading},
+                           Scale{glm::vec2(0.06f)}, Color{packColor(color)}, SpriteRef{3},
+                           ZLayer{static_cast<std::uint16_t>(i % kWandererZLayers)}, Boid{speed});
     }
+}
 
-    // Once linked, the individual shaders are no longer needed.
-    // The GPU retains the compiled logic inside the program, and the original shader objects can be deleted.
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+// Systems
+// -------
+// Each is one loop per chunk over plain arrays (see ecs/components.h for who reads what),
+// with the chunks spread across the job system's threads (ecs/parallel.h).
 
-    // Return the program ID so it can be used with glUseProgram(...) in rendering.
-    return program;
+// Start of a step: remember positions so rendering can interpolate.
+void snapshotSystem(World& world, JobSystem& jobs) {
+    parallelForEachChunk<Position, PreviousPosition>(world, jobs, [](std::size_t n, Position* p, PreviousPosition* prev) {
+        for (std::size_t i = 0; i < n; ++i) {
+            prev[i].value = p[i].value;
+        }
+    });
 }
 
+// A player's velocity for a step's actions: bit tests on the mask, no glfwGetKey calls.
+// Also what a network client predicts its own player with (net/prediction.h).
+glm::vec2 moveVelocity(ActionMask actions, float speed) {
+    auto axis = [actions](ActionId negative, ActionId positive) {
+        return static_cast<float>((actions >> positive) & 1u) - static_cast<float>((actions >> negative) & 1u);
+    };
+    const float sprint = ((actions >> Sprint) & 1u) ? gameConfig.sprint : 1.0f;
+    return glm::vec2(axis(MoveLeft, MoveRight), axis(MoveDown, MoveUp)) * (speed * sprint);
+}
 
-int main() {
-    // Attempt to initialize GLFW
-    if(!glfwInit()){
-        std::cerr << "Failed to initialize GLFW. Exiting\n";
-        return -1;
-    }
-    
-    // Successful windowing initialization
-    
-    // Specify the OpenGL version and profile to request from the driver.
-    // Must match (or be below) what GLAD was generated for (e.g., 3.3 Core).
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3); // Specifies OpenGL 3.x
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3); // Specifies OpenGL x.3
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE); // OpenGL Core
-
-    // GLFW will then ask the OS/driver to create a compatible OpenGL context.
+// Input → velocity (and the R toggle → scale) for every controllable entity, each by its
+// own PlayerInput: the keys for the local player, the network's for a client's.
+void movementSystem(World& world, JobSystem& jobs, bool scaleUp) {
+    const glm::vec2 scale(scaleUp ? 1.5f : 1.0f);
+    parallelForEachChunk<Controllable, PlayerInput, Velocity, Scale>(
+        world, jobs, [&](std::size_t n, Controllable* c, PlayerInput* input, Velocity* v, Scale* s) {
+            for (std::size_t i = 0; i < n; ++i) {
+                v[i].value = moveVelocity(input[i].actions, c[i].speed);
+                s[i].value = scale;
+            }
+        });
+}
 
-    // Window creation
-    // Create an 800x600 window with title "GL Triangle Window"
-    // last two args are for context sharing between windows - not needed here
-    // Function call also creates an OpenGL context associated with the window.
-    GLFWwindow* window = glfwCreateWindow(1000, 1000, "GL Triangle Window", nullptr, nullptr);
+void integrateSystem(World& world, JobSystem& jobs, float dt) {
+    parallelForEachChunk<Position, Velocity>(world, jobs, [dt](std::size_t n, Position* p, Velocity* v) {
+        for (std::size_t i = 0; i < n; ++i) {
+            p[i].value += v[i].value * dt;
+        }
+    });
+}
 
-    if(!window){
-        std::cerr << "Failed to create GLFW window\n";
-        glfwTerminate(); // shut down GLFW cleanly.
-        return -1;
+// The quad mesh's corners are at ±0.25, times Scale.
+constexpr float kQuadHalfSize = 0.25f;
+
+// Colliders pushed apart: their boxes gathered into arrays, the broadphase's pairs
+// (sweep and prune, core/sweep_and_prune.h) split into islands and resolved by the
+// narrowphase on the workers (core/collision.h), positions and velocities written back.
+// Bit-exact whatever the worker count. Boxes ignore Rotation.
+void collisionSystem(World& world, JobSystem& jobs, CollisionStep& step) {
+    const std::size_t rows = collectChunks(world, step.chunks);
+    step.bodies.resize(rows);
+    step.broadphase.resize(rows);
+    step.pairs.clear();
+    step.contacts = 0;
+    if (rows == 0) {
+        return;
     }
-
-    glfwSetFramebufferSizeCallback(window, [](GLFWwindow*, int width, int height) {
-        glViewport(0, 0, width, height);
+    CollisionBodies& b = step.bodies;
+    // Each row writes its own index of every array (the broadphase's too): no locks.
+    jobs.parallelFor(step.chunks.size(), 4, [&step, &b](std::size_t begin, std::size_t end) {
+        for (std::size_t c = begin; c < end; ++c) {
+            const auto& span = step.chunks[c];
+            const auto [p, v, s, collider] = span.arrays;
+            for (std::size_t i = 0, k = span.first; i < span.count; ++i, ++k) {
+                b.x[k] = p[i].value.x;
+                b.y[k] = p[i].value.y;
+                b.vx[k] = v[i].value.x;
+                b.vy[k] = v[i].value.y;
+                b.halfX[k] = kQuadHalfSize * std::fabs(s[i].value.x);
+                b.halfY[k] = kQuadHalfSize * std::fabs(s[i].value.y);
+                b.inverseMass[k] = collider[i].inverseMass;
+                step.broadphase.update(static_cast<ObjectId>(k), b.bounds(k));
+            }
+        }
     });
-    
-    // Callback Function (Resize Handling)
-    // -----------------------------------
-    // What is a callback?
-    // - A function that YOU write, but GLFW (or any system) calls LATER when an event happens.
-    // - You don’t call this function manually—it’s run automatically when GLFW detects a matching event.
-    //
-    // Who decides when the callback runs?
-    // - GLFW does. You simply *register* the function (with glfwSetFramebufferSizeCallback),
-    //   and GLFW calls it every time the framebuffer size changes (e.g., on window resize).
-    //
-    // What does this callback do?
-    // - It receives the new width and height of the framebuffer.
-    // - We then call glViewport(...) to tell OpenGL to match the new window size.
-    // - Without this, OpenGL would keep drawing to the old viewport and not scale with the window.
+    step.broadphase.findPairs(step.pairs);
+    step.islands.build(b, step.pairs.data(), step.pairs.size());
+    step.contacts = resolveContactsParallel(jobs, b, step.pairs.data(), step.islands);
+    jobs.parallelFor(step.chunks.size(), 4, [&step, &b](std::size_t begin, std::size_t end) {
+        for (std::size_t c = begin; c < end; ++c) {
+            const auto& span = step.chunks[c];
+            const auto [p, v, s, collider] = span.arrays;
+            for (std::size_t i = 0, k = span.first; i < span.count; ++i, ++k) {
+                p[i].value = glm::vec2(b.x[k], b.y[k]);
+                v[i].value = glm::vec2(b.vx[k], b.vy[k]);
+            }
+        }
+    });
+}
 
-    // Make OGL context active
-    // Essentially signals to OGL: "all OpenGL function calls in this thread affect this specific window"
-    glfwMakeContextCurrent(window);
+// Reflect velocities that point further out of the entity's area.
+void bounceSystem(World& world, JobSystem& jobs, EventBus& bus) {
+    parallelForEachChunk<Position, Velocity, BounceArea>(world, jobs, [&bus](std::size_t n, Position* p, Velocity* v, BounceArea* b) {
+        for (std::size_t i = 0; i < n; ++i) {
+            const glm::vec2 pos = p[i].value;
+            glm::vec2& vel = v[i].value;
+            const Aabb& area = b[i].area;
+            const glm::vec2 before = vel;
+            if ((pos.x < area.min.x && vel.x < 0.0f) || (pos.x > area.max.x && vel.x > 0.0f)) vel.x = -vel.x;
+            if ((pos.y < area.min.y && vel.y < 0.0f) || (pos.y > area.max.y && vel.y > 0.0f)) vel.y = -vel.y;
+            if (vel != before) {
+                bus.publish(BounceEvent{pos});
+            }
+        }
+    });
+}
 
-    // Load OpenGL functions with GLAD
-    // gladLoadGL uses the active context defined in the previous step
-    if(!gladLoadGL()){
-        std::cerr << "Failed to initialize GLAD\n";
-        glfwDestroyWindow(window); // cleaner to explicitly call
-        glfwTerminate(); // typically includes DestroyWindow
-        return -1;
+// FlowFollowers: velocity down the flow field, one lookup each; stopped on the goal's
+// tile, or where there is no field (yet) or no way.
+void flowSystem(World& world, JobSystem& jobs, const FlowField* field) {
+    if (field == nullptr) {
+        return;
     }
+    parallelForEachChunk<Position, FlowFollower, Velocity>(world, jobs, [field](std::size_t n, Position* p,
+                                                                              FlowFollower* f, Velocity* v) {
+        for (std::size_t i = 0; i < n; ++i) {
+            v[i].value = field->direction(p[i].value) * f[i].speed;
+        }
+    });
+}
 
-    // Set default background colour of framebuffer. Tells OGL to use this colour next clear.
-    // This ONLY sets the colour - it doesn't perform any colouring action.
-    glClearColor(0.2f, 0.3f, 0.3f, 1.0f); // Dark teal
-
-    // Set up triangle, shader objects, and load and link shaders
-
-    float vertices[] = {
-
-        -0.25f, -0.25f,  // bottom-left corner (0)
-        0.25f, -0.25f,  // bottom-right corner (1)
-        0.25f,  0.25f,  // top-right corner (2)
-        -0.25f,  0.25f   // top-left corner (3)
-
-    };
-
-    // For use with glDrawElements (more useful for my game):
-    unsigned int indices[] = {
-        0, 1, 2,  // draw triangle using vertex 0 → 1 → 2
-        2, 3, 0
-    };
+// Boids: gathered into the Flock's arrays, steered there (core/boids.h), and only their
+// velocities written back; integrate moves them.
+void boidsSystem(World& world, JobSystem& jobs, FlockStep& step, float dt) {
+    const std::size_t rows = collectChunks(world, step.chunks);
+    if (rows == 0) {
+        return;
+    }
+    Flock& f = step.flock;
+    f.resize(rows);
+    jobs.parallelFor(step.chunks.size(), 4, [&step, &f](std::size_t begin, std::size_t end) {
+        for (std::size_t c = begin; c < end; ++c) {
+            const auto& span = step.chunks[c];
+            const auto [p, v, b] = span.arrays;
+            for (std::size_t i = 0, k = span.first; i < span.count; ++i, ++k) {
+                f.x[k] = p[i].value.x;
+                f.y[k] = p[i].value.y;
+                f.vx[k] = v[i].value.x;
+                f.vy[k] = v[i].value.y;
+                f.maxSpeed[k] = b[i].maxSpeed;
+            }
+        }
+    });
+    f.step(jobs, dt);
+    jobs.parallelFor(step.chunks.size(), 4, [&step, &f](std::size_t begin, std::size_t end) {
+        for (std::size_t c = begin; c < end; ++c) {
+            const auto& span = step.chunks[c];
+            Velocity* v = std::get<1>(span.arrays);
+            for (std::size_t i = 0, k = span.first; i < span.count; ++i, ++k) {
+                v[i].value = glm::vec2(f.vx[k], f.vy[k]);
+            }
+        }
+    });
+}
 
-    float xOffset= 0.0f, yOffset = 0.0f;
-    glm::vec2 cameraPos = glm::vec2(0.0f, 0.0f);
+void registerSystems(SimState& state, JobSystem& jobs) {
+    state.systems.add("snapshot", [&jobs](World& w, float) { snapshotSystem(w, jobs); });
+    state.systems.add("movement", [&jobs, &state](World& w, float) { movementSystem(w, jobs, state.scaleUp); });
+    state.systems.add("flow", [&jobs, &state](World& w, float) { flowSystem(w, jobs, state.flow); });
+    state.systems.add("boids", [&jobs, &state](World& w, float dt) { boidsSystem(w, jobs, state.boids, dt); });
+    state.systems.add("integrate", [&jobs](World& w, float dt) { integrateSystem(w, jobs, dt); });
+    state.systems.add("collide", [&jobs, &state](World& w, float) { collisionSystem(w, jobs, state.collisions); });
+    state.systems.add("bounce", [&jobs, &state](World& w, float) { bounceSystem(w, jobs, events); });
+}
 
-    
-    // Create VAO (vertex array object)
-    // Create and bind VAO BEFORE VBO bind, binding VAO "starts recording state"
-    unsigned int VAO;
-    glGenVertexArrays(1, &VAO);
-    glBindVertexArray(VAO); 
+// Camera movement, after the player moved: following it has no step of lag. Also run
+// for the steps that rewind instead of simulating.
+void stepCameras(SimState& state, const InputState& keys, float dt) {
+    CameraRig::Controls controls;
+    const float speed = gameConfig.cameraSpeed * (keys.active(Sprint) ? gameConfig.cameraSprint : 1.0f);
+    controls.pan = glm::vec2(keys.axis(CameraLeft, CameraRight), keys.axis(CameraDown, CameraUp)) * speed;
+    controls.zoom = keys.axis(ZoomOut, ZoomIn);
+    const Position* player = state.world.get<Position>(state.player);
+    if (cameraFollow && player) {
+        controls.follow = &player->value;
+    }
+    state.camera.step(controls, dt);
+    if (player) {
+        CameraRig::Controls follow;
+        follow.follow = &player->value;
+        state.playerCamera.step(follow, dt);
+    }
+}
 
-    unsigned int VBO;                       // vertex buffer object
-    glGenBuffers(1, &VBO);                  // Generate 1 buffer
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);     // Bind it as a vertex buffer
-    
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW); // This 
-    unsigned int EBO;
-    glGenBuffers(1, &EBO);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-
-    glVertexAttribPointer(
-        0,                  // attribute location (in vertex shader)
-        2,                  // number of components (x, y)
-        GL_FLOAT,           // data type
-        GL_FALSE,           // normalize?
-        2 * sizeof(float),  // stride (bytes between vertices)
-        (void*)0            // offset into data
-    );
-
-    glEnableVertexAttribArray(0);
+void updateSimulation(SimState& state, const InputState& keys, float dt) {
+    if (PlayerInput* input = state.world.get<PlayerInput>(state.player)) {
+        input->actions = keys.actions();
+    }
+    state.timers.advance();         // what is due this step, before the systems see it
+    state.systems.run(state.world, dt);
+    stepCameras(state, keys, dt);
+    state.time += dt;
+}
 
-    
-    // Load shader sources
-    std::string vertexSrc = loadShaderSource("shaders/vertex.glsl");
-    std::string fragmentSrc = loadShaderSource("shaders/fragment.glsl");
-    
-    // Compile individual shaders
-    GLuint vertexShader = compileShader(vertexSrc.c_str(), GL_VERTEX_SHADER);
-    GLuint fragmentShader = compileShader(fragmentSrc.c_str(), GL_FRAGMENT_SHADER);
+// A network client's step of its own player: what the movement and integrate systems
+// would do to it, and nothing else (the rest of its World is the server's). Returns the
+// new position.
+glm::vec2 predictPlayer(SimState& state, ActionMask actions, float dt) {
+    Position* p = state.world.get<Position>(state.player);
+    PreviousPosition* previous = state.world.get<PreviousPosition>(state.player);
+    const Controllable* c = state.world.get<Controllable>(state.player);
+    previous->value = p->value;
+    p->value += moveVelocity(actions, c->speed) * dt;
+    if (Scale* s = state.world.get<Scale>(state.player)) {
+        s->value = glm::vec2(state.scaleUp ? 1.5f : 1.0f);
+    }
+    return p->value;
+}
 
-    // Link them into a program
-    GLuint shaderProgram = linkProgram(vertexShader, fragmentShader);
+// Game sounds (audio/mixer.h), generated at start-up like the sprites.
+struct GameSounds {
+    static constexpr int kTocks = 4;
+    SoundId tocks[kTocks] = {};        // bounces, a few pitches so a crowd isn't one note
+    SoundId blip = 0;                  // a pick
+};
+
+GameSounds addGameSounds(AudioMixer& audio, int rate) {
+    GameSounds sounds;
+    for (int k = 0; k < GameSounds::kTocks; ++k) {
+        sounds.tocks[k] = audio.add(synthTock(rate, 330.0f * std::pow(1.26f, static_cast<float>(k))));
+    }
+    sounds.blip = audio.add(synthBlip(rate, 880.0f));
+    return sounds;
+}
 
-    // Everything is now ready, enter draw loop.
-    // Main game/render loop, runs until close button is pressed or glfwSetWindowShouldClose(window, true) is called
+// A frame's bounces, each one play() onto the mixer's ring: panned by where it is across
+// the view, quieter the further off-centre, silent well outside it.
+void playBounceSounds(AudioMixer& audio, const GameSounds& sounds, const BounceEvent* bounces, std::size_t count,
+                      const glm::vec2& cameraPos, const glm::vec2& halfExtent) {
+    for (std::size_t i = 0; i < count; ++i) {
+        const glm::vec2 offset = (bounces[i].at - cameraPos) / halfExtent;
+        const float distance = glm::length(offset);
+        if (distance > 1.5f) {
+            continue;
+        }
+        const float gain = 0.2f * (1.0f - distance / 1.5f);
+        audio.play(sounds.tocks[i % GameSounds::kTocks], gain, glm::clamp(offset.x, -1.0f, 1.0f));
+    }
+}
+// --path-agents: the tiles' walkability for a PathService (core/path_service.h), the
+// map the tilemap draws: layer 0 is floor, anything on an upper layer blocks. A level's
+// and a --procgen world's start open and follow their chunks' tile edits; the generated
+// map's is filled here.
+bool buildPathGrid(PathGrid& grid, const LevelFile& level, const WorldGenerator* world) {
+    PathGrid::Options options;
+    if (level.isOpen() && level.header().tilesPerRegion > 0) {
+        const LevelHeader& header = level.header();
+        options.width = level.tilesX();
+        options.height = level.tilesY();
+        options.tileSize = header.regionSize / header.tilesPerRegion;
+        options.origin = glm::vec2(header.originX, header.originY);
+        return grid.init(options);
+    }
+    if (world) {
+        options.width = world->settings().width;
+        options.height = world->settings().height;
+        options.tileSize = world->settings().tileSize;
+        options.origin = world->settings().origin;
+        return grid.init(options);
+    }
+    options.width = options.height = kTilemapSize;
+    options.tileSize = Tilemap::Options{}.tileSize;
+    options.origin = glm::vec2(-0.5f * options.tileSize * kTilemapSize);
+    if (!grid.init(options)) {
+        return false;
+    }
+    for (int y = 0; y < kTilemapSize; ++y) {
+        for (int x = 0; x < kTilemapSize; ++x) {
+            grid.setTile(1, x, y, generatedTile(1, x, y) != Tilemap::kEmpty);
+        }
+    }
+    grid.rebuild();
+    return true;
+}
 
-    // Start time measure
-    float lastFrameTime = glfwGetTime(); // seconds
+// --orbiters=N
+// ------------
+// A TransformHierarchy (core/transform_hierarchy.h) hung on the player: a spinning hub,
+// N satellites around it and a moon around each satellite, drawn with the world's quads.
+//
+//     root (the player) ─► hub (turns) ─► satellite × N ─► moon
+//
+// Each frame sets two locals—the root's position, the hub's angle—and update() carries
+// them down, one pass per level. Only the root and the hub are ever set: the satellites'
+// and moons' locals never change, their world transforms follow their parents.
+struct Orbiters {
+    TransformHierarchy tree;
+    TransformHierarchy::NodeId root = TransformHierarchy::kNone;
+    TransformHierarchy::NodeId hub = TransformHierarchy::kNone;
+    float angle = 0.0f;
+
+    void init(int count) {
+        root = tree.create();
+        hub = tree.create(root);
+        for (int i = 0; i < count; ++i) {
+            const float a = 6.2831853f * static_cast<float>(i) / static_cast<float>(count);
+            LocalTransform2D satellite;
+            satellite.position = 0.4f * glm::vec2(std::cos(a), std::sin(a));
+            satellite.rotation = a;
+            satellite.scale = glm::vec2(0.25f);
+            LocalTransform2D moon;
+            moon.position = glm::vec2(0.9f, 0.0f);   // in the satellite's (scaled) frame
+            moon.scale = glm::vec2(0.4f);
+            tree.create(tree.create(hub, satellite), moon);
+        }
+    }
 
-    glfwSetKeyCallback(window, keyCallback);
-    // glfwSetCursorPosCallback(window, cursorPositionCallback);
+    void update(const glm::vec2& center, float dt, JobSystem& jobs) {
+        angle += 1.5f * dt;
+        LocalTransform2D r;
+        r.position = center;
+        tree.setLocal(root, r);
+        LocalTransform2D h;
+        h.rotation = angle;
+        tree.setLocal(hub, h);
+        tree.update(&jobs);
+    }
 
-    while (!glfwWindowShouldClose(window)) {
-        float currentFrameTime = glfwGetTime();
-        float deltaTime = currentFrameTime - lastFrameTime;
-        lastFrameTime = currentFrameTime;
-        glClear(GL_COLOR_BUFFER_BIT);     // Clear the screen to the background color
-        // GL_COLOR_BUFFER_BIT is a bitmask constant that tells OpenGL to clear the color buffer
-        // using the value previously set with glClearColor().
-        
-        // Input polling
-        if(!isPaused){
-            float speed = 1.0f;
-            if(glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS){
-                speed = 2.0f;
+    // Every node below the hub (depth order: the root and the hub are the first two),
+    // appended to the arrays the packet's path reads.
+    void appendTo(FramePacket& packet) const {
+        const std::uint32_t color = packColor(glm::vec4(0.6f, 0.8f, 1.0f, 1.0f));
+        for (std::size_t i = 2; i < tree.size(); ++i) {
+            const Affine2D world = relativeAffine2D(tree.worlds()[i], packet.origin);
+            if (packet.path == FramePacket::Path::Layered) {
+                packet.affine.push_back(world);
+                packet.zLayers.push_back(kPlayerZLayer);
+            } else {
+                packet.models.push_back(fromAffine2D(world));
             }
-            if(glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS){
-                // left key pressed
-                xOffset = xOffset - speed * deltaTime;
+            if (packet.path != FramePacket::Path::Instanced) {
+                packet.sprites.push_back(1);              // a disc
             }
-            if(glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS){
-                // right key pressed
-                xOffset = xOffset + speed * deltaTime;
+            if (!packet.animations.empty()) {
+                packet.animations.push_back(glm::vec2(0.0f));
             }
-
-            if(glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS){
-                // up key pressed
-                yOffset = yOffset + speed * deltaTime;
-            }
-            if(glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS){
-                // down key pressed
-                yOffset = yOffset - speed * deltaTime;
+            packet.colors.push_back(color);
+        }
+    }
+};
+
+// --critters=N
+// ------------
+// N copies of one rig—a body and four three-segment arms—scattered over wanderBounds, each
+// waving the same clip at its own phase and speed. SkeletonPoses (core/skeleton_2d.h)
+// poses all of them as one batch on the job system; SkinnedMeshRenderer draws them all with
+// one instanced draw, the GPU bending the shared mesh by each critter's palette.
+//
+//     body ─► arm × 4 ─► segment ─► segment ─► segment (the tip)
+//
+// The mesh is built in the bind pose: an octagon on the body, and per arm a strip whose
+// joints are shared half and half by the segments either side of them, so arms bend
+// instead of breaking.
+struct Critters {
+    static constexpr int kArms = 4;
+    static constexpr int kSegments = 3;
+    static constexpr float kBody = 0.1f;      // body radius, where the arms start
+    static constexpr float kSegment = 0.08f;  // segment length
+
+    Skeleton2D skeleton;
+    SkeletonPoses poses;
+    std::vector<SkinnedVertex> vertices;
+    std::vector<std::uint16_t> indices;
+
+    void init(int count, const Aabb& bounds) {
+        const float twoPi = 6.2831853f;
+        const int body = skeleton.addBone(-1, LocalTransform2D{});
+        int first[kArms];
+        for (int a = 0; a < kArms; ++a) {
+            const float angle = 0.7853982f + static_cast<float>(a) * 1.5707963f;
+            LocalTransform2D root;
+            root.position = kBody * glm::vec2(std::cos(angle), std::sin(angle));
+            root.rotation = angle;
+            int bone = skeleton.addBone(body, root);
+            first[a] = bone;
+            LocalTransform2D segment;
+            segment.position = glm::vec2(kSegment, 0.0f);
+            for (int s = 1; s < kSegments; ++s) {
+                bone = skeleton.addBone(bone, segment);
             }
+        }
 
-            // Camera movement
-            if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) {
-                cameraPos.x -= speed * deltaTime;
-            }
-            if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS) {
-                cameraPos.x += speed * deltaTime;
+        constexpr int kKeys = 8;
+        SkeletonClip2D clip;
+        clip.duration = 1.2f;
+        clip.keys = kKeys;
+        clip.rotations.resize(skeleton.size() * kKeys);
+        for (int k = 0; k < kKeys; ++k) {
+            const float phase = twoPi * static_cast<float>(k) / kKeys;
+            clip.rotations[static_cast<std::size_t>(body) * kKeys + k] = 0.15f * std::sin(phase);
+            for (int a = 0; a < kArms; ++a) {
+                for (int s = 0; s < kSegments; ++s) {
+                    const std::size_t bone = static_cast<std::size_t>(first[a] + s);
+                    clip.rotations[bone * kKeys + k] =
+                        0.5f * (0.6f + 0.2f * s) * std::sin(phase - 0.9f * s + 1.5707963f * a);
+                }
             }
-            if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) {
-                cameraPos.y += speed * deltaTime;
-            }
-            if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) {
-                cameraPos.y -= speed * deltaTime;
-            }
-        }
-        // Using GLM, we just send the transformation matrix to the GPU. The shader code
-        // already applies the model transformation matrix (which, when run in the shader
-        // code, will contain all the transformations we wish to apply when constructed
-        // and composed correctly), so it just needs to be sent after composed.
-        glm::mat4 model = glm::mat4(1.0f); // identity matrix
-        model = glm::translate(model, glm::vec3(xOffset, yOffset, 0.0f)); // move by offset
-        // float angle = xOffset;
-        // model = glm::rotate(model, angle, glm::vec3(0.0f, 0.0f, 1.0f));
-        if(scaleUp){
-            model = glm::scale(model, glm::vec3(1.5f, 1.5f, 1.0f));
         }
 
-        
-        glfwGetFramebufferSize(window, &width, &height);
-        float aspect = static_cast<float>(width) / height;
-
-        glm::mat4 projection;
-        if (useOrtho) {
-            projection = glm::ortho(-aspect, aspect, -1.0f, 1.0f);
-        } else {
-            projection = glm::perspective(glm::radians(45.0f), aspect, 0.1f, 100.0f);
+        // The body: a fan of 8 around its centre.
+        const std::uint32_t bodyColor = packColor(glm::vec4(0.95f, 0.55f, 0.3f, 1.0f));
+        const std::uint32_t armColor = packColor(glm::vec4(0.9f, 0.75f, 0.35f, 1.0f));
+        vertices.push_back({glm::vec2(0.0f), {0, 0}, 255, 0, bodyColor});
+        for (int i = 0; i < 8; ++i) {
+            const float angle = twoPi * static_cast<float>(i) / 8.0f;
+            vertices.push_back({1.15f * kBody * glm::vec2(std::cos(angle), std::sin(angle)), {0, 0}, 255, 0,
+                                bodyColor});
+            indices.insert(indices.end(), {0, static_cast<std::uint16_t>(1 + i),
+                                           static_cast<std::uint16_t>(1 + (i + 1) % 8)});
         }
-
-        glm::mat4 view;
-        if (useOrtho) {
-            // translate(identity, -cameraPos.x, -cameraPos.y, z=0.0f)
-            view = glm::translate(glm::mat4(1.0f), glm::vec3(-cameraPos, 0.0f));
-        } else {
-            view = glm::lookAt(
-                glm::vec3(0.0f, 0.0f, 3.0f),  // camera position
-                glm::vec3(0.0f, 0.0f, 0.0f),  // look at origin
-                glm::vec3(0.0f, 1.0f, 0.0f)   // up direction
-            );
+        // Each arm: pairs of vertices every half segment, from the body out to the tip.
+        for (int a = 0; a < kArms; ++a) {
+            const float angle = 0.7853982f + static_cast<float>(a) * 1.5707963f;
+            const glm::vec2 along(std::cos(angle), std::sin(angle));
+            const glm::vec2 across(-along.y, along.x);
+            constexpr int kSteps = 2 * kSegments + 1;
+            for (int i = 0; i < kSteps; ++i) {
+                const float t = 0.5f * static_cast<float>(i);     // in segments
+                const float width = 0.035f * (1.0f - t / 3.5f);
+                const glm::vec2 center = (kBody + t * kSegment) * along;
+                const int segment = i / 2;                        // the one this step starts
+                std::uint8_t bones[2];
+                std::uint8_t weight = 255;
+                if (i % 2 == 1) {                                 // a midpoint: its segment's alone
+                    bones[0] = bones[1] = static_cast<std::uint8_t>(first[a] + segment);
+                } else if (segment == kSegments) {                // the tip: the last segment's
+                    bones[0] = bones[1] = static_cast<std::uint8_t>(first[a] + kSegments - 1);
+                } else {                                          // a joint: shared with the one before
+                    bones[0] = static_cast<std::uint8_t>(segment == 0 ? body : first[a] + segment - 1);
+                    bones[1] = static_cast<std::uint8_t>(first[a] + segment);
+                    weight = 128;
+                }
+                const std::uint16_t base = static_cast<std::uint16_t>(vertices.size());
+                vertices.push_back({center + width * across, {bones[0], bones[1]}, weight, 0, armColor});
+                vertices.push_back({center - width * across, {bones[0], bones[1]}, weight, 0, armColor});
+                if (i > 0) {
+                    indices.insert(indices.end(), {static_cast<std::uint16_t>(base - 2),
+                                                   static_cast<std::uint16_t>(base - 1), base,
+                                                   static_cast<std::uint16_t>(base - 1),
+                                                   static_cast<std::uint16_t>(base + 1), base});
+                }
+            }
         }
 
-        glm::mat4 MVP = projection * view * model;
+        // A grid over the bounds, each critter turned, sized and phased by an LCG.
+        const std::size_t n = static_cast<std::size_t>(count);
+        poses.init(skeleton, clip, n);
+        const int columns = std::max(1, static_cast<int>(std::ceil(std::sqrt(static_cast<float>(count)))));
+        const int rows = (count + columns - 1) / columns;
+        const glm::vec2 cell = (bounds.max - bounds.min) / glm::vec2(columns, rows);
+        std::uint32_t seed = 0x2545f491u;
+        const auto next = [&seed]() {
+            seed = seed * 1664525u + 1013904223u;
+            return static_cast<float>(seed >> 8) / 16777216.0f;
+        };
+        Transforms2D& placed = poses.placements();
+        for (std::size_t c = 0; c < n; ++c) {
+            const int column = static_cast<int>(c) % columns;
+            const int row = static_cast<int>(c) / columns;
+            const glm::vec2 p = bounds.min + cell * glm::vec2(column + 0.5f, row + 0.5f);
+            placed.x[c] = p.x;
+            placed.y[c] = p.y;
+            placed.rotation[c] = twoPi * next();
+            const float scale = 0.8f + 0.5f * next();
+            placed.scaleX[c] = scale;
+            placed.scaleY[c] = scale;
+            poses.setPlayback(c, clip.duration * next(), 0.7f + 0.6f * next());
+        }
+    }
 
-        currentMVP = MVP;
+    void update(float time, JobSystem& jobs) { poses.evaluate(time, &jobs); }
 
-        glfwSetMouseButtonCallback(window, [](GLFWwindow* window, int button, int action, int mods) {
-            if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS) {
-                double mouseX, mouseY;
-                glfwGetCursorPos(window, &mouseX, &mouseY);
+    void appendTo(FramePacket& packet) const {
+        packet.skinPalette.assign(poses.palette(), poses.palette() + poses.paletteSize());
+        packet.skinBones = static_cast<std::uint32_t>(poses.bones());
+        packet.skinCharacters = static_cast<std::uint32_t>(poses.characters());
+    }
+};
+
+// --path-agents=N
+// ---------------
+// N discs walking the tile map from one random open tile to another, on paths the
+// PathService finds on the workers. An agent with no path asks for one and stands still
+// until its callback brings it (a frame or two); then each frame points its Velocity at
+// the next waypoint and the integrate system walks it there.
+struct PathAgents {
+    static constexpr float kSpeed = 1.2f;      // world units per second
+    static constexpr std::size_t kAgentsPerSlice = 256;
+
+    struct Agent {
+        EntityHandle entity;
+        std::vector<glm::vec2> path;
+        std::size_t next = 0;
+        bool waiting = false;
+    };
+    std::vector<Agent> agents;
+    std::size_t cursor = 0;                    // the next agent of the pass in progress
+    std::uint32_t rng = 0x2f6b1e35u;
+
+    glm::vec2 randomOpenTile(const PathGrid& grid) {
+        const PathGrid::Options& o = grid.options();
+        int x = 0, y = 0;
+        for (int attempt = 0; attempt < 16; ++attempt) {
+            rng = rng * 1664525u + 1013904223u;
+            x = static_cast<int>((rng >> 8) % static_cast<std::uint32_t>(o.width));
+            rng = rng * 1664525u + 1013904223u;
+            y = static_cast<int>((rng >> 8) % static_cast<std::uint32_t>(o.height));
+            if (!grid.blocked(x, y)) {
+                break;
+            }
+        }
+        return grid.center(x, y);
+    }
 
-                int width, height;
-                glfwGetFramebufferSize(window, &width, &height);
+    void init(int count, World& world, const PathGrid& grid) {
+        agents.resize(static_cast<std::size_t>(count));
+        for (std::size_t i = 0; i < agents.size(); ++i) {
+            const glm::vec2 p = randomOpenTile(grid);
+            const float hue = static_cast<float>(i % 7) / 7.0f;
+            const glm::vec4 color(1.0f, 0.5f + 0.5f * hue, 0.2f + 0.3f * hue, 1.0f);
+            agents[i].entity = world.create(Position{p}, PreviousPosition{p}, Velocity{glm::vec2(0.0f)},
+                                            Rotation{0.0f}, Scale{glm::vec2(0.3f)}, Color{packColor(color)},
+                                            SpriteRef{1}, ZLayer{kWandererZLayers});
+        }
+    }
 
-                // Convert to NDC
-                float xNDC = (2.0f * mouseX) / width - 1.0f;
-                float yNDC = 1.0f - (2.0f * mouseY) / height;
+    // Main thread, kAgentsPerSlice agents at a time (a FrameBudget slice), after
+    // service.update() delivered the answers. true: this pass over them isn't done; the
+    // rest keep their velocities until a later slice gets to them.
+    bool update(World& world, PathService& service) {
+        const float arrived = 0.25f * service.grid().options().tileSize;
+        const std::size_t end = std::min(agents.size(), cursor + kAgentsPerSlice);
+        for (std::size_t i = cursor; i < end; ++i) {
+            Agent& a = agents[i];
+            const Position* p = world.get<Position>(a.entity);
+            Velocity* v = world.get<Velocity>(a.entity);
+            if (p == nullptr || v == nullptr) {
+                continue;
+            }
+            while (a.next < a.path.size() && glm::length(a.path[a.next] - p->value) < arrived) {
+                ++a.next;
+            }
+            if (a.next < a.path.size()) {
+                v->value = glm::normalize(a.path[a.next] - p->value) * kSpeed;
+                continue;
+            }
+            v->value = glm::vec2(0.0f);
+            if (!a.waiting) {
+                a.waiting = true;
+                service.request(p->value, randomOpenTile(service.grid()), [this, i](const PathService::Result& r) {
+                    Agent& agent = agents[i];
+                    agent.path = r.points;
+                    agent.next = 0;
+                    agent.waiting = false;
+                });
+            }
+        }
+        cursor = end < agents.size() ? end : 0;
+        return cursor != 0;
+    }
+};
+
+// --flow-agents=N: N discs on random open tiles, all heading for the player's tile down
+// one FlowField, rebuilt when the player crosses into another tile or the map changes.
+void spawnFlowAgents(World& world, int count, const PathGrid& grid) {
+    std::uint32_t rng = 0x6c8e9cf5u;
+    auto next = [&rng](int range) {
+        rng = rng * 1664525u + 1013904223u;
+        return static_cast<int>((rng >> 8) % static_cast<std::uint32_t>(range));
+    };
+    const PathGrid::Options& o = grid.options();
+    const std::uint32_t color = packColor(glm::vec4(0.5f, 1.0f, 0.6f, 1.0f));
+    for (int i = 0; i < count; ++i) {
+        int x = next(o.width), y = next(o.height);
+        for (int attempt = 0; attempt < 16 && grid.blocked(x, y); ++attempt) {
+            x = next(o.width);
+            y = next(o.height);
+        }
+        const glm::vec2 p = grid.center(x, y);
+        world.create(Position{p}, PreviousPosition{p}, Velocity{glm::vec2(0.0f)}, Rotation{0.0f},
+                     Scale{glm::vec2(0.2f)}, Color{color}, SpriteRef{1}, ZLayer{kWandererZLayers},
+                     FlowFollower{0.8f + 0.1f * static_cast<float>(i % 5)});
+    }
+}
 
-                glm::vec4 clipCoords = glm::vec4(xNDC, yNDC, -1.0f, 1.0f);
+// Render pipeline
+// ---------------
+// Everything between the simulation and the GL calls, as a TaskGraph (core/task_graph.h)
+// built once and run every frame:
+//
+//     extract ──► cull ──► compact
+//
+// | Task    | Work, split across the JobSystem                                          |
+// | ------- | ------------------------------------------------------------------------- |
+// | extract | SoA transforms (+ colors, sprites, z-layers, handles) — per chunk slices |
+// | cull    | VisibleSet: last frame's list patched with the objects that crossed the   |
+// |         | view's edges, or cullTransforms of everything (render/visible_set.h)      |
+// | compact | each kCullRange piece of the list gathers its objects to its own offset   |
+//
+// Jobs are sized per call site by an AdaptiveGrain (core/job_system.h): from the cache
+// size first, then from how long the last frame's jobs took.
+//
+// Every piece writes a disjoint slice of a preallocated array, so there are no locks and
+// the result is the same as the single-threaded version, in the same order. After the
+// graph, main maps visibleCount instances and composeParallel fills them: the GL thread
+// itself only maps, draws and waits.
+constexpr std::size_t kCullRange = 512;     // visible objects per gather range
+
+struct RenderFrame {
+    // Inputs, set before each run.
+    World* world = nullptr;
+    float alpha = 0.0f;
+    CullRect view{};
+    const AnimationClipTable* clips = nullptr;  // --sprite-animation: extract the animations too
+    float time = 0.0f;                          // their clock, interpolated like the positions
+    SpriteLod* lod = nullptr;                   // null: every visible sprite as it is
+    float pixelsPerUnit = 0.0f;                 // the main view's, for the LOD
+
+    // Every drawable entity, in chunk order (picking indexes these).
+    Transforms2D transforms;
+    std::vector<std::uint32_t> colors;
+    std::vector<std::uint32_t> sprites;    // atlas ids (SpriteRef)
+    std::vector<std::uint16_t> zLayers;
+    std::vector<glm::vec2> animations;     // SpriteRef (start, rate); only with clips
+    std::vector<EntityHandle> handles;
+    // The visible ones, compacted.
+    Transforms2D visibleTransforms;
+    std::vector<std::uint32_t> visibleColors;
+    std::vector<std::uint32_t> visibleSprites;
+    std::vector<std::uint16_t> visibleZLayers;
+    std::vector<glm::vec2> visibleAnimations;
+    std::size_t visibleCount = 0;
+
+    // Scratch, reused every frame.
+    std::vector<ChunkSpan<Position, PreviousPosition, Rotation, Scale, Color, SpriteRef, ZLayer>> chunks;
+    VisibleSet visibleSet;                 // the visible indices, kept across frames
+
+    // Job sizes, adapted frame to frame: a compact range's gathers (index, 32 bytes read
+    // and written per object), a matrix / Affine2D composed from its 5 floats.
+    AdaptiveGrain compactGrain{kCullRange * (sizeof(std::uint32_t) + 2 * 32)};
+    AdaptiveGrain composeGrain{5 * sizeof(float) + sizeof(glm::mat4)};
+    AdaptiveGrain affineGrain{5 * sizeof(float) + sizeof(Affine2D)};
+};
+
+void buildRenderGraph(TaskGraph& graph, RenderFrame& frame) {
+    const TaskGraph::Task extract = graph.add("extract", [&frame](JobSystem& jobs) {
+        const std::size_t rows = collectChunks(*frame.world, frame.chunks);
+        frame.transforms.resize(rows);
+        frame.colors.resize(rows);
+        frame.sprites.resize(rows);
+        frame.zLayers.resize(rows);
+        frame.animations.resize(frame.clips ? rows : 0);
+        frame.handles.resize(rows);
+        jobs.parallelFor(frame.chunks.size(), 4, [&frame](std::size_t begin, std::size_t end) {
+            Transforms2D& out = frame.transforms;
+            for (std::size_t c = begin; c < end; ++c) {
+                const auto& span = frame.chunks[c];
+                const auto [p, prev, r, s, color, sprite, z] = span.arrays;
+                for (std::size_t i = 0, k = span.first; i < span.count; ++i, ++k) {
+                    const glm::vec2 pos = glm::mix(prev[i].value, p[i].value, frame.alpha);
+                    out.x[k] = pos.x;
+                    out.y[k] = pos.y;
+                    out.rotation[k] = r[i].radians;
+                    out.scaleX[k] = s[i].value.x;
+                    out.scaleY[k] = s[i].value.y;
+                    frame.colors[k] = color[i].rgba;
+                    frame.sprites[k] = sprite[i].id;
+                    frame.zLayers[k] = z[i].value;
+                    frame.handles[k] = span.handles[i];
+                }
+                if (frame.clips) {
+                    for (std::size_t i = 0, k = span.first; i < span.count; ++i, ++k) {
+                        frame.animations[k] = glm::vec2(sprite[i].start, sprite[i].rate);
+                    }
+                }
+            }
+        });
+    });
 
-                glm::mat4 invMVP = glm::inverse(currentMVP); // use global copy
-                glm::vec4 worldCoords = invMVP * clipCoords;
-                worldCoords /= worldCoords.w;
+    const TaskGraph::Task cull = graph.add("cull", [&frame](JobSystem& jobs) {
+        frame.visibleSet.update(jobs, frame.transforms, 0.25f, frame.view);
+    });
 
-                std::cout << "Mouse world coordinates: (" << worldCoords.x << ", " << worldCoords.y << ")\n";
+    const TaskGraph::Task compact = graph.add("compact", [&frame](JobSystem& jobs) {
+        const std::size_t total = frame.visibleSet.size();
+        const std::size_t ranges = (total + kCullRange - 1) / kCullRange;
+        frame.visibleCount = total;
+        frame.visibleTransforms.resize(total);
+        frame.visibleColors.resize(total);
+        frame.visibleSprites.resize(total);
+        frame.visibleZLayers.resize(total);
+        frame.visibleAnimations.resize(frame.clips ? total : 0);
+        jobs.parallelFor(ranges, frame.compactGrain, [&frame, total](std::size_t begin, std::size_t end) {
+            for (std::size_t r = begin; r < end; ++r) {
+                const std::size_t offset = r * kCullRange;
+                const std::size_t count = std::min(kCullRange, total - offset);
+                const std::uint32_t* indices = frame.visibleSet.indices().data() + offset;
+                gatherTransforms(frame.transforms, indices, count, frame.visibleTransforms, offset);
+                for (std::size_t k = 0; k < count; ++k) {
+                    frame.visibleColors[offset + k] = frame.colors[indices[k]];
+                    frame.visibleSprites[offset + k] = frame.sprites[indices[k]];
+                    frame.visibleZLayers[offset + k] = frame.zLayers[indices[k]];
+                }
+                if (frame.clips) {
+                    for (std::size_t k = 0; k < count; ++k) {
+                        frame.visibleAnimations[offset + k] = frame.animations[indices[k]];
+                    }
+                }
             }
         });
+    });
 
+    // Zoomed out: tiny sprites flat, crowds of them as impostors (render/sprite_lod.h).
+    const TaskGraph::Task lod = graph.add("lod", [&frame](JobSystem& jobs) {
+        if (frame.lod != nullptr) {
+            frame.visibleCount = frame.lod->apply(jobs, frame.pixelsPerUnit, frame.visibleTransforms,
+                                                  frame.visibleColors, frame.visibleSprites, frame.visibleZLayers,
+                                                  frame.clips ? &frame.visibleAnimations : nullptr);
+        }
+    });
 
-        glUseProgram(shaderProgram);
+    graph.depend(cull, extract);
+    graph.depend(compact, cull);
+    graph.depend(lod, compact);
+}
 
-        // Find 'model' memory location
-        // GLuint modelLoc = glGetUniformLocation(shaderProgram, "model");
+// composeModelMatrices, `grain`'s matrices per job, relative to `origin`. `out` may be
+// mapped GPU memory: each job writes its own contiguous block, front to back.
+void composeParallel(JobSystem& jobs, const Transforms2D& transforms, glm::mat4* out, AdaptiveGrain& grain,
+                     const WorldPosition& origin) {
+    jobs.parallelFor(transforms.size(), grain, [&](std::size_t begin, std::size_t end) {
+        composeModelMatrices(transforms, begin, end - begin, out + begin, origin);
+    });
+}
 
-        // Send composed model matrix (using value_ptr) to location found
-        // in the previous step
-        // glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+// Same, Affine2D output.
+void composeAffineParallel(JobSystem& jobs, const Transforms2D& transforms, Affine2D* out, AdaptiveGrain& grain,
+                           const WorldPosition& origin) {
+    jobs.parallelFor(transforms.size(), grain, [&](std::size_t begin, std::size_t end) {
+        composeAffine2D(transforms, begin, end - begin, out + begin, origin);
+    });
+}
 
-        GLuint mvpLoc = glGetUniformLocation(shaderProgram, "MVP");
-        glUniformMatrix4fv(mvpLoc, 1, GL_FALSE, glm::value_ptr(MVP));
+// --gpu-pick: the objects whose bounds touch the GpuPicker region around framebuffer pixel
+// (x, y), in draw order, as the instances to draw into it: colour = candidate index + 1,
+// the sprite (or GpuPicker::kNoAlphaTest for the untextured path) and z-layer the frame
+// drew them with, in world space (the packet makes them relative to its origin).
+// `handles` maps the candidate index back.
+void gpuPickCandidates(Picker& picker, Camera& camera, const RenderFrame& frame, GamePath path, double x, double y,
+                       std::vector<LayeredInstance>& instances, std::vector<EntityHandle>& handles) {
+    const float r = static_cast<float>(GpuPicker::kRadius + 1);
+    glm::vec2 corners[4] = {{static_cast<float>(x) - r, static_cast<float>(y) - r},
+                            {static_cast<float>(x) + r, static_cast<float>(y) - r},
+                            {static_cast<float>(x) - r, static_cast<float>(y) + r},
+                            {static_cast<float>(x) + r, static_cast<float>(y) + r}};
+    camera.screenToWorld(corners, 4, corners);
+    Aabb region{corners[0], corners[0]};
+    for (const glm::vec2& corner : corners) {
+        region.min = glm::min(region.min, corner);
+        region.max = glm::max(region.max, corner);
+    }
+    std::vector<ObjectId> ids;
+    picker.overlapping(region, frame.transforms, ids);
+    instances.resize(ids.size());
+    handles.resize(ids.size());
+    for (std::size_t k = 0; k < ids.size(); ++k) {
+        const ObjectId id = ids[k];
+        LayeredInstance& instance = instances[k];
+        composeAffine2D(frame.transforms, id, 1, &instance.transform);
+        const std::uint32_t sprite = frame.clips ? frame.clips->layerAt(frame.sprites[id], frame.animations[id].x,
+                                                                        frame.animations[id].y, frame.time)
+                                                 : frame.sprites[id];
+        const std::uint32_t layer = path == GamePath::Instanced ? GpuPicker::kNoAlphaTest : sprite;
+        instance.layer = layeredLayer(layer, path == GamePath::Layered ? frame.zLayers[id] : 0);
+        instance.color = static_cast<std::uint32_t>(k + 1);
+        handles[k] = frame.handles[id];
+    }
+}
 
+// --lights=N
+// ----------
+// N coloured point lights, each circling a point of its own over the wander bounds at its
+// own speed, and a warm one on the player. Only those that reach one of the views go
+// into the packet.
+void appendLights(FramePacket& packet, int count, const Aabb& bounds, float time, const glm::vec2& player) {
+    auto hashed = [](std::uint32_t h) {           // [0, 1)
+        h = (h ^ (h >> 16)) * 0x45d9f3bu;
+        h = (h ^ (h >> 16)) * 0x45d9f3bu;
+        return static_cast<float>((h ^ (h >> 16)) & 0xffffu) / 65536.0f;
+    };
+    const glm::vec2 size = bounds.max - bounds.min;
+    for (int i = 0; i < count; ++i) {
+        const std::uint32_t seed = static_cast<std::uint32_t>(i) * 4u;
+        const glm::vec2 center = bounds.min + size * glm::vec2(hashed(seed), hashed(seed + 1));
+        const float speed = 0.3f + hashed(seed + 2);
+        const float hue = hashed(seed + 3);
+        const float angle = time * speed + hue * 6.2831853f;
+        PointLight2D light;
+        light.position = center + 0.6f * glm::vec2(std::cos(angle), std::sin(angle));
+        light.radius = 0.5f + 0.5f * speed;
+        if (!packet.visible.contains(light.position, light.radius)) {
+            continue;
+        }
+        const glm::vec3 rgb = glm::clamp(glm::abs(glm::mod(hue * 6.0f + glm::vec3(0.0f, 4.0f, 2.0f), 6.0f) - 3.0f) - 1.0f,
+                                         0.0f, 1.0f);
+        light.color = packColor(glm::vec4(rgb, 0.8f));
+        packet.lights.push_back(light);
+    }
+    packet.lights.push_back(PointLight2D{player, 1.5f, packColor(glm::vec4(1.0f, 0.85f, 0.6f, 1.0f))});
+}
 
-        // glm::value_ptr(...)
-        // --------------------
-        // Converts a GLM matrix (or vector) into a raw pointer (float*) usable by OpenGL.
-        //
-        // Usage:
-        // glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(matrix));
-        //
-        // Why it's needed:
-        // OpenGL expects matrices as arrays of floats in column-major order.
-        // GLM stores data this way internally, so value_ptr() gives you safe access to it.
-        
-        // glUniformMatrix4fv(...)
-        // ------------------------
-        // Sends a 4×4 matrix to the currently active shader program.
-        //
-        // Usage:
-        // glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(matrix));
-        //
-        // Parameters:
-        // - location: ID of the uniform variable in the shader
-        // - 1: number of matrices you're uploading (usually 1)
-        // - GL_FALSE: whether to transpose (must be GL_FALSE for GLM)
-        // - value_ptr(matrix): raw float pointer to the matrix data
-        //
-        // This sets a uniform mat4 variable in your GLSL vertex shader.
-
-
-        // int offsetLoc = glGetUniformLocation(shaderProgram, "xOffset");
-        // Asks OpenGL:
-        // “In the currently linked shader program, where is the uniform variable named xOffset?”
-        // OpenGL will:
-        // Look into the compiled+linked shader program
-        // Find the memory location for the variable xOffset
-        // Return an integer handle that refers to that location
-        // OpengGL doesn't expose actual variable pointers in GLSL - uses opaque location IDs
-        // glUniform1f(glGetUniformLocation(shaderProgram, "xOffset"), xOffset);
-        // glUniform1f(glGetUniformLocation(shaderProgram, "yOffset"), yOffset);
-
-        // Sends the value of xOffset(C++) to the GPU at the location where xOffset is found
-        // in the GLSL shader program. 
-        // * THIS IS THE BASIC METHOD TO UPDATE VALUES USED IN SHADER CODE!
-
-        glBindVertexArray(VAO);           // ✅ Reactivate the same VAO for drawing
-        
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-        // | Argument          | Meaning                                         |
-        // | ----------------- | ----------------------------------------------- |
-        // | `GL_TRIANGLES`    | Draws one triangle per 3 indices                |
-        // | `3`               | Number of indices to use                        |
-        // | `GL_UNSIGNED_INT` | Type of the indices in the EBO (`unsigned int`) |
-        // | `0`               | Offset in the EBO (start at beginning)          |
+// If I wanted to handle multiple different inputs via a callback event, I would
+// do so within the *single* keyCallback function. Only ONE callback function can
+// be registered for key presses. One implementation would be to use a switch block
+// to determine the input to be handled out of all inputs registered in the callback.
+// The callback is essentially an event router.
 
-        // ! NOTE: glDrawElements would be better suited for my game.
-        // ! glDrawElements allows you to draw objects that share vertices w/o
-        // ! having to duplicate the shared vertices.
 
-        glfwSwapBuffers(window);          // Present the frame (double buffering)
-        glfwPollEvents();                 // Handle keyboard/mouse/input/window events
+// A saved config file: whatever differs from the config in use takes effect now, between
+// frames. Settings the command line overrode stay overridden unless their line changed.
+// The clear colour and the speeds need nothing here: they are read where they're used.
+void applyConfig(const GameConfig& next, GLFWwindow* window, InputState& keys, SimState& sim, Options& options,
+                 bool headless) {
+    const GameConfig before = gameConfig;
+    gameConfig = next;
+    if (next.windowWidth != before.windowWidth || next.windowHeight != before.windowHeight) {
+        glfwSetWindowSize(window, next.windowWidth, next.windowHeight);   // a resize event follows
+    }
+    if (next.vsync != before.vsync && !headless) {
+        options.pacing.vsync = next.vsync;
+    }
+    if (next.renderScale != before.renderScale) {
+        options.renderScale = next.renderScale;
+    }
+    if (next.msaa != before.msaa) {
+        options.msaa = next.msaa;
+    }
+    if (next.playerSpeed != before.playerSpeed) {
+        if (Controllable* c = sim.world.get<Controllable>(sim.player)) {
+            c->speed = next.playerSpeed;
+        }
+    }
+    if (next.keys != before.keys) {
+        bindKeys(keys, next);
+    }
+    if (next.commands != before.commands) {
+        bindCommands(commands, next);
+    }
+}
+
+// FrameBudget's period: the display's refresh with vsync, the cap's if that is longer,
+// 60 Hz with neither (an uncapped frame still shouldn't stall on deferrable work).
+double targetFramePeriod(const FramePacer::Settings& pacing, double refreshHz) {
+    double period = pacing.vsync != VsyncMode::Off && refreshHz > 0.0 ? 1.0 / refreshHz : 1.0 / 60.0;
+    if (pacing.fpsCap > 0.0) {
+        period = std::max(period, 1.0 / pacing.fpsCap);
+    }
+    return period;
+}
+
+// --sim-bench
+// -----------
+// The --replay's ticks with nothing else: no window, GL context, renderer, audio or frame
+// pacing, just the World the game would spawn and updateSimulation once per recorded
+// tick, as fast as it goes. Once per thread count, each with a JobSystem of that many
+// threads (the caller and count - 1 workers) and a freshly spawned World, so the runs
+// are the same work and ticks/s at 1 thread is the baseline for the others' speedup.
+//
+// The systems (registerSystems), the camera and the timer wheel run; what the frame
+// loop does between ticks (the frame budget's deferred work, path agents, the streamed
+// level) doesn't. Every run ends on a checksum of the World's snapshot image: the
+// replay is deterministic, so a count that ends elsewhere has a race.
+bool runSimulationBench(const Options& options) {
+    SimState* current = nullptr;        // the run's, for the recorded toggles
+    events.declare<PauseToggled, 16>();
+    events.declare<ScaleToggled, 16>();
+    events.declare<ProjectionToggled, 16>();
+    events.declare<BounceEvent, kBounceEvents>();
+    events.subscribe<ScaleToggled>([&current](const ScaleToggled*, std::size_t count) {
+        if (current) {
+            current->scaleUp ^= count % 2 != 0;
+        }
+    });
+    defineCommands(commands);
+    bindCommands(commands, gameConfig);
+
+    std::cout << "Simulation bench: " << options.replayPath << ", " << options.entities << " wanderers, "
+              << options.boids << " boids" << (options.collisions ? ", collisions" : "") << "\n";
+    std::printf("%8s %10s %12s %9s %11s %10s\n", "threads", "ticks", "ticks/s", "speedup", "efficiency", "state");
+    const float dt = static_cast<float>(1.0 / kSimulationHz);
+    double baseline = 0.0;
+    std::uint32_t firstState = 0;
+    bool deterministic = true;
+    std::vector<unsigned char> image;
+    for (std::size_t r = 0; r < options.simBenchThreads.size(); ++r) {
+        const int threads = options.simBenchThreads[r];
+        InputReplay replay;
+        if (!replay.open(options.replayPath)) {
+            return false;
+        }
+        JobSystem jobs;
+        jobs.init(threads - 1);
+        SimState sim;
+        sim.player = spawnPlayer(sim.world, packColor(glm::vec4(1.0f, 0.5f, 0.2f, 1.0f)), options.collisions);
+        spawnWanderers(sim, options.entities, options.collisions, options.spriteAnimation);
+        spawnBoids(sim, options.boids);
+        if (options.turnTimers) {
+            scheduleWandererTurns(sim);
+        }
+        registerSystems(sim, jobs);
+        current = &sim;
+        InputState keys;
+        ActionMask actions = 0;
+        const monoclock::Ticks start = monoclock::now();
+        while (replay.next([](int key, int action, int mods) { keyCallback(nullptr, key, 0, action, mods); },
+                           actions)) {
+            events.dispatch(FrameArena::thisThread());   // its toggles, on this tick
+            keys.setActions(actions);
+            updateSimulation(sim, keys, dt);
+            events.dispatch(FrameArena::thisThread());   // the bounces, heard by nobody
+            FrameArena::thisThread().reset();
+        }
+        const double seconds = std::max(monoclock::toSeconds(monoclock::now() - start), 1e-9);
+        current = nullptr;
+
+        sim.world.snapshot(image);
+        const std::uint32_t state = LevelFile::checksum(image.data(), image.size());
+        const double ticksPerSecond = static_cast<double>(replay.tick()) / seconds;
+        if (r == 0) {
+            baseline = ticksPerSecond;
+            firstState = state;
+        }
+        deterministic = deterministic && state == firstState;
+        // Against the first count's: perfect scaling is threads / that count.
+        const double speedup = ticksPerSecond / baseline;
+        const double ideal = static_cast<double>(threads) / static_cast<double>(options.simBenchThreads[0]);
+        std::printf("%8d %10llu %12.0f %8.2fx %10.0f%% %08x%s\n", threads,
+                    static_cast<unsigned long long>(replay.tick()), ticksPerSecond, speedup, 100.0 * speedup / ideal,
+                    state, state == firstState ? "" : " (differs)");
+    }
+    if (!deterministic) {
+        std::cerr << "Simulation bench: the World ended differently at different thread counts\n";
+    }
+    return deterministic;
+}
+
+int main(int argc, char** argv) {
+    // --profile prints it at the first frame; with --trace its steps are spans too.
+    StartupTimeline startupTimeline;
+    startupTimeline.start();
+    // The config file first: the options below override what it says.
+    const std::string configFile = configPath(argc, argv);
+    {
+        std::vector<std::string> errors;
+        if (!loadGameConfig(configFile, gameConfig, errors)) {
+            for (const std::string& e : errors) {
+                std::cerr << "Config " << configFile << ": " << e << "\n";
+            }
+        }
+    }
+    Options options;
+    options.pacing.vsync = gameConfig.vsync;
+    options.renderScale = gameConfig.renderScale;
+    options.msaa = gameConfig.msaa;
+    if (!parseOptions(argc, argv, options)) {
+        return -1;
+    }
+    if (options.bench.enabled && !options.replayPath.empty()) {
+        std::cerr << "--bench and --replay are two different benchmarks: pick one\n";
+        return -1;
+    }
+    if (!options.simBenchThreads.empty() && options.replayPath.empty()) {
+        std::cerr << "--sim-bench replays a recording: give it --replay=FILE\n";
+        return -1;
+    }
+    InputReplay inputReplay;
+    const bool replaying = !options.replayPath.empty();
+    if (replaying && !inputReplay.open(options.replayPath)) {
+        return -1;
+    }
+    // --offline: a video or a thumbnail, not a game. Every frame is one step of simulated
+    // time and is captured, whatever the wall clock did in between.
+    const bool offline = options.offlineFrames >= 0;
+    if (offline) {
+        if (options.offlineFrames == 0 && !replaying) {
+            options.offlineFrames = 1;
+        }
+        options.capture = true;
+        options.captureSettings.wait = true;
+    }
+    const bool thumbnails = !options.thumbnails.empty();
+    const bool headless = options.bench.enabled || replaying || offline || thumbnails;
+    if (headless) {
+        // Benchmarks measure rendering, not the display: never wait for vblank or a cap.
+        options.pacing.vsync = VsyncMode::Off;
+        options.pacing.fpsCap = 0.0;
+    }
+    // --bench-scene: the scenes that aren't quads are the feature they measure, turned on.
+    if (options.bench.enabled && options.bench.scene == BenchSceneKind::Particles) {
+        options.particles = options.bench.quads;
+    } else if (options.bench.enabled && options.bench.scene == BenchSceneKind::Tilemap) {
+        options.tilemap = true;
+    }
+    const int tilemapWidth = options.bench.enabled && options.bench.scene == BenchSceneKind::Tilemap
+                                 ? options.bench.tilesX : kTilemapSize;
+    const int tilemapHeight = options.bench.enabled && options.bench.scene == BenchSceneKind::Tilemap
+                                  ? options.bench.tilesY : kTilemapSize;
+    // From here on logging:: calls only queue their message; a thread of its own prints.
+    logging::start(options.logLevel);
+    // Early, so the startup steps are in the trace too.
+    if (!options.tracePath.empty() && trace::start(options.tracePath.c_str())) {
+        std::cout << "Tracing to " << options.tracePath << "\n";
+    }
+    const bool flightRecorder = (options.flightRecorder || options.hitchMultiple > 0.0) && flightrec::start();
+    if (flightRecorder) {
+        std::cout << "Flight recorder: on";
+        if (options.hitchMultiple > 0.0) {
+            std::cout << ", captures frames over " << options.hitchMultiple << "x the median";
+        }
+        std::cout << "\n";
+    }
+    HitchDetector::Settings hitchSettings;
+    hitchSettings.multiple = options.hitchMultiple;
+    HitchDetector hitchDetector(hitchSettings);
+    const bool hitchCapture = flightRecorder && options.hitchMultiple > 0.0;
+    trace::setThreadName("main");       // also a sampling profiler's name for it
+    if (sampling::enabled()) {
+        std::cout << "Sampling profiler hooks: " << sampling::backendName() << "\n";
+    }
+    // --affinity: which cores the render, main, audio and worker threads run on. Set before
+    // any of them starts; each pins itself as it does (core/thread_affinity.h).
+    if (options.affinity || !options.affinityCpus.empty()) {
+        const affinity::Topology topology = affinity::detect();
+        affinity::Plan plan = options.affinity ? affinity::automatic(topology) : affinity::Plan{};
+        for (int r = 0; r < affinity::kRoles; ++r) {
+            if (!options.affinityCpus.cpus[r].empty()) {
+                plan.cpus[r] = options.affinityCpus.cpus[r];
+            }
+        }
+        affinity::setPlan(plan);
+        const int performance = topology.performanceCores();
+        std::cout << "CPU topology: " << topology.cores.size() << " cores, " << topology.cpus.size() << " threads";
+        if (topology.hybrid) {
+            std::cout << " (" << performance << " P, " << topology.cores.size() - performance << " E)";
+        }
+        std::cout << "\n";
+        if (plan.empty()) {
+            std::cout << "Affinity: off (fewer than 4 cores to share out)\n";
+        } else {
+            std::cout << "Affinity:";
+            for (int r = 0; r < affinity::kRoles; ++r) {
+                const affinity::Role role = static_cast<affinity::Role>(r);
+                std::cout << " " << affinity::roleName(role) << " "
+                          << (plan[role].empty() ? "any" : affinity::formatCpuList(plan[role]));
+            }
+            std::cout << "\n";
+            if (!affinity::pinThisThread(affinity::Role::Main)) {
+                std::cerr << "Affinity: could not pin the main thread\n";
+            }
+            if (options.jobs < 0 && !plan[affinity::Role::Workers].empty()) {
+                options.jobs = static_cast<int>(plan[affinity::Role::Workers].size());
+            }
+        }
+    }
+
+    // --sim-bench: the replay's simulation alone, then out; nothing below is needed.
+    if (!options.simBenchThreads.empty()) {
+        const bool ok = runSimulationBench(options);
+        trace::stop();
+        flightrec::stop();
+        logging::stop();
+        return ok ? 0 : 1;
+    }
+
+    // Packs go in before anything is loaded (and before the loader threads exist).
+#ifdef EMBED_SHADERS
+    vfs::mountEmbedded(kEmbeddedShaders, kEmbeddedShadersCount); // make EMBED_SHADERS=1
+    std::cout << "Shaders: " << kEmbeddedShadersCount << " files embedded in the executable\n";
+#endif
+    for (const std::string& pack : options.packs) {
+        if (!vfs::mount(pack)) {
+            return -1;
+        }
+        std::cout << "Pack: " << pack << "\n";
+    }
+
+    // The variants of the shared GLSL files that are actually drawn with; nothing else is
+    // compiled (src/render/shader_preprocessor.h).
+    const ProgramDesc shaderDesc{"shaders/vertex.glsl", "shaders/fragment.glsl",
+                                 {kShaderInstanced | kShaderInstanceColor, {}}};
+    // Same fragment stage, vertex stage that reads the compact Affine2D instances.
+    const ProgramDesc affineDesc{"shaders/vertex.glsl", "shaders/fragment.glsl",
+                                 {kShaderInstanced | kShaderAffine2D | kShaderInstanceColor, {}}};
+    // Texture array: Affine2D + layer + tint, and the sampler2DArray fragment stage; the
+    // z-layer becomes depth, so opaque quads need no sorting. INSTANCE_FETCH comes off
+    // again below if the texture buffer storage turns out unavailable.
+    ProgramDesc layeredDesc{"shaders/vertex.glsl", "shaders/fragment.glsl",
+                            {kShaderInstanced | kShaderAffine2D | kShaderTextureArray | kShaderDepthLayers |
+                                 (options.instanceFetch ? kShaderInstanceFetch : 0u),
+                             {}}};
+    // Sprite batcher: CPU-transformed quads merged into as few draws as possible.
+    // Uses its own vertex stage (no per-instance model matrix, has UV + colour).
+    const ProgramDesc spriteDesc{"shaders/sprite_vertex.glsl", "shaders/fragment.glsl", {kShaderTextured, {}}};
+    // Tilemap: baked world-space vertices sampling the same texture array, or (index mode)
+    // one quad whose fragments look the tiles up.
+    const ProgramDesc tilemapDesc{
+        "shaders/vertex.glsl", "shaders/fragment.glsl",
+        {kShaderTilemap | kShaderTextureArray |
+             (options.tilemapMode == Tilemap::Mode::IndexTexture ? kShaderTileIndex : 0u),
+         {}}};
+    // Particles: the transform feedback update pass (its fragment stage never runs), and
+    // quads instanced straight from the state buffer it wrote.
+    const ProgramDesc particleUpdateDesc{"shaders/particle_update.glsl", "shaders/fragment.glsl", {},
+                                         ParticleSystem::feedbackVaryings()};
+    const ProgramDesc particleDesc{"shaders/vertex.glsl", "shaders/fragment.glsl",
+                                   {kShaderParticles | kShaderTextureArray, {}}};
+    const bool particles = options.particles > 0;
+    const bool gpuParticles = particles && !options.particlesCpu; // the update pass
+    // HUD text: sprite batch vertices already in clip space, alpha from the SDF atlas.
+    const ProgramDesc textDesc{"shaders/sprite_vertex.glsl", "shaders/fragment.glsl",
+                               {kShaderTextured | kShaderSdf | kShaderScreenSpace, {}}};
+    // Debug shapes: world-space vertices with a colour each. Not even compiled without DEBUG_DRAW.
+    const ProgramDesc debugDesc{"shaders/debug_vertex.glsl", "shaders/fragment.glsl", {kShaderVertexColor, {}}};
+    // The --overdraw heatmap: full-screen triangles of one colour each.
+    const ProgramDesc heatmapDesc{"shaders/fullscreen_vertex.glsl", "shaders/fragment.glsl", {kShaderVertexColor, {}}};
+    // --post: bloom's bright and blur passes, and the final pass with every per-pixel
+    // effect fused into it.
+    using PostProgram = PostProcessChain::Program;
+    const ProgramDesc postBrightDesc{"shaders/fullscreen_vertex.glsl", "shaders/fragment.glsl",
+                                     PostProcessChain::variant(PostProgram::Bright, options.post)};
+    const ProgramDesc postBlurDesc{"shaders/fullscreen_vertex.glsl", "shaders/fragment.glsl",
+                                   PostProcessChain::variant(PostProgram::Blur, options.post)};
+    const ProgramDesc postFinalDesc{"shaders/fullscreen_vertex.glsl", "shaders/fragment.glsl",
+                                    PostProcessChain::variant(PostProgram::Final, options.post)};
+    const bool post = options.post != 0;
+    // --procgen-gpu: the two noise fields of a batch of world chunks (render/gpu_noise.h).
+    const ProgramDesc noiseDesc{"shaders/fullscreen_vertex.glsl", "shaders/fragment.glsl", {kShaderNoise, {}}};
+    const bool postBloom = PostProcessChain::uses(PostProgram::Bright, options.post);
+    // --gpu-pick: the layered program writing object ids instead of colours.
+    const ProgramDesc pickDesc{"shaders/vertex.glsl", "shaders/fragment.glsl",
+                               {kShaderInstanced | kShaderAffine2D | kShaderTextureArray | kShaderDepthLayers |
+                                    kShaderPickId,
+                                {}}};
+    // --sprite-animation: the layered program picking clip frames from the clip table.
+    const ProgramDesc animatedDesc{"shaders/vertex.glsl", "shaders/fragment.glsl",
+                                   {kShaderInstanced | kShaderAffine2D | kShaderTextureArray | kShaderDepthLayers |
+                                        kShaderAnimated,
+                                    {}}};
+    const bool animated = options.spriteAnimation;
+    // --critters: skinned on the GPU from the palette texture, coloured per vertex.
+    const ProgramDesc skinnedDesc{"shaders/vertex.glsl", "shaders/fragment.glsl",
+                                  {kShaderSkinned | kShaderVertexColor, {}}};
+    // --virtual-background: the image's quad through the page table, and the same quad
+    // writing the page ids it needs instead (render/virtual_texture.h).
+    const ProgramDesc virtualDesc{"shaders/vertex.glsl", "shaders/fragment.glsl",
+                                  {kShaderTilemap | kShaderVirtualTexture, {}}};
+    const ProgramDesc virtualFeedbackDesc{"shaders/vertex.glsl", "shaders/fragment.glsl",
+                                          {kShaderTilemap | kShaderVirtualTexture, {"FEEDBACK"}}};
+    const bool virtualBackground = options.virtualPages > 0;
+    // --lights: the lights' quads into the light target, and the target over the scene;
+    // --light-tiles: only the composite, reading the tile lists.
+    const ProgramDesc lightDesc{"shaders/vertex.glsl", "shaders/fragment.glsl", {kShaderLight, {}}};
+    const ProgramDesc lightCompositeDesc{"shaders/fullscreen_vertex.glsl", "shaders/fragment.glsl",
+                                         options.lightTiles ? ShaderVariant{kShaderLight, {"COMPOSITE", "TILED"}}
+                                                            : ShaderVariant{kShaderLight, {"COMPOSITE"}}};
+    const bool lit = options.lights > 0;
+    const bool litQuads = lit && !options.lightTiles;
+    // --oit: the texture array program writing weighted colour and coverage instead of
+    // blending, and the composite that resolves them over the scene.
+    ProgramDesc oitDesc = layeredDesc;
+    oitDesc.variant.defines.push_back("OIT");
+    const ProgramDesc oitCompositeDesc{"shaders/fullscreen_vertex.glsl", "shaders/fragment.glsl",
+                                       {0u, {"OIT", "COMPOSITE"}}};
+    const bool oit = options.oit;
+
+    // Worker threads for the systems and the render pipeline; this thread is thread 0.
+    // Started before the window: the startup prefetch below runs on them meanwhile.
+    JobSystem jobs;
+    jobs.init(options.jobs);
+    TextureAtlas spriteAtlas;
+    StartupPrefetch prefetch;
+    prefetch.programs = {shaderDesc, affineDesc, layeredDesc, spriteDesc, tilemapDesc, textDesc};
+    if (gpuParticles) {
+        prefetch.programs.push_back(particleUpdateDesc);
+    }
+    if (particles) {
+        prefetch.programs.push_back(particleDesc);
+    }
+    if (debugdraw::enabled()) {
+        prefetch.programs.push_back(debugDesc);
+    }
+    if (options.overdraw) {
+        prefetch.programs.push_back(heatmapDesc);
+    }
+    if (postBloom) {
+        prefetch.programs.push_back(postBrightDesc);
+        prefetch.programs.push_back(postBlurDesc);
+    }
+    if (post) {
+        prefetch.programs.push_back(postFinalDesc);
+    }
+    if (options.gpuPick) {
+        prefetch.programs.push_back(pickDesc);
+    }
+    if (options.procgenGpu) {
+        prefetch.programs.push_back(noiseDesc);
+    }
+    if (animated) {
+        prefetch.programs.push_back(animatedDesc);
+    }
+    if (options.critters > 0) {
+        prefetch.programs.push_back(skinnedDesc);
+    }
+    if (virtualBackground) {
+        prefetch.programs.push_back(virtualDesc);
+        prefetch.programs.push_back(virtualFeedbackDesc);
+    }
+    if (litQuads) {
+        prefetch.programs.push_back(lightDesc);
+    }
+    if (lit) {
+        prefetch.programs.push_back(lightCompositeDesc);
+    }
+    if (oit) {
+        prefetch.programs.push_back(oitDesc);
+        prefetch.programs.push_back(oitCompositeDesc);
+    }
+    prefetch.atlas = &spriteAtlas;
+    prefetch.atlasOptions.pageSize = 512;   // the generated shapes fill about half of one page
+    prefetch.start(jobs);
+    startupTimeline.mark("options + prefetch start");
+
+    // Attempt to initialize GLFW
+    if(!glfwInit()){
+        std::cerr << "Failed to initialize GLFW. Exiting\n";
+        return -1;
+    }
+    startupTimeline.mark("glfw init");
+    
+    // Successful windowing initialization
+    
+    // Specify the OpenGL profile to request from the driver: core, the newest version it
+    // will create (below). glad itself only loads 3.3, which every newer core context
+    // includes; gl_ext loads what the newer ones add (render/gl_ext.h).
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE); // OpenGL Core
+    if (headless) {
+        // Hidden window: still a real context + default framebuffer, but nothing is shown
+        // and no compositor is involved, so results don't depend on the desktop.
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    }
+    gldebug::hintContext(options.glDebug);
+
+    // GLFW will then ask the OS/driver to create a compatible OpenGL context.
+
+    // Window creation
+    // Create an 800x600 window with title "GL Triangle Window"
+    // last two args are for context sharing between windows - not needed here
+    // Function call also creates an OpenGL context associated with the window.
+    // Newest first: a driver refuses a version it doesn't have, so the first window that
+    // comes back has the best context on offer. --gl-tier=baseline stops at 3.3.
+    GLFWwindow* window = nullptr;
+    for (const glext::ContextVersion& version : glext::kContextVersions) {
+        if (options.glTier == glext::Tier::Baseline && (version.major > 3 || version.minor > 3)) {
+            continue;
+        }
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, version.major);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, version.minor);
+        window = glfwCreateWindow(gameConfig.windowWidth, gameConfig.windowHeight, "GL Triangle Window", nullptr, nullptr);
+        if (window) {
+            break;
+        }
+    }
+
+    if(!window){
+        std::cerr << "Failed to create GLFW window\n";
+        glfwTerminate(); // shut down GLFW cleanly.
+        return -1;
+    }
+    startupTimeline.mark("window + context");
+
+    // The framebuffer size callback is registered by input.install(...) further down: it
+    // queues a FramebufferResize event that the frame applies (see onFramebufferResize).
+
+    // Callback Function (Resize Handling)
+    // -----------------------------------
+    // What is a callback?
+    // - A function that YOU write, but GLFW (or any system) calls LATER when an event happens.
+    // - You don’t call this function manually—it’s run automatically when GLFW detects a matching event.
+    //
+    // Who decides when the callback runs?
+    // - GLFW does. You simply *register* the function (with glfwSetFramebufferSizeCallback),
+    //   and GLFW calls it every time the framebuffer size changes (e.g., on window resize).
+    //
+    // What does this callback do?
+    // - It receives the new width and height of the framebuffer.
+    // - We then call glViewport(...) to tell OpenGL to match the new window size, and
+    //   hand the size to the camera (aspect ratio) and anything else sized to the window.
+    // - Without this, OpenGL would keep drawing to the old viewport and not scale with the window.
+
+    // Make OGL context active
+    // Essentially signals to OGL: "all OpenGL function calls in this thread affect this specific window"
+    glfwMakeContextCurrent(window);
+
+    // Load OpenGL functions with GLAD
+    // gladLoadGL uses the active context defined in the previous step
+    if(!gladLoadGL()){
+        std::cerr << "Failed to initialize GLAD\n";
+        glfwDestroyWindow(window); // cleaner to explicitly call
+        glfwTerminate(); // typically includes DestroyWindow
+        return -1;
+    }
+
+    // glad only knows GL 3.3 core; pick up optional faster paths (persistent mapping, ...)
+    // that this driver offers on top of that. See render/gl_ext.h.
+    glext::load();
+    const glext::Tier driverTier = glext::tier();
+    glext::limitTier(options.glTier);
+    {
+        const glext::Caps& caps = glext::caps();
+        std::cout << "GL " << caps.major << "." << caps.minor << " core, tier " << glext::tierName(glext::tier());
+        if (glext::tier() != driverTier) {
+            std::cout << " (of " << glext::tierName(driverTier) << ", --gl-tier)";
+        }
+        std::cout << ": buffer storage " << (caps.bufferStorage ? "yes" : "no") << ", multi-draw indirect "
+                  << (caps.multiDrawIndirect ? "yes" : "no") << ", compute " << (caps.computeShader ? "yes" : "no")
+                  << ", DSA " << (caps.directStateAccess ? "yes" : "no") << ", parallel compile "
+                  << (caps.parallelShaderCompile ? "yes" : "no") << ", explicit bindings "
+                  << (caps.explicitBindings ? "yes" : "no") << ", invalidate "
+                  << (caps.invalidateFramebuffer ? "yes" : "no") << "\n";
+        // The bench runner (src/tools/bench_runner.cpp) keys its baselines by this line.
+        std::cout << "GL device: " << reinterpret_cast<const char*>(glGetString(GL_RENDERER)) << " | "
+                  << reinterpret_cast<const char*>(glGetString(GL_VERSION)) << "\n";
+    }
+    gldebug::install(options.glDebug);
+    glstall::setThresholdMs(options.stallMs);
+    startupTimeline.mark("glad + extensions");
+
+    // Set default background colour of framebuffer. Tells OGL to use this colour next clear.
+    // This ONLY sets the colour - it doesn't perform any colouring action.
+    glClearColor(gameConfig.clearColor.r, gameConfig.clearColor.g, gameConfig.clearColor.b, gameConfig.clearColor.a);
+
+    // Set up triangle, shader objects, and load and link shaders
+
+    float vertices[] = {
+
+        -0.25f, -0.25f,  // bottom-left corner (0)
+        0.25f, -0.25f,  // bottom-right corner (1)
+        0.25f,  0.25f,  // top-right corner (2)
+        -0.25f,  0.25f   // top-left corner (3)
+
+    };
+
+    // For use with glDrawElements (more useful for my game):
+    std::uint16_t indices[] = {
+        0, 1, 2,  // draw triangle using vertex 0 → 1 → 2
+        2, 3, 0
+    };
+
+    // Simulation state is stepped at a fixed rate; it keeps the previous step's positions
+    // so rendering can interpolate between the last two steps (see core/fixed_timestep.h).
+    SimState sim;
+    sim.player = spawnPlayer(sim.world, packColor(glm::vec4(1.0f, 0.5f, 0.2f, 1.0f)), options.collisions);
+    // The clips are fixed from here on: the render thread reads them, the UBO gets them once.
+    AnimationClipTable spriteClips;
+    if (options.spriteAnimation) {
+        defineSpriteClips(spriteClips);
+    }
+    spawnWanderers(sim, options.entities, options.collisions, options.spriteAnimation);
+    spawnBoids(sim, options.boids);
+    if (options.turnTimers) {
+        scheduleWandererTurns(sim);
+    }
+    if (!options.recordPath.empty() &&
+        inputRecorder.open(options.recordPath, static_cast<std::uint32_t>(kSimulationHz))) {
+        std::cout << "Input: recording to " << options.recordPath << "\n";
+    }
+    if (replaying) {
+        std::cout << "Input: replaying " << options.replayPath << ", one tick per frame\n";
+        if (inputReplay.ticksPerSecond() != static_cast<std::uint32_t>(kSimulationHz)) {
+            std::cerr << "Input replay: recorded at " << inputReplay.ticksPerSecond() << " ticks/s, simulating at "
+                      << kSimulationHz << "\n";
+        }
+    }
+
+    // --level: opening checks the tables only; regions are read when the camera nears them.
+    LevelFile level;
+    std::unique_ptr<LevelStreamer> levelStreamer;
+    std::vector<std::uint32_t> levelSprites;               // asset → sprite id
+    std::vector<std::vector<EntityHandle>> levelEntities;  // per region, while Live
+    std::vector<int> streamIn, streamOut;
+    std::deque<int> regionsToSpawn;                        // handed out, spawned by the frame budget
+    if (!options.levelPath.empty() && !options.bench.enabled && level.open(options.levelPath)) {
+        CameraRig::Settings rig = sim.camera.settings();
+        rig.bounds = level.bounds();
+        sim.camera = CameraRig(rig);
+        LevelStreamer::Settings streaming;
+        // Everything the widest zoom shows (aspect up to 2), plus a region of slack.
+        streaming.loadRadius = 2.0f / rig.minZoom;
+        streaming.unloadRadius = streaming.loadRadius + level.header().regionSize;
+        levelStreamer = std::make_unique<LevelStreamer>(level, jobs, streaming);
+        levelSprites = resolveLevelSprites(level);
+        levelEntities.resize(level.regionCount());
+        std::cout << "Level: " << options.levelPath << ", " << level.regionsX() << "x" << level.regionsY()
+                  << " regions of " << level.header().regionSize << " units\n";
+    }
+    // --procgen: a noise world around the origin, generated chunk by chunk ahead of the
+    // camera. Tile ids are sprite ids, like the other tilemaps': rings of sand, diamonds
+    // of grass, discs of rock; discs and diamonds on top for trees and boulders.
+    std::unique_ptr<WorldGenerator> worldGen;
+    std::vector<int> generatedChunks;
+    std::vector<int> fieldRequests;     // --procgen-gpu: chunks for the next packet
+    glm::vec2 lastGenFocus(0.0f);
+    if (options.procgenWidth > 0 && !level.isOpen() && !options.bench.enabled) {
+        WorldGenerator::Settings world;
+        world.seed = options.procgenSeed;
+        world.width = options.procgenWidth;
+        world.height = options.procgenHeight;
+        world.tileSize = Tilemap::Options{}.tileSize;
+        world.origin = -0.5f * world.tileSize * glm::vec2(static_cast<float>(world.width), static_cast<float>(world.height));
+        world.palette = WorldGenerator::Palette{2, 3, 1, 4, 6};
+        CameraRig::Settings rig = sim.camera.settings();
+        rig.bounds = Aabb{world.origin, -world.origin};
+        sim.camera = CameraRig(rig);
+        // Everything the widest zoom shows (aspect up to 2), plus a chunk of slack.
+        world.loadRadius = 2.0f / rig.minZoom + WorldGenerator::kChunkTiles * world.tileSize;
+        if (options.procgenGpu) {
+            world.maxInFlight = GpuNoise::kCells * GpuNoise::kCells;   // a full batch
+        }
+        worldGen = std::make_unique<WorldGenerator>(jobs, world);
+        std::cout << "World: " << world.width << "x" << world.height << " tiles, seed " << world.seed << ", "
+                  << worldGen->chunkCount() << " chunks generated as the camera nears them\n";
+    }
+    // Networking (net/replication.h). A client's World is what the server sends, plus its
+    // own player, predicted from its input and corrected by the server (net/prediction.h).
+    ReplicationServer replicationServer;
+    ReplicationClient replicationClient;
+    ClientPrediction prediction;
+    std::uint32_t inputTick = 0;
+    if (options.hostPort > 0 && !headless) {
+        ReplicationServer::Settings serving;
+        serving.port = static_cast<std::uint16_t>(options.hostPort);
+        serving.bounds = levelStreamer ? level.bounds()
+                                       : Aabb{sim.wanderBounds.min - glm::vec2(16.0f), sim.wanderBounds.max + glm::vec2(16.0f)};
+        const bool colliders = options.collisions;
+        serving.spawnPlayer = [colliders](World& world) {
+            return spawnPlayer(world, packColor(glm::vec4(0.3f, 0.9f, 0.4f, 1.0f)), colliders);
+        };
+        if (replicationServer.open(serving)) {
+            std::cout << "Net: serving on UDP port " << serving.port << "\n";
+        } else {
+            std::cerr << "Net: can't listen on UDP port " << serving.port << "\n";
+        }
+    } else if (!options.connectTo.empty() && !headless && !levelStreamer) {
+        NetAddress server;
+        if (NetAddress::parse(options.connectTo, server) && replicationClient.connect(server)) {
+            // Only this client's own player: the rest comes from the server.
+            sim.world.clear();
+            sim.player = spawnPlayer(sim.world, packColor(glm::vec4(1.0f, 0.5f, 0.2f, 1.0f)), false);
+            std::cout << "Net: playing on " << server.toString() << "\n";
+        } else {
+            std::cerr << "Net: can't reach " << options.connectTo << "\n";
+        }
+    }
+    // --telemetry: a port to ask, or an address to tell.
+    Telemetry telemetry;
+    if (!options.telemetry.empty()) {
+        NetAddress agent;
+        if (options.telemetry.find(':') != std::string::npos) {
+            if (NetAddress::parse(options.telemetry, agent) && telemetry.push(agent)) {
+                std::cout << "Telemetry: pushed to " << agent.toString() << " every second\n";
+            } else {
+                std::cerr << "Telemetry: can't reach " << options.telemetry << "\n";
+            }
+        } else {
+            const int port = std::atoi(options.telemetry.c_str());
+            if (port > 0 && port <= 65535 && telemetry.listen(static_cast<std::uint16_t>(port))) {
+                std::cout << "Telemetry: on UDP port " << telemetry.port() << "\n";
+            } else {
+                std::cerr << "Telemetry: can't listen on UDP port " << options.telemetry << "\n";
+            }
+        }
+    }
+    // Rewind and quick-save: the World snapshotted after every step (ecs/snapshot.h). Not
+    // while recording or replaying input (the ticks would stop matching the recording)
+    // nor with --level (the streamer's idea of which regions are in the World would), nor
+    // when the World is a server's.
+    std::unique_ptr<SnapshotHistory> history;
+    std::uint64_t simTick = 0;
+    if (options.rewindSeconds > 0.0 && !options.bench.enabled && !replaying && options.recordPath.empty() &&
+        !levelStreamer && !replicationClient.isOpen()) {
+        SnapshotHistory::Settings settings;
+        settings.capacity = static_cast<std::size_t>(options.rewindSeconds * kSimulationHz);
+        history = std::make_unique<SnapshotHistory>(jobs, settings);
+        history->capture(sim.world, simTick);
+    }
+    // Sound: the mixer runs on its own thread; this one only queues commands to it. Not
+    // in the headless runs. No sound card (or no ALSA) just means no sound.
+    AudioMixer audio;
+    GameSounds sounds;
+    if (options.audio && !headless) {
+        AudioMixer::Settings settings;
+        sounds = addGameSounds(audio, settings.rate);
+        if (!options.musicPath.empty()) {
+            auto music = std::make_unique<AudioStream>();
+            std::string error;
+            if (music->open(options.musicPath, settings.rate, true, &error)) {
+                audio.setStream(std::move(music), 0.5f);
+            } else {
+                std::cerr << "Audio: " << error << "\n";
+            }
+        }
+        if (!options.audioOut.empty()) {
+            settings.device = AudioDevice::Kind::Wav;
+            settings.wavPath = options.audioOut;
+        }
+        if (audio.start(settings)) {
+            std::cout << "Audio: " << audio.deviceName() << ", " << settings.rate << " Hz, " << settings.voices
+                      << " voices\n";
+        } else {
+            std::cout << "Audio: off\n";
+        }
+    }
+    RenderFrame renderFrame;
+    renderFrame.world = &sim.world;
+    renderFrame.clips = options.spriteAnimation ? &spriteClips : nullptr;
+    // --quality-governor: its knobs are applied where each is used (the LOD sizes here and
+    // on a config reload, the rest in the packet). Not headless: benchmarks, replays and
+    // offline rendering draw the same picture whatever the machine.
+    QualityGovernor qualityGovernor;
+    const bool governed = options.qualityGovernor && !headless;
+    if (governed) {
+        qualityGovernor.init(QualityGovernor::Settings{});
+        std::cout << "Quality governor: on, " << QualityGovernor::kLevels << " levels\n";
+    }
+    SpriteLod spriteLod(0);     // sprite 0: the solid square
+    if (options.lod) {
+        describeSpriteLod(spriteLod);
+        configureSpriteLod(spriteLod, spriteClips, gameConfig);
+        renderFrame.lod = &spriteLod;
+    }
+    TaskGraph renderGraph;
+    buildRenderGraph(renderGraph, renderFrame);
+
+    
+    // Static meshes share one vertex buffer and one index buffer (render/mesh_pool.h); the
+    // quad is the first of them. Its indices are relative to its own first vertex: the
+    // draws add Mesh::baseVertex.
+    static const VertexLayout kQuadLayout(2 * sizeof(float), {
+        shaderInput(shaderlayout::vertex::aPos, 2, GL_FLOAT, VertexAttribute::Kind::Float, 0),
+    });
+    MeshPool meshes;
+    meshes.init(kQuadLayout, 4096, 8192);
+    const Mesh quadMesh = meshes.add(vertices, 4, indices, 6);
+    // --shapes: a five-pointed star in the quad's [-0.5, 0.5] space, triangulated once
+    // into the same pool; the sprite batch path draws the wanderers with it.
+    ShapeCache shapes;
+    shapes.init(&meshes);
+    const ShapeCache::Shape* wandererShape = nullptr;
+    if (options.shapes) {
+        glm::vec2 star[10];
+        for (int i = 0; i < 10; ++i) {
+            const float radius = i % 2 == 0 ? 0.5f : 0.2f;
+            const float angle = glm::half_pi<float>() + static_cast<float>(i) * glm::pi<float>() / 5.0f;
+            star[i] = radius * glm::vec2(std::cos(angle), std::sin(angle));
+        }
+        wandererShape = shapes.get(star, 10);
+    }
+
+    // VAOs over fixed buffers (the GPU particles, the tilemap) come from here, one per
+    // distinct (layouts, buffers); see render/vertex_array_cache.h.
+    VertexArrayCache vertexArrays;
+
+    // Create VAO (vertex array object)
+    // Create and bind VAO BEFORE VBO bind, binding VAO "starts recording state"
+    // The GL objects are RAII handles (render/gl_resource.h): dropping one queues its
+    // deletion until the GPU is done with it.
+    // Each instanced renderer records its own attributes into its VAO, so each gets one
+    // of these: the pool's buffers with the quad's aPos, plus room for the instances.
+    auto meshVao = [&meshes] {
+        GlVertexArray vao = GlVertexArray::create();
+        if (glbuffer::direct()) {
+            glext::vertexArrayElementBuffer(vao.get(), meshes.indexBuffer());
+            meshes.layout().enableOn(vao.get(), meshes.vertexBuffer());
+            return vao;
+        }
+        glstate::bindVertexArray(vao.get());
+        glstate::bindBuffer(GL_ARRAY_BUFFER, meshes.vertexBuffer());
+        glstate::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, meshes.indexBuffer());
+        meshes.layout().enable();
+        return vao;
+    };
+    GlVertexArray VAO = meshVao();
+
+    // Per-instance transforms live in a second VBO recorded into the same VAO
+    // (attribute locations 1..4, divisor 1), each instance's colour after them (5). See
+    // render/instanced_quads.h.
+    InstancedQuadRenderer quads;
+    quads.init(VAO.get(), quadMesh, 1024, InstancedQuadRenderer::Format::Mat4, true);
+
+    // Compact variant: 24-byte 2D affine transform per instance instead of a 64-byte mat4.
+    // Its attributes (locations 1..2, vec3) differ from the mat4's, so it records them into
+    // its own VAO over the same pool.
+    GlVertexArray affineVAO = meshVao();
+    InstancedQuadRenderer affineQuads;
+    affineQuads.init(affineVAO.get(), quadMesh, 1024, InstancedQuadRenderer::Format::Affine2D, true);
+
+    // Texture array variant: Affine2D + layer + tint per instance (locations 1..4), or
+    // (--instance-fetch) the same LayeredInstances fetched from a texture buffer.
+    GlVertexArray layeredVAO = meshVao();
+    InstancedQuadRenderer layeredQuads;
+    const bool instanceFetch =
+        options.instanceFetch && layeredQuads.init(layeredVAO.get(), quadMesh, 1024, InstancedQuadRenderer::Format::Layered,
+                                                   false, InstancedQuadRenderer::Storage::TextureBuffer);
+    if (!instanceFetch) {
+        layeredQuads.init(layeredVAO.get(), quadMesh, 1024, InstancedQuadRenderer::Format::Layered);
+        layeredDesc.variant.features &= ~kShaderInstanceFetch;
+        oitDesc.variant.features &= ~kShaderInstanceFetch;
+    }
+    // --sprite-animation: the same + a clip's start and rate per instance (location 5).
+    GlVertexArray animatedVAO = options.spriteAnimation ? meshVao() : GlVertexArray{};
+    InstancedQuadRenderer animatedQuads;
+    if (options.spriteAnimation) {
+        animatedQuads.init(animatedVAO.get(), quadMesh, 1024, InstancedQuadRenderer::Format::Animated);
+    }
+
+    // --gpu-pick: Layered instances of its own, drawn into its own tiny target.
+    GlVertexArray pickVAO = meshVao();
+    GpuPicker gpuPicker;
+    if (options.gpuPick && !gpuPicker.init(pickVAO.get(), quadMesh)) {
+        std::cout << "GPU picking: unavailable (no R32UI render target)\n";
+    }
+    // --procgen-gpu: the world's chunks' noise fields, a batch of them at a time.
+    GpuNoise gpuNoise;
+    if (worldGen && options.procgenGpu && !gpuNoise.init(WorldGenerator::kChunkTiles)) {
+        std::cout << "GPU noise: unavailable (no RG32F render target), generating on the workers\n";
+    }
+    const bool gpuFields = gpuNoise.initialized();
+
+    // --particles=N: state that only ever lives on the GPU (render/particle_system.h),
+    // drawn with this same quad. --particles-cpu: the state is main's SoA arrays and only
+    // the instances are streamed, through their own VAO over the same quad.
+    ParticleSystem particleSystem;
+    ParticlesSoA cpuParticles;
+    Orbiters orbiters;
+    if (options.orbiters > 0) {
+        orbiters.init(options.orbiters);
+    }
+    Critters critters;
+    SkinnedMeshRenderer skinnedMesh;
+    if (options.critters > 0) {
+        critters.init(options.critters, sim.wanderBounds);
+        if (skinnedMesh.init(vertexArrays, critters.vertices.data(), critters.vertices.size(),
+                             critters.indices.data(), critters.indices.size(),
+                             critters.poses.bones() * critters.poses.characters())) {
+            std::cout << "Critters: " << options.critters << " x " << critters.poses.bones() << " bones, "
+                      << critters.indices.size() / 3 << " triangles each\n";
+        }
+    }
+    LightBuffer lightBuffer;
+    LightBuffer::Options lightOptions;
+    lightOptions.tiled = options.lightTiles;
+    if (options.lights > 0 && lightBuffer.init(lightOptions)) {
+        if (lightOptions.tiled) {
+            std::cout << "Lights: " << options.lights << " + the player's, in " << LightBuffer::kTileSize
+                      << "x" << LightBuffer::kTileSize << " pixel tile lists\n";
+        } else {
+            std::cout << "Lights: " << options.lights << " + the player's, into a 1/" << lightOptions.divisor
+                      << " resolution light target\n";
+        }
+    }
+    OitBuffer oitBuffer;
+    if (oit && oitBuffer.init()) {
+        std::cout << "OIT: translucent layered sprites weighted and blended unsorted\n";
+    }
+    GlVertexArray particleVAO = meshVao();
+    InstancedQuadRenderer particleQuads;
+    particleQuads.init(particleVAO.get(), quadMesh, 1024, InstancedQuadRenderer::Format::Particle);
+    // Debug shapes: main fills a DebugDrawList, the packet carries its vertices over.
+    DebugDrawList debugDraw;
+    debugShapes = debugdraw::enabled() && options.debugDraw;
+    if (options.particles > 0 && options.particlesCpu) {
+        cpuParticles.reset(static_cast<std::size_t>(options.particles));
+        std::cout << "Particles: " << options.particles << " on the CPU, "
+                  << options.particles * sizeof(ParticleInstance) / 1024 << " KiB streamed per frame\n";
+    } else if (options.particles > 0 &&
+               particleSystem.init(static_cast<std::size_t>(options.particles), vertexArrays, meshes, quadMesh)) {
+        if (options.gpuCull && !particleSystem.enableCulling()) {
+            std::cout << "GPU culling: unavailable (needs compute shaders and indirect draws, GL 4.3)\n";
+        }
+        std::cout << "Particles: " << options.particles << " on the GPU, "
+                  << particleSystem.stats().bufferBytes / 1024 << " KiB of state"
+                  << (particleSystem.stats().culling ? ", culled on the GPU" : "") << "\n";
+    }
+
+    
+    // Linked programs from earlier launches, if the sources and the driver are unchanged.
+    const double shaderStart = monoclock::seconds();
+    ProgramCache programCache;
+    if (!options.shaderCache.empty() && !programCache.init(options.shaderCache) && !glext::caps().programBinary) {
+        std::cout << "Shader cache: off (driver has no program binary formats)\n";
+    }
+    if (glext::caps().parallelShaderCompile) {
+        glext::maxShaderCompilerThreads(0xFFFFFFFFu); // as many as the driver likes
+    }
+
+    const bool gpuPick = gpuPicker.initialized();
+    const bool skinned = skinnedMesh.initialized();
+
+    startupTimeline.mark("buffers + renderers");
+    // The prefetch has had the whole window + context creation (and the renderers' init)
+    // to run; usually this waits for nothing.
+    jobs.wait(prefetch.counter);
+    startupTimeline.mark("shader load (prefetch)");
+
+    // Submit every compile and link (or load the cached binaries) before checking any:
+    // the driver works through them while the atlas below is uploaded. The sources were
+    // preprocessed by the prefetch.
+    auto begin = [&programCache, &prefetch](const ProgramDesc& desc) {
+        const ProgramSources* sources = prefetch.find(desc);
+        return sources ? beginProgram(programCache, desc, *sources) : beginProgram(programCache, desc);
+    };
+    PendingProgram pendingShader = begin(shaderDesc);
+    PendingProgram pendingAffine = begin(affineDesc);
+    PendingProgram pendingLayered = begin(layeredDesc);
+    PendingProgram pendingSprite = begin(spriteDesc);
+    PendingProgram pendingTilemap = begin(tilemapDesc);
+    PendingProgram pendingParticleUpdate = gpuParticles ? begin(particleUpdateDesc) : PendingProgram{};
+    PendingProgram pendingParticles = particles ? begin(particleDesc) : PendingProgram{};
+    PendingProgram pendingText = begin(textDesc);
+    PendingProgram pendingDebug = debugdraw::enabled() ? begin(debugDesc) : PendingProgram{};
+    PendingProgram pendingHeatmap = options.overdraw ? begin(heatmapDesc) : PendingProgram{};
+    PendingProgram pendingPostBright = postBloom ? begin(postBrightDesc) : PendingProgram{};
+    PendingProgram pendingPostBlur = postBloom ? begin(postBlurDesc) : PendingProgram{};
+    PendingProgram pendingPostFinal = post ? begin(postFinalDesc) : PendingProgram{};
+    PendingProgram pendingPick = gpuPick ? begin(pickDesc) : PendingProgram{};
+    PendingProgram pendingNoise = gpuFields ? begin(noiseDesc) : PendingProgram{};
+    PendingProgram pendingAnimated = animated ? begin(animatedDesc) : PendingProgram{};
+    PendingProgram pendingSkinned = skinned ? begin(skinnedDesc) : PendingProgram{};
+    PendingProgram pendingVirtual = virtualBackground ? begin(virtualDesc) : PendingProgram{};
+    PendingProgram pendingVirtualFeedback = virtualBackground ? begin(virtualFeedbackDesc) : PendingProgram{};
+    PendingProgram pendingLight = litQuads ? begin(lightDesc) : PendingProgram{};
+    PendingProgram pendingLightComposite = lit ? begin(lightCompositeDesc) : PendingProgram{};
+    PendingProgram pendingOit = oit ? begin(oitDesc) : PendingProgram{};
+    PendingProgram pendingOitComposite = oit ? begin(oitCompositeDesc) : PendingProgram{};
+    const double shaderSubmitMs = (monoclock::seconds() - shaderStart) * 1000.0;
+    prefetch.releasePrograms();
+    startupTimeline.mark("shader submit");
+
+    // The batches are the render side's (render/frame_renderer.h); the fonts it draws with
+    // are made here.
+    SdfFont hudFont;
+    hudFont.init();
+    // --font: the HUD's text from a bitmap font instead, through the glyph cache.
+    BitmapFont bitmapFont;
+    GlyphCache glyphCache;
+    if (!options.fontPath.empty()) {
+        std::string error;
+        if (!bitmapFont.loadHex(options.fontPath, &error) || !glyphCache.init(bitmapFont, GlyphCache::Options{})) {
+            std::cerr << "Font " << options.fontPath << ": " << (error.empty() ? "no glyph cache" : error)
+                      << "; the built-in one instead\n";
+        }
+    }
+    hudVisible = options.hud;
+    toolsVisible = options.ui;
+
+    // --profiler-window: a second window on a context that shares this one's objects, so
+    // the font atlas, the text program and the batch's buffers serve both. Container
+    // objects (VAOs) are never shared: it draws through a batch of its own, made here with
+    // its context current. The render thread draws the HUD into it after each frame.
+    GLFWwindow* profilerWindow = nullptr;
+    SpriteBatch profilerBatch;
+    if (options.profilerWindow && !headless) {
+        constexpr int kProfilerWidth = 480, kProfilerHeight = 400; // fits the HUD text and graph
+        profilerWindow = glfwCreateWindow(kProfilerWidth, kProfilerHeight, "Profiler", nullptr, window);
+        if (profilerWindow) {
+            glfwMakeContextCurrent(profilerWindow);
+            glfwSwapInterval(0);        // never waits for a vblank: the main window's swap does
+            glstate::invalidate();      // one bind cache, two contexts
+            profilerBatch.init();
+            glfwMakeContextCurrent(window);
+            glstate::invalidate();
+        } else {
+            std::cerr << "Profiler window: could not create it\n";
+        }
+    }
+
+    // All sprite images on as few pages as possible, so they batch (render/texture_atlas.h).
+    // The prefetch painted and packed them: only the pages' upload is left.
+    if (prefetch.atlasPacked && spriteAtlas.upload()) {
+        const TextureAtlas::Stats& as = spriteAtlas.stats();
+        std::cout << "Sprite atlas: " << as.images << " images on " << as.pages << " page(s), "
+                  << static_cast<int>(as.occupancy * 100.0f + 0.5f) << "% occupied\n";
+    }
+    // The same images as layers of one array texture (render/texture_array.h).
+    TextureArray spriteArray;
+    buildSpriteArray(spriteArray, std::move(prefetch.spriteLayers));
+    // Baked on the first frame's update(); from then on only edited chunks are.
+    Tilemap tilemap;
+    if (level.isOpen() && level.header().tilesPerRegion > 0) {
+        if (buildLevelTilemap(tilemap, options.tilemapMode, vertexArrays, level)) {
+            std::cout << "Tilemap: " << level.tilesX() << "x" << level.tilesY() << " level tiles in "
+                      << tilemap.stats().chunks << " chunks\n";
+        }
+    } else if (worldGen) {
+        Tilemap::Options generated;
+        generated.mode = options.tilemapMode;
+        generated.width = worldGen->settings().width;
+        generated.height = worldGen->settings().height;
+        generated.layers = WorldGenerator::kLayers;
+        generated.tileSize = worldGen->settings().tileSize;
+        generated.origin = worldGen->settings().origin;
+        if (tilemap.init(generated, vertexArrays)) {
+            std::cout << "Tilemap: " << generated.width << "x" << generated.height << " generated tiles in "
+                      << tilemap.stats().chunks << " chunks, empty until generated\n";
+        }
+    } else if (options.tilemap &&
+               buildTilemap(tilemap, options.tilemapMode, vertexArrays, tilemapWidth, tilemapHeight)) {
+        std::cout << "Tilemap: " << tilemapWidth << "x" << tilemapHeight << " tiles in "
+                  << tilemap.stats().chunks << " chunks\n";
+    }
+    // --path-agents, --flow-agents: the grid is main's copy of what blocks; edits reach it
+    // with the tilemap's (below, where the packet takes them), through the service.
+    PathGrid pathGrid;
+    std::unique_ptr<PathService> pathService;
+    PathAgents pathAgents;
+    FlowField flowField;
+    std::uint64_t flowGridVersion = ~std::uint64_t{0};   // pathGrid's rebuilds at its build
+    if (options.pathAgents > 0 || options.flowAgents > 0) {
+        if (tilemap.stats().chunks == 0 || !buildPathGrid(pathGrid, level, worldGen.get())) {
+            logging::warn("Path and flow agents: need --tilemap or a --level with tiles");
+        } else {
+            pathService = std::make_unique<PathService>(pathGrid, jobs, PathService::Settings{});
+            pathAgents.init(options.pathAgents, sim.world, pathGrid);
+            spawnFlowAgents(sim.world, options.flowAgents, pathGrid);
+            std::cout << "Path agents: " << options.pathAgents << " (+ " << options.flowAgents << " on a flow field) on "
+                      << pathGrid.options().width << "x" << pathGrid.options().height << " tiles, "
+                      << pathGrid.stats().nodes << " graph nodes in " << pathGrid.stats().clusters << " clusters\n";
+        }
+    }
+    // --level: each region's props, baked when it streams in (the atlas pages are their
+    // textures; without them the props stay entities, drawn untextured).
+    StaticBatch staticBatch;
+    const bool bakeScenery = levelStreamer && options.staticBatch && spriteAtlas.pageCount() > 0 &&
+                             staticBatch.init(level.regionCount(), vertexArrays);
+    if (bakeScenery) {
+        std::cout << "Static batch: level props baked per region (" << level.regionCount() << " regions)\n";
+    }
+    // Only the top level's page is loaded now; the rest as the feedback asks for them.
+    VirtualTexture virtualTexture;
+    if (virtualBackground) {
+        VirtualTexture::Options vo;
+        vo.pagesX = vo.pagesY = options.virtualPages;
+        vo.pageWorldSize = kBackgroundPageWorldSize;
+        vo.origin = glm::vec2(-0.5f * kBackgroundPageWorldSize * static_cast<float>(options.virtualPages));
+        const int pages = options.virtualPages;
+        if (virtualTexture.init(vo,
+                                [pages](int level, int x, int y, std::uint32_t* texels) {
+                                    paintBackgroundPage(pages, level, x, y, texels);
+                                },
+                                vertexArrays)) {
+            std::cout << "Virtual background: " << pages * VirtualTexture::kPageSize << "² texels, "
+                      << vo.cacheSlots * vo.cacheSlots << " cached pages\n";
+        }
+    }
+
+    startupTimeline.mark("textures + tilemap");
+
+    // Now the status queries. The wrappers reflect all active uniforms once, after link.
+    const int readyEarly = programReady(pendingShader) + programReady(pendingAffine) +
+                           programReady(pendingLayered) + programReady(pendingSprite) +
+                           programReady(pendingTilemap) + programReady(pendingText) +
+                           (gpuParticles ? programReady(pendingParticleUpdate) : 0) +
+                           (particles ? programReady(pendingParticles) : 0) +
+                           (debugdraw::enabled() ? programReady(pendingDebug) : 0) +
+                           (options.overdraw ? programReady(pendingHeatmap) : 0) +
+                           (postBloom ? programReady(pendingPostBright) + programReady(pendingPostBlur) : 0) +
+                           (post ? programReady(pendingPostFinal) : 0) +
+                           (gpuPick ? programReady(pendingPick) : 0) +
+                           (animated ? programReady(pendingAnimated) : 0) +
+                           (skinned ? programReady(pendingSkinned) : 0) +
+                           (virtualBackground ? programReady(pendingVirtual) + programReady(pendingVirtualFeedback) : 0) +
+                           (lit ? programReady(pendingLight) + programReady(pendingLightComposite) : 0) +
+                           (oit ? programReady(pendingOit) + programReady(pendingOitComposite) : 0);
+    // Per-program compile + link wall time; --profile prints the table (profile/shader_timings.h).
+    ShaderTimings shaderTimings;
+    const double shaderCheckStart = monoclock::seconds();
+    // The render side's programs, owned by it from here on (render/frame_renderer.h).
+    FrameRenderer frameRenderer;
+    FrameRenderer::Programs& programs = frameRenderer.programs();
+    programs.quads.reset(finishProgram(programCache, pendingShader, &shaderTimings));
+    programs.affine.reset(finishProgram(programCache, pendingAffine, &shaderTimings));
+    programs.layered.reset(finishProgram(programCache, pendingLayered, &shaderTimings));
+    programs.sprite.reset(finishProgram(programCache, pendingSprite, &shaderTimings));
+    programs.tilemap.reset(finishProgram(programCache, pendingTilemap, &shaderTimings));
+    programs.particleUpdate.reset(finishProgram(programCache, pendingParticleUpdate, &shaderTimings));
+    programs.particles.reset(finishProgram(programCache, pendingParticles, &shaderTimings));
+    programs.text.reset(finishProgram(programCache, pendingText, &shaderTimings));
+    programs.debug.reset(finishProgram(programCache, pendingDebug, &shaderTimings));
+    programs.heatmap.reset(finishProgram(programCache, pendingHeatmap, &shaderTimings));
+    programs.postBright.reset(finishProgram(programCache, pendingPostBright, &shaderTimings));
+    programs.postBlur.reset(finishProgram(programCache, pendingPostBlur, &shaderTimings));
+    programs.postFinal.reset(finishProgram(programCache, pendingPostFinal, &shaderTimings));
+    programs.pick.reset(finishProgram(programCache, pendingPick, &shaderTimings));
+    programs.noise.reset(finishProgram(programCache, pendingNoise, &shaderTimings));
+    programs.animated.reset(finishProgram(programCache, pendingAnimated, &shaderTimings));
+    programs.skinned.reset(finishProgram(programCache, pendingSkinned, &shaderTimings));
+    programs.virtualTexture.reset(finishProgram(programCache, pendingVirtual, &shaderTimings));
+    programs.virtualFeedback.reset(finishProgram(programCache, pendingVirtualFeedback, &shaderTimings));
+    programs.light.reset(finishProgram(programCache, pendingLight, &shaderTimings));
+    programs.lightComposite.reset(finishProgram(programCache, pendingLightComposite, &shaderTimings));
+    programs.oit.reset(finishProgram(programCache, pendingOit, &shaderTimings));
+    programs.oitComposite.reset(finishProgram(programCache, pendingOitComposite, &shaderTimings));
+    // Only when --gpu-cull found the support for it (render/particle_system.h).
+    programs.particleCull.reset(
+        particleSystem.stats().culling ? buildComputeProgram("shaders/particle_cull.glsl") : 0);
+    const double shaderWaitMs = (monoclock::seconds() - shaderCheckStart) * 1000.0;
+    startupTimeline.mark("shader link");
+
+    // The camera UBO, the post chain's effects and the pipelines (render/pipeline_state.h),
+    // over the programs just linked.
+    FrameRenderer::Settings renderSettings;
+    renderSettings.views = 1 + options.split + options.minimap;
+    renderSettings.post = options.post;
+    renderSettings.overdraw = options.overdraw;
+    renderSettings.overdrawCount = options.overdrawCount;
+    renderSettings.oit = oit;
+    renderSettings.animated = animated;
+    renderSettings.renderScale = options.renderScale;
+    renderSettings.msaa = options.msaa;
+    renderSettings.dynamicResolutionMs = options.dynamicResolutionMs;
+    renderSettings.capture = options.capture;
+    renderSettings.captureSettings = options.captureSettings;
+    renderSettings.renderJobs = options.renderJobs;
+    renderSettings.profile = options.profile;
+    renderSettings.startupBench = options.startupBench;
+    renderSettings.startupBenchCsv = options.startupBenchCsv;
+    renderSettings.buildStamp = kBuildStamp;
+    renderSettings.clearColor = gameConfig.clearColor;
+    frameRenderer.init(renderSettings);
+    // Clips (and their clock) in a UBO of their own, at the next binding point.
+    if (animated) {
+        spriteClips.init();
+    }
+    // --thumbnails: every level on the pool's contexts, then straight to shutdown.
+    if (thumbnails) {
+        renderThumbnails(options, window, programs.tilemap.id(), spriteArray, gameConfig.clearColor);
+        glfwSetWindowShouldClose(window, true);
+    }
+    // The tile grid's origin and size. Texture units are the shaders' own.
+    tilemap.setUniforms(programs.tilemap.id());
+    // --instance-fetch: where each draw's first instance is.
+    if (instanceFetch) {
+        layeredQuads.setUniforms(programs.layered.id());
+    }
+    // Where in the palette this frame's bones start.
+    if (skinned) {
+        skinnedMesh.setUniforms(programs.skinned.id());
+    }
+    // The page grid's placement and the image / cache layout.
+    if (virtualTexture.initialized()) {
+        virtualTexture.setUniforms(programs.virtualTexture.id(), false);
+        virtualTexture.setUniforms(programs.virtualFeedback.id(), true);
+    }
+    // The light scale, ambient and tile grid uniforms.
+    if (lightBuffer.initialized()) {
+        lightBuffer.setUniforms(programs.lightComposite.id());
+    }
+    // --oit: the layered program's uniforms again.
+    if (oitBuffer.initialized() && instanceFetch) {
+        layeredQuads.setUniforms(programs.oit.id());
+    }
+
+    const ProgramCache::Stats& ps = programCache.stats();
+    std::cout << "Shaders: " << 6 + (particles ? 1 : 0) + (gpuParticles ? 1 : 0) + (debugdraw::enabled() ? 1 : 0) +
+                                     (options.overdraw ? 1 : 0) + (gpuPick ? 1 : 0) + (animated ? 1 : 0) +
+                                     (skinned ? 1 : 0) + (virtualBackground ? 2 : 0) + (lit ? 1 : 0) + (litQuads ? 1 : 0) +
+                                     (postBloom ? 2 : 0) + (post ? 1 : 0) + (oit ? 2 : 0)
+              << " programs";
+    if (programCache.enabled()) {
+        std::cout << ", " << ps.hits << " from the cache";
+        if (ps.rejected > 0) {
+            std::cout << " (" << ps.rejected << " stale)";
+        }
+    }
+    if (glext::caps().parallelShaderCompile) {
+        std::cout << ", " << readyEarly << " done before their first check";
+    }
+    std::cout << "; " << shaderSubmitMs << " ms to submit, " << shaderWaitMs << " ms waiting at the checks\n";
+    if (options.profile) {
+        shaderTimings.report(std::cout);
+    }
+    if (vfs::mountedPacks() > 0 || vfs::embeddedFiles() > 0) {
+        const vfs::Stats fs = vfs::stats();
+        std::cout << "Files so far: " << fs.embeddedReads << " embedded, " << fs.packReads << " from packs (" << fs.zeroCopy << " read in place), "
+                  << fs.looseReads << " loose\n";
+    }
+
+    // Saving a file in shaders/ rebuilds the programs that use it and swaps them in
+    // between frames, keeping the old one on errors (render/shader_reloader.h).
+    ShaderReloader shaderReloader;
+    // Not with a pack mounted or shaders embedded: the rebuilt programs would read the
+    // same packed / compiled-in sources again.
+    if (options.shaderReload && !options.bench.enabled && vfs::mountedPacks() == 0 && vfs::embeddedFiles() == 0 &&
+        shaderReloader.init("shaders", programCache, &shaderTimings)) {
+        // Bindings come with the program (render/shader_build.h): only the uniforms C++
+        // sets once need setting again.
+        auto layeredUniforms = [&layeredQuads](GLuint program) {
+            if (layeredQuads.storage() == InstancedQuadRenderer::Storage::TextureBuffer) {
+                layeredQuads.setUniforms(program);
+            }
+            return true;
+        };
+        shaderReloader.watch(programs.quads, shaderDesc);
+        shaderReloader.watch(programs.affine, affineDesc);
+        shaderReloader.watch(programs.layered, layeredDesc, layeredUniforms);
+        if (animated) {
+            shaderReloader.watch(programs.animated, animatedDesc);
+        }
+        if (skinned) {
+            shaderReloader.watch(programs.skinned, skinnedDesc, [&skinnedMesh](GLuint program) {
+                skinnedMesh.setUniforms(program);
+                return true;
+            });
+        }
+        if (virtualTexture.initialized()) {
+            shaderReloader.watch(programs.virtualTexture, virtualDesc, [&virtualTexture](GLuint program) {
+                virtualTexture.setUniforms(program, false);
+                return true;
+            });
+            shaderReloader.watch(programs.virtualFeedback, virtualFeedbackDesc, [&virtualTexture](GLuint program) {
+                virtualTexture.setUniforms(program, true);
+                return true;
+            });
+        }
+        if (lightBuffer.initialized()) {
+            if (litQuads) {
+                shaderReloader.watch(programs.light, lightDesc);
+            }
+            shaderReloader.watch(programs.lightComposite, lightCompositeDesc, [&lightBuffer](GLuint program) {
+                lightBuffer.setUniforms(program);
+                return true;
+            });
+        }
+        if (oitBuffer.initialized()) {
+            shaderReloader.watch(programs.oit, oitDesc, layeredUniforms);
+            shaderReloader.watch(programs.oitComposite, oitCompositeDesc);
+        }
+        PostProcessChain& postChain = frameRenderer.post();
+        if (postChain.enabled()) {
+            auto watchPost = [&](ShaderProgram& program, const ProgramDesc& desc, PostProgram which) {
+                shaderReloader.watch(program, desc, [&postChain, which](GLuint id) {
+                    postChain.setUniforms(which, id);
+                    return true;
+                });
+            };
+            if (postBloom) {
+                watchPost(programs.postBright, postBrightDesc, PostProgram::Bright);
+                watchPost(programs.postBlur, postBlurDesc, PostProgram::Blur);
+            }
+            watchPost(programs.postFinal, postFinalDesc, PostProgram::Final);
+        }
+        shaderReloader.watch(programs.sprite, spriteDesc);
+        shaderReloader.watch(programs.text, textDesc);
+        shaderReloader.watch(programs.tilemap, tilemapDesc, [&tilemap](GLuint program) {
+            tilemap.setUniforms(program);
+            return true;
+        });
+        if (particles) {
+            if (gpuParticles) {
+                shaderReloader.watch(programs.particleUpdate, particleUpdateDesc);
+            }
+            shaderReloader.watch(programs.particles, particleDesc);
+        }
+        if (debugdraw::enabled()) {
+            shaderReloader.watch(programs.debug, debugDesc);
+        }
+        if (gpuPick) {
+            shaderReloader.watch(programs.pick, pickDesc);
+        }
+        if (gpuFields) {
+            shaderReloader.watch(programs.noise, noiseDesc);
+        }
+        std::cout << "Shader hot-reload: watching shaders/\n";
+    }
+
+    // Image files: decoded on the loader's own thread, uploaded through a PBO ring by the
+    // render thread a budget per frame (render/texture_loader.h). Placeholder 0: until the
+    // image is in, the player keeps its atlas image. --texture-budget / --texture-cache:
+    // residency, with reloads from compressed copies in memory.
+    TextureLoader textureLoader;
+    TextureLoader::Options textureOptions;
+    textureOptions.gpuBudgetBytes = options.textureBudgetMb << 20;
+    textureOptions.cpuBudgetBytes = options.textureCacheMb << 20;
+    textureLoader.init(0, textureOptions);
+    TextureLoader::Handle playerTexture = TextureLoader::kInvalidHandle;
+    if (!options.playerTexture.empty()) {
+        playerTexture = textureLoader.request(options.playerTexture);
+    }
+
+    // Everything is now ready, enter draw loop.
+    // Main game/render loop, runs until close button is pressed or glfwSetWindowShouldClose(window, true) is called
+
+    // Start time measure: integer ticks, which keep their resolution over weeks of uptime
+    // (core/clock.h).
+    monoclock::Ticks lastFrameTicks = monoclock::now();
+    FixedTimestep simClock(kSimulationHz);
+
+    // Register every input callback ONCE. keyCallback still handles the toggles; it is
+    // forwarded to from Input's own key callback (GLFW allows only one per window).
+    Input input;
+    input.install(window, keyCallback);
+    glfwSetWindowRefreshCallback(window, [](GLFWwindow*) { windowDamaged = true; });
+
+    // Idle: paused (ESC), in the background or minimised. Not the benchmarks (they must
+    // keep drawing), nor a networked game (the other side expects ticks), nor
+    // --startup-bench. Nothing is simulated, and no frame is drawn unless one is owed:
+    // the loop sleeps in glfwWaitEventsTimeout instead.
+    //
+    // | Owed a frame when                   | Why                                       |
+    // | ----------------------------------- | ----------------------------------------- |
+    // | idle starts                         | the paused state itself has to be shown   |
+    // | input was queued (keys, resize...)  | a toggle or the new size changes the view |
+    // | the window system asks (refresh)    | uncovered / damaged window contents       |
+    //
+    // The timeout only bounds how long a wake-up nothing else triggers can be late.
+    constexpr double kIdleWaitSeconds = 0.5;
+    bool wasIdle = false;
+
+    // Damage tracking: a frame whose packet would draw exactly what the last presented one
+    // did (FramePacket::contentHash) is not submitted at all: no GL, no swap. The loop then
+    // sleeps in glfwWaitEventsTimeout for a simulation step instead of polling. A frame is
+    // presented anyway when
+    //
+    // | Trigger                                  | Why                                     |
+    // | ---------------------------------------- | --------------------------------------- |
+    // | the window system asks (refresh)         | its copy of the window is gone          |
+    // | tile edits, a pick, a --profile report   | one-shot work the packet carries        |
+    // | --procgen-gpu chunks to generate         | likewise                                |
+    // | GPU particles simulate (deltaTime > 0)   | their state lives on the GPU only       |
+    // | a pick readback is outstanding           | only frames poll for it                 |
+    // | the render side reported renderBusy      | texture, glyph uploads, shader rebuilds |
+    // | kDamageHeartbeatSeconds without a frame  | file watchers and anything missed above |
+    //
+    // Not in the benchmarks, --startup-bench or with --capture (every frame is the point).
+    const bool damageTracking =
+        options.damageTracking && !headless && !options.startupBench && !options.capture;
+    constexpr double kDamageHeartbeatSeconds = 0.25;
+    std::uint64_t presentedContent = 0;
+    double lastPresentTime = 0.0;
+    bool skippedFrame = false;     // the previous frame wasn't submitted
+
+    // Key bindings: adding keys here changes lookup tables only, not per-frame work.
+    InputState& bindings = input.state();
+    bindKeys(bindings, gameConfig);
+    defineCommands(commands);
+    bindCommands(commands, gameConfig);
+    Gamepads gamepads;                  // polled each frame; not in benchmarks or replays
+    bindGamepads(gamepads, gameConfig);
+    double padChangeSeen = 0.0;
+    // Raw input (a key callback's timestamp, or the poll that saw a pad change) to the end
+    // of the frame's simulation, which is when it has taken effect; the render thread's
+    // photonLatency takes it on to the screen.
+    LatencyHistogram simulatedLatency;
+    double unpresentedInput = 0.0;      // the oldest input no presented packet reflects yet
+    // Saving the config file reloads it (reloadConfig, applied between frames). Not for
+    // benchmarks: they run with what they started with.
+    FileWatcher configWatcher;
+    const std::filesystem::path configFsPath(configFile);
+    const std::string configName = configFsPath.filename().string();
+    if (!headless) {
+        configWatcher.init(configFsPath.has_parent_path() ? configFsPath.parent_path().string() : ".");
+    }
+    TaskScheduler tasks(jobs);          // multi-frame work on this thread: see core/frame_task.h
+    ConfigReload configReload;
+    configReload.path = configFile;
+    configReload.apply = [&](const GameConfig& next) {
+        applyConfig(next, window, input.state(), sim, options, headless);
+        configureSpriteLod(spriteLod, spriteClips, gameConfig, qualityGovernor.knobs().lodScale);
+        bindGamepads(gamepads, gameConfig);
+    };
+    registerSystems(sim, jobs);
+    // Event channels and who handles them, all on this thread inside events.dispatch():
+    // the toggles before a frame's steps (so they apply from its first step, live or
+    // replayed), the bounces after them, heard from where the camera ended up.
+    bool paused = false;
+    glm::vec2 listenerPos(0.0f);
+    glm::vec2 listenerHalfExtent(1.0f);
+    events.declare<PauseToggled, 16>();
+    events.declare<ScaleToggled, 16>();
+    events.declare<ProjectionToggled, 16>();
+    events.declare<BounceEvent, kBounceEvents>();
+    events.subscribe<PauseToggled>([&paused](const PauseToggled*, std::size_t count) {
+        if (count % 2 != 0) {
+            paused = !paused;
+            logging::info(paused ? "Game Paused" : "Game Unpaused");
+        }
+    });
+    events.subscribe<ScaleToggled>([&sim](const ScaleToggled*, std::size_t count) {
+        sim.scaleUp ^= count % 2 != 0;
+    });
+    events.subscribe<ProjectionToggled>([](const ProjectionToggled*, std::size_t count) {
+        if (count % 2 != 0) {
+            camera.toggleProjection();
+            logging::info("Projection mode: %s", camera.orthographic() ? "Orthographic" : "Perspective");
+        }
+    });
+    events.subscribe<BounceEvent>([&](const BounceEvent* bounces, std::size_t count) {
+        if (audio.running()) {
+            playBounceSounds(audio, sounds, bounces, count, listenerPos, listenerHalfExtent);
+        }
+    });
+    // glfwSetCursorPosCallback(window, cursorPositionCallback);
+
+    // Everything sized to the window follows framebuffer resizes here, driven by the
+    // FramebufferResize events Input queues from GLFW's callback. The size is asked for
+    // exactly once, below; the frame itself never queries the window system. The
+    // viewport travels in the frame packet: glViewport is the render thread's.
+    //
+    // With --split / --minimap the window holds several views (render/frame_packet.h
+    // FrameView), each with its own Camera sized to its part of the window. The main
+    // camera's view keeps the window's top-left corner, so clicks unproject through it.
+    struct ExtraView {
+        enum class Kind { FollowPlayer, Minimap };
+        Kind kind;
+        Camera camera;
+        glm::vec4 rect;         // fractions of the window, as FrameView::rect
+    };
+    const glm::vec4 mainViewRect(0.0f, 0.0f, options.split ? 0.5f : 1.0f, 1.0f);
+    std::vector<ExtraView> extraViews;
+    if (options.split) {
+        extraViews.push_back(ExtraView{ExtraView::Kind::FollowPlayer, Camera(), glm::vec4(0.5f, 0.0f, 0.5f, 1.0f)});
+    }
+    if (options.minimap) {
+        extraViews.push_back(ExtraView{ExtraView::Kind::Minimap, Camera(), glm::vec4(0.0f)});
+    }
+    int viewportWidth = 0, viewportHeight = 0;
+    auto onFramebufferResize = [&](int newWidth, int newHeight) {
+        viewportWidth = newWidth;
+        viewportHeight = newHeight;
+        const glm::ivec4 mainPixels = viewPixels(mainViewRect, newWidth, newHeight);
+        camera.setViewport(mainPixels.z, mainPixels.w); // projection rebuilt on next update()
+        sim.camera.setAspect(camera.aspect());   // for the rig's bounds
+        for (ExtraView& extra : extraViews) {
+            // The minimap: a quarter of the window's height, the shape of the camera's
+            // bounds, in the top-right corner, showing all of them.
+            const Aabb& world = sim.camera.settings().bounds;
+            const glm::vec2 size = world.max - world.min;
+            if (extra.kind == ExtraView::Kind::Minimap) {
+                const float height = 0.25f;
+                const float width = std::min(height * size.x / size.y * static_cast<float>(newHeight) /
+                                                 static_cast<float>(std::max(newWidth, 1)),
+                                             0.45f);
+                extra.rect = glm::vec4(1.0f - width - 0.01f, 1.0f - height - 0.01f, width, height);
+            }
+            const glm::ivec4 pixels = viewPixels(extra.rect, newWidth, newHeight);
+            extra.camera.setViewport(pixels.z, pixels.w);
+            if (extra.kind == ExtraView::Kind::Minimap) {
+                extra.camera.setPosition(0.5f * (world.min + world.max));
+                extra.camera.setZoom(std::min(extra.camera.aspect() / (0.5f * size.x), 1.0f / (0.5f * size.y)));
+            }
+        }
+        // The offscreen scene target follows on the render thread: it is asked for at the
+        // packet's viewport size times the render scale (render/render_target.h).
+    };
+    {
+        int initialWidth, initialHeight;
+        glfwGetFramebufferSize(window, &initialWidth, &initialHeight);
+        onFramebufferResize(initialWidth, initialHeight);
+    }
+
+    // Swap interval + frame cap. Needs the context current (it is, since glad loaded).
+    FramePacer pacer;
+    pacer.init(options.pacing);
+    std::cout << "Vsync: " << FramePacer::name(pacer.effectiveVsync());
+    if (options.pacing.fpsCap > 0.0) {
+        std::cout << ", fps cap: " << options.pacing.fpsCap;
+    }
+    std::cout << (pacer.lowLatency() ? ", low-latency" : "") << "\n";
+    double refreshHz = 0.0;             // the frame budget's period with vsync
+    if (GLFWmonitor* monitor = headless ? nullptr : glfwGetPrimaryMonitor()) {
+        if (const GLFWvidmode* mode = glfwGetVideoMode(monitor)) {
+            refreshHz = static_cast<double>(mode->refreshRate);
+        }
+    }
+
+    // Frame profilers: CPU + GPU (GL_TIME_ELAPSED) time per section, rolling min/avg/p99.
+    // One per thread (a Profiler isn't shared): the main thread's is CPU-only, the render
+    // thread's (render/frame_renderer.h) has the GPU queries.
+    Profiler profiler;
+    profiler.init(false, "main");
+    const Profiler::SectionId simulateSection = profiler.section("simulate");
+    const Profiler::SectionId waitSection = profiler.section("wait");    // for a free packet
+    const Profiler::SectionId buildSection = profiler.section("build");  // extract..compose
+    const Profiler::SectionId particleCpuSection = profiler.section("particles"); // --particles-cpu
+    const Profiler::SectionId hudSection = profiler.section("hud");             // F2
+
+    // --scripts: after every other system, so they see this step's movement. Scripts know
+    // the components and actions bound here, nothing else.
+    ScriptBindings scriptBindings;
+    ScriptHost scriptHost;
+    float scriptTime = 0.0f;
+    if (!options.scriptsDir.empty() && !options.bench.enabled) {
+        using Member = ScriptBindings::Member;
+        const auto x = static_cast<std::uint32_t>(offsetof(Position, value));
+        const auto y = static_cast<std::uint32_t>(x + sizeof(float));
+        scriptBindings.bind<Position>("Position", {{"x", x}, {"y", y}});
+        scriptBindings.bind<PreviousPosition>("PreviousPosition", {{"x", x}, {"y", y}});
+        scriptBindings.bind<Velocity>("Velocity", {{"x", x}, {"y", y}});
+        scriptBindings.bind<Scale>("Scale", {{"x", x}, {"y", y}});
+        scriptBindings.bind<Rotation>("Rotation", {{"radians", 0}});
+        scriptBindings.bind<Controllable>("Controllable", {{"speed", 0}});
+        scriptBindings.bind<Color>("Color", {{"r", 0, Member::Kind::Unorm8}, {"g", 1, Member::Kind::Unorm8},
+                                             {"b", 2, Member::Kind::Unorm8}, {"a", 3, Member::Kind::Unorm8}});
+        for (ActionId a = 0; a < kGameActionCount; ++a) {
+            scriptBindings.bindAction(kGameActionNames[a], a);
+        }
+        if (scriptHost.init(options.scriptsDir, scriptBindings, &profiler)) {
+            sim.systems.add("scripts", [&scriptHost, &scriptTime, &input](World& w, float dt) {
+                scriptTime += dt;
+                ScriptContext context;
+                context.dt = dt;
+                context.time = scriptTime;
+                context.actions = input.state().actions();
+                scriptHost.run(w, context);
+            });
+        }
+    }
+    ParticleStep particleStep;
+    PerfHud perfHud;
+    PerfHud::Timings hudMainTimings;
+    double nextReportTime = monoclock::seconds() + 2.0;
+
+
+    // Benchmark: fixed scene, fixed frame count, frame-time report at the end.
+    BenchScene benchScene;
+    BenchReport benchReport;
+    std::vector<std::uint32_t> benchVisible; // --bench-cull: visible object indices
+    Transforms2D benchCulled;                // --bench-cull: visible objects, compacted
+    std::vector<Aabb> benchBounds;           // --bench-cull=grid|quadtree: this frame's bounds
+    UniformGrid benchGrid(0.5f);             // ~2x the quad size; see core/uniform_grid.h
+    LooseQuadtree benchTree;                 // root fitted to the scene by rebuild()
+    SpatialIndex* benchIndex = nullptr;      // whichever of the two is under test
+    int benchFrame = 0;
+    std::uint64_t offlineFrame = 0;     // --offline: frames simulated, and drawn
+    if (options.bench.enabled) {
+        if (options.bench.path == BenchPath::Batched && options.bench.quads > static_cast<int>(SpriteBatch::kMaxSprites)) {
+            // The batcher's stream segment holds kMaxSprites per frame; more would be dropped.
+            std::cerr << "Bench: batched path limited to " << SpriteBatch::kMaxSprites << " quads\n";
+            options.bench.quads = static_cast<int>(SpriteBatch::kMaxSprites);
+        }
+        if (options.bench.scene == BenchSceneKind::Tilemap) {
+            // The camera pans over the whole map, however big it is.
+            const float halfWidth = 0.5f * Tilemap::Options{}.tileSize * static_cast<float>(tilemapWidth);
+            const float halfHeight = 0.5f * Tilemap::Options{}.tileSize * static_cast<float>(tilemapHeight);
+            options.bench.world = std::max({options.bench.world, halfWidth / camera.aspect(), halfHeight});
+        }
+        benchScene.init(benchSceneQuads(options.bench), camera.aspect(), options.bench.world, options.bench.scene);
+        benchReport.reserve(options.bench.frames);
+        std::cout << "Bench: " << benchSceneName(options.bench.scene) << " scene, ";
+        if (options.bench.scene == BenchSceneKind::Tilemap) {
+            std::cout << tilemapWidth << "x" << tilemapHeight << " tiles, ";
+        } else if (options.bench.scene == BenchSceneKind::Particles) {
+            std::cout << options.particles << " particles, ";
+        } else {
+            std::cout << options.bench.quads << " quads, ";
+        }
+        std::cout << benchPathName(options.bench.path) << ", "
+                  << options.bench.warmup << " warmup + " << options.bench.frames << " frames, "
+                  << "world " << options.bench.world << "x" << options.bench.world << " screens"
+                  << ", cull " << benchCullName(options.bench.cull) << "\n";
+        if (options.bench.cull == BenchCull::Grid || options.bench.cull == BenchCull::Quadtree) {
+            benchIndex = options.bench.cull == BenchCull::Grid ? static_cast<SpatialIndex*>(&benchGrid) : &benchTree;
+            benchScene.update(0);
+            benchBounds.resize(benchScene.size());
+            transformBounds(benchScene.transforms(), 0.25f, benchBounds.data());
+            benchIndex->rebuild(benchBounds.data(), benchBounds.size());
+        }
+    }
+
+    // Picking: the drawable entities (ids = their position in the last frame's render
+    // extraction; renderFrame.handles maps back) live in the picker's spatial index so a
+    // click tests the few objects near the cursor, not all of them (render/picker.h).
+    // Dragging with the left button held collects the cursor path; on release everything
+    // it crossed is picked in one batch.
+    Picker picker;
+    std::vector<glm::vec2> dragPath;
+    bool dragging = false;
+    // F4 / --ui: the tools panel's widgets, fed the mouse from the same events. A click on
+    // the panel is the panel's, not a pick.
+    ImmediateUi ui;
+    ImmediateUi::Input uiInput;
+    // --gpu-pick: the click waiting for the next packet, and the clicks whose ids are on
+    // their way back (candidate index + 1 → handle), oldest first.
+    struct GpuPick {
+        std::uint64_t request;
+        std::vector<EntityHandle> handles;
+    };
+    std::vector<LayeredInstance> gpuPickInstances;
+    std::uint64_t gpuPickRequest = 0;  // the last click's; 0: none waiting for a packet
+    glm::dvec2 gpuPickCursor{0.0};
+    std::deque<GpuPick> gpuPicks;
+    std::uint64_t gpuPickRequests = 0;
+    // The last click and what it hit, for the debug shapes; and the visible objects' bounds.
+    glm::vec2 debugPick{0.0f};
+    std::vector<Aabb> debugPicked;
+    std::vector<Aabb> debugBounds;
+    // Right clicks on the tilemap, until the next packet carries them to the render side.
+    std::vector<TileEdit> tileEdits;
+    // --level: regions to bake into (or drop from) the render side's StaticBatch, likewise.
+    std::vector<StaticBatchEdit> sceneryEdits;
+
+    // Render side
+    // -----------
+    // Every GL call of a frame, made with nothing but the packet the main thread
+    // submitted (render/frame_renderer.h). Runs on the render thread, or inline with
+    // --no-render-thread. The GL objects above belong to this side from
+    // renderThread.start() until renderThread.stop().
+    FrameRenderer::Resources renderResources;
+    renderResources.window = window;
+    renderResources.profilerWindow = profilerWindow;
+    renderResources.profilerBatch = &profilerBatch;
+    renderResources.pacer = &pacer;
+    renderResources.startupTimeline = &startupTimeline;
+    renderResources.shaderReloader = &shaderReloader;
+    renderResources.textureLoader = &textureLoader;
+    renderResources.playerTexture = playerTexture;
+    renderResources.glyphCache = &glyphCache;
+    renderResources.hudFont = &hudFont;
+    renderResources.spriteAtlas = &spriteAtlas;
+    renderResources.spriteArray = &spriteArray;
+    renderResources.wandererShape = wandererShape;
+    renderResources.quads = &quads;
+    renderResources.affineQuads = &affineQuads;
+    renderResources.layeredQuads = &layeredQuads;
+    renderResources.animatedQuads = &animatedQuads;
+    renderResources.particleQuads = &particleQuads;
+    renderResources.particleSystem = &particleSystem;
+    renderResources.skinnedMesh = &skinnedMesh;
+    renderResources.lightBuffer = &lightBuffer;
+    renderResources.oitBuffer = &oitBuffer;
+    renderResources.gpuPicker = &gpuPicker;
+    renderResources.gpuNoise = &gpuNoise;
+    renderResources.worldGen = worldGen.get();
+    renderResources.tilemap = &tilemap;
+    renderResources.staticBatch = bakeScenery ? &staticBatch : nullptr;
+    renderResources.level = &level;
+    renderResources.levelSprites = &levelSprites;
+    renderResources.virtualTexture = &virtualTexture;
+    renderResources.spriteClips = &spriteClips;
+    renderResources.meshes = &meshes;
+    renderResources.vertexArrays = &vertexArrays;
+    frameRenderer.attach(renderResources);
+
+    // From here on the GL context belongs to the render thread.
+    startupTimeline.mark("game setup");
+    RenderThread renderThread;
+    renderThread.start(window, [&frameRenderer](FramePacket& packet) { frameRenderer.render(packet); },
+                       options.renderThread);
+    std::cout << "Render thread: " << (renderThread.threaded() ? "on" : "off") << "\n";
+
+    // Deferrable main-thread work, in slices that fit the frame (core/frame_budget.h). Not
+    // in benchmarks, replays or offline rendering: they run everything, every frame.
+    FrameBudget frameBudget;
+    FrameBudget::Settings budgetSettings;
+    budgetSettings.unlimited = headless || !options.frameBudget;
+    frameBudget.setSettings(budgetSettings);
+    if (levelStreamer) {
+        frameBudget.add("streaming", 2.0, [&] {
+            if (regionsToSpawn.empty()) {
+                return false;
+            }
+            const int region = regionsToSpawn.front();
+            regionsToSpawn.pop_front();
+            spawnLevelRegion(sim, level, region, levelSprites, levelEntities[region], tileEdits,
+                             bakeScenery ? &sceneryEdits : nullptr);
+            return !regionsToSpawn.empty();
+        });
+    }
+    if (pathService) {
+        frameBudget.add("paths", 1.0, [&] {
+            pathService->update();      // last batch's callbacks: new paths
+            return false;
+        });
+        frameBudget.add("agents", 1.0, [&] { return pathAgents.update(sim.world, *pathService); });
+    }
+
+    double mainWorkMs = 0.0;            // the last frame's, up to presenting (--quality-governor)
+
+    while (!glfwWindowShouldClose(window)) {
+        const bool idle = options.idleWait && !headless && !options.startupBench && !replicationServer.isOpen() &&
+                          !replicationClient.isOpen() &&
+                          (paused || !glfwGetWindowAttrib(window, GLFW_FOCUSED) ||
+                           glfwGetWindowAttrib(window, GLFW_ICONIFIED));
+        const bool frameOwed = !idle || !wasIdle || windowDamaged || !input.empty();
+        wasIdle = idle;
+        if (!frameOwed) {
+            glfwWaitEventsTimeout(kIdleWaitSeconds);
+            lastFrameTicks = monoclock::now(); // the wait is not simulated time
+            continue;
+        }
+        const bool repaint = windowDamaged;
+        windowDamaged = false;
+        const double benchFrameStart = monoclock::seconds();
+        // Per-frame scratch on this thread starts over; the counters say whether the frame
+        // still reached the heap (want: 0 once the arenas and reused buffers have grown).
+        FrameArena::thisThread().reset();
+        const std::uint64_t mainAllocationsBefore = alloccount::thread();
+        const std::uint64_t allAllocationsBefore = alloccount::total();
+        const std::uint64_t mainBytesBefore = alloccount::threadBytes();
+        const std::uint64_t allBytesBefore = alloccount::totalBytes();
+        profiler.beginFrame();
+        if (pacer.lowLatency()) {
+            // Low-latency: idle first, THEN sample input, so the newest input is used.
+            pacer.waitForNextFrame();
+            input.newFrame();
+            if (skippedFrame) {
+                glfwWaitEventsTimeout(simClock.dt());
+            } else {
+                glfwPollEvents();
+            }
+        }
+        if (!headless) {
+            gamepads.poll(monoclock::seconds());
+            input.state().setPad(gamepads.actions(), gamepads.analog());
+        }
+        events.dispatch(FrameArena::thisThread());     // the toggles polled since last frame
+
+        const monoclock::Ticks currentFrameTicks = monoclock::now();
+        const monoclock::Ticks frameTicks = currentFrameTicks - lastFrameTicks;
+        lastFrameTicks = currentFrameTicks;
+        const double currentFrameTime = offline ? static_cast<double>(offlineFrame) * simClock.dt()
+                                                : monoclock::toSeconds(currentFrameTicks);
+        const double frameTime = offline ? simClock.dt() : monoclock::toSeconds(frameTicks);
+        if (!skippedFrame) {            // not a frame that slept waiting for events
+            flightrec::frame(frameTime * 1000.0);
+            if (hitchCapture) {
+                hitchDetector.frame(frameTime * 1000.0, currentFrameTime);
+            }
+        }
+
+        // Fixed-step simulation: 0..N steps of exactly simClock.dt() this frame, regardless
+        // of how fast we render. Paused = no steps at all (and no interpolation drift).
+        // A replay runs exactly one recorded tick per frame, however long the frame took:
+        // the same steps in the same order every run, so only the frame times differ.
+        // --offline likewise: frame N shows simulated time N * dt.
+        int steps = replaying || offline ? 1 : paused || idle ? 0 : simClock.advance(frameTicks);
+        scriptHost.reload();            // scripts saved since the last frame
+        for (const std::string& name : configWatcher.poll()) {
+            if (name == configName) {
+                tasks.spawn(reloadConfig(&configReload, ++configReload.generation));
+            }
+        }
+        tasks.update(frameTime);        // waits that are over resume: a reload, say
+        profiler.begin(simulateSection);
+        if (!options.saveFile.empty() && (quickSave || quickLoad)) {
+            const double start = monoclock::seconds();
+            std::string error;
+            savefile::LoadStats loaded;
+            if (quickSave && savefile::write(sim.world, simTick, options.saveFile, &error)) {
+                logging::info("Saved tick %llu to %s (%.1f ms)", static_cast<unsigned long long>(simTick),
+                              options.saveFile.c_str(), (monoclock::seconds() - start) * 1000.0);
+            } else if (quickLoad && savefile::load(sim.world, options.saveFile, &simTick, &loaded, &error)) {
+                logging::info("Loaded tick %llu: %zu entities, %zu chunks mapped, %zu copied (%.2f ms)",
+                              static_cast<unsigned long long>(simTick), loaded.entities, loaded.mappedChunks,
+                              loaded.copiedChunks, (monoclock::seconds() - start) * 1000.0);
+            } else {
+                logging::warn("%s: %s", quickSave ? "Save" : "Load", error.c_str());
+            }
+        } else if (history && (quickSave || quickLoad)) {
+            if (quickSave && history->save()) {
+                logging::info("Quick-saved tick %llu", static_cast<unsigned long long>(simTick));
+            } else if (quickLoad && history->load(sim.world, &simTick)) {
+                logging::info("Quick-loaded tick %llu", static_cast<unsigned long long>(simTick));
+            } else if (quickLoad) {
+                logging::warn("Quick-load: nothing saved yet (F5)");
+            }
+        }
+        quickSave = quickLoad = false;
+        frameBudget.setPeriod(targetFramePeriod(options.pacing, refreshHz));
+        frameBudget.run(currentFrameTicks);
+        if (pathService) {
+            int goalX = 0, goalY = 0;
+            const Position* player = sim.world.get<Position>(sim.player);
+            if (options.flowAgents > 0 && player && pathGrid.tileAt(player->value, goalX, goalY) &&
+                (glm::ivec2(goalX, goalY) != flowField.goal() || pathGrid.stats().rebuilds != flowGridVersion)) {
+                flowField.build(pathGrid, glm::ivec2(goalX, goalY), jobs);
+                flowGridVersion = pathGrid.stats().rebuilds;
+                sim.flow = &flowField;
+            }
+        }
+        for (int step = 0; step < steps; ++step) {
+            if (replicationClient.isOpen()) {
+                // Only the player moves here, at once; the server steps the same input later.
+                const ActionMask actions = input.state().actions();
+                replicationClient.pushInput(++inputTick, actions);
+                const glm::vec2 moved = predictPlayer(sim, actions, static_cast<float>(simClock.dt()));
+                prediction.record(inputTick, actions, moved);
+                stepCameras(sim, input.state(), static_cast<float>(simClock.dt()));
+                continue;
+            }
+            if (history && rewinding) {
+                // Backwards, a snapshot per step; where the history ends, it stays.
+                history->rewind(sim.world, &simTick);
+                stepCameras(sim, input.state(), static_cast<float>(simClock.dt()));
+                continue;
+            }
+            if (replaying) {
+                ActionMask actions = 0;
+                if (!inputReplay.next([](int key, int action, int mods) { keyCallback(nullptr, key, 0, action, mods); },
+                                      actions)) {
+                    glfwSetWindowShouldClose(window, true);
+                    steps = step;
+                    break;
+                }
+                events.dispatch(FrameArena::thisThread());   // its toggles, on this tick
+                input.state().setActions(actions);
+            }
+            inputRecorder.tick(input.state().actions());
+            replicationServer.stepInputs(sim.world);
+            updateSimulation(sim, input.state(), static_cast<float>(simClock.dt()));
+            if (history) {
+                history->capture(sim.world, ++simTick);
+            }
+        }
+        profiler.end(simulateSection);
+
+        // Render the state between the last two steps (alpha = leftover fraction of a step);
+        // a replay (or --offline) always draws the newest one.
+        const float alpha = replaying || offline ? 1.0f : static_cast<float>(simClock.alpha());
+        const CameraView cameraView = sim.camera.interpolate(alpha);
+        glm::vec2 cameraPos = cameraView.position;
+        float cameraZoom = cameraView.zoom;
+        listenerPos = cameraPos;
+        listenerHalfExtent = glm::vec2(camera.aspect(), 1.0f) / cameraZoom;
+        events.dispatch(FrameArena::thisThread());     // the steps' bounces
+        if (options.bench.enabled) {
+            // Scene and camera are functions of the frame index only: identical every run.
+            benchScene.update(static_cast<std::uint64_t>(benchFrame));
+            cameraPos = benchScene.cameraPosition(static_cast<std::uint64_t>(benchFrame));
+            cameraZoom = 1.0f;
+        }
+
+        // Using GLM, we just send the transformation matrix to the GPU. The shader code
+        // already applies the model transformation matrix (which, when run in the shader
+        // code, will contain all the transformations we wish to apply when constructed
+        // and composed correctly), so it just needs to be sent after composed.
+        // Per entity that is what composeModelMatrices does in the draw section, for all
+        // of them in one pass; for a single entity i it equals:
+        //     glm::mat4 model = glm::mat4(1.0f); // identity matrix
+        //     model = glm::translate(model, glm::vec3(x[i], y[i], 0.0f)); // move by offset
+        //     model = glm::rotate(model, rotation[i], glm::vec3(0.0f, 0.0f, 1.0f));
+        //     model = glm::scale(model, glm::vec3(scaleX[i], scaleY[i], 1.0f));
+
+        
+        // Drain this frame's input events. The callbacks were registered once by
+        // input.install(...) and only queued these; all handling happens here—before the
+        // camera moves on and the render pipeline runs, so clicks are resolved against the
+        // frame the user clicked on.
+        const double inputConsumed = monoclock::seconds();
+        auto consumedInput = [&](double time) {
+            simulatedLatency.add((inputConsumed - time) * 1000.0);
+            if (unpresentedInput == 0.0 || time < unpresentedInput) {
+                unpresentedInput = time;
+            }
+        };
+        if (gamepads.changedAt() > padChangeSeen) {
+            padChangeSeen = gamepads.changedAt();
+            consumedInput(padChangeSeen);
+        }
+        InputEvent event;
+        while (input.poll(event)) {
+            if ((event.type == InputEvent::Key && event.action != GLFW_REPEAT) ||
+                (event.type == InputEvent::MouseButton && event.action == GLFW_PRESS)) {
+                consumedInput(event.time);
+            }
+            if (event.type == InputEvent::CursorMove || event.type == InputEvent::MouseButton) {
+                uiInput.mouse = glm::vec2(static_cast<float>(event.x), static_cast<float>(event.y));
+            }
+            if (event.type == InputEvent::MouseButton && event.code == GLFW_MOUSE_BUTTON_LEFT) {
+                uiInput.down = event.action == GLFW_PRESS;
+                uiInput.pressed = uiInput.pressed || uiInput.down;
+            }
+            const bool uiMouse = toolsVisible && ui.wantsMouse();
+            if (event.type == InputEvent::FramebufferResize) {
+                onFramebufferResize(event.code, event.action);
+            } else if (event.type == InputEvent::MouseButton && !uiMouse &&
+                event.code == GLFW_MOUSE_BUTTON_LEFT && event.action == GLFW_PRESS) {
+                // Cursor position was captured when the click happened. The camera
+                // inverts projection * view at most once per camera change.
+                std::vector<ObjectId> picked;
+                const glm::vec2 worldCoords = picker.pick(camera, event.x, event.y, renderFrame.transforms, picked);
+                dragging = true;
+                dragPath.assign(1, glm::vec2(static_cast<float>(event.x), static_cast<float>(event.y)));
+
+                logging::info("Mouse world coordinates: (%g, %g)", worldCoords.x, worldCoords.y);
+                if (gpuPick && !options.bench.enabled) {
+                    GpuPick pending{++gpuPickRequests, {}};
+                    gpuPickCandidates(picker, camera, renderFrame, gamePath, event.x, event.y, gpuPickInstances,
+                                      pending.handles);
+                    gpuPickRequest = pending.request;
+                    gpuPickCursor = glm::dvec2(event.x, event.y);
+                    gpuPicks.push_back(std::move(pending));
+                }
+                if (audio.running() && !picked.empty()) {
+                    audio.play(sounds.blip, 0.4f);
+                }
+                debugPick = worldCoords;
+                debugPicked.clear();
+                for (ObjectId id : picked) {
+                    debugPicked.push_back(picker.bounds(id));
+                }
+                for (ObjectId id : picked) {
+                    if (renderFrame.handles[id] == sim.player) {
+                        logging::info("Picked: player");
+                    } else {
+                        logging::info("Picked: entity %u", static_cast<unsigned>(renderFrame.handles[id].slot));
+                    }
+                }
+            } else if (event.type == InputEvent::CursorMove && dragging) {
+                dragPath.emplace_back(static_cast<float>(event.x), static_cast<float>(event.y));
+            } else if (event.type == InputEvent::MouseButton && event.code == GLFW_MOUSE_BUTTON_LEFT &&
+                       event.action == GLFW_RELEASE && dragging) {
+                dragging = false;
+                if (dragPath.size() > 1) {
+                    // The whole stroke at once: one index refresh, one batched unprojection.
+                    std::vector<ObjectId> picked;
+                    picker.pickPath(camera, dragPath.data(), dragPath.size(), renderFrame.transforms, picked);
+                    logging::info("Dragged over %zu objects (%zu cursor positions)", picked.size(), dragPath.size());
+                    debugPicked.clear();
+                    for (ObjectId id : picked) {
+                        debugPicked.push_back(picker.bounds(id));
+                    }
+                }
+            } else if (event.type == InputEvent::MouseButton && event.code == GLFW_MOUSE_BUTTON_RIGHT &&
+                       event.action == GLFW_PRESS && tilemap.stats().chunks > 0 && !uiMouse) {
+                TileEdit edit;
+                if (tilemap.tileAt(camera.screenToWorld(event.x, event.y), edit.x, edit.y)) {
+                    edit.layer = 1;
+                    edit.tile = kTilePaint;
+                    tileEdits.push_back(edit);
+                }
+            }
+        }
+
+        camera.setPosition(cameraPos);      // dirties the view only if it moved
+        camera.setZoom(cameraZoom);         // ... the projection only if it zoomed
+        camera.update();                    // rebuilds just the dirty matrices
+        const CameraView playerView = sim.playerCamera.interpolate(alpha);
+        for (ExtraView& extra : extraViews) {
+            if (extra.kind == ExtraView::Kind::FollowPlayer) {
+                extra.camera.setPosition(playerView.position);
+            }
+            extra.camera.update();
+        }
+
+        // --level: regions near the camera come in, far ones go. The load jobs already
+        // faulted their pages in, so creating the entities reads warm memory. Spawning is
+        // the frame budget's ("streaming", from the next frame on): a burst of regions
+        // comes in over a few frames. One gone before its turn is just dropped.
+        if (levelStreamer) {
+            streamIn.clear();
+            streamOut.clear();
+            levelStreamer->update(cameraPos, streamIn, streamOut);
+            for (int region : streamOut) {
+                const auto queued = std::find(regionsToSpawn.begin(), regionsToSpawn.end(), region);
+                if (queued != regionsToSpawn.end()) {
+                    regionsToSpawn.erase(queued);
+                    continue;
+                }
+                despawnLevelRegion(sim, level, region, levelSprites, levelEntities[region], tileEdits,
+                                   bakeScenery ? &sceneryEdits : nullptr);
+            }
+            regionsToSpawn.insert(regionsToSpawn.end(), streamIn.begin(), streamIn.end());
+        }
+        // --procgen: chunks ahead of the camera queued, finished ones placed as tile edits.
+        // The render side re-bakes a placed chunk once, a few of them a frame.
+        if (worldGen) {
+            const glm::vec2 velocity = frameTime > 0.0 ? (cameraPos - lastGenFocus) / static_cast<float>(frameTime)
+                                                       : glm::vec2(0.0f);
+            lastGenFocus = cameraPos;
+            generatedChunks.clear();
+            worldGen->update(cameraPos, velocity, generatedChunks, gpuFields ? &fieldRequests : nullptr);
+            for (int chunk : generatedChunks) {
+                const int x0 = worldGen->chunkX(chunk), y0 = worldGen->chunkY(chunk);
+                for (int layer = 0; layer < WorldGenerator::kLayers; ++layer) {
+                    const std::uint16_t* tiles = worldGen->tiles(chunk, layer);
+                    for (int k = 0; k < WorldGenerator::kChunkTiles * WorldGenerator::kChunkTiles; ++k) {
+                        if (tiles[k] != Tilemap::kEmpty) {
+                            tileEdits.push_back(TileEdit{x0 + k % WorldGenerator::kChunkTiles,
+                                                         y0 + k / WorldGenerator::kChunkTiles,
+                                                         static_cast<std::uint16_t>(layer), tiles[k]});
+                        }
+                    }
+                }
+            }
+        }
+
+        // Snapshots out (each client's view of this frame's World) or in (spawned, moved
+        // and removed before the cull, like the level's regions).
+        if (replicationServer.isOpen()) {
+            replicationServer.update(sim.world, currentFrameTime);
+        } else if (replicationClient.isOpen()) {
+            const CullRect seen = visibleRect(camera);
+            replicationClient.update(sim.world, Aabb{seen.min, seen.max}, currentFrameTime);
+            std::uint32_t serverTick = 0;
+            glm::vec2 serverPosition;
+            Position* player = sim.world.get<Position>(sim.player);
+            if (player && replicationClient.takePlayerState(serverTick, serverPosition)) {
+                const float dt = static_cast<float>(simClock.dt());
+                const float speed = sim.world.get<Controllable>(sim.player)->speed;
+                const glm::vec2 corrected = prediction.reconcile(
+                    serverTick, serverPosition, player->value,
+                    [dt, speed](const glm::vec2& p, ActionMask actions) { return p + moveVelocity(actions, speed) * dt; });
+                // The interpolation's start moves with it: a correction is a jump, not a streak.
+                sim.world.get<PreviousPosition>(sim.player)->value += corrected - player->value;
+                player->value = corrected;
+            }
+        }
+
+        // One cull for all the views, against the bounds of what they see: a second view
+        // over (or next to) the first costs a few more draws on the render thread, not a
+        // second cull, compose and instance copy. Each view draws the same instances; the
+        // GPU clips what falls outside it.
+        const CullRect mainVisible = visibleRect(camera);
+        CullRect cullRect = mainVisible;
+        for (ExtraView& extra : extraViews) {
+            const CullRect visible = visibleRect(extra.camera);
+            cullRect.min = glm::min(cullRect.min, visible.min);
+            cullRect.max = glm::max(cullRect.max, visible.max);
+        }
+
+        // This frame's packet. acquire() only waits while the render thread is still
+        // drawing what this packet carried two frames ago (render side is the bottleneck).
+        profiler.begin(waitSection);
+        FramePacket& packet = renderThread.acquire();
+        profiler.end(waitSection);
+        const RenderStats renderStats = packet.stats;    // of that earlier frame
+        const std::uint64_t renderAllocations = packet.renderAllocations;
+        PerfHud::Frame hudFrame;                         // the HUD's counters likewise
+        hudFrame.render = renderStats;
+        hudFrame.renderAllocations = renderAllocations;
+        hudFrame.renderScale = packet.renderScale;
+        hudFrame.overdraw = packet.overdraw;
+        hudFrame.overdrawMax = packet.overdrawMax;
+        hudFrame.gpuBytes = packet.gpuMemory;
+        hudFrame.gpuAvailable = packet.gpuAvailable;
+        hudFrame.glStalls = packet.glStalls;
+        hudFrame.glStallMs = packet.glStallMs;
+        hudFrame.inputSamples = packet.latency.samples;
+        hudFrame.inputSwapP50 = packet.latency.swapP50;
+        hudFrame.inputSwapP95 = packet.latency.swapP95;
+        hudFrame.inputGpuP50 = packet.latency.gpuP50;
+        hudFrame.inputGpuP95 = packet.latency.gpuP95;
+        const PerfHud::Timings hudRenderTimings = packet.renderTimings;
+        const bool renderBusy = packet.renderBusy;
+        if (packet.picked.request != 0) {
+            // Older clicks than this one lost their slot on the render side (GpuPicker::kSlots).
+            while (!gpuPicks.empty() && gpuPicks.front().request < packet.picked.request) {
+                gpuPicks.pop_front();
+            }
+            if (!gpuPicks.empty() && gpuPicks.front().request == packet.picked.request) {
+                const std::vector<EntityHandle>& handles = gpuPicks.front().handles;
+                const std::uint32_t id = packet.picked.hit != 0 ? packet.picked.hit : packet.picked.nearest;
+                if (id == 0 || id > handles.size()) {
+                    logging::info("Picked (pixel): nothing");
+                } else if (handles[id - 1] == sim.player) {
+                    logging::info("Picked (pixel)%s: player", packet.picked.hit != 0 ? "" : ", nearest");
+                } else {
+                    logging::info("Picked (pixel)%s: entity %u", packet.picked.hit != 0 ? "" : ", nearest",
+                                  static_cast<unsigned>(handles[id - 1].slot));
+                }
+                gpuPicks.pop_front();
+            }
+        }
+        // The render side's GPU time: its timed sections, summed (< 0: none were timed).
+        double renderGpuMs = -1.0;
+        for (int i = 0; i < hudRenderTimings.count; ++i) {
+            if (hudRenderTimings.gpuMs[i] >= 0.0f) {
+                renderGpuMs = std::max(renderGpuMs, 0.0) + hudRenderTimings.gpuMs[i];
+            }
+        }
+        // --quality-governor: this frame's knobs, from the last frame's main work and the
+        // GPU time the packet brought back. Level 0 when off: every knob as set.
+        bool qualityChanged = false;
+        if (governed) {
+            const int before = qualityGovernor.level();
+            qualityGovernor.setPeriod(targetFramePeriod(options.pacing, refreshHz));
+            qualityChanged = qualityGovernor.update(mainWorkMs, renderGpuMs);
+            if (qualityChanged) {
+                const QualityGovernor::Stats& qs = qualityGovernor.stats();
+                logging::info("Quality: %s -> %s (cpu %.2f ms, gpu %.2f ms, target %.2f ms)",
+                              QualityGovernor::knobs(before).name, qualityGovernor.knobs().name, qs.cpuMs, qs.gpuMs,
+                              qs.targetMs);
+                if (renderFrame.lod != nullptr) {
+                    configureSpriteLod(spriteLod, spriteClips, gameConfig, qualityGovernor.knobs().lodScale);
+                }
+            }
+        }
+        const QualityGovernor::Knobs& quality = qualityGovernor.knobs();
+        packet.begin();                                  // arrays empty, its arena rewound
+        // Instances are composed relative to the main camera (core/world_position.h), except
+        // on the sprite batch path: its program also draws the world-space static batches.
+        const bool spriteBatchPath = options.bench.enabled ? options.bench.path == BenchPath::Batched
+                                                           : gamePath == GamePath::Sprites;
+        packet.origin = spriteBatchPath ? WorldPosition{} : WorldPosition::at(glm::dvec2(cameraPos));
+        if (gpuPickRequest != 0) {
+            packet.pickInstances.assign(gpuPickInstances.begin(), gpuPickInstances.end());
+            for (LayeredInstance& instance : packet.pickInstances) {
+                instance.transform = relativeAffine2D(instance.transform, packet.origin);
+            }
+            packet.pickRequest = gpuPickRequest;
+            packet.pickX = gpuPickCursor.x;
+            packet.pickY = gpuPickCursor.y;
+            gpuPickRequest = 0;
+        }
+        packet.frame = profiler.frameIndex();
+        // No real input in benchmarks and replays: the frame's start stands in for one, so
+        // the pipeline's own latency is measured every frame.
+        packet.inputTime = headless ? benchFrameStart : unpresentedInput;
+        packet.viewCount = static_cast<std::uint32_t>(1 + extraViews.size());
+        for (std::uint32_t v = 0; v < packet.viewCount; ++v) {
+            Camera& viewCamera = v == 0 ? camera : extraViews[v - 1].camera;
+            FrameView& view = packet.views[v];
+            view.orthographic = viewCamera.orthographic();
+            if (view.orthographic) {
+                view.orthoView = viewCamera.orthoView();
+                view.orthoProjection = viewCamera.orthoProjection();
+            } else {
+                view.view = viewCamera.view();
+                view.projection = viewCamera.projectionMatrix();
+            }
+            view.version = viewCamera.version();    // the render thread uploads on change
+            view.rect = v == 0 ? mainViewRect : extraViews[v - 1].rect;
+            view.visible = v == 0 ? mainVisible : visibleRect(viewCamera);
+            view.clear = v > 0 && extraViews[v - 1].kind == ExtraView::Kind::Minimap;
+        }
+        packet.viewportWidth = viewportWidth;
+        packet.viewportHeight = viewportHeight;
+        packet.clearColor = gameConfig.clearColor;
+        packet.vsync = options.pacing.vsync;
+        packet.sceneScale = std::max(0.25f, options.renderScale * quality.renderScale);
+        packet.sceneSamples = std::min(options.msaa, quality.maxSamples);
+        packet.visible = cullRect;
+        // Benchmarks: one 60 Hz step a frame, like BenchScene, so particles are the same every run.
+        packet.deltaTime = options.bench.enabled ? 1.0f / 60.0f : static_cast<float>(steps * simClock.dt());
+        packet.particleEmitter = cameraPos;
+        packet.particleLimit = static_cast<std::size_t>(static_cast<double>(options.particles) * quality.particles);
+        if (cpuParticles.size() > 0) {
+            // The CPU particle step, straight into the packet's instances (the render
+            // thread's one copy puts them in the stream).
+            profiler.begin(particleCpuSection);
+            particleStep.dt = packet.deltaTime;
+            particleStep.time += packet.deltaTime;
+            particleStep.emitter = cameraPos;
+            packet.particles.resize(cpuParticles.size());
+            simulateParticlesParallel(jobs, cpuParticles, particleStep, packet.particles.data());
+            packet.particles.resize(std::min(packet.particles.size(), packet.particleLimit));   // all simulated
+            profiler.end(particleCpuSection);
+        }
+        if (pathService) {
+            for (const TileEdit& edit : tileEdits) {
+                if (edit.layer > 0) {
+                    pathService->setTile(edit.layer, edit.x, edit.y, edit.tile != Tilemap::kEmpty);
+                }
+            }
+        }
+        packet.tileEdits.assign(tileEdits.begin(), tileEdits.end());
+        tileEdits.clear();
+        for (int chunk : fieldRequests) {
+            packet.noiseRequests.push_back(GpuNoise::Request{chunk, worldGen->chunkX(chunk), worldGen->chunkY(chunk)});
+        }
+        fieldRequests.clear();
+        packet.sceneryEdits.assign(sceneryEdits.begin(), sceneryEdits.end());
+        sceneryEdits.clear();
+
+        profiler.begin(buildSection);
+        std::size_t drawnQuads = 0;
+        if (options.bench.enabled) {
+            // Culling: only objects touching the views' rectangle go any further.
+            const Transforms2D* drawSet = &benchScene.transforms();
+            if (options.bench.cull == BenchCull::Linear) {
+                benchVisible.resize(drawSet->size());
+                const std::size_t visibleCount =
+                    cullTransforms(*drawSet, 0.25f, cullRect, benchVisible.data());
+                gatherTransforms(*drawSet, benchVisible.data(), visibleCount, benchCulled);
+                drawSet = &benchCulled;
+            } else if (benchIndex) {
+                // Every object moved, so every object updates—but almost all stay in the
+                // same cells / nodes, and those updates are a compare. The query then only
+                // visits the part of the structure under the view.
+                transformBounds(*drawSet, 0.25f, benchBounds.data());
+                for (std::size_t i = 0; i < benchBounds.size(); ++i) {
+                    benchIndex->update(static_cast<ObjectId>(i), benchBounds[i]);
+                }
+                benchVisible.clear();
+                benchIndex->queryRect(Aabb{cullRect.min, cullRect.max}, benchVisible);
+                gatherTransforms(*drawSet, benchVisible.data(), benchVisible.size(), benchCulled);
+                drawSet = &benchCulled;
+            }
+            drawnQuads = drawSet->size();
+            // The overlap scene's quads are translucent: blended (and sorted) on the layered path.
+            const std::uint32_t benchColor = packColor(
+                glm::vec4(1.0f, 0.5f, 0.2f, options.bench.scene == BenchSceneKind::Overlap ? 0.375f : 1.0f));
+
+            if (options.bench.path == BenchPath::Batched) {
+                packet.path = FramePacket::Path::Sprites;
+                packet.spriteColor = benchColor;
+                packet.models.resize(drawnQuads);
+                composeParallel(jobs, *drawSet, packet.models.data(), renderFrame.composeGrain, packet.origin);
+            } else if (options.bench.path == BenchPath::Layered) {
+                // Affine2D + one layer per quad, cycling through the whole array.
+                packet.path = FramePacket::Path::Layered;
+                packet.spriteColor = benchColor;
+                packet.affine.resize(drawnQuads);
+                composeAffine2D(*drawSet, packet.affine.data(), packet.origin);
+                packet.sprites.resize(drawnQuads);
+                for (std::size_t i = 0; i < drawnQuads; ++i) {
+                    packet.sprites[i] = static_cast<std::uint32_t>(i % (kSpriteShapes + 1));
+                }
+            } else if (options.bench.path == BenchPath::Affine) {
+                // Same kernel, 24-byte output; needs the matching vertex stage.
+                packet.path = FramePacket::Path::Affine;
+                packet.spriteColor = benchColor;
+                packet.affine.resize(drawnQuads);
+                composeAffine2D(*drawSet, packet.affine.data(), packet.origin);
+            } else {
+                packet.path = FramePacket::Path::Instanced;
+                packet.spriteColor = benchColor;
+                packet.models.resize(drawnQuads);
+                composeParallel(jobs, *drawSet, packet.models.data(), renderFrame.composeGrain, packet.origin);
+            }
+        } else {
+            // Extract, cull and compact on the job system, then compose only what's on screen.
+            renderFrame.alpha = alpha;
+            renderFrame.view = cullRect;
+            renderFrame.pixelsPerUnit = static_cast<float>(viewportHeight) / (mainVisible.max.y - mainVisible.min.y);
+            // The step being drawn is alpha of the way from the previous one to the last.
+            renderFrame.time = sim.time - (1.0f - alpha) * static_cast<float>(simClock.dt());
+            renderGraph.run(jobs);
+            if (gamePath == GamePath::Layered) {
+                packet.path = FramePacket::Path::Layered;
+                packet.affine.resize(renderFrame.visibleCount);
+                composeAffineParallel(jobs, renderFrame.visibleTransforms, packet.affine.data(),
+                                      renderFrame.affineGrain, packet.origin);
+            } else {
+                packet.path = gamePath == GamePath::Sprites ? FramePacket::Path::Sprites
+                                                            : FramePacket::Path::Instanced;
+                packet.models.resize(renderFrame.visibleCount);
+                composeParallel(jobs, renderFrame.visibleTransforms, packet.models.data(), renderFrame.composeGrain,
+                                packet.origin);
+            }
+            packet.colors.assign(renderFrame.visibleColors.begin(), renderFrame.visibleColors.end());
+            if (gamePath != GamePath::Instanced) {
+                packet.sprites.assign(renderFrame.visibleSprites.begin(), renderFrame.visibleSprites.end());
+            }
+            if (gamePath == GamePath::Layered) {
+                packet.zLayers.assign(renderFrame.visibleZLayers.begin(), renderFrame.visibleZLayers.end());
+                // The clips' frames are the vertex shader's to pick: (start, rate) go as they are.
+                packet.animations.assign(renderFrame.visibleAnimations.begin(), renderFrame.visibleAnimations.end());
+                packet.animationTime = renderFrame.time;
+            } else if (gamePath == GamePath::Sprites && renderFrame.clips) {
+                // The sprite batch has no clip table: the frames as image ids, here.
+                for (std::size_t k = 0; k < packet.sprites.size(); ++k) {
+                    const glm::vec2 a = renderFrame.visibleAnimations[k];
+                    packet.sprites[k] = spriteClips.layerAt(packet.sprites[k], a.x, a.y, renderFrame.time);
+                }
+            }
+            if (options.orbiters > 0) {
+                const Position* p = sim.world.get<Position>(sim.player);
+                const PreviousPosition* previous = sim.world.get<PreviousPosition>(sim.player);
+                if (p && previous) {
+                    orbiters.update(glm::mix(previous->value, p->value, alpha), packet.deltaTime, jobs);
+                    orbiters.appendTo(packet);
+                }
+            }
+            if (skinnedMesh.initialized()) {
+                // On the same interpolated clock as the positions and the sprite clips.
+                critters.update(sim.time - (1.0f - alpha) * static_cast<float>(simClock.dt()), jobs);
+                critters.appendTo(packet);
+            }
+            if (lightBuffer.initialized()) {
+                const Position* p = sim.world.get<Position>(sim.player);
+                const PreviousPosition* previous = sim.world.get<PreviousPosition>(sim.player);
+                const glm::vec2 player = p && previous ? glm::mix(previous->value, p->value, alpha) : cameraPos;
+                appendLights(packet, static_cast<int>(static_cast<float>(options.lights) * quality.lights),
+                             sim.wanderBounds,
+                             sim.time - (1.0f - alpha) * static_cast<float>(simClock.dt()), player);
+            }
+        }
+        profiler.end(buildSection);
+
+        if (debugdraw::enabled() && debugShapes && !options.bench.enabled) {
+            // What culling kept (object bounds, green) inside what it tested against (the
+            // view, yellow), and the last pick: the point and every bound it hit.
+            debugBounds.resize(renderFrame.visibleTransforms.size());
+            transformBounds(renderFrame.visibleTransforms, 0.25f, debugBounds.data());
+            const std::uint32_t boundsColor = packColor(glm::vec4(0.2f, 1.0f, 0.3f, 1.0f));
+            for (const Aabb& bounds : debugBounds) {
+                debugDraw.rect(bounds.min, bounds.max, boundsColor);
+            }
+            debugDraw.rect(renderFrame.view.min, renderFrame.view.max, packColor(glm::vec4(1.0f, 1.0f, 0.0f, 1.0f)));
+            for (const Aabb& bounds : debugPicked) {
+                debugDraw.rectFilled(bounds.min, bounds.max, packColor(glm::vec4(1.0f, 0.2f, 0.2f, 0.35f)));
+            }
+            debugDraw.cross(debugPick, 0.05f, packColor(glm::vec4(1.0f, 0.2f, 0.2f, 1.0f)));
+            debugDraw.circle(debugPick, 0.05f, packColor(glm::vec4(1.0f, 0.2f, 0.2f, 1.0f)));
+            packet.debugLines.assign(debugDraw.lines().begin(), debugDraw.lines().end());
+            packet.debugTriangles.assign(debugDraw.triangles().begin(), debugDraw.triangles().end());
+            debugDraw.clear();
+        }
+
+        if (toolsVisible) {
+            // The tools panel, top-right: laid out and answered here, this frame's clicks
+            // applied at once; the render side rebuilds only the widgets that changed.
+            ui.begin(uiInput, packet.uiWidgets, packet.uiText);
+            ui.beginPanel("Tools (F4)", glm::vec2(static_cast<float>(viewportWidth) - 248.0f, 8.0f), 240.0f);
+            ui.checkbox("HUD (F2)", hudVisible);
+            if (debugdraw::enabled()) {
+                ui.checkbox("Debug shapes (F3)", debugShapes);
+            }
+            ui.checkbox("Camera follows player (F)", cameraFollow);
+            ui.slider("Camera speed", gameConfig.cameraSpeed, 0.0f, 10.0f);
+            char label[64];
+            std::snprintf(label, sizeof(label), "Path: %s (B)", gamePathName(gamePath));
+            if (ui.button(label)) {
+                cycleGamePath();
+            }
+            std::snprintf(label, sizeof(label), "Entities: %zu", renderFrame.handles.size());
+            ui.label(label);
+            ui.endPanel();
+            ui.end();
+        }
+        uiInput.pressed = false;
+        packet.hudOverlay = hudVisible;
+        packet.hudWindowWidth = packet.hudWindowHeight = 0;
+        if (profilerWindow) {
+            if (glfwWindowShouldClose(profilerWindow)) {
+                glfwHideWindow(profilerWindow);     // closing it only hides it: the game goes on
+                glfwSetWindowShouldClose(profilerWindow, GLFW_FALSE);
+            }
+            if (glfwGetWindowAttrib(profilerWindow, GLFW_VISIBLE) &&
+                !glfwGetWindowAttrib(profilerWindow, GLFW_ICONIFIED)) {
+                glfwGetFramebufferSize(profilerWindow, &packet.hudWindowWidth, &packet.hudWindowHeight);
+            }
+        }
+        if (hudVisible || packet.hudWindowWidth > 0) {
+            // Sums every frame, text only every PerfHud::kRefreshSeconds; both copied into
+            // the packet's arena: no heap.
+            CpuScope scope(profiler, hudSection);
+            hudFrame.ms = frameTime * 1000.0;
+            hudFrame.mainAllocations = static_cast<std::uint64_t>(profiler.allocations(Profiler::kFrameSection).last());
+            PerfHud::capture(profiler, hudMainTimings);
+            perfHud.add(hudFrame, hudMainTimings, hudRenderTimings);
+            const char* text = perfHud.text(currentFrameTime);
+            packet.hud.assign(text, text + perfHud.textLength());
+            packet.hudGraph.resize(PerfHud::kGraphFrames);
+            perfHud.graph(packet.hudGraph.data());
+        }
+        if (telemetry.isOpen()) {
+            Telemetry::Frame telemetryFrame;
+            telemetryFrame.ms = frameTime * 1000.0;
+            telemetryFrame.gpuMs = renderGpuMs;
+            telemetryFrame.render = renderStats;
+            telemetryFrame.allocations =
+                static_cast<std::uint64_t>(profiler.allocations(Profiler::kFrameSection).last()) + renderAllocations;
+            telemetryFrame.gpuBytes = hudFrame.gpuBytes;
+            telemetryFrame.glStalls = hudFrame.glStalls;
+            if (governed) {
+                telemetryFrame.qualityLevel = qualityGovernor.level();
+                telemetryFrame.qualityName = quality.name;
+                telemetryFrame.qualityChanged = qualityChanged;
+            }
+            telemetry.add(telemetryFrame);
+            telemetry.update(currentFrameTime);
+        }
+
+        // With --profile, the render thread prints this side's table together with its own
+        // (formatted here: the main profiler is only touched on this thread).
+        packet.report.clear();
+        if (options.profile && currentFrameTime >= nextReportTime) {
+            nextReportTime = currentFrameTime + 2.0;
+            FrameStringStream text;         // main's arena, then copied into the packet's
+            text << "main thread:\n";
+            profiler.report(text);
+            if (options.collisions) {
+                const SweepAndPrune::Stats& cs = sim.collisions.broadphase.stats();
+                text << "collisions " << cs.objects << " bodies, " << cs.moves << " sort moves, " << cs.tests
+                     << " x overlaps, " << cs.pairs << " pairs in " << sim.collisions.islands.stats().islands
+                     << " islands (largest " << sim.collisions.islands.stats().largest << "), "
+                     << sim.collisions.contacts << " contacts\n";
+            }
+            const VisibleSet::Stats& vs = renderFrame.visibleSet.stats();
+            text << "visible set " << renderFrame.visibleSet.size() << ": " << vs.incremental << " frames patched ("
+                 << vs.tested << " objects re-tested, " << vs.entered << " entered, " << vs.left << " left), "
+                 << vs.full << " culled from scratch\n";
+            renderFrame.visibleSet.resetStats();
+            const AdaptiveGrain::Stats& gc = renderFrame.composeGrain.stats();
+            const AdaptiveGrain::Stats& gv = renderFrame.visibleSet.compareGrain().stats();
+            text << "job grain compose " << gc.grain << " matrices (" << gc.jobs << " jobs, " << gc.meanUs << " us avg, "
+                 << gc.slowestUs << " us slowest), cull compare " << gv.grain << " ranges (" << gv.jobs << " jobs, "
+                 << gv.meanUs << " us avg, " << gv.slowestUs << " us slowest)\n";
+            if (simulatedLatency.count() > 0) {
+                text << "input latency " << simulatedLatency.mean() << " ms avg, " << simulatedLatency.percentile(0.95)
+                     << " ms p95, " << simulatedLatency.max() << " ms worst over " << simulatedLatency.count()
+                     << " inputs (raw event to simulated), " << gamepads.stats().connected << " gamepads\n";
+                simulatedLatency.clear();
+            }
+            const EventBus::Stats es = events.stats();
+            text << "events " << es.published << " published, " << es.dispatched << " dispatched in " << es.batches
+                 << " batches, " << es.dropped << " dropped\n";
+            const TaskScheduler::Stats tks = tasks.stats();
+            if (tks.spawned > 0) {
+                text << "tasks " << tks.active << " active, " << tks.finished << " finished, " << tks.resumes
+                     << " resumes, " << tks.loads << " loads, " << tks.heapFrames << " frames from the heap\n";
+            }
+            if (sim.timers.stats().scheduled > 0) {
+                const TimerWheel::Stats& ts = sim.timers.stats();
+                text << "timers " << ts.active << " pending, " << ts.fired << " fired, " << ts.cancelled
+                     << " cancelled, " << ts.cascaded << " re-filed a level down\n";
+            }
+            if (options.boids > 0) {
+                const Flock::Stats& bs = sim.boids.flock.stats();
+                const double visits = static_cast<double>(std::max<std::uint64_t>(1, bs.steps * bs.boids));
+                text << "boids " << bs.boids << " in " << bs.cells << " cells: " << bs.tested / visits
+                     << " candidates, " << bs.neighbours / visits << " neighbours per boid per step\n";
+                sim.boids.flock.resetStats();
+            }
+            if (pathService) {
+                const PathService::Stats& ps = pathService->stats();
+                text << "paths " << ps.queries << " answered (" << ps.failed << " failed) in " << ps.batches
+                     << " batches, " << ps.queued + ps.inFlight << " pending; " << ps.edits << " tile edits, "
+                     << pathGrid.stats().rebuilds << " clusters rebuilt, " << pathGrid.stats().nodes << " nodes\n";
+                if (sim.flow != nullptr) {
+                    text << "flow field " << flowField.stats().builds << " builds, " << flowField.stats().reached
+                         << " tiles reach the goal\n";
+                }
+            }
+            if (renderFrame.lod != nullptr) {
+                const SpriteLod::Stats& ls = spriteLod.stats();
+                const std::uint64_t frames = std::max<std::uint64_t>(1, ls.frames);
+                text << "lod " << ls.flattened / frames << " flat per frame, " << ls.clusters / frames
+                     << " impostors for " << ls.clustered / frames << " of them\n";
+                spriteLod.resetStats();
+            }
+            const FrameString report = text.str();
+            packet.report.assign(report.begin(), report.end());
+        }
+        frameBudget.endFrame(monoclock::now());
+        mainWorkMs = monoclock::toMs(monoclock::now() - currentFrameTicks);
+        bool present = true;
+        if (damageTracking) {
+            const std::uint64_t content = packet.contentHash();
+            present = content != presentedContent || repaint || renderBusy || !packet.tileEdits.empty() ||
+                      !packet.noiseRequests.empty() ||
+                      !packet.sceneryEdits.empty() || packet.pickRequest != 0 || !packet.report.empty() ||
+                      !gpuPicks.empty() ||
+                      (gpuParticles && packet.deltaTime > 0.0f) ||
+                      currentFrameTime - lastPresentTime >= kDamageHeartbeatSeconds;
+            presentedContent = content;
+        }
+        if (present) {
+            lastPresentTime = currentFrameTime;
+            unpresentedInput = 0.0;
+            renderThread.submit();          // draws now (inline) or on the render thread
+        } else {
+            packet.picked = GpuPicker::Result{};   // consumed above; the packet is refilled next
+        }
+        skippedFrame = !present;
+
+        if (!pacer.lowLatency()) {
+            pacer.waitForNextFrame();     // frame cap (no-op when uncapped)
+            input.newFrame();             // current key/action state becomes "previous"
+            if (skippedFrame) {
+                glfwWaitEventsTimeout(simClock.dt());   // nothing drawn: sleep, don't spin
+            } else {
+                glfwPollEvents();         // Handle keyboard/mouse/input/window events
+            }
+        }
+        profiler.endFrame();
+
+        if (headless && (replaying || offline || benchFrame >= options.bench.warmup)) {
+            // The render side's counts belong to the frame renderStats came from.
+            const FrameAllocations allocations{alloccount::thread() - mainAllocationsBefore,
+                                               renderAllocations,
+                                               alloccount::total() - allAllocationsBefore,
+                                               alloccount::threadBytes() - mainBytesBefore,
+                                               alloccount::totalBytes() - allBytesBefore};
+            benchReport.addFrame((monoclock::seconds() - benchFrameStart) * 1000.0, renderStats,
+                                 (replaying || offline ? renderFrame.visibleCount
+                                            : drawnQuads + static_cast<std::size_t>(options.particles)) * 2,
+                                 allocations);
+        }
+        if (options.bench.enabled) {
+            if (++benchFrame >= options.bench.warmup + options.bench.frames) {
+                glfwSetWindowShouldClose(window, true);
+            }
+        }
+        if (offline && ++offlineFrame >= static_cast<std::uint64_t>(options.offlineFrames) &&
+            options.offlineFrames > 0) {
+            glfwSetWindowShouldClose(window, true);
+        }
+        if (options.startupBench && frameRenderer.startupMeasured()) {
+            glfwSetWindowShouldClose(window, true);
+        }
+    }
+
+    renderThread.stop();                // the context is current on this thread again
+    shaderReloader.shutdown();
+    int exitCode = 0;
+    if (options.bench.enabled) {
+        const std::string size = options.bench.scene == BenchSceneKind::Tilemap
+                                     ? std::to_string(tilemapWidth) + "x" + std::to_string(tilemapHeight) + " tiles"
+                                 : options.bench.scene == BenchSceneKind::Particles
+                                     ? std::to_string(options.particles) + " particles"
+                                     : std::to_string(options.bench.quads) + " quads";
+        std::string label = std::string(benchSceneName(options.bench.scene)) + ", " + size + ", " +
+                            benchPathName(options.bench.path) +
+                            ", cull " + benchCullName(options.bench.cull);
+        benchReport.print(std::cout, label.c_str());
+        frameRenderer.latency().print(std::cout, "  ");
+        gpumemory::report(std::cout);
+        if (benchReport.allocatingFrames() > 0) {
+            // Where: the profiler sections that allocated, over their last RollingStats window.
+            std::cout << "  allocating sections, main thread:\n";
+            profiler.reportAllocations(std::cout, "    ");
+            std::cout << "  allocating sections, render thread:\n";
+            frameRenderer.profiler().reportAllocations(std::cout, "    ");
+        }
+        if (options.bench.zeroAlloc && !alloccount::enabled()) {
+            std::cerr << "bench: --bench-zero-alloc needs the allocation hook (built with ALLOC_HOOK=0)\n";
+            exitCode = 1;
+        } else if (options.bench.zeroAlloc && benchReport.allocatingFrames() > 0) {
+            std::cerr << "bench: " << benchReport.allocatingFrames()
+                      << " measured frames allocated from the heap (--bench-zero-alloc)\n";
+            exitCode = 1;
+        }
+    } else if (offline && !replaying) {
+        const std::string label = "offline, " + std::to_string(offlineFrame) + " frames";
+        benchReport.print(std::cout, label.c_str());
+        gpumemory::report(std::cout);
+    } else if (replaying) {
+        const std::string label = "replay " + options.replayPath + ", " + std::to_string(inputReplay.tick()) + " ticks";
+        benchReport.print(std::cout, label.c_str());
+        frameRenderer.latency().print(std::cout, "  ");
+        gpumemory::report(std::cout);
+        if (!inputReplay.complete()) {
+            std::cout << "  (the recording ends early: no End record)\n";
+        }
+    }
+    if (inputRecorder.recording()) {
+        inputRecorder.close();
+        std::cout << "Input: recorded " << inputRecorder.ticks() << " ticks in " << inputRecorder.bytes()
+                  << " bytes\n";
+    }
+
+    if (replicationServer.isOpen()) {
+        const ReplicationServer::Stats& served = replicationServer.stats();
+        std::cout << "Net: " << served.joined << " clients, " << served.snapshots << " snapshots ("
+                  << served.fullSnapshots << " full) in " << served.bytesSent << " bytes, " << served.records
+                  << " records, " << served.deferred << " deferred\n";
+        replicationServer.close();
+    }
+    if (replicationClient.isOpen()) {
+        const ReplicationClient::Stats& watched = replicationClient.stats();
+        const ClientPrediction::Stats& predicted = prediction.stats();
+        std::cout << "Net: " << watched.snapshots << " snapshots in " << watched.bytesReceived << " bytes, "
+                  << watched.stale << " stale, " << watched.undecodable << " undecodable; " << predicted.corrections
+                  << " of " << predicted.checks << " predictions corrected (" << predicted.resimulated
+                  << " ticks re-run, largest error " << predicted.largestError << ")\n";
+        replicationClient.close();
+    }
+    for (const ScriptHost::Stats& ran : scriptHost.stats()) {
+        std::cout << "Script " << ran.name << ": " << ran.ops << " ops, " << ran.runs << " runs, worst "
+                  << ran.worstMs << " ms, " << ran.overruns << " over its " << ran.budgetMs << " ms budget\n";
+    }
+    scriptHost.shutdown();
+    if (audio.running()) {
+        const AudioMixer::Stats heard = audio.stats();
+        std::cout << "Audio: " << heard.played << " sounds played, " << heard.stolen << " voices stolen, "
+                  << heard.dropped << " commands dropped, " << heard.xruns << " device underruns, "
+                  << heard.streamUnderruns << " stream underruns\n";
+        audio.stop();
+    }
+    if (history) {
+        const SnapshotHistory::Stats kept = history->stats();
+        std::cout << "Rewind: " << kept.deltas << " steps kept in " << kept.keptBytes << " bytes (images of "
+                  << kept.imageBytes << " bytes), " << kept.rewinds << " rewound\n";
+        history.reset();                // waits for its delta job
+    }
+    if (governed) {
+        const QualityGovernor::Stats& qs = qualityGovernor.stats();
+        std::cout << "Quality governor: " << qualityGovernor.knobs().name << " at the end, lowered " << qs.lowered
+                  << " and raised " << qs.raised << " times (" << qs.undone << " raises undone); frames at";
+        for (int level = 0; level < QualityGovernor::kLevels; ++level) {
+            std::cout << (level > 0 ? ", " : " ") << QualityGovernor::knobs(level).name << " " << qs.frames[level];
+        }
+        std::cout << "\n";
+    }
+    if (frameBudget.stats().frames > 0 && !frameBudget.subsystems().empty() && !budgetSettings.unlimited) {
+        const FrameBudget::Stats& fb = frameBudget.stats();
+        const double frames = static_cast<double>(fb.frames);
+        std::cout << "Frame budget: " << fb.spentMs / frames << " ms a frame of deferrable work, " << fb.deferred
+                  << " of " << fb.frames << " frames left some for later, " << fb.overruns << " ran over (";
+        for (std::size_t i = 0; i < frameBudget.subsystems().size(); ++i) {
+            const FrameBudget::Subsystem& sub = frameBudget.subsystems()[i];
+            std::cout << (i > 0 ? ", " : "") << sub.name << " " << sub.ms / frames << " ms, deferred " << sub.deferred;
+        }
+        std::cout << ")\n";
+    }
+    if (worldGen) {
+        const WorldGenerator::Stats& world = worldGen->stats();
+        std::cout << "World: " << world.placed << " of " << worldGen->chunkCount() << " chunks generated, "
+                  << (world.placed > 0 ? world.generateMs / static_cast<double>(world.placed) : 0.0)
+                  << (gpuFields ? " ms per chunk classifying" : " ms per chunk on the workers");
+        if (gpuFields) {
+            std::cout << ", their noise in " << gpuNoise.stats().batches << " GPU batches";
+        }
+        std::cout << "\n";
+        worldGen.reset();               // waits for its generation jobs
+    }
+    if (levelStreamer) {
+        const LevelStreamer::Stats& streamed = levelStreamer->stats();
+        std::cout << "Level: " << streamed.loads << " region loads, " << streamed.spawned << " spawned, "
+                  << streamed.despawned << " despawned, " << streamed.failed << " damaged\n";
+        levelStreamer.reset();          // waits for its load jobs
+    }
+
+    jobs.shutdown();
+    trace::stop();
+    flightrec::stop();
+    logging::stop();
+    profiler.shutdown();
+    frameRenderer.shutdown();   // its programs, targets and meters; waits for the capture writer
+    if (options.capture) {
+        const FrameCapture::Stats fs = frameRenderer.capture().stats();
+        std::cout << "Capture: " << fs.written << " frames written to "
+                  << (options.captureSettings.pipe.empty() ? options.captureSettings.directory + "/"
+                                                           : options.captureSettings.pipe);
+        if (fs.stalls > 0) {
+            std::cout << ", " << fs.stalls << " waited for the writer";
+        }
+        std::cout << "\n";
+    }
+    quads.shutdown();
+    affineQuads.shutdown();
+    layeredQuads.shutdown();
+    animatedQuads.shutdown();
+    skinnedMesh.shutdown();
+    particleQuads.shutdown();
+    hudFont.shutdown();
+    glyphCache.shutdown();
+    spriteAtlas.shutdown();
+    spriteArray.shutdown();
+    textureLoader.shutdown();
+    vfs::unmountAll();          // after the loader threads: they read from the mappings
+    tilemap.shutdown();
+    staticBatch.shutdown();
+    virtualTexture.shutdown();
+    lightBuffer.shutdown();
+    oitBuffer.shutdown();
+    particleSystem.shutdown();
+    gpuPicker.shutdown();
+    gpuNoise.shutdown();
+    spriteClips.shutdown();
+    vertexArrays.shutdown();
+    shapes.clear();
+    meshes.shutdown();
+    VAO.reset();
+    affineVAO.reset();
+    layeredVAO.reset();
+    particleVAO.reset();
+    pickVAO.reset();
+    glresource::shutdown();     // deletes everything queued above, with the context still current
+    gldebug::report(std::cout);
+    gldebug::uninstall();
+    // After it: its names are dropped, not deleted in the wrong context. Its VAO goes with
+    // its context, the shared objects with the last context of the share group.
+    profilerBatch.shutdown();
+    gpumemory::reportLeaks(std::cerr);  // still tracked now: never handed back
+    if (profilerWindow) {
+        glfwDestroyWindow(profilerWindow);
     }
-
-    glDeleteBuffers(1, &VBO);
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteProgram(shaderProgram);
 
     glfwDestroyWindow(window);
     glfwTerminate();
-    return 0;
+    return exitCode;
 }
@@ -0,0 +1,89 @@
+#include "net/bit_stream.h"
+
+#include <algorithm>
+
+void BitWriter::write(std::uint32_t value, int bits) {
+    if (bits <= 0) {
+        return;
+    }
+    if (padded_) {
+        bytes_.pop_back();              // the partial byte bytes() added; scratch_ still has it
+        padded_ = false;
+    }
+    if (bits < 32) {
+        value &= (1u << bits) - 1u;
+    }
+    scratch_ |= static_cast<std::uint64_t>(value) << scratchBits_;
+    scratchBits_ += bits;
+    bits_ += static_cast<std::size_t>(bits);
+    while (scratchBits_ >= 8) {
+        bytes_.push_back(static_cast<std::uint8_t>(scratch_));
+        scratch_ >>= 8;
+        scratchBits_ -= 8;
+    }
+}
+
+void BitWriter::writeVarUint(std::uint32_t value) {
+    const int width = bitWidth(value);
+    write(static_cast<std::uint32_t>(width), 6);
+    write(value, width);
+}
+
+void BitWriter::writeVarInt(std::int32_t value) {
+    const std::uint32_t u = static_cast<std::uint32_t>(value);
+    writeVarUint((u << 1) ^ (value < 0 ? 0xffffffffu : 0u));
+}
+
+const std::vector<std::uint8_t>& BitWriter::bytes() {
+    if (scratchBits_ > 0 && !padded_) {
+        // Copied out, but kept in scratch_: further writes carry on from the same bit.
+        bytes_.push_back(static_cast<std::uint8_t>(scratch_));
+        padded_ = true;
+    }
+    return bytes_;
+}
+
+void BitWriter::clear() {
+    bytes_.clear();
+    scratch_ = 0;
+    scratchBits_ = 0;
+    bits_ = 0;
+    padded_ = false;
+}
+
+std::uint32_t BitReader::read(int bits) {
+    if (bits <= 0) {
+        return 0;
+    }
+    if (position_ + static_cast<std::size_t>(bits) > size_ * 8) {
+        overflowed_ = true;
+        position_ = size_ * 8;
+        return 0;
+    }
+    std::uint64_t value = 0;
+    int got = 0;
+    while (got < bits) {
+        const std::size_t byte = position_ >> 3;
+        const int offset = static_cast<int>(position_ & 7);
+        const int take = std::min(8 - offset, bits - got);
+        const std::uint32_t piece = (data_[byte] >> offset) & ((1u << take) - 1u);
+        value |= static_cast<std::uint64_t>(piece) << got;
+        got += take;
+        position_ += static_cast<std::size_t>(take);
+    }
+    return static_cast<std::uint32_t>(value);
+}
+
+std::uint32_t BitReader::readVarUint() {
+    const int width = static_cast<int>(read(6));
+    if (width > 32) {
+        overflowed_ = true;
+        return 0;
+    }
+    return read(width);
+}
+
+std::int32_t BitReader::readVarInt() {
+    const std::uint32_t u = readVarUint();
+    return static_cast<std::int32_t>((u >> 1) ^ (0u - (u & 1u)));
+}
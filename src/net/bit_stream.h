@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// BitWriter / BitReader
+// ---------------------
+// Values packed at exactly the bit widths they need, least significant bit first, for
+// packets where every byte counts (net/replication.h). The writer appends to a byte
+// vector; the reader never reads past its buffer: a read beyond the end returns 0 and
+// sets overflowed(), which the caller checks once at the end instead of after every read.
+//
+// | Call                  | Bits                                                     |
+// | --------------------- | -------------------------------------------------------- |
+// | write(v, n)           | n (0..32)                                                |
+// | writeVarUint(v)       | 6-bit width + width: small numbers stay small            |
+// | writeVarInt(v)        | zigzag (-1 → 1, 1 → 2, ...) then writeVarUint            |
+class BitWriter {
+public:
+    void write(std::uint32_t value, int bits);
+    void writeBool(bool value) { write(value ? 1u : 0u, 1); }
+    void writeVarUint(std::uint32_t value);
+    void writeVarInt(std::int32_t value);
+
+    // Bits written so far (bytes() is this rounded up).
+    std::size_t bitCount() const { return bits_; }
+    // Pads the last byte with zeros and returns everything written.
+    const std::vector<std::uint8_t>& bytes();
+    void clear();
+
+private:
+    std::vector<std::uint8_t> bytes_;
+    std::uint64_t scratch_ = 0;        // bits not yet flushed to bytes_
+    int scratchBits_ = 0;
+    std::size_t bits_ = 0;
+    bool padded_ = false;              // bytes_ ends with scratch_'s partial byte
+};
+
+class BitReader {
+public:
+    BitReader(const std::uint8_t* data, std::size_t size) : data_(data), size_(size) {}
+
+    std::uint32_t read(int bits);
+    bool readBool() { return read(1) != 0; }
+    std::uint32_t readVarUint();
+    std::int32_t readVarInt();
+
+    bool overflowed() const { return overflowed_; }
+
+private:
+    const std::uint8_t* data_;
+    std::size_t size_;
+    std::size_t position_ = 0;         // in bits
+    bool overflowed_ = false;
+};
+
+// The bit width of v: 0 for 0, 32 for values with the top bit set.
+inline int bitWidth(std::uint32_t v) {
+    int n = 0;
+    while (v) {
+        ++n;
+        v >>= 1;
+    }
+    return n;
+}
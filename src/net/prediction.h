@@ -0,0 +1,90 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "input/input_state.h"
+
+// ClientPrediction
+// ----------------
+// A client moves its own player the moment a key is pressed instead of a round trip
+// later: every simulation step it applies its input locally AND sends it (net/
+// replication.h). The server applies the same input to its copy of the player, and each
+// snapshot says which input tick its position is after. When that disagrees with what
+// was predicted for the same tick (a collision the client didn't know about, a lost
+// input), the player is put where the server says and the inputs after it are stepped
+// again:
+//
+//     tick       ... 40  41  42  43  44  45      (45: now)
+//     predicted       ·   ·   p   ·   ·   ·
+//     server says         "after 42: s"     s != p → from s, step 43, 44, 45 again
+//
+// Only the player is re-simulated, from a ring of kTicks (tick, actions, position)
+// records, so a correction is a few vector adds per tick, not a re-run of the World; and
+// a prediction that was right (nearly every snapshot) costs one comparison.
+class ClientPrediction {
+public:
+    static constexpr std::size_t kTicks = 128;     // power of two; ~2 s at 60 Hz
+
+    struct Stats {
+        std::uint64_t checks = 0;          // server positions compared
+        std::uint64_t corrections = 0;     // ... that were off by more than the tolerance
+        std::uint64_t resimulated = 0;     // ticks stepped again for those
+        float largestError = 0.0f;         // world units
+    };
+
+    // Further than this (world units) from the server is a misprediction. Above the
+    // replication's quantization step, so rounding alone never triggers one.
+    explicit ClientPrediction(float tolerance = 0.01f) : tolerance_(tolerance) {}
+
+    // After stepping `tick` locally with `actions`: where the player ended up.
+    void record(std::uint32_t tick, ActionMask actions, const glm::vec2& position) {
+        Entry& e = ring_[tick % kTicks];
+        e.tick = tick;
+        e.actions = actions;
+        e.position = position;
+        newest_ = tick;
+    }
+
+    // The server's `position` after input `tick`. Returns where the player is now: `current`
+    // if the prediction held (or the tick is no longer, or not yet, recorded), else the
+    // server's position stepped on through the newer inputs with step(position, actions).
+    template <typename Step>
+    glm::vec2 reconcile(std::uint32_t tick, const glm::vec2& position, const glm::vec2& current, Step&& step) {
+        Entry& at = ring_[tick % kTicks];
+        if (tick == 0 || tick > newest_ || at.tick != tick) {
+            return current;
+        }
+        ++stats_.checks;
+        const float error = glm::length(at.position - position);
+        if (error <= tolerance_) {
+            return current;
+        }
+        ++stats_.corrections;
+        stats_.largestError = glm::max(stats_.largestError, error);
+        at.position = position;
+        glm::vec2 p = position;
+        for (std::uint32_t t = tick + 1; t <= newest_; ++t) {
+            Entry& e = ring_[t % kTicks];
+            p = step(p, e.actions);
+            e.position = p;
+            ++stats_.resimulated;
+        }
+        return p;
+    }
+
+    const Stats& stats() const { return stats_; }
+
+private:
+    struct Entry {
+        std::uint32_t tick = 0;
+        ActionMask actions = 0;
+        glm::vec2 position{0.0f};
+    };
+    std::array<Entry, kTicks> ring_{};
+    std::uint32_t newest_ = 0;
+    float tolerance_;
+    Stats stats_;
+};
@@ -0,0 +1,643 @@
+#include "net/replication.h"
+
+#include <glm/gtc/packing.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+#include "ecs/components.h"
+#include "ecs/world.h"
+
+namespace {
+
+// Packets: a 3-byte header, then per type
+//
+// | Type     | Direction | After the header                                        |
+// | -------- | --------- | ------------------------------------------------------- |
+// | Ack      | to server | session, sequence (0, 0: hello), view min.xy max.xy,    |
+// |          |           | newest input tick, n, n action masks (oldest first)     |
+// | Snapshot | to client | session, sequence, baseline (0: none), player id,       |
+// |          |           | last input tick applied, bounds, records                |
+// | Bye      | to server | —                                                       |
+//
+// Integers and floats little-endian. Records are bit-packed (net/bit_stream.h):
+//
+//     { 1 | id gap (var) | op (2) | payload } ... 0
+//
+//     op Remove: nothing    op Full: every field    op Delta: field mask (6) + those fields
+constexpr std::uint16_t kMagic = 0x4e52;   // "RN"
+enum PacketType : std::uint8_t { kAck = 1, kSnapshot = 2, kBye = 3 };
+enum RecordOp : std::uint32_t { kRemove = 0, kFull = 1, kDelta = 2 };
+enum FieldBit : std::uint32_t {
+    kFieldPosition = 1, kFieldRotation = 2, kFieldScale = 4, kFieldColor = 8, kFieldSprite = 16, kFieldZLayer = 32
+};
+constexpr std::size_t kHeaderBytes = 3;
+constexpr std::size_t kAckBytes = kHeaderBytes + 8 + 16 + 5;     // without the masks
+constexpr std::size_t kSnapshotHeaderBytes = kHeaderBytes + 20 + 16;
+// The most one record can take: more bit, a 32-bit gap, op, and a delta with every field
+// changed by the most it can. A record is only started if this much still fits.
+constexpr std::size_t kMaxRecordBits = 1 + 38 + 2 + 6 + 2 * 23 + 23 + 32 + 32 + 16 + 16;
+
+void putHeader(std::vector<std::uint8_t>& out, PacketType type) {
+    out.clear();
+    out.push_back(static_cast<std::uint8_t>(kMagic & 0xff));
+    out.push_back(static_cast<std::uint8_t>(kMagic >> 8));
+    out.push_back(type);
+}
+void put32(std::vector<std::uint8_t>& out, std::uint32_t v) {
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<std::uint8_t>(v >> (8 * i)));
+    }
+}
+void putFloat(std::vector<std::uint8_t>& out, float f) {
+    std::uint32_t v;
+    std::memcpy(&v, &f, 4);
+    put32(out, v);
+}
+void putRect(std::vector<std::uint8_t>& out, const Aabb& rect) {
+    putFloat(out, rect.min.x);
+    putFloat(out, rect.min.y);
+    putFloat(out, rect.max.x);
+    putFloat(out, rect.max.y);
+}
+std::uint32_t get32(const std::uint8_t* p) {
+    return std::uint32_t(p[0]) | std::uint32_t(p[1]) << 8 | std::uint32_t(p[2]) << 16 | std::uint32_t(p[3]) << 24;
+}
+void put64(std::vector<std::uint8_t>& out, std::uint64_t v) {
+    put32(out, static_cast<std::uint32_t>(v));
+    put32(out, static_cast<std::uint32_t>(v >> 32));
+}
+std::uint64_t get64(const std::uint8_t* p) {
+    return get32(p) | static_cast<std::uint64_t>(get32(p + 4)) << 32;
+}
+float getFloat(const std::uint8_t* p) {
+    const std::uint32_t v = get32(p);
+    float f;
+    std::memcpy(&f, &v, 4);
+    return f;
+}
+Aabb getRect(const std::uint8_t* p) {
+    return Aabb{glm::vec2(getFloat(p), getFloat(p + 4)), glm::vec2(getFloat(p + 8), getFloat(p + 12))};
+}
+// The type of a packet from this game, or 0.
+std::uint8_t packetType(const std::uint8_t* p, int size) {
+    if (size < static_cast<int>(kHeaderBytes) || (p[0] | p[1] << 8) != kMagic) {
+        return 0;
+    }
+    return p[2];
+}
+
+// Quantization
+std::uint32_t quantizePosition(const glm::vec2& p, const Aabb& bounds) {
+    return glm::packUnorm2x16((p - bounds.min) / (bounds.max - bounds.min));
+}
+glm::vec2 dequantizePosition(std::uint32_t q, const Aabb& bounds) {
+    return bounds.min + glm::unpackUnorm2x16(q) * (bounds.max - bounds.min);
+}
+std::uint16_t quantizeRotation(float radians) {
+    const float turns = radians * 0.15915494f;
+    return glm::packUnorm1x16(turns - std::floor(turns));
+}
+float dequantizeRotation(std::uint16_t q) {
+    return glm::unpackUnorm1x16(q) * 6.2831853f;
+}
+
+// Sorted insert / replace / erase by id.
+void applyRecord(NetSnapshot& states, std::uint32_t id, RecordOp op, const NetState& value) {
+    auto at = std::lower_bound(states.begin(), states.end(), id,
+                               [](const NetState& s, std::uint32_t key) { return s.id < key; });
+    const bool found = at != states.end() && at->id == id;
+    if (op == kRemove) {
+        if (found) {
+            states.erase(at);
+        }
+    } else if (found) {
+        *at = value;
+    } else {
+        states.insert(at, value);
+    }
+}
+
+void writeRecord(BitWriter& out, RecordOp op, const NetState* now, const NetState* base) {
+    out.write(op, 2);
+    if (op == kFull) {
+        out.write(now->position, 32);
+        out.write(now->rotation, 16);
+        out.write(now->scale, 32);
+        out.write(now->color, 32);
+        out.write(now->sprite, 16);
+        out.write(now->zLayer, 16);
+    } else if (op == kDelta) {
+        const std::uint32_t mask = (now->position != base->position ? kFieldPosition : 0u) |
+                                   (now->rotation != base->rotation ? kFieldRotation : 0u) |
+                                   (now->scale != base->scale ? kFieldScale : 0u) |
+                                   (now->color != base->color ? kFieldColor : 0u) |
+                                   (now->sprite != base->sprite ? kFieldSprite : 0u) |
+                                   (now->zLayer != base->zLayer ? kFieldZLayer : 0u);
+        out.write(mask, 6);
+        if (mask & kFieldPosition) {
+            // Per axis, the move in quantization steps: a few bits for anything that moved
+            // at a sensible speed since the baseline.
+            out.writeVarInt(static_cast<std::int32_t>(now->position & 0xffff) -
+                            static_cast<std::int32_t>(base->position & 0xffff));
+            out.writeVarInt(static_cast<std::int32_t>(now->position >> 16) -
+                            static_cast<std::int32_t>(base->position >> 16));
+        }
+        if (mask & kFieldRotation) {
+            out.writeVarInt(static_cast<std::int16_t>(now->rotation - base->rotation));   // the short way round
+        }
+        if (mask & kFieldScale) out.write(now->scale, 32);
+        if (mask & kFieldColor) out.write(now->color, 32);
+        if (mask & kFieldSprite) out.write(now->sprite, 16);
+        if (mask & kFieldZLayer) out.write(now->zLayer, 16);
+    }
+}
+
+// baseline + the records in `in` → out. false if the records are malformed.
+bool decodeRecords(BitReader& in, const NetSnapshot& baseline, NetSnapshot& out) {
+    out = baseline;
+    std::uint32_t id = 0;
+    while (in.readBool()) {
+        id += in.readVarUint();
+        const RecordOp op = static_cast<RecordOp>(in.read(2));
+        NetState state;
+        state.id = id;
+        if (op == kFull) {
+            state.position = in.read(32);
+            state.rotation = static_cast<std::uint16_t>(in.read(16));
+            state.scale = in.read(32);
+            state.color = in.read(32);
+            state.sprite = static_cast<std::uint16_t>(in.read(16));
+            state.zLayer = static_cast<std::uint16_t>(in.read(16));
+        } else if (op == kDelta) {
+            auto at = std::lower_bound(out.begin(), out.end(), id,
+                                       [](const NetState& s, std::uint32_t key) { return s.id < key; });
+            if (at == out.end() || at->id != id) {
+                return false;                   // a delta for something the baseline lacks
+            }
+            state = *at;
+            const std::uint32_t mask = in.read(6);
+            if (mask & kFieldPosition) {
+                const std::uint32_t x = static_cast<std::uint32_t>(static_cast<std::int32_t>(state.position & 0xffff) +
+                                                                   in.readVarInt());
+                const std::uint32_t y = static_cast<std::uint32_t>(static_cast<std::int32_t>(state.position >> 16) +
+                                                                   in.readVarInt());
+                state.position = (x & 0xffff) | (y & 0xffff) << 16;
+            }
+            if (mask & kFieldRotation) {
+                state.rotation = static_cast<std::uint16_t>(state.rotation + in.readVarInt());
+            }
+            if (mask & kFieldScale) state.scale = in.read(32);
+            if (mask & kFieldColor) state.color = in.read(32);
+            if (mask & kFieldSprite) state.sprite = static_cast<std::uint16_t>(in.read(16));
+            if (mask & kFieldZLayer) state.zLayer = static_cast<std::uint16_t>(in.read(16));
+        } else if (op != kRemove) {
+            return false;
+        }
+        if (in.overflowed()) {
+            return false;
+        }
+        applyRecord(out, id, op, state);
+    }
+    return !in.overflowed();
+}
+
+} // namespace
+
+bool ReplicationServer::open(const Settings& settings) {
+    close();
+    settings_ = settings;
+    if (!socket_.open(settings.port)) {
+        return false;
+    }
+    grid_ = UniformGrid(settings.cellSize);
+    // Sessions tell a client a snapshot is from a new connection (a restarted server
+    // counts sequences from 1 again): not the same as the last run's.
+    nextSession_ = static_cast<std::uint32_t>(std::chrono::steady_clock::now().time_since_epoch().count()) | 1u;
+    stats_ = Stats{};
+    return true;
+}
+
+void ReplicationServer::close() {
+    socket_.close();
+    clients_.clear();
+    stats_.clients = 0;
+}
+
+void ReplicationServer::leave(World& world, Client& client) {
+    if (client.player.slot != EntityHandle::kInvalidSlot) {
+        world.destroy(client.player);
+    }
+}
+
+void ReplicationServer::receive(World& world, double now) {
+    NetAddress from;
+    std::uint8_t buffer[UdpSocket::kMaxDatagram];
+    int size;
+    while ((size = socket_.receive(from, buffer, sizeof(buffer))) >= 0) {
+        ++stats_.packetsReceived;
+        const std::uint8_t type = packetType(buffer, size);
+        auto client = std::find_if(clients_.begin(), clients_.end(),
+                                   [&from](const Client& c) { return c.address == from; });
+        if (type == kBye) {
+            if (client != clients_.end()) {
+                leave(world, *client);
+                clients_.erase(client);
+            }
+            continue;
+        }
+        if (type != kAck || size < static_cast<int>(kAckBytes)) {
+            ++stats_.malformed;
+            continue;
+        }
+        if (client == clients_.end()) {
+            if (static_cast<int>(clients_.size()) >= settings_.maxClients) {
+                continue;                       // full: it keeps saying hello, and waits
+            }
+            clients_.emplace_back();
+            client = clients_.end() - 1;
+            client->address = from;
+            client->session = nextSession_++;
+            if (settings_.spawnPlayer) {
+                client->player = settings_.spawnPlayer(world);
+            }
+            ++stats_.joined;
+        }
+        const std::uint32_t session = get32(buffer + kHeaderBytes);
+        const std::uint32_t sequence = get32(buffer + kHeaderBytes + 4);
+        // Acks can arrive out of order: only ever move forward, and never past what was sent.
+        if (session == client->session && sequence > client->acked && sequence <= client->sequence) {
+            client->acked = sequence;
+        }
+        client->view = getRect(buffer + kHeaderBytes + 8);
+        client->lastHeard = now;
+
+        // Input: the same ticks arrive in several acks; each is kept once, until stepped.
+        const std::uint32_t newest = get32(buffer + kHeaderBytes + 24);
+        const std::uint32_t count = std::min<std::uint32_t>(buffer[kHeaderBytes + 28], newest);
+        if (size < static_cast<int>(kAckBytes + 8 * count)) {
+            ++stats_.malformed;
+            continue;
+        }
+        for (std::uint32_t i = 0; i < count; ++i) {
+            const std::uint32_t tick = newest - count + 1 + i;
+            if (tick <= client->appliedInput) {
+                continue;
+            }
+            TickInput& slot = client->inputs[tick % kInputRing];
+            slot.tick = tick;
+            slot.actions = get64(buffer + kAckBytes + 8 * i);
+        }
+        client->newestInput = std::max(client->newestInput, newest);
+    }
+}
+
+void ReplicationServer::stepInputs(World& world) {
+    for (Client& client : clients_) {
+        PlayerInput* input = world.get<PlayerInput>(client.player);
+        if (!input) {
+            continue;
+        }
+        // More than a few ticks queued (a burst after a stall, or a client stepping a bit
+        // faster): skip to the newest few, or the lag would only ever grow.
+        const std::uint32_t kMaxQueued = 4;
+        if (client.newestInput > client.appliedInput + kMaxQueued) {
+            client.appliedInput = client.newestInput - kMaxQueued;
+        }
+        const std::uint32_t tick = client.appliedInput + 1;
+        const TickInput& slot = client.inputs[tick % kInputRing];
+        if (slot.tick == tick) {
+            client.actions = slot.actions;
+            client.appliedInput = tick;
+        } else if (client.newestInput > tick) {
+            // Lost in every packet that carried it: the previous actions stand in for it.
+            client.appliedInput = tick;
+            ++stats_.inputsLost;
+        }
+        // Else the client's input hasn't arrived yet: keep going with what it last did.
+        input->actions = client.actions;
+    }
+}
+
+void ReplicationServer::gather(World& world) {
+    all_.clear();
+    allBounds_.clear();
+    const Aabb& bounds = settings_.bounds;
+    world.forEachChunkWithHandles<Position, Rotation, Scale, Color, SpriteRef, ZLayer>(
+        [&](std::size_t n, const EntityHandle* h, Position* p, Rotation* r, Scale* s, Color* c, SpriteRef* sprite,
+            ZLayer* z) {
+            for (std::size_t i = 0; i < n; ++i) {
+                NetState state;
+                state.id = h[i].slot << 8 | (h[i].generation & 0xff);
+                state.position = quantizePosition(p[i].value, bounds);
+                state.rotation = quantizeRotation(r[i].radians);
+                state.scale = glm::packHalf2x16(s[i].value);
+                state.color = c[i].rgba;
+                state.sprite = static_cast<std::uint16_t>(sprite[i].id);
+                state.zLayer = z[i].value;
+                all_.push_back(state);
+                const glm::vec2 half = 0.5f * glm::abs(s[i].value);
+                allBounds_.push_back(Aabb{p[i].value - half, p[i].value + half});
+            }
+        });
+    grid_.rebuild(allBounds_.data(), allBounds_.size());
+}
+
+void ReplicationServer::sendSnapshot(Client& client) {
+    found_.clear();
+    const Aabb interest{client.view.min - glm::vec2(settings_.viewMargin), client.view.max + glm::vec2(settings_.viewMargin)};
+    grid_.queryRect(interest, found_);
+    visible_.clear();
+    for (ObjectId id : found_) {
+        visible_.push_back(all_[id]);
+    }
+    std::sort(visible_.begin(), visible_.end(), [](const NetState& a, const NetState& b) { return a.id < b.id; });
+    // The client's own player, even out of its view: it reconciles against it.
+    const std::uint32_t playerId = client.player.slot != EntityHandle::kInvalidSlot
+                                       ? client.player.slot << 8 | (client.player.generation & 0xff)
+                                       : ReplicationClient::kNoPlayer;
+    auto playerAt = std::lower_bound(visible_.begin(), visible_.end(), playerId,
+                                     [](const NetState& s, std::uint32_t key) { return s.id < key; });
+    if (playerId != ReplicationClient::kNoPlayer && (playerAt == visible_.end() || playerAt->id != playerId)) {
+        auto it = std::find_if(all_.begin(), all_.end(), [playerId](const NetState& s) { return s.id == playerId; });
+        if (it != all_.end()) {
+            visible_.insert(playerAt, *it);
+        }
+    }
+
+    static const NetSnapshot kNothing;
+    const Sent& acked = client.history[client.acked % kHistory];
+    const bool hasBaseline = client.acked != 0 && acked.sequence == client.acked;
+    const NetSnapshot& baseline = hasBaseline ? acked.states : kNothing;
+
+    // What differs, by id: both lists are sorted.
+    struct Diff {
+        std::uint32_t id;
+        RecordOp op;
+        const NetState* now;
+        const NetState* base;
+    };
+    std::vector<Diff> diffs;
+    std::size_t b = 0, v = 0;
+    while (b < baseline.size() || v < visible_.size()) {
+        if (v == visible_.size() || (b < baseline.size() && baseline[b].id < visible_[v].id)) {
+            diffs.push_back(Diff{baseline[b].id, kRemove, nullptr, &baseline[b]});
+            ++b;
+        } else if (b == baseline.size() || visible_[v].id < baseline[b].id) {
+            diffs.push_back(Diff{visible_[v].id, kFull, &visible_[v], nullptr});
+            ++v;
+        } else {
+            if (visible_[v] != baseline[b]) {
+                diffs.push_back(Diff{visible_[v].id, kDelta, &visible_[v], &baseline[b]});
+            }
+            ++b;
+            ++v;
+        }
+    }
+
+    // Records from the cursor on (wrapping), until the packet is full. The record of what
+    // the client will have is the baseline with each written record applied.
+    NetSnapshot record = baseline;
+    const std::size_t start = static_cast<std::size_t>(
+        std::lower_bound(diffs.begin(), diffs.end(), client.cursor,
+                         [](const Diff& d, std::uint32_t key) { return d.id < key; }) -
+        diffs.begin());
+    const std::size_t budgetBits = (settings_.packetBytes - kSnapshotHeaderBytes) * 8 - 1;
+    writer_.clear();
+    std::uint32_t previous = 0;
+    std::size_t written = 0;
+    client.cursor = 0;
+    for (; written < diffs.size(); ++written) {
+        const Diff& d = diffs[(start + written) % diffs.size()];
+        if (writer_.bitCount() + kMaxRecordBits > budgetBits) {
+            client.cursor = d.id;
+            break;
+        }
+        writer_.writeBool(true);
+        writer_.writeVarUint(d.id - previous);  // wraps once, past the last id: still exact
+        previous = d.id;
+        writeRecord(writer_, d.op, d.now, d.base);
+        applyRecord(record, d.id, d.op, d.now ? *d.now : NetState{});
+    }
+    writer_.writeBool(false);
+
+    const std::uint32_t sequence = ++client.sequence;
+    putHeader(packet_, kSnapshot);
+    put32(packet_, client.session);
+    put32(packet_, sequence);
+    put32(packet_, hasBaseline ? client.acked : 0u);
+    put32(packet_, playerId);
+    put32(packet_, client.appliedInput);
+    putRect(packet_, settings_.bounds);
+    const std::vector<std::uint8_t>& bits = writer_.bytes();
+    packet_.insert(packet_.end(), bits.begin(), bits.end());
+    socket_.send(client.address, packet_.data(), packet_.size());
+
+    Sent& sent = client.history[sequence % kHistory];
+    sent.sequence = sequence;
+    sent.states = std::move(record);
+    ++stats_.snapshots;
+    stats_.fullSnapshots += hasBaseline ? 0 : 1;
+    stats_.bytesSent += packet_.size();
+    stats_.records += written;
+    stats_.deferred += diffs.size() - written;
+}
+
+void ReplicationServer::update(World& world, double now) {
+    if (!socket_.isOpen()) {
+        return;
+    }
+    receive(world, now);
+    clients_.erase(std::remove_if(clients_.begin(), clients_.end(),
+                                  [&](Client& c) {
+                                      if (now - c.lastHeard <= settings_.timeout) {
+                                          return false;
+                                      }
+                                      leave(world, c);
+                                      return true;
+                                  }),
+                   clients_.end());
+    stats_.clients = clients_.size();
+    if (now < nextSend_ || clients_.empty()) {
+        return;
+    }
+    // On the send rate's grid; after a stall, the next send is the first one due.
+    const double interval = 1.0 / settings_.sendHz;
+    nextSend_ = std::max(nextSend_ + interval, now);
+    gather(world);
+    for (Client& client : clients_) {
+        sendSnapshot(client);
+    }
+}
+
+bool ReplicationClient::connect(const NetAddress& server) {
+    close();
+    if (!socket_.open(0)) {
+        return false;
+    }
+    server_ = server;
+    session_ = 0;
+    latest_ = 0;
+    lastSent_ = -1.0;
+    for (Received& r : history_) {
+        r.sequence = 0;
+    }
+    return true;
+}
+
+void ReplicationClient::close() {
+    if (socket_.isOpen()) {
+        putHeader(packet_, kBye);
+        socket_.send(server_, packet_.data(), packet_.size());
+        socket_.close();
+    }
+}
+
+void ReplicationClient::pushInput(std::uint32_t tick, ActionMask actions) {
+    inputs_[tick % kInputRedundancy] = actions;
+    inputTick_ = tick;
+    ++stats_.inputsSent;
+}
+
+bool ReplicationClient::takePlayerState(std::uint32_t& inputTick, glm::vec2& position) {
+    if (!playerFresh_) {
+        return false;
+    }
+    playerFresh_ = false;
+    inputTick = playerInputTick_;
+    position = playerPosition_;
+    return true;
+}
+
+void ReplicationClient::sendAck(const Aabb& view, double now) {
+    putHeader(packet_, kAck);
+    put32(packet_, session_);
+    put32(packet_, latest_);
+    putRect(packet_, view);
+    // The newest ticks of input, oldest first: any one of these packets arriving is enough.
+    const std::uint32_t count = std::min<std::uint32_t>(inputTick_, kInputRedundancy);
+    put32(packet_, inputTick_);
+    packet_.push_back(static_cast<std::uint8_t>(count));
+    for (std::uint32_t tick = inputTick_ - count + 1; tick <= inputTick_ && count > 0; ++tick) {
+        put64(packet_, inputs_[tick % kInputRedundancy]);
+    }
+    socket_.send(server_, packet_.data(), packet_.size());
+    lastSent_ = now;
+    lastSentInput_ = inputTick_;
+}
+
+void ReplicationClient::update(World& world, const Aabb& view, double now) {
+    if (!socket_.isOpen()) {
+        return;
+    }
+    NetAddress from;
+    std::uint8_t buffer[UdpSocket::kMaxDatagram];
+    int size;
+    const NetSnapshot* newest = nullptr;
+    Aabb bounds{};
+    NetSnapshot decoded;
+    while ((size = socket_.receive(from, buffer, sizeof(buffer))) >= 0) {
+        if (from != server_ || packetType(buffer, size) != kSnapshot || size < static_cast<int>(kSnapshotHeaderBytes)) {
+            continue;
+        }
+        stats_.bytesReceived += static_cast<std::uint64_t>(size);
+        const std::uint32_t session = get32(buffer + kHeaderBytes);
+        const std::uint32_t sequence = get32(buffer + kHeaderBytes + 4);
+        const std::uint32_t baselineSequence = get32(buffer + kHeaderBytes + 8);
+        if (session != session_) {
+            // A new connection on the server's side: its sequences start over.
+            session_ = session;
+            latest_ = 0;
+            for (Received& r : history_) {
+                r.sequence = 0;
+            }
+        }
+        if (sequence <= latest_) {
+            ++stats_.stale;
+            continue;
+        }
+        static const NetSnapshot kNothing;
+        const Received& base = history_[baselineSequence % kHistory];
+        if (baselineSequence != 0 && base.sequence != baselineSequence) {
+            ++stats_.undecodable;
+            continue;
+        }
+        BitReader reader(buffer + kSnapshotHeaderBytes, static_cast<std::size_t>(size) - kSnapshotHeaderBytes);
+        if (!decodeRecords(reader, baselineSequence != 0 ? base.states : kNothing, decoded)) {
+            ++stats_.undecodable;
+            continue;
+        }
+        Received& slot = history_[sequence % kHistory];
+        slot.sequence = sequence;
+        slot.states.swap(decoded);
+        newest = &slot.states;
+        bounds = getRect(buffer + kHeaderBytes + 20);
+        playerId_ = get32(buffer + kHeaderBytes + 12);
+        playerInputTick_ = get32(buffer + kHeaderBytes + 16);
+        latest_ = sequence;
+        lastReceived_ = now;
+        ++stats_.snapshots;
+    }
+    if (newest) {
+        apply(world, *newest, bounds);
+        auto player = std::lower_bound(newest->begin(), newest->end(), playerId_,
+                                       [](const NetState& s, std::uint32_t key) { return s.id < key; });
+        if (player != newest->end() && player->id == playerId_) {
+            playerPosition_ = dequantizePosition(player->position, bounds);
+            playerFresh_ = true;
+        }
+    }
+    // Every frame with new input (it is what moves this client's player on the server);
+    // else on each snapshot, and a hello / keep-alive now and then.
+    if (newest || inputTick_ != lastSentInput_ || now - lastSent_ > 0.25) {
+        sendAck(view, now);
+    }
+}
+
+void ReplicationClient::apply(World& world, const NetSnapshot& next, const Aabb& bounds) {
+    // This client's own player is predicted (net/prediction.h), not applied: it is left out.
+    nextScratch_.clear();
+    for (const NetState& s : next) {
+        if (s.id != playerId_) {
+            nextScratch_.push_back(s);
+        }
+    }
+    const NetSnapshot& shown = nextScratch_;
+    std::size_t a = 0, n = 0;
+    while (a < applied_.size() || n < shown.size()) {
+        if (n == shown.size() || (a < applied_.size() && applied_[a].id < shown[n].id)) {
+            auto it = entities_.find(applied_[a].id);
+            if (it != entities_.end()) {
+                world.destroy(it->second);
+                entities_.erase(it);
+            }
+            ++a;
+            continue;
+        }
+        const NetState& s = shown[n];
+        const glm::vec2 p = dequantizePosition(s.position, bounds);
+        if (a == applied_.size() || s.id < applied_[a].id) {
+            entities_[s.id] = world.create(Position{p}, PreviousPosition{p}, Rotation{dequantizeRotation(s.rotation)},
+                                           Scale{glm::unpackHalf2x16(s.scale)}, Color{s.color}, SpriteRef{s.sprite},
+                                           ZLayer{s.zLayer});
+        } else {
+            if (s != applied_[a]) {
+                const EntityHandle h = entities_[s.id];
+                // Snapped, not interpolated: PreviousPosition too, as nothing steps it here.
+                if (Position* position = world.get<Position>(h)) position->value = p;
+                if (PreviousPosition* previous = world.get<PreviousPosition>(h)) previous->value = p;
+                if (Rotation* rotation = world.get<Rotation>(h)) rotation->radians = dequantizeRotation(s.rotation);
+                if (Scale* scale = world.get<Scale>(h)) scale->value = glm::unpackHalf2x16(s.scale);
+                if (Color* color = world.get<Color>(h)) color->rgba = s.color;
+                if (SpriteRef* sprite = world.get<SpriteRef>(h)) sprite->id = s.sprite;
+                if (ZLayer* z = world.get<ZLayer>(h)) z->value = s.zLayer;
+            }
+            ++a;
+        }
+        ++n;
+    }
+    applied_ = shown;
+    stats_.entities = applied_.size();
+}
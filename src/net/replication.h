@@ -0,0 +1,248 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "core/entity_handle.h"
+#include "core/spatial_index.h"
+#include "core/uniform_grid.h"
+#include "input/input_state.h"
+#include "net/bit_stream.h"
+#include "net/udp_socket.h"
+
+class World;
+
+// Snapshot replication
+// --------------------
+// The server sends each client, sendHz times a second, the drawable state of the
+// entities that client can see, as a DELTA against the last snapshot the client
+// acknowledged. One UDP datagram per snapshot (net/udp_socket.h); none are resent: a
+// lost snapshot is simply superseded by the next, which is a delta against whatever the
+// client did ack.
+//
+//     server, every 1/sendHz s                     client, every frame
+//     grid ← every entity's bounds                 receive snapshot S (delta vs B)
+//     per client: visible = grid.query(its view)   state(S) = state(B) + records
+//       baseline = what it last acked              apply to its World (create/update/destroy)
+//       records  = visible vs baseline ─── S ───▶  ack S, and send where its view is now
+//       remember what S leaves it with  ◀─ ack ──
+//
+// | Piece         | How                                                                  |
+// | ------------- | -------------------------------------------------------------------- |
+// | baselines     | per client, the last kHistory snapshots sent, each the client's whole |
+// |               | state after it; the client keeps the last kHistory it received. An    |
+// |               | ack older than that (or none yet) gets a full snapshot (baseline 0)   |
+// | records       | only what differs from the baseline: entity left the view (remove),  |
+// |               | came in (full state), or changed (a mask of the fields that did)     |
+// | quantization  | position: 16 bits per axis over Settings::bounds (glm::packUnorm2x16);|
+// |               | rotation 16 bits of a turn (packUnorm1x16); scale two halves         |
+// |               | (packHalf2x16); a moved position is the difference in those units    |
+// | bit packing   | net/bit_stream.h: entity ids as gaps from the previous one, small    |
+// |               | differences in few bits. A wanderer moving each snapshot is ~5 bytes |
+// | interest      | a UniformGrid (core/uniform_grid.h) of every entity, queried with    |
+// |               | each client's view plus viewMargin: bandwidth follows what a client  |
+// |               | sees, not the size of the World                                      |
+// | packet budget | records stop at packetBytes; the rest wait for the next snapshot,    |
+// |               | which starts where this one stopped, so nothing is starved            |
+//
+// Ids on the wire are the server's EntityHandle slot and the low 8 bits of its
+// generation: a reused slot reads as a different entity. Slots must stay under 2^24.
+//
+// Players: with Settings::spawnPlayer, each client gets an entity on the server that its
+// input moves. Every ack carries the client's last kInputRedundancy ticks of actions
+// (ActionMask, input/input_state.h), so one lost packet loses no input; stepInputs()
+// feeds one tick of them per simulation step into the entity's PlayerInput. Snapshots
+// say which entity is the client's and the last input tick the server applied to it:
+// the client predicts its player locally and reconciles against that (net/prediction.h),
+// so its own entity is left out of what it applies. Everything else in a client's World
+// is exactly what the server last sent, never simulated.
+//
+// The protocol has no authentication or encryption; it is for a LAN.
+
+// One entity as it goes over the wire.
+struct NetState {
+    std::uint32_t id = 0;              // slot << 8 | generation & 0xff
+    std::uint32_t position = 0;        // packUnorm2x16 within the bounds
+    std::uint32_t scale = 0;           // packHalf2x16
+    std::uint32_t color = 0;
+    std::uint16_t rotation = 0;        // packUnorm1x16 of radians / 2pi
+    std::uint16_t sprite = 0;
+    std::uint16_t zLayer = 0;
+
+    bool operator==(const NetState& o) const {
+        return id == o.id && position == o.position && scale == o.scale && color == o.color &&
+               rotation == o.rotation && sprite == o.sprite && zLayer == o.zLayer;
+    }
+    bool operator!=(const NetState& o) const { return !(*this == o); }
+};
+
+using NetSnapshot = std::vector<NetState>;     // sorted by id
+
+class ReplicationServer {
+public:
+    static constexpr std::size_t kHistory = 32;
+
+    struct Settings {
+        std::uint16_t port = 27960;
+        float sendHz = 20.0f;
+        std::size_t packetBytes = 1200;        // under a typical MTU: never fragmented
+        Aabb bounds{glm::vec2(-64.0f), glm::vec2(64.0f)};   // positions are quantized in here
+        float cellSize = 1.0f;                 // interest grid
+        float viewMargin = 0.5f;               // beyond the client's view, so entities
+                                               // are there before they come into it
+        int maxClients = 8;
+        double timeout = 5.0;                  // seconds without a packet: gone
+        // A new client's player entity (destroyed when it leaves); none if empty. It
+        // needs a PlayerInput for stepInputs() to drive it.
+        std::function<EntityHandle(World&)> spawnPlayer;
+    };
+
+    struct Stats {
+        std::uint64_t snapshots = 0;
+        std::uint64_t fullSnapshots = 0;       // no usable baseline
+        std::uint64_t bytesSent = 0;
+        std::uint64_t records = 0;
+        std::uint64_t deferred = 0;            // records left for a later snapshot (budget)
+        std::uint64_t packetsReceived = 0;
+        std::uint64_t malformed = 0;
+        std::uint64_t inputsLost = 0;          // ticks stepped with the previous actions
+        std::size_t clients = 0;
+        std::size_t joined = 0;                // over the whole run
+    };
+
+    ReplicationServer() = default;
+    ReplicationServer(const ReplicationServer&) = delete;
+    ReplicationServer& operator=(const ReplicationServer&) = delete;
+
+    bool open(const Settings& settings);
+    void close();
+    bool isOpen() const { return socket_.isOpen(); }
+
+    // Once a frame, after the simulation: takes in hellos, acks and input, and when a send
+    // is due sends every client its snapshot of `world`. `now` in seconds, any steady origin.
+    void update(World& world, double now);
+    // Every simulation step, before the systems: each player's next tick of input.
+    void stepInputs(World& world);
+
+    const Stats& stats() const { return stats_; }
+
+private:
+    struct Sent {
+        std::uint32_t sequence = 0;            // 0: empty
+        NetSnapshot states;                    // the client's state once it has this one
+    };
+    static constexpr std::size_t kInputRing = 64;  // power of two
+    struct TickInput {
+        std::uint32_t tick = 0;
+        ActionMask actions = 0;
+    };
+    struct Client {
+        NetAddress address;
+        EntityHandle player;
+        std::array<TickInput, kInputRing> inputs;
+        std::uint32_t newestInput = 0;         // the newest tick received
+        std::uint32_t appliedInput = 0;        // the last tick stepped
+        ActionMask actions = 0;                // what that tick was
+        std::uint32_t session = 0;
+        Aabb view{glm::vec2(-1.0f), glm::vec2(1.0f)};
+        double lastHeard = 0.0;
+        std::uint32_t sequence = 0;            // last sent
+        std::uint32_t acked = 0;
+        std::uint32_t cursor = 0;              // the id the next snapshot starts from
+        std::array<Sent, kHistory> history;
+    };
+
+    void receive(World& world, double now);
+    void leave(World& world, Client& client);
+    void gather(World& world);
+    void sendSnapshot(Client& client);
+
+    Settings settings_;
+    UdpSocket socket_;
+    std::vector<Client> clients_;
+    double nextSend_ = 0.0;
+    std::uint32_t nextSession_ = 1;
+    Stats stats_;
+
+    // Scratch, reused every send.
+    std::vector<NetState> all_;                // every replicated entity this send
+    std::vector<Aabb> allBounds_;
+    UniformGrid grid_;
+    std::vector<ObjectId> found_;
+    NetSnapshot visible_;
+    BitWriter writer_;
+    std::vector<std::uint8_t> packet_;
+};
+
+class ReplicationClient {
+public:
+    static constexpr std::size_t kHistory = ReplicationServer::kHistory;
+    static constexpr std::uint32_t kNoPlayer = 0xffffffffu;
+
+    struct Stats {
+        std::uint64_t snapshots = 0;           // applied
+        std::uint64_t bytesReceived = 0;
+        std::uint64_t stale = 0;               // older than one already applied
+        std::uint64_t undecodable = 0;         // baseline no longer kept, or malformed
+        std::uint64_t inputsSent = 0;          // ticks (each sent kInputRedundancy times)
+        std::size_t entities = 0;              // in the World now
+    };
+
+    ReplicationClient() = default;
+    ReplicationClient(const ReplicationClient&) = delete;
+    ReplicationClient& operator=(const ReplicationClient&) = delete;
+    ~ReplicationClient() { close(); }
+
+    bool connect(const NetAddress& server);
+    void close();                               // says goodbye, so the server frees the slot
+    bool isOpen() const { return socket_.isOpen(); }
+    // A snapshot arrived in the last second.
+    bool receiving(double now) const { return latest_ != 0 && now - lastReceived_ < 1.0; }
+
+    static constexpr std::size_t kInputRedundancy = 8;
+    // Every simulation step: the actions this client stepped its own player with. Ticks
+    // count from 1, one more each call.
+    void pushInput(std::uint32_t tick, ActionMask actions);
+    // Once per snapshot that has this client's player in it: the last input tick the
+    // server applied, and where that left the player. false when there is nothing new.
+    bool takePlayerState(std::uint32_t& inputTick, glm::vec2& position);
+
+    // Once a frame: applies the newest snapshot to `world` (spawning, moving and
+    // destroying entities), and tells the server what it saw and what `view` is.
+    void update(World& world, const Aabb& view, double now);
+
+    const Stats& stats() const { return stats_; }
+
+private:
+    struct Received {
+        std::uint32_t sequence = 0;
+        NetSnapshot states;
+    };
+
+    void sendAck(const Aabb& view, double now);
+    void apply(World& world, const NetSnapshot& next, const Aabb& bounds);
+
+    UdpSocket socket_;
+    NetAddress server_;
+    std::uint32_t session_ = 0;
+    std::uint32_t latest_ = 0;                 // newest sequence applied
+    std::uint32_t playerId_ = kNoPlayer;       // the server's entity for this client
+    std::uint32_t playerInputTick_ = 0;
+    glm::vec2 playerPosition_{0.0f};
+    bool playerFresh_ = false;
+    std::array<ActionMask, kInputRedundancy> inputs_{};   // by tick % kInputRedundancy
+    std::uint32_t inputTick_ = 0;              // the newest pushed
+    std::uint32_t lastSentInput_ = 0;
+    double lastReceived_ = 0.0;
+    double lastSent_ = -1.0;
+    std::array<Received, kHistory> history_;
+    NetSnapshot applied_;                       // what the World has now
+    NetSnapshot nextScratch_;
+    std::unordered_map<std::uint32_t, EntityHandle> entities_;   // wire id → local
+    Stats stats_;
+    std::vector<std::uint8_t> packet_;
+};
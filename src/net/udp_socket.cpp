@@ -0,0 +1,125 @@
+#include "net/udp_socket.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#define UDP_SOCKET_POSIX 1
+#endif
+
+#include <cstdlib>
+#include <cstring>
+
+bool NetAddress::parse(const std::string& text, NetAddress& out) {
+    const std::size_t colon = text.rfind(':');
+    if (colon == std::string::npos || colon + 1 == text.size()) {
+        return false;
+    }
+    const int port = std::atoi(text.c_str() + colon + 1);
+    if (port <= 0 || port > 65535) {
+        return false;
+    }
+#ifdef UDP_SOCKET_POSIX
+    const std::string host = colon == 0 ? std::string("127.0.0.1") : text.substr(0, colon);
+    addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo* result = nullptr;
+    if (getaddrinfo(host.c_str(), nullptr, &hints, &result) != 0 || !result) {
+        return false;
+    }
+    out.ip = ntohl(reinterpret_cast<const sockaddr_in*>(result->ai_addr)->sin_addr.s_addr);
+    out.port = static_cast<std::uint16_t>(port);
+    freeaddrinfo(result);
+    return true;
+#else
+    (void)out;
+    return false;
+#endif
+}
+
+std::string NetAddress::toString() const {
+    return std::to_string(ip >> 24) + "." + std::to_string((ip >> 16) & 0xff) + "." + std::to_string((ip >> 8) & 0xff) +
+           "." + std::to_string(ip & 0xff) + ":" + std::to_string(port);
+}
+
+bool UdpSocket::open(std::uint16_t port) {
+    close();
+#ifdef UDP_SOCKET_POSIX
+    const int fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        return false;
+    }
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+    socklen_t length = sizeof(address);
+    if (::bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL, 0) | O_NONBLOCK) != 0 ||
+        ::getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+        ::close(fd);
+        return false;
+    }
+    fd_ = fd;
+    port_ = ntohs(address.sin_port);
+    return true;
+#else
+    (void)port;
+    return false;
+#endif
+}
+
+void UdpSocket::close() {
+#ifdef UDP_SOCKET_POSIX
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+#endif
+    fd_ = -1;
+    port_ = 0;
+}
+
+bool UdpSocket::send(const NetAddress& to, const void* data, std::size_t size) {
+#ifdef UDP_SOCKET_POSIX
+    if (fd_ < 0) {
+        return false;
+    }
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(to.ip);
+    address.sin_port = htons(to.port);
+    return ::sendto(fd_, data, size, 0, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) ==
+           static_cast<ssize_t>(size);
+#else
+    (void)to, (void)data, (void)size;
+    return false;
+#endif
+}
+
+int UdpSocket::receive(NetAddress& from, void* buffer, std::size_t capacity) {
+#ifdef UDP_SOCKET_POSIX
+    if (fd_ < 0) {
+        return -1;
+    }
+    sockaddr_in address;
+    socklen_t length = sizeof(address);
+    const ssize_t got =
+        ::recvfrom(fd_, buffer, capacity, 0, reinterpret_cast<sockaddr*>(&address), &length);
+    if (got < 0) {
+        return -1;      // EAGAIN (nothing waiting) or an ICMP error from an earlier send
+    }
+    from.ip = ntohl(address.sin_addr.s_addr);
+    from.port = ntohs(address.sin_port);
+    return static_cast<int>(got);
+#else
+    (void)from, (void)buffer, (void)capacity;
+    return -1;
+#endif
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// NetAddress
+// ----------
+// An IPv4 address and port, in host byte order.
+struct NetAddress {
+    std::uint32_t ip = 0;
+    std::uint16_t port = 0;
+
+    bool operator==(const NetAddress& o) const { return ip == o.ip && port == o.port; }
+    bool operator!=(const NetAddress& o) const { return !(*this == o); }
+
+    // "host:port" (a name or dotted quad). Resolving a name may block briefly.
+    static bool parse(const std::string& text, NetAddress& out);
+    std::string toString() const;
+};
+
+// UdpSocket
+// ---------
+// One non-blocking UDP socket: send() and receive() never wait, so the game thread can
+// pump it once a frame. Datagrams arrive whole or not at all, in any order, maybe twice:
+// whatever rides on this (net/replication.h) copes with all of that itself.
+//
+// POSIX sockets; elsewhere open() fails and the game runs without networking.
+class UdpSocket {
+public:
+    // Larger than any packet this game sends (they are kept under a typical MTU).
+    static constexpr std::size_t kMaxDatagram = 1500;
+
+    UdpSocket() = default;
+    UdpSocket(const UdpSocket&) = delete;
+    UdpSocket& operator=(const UdpSocket&) = delete;
+    ~UdpSocket() { close(); }
+
+    // Bound to `port` on every interface; 0 picks a free one (a client).
+    bool open(std::uint16_t port);
+    void close();
+    bool isOpen() const { return fd_ >= 0; }
+    std::uint16_t port() const { return port_; }
+
+    // false if the datagram was not sent (no buffer space is not retried: it is lost like
+    // any other datagram).
+    bool send(const NetAddress& to, const void* data, std::size_t size);
+    // One datagram into buffer; the size, or -1 when nothing is waiting.
+    int receive(NetAddress& from, void* buffer, std::size_t capacity);
+
+private:
+    int fd_ = -1;
+    std::uint16_t port_ = 0;
+};
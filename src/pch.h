@@ -0,0 +1,29 @@
+// Precompiled header
+// ------------------
+// The Makefile compiles this once per configuration (build/<config>/pch.h.gch) and
+// force-includes it into every C++ file of the game, so the two biggest headers in the
+// tree are parsed once instead of once per file:
+//
+// | Header               | Why it's here                                              |
+// | -------------------- | ---------------------------------------------------------- |
+// | glad/glad.h          | ~4000 lines of GL declarations, in every render/ file      |
+// | glm (+ gtc headers)  | templates everywhere: core/, ecs/, render/                 |
+// | common std headers   | <string>, <vector>, ... which nearly every file pulls in   |
+//
+// Files still include what they use themselves: a build without the PCH (a tool target,
+// another build system) must compile the same.
+//
+// Changing this file rebuilds everything, so only stable, widely used headers go in.
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
@@ -0,0 +1,378 @@
+#include "profile/flight_recorder.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#define FLIGHT_RECORDER_POSIX 1
+#endif
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+
+namespace flightrec {
+
+namespace {
+
+enum class Kind : std::uint8_t { Section, Instant, Input, Frame };
+
+struct Event {
+    const char* name;
+    std::uint64_t ns;                  // steady_clock
+    std::uint64_t value;               // Section: duration ns; Input: key << 8 | action;
+    Kind kind;                         // Frame: microseconds
+};
+
+static_assert((kEvents & (kEvents - 1)) == 0, "kEvents must be a power of two");
+
+// One per thread that recorded an event. Never freed: a dump may read it after its
+// thread has ended.
+struct Ring {
+    Event events[kEvents];
+    std::atomic<std::uint64_t> written{0};
+    std::atomic<const char*> name{nullptr};
+};
+
+std::atomic<Ring*> gRings[kMaxThreads];
+std::atomic<int> gRingCount{0};
+std::atomic<bool> gActive{false};
+std::atomic<bool> gDumping{false};     // one dump at a time; a crash inside one doesn't recurse
+std::atomic<int> gDumps{0};
+
+thread_local Ring* tRing = nullptr;
+thread_local bool tNoRing = false;     // past kMaxThreads
+thread_local const char* tName = nullptr;
+
+std::uint64_t nowNs() {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+}
+
+Ring* localRing() {
+    if (!tRing && !tNoRing) {
+        const int index = gRingCount.fetch_add(1, std::memory_order_relaxed);
+        if (index >= kMaxThreads) {
+            tNoRing = true;
+            return nullptr;
+        }
+        tRing = new Ring();
+        tRing->name.store(tName, std::memory_order_relaxed);
+        gRings[index].store(tRing, std::memory_order_release);
+    }
+    return tRing;
+}
+
+void record(const char* name, std::uint64_t ns, std::uint64_t value, Kind kind) {
+    Ring* ring = localRing();
+    if (!ring) {
+        return;
+    }
+    const std::uint64_t n = ring->written.load(std::memory_order_relaxed);
+    ring->events[n & (kEvents - 1)] = Event{name, ns, value, kind};
+    ring->written.store(n + 1, std::memory_order_release);
+}
+
+#ifdef FLIGHT_RECORDER_POSIX
+
+// Buffered write() with its own number formatting: nothing here may allocate or lock.
+class Writer {
+public:
+    explicit Writer(int fd) : fd_(fd) {}
+    ~Writer() { flush(); }
+
+    void put(const char* text) {
+        for (; *text; ++text) {
+            putChar(*text);
+        }
+    }
+    // A name in quotes; what JSON would need escaped can't come from a literal we wrote.
+    void putName(const char* name) {
+        putChar('"');
+        for (; name && *name; ++name) {
+            putChar(*name == '"' || *name == '\\' || static_cast<unsigned char>(*name) < 0x20 ? '_' : *name);
+        }
+        putChar('"');
+    }
+    void putUnsigned(std::uint64_t value) {
+        char digits[20];
+        int n = 0;
+        do {
+            digits[n++] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        } while (value > 0);
+        while (n > 0) {
+            putChar(digits[--n]);
+        }
+    }
+    // thousandths as "X.YYY": ns as microseconds, microseconds as milliseconds.
+    void putThousandths(std::uint64_t value) {
+        putUnsigned(value / 1000);
+        putChar('.');
+        const std::uint64_t fraction = value % 1000;
+        putChar(static_cast<char>('0' + fraction / 100));
+        putChar(static_cast<char>('0' + fraction / 10 % 10));
+        putChar(static_cast<char>('0' + fraction % 10));
+    }
+    void putChar(char c) {
+        if (length_ == sizeof buffer_) {
+            flush();
+        }
+        buffer_[length_++] = c;
+    }
+    void flush() {
+        std::size_t done = 0;
+        while (done < length_ && ok_) {
+            const ssize_t n = ::write(fd_, buffer_ + done, length_ - done);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            ok_ = n > 0;
+            done += n > 0 ? static_cast<std::size_t>(n) : 0;
+        }
+        length_ = 0;
+    }
+    bool ok() const { return ok_; }
+
+private:
+    int fd_;
+    char buffer_[4096];
+    std::size_t length_ = 0;
+    bool ok_ = true;
+};
+
+// The oldest event of `ring` a dump reads: kGuardEvents past the oldest kept.
+std::uint64_t firstReadable(std::uint64_t written) {
+    return written > static_cast<std::uint64_t>(kEvents - kGuardEvents) ? written - (kEvents - kGuardEvents) : 0;
+}
+
+void writeEvents(Writer& out, int tid, const Ring& ring, std::uint64_t written, std::uint64_t baseNs, bool& first) {
+    auto begin = [&](const char* name, const char* phase, std::uint64_t ns) {
+        out.put(first ? "\n{\"name\":" : ",\n{\"name\":");
+        first = false;
+        out.putName(name);
+        out.put(",\"ph\":\"");
+        out.put(phase);
+        out.put("\",\"pid\":1,\"tid\":");
+        out.putUnsigned(static_cast<std::uint64_t>(tid));
+        out.put(",\"ts\":");
+        out.putThousandths(ns > baseNs ? ns - baseNs : 0);
+    };
+    if (const char* name = ring.name.load(std::memory_order_relaxed)) {
+        out.put(first ? "\n" : ",\n");
+        first = false;
+        out.put("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":");
+        out.putUnsigned(static_cast<std::uint64_t>(tid));
+        out.put(",\"args\":{\"name\":");
+        out.putName(name);
+        out.put("}}");
+    }
+    for (std::uint64_t i = firstReadable(written); i < written; ++i) {
+        const Event e = ring.events[i & (kEvents - 1)];
+        switch (e.kind) {
+            case Kind::Section:
+                begin(e.name, "X", e.ns);
+                out.put(",\"dur\":");
+                out.putThousandths(e.value);
+                out.put("}");
+                break;
+            case Kind::Instant:
+                begin(e.name, "i", e.ns);
+                out.put(",\"s\":\"t\"}");
+                break;
+            case Kind::Input:
+                begin(e.name, "i", e.ns);
+                out.put(",\"s\":\"t\",\"args\":{\"key\":");
+                out.putUnsigned(e.value >> 8);
+                out.put(",\"action\":");
+                out.putUnsigned(e.value & 0xff);
+                out.put("}}");
+                break;
+            case Kind::Frame:
+                begin(e.name, "C", e.ns);
+                out.put(",\"args\":{\"ms\":");
+                out.putThousandths(e.value);
+                out.put("}}");
+                break;
+        }
+    }
+}
+
+void onCrash(int signal) {
+    dump("crash");
+    ::signal(signal, SIG_DFL);         // the default action: core dump, exit status
+    ::raise(signal);
+}
+
+void onRequest(int) {
+    const int saved = errno;
+    dump("signal");
+    errno = saved;
+}
+
+constexpr int kCrashSignals[] = {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT};
+struct sigaction gPrevious[sizeof kCrashSignals / sizeof kCrashSignals[0] + 1];
+
+#endif
+
+} // namespace
+
+bool start() {
+#ifdef FLIGHT_RECORDER_POSIX
+    if (gActive.load()) {
+        return true;
+    }
+    struct sigaction action {};
+    action.sa_handler = onCrash;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESETHAND;
+    for (std::size_t i = 0; i < sizeof kCrashSignals / sizeof kCrashSignals[0]; ++i) {
+        sigaction(kCrashSignals[i], &action, &gPrevious[i]);
+    }
+    action.sa_handler = onRequest;
+    action.sa_flags = SA_RESTART;
+    sigaction(SIGUSR1, &action, &gPrevious[sizeof kCrashSignals / sizeof kCrashSignals[0]]);
+    gActive.store(true, std::memory_order_release);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void stop() {
+#ifdef FLIGHT_RECORDER_POSIX
+    if (!gActive.exchange(false)) {
+        return;
+    }
+    for (std::size_t i = 0; i < sizeof kCrashSignals / sizeof kCrashSignals[0]; ++i) {
+        sigaction(kCrashSignals[i], &gPrevious[i], nullptr);
+    }
+    sigaction(SIGUSR1, &gPrevious[sizeof kCrashSignals / sizeof kCrashSignals[0]], nullptr);
+#endif
+}
+
+bool active() {
+    return gActive.load(std::memory_order_relaxed);
+}
+
+void setThreadName(const char* name) {
+    tName = name;
+    if (tRing) {
+        tRing->name.store(name, std::memory_order_relaxed);
+    }
+}
+
+void section(const char* name, std::uint64_t startNs, std::uint64_t durationNs) {
+    if (active()) record(name, startNs, durationNs, Kind::Section);
+}
+
+void instant(const char* name) {
+    if (active()) record(name, nowNs(), 0, Kind::Instant);
+}
+
+void stall(const char* site, std::uint64_t durationNs) {
+    if (active()) {
+        const std::uint64_t now = nowNs();
+        record(site, now - durationNs, durationNs, Kind::Section);
+        record("gl stall", now, 0, Kind::Instant);
+    }
+}
+
+void input(int key, int action) {
+    if (active()) {
+        record("key", nowNs(),
+               static_cast<std::uint64_t>(static_cast<std::uint32_t>(key)) << 8 | (static_cast<std::uint32_t>(action) & 0xffu),
+               Kind::Input);
+    }
+}
+
+void frame(double ms) {
+    if (active()) record("frame ms", nowNs(), static_cast<std::uint64_t>(ms * 1000.0), Kind::Frame);
+}
+
+bool dump(const char* reason) {
+#ifdef FLIGHT_RECORDER_POSIX
+    if (gDumping.exchange(true, std::memory_order_acquire)) {
+        return false;
+    }
+    char path[96];
+    {
+        // flight-PID-N-reason.json, formatted by hand: no snprintf in a signal handler.
+        std::size_t length = 0;
+        auto append = [&](const char* text) {
+            for (; *text && length + 1 < sizeof path; ++text) {
+                path[length++] = *text;
+            }
+        };
+        auto appendNumber = [&](std::uint64_t value) {
+            char digits[20];
+            int n = 0;
+            do {
+                digits[n++] = static_cast<char>('0' + value % 10);
+                value /= 10;
+            } while (value > 0);
+            while (n > 0 && length + 1 < sizeof path) {
+                path[length++] = digits[--n];
+            }
+        };
+        append("flight-");
+        appendNumber(static_cast<std::uint64_t>(::getpid()));
+        append("-");
+        appendNumber(static_cast<std::uint64_t>(gDumps.fetch_add(1, std::memory_order_relaxed) + 1));
+        append("-");
+        append(reason);
+        append(".json");
+        path[length] = '\0';
+    }
+    const int fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        gDumping.store(false, std::memory_order_release);
+        return false;
+    }
+
+    // Each ring's count once, so the base time and the events read agree.
+    const int registered = gRingCount.load(std::memory_order_acquire);
+    const int rings = registered < kMaxThreads ? registered : kMaxThreads;
+    std::uint64_t written[kMaxThreads] = {};
+    std::uint64_t baseNs = ~std::uint64_t{0};
+    for (int r = 0; r < rings; ++r) {
+        const Ring* ring = gRings[r].load(std::memory_order_acquire);
+        written[r] = ring ? ring->written.load(std::memory_order_acquire) : 0;
+        if (ring && written[r] > 0) {
+            const Event& oldest = ring->events[firstReadable(written[r]) & (kEvents - 1)];
+            baseNs = oldest.ns < baseNs ? oldest.ns : baseNs;
+        }
+    }
+    const std::uint64_t now = nowNs();
+    baseNs = baseNs > now ? now : baseNs;
+
+    bool ok;
+    {
+        Writer out(fd);
+        out.put("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+        bool first = true;
+        for (int r = 0; r < rings; ++r) {
+            if (const Ring* ring = gRings[r].load(std::memory_order_acquire)) {
+                writeEvents(out, r + 1, *ring, written[r], baseNs, first);
+            }
+        }
+        out.put(first ? "\n{\"name\":" : ",\n{\"name\":");
+        out.putName(reason);
+        out.put(",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":0,\"ts\":");
+        out.putThousandths(now - baseNs);
+        out.put("}\n]}\n");
+        out.flush();
+        ok = out.ok();
+    }
+    ::close(fd);
+    gDumping.store(false, std::memory_order_release);
+    return ok;
+#else
+    (void)reason;
+    return false;
+#endif
+}
+
+} // namespace flightrec
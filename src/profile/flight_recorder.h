@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+
+// Flight recorder
+// ---------------
+// The last few seconds of every thread's profiler sections, GL stalls, input and frame
+// times, kept in memory all the time and written out only when something goes wrong
+// (--flight-recorder):
+//
+// | Trigger                             | Dump                                         |
+// | ----------------------------------- | -------------------------------------------- |
+// | a frame spike (--hitch-capture,     | flight-PID-N-hitch.json, a few frames after  |
+// | profile/hitch_detector.h)           | it                                           |
+// | SIGUSR1                             | flight-PID-N-signal.json, and the game runs  |
+// |                                     | on                                           |
+// | SIGSEGV, SIGBUS, SIGFPE, SIGILL,    | flight-PID-N-crash.json, then the default    |
+// | SIGABRT                             | action (the core dump, the exit status)      |
+//
+// The dumps are Chrome trace JSON (profile/trace.h's format): they open in
+// chrome://tracing and https://ui.perfetto.dev, a span per section on its thread's
+// track, a span and a "gl stall" marker per GL stall (render/gl_stall.h), an "i" marker
+// per key, the frame times as a counter track.
+//
+// Steady state is one 32-byte store into the calling thread's own ring and one release
+// store of its count per event: no locks, no allocation (after a thread's first event),
+// no I/O. Rings overwrite their oldest events; kEvents per thread is a few seconds of a
+// thread's sections at 60 fps.
+//
+// The dump runs inside a signal handler, so it sticks to async-signal-safe calls (open,
+// write, close; its own number formatting) and reads the other threads' rings while
+// they may be writing: it skips each ring's kGuardEvents oldest events, the ones a
+// writer could be overwriting. Names must be string literals, as for trace::.
+//
+// POSIX only; elsewhere start() fails and every call is a flag test.
+namespace flightrec {
+
+constexpr int kEvents = 4096;           // per thread, a power of two
+constexpr int kGuardEvents = 64;
+constexpr int kMaxThreads = 64;         // threads past it record nothing
+
+// Recording from now on, and the signal handlers installed.
+bool start();
+// Handlers back to the defaults; the rings are kept (a later start() reuses them).
+void stop();
+bool active();
+
+// The calling thread's name in the dumps (trace::setThreadName passes it on).
+void setThreadName(const char* name);
+
+// A finished section; steady_clock nanoseconds (Profiler::cpuEnd).
+void section(const char* name, std::uint64_t startNs, std::uint64_t durationNs);
+void instant(const char* name);
+// A GL stall at `site` that just ended (glstall::finish).
+void stall(const char* site, std::uint64_t durationNs);
+void input(int key, int action);
+// The frame's time, on the main thread: a counter sample.
+void frame(double ms);
+
+// Writes every ring to flight-PID-N-reason.json in the working directory. reason: a
+// string literal. Async-signal-safe. false: the file couldn't be written.
+bool dump(const char* reason);
+
+} // namespace flightrec
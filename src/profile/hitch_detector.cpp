@@ -0,0 +1,51 @@
+#include "profile/hitch_detector.h"
+
+#include "core/log.h"
+#include "profile/flight_recorder.h"
+#include "profile/trace.h"
+
+HitchDetector::~HitchDetector() {
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+}
+
+bool HitchDetector::frame(double ms, double now) {
+    ++frames_;
+    if (untilDump_ >= 0 && untilDump_-- == 0) {
+        capture();
+    }
+    const bool spike = frames_ > kWarmupFrames && median_ > 0.0 && ms > settings_.multiple * median_ &&
+                       ms > settings_.minMs;
+    if (!spike) {
+        frameMs_.add(ms);
+        if (frames_ % kMedianInterval == 0) {
+            median_ = frameMs_.summarize().p50;
+        }
+        return false;
+    }
+    ++hitches_;
+    flightrec::instant("hitch");
+    if (trace::active()) {
+        trace::instant("hitch");
+    }
+    if (untilDump_ < 0 && now >= nextCapture_) {
+        untilDump_ = settings_.framesAfter;
+        nextCapture_ = now + settings_.cooldownSeconds;
+        logging::info("Hitch: %.2f ms, %.1fx the %.2f ms median; capturing", ms, ms / median_, median_);
+    }
+    return true;
+}
+
+void HitchDetector::capture() {
+    if (writer_.joinable()) {
+        writer_.join();                 // the previous one, a cooldown ago
+    }
+    ++captures_;
+    writer_ = std::thread([] {
+        trace::setThreadName("hitch capture");
+        if (!flightrec::dump("hitch")) {
+            logging::warn("Hitch: the flight recorder dump couldn't be written");
+        }
+    });
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <thread>
+
+#include "profile/profiler.h"
+
+// Hitch detector
+// --------------
+// Spots frame spikes relative to how the game is running right now, not against a fixed
+// budget (--hitch-capture[=X]): a frame over X times the rolling median frame time is a
+// hitch, at 30 fps as at 240. Each one gets the flight recorder's rings
+// (profile/flight_recorder.h) written out as flight-PID-N-hitch.json, so the trace holds
+// the frames before the spike, the spike itself with its GL stalls, and the recovery:
+//
+// | Step             | What happens                                                   |
+// | ---------------- | -------------------------------------------------------------- |
+// | warm-up          | the first kWarmupFrames frames only feed the median (loading,  |
+// |                  | shader compiles)                                               |
+// | spike            | frame > multiple x median and > minMs: a "hitch" marker in the |
+// |                  | rings (and in --trace)                                         |
+// | framesAfter more | the dump, on a thread of its own so writing it doesn't cause   |
+// |                  | the next hitch                                                 |
+// | cooldown         | no new capture for cooldownSeconds: one stutter, one file      |
+//
+// A spike doesn't go into the median (it would raise the bar for the next one). The
+// median is recomputed every kMedianInterval frames, not per frame: RollingStats sorts.
+//
+// Main thread only. Skipped frames (asleep waiting for events) must not be passed in.
+class HitchDetector {
+public:
+    static constexpr int kWarmupFrames = 120;
+    static constexpr int kMedianInterval = 30;
+
+    struct Settings {
+        double multiple = 3.0;          // of the rolling median
+        double minMs = 8.0;             // spikes under it are ignored (fast frames jitter)
+        int framesAfter = 8;            // recorded after the spike before the dump
+        double cooldownSeconds = 10.0;
+    };
+
+    HitchDetector() = default;
+    explicit HitchDetector(const Settings& settings) : settings_(settings) {}
+    HitchDetector(const HitchDetector&) = delete;
+    HitchDetector& operator=(const HitchDetector&) = delete;
+    ~HitchDetector();
+
+    // The frame's time; true: it was a hitch. `now` in seconds (monoclock).
+    bool frame(double ms, double now);
+
+    double median() const { return median_; }
+    std::uint64_t hitches() const { return hitches_; }
+    std::uint64_t captures() const { return captures_; }
+
+private:
+    void capture();
+
+    Settings settings_;
+    RollingStats frameMs_;
+    double median_ = 0.0;
+    std::uint64_t frames_ = 0;
+    int untilDump_ = -1;                // frames until the pending dump; < 0: none
+    double nextCapture_ = 0.0;
+    std::uint64_t hitches_ = 0;
+    std::uint64_t captures_ = 0;
+    std::thread writer_;
+};
@@ -0,0 +1,116 @@
+#include "profile/input_latency.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <ostream>
+
+void LatencyHistogram::add(double ms) {
+    const double bin = std::floor(std::max(ms, 0.0) / kBinMs);
+    ++bins_[static_cast<std::size_t>(std::min(bin, static_cast<double>(kBins - 1)))];
+    ++count_;
+    sumMs_ += ms;
+    maxMs_ = std::max(maxMs_, ms);
+}
+
+void LatencyHistogram::clear() {
+    bins_.fill(0);
+    count_ = 0;
+    sumMs_ = 0.0;
+    maxMs_ = 0.0;
+}
+
+double LatencyHistogram::percentile(double p) const {
+    if (count_ == 0) {
+        return 0.0;
+    }
+    const std::uint64_t rank = static_cast<std::uint64_t>(std::ceil(std::clamp(p, 0.0, 1.0) * count_));
+    std::uint64_t seen = 0;
+    for (int b = 0; b < kBins; ++b) {
+        seen += bins_[static_cast<std::size_t>(b)];
+        if (seen >= std::max<std::uint64_t>(rank, 1)) {
+            return std::min((b + 1) * kBinMs, maxMs_);
+        }
+    }
+    return maxMs_;
+}
+
+void InputLatency::presented(double input, double now) {
+    if (windowStart_ < 0.0) {
+        windowStart_ = now;
+    }
+    if (input > 0.0) {
+        const double ms = (now - input) * 1000.0;
+        swap_.add(ms);
+        windowSwap_.add(ms);
+        if (count_ == kFences) {
+            ++droppedFences_;
+        } else {
+            Pending& p = pending_[(head_ + count_) % kFences];
+            p.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            p.input = input;
+            ++count_;
+        }
+    }
+    poll(now);
+}
+
+void InputLatency::poll(double now) {
+    // In order: a later fence can't be signalled before an earlier one.
+    while (count_ > 0) {
+        Pending& p = pending_[head_];
+        if (glClientWaitSync(p.fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+            break;
+        }
+        const double ms = (now - p.input) * 1000.0;
+        gpu_.add(ms);
+        windowGpu_.add(ms);
+        glDeleteSync(p.fence);
+        p.fence = nullptr;
+        head_ = (head_ + 1) % kFences;
+        --count_;
+    }
+    if (windowStart_ >= 0.0 && now - windowStart_ >= kWindowSeconds) {
+        closeWindow(now);
+    }
+}
+
+void InputLatency::closeWindow(double now) {
+    Summary s;
+    s.samples = static_cast<std::uint32_t>(windowSwap_.count());
+    s.swapP50 = static_cast<float>(windowSwap_.percentile(0.50));
+    s.swapP95 = static_cast<float>(windowSwap_.percentile(0.95));
+    s.swapMax = static_cast<float>(windowSwap_.max());
+    s.gpuP50 = static_cast<float>(windowGpu_.percentile(0.50));
+    s.gpuP95 = static_cast<float>(windowGpu_.percentile(0.95));
+    s.gpuMax = static_cast<float>(windowGpu_.max());
+    summary_ = s;
+    windowSwap_.clear();
+    windowGpu_.clear();
+    windowStart_ = now;
+}
+
+void InputLatency::shutdown() {
+    while (count_ > 0) {
+        glDeleteSync(pending_[head_].fence);
+        pending_[head_].fence = nullptr;
+        head_ = (head_ + 1) % kFences;
+        --count_;
+    }
+}
+
+void InputLatency::print(std::ostream& out, const char* indent) const {
+    char line[256];
+    auto row = [&](const char* name, const LatencyHistogram& h) {
+        if (h.count() == 0) {
+            std::snprintf(line, sizeof(line), "%s%-16sn/a\n", indent, name);
+        } else {
+            std::snprintf(line, sizeof(line), "%s%-16savg %.2f  p50 %.2f  p95 %.2f  p99 %.2f  max %.2f  (%llu frames)\n",
+                          indent, name, h.mean(), h.percentile(0.50), h.percentile(0.95), h.percentile(0.99),
+                          h.max(), static_cast<unsigned long long>(h.count()));
+        }
+        out << line;
+    };
+    row("input->swap ms", swap_);
+    row("input->gpu ms", gpu_);
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <array>
+#include <cstdint>
+#include <iosfwd>
+
+// LatencyHistogram
+// ----------------
+// Latencies in fixed kBinMs bins: add() is an increment, percentiles come from one scan
+// of the counts (no sample list, no sort, no allocation). Anything slower than the last
+// bin counts in it; max() is exact.
+class LatencyHistogram {
+public:
+    static constexpr double kBinMs = 0.25;
+    static constexpr int kBins = 1024;         // up to 256 ms
+
+    void add(double ms);
+    void clear();
+
+    std::uint64_t count() const { return count_; }
+    double mean() const { return count_ ? sumMs_ / static_cast<double>(count_) : 0.0; }
+    double max() const { return maxMs_; }
+    // The upper edge of the bin holding the p-th (0..1) sample; 0 when empty.
+    double percentile(double p) const;
+
+private:
+    std::array<std::uint32_t, kBins> bins_{};
+    std::uint64_t count_ = 0;
+    double sumMs_ = 0.0;
+    double maxMs_ = 0.0;
+};
+
+// InputLatency
+// ------------
+// Input to photon: how long after a key went down (or a pad moved) the first frame that
+// reflects it reached the screen. Each stage is a timestamp on monoclock::seconds():
+//
+// | Stage     | Taken where                                 | By                         |
+// | --------- | ------------------------------------------- | -------------------------- |
+// | input     | the GLFW callback (InputEvent::time), or    | main: the oldest one the   |
+// |           | the gamepad poll that saw the change        | frame consumed goes in its |
+// |           |                                             | packet (inputTime)         |
+// | swap      | glfwSwapBuffers returned for that packet    | presented()                |
+// | gpu       | a fence placed right after that swap is     | poll(), each render frame  |
+// |           | signalled: the GPU finished the frame       |                            |
+//
+// swap is the latency the CPU side controls (sampling, simulation, the render thread's
+// frame of pipelining, vsync blocking); gpu adds the GPU's queue. The display's scan-out
+// after that is not visible from here. A fence is noticed at the next poll, so gpu may
+// read up to one render frame late; polls never block.
+//
+// Render thread only (the fences belong to its context), except print() and the
+// histograms after it stopped. summary() is the last full kWindowSeconds, for the HUD;
+// the histograms cover the whole run, for the bench output.
+class InputLatency {
+public:
+    static constexpr int kFences = 8;          // frames in flight to the GPU, at most
+    static constexpr double kWindowSeconds = 1.0;
+
+    struct Summary {
+        std::uint32_t samples = 0;             // frames with an input, last window
+        float swapP50 = 0.0f, swapP95 = 0.0f, swapMax = 0.0f;   // ms
+        float gpuP50 = 0.0f, gpuP95 = 0.0f, gpuMax = 0.0f;
+    };
+
+    // Right after glfwSwapBuffers returned; `input`: the packet's inputTime (0: none).
+    void presented(double input, double now);
+    // Fences signalled since the last call; `now` is when they're noticed.
+    void poll(double now);
+    // Deletes pending fences; with the context current, before it goes away.
+    void shutdown();
+
+    const Summary& summary() const { return summary_; }
+    const LatencyHistogram& swap() const { return swap_; }
+    const LatencyHistogram& gpu() const { return gpu_; }
+    std::uint64_t droppedFences() const { return droppedFences_; }
+
+    // "  input->swap ms  p50 ..  p95 ..  p99 ..  max ..  (n frames)" and the gpu line.
+    void print(std::ostream& out, const char* indent) const;
+
+private:
+    struct Pending {
+        GLsync fence = nullptr;
+        double input = 0.0;
+    };
+
+    void closeWindow(double now);
+
+    Pending pending_[kFences];
+    int head_ = 0;                             // oldest pending
+    int count_ = 0;
+    std::uint64_t droppedFences_ = 0;          // ring full: that frame's gpu not measured
+    LatencyHistogram swap_, gpu_;              // the whole run
+    LatencyHistogram windowSwap_, windowGpu_;  // since windowStart_
+    double windowStart_ = -1.0;
+    Summary summary_;
+};
@@ -0,0 +1,138 @@
+#include "profile/perf_hud.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#include "core/alloc_counter.h"
+
+void PerfHud::capture(const Profiler& profiler, Timings& out) {
+    out.count = 0;
+    for (int i = Profiler::kFrameSection + 1; i < profiler.sectionCount() && out.count < kMaxSections; ++i) {
+        const Profiler::SectionId id = static_cast<Profiler::SectionId>(i);
+        out.names[out.count] = profiler.name(id);
+        out.cpuMs[out.count] = static_cast<float>(profiler.cpu(id).last());
+        // CPU-only sections (cpuBegin / CpuScope) never get a GPU sample.
+        out.gpuMs[out.count] = profiler.gpu(id).count() > 0 ? static_cast<float>(profiler.gpu(id).last()) : -1.0f;
+        ++out.count;
+    }
+}
+
+void PerfHud::accumulate(const Timings& in, Timings& sum) {
+    if (sum.count != in.count) {
+        sum = Timings{};                // first frame, or the sections changed: start over
+        sum.count = in.count;
+    }
+    for (int i = 0; i < in.count; ++i) {
+        sum.names[i] = in.names[i];
+        sum.cpuMs[i] += in.cpuMs[i];
+        sum.gpuMs[i] = in.gpuMs[i] < 0.0f ? -1.0f : std::max(sum.gpuMs[i], 0.0f) + in.gpuMs[i];
+    }
+}
+
+void PerfHud::add(const Frame& frame, const Timings& main, const Timings& render) {
+    graph_[graphNext_] = static_cast<float>(frame.ms);
+    graphNext_ = (graphNext_ + 1) % kGraphFrames;
+
+    sum_.ms += frame.ms;
+    sum_.render += frame.render;
+    sum_.mainAllocations += frame.mainAllocations;
+    sum_.renderAllocations += frame.renderAllocations;
+    sum_.renderScale += frame.renderScale;
+    sum_.overdraw += frame.overdraw;
+    sum_.overdrawMax = std::max(sum_.overdrawMax, frame.overdrawMax);
+    sum_.gpuBytes = frame.gpuBytes;
+    sum_.gpuAvailable = frame.gpuAvailable;
+    sum_.glStalls += frame.glStalls;
+    sum_.glStallMs += frame.glStallMs;
+    sum_.inputSamples = frame.inputSamples;
+    sum_.inputSwapP50 = frame.inputSwapP50;
+    sum_.inputSwapP95 = frame.inputSwapP95;
+    sum_.inputGpuP50 = frame.inputGpuP50;
+    sum_.inputGpuP95 = frame.inputGpuP95;
+    maxMs_ = std::max(maxMs_, frame.ms);
+    accumulate(main, mainSum_);
+    accumulate(render, renderSum_);
+    ++frames_;
+}
+
+const char* PerfHud::text(double now) {
+    if (now >= nextRefresh_ && frames_ > 0) {
+        nextRefresh_ = now + kRefreshSeconds;
+        const int length = format(text_, sizeof text_);
+        length_ = std::min<std::size_t>(length > 0 ? static_cast<std::size_t>(length) : 0, sizeof text_ - 1);
+        sum_ = Frame{};
+        maxMs_ = 0.0;
+        frames_ = 0;
+        mainSum_ = Timings{};
+        renderSum_ = Timings{};
+    }
+    return text_;
+}
+
+int PerfHud::format(char* out, std::size_t size) const {
+    const double n = static_cast<double>(frames_);
+    const double ms = sum_.ms / n;
+    const RenderStats& r = sum_.render;
+    int length = std::snprintf(out, size,
+                               "%.2f ms  %.0f fps  max %.2f\n"
+                               "%.0f instances  %.1f draws  %.1f batches\n"
+                               "breaks  program %.1f  texture %.1f  pipeline %.1f  full %.1f\n"
+                               "upload %.1f KiB  state %.0f issued  %.0f filtered\n",
+                               ms, ms > 0.0 ? 1000.0 / ms : 0.0, maxMs_, static_cast<double>(r.instances) / n,
+                               static_cast<double>(r.drawCalls) / n, static_cast<double>(r.batches) / n,
+                               static_cast<double>(r.programBreaks) / n, static_cast<double>(r.textureBreaks) / n,
+                               static_cast<double>(r.pipelineBreaks) / n, static_cast<double>(r.capacityBreaks) / n,
+                               static_cast<double>(r.uploadBytes) / n / 1024.0, static_cast<double>(r.stateIssued) / n,
+                               static_cast<double>(r.stateFiltered) / n);
+    auto append = [&](const char* format, auto... args) {
+        if (length >= 0 && static_cast<std::size_t>(length) < size) {
+            length += std::snprintf(out + length, size - length, format, args...);
+        }
+    };
+    if (alloccount::enabled()) {
+        append("allocs  main %.1f  render %.1f\n", static_cast<double>(sum_.mainAllocations) / n,
+               static_cast<double>(sum_.renderAllocations) / n);
+    } else {
+        append("allocs  n/a (ALLOC_HOOK=0)\n");
+    }
+    if (sum_.renderScale > 0.0f) {
+        append("scene scale %.2f\n", sum_.renderScale / n);
+    }
+    if (sum_.overdraw > 0.0f) {
+        append("overdraw %.2f  max %d\n", sum_.overdraw / n, sum_.overdrawMax);
+    }
+    if (sum_.gpuAvailable > 0) {
+        append("vram %.1f MiB  free %.0f MiB\n", static_cast<double>(sum_.gpuBytes) / (1 << 20),
+               static_cast<double>(sum_.gpuAvailable) / (1 << 20));
+    } else {
+        append("vram %.1f MiB\n", static_cast<double>(sum_.gpuBytes) / (1 << 20));
+    }
+    if (sum_.glStalls > 0) {
+        append("gpu stalls %u  %.2f ms\n", sum_.glStalls, static_cast<double>(sum_.glStallMs));
+    }
+    if (sum_.inputSamples > 0) {
+        append("input->swap p50 %.1f p95 %.1f  ->gpu p50 %.1f p95 %.1f ms\n",
+               static_cast<double>(sum_.inputSwapP50), static_cast<double>(sum_.inputSwapP95),
+               static_cast<double>(sum_.inputGpuP50), static_cast<double>(sum_.inputGpuP95));
+    }
+    // ms per section: "cpu" or "cpu/gpu".
+    append("main  ");
+    for (int i = 0; i < mainSum_.count; ++i) {
+        append(" %s %.2f", mainSum_.names[i], mainSum_.cpuMs[i] / n);
+    }
+    append("\nrender");
+    for (int i = 0; i < renderSum_.count; ++i) {
+        if (renderSum_.gpuMs[i] < 0.0f) {
+            append(" %s %.2f", renderSum_.names[i], renderSum_.cpuMs[i] / n);
+        } else {
+            append(" %s %.2f/%.2f", renderSum_.names[i], renderSum_.cpuMs[i] / n, renderSum_.gpuMs[i] / n);
+        }
+    }
+    return length;
+}
+
+void PerfHud::graph(float* out) const {
+    for (int i = 0; i < kGraphFrames; ++i) {
+        out[i] = graph_[(graphNext_ + i) % kGraphFrames];
+    }
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "profile/profiler.h"
+#include "render/render_stats.h"
+
+// PerfHud
+// -------
+// The numbers behind the on-screen performance overlay (F2 / --hud): a rolling graph of
+// frame times and a block of text with both threads' section timings, draw calls,
+// instances, why batches broke and the bytes streamed (render/render_stats.h), GL state
+// calls issued vs. filtered by the cache (render/gl_state.h), heap
+// allocations per frame and GPU memory (render/gpu_memory.h: tracked, and what the
+// driver says is free where it says). Main feeds it one Frame per frame; it is CPU-only and
+// knows nothing about drawing (the text and the graph travel in the FramePacket and are
+// drawn by TextBatch, in the HUD's one sprite batch draw).
+//
+// Cheap on purpose, since it runs every frame it is shown:
+//
+// | Per frame                                  | Every kRefreshSeconds            |
+// | ------------------------------------------ | -------------------------------- |
+// | add(): one graph slot, sums (no sorting);  | text() formats the averages of   |
+// | capture(): RollingStats::last() per section| the frames since into a buffer   |
+//
+// Text that changed 60 times a second couldn't be read anyway; the averages over a
+// quarter second can, and nothing is formatted on the frames in between.
+//
+// The render thread's sections come back in the packet (FramePacket::renderTimings),
+// captured there after its profiler's endFrame(), so they are two frames old—like
+// its RenderStats. GPU times lag a further Profiler::kLatency frames.
+class PerfHud {
+public:
+    static constexpr int kGraphFrames = 128;
+    static constexpr int kMaxSections = 8;      // per thread; the rest are left out
+    static constexpr double kRefreshSeconds = 0.25;
+    static constexpr std::size_t kTextSize = 640;
+
+    // One thread's sections for one frame: every section but the frame one.
+    struct Timings {
+        std::array<const char*, kMaxSections> names{};
+        std::array<float, kMaxSections> cpuMs{};
+        std::array<float, kMaxSections> gpuMs{};    // < 0: not timed on the GPU
+        int count = 0;
+    };
+    // The newest sample of each of `profiler`'s sections (no sorting, no allocation).
+    static void capture(const Profiler& profiler, Timings& out);
+
+    struct Frame {
+        double ms = 0.0;                        // frame to frame
+        RenderStats render;                     // draws, breaks, uploads, state calls
+        std::uint64_t mainAllocations = 0;
+        std::uint64_t renderAllocations = 0;
+        float renderScale = 0.0f;               // offscreen scene scale; 0: none
+        float overdraw = 0.0f;                  // fragments per pixel (--overdraw); 0: off
+        int overdrawMax = 0;
+        std::size_t gpuBytes = 0;               // tracked GPU memory (the newest, not averaged)
+        std::size_t gpuAvailable = 0;           // ... free by the driver's count; 0: unknown
+        std::uint32_t glStalls = 0;             // GPU waits over --stall-ms (render/gl_stall.h)
+        float glStallMs = 0.0f;
+        std::uint32_t inputSamples = 0;         // input-to-photon (profile/input_latency.h), the
+        float inputSwapP50 = 0.0f;              // newest window: frames with an input, and
+        float inputSwapP95 = 0.0f;              // ms to the swap and to the GPU finishing it
+        float inputGpuP50 = 0.0f;
+        float inputGpuP95 = 0.0f;
+    };
+
+    void add(const Frame& frame, const Timings& main, const Timings& render);
+
+    // The overlay text, re-formatted from the frames added since the last time when
+    // kRefreshSeconds have passed (`now` in seconds), else the same as before.
+    const char* text(double now);
+    std::size_t textLength() const { return length_; }
+
+    // Frame times (ms), oldest first, into kGraphFrames floats.
+    void graph(float* out) const;
+
+private:
+    void accumulate(const Timings& in, Timings& sum);
+    int format(char* out, std::size_t size) const;
+
+    std::array<float, kGraphFrames> graph_{};
+    int graphNext_ = 0;
+
+    // Since the last refresh.
+    Frame sum_;
+    double maxMs_ = 0.0;
+    int frames_ = 0;
+    Timings mainSum_;
+    Timings renderSum_;
+
+    char text_[kTextSize] = {};
+    std::size_t length_ = 0;
+    double nextRefresh_ = 0.0;
+};
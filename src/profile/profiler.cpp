@@ -0,0 +1,206 @@
+#include "profile/profiler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ostream>
+
+#include "core/alloc_counter.h"
+#include "profile/flight_recorder.h"
+#include "profile/trace.h"
+
+RollingStats::Summary RollingStats::summarize() const {
+    Summary s;
+    s.count = count_;
+    if (count_ == 0) {
+        return s;
+    }
+    std::array<double, kWindow> sorted;
+    std::copy(samples_.begin(), samples_.begin() + count_, sorted.begin());
+    std::sort(sorted.begin(), sorted.begin() + count_);
+
+    double sum = 0.0;
+    for (int i = 0; i < count_; ++i) {
+        sum += sorted[i];
+    }
+    s.min = sorted[0];
+    s.avg = sum / count_;
+    s.p50 = sorted[std::min(count_ - 1, static_cast<int>(count_ * 0.50))];
+    s.p95 = sorted[std::min(count_ - 1, static_cast<int>(count_ * 0.95))];
+    s.p99 = sorted[std::min(count_ - 1, static_cast<int>(count_ * 0.99))];
+    s.max = sorted[count_ - 1];
+    s.last = last();
+    return s;
+}
+
+bool Profiler::init(bool enableGpu, const char* frameName) {
+    sectionCount_ = 0;
+    frame_ = 0;
+    gpuEnabled_ = enableGpu;
+    frameName_ = frameName;
+    section("frame"); // kFrameSection
+    return true;
+}
+
+void Profiler::shutdown() {
+    for (int i = 0; i < sectionCount_; ++i) {
+        Section& s = sections_[i];
+        if (s.queries[0] != 0) {
+            glDeleteQueries(kLatency, s.queries);
+            std::memset(s.queries, 0, sizeof(s.queries));
+        }
+    }
+    sectionCount_ = 0;
+}
+
+Profiler::SectionId Profiler::section(const char* name) {
+    for (int i = 0; i < sectionCount_; ++i) {
+        if (std::strcmp(sections_[i].name, name) == 0) {
+            return static_cast<SectionId>(i);
+        }
+    }
+    if (sectionCount_ == kMaxSections) {
+        return kFrameSection; // out of slots: fold into the frame section
+    }
+    Section& s = sections_[sectionCount_];
+    s.name = name;
+    if (s.samplingSite < 0) {
+        s.samplingSite = sampling::registerZone(name, __FILE__, __LINE__);   // kept over init()s
+    }
+    if (gpuEnabled_) {
+        glGenQueries(kLatency, s.queries);
+    }
+    return static_cast<SectionId>(sectionCount_++);
+}
+
+void Profiler::beginFrame() {
+    // The slot this frame is about to reuse was written kLatency frames ago: harvest it
+    // now if the GPU has finished, otherwise drop it (never wait).
+    if (gpuEnabled_) {
+        resolveGpuSlot(static_cast<int>(frame_ % kLatency));
+    }
+    cpuBegin(kFrameSection);
+}
+
+void Profiler::endFrame() {
+    cpuEnd(kFrameSection);
+    sampling::frameMark(frameName_);
+    ++frame_;
+}
+
+void Profiler::cpuBegin(SectionId id) {
+    Section& s = sections_[id];
+    if (trace::active()) {
+        s.traceStart = trace::now();
+    }
+    s.allocStart = alloccount::thread();
+    s.bytesStart = alloccount::threadBytes();
+    s.cpuStart = Clock::now();
+    s.samplingZone = sampling::zoneBegin(s.samplingSite);
+}
+
+void Profiler::cpuEnd(SectionId id) {
+    Section& s = sections_[id];
+    sampling::zoneEnd(s.samplingSite, s.samplingZone);
+    const Clock::time_point end = Clock::now();
+    std::chrono::duration<double, std::milli> elapsed = end - s.cpuStart;
+    s.cpu.add(elapsed.count());
+    if (flightrec::active()) {
+        flightrec::section(s.name,
+                           static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                          s.cpuStart.time_since_epoch())
+                                                          .count()),
+                           static_cast<std::uint64_t>(
+                               std::chrono::duration_cast<std::chrono::nanoseconds>(end - s.cpuStart).count()));
+    }
+    s.allocations.add(static_cast<double>(alloccount::thread() - s.allocStart));
+    s.bytes.add(static_cast<double>(alloccount::threadBytes() - s.bytesStart));
+    if (trace::active() && s.traceStart != 0) {
+        trace::complete(s.name, s.traceStart, trace::now() - s.traceStart);
+        s.traceStart = 0;
+    }
+}
+
+void Profiler::gpuBegin(SectionId id) {
+    if (!gpuEnabled_ || gpuActive_ || id == kFrameSection) {
+        return; // TIME_ELAPSED queries can't nest: inner GPU sections are skipped
+    }
+    const int slot = static_cast<int>(frame_ % kLatency);
+    Section& s = sections_[id];
+    glBeginQuery(GL_TIME_ELAPSED, s.queries[slot]);
+    s.issued[slot] = true;
+    s.gpuTraceStart[slot] = trace::active() ? trace::now() : 0;
+    gpuActive_ = true;
+}
+
+void Profiler::gpuEnd(SectionId id) {
+    const int slot = static_cast<int>(frame_ % kLatency);
+    if (!gpuActive_ || !sections_[id].issued[slot]) {
+        return;
+    }
+    glEndQuery(GL_TIME_ELAPSED);
+    gpuActive_ = false;
+}
+
+void Profiler::resolveGpuSlot(int slot) {
+    double frameTotal = 0.0;
+    bool any = false;
+    for (int i = 0; i < sectionCount_; ++i) {
+        Section& s = sections_[i];
+        if (!s.issued[slot]) {
+            continue;
+        }
+        s.issued[slot] = false;
+
+        GLint available = 0;
+        glGetQueryObjectiv(s.queries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            continue; // GPU more than kLatency frames behind: drop this sample
+        }
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(s.queries[slot], GL_QUERY_RESULT, &ns);
+        const double ms = static_cast<double>(ns) * 1e-6;
+        s.gpu.add(ms);
+        frameTotal += ms;
+        if (s.gpuTraceStart[slot] != 0) {
+            trace::gpu(s.name, s.gpuTraceStart[slot], ns);
+        }
+        any = true;
+    }
+    if (any) {
+        gpuFrame_.add(frameTotal);
+    }
+}
+
+void Profiler::report(std::ostream& out) const {
+    char line[192];
+    std::snprintf(line, sizeof(line), "%-14s %8s %8s %8s   %8s %8s %8s   %8s %10s\n",
+                  "section", "cpu min", "cpu avg", "cpu p99", "gpu min", "gpu avg", "gpu p99", "allocs", "bytes");
+    out << line;
+    for (int i = 0; i < sectionCount_; ++i) {
+        RollingStats::Summary c = sections_[i].cpu.summarize();
+        RollingStats::Summary g = (i == kFrameSection ? gpuFrame_ : sections_[i].gpu).summarize();
+        if (alloccount::enabled()) {
+            std::snprintf(line, sizeof(line), "%-14s %8.3f %8.3f %8.3f   %8.3f %8.3f %8.3f   %8.2f %10.0f\n",
+                          sections_[i].name, c.min, c.avg, c.p99, g.min, g.avg, g.p99,
+                          sections_[i].allocations.summarize().avg, sections_[i].bytes.summarize().avg);
+        } else {
+            std::snprintf(line, sizeof(line), "%-14s %8.3f %8.3f %8.3f   %8.3f %8.3f %8.3f   %8s %10s\n",
+                          sections_[i].name, c.min, c.avg, c.p99, g.min, g.avg, g.p99, "n/a", "n/a");
+        }
+        out << line;
+    }
+}
+
+void Profiler::reportAllocations(std::ostream& out, const char* indent) const {
+    char line[160];
+    for (int i = 0; i < sectionCount_; ++i) {
+        const RollingStats::Summary a = sections_[i].allocations.summarize();
+        if (a.count == 0 || a.avg == 0.0) {
+            continue;
+        }
+        std::snprintf(line, sizeof(line), "%s%-14s %.2f allocs, %.0f bytes / call\n", indent, sections_[i].name,
+                      a.avg, sections_[i].bytes.summarize().avg);
+        out << line;
+    }
+}
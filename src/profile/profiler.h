@@ -0,0 +1,160 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+
+#include "core/clock.h"
+#include "profile/sampling.h"
+
+// RollingStats
+// ------------
+// Last kWindow samples (milliseconds) of one measurement. Adding a sample is O(1);
+// min/avg/percentiles are computed only when asked for (reporting, HUD), never per sample.
+class RollingStats {
+public:
+    static constexpr int kWindow = 240; // ~4 s at 60 fps
+
+    void add(double ms) {
+        samples_[next_] = ms;
+        next_ = (next_ + 1) % kWindow;
+        if (count_ < kWindow) ++count_;
+    }
+
+    struct Summary {
+        double min = 0.0, avg = 0.0, p50 = 0.0, p95 = 0.0, p99 = 0.0, max = 0.0, last = 0.0;
+        int count = 0;
+    };
+    Summary summarize() const;
+
+    int count() const { return count_; }
+    double last() const { return count_ ? samples_[(next_ + kWindow - 1) % kWindow] : 0.0; }
+
+private:
+    std::array<double, kWindow> samples_{};
+    int next_ = 0;
+    int count_ = 0;
+};
+
+// Profiler
+// --------
+// Per-section CPU and GPU timings for the frame.
+//
+// CPU: the monotonic clock (core/clock.h) around the section (cpuBegin/cpuEnd or CpuScope).
+// GPU: a GL_TIME_ELAPSED query around the same commands. The GPU runs behind the CPU,
+//      so results are NOT read back immediately—that would stall until the GPU caught
+//      up. Instead each frame writes into its own slot of a kLatency-deep query ring;
+//      right before a slot is reused, the results written kLatency frames earlier
+//      are read back, checking GL_QUERY_RESULT_AVAILABLE first so even that never blocks.
+//
+//     frame N:   read slot N % 4 (issued in frame N-4)   →   begin/end queries into it
+//
+// GL_TIME_ELAPSED queries cannot nest: GPU sections must be sequential (clear, upload,
+// draw, swap...). CPU scopes may nest freely.
+//
+// Heap: every CPU section also counts the heap allocations (and bytes) its thread made
+// between begin and end (core/alloc_counter.h); a nested section's are included in its
+// parent's. report() shows the averages next to the timings, reportAllocations() only
+// the sections that allocated—which in a steady-state frame should be none.
+//
+// Usage:
+//     SectionId draw = profiler.section("draw");      // once at startup
+//     profiler.beginFrame();
+//     profiler.begin(draw); ... GL calls ...; profiler.end(draw);   // CPU + GPU
+//     profiler.endFrame();
+//     profiler.cpu(draw).summarize();                 // rolling min/avg/percentiles
+class Profiler {
+public:
+    using SectionId = std::uint8_t;
+    static constexpr int kMaxSections = 32;
+    static constexpr int kLatency = 4;         // frames of GPU query buffering
+    static constexpr SectionId kFrameSection = 0; // whole-frame CPU time, always present
+
+    // `frameName`: endFrame()'s mark for a sampling profiler (profile/sampling.h).
+    bool init(bool enableGpu = true, const char* frameName = "frame");
+    void shutdown();
+
+    // Register a section (startup only). Returns the same id for the same name.
+    SectionId section(const char* name);
+    const char* name(SectionId id) const { return sections_[id].name; }
+    int sectionCount() const { return sectionCount_; }
+
+    void beginFrame();
+    void endFrame();
+
+    // CPU + GPU timing of one section.
+    void begin(SectionId id) { cpuBegin(id); gpuBegin(id); }
+    void end(SectionId id) { gpuEnd(id); cpuEnd(id); }
+
+    void cpuBegin(SectionId id);
+    void cpuEnd(SectionId id);
+    void gpuBegin(SectionId id);
+    void gpuEnd(SectionId id);
+
+    const RollingStats& cpu(SectionId id) const { return sections_[id].cpu; }
+    const RollingStats& gpu(SectionId id) const { return sections_[id].gpu; }
+    // Sum of all GPU sections of the most recently resolved frame: compare with CPU frame
+    // time to see whether we're CPU- or GPU-bound.
+    const RollingStats& gpuFrame() const { return gpuFrame_; }
+    bool gpuEnabled() const { return gpuEnabled_; }
+    std::uint64_t frameIndex() const { return frame_; }
+
+    const RollingStats& allocations(SectionId id) const { return sections_[id].allocations; }
+    const RollingStats& allocatedBytes(SectionId id) const { return sections_[id].bytes; }
+
+    // Multi-line table of every section: CPU and GPU min/avg/p99 in ms, heap allocations
+    // and bytes per call (avg).
+    void report(std::ostream& out) const;
+    // One line per section whose calls allocated within the window: "  draw  1.00 allocs,
+    // 32 bytes / call". Prints nothing if none did. `indent` goes before each line.
+    void reportAllocations(std::ostream& out, const char* indent = "") const;
+
+private:
+    using Clock = monoclock::Clock;
+
+    struct Section {
+        const char* name = nullptr;
+        Clock::time_point cpuStart{};
+        std::uint64_t allocStart = 0;              // alloccount::thread() at cpuBegin
+        std::uint64_t bytesStart = 0;
+        std::uint64_t traceStart = 0;              // trace clock, only while tracing
+        int samplingSite = -1;                     // sampling::registerZone
+        sampling::Zone samplingZone;
+        std::uint64_t gpuTraceStart[kLatency] = {};
+        RollingStats cpu;
+        RollingStats gpu;
+        RollingStats allocations;                  // per call (not ms)
+        RollingStats bytes;
+        GLuint queries[kLatency] = {};
+        bool issued[kLatency] = {};    // query slot was used in that frame
+    };
+
+    void resolveGpuSlot(int slot);
+
+    std::array<Section, kMaxSections> sections_{};
+    int sectionCount_ = 0;
+    bool gpuEnabled_ = false;
+    bool gpuActive_ = false;           // a TIME_ELAPSED query is open
+    std::uint64_t frame_ = 0;
+    const char* frameName_ = "frame";
+    RollingStats gpuFrame_;
+};
+
+// CpuScope
+// --------
+// RAII CPU-only section: times from construction to end of the enclosing block.
+class CpuScope {
+public:
+    CpuScope(Profiler& profiler, Profiler::SectionId id) : profiler_(profiler), id_(id) {
+        profiler_.cpuBegin(id_);
+    }
+    ~CpuScope() { profiler_.cpuEnd(id_); }
+    CpuScope(const CpuScope&) = delete;
+    CpuScope& operator=(const CpuScope&) = delete;
+
+private:
+    Profiler& profiler_;
+    Profiler::SectionId id_;
+};
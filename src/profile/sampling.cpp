@@ -0,0 +1,143 @@
+#include "profile/sampling.h"
+
+#if SAMPLING_PROFILER
+
+#include <atomic>
+#include <cstring>
+#include <mutex>
+
+#if defined(SAMPLING_PROFILER_TRACY)
+#include <tracy/TracyC.h>
+#else
+#include <ittnotify.h>
+#endif
+
+namespace {
+
+struct Site {
+#if defined(SAMPLING_PROFILER_TRACY)
+    ___tracy_source_location_data location{};  // Tracy keeps the pointer: static storage
+#else
+    __itt_string_handle* handle = nullptr;
+#endif
+};
+
+Site gSites[sampling::kMaxZones];
+std::atomic<int> gSiteCount{0};
+
+#if defined(SAMPLING_PROFILER_ITT)
+__itt_domain* gDomain = __itt_domain_create("game");
+
+// One domain per frame name: VTune's frame sets. Few names (main, render), set once each.
+constexpr int kMaxFrameDomains = 8;
+struct FrameDomain {
+    const char* name = nullptr;
+    __itt_domain* domain = nullptr;
+    bool open = false;
+};
+FrameDomain gFrames[kMaxFrameDomains];
+std::mutex gFramesMutex;
+
+FrameDomain* frameDomain(const char* name) {
+    std::lock_guard<std::mutex> lock(gFramesMutex);
+    for (FrameDomain& f : gFrames) {
+        if (f.name == name || (f.name && std::strcmp(f.name, name) == 0)) {
+            return &f;
+        }
+        if (!f.name) {
+            f.name = name;
+            f.domain = __itt_domain_create(name);
+            return &f;
+        }
+    }
+    return nullptr;
+}
+#endif
+
+} // namespace
+
+namespace sampling {
+
+const char* backendName() {
+#if defined(SAMPLING_PROFILER_TRACY)
+    return "tracy";
+#else
+    return "itt";
+#endif
+}
+
+void setThreadName(const char* name) {
+#if defined(SAMPLING_PROFILER_TRACY)
+    ___tracy_set_thread_name(name);
+#else
+    __itt_thread_set_name(name);
+#endif
+}
+
+void frameMark(const char* name) {
+#if defined(SAMPLING_PROFILER_TRACY)
+    ___tracy_emit_frame_mark(name);
+#else
+    // ITT frames are begin / end pairs: each mark ends the frame the last one began.
+    thread_local const char* lastName = nullptr;
+    thread_local FrameDomain* last = nullptr;
+    FrameDomain* f = name == lastName ? last : frameDomain(name);
+    lastName = name;
+    last = f;
+    if (!f) {
+        return;
+    }
+    if (f->open) {
+        __itt_frame_end_v3(f->domain, nullptr);
+    }
+    __itt_frame_begin_v3(f->domain, nullptr);
+    f->open = true;
+#endif
+}
+
+int registerZone(const char* name, const char* file, int line) {
+    const int id = gSiteCount.fetch_add(1, std::memory_order_relaxed);
+    if (id >= kMaxZones) {
+        return -1;
+    }
+    Site& site = gSites[id];
+#if defined(SAMPLING_PROFILER_TRACY)
+    site.location.name = name;
+    site.location.function = name;
+    site.location.file = file;
+    site.location.line = static_cast<std::uint32_t>(line);
+#else
+    (void)file;
+    (void)line;
+    site.handle = __itt_string_handle_create(name);
+#endif
+    return id;
+}
+
+Zone zoneBegin(int site) {
+    if (site < 0) {
+        return Zone{};
+    }
+#if defined(SAMPLING_PROFILER_TRACY)
+    const TracyCZoneCtx ctx = ___tracy_emit_zone_begin(&gSites[site].location, 1);
+    return Zone{ctx.id, ctx.active};
+#else
+    __itt_task_begin(gDomain, __itt_null, __itt_null, gSites[site].handle);
+    return Zone{0, 1};
+#endif
+}
+
+void zoneEnd(int site, Zone zone) {
+    if (site < 0 || !zone.active) {
+        return;
+    }
+#if defined(SAMPLING_PROFILER_TRACY)
+    ___tracy_emit_zone_end(TracyCZoneCtx{zone.id, zone.active});
+#else
+    __itt_task_end(gDomain);
+#endif
+}
+
+} // namespace sampling
+
+#endif
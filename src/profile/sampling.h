@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+
+// Sampling profiler hooks
+// -----------------------
+// What a sampling profiler needs from the game to line its call stacks up with ours:
+// which thread is which, where frames end, and which section a sample landed in. Built
+// in with `make SAMPLING_PROFILER=tracy` or `=itt` (see the Makefile); without it every
+// call here is an empty inline function and SAMPLING_ZONE expands to nothing.
+//
+// | Hook                   | Called from                     | Tracy (C API)   | ITT (VTune)       |
+// | ---------------------- | ------------------------------- | --------------- | ----------------- |
+// | setThreadName(name)    | trace::setThreadName: main,     | set_thread_name | thread_set_name   |
+// |                        | render, workers, loader threads |                 |                   |
+// | frameMark(name)        | Profiler::endFrame ("main",     | frame_mark      | frame_begin/end   |
+// |                        | "render": one frame set each)   | (named)         | on a domain each  |
+// | zoneBegin / zoneEnd    | Profiler::cpuBegin / cpuEnd:    | zone_begin/end  | task_begin/end    |
+// |                        | every CPU section               |                 |                   |
+// | SAMPLING_ZONE("name")  | any other scope worth a name:   | same            | same              |
+// |                        | each job system job ("job")     |                 |                   |
+//
+// Zones are registered once (registerZone: a section at startup, SAMPLING_ZONE's static
+// on first pass); a begin/end is then one call into the profiler's client, nothing more.
+// Names must outlive the program (string literals), like trace::'s. Begin and end of a
+// zone happen on the same thread, in nested order.
+#if defined(SAMPLING_PROFILER_TRACY) || defined(SAMPLING_PROFILER_ITT)
+#define SAMPLING_PROFILER 1
+#else
+#define SAMPLING_PROFILER 0
+#endif
+
+namespace sampling {
+
+constexpr bool enabled() { return SAMPLING_PROFILER != 0; }
+
+// Started zone: what zoneEnd needs back (Tracy's context; unused by ITT).
+struct Zone {
+    std::uint32_t id = 0;
+    int active = 0;
+};
+
+#if SAMPLING_PROFILER
+
+const char* backendName();                      // "tracy" / "itt"
+void setThreadName(const char* name);
+void frameMark(const char* name);
+// A zone site for `name`: its id, or -1 once kMaxZones are taken (then zoneBegin is a no-op).
+int registerZone(const char* name, const char* file, int line);
+Zone zoneBegin(int site);
+void zoneEnd(int site, Zone zone);
+
+#else
+
+inline const char* backendName() { return "off"; }
+inline void setThreadName(const char*) {}
+inline void frameMark(const char*) {}
+inline int registerZone(const char*, const char*, int) { return -1; }
+inline Zone zoneBegin(int) { return Zone{}; }
+inline void zoneEnd(int, Zone) {}
+
+#endif
+
+constexpr int kMaxZones = 512;
+
+class ScopedZone {
+public:
+    explicit ScopedZone(int site) : site_(site), zone_(zoneBegin(site)) {}
+    ~ScopedZone() { zoneEnd(site_, zone_); }
+    ScopedZone(const ScopedZone&) = delete;
+    ScopedZone& operator=(const ScopedZone&) = delete;
+
+private:
+    int site_;
+    Zone zone_;
+};
+
+} // namespace sampling
+
+#define SAMPLING_CONCAT_INNER(a, b) a##b
+#define SAMPLING_CONCAT(a, b) SAMPLING_CONCAT_INNER(a, b)
+#if SAMPLING_PROFILER
+#define SAMPLING_ZONE_AT(name, n)                                                                     \
+    static const int SAMPLING_CONCAT(samplingSite_, n) = ::sampling::registerZone(name, __FILE__, __LINE__); \
+    const ::sampling::ScopedZone SAMPLING_CONCAT(samplingZone_, n)(SAMPLING_CONCAT(samplingSite_, n))
+#define SAMPLING_ZONE(name) SAMPLING_ZONE_AT(name, __COUNTER__)
+#else
+#define SAMPLING_ZONE(name) static_cast<void>(0)
+#endif
@@ -0,0 +1,46 @@
+#include "profile/shader_timings.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <ostream>
+
+void ShaderTimings::record(const std::string& program, const ShaderBuildTiming& timing) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = std::find_if(entries_.begin(), entries_.end(),
+                           [&program](const Entry& e) { return e.program == program; });
+    if (it == entries_.end()) {
+        entries_.push_back(Entry{program, {}, 0});
+        it = entries_.end() - 1;
+    }
+    it->last = timing;
+    ++it->builds;
+}
+
+std::vector<ShaderTimings::Entry> ShaderTimings::entries() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_;
+}
+
+void ShaderTimings::report(std::ostream& out) const {
+    std::vector<Entry> sorted = entries();
+    std::sort(sorted.begin(), sorted.end(),
+              [](const Entry& a, const Entry& b) { return a.last.totalMs() > b.last.totalMs(); });
+
+    char line[200];
+    std::snprintf(line, sizeof(line), "%-64s %8s %8s %8s %8s %6s\n",
+                  "program", "vertex", "fragment", "link", "total", "builds");
+    out << line;
+    ShaderBuildTiming sum;
+    for (const Entry& e : sorted) {
+        std::snprintf(line, sizeof(line), "%-64s %8.3f %8.3f %8.3f %8.3f %6d%s\n", e.program.c_str(),
+                      e.last.vertexMs, e.last.fragmentMs, e.last.linkMs, e.last.totalMs(), e.builds,
+                      e.last.cached ? "  (cached)" : "");
+        out << line;
+        sum.vertexMs += e.last.vertexMs;
+        sum.fragmentMs += e.last.fragmentMs;
+        sum.linkMs += e.last.linkMs;
+    }
+    std::snprintf(line, sizeof(line), "%-64s %8.3f %8.3f %8.3f %8.3f\n", "(all, ms)",
+                  sum.vertexMs, sum.fragmentMs, sum.linkMs, sum.totalMs());
+    out << line;
+}
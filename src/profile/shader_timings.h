@@ -0,0 +1,56 @@
+#pragma once
+
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// ShaderTimings
+// -------------
+// Wall time spent building each shader program, to see which ones dominate startup.
+// Unlike Profiler sections these aren't per frame: one row per program, updated each
+// time it is (re)built.
+//
+// Builds are split across two points (render/shader_build.h): compiles and the link are
+// SUBMITTED first, and only the status checks later wait for them. A stage's time is
+// both parts added up:
+//
+//     vertex  = glCompileShader(vs)  + waiting at its GL_COMPILE_STATUS
+//     fragment= glCompileShader(fs)  + waiting at its GL_COMPILE_STATUS
+//     link    = glLinkProgram        + waiting at GL_LINK_STATUS
+//     (cached)= glProgramBinary      : the whole build, in the link column
+//
+// Where the driver compiles lazily the wait lands on whichever check comes first, and
+// with KHR_parallel_shader_compile work done meanwhile is free: a stage that was ready
+// before its check shows close to its submit time only.
+//
+// Recorded from the GL thread (startup, then the render thread's reloads); report() may
+// run on any thread.
+struct ShaderBuildTiming {
+    double vertexMs = 0.0;
+    double fragmentMs = 0.0;
+    double linkMs = 0.0;
+    bool cached = false;  // loaded from the ProgramCache: nothing was compiled
+
+    double totalMs() const { return vertexMs + fragmentMs + linkMs; }
+};
+
+class ShaderTimings {
+public:
+    struct Entry {
+        std::string program;     // e.g. "vertex.glsl + fragment.glsl [INSTANCED]"
+        ShaderBuildTiming last;  // the most recent build
+        int builds = 0;
+    };
+
+    void record(const std::string& program, const ShaderBuildTiming& timing);
+
+    std::vector<Entry> entries() const;
+
+    // One line per program, most expensive (last build) first, then the sum.
+    void report(std::ostream& out) const;
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<Entry> entries_;
+};
@@ -0,0 +1,82 @@
+#include "profile/startup_timeline.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <ostream>
+
+#include "profile/trace.h"
+
+namespace {
+double msBetween(StartupTimeline::Clock::time_point from, StartupTimeline::Clock::time_point to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+} // namespace
+
+void StartupTimeline::start() {
+    start_ = Clock::now();
+    steps_.clear();
+    steps_.reserve(16);
+}
+
+void StartupTimeline::mark(const char* step) {
+    const Clock::time_point now = Clock::now();
+    const Clock::time_point from = steps_.empty() ? start_ : steps_.back().end;
+    steps_.push_back(Step{step, now});
+    if (trace::active()) {
+        const std::uint64_t traceNow = trace::now();
+        const std::uint64_t duration =
+            static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - from).count());
+        const std::uint64_t clipped = duration < traceNow ? duration : traceNow;
+        trace::complete(step, traceNow - clipped, clipped);
+    }
+}
+
+double StartupTimeline::totalMs() const {
+    return steps_.empty() ? 0.0 : msBetween(start_, steps_.back().end);
+}
+
+void StartupTimeline::report(std::ostream& out) const {
+    char line[120];
+    std::snprintf(line, sizeof(line), "%-24s %9s %9s\n", "step", "ms", "at");
+    out << line;
+    Clock::time_point from = start_;
+    for (const Step& s : steps_) {
+        std::snprintf(line, sizeof(line), "%-24s %9.2f %9.2f\n", s.name, msBetween(from, s.end),
+                      msBetween(start_, s.end));
+        out << line;
+        from = s.end;
+    }
+    std::snprintf(line, sizeof(line), "%-24s %9.2f\n", "total", totalMs());
+    out << line;
+}
+
+bool StartupTimeline::appendCsv(const std::string& path, const char* build) const {
+    bool empty = true;
+    {
+        std::ifstream existing(path, std::ios::binary | std::ios::ate);
+        empty = !existing || existing.tellg() <= 0;
+    }
+    std::ofstream out(path, std::ios::app);
+    if (!out) {
+        return false;
+    }
+    if (empty) {
+        out << "build";
+        for (const Step& s : steps_) {
+            out << "," << s.name;
+        }
+        out << ",total\n";
+    }
+    char value[32];
+    out << '"' << build << '"';
+    Clock::time_point from = start_;
+    for (const Step& s : steps_) {
+        std::snprintf(value, sizeof(value), ",%.3f", msBetween(from, s.end));
+        out << value;
+        from = s.end;
+    }
+    std::snprintf(value, sizeof(value), ",%.3f\n", totalMs());
+    out << value;
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// StartupTimeline
+// ---------------
+// Time to first frame, step by step. main() marks the end of each startup step; the
+// render side marks the first frame it presents; report() says where the time went:
+//
+//     timeline.start();               // first thing in main()
+//     ...
+//     timeline.mark("context");       // the step since the previous mark ends here
+//
+// | Column | Meaning                                          |
+// | ------ | ------------------------------------------------ |
+// | step   | the mark's name                                  |
+// | ms     | since the previous mark: the step's own time     |
+// | at     | since start(): when the step ended               |
+//
+// Work overlapped on other threads (main's startup prefetch) shows up only as the wait
+// at the mark that joins it. With a trace running (profile/trace.h) every step is also a
+// span on the marking thread's track, clipped to when the trace started.
+//
+// One thread marks at a time: main, then the render thread once it owns the frame.
+class StartupTimeline {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    void start();
+    // `step` must be a string literal (the trace keeps the pointer).
+    void mark(const char* step);
+
+    std::size_t size() const { return steps_.size(); }
+    double totalMs() const;     // start() to the last mark
+
+    // One line per step, in order, then the total.
+    void report(std::ostream& out) const;
+    // One CSV row: build, each step's ms, the total; a header row first if the file is
+    // new or empty. For tracking cold starts build over build (--startup-bench=FILE).
+    // Step names are used as column names as they are: no commas or quotes in them.
+    bool appendCsv(const std::string& path, const char* build) const;
+
+private:
+    struct Step {
+        const char* name;
+        Clock::time_point end;
+    };
+
+    Clock::time_point start_;
+    std::vector<Step> steps_;
+};
@@ -0,0 +1,119 @@
+#include "profile/telemetry.h"
+
+#include <algorithm>
+#include <cstdio>
+
+bool Telemetry::listen(std::uint16_t port) {
+    close();
+    return socket_.open(port);
+}
+
+bool Telemetry::push(const NetAddress& to) {
+    close();
+    if (!socket_.open(0)) {
+        return false;
+    }
+    pushTo_ = to;
+    pushing_ = true;
+    return true;
+}
+
+void Telemetry::close() {
+    socket_.close();
+    pushing_ = false;
+    length_ = 0;
+    text_[0] = '\0';
+}
+
+void Telemetry::add(const Frame& frame) {
+    frameMs_.add(frame.ms);
+    if (frame.gpuMs >= 0.0) {
+        gpuMs_.add(frame.gpuMs);
+    }
+    render_ += frame.render;
+    allocations_ += frame.allocations;
+    glStalls_ += frame.glStalls;
+    gpuBytes_ = frame.gpuBytes;
+    qualityLevel_ = frame.qualityLevel;
+    qualityName_ = frame.qualityName;
+    qualityChanges_ += frame.qualityChanged ? 1 : 0;
+    qualityChangesTotal_ += frame.qualityChanged ? 1 : 0;
+    ++frames_;
+    ++totalFrames_;
+}
+
+void Telemetry::update(double now) {
+    if (!isOpen()) {
+        return;
+    }
+    if (now >= nextUpdate_ && frames_ > 0) {
+        nextUpdate_ = now + kIntervalSeconds;
+        const int length = format(text_, sizeof text_);
+        length_ = std::min<std::size_t>(length > 0 ? static_cast<std::size_t>(length) : 0, sizeof text_ - 1);
+        render_ = RenderStats{};
+        allocations_ = 0;
+        glStalls_ = 0;
+        qualityChanges_ = 0;
+        frames_ = 0;
+        if (pushing_) {
+            socket_.send(pushTo_, text_, length_);
+        }
+    }
+    if (!pushing_) {
+        poll();
+    }
+}
+
+// Whatever a request says, the answer is the snapshot; a request that arrives before the
+// first one gets nothing (the agent asks again next second).
+void Telemetry::poll() {
+    unsigned char request[64];
+    NetAddress from;
+    for (int i = 0; i < kMaxRepliesPerPoll; ++i) {
+        if (socket_.receive(from, request, sizeof request) < 0) {
+            return;
+        }
+        ++requests_;
+        if (length_ > 0) {
+            socket_.send(from, text_, length_);
+        }
+    }
+}
+
+int Telemetry::format(char* out, std::size_t size) const {
+    const double n = static_cast<double>(frames_);
+    const RollingStats::Summary frame = frameMs_.summarize();
+    const RollingStats::Summary gpu = gpuMs_.summarize();
+    int length = std::snprintf(out, size,
+                               "frames %llu\n"
+                               "frames_total %llu\n"
+                               "frame_ms_avg %.3f\n"
+                               "frame_ms_p50 %.3f\n"
+                               "frame_ms_p95 %.3f\n"
+                               "frame_ms_p99 %.3f\n"
+                               "frame_ms_max %.3f\n",
+                               static_cast<unsigned long long>(frames_), static_cast<unsigned long long>(totalFrames_),
+                               frame.avg, frame.p50, frame.p95, frame.p99, frame.max);
+    auto append = [&](const char* format, auto... args) {
+        if (length >= 0 && static_cast<std::size_t>(length) < size) {
+            length += std::snprintf(out + length, size - length, format, args...);
+        }
+    };
+    if (gpu.count > 0) {
+        append("gpu_ms_avg %.3f\ngpu_ms_p95 %.3f\ngpu_ms_p99 %.3f\n", gpu.avg, gpu.p95, gpu.p99);
+    }
+    // Per frame, over the interval.
+    append("draw_calls %.1f\ninstances %.0f\nbatches %.1f\n", render_.drawCalls / n, render_.instances / n,
+           render_.batches / n);
+    append("breaks_program %.1f\nbreaks_texture %.1f\nbreaks_pipeline %.1f\nbreaks_capacity %.1f\n",
+           render_.programBreaks / n, render_.textureBreaks / n, render_.pipelineBreaks / n,
+           render_.capacityBreaks / n);
+    append("upload_bytes %.0f\nstate_issued %.0f\nstate_filtered %.0f\n", render_.uploadBytes / n,
+           render_.stateIssued / n, render_.stateFiltered / n);
+    append("heap_allocs %.2f\ngl_stalls %u\ngpu_memory_bytes %zu\n", allocations_ / n, glStalls_, gpuBytes_);
+    if (qualityLevel_ >= 0) {
+        append("quality_level %d\nquality_name %s\nquality_changes %u\nquality_changes_total %llu\n", qualityLevel_,
+               qualityName_, qualityChanges_, static_cast<unsigned long long>(qualityChangesTotal_));
+    }
+    return length;
+}
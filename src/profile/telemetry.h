@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "net/udp_socket.h"
+#include "profile/profiler.h"
+#include "render/render_stats.h"
+
+// Telemetry
+// ---------
+// Live numbers for an external monitoring agent (--telemetry): the rolling frame time
+// percentiles, GPU time, memory and the render stats, formatted once per second into one
+// datagram of "key value" lines that an agent fetches over UDP:
+//
+//     $ echo | nc -u -w1 127.0.0.1 27962
+//     frames 61
+//     frame_ms_p50 16.667
+//     ...
+//
+// | --telemetry= | What happens                                                      |
+// | ------------ | ----------------------------------------------------------------- |
+// | (none), PORT | bound to PORT (default kDefaultPort): any datagram to it gets the |
+// |              | latest snapshot back, to the sender                               |
+// | HOST:PORT    | the snapshot is sent there every second; nothing is listened to   |
+//
+// With --quality-governor the snapshot also has its level (quality_level, quality_name)
+// and the level changes in the interval and since startup, so an agent sees when and
+// how often a machine had to trade quality for the frame rate.
+//
+// Cheap on the game's side whatever the agent does: add() per frame is two RollingStats
+// samples and a few sums; the text is formatted once per interval, not per request, and
+// poll() answers at most kMaxRepliesPerPoll requests a frame from the already formatted
+// buffer (never blocking: UdpSocket). Nothing allocates after open().
+//
+// Main thread only. The render side's numbers come from the FramePacket, as for the HUD:
+// two frames old.
+class Telemetry {
+public:
+    static constexpr std::uint16_t kDefaultPort = 27962;
+    static constexpr double kIntervalSeconds = 1.0;
+    static constexpr int kMaxRepliesPerPoll = 4;
+
+    // One frame's numbers.
+    struct Frame {
+        double ms = 0.0;                        // frame to frame
+        double gpuMs = -1.0;                    // the render side's GPU sections; < 0: untimed
+        RenderStats render;
+        std::uint64_t allocations = 0;          // heap allocations, main + render
+        std::size_t gpuBytes = 0;               // tracked GPU memory (the newest)
+        std::uint32_t glStalls = 0;
+        int qualityLevel = -1;                  // --quality-governor's level; < 0: off
+        const char* qualityName = "";
+        bool qualityChanged = false;            // this frame
+    };
+
+    Telemetry() = default;
+    Telemetry(const Telemetry&) = delete;
+    Telemetry& operator=(const Telemetry&) = delete;
+
+    // Serves snapshots on `port`.
+    bool listen(std::uint16_t port);
+    // Sends them to `to` every interval.
+    bool push(const NetAddress& to);
+    void close();
+    bool isOpen() const { return socket_.isOpen(); }
+    std::uint16_t port() const { return socket_.port(); }
+
+    void add(const Frame& frame);
+    // Once a frame: formats a new snapshot when kIntervalSeconds have passed since the
+    // last (`now` in seconds, and pushes it), then answers waiting requests.
+    void update(double now);
+
+    const char* text() const { return text_; }
+    std::uint64_t requests() const { return requests_; }
+
+private:
+    int format(char* out, std::size_t size) const;
+    void poll();
+
+    UdpSocket socket_;
+    NetAddress pushTo_;
+    bool pushing_ = false;
+    double nextUpdate_ = 0.0;
+
+    RollingStats frameMs_;
+    RollingStats gpuMs_;
+    // Since the last snapshot.
+    RenderStats render_;
+    std::uint64_t allocations_ = 0;
+    std::uint32_t glStalls_ = 0;
+    std::size_t gpuBytes_ = 0;
+    int qualityLevel_ = -1;            // the newest
+    const char* qualityName_ = "";
+    std::uint32_t qualityChanges_ = 0;
+    std::uint64_t qualityChangesTotal_ = 0;
+    std::uint64_t frames_ = 0;         // in the interval
+    std::uint64_t totalFrames_ = 0;
+
+    char text_[UdpSocket::kMaxDatagram] = {};
+    std::size_t length_ = 0;
+    std::uint64_t requests_ = 0;
+};
@@ -0,0 +1,197 @@
+#include "profile/trace.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "core/spsc_ring.h"
+#include "profile/flight_recorder.h"
+#include "profile/sampling.h"
+
+namespace trace {
+
+namespace {
+
+enum class Kind : std::uint8_t { Complete, Gpu, Instant, Counter };
+
+struct Event {
+    const char* name;
+    std::uint64_t startNs;
+    std::uint64_t durationNs;          // Counter: the value
+    Kind kind;
+};
+
+constexpr std::uint32_t kGpuTrackId = 0;
+
+// One per thread that ever emitted an event. Never freed before process exit, so the
+// writer can keep reading a buffer after its thread has ended.
+struct ThreadBuffer {
+    SpscRing<Event, 16384> ring;
+    std::uint32_t tid = 0;
+    std::atomic<const char*> name{nullptr};
+    const char* writtenName = nullptr; // writer-side: last name emitted as metadata
+};
+
+using Clock = std::chrono::steady_clock;
+
+std::mutex gRegistryMutex;                          // registration + writer drain only
+std::vector<std::unique_ptr<ThreadBuffer>> gRegistry;
+std::atomic<bool> gActive{false};
+std::atomic<bool> gStopRequested{false};
+std::atomic<std::uint64_t> gDropped{0};
+std::thread gWriter;
+std::FILE* gFile = nullptr;
+bool gFirstRecord = true;
+const Clock::time_point gEpoch = Clock::now();
+
+thread_local ThreadBuffer* tLocal = nullptr;
+
+ThreadBuffer* localBuffer() {
+    if (!tLocal) {
+        std::lock_guard<std::mutex> lock(gRegistryMutex);
+        gRegistry.push_back(std::make_unique<ThreadBuffer>());
+        tLocal = gRegistry.back().get();
+        tLocal->tid = static_cast<std::uint32_t>(gRegistry.size()); // 0 is the GPU track
+    }
+    return tLocal;
+}
+
+void push(const Event& event) {
+    if (!localBuffer()->ring.push(event)) {
+        gDropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void writeRecord(const char* json) {
+    std::fputs(gFirstRecord ? "\n" : ",\n", gFile);
+    std::fputs(json, gFile);
+    gFirstRecord = false;
+}
+
+void writeThreadName(std::uint32_t tid, const char* name) {
+    char line[256];
+    std::snprintf(line, sizeof(line),
+                  "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                  tid, name);
+    writeRecord(line);
+}
+
+void writeEvent(std::uint32_t tid, const Event& e) {
+    char line[256];
+    const double ts = e.startNs / 1000.0; // trace format uses microseconds
+    switch (e.kind) {
+        case Kind::Complete:
+        case Kind::Gpu:
+            std::snprintf(line, sizeof(line),
+                          "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                          e.name, e.kind == Kind::Gpu ? kGpuTrackId : tid, ts, e.durationNs / 1000.0);
+            break;
+        case Kind::Instant:
+            std::snprintf(line, sizeof(line),
+                          "{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"p\",\"pid\":1,\"tid\":%u,\"ts\":%.3f}",
+                          e.name, tid, ts);
+            break;
+        case Kind::Counter:
+            std::snprintf(line, sizeof(line),
+                          "{\"name\":\"%s\",\"ph\":\"C\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"args\":{\"value\":%llu}}",
+                          e.name, tid, ts, static_cast<unsigned long long>(e.durationNs));
+            break;
+    }
+    writeRecord(line);
+}
+
+void drainAll() {
+    std::lock_guard<std::mutex> lock(gRegistryMutex);
+    for (auto& buffer : gRegistry) {
+        const char* name = buffer->name.load(std::memory_order_acquire);
+        if (name && name != buffer->writtenName) {
+            writeThreadName(buffer->tid, name);
+            buffer->writtenName = name;
+        }
+        Event e;
+        while (buffer->ring.pop(e)) {
+            writeEvent(buffer->tid, e);
+        }
+    }
+}
+
+void writerMain() {
+    while (!gStopRequested.load(std::memory_order_acquire)) {
+        drainAll();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    drainAll();
+}
+
+} // namespace
+
+std::uint64_t now() {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - gEpoch).count());
+}
+
+bool start(const char* path) {
+    if (gActive.load()) {
+        return true;
+    }
+    gFile = std::fopen(path, "w");
+    if (!gFile) {
+        std::fprintf(stderr, "Failed to open trace file: %s\n", path);
+        return false;
+    }
+    std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", gFile);
+    gFirstRecord = true;
+    writeThreadName(kGpuTrackId, "GPU");
+
+    gStopRequested.store(false);
+    gWriter = std::thread(writerMain);
+    gActive.store(true, std::memory_order_release);
+    return true;
+}
+
+void stop() {
+    if (!gActive.exchange(false)) {
+        return;
+    }
+    gStopRequested.store(true, std::memory_order_release);
+    gWriter.join();
+    std::fputs("\n]}\n", gFile);
+    std::fclose(gFile);
+    gFile = nullptr;
+}
+
+bool active() {
+    return gActive.load(std::memory_order_relaxed);
+}
+
+void setThreadName(const char* name) {
+    localBuffer()->name.store(name, std::memory_order_release);
+    sampling::setThreadName(name);      // a sampling profiler's thread list too, if built in
+    flightrec::setThreadName(name);     // and the flight recorder's dumps
+}
+
+void complete(const char* name, std::uint64_t startNs, std::uint64_t durationNs) {
+    if (active()) push(Event{name, startNs, durationNs, Kind::Complete});
+}
+
+void gpu(const char* name, std::uint64_t startNs, std::uint64_t durationNs) {
+    if (active()) push(Event{name, startNs, durationNs, Kind::Gpu});
+}
+
+void instant(const char* name) {
+    if (active()) push(Event{name, now(), 0, Kind::Instant});
+}
+
+void counter(const char* name, std::uint64_t value) {
+    if (active()) push(Event{name, now(), value, Kind::Counter});
+}
+
+std::uint64_t droppedEvents() {
+    return gDropped.load(std::memory_order_relaxed);
+}
+
+} // namespace trace
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+
+// Chrome / Perfetto trace export
+// ------------------------------
+// Writes a JSON trace ("Trace Event Format") that chrome://tracing and
+// https://ui.perfetto.dev open directly.
+//
+// Hot path: trace::complete(...) copies a 32-byte event into a lock-free ring owned by
+// the CALLING thread (one ring per thread, created on first use). No locks, no
+// allocation, no I/O.
+// Cold path: a background writer thread drains every thread's ring a few times per
+// second and formats/writes the JSON, so file I/O never happens on the game threads.
+//
+// If a ring is full (writer fell behind) the event is dropped and counted.
+//
+// Names must be string literals (or otherwise outlive the trace): only the pointer is
+// stored in the event.
+namespace trace {
+
+// Nanoseconds on the trace clock (steady_clock, zero at start()).
+std::uint64_t now();
+
+// Starts the writer thread and opens `path`. Returns false if the file can't be opened.
+bool start(const char* path);
+// Flushes everything still queued, closes the JSON and joins the writer.
+void stop();
+bool active();
+
+// Names the calling thread in the trace viewer (e.g. "main", "render", "worker 3"), in
+// a sampling profiler's when one is built in (profile/sampling.h) and in the flight
+// recorder's dumps (profile/flight_recorder.h), tracing or not.
+void setThreadName(const char* name);
+
+// A finished span on the calling thread's track ("X" event).
+void complete(const char* name, std::uint64_t startNs, std::uint64_t durationNs);
+// A span on the virtual GPU track. Start time is where the CPU issued the work.
+void gpu(const char* name, std::uint64_t startNs, std::uint64_t durationNs);
+// A zero-length marker ("i" event), e.g. frame boundaries or hitches.
+void instant(const char* name);
+// A value over time ("C" event), drawn as its own graph under the process: per-frame
+// counts, bytes.
+void counter(const char* name, std::uint64_t value);
+
+std::uint64_t droppedEvents();
+
+// RAII span on the calling thread.
+class Scope {
+public:
+    explicit Scope(const char* name) : name_(name), enabled_(active()), start_(enabled_ ? now() : 0) {}
+    ~Scope() {
+        if (enabled_) complete(name_, start_, now() - start_);
+    }
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    const char* name_;
+    bool enabled_;
+    std::uint64_t start_;
+};
+
+} // namespace trace
@@ -0,0 +1,143 @@
+#include "render/camera.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <cmath>
+
+#include "core/matrix_inverse.h"
+
+void Camera::setPosition(const glm::vec2& position) {
+    if (position == position_) {
+        return;
+    }
+    position_ = position;
+    if (mode_ == Projection::Orthographic) {
+        dirty_ |= kView; // the perspective view looks at a fixed point and ignores position
+    }
+}
+
+void Camera::setZoom(float zoom) {
+    if (zoom == zoom_ || zoom <= 0.0f) {
+        return;
+    }
+    zoom_ = zoom;
+    dirty_ |= orthographic() ? kProjection : kView;
+}
+
+void Camera::setViewport(int width, int height) {
+    if (width <= 0 || height <= 0) {
+        return; // minimized: keep the last valid size instead of a 0 aspect ratio
+    }
+    if (width == width_ && height == height_) {
+        return;
+    }
+    width_ = width;
+    height_ = height;
+    dirty_ |= kProjection;
+}
+
+void Camera::setProjection(Projection projection) {
+    if (projection == mode_) {
+        return;
+    }
+    mode_ = projection;
+    dirty_ |= kView | kProjection;
+}
+
+void Camera::toggleProjection() {
+    setProjection(orthographic() ? Projection::Perspective : Projection::Orthographic);
+}
+
+bool Camera::update() {
+    if (dirty_ == 0) {
+        return false;
+    }
+    if (orthographic()) {
+        // Scale + offset only (render/ortho_2d.h); the mat4s are expanded, not multiplied.
+        if (dirty_ & kProjection) {
+            orthoProjection_ = Ortho2D::projection(aspect() / zoom_, 1.0f / zoom_);
+            projectionMatrix_ = orthoProjection_.toMat4();
+        }
+        if (dirty_ & kView) {
+            orthoView_ = Ortho2D::translation(-position_.x, -position_.y);
+            view_ = orthoView_.toMat4();
+        }
+        viewProjection_ = (orthoProjection_ * orthoView_).toMat4();
+        dirty_ = 0;
+        ++version_;
+        return true;
+    }
+    if (dirty_ & kProjection) {
+        projectionMatrix_ = glm::perspective(glm::radians(45.0f), aspect(), 0.1f, 100.0f);
+    }
+    if (dirty_ & kView) {
+        view_ = glm::lookAt(
+            glm::vec3(0.0f, 0.0f, 3.0f / zoom_),  // camera position
+            glm::vec3(0.0f, 0.0f, 0.0f),  // look at origin
+            glm::vec3(0.0f, 1.0f, 0.0f)   // up direction
+        );
+    }
+    viewProjection_ = projectionMatrix_ * view_;
+    dirty_ = 0;
+    ++version_;
+    return true;
+}
+
+const glm::mat4& Camera::inverseViewProjection() {
+    update(); // may be called between setters and the frame's update()
+    // Inverting a 4x4 is comparatively expensive: once per camera change, and only if
+    // someone asks (a click), not once per frame.
+    if (inverseVersion_ != version_) {
+        // Orthographic: the Ortho2D's inverse. Perspective: each factor's closed form
+        // (core/matrix_inverse.h)—lookAt is rigid—exact where glm::inverse rounds.
+        inverseViewProjection_ = orthographic()
+            ? (orthoProjection_ * orthoView_).inverse().toMat4()
+            : inverseOf(view_, MatrixKind::Rigid) * inverseOf(projectionMatrix_, MatrixKind::Perspective);
+        inverseVersion_ = version_;
+    }
+    return inverseViewProjection_;
+}
+
+Ortho2D Camera::inverseOrtho() {
+    update();
+    return (orthoProjection_ * orthoView_).inverse();
+}
+
+glm::vec2 Camera::screenToWorld(double x, double y) {
+    const glm::vec2 screen(static_cast<float>(x), static_cast<float>(y));
+    glm::vec2 world;
+    screenToWorld(&screen, 1, &world);
+    return world;
+}
+
+void Camera::screenToWorld(const glm::vec2* screen, std::size_t count, glm::vec2* world) {
+    // Framebuffer pixels → NDC (y flipped: pixel y grows downwards).
+    const float scaleX = 2.0f / width_;
+    const float scaleY = -2.0f / height_;
+    if (orthographic()) {
+        // Pixels → NDC → world is one scale + offset per axis: two FMAs per point.
+        const Ortho2D pixels = inverseOrtho() * Ortho2D{scaleX, scaleY, 1.0f, -1.0f, 1.0f};
+        for (std::size_t i = 0; i < count; ++i) {
+            world[i] = pixels.apply(screen[i]);
+        }
+        return;
+    }
+    // Inverse view-projection (not MVP): true world coordinates, independent of any
+    // object's own model transform.
+    const glm::mat4& inverse = inverseViewProjection();
+
+    // inverse * (x, y, z, 1) = base + z * inverse[2], with base = inverse * (x, y, 0, 1):
+    // the pixel's ray through the depth range, homogeneous. It crosses the world's z = 0
+    // plane where its z component is 0 (the same ray visibleRect intersects, in closed
+    // form). Rays parallel to the plane can't happen with this camera; they keep the near
+    // point.
+    const glm::vec4 ray = inverse[2];
+    const bool parallel = std::fabs(ray.z) < 1e-12f;
+    for (std::size_t i = 0; i < count; ++i) {
+        const float xNDC = screen[i].x * scaleX - 1.0f;
+        const float yNDC = screen[i].y * scaleY + 1.0f;
+        const glm::vec4 base = inverse[0] * xNDC + inverse[1] * yNDC + inverse[3];
+        const float depth = parallel ? -1.0f : -base.z / ray.z;
+        const glm::vec4 hit = base + ray * depth;
+        world[i] = glm::vec2(hit) / hit.w;
+    }
+}
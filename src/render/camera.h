@@ -0,0 +1,98 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+
+#include "render/ortho_2d.h"
+
+// Camera
+// ------
+// Owns everything the view and projection matrices are built from—2D position,
+// projection mode and viewport size—and rebuilds the matrices ONLY when one of those
+// actually changed.
+//
+// | Input changed            | Recomputed                          |
+// | ------------------------ | ----------------------------------- |
+// | setPosition (ortho mode) | view                                |
+// | setZoom                  | projection (ortho) / view (persp.)  |
+// | setViewport (resize)     | projection                          |
+// | setProjection / toggle   | view + projection                   |
+// | nothing                  | nothing: update() returns false     |
+//
+// version() increases every time the matrices change. Anything derived from them keeps
+// the version it was built from and skips its work while it still matches:
+//
+//     if (camera.version() != uploadedVersion) {   // e.g. the camera UBO
+//         ubo.upload(camera.view(), camera.projectionMatrix());
+//         uploadedVersion = camera.version();
+//     }
+//
+// The inverse view-projection (picking) is computed lazily, at most once per version,
+// and always reflects the latest setters (it calls update() itself).
+//
+// Orthographic mode builds its matrices as Ortho2D (render/ortho_2d.h), a scale + offset
+// per axis: no glm::ortho, no generic 4x4 multiply, and the inverse (picking, culling) is
+// the Ortho2D's own. The mat4s are those expanded, for whoever still wants them.
+class Camera {
+public:
+    enum class Projection { Orthographic, Perspective };
+
+    void setPosition(const glm::vec2& position);
+    // > 1 magnifies: the orthographic extent shrinks to (±aspect, ±1) / zoom, the
+    // perspective eye moves closer by the same factor (core/camera_rig.h smooths it).
+    void setZoom(float zoom);
+    void setViewport(int width, int height);
+    void setProjection(Projection projection);
+    void toggleProjection();
+
+    // Rebuilds dirty matrices. Returns true (and bumps version()) if anything changed.
+    bool update();
+
+    const glm::vec2& position() const { return position_; }
+    float zoom() const { return zoom_; }
+    Projection projection() const { return mode_; }
+    bool orthographic() const { return mode_ == Projection::Orthographic; }
+    int width() const { return width_; }
+    int height() const { return height_; }
+    float aspect() const { return height_ > 0 ? static_cast<float>(width_) / height_ : 1.0f; }
+
+    // Valid after update().
+    const glm::mat4& view() const { return view_; }
+    const glm::mat4& projectionMatrix() const { return projectionMatrix_; }
+    const glm::mat4& viewProjection() const { return viewProjection_; }
+    const glm::mat4& inverseViewProjection();
+    // Orthographic mode only (valid after update()): view and projection as Ortho2D.
+    const Ortho2D& orthoView() const { return orthoView_; }
+    const Ortho2D& orthoProjection() const { return orthoProjection_; }
+    // projection * view, inverted: clip → world. Calls update() like inverseViewProjection.
+    Ortho2D inverseOrtho();
+    std::uint64_t version() const { return version_; }
+
+    // Framebuffer pixel coordinates (origin top-left, as setViewport's size and Input's
+    // cursor events) → world position on the z = 0 plane.
+    glm::vec2 screenToWorld(double x, double y);
+    // The same for `count` points at once (a drag path, several touches): the inverse and
+    // the pixel → NDC scale are looked up once, then each point is a few multiply-adds
+    // and one divide. `world` may alias `screen`.
+    void screenToWorld(const glm::vec2* screen, std::size_t count, glm::vec2* world);
+
+private:
+    enum Dirty : std::uint8_t { kView = 1, kProjection = 2 };
+
+    glm::vec2 position_{0.0f, 0.0f};
+    float zoom_ = 1.0f;
+    Projection mode_ = Projection::Orthographic;
+    int width_ = 1;
+    int height_ = 1;
+
+    std::uint8_t dirty_ = kView | kProjection;
+    std::uint64_t version_ = 0;
+    std::uint64_t inverseVersion_ = ~0ull;
+    glm::mat4 view_{1.0f};
+    glm::mat4 projectionMatrix_{1.0f};
+    glm::mat4 viewProjection_{1.0f};
+    glm::mat4 inverseViewProjection_{1.0f};
+    Ortho2D orthoView_;
+    Ortho2D orthoProjection_;
+};
@@ -0,0 +1,74 @@
+#include "render/camera_ubo.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <iostream>
+
+#include "render/gl_buffer.h"
+#include "render/gl_state.h"
+#include "render/gpu_memory.h"
+
+namespace {
+
+// projection * view * translate(origin), multiplied in double: the view's translation
+// (-camera) and the origin cancel exactly, so only their small difference reaches a float.
+glm::mat4 relativeViewProjection(const glm::mat4& projection, const glm::mat4& view, const glm::dvec2& origin) {
+    return glm::mat4(glm::dmat4(projection) * glm::dmat4(view) *
+                     glm::translate(glm::dmat4(1.0), glm::dvec3(origin, 0.0)));
+}
+
+} // namespace
+
+bool CameraUniformBuffer::init(int views) {
+    const gpumemory::Owner owner("camera");
+    views_ = std::clamp(views, 1, kMaxViews);
+
+    // Range binds must start at a multiple of the alignment (256 on most desktop GPUs).
+    GLint alignment = 1;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    const GLsizeiptr align = std::max<GLsizeiptr>(alignment, 1);
+    stride_ = (static_cast<GLsizeiptr>(sizeof(CameraBlock)) + align - 1) / align * align;
+
+    ubo_ = GlBuffer::create();
+    glbuffer::data(GL_UNIFORM_BUFFER, ubo_.get(), stride_ * views_, nullptr, GL_DYNAMIC_DRAW);
+
+    if (!ubo_) {
+        std::cerr << "Failed to create camera uniform buffer\n";
+        return false;
+    }
+    // Point the binding point at view 0. With a single view this only has to happen
+    // once: it keeps pointing at our buffer until something else is bound there.
+    bindView(0);
+    return true;
+}
+
+void CameraUniformBuffer::shutdown() {
+    ubo_.reset();
+}
+
+void CameraUniformBuffer::upload(int view, const glm::mat4& viewMatrix, const glm::mat4& projection,
+                                 const glm::dvec2& origin) {
+    CameraBlock& block = blocks_[view];
+    block.view = viewMatrix;
+    block.projection = projection;
+    block.viewProjection = projection * viewMatrix;
+    block.relativeViewProjection = relativeViewProjection(projection, viewMatrix, origin);
+
+    glbuffer::subData(GL_UNIFORM_BUFFER, ubo_.get(), stride_ * view, sizeof(CameraBlock), &block);
+}
+
+void CameraUniformBuffer::upload(int view, const Ortho2D& viewOrtho, const Ortho2D& projection,
+                                 const glm::dvec2& origin) {
+    CameraBlock& block = blocks_[view];
+    block.view = viewOrtho.toMat4();
+    block.projection = projection.toMat4();
+    block.viewProjection = (projection * viewOrtho).toMat4();
+    block.relativeViewProjection = relativeViewProjection(block.projection, block.view, origin);
+
+    glbuffer::subData(GL_UNIFORM_BUFFER, ubo_.get(), stride_ * view, sizeof(CameraBlock), &block);
+}
+
+void CameraUniformBuffer::bindView(int view) {
+    glstate::bindBufferRange(GL_UNIFORM_BUFFER, kBindingPoint, ubo_.get(), stride_ * view,
+                             static_cast<GLsizeiptr>(sizeof(CameraBlock)));
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+
+#include "render/gl_resource.h"
+#include "render/ortho_2d.h"
+#include "render/shader_layout.h"
+
+// CameraBlock
+// -----------
+// CPU mirror of the GLSL block in shaders/camera.glsl:
+//
+//     layout (std140, binding = 0) uniform Camera {
+//         mat4 view;
+//         mat4 projection;
+//         mat4 viewProjection;
+//         mat4 relativeViewProjection;
+//     };
+//
+// std140 rules for mat4: each column is a vec4 aligned to 16 bytes, so a mat4 is
+// exactly 64 bytes and glm::mat4 matches it byte for byte. Keep the member order
+// identical to the shader—offsets are implied by order, not by name (the asserts
+// below hold it to the offsets generated from camera.glsl: render/shader_layout.h).
+struct CameraBlock {
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::mat4 viewProjection;
+    glm::mat4 relativeViewProjection;   // viewProjection * translate(origin): core/world_position.h
+};
+static_assert(sizeof(CameraBlock) == shaderlayout::camera::Camera::kSize, "CameraBlock must match std140 layout");
+static_assert(offsetof(CameraBlock, projection) == shaderlayout::camera::Camera::projection &&
+                  offsetof(CameraBlock, viewProjection) == shaderlayout::camera::Camera::viewProjection &&
+                  offsetof(CameraBlock, relativeViewProjection) ==
+                      shaderlayout::camera::Camera::relativeViewProjection,
+              "CameraBlock's members must be in the shader's order");
+
+// CameraUniformBuffer
+// -------------------
+// A Uniform Buffer Object (UBO) holding one CameraBlock per view (split-screen halves, a
+// minimap), on the binding point camera.glsl names (kBindingPoint).
+//
+// | Step                          | When                                        |
+// | ----------------------------- | ------------------------------------------- |
+// | init(views)                   | once at startup                             |
+// | upload(view index, matrices)  | once per frame, per view whose camera moved |
+// | bindView(view index)          | before that view's draws                    |
+//
+// Every program's "Camera" block reads that binding point (the GLSL says so, nothing
+// attaches it: render/shader_build.h), so camera matrices are uploaded once per frame
+// no matter how many draws (or programs) follow.
+//
+// The blocks sit one after another in the one buffer, each at a multiple of
+// GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT. bindView points the binding point at one of them
+// (glBindBufferRange, filtered by gl_state when it already does): the shaders keep their
+// single `Camera` block, and which view a draw sees is a per-draw binding, not a
+// per-view upload.
+class CameraUniformBuffer {
+public:
+    static constexpr GLuint kBindingPoint = shaderlayout::camera::Camera::kBinding;
+    static constexpr int kMaxViews = 8;
+
+    bool init(int views = 1);
+    void shutdown();
+
+    // Computes viewProjection and streams that view's block in one glBufferSubData.
+    // relativeViewProjection is viewProjection for instances composed relative to
+    // `origin` (the frame's FramePacket::origin, in world units).
+    void upload(int view, const glm::mat4& viewMatrix, const glm::mat4& projection,
+                const glm::dvec2& origin = glm::dvec2(0.0));
+    void upload(const glm::mat4& viewMatrix, const glm::mat4& projection) { upload(0, viewMatrix, projection); }
+    // Orthographic cameras (render/ortho_2d.h): the matrices are expanded from scale +
+    // offset; viewProjection is composed as Ortho2D, not multiplied as 4x4s.
+    void upload(int view, const Ortho2D& viewOrtho, const Ortho2D& projection,
+                const glm::dvec2& origin = glm::dvec2(0.0));
+    // Draws from here on read view `view`'s block. init() leaves view 0 bound.
+    void bindView(int view);
+
+    const CameraBlock& data(int view = 0) const { return blocks_[view]; }
+    int views() const { return views_; }
+
+private:
+    GlBuffer ubo_;
+    int views_ = 1;
+    GLsizeiptr stride_ = sizeof(CameraBlock);
+    CameraBlock blocks_[kMaxViews]{};
+};
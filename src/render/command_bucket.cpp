@@ -0,0 +1,168 @@
+#include "render/command_bucket.h"
+
+#include <algorithm>
+
+#include "core/job_system.h"
+#include "render/gl_state.h"
+
+namespace sortkey {
+std::uint32_t depthBits(float depth01, bool backToFront) {
+    const float clamped = std::min(1.0f, std::max(0.0f, depth01));
+    const std::uint32_t max = static_cast<std::uint32_t>(mask(kDepthBits));
+    const std::uint32_t bits = static_cast<std::uint32_t>(clamped * static_cast<float>(max));
+    return backToFront ? max - bits : bits;
+}
+} // namespace sortkey
+
+void CommandContext::useProgram(GLuint program) {
+    useDefaultState();
+    if (program != program_) {
+        draws_.flush();
+        glstate::useProgram(program);
+        program_ = program;
+        ++stats_.programChanges;
+    }
+}
+
+void CommandContext::bindTexture(GLuint texture, GLenum target) {
+    if (texture != texture_ || target != textureTarget_) {
+        draws_.flush();
+        glstate::activeTexture(GL_TEXTURE0);
+        glstate::bindTexture(target, texture);
+        texture_ = texture;
+        textureTarget_ = target;
+        ++stats_.textureChanges;
+    }
+}
+
+void CommandContext::usePipeline(PipelineId pipeline) {
+    if (pipeline != pipelines_->current()) {
+        draws_.flush();
+        pipelines_->bind(pipeline);
+        ++stats_.pipelineChanges;
+        const GLuint program = pipelines_->desc(pipeline).program;
+        if (program != 0 && program != program_) {
+            program_ = program;
+            ++stats_.programChanges;
+        }
+    }
+}
+
+void CommandContext::useDefaultState() {
+    if (pipelines_ && pipelines_->current() != PipelineLibrary::kDefault) {
+        draws_.flush();
+        pipelines_->bind(PipelineLibrary::kDefault);
+    }
+}
+
+void CommandContext::invalidate() {
+    program_ = kUnknown;
+    texture_ = kUnknown;
+    if (pipelines_) {
+        pipelines_->invalidate();
+    }
+}
+
+void CommandContext::reset() {
+    invalidate();
+    stats_ = Stats{};
+}
+
+void CommandBucket::clear() {
+    entries_.clear();
+    arena_.clear();
+}
+
+std::size_t CommandBucket::reserve(std::size_t commandBytes) {
+    const std::size_t offset = arena_.size();
+    const std::size_t record = (kHeaderSize + commandBytes + kAlign - 1) / kAlign * kAlign;
+    arena_.resize(offset + record); // capacity is kept across clear(): no steady-state allocation
+    return offset;
+}
+
+void CommandBucket::append(const CommandBucket& other) {
+    const std::size_t base = arena_.size();
+    arena_.insert(arena_.end(), other.arena_.begin(), other.arena_.end());  // records stay kAlign-aligned
+    for (const Entry& e : other.entries_) {
+        entries_.push_back(Entry{e.key, static_cast<std::uint32_t>(base + e.offset)});
+    }
+}
+
+void CommandBucket::sort() {
+    const std::size_t n = entries_.size();
+    if (n < 2) {
+        return;
+    }
+
+    // One read of the keys builds the histograms of all eight bytes.
+    std::size_t counts[8][256] = {};
+    for (const Entry& e : entries_) {
+        for (int pass = 0; pass < 8; ++pass) {
+            ++counts[pass][(e.key >> (pass * 8)) & 0xff];
+        }
+    }
+
+    scratch_.resize(n);
+    Entry* src = entries_.data();
+    Entry* dst = scratch_.data();
+    for (int pass = 0; pass < 8; ++pass) {
+        std::size_t* count = counts[pass];
+        const int shift = pass * 8;
+        if (count[(src[0].key >> shift) & 0xff] == n) {
+            continue; // every key has this byte: the pass wouldn't move anything
+        }
+        std::size_t offset = 0;
+        for (int b = 0; b < 256; ++b) {
+            const std::size_t c = count[b];
+            count[b] = offset;
+            offset += c;
+        }
+        for (std::size_t i = 0; i < n; ++i) {
+            dst[count[(src[i].key >> shift) & 0xff]++] = src[i];
+        }
+        std::swap(src, dst);
+    }
+    if (src != entries_.data()) {
+        entries_.swap(scratch_); // odd number of passes ran: the result is in scratch_
+    }
+}
+
+void CommandBucket::execute(CommandContext& context, std::size_t begin, std::size_t end) const {
+    for (std::size_t i = begin; i < end; ++i) {
+        const Entry& e = entries_[i];
+        const unsigned char* record = arena_.data() + e.offset;
+        Header header;
+        std::memcpy(&header, record, sizeof(Header));
+        header.dispatch(record + kHeaderSize, context);
+        ++context.stats_.commands;
+    }
+    context.draws_.flush();
+    context.useDefaultState();         // what the code after the bucket expects
+}
+
+std::size_t CommandBucket::lowerBound(std::uint64_t key) const {
+    const auto it = std::lower_bound(entries_.begin(), entries_.end(), key,
+                                     [](const Entry& e, std::uint64_t k) { return e.key < k; });
+    return static_cast<std::size_t>(it - entries_.begin());
+}
+
+void CommandRecorder::init(JobSystem& jobs) {
+    jobs_ = &jobs;
+    buckets_.resize(jobs.threadCount());
+}
+
+void CommandRecorder::clear() {
+    for (CommandBucket& bucket : buckets_) {
+        bucket.clear();
+    }
+}
+
+CommandBucket& CommandRecorder::local() {
+    return buckets_[jobs_->threadIndex()];
+}
+
+void CommandRecorder::gatherInto(CommandBucket& bucket) const {
+    for (const CommandBucket& b : buckets_) {
+        bucket.append(b);
+    }
+}
@@ -0,0 +1,254 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include "render/multi_draw.h"
+#include "render/pipeline_state.h"
+
+class JobSystem;
+
+// Sort keys
+// ---------
+// A draw's 64-bit key says where it goes in the frame. Sorting the keys as plain integers
+// orders by the high fields first:
+//
+//     63      56 55        44 43                 24 23                     0
+//     │ layer  │  program   │      texture        │        depth           │
+//       8 bits    12 bits         20 bits                 24 bits
+//
+// | Field   | Why at this position                                                     |
+// | ------- | ------------------------------------------------------------------------ |
+// | layer   | coarse pass order (world before overlay before UI): must win over state  |
+// |         | high 4 bits: the view (viewLayer), so each view's passes run together    |
+// | program | the most expensive state to change, so draws sharing one end up adjacent |
+// | texture | next most expensive; adjacent draws with the same one skip the bind      |
+// | depth   | front-to-back (opaque, early-z) or inverted for back-to-front blending   |
+//
+// Program and texture are GL object names truncated to their field: only equality matters,
+// and names are small sequential integers in practice.
+//
+// With several views (split-screen, a minimap) the layer field is view * 16 + layer: all
+// of view 0's layers, then all of view 1's, ..., then kWindowView's, whose layers draw
+// once over the whole window (the HUD, presenting the scene). A view's part of the frame
+// is never revisited, so switching viewport and camera costs once per view.
+namespace sortkey {
+
+constexpr int kDepthBits = 24;
+constexpr int kTextureBits = 20;
+constexpr int kProgramBits = 12;
+constexpr int kLayerBits = 8;
+constexpr int kPassBits = 4;        // of the layer field: RenderLayer; the rest is the view
+constexpr std::uint32_t kWindowView = (1u << (kLayerBits - kPassBits)) - 1;
+
+constexpr int kTextureShift = kDepthBits;
+constexpr int kProgramShift = kTextureShift + kTextureBits;
+constexpr int kLayerShift = kProgramShift + kProgramBits;
+
+constexpr std::uint64_t mask(int bits) { return (std::uint64_t{1} << bits) - 1; }
+
+constexpr std::uint64_t make(std::uint32_t layer, std::uint32_t program, std::uint32_t texture,
+                             std::uint32_t depth) {
+    return ((layer & mask(kLayerBits)) << kLayerShift) |
+           ((program & mask(kProgramBits)) << kProgramShift) |
+           ((texture & mask(kTextureBits)) << kTextureShift) |
+           (depth & mask(kDepthBits));
+}
+
+// The layer field of `layer` in `view`.
+constexpr std::uint32_t viewLayer(std::uint32_t view, std::uint32_t layer) {
+    return view << kPassBits | (layer & ((1u << kPassBits) - 1));
+}
+
+constexpr std::uint32_t layer(std::uint64_t key) {
+    return static_cast<std::uint32_t>((key >> kLayerShift) & mask(kLayerBits));
+}
+constexpr std::uint32_t view(std::uint64_t key) {
+    return layer(key) >> kPassBits;
+}
+constexpr std::uint32_t program(std::uint64_t key) {
+    return static_cast<std::uint32_t>((key >> kProgramShift) & mask(kProgramBits));
+}
+constexpr std::uint32_t texture(std::uint64_t key) {
+    return static_cast<std::uint32_t>((key >> kTextureShift) & mask(kTextureBits));
+}
+
+// depth01 in [0, 1] (0 = nearest) quantized to the depth field. backToFront inverts it,
+// for blended draws that must be painted far to near.
+std::uint32_t depthBits(float depth01, bool backToFront = false);
+
+} // namespace sortkey
+
+// Layers, in draw order.
+enum class RenderLayer : std::uint32_t {
+    Background = 0,   // tilemap chunks, under everything
+    World = 1,
+    Lighting = 2,     // --lights: the view multiplied by its light (render/light_buffer.h)
+    Overlay = 3,      // particles, blended over the world
+    Ui = 4,           // debug shapes, over everything
+};
+
+// CommandContext
+// --------------
+// The GL state shared by consecutive commands while a bucket executes. Commands bind
+// through it, so a program or texture that is already bound costs a compare instead of
+// a GL call—that's where the sorting pays off.
+//
+// With a PipelineLibrary (render/pipeline_state.h), a command can bind a whole pipeline
+// instead: usePipeline() sets only the state that differs from the last one. Commands
+// that set state themselves start from useProgram(), which puts the library's default
+// state back first, and must leave that state as they found it.
+//
+// Commands that draw meshes of a pool (render/mesh_pool.h) add them to draws() instead of
+// drawing each: consecutive ones with the same state become one multi-draw (one
+// glMultiDrawElementsIndirect where the driver has it). A command flushes them before it
+// changes state outside the context; the bucket flushes whatever is left at the end.
+class CommandContext {
+public:
+    struct Stats {
+        std::size_t commands = 0;
+        std::size_t programChanges = 0;
+        std::size_t textureChanges = 0;
+        std::size_t pipelineChanges = 0;
+    };
+
+    // Both flush pending draws() first when they change the binding.
+    void useProgram(GLuint program);
+    void bindTexture(GLuint texture, GLenum target = GL_TEXTURE_2D);     // unit 0
+    // Needs setPipelines(); flushes too when the pipeline changes.
+    void usePipeline(PipelineId pipeline);
+    // The library's default state (no pipeline's blending or depth), for a command about
+    // to set its own without changing the program.
+    void useDefaultState();
+
+    // The library usePipeline() binds from; null: none.
+    void setPipelines(PipelineLibrary* pipelines) { pipelines_ = pipelines; }
+
+    MultiDraw& draws() { return draws_; }
+
+    // Forget what's bound: code outside the context changed GL state.
+    void invalidate();
+    // invalidate() and zero the stats (start of a frame).
+    void reset();
+    const Stats& stats() const { return stats_; }
+
+private:
+    friend class CommandBucket;
+
+    static constexpr GLuint kUnknown = 0xffffffffu;
+    GLuint program_ = kUnknown;
+    GLuint texture_ = kUnknown;
+    GLenum textureTarget_ = GL_TEXTURE_2D;
+    PipelineLibrary* pipelines_ = nullptr;
+    MultiDraw draws_;
+    Stats stats_;
+};
+
+// CommandBucket
+// -------------
+// One frame's (or one pass's) draw commands, collected in any order and executed in
+// sort-key order:
+//
+//     bucket.clear();
+//     bucket.submit(key, DrawInstanced{&quads, program});   // any number, any order
+//     bucket.sort();                                        // radix sort on the keys
+//     bucket.execute(context);                              // in key order
+//
+// A command is a small trivially copyable struct with a static
+//     void execute(const Command& command, CommandContext& context);
+// It is copied into the bucket's arena next to a pointer to that function, so commands
+// of different types share one bucket and executing one is an indirect call—no virtual
+// base class, no per-command allocation.
+//
+// sort() is an LSD radix sort of (key, arena offset) pairs: 8 passes of 8 bits, passes
+// where every key has the same byte skipped (most of a frame's keys differ only in a few
+// fields). Linear in the number of commands and stable, so equal keys keep submission
+// order.
+class CommandBucket {
+public:
+    template <typename Command>
+    void submit(std::uint64_t key, const Command& command) {
+        static_assert(std::is_trivially_copyable<Command>::value, "commands are copied with memcpy");
+        static_assert(alignof(Command) <= kAlign, "command over-aligned for the arena");
+        const std::size_t offset = reserve(sizeof(Command));
+        Header header{&invoke<Command>};
+        std::memcpy(arena_.data() + offset, &header, sizeof(Header));
+        std::memcpy(arena_.data() + offset + kHeaderSize, &command, sizeof(Command));
+        entries_.push_back(Entry{key, static_cast<std::uint32_t>(offset)});
+    }
+
+    void clear();
+    // Copies `other`'s commands after this bucket's, as if submitted here in its order.
+    void append(const CommandBucket& other);
+    void sort();
+    // Leaves no draws pending in the context.
+    void execute(CommandContext& context) const { execute(context, 0, entries_.size()); }
+    // Commands [begin, end) of the sorted bucket: one pass's part of the frame.
+    void execute(CommandContext& context, std::size_t begin, std::size_t end) const;
+    // After sort(): the first command whose key is at least `key` (size() if none).
+    std::size_t lowerBound(std::uint64_t key) const;
+
+    std::size_t size() const { return entries_.size(); }
+    std::uint64_t keyAt(std::size_t i) const { return entries_[i].key; }
+
+private:
+    using Dispatch = void (*)(const void* command, CommandContext& context);
+
+    struct Header {
+        Dispatch dispatch;
+    };
+    struct Entry {
+        std::uint64_t key;
+        std::uint32_t offset;   // of the command's Header in arena_
+    };
+
+    static constexpr std::size_t kAlign = 16;
+    static constexpr std::size_t kHeaderSize = (sizeof(Header) + kAlign - 1) / kAlign * kAlign;
+
+    template <typename Command>
+    static void invoke(const void* command, CommandContext& context) {
+        Command::execute(*static_cast<const Command*>(command), context);
+    }
+
+    std::size_t reserve(std::size_t commandBytes);
+
+    std::vector<Entry> entries_;
+    std::vector<Entry> scratch_;           // radix sort ping-pong buffer
+    std::vector<unsigned char> arena_;     // Header + command, kAlign-aligned records
+};
+
+// CommandRecorder
+// ---------------
+// Commands recorded by several threads at once: one CommandBucket per thread of a
+// JobSystem, each filled only by its own thread (no locks, no shared arena), then
+// gathered on the GL thread, which alone sorts and executes them:
+//
+//     recorder.clear();
+//     jobs.parallelFor(views, 1, [&](std::size_t begin, std::size_t end) {
+//         for (std::size_t v = begin; v < end; ++v) record(v, recorder.local());
+//     });
+//     recorder.gatherInto(bucket);     // then bucket.sort(), bucket.execute(context)
+//
+// Commands only carry pointers and values, so recording one touches no GL: a job builds
+// its part of the draw list, the context stays with the thread that replays it. The
+// gathered order is thread by thread, so commands with equal keys keep their order only
+// if one job submitted them (give each job whole views, whose keys differ by view).
+class CommandRecorder {
+public:
+    // One bucket per thread of `jobs`, which must outlive the recorder.
+    void init(JobSystem& jobs);
+    void clear();
+
+    // The calling thread's bucket (a thread of the JobSystem: a job, or whoever waits).
+    CommandBucket& local();
+    // Appends every thread's commands to `bucket`. After the recording jobs finished.
+    void gatherInto(CommandBucket& bucket) const;
+
+private:
+    JobSystem* jobs_ = nullptr;
+    std::vector<CommandBucket> buckets_;
+};
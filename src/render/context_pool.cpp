@@ -0,0 +1,104 @@
+#include "render/context_pool.h"
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <chrono>
+#include <iostream>
+#include <utility>
+
+#include "profile/trace.h"
+#include "render/gl_resource.h"
+#include "render/gl_state.h"
+
+int ContextPool::start(GLFWwindow* share, int contexts) {
+    stop();
+    // The game's context's version and profile, in a window that is never shown.
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, glfwGetWindowAttrib(share, GLFW_CONTEXT_VERSION_MAJOR));
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, glfwGetWindowAttrib(share, GLFW_CONTEXT_VERSION_MINOR));
+    glfwWindowHint(GLFW_OPENGL_PROFILE, glfwGetWindowAttrib(share, GLFW_OPENGL_PROFILE));
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    for (int i = 0; i < contexts; ++i) {
+        GLFWwindow* window = glfwCreateWindow(1, 1, "context pool", nullptr, share);
+        if (!window) {
+            std::cerr << "Context pool: " << i << " of " << contexts << " shared contexts created\n";
+            break;
+        }
+        workers_.push_back(Worker{window, {}});
+    }
+    glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+    stopping_ = false;
+    for (int i = 0; i < size(); ++i) {
+        workers_[i].thread = std::thread(&ContextPool::threadMain, this, i);
+    }
+    return size();
+}
+
+void ContextPool::stop(const Job& teardown) {
+    if (workers_.empty()) {
+        return;
+    }
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        teardown_ = teardown;
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (Worker& worker : workers_) {
+        worker.thread.join();
+        glfwDestroyWindow(worker.window);
+    }
+    workers_.clear();
+    teardown_ = nullptr;
+}
+
+void ContextPool::submit(Job job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(std::move(job));
+    }
+    wake_.notify_one();
+}
+
+void ContextPool::wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_.wait(lock, [this] { return queue_.empty() && running_ == 0; });
+}
+
+ContextPool::Stats ContextPool::stats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void ContextPool::threadMain(int index) {
+    trace::setThreadName("context pool");
+    glfwMakeContextCurrent(workers_[index].window);
+    glresource::setImmediate(true);
+    glstate::invalidate();
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        wake_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+        if (queue_.empty()) {
+            break;                     // stopping, and nothing left
+        }
+        Job job = std::move(queue_.front());
+        queue_.pop_front();
+        ++running_;
+        lock.unlock();
+        const auto start = std::chrono::steady_clock::now();
+        job(index);
+        const std::chrono::duration<double, std::milli> busy = std::chrono::steady_clock::now() - start;
+        lock.lock();
+        --running_;
+        ++stats_.jobs;
+        stats_.busyMs += busy.count();
+        idle_.notify_all();
+    }
+    lock.unlock();
+    if (teardown_) {
+        teardown_(index);
+    }
+    glFinish();                        // nothing of this context still in flight
+    glresource::setImmediate(false);
+    glfwMakeContextCurrent(nullptr);
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct GLFWwindow;
+
+// ContextPool
+// -----------
+// Hidden GL contexts that share the game's objects, each current on a thread of its own,
+// taking jobs from one queue: several independent renders (a thumbnail per level,
+// --thumbnails) in flight at once in one process, instead of a process per render paying
+// for the window, the shader compiles and the atlas upload each time.
+//
+// | Shared with the game's context         | Each pool context's own                      |
+// | -------------------------------------- | -------------------------------------------- |
+// | programs (compiled and linked once),   | VAOs and framebuffers (container objects:    |
+// | textures (the sprite atlas and array), | never shared), the binding points, the bind  |
+// | buffers                                | cache (render/gl_state.h)                    |
+//
+// A job runs with its worker's context current and is handed the worker's index, so
+// the caller can keep per-context state (an offscreen target, a VAO cache) in an array
+// of its own. Handles a worker drops are deleted in its context right away
+// (glresource::setImmediate): nothing of a pool context goes through the game's deletion
+// queue. A job must not touch shared objects' state (a program's uniforms) the others
+// draw with: set it before start().
+//
+// start() and stop() on the main thread (GLFW creates and destroys windows only there),
+// with the game's context current. The drivers serialize some of the submission, so the
+// gain is the CPU side of each render (baking, readback, encoding) overlapping the
+// others' GPU work, not a multiple of the GPU.
+class ContextPool {
+public:
+    using Job = std::function<void(int worker)>;
+
+    struct Stats {
+        std::uint64_t jobs = 0;        // finished
+        double busyMs = 0.0;           // summed over the workers
+    };
+
+    ContextPool() = default;
+    ~ContextPool() { stop(); }
+    ContextPool(const ContextPool&) = delete;
+    ContextPool& operator=(const ContextPool&) = delete;
+
+    // Up to `contexts` hidden windows sharing `share`'s objects, a thread each. Returns
+    // how many were created (0: none, the driver refused).
+    int start(GLFWwindow* share, int contexts);
+    // Waits for the queue, runs `teardown` once on each worker (its context current, for
+    // the per-context state), joins the threads and destroys the windows.
+    void stop(const Job& teardown = {});
+
+    void submit(Job job);
+    // Until every submitted job has finished.
+    void wait();
+
+    int size() const { return static_cast<int>(workers_.size()); }
+    Stats stats();
+
+private:
+    struct Worker {
+        GLFWwindow* window = nullptr;
+        std::thread thread;
+    };
+
+    void threadMain(int index);
+
+    std::vector<Worker> workers_;
+    std::mutex mutex_;
+    std::condition_variable wake_;     // a job, or stopping
+    std::condition_variable idle_;     // a job finished
+    std::deque<Job> queue_;
+    int running_ = 0;
+    bool stopping_ = false;
+    Job teardown_;
+    Stats stats_;
+};
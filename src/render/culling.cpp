@@ -0,0 +1,129 @@
+#include "render/culling.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "render/camera.h"
+
+CullRect visibleRect(Camera& camera) {
+    if (camera.orthographic()) {
+        // NDC corners (±1, ±1) through the inverse scale + offset; a negative scale
+        // would swap them, hence min/max.
+        const Ortho2D inverse = camera.inverseOrtho();
+        const glm::vec2 a = inverse.apply(glm::vec2(-1.0f));
+        const glm::vec2 b = inverse.apply(glm::vec2(1.0f));
+        return CullRect{glm::min(a, b), glm::max(a, b)};
+    }
+    const glm::mat4& inverse = camera.inverseViewProjection();
+    const glm::vec2 corners[4] = {{-1.0f, -1.0f}, {1.0f, -1.0f}, {-1.0f, 1.0f}, {1.0f, 1.0f}};
+
+    CullRect rect{glm::vec2(1e30f), glm::vec2(-1e30f)};
+    for (const glm::vec2& ndc : corners) {
+        // Ray through this corner: from the near plane (z = -1) to the far plane (z = 1).
+        glm::vec4 nearPoint = inverse * glm::vec4(ndc, -1.0f, 1.0f);
+        glm::vec4 farPoint = inverse * glm::vec4(ndc, 1.0f, 1.0f);
+        glm::vec3 a = glm::vec3(nearPoint) / nearPoint.w;
+        glm::vec3 b = glm::vec3(farPoint) / farPoint.w;
+
+        // Where it crosses z = 0. Orthographic rays are parallel to z, so any point on
+        // them will do (a.z == b.z would divide by zero).
+        glm::vec2 hit;
+        if (std::fabs(b.z - a.z) < 1e-6f) {
+            hit = glm::vec2(a);
+        } else {
+            const float t = a.z / (a.z - b.z);
+            hit = glm::vec2(a + (b - a) * t);
+        }
+        rect.min = glm::min(rect.min, hit);
+        rect.max = glm::max(rect.max, hit);
+    }
+    return rect;
+}
+
+namespace {
+
+constexpr float kSqrt2 = 1.41421356f;
+
+std::size_t cullScalar(const Transforms2D& t, std::size_t begin, std::size_t end, float halfExtent,
+                       const CullRect& rect, std::uint32_t* visible) {
+    std::size_t count = 0;
+    for (std::size_t i = begin; i < end; ++i) {
+        const float radius = halfExtent * kSqrt2 *
+                             std::max(std::fabs(t.scaleX[i]), std::fabs(t.scaleY[i]));
+        if (rect.contains(glm::vec2(t.x[i], t.y[i]), radius)) {
+            visible[count++] = static_cast<std::uint32_t>(i);
+        }
+    }
+    return count;
+}
+
+} // namespace
+
+std::size_t cullTransforms(const Transforms2D& transforms, float localHalfExtent,
+                           const CullRect& rect, std::uint32_t* visible) {
+    return cullTransforms(transforms, 0, transforms.size(), localHalfExtent, rect, visible);
+}
+
+std::size_t cullTransforms(const Transforms2D& transforms, std::size_t first, std::size_t count,
+                           float localHalfExtent, const CullRect& rect, std::uint32_t* visible) {
+    const std::size_t n = first + count;
+    std::size_t written = 0;
+    std::size_t i = first;
+#if defined(__SSE2__)
+    const __m128 minX = _mm_set1_ps(rect.min.x), maxX = _mm_set1_ps(rect.max.x);
+    const __m128 minY = _mm_set1_ps(rect.min.y), maxY = _mm_set1_ps(rect.max.y);
+    const __m128 radiusScale = _mm_set1_ps(localHalfExtent * kSqrt2);
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+
+    for (; i + 4 <= n; i += 4) {
+        const __m128 sx = _mm_and_ps(_mm_loadu_ps(&transforms.scaleX[i]), absMask);
+        const __m128 sy = _mm_and_ps(_mm_loadu_ps(&transforms.scaleY[i]), absMask);
+        const __m128 r = _mm_mul_ps(_mm_max_ps(sx, sy), radiusScale);
+        const __m128 x = _mm_loadu_ps(&transforms.x[i]);
+        const __m128 y = _mm_loadu_ps(&transforms.y[i]);
+
+        // Overlap on both axes: x + r >= minX, x - r <= maxX, same for y.
+        __m128 in = _mm_and_ps(_mm_cmpge_ps(_mm_add_ps(x, r), minX), _mm_cmple_ps(_mm_sub_ps(x, r), maxX));
+        in = _mm_and_ps(in, _mm_cmpge_ps(_mm_add_ps(y, r), minY));
+        in = _mm_and_ps(in, _mm_cmple_ps(_mm_sub_ps(y, r), maxY));
+
+        int mask = _mm_movemask_ps(in);
+        while (mask) {
+            const int lane = __builtin_ctz(mask); // lowest set bit = next visible lane
+            visible[written++] = static_cast<std::uint32_t>(i + lane);
+            mask &= mask - 1;
+        }
+    }
+#endif
+    return written + cullScalar(transforms, i, n, localHalfExtent, rect, visible + written);
+}
+
+void gatherTransforms(const Transforms2D& transforms, const std::uint32_t* indices,
+                      std::size_t count, Transforms2D& out) {
+    out.resize(count);
+    gatherTransforms(transforms, indices, count, out, 0);
+}
+
+void gatherTransforms(const Transforms2D& transforms, const std::uint32_t* indices,
+                      std::size_t count, Transforms2D& out, std::size_t outFirst) {
+    for (std::size_t k = 0; k < count; ++k) {
+        const std::uint32_t i = indices[k];
+        out.x[outFirst + k] = transforms.x[i];
+        out.y[outFirst + k] = transforms.y[i];
+        out.rotation[outFirst + k] = transforms.rotation[i];
+        out.scaleX[outFirst + k] = transforms.scaleX[i];
+        out.scaleY[outFirst + k] = transforms.scaleY[i];
+    }
+}
+
+void transformBounds(const Transforms2D& transforms, float localHalfExtent, Aabb* out) {
+    for (std::size_t i = 0; i < transforms.size(); ++i) {
+        const float radius = localHalfExtent * kSqrt2 *
+                             std::max(std::fabs(transforms.scaleX[i]), std::fabs(transforms.scaleY[i]));
+        out[i] = Aabb::around(glm::vec2(transforms.x[i], transforms.y[i]), radius);
+    }
+}
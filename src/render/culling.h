@@ -0,0 +1,69 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+
+#include "core/batch_transform.h"
+#include "core/spatial_index.h"
+
+class Camera;
+
+// CullRect
+// --------
+// The part of the z = 0 plane (where every object in this game lives) that the camera
+// can see, as a world-space axis-aligned rectangle.
+//
+// | Projection   | Visible region on z = 0                                          |
+// | ------------ | ---------------------------------------------------------------- |
+// | Orthographic | exactly position ± (aspect, 1)                                   |
+// | Perspective  | the frustum's cross-section with the plane (a rect for the       |
+// |              | straight-down lookAt used here; its bounding box in general)     |
+//
+// Both come out of the same computation: the four NDC corner rays are unprojected with
+// the inverse view-projection and intersected with z = 0. Because everything is flat,
+// testing against this rectangle IS the frustum test—near/far never cut the plane.
+struct CullRect {
+    glm::vec2 min;
+    glm::vec2 max;
+
+    bool contains(const glm::vec2& p, float radius) const {
+        return p.x + radius >= min.x && p.x - radius <= max.x &&
+               p.y + radius >= min.y && p.y - radius <= max.y;
+    }
+};
+
+CullRect visibleRect(Camera& camera);
+
+// cullTransforms
+// --------------
+// Writes the indices of the objects whose bounding circle touches `rect` to `visible`
+// (room for transforms.size() entries) and returns how many there are.
+//
+// Each object is the unit quad of main() (local half extent `localHalfExtent`, 0.25)
+// scaled by scaleX/scaleY and rotated. A circle of radius
+//     localHalfExtent * max(|scaleX|, |scaleY|) * sqrt(2)
+// contains it at any rotation, so no sin/cos is needed to cull.
+//
+// SSE2: four objects per iteration; the four results become a 4-bit mask
+// (_mm_movemask_ps) and fully hidden groups—the common case when scrolling a large
+// level—cost a single branch.
+std::size_t cullTransforms(const Transforms2D& transforms, float localHalfExtent,
+                           const CullRect& rect, std::uint32_t* visible);
+// Objects [first, first + count) only; `visible` has room for count entries and receives
+// absolute indices. Disjoint ranges can be culled on different threads.
+std::size_t cullTransforms(const Transforms2D& transforms, std::size_t first, std::size_t count,
+                           float localHalfExtent, const CullRect& rect, std::uint32_t* visible);
+
+// Copies the listed objects into `out` (resized to count), ready for composeModelMatrices /
+// composeAffine2D, so only visible instances reach the renderer.
+void gatherTransforms(const Transforms2D& transforms, const std::uint32_t* indices,
+                      std::size_t count, Transforms2D& out);
+// Writes to out[outFirst, outFirst + count) without resizing `out` (it must be big
+// enough), so several threads can fill disjoint parts of one output.
+void gatherTransforms(const Transforms2D& transforms, const std::uint32_t* indices,
+                      std::size_t count, Transforms2D& out, std::size_t outFirst);
+
+// Bounding box of each object's bounding circle (the same circle cullTransforms uses),
+// for feeding a SpatialIndex: out[i] covers object i. `out` has room for size() boxes.
+void transformBounds(const Transforms2D& transforms, float localHalfExtent, Aabb* out);
@@ -0,0 +1,167 @@
+#include "render/debug_draw.h"
+
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#include "render/gl_state.h"
+#include "render/gpu_memory.h"
+#include "render/vertex_layout.h"
+
+#if DEBUG_DRAW
+
+namespace {
+
+// shaders/debug_vertex.glsl: aPos (0), aColor (1).
+namespace input = shaderlayout::debug_vertex;
+
+const VertexLayout kVertexLayout(sizeof(DebugVertex), {
+    shaderInput(input::aPos, 2, GL_FLOAT, VertexAttribute::Kind::Float, offsetof(DebugVertex, pos)),
+    shaderInput(input::aColor, 4, GL_UNSIGNED_BYTE, VertexAttribute::Kind::Normalized, offsetof(DebugVertex, color)),
+});
+
+} // namespace
+
+void DebugDrawList::line(const glm::vec2& a, const glm::vec2& b, std::uint32_t color) {
+    lines_.push_back({a, color});
+    lines_.push_back({b, color});
+}
+
+void DebugDrawList::rect(const glm::vec2& min, const glm::vec2& max, std::uint32_t color) {
+    const glm::vec2 corners[4] = {min, glm::vec2(max.x, min.y), max, glm::vec2(min.x, max.y)};
+    for (int i = 0; i < 4; ++i) {
+        line(corners[i], corners[(i + 1) % 4], color);
+    }
+}
+
+void DebugDrawList::rectFilled(const glm::vec2& min, const glm::vec2& max, std::uint32_t color) {
+    const DebugVertex a{min, color}, b{glm::vec2(max.x, min.y), color}, c{max, color},
+                      d{glm::vec2(min.x, max.y), color};
+    triangles_.insert(triangles_.end(), {a, b, c, c, d, a});
+}
+
+void DebugDrawList::circle(const glm::vec2& center, float radius, std::uint32_t color, int segments) {
+    if (segments < 3) segments = 3;
+    const float step = 6.2831853f / static_cast<float>(segments);
+    glm::vec2 previous = center + glm::vec2(radius, 0.0f);
+    for (int i = 1; i <= segments; ++i) {
+        const float angle = step * static_cast<float>(i);
+        const glm::vec2 next = center + radius * glm::vec2(std::cos(angle), std::sin(angle));
+        line(previous, next, color);
+        previous = next;
+    }
+}
+
+void DebugDrawList::circleFilled(const glm::vec2& center, float radius, std::uint32_t color, int segments) {
+    if (segments < 3) segments = 3;
+    const float step = 6.2831853f / static_cast<float>(segments);
+    glm::vec2 previous = center + glm::vec2(radius, 0.0f);
+    for (int i = 1; i <= segments; ++i) {
+        const float angle = step * static_cast<float>(i);
+        const glm::vec2 next = center + radius * glm::vec2(std::cos(angle), std::sin(angle));
+        triangles_.insert(triangles_.end(), {DebugVertex{center, color}, DebugVertex{previous, color},
+                                             DebugVertex{next, color}});
+        previous = next;
+    }
+}
+
+void DebugDrawList::cross(const glm::vec2& center, float halfSize, std::uint32_t color) {
+    line(center - glm::vec2(halfSize, 0.0f), center + glm::vec2(halfSize, 0.0f), color);
+    line(center - glm::vec2(0.0f, halfSize), center + glm::vec2(0.0f, halfSize), color);
+}
+
+bool DebugDrawRenderer::init(std::size_t initialVertices) {
+    shutdown();
+    vao_ = GlVertexArray::create();    // attributes set by reserve(), once per new buffer
+    if (!reserve(initialVertices > 0 ? initialVertices : 1)) {
+        std::cerr << "DebugDrawRenderer: failed to create vertex stream\n";
+        return false;
+    }
+    return true;
+}
+
+void DebugDrawRenderer::shutdown() {
+    stream_.shutdown();
+    vao_.reset();
+    capacity_ = 0;
+}
+
+// Doubles until `vertices` fit in one segment; the attributes point into the new buffer.
+bool DebugDrawRenderer::reserve(std::size_t vertices) {
+    const gpumemory::Owner owner("debug draw");
+    if (vertices <= capacity_) {
+        return true;
+    }
+    std::size_t newCapacity = capacity_ > 0 ? capacity_ : 1;
+    while (newCapacity < vertices) {
+        newCapacity *= 2;
+    }
+    stream_.shutdown();
+    capacity_ = 0;
+    // A whole number of vertices per segment, so every allocation starts on a vertex.
+    if (!stream_.init(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(newCapacity * sizeof(DebugVertex)))) {
+        return false;
+    }
+    capacity_ = newCapacity;
+
+    glstate::bindVertexArray(vao_.get());
+    glstate::bindBuffer(GL_ARRAY_BUFFER, stream_.buffer());
+    kVertexLayout.enable();
+    glstate::bindVertexArray(0);
+    return true;
+}
+
+std::size_t DebugDrawRenderer::draw(const DebugVertex* lines, std::size_t lineVertices,
+                                    const DebugVertex* triangles, std::size_t triangleVertices) {
+    lineVertices -= lineVertices % 2;
+    triangleVertices -= triangleVertices % 3;
+    const std::size_t total = lineVertices + triangleVertices;
+    if (capacity_ == 0 || total == 0) {
+        return 0;
+    }
+    const GLsizeiptr stride = sizeof(DebugVertex);
+    StreamAllocation allocation = stream_.allocate(static_cast<GLsizeiptr>(total) * stride, stride);
+    if (!allocation.valid()) {
+        // More shapes than last time: grow (rare, the capacity is kept) and retry.
+        if (!reserve(capacity_ * 2 > total ? capacity_ * 2 : total)) {
+            return 0;
+        }
+        allocation = stream_.allocate(static_cast<GLsizeiptr>(total) * stride, stride);
+        if (!allocation.valid()) {
+            return 0;
+        }
+    }
+    std::memcpy(allocation.ptr, lines, lineVertices * sizeof(DebugVertex));
+    std::memcpy(static_cast<char*>(allocation.ptr) + lineVertices * sizeof(DebugVertex), triangles,
+                triangleVertices * sizeof(DebugVertex));
+    stream_.commit(allocation);
+
+    const GLint first = static_cast<GLint>(allocation.offset / stride);
+    std::size_t draws = 0;
+    glstate::bindVertexArray(vao_.get());
+    if (triangleVertices > 0) {                // fills under the outlines
+        glDrawArrays(GL_TRIANGLES, first + static_cast<GLint>(lineVertices), static_cast<GLsizei>(triangleVertices));
+        ++draws;
+    }
+    if (lineVertices > 0) {
+        glDrawArrays(GL_LINES, first, static_cast<GLsizei>(lineVertices));
+        ++draws;
+    }
+    return draws;
+}
+
+void DebugDrawRenderer::endFrame() {
+    if (capacity_ > 0) {
+        stream_.endFrame();
+    }
+}
+
+#else // DEBUG_DRAW
+
+bool DebugDrawRenderer::init(std::size_t) { return false; }
+void DebugDrawRenderer::shutdown() {}
+bool DebugDrawRenderer::reserve(std::size_t) { return false; }
+std::size_t DebugDrawRenderer::draw(const DebugVertex*, std::size_t, const DebugVertex*, std::size_t) { return 0; }
+void DebugDrawRenderer::endFrame() {}
+
+#endif // DEBUG_DRAW
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "render/gl_resource.h"
+#include "render/stream_buffer.h"
+
+// DEBUG_DRAW
+// ----------
+// On unless NDEBUG (so off in the release and pgo configurations); `make DEBUG_DRAW=1`
+// or `=0` overrides it. Off, every DebugDrawList call below is an empty inline function
+// and DebugDrawRenderer creates nothing, so shipping builds pay for neither the vertices
+// nor the draws. Callers that loop to produce shapes test debugdraw::enabled() first:
+// it is constexpr, so the whole loop is compiled out with it.
+#ifndef DEBUG_DRAW
+#if defined(NDEBUG)
+#define DEBUG_DRAW 0
+#else
+#define DEBUG_DRAW 1
+#endif
+#endif
+
+namespace debugdraw {
+constexpr bool enabled() { return DEBUG_DRAW != 0; }
+} // namespace debugdraw
+
+// One end of a line or corner of a triangle, in world space. 12 bytes.
+//
+// | Location | Field | Format                        |
+// | -------- | ----- | ----------------------------- |
+// | 0        | pos   | 2 x float                     |
+// | 1        | color | 4 x unsigned byte, normalized |
+struct DebugVertex {
+    glm::vec2 pos;
+    std::uint32_t color;               // packColor (render/sprite_batch.h)
+};
+static_assert(sizeof(DebugVertex) == 12, "DebugVertex must stay tightly packed (vertex attribute stride)");
+
+// DebugDrawList
+// -------------
+// Immediate-mode debug shapes: call it from anywhere during the frame, everything is
+// turned into vertices right away and kept in two arrays until clear():
+//
+// | Call                      | Becomes                                  |
+// | ------------------------- | ---------------------------------------- |
+// | line, rect, circle, cross | GL_LINES vertices (2 per segment)        |
+// | rectFilled, circleFilled  | GL_TRIANGLES vertices (3 per triangle)   |
+//
+// However many shapes there are, DebugDrawRenderer draws them with at most two calls.
+// The arrays keep their capacity, so a steady number of shapes allocates nothing.
+// Not thread-safe: one list per thread that draws.
+class DebugDrawList {
+public:
+#if DEBUG_DRAW
+    void line(const glm::vec2& a, const glm::vec2& b, std::uint32_t color);
+    void rect(const glm::vec2& min, const glm::vec2& max, std::uint32_t color);
+    void rectFilled(const glm::vec2& min, const glm::vec2& max, std::uint32_t color);
+    void circle(const glm::vec2& center, float radius, std::uint32_t color, int segments = 24);
+    void circleFilled(const glm::vec2& center, float radius, std::uint32_t color, int segments = 24);
+    void cross(const glm::vec2& center, float halfSize, std::uint32_t color);
+    void clear() { lines_.clear(); triangles_.clear(); }
+#else
+    void line(const glm::vec2&, const glm::vec2&, std::uint32_t) {}
+    void rect(const glm::vec2&, const glm::vec2&, std::uint32_t) {}
+    void rectFilled(const glm::vec2&, const glm::vec2&, std::uint32_t) {}
+    void circle(const glm::vec2&, float, std::uint32_t, int = 24) {}
+    void circleFilled(const glm::vec2&, float, std::uint32_t, int = 24) {}
+    void cross(const glm::vec2&, float, std::uint32_t) {}
+    void clear() {}
+#endif
+
+    const std::vector<DebugVertex>& lines() const { return lines_; }
+    const std::vector<DebugVertex>& triangles() const { return triangles_; }
+
+private:
+    std::vector<DebugVertex> lines_;
+    std::vector<DebugVertex> triangles_;
+};
+
+// DebugDrawRenderer
+// -----------------
+// Draws a frame's debug vertices from one StreamBuffer: both arrays are copied into one
+// allocation, then one glDrawArrays(GL_LINES) and one glDrawArrays(GL_TRIANGLES) read it.
+// The attributes are recorded once at offset 0 and each draw starts at its vertex index
+// in the buffer (the segments are a whole number of vertices), so nothing is re-pointed
+// per frame. Drawn with shaders/debug_vertex.glsl + fragment.glsl built with VERTEX_COLOR.
+class DebugDrawRenderer {
+public:
+    // GL thread. False (and nothing created) when DEBUG_DRAW is 0.
+    bool init(std::size_t initialVertices = 4096);
+    void shutdown();
+
+    // GL thread, program bound: the draws issued (0..2). The stream grows if needed.
+    std::size_t draw(const DebugVertex* lines, std::size_t lineVertices,
+                     const DebugVertex* triangles, std::size_t triangleVertices);
+    void endFrame();
+
+private:
+    bool reserve(std::size_t vertices);
+
+    GlVertexArray vao_;
+    StreamBuffer stream_;
+    std::size_t capacity_ = 0;         // vertices one stream segment holds
+};
@@ -0,0 +1,50 @@
+#include "render/dynamic_resolution.h"
+
+#include <algorithm>
+#include <cmath>
+
+void DynamicResolution::init(const Settings& settings) {
+    settings_ = settings;
+    settings_.minScale = std::min(settings_.minScale, settings_.maxScale);
+    settings_.step = std::max(settings_.step, 1.0f / 256.0f);
+    stats_ = Stats{};
+    scale_ = settings_.maxScale;    // start sharp; the first slow frames bring it down
+    smoothed_ = 0.0;
+    settle_ = kSettleFrames;        // the first frames pay for shader compiles and uploads
+}
+
+bool DynamicResolution::update(double gpuMs) {
+    if (settle_ > 0) {
+        --settle_;                  // still frames drawn before the last change
+        return false;
+    }
+    if (gpuMs <= 0.0) {
+        return false;               // no sample resolved yet
+    }
+    smoothed_ = smoothed_ == 0.0 ? gpuMs : smoothed_ + kSmoothing * (gpuMs - smoothed_);
+    stats_.smoothedMs = smoothed_;
+
+    float next = scale_;
+    if (smoothed_ > settings_.targetMs) {
+        next = quantize(scale_ * static_cast<float>(std::sqrt(settings_.targetMs * kHeadroom / smoothed_)));
+        if (next == scale_) {
+            next = quantize(scale_ - settings_.step);   // rounding kept it: at least one step
+        }
+    } else if (smoothed_ < settings_.targetMs * kRaiseBelow) {
+        next = quantize(scale_ + settings_.step);
+    }
+    if (next == scale_) {
+        return false;
+    }
+    ++(next < scale_ ? stats_.lowered : stats_.raised);
+    scale_ = next;
+    smoothed_ = 0.0;                // the old scale's average says nothing about the new one
+    settle_ = kSettleFrames;
+    return true;
+}
+
+float DynamicResolution::quantize(float scale) const {
+    // Down to a multiple of the step, so that equal scales are bit-equal.
+    const float stepped = std::floor(scale / settings_.step + 1e-3f) * settings_.step;
+    return std::min(settings_.maxScale, std::max(settings_.minScale, stepped));
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+
+// DynamicResolution
+// -----------------
+// Picks the scene's render scale (render/render_target.h) each frame so that the GPU
+// frame time stays within a budget: under load the world is drawn at fewer pixels and
+// upscaled, and when the load goes away it climbs back to full resolution. The input
+// is the render profiler's GPU frame time (Profiler::gpuFrame()), one sample a frame.
+//
+// | Smoothed GPU time          | Action                                               |
+// | -------------------------- | ---------------------------------------------------- |
+// | > target                   | down at once, by sqrt(target * kHeadroom / time):    |
+// |                            | the pixel count (scale squared) is what costs        |
+// | < target * kRaiseBelow     | up one step                                          |
+// | in between                 | stay                                                 |
+//
+// The scale moves in multiples of `step` only, so the scene target comes in a handful
+// of sizes that the RenderTargetPool can keep instead of a new size every frame; and
+// after a change it waits kSettleFrames before judging again. GPU times come back
+// Profiler::kLatency frames late: without the wait, the frames still drawn at the OLD
+// scale would push it further the same way (and it would oscillate). Going down is
+// quick and going up is one step at a time, so a spike costs a few blurry frames
+// rather than a few slow ones.
+//
+// Usage (render thread):
+//     dynamicResolution.init(settings);
+//     ... draw the scene at dynamicResolution.scale() ...
+//     renderProfiler.endFrame();
+//     dynamicResolution.update(renderProfiler.gpuFrame().last());
+class DynamicResolution {
+public:
+    static constexpr int kSettleFrames = 8;        // after a change; > Profiler::kLatency
+    static constexpr double kSmoothing = 0.2;      // exponential moving average weight
+    static constexpr double kHeadroom = 0.9;       // aim a little under the target when going down
+    static constexpr double kRaiseBelow = 0.75;
+
+    struct Settings {
+        double targetMs = 14.0;        // GPU budget: leaves room in a 60 Hz frame (16.7 ms)
+        float minScale = 0.5f;
+        float maxScale = 1.0f;
+        float step = 1.0f / 16.0f;
+    };
+
+    struct Stats {
+        double smoothedMs = 0.0;       // what the last decision was based on
+        std::uint64_t lowered = 0;     // changes since init
+        std::uint64_t raised = 0;
+    };
+
+    void init(const Settings& settings);
+
+    // One GPU frame time (ms). Returns true if scale() changed.
+    bool update(double gpuMs);
+
+    float scale() const { return scale_; }
+    const Settings& settings() const { return settings_; }
+    const Stats& stats() const { return stats_; }
+
+private:
+    float quantize(float scale) const;
+
+    Settings settings_;
+    Stats stats_;
+    float scale_ = 1.0f;
+    double smoothed_ = 0.0;            // 0: reseed from the next sample
+    int settle_ = 0;
+};
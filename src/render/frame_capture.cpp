@@ -0,0 +1,252 @@
+#include "render/frame_capture.h"
+
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+#include "render/gl_state.h"
+#include "render/gl_stall.h"
+#include "render/gpu_memory.h"
+
+bool FrameCapture::parse(const char* text, Format& format) {
+    if (std::strcmp(text, "png") == 0) {
+        format = Format::Png;
+    } else if (std::strcmp(text, "raw") == 0) {
+        format = Format::Raw;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool FrameCapture::init(const Settings& settings) {
+    shutdown();
+    settings_ = settings;
+    settings_.every = settings.every < 1 ? 1 : settings.every;
+    if (!settings_.pipe.empty()) {
+        settings_.format = Format::Raw;
+        // An encoder that exits early must fail the writes, not kill the game.
+        std::signal(SIGPIPE, SIG_IGN);
+        pipe_ = popen(settings_.pipe.c_str(), "w");
+        if (!pipe_) {
+            std::cerr << "Capture: can't start " << settings_.pipe << "\n";
+            return false;
+        }
+    } else {
+        std::error_code ec;
+        std::filesystem::create_directories(settings_.directory, ec);
+        if (ec) {
+            std::cerr << "Capture: can't create " << settings_.directory << ": " << ec.message() << "\n";
+            return false;
+        }
+    }
+    for (Slot& slot : slots_) {
+        slot = Slot{};
+    }
+    next_ = 0;
+    frame_ = captured_ = waits_ = dropped_ = 0;
+    written_ = failed_ = bytes_ = stalls_ = 0;
+    stopping_ = false;
+    writer_ = std::thread(&FrameCapture::writerLoop, this);
+    return true;
+}
+
+void FrameCapture::shutdown() {
+    if (!writer_.joinable()) {
+        return;
+    }
+    // Oldest first, so the files still come out in frame order.
+    for (int i = 0; i < kSlots; ++i) {
+        collect(slots_[(next_ + i) % kSlots], true);
+    }
+    for (Slot& slot : slots_) {
+        slot.buffer.reset();           // queued (render/gl_resource.h)
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    writer_.join();                    // after it has written everything queued
+    queue_.clear();
+    free_.clear();
+    if (pipe_) {
+        const int status = pclose(pipe_);  // the encoder finishes the file
+        pipe_ = nullptr;
+        if (status != 0) {
+            std::cerr << "Capture: " << settings_.pipe << " exited with status " << status << "\n";
+        }
+    }
+}
+
+void FrameCapture::capture(int width, int height) {
+    const gpumemory::Owner owner("frame capture");
+    if (!enabled()) {
+        return;
+    }
+    // Everything whose fence has passed, oldest first.
+    for (int i = 0; i < kSlots; ++i) {
+        Slot& slot = slots_[(next_ + i) % kSlots];
+        if (slot.fence && glClientWaitSync(slot.fence, 0, 0) != GL_TIMEOUT_EXPIRED) {
+            collect(slot, false);
+        }
+    }
+    const std::uint64_t frame = frame_++;
+    if (frame % static_cast<std::uint64_t>(settings_.every) != 0 ||
+        (settings_.limit > 0 && captured_ >= settings_.limit) || width <= 0 || height <= 0) {
+        return;
+    }
+
+    Slot& slot = slots_[next_];
+    if (slot.fence) {
+        ++waits_;
+        collect(slot, true);           // kSlots frames old: the GPU is far behind
+    }
+    next_ = (next_ + 1) % kSlots;
+    const std::size_t bytes = static_cast<std::size_t>(width) * static_cast<std::size_t>(height) * 4;
+    if (!slot.buffer || slot.capacity < bytes) {
+        slot.buffer = GlBuffer::create();
+        glstate::bindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer.get());
+        glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(bytes), nullptr, GL_STREAM_READ);
+        gpumemory::trackBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer.get(), bytes);
+        slot.capacity = bytes;
+    } else {
+        glstate::bindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer.get());
+    }
+    glstate::bindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    glReadBuffer(GL_BACK);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    {
+        const glstall::Wait wait("frame capture readback");
+        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    }
+    glstate::bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.width = width;
+    slot.height = height;
+    slot.frame = frame;
+    ++captured_;
+}
+
+void FrameCapture::collect(Slot& slot, bool wait) {
+    if (!slot.fence) {
+        return;
+    }
+    if (wait) {
+        const glstall::Wait stall("frame capture fence");
+        while (glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED) {
+        }
+    }
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+
+    Job job;
+    job.frame = slot.frame;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (queue_.size() >= kMaxQueued && settings_.wait) {
+            ++stalls_;                 // the disk or the encoder, not the GPU
+            room_.wait(lock, [this] { return queue_.size() < kMaxQueued; });
+        }
+        if (queue_.size() >= kMaxQueued) {
+            ++dropped_;
+            return;
+        }
+        if (!free_.empty()) {
+            job.image = std::move(free_.back());
+            free_.pop_back();
+        }
+    }
+    job.image.width = slot.width;
+    job.image.height = slot.height;
+    job.image.pixels.resize(static_cast<std::size_t>(slot.width) * static_cast<std::size_t>(slot.height));
+    glstate::bindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer.get());
+    const void* pixels = nullptr;
+    {
+        const glstall::Wait stall("frame capture map");
+        pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(job.image.bytes()),
+                                  GL_MAP_READ_BIT);
+    }
+    if (pixels) {
+        std::memcpy(job.image.pixels.data(), pixels, job.image.bytes());
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glstate::bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pixels) {
+            queue_.push_back(std::move(job));
+        } else {
+            ++failed_;
+            free_.push_back(std::move(job.image));
+        }
+    }
+    wake_.notify_one();
+}
+
+FrameCapture::Stats FrameCapture::stats() const {
+    Stats s;
+    s.captured = captured_;
+    s.waits = waits_;
+    std::lock_guard<std::mutex> lock(mutex_);
+    s.dropped = dropped_;
+    s.written = written_;
+    s.failed = failed_;
+    s.bytes = bytes_;
+    s.stalls = stalls_;
+    return s;
+}
+
+void FrameCapture::writerLoop() {
+    std::vector<unsigned char> scratch;    // the encoded file, reused
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        wake_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+        if (queue_.empty()) {
+            return;                        // stopping, and everything is written
+        }
+        Job job = std::move(queue_.front());
+        queue_.pop_front();
+        room_.notify_one();
+        lock.unlock();
+        const bool ok = write(job, scratch);
+        lock.lock();
+        if (ok) {
+            ++written_;
+            bytes_ += scratch.size();
+        } else {
+            ++failed_;
+        }
+        free_.push_back(std::move(job.image));
+    }
+}
+
+bool FrameCapture::write(const Job& job, std::vector<unsigned char>& scratch) {
+    char name[64];
+    std::snprintf(name, sizeof name, "frame_%06llu.%s", static_cast<unsigned long long>(job.frame),
+                  settings_.format == Format::Png ? "png" : "rgba");
+    scratch.clear();
+    if (settings_.format == Format::Png) {
+        encodePng(job.image, scratch);
+    } else {
+        // Top row first, like every video tool expects (GL's row 0 is the bottom).
+        const std::size_t rowBytes = static_cast<std::size_t>(job.image.width) * 4;
+        scratch.resize(rowBytes * static_cast<std::size_t>(job.image.height));
+        for (int y = 0; y < job.image.height; ++y) {
+            std::memcpy(scratch.data() + static_cast<std::size_t>(job.image.height - 1 - y) * rowBytes,
+                        job.image.pixels.data() + static_cast<std::size_t>(y) * job.image.width, rowBytes);
+        }
+    }
+    if (pipe_) {
+        return std::fwrite(scratch.data(), 1, scratch.size(), pipe_) == scratch.size();
+    }
+    const std::string path = settings_.directory + "/" + name;
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    const bool ok = std::fwrite(scratch.data(), 1, scratch.size(), file) == scratch.size();
+    return std::fclose(file) == 0 && ok;
+}
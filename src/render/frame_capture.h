@@ -0,0 +1,131 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "asset/image.h"
+#include "render/gl_resource.h"
+
+// FrameCapture
+// ------------
+// Every Nth finished frame to disk (--capture, --capture-dir=DIR), for visual regression runs and video,
+// without waiting for the GPU:
+//
+//     frame f:      glReadPixels(back buffer) → pixel pack buffer slot f % kSlots, fence
+//     frame f + 2:  fence passed → map the slot, copy into an Image, unmap
+//     writer thread: encode (PNG or raw), write DIR/frame_000123.png
+//
+// With a pixel pack buffer bound, glReadPixels only queues the copy and returns; the map
+// waits for nothing as long as the fence has passed, which kSlots - 1 frames later it
+// almost always has. When it hasn't (the GPU is more than two frames behind) the slot is
+// waited for rather than the frame dropped, and counted in Stats::waits.
+//
+// | Format | File                     | Notes                                            |
+// | ------ | ------------------------ | ------------------------------------------------ |
+// | png    | frame_000123.png         | stored deflate (asset/image.h): big, lossless,   |
+// |        |                          | opens anywhere                                   |
+// | raw    | frame_000123.rgba        | RGBA8 rows top first, no header: e.g. ffmpeg     |
+// |        |                          | -f rawvideo -pixel_format rgba -video_size WxH   |
+// | pipe   | none: the raw frames go  | --capture-pipe=CMD, an encoder reading stdin,    |
+// |        | to CMD's stdin, back to  | e.g. "ffmpeg -f rawvideo -pixel_format rgba      |
+// |        | back                     | -video_size WxH -framerate 60 -i - out.mp4"      |
+//
+// Images the writer hasn't got to yet queue up to kMaxQueued; beyond that frames are
+// dropped (Stats::dropped) rather than the frame thread blocked on the disk, unless
+// Settings::wait (--offline: a video with holes is no use, and nobody is watching the
+// frame rate). Finished Images go back to a free list, so steady-state capture doesn't
+// allocate.
+class FrameCapture {
+public:
+    enum class Format : std::uint8_t { Png, Raw };   // a pipe is always Raw
+
+    static constexpr int kSlots = 3;
+    static constexpr std::size_t kMaxQueued = 8;
+
+    struct Settings {
+        std::string directory = "captures";
+        Format format = Format::Png;
+        int every = 1;                 // capture one frame in this many
+        std::uint64_t limit = 0;       // stop after this many; 0: no limit
+        std::string pipe;              // an encoder command instead of the directory
+        bool wait = false;             // a full queue waits for the writer: nothing dropped
+    };
+
+    struct Stats {
+        std::uint64_t captured = 0;    // read back
+        std::uint64_t written = 0;     // on disk
+        std::uint64_t waits = 0;       // slots mapped before their fence had passed
+        std::uint64_t dropped = 0;     // writer too far behind
+        std::uint64_t stalls = 0;      // frames that waited for the writer (Settings::wait)
+        std::uint64_t failed = 0;      // couldn't be written
+        std::uint64_t bytes = 0;       // written
+    };
+
+    FrameCapture() = default;
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+    ~FrameCapture() { shutdown(); }
+
+    // "png" or "raw"; false if it is neither.
+    static bool parse(const char* text, Format& format);
+
+    // GL thread: creates the directory (or starts the encoder) and starts the writer.
+    bool init(const Settings& settings);
+    // GL thread: reads back what is still in flight, then writes everything queued (and
+    // waits for the encoder to finish).
+    void shutdown();
+
+    // GL thread, the frame finished in the default framebuffer's back buffer (before the
+    // swap): collects older slots, then queues this frame's readback if it is due.
+    void capture(int width, int height);
+
+    bool enabled() const { return writer_.joinable(); }
+    Stats stats() const;
+
+private:
+    struct Slot {
+        GlBuffer buffer;
+        std::size_t capacity = 0;
+        GLsync fence = nullptr;        // null: free
+        int width = 0, height = 0;
+        std::uint64_t frame = 0;
+    };
+    struct Job {
+        Image image;
+        std::uint64_t frame;
+    };
+
+    void collect(Slot& slot, bool wait);
+    void writerLoop();
+    bool write(const Job& job, std::vector<unsigned char>& scratch);
+
+    Settings settings_;
+    Slot slots_[kSlots];
+    int next_ = 0;                     // slot the next readback uses (the oldest)
+    std::uint64_t frame_ = 0;
+    std::uint64_t captured_ = 0;
+    std::uint64_t waits_ = 0;
+    std::uint64_t dropped_ = 0;
+
+    // Shared with the writer thread.
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable room_;     // the writer took a job (Settings::wait)
+    std::deque<Job> queue_;
+    std::vector<Image> free_;          // written Images, for reuse
+    bool stopping_ = false;
+    std::uint64_t written_ = 0;
+    std::uint64_t failed_ = 0;
+    std::uint64_t bytes_ = 0;
+    std::uint64_t stalls_ = 0;
+    std::FILE* pipe_ = nullptr;        // the encoder's stdin; the writer's only
+    std::thread writer_;
+};
@@ -0,0 +1,111 @@
+#include "render/frame_packet.h"
+
+#include <cstring>
+#include <vector>
+
+namespace {
+
+// 8 bytes at a time, multiply and fold: cheap enough to run over every instance of a
+// frame (a few GB/s), and any changed byte changes the result in practice.
+std::uint64_t mix(std::uint64_t hash, const void* data, std::size_t bytes) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    hash ^= bytes * 0x9e3779b97f4a7c15ull;
+    for (; bytes >= 8; p += 8, bytes -= 8) {
+        std::uint64_t word;
+        std::memcpy(&word, p, 8);
+        hash = (hash ^ word) * 0xff51afd7ed558ccdull;
+        hash ^= hash >> 32;
+    }
+    if (bytes > 0) {
+        std::uint64_t word = 0;
+        std::memcpy(&word, p, bytes);
+        hash = (hash ^ word) * 0xff51afd7ed558ccdull;
+        hash ^= hash >> 32;
+    }
+    return hash;
+}
+
+template <typename T>
+std::uint64_t mixValue(std::uint64_t hash, const T& value) {
+    return mix(hash, &value, sizeof(T));
+}
+
+template <typename Vector>
+std::uint64_t mixArray(std::uint64_t hash, const Vector& v) {
+    return mix(hash, v.data(), v.size() * sizeof(*v.data()));
+}
+
+} // namespace
+
+std::uint64_t FramePacket::contentHash() const {
+    std::uint64_t h = 0xcbf29ce484222325ull;
+    h = mixValue(h, viewCount);
+    for (std::uint32_t v = 0; v < viewCount; ++v) {
+        h = mixValue(h, views[v].version);
+        h = mixValue(h, views[v].rect);
+        h = mixValue(h, views[v].clear);
+    }
+    h = mixValue(h, origin);
+    h = mixValue(h, viewportWidth);
+    h = mixValue(h, viewportHeight);
+    h = mixValue(h, clearColor);
+    h = mixValue(h, vsync);
+    h = mixValue(h, sceneScale);
+    h = mixValue(h, sceneSamples);
+    h = mixValue(h, path);
+    h = mixArray(h, models);
+    h = mixArray(h, affine);
+    h = mixArray(h, colors);
+    h = mixValue(h, spriteColor);
+    h = mixArray(h, sprites);
+    h = mixArray(h, zLayers);
+    h = mixArray(h, animations);
+    if (!animations.empty()) {
+        h = mixValue(h, animationTime);
+    }
+    h = mixArray(h, skinPalette);
+    h = mixArray(h, lights);
+    h = mixArray(h, particles);
+    h = mixValue(h, particleLimit);
+    h = mixArray(h, debugLines);
+    h = mixArray(h, debugTriangles);
+    h = mixArray(h, hud);
+    h = mixArray(h, hudGraph);
+    h = mixValue(h, hudOverlay);
+    h = mixValue(h, hudWindowWidth);
+    h = mixValue(h, hudWindowHeight);
+    h = mixArray(h, uiWidgets);
+    h = mixArray(h, uiText);
+    return h;
+}
+
+bool viewsCover(const FrameView* views, std::size_t count, int width, int height) {
+    // The grid every rect edge cuts the target into: each cell is wholly inside a rect or
+    // wholly outside it, so checking one corner per cell is exact.
+    std::vector<int> xs{0, width};
+    std::vector<int> ys{0, height};
+    std::vector<glm::ivec4> rects;
+    for (std::size_t v = 0; v < count; ++v) {
+        const glm::ivec4 r = viewPixels(views[v].rect, width, height);
+        rects.push_back(r);
+        xs.push_back(std::clamp(r.x, 0, width));
+        xs.push_back(std::clamp(r.x + r.z, 0, width));
+        ys.push_back(std::clamp(r.y, 0, height));
+        ys.push_back(std::clamp(r.y + r.w, 0, height));
+    }
+    std::sort(xs.begin(), xs.end());
+    xs.erase(std::unique(xs.begin(), xs.end()), xs.end());
+    std::sort(ys.begin(), ys.end());
+    ys.erase(std::unique(ys.begin(), ys.end()), ys.end());
+    for (std::size_t i = 0; i + 1 < xs.size(); ++i) {
+        for (std::size_t j = 0; j + 1 < ys.size(); ++j) {
+            const bool covered = std::any_of(rects.begin(), rects.end(), [&](const glm::ivec4& r) {
+                return r.x <= xs[i] && r.x + r.z >= xs[i + 1] && r.y <= ys[j] && r.y + r.w >= ys[j + 1];
+            });
+            if (!covered) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
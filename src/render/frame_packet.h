@@ -0,0 +1,239 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include "core/batch_transform.h"
+#include "core/frame_pacer.h"
+#include "core/frame_arena.h"
+#include "core/particle_soa.h"
+#include "core/world_position.h"
+#include "profile/input_latency.h"
+#include "profile/perf_hud.h"
+#include "render/camera_ubo.h"
+#include "render/culling.h"
+#include "render/debug_draw.h"
+#include "render/gpu_noise.h"
+#include "render/gpu_picker.h"
+#include "render/light_buffer.h"
+#include "render/ortho_2d.h"
+#include "render/render_stats.h"
+#include "render/static_batch.h"
+#include "render/tilemap.h"
+#include "ui/immediate_ui.h"
+
+// FrameView
+// ---------
+// One camera's part of the frame: the whole window, a split-screen half, a minimap.
+// rect is (x, y, width, height) in fractions of the window, origin bottom-left as in
+// glViewport; viewPixels() rounds it the same way for main's Camera and the render thread.
+struct FrameView {
+    glm::mat4 view{1.0f};              // perspective cameras
+    glm::mat4 projection{1.0f};
+    bool orthographic = false;         // the Ortho2D pair instead, expanded at upload
+    Ortho2D orthoView;
+    Ortho2D orthoProjection;
+    std::uint64_t version = 0;         // its Camera's version(): uploaded when it changes
+    glm::vec4 rect{0.0f, 0.0f, 1.0f, 1.0f};
+    CullRect visible{glm::vec2(0.0f), glm::vec2(0.0f)};
+    bool clear = false;                // drawn over another view: clears its rect first
+};
+
+// A view rect in pixels (x, y, width, height) of a width x height target. Views that
+// touch in fractions touch in pixels: no gap, no overlap.
+inline glm::ivec4 viewPixels(const glm::vec4& rect, int width, int height) {
+    const int x = static_cast<int>(rect.x * width + 0.5f);
+    const int y = static_cast<int>(rect.y * height + 0.5f);
+    return glm::ivec4(x, y, std::max(1, static_cast<int>((rect.x + rect.z) * width + 0.5f) - x),
+                      std::max(1, static_cast<int>((rect.y + rect.w) * height + 0.5f) - y));
+}
+
+// Whether the views' viewPixels() rects together cover every pixel of a width x height
+// target: a full-window view or a split screen's halves do, a minimap alone doesn't.
+bool viewsCover(const FrameView* views, std::size_t count, int width, int height);
+
+// FramePacket
+// -----------
+// Everything the render thread needs to draw one frame, produced by the simulation side:
+// plain values and arrays, no pointers into game state. The render thread reads ONLY the
+// packet, so the simulation can already be changing the World (and filling the other
+// packet) while this one is drawn. See render/render_thread.h.
+//
+// | Field            | Filled by main                 | Used by the render thread      |
+// | ---------------- | ------------------------------ | ------------------------------ |
+// | views            | one per camera, every frame    | per view: UBO block upload if  |
+// |                  | (--split, --minimap add more)  | its version differs from the   |
+// |                  |                                | last upload; the world's draws |
+// |                  |                                | once per view (same instances) |
+// | viewport         | last framebuffer resize        | glViewport when it changes     |
+// | clearColor,      | the game config (main's        | glClearColor / swap interval   |
+// | vsync            | GameConfig), every frame       | when they change               |
+// | sceneScale,      | the config or --render-scale / | the offscreen scene target's   |
+// | sceneSamples     | --msaa                         | size and samples               |
+// | origin           | the main camera's position (0  | every view's relative          |
+// |                  | on the Sprites path)           | viewProjection (camera UBO)    |
+// | path + arrays    | compose kernels (job system),  | copied into the instance       |
+// |                  | relative to origin             | stream / sprite batch, drawn   |
+// | visible          | bounds of every view's visible | GPU particle culling           |
+// |                  | rect: what culling kept        |                                |
+// | tileEdits        | tile changes since last packet | Tilemap::apply, before drawing |
+// | noiseRequests    | --procgen-gpu chunks queued    | GpuNoise::queue; their fields  |
+// |                  | since last packet              | back to the WorldGenerator     |
+// | sceneryEdits     | level regions in / out since   | StaticBatch bake / release,    |
+// |                  | last packet                    | before drawing                 |
+// | deltaTime,       | simulated seconds this frame,  | one ParticleSystem update      |
+// | particleEmitter  | the camera position            | (--particles)                  |
+// | particleLimit    | the quality governor's share   | how many of them are drawn     |
+// | particles        | simulateParticlesParallel      | copied into the particle       |
+// |                  | (--particles-cpu)              | stream, drawn                  |
+// | skinPalette      | SkeletonPoses::evaluate        | one palette upload, then one   |
+// |                  | (--critters)                   | instanced draw per view        |
+// | lights           | --lights: the ones touching a  | one instance copy; per view,   |
+// |                  | view, and the player's         | accumulate + composite         |
+// | hud, hudGraph    | PerfHud text and frame times,  | TextBatch into the HUD sprite  |
+// |                  | with F2 / --hud, or while the  | batch: one draw over the frame |
+// |                  | --profiler-window is shown     | (hudOverlay), one in the other |
+// |                  |                                | window (hudWindow size)        |
+// | uiWidgets,       | ImmediateUi, with F4 / --ui    | UiRenderer: quads kept per     |
+// | uiText           |                                | widget, one draw over the HUD  |
+// | debugLines,      | DebugDrawList, with F3 /       | one stream copy, up to two     |
+// | debugTriangles   | --debug-draw (not in release)  | draws over everything          |
+// | report           | main profiler table, every 2 s | print it + the render profiler |
+// |                  | with --profile                 |                                |
+// | inputTime        | the oldest input this frame    | InputLatency::presented after  |
+// |                  | consumed (0: none)             | its swap                       |
+//
+// stats, renderAllocations, renderTimings, renderScale, the overdraw numbers, the GPU memory
+// numbers, picked, latency and renderBusy go the other way: the render thread writes them,
+// and main reads them when the packet comes back to be refilled (two frames later).
+//
+// contentHash() fingerprints what the packet would put on screen, for damage tracking:
+// main presents a packet whose hash equals the last presented one's only when something
+// else asks for the frame (see main's loop).
+//
+// The arrays live in the packet's own FrameArena, so the two packets are two arenas
+// (double buffering): main refills one while the render thread still reads the other,
+// and begin() can rewind an arena nobody is reading. After the first frames have sized
+// both arenas, filling a packet never calls malloc.
+struct FramePacket {
+    enum class Path : std::uint8_t {
+        Instanced, // models → InstancedQuadRenderer (mat4 instances)
+        Affine,    // affine → InstancedQuadRenderer (Affine2D instances)
+        Layered,   // affine + sprites (as layers) (+ colors) → InstancedQuadRenderer
+                   // (LayeredInstance) sampling the sprite TextureArray
+        Sprites,   // models (+ colors, sprites) → SpriteBatch
+    };
+
+    FrameArena arena;                  // first: the arrays below allocate from it
+
+    std::uint64_t frame = 0;
+
+    FrameView views[CameraUniformBuffer::kMaxViews];
+    std::uint32_t viewCount = 1;       // views[0] is the main camera's
+    WorldPosition origin;              // what models / affine are relative to (0: world space)
+    int viewportWidth = 0;
+    int viewportHeight = 0;
+    CullRect visible{glm::vec2(0.0f), glm::vec2(0.0f)};
+    float deltaTime = 0.0f;            // 0 while paused
+    glm::vec2 particleEmitter{0.0f};
+    std::size_t particleLimit = static_cast<std::size_t>(-1);   // GPU particles drawn, at most
+    glm::vec4 clearColor{0.0f, 0.0f, 0.0f, 1.0f};
+    VsyncMode vsync = VsyncMode::On;
+    float sceneScale = 1.0f;           // the world's resolution, of the window's
+    int sceneSamples = 1;
+
+    Path path = Path::Instanced;
+    FrameVector<glm::mat4> models{FrameAllocator<glm::mat4>(arena)};
+    FrameVector<Affine2D> affine{FrameAllocator<Affine2D>(arena)};
+    FrameVector<std::uint32_t> colors{FrameAllocator<std::uint32_t>(arena)}; // one per quad
+                                        // (instance colour); empty = all spriteColor
+    std::uint32_t spriteColor = 0xffffffffu;
+    FrameVector<std::uint32_t> sprites{FrameAllocator<std::uint32_t>(arena)}; // Sprites, Layered:
+                                        // image id per quad (atlas id = array layer);
+                                        // empty = untextured / layer 0
+    FrameVector<std::uint16_t> zLayers{FrameAllocator<std::uint16_t>(arena)}; // Layered: one
+                                        // per quad, higher in front; empty = all 0
+    FrameVector<glm::vec2> animations{FrameAllocator<glm::vec2>(arena)}; // Layered: (start,
+                                        // rate) per quad, for sprites that are clips
+                                        // (render/sprite_animation.h); empty = none are
+    float animationTime = 0.0f;        // the clips' clock for this frame
+    FrameVector<Affine2D> skinPalette{FrameAllocator<Affine2D>(arena)}; // --critters: bone-major,
+                                        // skinBones rows of skinCharacters (core/skeleton_2d.h)
+    std::uint32_t skinBones = 0;
+    std::uint32_t skinCharacters = 0;
+    FrameVector<PointLight2D> lights{FrameAllocator<PointLight2D>(arena)}; // --lights
+    FrameVector<TileEdit> tileEdits{FrameAllocator<TileEdit>(arena)}; // in order; --tilemap
+    FrameVector<GpuNoise::Request> noiseRequests{FrameAllocator<GpuNoise::Request>(arena)}; // --procgen-gpu
+    FrameVector<StaticBatchEdit> sceneryEdits{FrameAllocator<StaticBatchEdit>(arena)}; // in order; --level
+    FrameVector<ParticleInstance> particles{FrameAllocator<ParticleInstance>(arena)}; // --particles-cpu
+    FrameVector<DebugVertex> debugLines{FrameAllocator<DebugVertex>(arena)};     // GL_LINES pairs
+    FrameVector<DebugVertex> debugTriangles{FrameAllocator<DebugVertex>(arena)}; // GL_TRIANGLES
+
+    // --gpu-pick: a click's candidates, each with its id (candidate index + 1) as the
+    // colour, and where it was (render/gpu_picker.h).
+    FrameVector<LayeredInstance> pickInstances{FrameAllocator<LayeredInstance>(arena)};
+    std::uint64_t pickRequest = 0;     // 0: no pick this frame
+    double pickX = 0.0, pickY = 0.0;   // framebuffer pixels, origin top-left
+
+    FrameString hud{FrameAllocator<char>(arena)};    // non-empty: drawn as text, top-left
+    FrameVector<float> hudGraph{FrameAllocator<float>(arena)}; // frame ms, oldest first; under the text
+    bool hudOverlay = false;           // F2: the HUD over the frame too, not only in its window
+    int hudWindowWidth = 0, hudWindowHeight = 0; // --profiler-window's framebuffer; 0: hidden
+    FrameVector<UiWidget> uiWidgets{FrameAllocator<UiWidget>(arena)}; // F4 / --ui: the tools panel
+    FrameString uiText{FrameAllocator<char>(arena)};    // their labels, UiWidget::text into it
+    FrameString report{FrameAllocator<char>(arena)}; // non-empty: print it, then the render profiler
+    double inputTime = 0.0;            // monoclock::seconds() of the oldest input it reflects; 0: none
+
+    RenderStats stats;                 // draws, batch breaks, uploads: by the render thread
+    std::uint64_t renderAllocations = 0; // heap allocations while drawing it, likewise
+    PerfHud::Timings renderTimings;    // the render profiler's sections, after drawing it
+    float renderScale = 0.0f;          // the scene's resolution scale; 0: drawn into the window
+    float overdraw = 0.0f;             // fragments per pixel, last readback (--overdraw); 0: off
+    int overdrawMax = 0;
+    std::size_t gpuMemory = 0;         // bytes tracked by render/gpu_memory.h after drawing it
+    std::size_t gpuAvailable = 0;      // the driver's free video memory, with the HUD up; 0: unknown
+    std::uint32_t glStalls = 0;        // waits for the GPU over --stall-ms while drawing it
+    float glStallMs = 0.0f;            // ... and the time spent in them
+    GpuPicker::Result picked;          // a --gpu-pick readback that arrived while drawing it
+    InputLatency::Summary latency;     // input-to-photon, the last full window after presenting it
+    bool renderBusy = false;           // the render side has work in flight that only more
+                                       // frames finish (texture uploads, shader rebuilds)
+
+    // Everything drawn from: views (by camera version), origin, viewport, scene settings,
+    // the instance arrays, the clip clock while clips play, the palette, lights, HUD, UI
+    // and debug shapes.
+    // Not the one-shot fields (tileEdits, noiseRequests, sceneryEdits, pickRequest, report,
+    // deltaTime, inputTime): the caller treats those as damage on their own.
+    std::uint64_t contentHash() const;
+
+    // Main, right after acquire(): empties the arrays and rewinds the arena for this fill.
+    void begin() {
+        frameRelease(models);
+        frameRelease(affine);
+        frameRelease(colors);
+        frameRelease(sprites);
+        frameRelease(zLayers);
+        frameRelease(animations);
+        frameRelease(skinPalette);
+        skinBones = 0;
+        skinCharacters = 0;
+        frameRelease(lights);
+        frameRelease(tileEdits);
+        frameRelease(noiseRequests);
+        frameRelease(sceneryEdits);
+        frameRelease(particles);
+        frameRelease(debugLines);
+        frameRelease(debugTriangles);
+        frameRelease(pickInstances);
+        pickRequest = 0;
+        inputTime = 0.0;
+        frameRelease(hud);
+        frameRelease(hudGraph);
+        frameRelease(uiWidgets);
+        frameRelease(uiText);
+        frameRelease(report);
+        arena.reset();
+    }
+};
@@ -0,0 +1,1390 @@
+#include "render/frame_renderer.h"
+
+#include <GLFW/glfw3.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cstring>
+#include <initializer_list>
+#include <iostream>
+
+#include "core/alloc_counter.h"
+#include "core/clock.h"
+#include "core/frame_arena.h"
+#include "core/frame_pacer.h"
+#include "core/level_file.h"
+#include "core/radix_sort.h"
+#include "core/world_gen.h"
+#include "profile/perf_hud.h"
+#include "profile/startup_timeline.h"
+#include "render/gl_debug.h"
+#include "render/gl_framebuffer.h"
+#include "render/gl_resource.h"
+#include "render/gl_stall.h"
+#include "render/gl_state.h"
+#include "render/glyph_cache.h"
+#include "render/gpu_memory.h"
+#include "render/gpu_noise.h"
+#include "render/gpu_picker.h"
+#include "render/instanced_quads.h"
+#include "render/light_buffer.h"
+#include "render/mesh_pool.h"
+#include "render/oit_buffer.h"
+#include "render/particle_system.h"
+#include "render/sdf_font.h"
+#include "render/shader_reloader.h"
+#include "render/skinned_mesh.h"
+#include "render/sprite_animation.h"
+#include "render/static_batch.h"
+#include "render/stream_buffer.h"
+#include "render/texture_array.h"
+#include "render/texture_atlas.h"
+#include "render/tilemap.h"
+#include "render/vertex_array_cache.h"
+#include "render/virtual_texture.h"
+
+namespace {
+
+using PostProgram = PostProcessChain::Program;
+
+// The packet's colour per quad into a renderer's mapped colour slots (instance colours;
+// null: none); spriteColor for all of them when the packet has none (the benchmarks).
+void copyInstanceColors(const FramePacket& packet, std::uint32_t* dst, std::size_t count) {
+    if (!dst) {
+        return;
+    }
+    if (packet.colors.size() == count) {
+        std::memcpy(dst, packet.colors.data(), count * sizeof(std::uint32_t));
+    } else {
+        std::fill_n(dst, count, packet.spriteColor);
+    }
+}
+
+// Render commands
+// ---------------
+// What the render thread puts in its CommandBucket (render/command_bucket.h). Each one
+// binds its program through the CommandContext, so consecutive commands with the same
+// program (adjacent after the sort) don't re-bind it.
+
+// One instanced draw of whatever the renderer has mapped this frame.
+struct DrawInstancedCommand {
+    InstancedQuadRenderer* renderer;
+    PipelineId pipeline;
+
+    static void execute(const DrawInstancedCommand& c, CommandContext& context) {
+        context.usePipeline(c.pipeline);
+        c.renderer->drawMapped();   // binds VAO, glDrawElementsInstanced
+    }
+};
+
+// --critters: every character of the rig in one draw, bent by this frame's palette
+// (uploaded once, before the commands run; each view draws the same upload).
+struct DrawSkinnedCommand {
+    SkinnedMeshRenderer* renderer;
+    PipelineId pipeline;
+
+    static void execute(const DrawSkinnedCommand& c, CommandContext& context) {
+        context.usePipeline(c.pipeline);
+        c.renderer->draw();         // palette texture on its unit, VAO, glDrawElementsInstanced
+    }
+};
+
+// Instanced quads that sample a texture array: one texture bind for every layer. The
+// z-layers are depth (DEPTH_LAYERS), in two parts of the one mapping, each its own
+// pipeline (the two differ only in depth writes: switching is one glDepthMask):
+//
+// | Part        | Tint alpha | Order on the CPU   | Depth test | Depth write | Blend |
+// | ----------- | ---------- | ------------------ | ---------- | ----------- | ----- |
+// | opaque      | 1          | none (as composed) | LEQUAL     | yes         | yes*  |
+// | translucent | < 1        | back to front      | LEQUAL     | no          | yes   |
+//
+// * only the soft edge the alpha cutoff leaves; the corners are discarded.
+struct DrawLayeredCommand {
+    InstancedQuadRenderer* renderer;
+    PipelineId pipeline;            // opaque or translucent
+    GLuint textureArray;
+    std::uint32_t first, count;     // instances of the mapped stream
+
+    static void execute(const DrawLayeredCommand& c, CommandContext& context) {
+        context.usePipeline(c.pipeline);
+        context.bindTexture(c.textureArray, GL_TEXTURE_2D_ARRAY);
+        c.renderer->drawMappedRange(c.first, c.count);
+    }
+};
+
+// The tilemap's chunks that overlap the view, under the world layer (RenderLayer::Background).
+struct DrawTilemapCommand {
+    Tilemap* tilemap;
+    PipelineId pipeline;        // alpha blended: the shapes' corners are transparent
+    GLuint textureArray;
+    CullRect view;
+    std::size_t* draws;         // += the chunks it drew (one per view)
+
+    static void execute(const DrawTilemapCommand& c, CommandContext& context) {
+        context.usePipeline(c.pipeline);
+        context.bindTexture(c.textureArray, GL_TEXTURE_2D_ARRAY);
+        c.tilemap->draw(c.view, context.draws());
+        context.draws().flush();    // the visible chunks: one multi-draw
+        *c.draws += c.tilemap->stats().draws;
+    }
+};
+
+// --level: the baked props of the regions that overlap the view, first in the world layer.
+struct DrawStaticBatchCommand {
+    StaticBatch* batch;
+    PipelineId pipeline;        // the sprite program, alpha blended
+    CullRect view;
+    std::size_t* draws;         // += the runs it drew (one per view)
+
+    static void execute(const DrawStaticBatchCommand& c, CommandContext& context) {
+        context.usePipeline(c.pipeline);
+        c.batch->draw(c.view, context.draws());
+        context.draws().flush();
+        context.invalidate();       // draw() bound the atlas pages itself
+        *c.draws += c.batch->stats().draws;
+    }
+};
+
+// --virtual-background: the image's one quad, under the tilemap (program 0 in the key
+// sorts it first in the Background layer, after the view's SetViewCommand at depth 0).
+// Opaque: no blending.
+struct DrawVirtualTextureCommand {
+    VirtualTexture* texture;
+    GLuint program;
+    CullRect view;
+
+    static void execute(const DrawVirtualTextureCommand& c, CommandContext& context) {
+        context.useProgram(c.program);
+        context.bindTexture(c.texture->physicalTexture());
+        c.texture->draw(c.view);    // page table on its unit, the quad
+    }
+};
+
+// --lights: the view's light accumulated, then multiplied over what the view has drawn so
+// far (RenderLayer::Lighting: the background and the world, not the particles or the UI).
+// --light-tiles: no accumulation (lightProgram 0), the composite sums the view's tiles.
+struct ApplyLightingCommand {
+    LightBuffer* lights;
+    GLuint lightProgram;
+    GLuint compositeProgram;
+    GLuint framebuffer;             // the scene target's, or 0 (the window)
+    glm::ivec4 rect;                // the view, in its pixels
+    std::uint32_t view;
+
+    static void execute(const ApplyLightingCommand& c, CommandContext& context) {
+        context.draws().flush();    // the world's draws land before it is lit
+        if (c.lightProgram != 0) {
+            context.useProgram(c.lightProgram);
+            c.lights->accumulate(c.rect);
+        }
+        context.useProgram(c.compositeProgram);
+        context.bindTexture(c.lights->texture());
+        c.lights->composite(c.framebuffer, c.rect, c.view);
+    }
+};
+
+// --oit: the view's translucent layered quads, in the order they were written, weighted
+// into the OIT targets and then composited over the scene (render/oit_buffer.h). Takes
+// the translucent DrawLayeredCommand's place and key: after the opaque part, whose depth
+// it tests against.
+struct DrawOitCommand {
+    OitBuffer* oit;
+    InstancedQuadRenderer* renderer;
+    PipelineId pipeline;            // the OIT program, blend::kOitAccumulate
+    GLuint compositeProgram;
+    GLuint textureArray;
+    std::uint32_t first, count;     // instances of the mapped stream
+    GLuint framebuffer;             // the scene target's
+    glm::ivec4 rect;                // the view, in its pixels
+
+    static void execute(const DrawOitCommand& c, CommandContext& context) {
+        context.draws().flush();    // the opaque part's depth is in before the quads test it
+        c.oit->accumulate(c.rect);
+        context.usePipeline(c.pipeline);
+        context.bindTexture(c.textureArray, GL_TEXTURE_2D_ARRAY);
+        c.renderer->drawMappedRange(c.first, c.count);
+        context.useProgram(c.compositeProgram);
+        context.bindTexture(c.oit->texture());
+        c.oit->composite(c.framebuffer, c.rect);
+    }
+};
+
+// Every particle as an instanced quad, added onto what's below (RenderLayer::Overlay):
+// from the GPU state buffer, or (--particles-cpu) the instances mapped into `cpu`.
+struct DrawParticlesCommand {
+    ParticleSystem* particles;  // nullptr: cpu
+    InstancedQuadRenderer* cpu;
+    PipelineId pipeline;        // additive: overlaps get brighter
+    GLuint textureArray;
+
+    static void execute(const DrawParticlesCommand& c, CommandContext& context) {
+        context.usePipeline(c.pipeline);
+        context.bindTexture(c.textureArray, GL_TEXTURE_2D_ARRAY);
+        if (c.particles) {
+            c.particles->draw();
+        } else {
+            c.cpu->drawMapped();
+        }
+    }
+};
+
+// With --split / --minimap: the view's part of the target and its camera block, first in
+// the view (layer 0, program 0 sort before everything else in it). A view drawn over
+// another clears its rectangle first (scissored: colour and depth, not the overdraw
+// stencil). The kWindowView one puts the whole target and view 0's camera back.
+struct SetViewCommand {
+    CameraUniformBuffer* cameras;
+    int view;
+    glm::ivec4 rect;            // pixels of the bound target: x, y, width, height
+    int targetWidth, targetHeight;
+    GLbitfield clear;           // of the rect: GL_COLOR_BUFFER_BIT, GL_DEPTH_BUFFER_BIT, or 0
+
+    static void execute(const SetViewCommand& c, CommandContext& context) {
+        context.draws().flush();    // pending draws belong to the previous view
+        glstate::viewport(c.rect.x, c.rect.y, c.rect.z, c.rect.w);
+        c.cameras->bindView(c.view);
+        if (c.clear != 0) {
+            context.useDefaultState();  // depth writes on, whatever pipeline drew last
+            const GLfloat background[4] = {0.05f, 0.05f, 0.08f, 1.0f};
+            const GLfloat farthest = 1.0f;
+            glframebuffer::Scissor scissor(c.rect, c.targetWidth, c.targetHeight);
+            if (c.clear & GL_COLOR_BUFFER_BIT) {
+                glClearBufferfv(GL_COLOR, 0, background);
+            }
+            if (c.clear & GL_DEPTH_BUFFER_BIT) {
+                glClearBufferfv(GL_DEPTH, 0, &farthest);
+            }
+        }
+    }
+};
+
+// The packet's debug shapes, over everything (RenderLayer::Ui): at most two draws.
+struct DrawDebugCommand {
+    DebugDrawRenderer* renderer;
+    PipelineId pipeline;        // alpha blended
+    const FramePacket* packet;
+    std::size_t* draws;         // how many it issued
+
+    static void execute(const DrawDebugCommand& c, CommandContext& context) {
+        context.usePipeline(c.pipeline);
+        *c.draws = c.renderer->draw(c.packet->debugLines.data(), c.packet->debugLines.size(),
+                                    c.packet->debugTriangles.data(), c.packet->debugTriangles.size());
+    }
+};
+
+// The packet's HUD: text and the frame-time graph, glyph quads and boxes from one SDF
+// atlas, so one sprite batch draw. Timed (CPU) as the render profiler's "hud" section.
+// Also draws the --profiler-window, through that context's batch and at its size.
+struct DrawTextCommand {
+    SpriteBatch* batch;
+    TextBatch* text;
+    const SdfFont* font;
+    GlyphCache* glyphs;         // --font: the text from it instead, when initialized
+    GLuint program;
+    const FramePacket* packet;
+    Profiler* profiler;
+    Profiler::SectionId section;
+    int width, height;          // the target's pixels
+
+    static void execute(const DrawTextCommand& c, CommandContext& context) {
+        CpuScope scope(*c.profiler, c.section);
+        const FramePacket& packet = *c.packet;
+        context.useDefaultState();  // it sets its own blending, and nothing else
+        glstate::enable(GL_BLEND);
+        glstate::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        c.batch->begin();
+        c.batch->setProgram(c.program);
+        if (c.glyphs->initialized()) {
+            c.text->begin(*c.batch, *c.glyphs, c.width, c.height);
+        } else {
+            c.text->begin(*c.batch, *c.font, c.width, c.height);
+        }
+        // A dark copy one pixel down-right keeps it readable over anything.
+        c.text->print(glm::vec2(9.0f, 9.0f), 14.0f, packet.hud.data(), packet.hud.size(), 0xC0000000u);
+        const glm::vec2 pen = c.text->print(glm::vec2(8.0f, 8.0f), 14.0f, packet.hud.data(), packet.hud.size(),
+                                            0xFFFFFFFFu);
+        if (!packet.hudGraph.empty()) {
+            // One 2-pixel bar per frame, kGraphMs at the top, a line at 60 fps; green
+            // under 60 fps' 16.7 ms, yellow under 30 fps', red over.
+            constexpr float kGraphMs = 50.0f, kGraphHeight = 64.0f, kBar = 2.0f;
+            const glm::vec2 origin(8.0f, pen.y + c.text->lineHeight(14.0f) + 6.0f);
+            const float width = kBar * static_cast<float>(packet.hudGraph.size());
+            c.text->rect(origin, glm::vec2(width, kGraphHeight), 0x80000000u);
+            for (std::size_t i = 0; i < packet.hudGraph.size(); ++i) {
+                const float ms = packet.hudGraph[i];
+                const float height = std::min(ms / kGraphMs, 1.0f) * kGraphHeight;
+                const std::uint32_t color = ms < 16.7f ? 0xFF40E040u : ms < 33.3f ? 0xFF30D0F0u : 0xFF4040F0u;
+                c.text->rect(glm::vec2(origin.x + kBar * i, origin.y + kGraphHeight - height),
+                             glm::vec2(kBar, height), color);
+            }
+            c.text->rect(glm::vec2(origin.x, origin.y + kGraphHeight * (1.0f - 16.7f / kGraphMs)),
+                         glm::vec2(width, 1.0f), 0xC0FFFFFFu);
+        }
+        c.batch->end();
+        context.invalidate();
+        glstate::disable(GL_BLEND);
+    }
+};
+
+// The packet's tools panel (F4 / --ui): each widget's quads as kept by the UiRenderer,
+// rebuilt only where the widget changed; one sprite batch draw under the HUD's.
+struct DrawUiCommand {
+    UiRenderer* ui;
+    SpriteBatch* batch;
+    TextBatch* text;
+    const SdfFont* font;
+    GlyphCache* glyphs;
+    GLuint program;
+    const FramePacket* packet;
+    Profiler* profiler;
+    Profiler::SectionId section;
+
+    static void execute(const DrawUiCommand& c, CommandContext& context) {
+        CpuScope scope(*c.profiler, c.section);
+        const FramePacket& packet = *c.packet;
+        context.useDefaultState();
+        glstate::enable(GL_BLEND);
+        glstate::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        c.ui->draw(*c.batch, *c.text, c.program, *c.font, *c.glyphs, packet.uiWidgets.data(), packet.uiWidgets.size(),
+                   packet.uiText.data(), packet.viewportWidth, packet.viewportHeight);
+        context.invalidate();
+        glstate::disable(GL_BLEND);
+    }
+};
+
+// The packet's models (+ colors, atlas sprites) through the sprite batcher. The atlas is
+// built before the render thread starts and never changes, so reading it here is safe.
+struct DrawSpritesCommand {
+    SpriteBatch* batch;
+    GLuint program;
+    const FramePacket* packet;
+    const TextureAtlas* atlas;
+    GLuint playerTexture;       // 0 = the atlas image (sprite 0 is only ever the player)
+    glm::vec4 playerUv;         // (0, 1, 1, 0) for a top-down (KTX2) texture
+    SpriteBatch::Stats* sum;    // += its draws and breaks (it re-batches for every view)
+    const ShapeCache::Shape* shape; // --shapes: the wanderers' outline; nullptr: quads
+
+    static void execute(const DrawSpritesCommand& c, CommandContext& context) {
+        // The batcher's unit quad is [-0.5, 0.5], ours is [-0.25, 0.25].
+        const glm::mat4 toUnitQuad = glm::scale(glm::mat4(1.0f), glm::vec3(0.5f, 0.5f, 1.0f));
+        const FramePacket& packet = *c.packet;
+        const bool textured = !packet.sprites.empty() && c.atlas->pageCount() > 0;
+        context.useDefaultState();
+        glstate::enable(GL_BLEND);  // the shapes' corners are transparent
+        glstate::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        c.batch->begin();
+        c.batch->setProgram(c.program);
+        for (std::size_t k = 0; k < packet.models.size(); ++k) {
+            const std::uint32_t color = packet.colors.empty() ? packet.spriteColor : packet.colors[k];
+            GLuint texture = 0;
+            glm::vec4 uvRect(0.0f, 0.0f, 1.0f, 1.0f);
+            if (textured && c.playerTexture != 0 && packet.sprites[k] == 0) {
+                texture = c.playerTexture;
+                uvRect = c.playerUv;
+            } else if (textured) {
+                const AtlasRegion& region = c.atlas->region(packet.sprites[k]);
+                texture = c.atlas->pageTexture(region.page);
+                uvRect = region.uvRect;
+            }
+            const glm::mat4 model = packet.models[k] * toUnitQuad;
+            if (c.shape && k > 0) {     // model 0 is the player's
+                c.batch->submitTriangles(model, c.shape->vertices.data(), c.shape->indices.data(),
+                                         c.shape->indices.size(), texture, uvRect, color);
+            } else {
+                c.batch->submit(model, texture, uvRect, color);
+            }
+        }
+        c.batch->end();             // binds its own program and textures:
+        context.invalidate();       // the context no longer knows what's bound
+        glstate::disable(GL_BLEND);
+        const SpriteBatch::Stats& s = c.batch->stats();
+        c.sum->sprites += s.sprites;
+        c.sum->batches += s.batches;
+        c.sum->programBreaks += s.programBreaks;
+        c.sum->textureBreaks += s.textureBreaks;
+        c.sum->capacityBreaks += s.capacityBreaks;
+    }
+};
+
+} // namespace
+
+PipelineId FrameRenderer::makePipeline(const char* name, const ShaderProgram& program, const BlendState& blendState,
+                                       const DepthState& depth) {
+    PipelineDesc desc;
+    desc.name = name;
+    desc.program = program.id();
+    desc.blend = blendState;
+    desc.depth = depth;
+    const PipelineId id = pipelines_.create(desc);
+    pipelinePrograms_.push_back(PipelineProgram{id, &program});
+    return id;
+}
+
+void FrameRenderer::init(const Settings& settings) {
+    settings_ = settings;
+    appliedClearColor_ = settings.clearColor;
+    std::fill_n(uploadedCameraVersions_, CameraUniformBuffer::kMaxViews, ~0ull); // forces the first uploads
+    // Camera matrices live in a UBO on camera.glsl's binding point, which every program's
+    // "Camera" block already reads (render/shader_build.h); uploads happen once per frame.
+    cameraUBO_.init(settings.views);
+    spriteBatch_.init();
+    hudBatch_.init();
+    uiBatch_.init();
+    debugRenderer_.init();
+
+    // The effects' settings.
+    const bool postBloom = PostProcessChain::uses(PostProgram::Bright, settings.post);
+    if (settings.post != 0 && postChain_.init(PostProcessChain::Options{settings.post})) {
+        if (postBloom) {
+            postChain_.setUniforms(PostProgram::Bright, programs_.postBright.id());
+            postChain_.setUniforms(PostProgram::Blur, programs_.postBlur.id());
+        }
+        postChain_.setUniforms(PostProgram::Final, programs_.postFinal.id());
+        std::cout << "Post: " << PostProcessChain::describe(postChain_.effects()) << ", "
+                  << (postBloom ? 4 : 1) << " pass(es)\n";
+    }
+
+    // Equal z-layers: the later draw wins, as without depth. The translucent part tests
+    // against the opaque one but doesn't write.
+    const DepthState opaqueLayers{true, GL_LEQUAL, true};
+    const DepthState translucentLayers{true, GL_LEQUAL, false};
+    quadsPipeline_ = makePipeline("quads", programs_.quads, blend::kOpaque);
+    affinePipeline_ = makePipeline("affine", programs_.affine, blend::kOpaque);
+    layeredOpaquePipeline_ = makePipeline("layered opaque", programs_.layered, blend::kAlpha, opaqueLayers);
+    layeredTranslucentPipeline_ =
+        makePipeline("layered translucent", programs_.layered, blend::kAlpha, translucentLayers);
+    layeredOitPipeline_ = makePipeline("layered oit", programs_.oit, blend::kOitAccumulate, translucentLayers);
+    animatedOpaquePipeline_ = makePipeline("animated opaque", programs_.animated, blend::kAlpha, opaqueLayers);
+    animatedTranslucentPipeline_ =
+        makePipeline("animated translucent", programs_.animated, blend::kAlpha, translucentLayers);
+    tilemapPipeline_ = makePipeline("tilemap", programs_.tilemap, blend::kAlpha);
+    staticBatchPipeline_ = makePipeline("static batch", programs_.sprite, blend::kAlpha);
+    skinnedPipeline_ = makePipeline("skinned", programs_.skinned, blend::kOpaque);
+    particlePipeline_ = makePipeline("particles", programs_.particles, blend::kAdditive);
+    debugPipeline_ = makePipeline("debug", programs_.debug, blend::kAlpha);
+}
+
+void FrameRenderer::attach(const Resources& resources) {
+    res_ = resources;
+    // One Profiler per thread (a Profiler isn't shared): this one has the GPU queries. GPU
+    // sections must not overlap; the five below run one after another.
+    profiler_.init(true, "render");
+    clearSection_ = profiler_.section("clear");
+    uploadSection_ = profiler_.section("upload");
+    particleSection_ = profiler_.section("particles");
+    drawSection_ = profiler_.section("draw");
+    swapSection_ = profiler_.section("swap");
+    // CPU only, inside draw: what drawing the HUD costs the render thread.
+    hudDrawSection_ = profiler_.section("hud");
+    uiDrawSection_ = profiler_.section("ui");
+    // CPU only: the HUD drawn again, into the --profiler-window.
+    profilerWindowSection_ = profiler_.section("profiler window");
+
+    // --dynamic-resolution: the scale follows the GPU frame time, down to --render-scale.
+    dynamicScale_ = settings_.dynamicResolutionMs > 0.0 && profiler_.gpuEnabled();
+    if (settings_.dynamicResolutionMs > 0.0 && !dynamicScale_) {
+        std::cerr << "Dynamic resolution: needs GPU timer queries, off\n";
+    }
+    if (dynamicScale_) {
+        DynamicResolution::Settings scaling;
+        scaling.targetMs = settings_.dynamicResolutionMs;
+        if (settings_.renderScale < 1.0f) {
+            scaling.minScale = settings_.renderScale;
+        }
+        dynamicResolution_.init(scaling);
+        std::cout << "Dynamic resolution: " << scaling.minScale << "x..1x to hold " << scaling.targetMs
+                  << " ms of GPU time\n";
+    }
+    if (isOffscreen(settings_.renderScale, settings_.msaa) && !dynamicScale_) {
+        std::cout << "Scene: " << settings_.renderScale << "x resolution, "
+                  << std::min(settings_.overdraw ? 1 : settings_.msaa, RenderTargetPool::maxSamples())
+                  << "x MSAA, presented by blit\n";
+    }
+    if (settings_.overdraw) {
+        overdraw_.init(settings_.overdrawCount);
+        std::cout << "Overdraw: counting " << OverdrawMeter::name(settings_.overdrawCount)
+                  << " fragments per pixel" << (settings_.msaa > 1 ? " (MSAA off)" : "") << "\n";
+    }
+    const FrameCapture::Settings& capture = settings_.captureSettings;
+    if (settings_.capture && frameCapture_.init(capture)) {
+        std::cout << "Capture: every " << capture.every << " frame(s) to ";
+        if (capture.pipe.empty()) {
+            std::cout << capture.directory << "/ as "
+                      << (capture.format == FrameCapture::Format::Png ? "PNG" : "raw RGBA");
+        } else {
+            std::cout << "\"" << capture.pipe << "\" as raw RGBA";
+        }
+        std::cout << (capture.wait ? ", none dropped" : "") << "\n";
+    }
+    commandContext_.setPipelines(&pipelines_);
+    commandContext_.draws().init();             // multi-draw indirect where the driver has it
+    std::cout << "Multi-draw: " << (commandContext_.draws().indirect() ? "glMultiDrawElementsIndirect"
+                                                                       : "looped glDrawElementsInstancedBaseVertex")
+              << "\n";
+}
+
+// --overdraw counts in the scene target's stencil and reads it back: always offscreen,
+// never multisampled (render/overdraw.h). Scale and samples come with each packet: a
+// reloaded config changes them between frames.
+// --post reads the scene as a texture: offscreen too. --oit shares the scene's depth
+// buffer, which the window's isn't.
+bool FrameRenderer::isOffscreen(float scale, int samples) const {
+    return scale < 1.0f || samples > 1 || dynamicScale_ || settings_.overdraw || settings_.post != 0 || settings_.oit;
+}
+
+void FrameRenderer::shutdown() {
+    photonLatency_.shutdown();
+    renderTargets_.shutdown();
+    commandContext_.draws().shutdown();
+    profiler_.shutdown();
+    debugRenderer_.shutdown();
+    spriteBatch_.shutdown();
+    hudBatch_.shutdown();
+    uiBatch_.shutdown();
+    overdraw_.shutdown();
+    frameCapture_.shutdown();   // waits for the writer: every captured frame is on disk
+    postChain_.shutdown();
+    cameraUBO_.shutdown();
+    for (ShaderProgram* program :
+         {&programs_.quads, &programs_.affine, &programs_.layered, &programs_.sprite, &programs_.tilemap,
+          &programs_.particleUpdate, &programs_.particles, &programs_.text, &programs_.debug, &programs_.heatmap,
+          &programs_.postBright, &programs_.postBlur, &programs_.postFinal, &programs_.pick, &programs_.noise,
+          &programs_.animated, &programs_.skinned, &programs_.virtualTexture, &programs_.virtualFeedback,
+          &programs_.light, &programs_.lightComposite, &programs_.oit, &programs_.oitComposite,
+          &programs_.particleCull}) {
+        program->destroy();
+    }
+}
+
+void FrameRenderer::render(FramePacket& packet) {
+    if (!renderJobsStarted_) {
+        renderJobs_.init(settings_.renderJobs);
+        commandRecorder_.init(renderJobs_);
+        renderJobsStarted_ = true;
+        std::cout << "Render jobs: " << renderJobs_.workerCount() << " worker(s)\n";
+    }
+    const bool gpuPick = res_.gpuPicker->initialized();   // --gpu-pick
+    const bool gpuFields = res_.gpuNoise->initialized();  // --procgen-gpu
+    const bool skinned = res_.skinnedMesh->initialized(); // --critters
+    // This thread's scratch arena holds nothing from the previous packet.
+    FrameArena::thisThread().reset();
+    photonLatency_.poll(monoclock::seconds());  // the earlier frames' fences, before this one queues more
+    const std::uint64_t allocationsBefore = alloccount::thread();
+    const std::uint64_t stateIssuedBefore = glstate::stats().issued();
+    const std::uint64_t stateFilteredBefore = glstate::stats().filtered();
+    const std::uint64_t streamedBefore = StreamBuffer::bytesStreamed();
+    profiler_.beginFrame();
+    res_.textureLoader->update();         // at most one upload budget of finished images
+    res_.glyphCache->update();            // glyphs rasterized since, into the atlas
+    res_.shaderReloader->update();        // swaps in programs rebuilt from saved files
+    for (const PipelineProgram& p : pipelinePrograms_) {
+        pipelines_.setProgram(p.pipeline, p.program->id());   // a compare unless swapped
+    }
+    const TextureLoader::Stats loading = res_.textureLoader->stats();
+    packet.renderBusy = res_.shaderReloader->busy() ||
+                        loading.ready + loading.failed + loading.evicted < loading.requested ||
+                        res_.virtualTexture->busy() || res_.gpuNoise->busy() || res_.glyphCache->busy();
+    // Where the world goes: the window, or an offscreen target of the scaled size
+    // (the same pooled one every frame until the size changes). A dynamic scale back
+    // at 1 without MSAA draws straight into the window again: no blit.
+    const bool offscreenScene = isOffscreen(packet.sceneScale, packet.sceneSamples);
+    const int sceneSamples = settings_.overdraw ? 1 : packet.sceneSamples;
+    const float renderScale = dynamicScale_ ? dynamicResolution_.scale() : packet.sceneScale;
+    packet.renderScale = offscreenScene ? renderScale : 0.0f;
+    const bool wantTarget = offscreenScene && (renderScale < 1.0f || sceneSamples > 1 || settings_.overdraw ||
+                                                  postChain_.enabled() || res_.oitBuffer->initialized());
+    RenderTargetDesc sceneDesc;
+    sceneDesc.width = std::max(1, static_cast<int>(packet.viewportWidth * renderScale + 0.5f));
+    sceneDesc.height = std::max(1, static_cast<int>(packet.viewportHeight * renderScale + 0.5f));
+    sceneDesc.samples = sceneSamples;
+    sceneDesc.depthFormat = GL_DEPTH24_STENCIL8; // z-layers (texture array path)
+
+    // The frame's passes (render/render_graph.h), declared before anything is recorded:
+    // compiling gives the scene its pooled target, which commands point at. They run
+    // after the bucket is sorted, in the graph's order; the bucket's keys order the
+    // draws within the scene and window passes.
+    //
+    // | Pass           | Reads  | Writes | What                                              |
+    // | -------------- | ------ | ------ | ------------------------------------------------- |
+    // | scene          |        | scene  | clear, then every layer of every view             |
+    // | overdraw       | scene  | scene  | --overdraw: the heatmap over it                   |
+    // | post, present  | scene  | window | --post's passes (render/post_process.h), or the   |
+    // |                |        |        | resolve and scale into the window                 |
+    // | window         | window | window | kWindowView's Ui layer: the UI, the HUD           |
+    // | pick, noise    |        |        | into targets of their own: side effects, kept     |
+    //
+    // Without an offscreen scene, "scene" is the window and nothing sits in between.
+    RenderGraph::Resource windowResource = 0;
+    RenderGraph::Resource sceneResource = 0;
+    std::size_t windowCommands = 0;     // where kWindowView's Ui layer starts in the sorted bucket
+    bool backgroundCovers = false;
+    int targetWidth = packet.viewportWidth;
+    int targetHeight = packet.viewportHeight;
+    PostProcessChain::Programs postPrograms;
+    postPrograms.program[static_cast<int>(PostProgram::Bright)] = programs_.postBright.id();
+    postPrograms.program[static_cast<int>(PostProgram::Blur)] = programs_.postBlur.id();
+    postPrograms.program[static_cast<int>(PostProgram::Final)] = programs_.postFinal.id();
+    auto declareFrame = [&](bool offscreen) {
+        frameGraph_.reset();
+        windowResource = frameGraph_.importBackbuffer(packet.viewportWidth, packet.viewportHeight);
+        sceneResource = offscreen ? frameGraph_.createTarget("scene", sceneDesc) : windowResource;
+        const RenderGraph::Pass scenePass = frameGraph_.addPass("scene", [&](const RenderGraph& g) {
+            profiler_.begin(clearSection_);
+            // Depth only for the path that tests against it (the window has a depth
+            // buffer by default; the scene target gets one). Colour isn't cleared when
+            // the opaque virtual-texture background covers every view: discarded instead.
+            const GLbitfield clear = packet.path == FramePacket::Path::Layered
+                                         ? GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT
+                                         : GL_COLOR_BUFFER_BIT;
+            glframebuffer::begin(g.framebuffer(sceneResource), targetWidth, targetHeight, clear,
+                                 backgroundCovers ? GL_COLOR_BUFFER_BIT : 0);
+            if (g.target(sceneResource) && overdraw_.enabled()) {
+                overdraw_.begin();       // zeroes the stencil; every draw from here on counts
+            }
+            profiler_.end(clearSection_);
+            commands_.execute(commandContext_, 0, windowCommands);
+        });
+        frameGraph_.write(scenePass, sceneResource);
+        if (offscreen && overdraw_.enabled()) {
+            const RenderGraph::Pass heatmap = frameGraph_.addPass("overdraw", [&](const RenderGraph& g) {
+                const RenderTarget& target = *g.target(sceneResource);
+                target.bind();
+                overdraw_.end(target);
+                overdraw_.drawHeatmap(programs_.heatmap.id());
+            });
+            frameGraph_.read(heatmap, sceneResource);
+            frameGraph_.write(heatmap, sceneResource);
+        }
+        if (offscreen && !postChain_.addPasses(frameGraph_, sceneResource, windowResource, postPrograms,
+                                               packet.viewportWidth, packet.viewportHeight)) {
+            const RenderGraph::Pass present = frameGraph_.addPass("present", [&](const RenderGraph& g) {
+                renderTargets_.present(*g.target(sceneResource), packet.viewportWidth, packet.viewportHeight);
+            });
+            frameGraph_.read(present, sceneResource);
+            frameGraph_.write(present, windowResource);
+        }
+        const RenderGraph::Pass windowPass = frameGraph_.addPass("window", [&](const RenderGraph&) {
+            glstate::bindFramebuffer(GL_FRAMEBUFFER, 0);
+            glstate::viewport(0, 0, packet.viewportWidth, packet.viewportHeight);
+            commandContext_.invalidate();    // the passes since the scene's set state of their own
+            commands_.execute(commandContext_, windowCommands, commands_.size());
+        });
+        frameGraph_.read(windowPass, windowResource);
+        frameGraph_.write(windowPass, windowResource);
+        if (gpuPick && packet.pickRequest != 0) {
+            // Clicks pick in the main camera's view (its top-left is the window's).
+            frameGraph_.sideEffect(frameGraph_.addPass("pick", [&](const RenderGraph&) {
+                const glm::ivec4 mainView = viewPixels(packet.views[0].rect, packet.viewportWidth,
+                                                       packet.viewportHeight);
+                res_.gpuPicker->render(programs_.pick.id(), res_.spriteArray->texture(),
+                                       static_cast<std::uint32_t>(res_.spriteArray->layers()),
+                                       packet.pickInstances.data(), packet.pickInstances.size(), packet.pickX,
+                                       packet.pickY, mainView.z, mainView.w, packet.pickRequest);
+            }));
+        }
+        if (gpuFields) {
+            frameGraph_.sideEffect(frameGraph_.addPass("noise", [&](const RenderGraph&) {
+                res_.gpuNoise->render(programs_.noise.id(), res_.worldGen->heightField(),
+                                      res_.worldGen->moistureField(), packet.viewportWidth, packet.viewportHeight);
+            }));
+        }
+        return frameGraph_.compile(renderTargets_);
+    };
+    if (!declareFrame(wantTarget) && wantTarget) {
+        declareFrame(false);            // no target to be had: straight into the window
+    }
+    RenderTarget* scene = frameGraph_.target(sceneResource);
+    if (scene) {
+        targetWidth = scene->width();
+        targetHeight = scene->height();
+    }
+
+    if (packet.clearColor != appliedClearColor_) {
+        appliedClearColor_ = packet.clearColor;
+        glClearColor(appliedClearColor_.r, appliedClearColor_.g, appliedClearColor_.b, appliedClearColor_.a);
+    }
+    if (packet.vsync != res_.pacer->settings().vsync) {
+        res_.pacer->setVsync(packet.vsync);   // the swap interval is the context's: this thread's
+    }
+    // The views tile the target and the opaque virtual-texture background fills each of
+    // them: its draws overwrite every pixel, so the scene pass doesn't clear colour.
+    backgroundCovers = res_.virtualTexture->initialized() &&
+                            viewsCover(packet.views, packet.viewCount, targetWidth, targetHeight);
+    for (std::uint32_t v = 0; backgroundCovers && v < packet.viewCount; ++v) {
+        backgroundCovers = res_.virtualTexture->covers(packet.views[v].visible);
+    }
+    // GL_COLOR_BUFFER_BIT is a bitmask constant that tells OpenGL to clear the color buffer
+    // using the value previously set with glClearColor().
+
+    // Camera data goes to the GPU only when the matrices changed. The UBO keeps its
+    // contents between frames, so an idle camera costs nothing here.
+    profiler_.begin(uploadSection_);
+    const bool originMoved = packet.origin != uploadedOrigin_;   // every view's relative matrix
+    for (std::uint32_t v = 0; v < packet.viewCount; ++v) {
+        const FrameView& view = packet.views[v];
+        if (originMoved || view.version != uploadedCameraVersions_[v]) {
+            if (view.orthographic) {
+                cameraUBO_.upload(static_cast<int>(v), view.orthoView, view.orthoProjection, packet.origin.world());
+            } else {
+                cameraUBO_.upload(static_cast<int>(v), view.view, view.projection, packet.origin.world());
+            }
+            uploadedCameraVersions_[v] = view.version;
+        }
+    }
+    uploadedOrigin_ = packet.origin;
+    if (!packet.animations.empty()) {
+        res_.spriteClips->upload(packet.animationTime);  // the clock; the clips once
+    }
+    if (res_.virtualTexture->initialized()) {
+        // Pages that arrived into the cache, then this frame's feedback (read two or
+        // three frames later), seen through the main view.
+        res_.virtualTexture->update();
+        if (packet.viewCount > 1) {
+            cameraUBO_.bindView(0);
+        }
+        res_.virtualTexture->feedback(programs_.virtualFeedback.id(), packet.viewportWidth, packet.viewportHeight);
+    }
+    profiler_.end(uploadSection_);
+
+    // The particle step is GPU work only: the same few calls for any particle count.
+    // The CPU path's step already ran on main; its instances are one copy.
+    profiler_.begin(particleSection_);
+    res_.particleSystem->setDrawLimit(packet.particleLimit);  // --quality-governor
+    res_.particleSystem->update(programs_.particleUpdate, packet.deltaTime, packet.particleEmitter);
+    res_.particleSystem->cull(programs_.particleCull, packet.visible);    // --gpu-cull
+    ParticleInstance* particleDst = res_.particleQuads->mapParticles(packet.particles.size());
+    if (particleDst) {
+        std::memcpy(particleDst, packet.particles.data(), packet.particles.size() * sizeof(ParticleInstance));
+    }
+    profiler_.end(particleSection_);
+
+    // Find 'model' memory location
+    // GLuint modelLoc = glGetUniformLocation(shaderProgram, "model");
+
+    // Send composed model matrix (using value_ptr) to location found
+    // in the previous step
+    // glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+
+    // GLuint mvpLoc = glGetUniformLocation(shaderProgram, "MVP");
+    // glUniformMatrix4fv(mvpLoc, 1, GL_FALSE, glm::value_ptr(MVP));
+
+    // With instancing, each object's model matrix travels in the instance buffer and
+    // projection/view come from the Camera UBO, so there are no per-draw uniforms.
+    // For per-draw uniforms use programs_.quads.set(shaderlayout::vertex::uName, value)
+    // here (render/shader_layout.h)—never glGetUniformLocation in the loop.
+
+
+    // glm::value_ptr(...)
+    // --------------------
+    // Converts a GLM matrix (or vector) into a raw pointer (float*) usable by OpenGL.
+    //
+    // Usage:
+    // glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(matrix));
+    //
+    // Why it's needed:
+    // OpenGL expects matrices as arrays of floats in column-major order.
+    // GLM stores data this way internally, so value_ptr() gives you safe access to it.
+    
+    // glUniformMatrix4fv(...)
+    // ------------------------
+    // Sends a 4×4 matrix to the currently active shader program.
+    //
+    // Usage:
+    // glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(matrix));
+    //
+    // Parameters:
+    // - location: ID of the uniform variable in the shader
+    // - 1: number of matrices you're uploading (usually 1)
+    // - GL_FALSE: whether to transpose (must be GL_FALSE for GLM)
+    // - value_ptr(matrix): raw float pointer to the matrix data
+    //
+    // This sets a uniform mat4 variable in your GLSL vertex shader.
+
+
+    // int offsetLoc = glGetUniformLocation(shaderProgram, "xOffset");
+    // Asks OpenGL:
+    // “In the currently linked shader program, where is the uniform variable named xOffset?”
+    // OpenGL will:
+    // Look into the compiled+linked shader program
+    // Find the memory location for the variable xOffset
+    // Return an integer handle that refers to that location
+    // OpengGL doesn't expose actual variable pointers in GLSL - uses opaque location IDs
+    // glUniform1f(glGetUniformLocation(shaderProgram, "xOffset"), xOffset);
+    // glUniform1f(glGetUniformLocation(shaderProgram, "yOffset"), yOffset);
+
+    // Sends the value of xOffset(C++) to the GPU at the location where xOffset is found
+    // in the GLSL shader program. 
+    // * THIS IS THE BASIC METHOD TO UPDATE VALUES USED IN SHADER CODE!
+
+    // glBindVertexArray(VAO);           // ✅ Reactivate the same VAO for drawing
+    // glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+
+    profiler_.begin(drawSection_);
+    // Instances go into their streams first; then the draws are collected into the
+    // bucket with sort keys and executed in key order (program, then texture).
+    //
+    // Every view gets the world's commands again with its view in the key (the
+    // instances below are streamed ONCE, whatever the number of views); the layers
+    // over the whole window go to kWindowView, after all of them.
+    const std::uint32_t viewCount = packet.viewCount;
+    auto layerOf = [](std::uint32_t view, RenderLayer layer) {
+        return sortkey::viewLayer(view, static_cast<std::uint32_t>(layer));
+    };
+    const std::uint32_t uiLayer = layerOf(sortkey::kWindowView, RenderLayer::Ui);
+    commands_.clear();
+    std::size_t viewCommands = 0;
+    if (viewCount > 1) {
+        commands_.submit(sortkey::make(layerOf(sortkey::kWindowView, RenderLayer::Background), 0, 0, 0),
+                         SetViewCommand{&cameraUBO_, 0, {0, 0, targetWidth, targetHeight}, targetWidth, targetHeight,
+                                        0});
+        viewCommands = viewCount + 1;
+    }
+    std::size_t tilemapDraws = 0;
+    const bool drawTilemap = res_.tilemap->stats().chunks > 0;
+    if (drawTilemap) {
+        // Edits made since the last packet, then one re-bake per chunk they touched.
+        res_.tilemap->apply(packet.tileEdits.data(), packet.tileEdits.size());
+        res_.tilemap->update(static_cast<std::uint32_t>(res_.spriteArray->layers()));
+    }
+    std::size_t staticBatchDraws = 0;
+    if (res_.staticBatch) {
+        // In order: a region that came and went within one packet ends up released.
+        for (const StaticBatchEdit& edit : packet.sceneryEdits) {
+            if (edit.bake) {
+                res_.staticBatch->bake(static_cast<std::size_t>(edit.chunk), res_.level->entities(edit.chunk),
+                                       *res_.levelSprites, *res_.spriteAtlas);
+            } else {
+                res_.staticBatch->release(static_cast<std::size_t>(edit.chunk));
+            }
+        }
+    }
+    const bool drawStaticBatch = res_.staticBatch && res_.staticBatch->stats().chunks > 0;
+    const bool drawSkinned = skinned && packet.skinCharacters > 0;
+    if (drawSkinned) {
+        res_.skinnedMesh->upload(packet.skinPalette.data(), packet.skinBones, packet.skinCharacters);
+    }
+    const bool drawLights = res_.lightBuffer->initialized() &&
+                            (res_.lightBuffer->tiled() || programs_.light.id() != 0) &&
+                            programs_.lightComposite.id() != 0;
+    if (drawLights) {
+        // Tiled: the views' cameras and pixels, to bin the lights in.
+        LightBuffer::View lightViews[CameraUniformBuffer::kMaxViews];
+        for (std::uint32_t v = 0; v < packet.viewCount; ++v) {
+            const FrameView& view = packet.views[v];
+            lightViews[v].viewProjection = view.orthographic ? (view.orthoProjection * view.orthoView).toMat4()
+                                                             : view.projection * view.view;
+            lightViews[v].rect = viewPixels(view.rect, targetWidth, targetHeight);
+        }
+        res_.lightBuffer->begin(packet.lights.data(), packet.lights.size(), targetWidth, targetHeight, lightViews,
+                                packet.viewCount, &renderJobs_);
+    }
+    const bool drawParticles = res_.particleSystem->stats().count > 0 || particleDst;
+    const GLuint textTexture = res_.glyphCache->initialized() ? res_.glyphCache->texture() : res_.hudFont->texture();
+    if (!packet.uiWidgets.empty()) {
+        commands_.submit(sortkey::make(uiLayer, programs_.text.id(), textTexture, 0),
+                         DrawUiCommand{&uiRenderer_, &uiBatch_, &textBatch_, res_.hudFont, res_.glyphCache,
+                                       programs_.text.id(), &packet, &profiler_, uiDrawSection_});
+    }
+    if (packet.hudOverlay && !packet.hud.empty()) {
+        commands_.submit(sortkey::make(uiLayer, programs_.text.id(), textTexture, 1),   // over the UI
+                         DrawTextCommand{&hudBatch_, &textBatch_, res_.hudFont, res_.glyphCache, programs_.text.id(),
+                                         &packet, &profiler_, hudDrawSection_, packet.viewportWidth,
+                                         packet.viewportHeight});
+    }
+    std::size_t debugDraws = 0;
+    if (!packet.debugLines.empty() || !packet.debugTriangles.empty()) {
+        // World-space shapes: with several views, in the main camera's view only.
+        commands_.submit(sortkey::make(viewCount > 1 ? layerOf(0, RenderLayer::Ui) : uiLayer, programs_.debug.id(),
+                                       0, 0),
+                         DrawDebugCommand{&debugRenderer_, debugPipeline_, &packet, &debugDraws});
+    }
+    SpriteBatch::Stats spriteSum;
+    // What the world path streamed this frame, for every view to draw.
+    InstancedQuadRenderer* layeredRenderer = nullptr;
+    GLuint layeredDrawProgram = 0;
+    PipelineId layeredOpaqueDraw = PipelineLibrary::kDefault, layeredTranslucentDraw = PipelineLibrary::kDefault;
+    std::size_t layeredOpaque = 0, layeredTranslucent = 0;
+    // --oit: the translucent part unsorted, weighted and composited per view. Not with a
+    // multisampled scene, nor for clips (the animated program has no OIT variant).
+    const bool oitFrame = res_.oitBuffer->initialized() && scene && programs_.oit.id() != 0 &&
+                               programs_.oitComposite.id() != 0 && res_.oitBuffer->begin(*scene);
+    bool layeredOit = false;
+    bool drawAffine = false, drawQuads = false;
+    std::size_t streamedQuads = 0;  // instances in the stream every view draws
+    if (packet.path == FramePacket::Path::Sprites) {
+        // Nothing to stream: DrawSpritesCommand batches as it executes.
+    } else if (packet.path == FramePacket::Path::Layered) {
+        // Transform, layer (+ z-layer) and tint interleaved into the stream, written
+        // front to back: the opaque quads as they come, the depth test orders them; then
+        // the translucent ones, the only ones sorted (by z-layer, then higher on screen
+        // first: back to front for a top-down view; radix, stable). With clips
+        // (--sprite-animation) the instances are AnimatedInstances: the same + (start,
+        // rate), and the program picks each clip's frame.
+        const std::size_t count = packet.affine.size();
+        const bool animatedPacket = !packet.animations.empty() && programs_.animated.id() != 0;
+        InstancedQuadRenderer& renderer = animatedPacket ? *res_.animatedQuads : *res_.layeredQuads;
+        const GLuint program = animatedPacket ? programs_.animated.id() : programs_.layered.id();
+        LayeredInstance* layeredDst = animatedPacket ? nullptr : res_.layeredQuads->mapLayered(count);
+        AnimatedInstance* animatedDst = animatedPacket ? res_.animatedQuads->mapAnimated(count) : nullptr;
+        if (layeredDst || animatedDst) {
+            const std::uint32_t layers = static_cast<std::uint32_t>(res_.spriteArray->layers());
+            auto write = [&](std::size_t slot, std::size_t k) {
+                const std::uint32_t sprite = packet.sprites.empty() ? 0u : packet.sprites[k];
+                const std::uint32_t layer = isAnimatedSprite(sprite) && animatedPacket ? sprite
+                                          : layers > 0                                 ? sprite % layers
+                                                                                       : 0u;
+                const std::uint16_t z = packet.zLayers.empty() ? 0 : packet.zLayers[k];
+                const LayeredInstance instance{packet.affine[k], layeredLayer(layer, z),
+                                               packet.colors.empty() ? packet.spriteColor : packet.colors[k]};
+                if (animatedDst) {
+                    const glm::vec2 a = packet.animations[k];
+                    animatedDst[slot] = AnimatedInstance{instance.transform, instance.layer, instance.color, a.x, a.y};
+                } else {
+                    layeredDst[slot] = instance;
+                }
+            };
+            auto isOpaque = [&packet](std::size_t k) {
+                const std::uint32_t color = packet.colors.empty() ? packet.spriteColor : packet.colors[k];
+                return (color >> 24) == 0xffu;
+            };
+            // | z-layer (16 bits) | -y (24: the float's top bits) | index (24) |: only the
+            // top five bytes are sorted, the index rides along (and keeps equal keys in
+            // order: the sort is stable). 2^24 instances is far past what a frame draws.
+            auto translucentKey = [&packet](std::size_t k) {
+                const std::uint64_t z = packet.zLayers.empty() ? 0u : packet.zLayers[k];
+                std::uint32_t y;
+                std::memcpy(&y, &packet.affine[k].row1.z, sizeof y);
+                y = (y & 0x80000000u) ? ~y : y | 0x80000000u;   // float order as unsigned order
+                return z << 48 | static_cast<std::uint64_t>(~y >> 8) << 24 | k;
+            };
+            FrameVector<std::uint64_t> translucent; // translucentKey()s, sorted below
+            std::size_t opaque = 0;
+            for (std::size_t k = 0; k < count; ++k) {
+                if (isOpaque(k)) {
+                    write(opaque++, k);
+                } else {
+                    translucent.push_back(translucentKey(k));
+                }
+            }
+            // --oit: no order to put them in; the keys' low bits are still their indices.
+            layeredOit = oitFrame && !animatedPacket;
+            FrameVector<std::uint64_t> sortScratch(layeredOit ? 0 : translucent.size());
+            const std::uint64_t* sorted =
+                layeredOit ? translucent.data()
+                           : radixSort(renderJobs_, translucent.data(), sortScratch.data(), translucent.size(), 3, 8);
+            for (std::size_t t = 0; t < translucent.size(); ++t) {
+                write(opaque + t, static_cast<std::uint32_t>(sorted[t] & 0xffffffu));
+            }
+            layeredRenderer = &renderer;
+            layeredDrawProgram = program;
+            layeredOpaqueDraw = animatedPacket ? animatedOpaquePipeline_ : layeredOpaquePipeline_;
+            layeredTranslucentDraw = animatedPacket ? animatedTranslucentPipeline_ : layeredTranslucentPipeline_;
+            layeredOpaque = opaque;
+            layeredTranslucent = translucent.size();
+            streamedQuads = count;
+        }
+    } else if (packet.path == FramePacket::Path::Affine) {
+        const std::size_t count = packet.affine.size();
+        if (Affine2D* dst = res_.affineQuads->mapAffine(count)) {
+            std::memcpy(dst, packet.affine.data(), count * sizeof(Affine2D));
+            copyInstanceColors(packet, res_.affineQuads->mapColors(), count);
+            drawAffine = true;
+            streamedQuads = count;
+        }
+    } else {
+        // Instanced path: the composed matrices are one straight copy into the
+        // instance stream, the colours a second one after them, and one call draws
+        // them all.
+        const std::size_t count = packet.models.size();
+        if (glm::mat4* dst = res_.quads->mapInstances(count)) {
+            std::memcpy(dst, packet.models.data(), count * sizeof(glm::mat4));
+            copyInstanceColors(packet, res_.quads->mapColors(), count);
+            drawQuads = true;
+            streamedQuads = count;
+        }
+    }
+
+    // A view's commands, recorded into `bucket`: GL-free, so the views can be recorded
+    // by the render jobs at once (render/command_bucket.h, CommandRecorder) and gathered
+    // here, the only thread that replays them.
+    const GLuint spritePage = res_.spriteAtlas->pageCount() > 0 ? res_.spriteAtlas->pageTexture(0) : 0;
+    const GLuint playerImage = res_.textureLoader->texture(res_.playerTexture);
+    const glm::vec4 playerUv = res_.textureLoader->topDown(res_.playerTexture) ? glm::vec4(0.0f, 1.0f, 1.0f, 0.0f)
+                                                                               : glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+    auto recordView = [&](std::uint32_t v, CommandBucket& bucket) {
+        if (viewCount > 1) {
+            const glm::ivec4 rect = viewPixels(packet.views[v].rect, targetWidth, targetHeight);
+            // A view over another clears its rect, colour too unless the background
+            // fills it.
+            const GLbitfield clear =
+                !packet.views[v].clear ? 0
+                : backgroundCovers     ? GL_DEPTH_BUFFER_BIT
+                                       : GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT;
+            bucket.submit(sortkey::make(layerOf(v, RenderLayer::Background), 0, 0, 0),
+                          SetViewCommand{&cameraUBO_, static_cast<int>(v), rect, targetWidth, targetHeight, clear});
+        }
+        if (res_.virtualTexture->initialized()) {
+            bucket.submit(sortkey::make(layerOf(v, RenderLayer::Background), 0, 0, 1),
+                          DrawVirtualTextureCommand{res_.virtualTexture, programs_.virtualTexture.id(),
+                                                    packet.views[v].visible});
+        }
+        if (drawTilemap) {
+            bucket.submit(sortkey::make(layerOf(v, RenderLayer::Background), programs_.tilemap.id(),
+                                        res_.spriteArray->texture(), 0),
+                          DrawTilemapCommand{res_.tilemap, tilemapPipeline_, res_.spriteArray->texture(),
+                                             packet.views[v].visible, &tilemapDraws});
+        }
+        if (drawSkinned) {
+            bucket.submit(sortkey::make(layerOf(v, RenderLayer::World), programs_.skinned.id(), 0, 0),
+                          DrawSkinnedCommand{res_.skinnedMesh, skinnedPipeline_});
+        }
+        if (drawLights) {
+            bucket.submit(sortkey::make(layerOf(v, RenderLayer::Lighting), programs_.lightComposite.id(), 0, 0),
+                          ApplyLightingCommand{res_.lightBuffer, programs_.light.id(), programs_.lightComposite.id(),
+                                               scene ? scene->framebuffer() : 0,
+                                               viewPixels(packet.views[v].rect, targetWidth, targetHeight), v});
+        }
+        if (drawParticles) {
+            bucket.submit(sortkey::make(layerOf(v, RenderLayer::Overlay), programs_.particles.id(),
+                                        res_.spriteArray->texture(), 0),
+                          DrawParticlesCommand{particleDst ? nullptr : res_.particleSystem, res_.particleQuads,
+                                               particlePipeline_, res_.spriteArray->texture()});
+        }
+        const std::uint32_t world = layerOf(v, RenderLayer::World);
+        // Submitted first with the dynamic sprites' key: the stable sort draws it under them.
+        if (drawStaticBatch) {
+            bucket.submit(sortkey::make(world, programs_.sprite.id(), spritePage, 0),
+                          DrawStaticBatchCommand{res_.staticBatch, staticBatchPipeline_, packet.views[v].visible,
+                                                 &staticBatchDraws});
+        }
+        if (packet.path == FramePacket::Path::Sprites) {
+            bucket.submit(sortkey::make(world, programs_.sprite.id(), spritePage, 0),
+                          DrawSpritesCommand{&spriteBatch_, programs_.sprite.id(), &packet, res_.spriteAtlas,
+                                             playerImage, playerUv, &spriteSum, res_.wandererShape});
+        }
+        // Same program and texture: the depth field alone puts the opaque part first.
+        if (layeredOpaque > 0) {
+            bucket.submit(sortkey::make(world, layeredDrawProgram, res_.spriteArray->texture(), 0),
+                          DrawLayeredCommand{layeredRenderer, layeredOpaqueDraw, res_.spriteArray->texture(), 0,
+                                             static_cast<std::uint32_t>(layeredOpaque)});
+        }
+        if (layeredTranslucent > 0 && layeredOit) {
+            bucket.submit(sortkey::make(world, layeredDrawProgram, res_.spriteArray->texture(),
+                                        sortkey::depthBits(1.0f)),
+                          DrawOitCommand{res_.oitBuffer, layeredRenderer, layeredOitPipeline_,
+                                         programs_.oitComposite.id(), res_.spriteArray->texture(),
+                                         static_cast<std::uint32_t>(layeredOpaque),
+                                         static_cast<std::uint32_t>(layeredTranslucent), scene->framebuffer(),
+                                         viewPixels(packet.views[v].rect, targetWidth, targetHeight)});
+        } else if (layeredTranslucent > 0) {
+            bucket.submit(sortkey::make(world, layeredDrawProgram, res_.spriteArray->texture(),
+                                        sortkey::depthBits(1.0f)),
+                          DrawLayeredCommand{layeredRenderer, layeredTranslucentDraw, res_.spriteArray->texture(),
+                                             static_cast<std::uint32_t>(layeredOpaque),
+                                             static_cast<std::uint32_t>(layeredTranslucent)});
+        }
+        if (drawAffine) {
+            bucket.submit(sortkey::make(world, programs_.affine.id(), 0, 0),
+                          DrawInstancedCommand{res_.affineQuads, affinePipeline_});
+        }
+        if (drawQuads) {
+            bucket.submit(sortkey::make(world, programs_.quads.id(), 0, 0),
+                          DrawInstancedCommand{res_.quads, quadsPipeline_});
+        }
+    };
+    if (viewCount > 1 && renderJobs_.workerCount() > 0) {
+        commandRecorder_.clear();
+        renderJobs_.parallelFor(viewCount, 1, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t v = begin; v < end; ++v) {
+                recordView(static_cast<std::uint32_t>(v), commandRecorder_.local());
+            }
+        });
+        commandRecorder_.gatherInto(commands_);
+    } else {
+        for (std::uint32_t v = 0; v < viewCount; ++v) {
+            recordView(v, commands_);
+        }
+    }
+    commands_.sort();
+    windowCommands = commands_.lowerBound(sortkey::make(uiLayer, 0, 0, 0));
+
+    // --gpu-pick: the oldest readback that has arrived goes back to main with the packet;
+    // this packet's click, if any, is drawn into the picker's own target (the "pick" pass).
+    packet.picked = GpuPicker::Result{};
+    if (gpuPick) {
+        res_.gpuPicker->poll(packet.picked);
+    }
+    // --procgen-gpu: this packet's chunks queued and the fields read back since
+    // classified into their chunks' tiles (main places them); the "noise" pass draws a
+    // batch of the oldest.
+    if (gpuFields) {
+        res_.gpuNoise->queue(packet.noiseRequests.data(), packet.noiseRequests.size());
+        res_.gpuNoise->poll(
+            [](void* world, std::int32_t chunk, const float* fields, std::size_t stride) {
+                static_cast<WorldGenerator*>(world)->supplyFields(chunk, fields, stride);
+            },
+            res_.worldGen);
+    }
+    commandContext_.reset();       // per-frame stats; state outside the bucket is unknown
+    frameGraph_.execute();         // the passes declared above, in the graph's order
+
+    res_.quads->endFrame();             // fence this frame's slice of each stream
+    res_.affineQuads->endFrame();
+    res_.layeredQuads->endFrame();
+    if (settings_.animated) {
+        res_.animatedQuads->endFrame();
+    }
+    if (skinned) {
+        res_.skinnedMesh->endFrame();
+    }
+    res_.particleQuads->endFrame();
+    res_.lightBuffer->endFrame();
+    debugRenderer_.endFrame();
+    hudBatch_.endFrame();
+    uiBatch_.endFrame();
+    spriteBatch_.endFrame();
+    commandContext_.draws().endFrame();
+    res_.gpuPicker->endFrame();
+    renderTargets_.endFrame();     // the graph's transients went back as it finished
+    packet.stats = RenderStats{};
+    packet.stats.drawCalls = packet.path == FramePacket::Path::Sprites ? spriteSum.batches
+                                                                  : commands_.size() - viewCommands;
+    if (res_.tilemap->stats().chunks > 0) {
+        // Its command per view is a draw per chunk on screen, or the one quad (and not a
+        // sprite batch).
+        packet.stats.drawCalls += tilemapDraws;
+        packet.stats.drawCalls -= packet.path == FramePacket::Path::Sprites ? 0 : viewCount;
+    }
+    if (res_.virtualTexture->initialized() && packet.path == FramePacket::Path::Sprites) {
+        packet.stats.drawCalls += viewCount;          // its quad per view (one command each)
+    }
+    if (drawStaticBatch) {
+        // A draw per run of each chunk on screen, for its one command per view.
+        packet.stats.drawCalls += staticBatchDraws;
+        packet.stats.drawCalls -= packet.path == FramePacket::Path::Sprites ? 0 : viewCount;
+    }
+    if (drawLights) {
+        // Two per view: the lights and the composite (tiled: the composite only).
+        const std::uint32_t lightDraws = res_.lightBuffer->tiled() ? 1 : 2;
+        packet.stats.drawCalls += packet.path == FramePacket::Path::Sprites ? lightDraws * viewCount
+                                                                      : (lightDraws - 1) * viewCount;
+    }
+    if (layeredOit && layeredTranslucent > 0) {
+        packet.stats.drawCalls += viewCount;          // the composite after each view's quads
+    }
+    if (packet.hudOverlay && !packet.hud.empty()) {
+        packet.stats.drawCalls += hudBatch_.stats().batches; // one, unless it has a huge amount of text
+        packet.stats.drawCalls -= packet.path == FramePacket::Path::Sprites ? 0 : 1;
+    }
+    if (!packet.uiWidgets.empty()) {
+        packet.stats.drawCalls += uiBatch_.stats().batches;  // likewise
+        packet.stats.drawCalls -= packet.path == FramePacket::Path::Sprites ? 0 : 1;
+    }
+    if (!packet.debugLines.empty() || !packet.debugTriangles.empty()) {
+        packet.stats.drawCalls += debugDraws;         // lines and fills: up to two
+        packet.stats.drawCalls -= packet.path == FramePacket::Path::Sprites ? 0 : 1;
+    }
+    if (scene) {
+        // Graph passes, not commands: --post's draws (present's blit is none), the heatmap.
+        packet.stats.drawCalls += static_cast<std::size_t>(postChain_.stats().passes);
+        packet.stats.drawCalls += overdraw_.enabled() ? 1 : 0;
+    }
+    // What was drawn, and why it took that many draws: the context's binding changes
+    // between commands, the sprite batches' flushes within theirs.
+    const std::size_t particlesDrawn =
+        !drawParticles ? 0 : particleDst ? packet.particles.size() : res_.particleSystem->stats().count;
+    packet.stats.instances = (streamedQuads + particlesDrawn) * viewCount;
+    const CommandContext::Stats& contextStats = commandContext_.stats();
+    packet.stats.commands = contextStats.commands;
+    packet.stats.programBreaks = contextStats.programChanges;
+    packet.stats.textureBreaks = contextStats.textureChanges;
+    packet.stats.pipelineBreaks = contextStats.pipelineChanges;
+    auto addBatch = [&packet](const SpriteBatch::Stats& batch) {
+        packet.stats.instances += batch.sprites;
+        packet.stats.batches += batch.batches;
+        packet.stats.programBreaks += batch.programBreaks;
+        packet.stats.textureBreaks += batch.textureBreaks;
+        packet.stats.capacityBreaks += batch.capacityBreaks;
+    };
+    addBatch(spriteSum);
+    if (packet.hudOverlay && !packet.hud.empty()) {
+        addBatch(hudBatch_.stats());
+    }
+    if (!packet.uiWidgets.empty()) {
+        addBatch(uiBatch_.stats());
+    }
+    packet.stats.vertices = packet.stats.instances * RenderStats::kQuadVertices;
+
+    // Old single-draw call reference:
+    // | Argument          | Meaning                                         |
+    // | ----------------- | ----------------------------------------------- |
+    // | `GL_TRIANGLES`    | Draws one triangle per 3 indices                |
+    // | `3`               | Number of indices to use                        |
+    // | `GL_UNSIGNED_INT` | Type of the indices in the EBO (`unsigned int`) |
+    // | `0`               | Offset in the EBO (start at beginning)          |
+
+    // ! NOTE: glDrawElements would be better suited for my game.
+    // ! glDrawElements allows you to draw objects that share vertices w/o
+    // ! having to duplicate the shared vertices.
+
+    profiler_.end(drawSection_);
+    packet.stats.stateIssued = glstate::stats().issued() - stateIssuedBefore;
+    packet.stats.stateFiltered = glstate::stats().filtered() - stateFilteredBefore;
+    packet.stats.uploadBytes = StreamBuffer::bytesStreamed() - streamedBefore;
+    packet.stats.trace();
+    packet.overdraw = overdraw_.stats().average;
+    packet.overdrawMax = overdraw_.stats().max;
+    packet.gpuMemory = gpumemory::totals().total;
+    packet.gpuAvailable = packet.hud.empty() ? 0 : gpumemory::driver().availableBytes;
+    const glstall::Frame stalls = glstall::takeFrame();
+    packet.glStalls = stalls.stalls;
+    packet.glStallMs = stalls.ms;
+
+    // The finished back buffer, queued for readback before the swap hands it over.
+    frameCapture_.capture(packet.viewportWidth, packet.viewportHeight);
+    // Only the colour is shown: the window's depth and stencil aren't stored.
+    glframebuffer::discard(0, GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+    profiler_.begin(swapSection_);
+    glfwSwapBuffers(res_.window);          // Present the frame (double buffering)
+    profiler_.end(swapSection_);
+    photonLatency_.presented(packet.inputTime, monoclock::seconds());
+    packet.latency = photonLatency_.summary();
+    if (!firstFramePresented_) {
+        firstFramePresented_ = true;
+        res_.startupTimeline->mark("first frame");
+        std::cout << "Startup: " << res_.startupTimeline->totalMs() << " ms to the first frame\n";
+        if (settings_.profile || settings_.startupBench) {
+            res_.startupTimeline->report(std::cout);
+        }
+        if (!settings_.startupBenchCsv.empty() &&
+            !res_.startupTimeline->appendCsv(settings_.startupBenchCsv, settings_.buildStamp)) {
+            std::cerr << "Startup bench: can't append to " << settings_.startupBenchCsv << "\n";
+        }
+        startupMeasured_.store(true, std::memory_order_release);
+    }
+    if (res_.profilerWindow && packet.hudWindowWidth > 0 && !packet.hud.empty()) {
+        // The same thread, the other context: the font, program and buffers are shared,
+        // the bind cache is not per context, so it starts over on each switch.
+        glfwMakeContextCurrent(res_.profilerWindow);
+        glstate::invalidate();
+        glstate::viewport(0, 0, packet.hudWindowWidth, packet.hudWindowHeight);
+        glClearColor(0.08f, 0.08f, 0.1f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        CommandContext profilerContext;
+        DrawTextCommand::execute(DrawTextCommand{res_.profilerBatch, &textBatch_, res_.hudFont, res_.glyphCache,
+                                                 programs_.text.id(), &packet, &profiler_, profilerWindowSection_,
+                                                 packet.hudWindowWidth, packet.hudWindowHeight},
+                                 profilerContext);
+        res_.profilerBatch->endFrame();
+        glfwSwapBuffers(res_.profilerWindow);
+        glfwMakeContextCurrent(res_.window);
+        glstate::invalidate();
+    }
+    glresource::collect();            // names dropped this frame get a fence; done ones go
+    gldebug::poll();                  // without KHR_debug: this frame's GL errors
+    profiler_.endFrame();
+    PerfHud::capture(profiler_, packet.renderTimings);
+    if (dynamicScale_) {
+        dynamicResolution_.update(profiler_.gpuFrame().last()); // for the next packet
+    }
+
+    if (!packet.report.empty()) {
+        report(packet, offscreenScene, drawLights);
+    }
+    packet.renderAllocations = alloccount::thread() - allocationsBefore;
+}
+
+// --profile, every 2 s: main's table (the packet's report), then the render thread's.
+void FrameRenderer::report(const FramePacket& packet, bool offscreenScene, bool drawLights) {
+    std::cout << packet.report << "render thread:\n";
+    profiler_.report(std::cout);
+    const CommandContext::Stats& cs = commandContext_.stats();
+    std::cout << "commands " << cs.commands << ", program changes " << cs.programChanges
+              << ", texture changes " << cs.textureChanges << ", pipeline changes " << cs.pipelineChanges
+              << "\n";
+    const PipelineLibrary::Stats& pls = pipelines_.stats();
+    std::cout << "pipelines " << pipelines_.size() << ": " << pls.binds << " binds (" << pls.repeated
+              << " repeated), " << pls.applied << " state sets, " << pls.skipped << " skipped by the diffs\n";
+    pipelines_.resetStats();
+    const MultiDraw::Stats& md = commandContext_.draws().stats();
+    std::cout << "multi-draw " << md.draws << " draws in " << md.calls << " calls (" << md.multiDraws
+              << " indirect)\n";
+    commandContext_.draws().resetStats();
+    glstate::report(std::cout);   // since the previous report
+    glresource::report(std::cout);
+    gldebug::report(std::cout);
+    glstall::report(std::cout);
+    glframebuffer::report(std::cout);
+    gpumemory::report(std::cout);
+    res_.vertexArrays->report(std::cout);
+    {
+        const MeshPool::Stats ms = res_.meshes->stats();
+        std::cout << "mesh pool " << ms.meshes << " meshes, " << ms.vertices << "/" << ms.vertexCapacity
+                  << " vertices, " << ms.indices << "/" << ms.indexCapacity << " indices\n";
+    }
+    frameGraph_.report(std::cout);
+    if (offscreenScene) {
+        const RenderTargetPool::Stats rs = renderTargets_.stats();
+        std::cout << "render targets " << rs.targets << " (" << rs.inUse << " in use), " << rs.bytes / 1024
+                  << " KiB, " << rs.created << " created, " << rs.reused << " reused\n";
+    }
+    if (res_.staticBatch) {
+        const StaticBatch::Stats& sb = res_.staticBatch->stats();
+        std::cout << "static batch " << sb.chunks << " chunks, " << sb.quads << " quads ("
+                  << sb.vertexBytes / 1024 << " KiB), " << sb.draws << " draws of " << sb.drawnQuads
+                  << " quads last view, " << sb.bakes << " baked\n";
+    }
+    if (overdraw_.enabled()) {
+        overdraw_.report(std::cout);
+    }
+    if (postChain_.enabled()) {
+        const PostProcessChain::Stats& pp = postChain_.stats();
+        std::cout << "post " << pp.passes << " passes (" << pp.fused << " effects fused into the last), "
+                  << pp.pixels / 1000 << "K pixels shaded\n";
+    }
+    if (res_.gpuPicker->initialized()) {
+        const GpuPicker::Stats& gs = res_.gpuPicker->stats();
+        std::cout << "gpu pick " << gs.picks << " picks, " << gs.instances << " instances drawn, "
+                  << gs.dropped << " dropped\n";
+    }
+    if (frameCapture_.enabled()) {
+        const FrameCapture::Stats fs = frameCapture_.stats();
+        std::cout << "capture " << fs.captured << " read back, " << fs.written << " written ("
+                  << fs.bytes / 1024 << " KiB), " << fs.waits << " waits, " << fs.stalls << " writer stalls, "
+                  << fs.dropped << " dropped, "
+                  << fs.failed << " failed\n";
+    }
+    if (dynamicScale_) {
+        const DynamicResolution::Stats& ds = dynamicResolution_.stats();
+        std::cout << "dynamic resolution " << dynamicResolution_.scale() << "x, gpu " << ds.smoothedMs
+                  << " ms (target " << dynamicResolution_.settings().targetMs << "), lowered "
+                  << ds.lowered << ", raised " << ds.raised << "\n";
+    }
+    glstate::resetStats();
+    const TextureLoader::Stats ts = res_.textureLoader->stats();
+    if (ts.requested > 0) {
+        std::cout << "textures " << ts.ready << "/" << ts.requested << " ready, " << ts.failed
+                  << " failed, " << ts.evicted << " evicted, " << ts.transcoded << " transcoded, "
+                  << ts.uploadedBytes / 1024 << " KiB uploaded, " << ts.residentBytes / 1024
+                  << " KiB resident, " << ts.cachedBytes / 1024 << " KiB cached (" << ts.cacheHits
+                  << " hits)\n";
+    }
+    res_.textureLoader->resetFrameStats();
+    if (drawLights) {
+        const LightBuffer::Stats& ls = res_.lightBuffer->stats();
+        if (res_.lightBuffer->tiled()) {
+            std::cout << "lights " << ls.lights << " binned into " << ls.tiles << " tiles, "
+                      << ls.tileEntries << " entries (" << ls.clipped << " over "
+                      << LightBuffer::kMaxLightsPerTile << " per tile left out)\n";
+        } else {
+            std::cout << "lights " << ls.lights << " drawn into " << ls.width << "x" << ls.height << "\n";
+        }
+    }
+    if (res_.virtualTexture->initialized()) {
+        const VirtualTexture::Stats vs = res_.virtualTexture->stats();
+        std::cout << "virtual texture " << vs.resident << " pages resident, " << vs.wanted << " wanted, "
+                  << vs.pending << " pending; " << vs.loads << " loaded, " << vs.uploads << " uploaded, "
+                  << vs.evictions << " evicted, " << vs.dropped << " dropped, " << vs.feedbacks
+                  << " feedbacks\n";
+    }
+}
@@ -0,0 +1,271 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "core/job_system.h"
+#include "core/world_position.h"
+#include "profile/input_latency.h"
+#include "profile/profiler.h"
+#include "render/camera_ubo.h"
+#include "render/command_bucket.h"
+#include "render/debug_draw.h"
+#include "render/dynamic_resolution.h"
+#include "render/frame_capture.h"
+#include "render/frame_packet.h"
+#include "render/overdraw.h"
+#include "render/pipeline_state.h"
+#include "render/post_process.h"
+#include "render/render_graph.h"
+#include "render/render_target.h"
+#include "render/shader_program.h"
+#include "render/shape_cache.h"
+#include "render/sprite_batch.h"
+#include "render/text_batch.h"
+#include "render/texture_loader.h"
+#include "render/ui_renderer.h"
+
+struct GLFWwindow;
+class AnimationClipTable;
+class FramePacer;
+class GlyphCache;
+class GpuNoise;
+class GpuPicker;
+class InstancedQuadRenderer;
+class LevelFile;
+class LightBuffer;
+class MeshPool;
+class OitBuffer;
+class ParticleSystem;
+class SdfFont;
+class ShaderReloader;
+class SkinnedMeshRenderer;
+class StartupTimeline;
+class StaticBatch;
+class TextureArray;
+class TextureAtlas;
+class Tilemap;
+class VertexArrayCache;
+class VirtualTexture;
+class WorldGenerator;
+
+// FrameRenderer
+// -------------
+// Every GL call of a frame, made with nothing but the packet the main thread submitted
+// (render/frame_packet.h): render(packet) is what RenderThread runs, on the render thread
+// or inline with --no-render-thread. main() builds the packet and hands it over.
+//
+// | Owned                                   | What for                                    |
+// | --------------------------------------- | ------------------------------------------- |
+// | Programs                                | every program a frame binds; main links     |
+// |                                         | them, the ShaderReloader swaps them         |
+// | PipelineLibrary                         | the pipelined commands' program and state   |
+// | CameraUniformBuffer                     | the views' matrices, uploaded when changed  |
+// | RenderTargetPool, RenderGraph           | the offscreen scene, each packet's passes   |
+// | PostProcessChain, OverdrawMeter         | --post, --overdraw: passes of the graph     |
+// | FrameCapture, DynamicResolution         | --capture, --dynamic-resolution             |
+// | CommandBucket, CommandContext, JobSystem| the frame's sorted draws, recorded per view |
+// | sprite / HUD / UI batches, debug shapes | the packet's immediate-mode geometry        |
+// | Profiler, InputLatency                  | the render thread's sections, input→photon  |
+//
+// The scene's renderers, the world and the window are main's and only borrowed
+// (Resources): main creates them, reads their stats and shuts them down.
+//
+// | Call             | When                                                         |
+// | ---------------- | ------------------------------------------------------------ |
+// | programs()       | main links into it, then sets the programs' uniforms         |
+// | init(settings)   | right after the link: camera UBO, post chain, pipelines      |
+// | attach(res)      | before RenderThread::start(): what it draws, and the rest    |
+// | render(packet)   | every packet, on whichever thread renders                    |
+// | shutdown()       | after RenderThread::stop(), with the context current again   |
+//
+// The GL objects it borrows belong to the render side from RenderThread::start() until
+// RenderThread::stop(), as its own do.
+class FrameRenderer {
+public:
+    struct Programs {
+        ShaderProgram quads;            // the instanced path's
+        ShaderProgram affine;
+        ShaderProgram layered;
+        ShaderProgram sprite;
+        ShaderProgram tilemap;
+        ShaderProgram particleUpdate;
+        ShaderProgram particles;
+        ShaderProgram text;
+        ShaderProgram debug;
+        ShaderProgram heatmap;
+        ShaderProgram postBright;
+        ShaderProgram postBlur;
+        ShaderProgram postFinal;
+        ShaderProgram pick;
+        ShaderProgram noise;
+        ShaderProgram animated;
+        ShaderProgram skinned;
+        ShaderProgram virtualTexture;
+        ShaderProgram virtualFeedback;
+        ShaderProgram light;
+        ShaderProgram lightComposite;
+        ShaderProgram oit;
+        ShaderProgram oitComposite;
+        ShaderProgram particleCull;     // only with --gpu-cull's support
+    };
+
+    struct Settings {
+        int views = 1;                  // camera blocks: 1 + --split + --minimap
+        std::uint32_t post = 0;         // --post's PostProcessChain effects
+        bool overdraw = false;          // --overdraw
+        OverdrawMeter::Count overdrawCount = OverdrawMeter::Count::Rasterized;
+        bool oit = false;               // --oit
+        bool animated = false;          // --sprite-animation
+        float renderScale = 1.0f;       // --render-scale, the lowest dynamic scale
+        int msaa = 1;
+        double dynamicResolutionMs = 0.0;
+        bool capture = false;
+        FrameCapture::Settings captureSettings;
+        int renderJobs = 2;             // --render-jobs
+        bool profile = false;           // the startup timeline's report after the first frame
+        bool startupBench = false;      // ... likewise
+        std::string startupBenchCsv;    // ... and a row appended to it
+        const char* buildStamp = "";
+        glm::vec4 clearColor{0.0f, 0.0f, 0.0f, 1.0f};
+    };
+
+    // Borrowed for render(): main's, alive until shutdown(). staticBatch is null without
+    // --level's baked scenery, worldGen without a generated world.
+    struct Resources {
+        GLFWwindow* window = nullptr;
+        GLFWwindow* profilerWindow = nullptr;   // --profiler-window
+        SpriteBatch* profilerBatch = nullptr;   // ... made on its context
+        FramePacer* pacer = nullptr;
+        StartupTimeline* startupTimeline = nullptr;
+        ShaderReloader* shaderReloader = nullptr;
+        TextureLoader* textureLoader = nullptr;
+        TextureLoader::Handle playerTexture = TextureLoader::kInvalidHandle;
+        GlyphCache* glyphCache = nullptr;
+        const SdfFont* hudFont = nullptr;
+        const TextureAtlas* spriteAtlas = nullptr;
+        const TextureArray* spriteArray = nullptr;
+        const ShapeCache::Shape* wandererShape = nullptr;
+        InstancedQuadRenderer* quads = nullptr;
+        InstancedQuadRenderer* affineQuads = nullptr;
+        InstancedQuadRenderer* layeredQuads = nullptr;
+        InstancedQuadRenderer* animatedQuads = nullptr;
+        InstancedQuadRenderer* particleQuads = nullptr;
+        ParticleSystem* particleSystem = nullptr;
+        SkinnedMeshRenderer* skinnedMesh = nullptr;
+        LightBuffer* lightBuffer = nullptr;
+        OitBuffer* oitBuffer = nullptr;
+        GpuPicker* gpuPicker = nullptr;
+        GpuNoise* gpuNoise = nullptr;
+        WorldGenerator* worldGen = nullptr;
+        Tilemap* tilemap = nullptr;
+        StaticBatch* staticBatch = nullptr;
+        const LevelFile* level = nullptr;
+        const std::vector<std::uint32_t>* levelSprites = nullptr;
+        VirtualTexture* virtualTexture = nullptr;
+        AnimationClipTable* spriteClips = nullptr;
+        const MeshPool* meshes = nullptr;               // for the reports
+        const VertexArrayCache* vertexArrays = nullptr;
+    };
+
+    FrameRenderer() = default;
+    FrameRenderer(const FrameRenderer&) = delete;
+    FrameRenderer& operator=(const FrameRenderer&) = delete;
+
+    Programs& programs() { return programs_; }
+    void init(const Settings& settings);
+    void attach(const Resources& resources);
+    void render(FramePacket& packet);
+    void shutdown();
+
+    // The chain's uniforms are set again when the ShaderReloader swaps its programs.
+    PostProcessChain& post() { return postChain_; }
+    const Profiler& profiler() const { return profiler_; }
+    const InputLatency& latency() const { return photonLatency_; }
+    const FrameCapture& capture() const { return frameCapture_; }
+    // The first frame is presented and the startup timeline complete (--startup-bench).
+    bool startupMeasured() const { return startupMeasured_.load(std::memory_order_acquire); }
+
+private:
+    struct PipelineProgram {
+        PipelineId pipeline;
+        const ShaderProgram* program;
+    };
+
+    PipelineId makePipeline(const char* name, const ShaderProgram& program, const BlendState& blendState,
+                            const DepthState& depth = DepthState{});
+    bool isOffscreen(float scale, int samples) const;
+    void report(const FramePacket& packet, bool offscreenScene, bool drawLights);
+
+    Settings settings_;
+    Resources res_;
+    Programs programs_;
+
+    // Pipelines: each pipelined command's program and fixed-function state, validated once
+    // and bound as a unit (render/pipeline_state.h). Their programs are refreshed every
+    // frame, since a hot reload swaps them.
+    PipelineLibrary pipelines_;
+    std::vector<PipelineProgram> pipelinePrograms_;
+    PipelineId quadsPipeline_ = PipelineLibrary::kDefault;
+    PipelineId affinePipeline_ = PipelineLibrary::kDefault;
+    PipelineId layeredOpaquePipeline_ = PipelineLibrary::kDefault;
+    PipelineId layeredTranslucentPipeline_ = PipelineLibrary::kDefault;
+    PipelineId layeredOitPipeline_ = PipelineLibrary::kDefault;
+    PipelineId animatedOpaquePipeline_ = PipelineLibrary::kDefault;
+    PipelineId animatedTranslucentPipeline_ = PipelineLibrary::kDefault;
+    PipelineId tilemapPipeline_ = PipelineLibrary::kDefault;
+    PipelineId staticBatchPipeline_ = PipelineLibrary::kDefault;
+    PipelineId skinnedPipeline_ = PipelineLibrary::kDefault;
+    PipelineId particlePipeline_ = PipelineLibrary::kDefault;
+    PipelineId debugPipeline_ = PipelineLibrary::kDefault;
+
+    CameraUniformBuffer cameraUBO_;
+    std::uint64_t uploadedCameraVersions_[CameraUniformBuffer::kMaxViews]; // per view block
+    WorldPosition uploadedOrigin_;          // FramePacket::origin the blocks were built for
+    RenderTargetPool renderTargets_;        // --render-scale / --msaa: the offscreen scene
+    RenderGraph frameGraph_;                // each packet's passes and their targets
+    PostProcessChain postChain_;
+    OverdrawMeter overdraw_;
+    FrameCapture frameCapture_;
+    DynamicResolution dynamicResolution_;
+    bool dynamicScale_ = false;
+
+    CommandBucket commands_;                // this frame's draws, sorted by key
+    CommandContext commandContext_;
+    // --render-jobs: the render side's own workers. Not the main JobSystem: its run()/wait()
+    // belong to the threads it knows, and the main thread is busy simulating the next frame
+    // meanwhile. Started by the first packet, so on whichever thread renders.
+    JobSystem renderJobs_;
+    CommandRecorder commandRecorder_;       // with several views: one bucket per render job
+    bool renderJobsStarted_ = false;
+
+    SpriteBatch spriteBatch_;
+    // The HUD and the tools panel have batches of their own, so the sprite path's batch
+    // stats stay its own.
+    SpriteBatch hudBatch_;
+    SpriteBatch uiBatch_;
+    UiRenderer uiRenderer_;
+    TextBatch textBatch_;
+    DebugDrawRenderer debugRenderer_;
+
+    // CPU + GPU time per section (profile/profiler.h): the render thread's own Profiler.
+    Profiler profiler_;
+    Profiler::SectionId clearSection_ = 0;
+    Profiler::SectionId uploadSection_ = 0;
+    Profiler::SectionId particleSection_ = 0;
+    Profiler::SectionId drawSection_ = 0;
+    Profiler::SectionId swapSection_ = 0;
+    Profiler::SectionId hudDrawSection_ = 0;
+    Profiler::SectionId uiDrawSection_ = 0;
+    Profiler::SectionId profilerWindowSection_ = 0;
+    // Input to swap and to GPU completion, per packet that carried an input (its inputTime).
+    InputLatency photonLatency_;
+
+    glm::vec4 appliedClearColor_{0.0f};     // what glClearColor was last given
+    bool firstFramePresented_ = false;      // marks the end of the startup timeline
+    std::atomic<bool> startupMeasured_{false}; // ... and tells main (--startup-bench)
+};
@@ -0,0 +1,70 @@
+#include "render/gl_buffer.h"
+
+#include "render/gl_ext.h"
+#include "render/gl_state.h"
+#include "render/gpu_memory.h"
+
+namespace glbuffer {
+namespace {
+
+// The GL 3.3 path: `buffer` on `target`, outside any VAO if it's an index buffer.
+void bind(GLenum target, GLuint buffer) {
+    if (target == GL_ELEMENT_ARRAY_BUFFER) {
+        glstate::bindVertexArray(0);
+    }
+    glstate::bindBuffer(target, buffer);
+}
+
+} // namespace
+
+bool direct() {
+    return glext::caps().directStateAccess;
+}
+
+void data(GLenum target, GLuint buffer, GLsizeiptr size, const void* data, GLenum usage) {
+    gpumemory::trackBuffer(target, buffer, static_cast<std::size_t>(size));
+    if (direct()) {
+        glext::namedBufferData(buffer, size, data, usage);
+        return;
+    }
+    bind(target, buffer);
+    glBufferData(target, size, data, usage);
+}
+
+void subData(GLenum target, GLuint buffer, GLintptr offset, GLsizeiptr size, const void* data) {
+    if (direct()) {
+        glext::namedBufferSubData(buffer, offset, size, data);
+        return;
+    }
+    bind(target, buffer);
+    glBufferSubData(target, offset, size, data);
+}
+
+void storage(GLenum target, GLuint buffer, GLsizeiptr size, const void* data, GLbitfield flags) {
+    gpumemory::trackBuffer(target, buffer, static_cast<std::size_t>(size));
+    if (direct() && glext::namedBufferStorage) {
+        glext::namedBufferStorage(buffer, size, data, flags);
+        return;
+    }
+    bind(target, buffer);
+    glext::bufferStorage(target, size, data, flags);
+}
+
+void* mapRange(GLenum target, GLuint buffer, GLintptr offset, GLsizeiptr length, GLbitfield access) {
+    if (direct()) {
+        return glext::mapNamedBufferRange(buffer, offset, length, access);
+    }
+    bind(target, buffer);
+    return glMapBufferRange(target, offset, length, access);
+}
+
+void unmap(GLenum target, GLuint buffer) {
+    if (direct()) {
+        glext::unmapNamedBuffer(buffer);
+        return;
+    }
+    bind(target, buffer);
+    glUnmapBuffer(target);
+}
+
+} // namespace glbuffer
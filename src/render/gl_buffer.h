@@ -0,0 +1,39 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// gl_buffer
+// ---------
+// Buffer edits by name. With direct state access (glext::caps().directStateAccess, GL 4.5
+// or ARB_direct_state_access) each call goes straight to the named object; without it,
+// the buffer is bound to `target` first (through glstate, so an edit of what is already
+// bound costs no bind) and left bound there:
+//
+// | Call      | DSA                     | GL 3.3                                      |
+// | --------- | ----------------------- | ------------------------------------------- |
+// | data      | glNamedBufferData       | glBindBuffer + glBufferData                 |
+// | subData   | glNamedBufferSubData    | glBindBuffer + glBufferSubData              |
+// | storage   | glNamedBufferStorage    | glBindBuffer + glext::bufferStorage         |
+// | mapRange  | glMapNamedBufferRange   | glBindBuffer + glMapBufferRange             |
+// | unmap     | glUnmapNamedBuffer      | glBindBuffer + glUnmapBuffer                |
+//
+// So on 4.5 streaming a buffer never disturbs a binding, and creating one (with
+// GlBuffer::create, glCreateBuffers there) needs no bind at all. Without DSA, binding an
+// index buffer would record it into whatever VAO is bound: for GL_ELEMENT_ARRAY_BUFFER
+// the fallback binds VAO 0 first, so an edit never changes a VAO either way.
+//
+// data and storage also record the buffer's size with render/gpu_memory.h.
+//
+// GL thread only, like every GL call.
+namespace glbuffer {
+
+bool direct();                      // glext::caps().directStateAccess
+
+void data(GLenum target, GLuint buffer, GLsizeiptr size, const void* data, GLenum usage);
+void subData(GLenum target, GLuint buffer, GLintptr offset, GLsizeiptr size, const void* data);
+// Needs glext::caps().bufferStorage.
+void storage(GLenum target, GLuint buffer, GLsizeiptr size, const void* data, GLbitfield flags);
+void* mapRange(GLenum target, GLuint buffer, GLintptr offset, GLsizeiptr length, GLbitfield access);
+void unmap(GLenum target, GLuint buffer);
+
+} // namespace glbuffer
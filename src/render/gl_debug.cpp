@@ -0,0 +1,232 @@
+#include "render/gl_debug.h"
+
+#include "render/gl_ext.h"
+
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <ostream>
+
+#include "core/log.h"
+
+namespace gldebug {
+
+bool parse(const char* text, Mode& mode) {
+    if (std::strcmp(text, "on") == 0) {
+        mode = Mode::On;
+    } else if (std::strcmp(text, "sync") == 0) {
+        mode = Mode::Sync;
+    } else if (std::strcmp(text, "off") == 0) {
+        mode = Mode::Off;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+#if GL_DEBUG
+
+namespace {
+
+constexpr int kMaxDistinct = 256;      // messages remembered; past them, new ones are only counted
+constexpr int kTextSize = 96;          // of each, for report()
+constexpr int kReported = 5;           // most repeated ones in report()
+
+struct Seen {
+    GLenum source;
+    GLenum type;
+    GLuint id;
+    std::uint64_t count;
+    char text[kTextSize];
+};
+
+struct State {
+    std::mutex mutex;                  // the callback may come from a driver thread
+    Seen seen[kMaxDistinct];
+    int seenCount = 0;
+    Stats stats;
+    bool installed = false;
+    bool callback = false;             // false: the glGetError poll
+};
+
+State& state() {
+    static State s;
+    return s;
+}
+
+const char* typeName(GLenum type) {
+    switch (type) {
+        case GL_DEBUG_TYPE_ERROR:               return "error";
+        case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: return "deprecated";
+        case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:  return "undefined behavior";
+        case GL_DEBUG_TYPE_PORTABILITY:         return "portability";
+        case GL_DEBUG_TYPE_PERFORMANCE:         return "performance";
+        default:                                return "other";
+    }
+}
+
+const char* errorName(GLenum error) {
+    switch (error) {
+        case GL_INVALID_ENUM:                  return "GL_INVALID_ENUM";
+        case GL_INVALID_VALUE:                 return "GL_INVALID_VALUE";
+        case GL_INVALID_OPERATION:             return "GL_INVALID_OPERATION";
+        case GL_INVALID_FRAMEBUFFER_OPERATION: return "GL_INVALID_FRAMEBUFFER_OPERATION";
+        case GL_OUT_OF_MEMORY:                 return "GL_OUT_OF_MEMORY";
+        default:                               return "unknown GL error";
+    }
+}
+
+// Counts the message; true the first time it is seen (then it is logged).
+bool remember(GLenum source, GLenum type, GLuint id, const char* text, std::size_t length) {
+    State& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    ++s.stats.messages;
+    s.stats.errors += type == GL_DEBUG_TYPE_ERROR ? 1 : 0;
+    s.stats.performance += type == GL_DEBUG_TYPE_PERFORMANCE ? 1 : 0;
+    for (int i = 0; i < s.seenCount; ++i) {
+        Seen& seen = s.seen[i];
+        if (seen.id == id && seen.type == type && seen.source == source) {
+            ++seen.count;
+            return false;
+        }
+    }
+    if (s.seenCount == kMaxDistinct) {
+        return false;
+    }
+    Seen& seen = s.seen[s.seenCount++];
+    seen.source = source;
+    seen.type = type;
+    seen.id = id;
+    seen.count = 1;
+    const std::size_t n = std::min(length, static_cast<std::size_t>(kTextSize - 1));
+    std::memcpy(seen.text, text, n);
+    seen.text[n] = '\0';
+    ++s.stats.distinct;
+    return true;
+}
+
+void APIENTRY onMessage(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length,
+                        const GLchar* message, const void*) {
+    if (type == GL_DEBUG_TYPE_PUSH_GROUP || type == GL_DEBUG_TYPE_POP_GROUP || type == GL_DEBUG_TYPE_MARKER) {
+        return;                        // the profiler's own groups, echoed back
+    }
+    const std::size_t size = length >= 0 ? static_cast<std::size_t>(length) : std::strlen(message);
+    if (!remember(source, type, id, message, size)) {
+        return;
+    }
+    logging::Level level = logging::Level::Info;
+    if (type == GL_DEBUG_TYPE_ERROR || severity == GL_DEBUG_SEVERITY_HIGH) {
+        level = logging::Level::Error;
+    } else if (type == GL_DEBUG_TYPE_PERFORMANCE || severity == GL_DEBUG_SEVERITY_MEDIUM) {
+        level = logging::Level::Warning;
+    }
+    logging::write(level, "GL %s 0x%x: %.*s", typeName(type), id, static_cast<int>(size), message);
+}
+
+} // namespace
+
+void hintContext(Mode mode) {
+    if (mode != Mode::Off) {
+        glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE);
+    }
+}
+
+bool install(Mode mode) {
+    State& s = state();
+    if (mode == Mode::Off) {
+        return false;
+    }
+    s.installed = true;
+    s.callback = glext::caps().debugOutput;
+    if (!s.callback) {
+        logging::warn("GL debug: no KHR_debug, polling glGetError once a frame");
+        return true;
+    }
+    GLint flags = 0;
+    glGetIntegerv(GL_CONTEXT_FLAGS, &flags);
+    if ((flags & GL_CONTEXT_FLAG_DEBUG_BIT) == 0) {
+        logging::warn("GL debug: not a debug context, the driver may report little");
+    }
+    glEnable(GL_DEBUG_OUTPUT);
+    if (mode == Mode::Sync) {
+        glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    }
+    glext::debugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, nullptr, GL_TRUE);
+    glext::debugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr, GL_FALSE);
+    glext::debugMessageCallback(onMessage, nullptr);
+    return true;
+}
+
+void poll() {
+    State& s = state();
+    if (!s.installed || s.callback) {
+        return;
+    }
+    // Errors queue up (one per flag): a frame's worth at most.
+    for (GLenum error = glGetError(); error != GL_NO_ERROR; error = glGetError()) {
+        const char* name = errorName(error);
+        if (remember(GL_DEBUG_SOURCE_API, GL_DEBUG_TYPE_ERROR, error, name, std::strlen(name))) {
+            logging::error("GL error: %s (first seen this frame)", name);
+        }
+    }
+}
+
+void uninstall() {
+    State& s = state();
+    if (s.installed && s.callback) {
+        glext::debugMessageCallback(nullptr, nullptr);
+        glDisable(GL_DEBUG_OUTPUT);
+    }
+    s.installed = false;
+}
+
+Stats stats() {
+    State& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    return s.stats;
+}
+
+void report(std::ostream& out) {
+    State& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    if (!s.installed && s.stats.messages == 0) {
+        return;
+    }
+    out << "GL debug: " << s.stats.distinct << " distinct of " << s.stats.messages << " messages ("
+        << s.stats.errors << " errors, " << s.stats.performance << " performance)"
+        << (s.callback ? "" : ", glGetError poll") << "\n";
+    // The most repeated first: a warning every draw is the slow path worth fixing.
+    const Seen* top[kReported] = {};
+    for (int i = 0; i < s.seenCount; ++i) {
+        const Seen* candidate = &s.seen[i];
+        for (int k = 0; k < kReported && candidate != nullptr; ++k) {
+            if (top[k] == nullptr || candidate->count > top[k]->count) {
+                std::swap(top[k], candidate);
+            }
+        }
+    }
+    for (const Seen* seen : top) {
+        if (seen != nullptr && seen->count > 1) {
+            out << "  x" << seen->count << " " << typeName(seen->type) << ": " << seen->text << "\n";
+        }
+    }
+}
+
+#else // GL_DEBUG
+
+void hintContext(Mode) {}
+bool install(Mode mode) {
+    if (mode != Mode::Off) {
+        logging::warn("GL debug: not in this build (GL_DEBUG=0)");
+    }
+    return false;
+}
+void poll() {}
+void uninstall() {}
+Stats stats() { return Stats{}; }
+void report(std::ostream&) {}
+
+#endif // GL_DEBUG
+
+} // namespace gldebug
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+
+// GL_DEBUG
+// --------
+// On unless NDEBUG, like DEBUG_DRAW (render/debug_draw.h); `make GL_DEBUG=1` or `=0`
+// overrides it. Off, everything below is an empty function and --gl-debug only says so.
+#ifndef GL_DEBUG
+#if defined(NDEBUG)
+#define GL_DEBUG 0
+#else
+#define GL_DEBUG 1
+#endif
+#endif
+
+// gl_debug
+// --------
+// The driver's own view of what the game does wrong or slowly (--gl-debug). A debug
+// context is asked for before the window is created, and KHR_debug's callback (GL 4.3
+// or the extension; glext::caps().debugOutput) installed after: the driver then reports
+// errors as they happen and, more usefully, its PERFORMANCE warnings, the slow paths
+// nothing else shows:
+//
+// | Typical warning                             | What it means                          |
+// | ------------------------------------------- | -------------------------------------- |
+// | buffer ... stalled / is being used by GPU   | a map or sub-data waited for the GPU   |
+// | program/shader ... recompiled based on state| a state change forced a shader variant |
+// | texture ... incomplete / will be re-uploaded| an upload or mip setup took a slow path|
+//
+// Messages go to the async logger (core/log.h: the callback only formats into its ring,
+// it never writes to the terminal), and each distinct one (source, type, id) only the
+// FIRST time: a warning raised every draw is one log line, with the count in report().
+// Notifications (NVIDIA's "buffer will use VIDEO memory" and the like) are switched off
+// at the driver, so they cost nothing.
+//
+// | Mode            | Callback                     | Cost                                  |
+// | --------------- | ---------------------------- | ------------------------------------- |
+// | --gl-debug      | asynchronous: any thread, a  | the debug context's validation; one   |
+// |                 | little after the call        | lookup per message                    |
+// | --gl-debug=sync | on the offending call, on    | + the driver stays synchronous: slow, |
+// |                 | its thread (a breakpoint in  | for finding the call, not for timing  |
+// |                 | the callback shows the call) |                                       |
+// | no KHR_debug    | none: poll() calls           | one glGetError a frame                |
+// |                 | glGetError once a frame      |                                       |
+//
+// Usage, with the context current:
+//     gldebug::hintContext(mode);        // before glfwCreateWindow
+//     gldebug::install(mode);            // after glext::load()
+//     gldebug::poll();                   // once per frame, GL thread
+//     gldebug::report(std::cout);        // with --profile, and at exit
+namespace gldebug {
+
+constexpr bool enabled() { return GL_DEBUG != 0; }
+
+enum class Mode : std::uint8_t { Off, On, Sync };
+
+// "on" / "sync" / "off"; false for anything else.
+bool parse(const char* text, Mode& mode);
+
+struct Stats {
+    std::uint64_t messages = 0;        // reported by the driver (or glGetError)
+    std::uint64_t distinct = 0;        // ... of which logged: the first of each
+    std::uint64_t errors = 0;
+    std::uint64_t performance = 0;
+};
+
+// Before the window is created: ask GLFW for a debug context (nothing when Off or not
+// in this build).
+void hintContext(Mode mode);
+// Context current, after glext::load(): the callback, or without KHR_debug the
+// glGetError poll. False when off or not in this build.
+bool install(Mode mode);
+// GL thread, once per frame: the fallback poll (nothing with the callback).
+void poll();
+// Before the context goes away: no more callbacks.
+void uninstall();
+
+Stats stats();
+// "GL debug: 3 distinct of 1200 messages (0 errors, 1198 performance)" and the most
+// repeated ones. Nothing when not installed.
+void report(std::ostream& out);
+
+} // namespace gldebug
@@ -0,0 +1,215 @@
+#include "render/gl_ext.h"
+
+#include <GLFW/glfw3.h>
+#include <cstring>
+
+namespace glext {
+
+PFNGLBUFFERSTORAGEPROC bufferStorage = nullptr;
+PFNGLGETPROGRAMBINARYPROC getProgramBinary = nullptr;
+PFNGLPROGRAMBINARYPROC programBinary = nullptr;
+PFNGLPROGRAMPARAMETERIPROC programParameteri = nullptr;
+PFNGLMAXSHADERCOMPILERTHREADSPROC maxShaderCompilerThreads = nullptr;
+PFNGLMULTIDRAWELEMENTSINDIRECTPROC multiDrawElementsIndirect = nullptr;
+PFNGLDRAWELEMENTSINDIRECTPROC drawElementsIndirect = nullptr;
+PFNGLDISPATCHCOMPUTEPROC dispatchCompute = nullptr;
+PFNGLMEMORYBARRIERPROC memoryBarrier = nullptr;
+PFNGLCREATEBUFFERSPROC createBuffers = nullptr;
+PFNGLCREATEVERTEXARRAYSPROC createVertexArrays = nullptr;
+PFNGLNAMEDBUFFERDATAPROC namedBufferData = nullptr;
+PFNGLNAMEDBUFFERSUBDATAPROC namedBufferSubData = nullptr;
+PFNGLNAMEDBUFFERSTORAGEPROC namedBufferStorage = nullptr;
+PFNGLMAPNAMEDBUFFERRANGEPROC mapNamedBufferRange = nullptr;
+PFNGLUNMAPNAMEDBUFFERPROC unmapNamedBuffer = nullptr;
+PFNGLVERTEXARRAYVERTEXBUFFERPROC vertexArrayVertexBuffer = nullptr;
+PFNGLVERTEXARRAYELEMENTBUFFERPROC vertexArrayElementBuffer = nullptr;
+PFNGLENABLEVERTEXARRAYATTRIBPROC enableVertexArrayAttrib = nullptr;
+PFNGLVERTEXARRAYATTRIBFORMATPROC vertexArrayAttribFormat = nullptr;
+PFNGLVERTEXARRAYATTRIBIFORMATPROC vertexArrayAttribIFormat = nullptr;
+PFNGLVERTEXARRAYATTRIBBINDINGPROC vertexArrayAttribBinding = nullptr;
+PFNGLVERTEXARRAYBINDINGDIVISORPROC vertexArrayBindingDivisor = nullptr;
+PFNGLDEBUGMESSAGECALLBACKPROC debugMessageCallback = nullptr;
+PFNGLDEBUGMESSAGECONTROLPROC debugMessageControl = nullptr;
+PFNGLINVALIDATEFRAMEBUFFERPROC invalidateFramebuffer = nullptr;
+
+namespace {
+Caps gCaps;
+constexpr const char* kTierNames[] = {"baseline", "streaming", "gpu-driven"}; // by Tier
+
+bool versionAtLeast(int major, int minor) {
+    return gCaps.major > major || (gCaps.major == major && gCaps.minor >= minor);
+}
+
+template <typename Fn>
+Fn loadProc(const char* name) {
+    return reinterpret_cast<Fn>(glfwGetProcAddress(name));
+}
+} // namespace
+
+bool hasExtension(const char* name) {
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; ++i) {
+        const char* ext = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+        if (ext && std::strcmp(ext, name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void load() {
+    gCaps = Caps{};
+    glGetIntegerv(GL_MAJOR_VERSION, &gCaps.major);
+    glGetIntegerv(GL_MINOR_VERSION, &gCaps.minor);
+
+    if (versionAtLeast(4, 4) || hasExtension("GL_ARB_buffer_storage")) {
+        bufferStorage = loadProc<PFNGLBUFFERSTORAGEPROC>("glBufferStorage");
+    }
+    gCaps.bufferStorage = bufferStorage != nullptr;
+
+    gCaps.textureS3tc = hasExtension("GL_EXT_texture_compression_s3tc");
+    gCaps.textureBptc = versionAtLeast(4, 2) || hasExtension("GL_ARB_texture_compression_bptc");
+    gCaps.textureEtc2 = versionAtLeast(4, 3) || hasExtension("GL_ARB_ES3_compatibility");
+    gCaps.memoryInfoNvx = hasExtension("GL_NVX_gpu_memory_info");
+    gCaps.memoryInfoAti = hasExtension("GL_ATI_meminfo");
+    // Core GLSL 4.20, but the shaders are #version 330: they need the extension by name.
+    gCaps.explicitBindings = hasExtension("GL_ARB_shading_language_420pack");
+
+    if (versionAtLeast(4, 1) || hasExtension("GL_ARB_get_program_binary")) {
+        getProgramBinary = loadProc<PFNGLGETPROGRAMBINARYPROC>("glGetProgramBinary");
+        programBinary = loadProc<PFNGLPROGRAMBINARYPROC>("glProgramBinary");
+        programParameteri = loadProc<PFNGLPROGRAMPARAMETERIPROC>("glProgramParameteri");
+    }
+    // A driver may expose the entry points with zero formats: nothing it writes could be read back.
+    GLint binaryFormats = 0;
+    if (getProgramBinary && programBinary && programParameteri) {
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &binaryFormats);
+    }
+    gCaps.programBinary = binaryFormats > 0;
+
+    // Same entry point and tokens; only the name's suffix differs.
+    if (hasExtension("GL_KHR_parallel_shader_compile")) {
+        maxShaderCompilerThreads = loadProc<PFNGLMAXSHADERCOMPILERTHREADSPROC>("glMaxShaderCompilerThreadsKHR");
+    } else if (hasExtension("GL_ARB_parallel_shader_compile")) {
+        maxShaderCompilerThreads = loadProc<PFNGLMAXSHADERCOMPILERTHREADSPROC>("glMaxShaderCompilerThreadsARB");
+    }
+    gCaps.parallelShaderCompile = maxShaderCompilerThreads != nullptr;
+
+    // The multi-draw extension only adds the call; the indirect buffer target comes from
+    // ARB_draw_indirect (both core in 4.3).
+    multiDrawElementsIndirect = nullptr;
+    if (versionAtLeast(4, 3) ||
+        (hasExtension("GL_ARB_multi_draw_indirect") && (versionAtLeast(4, 0) || hasExtension("GL_ARB_draw_indirect")))) {
+        multiDrawElementsIndirect = loadProc<PFNGLMULTIDRAWELEMENTSINDIRECTPROC>("glMultiDrawElementsIndirect");
+    }
+    gCaps.multiDrawIndirect = multiDrawElementsIndirect != nullptr;
+
+    drawElementsIndirect = nullptr;
+    if (versionAtLeast(4, 0) || hasExtension("GL_ARB_draw_indirect")) {
+        drawElementsIndirect = loadProc<PFNGLDRAWELEMENTSINDIRECTPROC>("glDrawElementsIndirect");
+    }
+    gCaps.drawIndirect = drawElementsIndirect != nullptr;
+
+    dispatchCompute = nullptr;
+    memoryBarrier = nullptr;
+    if (versionAtLeast(4, 3) ||
+        (hasExtension("GL_ARB_compute_shader") && hasExtension("GL_ARB_shader_storage_buffer_object"))) {
+        dispatchCompute = loadProc<PFNGLDISPATCHCOMPUTEPROC>("glDispatchCompute");
+        memoryBarrier = loadProc<PFNGLMEMORYBARRIERPROC>("glMemoryBarrier");
+    }
+    gCaps.computeShader = dispatchCompute != nullptr && memoryBarrier != nullptr;
+
+    // Named buffer storage only exists where buffer storage does: without it, DSA is used
+    // for everything but the persistent StreamBuffers.
+    createBuffers = nullptr;
+    createVertexArrays = nullptr;
+    namedBufferData = nullptr;
+    namedBufferSubData = nullptr;
+    namedBufferStorage = nullptr;
+    mapNamedBufferRange = nullptr;
+    unmapNamedBuffer = nullptr;
+    vertexArrayVertexBuffer = nullptr;
+    vertexArrayElementBuffer = nullptr;
+    enableVertexArrayAttrib = nullptr;
+    vertexArrayAttribFormat = nullptr;
+    vertexArrayAttribIFormat = nullptr;
+    vertexArrayAttribBinding = nullptr;
+    vertexArrayBindingDivisor = nullptr;
+    if (versionAtLeast(4, 5) || hasExtension("GL_ARB_direct_state_access")) {
+        createBuffers = loadProc<PFNGLCREATEBUFFERSPROC>("glCreateBuffers");
+        createVertexArrays = loadProc<PFNGLCREATEVERTEXARRAYSPROC>("glCreateVertexArrays");
+        namedBufferData = loadProc<PFNGLNAMEDBUFFERDATAPROC>("glNamedBufferData");
+        namedBufferSubData = loadProc<PFNGLNAMEDBUFFERSUBDATAPROC>("glNamedBufferSubData");
+        namedBufferStorage = loadProc<PFNGLNAMEDBUFFERSTORAGEPROC>("glNamedBufferStorage");
+        mapNamedBufferRange = loadProc<PFNGLMAPNAMEDBUFFERRANGEPROC>("glMapNamedBufferRange");
+        unmapNamedBuffer = loadProc<PFNGLUNMAPNAMEDBUFFERPROC>("glUnmapNamedBuffer");
+        vertexArrayVertexBuffer = loadProc<PFNGLVERTEXARRAYVERTEXBUFFERPROC>("glVertexArrayVertexBuffer");
+        vertexArrayElementBuffer = loadProc<PFNGLVERTEXARRAYELEMENTBUFFERPROC>("glVertexArrayElementBuffer");
+        enableVertexArrayAttrib = loadProc<PFNGLENABLEVERTEXARRAYATTRIBPROC>("glEnableVertexArrayAttrib");
+        vertexArrayAttribFormat = loadProc<PFNGLVERTEXARRAYATTRIBFORMATPROC>("glVertexArrayAttribFormat");
+        vertexArrayAttribIFormat = loadProc<PFNGLVERTEXARRAYATTRIBIFORMATPROC>("glVertexArrayAttribIFormat");
+        vertexArrayAttribBinding = loadProc<PFNGLVERTEXARRAYATTRIBBINDINGPROC>("glVertexArrayAttribBinding");
+        vertexArrayBindingDivisor = loadProc<PFNGLVERTEXARRAYBINDINGDIVISORPROC>("glVertexArrayBindingDivisor");
+    }
+    gCaps.directStateAccess = createBuffers && createVertexArrays && namedBufferData && namedBufferSubData &&
+                              mapNamedBufferRange && unmapNamedBuffer && vertexArrayVertexBuffer &&
+                              vertexArrayElementBuffer && enableVertexArrayAttrib && vertexArrayAttribFormat &&
+                              vertexArrayAttribIFormat && vertexArrayAttribBinding && vertexArrayBindingDivisor;
+
+    debugMessageCallback = nullptr;
+    debugMessageControl = nullptr;
+    if (versionAtLeast(4, 3) || hasExtension("GL_KHR_debug")) {
+        debugMessageCallback = loadProc<PFNGLDEBUGMESSAGECALLBACKPROC>("glDebugMessageCallback");
+        debugMessageControl = loadProc<PFNGLDEBUGMESSAGECONTROLPROC>("glDebugMessageControl");
+    }
+    gCaps.debugOutput = debugMessageCallback != nullptr && debugMessageControl != nullptr;
+
+    invalidateFramebuffer = nullptr;
+    if (versionAtLeast(4, 3) || hasExtension("GL_ARB_invalidate_subdata")) {
+        invalidateFramebuffer = loadProc<PFNGLINVALIDATEFRAMEBUFFERPROC>("glInvalidateFramebuffer");
+    }
+    gCaps.invalidateFramebuffer = invalidateFramebuffer != nullptr;
+}
+
+const Caps& caps() {
+    return gCaps;
+}
+
+Tier tier() {
+    if (!gCaps.bufferStorage) {
+        return Tier::Baseline;
+    }
+    if (!gCaps.multiDrawIndirect || !gCaps.drawIndirect || !gCaps.computeShader) {
+        return Tier::Streaming;
+    }
+    return Tier::GpuDriven;
+}
+
+void limitTier(Tier highest) {
+    if (highest < Tier::GpuDriven) {
+        gCaps.multiDrawIndirect = false;
+        gCaps.drawIndirect = false;
+        gCaps.computeShader = false;
+    }
+    if (highest < Tier::Streaming) {
+        gCaps.bufferStorage = false;
+        gCaps.directStateAccess = false;
+    }
+}
+
+const char* tierName(Tier tier) {
+    return kTierNames[static_cast<int>(tier)];
+}
+
+bool parseTier(const char* name, Tier* tier) {
+    for (int i = 0; i < 3; ++i) {
+        if (std::strcmp(name, kTierNames[i]) == 0) {
+            *tier = static_cast<Tier>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace glext
@@ -0,0 +1,251 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// gl_ext
+// ------
+// The vendored glad loader was generated for plain GL 3.3 core with NO extensions
+// (see the header comment in include/glad/glad.h). Faster paths such as persistent
+// buffer mapping live in extensions / newer core versions, so this module loads
+// those entry points by hand, after gladLoadGL(), through glfwGetProcAddress.
+//
+// Every function pointer here may be nullptr. Always check the matching caps()
+// flag before calling one, and keep a plain GL 3.3 fallback.
+//
+// Tiers
+// -----
+// main asks for the newest core context first (kContextVersions) and settles for what
+// the driver gives, down to 3.3. The flags then sort the machine into a tier, and the
+// renderers pick their backend from the flags, so a newer tier just switches paths on:
+//
+// | Tier      | Needs (on top of the one above)         | Switches on                      |
+// | --------- | --------------------------------------- | -------------------------------- |
+// | Baseline  | GL 3.3 core                             | orphaned streams, one draw per   |
+// |           |                                         | batch, particles on the CPU      |
+// | Streaming | bufferStorage                           | persistent-mapped StreamBuffers  |
+// | GpuDriven | multiDrawIndirect, drawIndirect,        | MultiDrawBatch indirect, GPU     |
+// |           | computeShader                           | particle update + culling        |
+//
+// limitTier() clears the flags of the tiers above a given one, so a GL 4.6 machine can
+// run exactly what a 3.3 one would (--gl-tier; baseline also clears directStateAccess).
+// Program binaries, parallel compiles, texture formats and DSA aren't what a tier needs:
+// they change load times, capacity and call counts, not which drawing path runs.
+
+// ARB_buffer_storage / GL 4.4 tokens (not in the 3.3 glad header)
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT   0x0040
+#define GL_MAP_COHERENT_BIT     0x0080
+#define GL_DYNAMIC_STORAGE_BIT  0x0100
+#define GL_CLIENT_STORAGE_BIT   0x0200
+#endif
+
+// Compressed texture formats (EXT_texture_compression_s3tc, ARB_texture_compression_bptc,
+// ARB_ES3_compatibility). Core glCompressedTexImage2D takes them; only the tokens are new.
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT   0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT  0x83F1
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT  0x83F3
+#endif
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#define GL_COMPRESSED_RGBA_BPTC_UNORM     0x8E8C
+#endif
+#ifndef GL_COMPRESSED_RGB8_ETC2
+#define GL_COMPRESSED_RGB8_ETC2           0x9274
+#define GL_COMPRESSED_RGBA8_ETC2_EAC      0x9278
+#endif
+
+// ARB_get_program_binary / GL 4.1 tokens
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#define GL_PROGRAM_BINARY_LENGTH           0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS      0x87FE
+#define GL_PROGRAM_BINARY_FORMATS          0x87FF
+#endif
+
+// KHR_parallel_shader_compile tokens (the ARB variant uses the same values)
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#define GL_COMPLETION_STATUS_KHR           0x91B1
+#endif
+
+// ARB_draw_indirect / GL 4.0 token: the buffer glMultiDrawElementsIndirect reads
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER            0x8F3F
+#endif
+
+// ARB_compute_shader / ARB_shader_storage_buffer_object / GL 4.3 tokens
+#ifndef GL_COMPUTE_SHADER
+#define GL_COMPUTE_SHADER                  0x91B9
+#define GL_SHADER_STORAGE_BUFFER           0x90D2
+#endif
+// ARB_shader_image_load_store / GL 4.2 barrier bits
+#ifndef GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT
+#define GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT 0x00000001
+#define GL_COMMAND_BARRIER_BIT             0x00000040
+#define GL_SHADER_STORAGE_BARRIER_BIT      0x00002000
+#endif
+
+// NVX_gpu_memory_info / ATI_meminfo tokens: what the driver says about video memory (KiB)
+#ifndef GL_GPU_MEMORY_INFO_DEDICATED_VIDMEM_NVX
+#define GL_GPU_MEMORY_INFO_DEDICATED_VIDMEM_NVX         0x9047
+#define GL_GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX   0x9048
+#define GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX 0x9049
+#endif
+#ifndef GL_TEXTURE_FREE_MEMORY_ATI
+#define GL_VBO_FREE_MEMORY_ATI                          0x87FB
+#define GL_TEXTURE_FREE_MEMORY_ATI                      0x87FC
+#define GL_RENDERBUFFER_FREE_MEMORY_ATI                 0x87FD
+#endif
+
+// KHR_debug / GL 4.3 tokens (render/gl_debug.h)
+#ifndef GL_DEBUG_OUTPUT
+#define GL_DEBUG_OUTPUT                    0x92E0
+#define GL_DEBUG_OUTPUT_SYNCHRONOUS        0x8242
+#define GL_CONTEXT_FLAG_DEBUG_BIT          0x00000002
+#define GL_DEBUG_SOURCE_API                0x8246
+#define GL_DEBUG_SOURCE_WINDOW_SYSTEM      0x8247
+#define GL_DEBUG_SOURCE_SHADER_COMPILER    0x8248
+#define GL_DEBUG_SOURCE_THIRD_PARTY        0x8249
+#define GL_DEBUG_SOURCE_APPLICATION        0x824A
+#define GL_DEBUG_SOURCE_OTHER              0x824B
+#define GL_DEBUG_TYPE_ERROR                0x824C
+#define GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR  0x824D
+#define GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR   0x824E
+#define GL_DEBUG_TYPE_PORTABILITY          0x824F
+#define GL_DEBUG_TYPE_PERFORMANCE          0x8250
+#define GL_DEBUG_TYPE_OTHER                0x8251
+#define GL_DEBUG_TYPE_MARKER               0x8268
+#define GL_DEBUG_TYPE_PUSH_GROUP           0x8269
+#define GL_DEBUG_TYPE_POP_GROUP            0x826A
+#define GL_DEBUG_SEVERITY_HIGH             0x9146
+#define GL_DEBUG_SEVERITY_MEDIUM           0x9147
+#define GL_DEBUG_SEVERITY_LOW              0x9148
+#define GL_DEBUG_SEVERITY_NOTIFICATION     0x826B
+#endif
+
+namespace glext {
+
+typedef void (APIENTRYP PFNGLBUFFERSTORAGEPROC)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+typedef void (APIENTRYP PFNGLGETPROGRAMBINARYPROC)(GLuint program, GLsizei bufSize, GLsizei* length,
+                                                   GLenum* binaryFormat, void* binary);
+typedef void (APIENTRYP PFNGLPROGRAMBINARYPROC)(GLuint program, GLenum binaryFormat, const void* binary,
+                                                GLsizei length);
+typedef void (APIENTRYP PFNGLPROGRAMPARAMETERIPROC)(GLuint program, GLenum pname, GLint value);
+typedef void (APIENTRYP PFNGLMAXSHADERCOMPILERTHREADSPROC)(GLuint count);
+typedef void (APIENTRYP PFNGLMULTIDRAWELEMENTSINDIRECTPROC)(GLenum mode, GLenum type, const void* indirect,
+                                                           GLsizei drawcount, GLsizei stride);
+typedef void (APIENTRYP PFNGLDRAWELEMENTSINDIRECTPROC)(GLenum mode, GLenum type, const void* indirect);
+typedef void (APIENTRYP PFNGLDISPATCHCOMPUTEPROC)(GLuint x, GLuint y, GLuint z);
+typedef void (APIENTRYP PFNGLMEMORYBARRIERPROC)(GLbitfield barriers);
+// ARB_direct_state_access / GL 4.5: edit objects by name, without binding them first
+typedef void (APIENTRYP PFNGLCREATEBUFFERSPROC)(GLsizei n, GLuint* buffers);
+typedef void (APIENTRYP PFNGLCREATEVERTEXARRAYSPROC)(GLsizei n, GLuint* arrays);
+typedef void (APIENTRYP PFNGLNAMEDBUFFERDATAPROC)(GLuint buffer, GLsizeiptr size, const void* data, GLenum usage);
+typedef void (APIENTRYP PFNGLNAMEDBUFFERSUBDATAPROC)(GLuint buffer, GLintptr offset, GLsizeiptr size,
+                                                     const void* data);
+typedef void (APIENTRYP PFNGLNAMEDBUFFERSTORAGEPROC)(GLuint buffer, GLsizeiptr size, const void* data,
+                                                     GLbitfield flags);
+typedef void* (APIENTRYP PFNGLMAPNAMEDBUFFERRANGEPROC)(GLuint buffer, GLintptr offset, GLsizeiptr length,
+                                                       GLbitfield access);
+typedef GLboolean (APIENTRYP PFNGLUNMAPNAMEDBUFFERPROC)(GLuint buffer);
+typedef void (APIENTRYP PFNGLVERTEXARRAYVERTEXBUFFERPROC)(GLuint vaobj, GLuint bindingindex, GLuint buffer,
+                                                          GLintptr offset, GLsizei stride);
+typedef void (APIENTRYP PFNGLVERTEXARRAYELEMENTBUFFERPROC)(GLuint vaobj, GLuint buffer);
+typedef void (APIENTRYP PFNGLENABLEVERTEXARRAYATTRIBPROC)(GLuint vaobj, GLuint index);
+typedef void (APIENTRYP PFNGLVERTEXARRAYATTRIBFORMATPROC)(GLuint vaobj, GLuint attribindex, GLint size,
+                                                          GLenum type, GLboolean normalized, GLuint relativeoffset);
+typedef void (APIENTRYP PFNGLVERTEXARRAYATTRIBIFORMATPROC)(GLuint vaobj, GLuint attribindex, GLint size,
+                                                           GLenum type, GLuint relativeoffset);
+typedef void (APIENTRYP PFNGLVERTEXARRAYATTRIBBINDINGPROC)(GLuint vaobj, GLuint attribindex, GLuint bindingindex);
+typedef void (APIENTRYP PFNGLVERTEXARRAYBINDINGDIVISORPROC)(GLuint vaobj, GLuint bindingindex, GLuint divisor);
+// KHR_debug / GL 4.3: the driver calls back with errors and performance warnings
+typedef void (APIENTRYP PFNGLDEBUGMESSAGECALLBACKPROC)(GLDEBUGPROC callback, const void* userParam);
+typedef void (APIENTRYP PFNGLDEBUGMESSAGECONTROLPROC)(GLenum source, GLenum type, GLenum severity, GLsizei count,
+                                                      const GLuint* ids, GLboolean enabled);
+// ARB_invalidate_subdata / GL 4.3: an attachment's contents no longer matter (render/gl_framebuffer.h)
+typedef void (APIENTRYP PFNGLINVALIDATEFRAMEBUFFERPROC)(GLenum target, GLsizei numAttachments,
+                                                         const GLenum* attachments);
+
+struct Caps {
+    int major = 3;
+    int minor = 3;
+    bool bufferStorage = false; // ARB_buffer_storage or GL 4.4: persistent/coherent mapping
+    bool textureS3tc = false;   // EXT_texture_compression_s3tc: BC1 / BC3 (desktop GPUs, in practice)
+    bool textureBptc = false;   // ARB_texture_compression_bptc or GL 4.2: BC7
+    bool textureEtc2 = false;   // ARB_ES3_compatibility or GL 4.3: ETC2 / EAC
+    bool programBinary = false; // ARB_get_program_binary or GL 4.1, with at least one binary format
+    bool parallelShaderCompile = false; // KHR/ARB_parallel_shader_compile: background compiles,
+                                        // GL_COMPLETION_STATUS_KHR polls them without blocking
+    bool multiDrawIndirect = false; // ARB_multi_draw_indirect (+ ARB_draw_indirect) or GL 4.3:
+                                    // many indexed draws from one buffer of commands, one call
+    bool drawIndirect = false;      // ARB_draw_indirect or GL 4.0: a draw's arguments from a buffer
+    bool computeShader = false;     // ARB_compute_shader + ARB_shader_storage_buffer_object or
+                                    // GL 4.3: compute dispatches reading/writing buffers
+    bool directStateAccess = false; // ARB_direct_state_access or GL 4.5, with every entry point
+                                    // below: render/gl_buffer.h edits buffers and VAOs by name
+    bool memoryInfoNvx = false;     // NVX_gpu_memory_info: dedicated / free video memory
+    bool memoryInfoAti = false;     // ATI_meminfo: free memory per pool (render/gpu_memory.h)
+    bool debugOutput = false;       // KHR_debug or GL 4.3: glDebugMessageCallback (render/gl_debug.h)
+    bool explicitBindings = false;  // ARB_shading_language_420pack: the #version 330 shaders may say
+                                    // `layout (binding = N)` (render/shader_build.h)
+    bool invalidateFramebuffer = false; // ARB_invalidate_subdata or GL 4.3: attachments a tiled
+                                        // GPU needn't load or store (render/gl_framebuffer.h)
+};
+
+enum class Tier { Baseline, Streaming, GpuDriven };
+
+struct ContextVersion {
+    int major;
+    int minor;
+};
+
+// What main asks GLFW for, in order; the first context created wins. 3.3 is the floor
+// everything has a path for.
+constexpr ContextVersion kContextVersions[] = {{4, 6}, {4, 5}, {4, 4}, {4, 3}, {4, 2}, {4, 1}, {4, 0}, {3, 3}};
+
+// Loads optional entry points and fills caps(). Call once after gladLoadGL(),
+// with the context current. Safe to call again after a context change.
+void load();
+
+const Caps& caps();
+
+// The highest tier caps() qualifies for.
+Tier tier();
+// Clears what caps() reports above `highest` (after load(); the entry points stay loaded,
+// but nothing calls one without its flag).
+void limitTier(Tier highest);
+const char* tierName(Tier tier);
+// "baseline" / "streaming" / "gpu-driven" (tierName's spelling); false if none of them.
+bool parseTier(const char* name, Tier* tier);
+
+// Linear scan of glGetStringi(GL_EXTENSIONS, i). Init-time only.
+bool hasExtension(const char* name);
+
+extern PFNGLBUFFERSTORAGEPROC bufferStorage;
+extern PFNGLGETPROGRAMBINARYPROC getProgramBinary;
+extern PFNGLPROGRAMBINARYPROC programBinary;
+extern PFNGLPROGRAMPARAMETERIPROC programParameteri;
+extern PFNGLMAXSHADERCOMPILERTHREADSPROC maxShaderCompilerThreads;
+extern PFNGLMULTIDRAWELEMENTSINDIRECTPROC multiDrawElementsIndirect;
+extern PFNGLDRAWELEMENTSINDIRECTPROC drawElementsIndirect;
+extern PFNGLDISPATCHCOMPUTEPROC dispatchCompute;
+extern PFNGLMEMORYBARRIERPROC memoryBarrier;
+extern PFNGLCREATEBUFFERSPROC createBuffers;
+extern PFNGLCREATEVERTEXARRAYSPROC createVertexArrays;
+extern PFNGLNAMEDBUFFERDATAPROC namedBufferData;
+extern PFNGLNAMEDBUFFERSUBDATAPROC namedBufferSubData;
+extern PFNGLNAMEDBUFFERSTORAGEPROC namedBufferStorage;
+extern PFNGLMAPNAMEDBUFFERRANGEPROC mapNamedBufferRange;
+extern PFNGLUNMAPNAMEDBUFFERPROC unmapNamedBuffer;
+extern PFNGLVERTEXARRAYVERTEXBUFFERPROC vertexArrayVertexBuffer;
+extern PFNGLVERTEXARRAYELEMENTBUFFERPROC vertexArrayElementBuffer;
+extern PFNGLENABLEVERTEXARRAYATTRIBPROC enableVertexArrayAttrib;
+extern PFNGLVERTEXARRAYATTRIBFORMATPROC vertexArrayAttribFormat;
+extern PFNGLVERTEXARRAYATTRIBIFORMATPROC vertexArrayAttribIFormat;
+extern PFNGLVERTEXARRAYATTRIBBINDINGPROC vertexArrayAttribBinding;
+extern PFNGLVERTEXARRAYBINDINGDIVISORPROC vertexArrayBindingDivisor;
+extern PFNGLDEBUGMESSAGECALLBACKPROC debugMessageCallback;
+extern PFNGLDEBUGMESSAGECONTROLPROC debugMessageControl;
+extern PFNGLINVALIDATEFRAMEBUFFERPROC invalidateFramebuffer;
+
+} // namespace glext
@@ -0,0 +1,80 @@
+#include "render/gl_framebuffer.h"
+
+#include <ostream>
+
+#include "render/gl_ext.h"
+#include "render/gl_state.h"
+
+namespace glframebuffer {
+
+namespace {
+
+Stats gStats;                          // the render thread's
+
+} // namespace
+
+void begin(GLuint framebuffer, int width, int height, GLbitfield clearBits, GLbitfield coveredBits) {
+    glstate::bindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glstate::viewport(0, 0, width, height);
+    const GLbitfield covered = clearBits & coveredBits;
+    if (covered != 0) {
+        discard(framebuffer, covered);
+        ++gStats.skippedClears;
+    }
+    if ((clearBits & ~covered) != 0) {
+        glClear(clearBits & ~covered);
+        ++gStats.clears;
+    }
+}
+
+void discard(GLuint framebuffer, GLbitfield bits) {
+    if (!glext::caps().invalidateFramebuffer || bits == 0) {
+        return;
+    }
+    // The window's attachments have names of their own; a depth-stencil renderbuffer
+    // (RenderTarget's) is one attachment, named either way.
+    GLenum attachments[3];
+    GLsizei count = 0;
+    if (bits & GL_COLOR_BUFFER_BIT) {
+        attachments[count++] = framebuffer == 0 ? GL_COLOR : GL_COLOR_ATTACHMENT0;
+    }
+    if (bits & GL_DEPTH_BUFFER_BIT) {
+        attachments[count++] = framebuffer == 0 ? GL_DEPTH : GL_DEPTH_ATTACHMENT;
+    }
+    if (bits & GL_STENCIL_BUFFER_BIT) {
+        attachments[count++] = framebuffer == 0 ? GL_STENCIL : GL_STENCIL_ATTACHMENT;
+    }
+    glstate::bindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glext::invalidateFramebuffer(GL_READ_FRAMEBUFFER, count, attachments);
+    ++gStats.discards;
+}
+
+Scissor::Scissor(const glm::ivec4& rect, int width, int height)
+    : enabled_(rect.x > 0 || rect.y > 0 || rect.z < width || rect.w < height) {
+    if (enabled_) {
+        glstate::enable(GL_SCISSOR_TEST);
+        glScissor(rect.x, rect.y, rect.z, rect.w);
+        ++gStats.scissoredClears;
+    } else {
+        ++gStats.clears;
+    }
+}
+
+Scissor::~Scissor() {
+    if (enabled_) {
+        glstate::disable(GL_SCISSOR_TEST);
+    }
+}
+
+Stats stats() {
+    return gStats;
+}
+
+void report(std::ostream& out) {
+    out << "framebuffers: " << gStats.clears << " clears, " << gStats.scissoredClears << " scissored, "
+        << gStats.skippedClears << " skipped (covered), " << gStats.discards << " discards"
+        << (glext::caps().invalidateFramebuffer ? "" : " (no glInvalidateFramebuffer)") << "\n";
+    gStats = Stats{};
+}
+
+} // namespace glframebuffer
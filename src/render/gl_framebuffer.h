@@ -0,0 +1,75 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <iosfwd>
+
+// gl_framebuffer
+// --------------
+// What a pass does with a framebuffer's old contents and what it leaves behind. A tiled
+// GPU (mobile, most integrated ones) draws in on-chip tile memory: at the start of a
+// pass it LOADS each tile from the framebuffer unless it knows the old pixels don't
+// matter, and at the end it STORES every attachment back, depth included, whether or not
+// anything reads it again. A full clear or an invalidate skips the load; an invalidate
+// at the end skips the store. Desktop GPUs mostly save the clear's bandwidth.
+//
+// | Call                    | GL                                   | Tells the driver              |
+// | ----------------------- | ------------------------------------ | ----------------------------- |
+// | begin(fb, clear, cover) | glClear of `clear` minus `covered`;  | load nothing: cleared or      |
+// |                         | an invalidate of the covered ones    | overwritten anyway            |
+// | discard(fb, bits)       | glInvalidateFramebuffer              | neither load nor store them   |
+// | Scissor(rect, w, h)     | GL_SCISSOR_TEST around a clear of    | only these pixels change      |
+// |                         | part of the target; none for all     | (a full clear is the cheap    |
+// |                         | of it                                | one on a tiler)               |
+//
+// Where the renderer uses them:
+//
+// | Pass                        | Start                                 | End                       |
+// | --------------------------- | ------------------------------------- | ------------------------- |
+// | scene (window or offscreen) | colour cleared unless an opaque       | window: depth/stencil     |
+// |                             | background covers every view          | discarded before the swap |
+// | a view over another         | its rect cleared, scissored           |                           |
+// | present / post passes       | the destination discarded: a blit or  | the scene target, all of  |
+// |                             | full-screen triangle overwrites it    | it, once presented        |
+//
+// discard() needs glext::caps().invalidateFramebuffer (ARB_invalidate_subdata / GL 4.3);
+// without it the calls are skipped and a covered attachment is simply not cleared. GL
+// thread only; the counters are the render thread's, reported with --profile.
+namespace glframebuffer {
+
+struct Stats {
+    std::uint64_t clears = 0;          // of whole targets: begin()s, full-target Scissors
+    std::uint64_t scissoredClears = 0; // Scissors of part of a target
+    std::uint64_t skippedClears = 0;   // begin()s whose covered bits made a clear unnecessary
+    std::uint64_t discards = 0;        // glInvalidateFramebuffer calls
+};
+
+// Starts a pass on `framebuffer` (0: the window) of width x height: binds it, sets the
+// viewport, clears `clearBits` (GL_COLOR_BUFFER_BIT, ...: to glClearColor's colour, depth
+// 1, stencil 0) except the `coveredBits` the pass's first draws overwrite at every pixel
+// (an opaque full-screen background), which are discarded instead.
+void begin(GLuint framebuffer, int width, int height, GLbitfield clearBits, GLbitfield coveredBits = 0);
+
+// `bits` of `framebuffer` hold nothing anyone will read: invalidated, through the read
+// binding so the draw framebuffer stays bound. A no-op without the entry point.
+void discard(GLuint framebuffer, GLbitfield bits);
+
+// GL_SCISSOR_TEST limited to `rect` (x, y, width, height) for the block's clears and
+// draws, unless it is the whole width x height target. Off again at the end of the block.
+class Scissor {
+public:
+    Scissor(const glm::ivec4& rect, int width, int height);
+    ~Scissor();
+    Scissor(const Scissor&) = delete;
+    Scissor& operator=(const Scissor&) = delete;
+
+private:
+    bool enabled_;
+};
+
+// Counters since the previous report(); report() prints one line and zeroes them.
+Stats stats();
+void report(std::ostream& out);
+
+} // namespace glframebuffer
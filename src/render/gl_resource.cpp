@@ -0,0 +1,186 @@
+#include "render/gl_resource.h"
+
+#include <mutex>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+#include "render/gl_ext.h"
+#include "render/gl_state.h"
+#include "render/gpu_memory.h"
+
+namespace glresource {
+namespace {
+
+struct Pending {
+    GlObject type;
+    GLuint name;
+};
+
+// Names queued between two collect() calls, and the fence placed after that frame.
+struct Batch {
+    GLsync fence = nullptr;
+    std::vector<Pending> names;
+};
+
+struct Queue {
+    std::mutex mutex;              // guards incoming, open and queued
+    std::vector<Pending> incoming;
+    bool open = true;
+    std::uint64_t queued = 0;
+
+    // GL thread only.
+    std::vector<Batch> inFlight;   // oldest first
+    std::vector<Batch> spare;      // emptied batches, kept for their capacity
+    std::uint64_t deleted = 0;
+};
+
+Queue& queue() {
+    static Queue q;
+    return q;
+}
+
+thread_local bool tImmediate = false;
+
+void destroyNow(const Pending& p) {
+    GLuint name = p.name;
+    gpumemory::release(p.type, name);
+    switch (p.type) {
+        case GlObject::Buffer:      glstate::deleteBuffer(name); break;
+        case GlObject::VertexArray: glstate::deleteVertexArray(name); break;
+        case GlObject::Program:     glstate::deleteProgram(name); break;
+        case GlObject::Texture:     glstate::deleteTexture(name); break;
+        case GlObject::Framebuffer: glstate::deleteFramebuffer(name); break;
+        case GlObject::Renderbuffer: glDeleteRenderbuffers(1, &name); break; // never cached
+    }
+}
+
+void retire(Queue& q, Batch& batch) {
+    for (const Pending& p : batch.names) {
+        destroyNow(p);
+    }
+    q.deleted += batch.names.size();
+    batch.names.clear();
+    if (batch.fence) {
+        glDeleteSync(batch.fence);
+        batch.fence = nullptr;
+    }
+}
+
+} // namespace
+
+void destroyLater(GlObject type, GLuint name) {
+    if (name == 0) {
+        return;
+    }
+    if (tImmediate) {
+        destroyNow(Pending{type, name});
+        return;
+    }
+    Queue& q = queue();
+    std::lock_guard<std::mutex> lock(q.mutex);
+    if (q.open) {
+        q.incoming.push_back(Pending{type, name});
+        ++q.queued;
+    } else {
+        gpumemory::release(type, name);    // goes with the context
+    }
+}
+
+void setImmediate(bool immediate) {
+    tImmediate = immediate;
+}
+
+void collect() {
+    Queue& q = queue();
+    Batch batch;
+    if (!q.spare.empty()) {
+        batch = std::move(q.spare.back());
+        q.spare.pop_back();
+    }
+    {
+        std::lock_guard<std::mutex> lock(q.mutex);
+        batch.names.swap(q.incoming);
+    }
+    if (!batch.names.empty()) {
+        // Everything submitted so far, this frame's draws included, comes before the fence.
+        batch.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        q.inFlight.push_back(std::move(batch));
+    } else {
+        q.spare.push_back(std::move(batch));
+    }
+
+    // Fences signal in submission order: stop at the first one still pending.
+    std::size_t done = 0;
+    while (done < q.inFlight.size()) {
+        const GLenum status = glClientWaitSync(q.inFlight[done].fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+            break;
+        }
+        retire(q, q.inFlight[done]);
+        ++done;
+    }
+    for (std::size_t i = 0; i < done; ++i) {
+        q.spare.push_back(std::move(q.inFlight[i]));
+    }
+    q.inFlight.erase(q.inFlight.begin(), q.inFlight.begin() + static_cast<std::ptrdiff_t>(done));
+}
+
+void shutdown() {
+    Queue& q = queue();
+    Batch last;
+    {
+        std::lock_guard<std::mutex> lock(q.mutex);
+        q.open = false;
+        last.names.swap(q.incoming);
+    }
+    glFinish();                    // every fence is signaled now
+    for (Batch& batch : q.inFlight) {
+        retire(q, batch);
+    }
+    retire(q, last);
+    q.inFlight.clear();
+    q.spare.clear();
+}
+
+Stats stats() {
+    Queue& q = queue();
+    Stats s;
+    std::size_t inFlight = 0;
+    for (const Batch& batch : q.inFlight) {
+        inFlight += batch.names.size();
+    }
+    std::lock_guard<std::mutex> lock(q.mutex);
+    s.queued = q.queued;
+    s.deleted = q.deleted;
+    s.pending = q.incoming.size() + inFlight;
+    return s;
+}
+
+void report(std::ostream& out) {
+    const Stats s = stats();
+    out << "GL objects: " << s.queued << " queued, " << s.deleted << " deleted, " << s.pending << " pending\n";
+}
+
+GLuint create(GlObject type) {
+    GLuint name = 0;
+    switch (type) {
+        // With DSA the object must exist before its first by-name edit: glCreate*, not
+        // glGen* (which only reserves the name until the first bind).
+        case GlObject::Buffer:
+            if (glext::caps().directStateAccess) glext::createBuffers(1, &name);
+            else glGenBuffers(1, &name);
+            break;
+        case GlObject::VertexArray:
+            if (glext::caps().directStateAccess) glext::createVertexArrays(1, &name);
+            else glGenVertexArrays(1, &name);
+            break;
+        case GlObject::Program:     name = glCreateProgram(); break;
+        case GlObject::Texture:     glGenTextures(1, &name); break;
+        case GlObject::Framebuffer: glGenFramebuffers(1, &name); break;
+        case GlObject::Renderbuffer: glGenRenderbuffers(1, &name); break;
+    }
+    return name;
+}
+
+} // namespace glresource
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+
+// GL resource handles
+// -------------------
+// GlBuffer, GlVertexArray, GlProgram, GlTexture, GlFramebuffer and GlRenderbuffer own one
+// GL object name each. They are
+// move-only, and letting one go (destructor, reset(), move-assignment over it) does NOT
+// call glDelete*: the name goes to a deletion queue that deletes it on the GL thread once
+// the GPU has finished every frame that could still use it:
+//
+//     frame N:  draw with texture T, then T.reset()       → T queued
+//     end of N: glresource::collect()                      → fence F after frame N's work
+//     later:    collect() sees F signaled                  → glDeleteTextures(T)
+//
+// | Without the queue                            | With it                                  |
+// | -------------------------------------------- | ---------------------------------------- |
+// | glDelete* while queued draws still read it:  | deleted when the fence says the GPU is   |
+// | some drivers synchronize right there         | done: the frame never waits              |
+// | must run on the thread with the context      | any thread may drop a handle             |
+// | easy to forget one (see the old main())      | the destructor can't forget              |
+//
+// Deletion goes through glstate::delete*, so the bind cache forgets the name at the
+// moment it really dies, and releases its size from render/gpu_memory.h's totals. Names queued after glresource::shutdown() are dropped: by then
+// the context (and every object in it) is about to be destroyed anyway.
+enum class GlObject : std::uint8_t { Buffer, VertexArray, Program, Texture, Framebuffer, Renderbuffer };
+
+namespace glresource {
+
+struct Stats {
+    std::uint64_t queued = 0;      // names handed to the queue so far
+    std::uint64_t deleted = 0;     // ... and actually deleted
+    std::size_t pending = 0;       // waiting: not yet fenced, or fence not signaled
+};
+
+// Any thread. name 0 is ignored.
+void destroyLater(GlObject type, GLuint name);
+
+// For a thread with a context of its own that no frame loop collects (render/
+// context_pool.h): from now on its handles delete their names at once, in its context,
+// instead of queueing them for the main one, where a VAO or framebuffer name is some
+// other object. The thread must be done with them on the GPU (glFinish).
+void setImmediate(bool immediate);
+
+// GL thread, once per frame after the frame's last GL call: fences what was queued since
+// the previous call and deletes every batch whose fence has signaled. Never blocks.
+void collect();
+
+// GL thread, before the context goes away: waits for the GPU, deletes everything still
+// queued, and drops whatever is queued afterwards.
+void shutdown();
+
+Stats stats();                     // GL thread
+
+// "GL objects: 12 queued, 10 deleted, 2 pending".
+void report(std::ostream& out);
+
+// glGen* / glCreateProgram for one object (buffers and VAOs: glCreate* with DSA, so they
+// can be edited by name straight away; render/gl_buffer.h).
+GLuint create(GlObject type);
+
+} // namespace glresource
+
+template <GlObject Type>
+class GlHandle {
+public:
+    GlHandle() = default;
+    explicit GlHandle(GLuint name) : name_(name) {}
+    ~GlHandle() { reset(); }
+
+    GlHandle(const GlHandle&) = delete;
+    GlHandle& operator=(const GlHandle&) = delete;
+    GlHandle(GlHandle&& other) noexcept : name_(other.release()) {}
+    GlHandle& operator=(GlHandle&& other) noexcept {
+        if (this != &other) {
+            reset(other.release());
+        }
+        return *this;
+    }
+
+    // A new object (needs the GL context current).
+    static GlHandle create() { return GlHandle(glresource::create(Type)); }
+
+    GLuint get() const { return name_; }
+    explicit operator bool() const { return name_ != 0; }
+
+    // Queues the current object for deletion and takes `name` instead.
+    void reset(GLuint name = 0) {
+        if (name_ != 0 && name_ != name) {
+            glresource::destroyLater(Type, name_);
+        }
+        name_ = name;
+    }
+    // Gives up ownership without deleting.
+    GLuint release() {
+        const GLuint name = name_;
+        name_ = 0;
+        return name;
+    }
+
+private:
+    GLuint name_ = 0;
+};
+
+using GlBuffer = GlHandle<GlObject::Buffer>;
+using GlVertexArray = GlHandle<GlObject::VertexArray>;
+using GlProgram = GlHandle<GlObject::Program>;
+using GlTexture = GlHandle<GlObject::Texture>;
+using GlFramebuffer = GlHandle<GlObject::Framebuffer>;
+using GlRenderbuffer = GlHandle<GlObject::Renderbuffer>;
@@ -0,0 +1,124 @@
+#include "render/gl_stall.h"
+
+#include <algorithm>
+#include <mutex>
+#include <ostream>
+
+#include "core/log.h"
+#include "profile/flight_recorder.h"
+
+namespace glstall {
+namespace {
+
+constexpr int kMaxSites = 32;          // past them, waits still count in the totals
+
+struct Site {
+    const char* name;
+    std::uint64_t waits;
+    std::uint64_t stalls;
+    double stalledMs;
+    double worstMs;
+};
+
+struct State {
+    std::mutex mutex;                  // the totals and the sites; not the threshold
+    std::uint64_t thresholdNs = static_cast<std::uint64_t>(kDefaultThresholdMs * 1e6);
+    Site sites[kMaxSites];
+    int siteCount = 0;
+    std::uint64_t waits = 0;
+    std::uint64_t stalls = 0;
+    double stalledMs = 0.0;
+    Frame frame;
+};
+
+State& state() {
+    static State s;
+    return s;
+}
+
+Site* find(State& s, const char* name) {
+    for (int i = 0; i < s.siteCount; ++i) {
+        if (s.sites[i].name == name) {
+            return &s.sites[i];
+        }
+    }
+    if (s.siteCount == kMaxSites) {
+        return nullptr;
+    }
+    s.sites[s.siteCount] = Site{name, 0, 0, 0.0, 0.0};
+    return &s.sites[s.siteCount++];
+}
+
+} // namespace
+
+void setThresholdMs(double ms) {
+    state().thresholdNs = static_cast<std::uint64_t>(std::max(0.0, ms) * 1e6);
+}
+
+double thresholdMs() {
+    return static_cast<double>(state().thresholdNs) / 1e6;
+}
+
+void finish(const char* site, std::uint64_t startNs) {
+    State& s = state();
+    const std::uint64_t durationNs = trace::now() - startNs;
+    std::unique_lock<std::mutex> lock(s.mutex);
+    ++s.waits;
+    Site* entry = find(s, site);
+    if (entry != nullptr) {
+        ++entry->waits;
+    }
+    if (durationNs <= s.thresholdNs) {
+        return;
+    }
+    const double ms = static_cast<double>(durationNs) / 1e6;
+    ++s.stalls;
+    s.stalledMs += ms;
+    ++s.frame.stalls;
+    s.frame.ms += static_cast<float>(ms);
+    const bool first = entry != nullptr && entry->stalls++ == 0;
+    if (entry != nullptr) {
+        entry->stalledMs += ms;
+        entry->worstMs = std::max(entry->worstMs, ms);
+    }
+    lock.unlock();
+    if (trace::active()) {
+        trace::complete(site, startNs, durationNs);
+        trace::instant("gl stall");
+    }
+    flightrec::stall(site, durationNs);
+    if (first) {
+        logging::warn("GL stall: %s waited %.2f ms for the GPU (first at this site)", site, ms);
+    }
+}
+
+Frame takeFrame() {
+    State& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    const Frame frame = s.frame;
+    s.frame = Frame{};
+    return frame;
+}
+
+void report(std::ostream& out) {
+    State& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    out << "GL stalls (> " << thresholdMs() << " ms): " << s.stalls << " of " << s.waits << " waits, "
+        << s.stalledMs << " ms\n";
+    // The costliest first: the site to look at.
+    const Site* sorted[kMaxSites];
+    int count = 0;
+    for (int i = 0; i < s.siteCount; ++i) {
+        if (s.sites[i].stalls > 0) {
+            sorted[count++] = &s.sites[i];
+        }
+    }
+    std::sort(sorted, sorted + count, [](const Site* a, const Site* b) { return a->stalledMs > b->stalledMs; });
+    for (int i = 0; i < count; ++i) {
+        const Site& site = *sorted[i];
+        out << "  " << site.name << ": " << site.stalls << " of " << site.waits << " waits, " << site.stalledMs
+            << " ms, worst " << site.worstMs << " ms\n";
+    }
+}
+
+} // namespace glstall
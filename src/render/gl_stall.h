@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+
+#include "profile/trace.h"
+
+// gl_stall
+// --------
+// Finds the places where the CPU waits for the GPU. A map, a readback or a fence wait
+// normally returns at once (the fences and readback rings exist so that it does); when
+// the GPU falls behind, or the driver decides a buffer is still in use, the same call
+// blocks until the GPU catches up, and the frame shows a spike nothing else explains.
+// Each such call is wrapped in a Wait named after its call site:
+//
+//     {
+//         const glstall::Wait wait("overdraw map");
+//         counts = glMapBufferRange(GL_PIXEL_PACK_BUFFER, ...);
+//     }
+//
+// A wait longer than the threshold (--stall-ms, default kDefaultThresholdMs) is a stall:
+//
+// | Where          | What                                                        |
+// | -------------- | ----------------------------------------------------------- |
+// | trace          | the wait as a span named after the site, and a "gl stall"   |
+// |                | marker (with --trace; in the flight recorder's rings too)   |
+// | log            | the first stall of each site, with its duration             |
+// | report()       | per site: waits, stalls, stalled ms, worst (with --profile) |
+// | HUD            | stalls and stalled ms per frame (takeFrame())               |
+//
+// | Site                               | Can block on                                |
+// | ---------------------------------- | ------------------------------------------- |
+// | stream buffer fence / map          | the GPU still reading the segment           |
+// | * readback (glReadPixels to a PBO) | a driver that copies synchronously          |
+// | * map (of a readback buffer)       | a readback whose fence was not checked      |
+// | frame capture fence                | the capture ring full: waited on purpose    |
+//
+// Fence polls with a zero timeout are not wrapped: they never block.
+//
+// A Wait is two clock reads and an uncontended lock; sites must be string literals (the
+// trace keeps the pointer, the per-site table is keyed by it). Any thread with a context
+// current: the render thread, and a ContextPool's (render/context_pool.h).
+namespace glstall {
+
+constexpr double kDefaultThresholdMs = 0.5;
+
+void setThresholdMs(double ms);
+double thresholdMs();
+
+// The wait from `startNs` (trace::now()) until now, at `site`.
+void finish(const char* site, std::uint64_t startNs);
+
+// Times the enclosing block as a wait at `site`.
+class Wait {
+public:
+    explicit Wait(const char* site) : site_(site), start_(trace::now()) {}
+    ~Wait() { finish(site_, start_); }
+    Wait(const Wait&) = delete;
+    Wait& operator=(const Wait&) = delete;
+
+private:
+    const char* site_;
+    std::uint64_t start_;
+};
+
+struct Frame {
+    std::uint32_t stalls = 0;
+    float ms = 0.0f;                   // spent in them
+};
+// The stalls since the previous call (once per frame, for the HUD).
+Frame takeFrame();
+
+// "GL stalls (> 0.5 ms): 3 of 1200 waits, 4.1 ms" and, per site with a stall, its
+// counts and worst. Only the totals when nothing stalled.
+void report(std::ostream& out);
+
+} // namespace glstall
@@ -0,0 +1,422 @@
+#include "render/gl_state.h"
+
+#include <cstdio>
+#include <ostream>
+
+namespace glstate {
+namespace {
+
+constexpr GLuint kUnknown = 0xffffffffu;
+constexpr GLenum kUnknownEnum = 0xffffffffu;
+constexpr int kMaxUnits = 16;
+constexpr int kMaxUniformBindings = 16;
+
+// Buffer targets the cache tracks, and where in State::buffers each one lives.
+constexpr GLenum kBufferTargets[] = {
+    GL_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER, GL_UNIFORM_BUFFER,
+    GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, GL_PIXEL_UNPACK_BUFFER,
+};
+constexpr int kBufferTargetCount = sizeof(kBufferTargets) / sizeof(kBufferTargets[0]);
+constexpr int kElementArraySlot = 1;
+
+constexpr GLenum kCapabilities[] = {GL_BLEND, GL_DEPTH_TEST, GL_CULL_FACE, GL_SCISSOR_TEST};
+constexpr int kCapabilityCount = sizeof(kCapabilities) / sizeof(kCapabilities[0]);
+
+enum Tristate : std::uint8_t { Off, On, Unknown };
+
+struct State {
+    GLuint program;
+    GLuint vao;
+    GLuint buffers[kBufferTargetCount];
+    GLuint uniformBindings[kMaxUniformBindings];
+    GLintptr uniformOffsets[kMaxUniformBindings];   // -1: the whole buffer (bindBufferBase)
+    GLsizeiptr uniformSizes[kMaxUniformBindings];
+    int activeUnit;                  // -1 = unknown
+    GLuint textures2D[kMaxUnits];
+    GLuint textures2DArray[kMaxUnits];
+    Tristate capabilities[kCapabilityCount];
+    GLenum blendSource, blendDestination;
+    GLenum blendSourceAlpha, blendDestinationAlpha;
+    GLenum depthFunction;
+    Tristate depthWrite;
+    GLuint drawFramebuffer, readFramebuffer;
+    GLint viewport[4];
+};
+
+// Per thread: each thread has its own context current (render/gl_state.h).
+thread_local State state;
+thread_local Stats counters;
+thread_local bool initialized = false;
+
+void forget() {
+    state.program = kUnknown;
+    state.vao = kUnknown;
+    for (GLuint& b : state.buffers) b = kUnknown;
+    for (GLuint& b : state.uniformBindings) b = kUnknown;
+    for (GLintptr& o : state.uniformOffsets) o = -1;
+    for (GLsizeiptr& n : state.uniformSizes) n = 0;
+    state.activeUnit = -1;
+    for (GLuint& t : state.textures2D) t = kUnknown;
+    for (GLuint& t : state.textures2DArray) t = kUnknown;
+    for (Tristate& c : state.capabilities) c = Unknown;
+    state.blendSource = state.blendDestination = kUnknownEnum;
+    state.blendSourceAlpha = state.blendDestinationAlpha = kUnknownEnum;
+    state.depthFunction = kUnknownEnum;
+    state.depthWrite = Unknown;
+    state.drawFramebuffer = state.readFramebuffer = kUnknown;
+    state.viewport[0] = state.viewport[1] = -1;
+    state.viewport[2] = state.viewport[3] = -1;
+}
+
+State& current() {
+    if (!initialized) {
+        forget();
+        initialized = true;
+    }
+    return state;
+}
+
+// true = the call must go to GL (and is counted as issued).
+bool changed(Kind kind, bool differs) {
+    Counter& c = counters.kinds[static_cast<int>(kind)];
+    if (differs) {
+        ++c.issued;
+    } else {
+        ++c.filtered;
+    }
+    return differs;
+}
+
+int bufferSlot(GLenum target) {
+    for (int i = 0; i < kBufferTargetCount; ++i) {
+        if (kBufferTargets[i] == target) return i;
+    }
+    return -1;
+}
+
+int capabilitySlot(GLenum capability) {
+    for (int i = 0; i < kCapabilityCount; ++i) {
+        if (kCapabilities[i] == capability) return i;
+    }
+    return -1;
+}
+
+const char* kindName(Kind kind) {
+    switch (kind) {
+        case Kind::Program:       return "program";
+        case Kind::VertexArray:   return "vertex array";
+        case Kind::Buffer:        return "buffer";
+        case Kind::BufferBase:    return "buffer base";
+        case Kind::ActiveTexture: return "active texture";
+        case Kind::Texture:       return "texture";
+        case Kind::Capability:    return "enable/disable";
+        case Kind::BlendFunc:     return "blend func";
+        case Kind::DepthFunc:     return "depth func";
+        case Kind::DepthMask:     return "depth mask";
+        case Kind::Framebuffer:   return "framebuffer";
+        case Kind::Viewport:      return "viewport";
+        case Kind::Count:         break;
+    }
+    return "?";
+}
+
+} // namespace
+
+std::uint64_t Stats::issued() const {
+    std::uint64_t n = 0;
+    for (const Counter& c : kinds) n += c.issued;
+    return n;
+}
+
+std::uint64_t Stats::filtered() const {
+    std::uint64_t n = 0;
+    for (const Counter& c : kinds) n += c.filtered;
+    return n;
+}
+
+void useProgram(GLuint program) {
+    State& s = current();
+    if (changed(Kind::Program, s.program != program)) {
+        glUseProgram(program);
+        s.program = program;
+    }
+}
+
+void bindVertexArray(GLuint vao) {
+    State& s = current();
+    if (changed(Kind::VertexArray, s.vao != vao)) {
+        glBindVertexArray(vao);
+        s.vao = vao;
+        // The element buffer binding belongs to the VAO: whatever the new one recorded
+        // is not what the cache last saw.
+        s.buffers[kElementArraySlot] = kUnknown;
+    }
+}
+
+void bindBuffer(GLenum target, GLuint buffer) {
+    State& s = current();
+    const int slot = bufferSlot(target);
+    if (slot < 0) {
+        changed(Kind::Buffer, true);
+        glBindBuffer(target, buffer);
+        return;
+    }
+    if (changed(Kind::Buffer, s.buffers[slot] != buffer)) {
+        glBindBuffer(target, buffer);
+        s.buffers[slot] = buffer;
+    }
+}
+
+void bindBufferBase(GLenum target, GLuint index, GLuint buffer) {
+    State& s = current();
+    if (target != GL_UNIFORM_BUFFER || index >= static_cast<GLuint>(kMaxUniformBindings)) {
+        changed(Kind::BufferBase, true);
+        glBindBufferBase(target, index, buffer);
+        const int slot = bufferSlot(target);
+        if (slot >= 0) s.buffers[slot] = buffer;
+        return;
+    }
+    if (changed(Kind::BufferBase, s.uniformBindings[index] != buffer || s.uniformOffsets[index] != -1)) {
+        glBindBufferBase(target, index, buffer);
+        s.uniformBindings[index] = buffer;
+        s.uniformOffsets[index] = -1;
+        s.buffers[bufferSlot(GL_UNIFORM_BUFFER)] = buffer; // the generic binding moves too
+    }
+}
+
+void bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) {
+    State& s = current();
+    if (target != GL_UNIFORM_BUFFER || index >= static_cast<GLuint>(kMaxUniformBindings)) {
+        changed(Kind::BufferBase, true);
+        glBindBufferRange(target, index, buffer, offset, size);
+        const int slot = bufferSlot(target);
+        if (slot >= 0) s.buffers[slot] = buffer;
+        return;
+    }
+    if (changed(Kind::BufferBase, s.uniformBindings[index] != buffer || s.uniformOffsets[index] != offset ||
+                                      s.uniformSizes[index] != size)) {
+        glBindBufferRange(target, index, buffer, offset, size);
+        s.uniformBindings[index] = buffer;
+        s.uniformOffsets[index] = offset;
+        s.uniformSizes[index] = size;
+        s.buffers[bufferSlot(GL_UNIFORM_BUFFER)] = buffer;
+    }
+}
+
+void activeTexture(GLenum unit) {
+    State& s = current();
+    const int index = static_cast<int>(unit - GL_TEXTURE0);
+    if (changed(Kind::ActiveTexture, s.activeUnit != index)) {
+        glActiveTexture(unit);
+        s.activeUnit = index;
+    }
+}
+
+void bindTexture(GLenum target, GLuint texture) {
+    State& s = current();
+    GLuint* units = target == GL_TEXTURE_2D       ? s.textures2D
+                  : target == GL_TEXTURE_2D_ARRAY ? s.textures2DArray
+                                                  : nullptr;
+    if (!units || s.activeUnit < 0 || s.activeUnit >= kMaxUnits) {
+        changed(Kind::Texture, true);
+        glBindTexture(target, texture);
+        if (units && s.activeUnit < 0) {
+            for (int u = 0; u < kMaxUnits; ++u) units[u] = kUnknown; // don't know which unit changed
+        }
+        return;
+    }
+    GLuint& bound = units[s.activeUnit];
+    if (changed(Kind::Texture, bound != texture)) {
+        glBindTexture(target, texture);
+        bound = texture;
+    }
+}
+
+void setEnabled(GLenum capability, bool enabled) {
+    State& s = current();
+    const int slot = capabilitySlot(capability);
+    const Tristate wanted = enabled ? On : Off;
+    if (slot >= 0 && !changed(Kind::Capability, s.capabilities[slot] != wanted)) {
+        return;
+    }
+    if (slot < 0) {
+        changed(Kind::Capability, true);
+    } else {
+        s.capabilities[slot] = wanted;
+    }
+    if (enabled) {
+        glEnable(capability);
+    } else {
+        glDisable(capability);
+    }
+}
+
+void enable(GLenum capability) { setEnabled(capability, true); }
+void disable(GLenum capability) { setEnabled(capability, false); }
+
+void blendFunc(GLenum source, GLenum destination) {
+    blendFuncSeparate(source, destination, source, destination);
+}
+
+void blendFuncSeparate(GLenum source, GLenum destination, GLenum sourceAlpha, GLenum destinationAlpha) {
+    State& s = current();
+    if (changed(Kind::BlendFunc, s.blendSource != source || s.blendDestination != destination ||
+                                     s.blendSourceAlpha != sourceAlpha ||
+                                     s.blendDestinationAlpha != destinationAlpha)) {
+        if (sourceAlpha == source && destinationAlpha == destination) {
+            glBlendFunc(source, destination);
+        } else {
+            glBlendFuncSeparate(source, destination, sourceAlpha, destinationAlpha);
+        }
+        s.blendSource = source;
+        s.blendDestination = destination;
+        s.blendSourceAlpha = sourceAlpha;
+        s.blendDestinationAlpha = destinationAlpha;
+    }
+}
+
+void depthFunc(GLenum function) {
+    State& s = current();
+    if (changed(Kind::DepthFunc, s.depthFunction != function)) {
+        glDepthFunc(function);
+        s.depthFunction = function;
+    }
+}
+
+void depthMask(bool write) {
+    State& s = current();
+    const Tristate wanted = write ? On : Off;
+    if (changed(Kind::DepthMask, s.depthWrite != wanted)) {
+        glDepthMask(write ? GL_TRUE : GL_FALSE);
+        s.depthWrite = wanted;
+    }
+}
+
+void bindFramebuffer(GLenum target, GLuint framebuffer) {
+    State& s = current();
+    const bool draw = target != GL_READ_FRAMEBUFFER;
+    const bool read = target != GL_DRAW_FRAMEBUFFER;
+    if (changed(Kind::Framebuffer, (draw && s.drawFramebuffer != framebuffer) ||
+                                       (read && s.readFramebuffer != framebuffer))) {
+        glBindFramebuffer(target, framebuffer);
+        if (draw) s.drawFramebuffer = framebuffer;
+        if (read) s.readFramebuffer = framebuffer;
+    }
+}
+
+void viewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+    State& s = current();
+    GLint* v = s.viewport;
+    if (changed(Kind::Viewport, v[0] != x || v[1] != y || v[2] != width || v[3] != height)) {
+        glViewport(x, y, width, height);
+        v[0] = x;
+        v[1] = y;
+        v[2] = width;
+        v[3] = height;
+    }
+}
+
+void deletedProgram(GLuint program) {
+    // A program in use is only flagged for deletion and stays bound: don't guess.
+    State& s = current();
+    if (s.program == program) s.program = kUnknown;
+}
+
+void deletedVertexArray(GLuint vao) {
+    State& s = current();
+    if (s.vao == vao) {
+        s.vao = 0;
+        s.buffers[kElementArraySlot] = kUnknown;
+    }
+}
+
+void deletedBuffer(GLuint buffer) {
+    State& s = current();
+    for (GLuint& b : s.buffers) {
+        if (b == buffer) b = 0;
+    }
+    for (GLuint& b : s.uniformBindings) {
+        if (b == buffer) b = kUnknown; // indexed bindings: drivers differ, don't guess
+    }
+}
+
+void deletedTexture(GLuint texture) {
+    State& s = current();
+    for (GLuint& t : s.textures2D) {
+        if (t == texture) t = 0;
+    }
+    for (GLuint& t : s.textures2DArray) {
+        if (t == texture) t = 0;
+    }
+}
+
+void deletedFramebuffer(GLuint framebuffer) {
+    // Deleting a bound framebuffer binds the default one in its place.
+    State& s = current();
+    if (s.drawFramebuffer == framebuffer) s.drawFramebuffer = 0;
+    if (s.readFramebuffer == framebuffer) s.readFramebuffer = 0;
+}
+
+void deleteProgram(GLuint& program) {
+    if (program != 0) {
+        glDeleteProgram(program);
+        deletedProgram(program);
+        program = 0;
+    }
+}
+
+void deleteVertexArray(GLuint& vao) {
+    if (vao != 0) {
+        glDeleteVertexArrays(1, &vao);
+        deletedVertexArray(vao);
+        vao = 0;
+    }
+}
+
+void deleteBuffer(GLuint& buffer) {
+    if (buffer != 0) {
+        glDeleteBuffers(1, &buffer);
+        deletedBuffer(buffer);
+        buffer = 0;
+    }
+}
+
+void deleteTexture(GLuint& texture) {
+    if (texture != 0) {
+        glDeleteTextures(1, &texture);
+        deletedTexture(texture);
+        texture = 0;
+    }
+}
+
+void deleteFramebuffer(GLuint& framebuffer) {
+    if (framebuffer != 0) {
+        glDeleteFramebuffers(1, &framebuffer);
+        deletedFramebuffer(framebuffer);
+        framebuffer = 0;
+    }
+}
+
+void invalidate() {
+    forget();
+    initialized = true;
+}
+
+const Stats& stats() { return counters; }
+
+void resetStats() { counters = Stats{}; }
+
+void report(std::ostream& out) {
+    char line[96];
+    std::snprintf(line, sizeof(line), "%-16s %10s %10s\n", "gl state", "issued", "filtered");
+    out << line;
+    for (int k = 0; k < static_cast<int>(Kind::Count); ++k) {
+        const Counter& c = counters.kinds[k];
+        if (c.issued == 0 && c.filtered == 0) continue;
+        std::snprintf(line, sizeof(line), "%-16s %10llu %10llu\n", kindName(static_cast<Kind>(k)),
+                      static_cast<unsigned long long>(c.issued), static_cast<unsigned long long>(c.filtered));
+        out << line;
+    }
+}
+
+} // namespace glstate
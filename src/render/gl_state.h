@@ -0,0 +1,120 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <iosfwd>
+
+// gl_state
+// --------
+// A thin cache in front of the glad entry points for the state this renderer binds
+// every frame. Each call compares against what the cache last set and only reaches the
+// driver when the value actually changes:
+//
+//     glstate::useProgram(program);       // glUseProgram only if a different one is bound
+//     glstate::bindVertexArray(vao);
+//     glstate::bindBuffer(GL_ARRAY_BUFFER, vbo);
+//
+// | Covered state                         | Notes                                       |
+// | ------------------------------------- | ------------------------------------------- |
+// | program, VAO                          |                                             |
+// | ARRAY / ELEMENT_ARRAY / UNIFORM /     | ELEMENT_ARRAY is VAO state: forgotten       |
+// | COPY_READ / COPY_WRITE / PIXEL_UNPACK | whenever the VAO changes                    |
+// | uniform buffer binding points 0..15   | bindBufferBase/Range also set the generic   |
+// | (buffer, and the range of it)         | target                                      |
+// | active texture unit, 2D and 2D array  | units 0..15                                 |
+// | texture per unit                      |                                             |
+// | BLEND, DEPTH_TEST, CULL_FACE,         | enable / disable / setEnabled               |
+// | SCISSOR_TEST                          |                                             |
+// | blendFunc[Separate], depthFunc,       |                                             |
+// | depthMask                             |                                             |
+// | DRAW / READ framebuffer               | GL_FRAMEBUFFER sets both                    |
+// | viewport                              |                                             |
+//
+// Anything else passes straight through (counted as issued). Everything starts UNKNOWN,
+// so the first call of each kind always goes to GL.
+//
+// The rules that keep the cache true:
+// - ALL binds of covered state go through here. Code that calls GL directly afterwards
+//   must call invalidate().
+// - Deleting a bound object unbinds it in GL; tell the cache with the deleted*() calls
+//   (or use the delete*() wrappers), otherwise a recycled name would be filtered as
+//   "already bound".
+//
+// One cache (and one set of counters) per thread, standing for the context that thread
+// has current. The game's context moves between threads only at RenderThread start/stop
+// (a thread's first call starts from UNKNOWN; stop() invalidates main's old cache); the
+// ContextPool's threads (render/context_pool.h) each keep a context of their own. The
+// --profiler-window's context shares its objects but not its bindings: whoever switches
+// contexts on a thread calls invalidate() after.
+namespace glstate {
+
+enum class Kind : std::uint8_t {
+    Program,
+    VertexArray,
+    Buffer,
+    BufferBase,
+    ActiveTexture,
+    Texture,
+    Capability,
+    BlendFunc,
+    DepthFunc,
+    DepthMask,
+    Framebuffer,
+    Viewport,
+    Count
+};
+
+struct Counter {
+    std::uint64_t issued = 0;   // reached the driver
+    std::uint64_t filtered = 0; // skipped: the value was already set
+};
+
+struct Stats {
+    Counter kinds[static_cast<int>(Kind::Count)];
+
+    std::uint64_t issued() const;
+    std::uint64_t filtered() const;
+};
+
+void useProgram(GLuint program);
+void bindVertexArray(GLuint vao);
+void bindBuffer(GLenum target, GLuint buffer);
+void bindBufferBase(GLenum target, GLuint index, GLuint buffer);
+void bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+void activeTexture(GLenum unit);                  // GL_TEXTURE0 + i
+void bindTexture(GLenum target, GLuint texture);  // on the active unit
+
+void enable(GLenum capability);
+void disable(GLenum capability);
+void setEnabled(GLenum capability, bool enabled);
+void blendFunc(GLenum source, GLenum destination);
+void blendFuncSeparate(GLenum source, GLenum destination, GLenum sourceAlpha, GLenum destinationAlpha);
+void depthFunc(GLenum function);
+void depthMask(bool write);
+void bindFramebuffer(GLenum target, GLuint framebuffer);  // GL_FRAMEBUFFER / DRAW_ / READ_
+void viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+
+// GL unbinds an object when it is deleted; these make the cache agree.
+void deletedProgram(GLuint program);
+void deletedVertexArray(GLuint vao);
+void deletedBuffer(GLuint buffer);
+void deletedTexture(GLuint texture);
+void deletedFramebuffer(GLuint framebuffer);
+
+// glDelete* + the matching deleted*(); `name` is set to 0.
+void deleteProgram(GLuint& program);
+void deleteVertexArray(GLuint& vao);
+void deleteBuffer(GLuint& buffer);
+void deleteTexture(GLuint& texture);
+void deleteFramebuffer(GLuint& framebuffer);
+
+// Forget everything: the next call of each kind goes to GL.
+void invalidate();
+
+const Stats& stats();
+void resetStats();
+
+// One line per kind with traffic: issued / filtered counts since resetStats().
+void report(std::ostream& out);
+
+} // namespace glstate
@@ -0,0 +1,297 @@
+#include "render/glyph_cache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#include "profile/trace.h"
+#include "render/gl_state.h"
+#include "render/gpu_memory.h"
+
+namespace {
+
+// Distance from p to the axis-aligned square [min, min + size]^2 (0 inside).
+float distanceToSquare(const glm::vec2& p, const glm::vec2& min, float size) {
+    const float dx = std::max({min.x - p.x, 0.0f, p.x - (min.x + size)});
+    const float dy = std::max({min.y - p.y, 0.0f, p.y - (min.y + size)});
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+} // namespace
+
+void GlyphCache::rasterize(const BitmapFont::Glyph& glyph, int pixelScale, int spread, int slotTexels,
+                           std::uint8_t* texels) {
+    constexpr int kRows = BitmapFont::kRows;
+    const int width = glyph.width;
+    const float s = static_cast<float>(pixelScale);
+    const glm::vec2 boxMin(static_cast<float>(spread));     // glyph box, in cell texels
+    // Font pixels past this many from the texel's own are beyond the clamp.
+    const int reach = spread / pixelScale + 1;
+    for (int y = 0; y < slotTexels; ++y) {
+        for (int x = 0; x < slotTexels; ++x) {
+            const glm::vec2 p(x + 0.5f, y + 0.5f);
+            // The font pixel under the texel (texture rows go up, font rows go down); the
+            // window around it, one ring outside the box included: empty, like the box edge.
+            const int column = static_cast<int>(std::floor((p.x - boxMin.x) / s));
+            const int row = kRows - 1 - static_cast<int>(std::floor((p.y - boxMin.y) / s));
+            float toInk = static_cast<float>(spread);        // nearest on square (outside)
+            float toEmpty = static_cast<float>(spread);      // nearest off square (inside)
+            bool covered = false;
+            for (int r = std::max(row - reach, -1); r <= std::min(row + reach, kRows); ++r) {
+                for (int c = std::max(column - reach, -1); c <= std::min(column + reach, width); ++c) {
+                    const glm::vec2 min = boxMin + s * glm::vec2(c, kRows - 1 - r);
+                    const float d = distanceToSquare(p, min, s);
+                    const bool inBox = r >= 0 && r < kRows && c >= 0 && c < width;
+                    if (inBox && glyph.pixel(c, r)) {
+                        toInk = std::min(toInk, d);
+                        covered = covered || d == 0.0f;
+                    } else {
+                        toEmpty = std::min(toEmpty, d);
+                    }
+                }
+            }
+            const float signedDistance = covered ? toEmpty : -toInk;
+            const float value = 0.5f + 0.5f * std::clamp(signedDistance / spread, -1.0f, 1.0f);
+            texels[static_cast<std::size_t>(y) * slotTexels + x] = static_cast<std::uint8_t>(value * 255.0f + 0.5f);
+        }
+    }
+}
+
+bool GlyphCache::init(const BitmapFont& font, const Options& options) {
+    const gpumemory::Owner owner("glyph cache");
+    shutdown();
+    if (font.size() == 0) {
+        std::cerr << "GlyphCache: the font has no glyphs\n";
+        return false;
+    }
+    font_ = &font;
+    options_ = options;
+    options_.pixelScale = std::max(1, options.pixelScale);
+    options_.spread = std::max(1, options.spread);
+    options_.uploadsPerFrame = std::max(1, options.uploadsPerFrame);
+    GLint maxSize = 4096;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+    options_.slots = std::max(2, std::min(options.slots, static_cast<int>(maxSize) / slotTexels()));
+    border_ = static_cast<float>(options_.spread) / static_cast<float>(options_.pixelScale);
+    fallback_ = font.find(0xFFFD) ? 0xFFFD : font.find('?') ? '?' : kNone;
+
+    const int atlas = options_.slots * slotTexels();
+    texture_ = GlTexture::create();
+    if (!texture_) {
+        std::cerr << "GlyphCache: failed to create the atlas texture\n";
+        return false;
+    }
+    glstate::bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glstate::activeTexture(GL_TEXTURE0);
+    glstate::bindTexture(GL_TEXTURE_2D, texture_.get());
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, atlas, atlas, 0, GL_RED, GL_UNSIGNED_BYTE, nullptr);
+    gpumemory::track(GlObject::Texture, texture_.get(), gpumemory::textureBytes(GL_R8, atlas, atlas),
+                     gpumemory::Category::Texture);
+    // Linear: interpolated distances are what keeps the outline straight when magnified.
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+
+    // Slot 0: solid, every fragment of a box samples "inside".
+    const std::vector<std::uint8_t> solid(static_cast<std::size_t>(slotTexels()) * slotTexels(), 255);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);   // rows of single bytes
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, slotTexels(), slotTexels(), GL_RED, GL_UNSIGNED_BYTE, solid.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    const float centre = 0.5f * static_cast<float>(slotTexels()) / static_cast<float>(atlas);
+    solidUv_ = glm::vec4(centre, centre, centre, centre);
+
+    slots_.assign(static_cast<std::size_t>(options_.slots) * options_.slots, Slot{});
+    freeSlots_.clear();
+    for (int s = static_cast<int>(slots_.size()) - 1; s >= 1; --s) {
+        freeSlots_.push_back(s);
+    }
+    const std::size_t slotBytes = static_cast<std::size_t>(slotTexels()) * slotTexels();
+    if (!staging_.init(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(slotBytes * options_.uploadsPerFrame))) {
+        std::cerr << "GlyphCache: no glyph upload ring\n";
+        shutdown();
+        return false;
+    }
+    stopping_ = false;
+    thread_ = std::thread(&GlyphCache::rasterLoop, this);
+    return true;
+}
+
+void GlyphCache::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        queue_.clear();
+    }
+    wake_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    rasterized_.clear();
+    incoming_.clear();
+
+    texture_.reset();
+    staging_.shutdown();
+    slots_.clear();
+    freeSlots_.clear();
+    resident_.clear();
+    pending_.clear();
+    frame_ = 0;
+    stats_ = Stats{};
+    font_ = nullptr;
+    fallback_ = kNone;
+    solidUv_ = glm::vec4(0.0f);
+}
+
+int GlyphCache::slotTexels() const {
+    return BitmapFont::kRows * options_.pixelScale + 2 * options_.spread;
+}
+
+void GlyphCache::rasterLoop() {
+    trace::setThreadName("glyph cache");
+    const int texels = slotTexels();
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        wake_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+        if (stopping_) {
+            return;
+        }
+        const std::uint32_t codepoint = queue_.front();
+        queue_.pop_front();
+        lock.unlock();
+
+        Rasterized glyph{codepoint, std::vector<std::uint8_t>(static_cast<std::size_t>(texels) * texels)};
+        {
+            trace::Scope scope("glyph raster");
+            rasterize(*font_->find(codepoint), options_.pixelScale, options_.spread, texels, glyph.texels.data());
+        }
+
+        lock.lock();
+        rasterized_.push_back(std::move(glyph));
+    }
+}
+
+void GlyphCache::update() {
+    const gpumemory::Owner owner("glyph cache");
+    if (!initialized()) {
+        return;
+    }
+    ++frame_;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.rasterized += rasterized_.size();
+        incoming_.insert(incoming_.end(), std::make_move_iterator(rasterized_.begin()),
+                         std::make_move_iterator(rasterized_.end()));
+        rasterized_.clear();
+    }
+
+    // Rasterized glyphs into slots, at most uploadsPerFrame of them, through the PBO ring.
+    const int texels = slotTexels();
+    const std::size_t slotBytes = static_cast<std::size_t>(texels) * texels;
+    std::size_t used = 0;
+    int budget = options_.uploadsPerFrame;
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    while (used < incoming_.size() && budget > 0) {
+        const Rasterized& glyph = incoming_[used];
+        StreamAllocation staging = staging_.allocate(static_cast<GLsizeiptr>(slotBytes), 4);
+        if (!staging.valid()) {
+            break;
+        }
+        ++used;
+        const int slot = takeSlot();
+        if (slot < 0) {
+            ++stats_.dropped;          // every slot is on screen: asked again by the next lookup()
+            pending_.erase(glyph.codepoint);
+            continue;
+        }
+        std::memcpy(staging.ptr, glyph.texels.data(), slotBytes);
+        staging_.commit(staging);
+        glstate::bindBuffer(GL_PIXEL_UNPACK_BUFFER, staging_.buffer());
+        glstate::activeTexture(GL_TEXTURE0);
+        glstate::bindTexture(GL_TEXTURE_2D, texture_.get());
+        glTexSubImage2D(GL_TEXTURE_2D, 0, slot % options_.slots * texels, slot / options_.slots * texels, texels,
+                        texels, GL_RED, GL_UNSIGNED_BYTE, reinterpret_cast<const void*>(staging.offset));
+        slots_[slot] = Slot{glyph.codepoint, frame_};
+        resident_[glyph.codepoint] = slot;
+        pending_.erase(glyph.codepoint);
+        ++stats_.uploads;
+        --budget;
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glstate::bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    incoming_.erase(incoming_.begin(), incoming_.begin() + static_cast<std::ptrdiff_t>(used));
+    staging_.endFrame();
+}
+
+// A free slot, or the one used longest ago. Never one looked up this frame or the last
+// (its glyph may still be drawn), nor the solid slot 0. -1: none to spare.
+int GlyphCache::takeSlot() {
+    if (!freeSlots_.empty()) {
+        const int slot = freeSlots_.back();
+        freeSlots_.pop_back();
+        return slot;
+    }
+    int oldest = -1;
+    for (int s = 1; s < static_cast<int>(slots_.size()); ++s) {
+        const Slot& slot = slots_[s];
+        if (slot.lastUsed + 1 >= frame_) {
+            continue;
+        }
+        if (oldest < 0 || slot.lastUsed < slots_[oldest].lastUsed) {
+            oldest = s;
+        }
+    }
+    if (oldest >= 0) {
+        resident_.erase(slots_[oldest].codepoint);
+        ++stats_.evictions;
+    }
+    return oldest;
+}
+
+bool GlyphCache::lookup(std::uint32_t codepoint, glm::vec4& uvRect, int& advance) {
+    advance = 8;
+    if (!initialized()) {
+        return false;
+    }
+    const BitmapFont::Glyph* glyph = font_->find(codepoint);
+    if (!glyph && fallback_ != kNone) {
+        codepoint = fallback_;
+        glyph = font_->find(codepoint);
+    }
+    if (!glyph) {
+        return false;
+    }
+    advance = glyph->width;
+    const auto it = resident_.find(codepoint);
+    if (it == resident_.end()) {
+        if (pending_.insert(codepoint).second) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                queue_.push_back(codepoint);
+            }
+            wake_.notify_one();
+        }
+        return false;
+    }
+    Slot& slot = slots_[it->second];
+    slot.lastUsed = frame_;
+    const float atlas = static_cast<float>(options_.slots * slotTexels());
+    const float u0 = static_cast<float>(it->second % options_.slots * slotTexels()) / atlas;
+    const float v0 = static_cast<float>(it->second / options_.slots * slotTexels()) / atlas;
+    const float width = static_cast<float>(glyph->width * options_.pixelScale + 2 * options_.spread) / atlas;
+    uvRect = glm::vec4(u0, v0, u0 + width, v0 + static_cast<float>(slotTexels()) / atlas);
+    return true;
+}
+
+bool GlyphCache::busy() const {
+    return !pending_.empty();
+}
+
+GlyphCache::Stats GlyphCache::stats() const {
+    Stats stats = stats_;
+    stats.resident = resident_.size();
+    stats.pending = pending_.size();
+    return stats;
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "asset/bitmap_font.h"
+#include "render/gl_resource.h"
+#include "render/stream_buffer.h"
+
+// GlyphCache
+// ----------
+// Signed distance field glyphs for any character of a BitmapFont (--font, a Unifont
+// .hex: the whole BMP), made the first time text asks for them. SdfFont bakes ASCII at
+// startup; baking tens of thousands of CJK glyphs the same way would take seconds and
+// tens of MB for the few hundred a screen ever shows. Instead, one atlas texture of
+// fixed-size SLOTS holds the glyphs in use:
+//
+//     lookup(c) on the GL thread ── resident? ──▶ its slot's uvRect (marked used)
+//           │ no: queued once, drawn blank this frame
+//           ▼
+//     raster thread: BitmapFont bits → distance field (as SdfFont's: 0.5 = the outline)
+//           ▼
+//     update(), GL thread: ≤ uploadsPerFrame glyphs into free or least recently used
+//     slots, through a PBO ring (StreamBuffer on GL_PIXEL_UNPACK_BUFFER)
+//
+// | Slots (default 32²) | Texels each (scale 2, spread 4) | Atlas, R8     | Glyphs held |
+// | ------------------- | ------------------------------- | ------------- | ----------- |
+// | 1024                | 40 x 40                         | 1280², 1.6 MB | 1023        |
+//
+// Everything text draws comes from this ONE texture, ASCII included, and slot 0 is
+// solid (solidUv(), for boxes): a screen of text in any script stays one sprite batch
+// draw, as with SdfFont. A slot is only reused once its glyph went a whole frame without
+// a lookup(), so nothing drawn this frame or the last is ever overwritten; when every
+// slot is that busy, a glyph waits (dropped, asked for again by its next lookup()).
+//
+// The distances come from a window of font pixels around each texel (spread / scale of
+// them, plus one), not the whole glyph: exact, since farther pixels are beyond the
+// clamp anyway, and about 25 pixel tests per texel instead of 256. A missing character
+// shows as U+FFFD, or '?' when the font lacks that too.
+//
+// GL thread only, apart from the rasterization on the cache's own thread (not a
+// JobSystem job: a frame's wait() must not pick it up).
+class GlyphCache {
+public:
+    struct Options {
+        int pixelScale = 2;            // atlas texels per font pixel
+        int spread = 4;                // texels of distance on each side of the outline
+        int slots = 32;                // per side of the atlas
+        int uploadsPerFrame = 32;
+    };
+
+    struct Stats {
+        std::size_t resident = 0;      // glyphs in slots
+        std::size_t pending = 0;       // asked for, not uploaded yet
+        std::uint64_t rasterized = 0;
+        std::uint64_t uploads = 0;
+        std::uint64_t evictions = 0;
+        std::uint64_t dropped = 0;     // rasterized, but no slot to spare
+    };
+
+    GlyphCache() = default;
+    GlyphCache(const GlyphCache&) = delete;
+    GlyphCache& operator=(const GlyphCache&) = delete;
+
+    // CPU only: `glyph` as a distance field into `texels`, a slotTexels² R8 cell (rows
+    // bottom-up), the glyph box `spread` texels in from its lower-left corner.
+    static void rasterize(const BitmapFont::Glyph& glyph, int pixelScale, int spread, int slotTexels,
+                          std::uint8_t* texels);
+
+    // GL thread. `font` must outlive the cache. Starts the raster thread.
+    bool init(const BitmapFont& font, const Options& options);
+    void shutdown();
+
+    // GL thread, once per frame before text is laid out.
+    void update();
+    // GL thread: the character's cell, border included, as a Sprite::uvRect, and its
+    // advance in font pixels. false: not resident yet (queued) or the font has nothing
+    // for it; `advance` is right either way.
+    bool lookup(std::uint32_t codepoint, glm::vec4& uvRect, int& advance);
+
+    GLuint texture() const { return texture_.get(); }
+    bool initialized() const { return texture_.get() != 0; }
+    glm::vec4 solidUv() const { return solidUv_; }
+    float border() const { return border_; }                    // spread, in font pixels
+    // Glyphs still on their way: the text on screen is not final yet.
+    bool busy() const;
+    // Changes whenever a slot gets a glyph: geometry built from older lookup()s may miss
+    // characters or point at another one's slot (render/ui_renderer.h rebuilds it).
+    std::uint64_t generation() const { return stats_.uploads; }
+    Stats stats() const;
+
+private:
+    struct Slot {
+        std::uint32_t codepoint = kNone;
+        std::uint64_t lastUsed = 0;    // frame_ of the last lookup()
+    };
+    struct Rasterized {
+        std::uint32_t codepoint;
+        std::vector<std::uint8_t> texels;
+    };
+
+    static constexpr std::uint32_t kNone = 0xffffffffu;
+
+    void rasterLoop();
+    int takeSlot();
+    int slotTexels() const;
+
+    const BitmapFont* font_ = nullptr;
+    Options options_;
+    float border_ = 0.0f;
+    std::uint32_t fallback_ = kNone;   // U+FFFD or '?'
+    GlTexture texture_;
+    glm::vec4 solidUv_{0.0f};
+    StreamBuffer staging_;
+
+    // GL thread.
+    std::vector<Slot> slots_;
+    std::vector<int> freeSlots_;
+    std::unordered_map<std::uint32_t, int> resident_;   // code point → slot
+    std::unordered_set<std::uint32_t> pending_;         // asked for, not resident
+    std::vector<Rasterized> incoming_;                  // rasterized, waiting for a slot
+    std::uint64_t frame_ = 0;
+    Stats stats_;
+
+    // Shared with the raster thread.
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::deque<std::uint32_t> queue_;
+    std::vector<Rasterized> rasterized_;
+    bool stopping_ = false;
+    std::thread thread_;
+};
@@ -0,0 +1,247 @@
+#include "render/gpu_memory.h"
+
+#include <algorithm>
+#include <mutex>
+#include <ostream>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "render/gl_ext.h"
+
+namespace gpumemory {
+namespace {
+
+constexpr const char* kCategoryNames[kCategories] = {"buffers", "uniforms", "transfer", "textures",
+                                                     "render targets"};
+
+struct Entry {
+    std::size_t bytes;
+    Category category;
+    const char* owner;
+};
+
+struct Tracker {
+    std::mutex mutex;
+    std::unordered_map<std::uint64_t, Entry> entries;   // by key()
+    Totals totals;
+};
+
+Tracker& tracker() {
+    static Tracker t;
+    return t;
+}
+
+thread_local const char* tCurrentOwner = nullptr;
+
+std::uint64_t key(GlObject type, GLuint name) {
+    return (static_cast<std::uint64_t>(type) << 32) | name;
+}
+
+// 4x4 blocks: 8 bytes (BC1, ETC2 RGB) or 16 (BC3, BC7, ETC2 + EAC alpha); 0: not compressed.
+std::size_t blockBytes(GLenum internalFormat) {
+    switch (internalFormat) {
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RGB8_ETC2:   return 8;
+        case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+        case GL_COMPRESSED_RGBA_BPTC_UNORM:
+        case GL_COMPRESSED_RGBA8_ETC2_EAC: return 16;
+        default:                        return 0;
+    }
+}
+
+// "12.3 MiB" style, for the reports.
+void printBytes(std::ostream& out, std::size_t bytes) {
+    if (bytes >= (std::size_t{1} << 20)) {
+        out << static_cast<double>(bytes) / (1 << 20) << " MiB";
+    } else {
+        out << bytes / 1024 << " KiB";
+    }
+}
+
+// Tracked bytes per owner, largest first. Called with the mutex held.
+std::vector<std::pair<const char*, std::size_t>> byOwner(const Tracker& t) {
+    std::vector<std::pair<const char*, std::size_t>> owners;
+    for (const auto& kv : t.entries) {
+        auto it = std::find_if(owners.begin(), owners.end(),
+                               [&](const auto& o) { return o.first == kv.second.owner; });
+        if (it == owners.end()) {
+            owners.emplace_back(kv.second.owner, kv.second.bytes);
+        } else {
+            it->second += kv.second.bytes;
+        }
+    }
+    std::sort(owners.begin(), owners.end(), [](const auto& a, const auto& b) { return a.second > b.second; });
+    return owners;
+}
+
+} // namespace
+
+const char* categoryName(Category category) {
+    return kCategoryNames[static_cast<int>(category)];
+}
+
+Owner::Owner(const char* name) : previous_(tCurrentOwner) {
+    tCurrentOwner = name;
+}
+
+Owner::~Owner() {
+    tCurrentOwner = previous_;
+}
+
+std::size_t texelBytes(GLenum internalFormat) {
+    switch (internalFormat) {
+        case GL_NONE:               return 0;
+        case GL_R8:
+        case GL_R8UI:               return 1;
+        case GL_RG8:
+        case GL_R16UI:
+        case GL_R16F:
+        case GL_DEPTH_COMPONENT16:  return 2;
+        case GL_RGBA16F:
+        case GL_RG32F:
+        case GL_RG32UI:             return 8;
+        case GL_RGBA32F:
+        case GL_RGBA32UI:           return 16;
+        case GL_DEPTH32F_STENCIL8:  return 8;
+        default:                    return 4;  // RGBA8(UI), R32UI/F, R11F_G11F_B10F, DEPTH24_STENCIL8, ...
+    }
+}
+
+std::size_t textureBytes(GLenum internalFormat, int width, int height, int depth, int levels) {
+    const std::size_t block = blockBytes(internalFormat);
+    std::size_t bytes = 0;
+    for (int level = 0; level < std::max(1, levels); ++level) {
+        const std::size_t w = static_cast<std::size_t>(std::max(1, width >> level));
+        const std::size_t h = static_cast<std::size_t>(std::max(1, height >> level));
+        bytes += block != 0 ? ((w + 3) / 4) * ((h + 3) / 4) * block : w * h * texelBytes(internalFormat);
+    }
+    return bytes * static_cast<std::size_t>(std::max(1, depth));
+}
+
+void track(GlObject type, GLuint name, std::size_t bytes, Category category) {
+    if (name == 0) {
+        return;
+    }
+    Tracker& t = tracker();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    Entry& e = t.entries.emplace(key(type, name), Entry{0, category, nullptr}).first->second;
+    Totals& totals = t.totals;
+    if (e.owner != nullptr) {
+        totals.bytes[static_cast<int>(e.category)] -= e.bytes;
+        --totals.objects[static_cast<int>(e.category)];
+        totals.total -= e.bytes;
+    }
+    e = Entry{bytes, category, tCurrentOwner ? tCurrentOwner : "other"};
+    totals.bytes[static_cast<int>(category)] += bytes;
+    ++totals.objects[static_cast<int>(category)];
+    totals.total += bytes;
+    totals.peak = std::max(totals.peak, totals.total);
+}
+
+void trackBuffer(GLenum target, GLuint name, std::size_t bytes) {
+    Category category = Category::Buffer;
+    if (target == GL_UNIFORM_BUFFER) {
+        category = Category::Uniform;
+    } else if (target == GL_PIXEL_PACK_BUFFER || target == GL_PIXEL_UNPACK_BUFFER) {
+        category = Category::Transfer;
+    }
+    track(GlObject::Buffer, name, bytes, category);
+}
+
+void release(GlObject type, GLuint name) {
+    Tracker& t = tracker();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    const auto it = t.entries.find(key(type, name));
+    if (it == t.entries.end()) {
+        return;
+    }
+    const Entry& e = it->second;
+    t.totals.bytes[static_cast<int>(e.category)] -= e.bytes;
+    --t.totals.objects[static_cast<int>(e.category)];
+    t.totals.total -= e.bytes;
+    t.entries.erase(it);
+}
+
+Totals totals() {
+    Tracker& t = tracker();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    return t.totals;
+}
+
+DriverInfo driver() {
+    DriverInfo info;
+    if (glext::caps().memoryInfoNvx) {
+        GLint dedicated = 0, available = 0;
+        glGetIntegerv(GL_GPU_MEMORY_INFO_DEDICATED_VIDMEM_NVX, &dedicated);
+        glGetIntegerv(GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX, &available);
+        info.source = "NVX_gpu_memory_info";
+        info.dedicatedBytes = static_cast<std::size_t>(std::max(0, dedicated)) * 1024;
+        info.availableBytes = static_cast<std::size_t>(std::max(0, available)) * 1024;
+    } else if (glext::caps().memoryInfoAti) {
+        GLint free[4] = {};            // total free, largest free block, auxiliary total, largest
+        glGetIntegerv(GL_TEXTURE_FREE_MEMORY_ATI, free);
+        info.source = "ATI_meminfo";
+        info.availableBytes = static_cast<std::size_t>(std::max(0, free[0])) * 1024;
+    }
+    return info;
+}
+
+void report(std::ostream& out) {
+    Tracker& t = tracker();
+    std::vector<std::pair<const char*, std::size_t>> owners;
+    Totals totals;
+    {
+        std::lock_guard<std::mutex> lock(t.mutex);
+        owners = byOwner(t);
+        totals = t.totals;
+    }
+    out << "GPU memory: ";
+    printBytes(out, totals.total);
+    out << " tracked (peak ";
+    printBytes(out, totals.peak);
+    out << ")";
+    for (int c = 0; c < kCategories; ++c) {
+        if (totals.objects[c] > 0) {
+            out << ", " << kCategoryNames[c] << " ";
+            printBytes(out, totals.bytes[c]);
+            out << " in " << totals.objects[c];
+        }
+    }
+    out << "\n  by owner:";
+    for (const auto& o : owners) {
+        out << " " << o.first << " ";
+        printBytes(out, o.second);
+        out << (&o == &owners.back() ? "" : ",");
+    }
+    const DriverInfo info = driver();
+    if (info.source != nullptr) {
+        out << "\n  driver (" << info.source << "): ";
+        if (info.dedicatedBytes > 0) {
+            printBytes(out, info.dedicatedBytes);
+            out << " dedicated, ";
+        }
+        printBytes(out, info.availableBytes);
+        out << " available";
+    }
+    out << "\n";
+}
+
+void reportLeaks(std::ostream& out) {
+    Tracker& t = tracker();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    if (t.entries.empty()) {
+        return;
+    }
+    out << "GPU memory: " << t.entries.size() << " objects (";
+    printBytes(out, t.totals.total);
+    out << ") never released:";
+    for (const auto& o : byOwner(t)) {
+        out << " " << o.first << " ";
+        printBytes(out, o.second);
+    }
+    out << "\n";
+}
+
+} // namespace gpumemory
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+
+#include "render/gl_resource.h"
+
+// gpu_memory
+// ----------
+// What the game has asked the GPU to hold, by object: every buffer, texture and
+// renderbuffer whose storage is specified is tracked with its size, a category and an
+// owner, until the deletion queue (render/gl_resource.h) really deletes it:
+//
+//     const gpumemory::Owner owner("tilemap");       // in the subsystem's init()
+//     glbuffer::data(GL_ARRAY_BUFFER, vbo, bytes, ...);               // tracked (Buffer)
+//     glTexImage3D(...);
+//     gpumemory::track(GlObject::Texture, texture, gpumemory::textureBytes(GL_R16UI, w, h, layers),
+//                      gpumemory::Category::Texture);
+//
+// | Category     | What                                   | Tracked by                      |
+// | ------------ | -------------------------------------- | ------------------------------- |
+// | Buffer       | vertex, index, instance, indirect,     | glbuffer::data / storage (the   |
+// |              | texel and storage buffers              | category comes from the target) |
+// | Uniform      | GL_UNIFORM_BUFFER                      | ... likewise                    |
+// | Transfer     | pixel pack / unpack (readbacks, PBOs)  | ... likewise                    |
+// | Texture      | images, arrays, atlases, tables        | track() after glTex*Image       |
+// | RenderTarget | attachments of a RenderTarget          | RenderTarget::allocate          |
+//
+// Specifying storage again for a tracked name replaces its size (a resize); deletion
+// releases it. The owner is whatever Owner scope is open on the thread (nested scopes:
+// the innermost), "other" outside any. Sizes are what was asked for: drivers round up,
+// pad and keep copies, so the driver's own numbers (driver(): NVX_gpu_memory_info or
+// ATI_meminfo, when the extension is there) are reported next to them:
+//
+// | Query                 | Gives                                                     |
+// | --------------------- | --------------------------------------------------------- |
+// | NVX_gpu_memory_info   | dedicated video memory, and what is currently free of it  |
+// | ATI_meminfo           | free memory of the texture pool (no total)                |
+// | neither (Intel, Mesa) | nothing: the tracked totals are all there is              |
+//
+// A leak shows as a total that only grows, and at exit: whatever is still tracked after
+// glresource::shutdown() was never let go (reportLeaks()).
+//
+// Any thread (a mutex; allocations are rare). driver() on the GL thread.
+namespace gpumemory {
+
+enum class Category : std::uint8_t { Buffer, Uniform, Transfer, Texture, RenderTarget };
+constexpr int kCategories = 5;
+
+const char* categoryName(Category category);
+
+// Names whatever is tracked on this thread while it is open. `name` must outlive the
+// tracking (a string literal).
+class Owner {
+public:
+    explicit Owner(const char* name);
+    ~Owner();
+    Owner(const Owner&) = delete;
+    Owner& operator=(const Owner&) = delete;
+
+private:
+    const char* previous_;
+};
+
+// Bytes per texel of an uncompressed internal format.
+std::size_t texelBytes(GLenum internalFormat);
+// A width x height x depth texture (depth: layers, or a renderbuffer's samples) with
+// `levels` mip levels, each half the one before; block-compressed formats by 4x4 blocks.
+std::size_t textureBytes(GLenum internalFormat, int width, int height, int depth = 1, int levels = 1);
+
+// `name`'s storage is `bytes` now. name 0 is ignored.
+void track(GlObject type, GLuint name, std::size_t bytes, Category category);
+// A buffer's storage, the category from the target it was specified through.
+void trackBuffer(GLenum target, GLuint name, std::size_t bytes);
+// Deleted: no longer counted. Untracked names are ignored.
+void release(GlObject type, GLuint name);
+
+struct Totals {
+    std::size_t bytes[kCategories] = {};
+    std::size_t objects[kCategories] = {};
+    std::size_t total = 0;             // bytes, over the categories
+    std::size_t peak = 0;              // the highest total so far
+};
+Totals totals();
+
+// What the driver reports; 0: unknown.
+struct DriverInfo {
+    const char* source = nullptr;      // "NVX_gpu_memory_info", "ATI_meminfo" or null
+    std::size_t dedicatedBytes = 0;
+    std::size_t availableBytes = 0;
+};
+DriverInfo driver();                   // GL thread; a glGetIntegerv or two
+
+// The totals by category and by owner (largest first), and the driver's numbers.
+void report(std::ostream& out);
+// After glresource::shutdown(): what is still tracked, by owner. Nothing: nothing printed.
+void reportLeaks(std::ostream& out);
+
+} // namespace gpumemory
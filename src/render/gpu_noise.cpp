@@ -0,0 +1,181 @@
+#include "render/gpu_noise.h"
+
+#include <algorithm>
+
+#include "render/gl_stall.h"
+#include "render/gl_state.h"
+#include "render/gpu_memory.h"
+#include "render/shader_layout.h"
+
+namespace {
+
+// (frequency, lacunarity, gain, octaves) and the offset: uNoiseFields[i], uNoiseOffsets[i].
+void packField(const noise::Fbm& field, float* packed, float* offset) {
+    packed[0] = field.frequency;
+    packed[1] = field.lacunarity;
+    packed[2] = field.gain;
+    packed[3] = static_cast<float>(field.octaves);
+    offset[0] = field.offset.x;
+    offset[1] = field.offset.y;
+}
+
+} // namespace
+
+bool GpuNoise::init(int cellTiles) {
+    const gpumemory::Owner owner("gpu noise");
+    shutdown();
+    cellTiles_ = std::max(cellTiles, 1);
+    RenderTargetDesc desc;
+    desc.width = width();
+    desc.height = width();
+    desc.colorFormat = GL_RG32F;
+    desc.depthFormat = GL_NONE;
+    if (!target_.init(desc)) {
+        shutdown();
+        return false;
+    }
+    vao_ = GlVertexArray::create();
+    const std::size_t bytes = static_cast<std::size_t>(width()) * width() * 2 * sizeof(float);
+    for (Slot& slot : slots_) {
+        slot.buffer = GlBuffer::create();
+        glstate::bindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer.get());
+        glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(bytes), nullptr, GL_STREAM_READ);
+        gpumemory::trackBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer.get(), bytes);
+        slot.requests.reserve(kCells * kCells);
+    }
+    glstate::bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    next_ = 0;
+    stats_ = Stats{};
+    return true;
+}
+
+void GpuNoise::shutdown() {
+    for (Slot& slot : slots_) {
+        if (slot.fence) {
+            glDeleteSync(slot.fence);
+        }
+        slot = Slot{};
+    }
+    vao_.reset();
+    target_.shutdown();
+    queue_.clear();
+    program_ = 0;
+    originLocation_ = fieldsLocation_ = offsetsLocation_ = -1;
+}
+
+void GpuNoise::queue(const Request* requests, std::size_t count) {
+    queue_.insert(queue_.end(), requests, requests + count);
+    stats_.queued = queue_.size();
+}
+
+void GpuNoise::render(GLuint program, const noise::Fbm& first, const noise::Fbm& second, int viewWidth,
+                      int viewHeight) {
+    Slot& slot = slots_[next_];
+    if (queue_.empty() || slot.fence || program == 0) {
+        return;                            // nothing to do, or every slot still in flight
+    }
+    next_ = (next_ + 1) % kSlots;
+
+    glstate::useProgram(program);
+    if (program != program_) {             // first batch, or a reloaded program
+        program_ = program;
+        originLocation_ = glGetUniformLocation(program, shaderlayout::fragment::uNoiseOrigin.name);
+        fieldsLocation_ = glGetUniformLocation(program, shaderlayout::fragment::uNoiseFields.name);
+        offsetsLocation_ = glGetUniformLocation(program, shaderlayout::fragment::uNoiseOffsets.name);
+    }
+    float fields[8], offsets[4];
+    packField(first, fields, offsets);
+    packField(second, fields + 4, offsets + 2);
+    glUniform4fv(fieldsLocation_, 2, fields);
+    glUniform2fv(offsetsLocation_, 2, offsets);
+
+    glstate::bindFramebuffer(GL_FRAMEBUFFER, target_.framebuffer());
+    glstate::disable(GL_BLEND);
+    glstate::disable(GL_DEPTH_TEST);
+    glstate::bindVertexArray(vao_.get());
+    const std::size_t count = std::min(queue_.size(), static_cast<std::size_t>(kCells * kCells));
+    slot.requests.clear();
+    for (std::size_t k = 0; k < count; ++k) {
+        const Request& request = queue_[k];
+        const int px = static_cast<int>(k % kCells) * cellTiles_;
+        const int py = static_cast<int>(k / kCells) * cellTiles_;
+        glstate::viewport(px, py, cellTiles_, cellTiles_);
+        // gl_FragCoord is the pixel centre: + this, the tile centre.
+        glUniform2f(originLocation_, static_cast<float>(request.x - px), static_cast<float>(request.y - py));
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        slot.requests.push_back(request);
+    }
+    queue_.erase(queue_.begin(), queue_.begin() + static_cast<std::ptrdiff_t>(count));
+
+    // Only the rows of cells drawn.
+    const int rows = static_cast<int>((count + kCells - 1) / kCells) * cellTiles_;
+    glstate::bindFramebuffer(GL_READ_FRAMEBUFFER, target_.framebuffer());
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glstate::bindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer.get());
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    {
+        const glstall::Wait wait("gpu noise readback");
+        glReadPixels(0, 0, width(), rows, GL_RG, GL_FLOAT, nullptr);
+    }
+    glstate::bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    glstate::bindFramebuffer(GL_FRAMEBUFFER, 0);
+    glstate::viewport(0, 0, viewWidth, viewHeight);
+    ++stats_.batches;
+    stats_.cells += count;
+    stats_.queued = queue_.size();
+}
+
+std::size_t GpuNoise::poll(Sink sink, void* context) {
+    std::size_t delivered = 0;
+    for (int i = 0; i < kSlots; ++i) {
+        Slot& slot = slots_[(next_ + i) % kSlots];
+        if (!slot.fence) {
+            continue;
+        }
+        if (glClientWaitSync(slot.fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+            break;                         // the older ones come first
+        }
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+
+        const std::size_t stride = static_cast<std::size_t>(width()) * 2;   // floats per row
+        const std::size_t rows = (slot.requests.size() + kCells - 1) / kCells * static_cast<std::size_t>(cellTiles_);
+        glstate::bindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer.get());
+        const float* mapped = nullptr;
+        {
+            const glstall::Wait wait("gpu noise map");
+            mapped = static_cast<const float*>(glMapBufferRange(
+                GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(rows * stride * sizeof(float)), GL_MAP_READ_BIT));
+        }
+        if (mapped) {
+            for (std::size_t k = 0; k < slot.requests.size(); ++k) {
+                const std::size_t row = k / kCells * static_cast<std::size_t>(cellTiles_);
+                const std::size_t column = k % kCells * static_cast<std::size_t>(cellTiles_) * 2;
+                sink(context, slot.requests[k].id, mapped + row * stride + column, stride);
+            }
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            delivered += slot.requests.size();
+        } else {
+            // A failed map: rendered again rather than never answered.
+            queue_.insert(queue_.begin(), slot.requests.begin(), slot.requests.end());
+            stats_.queued = queue_.size();
+        }
+        glstate::bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+    stats_.delivered += delivered;
+    return delivered;
+}
+
+bool GpuNoise::busy() const {
+    if (!queue_.empty()) {
+        return true;
+    }
+    for (const Slot& slot : slots_) {
+        if (slot.fence) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "core/noise.h"
+#include "render/gl_resource.h"
+#include "render/render_target.h"
+
+// GpuNoise
+// --------
+// Procedural fields on the GPU (--procgen-gpu): two fBm fields of simplex noise per
+// cell of tiles, rendered by fragment.glsl NOISE (shaders/noise.glsl) and read back
+// without stalling. The CPU path (core/noise.h on the job system) costs about 16 ns per
+// sample and octave on a core; here a whole batch of cells is one pass of a few draws.
+//
+// A batch is up to kCells x kCells cells, each cellTiles² pixels of an RG32F target
+// (the two fields), one draw per cell with the viewport on it:
+//
+//     GL:       queue(requests) → render() draws the oldest ones into the target, reads
+//               the used rows into a pixel pack buffer of the ring, fences
+//     GL, later frames: fence passed → map → sink(id, fields) per cell → unmap
+//
+// | Cost (cellTiles 32, a full batch) | Per batch                                     |
+// | --------------------------------- | --------------------------------------------- |
+// | GPU                               | 64K pixels x 2 fields x octaves of simplex    |
+// | readback                          | 512 KiB copied into the ring asynchronously   |
+// | CPU, GL thread                    | one map, and whatever the sink does per cell  |
+// | latency                           | usually 1-2 frames                            |
+//
+// Requests wait in the queue while every slot is in flight: none is dropped, so each
+// one reaches the sink exactly once (a chunk waiting for its fields would otherwise
+// never finish). A cell's pixel (i, j) is sample (x + i + 0.5, y + j + 0.5) of the
+// request's (x, y): tile centres, where the CPU path samples too.
+//
+// GL thread only.
+class GpuNoise {
+public:
+    static constexpr int kCells = 8;       // per side of a batch
+    static constexpr int kSlots = 3;
+
+    struct Request {
+        std::int32_t id = 0;               // the caller's, handed back to the sink
+        std::int32_t x = 0, y = 0;         // the cell's first tile
+    };
+
+    // One cell's fields: (first, second) per sample, cellTiles pairs per row from its
+    // lower-left, rows `stride` floats apart. Valid during the call only.
+    using Sink = void (*)(void* context, std::int32_t id, const float* fields, std::size_t stride);
+
+    struct Stats {
+        std::uint64_t batches = 0;
+        std::uint64_t cells = 0;           // rendered, all batches
+        std::uint64_t delivered = 0;       // handed to the sink
+        std::size_t queued = 0;            // waiting for a slot, now
+    };
+
+    bool init(int cellTiles);
+    void shutdown();
+
+    void queue(const Request* requests, std::size_t count);
+    // Renders the oldest queued requests, a batch, if a slot is free. `program` is
+    // fullscreen_vertex.glsl + fragment.glsl NOISE. Leaves framebuffer 0 bound with the
+    // viewport viewWidth x viewHeight.
+    void render(GLuint program, const noise::Fbm& first, const noise::Fbm& second, int viewWidth, int viewHeight);
+    // Every batch whose readback has arrived, oldest first, through `sink`; the cells read.
+    std::size_t poll(Sink sink, void* context);
+
+    // Requests queued or in flight: only more frames finish them.
+    bool busy() const;
+    bool initialized() const { return target_.framebuffer() != 0; }
+    const Stats& stats() const { return stats_; }
+
+private:
+    struct Slot {
+        GlBuffer buffer;
+        GLsync fence = nullptr;            // null: free
+        std::vector<Request> requests;     // cell k of the batch: requests[k]
+    };
+
+    int width() const { return kCells * cellTiles_; }
+
+    RenderTarget target_;
+    GlVertexArray vao_;                    // empty: fullscreen_vertex.glsl makes its positions
+    Slot slots_[kSlots];
+    int next_ = 0;                         // the oldest slot: written next, read first
+    int cellTiles_ = 0;
+    std::deque<Request> queue_;
+    GLuint program_ = 0;
+    GLint originLocation_ = -1;
+    GLint fieldsLocation_ = -1;
+    GLint offsetsLocation_ = -1;
+    Stats stats_;
+};
@@ -0,0 +1,169 @@
+#include "render/gpu_picker.h"
+
+#include <cmath>
+#include <cstring>
+
+#include "render/gl_state.h"
+#include "render/gl_stall.h"
+#include "render/gpu_memory.h"
+#include "render/shader_layout.h"
+
+namespace {
+
+constexpr std::size_t kReadbackBytes = GpuPicker::kRegion * GpuPicker::kRegion * sizeof(std::uint32_t);
+
+} // namespace
+
+bool GpuPicker::init(GLuint vao, const Mesh& quad) {
+    const gpumemory::Owner owner("gpu picker");
+    RenderTargetDesc desc;
+    desc.width = kRegion;
+    desc.height = kRegion;
+    desc.colorFormat = GL_R32UI;
+    desc.depthFormat = GL_DEPTH_COMPONENT24;
+    if (!target_.init(desc) || !quads_.init(vao, quad, 64, InstancedQuadRenderer::Format::Layered)) {
+        shutdown();
+        return false;
+    }
+    for (Slot& slot : slots_) {
+        slot.buffer = GlBuffer::create();
+        glstate::bindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer.get());
+        glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(kReadbackBytes), nullptr, GL_STREAM_READ);
+        gpumemory::trackBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer.get(), kReadbackBytes);
+    }
+    glstate::bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    next_ = 0;
+    stats_ = Stats{};
+    return true;
+}
+
+void GpuPicker::shutdown() {
+    for (Slot& slot : slots_) {
+        if (slot.fence) {
+            glDeleteSync(slot.fence);
+        }
+        slot = Slot{};
+    }
+    quads_.shutdown();
+    target_.shutdown();
+    program_ = 0;
+    regionLocation_ = -1;
+}
+
+void GpuPicker::render(GLuint program, GLuint textureArray, std::uint32_t arrayLayers,
+                       const LayeredInstance* instances, std::size_t count, double x, double y, int viewWidth,
+                       int viewHeight, std::uint64_t request) {
+    Slot& slot = slots_[next_];
+    if (slot.fence) {
+        // Three picks in flight: the oldest is dropped rather than waited for.
+        ++stats_.dropped;
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+    }
+    next_ = (next_ + 1) % kSlots;
+
+    // The window pixel under the cursor (GL's y grows upwards), and the NDC rectangle of
+    // the kRegion pixels around it: ndc' = (ndc - center) * scale maps that onto the target.
+    const int px = static_cast<int>(std::floor(x));
+    const int py = viewHeight - 1 - static_cast<int>(std::floor(y));
+    const float centerX = 2.0f * (static_cast<float>(px) + 0.5f) / static_cast<float>(viewWidth) - 1.0f;
+    const float centerY = 2.0f * (static_cast<float>(py) + 0.5f) / static_cast<float>(viewHeight) - 1.0f;
+    const float scaleX = static_cast<float>(viewWidth) / kRegion;
+    const float scaleY = static_cast<float>(viewHeight) / kRegion;
+
+    target_.bind();
+    const GLuint nothing[4] = {0u, 0u, 0u, 0u};
+    const GLfloat farthest = 1.0f;
+    glstate::depthMask(true);
+    glClearBufferuiv(GL_COLOR, 0, nothing);
+    glClearBufferfv(GL_DEPTH, 0, &farthest);
+
+    if (count > 0) {
+        if (LayeredInstance* dst = quads_.mapLayered(count)) {
+            for (std::size_t i = 0; i < count; ++i) {
+                LayeredInstance instance = instances[i];
+                const std::uint32_t layer = instance.layer & 0xffffu;
+                if (layer != kNoAlphaTest) {
+                    instance.layer = (instance.layer & 0xffff0000u) | (arrayLayers > 0 ? layer % arrayLayers : 0u);
+                }
+                dst[i] = instance;
+            }
+            glstate::useProgram(program);
+            if (program != program_) {     // first pick, or a reloaded program
+                program_ = program;
+                regionLocation_ = glGetUniformLocation(program, shaderlayout::vertex::uPickRegion.name);
+            }
+            glUniform4f(regionLocation_, centerX, centerY, scaleX, scaleY);
+            glstate::activeTexture(GL_TEXTURE0);
+            glstate::bindTexture(GL_TEXTURE_2D_ARRAY, textureArray);
+            glstate::disable(GL_BLEND);    // ids don't blend
+            glstate::enable(GL_DEPTH_TEST);
+            glstate::depthFunc(GL_LEQUAL); // equal z-layers: the later draw wins, as in the scene
+            quads_.drawMapped();
+            glstate::disable(GL_DEPTH_TEST);
+        }
+    }
+
+    glstate::bindFramebuffer(GL_READ_FRAMEBUFFER, target_.framebuffer());
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glstate::bindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer.get());
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    {
+        const glstall::Wait wait("gpu pick readback");
+        glReadPixels(0, 0, kRegion, kRegion, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+    }
+    glstate::bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.request = request;
+
+    glstate::bindFramebuffer(GL_FRAMEBUFFER, 0);
+    glstate::viewport(0, 0, viewWidth, viewHeight);
+    ++stats_.picks;
+    stats_.instances += count;
+}
+
+bool GpuPicker::poll(Result& result) {
+    for (int i = 0; i < kSlots; ++i) {
+        Slot& slot = slots_[(next_ + i) % kSlots];
+        if (!slot.fence) {
+            continue;
+        }
+        if (glClientWaitSync(slot.fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+            return false;                  // the older ones come first
+        }
+        read(slot, result);
+        return true;
+    }
+    return false;
+}
+
+void GpuPicker::read(Slot& slot, Result& result) {
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+    result = Result{};
+    result.request = slot.request;
+
+    glstate::bindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer.get());
+    const void* mapped = nullptr;
+    {
+        const glstall::Wait wait("gpu pick map");
+        mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(kReadbackBytes), GL_MAP_READ_BIT);
+    }
+    if (mapped) {
+        std::uint32_t ids[kRegion * kRegion];
+        std::memcpy(ids, mapped, sizeof ids);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        result.hit = ids[kRadius * kRegion + kRadius];
+        int best = kRadius * kRadius + 1;  // within the circle only
+        for (int y = 0; y < kRegion; ++y) {
+            for (int x = 0; x < kRegion; ++x) {
+                const int d = (x - kRadius) * (x - kRadius) + (y - kRadius) * (y - kRadius);
+                if (ids[y * kRegion + x] != 0u && d < best) {
+                    best = d;
+                    result.nearest = ids[y * kRegion + x];
+                }
+            }
+        }
+    }
+    glstate::bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+
+#include "render/gl_resource.h"
+#include "render/instanced_quads.h"
+#include "render/render_target.h"
+
+// GpuPicker
+// ---------
+// Pixel-exact picking (--gpu-pick): which object's visible pixels are under the cursor,
+// transparent sprite corners and z-layers included, which the bounding-box Picker
+// (render/picker.h) can only approximate.
+//
+// Only a kRegion x kRegion window around the cursor is ever drawn, into an R32UI (+
+// depth) target of exactly that size, and only the few objects main found overlapping it:
+//
+//     main:     click → objects whose bounds touch the region → LayeredInstances with
+//               color = candidate index + 1 (0 = nothing), queued in the packet
+//     GL:       draw them into the region target (PICK_ID program), glReadPixels into a
+//               pixel pack buffer of the ring, fence
+//     GL, later frames: fence passed → map, read the ids → Result in the packet
+//     main:     candidate index → entity
+//
+// | Cost                 | Per pick                                                     |
+// | -------------------- | ------------------------------------------------------------ |
+// | GPU                  | kRegion² pixels of a handful of quads, one tiny copy         |
+// | CPU, GL thread       | a map of kRegion² * 4 bytes once the copy is done: no stall  |
+// | latency              | usually 1-2 frames                                           |
+//
+// The region's projection is the scene's, zoomed so that exactly the kRegion pixels
+// around the cursor fill it (uPickRegion in shaders/vertex.glsl): target pixel
+// (kRadius, kRadius) IS the window pixel under the cursor.
+//
+// Draw order follows the scene: z-layers are depth (DEPTH_LAYERS), equal layers go to
+// the later draw (GL_LEQUAL), and sprites discard texels below the scene's alpha cutoff.
+// Instances whose array layer is kNoAlphaTest are solid quads (the untextured paths).
+class GpuPicker {
+public:
+    static constexpr int kRadius = 7;
+    static constexpr int kRegion = 2 * kRadius + 1;
+    static constexpr int kSlots = 3;
+    static constexpr std::uint32_t kNoAlphaTest = 0xffffu;
+
+    struct Result {
+        std::uint64_t request = 0;     // as passed to render(); 0: no result
+        std::uint32_t hit = 0;         // id under the cursor pixel, 0: nothing
+        std::uint32_t nearest = 0;     // closest id within kRadius pixels (touch input)
+    };
+
+    struct Stats {
+        std::uint64_t picks = 0;
+        std::uint64_t instances = 0;   // drawn into the region, all picks
+        std::uint64_t dropped = 0;     // overwritten before their readback arrived
+    };
+
+    bool init(GLuint vao, const Mesh& quad);
+    void shutdown();
+
+    // GL thread: renders `count` instances (color = id) into the region around window
+    // pixel (x, y) (origin top-left) of a viewWidth x viewHeight scene, and queues the
+    // readback. `textureArray` is what the sprite layers sample. Leaves framebuffer 0 bound.
+    void render(GLuint program, GLuint textureArray, std::uint32_t arrayLayers, const LayeredInstance* instances,
+                std::size_t count, double x, double y, int viewWidth, int viewHeight, std::uint64_t request);
+    // GL thread, once per frame: the oldest readback that has arrived, if any.
+    bool poll(Result& result);
+    // GL thread, after the frame's last render(): fences this frame's instances.
+    void endFrame() { quads_.endFrame(); }
+
+    bool initialized() const { return target_.framebuffer() != 0; }
+    const Stats& stats() const { return stats_; }
+
+private:
+    struct Slot {
+        GlBuffer buffer;
+        GLsync fence = nullptr;        // null: free
+        std::uint64_t request = 0;
+    };
+
+    void read(Slot& slot, Result& result);
+
+    RenderTarget target_;
+    InstancedQuadRenderer quads_;
+    Slot slots_[kSlots];
+    int next_ = 0;                     // the oldest slot: written next, read first
+    GLuint program_ = 0;
+    GLint regionLocation_ = -1;
+    Stats stats_;
+};
@@ -0,0 +1,345 @@
+#include "render/instanced_quads.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <numeric>
+
+#include "render/gl_buffer.h"
+#include "render/gl_ext.h"
+#include "render/gl_state.h"
+#include "render/gpu_memory.h"
+#include "render/shader_layout.h"
+
+namespace {
+
+// bindInstanceAttributes() counts every format's inputs up from kModelAttribLocation: the
+// GLSL must keep them there.
+namespace input = shaderlayout::vertex;
+constexpr GLuint kModel = InstancedQuadRenderer::kModelAttribLocation;
+static_assert(input::aModel.locations == 4 && input::aInstanceColor.location == kModel + 4,
+              "aInstanceColor follows the mat4's columns");
+static_assert(input::aRow0.location == kModel && input::aRow1.location == kModel + 1, "Affine2D rows");
+static_assert(input::aLayer.location == kModel + 2 && input::aColor.location == kModel + 3, "Layered layer, colour");
+static_assert(input::aAnimation.location == kModel + 4, "Animated start, rate");
+static_assert(input::aParticlePos.location == kModel && input::aParticleAge.location == kModel + 1, "Particle");
+
+} // namespace
+
+bool InstancedQuadRenderer::init(GLuint vao, const Mesh& mesh, std::size_t initialCapacity,
+                                 Format format, bool instanceColors, Storage storage) {
+    vao_ = vao;
+    mesh_ = mesh;
+    format_ = format;
+    storage_ = storage;
+    instanceColors_ = instanceColors && (format == Format::Mat4 || format == Format::Affine2D);
+    texture_.reset();
+    if (storage_ == Storage::TextureBuffer) {
+        if ((format_ != Format::Mat4 && format_ != Format::Layered) || instanceColors_) {
+            std::cerr << "Instance texture buffer: Mat4 or Layered instances only, without colours\n";
+            return false;
+        }
+        GLint maxTexels = 65536;
+        glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+        maxTexels_ = static_cast<std::size_t>(maxTexels);
+        texture_ = GlTexture::create();
+    }
+
+    if (!reserveGpu(initialCapacity > 0 ? initialCapacity : 1)) {
+        std::cerr << "Failed to create instance buffer\n";
+        return false;
+    }
+    if (storage_ == Storage::TextureBuffer) {
+        return true;                   // nothing per instance in the VAO
+    }
+    if (glbuffer::direct()) {
+        formatInstanceAttributes();
+        return true;
+    }
+
+    glstate::bindVertexArray(vao_);
+    for (GLuint column = 0; column < attributeCount(); ++column) {
+        GLuint location = kModelAttribLocation + column;
+        glEnableVertexAttribArray(location);
+        glVertexAttribDivisor(location, 1);              // advance once per instance
+    }
+    if (instanceColors_) {
+        glEnableVertexAttribArray(kColorAttribLocation);
+        glVertexAttribDivisor(kColorAttribLocation, 1);
+    }
+    bindInstanceAttributes(0);
+    glstate::bindVertexArray(0);
+    return true;
+}
+
+void InstancedQuadRenderer::shutdown() {
+    stream_.shutdown();
+    texture_.reset();
+    gpuCapacity_ = 0;
+    instances_.clear();
+    affine_.clear();
+    layered_.clear();
+    animated_.clear();
+    colors_.clear();
+}
+
+// Grows the stream buffer geometrically so steady-state frames never reallocate.
+bool InstancedQuadRenderer::reserveGpu(std::size_t count) {
+    const gpumemory::Owner owner("instanced quads");
+    if (count <= gpuCapacity_) {
+        return true;
+    }
+    std::size_t newCapacity = gpuCapacity_ > 0 ? gpuCapacity_ : 1;
+    while (newCapacity < count) {
+        newCapacity *= 2;
+    }
+    const bool texels = storage_ == Storage::TextureBuffer;
+    if (texels) {
+        // Every segment of the ring has to be addressable: the texture is all of it.
+        const std::size_t texelsPerInstance = instanceStride() / sizeof(glm::vec4);
+        const std::size_t limit = maxTexels_ / (texelsPerInstance * StreamBuffer::kFrames);
+        if (count > limit) {
+            return false;
+        }
+        newCapacity = std::min(newCapacity, limit);
+    }
+    stream_.shutdown();
+    if (!stream_.init(texels ? GL_TEXTURE_BUFFER : GL_ARRAY_BUFFER,
+                      static_cast<GLsizeiptr>(newCapacity * instanceBytes()))) {
+        gpuCapacity_ = 0;
+        return false;
+    }
+    if (texels) {
+        // A new buffer: the texture has to be pointed at it again (rare, like the growth).
+        glstate::activeTexture(kInstanceTextureUnit);
+        glstate::bindTexture(GL_TEXTURE_BUFFER, texture_.get());
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32UI, stream_.buffer());
+        glstate::activeTexture(GL_TEXTURE0);
+    }
+    gpuCapacity_ = newCapacity;
+    return true;
+}
+
+void InstancedQuadRenderer::setUniforms(GLuint program) {
+    baseLocation_ = glGetUniformLocation(program, shaderlayout::vertex::uInstanceBase.name);
+}
+
+// TextureBuffer: where instance 0 is, as a texel index, and the texture itself. Assumes
+// the program is bound.
+void InstancedQuadRenderer::bindInstanceTexels(GLintptr offset) {
+    glUniform1i(baseLocation_, static_cast<GLint>(offset / static_cast<GLintptr>(sizeof(glm::vec4))));
+    glstate::activeTexture(kInstanceTextureUnit);
+    glstate::bindTexture(GL_TEXTURE_BUFFER, texture_.get());
+    glstate::activeTexture(GL_TEXTURE0);
+}
+
+// Direct state access: the formats go into the VAO once, relative to two buffer binding
+// points (instances, colours); a draw then only moves those bindings (below).
+void InstancedQuadRenderer::formatInstanceAttributes() {
+    auto attribute = [this](GLuint location, GLint components, GLenum type, GLboolean normalized, std::size_t offset,
+                            GLuint binding = kInstanceBinding) {
+        glext::enableVertexArrayAttrib(vao_, location);
+        glext::vertexArrayAttribFormat(vao_, location, components, type, normalized, static_cast<GLuint>(offset));
+        glext::vertexArrayAttribBinding(vao_, location, binding);
+    };
+    glext::vertexArrayBindingDivisor(vao_, kInstanceBinding, 1);
+    if (instanceColors_) {
+        attribute(kColorAttribLocation, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, kColorBinding);
+        glext::vertexArrayBindingDivisor(vao_, kColorBinding, 1);
+    }
+    if (format_ == Format::Particle) {
+        attribute(kModelAttribLocation, 2, GL_FLOAT, GL_FALSE, offsetof(ParticleInstance, position));
+        attribute(kModelAttribLocation + 1, 2, GL_FLOAT, GL_FALSE, offsetof(ParticleInstance, age));
+        return;
+    }
+    if (format_ == Format::Mat4) {
+        for (GLuint column = 0; column < 4; ++column) {
+            attribute(kModelAttribLocation + column, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4) * column);
+        }
+        return;
+    }
+    for (GLuint row = 0; row < 2; ++row) {
+        attribute(kModelAttribLocation + row, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3) * row);
+    }
+    if (format_ != Format::Affine2D) {
+        const GLuint layer = kModelAttribLocation + 2;
+        glext::enableVertexArrayAttrib(vao_, layer);
+        glext::vertexArrayAttribIFormat(vao_, layer, 1, GL_UNSIGNED_INT, offsetof(LayeredInstance, layer));
+        glext::vertexArrayAttribBinding(vao_, layer, kInstanceBinding);
+        attribute(kModelAttribLocation + 3, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(LayeredInstance, color));
+    }
+    if (format_ == Format::Animated) {
+        attribute(kModelAttribLocation + 4, 2, GL_FLOAT, GL_FALSE, offsetof(AnimatedInstance, start));
+    }
+}
+
+// Points the instance attributes at the data starting at `offset` in the stream buffer.
+// The stream hands out a different offset every frame, so this is re-recorded per draw
+// (a few cheap calls—much cheaper than a driver-side buffer copy or stall; with DSA, one
+// or two binding moves and no buffer bind at all).
+// Assumes vao_ is bound.
+void InstancedQuadRenderer::bindInstanceAttributes(GLintptr offset, GLintptr colorOffset) {
+    if (glbuffer::direct()) {
+        glext::vertexArrayVertexBuffer(vao_, kInstanceBinding, stream_.buffer(), offset,
+                                       static_cast<GLsizei>(instanceStride()));
+        if (instanceColors_) {
+            glext::vertexArrayVertexBuffer(vao_, kColorBinding, stream_.buffer(), colorOffset,
+                                           static_cast<GLsizei>(sizeof(std::uint32_t)));
+        }
+        return;
+    }
+    glstate::bindBuffer(GL_ARRAY_BUFFER, stream_.buffer());
+    if (instanceColors_) {
+        // Normalized: 0..255 arrives in the shader as 0.0..1.0. Tightly packed (stride 4).
+        glVertexAttribPointer(kColorAttribLocation, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(std::uint32_t),
+                              (void*)colorOffset);
+    }
+    const GLsizei stride = static_cast<GLsizei>(instanceStride()); // one transform per instance
+    if (format_ == Format::Particle) {
+        glVertexAttribPointer(kModelAttribLocation, 2, GL_FLOAT, GL_FALSE, stride,
+                              (void*)(offset + offsetof(ParticleInstance, position)));
+        glVertexAttribPointer(kModelAttribLocation + 1, 2, GL_FLOAT, GL_FALSE, stride, // + lifetime
+                              (void*)(offset + offsetof(ParticleInstance, age)));
+        return;
+    }
+    if (format_ == Format::Affine2D || format_ == Format::Layered || format_ == Format::Animated) {
+        // Two vec3 rows: (a, c, tx) and (b, d, ty).
+        for (GLuint row = 0; row < 2; ++row) {
+            glVertexAttribPointer(kModelAttribLocation + row, 3, GL_FLOAT, GL_FALSE, stride,
+                                  (void*)(offset + sizeof(glm::vec3) * row));
+        }
+        if (format_ != Format::Affine2D) {
+            // The I variant keeps the layer an integer all the way to the shader (uint aLayer).
+            // Animated starts with a LayeredInstance's fields, at the same offsets.
+            glVertexAttribIPointer(kModelAttribLocation + 2, 1, GL_UNSIGNED_INT, stride,
+                                   (void*)(offset + offsetof(LayeredInstance, layer)));
+            glVertexAttribPointer(kModelAttribLocation + 3, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride,
+                                  (void*)(offset + offsetof(LayeredInstance, color)));
+        }
+        if (format_ == Format::Animated) {
+            glVertexAttribPointer(kModelAttribLocation + 4, 2, GL_FLOAT, GL_FALSE, stride, // start, rate
+                                  (void*)(offset + offsetof(AnimatedInstance, start)));
+        }
+        return;
+    }
+    // A mat4 is passed as 4 vec4 attributes (one per column, GLM is column-major).
+    for (GLuint column = 0; column < 4; ++column) {
+        glVertexAttribPointer(
+            kModelAttribLocation + column,
+            4,                                                   // vec4 per column
+            GL_FLOAT,
+            GL_FALSE,
+            stride,
+            (void*)(offset + sizeof(glm::vec4) * column)         // offset of this column
+        );
+    }
+}
+
+void InstancedQuadRenderer::draw() {
+    const std::size_t count = instanceCount();
+    if (count == 0) {
+        return;
+    }
+    void* dst = mapRaw(count);
+    if (!dst) {
+        return;
+    }
+    const void* src = format_ == Format::Affine2D ? static_cast<const void*>(affine_.data())
+                    : format_ == Format::Layered  ? static_cast<const void*>(layered_.data())
+                    : format_ == Format::Animated ? static_cast<const void*>(animated_.data())
+                                                  : static_cast<const void*>(instances_.data());
+    std::memcpy(dst, src, count * instanceStride());
+    if (std::uint32_t* colors = mapColors()) {
+        std::memcpy(colors, colors_.data(), count * sizeof(std::uint32_t));
+    }
+    drawMapped();
+}
+
+glm::mat4* InstancedQuadRenderer::mapInstances(std::size_t count) {
+    return format_ == Format::Mat4 ? static_cast<glm::mat4*>(mapRaw(count)) : nullptr;
+}
+
+Affine2D* InstancedQuadRenderer::mapAffine(std::size_t count) {
+    return format_ == Format::Affine2D ? static_cast<Affine2D*>(mapRaw(count)) : nullptr;
+}
+
+LayeredInstance* InstancedQuadRenderer::mapLayered(std::size_t count) {
+    return format_ == Format::Layered ? static_cast<LayeredInstance*>(mapRaw(count)) : nullptr;
+}
+
+AnimatedInstance* InstancedQuadRenderer::mapAnimated(std::size_t count) {
+    return format_ == Format::Animated ? static_cast<AnimatedInstance*>(mapRaw(count)) : nullptr;
+}
+
+ParticleInstance* InstancedQuadRenderer::mapParticles(std::size_t count) {
+    return format_ == Format::Particle ? static_cast<ParticleInstance*>(mapRaw(count)) : nullptr;
+}
+
+std::uint32_t* InstancedQuadRenderer::mapColors() {
+    if (!instanceColors_ || mappedCount_ == 0) {
+        return nullptr;
+    }
+    return reinterpret_cast<std::uint32_t*>(static_cast<char*>(mapped_.ptr) + mappedCount_ * instanceStride());
+}
+
+void* InstancedQuadRenderer::mapRaw(std::size_t count) {
+    mappedCount_ = 0;
+    mappedCommitted_ = false;
+    if (count == 0) {
+        return nullptr;
+    }
+    const GLsizeiptr stride = static_cast<GLsizeiptr>(instanceStride());
+    const GLsizeiptr bytes = static_cast<GLsizeiptr>(count * instanceBytes()); // + the colours after them
+    // A multiple of the stride and of kSimdAlign: writers fill it with 16-byte stores.
+    const GLsizeiptr alignment = std::lcm(stride, static_cast<GLsizeiptr>(kSimdAlign));
+    StreamAllocation allocation = stream_.allocate(bytes, alignment);
+    if (!allocation.valid()) {
+        // Segment too small (or already used by an earlier draw this frame): grow it.
+        // Recreating the ring is rare—capacity doubles and is then kept.
+        if (!reserveGpu(gpuCapacity_ * 2 > count ? gpuCapacity_ * 2 : count)) {
+            return nullptr;
+        }
+        allocation = stream_.allocate(bytes, alignment);
+        if (!allocation.valid()) {
+            return nullptr;
+        }
+    }
+    mapped_ = allocation;
+    mappedCount_ = count;
+    return allocation.ptr;
+}
+
+void InstancedQuadRenderer::drawMapped() {
+    drawMappedRange(0, mappedCount_);
+    mappedCount_ = 0;
+}
+
+void InstancedQuadRenderer::drawMappedRange(std::size_t first, std::size_t count) {
+    if (first >= mappedCount_ || count == 0) {
+        return;
+    }
+    count = std::min(count, mappedCount_ - first);
+    if (!mappedCommitted_) {
+        stream_.commit(mapped_);
+        mappedCommitted_ = true;
+    }
+
+    glstate::bindVertexArray(vao_);
+    // The attribute offsets (or the first texel) start at `first`: gl_InstanceID counts
+    // from 0 again.
+    if (storage_ == Storage::TextureBuffer) {
+        bindInstanceTexels(mapped_.offset + static_cast<GLintptr>(first * instanceStride()));
+    } else {
+        bindInstanceAttributes(mapped_.offset + static_cast<GLintptr>(first * instanceStride()),
+                               mapped_.offset + static_cast<GLintptr>(mappedCount_ * instanceStride() +
+                                                                      first * sizeof(std::uint32_t)));
+    }
+    MeshPool::drawInstanced(mesh_, static_cast<GLsizei>(count));
+    // | Argument         | Meaning                                          |
+    // | ---------------- | ------------------------------------------------ |
+    // | mesh_.indexCount | Indices per instance (6 for the quad)            |
+    // | mesh_.baseVertex | Added to each index: where the quad is in the    |
+    // |                  | pool's vertex buffer                             |
+    // | instances        | Number of instances; gl_InstanceID = 0..count-1  |
+}
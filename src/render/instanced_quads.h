@@ -0,0 +1,251 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "core/batch_transform.h"
+#include "core/particle_soa.h"
+#include "render/gl_resource.h"
+#include "render/mesh_pool.h"
+#include "render/shader_layout.h"
+#include "render/stream_buffer.h"
+
+// LayeredInstance
+// ---------------
+// Affine2D transform + which layer of a TextureArray to sample + tint. 32 bytes.
+//
+// `layer` carries two 16-bit fields, so the z-layer rides along without growing the
+// instance: the low half is the array layer, the high half the draw order that
+// shaders/vertex.glsl DEPTH_LAYERS turns into depth (higher in front).
+struct LayeredInstance {
+    Affine2D transform;
+    std::uint32_t layer;   // layeredLayer(arrayLayer, zLayer)
+    std::uint32_t color;   // packColor (render/sprite_batch.h)
+};
+static_assert(sizeof(LayeredInstance) == 32, "LayeredInstance must stay tightly packed (vertex attribute stride)");
+
+constexpr std::uint32_t layeredLayer(std::uint32_t arrayLayer, std::uint16_t zLayer) {
+    return (arrayLayer & 0xffffu) | (static_cast<std::uint32_t>(zLayer) << 16);
+}
+
+// AnimatedInstance
+// ----------------
+// A LayeredInstance whose layer may be animatedSprite(clip) (render/sprite_animation.h),
+// plus when that clip started and how fast it plays. 40 bytes. Written when the clip
+// starts; the shader (ANIMATED) picks the frame, so it's the same every frame after.
+struct AnimatedInstance {
+    Affine2D transform;
+    std::uint32_t layer;   // layeredLayer(arrayLayer or animatedSprite(clip), zLayer)
+    std::uint32_t color;
+    float start;           // seconds, on the clip table's clock
+    float rate;            // 1: the clip's own fps
+};
+static_assert(sizeof(AnimatedInstance) == 40, "AnimatedInstance must stay tightly packed (vertex attribute stride)");
+
+// InstancedQuadRenderer
+// ---------------------
+// Draws many copies of the same quad with ONE glDrawElementsInstanced call instead of
+// one glDrawElements + one glUniformMatrix4fv per object.
+//
+// How it works:
+// - The quad's VAO/EBO (built in main()) stays exactly as it is: location 0 = vec2 aPos.
+//   The quad is a Mesh in main's MeshPool (render/mesh_pool.h), so the draw says where
+//   in the pool's buffers it is (glDrawElementsInstancedBaseVertex).
+// - A second VBO holds one mat4 per instance. A mat4 attribute takes up FOUR consecutive
+//   attribute locations (one vec4 column each), so locations 1..4 are used for aModel.
+// - glVertexAttribDivisor(loc, 1) tells OpenGL: "advance this attribute once per
+//   INSTANCE, not once per vertex". Location 0 keeps divisor 0 (per vertex).
+//
+// | Divisor | Meaning                                       |
+// | ------- | --------------------------------------------- |
+// | 0       | New value for every vertex (default)          |
+// | 1       | New value for every instance                  |
+// | N       | New value every N instances                   |
+//
+// Usage per frame:
+//     quads.begin();
+//     quads.submit(model);   // once per object
+//     quads.draw();          // one upload + one draw call for everything
+//     quads.endFrame();      // after the frame's last draw: fences the stream segment
+//
+// Instance data is written straight into a StreamBuffer (persistent-mapped ring when
+// available), so uploads never stall on the GPU or make the driver copy the data.
+//
+// Zero-copy variant for large batches (no CPU staging array at all):
+//     glm::mat4* dst = quads.mapInstances(n);  // n matrices in this frame's stream segment
+//     composeModelMatrices(transforms, dst);   // see core/batch_transform.h
+//     quads.drawMapped();
+//
+// One mapping can also be drawn in parts with different state in between, e.g. the
+// opaque instances with depth writes and then the translucent ones without:
+//     quads.drawMappedRange(0, opaque);
+//     quads.drawMappedRange(opaque, count - opaque);
+//
+// Instance formats (the program bound at draw time must match):
+//
+// | Format   | Bytes | Attributes (divisor 1)             | shaders/vertex.glsl with   |
+// | -------- | ----- | ---------------------------------- | -------------------------- |
+// | Mat4     | 64    | mat4 aModel, locations 1..4        | INSTANCED                  |
+// | Affine2D | 24    | vec3 aRow0 + aRow1, locations 1..2 | INSTANCED AFFINE_2D        |
+// | Layered  | 32    | aRow0 + aRow1, uint aLayer (3),    | INSTANCED AFFINE_2D        |
+// |          |       | vec4 aColor (4, normalized RGBA8)  | TEXTURE_ARRAY (+ DEPTH_    |
+// |          |       |                                    | LAYERS)                    |
+// | Animated | 40    | Layered's + vec2 aAnimation (5):   | Layered's + ANIMATED       |
+// |          |       | start, rate                        |                            |
+// | Particle | 16    | vec2 position (1), vec2 age +      | PARTICLES TEXTURE_ARRAY    |
+// |          |       | lifetime (2): ParticleInstance     |                            |
+//
+// Per-instance colour (Mat4 and Affine2D, init(..., instanceColors = true)): one packed
+// RGBA8 per instance, read as a normalized vec4 aInstanceColor at kColorAttribLocation
+// (glVertexAttribPointer, GL_UNSIGNED_BYTE, GL_TRUE). The colours sit in the same stream
+// allocation as the transforms but AFTER all of them, not interleaved—so the compose
+// kernels still write one packed array of transforms, and the colours are a second one:
+//
+//     | transform 0 | transform 1 | ... | transform n-1 | color 0 | color 1 | ... |
+//       ^ mapInstances() / mapAffine()                    ^ mapColors()
+//
+// A colour per instance instead of a colour uniform keeps differently coloured quads in
+// one draw. Layered and Animated have their colour interleaved already (Animated's
+// location 5 is its animation instead); Particle computes its own.
+//
+// Each renderer records its attributes into the VAO it's given, so two renderers with
+// different formats need two VAOs (they can share the quad's VBO and EBO).
+//
+// Storage::TextureBuffer (Mat4 and Layered, no instance colours): the same stream, the
+// same packed structs, but no instance attributes at all. The stream buffer is the
+// storage of an RGBA32UI texture buffer on kInstanceTextureUnit, and vertex.glsl
+// INSTANCE_FETCH reads instance gl_InstanceID with texelFetch from uInstanceBase on:
+//
+// | Storage       | Per draw                          | Per instance, at most            |
+// | ------------- | --------------------------------- | -------------------------------- |
+// | Attributes    | re-point every instance attribute | 16 attribute locations, fixed    |
+// |               | at the new offset                 | formats per location             |
+// | TextureBuffer | one int uniform + the texture     | anything in 16-byte texels; the  |
+// |               | bind                              | shader decides how to read it    |
+//
+// The ring as a whole has to fit GL_MAX_TEXTURE_BUFFER_SIZE texels (64K at least, 128M
+// on desktop drivers: millions of instances), so a mapping past that fails like any
+// other the stream can't hold. setUniforms() after each link of the program.
+class InstancedQuadRenderer {
+public:
+    enum class Format { Mat4, Affine2D, Layered, Animated, Particle };
+    enum class Storage { Attributes, TextureBuffer };
+
+    // First of the locations used by the per-instance transform (vertex.glsl's aModel; the
+    // other formats' inputs follow it, checked in the .cpp).
+    static constexpr GLuint kModelAttribLocation = shaderlayout::vertex::aModel.location;
+    // aInstanceColor: after a mat4's four locations, so the same for every format.
+    static constexpr GLuint kColorAttribLocation = shaderlayout::vertex::aInstanceColor.location;
+    // Storage::TextureBuffer: uInstances' unit, vertex.glsl's binding.
+    static constexpr GLenum kInstanceTextureUnit = GL_TEXTURE0 + shaderlayout::vertex::uInstances.binding;
+
+    // vao:            VAO that already has the mesh pool's vertex buffer and EBO recorded.
+    // mesh:           the quad, within that pool.
+    // instanceColors: Mat4 / Affine2D only—a packed colour per instance (see above).
+    // storage:        TextureBuffer: Mat4 / Layered without instance colours only.
+    bool init(GLuint vao, const Mesh& mesh, std::size_t initialCapacity = 1024,
+              Format format = Format::Mat4, bool instanceColors = false,
+              Storage storage = Storage::Attributes);
+    void shutdown();
+    // Storage::TextureBuffer: finds `program`'s uInstanceBase.
+    void setUniforms(GLuint program);
+
+    void begin() { instances_.clear(); affine_.clear(); layered_.clear(); animated_.clear(); colors_.clear(); }
+    // Affine2D renderers keep only the 2D part of `model` (see toAffine2D). `color`
+    // (packColor) is used by renderers with instance colours only.
+    void submit(const glm::mat4& model, std::uint32_t color = 0xffffffffu) {
+        if (format_ == Format::Affine2D) affine_.push_back(toAffine2D(model));
+        else instances_.push_back(model);
+        if (instanceColors_) colors_.push_back(color);
+    }
+    // Layered renderers only.
+    void submit(const LayeredInstance& instance) { layered_.push_back(instance); }
+    // Animated renderers only.
+    void submit(const AnimatedInstance& instance) { animated_.push_back(instance); }
+
+    // Uploads this frame's instances and issues a single instanced draw.
+    // The shader program must already be bound with glUseProgram(...).
+    void draw();
+    void endFrame() { stream_.endFrame(); }
+
+    // Reserve `count` instances directly in the stream buffer. Write every matrix (the
+    // memory may be write-combined: write only, never read), then call drawMapped().
+    // Returns nullptr if the buffer can't be grown.
+    // mapInstances / mapAffine / mapLayered / mapAnimated / mapParticles: only for
+    // renderers of that format.
+    glm::mat4* mapInstances(std::size_t count);
+    Affine2D* mapAffine(std::size_t count);
+    LayeredInstance* mapLayered(std::size_t count);
+    AnimatedInstance* mapAnimated(std::size_t count);
+    ParticleInstance* mapParticles(std::size_t count);
+    // The colours of the instances just mapped (instance colours only, else nullptr):
+    // one per instance, written like the transforms, before drawMapped().
+    std::uint32_t* mapColors();
+    void drawMapped();
+    // Instances [first, first + count) of the mapped ones; may be called several times
+    // for one mapping (which stays open until the next map or drawMapped()).
+    void drawMappedRange(std::size_t first, std::size_t count);
+
+    Format format() const { return format_; }
+    Storage storage() const { return storage_; }
+    bool instanceColors() const { return instanceColors_; }
+    std::size_t instanceStride() const {
+        switch (format_) {
+            case Format::Affine2D: return sizeof(Affine2D);
+            case Format::Layered:  return sizeof(LayeredInstance);
+            case Format::Animated: return sizeof(AnimatedInstance);
+            case Format::Particle: return sizeof(ParticleInstance);
+            case Format::Mat4:     break;
+        }
+        return sizeof(glm::mat4);
+    }
+    std::size_t instanceCount() const {
+        switch (format_) {
+            case Format::Affine2D: return affine_.size();
+            case Format::Layered:  return layered_.size();
+            case Format::Animated: return animated_.size();
+            case Format::Particle: return 0;   // mapped only
+            case Format::Mat4:     break;
+        }
+        return instances_.size();
+    }
+
+private:
+    // DSA buffer binding points: past the ones VertexLayout::enableOn gives the mesh's
+    // locations (binding = location), see render/gl_buffer.h.
+    static constexpr GLuint kInstanceBinding = 8;
+    static constexpr GLuint kColorBinding = 9;
+
+    bool reserveGpu(std::size_t count);
+    void formatInstanceAttributes();
+    void bindInstanceTexels(GLintptr offset);
+    // transforms: where instance 0's transform is; colors: its colour (instance colours).
+    void bindInstanceAttributes(GLintptr offset, GLintptr colorOffset = 0);
+    std::size_t instanceBytes() const { return instanceStride() + (instanceColors_ ? sizeof(std::uint32_t) : 0); }
+    void* mapRaw(std::size_t count);
+    GLuint attributeCount() const { // Layered: 2 rows + layer + color; Animated: + animation
+        return format_ == Format::Affine2D || format_ == Format::Particle ? 2 : format_ == Format::Animated ? 5 : 4;
+    }
+
+    GLuint vao_ = 0;
+    Format format_ = Format::Mat4;
+    Storage storage_ = Storage::Attributes;
+    bool instanceColors_ = false;
+    GlTexture texture_;                // TextureBuffer: views the whole stream buffer
+    std::size_t maxTexels_ = 0;        // ... which may be this big at most
+    GLint baseLocation_ = -1;          // uInstanceBase
+    Mesh mesh_;
+    std::size_t gpuCapacity_ = 0;     // instances one stream segment can hold
+    StreamBuffer stream_;
+    StreamAllocation mapped_;          // pending mapInstances() region
+    std::size_t mappedCount_ = 0;
+    bool mappedCommitted_ = false;     // its writes are flushed (StreamBuffer::commit)
+    std::vector<glm::mat4> instances_; // CPU staging, reused every frame
+    std::vector<Affine2D> affine_;     // same, Affine2D format
+    std::vector<LayeredInstance> layered_; // same, Layered format
+    std::vector<AnimatedInstance> animated_; // same, Animated format
+    std::vector<std::uint32_t> colors_;    // same, instance colours
+};
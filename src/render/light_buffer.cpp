@@ -0,0 +1,358 @@
+#include "render/light_buffer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#include "core/job_system.h"
+#include "render/camera_ubo.h"
+#include "render/gl_buffer.h"
+#include "render/gl_framebuffer.h"
+#include "render/gl_state.h"
+#include "render/gpu_memory.h"
+#include "render/shader_layout.h"
+#include "render/vertex_layout.h"
+
+namespace {
+
+// The quad: corners at ±1, scaled by each light's radius in the vertex shader.
+const VertexLayout kQuadLayout(2 * sizeof(std::int8_t), {
+    shaderInput(shaderlayout::vertex::aPos, 2, GL_BYTE, VertexAttribute::Kind::Float, 0),
+});
+
+// vertex.glsl LIGHT's aLight and aLightColor, one per instance.
+const VertexLayout kLightLayout(sizeof(PointLight2D), {
+    shaderInput(shaderlayout::vertex::aLight, 3, GL_FLOAT, VertexAttribute::Kind::Float,
+                offsetof(PointLight2D, position), 1),
+    shaderInput(shaderlayout::vertex::aLightColor, 4, GL_UNSIGNED_BYTE, VertexAttribute::Kind::Normalized,
+                offsetof(PointLight2D, color), 1),
+});
+
+// Tiled: what the composite reads per light (two RGBA32F texels) and per tile.
+constexpr GLsizeiptr kLightTexelBytes = 2 * sizeof(glm::vec4);
+constexpr std::size_t kTileTexels = 1u << 20;   // per frame at most: 4 MB of table + lists
+
+} // namespace
+
+bool LightBuffer::init(const Options& options) {
+    const gpumemory::Owner owner("lights");
+    shutdown();
+    options_ = options;
+    options_.divisor = std::max(1, options.divisor);
+    options_.maxLights = std::max<std::size_t>(1, options.maxLights);
+    fullscreenVao_ = GlVertexArray::create();
+    if (options_.tiled) {
+        // Every segment of both rings has to be addressable: the textures are all of them.
+        GLint maxTexels = 65536;
+        glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+        const std::size_t perFrame = static_cast<std::size_t>(maxTexels) / StreamBuffer::kFrames;
+        lightCapacity_ = std::min(options_.maxLights * CameraUniformBuffer::kMaxViews, perFrame / 2);
+        tileCapacity_ = std::min(kTileTexels, perFrame);
+        if (!lightTexels_.init(GL_TEXTURE_BUFFER, static_cast<GLsizeiptr>(lightCapacity_) * kLightTexelBytes) ||
+            !tileTexels_.init(GL_TEXTURE_BUFFER, static_cast<GLsizeiptr>(tileCapacity_ * sizeof(std::uint32_t)))) {
+            std::cerr << "LightBuffer: no tile buffers\n";
+            shutdown();
+            return false;
+        }
+        lightTexture_ = GlTexture::create();
+        glstate::activeTexture(kLightsUnit);
+        glstate::bindTexture(GL_TEXTURE_BUFFER, lightTexture_.get());
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, lightTexels_.buffer());
+        tileTexture_ = GlTexture::create();
+        glstate::activeTexture(kTilesUnit);
+        glstate::bindTexture(GL_TEXTURE_BUFFER, tileTexture_.get());
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_R32UI, tileTexels_.buffer());
+        glstate::activeTexture(GL_TEXTURE0);
+        return true;
+    }
+    if (!instances_.init(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(options_.maxLights * sizeof(PointLight2D)))) {
+        std::cerr << "LightBuffer: no instance stream\n";
+        return false;
+    }
+    const std::int8_t corners[8] = {-1, -1, 1, -1, 1, 1, -1, 1};
+    const std::uint16_t indices[6] = {0, 1, 2, 2, 3, 0};
+    quadVbo_ = GlBuffer::create();
+    glbuffer::data(GL_ARRAY_BUFFER, quadVbo_.get(), sizeof(corners), corners, GL_STATIC_DRAW);
+    quadEbo_ = GlBuffer::create();
+    glbuffer::data(GL_ELEMENT_ARRAY_BUFFER, quadEbo_.get(), sizeof(indices), indices, GL_STATIC_DRAW);
+
+    vao_ = GlVertexArray::create();
+    glstate::bindVertexArray(vao_.get());
+    glstate::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, quadEbo_.get());   // recorded into the VAO
+    glstate::bindBuffer(GL_ARRAY_BUFFER, quadVbo_.get());
+    kQuadLayout.enable();
+    glstate::bindBuffer(GL_ARRAY_BUFFER, instances_.buffer());
+    kLightLayout.enable();             // pointed at this frame's instances by begin()
+    glstate::bindVertexArray(0);
+    return true;
+}
+
+void LightBuffer::shutdown() {
+    target_.shutdown();
+    instances_.shutdown();
+    vao_.reset();
+    fullscreenVao_.reset();
+    quadVbo_.reset();
+    quadEbo_.reset();
+    lightTexture_.reset();
+    tileTexture_.reset();
+    lightTexels_.shutdown();
+    tileTexels_.shutdown();
+    lightCapacity_ = tileCapacity_ = 0;
+    projected_.clear();
+    counts_.clear();
+    tileViews_.clear();
+    tileGridLocation_ = -1;
+    scaleLocation_ = -1;
+    sceneWidth_ = sceneHeight_ = 0;
+    stats_ = Stats{};
+}
+
+void LightBuffer::setUniforms(GLuint compositeProgram) {
+    glstate::useProgram(compositeProgram);
+    scaleLocation_ = glGetUniformLocation(compositeProgram, shaderlayout::fragment::uLightScale.name);
+    const GLint ambient = glGetUniformLocation(compositeProgram, shaderlayout::fragment::uAmbient.name);
+    if (ambient >= 0) {
+        glUniform3f(ambient, options_.ambient.r, options_.ambient.g, options_.ambient.b);
+    }
+    tileGridLocation_ = glGetUniformLocation(compositeProgram, shaderlayout::fragment::uTileGrid.name);
+}
+
+void LightBuffer::begin(const PointLight2D* lights, std::size_t count, int targetWidth, int targetHeight,
+                        const View* views, std::size_t viewCount, JobSystem* jobs) {
+    const gpumemory::Owner owner("lights");
+    stats_ = Stats{};
+    if (!initialized()) {
+        return;
+    }
+    if (options_.tiled) {
+        beginTiled(lights, std::min(count, options_.maxLights), views, viewCount, jobs);
+        return;
+    }
+    sceneWidth_ = std::max(1, targetWidth);
+    sceneHeight_ = std::max(1, targetHeight);
+    const int width = std::max(1, sceneWidth_ / options_.divisor);
+    const int height = std::max(1, sceneHeight_ / options_.divisor);
+    if (target_.framebuffer() == 0) {
+        RenderTargetDesc desc;
+        desc.width = width;
+        desc.height = height;
+        desc.colorFormat = GL_RGBA16F;     // sums past 1, blended in float
+        if (!target_.init(desc)) {
+            return;
+        }
+    } else if (!target_.resize(width, height)) {
+        return;
+    }
+    stats_.width = width;
+    stats_.height = height;
+
+    count = std::min(count, options_.maxLights);
+    if (count > 0) {
+        StreamAllocation a = instances_.allocate(static_cast<GLsizeiptr>(count * sizeof(PointLight2D)),
+                                                 sizeof(PointLight2D));
+        if (a.valid()) {
+            std::memcpy(a.ptr, lights, count * sizeof(PointLight2D));
+            instances_.commit(a);
+            glstate::bindVertexArray(vao_.get());
+            glstate::bindBuffer(GL_ARRAY_BUFFER, instances_.buffer());
+            kLightLayout.pointers(a.offset);
+            stats_.lights = count;
+        }
+    }
+}
+
+void LightBuffer::beginTiled(const PointLight2D* lights, std::size_t count, const View* views,
+                             std::size_t viewCount, JobSystem* jobs) {
+    tileViews_.assign(viewCount, TileView{});
+    if (viewCount == 0) {
+        return;
+    }
+    // Worst case up front, so each view writes straight into its part: every light in
+    // every view, and every tile's table entry plus a full list.
+    std::size_t tileCount = 0;
+    for (std::size_t v = 0; v < viewCount; ++v) {
+        const glm::ivec4& r = views[v].rect;
+        tileCount += static_cast<std::size_t>((std::max(r.z, 1) + kTileSize - 1) / kTileSize) *
+                     static_cast<std::size_t>((std::max(r.w, 1) + kTileSize - 1) / kTileSize);
+    }
+    count = std::min(count, lightCapacity_ / viewCount);
+    const std::size_t tileTexels = std::min(tileCapacity_, tileCount * (2 + kMaxLightsPerTile));
+    StreamAllocation la = lightTexels_.allocate(static_cast<GLsizeiptr>(std::max<std::size_t>(1, count * viewCount)) *
+                                                    kLightTexelBytes, kLightTexelBytes);
+    StreamAllocation ta = tileTexels_.allocate(static_cast<GLsizeiptr>(tileTexels * sizeof(std::uint32_t)),
+                                               sizeof(std::uint32_t));
+    if (!la.valid() || !ta.valid()) {
+        return;
+    }
+    glm::vec4* lightOut = static_cast<glm::vec4*>(la.ptr);
+    std::uint32_t* tileOut = static_cast<std::uint32_t*>(ta.ptr);
+    const std::uint32_t lightBase = static_cast<std::uint32_t>(la.offset / kLightTexelBytes);
+    const std::uint32_t tileBase = static_cast<std::uint32_t>(ta.offset / static_cast<GLintptr>(sizeof(std::uint32_t)));
+    std::size_t lightsWritten = 0, tileWritten = 0;
+
+    for (std::size_t v = 0; v < viewCount; ++v) {
+        const glm::ivec4 rect = views[v].rect;
+        const int tilesX = (std::max(rect.z, 1) + kTileSize - 1) / kTileSize;
+        const int tilesY = (std::max(rect.w, 1) + kTileSize - 1) / kTileSize;
+        const std::size_t tiles = static_cast<std::size_t>(tilesX) * static_cast<std::size_t>(tilesY);
+        if (tileWritten + 2 * tiles > tileTexels) {
+            break;                     // out of table room: the rest of the views go unlit
+        }
+
+        // The lights in the view's pixels: the centre through the camera, the radius as
+        // far as the point `radius` to its right lands (2D cameras don't shear).
+        projected_.resize(count);
+        const glm::mat4& vp = views[v].viewProjection;
+        const glm::vec2 half(0.5f * static_cast<float>(rect.z), 0.5f * static_cast<float>(rect.w));
+        const std::uint32_t viewLights = lightBase + static_cast<std::uint32_t>(lightsWritten);
+        for (std::size_t i = 0; i < count; ++i) {
+            const glm::vec4 c = vp * glm::vec4(lights[i].position, 0.0f, 1.0f);
+            const glm::vec4 e = vp * glm::vec4(lights[i].position + glm::vec2(lights[i].radius, 0.0f), 0.0f, 1.0f);
+            const glm::vec2 centre = (glm::vec2(c) / c.w + 1.0f) * half;
+            const float radius = glm::length((glm::vec2(e) / e.w + 1.0f) * half - centre);
+            projected_[i] = glm::vec3(centre, radius);
+            const std::uint32_t rgba = lights[i].color;
+            *lightOut++ = glm::vec4(centre + glm::vec2(rect.x, rect.y), radius, 0.0f);
+            *lightOut++ = glm::vec4(static_cast<float>(rgba & 0xffu), static_cast<float>(rgba >> 8 & 0xffu),
+                                    static_cast<float>(rgba >> 16 & 0xffu), static_cast<float>(rgba >> 24)) /
+                          255.0f;
+        }
+        lightsWritten += count;
+
+        // Two passes over the tile rows, in parallel: count each tile's lights, then (past
+        // a prefix sum, here) fill the lists. A row only reads the lights and writes its
+        // own tiles, so the jobs share nothing.
+        counts_.assign(tiles, 0);
+        auto binRow = [&](int ty, std::uint32_t* lists) {
+            const float y0 = static_cast<float>(ty * kTileSize);
+            const float y1 = y0 + static_cast<float>(kTileSize);
+            const std::size_t row = static_cast<std::size_t>(ty) * static_cast<std::size_t>(tilesX);
+            for (std::size_t i = 0; i < count; ++i) {
+                const glm::vec3 l = projected_[i];
+                if (l.z <= 0.0f || l.y + l.z < y0 || l.y - l.z > y1) {
+                    continue;
+                }
+                // The disc's widest extent across the row's band.
+                const float dy = l.y < y0 ? y0 - l.y : (l.y > y1 ? l.y - y1 : 0.0f);
+                const float dx = std::sqrt(std::max(0.0f, l.z * l.z - dy * dy));
+                const int tx0 = std::max(0, static_cast<int>(std::floor((l.x - dx) / kTileSize)));
+                const int tx1 = std::min(tilesX - 1, static_cast<int>(std::floor((l.x + dx) / kTileSize)));
+                for (int tx = tx0; tx <= tx1; ++tx) {
+                    const std::size_t t = row + static_cast<std::size_t>(tx);
+                    if (lists == nullptr) {
+                        ++counts_[t];  // past the cap too, for the stats
+                    } else if (filled_[t] < counts_[t]) {
+                        lists[firsts_[t] + filled_[t]++] = viewLights + static_cast<std::uint32_t>(i);
+                    }
+                }
+            }
+        };
+        auto forRows = [&](auto&& body) {
+            if (jobs != nullptr) {
+                jobs->parallelFor(static_cast<std::size_t>(tilesY), 4, [&](std::size_t begin, std::size_t end) {
+                    for (std::size_t ty = begin; ty < end; ++ty) body(static_cast<int>(ty));
+                });
+            } else {
+                for (int ty = 0; ty < tilesY; ++ty) body(ty);
+            }
+        };
+        forRows([&](int ty) { binRow(ty, nullptr); });
+
+        // The table: [first, count] per tile (first absolute, counts capped), the lists
+        // after it. Tiles whose lists don't fit any more keep none. counts_ becomes each
+        // list's length for the fill pass.
+        std::uint32_t* table = tileOut + tileWritten;
+        firsts_.resize(tiles);
+        filled_.assign(tiles, 0);
+        std::size_t listed = tileWritten + 2 * tiles;
+        for (std::size_t t = 0; t < tiles; ++t) {
+            const std::uint32_t total = counts_[t];
+            std::uint32_t n = std::min(total, static_cast<std::uint32_t>(kMaxLightsPerTile));
+            if (listed + n > tileTexels) {
+                n = 0;
+            }
+            firsts_[t] = static_cast<std::uint32_t>(listed - tileWritten - 2 * tiles);
+            counts_[t] = n;
+            table[2 * t] = tileBase + static_cast<std::uint32_t>(listed);
+            table[2 * t + 1] = n;
+            stats_.clipped += total - n;
+            stats_.tileEntries += n;
+            listed += n;
+        }
+        std::uint32_t* lists = table + 2 * tiles;
+        forRows([&](int ty) { binRow(ty, lists); });
+        tileViews_[v].grid = glm::ivec4(rect.x, rect.y, tilesX, static_cast<int>(tileBase + tileWritten));
+        tileWritten = listed;
+        stats_.tiles += tiles;
+    }
+    lightTexels_.commit(la);
+    tileTexels_.commit(ta);
+    stats_.lights = count;
+}
+
+void LightBuffer::accumulate(const glm::ivec4& viewRect) {
+    if (stats_.width == 0) {
+        return;
+    }
+    // The view's rect, in the target's (smaller) pixels.
+    const int x0 = viewRect.x * stats_.width / sceneWidth_;
+    const int y0 = viewRect.y * stats_.height / sceneHeight_;
+    const int x1 = (viewRect.x + viewRect.z) * stats_.width / sceneWidth_;
+    const int y1 = (viewRect.y + viewRect.w) * stats_.height / sceneHeight_;
+    glstate::bindFramebuffer(GL_FRAMEBUFFER, target_.framebuffer());
+    glstate::viewport(x0, y0, std::max(1, x1 - x0), std::max(1, y1 - y0));
+    const GLfloat ambient[4] = {options_.ambient.r, options_.ambient.g, options_.ambient.b, 1.0f};
+    {
+        glframebuffer::Scissor scissor(glm::ivec4(x0, y0, std::max(1, x1 - x0), std::max(1, y1 - y0)), stats_.width,
+                                       stats_.height);
+        glClearBufferfv(GL_COLOR, 0, ambient);
+    }
+    if (stats_.lights == 0) {
+        return;
+    }
+    glstate::enable(GL_BLEND);
+    glstate::blendFunc(GL_ONE, GL_ONE);
+    glstate::bindVertexArray(vao_.get());
+    glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, nullptr, static_cast<GLsizei>(stats_.lights));
+    glstate::disable(GL_BLEND);
+}
+
+void LightBuffer::composite(GLuint framebuffer, const glm::ivec4& viewRect, std::size_t view) {
+    if (options_.tiled) {
+        if (view >= tileViews_.size() || tileViews_[view].grid.z == 0) {
+            return;
+        }
+        glUniform4iv(tileGridLocation_, 1, &tileViews_[view].grid.x);
+        glstate::activeTexture(kLightsUnit);
+        glstate::bindTexture(GL_TEXTURE_BUFFER, lightTexture_.get());
+        glstate::activeTexture(kTilesUnit);
+        glstate::bindTexture(GL_TEXTURE_BUFFER, tileTexture_.get());
+        glstate::activeTexture(GL_TEXTURE0);
+    } else if (stats_.width == 0) {
+        return;
+    }
+    glstate::bindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glstate::viewport(viewRect.x, viewRect.y, viewRect.z, viewRect.w);
+    if (scaleLocation_ >= 0) {
+        glUniform2f(scaleLocation_, 1.0f / static_cast<float>(sceneWidth_), 1.0f / static_cast<float>(sceneHeight_));
+    }
+    glstate::enable(GL_BLEND);
+    glstate::blendFunc(GL_DST_COLOR, GL_SRC_COLOR);   // 2 x scene x output
+    glstate::bindVertexArray(fullscreenVao_.get());
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glstate::disable(GL_BLEND);
+}
+
+void LightBuffer::endFrame() {
+    if (!initialized()) {
+        return;
+    }
+    if (options_.tiled) {
+        lightTexels_.endFrame();
+        tileTexels_.endFrame();
+    } else {
+        instances_.endFrame();
+    }
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "render/gl_resource.h"
+#include "render/render_target.h"
+#include "render/shader_layout.h"
+#include "render/stream_buffer.h"
+
+class JobSystem;
+
+// A 2D point light, as the light pass reads it (one instance each, 16 bytes).
+struct PointLight2D {
+    glm::vec2 position;
+    float radius;                  // world units: the light is 0 from here on
+    std::uint32_t color;           // packColor: rgb, alpha the intensity
+};
+static_assert(sizeof(PointLight2D) == 16, "PointLight2D is an instance attribute stride");
+
+// LightBuffer
+// -----------
+// 2D lighting that costs what the lit pixels cost, not lights x sprites. Each view's
+// lights are drawn as additive instanced quads into a LIGHT ACCUMULATION target of
+// 1/divisor the scene's size per side, cleared to the ambient; then one full-screen
+// triangle multiplies the scene's view by it:
+//
+//     scene view ───────────────────────────────────────┐
+//     lights ─▶ quads, GL_ONE + GL_ONE ─▶ RGBA16F 1/4² ─┴▶ composite: scene x light (x2)
+//
+// | Per view          | Draws | Fragments                                         |
+// | ----------------- | ----- | ------------------------------------------------- |
+// | accumulate        | 1     | each light's disc, at 1/divisor² the pixels       |
+// | composite         | 1     | the view once                                     |
+//
+// Nothing per sprite: a thousand sprites under one light cost the same as one. Light is
+// smooth, so the low resolution (bilinearly upscaled by the composite) doesn't show.
+//
+// The composite blends GL_DST_COLOR, GL_SRC_COLOR: scene x 2 x its output. It outputs
+// half the accumulated light (clamped to 2), so light 1 leaves the scene as drawn, the
+// ambient darkens it and a bright light brightens it up to twice. A plain multiply
+// (GL_DST_COLOR, GL_ZERO) could only darken: the source is clamped to [0, 1] before
+// blending into an RGBA8 target.
+//
+//     lights.begin(packet lights, targetWidth, targetHeight);  // once per frame
+//     per view: light program, lights.accumulate(viewRect);    // the view's Camera block
+//               composite program + texture(), lights.composite(framebuffer, viewRect);
+//     lights.endFrame();
+//
+// Programs: vertex.glsl + fragment.glsl LIGHT for the quads; fullscreen_vertex.glsl +
+// fragment.glsl LIGHT + COMPOSITE for the composite (setUniforms() after each link).
+//
+// Tiled (Options::tiled, --light-tiles): no light target and no light quads. begin()
+// projects the lights into each view's pixels and bins them into kTileSize² pixel tiles
+// on the job system; the composite (+ TILED) looks up its pixel's tile and sums only the
+// lights in its list, at full resolution:
+//
+//     uTileLights (R32UI texture buffer), per view:
+//     [first, count] x tiles  │  light indices, tile after tile
+//     uLights (RGBA32F texture buffer): (x, y, radius) in pixels, (rgb, intensity) per light
+//
+// | Mode       | GPU per view                            | CPU per frame                   |
+// | ---------- | --------------------------------------- | ------------------------------- |
+// | accumulate | each light's disc at 1/divisor², then   | one instance copy               |
+// |            | the view once                           |                                 |
+// | tiled      | the view once, each pixel its tile's    | lights x tile rows of binning,  |
+// |            | lights (at most kMaxLightsPerTile)      | on the job system; the lists    |
+//
+// Thousands of small lights: tiled, whose cost per pixel is the lights that reach it,
+// with no blending and no overdraw of light quads. A few big ones: accumulate.
+class LightBuffer {
+public:
+    static constexpr int kTileSize = 16;               // pixels per tile side
+    static constexpr int kMaxLightsPerTile = 32;       // further ones are left out
+    // Tiled: fragment.glsl's units for uLights and uTileLights.
+    static constexpr GLenum kLightsUnit = GL_TEXTURE0 + shaderlayout::fragment::uLights.binding;
+    static constexpr GLenum kTilesUnit = GL_TEXTURE0 + shaderlayout::fragment::uTileLights.binding;
+
+    struct Options {
+        int divisor = 4;                       // the target is the scene's / divisor per side
+        std::size_t maxLights = 4096;          // per frame; begin() keeps the first ones
+        glm::vec3 ambient{0.3f, 0.32f, 0.4f};  // where no light reaches (1: unlit)
+        bool tiled = false;
+    };
+
+    struct Stats {
+        std::size_t lights = 0;        // this frame's begin()
+        int width = 0, height = 0;     // the accumulation target (tiled: 0)
+        std::size_t tiles = 0;         // tiled: over all views
+        std::size_t tileEntries = 0;   // ... light indices in their lists
+        std::size_t clipped = 0;       // ... dropped past kMaxLightsPerTile
+    };
+
+    // A view of the frame, for binning: its camera and its rect in target pixels.
+    struct View {
+        glm::mat4 viewProjection{1.0f};
+        glm::ivec4 rect{0};
+    };
+
+    LightBuffer() = default;
+    LightBuffer(const LightBuffer&) = delete;
+    LightBuffer& operator=(const LightBuffer&) = delete;
+
+    // GL thread. The quad's VAO is its own (the instance offset moves every frame).
+    bool init(const Options& options);
+    void shutdown();
+
+    // After each link of the composite program.
+    void setUniforms(GLuint compositeProgram);
+
+    // Once per frame, before the views: the lights into the instance stream, the target
+    // sized for a targetWidth x targetHeight scene. Tiled: the lights projected and
+    // binned for each of `views` instead (jobs: may be null).
+    void begin(const PointLight2D* lights, std::size_t count, int targetWidth, int targetHeight,
+               const View* views = nullptr, std::size_t viewCount = 0, JobSystem* jobs = nullptr);
+    // With the light program bound and the view's Camera block: the view's part of the
+    // target (viewRect in scene pixels) cleared to the ambient, then its lights added.
+    // Leaves the accumulation target bound. Tiled: nothing.
+    void accumulate(const glm::ivec4& viewRect);
+    // With the composite program bound and texture() on unit 0: `framebuffer` and its
+    // viewRect bound again, the view multiplied by its light. Tiled: view is the index
+    // into begin()'s views.
+    void composite(GLuint framebuffer, const glm::ivec4& viewRect, std::size_t view = 0);
+    void endFrame();
+
+    bool initialized() const { return fullscreenVao_.get() != 0; }
+    bool tiled() const { return options_.tiled; }
+    GLuint texture() const { return target_.colorTexture(); }
+    const Stats& stats() const { return stats_; }
+
+private:
+    struct TileView {
+        glm::ivec4 grid{0};            // origin x, y (pixels), tiles x, first texel
+    };
+
+    void beginTiled(const PointLight2D* lights, std::size_t count, const View* views, std::size_t viewCount,
+                    JobSystem* jobs);
+
+    Options options_;
+    GlBuffer quadVbo_;
+    GlBuffer quadEbo_;
+    GlVertexArray vao_;                // the quad + the instance stream
+    GlVertexArray fullscreenVao_;      // empty: fullscreen_vertex.glsl makes its positions
+    StreamBuffer instances_;
+    RenderTarget target_;
+    GLint scaleLocation_ = -1;         // uLightScale: 1 / the scene's size
+    int sceneWidth_ = 0, sceneHeight_ = 0;
+
+    // Tiled.
+    StreamBuffer lightTexels_;         // two RGBA32F texels per light and view
+    GlTexture lightTexture_;
+    StreamBuffer tileTexels_;          // R32UI: the views' tables and lists
+    GlTexture tileTexture_;
+    std::size_t lightCapacity_ = 0;    // lights per frame, over all views
+    std::size_t tileCapacity_ = 0;     // texels per frame
+    std::vector<glm::vec3> projected_; // one view's lights: pixels (x, y, radius); 0: off it
+    std::vector<std::uint32_t> counts_;   // per tile: lights reaching it, then its list's length
+    std::vector<std::uint32_t> firsts_;   // ... where its list starts, after the table
+    std::vector<std::uint32_t> filled_;   // ... written so far by the fill pass
+    std::vector<TileView> tileViews_;
+    GLint tileGridLocation_ = -1;
+    Stats stats_;
+};
@@ -0,0 +1,138 @@
+#include "render/mesh_pool.h"
+
+#include <iostream>
+
+#include "render/gl_buffer.h"
+#include "render/gpu_memory.h"
+
+bool MeshPool::init(const VertexLayout& layout, std::size_t vertexCapacity, std::size_t indexCapacity) {
+    const gpumemory::Owner owner("mesh pool");
+    shutdown();
+    if (vertexCapacity == 0 || indexCapacity == 0) {
+        return false;
+    }
+    layout_ = &layout;
+    vertices_ = GlBuffer::create();
+    glbuffer::data(GL_ARRAY_BUFFER, vertices_.get(), static_cast<GLsizeiptr>(vertexCapacity * layout.stride()),
+                   nullptr, GL_STATIC_DRAW);
+    indices_ = GlBuffer::create();
+    glbuffer::data(GL_ELEMENT_ARRAY_BUFFER, indices_.get(),
+                   static_cast<GLsizeiptr>(indexCapacity * sizeof(std::uint16_t)), nullptr, GL_STATIC_DRAW);
+    vertexRanges_.reset(vertexCapacity);
+    indexRanges_.reset(indexCapacity);
+    vertexCapacity_ = vertexCapacity;
+    indexCapacity_ = indexCapacity;
+    return true;
+}
+
+void MeshPool::shutdown() {
+    vertices_.reset();                 // queued (render/gl_resource.h)
+    indices_.reset();
+    vertexRanges_.reset(0);
+    indexRanges_.reset(0);
+    vertexCapacity_ = indexCapacity_ = 0;
+    meshes_ = 0;
+    failed_ = 0;
+}
+
+Mesh MeshPool::add(const void* vertices, std::size_t vertexCount, const std::uint16_t* indices,
+                   std::size_t indexCount) {
+    if (!vertices_ || vertexCount == 0 || indexCount == 0 || vertexCount > 65536) {
+        return Mesh{};
+    }
+    std::size_t firstVertex = 0;
+    std::size_t firstIndex = 0;
+    if (!vertexRanges_.allocate(vertexCount, firstVertex)) {
+        ++failed_;
+        std::cerr << "MeshPool: no room for " << vertexCount << " vertices\n";
+        return Mesh{};
+    }
+    if (!indexRanges_.allocate(indexCount, firstIndex)) {
+        vertexRanges_.free(firstVertex, vertexCount);
+        ++failed_;
+        std::cerr << "MeshPool: no room for " << indexCount << " indices\n";
+        return Mesh{};
+    }
+
+    const std::size_t stride = static_cast<std::size_t>(layout_->stride());
+    glbuffer::subData(GL_ARRAY_BUFFER, vertices_.get(), static_cast<GLintptr>(firstVertex * stride),
+                      static_cast<GLsizeiptr>(vertexCount * stride), vertices);
+    glbuffer::subData(GL_ELEMENT_ARRAY_BUFFER, indices_.get(), static_cast<GLintptr>(firstIndex * sizeof(std::uint16_t)),
+                      static_cast<GLsizeiptr>(indexCount * sizeof(std::uint16_t)), indices);
+    ++meshes_;
+    return Mesh{static_cast<GLint>(firstVertex), static_cast<GLsizei>(vertexCount), static_cast<GLsizei>(firstIndex),
+                static_cast<GLsizei>(indexCount)};
+}
+
+void MeshPool::remove(const Mesh& mesh) {
+    if (!mesh.valid() || meshes_ == 0) {
+        return;
+    }
+    vertexRanges_.free(static_cast<std::size_t>(mesh.baseVertex), static_cast<std::size_t>(mesh.vertexCount));
+    indexRanges_.free(static_cast<std::size_t>(mesh.firstIndex), static_cast<std::size_t>(mesh.indexCount));
+    --meshes_;
+}
+
+void MeshPool::draw(const Mesh& mesh, GLenum mode) {
+    glDrawElementsBaseVertex(mode, mesh.indexCount, GL_UNSIGNED_SHORT, mesh.indexOffset(), mesh.baseVertex);
+}
+
+void MeshPool::drawInstanced(const Mesh& mesh, GLsizei instances, GLenum mode) {
+    glDrawElementsInstancedBaseVertex(mode, mesh.indexCount, GL_UNSIGNED_SHORT, mesh.indexOffset(), instances,
+                                      mesh.baseVertex);
+}
+
+MeshPool::Stats MeshPool::stats() const {
+    Stats s;
+    s.meshes = meshes_;
+    s.vertices = vertexRanges_.used();
+    s.indices = indexRanges_.used();
+    s.vertexCapacity = vertexCapacity_;
+    s.indexCapacity = indexCapacity_;
+    s.failed = failed_;
+    return s;
+}
+
+void MeshPool::Ranges::reset(std::size_t capacity) {
+    free_.clear();
+    if (capacity > 0) {
+        free_.push_back(Range{0, capacity});
+    }
+    used_ = 0;
+}
+
+bool MeshPool::Ranges::allocate(std::size_t count, std::size_t& first) {
+    for (std::size_t i = 0; i < free_.size(); ++i) {
+        Range& r = free_[i];
+        if (r.count < count) {
+            continue;
+        }
+        first = r.first;
+        r.first += count;
+        r.count -= count;
+        if (r.count == 0) {
+            free_.erase(free_.begin() + static_cast<std::ptrdiff_t>(i));
+        }
+        used_ += count;
+        return true;
+    }
+    return false;
+}
+
+void MeshPool::Ranges::free(std::size_t first, std::size_t count) {
+    // Insert in order, then merge with the neighbours it touches.
+    std::size_t i = 0;
+    while (i < free_.size() && free_[i].first < first) {
+        ++i;
+    }
+    free_.insert(free_.begin() + static_cast<std::ptrdiff_t>(i), Range{first, count});
+    if (i + 1 < free_.size() && free_[i].first + free_[i].count == free_[i + 1].first) {
+        free_[i].count += free_[i + 1].count;
+        free_.erase(free_.begin() + static_cast<std::ptrdiff_t>(i + 1));
+    }
+    if (i > 0 && free_[i - 1].first + free_[i - 1].count == free_[i].first) {
+        free_[i - 1].count += free_[i].count;
+        free_.erase(free_.begin() + static_cast<std::ptrdiff_t>(i));
+    }
+    used_ -= count;
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "render/gl_resource.h"
+#include "render/vertex_layout.h"
+
+// Mesh
+// ----
+// Where one mesh lives inside a MeshPool: a range of its vertex buffer and a range of its
+// index buffer. The indices are the mesh's own (0 = its first vertex); baseVertex is
+// added by the draw, so the same mesh data works at any place in the pool.
+struct Mesh {
+    GLint baseVertex = 0;          // first vertex in the pool's vertex buffer
+    GLsizei vertexCount = 0;
+    GLsizei firstIndex = 0;        // first index in the pool's index buffer
+    GLsizei indexCount = 0;
+
+    bool valid() const { return indexCount > 0; }
+    // The `indices` argument of glDrawElements*: a byte offset into the bound EBO.
+    const void* indexOffset() const {
+        return reinterpret_cast<const void*>(static_cast<std::uintptr_t>(firstIndex) * sizeof(std::uint16_t));
+    }
+};
+
+// MeshPool
+// --------
+// Many static meshes of one vertex layout in ONE vertex buffer and ONE index buffer,
+// instead of a VBO/EBO pair each:
+//
+// | Per mesh                     | VBO/EBO per mesh                 | MeshPool                     |
+// | ---------------------------- | -------------------------------- | ---------------------------- |
+// | GL objects                   | 2 buffers + a VAO                | a range of each buffer       |
+// | switching meshes             | bind its VAO (new buffers)       | nothing: other draw args     |
+// | draws of different meshes    | can never be one draw            | same VAO and state: they can |
+// |                              |                                  | be batched (multi-draw)      |
+//
+// glDrawElementsBaseVertex (core in GL 3.2) adds baseVertex to every index it reads, so
+// each mesh keeps 16-bit indices relative to its own first vertex and needs no fixing
+// up when it is placed. A VAO over the pool (VertexArrayCache: {layout, vertexBuffer()}
+// + indexBuffer()) draws every mesh in it.
+//
+//     MeshPool pool;
+//     pool.init(kLayout, 4096, 8192);
+//     Mesh quad = pool.add(vertices, 4, indices, 6);
+//     ...
+//     glstate::bindVertexArray(poolVao);
+//     MeshPool::draw(quad);              // or drawInstanced(quad, n)
+//
+// The buffers have a fixed capacity chosen at init(): growing them would mean new buffer
+// names under every VAO that reads them. remove() gives a mesh's ranges back; add()
+// takes the first free range that fits (adjacent free ranges are merged).
+class MeshPool {
+public:
+    struct Stats {
+        std::size_t meshes = 0;
+        std::size_t vertices = 0;          // in use
+        std::size_t indices = 0;
+        std::size_t vertexCapacity = 0;
+        std::size_t indexCapacity = 0;
+        std::uint64_t failed = 0;          // add() calls that found no room
+    };
+
+    MeshPool() = default;
+    MeshPool(const MeshPool&) = delete;
+    MeshPool& operator=(const MeshPool&) = delete;
+
+    // GL thread: both buffers, uninitialized. `layout` must outlive the pool.
+    bool init(const VertexLayout& layout, std::size_t vertexCapacity, std::size_t indexCapacity);
+    void shutdown();
+
+    // GL thread: copies the mesh into the pool. `vertices` is vertexCount * stride bytes
+    // in the layout's format; indices are 0-based within the mesh. An invalid Mesh if it
+    // doesn't fit (or vertexCount exceeds 16-bit indices). Imported meshes go through
+    // meshopt::optimize() and narrowIndices() first (asset/mesh_optimize.h).
+    Mesh add(const void* vertices, std::size_t vertexCount, const std::uint16_t* indices, std::size_t indexCount);
+    // Its ranges are free again; draws already submitted still read the old contents.
+    void remove(const Mesh& mesh);
+
+    // GL thread, a VAO over this pool bound.
+    static void draw(const Mesh& mesh, GLenum mode = GL_TRIANGLES);
+    static void drawInstanced(const Mesh& mesh, GLsizei instances, GLenum mode = GL_TRIANGLES);
+
+    const VertexLayout& layout() const { return *layout_; }
+    GLuint vertexBuffer() const { return vertices_.get(); }
+    GLuint indexBuffer() const { return indices_.get(); }
+    Stats stats() const;
+
+private:
+    // First-fit free list over [0, capacity) of one buffer, in elements.
+    class Ranges {
+    public:
+        void reset(std::size_t capacity);
+        bool allocate(std::size_t count, std::size_t& first);
+        void free(std::size_t first, std::size_t count);
+        std::size_t used() const { return used_; }
+
+    private:
+        struct Range {
+            std::size_t first;
+            std::size_t count;
+        };
+        std::vector<Range> free_;          // sorted by first, never adjacent
+        std::size_t used_ = 0;
+    };
+
+    const VertexLayout* layout_ = nullptr;
+    GlBuffer vertices_;
+    GlBuffer indices_;
+    Ranges vertexRanges_;
+    Ranges indexRanges_;
+    std::size_t vertexCapacity_ = 0;
+    std::size_t indexCapacity_ = 0;
+    std::size_t meshes_ = 0;
+    std::uint64_t failed_ = 0;
+};
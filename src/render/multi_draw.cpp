@@ -0,0 +1,73 @@
+#include "render/multi_draw.h"
+
+#include <cstring>
+
+#include "render/gl_ext.h"
+#include "render/gl_state.h"
+#include "render/gpu_memory.h"
+
+void MultiDraw::init(std::size_t maxDrawsPerFrame, bool allowIndirect) {
+    const gpumemory::Owner owner("multi-draw");
+    shutdown();
+    indirect_ = allowIndirect && glext::caps().multiDrawIndirect && maxDrawsPerFrame > 0 &&
+                commands_.init(GL_DRAW_INDIRECT_BUFFER,
+                               static_cast<GLsizeiptr>(maxDrawsPerFrame * sizeof(DrawElementsIndirectCommand)));
+    pending_.reserve(256);
+}
+
+void MultiDraw::shutdown() {
+    commands_.shutdown();
+    indirect_ = false;
+    pending_.clear();
+    vao_ = 0;
+}
+
+void MultiDraw::add(GLuint vao, const Mesh& mesh, GLsizei instances) {
+    if (!mesh.valid() || instances <= 0) {
+        return;
+    }
+    if (vao != vao_ && !pending_.empty()) {
+        flush();
+    }
+    vao_ = vao;
+    pending_.push_back(DrawElementsIndirectCommand{static_cast<GLuint>(mesh.indexCount), static_cast<GLuint>(instances),
+                                                   static_cast<GLuint>(mesh.firstIndex), mesh.baseVertex, 0u});
+    ++stats_.draws;
+}
+
+void MultiDraw::flush(GLenum mode) {
+    if (pending_.empty()) {
+        return;
+    }
+    glstate::bindVertexArray(vao_);
+    const std::size_t bytes = pending_.size() * sizeof(DrawElementsIndirectCommand);
+    StreamAllocation a;
+    if (indirect_ && pending_.size() > 1) {
+        a = commands_.allocate(static_cast<GLsizeiptr>(bytes), 4);
+    }
+    if (a.valid()) {
+        std::memcpy(a.ptr, pending_.data(), bytes);
+        commands_.commit(a);
+        glstate::bindBuffer(GL_DRAW_INDIRECT_BUFFER, commands_.buffer());
+        glext::multiDrawElementsIndirect(mode, GL_UNSIGNED_SHORT, reinterpret_cast<const void*>(a.offset),
+                                         static_cast<GLsizei>(pending_.size()), 0);
+        ++stats_.calls;
+        ++stats_.multiDraws;
+    } else {
+        // One draw, no indirect support, or this frame's slice is full.
+        for (const DrawElementsIndirectCommand& d : pending_) {
+            glDrawElementsInstancedBaseVertex(
+                mode, static_cast<GLsizei>(d.count), GL_UNSIGNED_SHORT,
+                reinterpret_cast<const void*>(static_cast<std::uintptr_t>(d.firstIndex) * sizeof(std::uint16_t)),
+                static_cast<GLsizei>(d.instanceCount), d.baseVertex);
+            ++stats_.calls;
+        }
+    }
+    pending_.clear();
+}
+
+void MultiDraw::endFrame() {
+    if (indirect_) {
+        commands_.endFrame();
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "render/mesh_pool.h"
+#include "render/stream_buffer.h"
+
+// The record glMultiDrawElementsIndirect reads, one per draw (the layout is fixed by GL).
+struct DrawElementsIndirectCommand {
+    GLuint count;                      // indices
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;               // 0: the GL 3.3 fallback can't offset instances
+};
+static_assert(sizeof(DrawElementsIndirectCommand) == 20, "DrawElementsIndirectCommand is read by the GPU");
+
+// MultiDraw
+// ---------
+// Indexed draws that share one VAO and all other state, collected and then issued
+// together: the meshes of a MeshPool (render/mesh_pool.h) or the chunks of a Tilemap.
+//
+//     draws.add(vao, mesh);              // any number, same state
+//     draws.flush();                     // before the next state change
+//
+// | Driver                                  | flush() issues                                |
+// | --------------------------------------- | --------------------------------------------- |
+// | GL 4.3 / ARB_multi_draw_indirect        | the records into this frame's slice of a      |
+// | (glext::caps().multiDrawIndirect)       | GL_DRAW_INDIRECT_BUFFER stream, then ONE      |
+// |                                         | glMultiDrawElementsIndirect for all of them   |
+// | plain GL 3.3                            | one glDrawElementsInstancedBaseVertex each    |
+//
+// Either way the VAO is bound once per flush. The indirect path costs one call however
+// many draws there are; what it saves is the per-call driver validation, so it pays off
+// from a handful of draws on. add() with a different VAO flushes the pending ones first.
+// Indices are GL_UNSIGNED_SHORT, like every MeshPool's.
+class MultiDraw {
+public:
+    struct Stats {
+        std::uint64_t draws = 0;           // add() calls
+        std::uint64_t calls = 0;           // GL draw calls they became
+        std::uint64_t multiDraws = 0;      // ... of which glMultiDrawElementsIndirect
+    };
+
+    MultiDraw() = default;
+    MultiDraw(const MultiDraw&) = delete;
+    MultiDraw& operator=(const MultiDraw&) = delete;
+
+    // GL thread. Without multi-draw indirect support (or with `allowIndirect` false)
+    // every flush loops instead; at most `maxDrawsPerFrame` go through the indirect buffer
+    // per frame, the rest loop too.
+    void init(std::size_t maxDrawsPerFrame = 4096, bool allowIndirect = true);
+    void shutdown();
+
+    void add(GLuint vao, const Mesh& mesh, GLsizei instances = 1);
+    void flush(GLenum mode = GL_TRIANGLES);
+    // After the frame's last flush: fences this frame's slice of the indirect buffer.
+    void endFrame();
+
+    bool indirect() const { return indirect_; }
+    std::size_t pending() const { return pending_.size(); }
+    const Stats& stats() const { return stats_; }
+    void resetStats() { stats_ = Stats{}; }
+
+private:
+    std::vector<DrawElementsIndirectCommand> pending_;
+    GLuint vao_ = 0;                   // of the pending draws
+    StreamBuffer commands_;            // GL_DRAW_INDIRECT_BUFFER; unused when !indirect_
+    bool indirect_ = false;
+    Stats stats_;
+};
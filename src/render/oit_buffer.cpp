@@ -0,0 +1,114 @@
+#include "render/oit_buffer.h"
+
+#include <iostream>
+
+#include "render/gl_framebuffer.h"
+#include "render/gl_state.h"
+#include "render/gpu_memory.h"
+
+namespace {
+
+GlTexture createTarget(GLenum format, GLenum components, int width, int height) {
+    GlTexture texture = GlTexture::create();
+    glstate::activeTexture(GL_TEXTURE0);
+    glstate::bindTexture(GL_TEXTURE_2D, texture.get());
+    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, components, GL_HALF_FLOAT, nullptr);
+    gpumemory::track(GlObject::Texture, texture.get(), gpumemory::textureBytes(format, width, height),
+                     gpumemory::Category::RenderTarget);
+    // texelFetch only: one texel per scene pixel.
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glstate::bindTexture(GL_TEXTURE_2D, 0);
+    return texture;
+}
+
+} // namespace
+
+bool OitBuffer::init() {
+    shutdown();
+    fullscreenVao_ = GlVertexArray::create();
+    return true;
+}
+
+void OitBuffer::shutdown() {
+    framebuffer_.reset();
+    accum_.reset();
+    weight_.reset();
+    fullscreenVao_.reset();
+    depth_ = 0;
+    complete_ = false;
+    stats_ = Stats{};
+}
+
+bool OitBuffer::begin(const RenderTarget& scene) {
+    if (!initialized() || scene.multisampled() || scene.depthBuffer() == 0) {
+        return false;
+    }
+    if (scene.width() != stats_.width || scene.height() != stats_.height || scene.depthBuffer() != depth_) {
+        const gpumemory::Owner owner("oit");
+        depth_ = scene.depthBuffer();
+        allocate(scene.width(), scene.height());
+        // The scene's format decides the attachment point: its stencil comes along.
+        const GLenum format = scene.desc().depthFormat;
+        const bool stencil = format == GL_DEPTH24_STENCIL8 || format == GL_DEPTH32F_STENCIL8;
+        glstate::bindFramebuffer(GL_FRAMEBUFFER, framebuffer_.get());
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, stencil ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT,
+                                  GL_RENDERBUFFER, depth_);
+        const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+        glstate::bindFramebuffer(GL_FRAMEBUFFER, 0);
+        complete_ = status == GL_FRAMEBUFFER_COMPLETE;
+        if (!complete_) {
+            std::cerr << "OitBuffer: " << scene.width() << "x" << scene.height() << " incomplete (status 0x"
+                      << std::hex << status << std::dec << ")\n";
+        }
+    }
+    return complete_;
+}
+
+// New names rather than re-specifying the old ones, as RenderTarget does: a frame still
+// in flight may be reading them.
+void OitBuffer::allocate(int width, int height) {
+    framebuffer_ = GlFramebuffer::create();
+    accum_ = createTarget(GL_RGBA16F, GL_RGBA, width, height);
+    weight_ = createTarget(GL_R16F, GL_RED, width, height);
+    glstate::bindFramebuffer(GL_FRAMEBUFFER, framebuffer_.get());
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, accum_.get(), 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, weight_.get(), 0);
+    const GLenum buffers[2] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1};
+    glDrawBuffers(2, buffers);         // framebuffer state: set once
+    glstate::bindFramebuffer(GL_FRAMEBUFFER, 0);
+    stats_.width = width;
+    stats_.height = height;
+    stats_.bytes = gpumemory::textureBytes(GL_RGBA16F, width, height) + gpumemory::textureBytes(GL_R16F, width, height);
+}
+
+void OitBuffer::accumulate(const glm::ivec4& viewRect) {
+    if (!complete_) {
+        return;
+    }
+    glstate::bindFramebuffer(GL_FRAMEBUFFER, framebuffer_.get());
+    glstate::viewport(viewRect.x, viewRect.y, viewRect.z, viewRect.w);
+    const GLfloat nothing[4] = {0.0f, 0.0f, 0.0f, 1.0f};    // revealage 1: all of the scene shows
+    const GLfloat noWeight[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    glframebuffer::Scissor scissor(viewRect, stats_.width, stats_.height);   // none for a single view
+    glClearBufferfv(GL_COLOR, 0, nothing);
+    glClearBufferfv(GL_COLOR, 1, noWeight);
+}
+
+void OitBuffer::composite(GLuint framebuffer, const glm::ivec4& viewRect) {
+    if (!complete_) {
+        return;
+    }
+    glstate::bindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glstate::viewport(viewRect.x, viewRect.y, viewRect.z, viewRect.w);
+    glstate::activeTexture(kWeightUnit);
+    glstate::bindTexture(GL_TEXTURE_2D, weight_.get());
+    glstate::activeTexture(GL_TEXTURE0);
+    glstate::enable(GL_BLEND);
+    glstate::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);   // alpha: the coverage
+    glstate::bindVertexArray(fullscreenVao_.get());
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glstate::disable(GL_BLEND);
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+
+#include "render/gl_resource.h"
+#include "render/render_target.h"
+#include "render/shader_layout.h"
+
+// OitBuffer
+// ---------
+// Weighted blended order-independent transparency (McGuire & Bavoil 2013) for the
+// translucent sprites: drawn in any order, in as few draws as their state allows, with
+// no per-frame sort. Each view's translucent quads go into two targets the scene's size,
+// sharing its depth buffer (so opaque sprites still hide them), then one full-screen
+// triangle blends the result over the scene:
+//
+//     translucent quads ─▶ ACCUM   RGBA16F: rgb += colour x alpha x w, a *= 1 - alpha
+//                      └─▶ WEIGHT  R16F:    r += alpha x w
+//     composite: colour = accum.rgb / weight, coverage = 1 - accum.a, over the scene
+//
+// w favours what is nearer and more opaque, so the average leans the way a sorted
+// blend would; where translucent layers of very different colours overlap it is an
+// approximation. Both targets take the one blend state blend::kOitAccumulate (colours
+// added, alpha multiplied: GL 3.3 has no per-target blending), which is why the
+// revealage rides in ACCUM's alpha.
+//
+// | Per view, n translucent quads | Sorted (alpha blend)           | OitBuffer                   |
+// | ----------------------------- | ------------------------------ | --------------------------- |
+// | CPU                           | n keys radix-sorted            | no sort                     |
+// | draws                         | 1 (in sorted order)            | 1, any order + 1 composite  |
+// | overlaps                      | exact                          | weighted average: close for |
+// |                               |                                | similar colours or alphas   |
+//
+//     oit.begin(*scene);                        // once per frame; false: sort instead
+//     per view: oit.accumulate(viewRect);
+//               the translucent draw: fragment.glsl OIT, blend::kOitAccumulate
+//               composite program + texture(), oit.composite(sceneFramebuffer, viewRect);
+//
+// Programs: the layered program + OIT for the quads; fullscreen_vertex.glsl +
+// fragment.glsl OIT + COMPOSITE for the composite, whose two samplers' units are the
+// GLSL's (uAccum 0, uAccumWeight kWeightUnit): nothing to set after a link. The scene
+// must be single-sampled with depth: a multisampled depth buffer can't be shared with
+// single-sampled targets.
+class OitBuffer {
+public:
+    static constexpr GLenum kWeightUnit = GL_TEXTURE0 + shaderlayout::fragment::uAccumWeight.binding;
+
+    struct Stats {
+        int width = 0, height = 0;
+        std::size_t bytes = 0;         // both targets
+    };
+
+    OitBuffer() = default;
+    OitBuffer(const OitBuffer&) = delete;
+    OitBuffer& operator=(const OitBuffer&) = delete;
+
+    bool init();
+    void shutdown();
+
+    // Once per frame: the targets resized to `scene` and its depth attached. false: not
+    // usable this frame (multisampled, no depth, or the framebuffer incomplete).
+    bool begin(const RenderTarget& scene);
+    // The view's part of both targets cleared (ACCUM to (0, 0, 0, 1): nothing covered);
+    // leaves their framebuffer bound, both outputs drawn to, the viewport the view's.
+    void accumulate(const glm::ivec4& viewRect);
+    // With the composite program bound (CommandContext::useProgram: no depth test) and
+    // texture() on unit 0: `framebuffer` and its viewRect bound again, the weights on
+    // kWeightUnit, the result blended over it. Blending is left off.
+    void composite(GLuint framebuffer, const glm::ivec4& viewRect);
+
+    bool initialized() const { return fullscreenVao_.get() != 0; }
+    GLuint texture() const { return accum_.get(); }
+    const Stats& stats() const { return stats_; }
+
+private:
+    void allocate(int width, int height);
+
+    GlFramebuffer framebuffer_;
+    GlTexture accum_;
+    GlTexture weight_;
+    GlVertexArray fullscreenVao_;      // empty: fullscreen_vertex.glsl makes its positions
+    GLuint depth_ = 0;                 // the scene depth buffer attached
+    bool complete_ = false;
+    Stats stats_;
+};
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include "core/batch_transform.h"
+
+// Ortho2D
+// -------
+// The orthographic camera's matrices as what they really are: a scale and an offset per
+// axis. glm::ortho(l, r, b, t) and translate(-position) are 4x4s with 5 and 3 interesting
+// numbers; multiplying them (or inverting the product) generically is 64 multiply-adds
+// (or a full 4x4 inverse) for what is two FMAs per axis here:
+//
+//     clip.x = scaleX * p.x + offsetX
+//     clip.y = scaleY * p.y + offsetY
+//     clip.z = scaleZ * p.z                (-1 for a projection, as glm::ortho)
+//
+// | Operation            | Cost                                        |
+// | -------------------- | ------------------------------------------- |
+// | a * b (compose)      | 3 multiplies, 2 FMAs                        |
+// | inverse()            | 3 divides, 2 multiplies                     |
+// | apply(point)         | 2 FMAs                                      |
+// | apply(Affine2D)      | 6 multiplies, 2 adds: ortho * view * model  |
+// | toMat4()             | no math: the matrix, for the camera UBO     |
+//
+// Everything but toMat4 and the glm::vec2 overload is constexpr, so a fixed camera (a
+// minimap, a HUD) can be built at compile time. Camera keeps one per orthographic view
+// and projection; the render thread expands them when it uploads the camera block.
+struct Ortho2D {
+    float scaleX = 1.0f, scaleY = 1.0f, scaleZ = 1.0f;
+    float offsetX = 0.0f, offsetY = 0.0f;
+
+    // glm::ortho(-halfWidth, halfWidth, -halfHeight, halfHeight) around the origin.
+    static constexpr Ortho2D projection(float halfWidth, float halfHeight) {
+        return Ortho2D{1.0f / halfWidth, 1.0f / halfHeight, -1.0f, 0.0f, 0.0f};
+    }
+    // translate(identity, vec3(x, y, 0)).
+    static constexpr Ortho2D translation(float x, float y) { return Ortho2D{1.0f, 1.0f, 1.0f, x, y}; }
+
+    // this * other: other first, then this (matrix order).
+    constexpr Ortho2D operator*(const Ortho2D& other) const {
+        return Ortho2D{scaleX * other.scaleX, scaleY * other.scaleY, scaleZ * other.scaleZ,
+                       scaleX * other.offsetX + offsetX, scaleY * other.offsetY + offsetY};
+    }
+    constexpr Ortho2D inverse() const {
+        return Ortho2D{1.0f / scaleX, 1.0f / scaleY, 1.0f / scaleZ, -offsetX / scaleX, -offsetY / scaleY};
+    }
+
+    glm::vec2 apply(const glm::vec2& p) const { return glm::vec2(scaleX * p.x + offsetX, scaleY * p.y + offsetY); }
+    // this * model for a flat model transform: its rows, mapped to clip space.
+    Affine2D apply(const Affine2D& model) const {
+        return Affine2D{glm::vec3(scaleX * model.row0.x, scaleX * model.row0.y, scaleX * model.row0.z + offsetX),
+                        glm::vec3(scaleY * model.row1.x, scaleY * model.row1.y, scaleY * model.row1.z + offsetY)};
+    }
+
+    glm::mat4 toMat4() const {
+        glm::mat4 m(1.0f);
+        m[0][0] = scaleX;
+        m[1][1] = scaleY;
+        m[2][2] = scaleZ;
+        m[3][0] = offsetX;
+        m[3][1] = offsetY;
+        return m;
+    }
+};
+
+static_assert((Ortho2D::projection(2.0f, 1.0f) * Ortho2D::translation(-1.0f, 0.0f)).offsetX == -0.5f,
+              "Ortho2D must compose at compile time");
@@ -0,0 +1,169 @@
+#include "render/overdraw.h"
+
+#include <algorithm>
+#include <cstring>
+#include <ostream>
+
+#include "render/gl_state.h"
+#include "render/gl_stall.h"
+#include "render/gpu_memory.h"
+#include "render/render_target.h"
+#include "render/shader_layout.h"
+
+namespace {
+
+// Count 1 (drawn once, no overdraw) dark blue, through cyan, green, yellow and red, to
+// white at kHeatLevels and over.
+constexpr float kHeat[OverdrawMeter::kHeatLevels][3] = {
+    {0.0f, 0.0f, 0.5f}, {0.0f, 0.3f, 1.0f}, {0.0f, 0.8f, 0.8f}, {0.0f, 0.8f, 0.0f},
+    {0.9f, 0.9f, 0.0f}, {1.0f, 0.5f, 0.0f}, {1.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 1.0f},
+};
+constexpr float kHeatAlpha = 0.6f;  // the scene stays recognisable underneath
+
+} // namespace
+
+bool OverdrawMeter::parse(const char* text, Count& count) {
+    if (std::strcmp(text, "rasterized") == 0) {
+        count = Count::Rasterized;
+    } else if (std::strcmp(text, "shaded") == 0) {
+        count = Count::Shaded;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* OverdrawMeter::name(Count count) {
+    return count == Count::Shaded ? "shaded" : "rasterized";
+}
+
+void OverdrawMeter::init(Count count) {
+    shutdown();
+    count_ = count;
+    vao_ = GlVertexArray::create();
+}
+
+void OverdrawMeter::shutdown() {
+    if (fence_) {
+        glDeleteSync(fence_);
+        fence_ = nullptr;
+    }
+    pixels_.reset();
+    capacity_ = 0;
+    vao_.reset();
+    heatProgram_ = 0;
+    colorLocation_ = -1;
+    frame_ = 0;
+    stats_ = Stats{};
+}
+
+void OverdrawMeter::begin() {
+    glStencilMask(0xff);
+    glClearStencil(0);
+    glClear(GL_STENCIL_BUFFER_BIT);
+    glstate::enable(GL_STENCIL_TEST);
+    glStencilFunc(GL_ALWAYS, 0, 0xff);
+    glStencilOp(GL_KEEP, count_ == Count::Shaded ? GL_KEEP : GL_INCR, GL_INCR);
+}
+
+void OverdrawMeter::end(const RenderTarget& target) {
+    glstate::disable(GL_STENCIL_TEST);
+    collect();
+    if (!fence_ && frame_ % kReadbackInterval == 0 && !target.multisampled()) {
+        request(target);
+    }
+    ++frame_;
+}
+
+void OverdrawMeter::drawHeatmap(GLuint program) {
+    if (program == 0) {
+        return;
+    }
+    glstate::useProgram(program);
+    if (program != heatProgram_) {    // first call, or a reloaded program
+        heatProgram_ = program;
+        colorLocation_ = glGetUniformLocation(program, shaderlayout::fullscreen_vertex::uColor.name);
+    }
+    glstate::bindVertexArray(vao_.get());
+    glstate::enable(GL_BLEND);
+    glstate::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glstate::enable(GL_STENCIL_TEST);
+    glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+    for (int level = 1; level <= kHeatLevels; ++level) {
+        // GL_LEQUAL passes where ref <= stencil: the last level takes everything above.
+        glStencilFunc(level < kHeatLevels ? GL_EQUAL : GL_LEQUAL, level, 0xff);
+        const float* c = kHeat[level - 1];
+        glUniform4f(colorLocation_, c[0], c[1], c[2], kHeatAlpha);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+    }
+    glstate::disable(GL_STENCIL_TEST);
+    glstate::disable(GL_BLEND);
+}
+
+void OverdrawMeter::report(std::ostream& out) const {
+    out << "overdraw (" << name(count_) << ") " << stats_.average << " per pixel, " << stats_.averageCovered
+        << " where drawn, max " << stats_.max << ", " << static_cast<int>(stats_.covered * 100.0f + 0.5f)
+        << "% covered, " << stats_.readbacks << " readbacks\n";
+}
+
+void OverdrawMeter::request(const RenderTarget& target) {
+    const gpumemory::Owner owner("overdraw");
+    const std::size_t bytes = static_cast<std::size_t>(target.width()) * static_cast<std::size_t>(target.height());
+    if (bytes == 0) {
+        return;
+    }
+    if (!pixels_ || capacity_ < bytes) {
+        pixels_ = GlBuffer::create();
+        glstate::bindBuffer(GL_PIXEL_PACK_BUFFER, pixels_.get());
+        glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(bytes), nullptr, GL_STREAM_READ);
+        gpumemory::trackBuffer(GL_PIXEL_PACK_BUFFER, pixels_.get(), bytes);
+        capacity_ = bytes;
+    } else {
+        glstate::bindBuffer(GL_PIXEL_PACK_BUFFER, pixels_.get());
+    }
+    glstate::bindFramebuffer(GL_READ_FRAMEBUFFER, target.framebuffer());
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);  // one byte per pixel: rows are not padded
+    {
+        const glstall::Wait wait("overdraw readback");
+        glReadPixels(0, 0, target.width(), target.height(), GL_STENCIL_INDEX, GL_UNSIGNED_BYTE, nullptr);
+    }
+    glstate::bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    fence_ = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    readWidth_ = target.width();
+    readHeight_ = target.height();
+}
+
+void OverdrawMeter::collect() {
+    if (!fence_ || glClientWaitSync(fence_, 0, 0) == GL_TIMEOUT_EXPIRED) {
+        return;
+    }
+    glDeleteSync(fence_);
+    fence_ = nullptr;
+    const std::size_t pixels = static_cast<std::size_t>(readWidth_) * static_cast<std::size_t>(readHeight_);
+    glstate::bindBuffer(GL_PIXEL_PACK_BUFFER, pixels_.get());
+    const std::uint8_t* counts = nullptr;
+    {
+        const glstall::Wait wait("overdraw map");
+        counts = static_cast<const std::uint8_t*>(
+            glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(pixels), GL_MAP_READ_BIT));
+    }
+    if (counts) {
+        std::uint64_t sum = 0;
+        std::size_t covered = 0;
+        int max = 0;
+        for (std::size_t i = 0; i < pixels; ++i) {
+            const int n = counts[i];
+            sum += static_cast<std::uint64_t>(n);
+            covered += n > 0;
+            max = std::max(max, n);
+        }
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        stats_.average = static_cast<float>(static_cast<double>(sum) / static_cast<double>(pixels));
+        stats_.averageCovered =
+            covered > 0 ? static_cast<float>(static_cast<double>(sum) / static_cast<double>(covered)) : 0.0f;
+        stats_.max = max;
+        stats_.covered = static_cast<float>(static_cast<double>(covered) / static_cast<double>(pixels));
+        ++stats_.readbacks;
+    }
+    glstate::bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+
+#include "render/gl_resource.h"
+
+class RenderTarget;
+
+// OverdrawMeter
+// -------------
+// Debug measurement of fill-rate pressure (--overdraw): how many fragments each pixel of
+// the scene received this frame, as numbers and as a heatmap over the scene.
+//
+// The counter is the scene target's stencil buffer (the GL_DEPTH24_STENCIL8 it already
+// has): with the stencil test on, GL_ALWAYS and GL_INCR, every fragment of every draw
+// adds one to its pixel, whatever program, blend state or colour mask the draw sets.
+// Counting in colour instead (additive blending into an R16F target) would need every
+// fragment shader to write a constant and every command's blend state overridden.
+//
+// | Count      | --overdraw=  | sfail, dpfail, dppass | counts                            |
+// | ---------- | ------------ | --------------------- | --------------------------------- |
+// | Rasterized | (default)    | KEEP, INCR, INCR      | every fragment, occluded or not   |
+// | Shaded     | shaded       | KEEP, KEEP, INCR      | those that pass the depth test:   |
+// |            |              |                       | what depth rejection leaves       |
+//
+// On the Layered path (opaque quads front to back with depth writes) the difference
+// between the two is what the depth-sorted opaque pass saves. Discarded fragments (alpha
+// cutoff) count in neither. Counts saturate at 255.
+//
+//     overdraw.begin();                 // scene target bound and cleared
+//     ... the scene's draws ...
+//     overdraw.end(*scene);             // stop counting, maybe start a readback
+//     overdraw.drawHeatmap(program);    // over the scene, before it is presented
+//
+// Every kReadbackInterval frames the stencil is copied into a pixel pack buffer
+// (glReadPixels GL_STENCIL_INDEX); a later end() maps it once its fence has passed, so
+// the numbers are a few frames old but never stall the GPU. The scene must be single-
+// sampled for that: main turns MSAA off in this mode.
+class OverdrawMeter {
+public:
+    enum class Count : std::uint8_t { Rasterized, Shaded };
+
+    static constexpr int kReadbackInterval = 30;  // frames
+    static constexpr int kHeatLevels = 8;         // 1, 2, ... 7, and 8 or more
+
+    struct Stats {
+        float average = 0.0f;          // fragments per pixel, over the whole target
+        float averageCovered = 0.0f;   // ... over the pixels that got at least one
+        int max = 0;
+        float covered = 0.0f;          // fraction of pixels with at least one
+        std::uint64_t readbacks = 0;   // since init
+    };
+
+    OverdrawMeter() = default;
+    OverdrawMeter(const OverdrawMeter&) = delete;
+    OverdrawMeter& operator=(const OverdrawMeter&) = delete;
+
+    // "rasterized" or "shaded"; false if it is neither.
+    static bool parse(const char* text, Count& count);
+    static const char* name(Count count);
+
+    // GL thread.
+    void init(Count count);
+    void shutdown();
+
+    // The scene target bound: zeroes its stencil and counts from here on.
+    void begin();
+    // Stops counting; collects a finished readback, and starts one every kReadbackInterval.
+    void end(const RenderTarget& target);
+    // One full-screen triangle per heat level, stencil-tested to the pixels with that
+    // count, blended over the bound target. `program`: fullscreen_vertex.glsl + fragment.glsl
+    // VERTEX_COLOR (uColor).
+    void drawHeatmap(GLuint program);
+
+    bool enabled() const { return vao_.get() != 0; }
+    Count count() const { return count_; }
+    const Stats& stats() const { return stats_; }
+    void report(std::ostream& out) const;
+
+private:
+    void request(const RenderTarget& target);
+    void collect();
+
+    Count count_ = Count::Rasterized;
+    GlVertexArray vao_;                // empty: the vertex shader makes its positions
+    GLuint heatProgram_ = 0;           // colorLocation_ is this program's
+    GLint colorLocation_ = -1;
+
+    GlBuffer pixels_;                  // GL_PIXEL_PACK_BUFFER, capacity_ bytes
+    std::size_t capacity_ = 0;
+    GLsync fence_ = nullptr;           // the readback in flight; null: none
+    int readWidth_ = 0;
+    int readHeight_ = 0;
+    std::uint64_t frame_ = 0;
+    Stats stats_;
+};
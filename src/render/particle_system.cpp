@@ -0,0 +1,194 @@
+#include "render/particle_system.h"
+
+#include <algorithm>
+
+#include "render/gl_ext.h"
+#include "render/gl_buffer.h"
+#include "render/gl_state.h"
+#include "render/gpu_memory.h"
+#include "render/multi_draw.h"
+
+namespace {
+
+namespace input = shaderlayout::particle_update;
+namespace instance = shaderlayout::vertex;
+namespace cull = shaderlayout::particle_cull;
+
+// The update pass reads every field per vertex (particle_update.glsl)...
+const VertexLayout kStateLayout(sizeof(ParticleSystem::Particle), {
+    shaderInput(input::aPosition, 2, GL_FLOAT, VertexAttribute::Kind::Float,
+                offsetof(ParticleSystem::Particle, position)),
+    shaderInput(input::aVelocity, 2, GL_FLOAT, VertexAttribute::Kind::Float,
+                offsetof(ParticleSystem::Particle, velocity)),
+    shaderInput(input::aAge, 1, GL_FLOAT, VertexAttribute::Kind::Float, offsetof(ParticleSystem::Particle, age)),
+    shaderInput(input::aLifetime, 1, GL_FLOAT, VertexAttribute::Kind::Float,
+                offsetof(ParticleSystem::Particle, lifetime)),
+});
+
+// ... the draw reads position and (age, lifetime) per instance (vertex.glsl PARTICLES).
+const VertexLayout kInstanceLayout(sizeof(ParticleSystem::Particle), {
+    shaderInput(instance::aParticlePos, 2, GL_FLOAT, VertexAttribute::Kind::Float,
+                offsetof(ParticleSystem::Particle, position), 1),
+    shaderInput(instance::aParticleAge, 2, GL_FLOAT, VertexAttribute::Kind::Float,
+                offsetof(ParticleSystem::Particle, age), 1),
+});
+
+// The cull pass's output: position and (age, lifetime), 16 bytes per visible particle.
+const VertexLayout kVisibleLayout(cull::VisibleList::visibleStride, {
+    shaderInput(instance::aParticlePos, 2, GL_FLOAT, VertexAttribute::Kind::Float, 0, 1),
+    shaderInput(instance::aParticleAge, 2, GL_FLOAT, VertexAttribute::Kind::Float, 2 * sizeof(float), 1),
+});
+
+// particle_cull.glsl reads the state and writes the command in place.
+static_assert(sizeof(ParticleSystem::Particle) == cull::State::particlesStride,
+              "Particle must match the std430 Particle");
+static_assert(sizeof(DrawElementsIndirectCommand) == cull::Command::kSize, "the Command block is the indirect command");
+
+} // namespace
+
+std::vector<std::string> ParticleSystem::feedbackVaryings() {
+    return {"tfPosition", "tfVelocity", "tfAge", "tfLifetime"};
+}
+
+bool ParticleSystem::init(std::size_t count, VertexArrayCache& vaos, const MeshPool& meshes, const Mesh& quad,
+                          float emitSeconds) {
+    const gpumemory::Owner owner("particles");
+    shutdown();
+    if (count == 0) {
+        return false;
+    }
+    // Everything waits at the origin with a staggered negative age: the first particles
+    // are emitted on the first update, the last ones emitSeconds later.
+    std::vector<Particle> initial(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        const float spread = static_cast<float>(i + 1) / static_cast<float>(count);
+        initial[i] = Particle{glm::vec2(0.0f), glm::vec2(0.0f), -spread * emitSeconds, 1.0f};
+    }
+    const GLsizeiptr bytes = static_cast<GLsizeiptr>(count * sizeof(Particle));
+    vaos_ = &vaos;
+    meshes_ = &meshes;
+    quad_ = quad;
+    for (int i = 0; i < 2; ++i) {
+        state_[i] = GlBuffer::create();
+        // Written and read by the GPU only.
+        glbuffer::data(GL_ARRAY_BUFFER, state_[i].get(), bytes, initial.data(), GL_DYNAMIC_COPY);
+
+        updateVao_[i] = vaos.get({{&kStateLayout, state_[i].get()}});
+        drawVao_[i] = vaos.get({{&meshes.layout(), meshes.vertexBuffer()}, {&kInstanceLayout, state_[i].get()}},
+                               meshes.indexBuffer());
+    }
+    current_ = 0;
+    stats_.count = count;
+    stats_.bufferBytes = 2 * static_cast<std::size_t>(bytes);
+    return true;
+}
+
+void ParticleSystem::shutdown() {
+    for (int i = 0; i < 2; ++i) {
+        if (vaos_ != nullptr) {
+            vaos_->forget(state_[i].get());     // before the name can be reused
+        }
+        drawVao_[i] = updateVao_[i] = 0;
+        state_[i].reset();
+    }
+    if (vaos_ != nullptr) {
+        vaos_->forget(visible_.get());
+    }
+    visible_.reset();
+    indirect_.reset();
+    cullVao_ = 0;
+    culled_ = false;
+    vaos_ = nullptr;
+    meshes_ = nullptr;
+    time_ = 0.0f;
+    stats_ = Stats{};
+}
+
+bool ParticleSystem::enableCulling() {
+    const gpumemory::Owner owner("particles");
+    if (stats_.count == 0 || !glext::caps().computeShader || !glext::caps().drawIndirect) {
+        return false;
+    }
+    if (!visible_) {
+        const GLsizeiptr bytes = static_cast<GLsizeiptr>(stats_.count * kVisibleLayout.stride());
+        visible_ = GlBuffer::create();
+        glbuffer::data(GL_ARRAY_BUFFER, visible_.get(), bytes, nullptr, GL_DYNAMIC_COPY);   // GPU to GPU only
+        indirect_ = GlBuffer::create();
+        glbuffer::data(GL_DRAW_INDIRECT_BUFFER, indirect_.get(), sizeof(DrawElementsIndirectCommand), nullptr,
+                       GL_DYNAMIC_DRAW);
+        cullVao_ = vaos_->get({{&meshes_->layout(), meshes_->vertexBuffer()}, {&kVisibleLayout, visible_.get()}},
+                              meshes_->indexBuffer());
+        stats_.bufferBytes += static_cast<std::size_t>(bytes);
+    }
+    stats_.culling = true;
+    return true;
+}
+
+void ParticleSystem::update(const ShaderProgram& program, float dt, const glm::vec2& emitter) {
+    if (stats_.count == 0 || program.id() == 0) {
+        return;
+    }
+    time_ += dt;
+    program.use();
+    program.set(shaderlayout::particle_update::uDeltaTime, dt);
+    program.set(shaderlayout::particle_update::uTime, time_);
+    program.set(shaderlayout::particle_update::uEmitter, emitter);
+    program.set(shaderlayout::particle_update::uGravity, gravity_);
+
+    const int next = 1 - current_;
+    glstate::enable(GL_RASTERIZER_DISCARD);       // vertex stage only: no fragments
+    glstate::bindVertexArray(updateVao_[current_]);
+    glstate::bindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, state_[next].get());
+    glBeginTransformFeedback(GL_POINTS);
+    glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(stats_.count));
+    glEndTransformFeedback();
+    glstate::bindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0); // draw() reads it as instances
+    glstate::disable(GL_RASTERIZER_DISCARD);
+    current_ = next;
+    ++stats_.updates;
+}
+
+void ParticleSystem::cull(const ShaderProgram& program, const CullRect& view) {
+    if (!stats_.culling || program.id() == 0) {
+        return;
+    }
+    // A fresh command with no instances: the dispatch counts them in.
+    const DrawElementsIndirectCommand command{static_cast<GLuint>(quad_.indexCount), 0u,
+                                              static_cast<GLuint>(quad_.firstIndex), quad_.baseVertex, 0u};
+    glstate::bindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect_.get());
+    glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, sizeof(command), &command);
+
+    program.use();
+    program.set(cull::uViewMin, view.min);
+    program.set(cull::uViewMax, view.max);
+    program.set(cull::uRadius, kCullRadius);
+    program.set(cull::uCount, static_cast<GLint>(drawn()));
+    glstate::bindBufferBase(GL_SHADER_STORAGE_BUFFER, cull::State::kBinding, state_[current_].get());
+    glstate::bindBufferBase(GL_SHADER_STORAGE_BUFFER, cull::VisibleList::kBinding, visible_.get());
+    glstate::bindBufferBase(GL_SHADER_STORAGE_BUFFER, cull::Command::kBinding, indirect_.get());
+    const GLuint groups = static_cast<GLuint>((drawn() + cull::kLocalSizeX - 1) / cull::kLocalSizeX);
+    glext::dispatchCompute(groups, 1, 1);
+    // The draw reads the list as instances and the command as its arguments.
+    glext::memoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+    culled_ = true;
+    ++stats_.culls;
+}
+
+void ParticleSystem::draw() {
+    if (stats_.count == 0) {
+        return;
+    }
+    if (culled_) {
+        culled_ = false;
+        glstate::bindVertexArray(cullVao_);
+        glstate::bindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect_.get());
+        glext::drawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_SHORT, nullptr);
+        return;
+    }
+    glstate::bindVertexArray(drawVao_[current_]);
+    MeshPool::drawInstanced(quad_, static_cast<GLsizei>(drawn()));
+}
+
+std::size_t ParticleSystem::drawn() const {
+    return std::min(stats_.count, drawLimit_);
+}
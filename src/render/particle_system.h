@@ -0,0 +1,124 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "render/culling.h"
+#include "render/gl_resource.h"
+#include "render/mesh_pool.h"
+#include "render/shader_program.h"
+#include "render/vertex_array_cache.h"
+
+// ParticleSystem
+// --------------
+// Particles simulated entirely on the GPU with transform feedback (core in GL 3.3). The
+// state lives in two buffers; each frame one update pass reads one and writes the other
+// (shaders/particle_update.glsl), and the instanced quad path draws the one just written
+// (PARTICLES variant of vertex.glsl), reading the particles as instance attributes:
+//
+// | Per frame      | CPU                                     | GPU                       |
+// | -------------- | --------------------------------------- | ------------------------- |
+// | update()       | a few uniforms, one glDrawArrays        | one vertex per particle,  |
+// |                | (GL_POINTS, rasterizer off)             | captured into the other   |
+// |                |                                         | buffer                    |
+// | draw()         | one glDrawElementsInstanced             | the usual quad instances  |
+//
+// Neither call depends on how many particles there are, and nothing is mapped or read
+// back: the CPU cost is the same for a hundred particles or a million. In exchange the
+// simulation is whatever the shader does (no game-side per-particle logic).
+//
+// Emission is part of the update: a particle past its lifetime starts over at the
+// emitter with a hashed direction, speed and lifetime, so the pool stays full.
+//
+// GPU culling (enableCulling(), GL 4.3): a compute pass between the two (shaders/
+// particle_cull.glsl) appends the live particles inside the view to a visible list and
+// counts them into a DrawElementsIndirectCommand; draw() then reads its instance count
+// from that buffer (glDrawElementsIndirect). Off-screen and dead particles cost one
+// invocation each instead of four vertices, and the count never comes back to the CPU.
+//
+// | draw() instances       | Without culling        | With culling                        |
+// | ---------------------- | ---------------------- | ----------------------------------- |
+// | how many               | all of them            | the visible ones (GPU-counted)      |
+// | read from              | state_[current]        | the visible list                    |
+// | CPU work               | one call               | one dispatch + one indirect call    |
+//
+// GL 3.3 has no way to draw a count the GPU wrote (glDrawTransformFeedbackInstanced is
+// 4.2, indirect draws 4.0), so without compute shaders every particle is drawn and the
+// clipper does the culling.
+class ParticleSystem {
+public:
+    // One particle, as both passes read it and transform feedback writes it (24 bytes).
+    struct Particle {
+        glm::vec2 position;
+        glm::vec2 velocity;
+        float age;                     // seconds; negative: not emitted yet
+        float lifetime;
+    };
+
+    struct Stats {
+        std::size_t count = 0;
+        std::uint64_t updates = 0;
+        std::size_t bufferBytes = 0;   // both state buffers (+ the visible list)
+        bool culling = false;
+        std::uint64_t culls = 0;       // cull() dispatches
+    };
+
+    // Half the width of the largest particle quad (vertex.glsl PARTICLES: 0.5 * 0.12).
+    static constexpr float kCullRadius = 0.03f;
+
+    // What the update program's ProgramDesc must capture, in Particle's order.
+    static std::vector<std::string> feedbackVaryings();
+
+    ParticleSystem() = default;
+    ParticleSystem(const ParticleSystem&) = delete;
+    ParticleSystem& operator=(const ParticleSystem&) = delete;
+
+    // GL thread. quad: the shared quad in `meshes` (vec2 at location 0). The VAOs come
+    // from `vaos`; both must outlive the system. The particles are spread over the first
+    // `emitSeconds` so they don't all start at once.
+    bool init(std::size_t count, VertexArrayCache& vaos, const MeshPool& meshes, const Mesh& quad,
+              float emitSeconds = 2.0f);
+    void shutdown();
+
+    // GL thread, after init(): the visible list and indirect command for cull(). False
+    // (and culling stays off) without glext::caps().computeShader and drawIndirect.
+    bool enableCulling();
+
+    // GL thread: one simulation step of dt seconds.
+    void update(const ShaderProgram& program, float dt, const glm::vec2& emitter);
+    // GL thread, after update(), with shaders/particle_cull.glsl: this frame's draw()
+    // draws only what is inside `view`.
+    void cull(const ShaderProgram& program, const CullRect& view);
+    // GL thread, draw program bound: every particle as one instanced quad.
+    void draw();
+
+    void setGravity(const glm::vec2& gravity) { gravity_ = gravity; }
+    // draw() (and cull()) only the first `count` particles: the quality governor's share
+    // (render/quality_governor.h). All of them are still simulated.
+    void setDrawLimit(std::size_t count) { drawLimit_ = count; }
+    const Stats& stats() const { return stats_; }
+
+private:
+    std::size_t drawn() const;
+
+    GlBuffer state_[2];
+    VertexArrayCache* vaos_ = nullptr;
+    const MeshPool* meshes_ = nullptr;
+    Mesh quad_;
+    GlBuffer visible_;                 // culling: this frame's visible particles
+    GlBuffer indirect_;                // ... and their DrawElementsIndirectCommand
+    GLuint cullVao_ = 0;               // the quad + visible_ per instance
+    bool culled_ = false;              // cull() ran since the last draw()
+    std::size_t drawLimit_ = static_cast<std::size_t>(-1);
+    GLuint updateVao_[2] = {};         // reads state_[i] per vertex
+    GLuint drawVao_[2] = {};           // the quad + state_[i] per instance
+    int current_ = 0;                  // the buffer the last update wrote
+    float time_ = 0.0f;
+    glm::vec2 gravity_{0.0f, -0.6f};
+
+    Stats stats_;
+};
@@ -0,0 +1,72 @@
+#include "render/picker.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "render/camera.h"
+#include "render/culling.h"
+
+glm::vec2 Picker::pick(Camera& camera, double x, double y, const Transforms2D& objects,
+                       std::vector<ObjectId>& hits) {
+    const glm::vec2 screen(static_cast<float>(x), static_cast<float>(y));
+    pickPath(camera, &screen, 1, objects, hits);
+    return world_[0];
+}
+
+void Picker::pickPath(Camera& camera, const glm::vec2* screen, std::size_t count, const Transforms2D& objects,
+                      std::vector<ObjectId>& hits) {
+    world_.resize(count);
+    camera.screenToWorld(screen, count, world_.data());
+    refresh(objects);
+
+    if (++path_ == 0) {                // wrapped: old stamps could collide
+        std::fill(seen_.begin(), seen_.end(), 0u);
+        path_ = 1;
+    }
+    for (const glm::vec2& point : world_) {
+        candidates_.clear();
+        index_.queryPoint(point, candidates_);
+        stats_.candidates += candidates_.size();
+        for (ObjectId id : candidates_) {
+            if (seen_[id] != path_ && covers(objects, id, point)) {
+                seen_[id] = path_;
+                hits.push_back(id);
+                ++stats_.hits;
+            }
+        }
+    }
+    stats_.points += count;
+}
+
+void Picker::overlapping(const Aabb& rect, const Transforms2D& objects, std::vector<ObjectId>& out) {
+    refresh(objects);
+    const std::size_t first = out.size();
+    index_.queryRect(rect, out);
+    std::sort(out.begin() + static_cast<std::ptrdiff_t>(first), out.end());
+    stats_.candidates += out.size() - first;
+}
+
+void Picker::refresh(const Transforms2D& objects) {
+    const std::size_t count = objects.size();
+    for (std::size_t id = count; id < bounds_.size(); ++id) {
+        index_.remove(static_cast<ObjectId>(id));   // fewer objects than last time
+    }
+    bounds_.resize(count);
+    seen_.resize(count, 0u);
+    transformBounds(objects, halfExtent_, bounds_.data());
+    for (std::size_t id = 0; id < count; ++id) {
+        index_.update(static_cast<ObjectId>(id), bounds_[id]);
+    }
+}
+
+bool Picker::covers(const Transforms2D& objects, ObjectId id, const glm::vec2& point) const {
+    // The point in the quad's own frame: undo the translation, then the rotation.
+    const float dx = point.x - objects.x[id];
+    const float dy = point.y - objects.y[id];
+    const float c = std::cos(objects.rotation[id]);
+    const float s = std::sin(objects.rotation[id]);
+    const float localX = c * dx + s * dy;
+    const float localY = -s * dx + c * dy;
+    return std::fabs(localX) <= halfExtent_ * std::fabs(objects.scaleX[id]) &&
+           std::fabs(localY) <= halfExtent_ * std::fabs(objects.scaleY[id]);
+}
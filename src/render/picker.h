@@ -0,0 +1,73 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "core/batch_transform.h"
+#include "core/uniform_grid.h"
+
+class Camera;
+
+// Picker
+// ------
+// Screen positions → the objects under them, for clicks and for whole drag paths:
+//
+//     screen points ──Camera::screenToWorld (batched; inverse cached per camera version)──▶
+//     world points ──UniformGrid::queryPoint──▶ candidates ──rotated-quad test──▶ hits
+//
+// | Step                  | Cost per pick call                                      |
+// | --------------------- | ------------------------------------------------------- |
+// | unproject             | one inverse per camera change, then ~12 FMAs per point  |
+// | refresh the index     | once per call, not per point: objects that stayed in    |
+// |                       | their cells since the last pick cost a compare each     |
+// | query                 | one grid cell per point                                 |
+// | exact test            | per candidate: the point in the quad's local frame      |
+//
+// Objects are the unit quads of main(): object i of `objects` (ids are positions, as in
+// the frame's render extraction), half extent `localHalfExtent` scaled and rotated. The
+// grid only knows bounding boxes, so candidates are checked against the actual rotated
+// quad; a click on the empty corner of a rotated quad's box no longer selects it.
+//
+// A path reports each object once, in the order the path first touched it.
+class Picker {
+public:
+    struct Stats {
+        std::uint64_t points = 0;      // unprojected and queried
+        std::uint64_t candidates = 0;  // bounding boxes under them
+        std::uint64_t hits = 0;        // ... that the quad itself covers
+    };
+
+    explicit Picker(float cellSize = 0.5f, float localHalfExtent = 0.25f)
+        : index_(cellSize), halfExtent_(localHalfExtent) {}
+
+    // One window position (pixels, origin top-left); returns the world point it hit.
+    glm::vec2 pick(Camera& camera, double x, double y, const Transforms2D& objects, std::vector<ObjectId>& hits);
+    // Every object any of the `count` positions is over (a drag path, several touches).
+    void pickPath(Camera& camera, const glm::vec2* screen, std::size_t count, const Transforms2D& objects,
+                  std::vector<ObjectId>& hits);
+
+    // Every object whose bounds overlap `rect` (no exact test), in ascending id order, which
+    // is the order the frame draws them in (candidates for GpuPicker, render/gpu_picker.h).
+    void overlapping(const Aabb& rect, const Transforms2D& objects, std::vector<ObjectId>& out);
+
+    // World points of the last pick / pickPath, and the bounds the index has for an object.
+    const std::vector<glm::vec2>& worldPoints() const { return world_; }
+    const Aabb& bounds(ObjectId id) const { return bounds_[id]; }
+
+    const Stats& stats() const { return stats_; }
+
+private:
+    void refresh(const Transforms2D& objects);
+    bool covers(const Transforms2D& objects, ObjectId id, const glm::vec2& point) const;
+
+    UniformGrid index_;
+    float halfExtent_;
+    std::vector<Aabb> bounds_;
+    std::vector<glm::vec2> world_;
+    std::vector<ObjectId> candidates_;
+    std::vector<std::uint32_t> seen_;  // per object: the path that last reported it
+    std::uint32_t path_ = 0;
+    Stats stats_;
+};
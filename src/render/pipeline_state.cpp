@@ -0,0 +1,145 @@
+#include "render/pipeline_state.h"
+
+#include <bitset>
+#include <iostream>
+
+#include "render/gl_state.h"
+
+namespace {
+
+bool validBlendFactor(GLenum factor) {
+    switch (factor) {
+    case GL_ZERO: case GL_ONE:
+    case GL_SRC_COLOR: case GL_ONE_MINUS_SRC_COLOR: case GL_DST_COLOR: case GL_ONE_MINUS_DST_COLOR:
+    case GL_SRC_ALPHA: case GL_ONE_MINUS_SRC_ALPHA: case GL_DST_ALPHA: case GL_ONE_MINUS_DST_ALPHA:
+    case GL_CONSTANT_COLOR: case GL_ONE_MINUS_CONSTANT_COLOR:
+    case GL_CONSTANT_ALPHA: case GL_ONE_MINUS_CONSTANT_ALPHA: case GL_SRC_ALPHA_SATURATE:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool validDepthFunction(GLenum function) {
+    return function >= GL_NEVER && function <= GL_ALWAYS;
+}
+
+bool sameDesc(const PipelineDesc& a, const PipelineDesc& b) {
+    return a.program == b.program && a.vertexArray == b.vertexArray && a.blend.enabled == b.blend.enabled &&
+           a.blend.source == b.blend.source && a.blend.destination == b.blend.destination &&
+           a.blend.alphaSource() == b.blend.alphaSource() &&
+           a.blend.alphaDestination() == b.blend.alphaDestination() && a.depth.test == b.depth.test && a.depth.function == b.depth.function && a.depth.write == b.depth.write &&
+           a.raster.cullFace == b.raster.cullFace;
+}
+
+} // namespace
+
+PipelineLibrary::PipelineLibrary() {
+    PipelineDesc defaults;
+    defaults.name = "default";
+    pipelines_.push_back(defaults);
+    diffs_.assign(1, 0);
+}
+
+PipelineId PipelineLibrary::create(const PipelineDesc& desc) {
+    auto reject = [&desc](const char* why) {
+        std::cerr << "Pipeline '" << desc.name << "': " << why << "\n";
+        return kDefault;
+    };
+    if (desc.program != 0) {
+        GLint linked = GL_FALSE;
+        glGetProgramiv(desc.program, GL_LINK_STATUS, &linked);
+        if (!linked) {
+            return reject("program not linked");
+        }
+    }
+    if (desc.vertexArray != 0 && !glIsVertexArray(desc.vertexArray)) {
+        return reject("not a vertex array");
+    }
+    if (!validBlendFactor(desc.blend.source) || !validBlendFactor(desc.blend.destination) ||
+        !validBlendFactor(desc.blend.alphaSource()) || !validBlendFactor(desc.blend.alphaDestination())) {
+        return reject("invalid blend factor");
+    }
+    if (!validDepthFunction(desc.depth.function)) {
+        return reject("invalid depth function");
+    }
+    // Not for unbuilt programs: a reload may give each its own.
+    for (std::size_t i = 1; i < pipelines_.size() && desc.program != 0; ++i) {
+        if (sameDesc(pipelines_[i], desc)) {
+            return static_cast<PipelineId>(i);
+        }
+    }
+    if (pipelines_.size() >= kUnknown) {
+        return reject("too many pipelines");
+    }
+    pipelines_.push_back(desc);
+    rebuildDiffs();
+    return static_cast<PipelineId>(pipelines_.size() - 1);
+}
+
+void PipelineLibrary::setProgram(PipelineId id, GLuint program) {
+    if (id == kDefault || id >= pipelines_.size() || pipelines_[id].program == program) {
+        return;
+    }
+    pipelines_[id].program = program;
+    rebuildDiffs();
+    if (current_ == id) {
+        current_ = kUnknown;           // what's bound is the old program
+    }
+}
+
+std::uint8_t PipelineLibrary::compare(const PipelineDesc& from, const PipelineDesc& to) {
+    std::uint8_t d = 0;
+    // 0 leaves the binding alone: nothing to set going there.
+    if (to.program != 0 && to.program != from.program) d |= kProgram;
+    if (to.vertexArray != 0 && to.vertexArray != from.vertexArray) d |= kVertexArray;
+    if (to.blend.enabled != from.blend.enabled) d |= kBlendEnable;
+    // The function only matters while blending is on: going to a pipeline without it
+    // leaves the old one set, and one with it compares against what was set last.
+    if (to.blend.enabled && (to.blend.source != from.blend.source || to.blend.destination != from.blend.destination ||
+                             to.blend.alphaSource() != from.blend.alphaSource() ||
+                             to.blend.alphaDestination() != from.blend.alphaDestination() || !from.blend.enabled)) {
+        d |= kBlendFunc;
+    }
+    if (to.depth.test != from.depth.test) d |= kDepthTest;
+    if (to.depth.test && (to.depth.function != from.depth.function || !from.depth.test)) d |= kDepthFunc;
+    if (to.depth.write != from.depth.write) d |= kDepthWrite;
+    if (to.raster.cullFace != from.raster.cullFace) d |= kCullFace;
+    return d;
+}
+
+void PipelineLibrary::rebuildDiffs() {
+    const std::size_t n = pipelines_.size();
+    diffs_.resize(n * n);
+    for (std::size_t from = 0; from < n; ++from) {
+        for (std::size_t to = 0; to < n; ++to) {
+            diffs_[from * n + to] = compare(pipelines_[from], pipelines_[to]);
+        }
+    }
+}
+
+void PipelineLibrary::bind(PipelineId id) {
+    if (id == current_) {
+        ++stats_.repeated;
+        return;
+    }
+    // From an unknown state everything is set (gl_state still filters what matches).
+    const std::uint8_t d = current_ == kUnknown ? kEverything : diff(current_, id);
+    const PipelineDesc& p = pipelines_[id];
+    if ((d & kProgram) && p.program != 0) glstate::useProgram(p.program);
+    if ((d & kVertexArray) && p.vertexArray != 0) glstate::bindVertexArray(p.vertexArray);
+    if (d & kBlendEnable) glstate::setEnabled(GL_BLEND, p.blend.enabled);
+    if ((d & kBlendFunc) && p.blend.enabled) {
+        glstate::blendFuncSeparate(p.blend.source, p.blend.destination, p.blend.alphaSource(),
+                                   p.blend.alphaDestination());
+    }
+    if (d & kDepthTest) glstate::setEnabled(GL_DEPTH_TEST, p.depth.test);
+    if ((d & kDepthFunc) && p.depth.test) glstate::depthFunc(p.depth.function);
+    if (d & kDepthWrite) glstate::depthMask(p.depth.write);
+    if (d & kCullFace) glstate::setEnabled(GL_CULL_FACE, p.raster.cullFace);
+    const std::size_t set = std::bitset<8>(d).count();
+    stats_.applied += set;
+    stats_.skipped += 8 - set;
+    ++stats_.binds;
+    current_ = id;
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Fixed-function state a pipeline sets. The defaults are what the renderer's ad-hoc
+// commands assume between draws: no blending, no depth test (but depth writes on, for
+// the frame's clear), no culling.
+struct BlendState {
+    bool enabled = false;
+    GLenum source = GL_ONE;
+    GLenum destination = GL_ZERO;
+    GLenum sourceAlpha = GL_NONE;      // GL_NONE: the alpha channel blends as the colour
+    GLenum destinationAlpha = GL_NONE;
+
+    GLenum alphaSource() const { return sourceAlpha == GL_NONE ? source : sourceAlpha; }
+    GLenum alphaDestination() const { return destinationAlpha == GL_NONE ? destination : destinationAlpha; }
+};
+
+struct DepthState {
+    bool test = false;
+    GLenum function = GL_LESS;
+    bool write = true;
+};
+
+struct RasterState {
+    bool cullFace = false;
+};
+
+namespace blend {
+constexpr BlendState kOpaque{};
+constexpr BlendState kAlpha{true, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA};
+constexpr BlendState kAdditive{true, GL_SRC_ALPHA, GL_ONE};
+// Weighted blended OIT's accumulation (render/oit_buffer.h): colours summed, the alpha
+// channel the product of (1 - alpha).
+constexpr BlendState kOitAccumulate{true, GL_ONE, GL_ONE, GL_ZERO, GL_ONE_MINUS_SRC_ALPHA};
+} // namespace blend
+
+// Everything a pipeline is. program / vertexArray 0: left as they are (renderers that
+// bind their own VAO per draw; a program that failed to build draws nothing anyway).
+struct PipelineDesc {
+    const char* name = "";
+    GLuint program = 0;
+    GLuint vertexArray = 0;
+    BlendState blend;
+    DepthState depth;
+    RasterState raster;
+};
+
+using PipelineId = std::uint16_t;
+
+// PipelineLibrary
+// ---------------
+// Immutable PIPELINE STATE OBJECTS: program + vertex array + blend / depth / raster
+// state, created and validated once at load time, bound as one unit at draw time:
+//
+//     PipelineId layered = pipelines.create({"layered", program, 0, blend::kAlpha,
+//                                            {true, GL_LEQUAL, true}});   // startup
+//     context.usePipeline(layered);                                       // per draw
+//
+// create() checks the desc (program linked, vertex array real, blend factors and depth
+// function valid enums) and precomputes the DIFF between the new pipeline and every
+// other one: a bit per piece of state that differs. bind(to) looks up diff(current, to)
+// and issues only those calls:
+//
+// | Bit          | Calls it stands for                    |
+// | ------------ | -------------------------------------- |
+// | Program      | glUseProgram                           |
+// | VertexArray  | glBindVertexArray                      |
+// | BlendEnable  | glEnable / glDisable(GL_BLEND)         |
+// | BlendFunc    | glBlendFunc[Separate] (if blending is) |
+// | DepthTest    | glEnable / glDisable(GL_DEPTH_TEST)    |
+// | DepthFunc    | glDepthFunc (only if the test is on)   |
+// | DepthWrite   | glDepthMask                            |
+// | CullFace     | glEnable / glDisable(GL_CULL_FACE)     |
+//
+// Binding the current pipeline again is one compare; switching between two that differ
+// only in depth writes is one glDepthMask, with no per-call comparing of eight pieces of
+// state (they still go through gl_state, which stays the source of truth for the rest).
+//
+// kDefault is the state ad-hoc code expects (the defaults above, program left alone):
+// CommandContext::useProgram binds it before a command that sets its own state, and a
+// bucket ends in it. When code outside the library changes covered state, invalidate():
+// the next bind then sets everything.
+//
+// setProgram() is for hot reload: the pipeline keeps its id, its diffs are recomputed.
+// GL thread only.
+class PipelineLibrary {
+public:
+    static constexpr PipelineId kDefault = 0;
+    static constexpr PipelineId kUnknown = 0xffff;
+
+    enum Diff : std::uint8_t {
+        kProgram = 1u << 0,
+        kVertexArray = 1u << 1,
+        kBlendEnable = 1u << 2,
+        kBlendFunc = 1u << 3,
+        kDepthTest = 1u << 4,
+        kDepthFunc = 1u << 5,
+        kDepthWrite = 1u << 6,
+        kCullFace = 1u << 7,
+        kEverything = 0xff,
+    };
+
+    struct Stats {
+        std::uint64_t binds = 0;       // that switched pipelines
+        std::uint64_t repeated = 0;    // of the current one: a compare
+        std::uint64_t applied = 0;     // pieces of state the diffs said to set
+        std::uint64_t skipped = 0;     // ... and said to leave alone
+    };
+
+    PipelineLibrary();
+    PipelineLibrary(const PipelineLibrary&) = delete;
+    PipelineLibrary& operator=(const PipelineLibrary&) = delete;
+
+    // Load time. Returns the new pipeline, or an existing one with the same desc (and a
+    // built program); an invalid desc is reported and gets kDefault.
+    PipelineId create(const PipelineDesc& desc);
+    // A rebuilt program for `id`: the diffs to and from it are recomputed. Same program:
+    // a compare.
+    void setProgram(PipelineId id, GLuint program);
+
+    // Sets what differs between the current pipeline and `id`.
+    void bind(PipelineId id);
+    // Covered state was changed behind the library's back: the next bind sets it all.
+    void invalidate() { current_ = kUnknown; }
+
+    PipelineId current() const { return current_; }
+    const PipelineDesc& desc(PipelineId id) const { return pipelines_[id]; }
+    std::uint8_t diff(PipelineId from, PipelineId to) const { return diffs_[from * pipelines_.size() + to]; }
+    std::size_t size() const { return pipelines_.size(); }
+
+    const Stats& stats() const { return stats_; }
+    void resetStats() { stats_ = Stats{}; }
+
+private:
+    static std::uint8_t compare(const PipelineDesc& from, const PipelineDesc& to);
+    void rebuildDiffs();
+
+    std::vector<PipelineDesc> pipelines_;
+    std::vector<std::uint8_t> diffs_;  // size² bits per (from, to), row-major by from
+    PipelineId current_ = kUnknown;
+    Stats stats_;
+};
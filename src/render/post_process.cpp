@@ -0,0 +1,262 @@
+#include "render/post_process.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "render/gl_framebuffer.h"
+#include "render/gl_state.h"
+#include "render/render_target.h"
+#include "render/shader_layout.h"
+
+namespace {
+
+// What each effect is made of. Its define is its per-pixel part, fused into the final
+// pass; `reduced`: it also has passes of its own at a fraction of the resolution.
+struct EffectInfo {
+    PostProcessChain::Effect effect;
+    const char* name;                  // in --post=
+    const char* define;
+    bool reduced;
+};
+
+constexpr EffectInfo kEffects[] = {
+    {PostProcessChain::kBloom, "bloom", "BLOOM", true},
+    {PostProcessChain::kColorGrade, "grade", "GRADE", false},
+    {PostProcessChain::kVignette, "vignette", "VIGNETTE", false},
+};
+
+constexpr int kBrightDivisor = 2;      // bloom's bright pass, per side
+constexpr int kBlurDivisor = 4;        // ... its blur
+// The final pass's second input, on fragment.glsl's unit for it.
+constexpr GLenum kBloomUnit = GL_TEXTURE0 + shaderlayout::fragment::uBloom.binding;
+
+int index(PostProcessChain::Program program) { return static_cast<int>(program); }
+
+} // namespace
+
+bool PostProcessChain::parse(const char* text, std::uint32_t& effects) {
+    std::uint32_t parsed = 0;
+    while (*text != '\0') {
+        const char* end = std::strchr(text, ',');
+        const std::size_t length = end ? static_cast<std::size_t>(end - text) : std::strlen(text);
+        bool known = false;
+        for (const EffectInfo& e : kEffects) {
+            if (std::strlen(e.name) == length && std::strncmp(text, e.name, length) == 0) {
+                parsed |= e.effect;
+                known = true;
+            }
+        }
+        if (!known) {
+            return false;
+        }
+        text += length + (end ? 1 : 0);
+    }
+    if (parsed == 0) {
+        return false;
+    }
+    effects = parsed;
+    return true;
+}
+
+std::string PostProcessChain::describe(std::uint32_t effects) {
+    std::string out;
+    for (const EffectInfo& e : kEffects) {
+        if (effects & e.effect) {
+            out += out.empty() ? "" : ",";
+            out += e.name;
+        }
+    }
+    return out;
+}
+
+bool PostProcessChain::uses(Program program, std::uint32_t effects) {
+    if (program == Program::Final) {
+        return effects != 0;
+    }
+    for (const EffectInfo& e : kEffects) {
+        if ((effects & e.effect) && e.reduced) {
+            return true;
+        }
+    }
+    return false;
+}
+
+ShaderVariant PostProcessChain::variant(Program program, std::uint32_t effects) {
+    ShaderVariant v{kShaderPost, {}};
+    switch (program) {
+    case Program::Bright:
+        v.defines.push_back("BRIGHT");
+        break;
+    case Program::Blur:
+        v.defines.push_back("BLUR");
+        break;
+    case Program::Final:
+        // The fusion: every effect's per-pixel part, one pass.
+        for (const EffectInfo& e : kEffects) {
+            if (effects & e.effect) {
+                v.defines.push_back(e.define);
+            }
+        }
+        break;
+    }
+    return v;
+}
+
+bool PostProcessChain::init(const Options& options) {
+    shutdown();
+    if ((options.effects & kAllEffects) == 0) {
+        return false;
+    }
+    options_ = options;
+    options_.effects &= kAllEffects;
+    vao_ = GlVertexArray::create();
+    return true;
+}
+
+void PostProcessChain::shutdown() {
+    vao_.reset();
+    for (Locations& l : locations_) {
+        l = Locations{};
+    }
+    stats_ = Stats{};
+}
+
+void PostProcessChain::setUniforms(Program program, GLuint id) {
+    glstate::useProgram(id);
+    namespace post = shaderlayout::fragment;
+    auto set1f = [id](shaderlayout::Uniform<float> uniform, float value) {
+        const GLint location = glGetUniformLocation(id, uniform.name);
+        if (location >= 0) glUniform1f(location, value);
+    };
+    set1f(post::uThreshold, options_.bloomThreshold);
+    set1f(post::uBloomIntensity, options_.bloomIntensity);
+    set1f(post::uVignette, options_.vignette);
+    const GLint grade = glGetUniformLocation(id, post::uGrade.name);
+    if (grade >= 0) {
+        glUniform3f(grade, options_.exposure, options_.contrast, options_.saturation);
+    }
+    const GLint tint = glGetUniformLocation(id, post::uGradeTint.name);
+    if (tint >= 0) {
+        glUniform3f(tint, options_.tint.r, options_.tint.g, options_.tint.b);
+    }
+    Locations& l = locations_[index(program)];
+    l.invSize = glGetUniformLocation(id, shaderlayout::fragment::uInvSize.name);
+    l.sourceTexel = glGetUniformLocation(id, shaderlayout::fragment::uSourceTexel.name);
+    l.blurStep = glGetUniformLocation(id, shaderlayout::fragment::uBlurStep.name);
+}
+
+void PostProcessChain::begin(GLuint program, GLuint source) {
+    glstate::disable(GL_BLEND);
+    glstate::bindVertexArray(vao_.get());
+    glstate::useProgram(program);
+    glstate::activeTexture(GL_TEXTURE0);
+    glstate::bindTexture(GL_TEXTURE_2D, source);
+}
+
+void PostProcessChain::pass(Program program, GLuint framebuffer, int width, int height) {
+    glframebuffer::discard(framebuffer, GL_COLOR_BUFFER_BIT);  // the triangle covers every pixel
+    glstate::bindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glstate::viewport(0, 0, width, height);
+    const Locations& l = locations_[index(program)];
+    if (l.invSize >= 0) {
+        glUniform2f(l.invSize, 1.0f / static_cast<float>(width), 1.0f / static_cast<float>(height));
+    }
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    ++stats_.passes;
+    stats_.pixels += static_cast<std::size_t>(width) * static_cast<std::size_t>(height);
+}
+
+bool PostProcessChain::addPasses(RenderGraph& graph, RenderGraph::Resource scene, RenderGraph::Resource window,
+                                 const Programs& programs, int width, int height) {
+    stats_ = Stats{};
+    const GLuint finalProgram = programs.program[index(Program::Final)];
+    if (!enabled() || finalProgram == 0) {
+        return false;
+    }
+    // The passes sample the scene: a multisampled one is resolved into a plain target first.
+    RenderGraph::Resource source = scene;
+    RenderTargetDesc sourceDesc = graph.desc(scene);
+    if (sourceDesc.samples > 1) {
+        sourceDesc.samples = 1;
+        sourceDesc.depthFormat = GL_NONE;
+        source = graph.createTarget("post resolved", sourceDesc);
+        const RenderGraph::Pass resolve = graph.addPass("post resolve", [scene, source](const RenderGraph& g) {
+            g.target(scene)->blitTo(*g.target(source));
+        });
+        graph.read(resolve, scene);
+        graph.write(resolve, source);
+    }
+
+    // Bloom at reduced resolution: bright pass, then the blur along x and along y.
+    RenderGraph::Resource bloom = RenderGraph::kNoResource;
+    const GLuint brightProgram = programs.program[index(Program::Bright)];
+    const GLuint blurProgram = programs.program[index(Program::Blur)];
+    if (uses(Program::Bright, options_.effects) && brightProgram != 0 && blurProgram != 0) {
+        RenderTargetDesc desc;
+        desc.width = std::max(1, sourceDesc.width / kBrightDivisor);
+        desc.height = std::max(1, sourceDesc.height / kBrightDivisor);
+        const RenderGraph::Resource bright = graph.createTarget("bloom bright", desc);
+        desc.width = std::max(1, sourceDesc.width / kBlurDivisor);
+        desc.height = std::max(1, sourceDesc.height / kBlurDivisor);
+        const RenderGraph::Resource blurTemp = graph.createTarget("bloom blur x", desc);
+        bloom = graph.createTarget("bloom", desc);
+
+        const RenderGraph::Pass brightPass = graph.addPass("post bright", [this, brightProgram, source,
+                                                                           bright](const RenderGraph& g) {
+            const RenderTarget& from = *g.target(source);
+            begin(brightProgram, from.colorTexture());
+            const Locations& b = locations_[index(Program::Bright)];
+            if (b.sourceTexel >= 0) {
+                glUniform2f(b.sourceTexel, 1.0f / static_cast<float>(from.width()),
+                            1.0f / static_cast<float>(from.height()));
+            }
+            pass(Program::Bright, g.framebuffer(bright), g.width(bright), g.height(bright));
+        });
+        graph.read(brightPass, source);
+        graph.write(brightPass, bright);
+
+        // Steps of one blur texel: the x pass also halves the bright target again
+        // (its bilinear fetches average 2x2 of it).
+        const RenderGraph::Pass blurX = graph.addPass("post blur x", [this, blurProgram, bright,
+                                                                     blurTemp](const RenderGraph& g) {
+            begin(blurProgram, g.target(bright)->colorTexture());
+            const Locations& u = locations_[index(Program::Blur)];
+            if (u.blurStep >= 0) {
+                glUniform2f(u.blurStep, 1.0f / static_cast<float>(g.width(blurTemp)), 0.0f);
+            }
+            pass(Program::Blur, g.framebuffer(blurTemp), g.width(blurTemp), g.height(blurTemp));
+        });
+        graph.read(blurX, bright);
+        graph.write(blurX, blurTemp);
+
+        const RenderGraph::Pass blurY = graph.addPass("post blur y", [this, blurProgram, blurTemp,
+                                                                     bloom](const RenderGraph& g) {
+            begin(blurProgram, g.target(blurTemp)->colorTexture());
+            const Locations& u = locations_[index(Program::Blur)];
+            if (u.blurStep >= 0) {
+                glUniform2f(u.blurStep, 0.0f, 1.0f / static_cast<float>(g.height(bloom)));
+            }
+            pass(Program::Blur, g.framebuffer(bloom), g.width(bloom), g.height(bloom));
+        });
+        graph.read(blurY, blurTemp);
+        graph.write(blurY, bloom);
+    }
+
+    // Everything per pixel in one pass, straight into the window (scaling included).
+    const RenderGraph::Pass finalPass = graph.addPass("post final", [this, finalProgram, source, bloom, width,
+                                                                     height](const RenderGraph& g) {
+        glstate::activeTexture(kBloomUnit);
+        glstate::bindTexture(GL_TEXTURE_2D, bloom != RenderGraph::kNoResource ? g.target(bloom)->colorTexture() : 0);
+        begin(finalProgram, g.target(source)->colorTexture());
+        pass(Program::Final, 0, width, height);
+        for (const EffectInfo& e : kEffects) {
+            stats_.fused += (options_.effects & e.effect) ? 1 : 0;
+        }
+    });
+    graph.read(finalPass, source);
+    if (bloom != RenderGraph::kNoResource) {
+        graph.read(finalPass, bloom);
+    }
+    graph.write(finalPass, window);
+    return true;
+}
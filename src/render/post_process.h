@@ -0,0 +1,139 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "render/gl_resource.h"
+#include "render/render_graph.h"
+#include "render/shader_preprocessor.h"
+
+// PostProcessChain
+// ----------------
+// Full-screen effects between the scene target and the window (--post): bloom, colour
+// grading and a vignette, for well under a millisecond at 1080p on an integrated GPU.
+// Two rules keep it that cheap:
+//
+// 1. What needs neighbourhoods runs small. Bloom's bright pass writes a 1/2 resolution
+//    target, its blur runs at 1/4 (separable, 5 bilinear taps per axis for 9 texels):
+//    a quarter and two sixteenths of the pixels, not three full screens.
+// 2. Everything per pixel is FUSED into one final pass. Each effect says which of its
+//    parts are per pixel; those become defines of a single fragment.glsl POST variant
+//    (variant(Program::Final, effects)), so grading and the vignette cost a few ALU ops
+//    in the pass that has to run anyway (it is the scene's present), not a full-screen
+//    read and write each.
+//
+//     scene ──▶ BRIGHT 1/2 ──▶ BLUR x 1/4 ──▶ BLUR y 1/4 ──┐
+//       └──────────────────────────────────────────────────┴▶ FINAL: + bloom, grade,
+//                                                              vignette ──▶ window
+//
+// | Effect    | --post= | Reduced-resolution passes       | Fused into the final pass    |
+// | --------- | ------- | ------------------------------- | ---------------------------- |
+// | Bloom     | bloom   | bright 1/2, blur x and y at 1/4 | + bloom x intensity          |
+// | ColorGrade| grade   | —                               | exposure x tint, contrast,   |
+// |           |         |                                 | saturation                   |
+// | Vignette  | vignette| —                               | darkened toward the corners  |
+//
+// | 1920x1080, everything on | Pixels | Fetches per pixel | Of a full screen           |
+// | ------------------------ | ------ | ----------------- | -------------------------- |
+// | bright (1/2)             | 518K   | 4 (bilinear)      | 0.25                       |
+// | blur x, blur y (1/4)     | 2x130K | 5 (bilinear)      | 0.125                      |
+// | final (window)           | 2.07M  | 2                 | 1                          |
+//
+// About 1.4 full-screen passes of RGBA8 traffic in all; unfused, each per-pixel effect
+// would add another full read and write. A multisampled scene is first resolved into
+// a transient target; a scaled one (--render-scale) is upscaled by the final pass's
+// bilinear fetch, which replaces RenderTargetPool::present's blit.
+//
+// Programs: fullscreen_vertex.glsl + fragment.glsl POST with BRIGHT, BLUR or the final
+// pass's fused defines (variant()); setUniforms() after each link. Each step is a pass
+// of the frame's RenderGraph (render/render_graph.h) and each intermediate one of its
+// transients, so they follow the window's size on their own and share pooled targets
+// with the rest of the frame where their lifetimes allow.
+//
+//     chain.init(options);
+//     chain.addPasses(graph, scene, window, programs, windowWidth, windowHeight);  // per frame
+//
+// GL thread only.
+class PostProcessChain {
+public:
+    enum Effect : std::uint32_t {
+        kBloom = 1u << 0,
+        kColorGrade = 1u << 1,
+        kVignette = 1u << 2,
+        kAllEffects = kBloom | kColorGrade | kVignette,
+    };
+    enum class Program : std::uint8_t { Bright, Blur, Final };
+    static constexpr int kProgramCount = 3;
+
+    struct Options {
+        std::uint32_t effects = kAllEffects;
+        float bloomThreshold = 0.7f;    // brightest channel above this glows
+        float bloomIntensity = 0.8f;
+        float exposure = 1.05f;
+        glm::vec3 tint{1.0f, 0.98f, 0.94f};
+        float contrast = 1.08f;
+        float saturation = 1.15f;
+        float vignette = 0.45f;         // how much darker the corners are
+    };
+
+    // The programs, by Program. 0: not built (their passes are skipped).
+    struct Programs {
+        GLuint program[kProgramCount] = {};
+    };
+
+    struct Stats {
+        int passes = 0;                // last apply(): draws, the resolve not counted
+        int fused = 0;                 // effects the final pass carries
+        std::size_t pixels = 0;        // shaded over all passes
+    };
+
+    PostProcessChain() = default;
+    PostProcessChain(const PostProcessChain&) = delete;
+    PostProcessChain& operator=(const PostProcessChain&) = delete;
+
+    // "bloom,grade,vignette" or any of them, in any order; false on an unknown name.
+    static bool parse(const char* text, std::uint32_t& effects);
+    // The effects' names, comma separated.
+    static std::string describe(std::uint32_t effects);
+    // Whether `effects` uses the program at all, and the fragment.glsl variant it takes.
+    static bool uses(Program program, std::uint32_t effects);
+    static ShaderVariant variant(Program program, std::uint32_t effects);
+
+    // GL thread.
+    bool init(const Options& options);
+    void shutdown();
+
+    // After each link of one of the programs.
+    void setUniforms(Program program, GLuint id);
+
+    // The passes taking `scene` into `window` (the default framebuffer, width x height)
+    // through every effect; they leave it bound with the viewport set to it, as
+    // RenderTargetPool::present does. false: not enabled or no final program, nothing
+    // added (present the scene instead).
+    bool addPasses(RenderGraph& graph, RenderGraph::Resource scene, RenderGraph::Resource window,
+                   const Programs& programs, int width, int height);
+
+    bool enabled() const { return vao_.get() != 0; }
+    std::uint32_t effects() const { return options_.effects; }
+    const Stats& stats() const { return stats_; }
+
+private:
+    struct Locations {
+        GLint invSize = -1;            // uInvSize: 1 / the pass's target size
+        GLint sourceTexel = -1;        // uSourceTexel: 1 / the source's size
+        GLint blurStep = -1;           // uBlurStep
+    };
+
+    // A pass's state: no blending, the empty VAO, `program`, `source` on unit 0.
+    void begin(GLuint program, GLuint source);
+    // One full-screen triangle into `framebuffer` (width x height), the program bound.
+    void pass(Program program, GLuint framebuffer, int width, int height);
+
+    Options options_;
+    GlVertexArray vao_;                // empty: fullscreen_vertex.glsl makes its positions
+    Locations locations_[kProgramCount];
+    Stats stats_;
+};
@@ -0,0 +1,162 @@
+#include "render/program_cache.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <system_error>
+#include <vector>
+
+#include "render/gl_ext.h"
+#include "render/gl_state.h"
+
+namespace {
+
+constexpr std::uint32_t kMagic = 0x42504C47;   // "GLPB"
+constexpr std::uint32_t kVersion = 1;
+
+// On disk: this header, then `length` bytes of the driver's binary.
+struct FileHeader {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint64_t key;
+    std::uint32_t binaryFormat;
+    std::uint32_t length;
+};
+
+std::uint64_t fnv1a(std::uint64_t hash, const void* data, std::size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+std::string glString(GLenum name) {
+    const GLubyte* s = glGetString(name);
+    return s ? reinterpret_cast<const char*>(s) : "";
+}
+
+} // namespace
+
+bool ProgramCache::init(const std::string& directory) {
+    enabled_ = false;
+    stats_ = Stats{};
+    directory_ = directory;
+    driver_ = glString(GL_VENDOR) + "\n" + glString(GL_RENDERER) + "\n" + glString(GL_VERSION);
+    if (!glext::caps().programBinary) {
+        return false;
+    }
+    std::error_code ec;
+    std::filesystem::create_directories(directory_, ec);
+    if (ec) {
+        std::cerr << "ProgramCache: cannot create " << directory_ << ": " << ec.message() << "\n";
+        return false;
+    }
+    enabled_ = true;
+    return true;
+}
+
+std::uint64_t ProgramCache::key(const std::string& vertexSource, const std::string& fragmentSource) const {
+    // The NULs keep ("ab", "c") and ("a", "bc") apart.
+    std::uint64_t hash = 0xcbf29ce484222325ull;
+    hash = fnv1a(hash, driver_.c_str(), driver_.size() + 1);
+    hash = fnv1a(hash, vertexSource.c_str(), vertexSource.size() + 1);
+    hash = fnv1a(hash, fragmentSource.c_str(), fragmentSource.size() + 1);
+    return hash;
+}
+
+std::string ProgramCache::path(std::uint64_t key) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+    return directory_ + "/" + name;
+}
+
+GLuint ProgramCache::load(std::uint64_t key) {
+    if (!enabled_) {
+        return 0;
+    }
+    const std::string file = path(key);
+    std::ifstream in(file, std::ios::binary);
+    if (!in) {
+        ++stats_.misses;
+        return 0;
+    }
+    FileHeader header{};
+    std::vector<char> binary;
+    bool ok = static_cast<bool>(in.read(reinterpret_cast<char*>(&header), sizeof(header))) &&
+              header.magic == kMagic && header.version == kVersion && header.key == key && header.length > 0;
+    if (ok) {
+        binary.resize(header.length);
+        ok = static_cast<bool>(in.read(binary.data(), static_cast<std::streamsize>(binary.size())));
+    }
+    in.close();
+
+    GLuint program = 0;
+    if (ok) {
+        program = glCreateProgram();
+        glext::programBinary(program, header.binaryFormat, binary.data(), static_cast<GLsizei>(binary.size()));
+        GLint linked = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        ok = linked == GL_TRUE;
+        if (!ok) {
+            glstate::deleteProgram(program);
+        }
+    }
+    if (!ok) {
+        // Stale or damaged: drop it so the recompiled program can replace it.
+        std::remove(file.c_str());
+        ++stats_.rejected;
+        ++stats_.misses;
+        return 0;
+    }
+    ++stats_.hits;
+    return program;
+}
+
+void ProgramCache::store(std::uint64_t key, GLuint program) {
+    if (!enabled_ || program == 0) {
+        return;
+    }
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (linked != GL_TRUE || length <= 0) {
+        return;
+    }
+    std::vector<char> binary(static_cast<std::size_t>(length));
+    GLenum format = 0;
+    GLsizei written = 0;
+    glext::getProgramBinary(program, length, &written, &format, binary.data());
+    if (written <= 0) {
+        return;
+    }
+
+    // Written beside the final name, then renamed: a crash mid-write can't leave a
+    // truncated file that a later launch would try to load.
+    const std::string file = path(key);
+    const std::string temporary = file + ".tmp";
+    const FileHeader header{kMagic, kVersion, key, format, static_cast<std::uint32_t>(written)};
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(binary.data(), written);
+        if (!out) {
+            std::remove(temporary.c_str());
+            return;
+        }
+    }
+    if (std::rename(temporary.c_str(), file.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        return;
+    }
+    ++stats_.stored;
+}
+
+void ProgramCache::markRetrievable(GLuint program) {
+    if (glext::caps().programBinary) {
+        glext::programParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+}
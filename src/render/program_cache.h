@@ -0,0 +1,70 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// ProgramCache
+// ------------
+// Linked programs saved to disk with glGetProgramBinary and read back with
+// glProgramBinary, so a launch with unchanged shaders skips the driver's compiler:
+//
+//     const std::uint64_t key = cache.key(vertexSrc, fragmentSrc);
+//     GLuint program = cache.load(key);           // 0: miss, or the driver refused it
+//     if (program == 0) {
+//         program = ...compile + link from source...;
+//         cache.store(key, program);               // only if it linked
+//     }
+//
+// | Launch                               | load()                    | Cost                 |
+// | ------------------------------------ | ------------------------- | -------------------- |
+// | first, or a shader source changed    | miss (no file for key)    | compile + link +     |
+// |                                      |                           | one file write       |
+// | unchanged sources, same driver       | hit                       | file read +          |
+// |                                      |                           | glProgramBinary      |
+// | driver updated / other GPU           | miss (key covers vendor,  | as the first launch  |
+// |                                      | renderer, version)        |                      |
+// | binary refused anyway                | rejected: file deleted,   | as the first launch  |
+// |                                      | returns 0                 |                      |
+//
+// The key is a 64-bit FNV-1a of the driver strings and both sources, and each file
+// (<directory>/<key as hex>.bin) repeats it in its header, so a renamed or truncated file
+// can't be mistaken for another program. Binaries are driver-private blobs: they are
+// only ever handed back to the driver that wrote them, never inspected.
+//
+// GL only promises a retrievable binary if the program was flagged before linking:
+// call markRetrievable() between glCreateProgram and glLinkProgram.
+//
+// Without ARB_get_program_binary (or with zero binary formats), or if the directory
+// can't be created, init() returns false and the cache stays off: load() always misses
+// and store() does nothing, so callers need no second code path.
+class ProgramCache {
+public:
+    struct Stats {
+        int hits = 0;
+        int misses = 0;
+        int rejected = 0;   // file found, but glProgramBinary failed (counted in misses too)
+        int stored = 0;
+    };
+
+    bool init(const std::string& directory);
+    bool enabled() const { return enabled_; }
+
+    std::uint64_t key(const std::string& vertexSource, const std::string& fragmentSource) const;
+
+    GLuint load(std::uint64_t key);
+    void store(std::uint64_t key, GLuint program);
+
+    static void markRetrievable(GLuint program);
+
+    const Stats& stats() const { return stats_; }
+
+private:
+    std::string path(std::uint64_t key) const;
+
+    bool enabled_ = false;
+    std::string directory_;
+    std::string driver_;    // GL_VENDOR \n GL_RENDERER \n GL_VERSION
+    Stats stats_;
+};
@@ -0,0 +1,90 @@
+#include "render/quality_governor.h"
+
+#include <algorithm>
+
+namespace {
+
+const QualityGovernor::Knobs kLadder[QualityGovernor::kLevels] = {
+    {"full", 1.0f, 1.0f, 1.0f, 1.0f, 64},
+    {"high", 1.0f, 0.75f, 0.75f, 1.5f, 2},
+    {"medium", 0.85f, 0.5f, 0.5f, 2.0f, 1},
+    {"low", 0.7f, 0.25f, 0.25f, 3.0f, 1},
+    {"minimum", 0.5f, 0.125f, 0.125f, 4.0f, 1},
+};
+
+} // namespace
+
+const QualityGovernor::Knobs& QualityGovernor::knobs(int level) {
+    return kLadder[std::clamp(level, 0, kLevels - 1)];
+}
+
+void QualityGovernor::init(const Settings& settings) {
+    settings_ = settings;
+    settings_.lowest = std::clamp(settings.lowest, 0, kLevels - 1);
+    stats_ = Stats{};
+    level_ = 0;
+    over_ = under_ = settle_ = 0;
+    backoff_ = 1;
+    frame_ = raisedAt_ = 0;
+    seeded_ = false;
+}
+
+void QualityGovernor::change(int level) {
+    level_ = level;
+    over_ = under_ = 0;
+    settle_ = kSettleFrames;
+    seeded_ = false;                   // the old level's times say nothing about this one
+}
+
+bool QualityGovernor::update(double cpuMs, double gpuMs) {
+    ++frame_;
+    ++stats_.frames[level_];
+    stats_.targetMs = period_ * 1000.0 * settings_.headroom;
+    if (settle_ > 0) {
+        --settle_;
+        return false;
+    }
+    if (!seeded_) {
+        stats_.cpuMs = cpuMs;
+        stats_.gpuMs = gpuMs;
+        seeded_ = true;
+    } else {
+        stats_.cpuMs += (cpuMs - stats_.cpuMs) * kSmoothing;
+        if (gpuMs < 0.0 || stats_.gpuMs < 0.0) {
+            stats_.gpuMs = gpuMs;          // untimed, or the first timed frame
+        } else {
+            stats_.gpuMs += (gpuMs - stats_.gpuMs) * kSmoothing;
+        }
+    }
+    // A raise that held long enough: the next one waits the normal time again.
+    if (raisedAt_ != 0 && frame_ - raisedAt_ > static_cast<std::uint64_t>(kUndoFrames)) {
+        raisedAt_ = 0;
+        backoff_ = 1;
+    }
+
+    const double load = std::max(stats_.cpuMs, stats_.gpuMs);
+    if (load > stats_.targetMs) {
+        under_ = 0;
+        if (++over_ >= kLowerFrames && level_ < settings_.lowest) {
+            if (raisedAt_ != 0) {      // the last raise didn't fit
+                ++stats_.undone;
+                backoff_ = std::min(backoff_ * 2, kMaxBackoff);
+                raisedAt_ = 0;
+            }
+            ++stats_.lowered;
+            change(level_ + 1);
+            return true;
+        }
+    } else if (load < stats_.targetMs * kRaiseBelow) {
+        over_ = 0;
+        if (++under_ >= kRaiseFrames * backoff_ && level_ > 0) {
+            ++stats_.raised;
+            raisedAt_ = frame_;
+            change(level_ - 1);
+            return true;
+        }
+    } else {
+        over_ = under_ = 0;
+    }
+    return false;
+}
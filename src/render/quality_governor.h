@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstdint>
+
+// QualityGovernor
+// ---------------
+// Holds the target frame rate on whatever hardware by trading picture for time
+// (--quality-governor): it watches main's frame work (CPU) and the render side's GPU
+// time against the frame's period, and walks a ladder of quality levels, each a set of
+// knobs the game applies to what it draws:
+//
+// | Level   | Render scale | Particles | Lights | LOD flat size | MSAA samples |
+// | ------- | ------------ | --------- | ------ | ------------- | ------------ |
+// | full    | x 1          | all       | all    | x 1           | as set       |
+// | high    | x 1          | 3/4       | 3/4    | x 1.5         | at most 2    |
+// | medium  | x 0.85       | 1/2       | 1/2    | x 2           | 1            |
+// | low     | x 0.7        | 1/4       | 1/4    | x 3           | 1            |
+// | minimum | x 0.5        | 1/8       | 1/8    | x 4           | 1            |
+//
+// The render scale multiplies --render-scale (--dynamic-resolution, when on, picks the
+// scale itself and this column is ignored); particles and lights are fractions of
+// --particles and --lights that are drawn (all of them are still simulated); the LOD
+// column multiplies the [lod] section's sizes, so sprites go flat and into impostors
+// sooner (render/sprite_lod.h).
+//
+// The load is the larger of the two smoothed times, against target = period x headroom:
+//
+// | Load                    | For                                  | Action          |
+// | ----------------------- | ------------------------------------ | --------------- |
+// | > target                | kLowerFrames in a row                | one level down  |
+// | < target x kRaiseBelow  | raise frames in a row (kRaiseFrames, | one level up    |
+// |                         | doubled each time a raise is undone) |                 |
+// | in between              | -                                    | both counts     |
+// |                         |                                      | start over      |
+//
+// That is the hysteresis: the band between the two thresholds never changes anything,
+// going down takes a third of a second of slow frames and going up several seconds of
+// fast ones. A raise that is lowered again within kUndoFrames (the level up didn't fit)
+// doubles the wait before the next raise, up to kMaxBackoff times, so the governor
+// doesn't flip between two levels; a raise that holds resets it. After any change it
+// ignores kSettleFrames frames: the GPU times come back Profiler::kLatency frames late,
+// and frames still drawn at the OLD level must not count against the new one.
+//
+// Main thread only; the caller applies the knobs (and logs the change).
+class QualityGovernor {
+public:
+    static constexpr int kLevels = 5;
+    static constexpr int kLowerFrames = 20;
+    static constexpr int kRaiseFrames = 180;
+    static constexpr int kUndoFrames = 600;
+    static constexpr int kMaxBackoff = 8;
+    static constexpr int kSettleFrames = 8;         // > Profiler::kLatency
+    static constexpr double kSmoothing = 0.1;       // exponential moving average weight
+    static constexpr double kRaiseBelow = 0.7;
+
+    struct Knobs {
+        const char* name;
+        float renderScale;             // of --render-scale
+        float particles;               // of --particles, drawn
+        float lights;                  // of --lights
+        float lodScale;                // of the [lod] sizes
+        int maxSamples;                // MSAA, at most
+    };
+
+    struct Settings {
+        double headroom = 0.9;         // of the period: the frame's work may take this much
+        int lowest = kLevels - 1;      // the lowest level it may go to
+    };
+
+    struct Stats {
+        double cpuMs = 0.0;            // smoothed: what the last decision was based on
+        double gpuMs = 0.0;            // < 0: no GPU timings
+        double targetMs = 0.0;
+        std::uint64_t lowered = 0;     // changes since init
+        std::uint64_t raised = 0;
+        std::uint64_t undone = 0;      // raises lowered again within kUndoFrames
+        std::uint64_t frames[kLevels] = {};   // frames spent at each level
+    };
+
+    static const Knobs& knobs(int level);
+
+    void init(const Settings& settings);
+    // The frame's target period, seconds (FrameBudget's: core/frame_budget.h).
+    void setPeriod(double seconds) { period_ = seconds; }
+
+    // Once a frame: main's work and the GPU's, ms (gpuMs < 0: untimed). Returns true if
+    // level() changed.
+    bool update(double cpuMs, double gpuMs);
+
+    int level() const { return level_; }
+    const Knobs& knobs() const { return knobs(level_); }
+    const Settings& settings() const { return settings_; }
+    const Stats& stats() const { return stats_; }
+
+private:
+    void change(int level);
+
+    Settings settings_;
+    Stats stats_;
+    double period_ = 1.0 / 60.0;
+    int level_ = 0;
+    int over_ = 0;                     // frames in a row over the target
+    int under_ = 0;                    // ... under the raise threshold
+    int settle_ = 0;
+    int backoff_ = 1;                  // the raise wait's multiplier
+    std::uint64_t frame_ = 0;
+    std::uint64_t raisedAt_ = 0;       // frame_ of the last raise; 0: none pending
+    bool seeded_ = false;              // the averages have a sample since the last change
+};
@@ -0,0 +1,309 @@
+#include "render/render_graph.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "profile/trace.h"
+#include "render/gl_framebuffer.h"
+
+namespace {
+
+constexpr std::uint32_t kScheduled = ~0u;   // in-degree of a pass already in the order
+constexpr std::uint32_t kUnused = ~0u;      // ResourceNode::first of a resource no kept pass uses
+
+} // namespace
+
+void RenderGraph::reset() {
+    releaseTargets();               // compiled but never executed
+    resources_.clear();
+    passes_.clear();
+    accesses_.clear();
+    edges_.clear();
+    order_.clear();
+    slots_.clear();
+    arena_.clear();
+    pool_ = nullptr;
+    stats_ = Stats{};
+}
+
+RenderGraph::Resource RenderGraph::importBackbuffer(int width, int height) {
+    ResourceNode node;
+    node.name = "window";
+    node.desc.width = width;
+    node.desc.height = height;
+    node.imported = true;
+    resources_.push_back(node);
+    return static_cast<Resource>(resources_.size() - 1);
+}
+
+RenderGraph::Resource RenderGraph::importTarget(const char* name, RenderTarget* target) {
+    ResourceNode node;
+    node.name = name;
+    node.desc = target->desc();
+    node.target = target;
+    node.imported = true;
+    resources_.push_back(node);
+    return static_cast<Resource>(resources_.size() - 1);
+}
+
+RenderGraph::Resource RenderGraph::createTarget(const char* name, const RenderTargetDesc& desc) {
+    ResourceNode node;
+    node.name = name;
+    node.desc = desc;
+    resources_.push_back(node);
+    return static_cast<Resource>(resources_.size() - 1);
+}
+
+std::size_t RenderGraph::reserve(std::size_t bodyBytes) {
+    const std::size_t offset = arena_.size();
+    arena_.resize(offset + (bodyBytes + kAlign - 1) / kAlign * kAlign);   // capacity kept across reset()
+    return offset;
+}
+
+RenderGraph::Pass RenderGraph::addPassNode(const char* name, Dispatch dispatch, std::size_t offset) {
+    passes_.push_back(PassNode{name, dispatch, static_cast<std::uint32_t>(offset)});
+    ++stats_.passes;
+    return static_cast<Pass>(passes_.size() - 1);
+}
+
+void RenderGraph::read(Pass pass, Resource resource) {
+    accesses_.push_back(Access{pass, resource, false});
+}
+
+void RenderGraph::write(Pass pass, Resource resource) {
+    accesses_.push_back(Access{pass, resource, true});
+    if (passes_[pass].target == kNoResource) {
+        passes_[pass].target = resource;
+    }
+}
+
+void RenderGraph::sideEffect(Pass pass) {
+    passes_[pass].sideEffect = true;
+}
+
+bool RenderGraph::compile(RenderTargetPool& pool) {
+    releaseTargets();
+    pool_ = &pool;
+    buildEdges();
+    cull();
+    schedule();
+    return allocate();
+}
+
+// Accesses in declaration order, then against every earlier one to the same resource:
+// a read depends on the last write before it; a write on that write and on every read
+// since (they must see the old contents before it is replaced). A handful of passes and
+// resources per frame: the quadratic scan is cheaper than building lists.
+void RenderGraph::buildEdges() {
+    edges_.clear();
+    if (!std::is_sorted(accesses_.begin(), accesses_.end(),
+                        [](const Access& a, const Access& b) { return a.pass < b.pass; })) {
+        std::stable_sort(accesses_.begin(), accesses_.end(),
+                         [](const Access& a, const Access& b) { return a.pass < b.pass; });
+    }
+    for (std::size_t i = 0; i < accesses_.size(); ++i) {
+        const Access& a = accesses_[i];
+        for (std::size_t j = i; j-- > 0;) {
+            const Access& earlier = accesses_[j];
+            if (earlier.resource != a.resource || earlier.pass == a.pass) {
+                continue;
+            }
+            if (earlier.write) {
+                edges_.push_back(Edge{earlier.pass, a.pass, !a.write});
+                break;
+            }
+            if (a.write) {
+                edges_.push_back(Edge{earlier.pass, a.pass, false});
+            }
+        }
+    }
+}
+
+// Backwards from the last pass: edges only point forward, so by the time a pass is
+// reached every pass that could need it has been decided.
+void RenderGraph::cull() {
+    for (PassNode& p : passes_) {
+        p.kept = p.sideEffect;
+    }
+    for (const Access& a : accesses_) {
+        if (a.write && resources_[a.resource].imported) {
+            passes_[a.pass].kept = true;
+        }
+    }
+    for (std::size_t p = passes_.size(); p-- > 0;) {
+        if (!passes_[p].kept) {
+            continue;
+        }
+        for (const Edge& e : edges_) {
+            if (e.to == p && e.data) {
+                passes_[e.from].kept = true;
+            }
+        }
+    }
+    stats_.culled = 0;
+    for (const PassNode& p : passes_) {
+        stats_.culled += p.kept ? 0 : 1;
+    }
+}
+
+// Kahn's algorithm over the kept passes. Ties go to the pass drawing into the target
+// already bound, then to the one declared first.
+void RenderGraph::schedule() {
+    order_.clear();
+    scratch_.assign(passes_.size(), 0);
+    for (const Edge& e : edges_) {
+        if (passes_[e.from].kept && passes_[e.to].kept) {
+            ++scratch_[e.to];
+        }
+    }
+    stats_.switches = 0;
+    Resource bound = kNoResource;
+    for (;;) {
+        Pass next = kScheduled;
+        for (Pass p = 0; p < passes_.size(); ++p) {
+            if (!passes_[p].kept || scratch_[p] != 0) {
+                continue;
+            }
+            if (next == kScheduled) {
+                next = p;
+            }
+            if (bound != kNoResource && passes_[p].target == bound) {
+                next = p;
+                break;
+            }
+        }
+        if (next == kScheduled) {
+            break;
+        }
+        scratch_[next] = kScheduled;
+        order_.push_back(next);
+        const Resource target = passes_[next].target;
+        if (target != kNoResource) {
+            stats_.switches += bound != kNoResource && target != bound ? 1 : 0;
+            bound = target;
+        }
+        for (const Edge& e : edges_) {
+            if (e.from == next && passes_[e.to].kept) {
+                --scratch_[e.to];
+            }
+        }
+    }
+}
+
+// Lifetimes in order positions, then first fit: each transient, by where it starts,
+// takes the first target of its desc whose last transient has ended.
+bool RenderGraph::allocate() {
+    for (ResourceNode& r : resources_) {
+        r.first = kUnused;
+        r.last = 0;
+        if (!r.imported) {
+            r.target = nullptr;
+        }
+    }
+    for (std::uint32_t i = 0; i < order_.size(); ++i) {
+        for (const Access& a : accesses_) {
+            if (a.pass == order_[i]) {
+                ResourceNode& r = resources_[a.resource];
+                r.first = std::min(r.first, i);
+                r.last = std::max(r.last, i);
+            }
+        }
+    }
+    slots_.clear();
+    stats_.transients = 0;
+    for (std::uint32_t i = 0; i < order_.size(); ++i) {
+        for (ResourceNode& r : resources_) {
+            if (r.imported || r.first != i) {
+                continue;
+            }
+            ++stats_.transients;
+            std::uint32_t slot = 0;
+            while (slot < slots_.size() && !(slots_[slot].desc == r.desc && slots_[slot].last < i)) {
+                ++slot;
+            }
+            if (slot == slots_.size()) {
+                slots_.push_back(Slot{r.desc});
+            }
+            slots_[slot].last = r.last;
+            r.slot = slot;
+        }
+    }
+    for (Slot& s : slots_) {
+        s.target = pool_->acquire(s.desc);
+        if (s.target == nullptr) {
+            releaseTargets();
+            return false;
+        }
+    }
+    stats_.targets = slots_.size();
+    stats_.bytes = 0;
+    for (const Slot& s : slots_) {
+        stats_.bytes += s.target->bytes();
+    }
+    std::size_t transientBytes = 0;
+    for (ResourceNode& r : resources_) {
+        if (!r.imported && r.first != kUnused) {
+            r.target = slots_[r.slot].target;
+            transientBytes += r.target->bytes();
+        }
+    }
+    stats_.aliasedBytes = transientBytes - stats_.bytes;
+    return true;
+}
+
+void RenderGraph::execute() {
+    for (std::uint32_t i = 0; i < order_.size(); ++i) {
+        const PassNode& p = passes_[order_[i]];
+        {
+            trace::Scope span(p.name);
+            p.dispatch(arena_.data() + p.offset, *this);
+        }
+        for (const ResourceNode& r : resources_) {
+            if (!r.imported && r.first != kUnused && r.last == i) {
+                glframebuffer::discard(r.target->framebuffer(),
+                                       GL_COLOR_BUFFER_BIT | (r.desc.depthFormat != GL_NONE
+                                                                  ? GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT
+                                                                  : 0));
+            }
+        }
+    }
+    releaseTargets();
+}
+
+void RenderGraph::releaseTargets() {
+    for (Slot& s : slots_) {
+        if (s.target) {
+            pool_->release(s.target);
+            s.target = nullptr;
+        }
+    }
+    for (ResourceNode& r : resources_) {
+        if (!r.imported) {
+            r.target = nullptr;
+        }
+    }
+}
+
+GLuint RenderGraph::framebuffer(Resource resource) const {
+    const RenderTarget* t = resources_[resource].target;
+    return t ? t->framebuffer() : 0;
+}
+
+void RenderGraph::report(std::ostream& out) const {
+    out << "render graph";
+    for (std::size_t i = 0; i < order_.size(); ++i) {
+        out << (i == 0 ? " " : " > ") << passes_[order_[i]].name;
+    }
+    if (stats_.culled > 0) {
+        out << " (culled:";
+        for (const PassNode& p : passes_) {
+            if (!p.kept) {
+                out << " " << p.name;
+            }
+        }
+        out << ")";
+    }
+    out << ", " << stats_.transients << " transient(s) in " << stats_.targets << " target(s), "
+        << stats_.bytes / 1024 << " KiB (" << stats_.aliasedBytes / 1024 << " KiB aliased), " << stats_.switches
+        << " framebuffer switch(es)\n";
+}
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iosfwd>
+#include <type_traits>
+#include <vector>
+
+#include "render/render_target.h"
+
+// RenderGraph
+// -----------
+// One frame's GPU passes, each declared with the targets it reads and writes. The graph
+// then works out which of them run, in what order, and in which framebuffers:
+//
+//     graph.reset();                                               // per frame
+//     const RenderGraph::Resource window = graph.importBackbuffer(width, height);
+//     const RenderGraph::Resource scene = graph.createTarget("scene", sceneDesc);
+//     const RenderGraph::Pass draw = graph.addPass("scene", [&](const RenderGraph& g) { ... });
+//     graph.write(draw, scene);
+//     const RenderGraph::Pass present = graph.addPass("present", [&](const RenderGraph& g) { ... });
+//     graph.read(present, scene);
+//     graph.write(present, window);
+//     graph.compile(pool);         // g.target(scene) exists from here: commands can point at it
+//     graph.execute();             // the passes that are left, in the graph's order
+//
+// Passes are declared in program order: a read sees the last write to that resource by
+// a pass declared before it. compile() then does three things:
+//
+// | Step  | What it does                                                                  |
+// | ----- | ----------------------------------------------------------------------------- |
+// | cull  | keeps the passes that write an imported resource (the window, a target that   |
+// |       | outlives the frame) or are marked sideEffect(), and every pass whose writes   |
+// |       | a kept pass reads. The rest never run; a transient only they use is never     |
+// |       | allocated                                                                     |
+// | order | a topological order of the kept passes (read after write, write after read,   |
+// |       | write after write). Among the passes ready at once, one that draws into the   |
+// |       | target the previous pass drew into goes first: one framebuffer switch fewer   |
+// | alias | each transient lives from the first kept pass that uses it to the last one.   |
+// |       | Transients with equal descs and disjoint lifetimes share one pooled           |
+// |       | RenderTarget, so a frame holds as many as are alive at once, not one per use  |
+//
+// execute() runs the kept passes. After a transient's last pass its attachments are
+// discarded (glframebuffer::discard: nothing stores them, and the next transient in
+// the same target starts from nothing). The targets go back to the pool when it returns.
+//
+// A pass's target is its first write; the pass binds it itself (begin(), bind(), a
+// blit), as it would without the graph. A pass that draws over what a target already
+// holds reads it as well. A pass that only writes it (a clear, a full-screen pass) ends
+// the previous contents, and a pass that only wrote those is culled.
+//
+// Pass bodies are copied into an arena, like CommandBucket's commands: lambdas that are
+// trivially copyable (captures by reference, or of plain values). reset() keeps every
+// capacity, so a frame with the same passes as the last allocates nothing. GL thread only.
+class RenderGraph {
+public:
+    using Resource = std::uint32_t;
+    using Pass = std::uint32_t;
+    static constexpr Resource kNoResource = ~0u;
+
+    struct Stats {
+        std::size_t passes = 0;        // declared
+        std::size_t culled = 0;
+        std::size_t transients = 0;    // used by kept passes
+        std::size_t targets = 0;       // pooled targets they were given
+        std::size_t bytes = 0;         // of those targets
+        std::size_t aliasedBytes = 0;  // the transients' bytes beyond that: what aliasing saved
+        std::size_t switches = 0;      // kept passes drawing into another target than the one before
+    };
+
+    RenderGraph() = default;
+    RenderGraph(const RenderGraph&) = delete;
+    RenderGraph& operator=(const RenderGraph&) = delete;
+
+    // Forgets the previous frame's passes and resources (its targets went back in execute()).
+    void reset();
+
+    // The window (framebuffer 0) and targets owned elsewhere: writing one keeps a pass.
+    Resource importBackbuffer(int width, int height);
+    Resource importTarget(const char* name, RenderTarget* target);
+    // A target for this frame only, from the pool. `name` must be a literal.
+    Resource createTarget(const char* name, const RenderTargetDesc& desc);
+
+    // `body(graph)` runs when execute() reaches the pass. `name` must be a literal.
+    template <typename Body>
+    Pass addPass(const char* name, const Body& body) {
+        static_assert(std::is_trivially_copyable<Body>::value, "pass bodies are copied with memcpy");
+        static_assert(alignof(Body) <= kAlign, "pass body over-aligned for the arena");
+        const std::size_t offset = reserve(sizeof(Body));
+        std::memcpy(arena_.data() + offset, &body, sizeof(Body));
+        return addPassNode(name, &invoke<Body>, offset);
+    }
+    void read(Pass pass, Resource resource);
+    void write(Pass pass, Resource resource);
+    // Kept even if nothing reads what it writes: readbacks, queries, uploads.
+    void sideEffect(Pass pass);
+
+    // Culls, orders and allocates. false if the pool couldn't create a target (nothing
+    // is held then; reset() and declare the frame without it).
+    bool compile(RenderTargetPool& pool);
+    // The kept passes in order. The transients' targets are back in the pool after it.
+    void execute();
+
+    // After compile(). null: the window, or a transient no kept pass uses.
+    RenderTarget* target(Resource resource) const { return resources_[resource].target; }
+    GLuint framebuffer(Resource resource) const;
+    // As declared: valid before compile().
+    const RenderTargetDesc& desc(Resource resource) const { return resources_[resource].desc; }
+    int width(Resource resource) const { return resources_[resource].desc.width; }
+    int height(Resource resource) const { return resources_[resource].desc.height; }
+    bool kept(Pass pass) const { return passes_[pass].kept; }
+
+    const Stats& stats() const { return stats_; }
+    // The last compile: its order, what it culled, the targets and what aliasing saved.
+    void report(std::ostream& out) const;
+
+private:
+    using Dispatch = void (*)(const void* body, const RenderGraph& graph);
+
+    static constexpr std::size_t kAlign = 16;
+
+    struct ResourceNode {
+        const char* name;
+        RenderTargetDesc desc;
+        RenderTarget* target = nullptr;
+        bool imported = false;
+        std::uint32_t first = 0;       // positions in order_ of the first and last kept pass
+        std::uint32_t last = 0;        // using it; first > last: none
+        std::uint32_t slot = 0;        // into slots_
+    };
+    struct PassNode {
+        const char* name;
+        Dispatch dispatch;
+        std::uint32_t offset;          // of the body in arena_
+        Resource target = kNoResource; // first write
+        bool sideEffect = false;
+        bool kept = false;
+    };
+    struct Access {
+        Pass pass;
+        Resource resource;
+        bool write;
+    };
+    struct Edge {
+        Pass from, to;
+        bool data;                     // read after write: `to` needs what `from` wrote
+    };
+    struct Slot {
+        RenderTargetDesc desc;
+        RenderTarget* target = nullptr;
+        std::uint32_t last = 0;        // order position its latest transient ends at
+    };
+
+    template <typename Body>
+    static void invoke(const void* body, const RenderGraph& graph) {
+        (*static_cast<const Body*>(body))(graph);
+    }
+
+    std::size_t reserve(std::size_t bodyBytes);
+    Pass addPassNode(const char* name, Dispatch dispatch, std::size_t offset);
+    void buildEdges();
+    void cull();
+    void schedule();
+    bool allocate();
+    void releaseTargets();
+
+    std::vector<ResourceNode> resources_;
+    std::vector<PassNode> passes_;
+    std::vector<Access> accesses_;
+    std::vector<Edge> edges_;
+    std::vector<Pass> order_;          // kept passes, as execute() runs them
+    std::vector<Slot> slots_;
+    std::vector<std::uint32_t> scratch_;
+    std::vector<unsigned char> arena_;
+    RenderTargetPool* pool_ = nullptr;
+    Stats stats_;
+};
@@ -0,0 +1,35 @@
+#include "render/render_stats.h"
+
+#include "profile/trace.h"
+
+RenderStats& RenderStats::operator+=(const RenderStats& other) {
+    drawCalls += other.drawCalls;
+    instances += other.instances;
+    vertices += other.vertices;
+    commands += other.commands;
+    batches += other.batches;
+    programBreaks += other.programBreaks;
+    textureBreaks += other.textureBreaks;
+    pipelineBreaks += other.pipelineBreaks;
+    capacityBreaks += other.capacityBreaks;
+    uploadBytes += other.uploadBytes;
+    stateIssued += other.stateIssued;
+    stateFiltered += other.stateFiltered;
+    return *this;
+}
+
+void RenderStats::trace() const {
+    if (!trace::active()) {
+        return;
+    }
+    trace::counter("draw calls", drawCalls);
+    trace::counter("instances", instances);
+    trace::counter("batches", batches);
+    trace::counter("program breaks", programBreaks);
+    trace::counter("texture breaks", textureBreaks);
+    trace::counter("pipeline breaks", pipelineBreaks);
+    trace::counter("capacity breaks", capacityBreaks);
+    trace::counter("upload bytes", uploadBytes);
+    trace::counter("state issued", stateIssued);
+    trace::counter("state filtered", stateFiltered);
+}
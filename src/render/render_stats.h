@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// RenderStats
+// -----------
+// What one frame cost the renderer, and why it didn't cost less: the render thread
+// fills one per packet (FramePacket::stats) after executing it, and main hands it to
+// the HUD (F2), the bench report and, with --trace, the trace as counters.
+//
+// | Field          | Counted from                                                 |
+// | -------------- | ------------------------------------------------------------ |
+// | drawCalls      | the commands, each expanded to the draws it really issued    |
+// | instances      | quads streamed x the views drawing them, sprites batched,    |
+// |                | particles                                                    |
+// | vertices       | kQuadVertices per instance                                   |
+// | batches        | SpriteBatch draws (world sprites, HUD text, tools panel)     |
+// | *Breaks        | why consecutive draws didn't merge: the CommandContext's     |
+// |                | program / texture / pipeline changes, the sprite batches'    |
+// |                | program, texture and full-buffer flushes                     |
+// | uploadBytes    | StreamBuffer::allocate() (instances, sprites, text, lights)  |
+// | state*         | glstate calls that reached GL, and that its cache skipped    |
+//
+// A frame that should batch and doesn't shows it here first: many textureBreaks is an
+// atlas that doesn't hold the frame's sprites, many pipelineBreaks is blend or depth
+// state alternating between commands whose keys interleave.
+struct RenderStats {
+    static constexpr std::size_t kQuadVertices = 4;
+
+    std::size_t drawCalls = 0;
+    std::size_t instances = 0;
+    std::size_t vertices = 0;
+    std::size_t commands = 0;           // executed from the bucket
+    std::size_t batches = 0;
+    std::size_t programBreaks = 0;
+    std::size_t textureBreaks = 0;
+    std::size_t pipelineBreaks = 0;     // blend / depth state (render/pipeline_state.h)
+    std::size_t capacityBreaks = 0;     // a sprite batch's buffer full
+    std::uint64_t uploadBytes = 0;
+    std::uint64_t stateIssued = 0;
+    std::uint64_t stateFiltered = 0;
+
+    std::size_t breaks() const { return programBreaks + textureBreaks + pipelineBreaks + capacityBreaks; }
+
+    RenderStats& operator+=(const RenderStats& other);
+
+    // One trace counter per field ("C" events, profile/trace.h); nothing unless tracing.
+    void trace() const;
+};
@@ -0,0 +1,217 @@
+#include "render/render_target.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "render/gl_framebuffer.h"
+#include "render/gl_state.h"
+#include "render/gpu_memory.h"
+
+namespace {
+
+bool integerFormat(GLenum format) {
+    switch (format) {
+        case GL_R8UI:
+        case GL_R16UI:
+        case GL_R32UI:
+        case GL_R32I:
+        case GL_RG32UI:
+        case GL_RGBA32UI:           return true;
+        default:                    return false;
+    }
+}
+
+} // namespace
+
+bool RenderTarget::init(const RenderTargetDesc& desc) {
+    shutdown();
+    desc_ = desc;
+    desc_.samples = std::max(1, std::min(desc.samples, RenderTargetPool::maxSamples()));
+    return allocate();
+}
+
+void RenderTarget::shutdown() {
+    framebuffer_.reset();
+    colorTexture_.reset();
+    colorBuffer_.reset();
+    depthBuffer_.reset();
+}
+
+bool RenderTarget::resize(int width, int height) {
+    if (width == desc_.width && height == desc_.height && framebuffer_) {
+        return true;
+    }
+    desc_.width = width;
+    desc_.height = height;
+    return allocate();
+}
+
+bool RenderTarget::allocate() {
+    const int width = std::max(1, desc_.width);
+    const int height = std::max(1, desc_.height);
+    desc_.width = width;
+    desc_.height = height;
+    // New names rather than re-specifying the old ones: a frame still in flight may be
+    // reading them, and the deletion queue lets it finish.
+    framebuffer_ = GlFramebuffer::create();
+    colorTexture_.reset();
+    colorBuffer_.reset();
+    depthBuffer_.reset();
+    glstate::bindFramebuffer(GL_FRAMEBUFFER, framebuffer_.get());
+
+    if (multisampled()) {
+        colorBuffer_ = GlRenderbuffer::create();
+        glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer_.get());
+        glRenderbufferStorageMultisample(GL_RENDERBUFFER, desc_.samples, desc_.colorFormat, width, height);
+        gpumemory::track(GlObject::Renderbuffer, colorBuffer_.get(),
+                         gpumemory::textureBytes(desc_.colorFormat, width, height, desc_.samples),
+                         gpumemory::Category::RenderTarget);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer_.get());
+    } else {
+        colorTexture_ = GlTexture::create();
+        glstate::activeTexture(GL_TEXTURE0);
+        glstate::bindTexture(GL_TEXTURE_2D, colorTexture_.get());
+        // Any matching format/type: nothing is uploaded. Integer formats (ids) need an
+        // integer one, and can't be filtered.
+        const bool integer = integerFormat(desc_.colorFormat);
+        glTexImage2D(GL_TEXTURE_2D, 0, desc_.colorFormat, width, height, 0, integer ? GL_RGBA_INTEGER : GL_RGBA,
+                     integer ? GL_UNSIGNED_INT : GL_UNSIGNED_BYTE, nullptr);
+        gpumemory::track(GlObject::Texture, colorTexture_.get(),
+                         gpumemory::textureBytes(desc_.colorFormat, width, height), gpumemory::Category::RenderTarget);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, integer ? GL_NEAREST : GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, integer ? GL_NEAREST : GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glstate::bindTexture(GL_TEXTURE_2D, 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture_.get(), 0);
+    }
+
+    if (desc_.depthFormat != GL_NONE) {
+        depthBuffer_ = GlRenderbuffer::create();
+        glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer_.get());
+        glRenderbufferStorageMultisample(GL_RENDERBUFFER, multisampled() ? desc_.samples : 0, desc_.depthFormat,
+                                         width, height);
+        gpumemory::track(GlObject::Renderbuffer, depthBuffer_.get(),
+                         gpumemory::textureBytes(desc_.depthFormat, width, height, desc_.samples),
+                         gpumemory::Category::RenderTarget);
+        const bool stencil = desc_.depthFormat == GL_DEPTH24_STENCIL8 || desc_.depthFormat == GL_DEPTH32F_STENCIL8;
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, stencil ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT,
+                                  GL_RENDERBUFFER, depthBuffer_.get());
+    }
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glstate::bindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "RenderTarget: " << width << "x" << height << " x" << desc_.samples
+                  << " incomplete (status 0x" << std::hex << status << std::dec << ")\n";
+        shutdown();
+        return false;
+    }
+    return true;
+}
+
+void RenderTarget::bind() const {
+    glstate::bindFramebuffer(GL_FRAMEBUFFER, framebuffer_.get());
+    glstate::viewport(0, 0, desc_.width, desc_.height);
+}
+
+void RenderTarget::blitTo(GLuint framebuffer, int width, int height) const {
+    glstate::bindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer_.get());
+    glstate::bindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffer);
+    const bool scaled = width != desc_.width || height != desc_.height;
+    glBlitFramebuffer(0, 0, desc_.width, desc_.height, 0, 0, width, height, GL_COLOR_BUFFER_BIT,
+                      scaled ? GL_LINEAR : GL_NEAREST);
+}
+
+std::size_t RenderTarget::bytes() const {
+    const std::size_t texels = static_cast<std::size_t>(desc_.width) * desc_.height * desc_.samples;
+    return texels * (gpumemory::texelBytes(desc_.colorFormat) + gpumemory::texelBytes(desc_.depthFormat));
+}
+
+RenderTarget* RenderTargetPool::acquire(const RenderTargetDesc& desc) {
+    for (Entry& e : entries_) {
+        if (!e.inUse && e.requested == desc) {
+            e.inUse = true;
+            e.lastUsed = frame_;
+            ++reused_;
+            return e.target.get();
+        }
+    }
+    Entry entry;
+    entry.target = std::make_unique<RenderTarget>();
+    const gpumemory::Owner owner("render target pool");
+    if (!entry.target->init(desc)) {
+        return nullptr;
+    }
+    entry.requested = desc;
+    entry.inUse = true;
+    entry.lastUsed = frame_;
+    entries_.push_back(std::move(entry));
+    ++created_;
+    return entries_.back().target.get();
+}
+
+void RenderTargetPool::release(RenderTarget* target) {
+    for (Entry& e : entries_) {
+        if (e.target.get() == target) {
+            e.inUse = false;
+            e.lastUsed = frame_;
+            return;
+        }
+    }
+}
+
+void RenderTargetPool::endFrame() {
+    ++frame_;
+    entries_.erase(std::remove_if(entries_.begin(), entries_.end(),
+                                  [this](const Entry& e) { return !e.inUse && frame_ - e.lastUsed > kIdleFrames; }),
+                   entries_.end());
+}
+
+void RenderTargetPool::shutdown() {
+    entries_.clear();               // each target's names go to the deletion queue
+}
+
+void RenderTargetPool::present(const RenderTarget& scene, int width, int height) {
+    const bool scaled = width != scene.width() || height != scene.height();
+    if (scene.multisampled() && scaled) {
+        // Resolve at the scene's size first: a multisampled blit can't also scale.
+        RenderTargetDesc resolveDesc = scene.desc();
+        resolveDesc.samples = 1;
+        resolveDesc.depthFormat = GL_NONE;
+        // Each blit overwrites all of its destination: nothing to load first, and the
+        // resolved copy is never stored.
+        if (RenderTarget* resolved = acquire(resolveDesc)) {
+            glframebuffer::discard(resolved->framebuffer(), GL_COLOR_BUFFER_BIT);
+            scene.blitTo(*resolved);
+            glframebuffer::discard(0, GL_COLOR_BUFFER_BIT);
+            resolved->blitTo(0, width, height);
+            glframebuffer::discard(resolved->framebuffer(), GL_COLOR_BUFFER_BIT);
+            release(resolved);
+        }
+    } else {
+        glframebuffer::discard(0, GL_COLOR_BUFFER_BIT);
+        scene.blitTo(0, width, height);
+    }
+    glstate::bindFramebuffer(GL_FRAMEBUFFER, 0);
+    glstate::viewport(0, 0, width, height);
+}
+
+RenderTargetPool::Stats RenderTargetPool::stats() const {
+    Stats s;
+    s.targets = entries_.size();
+    for (const Entry& e : entries_) {
+        s.inUse += e.inUse ? 1 : 0;
+        s.bytes += e.target->bytes();
+    }
+    s.created = created_;
+    s.reused = reused_;
+    return s;
+}
+
+int RenderTargetPool::maxSamples() {
+    GLint samples = 1;
+    glGetIntegerv(GL_MAX_SAMPLES, &samples);
+    return std::max(1, static_cast<int>(samples));
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "render/gl_resource.h"
+
+// RenderTargetDesc
+// ----------------
+// What a RenderTarget is made of. Two targets with equal descs are interchangeable,
+// which is what the pool matches on.
+struct RenderTargetDesc {
+    int width = 0;
+    int height = 0;
+    int samples = 1;                   // > 1: multisampled (MSAA), resolved by blitting
+    GLenum colorFormat = GL_RGBA8;     // integer formats (GL_R32UI ids) are unfiltered
+    GLenum depthFormat = GL_NONE;      // e.g. GL_DEPTH24_STENCIL8; GL_NONE: no depth
+
+    bool operator==(const RenderTargetDesc& o) const {
+        return width == o.width && height == o.height && samples == o.samples &&
+               colorFormat == o.colorFormat && depthFormat == o.depthFormat;
+    }
+};
+
+// RenderTarget
+// ------------
+// An offscreen framebuffer: one color attachment and optionally depth(-stencil).
+//
+// | samples | color attachment                 | depth attachment  | read back by          |
+// | ------- | -------------------------------- | ----------------- | --------------------- |
+// | 1       | texture (linear, clamp): can be  | renderbuffer      | blit, or sampling the |
+// |         | sampled by a later pass          |                   | texture               |
+// | > 1     | multisampled renderbuffer        | multisampled      | blit only: the blit   |
+// |         |                                  | renderbuffer      | IS the MSAA resolve   |
+//
+// resize() reallocates the attachments only when the size actually changes, so calling
+// it every frame with the window's size costs a compare.
+//
+// blitTo() copies the color into another target or the default framebuffer (0). A
+// multisampled source can only be resolved into a destination of the SAME size; scaling
+// it needs a single-sample intermediate (RenderTargetPool::present does both steps).
+class RenderTarget {
+public:
+    bool init(const RenderTargetDesc& desc);
+    void shutdown();
+    // Same attachments at a new size; no-op if it already is this size.
+    bool resize(int width, int height);
+
+    // Binds it for drawing (GL_FRAMEBUFFER) and sets the viewport to all of it.
+    void bind() const;
+
+    // Color of this whole target into (0, 0, width, height) of `framebuffer`, with
+    // GL_LINEAR when the sizes differ. Leaves the draw framebuffer bound to `framebuffer`.
+    void blitTo(GLuint framebuffer, int width, int height) const;
+    void blitTo(const RenderTarget& target) const { blitTo(target.framebuffer(), target.width(), target.height()); }
+
+    GLuint framebuffer() const { return framebuffer_.get(); }
+    GLuint colorTexture() const { return colorTexture_.get(); }   // 0 when multisampled
+    GLuint depthBuffer() const { return depthBuffer_.get(); }     // 0 without depth
+    const RenderTargetDesc& desc() const { return desc_; }
+    int width() const { return desc_.width; }
+    int height() const { return desc_.height; }
+    bool multisampled() const { return desc_.samples > 1; }
+    std::size_t bytes() const;         // approximate GPU memory of the attachments
+
+private:
+    bool allocate();
+
+    RenderTargetDesc desc_;
+    GlFramebuffer framebuffer_;
+    GlTexture colorTexture_;
+    GlRenderbuffer colorBuffer_;
+    GlRenderbuffer depthBuffer_;
+};
+
+// RenderTargetPool
+// ----------------
+// Targets handed out by desc and handed back when a pass is done with them, so a frame's
+// intermediates reuse the same few framebuffers instead of creating new ones:
+//
+//     RenderTarget* scene = pool.acquire(desc);    // idle one with this desc, or a new one
+//     ... draw into it, blit it ...
+//     pool.release(scene);                         // idle again, for this frame or the next
+//     pool.endFrame();                             // once per frame: drops stale idle ones
+//
+// When the window (or the render scale) changes, the old size's targets simply stop
+// being asked for and are destroyed kIdleFrames later; the new size's are created on
+// first acquire. GL names go through the deletion queue (render/gl_resource.h), so a
+// target dropped while the GPU still reads it is not a stall.
+//
+// present() is the usual end of a scene pass: resolve (MSAA) and/or scale the scene into
+// the default framebuffer, with a pooled single-sample target in between when it needs
+// both.
+class RenderTargetPool {
+public:
+    static constexpr int kIdleFrames = 8;
+
+    struct Stats {
+        std::size_t targets = 0;       // alive: in use + idle
+        std::size_t inUse = 0;
+        std::size_t bytes = 0;
+        std::uint64_t created = 0;     // since startup
+        std::uint64_t reused = 0;      // acquires served by an idle target
+    };
+
+    RenderTarget* acquire(const RenderTargetDesc& desc);
+    void release(RenderTarget* target);
+    void endFrame();
+    void shutdown();
+
+    // `scene` into the default framebuffer at width x height (leaves it bound, with the
+    // viewport set to it).
+    void present(const RenderTarget& scene, int width, int height);
+
+    Stats stats() const;
+
+    // The most samples this driver supports (GL_MAX_SAMPLES), at least 1.
+    static int maxSamples();
+
+private:
+    struct Entry {
+        std::unique_ptr<RenderTarget> target;
+        RenderTargetDesc requested;    // matched on this: init() may have clamped the samples
+        bool inUse = false;
+        std::uint64_t lastUsed = 0;    // frame
+    };
+
+    std::vector<Entry> entries_;
+    std::uint64_t frame_ = 0;
+    std::uint64_t created_ = 0;
+    std::uint64_t reused_ = 0;
+};
@@ -0,0 +1,117 @@
+#include "render/render_thread.h"
+
+#include <GLFW/glfw3.h>
+#include <chrono>
+#include <iostream>
+#include <system_error>
+
+#include "core/thread_affinity.h"
+#include "profile/trace.h"
+#include "render/gl_state.h"
+
+namespace {
+double msSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+} // namespace
+
+bool RenderThread::start(GLFWwindow* window, RenderFn render, bool threaded) {
+    if (started_) {
+        return true;
+    }
+    window_ = window;
+    render_ = std::move(render);
+    stopping_ = false;
+    started_ = true;
+    if (!threaded) {
+        return true;
+    }
+
+    glfwMakeContextCurrent(nullptr); // a context is current on at most one thread
+    try {
+        thread_ = std::thread(&RenderThread::threadMain, this);
+    } catch (const std::system_error& e) {
+        std::cerr << "RenderThread: could not start (" << e.what() << "), rendering inline\n";
+        glfwMakeContextCurrent(window_);
+    }
+    return true;
+}
+
+void RenderThread::stop() {
+    if (!started_) {
+        return;
+    }
+    if (thread_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        changed_.notify_all();
+        thread_.join();             // renders everything still pending first
+        glfwMakeContextCurrent(window_);
+        glstate::invalidate();      // this thread's cache is from before start()
+    }
+    started_ = false;
+}
+
+FramePacket& RenderThread::acquire() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (state_[write_] != State::Free) {
+        const auto start = std::chrono::steady_clock::now();
+        trace::Scope span("wait for render");
+        changed_.wait(lock, [&] { return state_[write_] == State::Free; });
+        stats_.acquireWaitMs += msSince(start);
+    }
+    return packets_[write_];
+}
+
+void RenderThread::submit() {
+    FramePacket& packet = packets_[write_];
+    if (!thread_.joinable()) {
+        render_(packet);
+        ++stats_.frames;
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        state_[write_] = State::Pending;
+        write_ ^= 1;
+    }
+    changed_.notify_all();
+}
+
+RenderThread::Stats RenderThread::stats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void RenderThread::threadMain() {
+    trace::setThreadName("render");
+    affinity::pinThisThread(affinity::Role::Render);
+    glfwMakeContextCurrent(window_);
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (state_[read_] != State::Pending) {
+                const auto start = std::chrono::steady_clock::now();
+                changed_.wait(lock, [&] { return state_[read_] == State::Pending || stopping_; });
+                stats_.renderIdleMs += msSince(start);
+            }
+            if (state_[read_] != State::Pending) {
+                break; // stopping, nothing left to draw
+            }
+            state_[read_] = State::Rendering;
+        }
+
+        render_(packets_[read_]);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            state_[read_] = State::Free;
+            read_ ^= 1;
+            ++stats_.frames;
+        }
+        changed_.notify_all();
+    }
+    glfwMakeContextCurrent(nullptr);
+}
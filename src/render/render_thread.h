@@ -0,0 +1,86 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "render/frame_packet.h"
+
+struct GLFWwindow;
+
+// RenderThread
+// ------------
+// Owns the GL context after start() and draws FramePackets that the main thread hands it,
+// so simulation of frame N+1 overlaps GL submission of frame N:
+//
+//     main:    │ sim+build N │ sim+build N+1 │ sim+build N+2 │
+//     render:                │   draw N      │   draw N+1    │   draw N+2
+//
+// Frame time becomes max(sim, render) instead of their sum, for one frame of extra
+// latency. Two packets alternate:
+//
+//     FramePacket& p = renderThread.acquire();   // waits only while p is still being drawn
+//     ... fill p ...
+//     renderThread.submit();                     // p goes to the render thread
+//
+// | Packet state | Owner         | Next                                       |
+// | ------------ | ------------- | ------------------------------------------ |
+// | free         | main          | acquire() returns it                       |
+// | pending      | (queued)      | render thread takes it                     |
+// | rendering    | render thread | free when render(packet) returns           |
+//
+// acquire() blocking = the render side is the bottleneck (GPU, vsync); the render thread
+// idling = the simulation side is. Both times are in stats().
+//
+// start(window, render, false) keeps everything on the calling thread: submit() calls
+// render(packet) right away. Same code path, no overlap—for comparison and debugging.
+//
+// The context moves: the caller creates resources with it current, start() releases it
+// and the render thread makes it current; stop() renders what was submitted, joins, and
+// makes it current on the caller again so resources can be destroyed there.
+class RenderThread {
+public:
+    using RenderFn = std::function<void(FramePacket& packet)>;
+
+    struct Stats {
+        double acquireWaitMs = 0.0; // total time main waited for a free packet
+        double renderIdleMs = 0.0;  // total time the render thread waited for work
+        std::uint64_t frames = 0;   // packets rendered
+    };
+
+    RenderThread() = default;
+    ~RenderThread() { stop(); }
+    RenderThread(const RenderThread&) = delete;
+    RenderThread& operator=(const RenderThread&) = delete;
+
+    bool start(GLFWwindow* window, RenderFn render, bool threaded = true);
+    void stop();
+
+    FramePacket& acquire();
+    void submit();
+
+    bool threaded() const { return thread_.joinable(); }
+    Stats stats();
+
+private:
+    enum class State : std::uint8_t { Free, Pending, Rendering };
+
+    void threadMain();
+
+    GLFWwindow* window_ = nullptr;
+    RenderFn render_;
+    std::thread thread_;
+    bool started_ = false;
+
+    FramePacket packets_[2];
+    State state_[2] = {State::Free, State::Free};
+    int write_ = 0;               // packet main fills next
+    int read_ = 0;                // packet the render thread takes next
+    bool stopping_ = false;
+
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    Stats stats_;
+};
@@ -0,0 +1,166 @@
+#include "render/sdf_font.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include "render/gl_state.h"
+#include "render/gpu_memory.h"
+
+namespace {
+
+constexpr int kGlyphCount = SdfFont::kLastChar - SdfFont::kFirstChar + 1;
+constexpr int kCellsPerRow = 16;
+
+// The classic 5x7 LCD font, ' ' .. '~'. One byte per column, left to right; bit 0 is the
+// top row.
+constexpr std::uint8_t kFont5x7[kGlyphCount][SdfFont::kGlyphColumns] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x5F, 0x00, 0x00}, {0x00, 0x07, 0x00, 0x07, 0x00}, // ' ' ! "
+    {0x14, 0x7F, 0x14, 0x7F, 0x14}, {0x24, 0x2A, 0x7F, 0x2A, 0x12}, {0x23, 0x13, 0x08, 0x64, 0x62}, // # $ %
+    {0x36, 0x49, 0x56, 0x20, 0x50}, {0x00, 0x05, 0x03, 0x00, 0x00}, {0x00, 0x1C, 0x22, 0x41, 0x00}, // & ' (
+    {0x00, 0x41, 0x22, 0x1C, 0x00}, {0x14, 0x08, 0x3E, 0x08, 0x14}, {0x08, 0x08, 0x3E, 0x08, 0x08}, // ) * +
+    {0x00, 0x50, 0x30, 0x00, 0x00}, {0x08, 0x08, 0x08, 0x08, 0x08}, {0x00, 0x60, 0x60, 0x00, 0x00}, // , - .
+    {0x20, 0x10, 0x08, 0x04, 0x02}, {0x3E, 0x51, 0x49, 0x45, 0x3E}, {0x00, 0x42, 0x7F, 0x40, 0x00}, // / 0 1
+    {0x42, 0x61, 0x51, 0x49, 0x46}, {0x21, 0x41, 0x45, 0x4B, 0x31}, {0x18, 0x14, 0x12, 0x7F, 0x10}, // 2 3 4
+    {0x27, 0x45, 0x45, 0x45, 0x39}, {0x3C, 0x4A, 0x49, 0x49, 0x30}, {0x01, 0x71, 0x09, 0x05, 0x03}, // 5 6 7
+    {0x36, 0x49, 0x49, 0x49, 0x36}, {0x06, 0x49, 0x49, 0x29, 0x1E}, {0x00, 0x36, 0x36, 0x00, 0x00}, // 8 9 :
+    {0x00, 0x56, 0x36, 0x00, 0x00}, {0x08, 0x14, 0x22, 0x41, 0x00}, {0x14, 0x14, 0x14, 0x14, 0x14}, // ; < =
+    {0x00, 0x41, 0x22, 0x14, 0x08}, {0x02, 0x01, 0x51, 0x09, 0x06}, {0x32, 0x49, 0x79, 0x41, 0x3E}, // > ? @
+    {0x7E, 0x11, 0x11, 0x11, 0x7E}, {0x7F, 0x49, 0x49, 0x49, 0x36}, {0x3E, 0x41, 0x41, 0x41, 0x22}, // A B C
+    {0x7F, 0x41, 0x41, 0x22, 0x1C}, {0x7F, 0x49, 0x49, 0x49, 0x41}, {0x7F, 0x09, 0x09, 0x09, 0x01}, // D E F
+    {0x3E, 0x41, 0x49, 0x49, 0x7A}, {0x7F, 0x08, 0x08, 0x08, 0x7F}, {0x00, 0x41, 0x7F, 0x41, 0x00}, // G H I
+    {0x20, 0x40, 0x41, 0x3F, 0x01}, {0x7F, 0x08, 0x14, 0x22, 0x41}, {0x7F, 0x40, 0x40, 0x40, 0x40}, // J K L
+    {0x7F, 0x02, 0x0C, 0x02, 0x7F}, {0x7F, 0x04, 0x08, 0x10, 0x7F}, {0x3E, 0x41, 0x41, 0x41, 0x3E}, // M N O
+    {0x7F, 0x09, 0x09, 0x09, 0x06}, {0x3E, 0x41, 0x51, 0x21, 0x5E}, {0x7F, 0x09, 0x19, 0x29, 0x46}, // P Q R
+    {0x46, 0x49, 0x49, 0x49, 0x31}, {0x01, 0x01, 0x7F, 0x01, 0x01}, {0x3F, 0x40, 0x40, 0x40, 0x3F}, // S T U
+    {0x1F, 0x20, 0x40, 0x20, 0x1F}, {0x3F, 0x40, 0x38, 0x40, 0x3F}, {0x63, 0x14, 0x08, 0x14, 0x63}, // V W X
+    {0x07, 0x08, 0x70, 0x08, 0x07}, {0x61, 0x51, 0x49, 0x45, 0x43}, {0x00, 0x7F, 0x41, 0x41, 0x00}, // Y Z [
+    {0x02, 0x04, 0x08, 0x10, 0x20}, {0x00, 0x41, 0x41, 0x7F, 0x00}, {0x04, 0x02, 0x01, 0x02, 0x04}, // \ ] ^
+    {0x40, 0x40, 0x40, 0x40, 0x40}, {0x00, 0x01, 0x02, 0x04, 0x00}, {0x20, 0x54, 0x54, 0x54, 0x78}, // _ ` a
+    {0x7F, 0x48, 0x44, 0x44, 0x38}, {0x38, 0x44, 0x44, 0x44, 0x20}, {0x38, 0x44, 0x44, 0x48, 0x7F}, // b c d
+    {0x38, 0x54, 0x54, 0x54, 0x18}, {0x08, 0x7E, 0x09, 0x01, 0x02}, {0x0C, 0x52, 0x52, 0x52, 0x3E}, // e f g
+    {0x7F, 0x08, 0x04, 0x04, 0x78}, {0x00, 0x44, 0x7D, 0x40, 0x00}, {0x20, 0x40, 0x44, 0x3D, 0x00}, // h i j
+    {0x7F, 0x10, 0x28, 0x44, 0x00}, {0x00, 0x41, 0x7F, 0x40, 0x00}, {0x7C, 0x04, 0x18, 0x04, 0x78}, // k l m
+    {0x7C, 0x08, 0x04, 0x04, 0x78}, {0x38, 0x44, 0x44, 0x44, 0x38}, {0x7C, 0x14, 0x14, 0x14, 0x08}, // n o p
+    {0x08, 0x14, 0x14, 0x18, 0x7C}, {0x7C, 0x08, 0x04, 0x04, 0x08}, {0x48, 0x54, 0x54, 0x54, 0x20}, // q r s
+    {0x04, 0x3F, 0x44, 0x40, 0x20}, {0x3C, 0x40, 0x40, 0x20, 0x7C}, {0x1C, 0x20, 0x40, 0x20, 0x1C}, // t u v
+    {0x3C, 0x40, 0x30, 0x40, 0x3C}, {0x44, 0x28, 0x10, 0x28, 0x44}, {0x0C, 0x50, 0x50, 0x50, 0x3C}, // w x y
+    {0x44, 0x64, 0x54, 0x4C, 0x44}, {0x00, 0x08, 0x36, 0x41, 0x00}, {0x00, 0x00, 0x7F, 0x00, 0x00}, // z { |
+    {0x00, 0x41, 0x36, 0x08, 0x00}, {0x10, 0x08, 0x08, 0x10, 0x08},                                  // } ~
+};
+
+bool pixelOn(int glyph, int column, int row) { // row 0 = top
+    return (kFont5x7[glyph][column] >> row) & 1;
+}
+
+// Distance from p to the axis-aligned square [min, min + size]^2 (0 inside).
+float distanceToSquare(const glm::vec2& p, const glm::vec2& min, float size) {
+    const float dx = std::max({min.x - p.x, 0.0f, p.x - (min.x + size)});
+    const float dy = std::max({min.y - p.y, 0.0f, p.y - (min.y + size)});
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+} // namespace
+
+std::vector<std::uint8_t> SdfFont::generate(const Options& options, int& width, int& height) {
+    const int scale = std::max(1, options.pixelScale);
+    const int spread = std::max(1, options.spread);
+    const int cellWidth = kGlyphColumns * scale + 2 * spread;
+    const int cellHeight = kGlyphRows * scale + 2 * spread;
+    const int cellRows = (kGlyphCount + kCellsPerRow - 1) / kCellsPerRow;
+    width = kCellsPerRow * cellWidth;
+    height = cellRows * cellHeight;
+    std::vector<std::uint8_t> texels(static_cast<std::size_t>(width) * height, 0);
+
+    const float s = static_cast<float>(scale);
+    const glm::vec2 boxMin(static_cast<float>(spread));     // glyph box, in cell texels
+    const glm::vec2 boxMax = boxMin + s * glm::vec2(kGlyphColumns, kGlyphRows);
+    for (int glyph = 0; glyph < kGlyphCount; ++glyph) {
+        const int cellX = (glyph % kCellsPerRow) * cellWidth;
+        const int cellY = (glyph / kCellsPerRow) * cellHeight;
+        for (int y = 0; y < cellHeight; ++y) {
+            for (int x = 0; x < cellWidth; ++x) {
+                const glm::vec2 p(x + 0.5f, y + 0.5f);
+                float toInk = static_cast<float>(spread);       // nearest on square (outside)
+                float toEmpty = std::min({p.x - boxMin.x, boxMax.x - p.x, // ... off square or the
+                                          p.y - boxMin.y, boxMax.y - p.y}); // box edge (inside)
+                bool inside = toEmpty > 0.0f;
+                bool covered = false;
+                for (int row = 0; row < kGlyphRows; ++row) {
+                    for (int column = 0; column < kGlyphColumns; ++column) {
+                        // Texture rows go up, font rows go down.
+                        const glm::vec2 min = boxMin + s * glm::vec2(column, kGlyphRows - 1 - row);
+                        const float d = distanceToSquare(p, min, s);
+                        if (pixelOn(glyph, column, row)) {
+                            toInk = std::min(toInk, d);
+                            covered = covered || d == 0.0f;
+                        } else if (inside) {
+                            toEmpty = std::min(toEmpty, d);
+                        }
+                    }
+                }
+                const float signedDistance = covered ? toEmpty : -toInk;
+                const float value = 0.5f + 0.5f * glm::clamp(signedDistance / spread, -1.0f, 1.0f);
+                texels[static_cast<std::size_t>(cellY + y) * width + cellX + x] =
+                    static_cast<std::uint8_t>(value * 255.0f + 0.5f);
+            }
+        }
+    }
+    return texels;
+}
+
+bool SdfFont::init(const Options& options) {
+    const gpumemory::Owner owner("font");
+    shutdown();
+    const std::vector<std::uint8_t> texels = generate(options, width_, height_);
+    const int scale = std::max(1, options.pixelScale);
+    const int spread = std::max(1, options.spread);
+    cellWidth_ = kGlyphColumns * scale + 2 * spread;
+    cellHeight_ = kGlyphRows * scale + 2 * spread;
+    border_ = static_cast<float>(spread) / static_cast<float>(scale);
+    cellSize_ = glm::vec2(kGlyphColumns, kGlyphRows) + 2.0f * border_;
+    // '|' is column 2 of every row; row 3 is the middle (texture rows go up, so 7 - 1 - 3).
+    const int bar = '|' - kFirstChar;
+    const glm::vec2 solid((bar % kCellsPerRow) * cellWidth_ + spread + 2.5f * scale,
+                          (bar / kCellsPerRow) * cellHeight_ + spread + 3.5f * scale);
+    solidUv_ = glm::vec4(solid.x / width_, solid.y / height_, solid.x / width_, solid.y / height_);
+
+    texture_ = GlTexture::create();
+    if (!texture_) {
+        std::cerr << "SdfFont: failed to create the atlas texture\n";
+        return false;
+    }
+    glstate::bindTexture(GL_TEXTURE_2D, texture_.get());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);   // rows of single bytes
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width_, height_, 0, GL_RED, GL_UNSIGNED_BYTE, texels.data());
+    gpumemory::track(GlObject::Texture, texture_.get(), gpumemory::textureBytes(GL_R8, width_, height_),
+                     gpumemory::Category::Texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    // Linear: interpolated distances are what keeps the outline straight when magnified.
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glstate::bindTexture(GL_TEXTURE_2D, 0);
+    return true;
+}
+
+void SdfFont::shutdown() {
+    texture_.reset();
+    width_ = height_ = 0;
+    solidUv_ = glm::vec4(0.0f);
+}
+
+glm::vec4 SdfFont::uvRect(char c) const {
+    int glyph = static_cast<unsigned char>(c) - kFirstChar;
+    if (glyph < 0 || glyph >= kGlyphCount) {
+        glyph = '?' - kFirstChar;
+    }
+    if (width_ == 0 || height_ == 0) {
+        return glm::vec4(0.0f);
+    }
+    const float u0 = static_cast<float>((glyph % kCellsPerRow) * cellWidth_) / width_;
+    const float v0 = static_cast<float>((glyph / kCellsPerRow) * cellHeight_) / height_;
+    return glm::vec4(u0, v0, u0 + static_cast<float>(cellWidth_) / width_,
+                     v0 + static_cast<float>(cellHeight_) / height_);
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "render/gl_resource.h"
+
+// SdfFont
+// -------
+// A signed distance field (SDF) glyph atlas for printable ASCII (32..126), generated at
+// startup from a built-in 5x7 pixel font. Every texel stores how far its centre is from
+// the glyph's outline instead of whether it is covered:
+//
+//     stored = 0.5 + 0.5 * signedDistance / spread      (inside > 0.5, outline = 0.5)
+//
+// Bilinear filtering interpolates distances, and distances interpolate back into a
+// straight outline, so the fragment stage (fragment.glsl built with SDF) can cut the
+// edge at 0.5 with a one-pixel smoothstep at ANY size. Coverage bitmaps blur when
+// magnified and alias when minified; one small SDF atlas stays sharp across sizes:
+//
+// | Atlas            | Texels per glyph | Scales to            | Memory (95 glyphs)    |
+// | ---------------- | ---------------- | -------------------- | --------------------- |
+// | coverage, 1 size | exactly one size | blurry / aliased     | one atlas per size    |
+// | SDF (this)       | 32 x 40, R8      | ~8 px .. hundreds    | one 512 x 240 R8      |
+//
+// The distances here are exact: the glyph is a union of font-pixel squares, so each
+// texel's distance is the distance to the nearest square (outside) or to the nearest
+// empty square or the glyph box's edge (inside). Cells are laid out 16 per row, one
+// `spread` of empty border around each glyph so neighbours never bleed into each other.
+class SdfFont {
+public:
+    static constexpr int kFirstChar = 32;
+    static constexpr int kLastChar = 126;
+    static constexpr int kGlyphColumns = 5;   // font pixels
+    static constexpr int kGlyphRows = 7;
+    static constexpr int kAdvance = 6;        // font pixels from one glyph to the next
+    static constexpr int kLineHeight = 9;
+
+    struct Options {
+        int pixelScale = 4;    // atlas texels per font pixel
+        int spread = 6;        // texels of distance stored on each side of the outline
+    };
+
+    // CPU only: the R8 atlas, row 0 at the bottom (GL order).
+    static std::vector<std::uint8_t> generate(const Options& options, int& width, int& height);
+
+    // GL thread: generates and uploads the atlas (linear filtering, no mipmaps).
+    bool init(const Options& options);
+    bool init() { return init(Options{}); }
+    void shutdown();
+
+    GLuint texture() const { return texture_.get(); }
+    // (u0, v0, u1, v1) of the character's whole cell, border included (Sprite::uvRect).
+    // Characters outside 32..126 map to '?'.
+    glm::vec4 uvRect(char c) const;
+    // The cell's size in font pixels (the glyph plus the border on both sides): a glyph
+    // quad drawn this big lines its outline up with the font-pixel grid.
+    glm::vec2 cellSize() const { return cellSize_; }
+    glm::vec2 cellOffset() const { return glm::vec2(-border_); } // quad corner vs. glyph corner
+    // A single point deep inside an inked font pixel (the middle of '|'), as a uvRect:
+    // every fragment of a quad drawn with it samples the same "inside" distance, so it
+    // comes out solid. Boxes and bars drawn with this share the text's texture and draw.
+    glm::vec4 solidUv() const { return solidUv_; }
+
+private:
+    GlTexture texture_;
+    int width_ = 0;
+    int height_ = 0;
+    int cellWidth_ = 0;        // texels
+    int cellHeight_ = 0;
+    float border_ = 0.0f;      // spread, in font pixels
+    glm::vec2 cellSize_{0.0f};
+    glm::vec4 solidUv_{0.0f};
+};
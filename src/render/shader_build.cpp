@@ -0,0 +1,484 @@
+#include "render/shader_build.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+#include "render/gl_ext.h"
+#include "render/gl_state.h"
+#include "render/shader_layout.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double msSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+std::string fileName(const std::string& path) {
+    const std::size_t slash = path.find_last_of('/');
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+// Blocks until the compile is done, without logging: finishProgram's timed wait.
+bool compileStatus(GLuint shader) {
+    GLint pass = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &pass);
+    return pass == GL_TRUE;
+}
+
+bool identifierChar(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+std::string trimmed(const std::string& text) {
+    const std::size_t first = text.find_first_not_of(" \t");
+    if (first == std::string::npos) {
+        return {};
+    }
+    return text.substr(first, text.find_last_not_of(" \t") - first + 1);
+}
+
+// `code` without any `binding = N` layout qualifier; a `layout ()` left empty goes too.
+std::string withoutBindings(const std::string& code) {
+    std::string out;
+    out.reserve(code.size());
+    std::size_t copied = 0;
+    for (std::size_t at = code.find("layout"); at != std::string::npos; at = code.find("layout", at + 1)) {
+        if ((at > 0 && identifierChar(code[at - 1])) || (at + 6 < code.size() && identifierChar(code[at + 6]))) {
+            continue;
+        }
+        const std::size_t open = code.find_first_not_of(" \t", at + 6);
+        const std::size_t close = open == std::string::npos ? open : code.find(')', open);
+        if (close == std::string::npos || code[open] != '(') {
+            continue;
+        }
+        std::string kept;
+        bool dropped = false;
+        std::size_t start = open + 1;
+        while (start <= close) {
+            std::size_t comma = code.find(',', start);
+            if (comma == std::string::npos || comma > close) {
+                comma = close;
+            }
+            const std::string qualifier = trimmed(code.substr(start, comma - start));
+            if (qualifier.compare(0, 7, "binding") == 0 && (qualifier.size() == 7 || !identifierChar(qualifier[7]))) {
+                dropped = true;
+            } else if (!qualifier.empty()) {
+                kept += (kept.empty() ? "" : ", ") + qualifier;
+            }
+            start = comma + 1;
+        }
+        if (!dropped) {
+            continue;
+        }
+        out.append(code, copied, at - copied);
+        std::size_t end = close + 1;
+        if (kept.empty()) {
+            end = code.find_first_not_of(" \t", end);   // `layout (binding = 0) uniform` → `uniform`
+        } else {
+            out += "layout (" + kept + ")";
+        }
+        copied = end;
+        at = close;
+    }
+    out.append(code, copied, std::string::npos);
+    return out;
+}
+
+// One stage's preprocessed source as this context compiles it (see "Explicit bindings"
+// in the header): #version 420+ as it is; otherwise with the extension, or without
+// the bindings.
+std::string withBindings(const std::string& code) {
+    const std::size_t version = code.find("#version");
+    if (version == std::string::npos || std::atoi(code.c_str() + version + 8) >= 420) {
+        return code;
+    }
+    if (!glext::caps().explicitBindings) {
+        return withoutBindings(code);
+    }
+    // Right after #version: before the defines, whose #line renumbers what follows.
+    std::string out = code;
+    std::size_t eol = out.find('\n', version);
+    if (eol == std::string::npos) {
+        eol = out.size();
+        out += '\n';
+    }
+    out.insert(eol + 1, "#extension GL_ARB_shading_language_420pack : require\n");
+    return out;
+}
+
+} // namespace
+
+// Note: TECHNICALLY, you could just directly hardcode shader code as a set of strings.
+// This would work perfectly fine. However:
+// External files let you:
+//     Reload shaders on the fly (especially during development)
+//     Swap shaders without touching your engine code
+//     Compile tools that preprocess or validate your shader files
+
+// compileShader(...)
+// ------------------
+// source:      The GLSL source code (preprocessed, see render/shader_preprocessor.h).
+// shaderType:  Type of shader to compile (e.g. GL_VERTEX_SHADER or GL_FRAGMENT_SHADER)
+//
+// Purpose: Creates, attaches, and compiles a shader of the given type using the provided GLSL source.
+// Returns: GLuint ID of the shader object. The compile may still be running (see
+//          PendingProgram below); its result is only known after shaderCompiled().
+
+GLuint compileShader(const std::string& source, GLenum shaderType){
+    // | `shaderType`         | Meaning                               |
+    // | -------------------- | ------------------------------------- |
+    // | `GL_VERTEX_SHADER`   | Vertex shader stage (runs per vertex) |
+    // | `GL_FRAGMENT_SHADER` | Fragment (pixel) shader               |
+    // | `GL_GEOMETRY_SHADER` | Optional stage (more advanced)        |
+    // | etc.                 | (e.g., tessellation, compute)         |
+
+    GLuint shader = glCreateShader(shaderType);
+    const GLchar* text = source.data();
+    const GLint length = static_cast<GLint>(source.size());
+    glShaderSource(shader, 1, &text, &length);
+    // void glShaderSource(GLuint shader,
+    //     GLsizei count,
+    //     const GLchar* const* string,
+    //     const GLint* length);
+
+    // | Parameter | Meaning                                                      |
+    // | --------- | ------------------------------------------------------------ |
+    // | `shader`  | The shader object to attach source code to                   |
+    // | `count`   | Number of strings passed (usually 1)                         |
+    // | `string`  | An array of `char*` pointers (C-strings holding GLSL source) |
+    // | `length`  | Optional: array of lengths for each string                   |
+
+    // If you pass nullptr for length, OpenGL assumes:
+
+    // “Each string in string[] is null-terminated. I’ll keep reading until I hit \0.”
+
+    // | Question                         | Answer                                                                       |
+    // | -------------------------------- | ---------------------------------------------------------------------------- |
+    // | Why pass `nullptr` for `length`? | It tells OpenGL “just treat this as a null-terminated C-string.”             |
+    // | Is that safe?                    | ✅ Yes—*if* the source string is cleanly null-terminated (as from `.c_str()`) |
+    // | When would I pass real lengths?  | When using multiple strings or substrings, or embedded nulls                 |
+
+    // We pass the real length: std::string already knows it, so the driver doesn't have
+    // to scan the whole source for the '\0' first, and a buffer that isn't terminated
+    // (a view into a larger one) works too.
+
+    glCompileShader(shader);
+    // No status query here: glGetShaderiv(GL_COMPILE_STATUS) would wait for this compile
+    // to finish before the next one is even submitted. shaderCompiled() checks it later.
+
+    return shader;
+}
+
+// shaderCompiled(...)
+// -------------------
+// Blocks until `shader`'s compile is done; logs the compiler output if it failed.
+bool shaderCompiled(GLuint shader) {
+    int pass;
+    // Checks status of a shader 
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &pass);
+
+    // | Parameter | Type     | Purpose                                                |
+    // | --------- | -------- | ------------------------------------------------------ |
+    // | `shader`  | `GLuint` | The ID of the shader object you want to query          |
+    // | `pname`   | `GLenum` | What property you want to query (e.g., compile status) |
+    // | `params`  | `GLint*` | Pointer to an integer where the result will be stored  |
+
+    // | `pname`                   | Meaning                                                                  |
+    // | ------------------------- | ------------------------------------------------------------------------ |
+    // | `GL_COMPILE_STATUS`       | Whether the shader compiled successfully (`GL_TRUE` or `GL_FALSE`)       |
+    // | `GL_SHADER_TYPE`          | Whether it's a vertex, fragment, geometry shader, etc.                   |
+    // | `GL_DELETE_STATUS`        | Whether the shader has been flagged for deletion                         |
+    // | `GL_INFO_LOG_LENGTH`      | Number of characters in the shader’s info log (compile errors, warnings) |
+    // | `GL_SHADER_SOURCE_LENGTH` | Length of the source code (if stored)                                    |
+
+    if(!pass){
+        // Compile failed
+        std::cerr << "Shader compilation failed:\n" << shaderInfoLog(shader) << "\n";
+    }
+    return pass != 0;
+
+}
+
+// shaderInfoLog(...) / programInfoLog(...)
+// ----------------------------------------
+// The complete compiler / linker output. GL_INFO_LOG_LENGTH includes the terminating
+// '\0'; 0 means there is no log at all. A fixed char[512] would cut off the end, which
+// with #included files is often where the first real error is reported.
+std::string shaderInfoLog(GLuint shader) {
+    GLint length = 0;
+    glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+    if (length <= 1) {
+        return std::string();
+    }
+    std::string log(static_cast<std::size_t>(length), '\0');
+    GLsizei written = 0;
+    glGetShaderInfoLog(shader, length, &written, &log[0]);
+    log.resize(static_cast<std::size_t>(written));
+    return log;
+}
+
+std::string programInfoLog(GLuint program) {
+    GLint length = 0;
+    glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+    if (length <= 1) {
+        return std::string();
+    }
+    std::string log(static_cast<std::size_t>(length), '\0');
+    GLsizei written = 0;
+    glGetProgramInfoLog(program, length, &written, &log[0]);
+    log.resize(static_cast<std::size_t>(written));
+    return log;
+}
+
+// linkProgram(...)
+// ----------------
+// vertexShader:   ID of a compiled vertex shader (from glCreateShader + glCompileShader)
+// fragmentShader: ID of a compiled fragment shader
+// feedbackVaryings: vertex outputs to capture with transform feedback (usually none)
+//
+// Purpose:
+//   - Creates a shader program object.
+//   - Attaches the provided shaders.
+//   - Links them into a single executable GPU pipeline.
+//
+// Returns: GLuint ID of the shader program, possibly still linking. programLinked()
+//          checks the result and deletes the shaders; only after that pass it to
+//          glUseProgram(...).
+
+GLuint linkProgram(GLuint vertexShader, GLuint fragmentShader, const std::vector<std::string>& feedbackVaryings) {
+    // Create a program object to link shaders into.
+    // Think of this like allocating a "pipeline object" that will represent your final shader program.
+    GLuint program = glCreateProgram();
+    // Ask for a binary the ProgramCache can save (no-op without ARB_get_program_binary).
+    ProgramCache::markRetrievable(program);
+
+    // Attach the already compiled vertex and fragment shaders to the program.
+    // These are just attachments at this stage—the actual linking hasn't happened yet.
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    // This doesn’t copy its contents—it’s still a reference to the original shader.
+
+    // Which outputs transform feedback writes is fixed at link time, so it's set before
+    // glLinkProgram (and kept in a cached binary, like everything else the link decided).
+    if (!feedbackVaryings.empty()) {
+        std::vector<const GLchar*> names;
+        for (const std::string& name : feedbackVaryings) {
+            names.push_back(name.c_str());
+        }
+        glTransformFeedbackVaryings(program, static_cast<GLsizei>(names.size()), names.data(),
+                                    GL_INTERLEAVED_ATTRIBS);
+    }
+
+    // Link the attached shader stages into a final shader program.
+    // This performs validation, matches inputs/outputs, resolves locations, and finalizes GPU-side code.
+    glLinkProgram(program);
+    // If linking fails, it's usually because:
+
+    // Vertex shader outputs don’t match fragment shader inputs
+    // Multiple main() definitions
+    // Using variables or functions inconsistently
+
+    // | Term                        | Summary 
+    // | --------------------------- | -------------------------------------------------------------------------------------------- |
+    // | **Attaching**               | Adds compiled shader stages to a program object. No validation.                              |
+    // | **Linking**                 | Finalizes the GPU pipeline by stitching stages together. Must be done before `glUseProgram`. |
+    // | When is the program usable? | **Only after linking succeeds**                                                              |
+
+    // Shader Program Stages Summary:
+    // ------------------------------
+    // glAttachShader → Stage compiled shader(s) for linking (not usable yet)
+    // glLinkProgram  → Validate & finalize the shader pipeline (now usable)
+    // Must glUseProgram(...) after linking to activate
+
+
+    // As with compileShader, the result is checked later (programLinked), so the driver
+    // can keep compiling and linking the other programs meanwhile.
+
+    // Return the program ID so it can be used with glUseProgram(...) in rendering.
+    return program;
+}
+
+// programLinked(...)
+// ------------------
+// Blocks until `program`'s link is done, logs what went wrong if it failed, and deletes
+// the two shaders it was linked from.
+bool programLinked(GLuint program, GLuint vertexShader, GLuint fragmentShader) {
+    // Check whether the program linking was successful.
+    int success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success); // similar to Shaderiv
+
+    // If linking failed, retrieve the error log from the GPU and output it to the console.
+    // A failed compile fails the link too: report the shaders' own logs first.
+    if (!success) {
+        shaderCompiled(vertexShader);
+        shaderCompiled(fragmentShader);
+        // Any linker output (errors, warnings, etc.), however long.
+        std::cerr << "Shader linking failed:\n" << programInfoLog(program) << '\n';
+    }
+
+    // Once linked, the individual shaders are no longer needed.
+    // The GPU retains the compiled logic inside the program, and the original shader objects can be deleted.
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+    return success != 0;
+}
+
+GLuint buildComputeProgram(const std::string& path, const ShaderVariant& variant) {
+    ShaderSource source;
+    std::string error;
+    if (!preprocessShader(path, variant, source, &error)) {
+        std::cerr << "Shader preprocessing failed: " << error << "\n";
+        return 0;
+    }
+    const GLuint shader = compileShader(source.code, GL_COMPUTE_SHADER);
+    if (!shaderCompiled(shader)) {
+        std::cerr << "  in " << describeFiles(source) << "\n";
+        glDeleteShader(shader);
+        return 0;
+    }
+    GLuint program = glCreateProgram();
+    glAttachShader(program, shader);
+    glLinkProgram(program);
+    GLint linked = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    glDeleteShader(shader);            // the program keeps what it needs
+    if (!linked) {
+        std::cerr << "Compute program linking failed (" << fileName(path) << "):\n" << programInfoLog(program) << '\n';
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+void applyBindings(GLuint program) {
+    if (glext::caps().explicitBindings) {
+        return;
+    }
+    for (const shaderlayout::Binding& block : shaderlayout::kBlockBindings) {
+        const GLuint index = glGetUniformBlockIndex(program, block.name);
+        if (index != GL_INVALID_INDEX) {
+            glUniformBlockBinding(program, index, block.binding);
+        }
+    }
+    glstate::useProgram(program);      // glUniform* sets the bound program's
+    for (const shaderlayout::Binding& sampler : shaderlayout::kSamplerBindings) {
+        const GLint location = glGetUniformLocation(program, sampler.name);
+        if (location >= 0) {
+            glUniform1i(location, static_cast<GLint>(sampler.binding));
+        }
+    }
+}
+
+bool loadProgramSources(const ProgramDesc& desc, ShaderSource& vertex, ShaderSource& fragment) {
+    std::string error;
+    if (!preprocessShader(desc.vertexPath, desc.variant, vertex, &error) ||
+        !preprocessShader(desc.fragmentPath, desc.variant, fragment, &error)) {
+        std::cerr << "Shader preprocessing failed: " << error << "\n";
+        return false;
+    }
+    return true;
+}
+
+std::string describeProgram(const ProgramDesc& desc) {
+    std::string name = fileName(desc.vertexPath) + " + " + fileName(desc.fragmentPath);
+    const std::string variant = describeVariant(desc.variant);
+    return variant.empty() ? name : name + " [" + variant + "]";
+}
+
+ProgramSources prepareProgram(const ProgramDesc& desc) {
+    ProgramSources sources;
+    sources.loaded = loadProgramSources(desc, sources.vertex, sources.fragment);
+    return sources;
+}
+
+PendingProgram beginProgram(ProgramCache& cache, const ProgramDesc& desc) {
+    return beginProgram(cache, desc, prepareProgram(desc));
+}
+
+PendingProgram beginProgram(ProgramCache& cache, const ProgramDesc& desc, const ProgramSources& sources) {
+    PendingProgram pending;
+    pending.name = describeProgram(desc);
+    if (!sources.loaded) {
+        return pending;
+    }
+    const ShaderSource& vertex = sources.vertex;
+    const ShaderSource& fragment = sources.fragment;
+    pending.files = vertex.files;
+    for (const std::string& file : fragment.files) {
+        if (std::find(pending.files.begin(), pending.files.end(), file) == pending.files.end()) {
+            pending.files.push_back(file);
+        }
+    }
+    // Keyed as compiled: the two binding paths are different programs.
+    const std::string vertexCode = withBindings(vertex.code);
+    const std::string fragmentCode = withBindings(fragment.code);
+    // The captured varyings change the linked program without changing its sources.
+    std::string keyedVertex = vertexCode;
+    for (const std::string& name : desc.feedbackVaryings) {
+        keyedVertex += "\n// feedback: " + name;
+    }
+    pending.cacheKey = cache.key(keyedVertex, fragmentCode);
+    Clock::time_point start = Clock::now();
+    pending.program = cache.load(pending.cacheKey);
+    pending.timing.cached = pending.program != 0;
+    pending.timing.linkMs = msSince(start);
+    if (pending.program == 0) {
+        start = Clock::now();
+        pending.vertexShader = compileShader(vertexCode, GL_VERTEX_SHADER);
+        pending.timing.vertexMs = msSince(start);
+        start = Clock::now();
+        pending.fragmentShader = compileShader(fragmentCode, GL_FRAGMENT_SHADER);
+        pending.timing.fragmentMs = msSince(start);
+        start = Clock::now();
+        pending.program = linkProgram(pending.vertexShader, pending.fragmentShader, desc.feedbackVaryings);
+        pending.timing.linkMs = msSince(start);
+        pending.sources = "vertex: " + describeFiles(vertex) + "; fragment: " + describeFiles(fragment);
+    }
+    return pending;
+}
+
+// true if the link had already completed in the background (always, for cached ones).
+bool programReady(const PendingProgram& pending) {
+    if (pending.vertexShader == 0 || !glext::caps().parallelShaderCompile) {
+        return pending.vertexShader == 0;
+    }
+    GLint done = GL_FALSE;
+    glGetProgramiv(pending.program, GL_COMPLETION_STATUS_KHR, &done);
+    return done == GL_TRUE;
+}
+
+// The linked program (saved to the cache if it was compiled), or 0 if it failed to build.
+GLuint finishProgram(ProgramCache& cache, PendingProgram& pending, ShaderTimings* timings) {
+    if (pending.vertexShader != 0) {
+        // Wait for each stage on its own first, so the time lands in the right column;
+        // programLinked then only finds finished work (and logs whatever failed).
+        Clock::time_point start = Clock::now();
+        compileStatus(pending.vertexShader);
+        pending.timing.vertexMs += msSince(start);
+        start = Clock::now();
+        compileStatus(pending.fragmentShader);
+        pending.timing.fragmentMs += msSince(start);
+        start = Clock::now();
+        const bool linked = programLinked(pending.program, pending.vertexShader, pending.fragmentShader);
+        pending.timing.linkMs += msSince(start);
+        if (!linked) {
+            std::cerr << "(source strings: " << pending.sources << ")\n";
+            glstate::deleteProgram(pending.program);
+        }
+        cache.store(pending.cacheKey, pending.program);
+        pending.vertexShader = pending.fragmentShader = 0;
+    }
+    // Here rather than in linkProgram: the queries would wait for a link that may still
+    // be running in the background.
+    if (pending.program != 0) {
+        applyBindings(pending.program);
+    }
+    if (timings != nullptr && pending.program != 0) {
+        timings->record(pending.name, pending.timing);
+    }
+    return pending.program;
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "profile/shader_timings.h"
+#include "render/program_cache.h"
+#include "render/shader_preprocessor.h"
+
+// Shader building
+// ---------------
+// GLSL files → preprocessed sources → shader objects → linked program, the steps main()
+// used to run inline. Startup and ShaderReloader (render/shader_reloader.h) share them.
+
+// A vertex + fragment file pair and the variant to build them as. feedbackVaryings: the
+// vertex outputs transform feedback captures, interleaved into one buffer, in this order
+// (the update pass of render/particle_system.h); empty for an ordinary program.
+struct ProgramDesc {
+    std::string vertexPath;
+    std::string fragmentPath;
+    ShaderVariant variant;
+    std::vector<std::string> feedbackVaryings;
+};
+
+// preprocessShader on both files; false (and the reason on stderr) if either fails.
+bool loadProgramSources(const ProgramDesc& desc, ShaderSource& vertex, ShaderSource& fragment);
+
+// A ProgramDesc's two stages, preprocessed. No GL: prepareProgram runs on any thread
+// (startup prepares them on the JobSystem while the context is still being created).
+struct ProgramSources {
+    ShaderSource vertex;
+    ShaderSource fragment;
+    bool loaded = false;        // loadProgramSources succeeded
+};
+ProgramSources prepareProgram(const ProgramDesc& desc);
+
+// "vertex.glsl + fragment.glsl [INSTANCED]": how logs and ShaderTimings name a program.
+std::string describeProgram(const ProgramDesc& desc);
+
+GLuint compileShader(const std::string& source, GLenum shaderType);
+bool shaderCompiled(GLuint shader);
+GLuint linkProgram(GLuint vertexShader, GLuint fragmentShader,
+                   const std::vector<std::string>& feedbackVaryings = {});
+bool programLinked(GLuint program, GLuint vertexShader, GLuint fragmentShader);
+
+// A compute program from one file (GL 4.3: glext::caps().computeShader), compiled, linked
+// and checked right away: 0 (and the logs on stderr) if any step fails. Compute programs
+// are few and optional, so they skip the cache and the pending/finish split.
+GLuint buildComputeProgram(const std::string& path, const ShaderVariant& variant = {});
+
+// Explicit bindings
+// -----------------
+// Every sampler says its texture unit and every uniform block its binding point in the
+// GLSL, `layout (binding = N)`, so no program needs them set after it links, and a
+// program switch never re-sets them. The shaders are #version 330, where that takes
+// ARB_shading_language_420pack (glext::caps().explicitBindings); beginProgram adapts the
+// sources to the context before keying and compiling them:
+//
+// | Context            | Sources                                 | After link                    |
+// | ------------------ | --------------------------------------- | ----------------------------- |
+// | 420pack            | + #extension ... : require              | nothing                       |
+// | plain 3.3          | `binding = N` taken out of the layouts  | applyBindings, once: the same |
+// |                    |                                         | numbers, from the tables      |
+//
+// The tables (shaderlayout::kSamplerBindings, kBlockBindings) are generated from the same
+// GLSL (render/shader_layout.h), so both paths agree. C++ binds a texture to
+// GL_TEXTURE0 + Sampler::binding and a UBO to BLOCK::kBinding. #version 420+ sources
+// (the compute ones) are left alone.
+
+// The 3.3 fallback: glUniformBlockBinding / glUniform1i for every binding `program` has
+// (a cached binary comes back without them, so after every link or load). Leaves
+// `program` bound. Nothing to do where caps().explicitBindings.
+void applyBindings(GLuint program);
+
+// Full compiler / linker logs (GL_INFO_LOG_LENGTH sized); empty if there are none.
+std::string shaderInfoLog(GLuint shader);
+std::string programInfoLog(GLuint program);
+
+// PendingProgram
+// --------------
+// Startup submits every program first and checks them afterwards:
+//
+//     beginProgram × N   → glCompileShader / glLinkProgram only: no status queries
+//     ...other init...   → the driver compiles meanwhile (on its own threads with
+//                          KHR_parallel_shader_compile, see render/gl_ext.h)
+//     finishProgram × N  → the first status query of each program
+//
+// A status query right after each compile, as compileShader used to do, makes the
+// driver finish that shader before the next one is submitted: N compiles in a row.
+// A program the ProgramCache had is complete at begin; finish only reports on it.
+struct PendingProgram {
+    GLuint program = 0;
+    GLuint vertexShader = 0;    // 0: loaded from the cache, nothing to check
+    GLuint fragmentShader = 0;
+    std::uint64_t cacheKey = 0;
+    std::string sources;        // which file each #line source number is, for error logs
+    std::vector<std::string> files; // every file read, both stages (includes too)
+    std::string name;           // describeProgram(desc)
+    ShaderBuildTiming timing;   // submit times from begin; finish adds the waits
+};
+
+// program 0 if the sources can't be preprocessed; finishProgram then returns 0 too.
+PendingProgram beginProgram(ProgramCache& cache, const ProgramDesc& desc);
+// The same with `sources` prepared beforehand (prepareProgram(desc)).
+PendingProgram beginProgram(ProgramCache& cache, const ProgramDesc& desc, const ProgramSources& sources);
+bool programReady(const PendingProgram& pending);
+// timings: where the build's wall time is recorded (profile/shader_timings.h), if given.
+GLuint finishProgram(ProgramCache& cache, PendingProgram& pending, ShaderTimings* timings = nullptr);
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+
+// Shader layout
+// -------------
+// What shaders/*.glsl declare, as C++ constants: src/generated/shader_reflection.h,
+// written at build time by shader_reflect (src/tools/shader_reflect.cpp) from the GLSL
+// itself, one namespace per file:
+//
+//     shaderlayout::vertex::aLayer               // Attribute: location 3, 1 uint
+//     shaderlayout::particle_update::uEmitter    // Uniform<glm::vec2>
+//     shaderlayout::fragment::uTileIndex         // Sampler (usampler2DArray), unit 1
+//     shaderlayout::camera::Camera::kSize        // the std140 block's size, 256
+//
+// | Who                              | Uses                                                 |
+// | -------------------------------- | ---------------------------------------------------- |
+// | shaderInput (vertex_layout.h)    | an input's location and components; a Kind that     |
+// |                                  | disagrees with the GLSL type fails the build         |
+// | ShaderProgram::set               | a uniform's slot (locations resolved once, at link)  |
+// |                                  | and its type: the value must be that C++ type        |
+// | glGetUniformLocation             | .name: a renamed uniform breaks the build, not the   |
+// |                                  | draw                                                 |
+// | texture units, UBO binding points| Sampler::binding, BLOCK::kBinding: the GLSL's        |
+// |                                  | `layout (binding = N)`, never set from C++           |
+// | static_asserts by the mirrors    | block sizes, offsets and strides (CameraBlock, the   |
+// |                                  | clip table, the particle SSBOs)                      |
+//
+// A constant belongs to a FILE, not to a variant: vertex.glsl's aUV and aParticlePos are
+// both location 1, each under its own #if. Uniforms of the same name share a slot
+// whatever file declares them (a program links one of each).
+
+namespace shaderlayout {
+
+// `layout (location = N) in TYPE NAME;`
+struct Attribute {
+    const char* name;
+    GLuint location;
+    GLint components;   // per location: vec3 3, mat4 4
+    GLint locations;    // mat4: 4 consecutive ones
+    bool integer;       // int, uint, ivec, uvec: glVertexAttribIPointer
+};
+
+// `uniform TYPE NAME;`, T the C++ type that TYPE uploads from.
+template <typename T>
+struct Uniform {
+    const char* name;
+    std::uint16_t slot; // into kUniformNames
+    GLint count;        // array length, 1 for non-arrays
+};
+
+// `layout (binding = N) uniform SAMPLER NAME;`: reads texture unit N, set by the GLSL.
+struct Sampler {
+    const char* name;
+    std::uint16_t slot;
+    GLint count;
+    GLenum type;        // GL_SAMPLER_2D, GL_UNSIGNED_INT_SAMPLER_BUFFER, ...
+    GLuint binding;     // the unit: bind to GL_TEXTURE0 + binding
+};
+
+// A sampler's or uniform block's binding, by name (kSamplerBindings, kBlockBindings).
+struct Binding {
+    const char* name;
+    GLuint binding;
+};
+
+} // namespace shaderlayout
+
+#include "generated/shader_reflection.h"
@@ -0,0 +1,191 @@
+#include "render/shader_preprocessor.h"
+
+#include <algorithm>
+#include <cctype>
+#include <string_view>
+
+#include "core/vfs.h"
+
+namespace {
+
+constexpr int kMaxIncludeDepth = 16;
+
+struct FeatureDefine {
+    std::uint32_t bit;
+    const char* name;
+};
+
+constexpr FeatureDefine kFeatureDefines[] = {
+    {kShaderInstanced, "INSTANCED"},
+    {kShaderAffine2D, "AFFINE_2D"},
+    {kShaderTextured, "TEXTURED"},
+    {kShaderTextureArray, "TEXTURE_ARRAY"},
+    {kShaderTilemap, "TILEMAP"},
+    {kShaderTileIndex, "TILE_INDEX"},
+    {kShaderParticles, "PARTICLES"},
+    {kShaderVertexColor, "VERTEX_COLOR"},
+    {kShaderSdf, "SDF"},
+    {kShaderScreenSpace, "SCREEN_SPACE"},
+    {kShaderDepthLayers, "DEPTH_LAYERS"},
+    {kShaderInstanceColor, "INSTANCE_COLOR"},
+    {kShaderPickId, "PICK_ID"},
+    {kShaderAnimated, "ANIMATED"},
+    {kShaderSkinned, "SKINNED"},
+    {kShaderInstanceFetch, "INSTANCE_FETCH"},
+    {kShaderVirtualTexture, "VIRTUAL_TEXTURE"},
+    {kShaderLight, "LIGHT"},
+    {kShaderPost, "POST"},
+    {kShaderNoise, "NOISE"},
+};
+
+bool fail(std::string* error, const std::string& message) {
+    if (error) *error = message;
+    return false;
+}
+
+std::string directoryOf(const std::string& path) {
+    const std::size_t slash = path.find_last_of('/');
+    return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+}
+
+// The directive name if `line` is a preprocessor line ("include", "version", ...), with
+// `rest` pointing past it.
+std::string_view directive(std::string_view line, std::size_t& rest) {
+    std::size_t i = line.find_first_not_of(" \t");
+    if (i == std::string_view::npos || line[i] != '#') {
+        return std::string_view();
+    }
+    i = line.find_first_not_of(" \t", i + 1);
+    if (i == std::string_view::npos) {
+        return std::string_view();
+    }
+    std::size_t end = i;
+    while (end < line.size() && (std::isalnum(static_cast<unsigned char>(line[end])) || line[end] == '_')) {
+        ++end;
+    }
+    rest = end;
+    return line.substr(i, end - i);
+}
+
+class Preprocessor {
+public:
+    Preprocessor(ShaderSource& out, std::string* error) : out_(out), error_(error) {}
+
+    bool file(const std::string& path, int depth, const ShaderVariant* variant) {
+        if (depth > kMaxIncludeDepth) {
+            return fail(error_, path + ": includes nested deeper than 16 levels");
+        }
+        vfs::Blob text; // from a pack (in place) or the shader file on disk
+        if (!vfs::read(path, text)) {
+            return fail(error_, "cannot open shader file " + path);
+        }
+        const int index = static_cast<int>(out_.files.size());
+        out_.files.push_back(path);
+        out_.code.reserve(out_.code.size() + text.size() + 256); // + the directives we add
+
+        // Lines are views into `text`: the only copy is the append to out_.code.
+        const std::string_view all(reinterpret_cast<const char*>(text.data()), text.size());
+        int number = 0;
+        for (std::size_t start = 0; start < all.size();) {
+            std::size_t end = all.find('\n', start);
+            if (end == std::string_view::npos) {
+                end = all.size();
+            }
+            const std::string_view line = all.substr(start, end - start);
+            start = end + 1;
+            ++number;
+            std::size_t rest = 0;
+            const std::string_view name = directive(line, rest);
+            if (name == "version") {
+                if (variant == nullptr) {
+                    return fail(error_, path + ":" + std::to_string(number) + ": #version in an included file");
+                }
+                // The defines have to come after #version, which must be first.
+                appendLine(line);
+                defines(*variant);
+                lineDirective(number + 1, index);
+                variant = nullptr;
+                continue;
+            }
+            if (name == "include") {
+                const std::size_t open = line.find('"', rest);
+                const std::size_t close = open == std::string_view::npos ? open : line.find('"', open + 1);
+                if (close == std::string_view::npos) {
+                    return fail(error_, path + ":" + std::to_string(number) + ": expected #include \"file\"");
+                }
+                const std::string included = directoryOf(path) + std::string(line.substr(open + 1, close - open - 1));
+                if (std::find(out_.files.begin(), out_.files.end(), included) == out_.files.end()) {
+                    lineDirective(1, static_cast<int>(out_.files.size()));
+                    if (!file(included, depth + 1, nullptr)) {
+                        return false;
+                    }
+                }
+                lineDirective(number + 1, index);
+                continue;
+            }
+            appendLine(line);
+        }
+        if (variant != nullptr) {
+            return fail(error_, path + ": no #version line");
+        }
+        return true;
+    }
+
+private:
+    void appendLine(std::string_view line) {
+        out_.code.append(line.data(), line.size());
+        out_.code += '\n';
+    }
+
+    void defines(const ShaderVariant& variant) {
+        for (const FeatureDefine& f : kFeatureDefines) {
+            if (variant.features & f.bit) {
+                out_.code += std::string("#define ") + f.name + " 1\n";
+            }
+        }
+        for (const std::string& d : variant.defines) {
+            out_.code += "#define " + d + "\n";
+        }
+    }
+
+    // GLSL #line: the line AFTER the directive is `line` of source string `file`.
+    void lineDirective(int line, int file) {
+        out_.code += "#line " + std::to_string(line) + " " + std::to_string(file) + "\n";
+    }
+
+    ShaderSource& out_;
+    std::string* error_;
+};
+
+} // namespace
+
+bool preprocessShader(const std::string& path, const ShaderVariant& variant, ShaderSource& out, std::string* error) {
+    out = ShaderSource{};
+    Preprocessor preprocessor(out, error);
+    if (!preprocessor.file(path, 0, &variant)) {
+        out.code.clear();
+        return false;
+    }
+    return true;
+}
+
+std::string describeVariant(const ShaderVariant& variant) {
+    std::string names;
+    for (const FeatureDefine& f : kFeatureDefines) {
+        if (variant.features & f.bit) {
+            names += (names.empty() ? "" : " ") + std::string(f.name);
+        }
+    }
+    for (const std::string& d : variant.defines) {
+        names += (names.empty() ? "" : " ") + d;
+    }
+    return names;
+}
+
+std::string describeFiles(const ShaderSource& source) {
+    std::string legend;
+    for (std::size_t i = 0; i < source.files.size(); ++i) {
+        legend += (i ? ", " : "") + std::to_string(i) + " = " + source.files[i];
+    }
+    return legend;
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ShaderFeature
+// -------------
+// Permutation bits. Each becomes a `#define NAME 1` after the #version line, and the
+// GLSL picks its code with #ifdef. One vertex.glsl / fragment.glsl pair covers every
+// instanced-quad program this way:
+//
+// | Bit           | Define         | vertex.glsl                     | fragment.glsl         |
+// | ------------- | -------------- | ------------------------------- | --------------------- |
+// | Instanced     | INSTANCED      | transform from instance         | —                     |
+// |               |                | attributes (else uniforms)      |                       |
+// | Affine2D      | AFFINE_2D      | 3x2 rows instead of a mat4      | —                     |
+// | Textured      | TEXTURED       | —                               | texture(uTexture) *   |
+// |               |                |                                 | vColor (else orange)  |
+// | TextureArray  | TEXTURE_ARRAY  | + layer and tint per instance,  | sampler2DArray        |
+// |               |                | UVs from the quad corner        | uTextures instead     |
+// | Tilemap       | TILEMAP        | baked world-space vertices with | —                     |
+// |               |                | UV + layer (render/tilemap.h)   |                       |
+// | TileIndex     | TILE_INDEX     | —                               | tile ids from the     |
+// |               |                |                                 | usampler2DArray       |
+// |               |                |                                 | uTileIndex            |
+// | Particles     | PARTICLES      | instances from the particle     | —                     |
+// |               |                | state buffer, size/tint by age  |                       |
+// | VertexColor   | VERTEX_COLOR   | — (debug_vertex.glsl)           | vColor as is          |
+// | Sdf           | SDF            | —                               | + TEXTURED: distance  |
+// |               |                |                                 | field text edge       |
+// | ScreenSpace   | SCREEN_SPACE   | sprite_vertex.glsl: clip-space  | —                     |
+// |               |                | corners, no camera              |                       |
+// | DepthLayers   | DEPTH_LAYERS   | + TEXTURE_ARRAY: z-layer from   | + TEXTURE_ARRAY:      |
+// |               |                | aLayer's high half → depth      | opaque tints discard  |
+// |               |                |                                 | alpha < 0.5 (cutout)  |
+// | InstanceColor | INSTANCE_COLOR | + INSTANCED: vec4 aInstance-    | vColor (else orange)  |
+// |               |                | Color (5) → vColor              |                       |
+// | PickId        | PICK_ID        | + DEPTH_LAYERS: aColor is an id | uint id (R32UI), no   |
+// |               |                | (bytes); zoomed to uPickRegion  | colour; cutout unless |
+// |               |                |                                 | layer 0xffff          |
+// | Animated      | ANIMATED       | + DEPTH_LAYERS: vec2 aAnimation | —                     |
+// |               |                | (5); the layer from the clip    |                       |
+// |               |                | table (animation.glsl)          |                       |
+// | Skinned       | SKINNED        | bind-pose vertices on two bones | — (+ VERTEX_COLOR)    |
+// |               |                | of the instance's palette, a    |                       |
+// |               |                | samplerBuffer uPalette          |                       |
+// | InstanceFetch | INSTANCE_FETCH | + INSTANCED: the instance from  | —                     |
+// |               |                | usamplerBuffer uInstances by    |                       |
+// |               |                | gl_InstanceID, no attributes    |                       |
+// | Virtual-      | VIRTUAL_       | + TILEMAP: vUV over the whole   | the page table →      |
+// | Texture       | TEXTURE        | image (render/virtual_texture.h)| cache slot; FEEDBACK: |
+// |               |                |                                 | the page id instead   |
+// | Light         | LIGHT          | point light quads (radius,      | additive falloff;     |
+// |               |                | colour per instance)            | COMPOSITE: the light  |
+// |               |                |                                 | target as a multiply  |
+// | Post          | POST           | — (fullscreen_vertex.glsl)      | BRIGHT, BLUR, or the  |
+// |               |                |                                 | fused final pass      |
+// |               |                |                                 | (post_process.h)      |
+// | Noise         | NOISE          | — (fullscreen_vertex.glsl)      | two fBm fields of     |
+// |               |                |                                 | simplex noise (RG32F, |
+// |               |                |                                 | render/gpu_noise.h)   |
+//
+// Only the combinations a program is built with are ever compiled, and each program's
+// final source differs, so ProgramCache keys (and stores) every variant separately.
+enum ShaderFeature : std::uint32_t {
+    kShaderInstanced = 1u << 0,
+    kShaderAffine2D = 1u << 1,
+    kShaderTextured = 1u << 2,
+    kShaderTextureArray = 1u << 3,
+    kShaderTilemap = 1u << 4,
+    kShaderTileIndex = 1u << 5,
+    kShaderParticles = 1u << 6,
+    kShaderVertexColor = 1u << 7,
+    kShaderSdf = 1u << 8,
+    kShaderScreenSpace = 1u << 9,
+    kShaderDepthLayers = 1u << 10,
+    kShaderInstanceColor = 1u << 11,
+    kShaderPickId = 1u << 12,
+    kShaderAnimated = 1u << 13,
+    kShaderSkinned = 1u << 14,
+    kShaderInstanceFetch = 1u << 15,
+    kShaderVirtualTexture = 1u << 16,
+    kShaderLight = 1u << 17,
+    kShaderPost = 1u << 18,
+    kShaderNoise = 1u << 19,
+};
+
+// A permutation: feature bits plus free-form defines ("NAME" or "NAME VALUE").
+struct ShaderVariant {
+    std::uint32_t features = 0;
+    std::vector<std::string> defines;
+};
+
+// ShaderSource
+// ------------
+// The preprocessed text and every file it was assembled from. files[i] is GLSL source
+// string number i in the `#line` directives, so a driver log line "2:14(3)" means line 14
+// of files[2].
+struct ShaderSource {
+    std::string code;
+    std::vector<std::string> files;
+};
+
+// preprocessShader(...)
+// ---------------------
+// Reads `path`, which must have a #version line (only comments before it), and produces:
+//
+//     #version ...                 (the file's own)
+//     #define INSTANCED 1          (variant.features, then variant.defines)
+//     #line 2 0                    (file 0 continues at its line 2)
+//     ...
+//     #include "camera.glsl"   →   #line 1 1, the included file, #line N 0
+//
+// #include paths are relative to the including file. Each file is pasted at most
+// once per shader (as if every file had an include guard), which also makes include
+// cycles harmless. Everything else is left to the GLSL compiler, #ifdef included: an
+// #include inside an #ifdef block is pasted either way (and then compiled out).
+//
+// false: a file can't be read, a #include is malformed, or an included file has its
+// own #version. The message goes to `error`.
+bool preprocessShader(const std::string& path, const ShaderVariant& variant, ShaderSource& out,
+                      std::string* error = nullptr);
+
+// "INSTANCED AFFINE_2D": the variant's defines, for logs and reports.
+std::string describeVariant(const ShaderVariant& variant);
+
+// "0 = shaders/vertex.glsl, 1 = shaders/camera.glsl": the legend for a compile log.
+std::string describeFiles(const ShaderSource& source);
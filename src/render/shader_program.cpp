@@ -0,0 +1,114 @@
+#include "render/shader_program.h"
+
+#include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+// A uniform name's slot in shaderlayout::kUniformNames, or -1.
+int uniformSlot(const char* name) {
+    const char* const* begin = shaderlayout::kUniformNames;
+    const char* const* end = begin + shaderlayout::kUniformCount;
+    const char* const* it =
+        std::lower_bound(begin, end, name, [](const char* a, const char* b) { return std::strcmp(a, b) < 0; });
+    return it != end && std::strcmp(*it, name) == 0 ? static_cast<int>(it - begin) : -1;
+}
+
+} // namespace
+
+void ShaderProgram::reset(GLuint program) {
+    program_.reset(program);       // a previous program is queued for deletion
+    locations_.fill(-1);
+    if (program == 0) {
+        return;
+    }
+
+    GLint count = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+    GLint maxNameLength = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+    std::vector<char> nameBuffer(maxNameLength > 0 ? maxNameLength : 1);
+    for (GLint i = 0; i < count; ++i) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(program, static_cast<GLuint>(i), static_cast<GLsizei>(nameBuffer.size()),
+                           &length, &size, &type, nameBuffer.data());
+
+        // Uniforms inside a uniform block have no location (-1); they're set via the UBO.
+        const GLint location = glGetUniformLocation(program, nameBuffer.data());
+        if (location < 0) {
+            continue;
+        }
+        // Arrays are reported as "uNoiseFields[0]": their slot is the GLSL name's.
+        if (length > 3 && std::strcmp(nameBuffer.data() + length - 3, "[0]") == 0) {
+            nameBuffer[length - 3] = '\0';
+        }
+        const int slot = uniformSlot(nameBuffer.data());
+        if (slot >= 0) {
+            locations_[slot] = location;
+        }
+    }
+}
+
+void ShaderProgram::destroy() {
+    program_.reset();              // deleted once the GPU is done with it
+    locations_.fill(-1);
+}
+
+void ShaderProgram::upload(GLint location, GLsizei count, const float* v) { glUniform1fv(location, count, v); }
+
+void ShaderProgram::upload(GLint location, GLsizei count, const glm::vec2* v) {
+    glUniform2fv(location, count, glm::value_ptr(*v));
+}
+
+void ShaderProgram::upload(GLint location, GLsizei count, const glm::vec3* v) {
+    glUniform3fv(location, count, glm::value_ptr(*v));
+}
+
+void ShaderProgram::upload(GLint location, GLsizei count, const glm::vec4* v) {
+    glUniform4fv(location, count, glm::value_ptr(*v));
+}
+
+void ShaderProgram::upload(GLint location, GLsizei count, const GLint* v) { glUniform1iv(location, count, v); }
+
+void ShaderProgram::upload(GLint location, GLsizei count, const glm::ivec2* v) {
+    glUniform2iv(location, count, glm::value_ptr(*v));
+}
+
+void ShaderProgram::upload(GLint location, GLsizei count, const glm::ivec3* v) {
+    glUniform3iv(location, count, glm::value_ptr(*v));
+}
+
+void ShaderProgram::upload(GLint location, GLsizei count, const glm::ivec4* v) {
+    glUniform4iv(location, count, glm::value_ptr(*v));
+}
+
+void ShaderProgram::upload(GLint location, GLsizei count, const GLuint* v) { glUniform1uiv(location, count, v); }
+
+void ShaderProgram::upload(GLint location, GLsizei count, const glm::uvec2* v) {
+    glUniform2uiv(location, count, glm::value_ptr(*v));
+}
+
+void ShaderProgram::upload(GLint location, GLsizei count, const glm::uvec3* v) {
+    glUniform3uiv(location, count, glm::value_ptr(*v));
+}
+
+void ShaderProgram::upload(GLint location, GLsizei count, const glm::uvec4* v) {
+    glUniform4uiv(location, count, glm::value_ptr(*v));
+}
+
+void ShaderProgram::upload(GLint location, GLsizei count, const glm::mat2* v) {
+    glUniformMatrix2fv(location, count, GL_FALSE, glm::value_ptr(*v));
+}
+
+void ShaderProgram::upload(GLint location, GLsizei count, const glm::mat3* v) {
+    glUniformMatrix3fv(location, count, GL_FALSE, glm::value_ptr(*v));
+}
+
+void ShaderProgram::upload(GLint location, GLsizei count, const glm::mat4* v) {
+    glUniformMatrix4fv(location, count, GL_FALSE, glm::value_ptr(*v));
+}
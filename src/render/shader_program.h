@@ -0,0 +1,74 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <array>
+
+#include "render/gl_resource.h"
+#include "render/gl_state.h"
+#include "render/shader_layout.h"
+
+// ShaderProgram
+// -------------
+// Wraps the GLuint returned by linkProgram(...).
+//
+// Its uniforms are the generated constants of render/shader_layout.h
+// (shaderlayout::particle_update::uEmitter, ...), not names: on reset() it enumerates the
+// active uniforms once (GL_ACTIVE_UNIFORMS) and files each location under its name's
+// slot, so an upload is an array index, a uniform renamed in the GLSL fails the build
+// where it is set, and a value of the wrong type doesn't compile.
+//
+// | Step                 | When            | Cost                                       |
+// | -------------------- | --------------- | ------------------------------------------ |
+// | reset(program)       | once after link | one query + binary search per uniform      |
+// | set(uniform, value)  | every frame     | array index + glUniform* call              |
+//
+// A uniform the program doesn't have (another variant's, or optimized out) has location
+// -1 and its uploads are ignored, as GL ignores them.
+class ShaderProgram {
+public:
+    ShaderProgram() { locations_.fill(-1); }
+    explicit ShaderProgram(GLuint program) { reset(program); }
+
+    // Takes ownership of a linked program and resolves its uniforms. The previous one is
+    // queued for deletion (render/gl_resource.h), so a draw still in flight keeps it.
+    void reset(GLuint program);
+    void destroy();
+
+    GLuint id() const { return program_.get(); }
+    void use() const { glstate::useProgram(program_.get()); }
+
+    template <typename T>
+    GLint location(shaderlayout::Uniform<T> u) const { return locations_[u.slot]; }
+    GLint location(shaderlayout::Sampler s) const { return locations_[s.slot]; }
+
+    // Per-frame uploads. Program must be bound. Arrays: `count` elements from values.
+    template <typename T>
+    void set(shaderlayout::Uniform<T> u, const T& value) const { upload(locations_[u.slot], 1, &value); }
+    template <typename T>
+    void set(shaderlayout::Uniform<T> u, const T* values, GLsizei count) const {
+        upload(locations_[u.slot], count < u.count ? count : u.count, values);
+    }
+    // The texture unit the sampler reads (0 for GL_TEXTURE0).
+    void set(shaderlayout::Sampler s, GLint unit) const { upload(locations_[s.slot], 1, &unit); }
+
+private:
+    static void upload(GLint location, GLsizei count, const float* v);
+    static void upload(GLint location, GLsizei count, const glm::vec2* v);
+    static void upload(GLint location, GLsizei count, const glm::vec3* v);
+    static void upload(GLint location, GLsizei count, const glm::vec4* v);
+    static void upload(GLint location, GLsizei count, const GLint* v);
+    static void upload(GLint location, GLsizei count, const glm::ivec2* v);
+    static void upload(GLint location, GLsizei count, const glm::ivec3* v);
+    static void upload(GLint location, GLsizei count, const glm::ivec4* v);
+    static void upload(GLint location, GLsizei count, const GLuint* v);
+    static void upload(GLint location, GLsizei count, const glm::uvec2* v);
+    static void upload(GLint location, GLsizei count, const glm::uvec3* v);
+    static void upload(GLint location, GLsizei count, const glm::uvec4* v);
+    static void upload(GLint location, GLsizei count, const glm::mat2* v);
+    static void upload(GLint location, GLsizei count, const glm::mat3* v);
+    static void upload(GLint location, GLsizei count, const glm::mat4* v);
+
+    GlProgram program_;
+    std::array<GLint, shaderlayout::kUniformCount> locations_;
+};
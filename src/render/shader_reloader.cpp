@@ -0,0 +1,120 @@
+#include "render/shader_reloader.h"
+
+#include <chrono>
+#include <iostream>
+
+#include "render/gl_ext.h"
+#include "render/gl_state.h"
+
+namespace {
+
+double nowSeconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+bool ShaderReloader::init(const std::string& directory, ProgramCache& cache, ShaderTimings* timings) {
+    cache_ = &cache;
+    timings_ = timings;
+    return watcher_.init(directory);
+}
+
+void ShaderReloader::shutdown() {
+    for (Watched& w : watched_) {
+        if (w.building) {
+            // Finish the build only to throw it away: its shaders must be deleted too.
+            if (finishProgram(*cache_, w.pending) != 0) {
+                glstate::deleteProgram(w.pending.program);
+            }
+            w.building = false;
+        }
+    }
+    watched_.clear();
+    watcher_.shutdown();
+}
+
+void ShaderReloader::watch(ShaderProgram& program, const ProgramDesc& desc, PrepareFn prepare) {
+    Watched w;
+    w.program = &program;
+    w.desc = desc;
+    w.prepare = std::move(prepare);
+    ShaderSource vertex, fragment;
+    if (loadProgramSources(desc, vertex, fragment)) {
+        w.files = vertex.files;
+        w.files.insert(w.files.end(), fragment.files.begin(), fragment.files.end());
+    } else {
+        w.files = {desc.vertexPath, desc.fragmentPath};
+    }
+    watched_.push_back(std::move(w));
+}
+
+bool ShaderReloader::matches(const std::string& path, const std::string& name) const {
+    const std::string& directory = watcher_.directory();
+    return path.size() == directory.size() + 1 + name.size() && path.compare(0, directory.size(), directory) == 0 &&
+           path[directory.size()] == '/' && path.compare(directory.size() + 1, name.size(), name) == 0;
+}
+
+void ShaderReloader::begin(Watched& w) {
+    w.dirty = false;
+    w.pending = beginProgram(*cache_, w.desc);
+    if (w.pending.program == 0) {
+        ++stats_.failures; // e.g. caught between an editor's delete and write; the next save retries
+        std::cerr << "Shader reload failed (" << w.desc.vertexPath << " + " << w.desc.fragmentPath
+                  << "): keeping the previous program\n";
+        return;
+    }
+    w.files = w.pending.files;   // an edit may have added or dropped an #include
+    w.started = nowSeconds();
+    w.building = true;
+}
+
+void ShaderReloader::finish(Watched& w) {
+    w.building = false;
+    GLuint program = finishProgram(*cache_, w.pending, timings_);
+    if (program != 0 && w.prepare && !w.prepare(program)) {
+        glstate::deleteProgram(program);
+    }
+    const std::string names = w.desc.vertexPath + " + " + w.desc.fragmentPath;
+    if (program == 0) {
+        ++stats_.failures;
+        std::cerr << "Shader reload failed (" << names << "): keeping the previous program\n";
+        return;
+    }
+    w.program->destroy();
+    w.program->reset(program);
+    ++stats_.reloads;
+    std::cout << "Shader reload: " << names << " in " << (nowSeconds() - w.started) * 1000.0 << " ms\n";
+}
+
+bool ShaderReloader::busy() const {
+    for (const Watched& w : watched_) {
+        if (w.dirty || w.building) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ShaderReloader::update() {
+    for (const std::string& name : watcher_.poll()) {
+        for (Watched& w : watched_) {
+            for (const std::string& file : w.files) {
+                if (matches(file, name)) {
+                    w.dirty = true;
+                }
+            }
+        }
+    }
+    const bool background = glext::caps().parallelShaderCompile;
+    for (Watched& w : watched_) {
+        if (w.building && (!background || programReady(w.pending))) {
+            finish(w);
+        }
+        // Saved again while building: the build in flight is finished first, then the
+        // newest sources start over.
+        if (w.dirty && !w.building) {
+            begin(w);
+        }
+    }
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "core/file_watcher.h"
+#include "render/program_cache.h"
+#include "render/shader_build.h"
+#include "render/shader_program.h"
+
+// ShaderReloader
+// --------------
+// Rebuilds a ShaderProgram when one of its GLSL files is saved, and swaps it in between
+// frames. update() runs on the GL thread at the start of a frame:
+//
+//     file saved → FileWatcher reports it → every program built from it marked dirty
+//                  (#included files count: saving camera.glsl rebuilds all four)
+//     next update():  preprocess both stages, beginProgram (compile + link submitted)
+//     later update(): programReady? → finishProgram → prepare(new) → swap, old deleted
+//
+// | Outcome                         | What the renderer uses                           |
+// | ------------------------------- | ------------------------------------------------ |
+// | compiling                       | the old program, untouched                       |
+// | compile / link error            | the old program; the log goes to stderr          |
+// | prepare() returns false         | the old program; the new one is deleted          |
+// | success                         | the new one, from the next draw on               |
+//
+// The swap is ShaderProgram::reset() on the same object, so everything that reads
+// program.id() per frame picks it up; reset() files the new program's uniform locations
+// under the same generated slots (render/shader_layout.h), so set() calls need nothing.
+// Texture units and UBO binding points come with the program (finishProgram: render/
+// shader_build.h), so prepare() only re-sets the plain uniforms C++ sets once.
+//
+// With KHR_parallel_shader_compile the driver compiles on its own threads and update()
+// only polls GL_COMPLETION_STATUS_KHR: the frames in between don't wait. Without it the
+// whole compile happens inside the next update() (one long frame per save, which is
+// still far better than restarting).
+class ShaderReloader {
+public:
+    // Gets the freshly linked program before it replaces the old one. false rejects it.
+    using PrepareFn = std::function<bool(GLuint program)>;
+
+    struct Stats {
+        int reloads = 0;
+        int failures = 0;
+    };
+
+    // directory: what to watch, e.g. "shaders". cache: where rebuilt binaries go (may be off).
+    // timings: where each rebuild's compile and link times are recorded, if given.
+    bool init(const std::string& directory, ProgramCache& cache, ShaderTimings* timings = nullptr);
+    void shutdown();
+
+    // desc: as the program was built at startup; its files inside the watched directory.
+    void watch(ShaderProgram& program, const ProgramDesc& desc, PrepareFn prepare = nullptr);
+
+    void update();
+    // A rebuild is waiting or in flight: only more update()s finish it.
+    bool busy() const;
+
+    const Stats& stats() const { return stats_; }
+
+private:
+    struct Watched {
+        ShaderProgram* program;
+        ProgramDesc desc;
+        std::vector<std::string> files; // from the last preprocessing: what to react to
+        PrepareFn prepare;
+        bool dirty = false;
+        bool building = false;
+        PendingProgram pending;
+        double started = 0.0;       // seconds (steady clock)
+    };
+
+    bool matches(const std::string& path, const std::string& name) const;
+    void begin(Watched& w);
+    void finish(Watched& w);
+
+    FileWatcher watcher_;
+    ProgramCache* cache_ = nullptr;
+    ShaderTimings* timings_ = nullptr;
+    std::vector<Watched> watched_;
+    Stats stats_;
+};
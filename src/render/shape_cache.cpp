@@ -0,0 +1,75 @@
+#include "render/shape_cache.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "asset/mesh_optimize.h"
+#include "core/triangulate.h"
+
+void ShapeCache::init(MeshPool* pool) {
+    clear();
+    pool_ = pool && pool->layout().stride() == static_cast<GLsizei>(sizeof(glm::vec2)) ? pool : nullptr;
+}
+
+void ShapeCache::clear() {
+    if (pool_) {
+        for (auto& [hash, entry] : shapes_) {
+            pool_->remove(entry.shape.mesh);
+        }
+    }
+    shapes_.clear();
+    stats_.shapes = 0;
+}
+
+// FNV-1a over the coordinates' bytes: the same outline, point for point, is the same shape.
+std::uint64_t ShapeCache::hashOutline(const glm::vec2* outline, std::size_t count) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(outline);
+    std::uint64_t hash = 0xcbf29ce484222325ull;
+    for (std::size_t i = 0; i < count * sizeof(glm::vec2); ++i) {
+        hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+const ShapeCache::Shape* ShapeCache::get(const glm::vec2* outline, std::size_t count) {
+    const std::uint64_t hash = hashOutline(outline, count);
+    const auto [first, last] = shapes_.equal_range(hash);
+    for (auto it = first; it != last; ++it) {
+        const std::vector<glm::vec2>& kept = it->second.outline;
+        if (kept.size() == count && std::equal(kept.begin(), kept.end(), outline)) {
+            ++stats_.hits;
+            return it->second.shape.indices.empty() ? nullptr : &it->second.shape;
+        }
+    }
+    Entry& entry = shapes_.emplace(hash, Entry{})->second;
+    entry.outline.assign(outline, outline + count);
+    build(entry);
+    ++stats_.misses;
+    stats_.shapes = shapes_.size();
+    return entry.shape.indices.empty() ? nullptr : &entry.shape;
+}
+
+void ShapeCache::build(Entry& entry) {
+    Shape& shape = entry.shape;
+    std::vector<std::uint16_t> triangles;
+    shape.simple = triangulatePolygon(entry.outline.data(), entry.outline.size(), triangles);
+    if (triangles.empty()) {
+        return;
+    }
+
+    // Ear clipping walks the outline, so its triangles already share vertices with their
+    // neighbours; the passes make that the cache's order and drop collinear points.
+    std::vector<std::uint32_t> indices(triangles.begin(), triangles.end());
+    std::vector<unsigned char> vertices(entry.outline.size() * sizeof(glm::vec2));
+    std::memcpy(vertices.data(), entry.outline.data(), vertices.size());
+    std::size_t vertexCount = entry.outline.size();
+    meshopt::optimize(vertices, sizeof(glm::vec2), vertexCount, indices);
+    shape.vertices.resize(vertexCount);
+    std::memcpy(shape.vertices.data(), vertices.data(), vertexCount * sizeof(glm::vec2));
+    meshopt::narrowIndices(indices.data(), indices.size(), shape.indices);   // fits: the outline had <= 65536
+    stats_.triangles += shape.indices.size() / 3;
+
+    if (pool_) {
+        shape.mesh = pool_->add(shape.vertices.data(), vertexCount, shape.indices.data(), shape.indices.size());
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "render/mesh_pool.h"
+
+// ShapeCache
+// ----------
+// Vector shapes (concave polygons: stars, outlines, decals) as indexed triangle meshes,
+// triangulated once per distinct outline and kept by its hash:
+//
+//     const ShapeCache::Shape* star = shapes.get(outline, 10);   // first call: the work
+//     batch.submitTriangles(model, star->vertices.data(), star->indices.data(),
+//                           star->indices.size(), texture, uvRect, color);
+//
+// | get() of an outline | Cost                                                        |
+// | ------------------- | ----------------------------------------------------------- |
+// | first time          | ear clipping (core/triangulate.h), vertex cache + fetch     |
+// |                     | order (asset/mesh_optimize.h), a MeshPool::add()            |
+// | after that          | hashing the outline, one map lookup                         |
+//
+// Each shape is kept twice, as it is drawn two ways: its vertices and indices here, for
+// SpriteBatch::submitTriangles() to put between the sprites of the same batch (no
+// separate draw, same program and texture); and a Mesh in the pool given to init(), the
+// shared vertex/index buffers the instanced and multi-draw paths read. Positions are
+// the outline's own: sprite batch shapes use the unit quad's [-0.5, 0.5] space.
+//
+// GL thread when there is a pool (add() uploads). Pointers stay valid until clear().
+class ShapeCache {
+public:
+    struct Shape {
+        std::vector<glm::vec2> vertices;   // first-use order, unused outline points gone
+        std::vector<std::uint16_t> indices;
+        Mesh mesh;                         // invalid without a pool or if it was full
+        bool simple = true;                // false: the outline crossed itself
+    };
+
+    struct Stats {
+        std::size_t shapes = 0;
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;          // outlines triangulated
+        std::uint64_t triangles = 0;       // ... into this many
+    };
+
+    // `pool` (may be null: no Meshes) must have a 2 x float position layout.
+    void init(MeshPool* pool);
+    // Gives the shapes' Meshes back to the pool.
+    void clear();
+
+    // nullptr: under 3 points, or no area (remembered: asking again is a hit).
+    const Shape* get(const glm::vec2* outline, std::size_t count);
+    const Stats& stats() const { return stats_; }
+
+private:
+    struct Entry {
+        std::vector<glm::vec2> outline;    // hash collisions compare it
+        Shape shape;
+    };
+
+    static std::uint64_t hashOutline(const glm::vec2* outline, std::size_t count);
+    void build(Entry& entry);
+
+    MeshPool* pool_ = nullptr;
+    std::unordered_multimap<std::uint64_t, Entry> shapes_;
+    Stats stats_;
+};
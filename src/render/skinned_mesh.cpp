@@ -0,0 +1,119 @@
+#include "render/skinned_mesh.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "render/gl_buffer.h"
+#include "render/gl_state.h"
+#include "render/gpu_memory.h"
+#include "render/shader_layout.h"
+#include "render/vertex_array_cache.h"
+#include "render/vertex_layout.h"
+
+namespace {
+
+// Same locations as vertex.glsl SKINNED: aPos (0), aBones (1), aWeight (2), aVertexColor (3).
+namespace input = shaderlayout::vertex;     // SKINNED
+
+const VertexLayout kVertexLayout(sizeof(SkinnedVertex), {
+    shaderInput(input::aPos, 2, GL_FLOAT, VertexAttribute::Kind::Float, offsetof(SkinnedVertex, position)),
+    shaderInput(input::aBones, 2, GL_UNSIGNED_BYTE, VertexAttribute::Kind::Integer, offsetof(SkinnedVertex, bones)),
+    shaderInput(input::aWeight, 1, GL_UNSIGNED_BYTE, VertexAttribute::Kind::Normalized,
+                offsetof(SkinnedVertex, weight)),
+    shaderInput(input::aVertexColor, 4, GL_UNSIGNED_BYTE, VertexAttribute::Kind::Normalized,
+                offsetof(SkinnedVertex, color)),
+});
+
+constexpr GLsizeiptr kEntryBytes = 2 * sizeof(glm::vec4);  // two RGBA32F texels
+
+} // namespace
+
+bool SkinnedMeshRenderer::init(VertexArrayCache& vaos, const SkinnedVertex* vertices, std::size_t vertexCount,
+                               const std::uint16_t* indices, std::size_t indexCount, std::size_t maxBones) {
+    const gpumemory::Owner owner("skinned mesh");
+    shutdown();
+    // Every segment of the ring has to be addressable: the texture is all of it.
+    GLint maxTexels = 65536;
+    glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+    maxBones_ = std::min(maxBones, static_cast<std::size_t>(maxTexels) / (2 * StreamBuffer::kFrames));
+    if (maxBones_ == 0 || !palette_.init(GL_TEXTURE_BUFFER, static_cast<GLsizeiptr>(maxBones_) * kEntryBytes)) {
+        std::cerr << "Skinned mesh: no palette buffer\n";
+        return false;
+    }
+    paletteTexture_ = GlTexture::create();
+    glstate::activeTexture(kPaletteTextureUnit);
+    glstate::bindTexture(GL_TEXTURE_BUFFER, paletteTexture_.get());
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, palette_.buffer());
+    glstate::activeTexture(GL_TEXTURE0);
+
+    vertices_ = GlBuffer::create();
+    glbuffer::data(GL_ARRAY_BUFFER, vertices_.get(), static_cast<GLsizeiptr>(vertexCount * sizeof(SkinnedVertex)),
+                   vertices, GL_STATIC_DRAW);
+    indices_ = GlBuffer::create();
+    glbuffer::data(GL_ELEMENT_ARRAY_BUFFER, indices_.get(),
+                   static_cast<GLsizeiptr>(indexCount * sizeof(std::uint16_t)), indices, GL_STATIC_DRAW);
+    indexCount_ = static_cast<GLsizei>(indexCount);
+    vaos_ = &vaos;
+    vao_ = vaos.get({{&kVertexLayout, vertices_.get()}}, indices_.get());
+    return vao_ != 0;
+}
+
+void SkinnedMeshRenderer::shutdown() {
+    if (vaos_ != nullptr) {
+        vaos_->forget(vertices_.get());
+    }
+    vaos_ = nullptr;
+    vao_ = 0;
+    vertices_.reset();
+    indices_.reset();
+    paletteTexture_.reset();
+    palette_.shutdown();
+    maxBones_ = 0;
+}
+
+void SkinnedMeshRenderer::setUniforms(GLuint program) {
+    baseLocation_ = glGetUniformLocation(program, shaderlayout::vertex::uPaletteBase.name);
+    charactersLocation_ = glGetUniformLocation(program, shaderlayout::vertex::uCharacters.name);
+}
+
+void SkinnedMeshRenderer::upload(const Affine2D* palette, std::size_t bones, std::size_t characters) {
+    stats_ = Stats{};
+    if (vao_ == 0 || bones == 0) {
+        return;
+    }
+    const std::size_t drawn = std::min(characters, maxBones_ / bones);
+    if (drawn == 0) {
+        return;
+    }
+    StreamAllocation a = palette_.allocate(static_cast<GLsizeiptr>(bones * drawn) * kEntryBytes, kEntryBytes);
+    if (!a.valid()) {
+        return;
+    }
+    // Rows padded to RGBA (RGB32F buffer textures are GL 4.0), written front to back.
+    glm::vec4* out = static_cast<glm::vec4*>(a.ptr);
+    for (std::size_t b = 0; b < bones; ++b) {
+        const Affine2D* row = palette + b * characters;
+        for (std::size_t c = 0; c < drawn; ++c) {
+            *out++ = glm::vec4(row[c].row0, 0.0f);
+            *out++ = glm::vec4(row[c].row1, 0.0f);
+        }
+    }
+    palette_.commit(a);
+    base_ = static_cast<GLint>(a.offset / static_cast<GLintptr>(sizeof(glm::vec4)));
+    stats_.characters = drawn;
+    stats_.bones = bones * drawn;
+}
+
+void SkinnedMeshRenderer::draw() {
+    if (stats_.characters == 0) {
+        return;
+    }
+    glUniform1i(baseLocation_, base_);
+    glUniform1i(charactersLocation_, static_cast<GLint>(stats_.characters));
+    glstate::activeTexture(kPaletteTextureUnit);
+    glstate::bindTexture(GL_TEXTURE_BUFFER, paletteTexture_.get());
+    glstate::activeTexture(GL_TEXTURE0);
+    glstate::bindVertexArray(vao_);
+    glDrawElementsInstanced(GL_TRIANGLES, indexCount_, GL_UNSIGNED_SHORT, nullptr,
+                            static_cast<GLsizei>(stats_.characters));
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+
+#include "core/batch_transform.h"
+#include "render/gl_resource.h"
+#include "render/shader_layout.h"
+#include "render/stream_buffer.h"
+
+class VertexArrayCache;
+
+// A vertex of a rig's mesh, in the rig's bind pose: on bones[0] with `weight`/255, on
+// bones[1] with the rest. 16 bytes.
+struct SkinnedVertex {
+    glm::vec2 position;
+    std::uint8_t bones[2];
+    std::uint8_t weight;           // bones[0]'s share, unorm8; 255: bones[0] alone
+    std::uint8_t unused;
+    std::uint32_t color;           // packColor
+};
+static_assert(sizeof(SkinnedVertex) == 16, "SkinnedVertex is a vertex attribute stride");
+
+// SkinnedMeshRenderer
+// -------------------
+// One rig's mesh, drawn once per character with ONE glDrawElementsInstanced; each
+// instance bends it by its own bones. The bones come from SkeletonPoses' palette
+// (core/skeleton_2d.h), streamed every frame into a texture buffer that SKINNED
+// vertex.glsl reads with texelFetch:
+//
+//     palette (bone-major):  bone 0: char 0 | char 1 | ... | bone 1: char 0 | ...
+//     texels (RGBA32F):      row0, row1 per entry (w unused): 32 bytes a bone
+//     entry for instance i:  uPaletteBase + 2 * (bone * uCharacters + i)
+//
+// | Per frame                   | Cost                                           |
+// | --------------------------- | ---------------------------------------------- |
+// | the palette upload          | bones x characters x 32 bytes, one stream copy |
+// | the draw                    | one, however many characters                   |
+// | the mesh                    | nothing: static VBO / EBO, a cached VAO        |
+//
+// A texture buffer rather than a UBO: a uniform block tops out at 16 KB (512 bones) on
+// many drivers, a texture buffer at GL_MAX_TEXTURE_BUFFER_SIZE texels (64K at the very
+// least, usually 128M). The stream buffer behind it is the texture's storage, so the
+// ring's segments are simply different base texels; glTexBuffer happens once per
+// (re)allocation, not per frame.
+//
+// setUniforms() finds the two ints; call it once after each link of the program (main
+// does, as for the tilemap). uPalette reads kPaletteTextureUnit, vertex.glsl's binding.
+class SkinnedMeshRenderer {
+public:
+    static constexpr GLenum kPaletteTextureUnit = GL_TEXTURE0 + shaderlayout::vertex::uPalette.binding;
+
+    struct Stats {
+        std::size_t characters = 0;    // this frame's upload()
+        std::size_t bones = 0;         // ... and the palette entries in it
+    };
+
+    // GL thread. The mesh's VAO comes from `vaos`, which must outlive the renderer.
+    // maxBones: palette entries (bones x characters) one frame can hold.
+    bool init(VertexArrayCache& vaos, const SkinnedVertex* vertices, std::size_t vertexCount,
+              const std::uint16_t* indices, std::size_t indexCount, std::size_t maxBones);
+    void shutdown();
+
+    void setUniforms(GLuint program);
+
+    // Once per frame: palette is `bones` rows of `characters` (SkeletonPoses::palette).
+    // Keeps as many characters as a frame's palette holds.
+    void upload(const Affine2D* palette, std::size_t bones, std::size_t characters);
+    // Per view, with the program bound: every character uploaded this frame, one draw.
+    void draw();
+    void endFrame() {
+        palette_.endFrame();
+        stats_ = Stats{};
+    }
+
+    bool initialized() const { return vao_ != 0; }
+    const Stats& stats() const { return stats_; }
+
+private:
+    VertexArrayCache* vaos_ = nullptr;
+    GlBuffer vertices_;
+    GlBuffer indices_;
+    GLuint vao_ = 0;
+    GLsizei indexCount_ = 0;
+    StreamBuffer palette_;
+    GlTexture paletteTexture_;
+    std::size_t maxBones_ = 0;
+    GLint base_ = 0;                   // this frame's first texel
+    GLint baseLocation_ = -1;
+    GLint charactersLocation_ = -1;
+    Stats stats_;
+};
@@ -0,0 +1,197 @@
+#include "render/soft_raster.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+constexpr float kH = SoftRasterizer::kQuadHalfExtent;
+
+// x / 255 rounded, exact for every x in [0, 255 * 255].
+inline std::uint32_t div255(std::uint32_t x) {
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+// src over dst with the source's own alpha, per channel (alpha included), as GL blends.
+inline std::uint32_t blendOver(std::uint32_t src, std::uint32_t dst) {
+    const std::uint32_t a = src >> 24;
+    std::uint32_t out = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+        const std::uint32_t s = (src >> shift) & 0xFFu, d = (dst >> shift) & 0xFFu;
+        out |= div255(s * a + d * (255u - a)) << shift;
+    }
+    return out;
+}
+
+inline std::uint32_t modulate(std::uint32_t texel, std::uint32_t tint) {
+    std::uint32_t out = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+        out |= div255(((texel >> shift) & 0xFFu) * ((tint >> shift) & 0xFFu)) << shift;
+    }
+    return out;
+}
+
+inline bool covered(float u, float v) {
+    return u >= -kH && u < kH && v >= -kH && v < kH;
+}
+
+} // namespace
+
+void SoftRasterizer::resize(int width, int height) {
+    target_.width = std::max(width, 0);
+    target_.height = std::max(height, 0);
+    target_.pixels.assign(static_cast<std::size_t>(target_.width) * static_cast<std::size_t>(target_.height), 0u);
+}
+
+void SoftRasterizer::clear(std::uint32_t color) {
+    std::fill(target_.pixels.begin(), target_.pixels.end(), color);
+}
+
+bool SoftRasterizer::setup(const Affine2D& model, Span& span) const {
+    // local → clip → pixels (the viewport: [-1, 1] onto [0, size]).
+    const float w = static_cast<float>(target_.width), h = static_cast<float>(target_.height);
+    const Affine2D viewport{glm::vec3(0.5f * w, 0.0f, 0.5f * w), glm::vec3(0.0f, 0.5f * h, 0.5f * h)};
+    const Affine2D pixel = combineAffine2D(viewport, camera_.apply(model));
+    const float det = pixel.row0.x * pixel.row1.y - pixel.row0.y * pixel.row1.x;
+    if (!(std::fabs(det) > 1e-12f)) {
+        return false;                  // zero scale (or NaN): nothing to cover
+    }
+    // The corners' bounding box, in whole pixels whose centers may be covered.
+    const float ex = kH * (std::fabs(pixel.row0.x) + std::fabs(pixel.row0.y));
+    const float ey = kH * (std::fabs(pixel.row1.x) + std::fabs(pixel.row1.y));
+    span.x0 = std::max(0, static_cast<int>(std::floor(pixel.row0.z - ex)));
+    span.y0 = std::max(0, static_cast<int>(std::floor(pixel.row1.z - ey)));
+    span.x1 = std::min(target_.width - 1, static_cast<int>(std::ceil(pixel.row0.z + ex)));
+    span.y1 = std::min(target_.height - 1, static_cast<int>(std::ceil(pixel.row1.z + ey)));
+    if (span.x0 > span.x1 || span.y0 > span.y1) {
+        return false;
+    }
+    span.local = inverseAffine2D(pixel);
+    return true;
+}
+
+void SoftRasterizer::drawQuads(const Affine2D* models, const std::uint32_t* colors, std::size_t count,
+                               Blend blend) {
+    for (std::size_t i = 0; i < count; ++i) {
+        Span span;
+        if (!setup(models[i], span)) {
+            continue;
+        }
+        // Fully transparent on an alpha blended path: nothing changes.
+        if (blend == Blend::Alpha && (colors[i] >> 24) == 0) {
+            continue;
+        }
+        ++stats_.quads;
+        fillSolid(span, colors[i], blend == Blend::Alpha && (colors[i] >> 24) == 255 ? Blend::Opaque : blend);
+    }
+}
+
+void SoftRasterizer::fillSolid(const Span& span, std::uint32_t color, Blend blend) {
+    const Affine2D& m = span.local;
+    std::uint64_t tested = 0, coveredCount = 0;
+#if defined(__SSE2__)
+    const __m128 lane = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);   // the pixel centers
+    const __m128 du = _mm_set1_ps(m.row0.x), dv = _mm_set1_ps(m.row1.x);
+    const __m128 lo = _mm_set1_ps(-kH), hi = _mm_set1_ps(kH);
+    const __m128i solid = _mm_set1_epi32(static_cast<int>(color));
+    const __m128i zero = _mm_setzero_si128();
+    // Alpha: src * a per channel (alpha's own too), and 255 - a, in 16-bit lanes.
+    const std::uint32_t a = color >> 24;
+    const __m128i srcTerm = _mm_mullo_epi16(_mm_unpacklo_epi8(solid, zero), _mm_set1_epi16(static_cast<short>(a)));
+    const __m128i inverse = _mm_set1_epi16(static_cast<short>(255 - a));
+    const __m128i round = _mm_set1_epi16(128);
+#endif
+    for (int y = span.y0; y <= span.y1; ++y) {
+        // Each pixel's point from its own x (never accumulated), the same in both loops.
+        const float py = static_cast<float>(y) + 0.5f;
+        const float ur = m.row0.y * py + m.row0.z;
+        const float vr = m.row1.y * py + m.row1.z;
+        std::uint32_t* row = target_.pixels.data() + static_cast<std::size_t>(y) * target_.width;
+        int x = span.x0;
+#if defined(__SSE2__)
+        const __m128 ur4 = _mm_set1_ps(ur), vr4 = _mm_set1_ps(vr);
+        for (; x + 3 <= span.x1; x += 4) {
+            const __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), lane);
+            const __m128 u4 = _mm_add_ps(_mm_mul_ps(px, du), ur4);
+            const __m128 v4 = _mm_add_ps(_mm_mul_ps(px, dv), vr4);
+            const __m128 in = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(u4, lo), _mm_cmplt_ps(u4, hi)),
+                                         _mm_and_ps(_mm_cmpge_ps(v4, lo), _mm_cmplt_ps(v4, hi)));
+            const int bits = _mm_movemask_ps(in);
+            if (bits != 0) {
+                const __m128i mask = _mm_castps_si128(in);
+                __m128i* p = reinterpret_cast<__m128i*>(row + x);
+                const __m128i dst = _mm_loadu_si128(p);
+                __m128i src = solid;
+                if (blend == Blend::Alpha) {
+                    // (s * a + d * (255 - a)) / 255 per channel, two pixels per half.
+                    __m128i l = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(dst, zero), inverse),
+                                                            srcTerm), round);
+                    __m128i h = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(dst, zero), inverse),
+                                                            srcTerm), round);
+                    l = _mm_srli_epi16(_mm_add_epi16(l, _mm_srli_epi16(l, 8)), 8);
+                    h = _mm_srli_epi16(_mm_add_epi16(h, _mm_srli_epi16(h, 8)), 8);
+                    src = _mm_packus_epi16(l, h);
+                }
+                _mm_storeu_si128(p, _mm_or_si128(_mm_and_si128(mask, src), _mm_andnot_si128(mask, dst)));
+                coveredCount += static_cast<std::uint64_t>(__builtin_popcount(static_cast<unsigned>(bits)));
+            }
+        }
+        tested += static_cast<std::uint64_t>(x - span.x0);
+#endif
+        for (; x <= span.x1; ++x) {
+            ++tested;
+            const float px = static_cast<float>(x) + 0.5f;
+            if (covered(px * m.row0.x + ur, px * m.row1.x + vr)) {
+                row[x] = blend == Blend::Alpha ? blendOver(color, row[x]) : color;
+                ++coveredCount;
+            }
+        }
+    }
+    stats_.pixelsTested += tested;
+    stats_.pixelsCovered += coveredCount;
+}
+
+void SoftRasterizer::drawSprites(const Affine2D* models, const glm::vec4* uvRects, const std::uint32_t* tints,
+                                 std::size_t count, const Image& texture, Blend blend) {
+    if (!texture.valid()) {
+        return;
+    }
+    const float tw = static_cast<float>(texture.width), th = static_cast<float>(texture.height);
+    for (std::size_t i = 0; i < count; ++i) {
+        Span span;
+        if (!setup(models[i], span)) {
+            continue;
+        }
+        ++stats_.quads;
+        // Local [-h, h) → texels of the rectangle, as one multiply-add per axis.
+        const glm::vec4& r = uvRects[i];
+        const float su = (r.z - r.x) * tw / (2.0f * kH), ou = r.x * tw + kH * su;
+        const float sv = (r.w - r.y) * th / (2.0f * kH), ov = r.y * th + kH * sv;
+        const Affine2D& m = span.local;
+        for (int y = span.y0; y <= span.y1; ++y) {
+            const float py = static_cast<float>(y) + 0.5f;
+            const float ur = m.row0.y * py + m.row0.z;
+            const float vr = m.row1.y * py + m.row1.z;
+            std::uint32_t* row = target_.pixels.data() + static_cast<std::size_t>(y) * target_.width;
+            for (int x = span.x0; x <= span.x1; ++x) {
+                ++stats_.pixelsTested;
+                const float px = static_cast<float>(x) + 0.5f;
+                const float u = px * m.row0.x + ur, v = px * m.row1.x + vr;
+                if (!covered(u, v)) {
+                    continue;
+                }
+                const int tx = std::clamp(static_cast<int>(u * su + ou), 0, texture.width - 1);
+                const int ty = std::clamp(static_cast<int>(v * sv + ov), 0, texture.height - 1);
+                const std::uint32_t texel =
+                    modulate(texture.pixels[static_cast<std::size_t>(ty) * texture.width + tx], tints[i]);
+                row[x] = blend == Blend::Alpha ? blendOver(texel, row[x]) : texel;
+                ++stats_.pixelsCovered;
+            }
+        }
+    }
+}
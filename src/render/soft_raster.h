@@ -0,0 +1,76 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+
+#include "asset/image.h"
+#include "core/batch_transform.h"
+#include "render/ortho_2d.h"
+
+// SoftRasterizer
+// --------------
+// The game's 2D primitives drawn on the CPU into an Image: no GPU, no driver, no context.
+// For machines without a GPU (CI: `make soft-bench`, src/bench/soft_bench.cpp) and for
+// timing the CPU side of drawing a scene with nothing of the driver's in the numbers.
+//
+// | Primitive      | Same as on the GPU                                              |
+// | -------------- | --------------------------------------------------------------- |
+// | quad           | main's quad ([-0.25, 0.25]², kQuadHalfExtent) under an Affine2D  |
+// |                | (core/batch_transform.h), one packed color each                 |
+// | sprite         | the same quad, a rectangle of a texture sampled nearest, tinted |
+// | camera         | an Ortho2D view-projection (render/ortho_2d.h), clip space to   |
+// |                | the whole target as glViewport would                            |
+// | Blend::Alpha   | glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA), alpha too    |
+//
+// Each quad is walked over its pixel bounding box; a pixel is covered when its center,
+// taken back into the quad's own space by the inverse transform, lands in
+// [-0.25, 0.25)²—half-open, so two quads sharing an edge never both cover a pixel. That
+// point is also the texture coordinate: a sprite costs one more multiply-add per axis.
+//
+// SSE2 path (every x86-64 CPU) for quads: four pixels per iteration, the coverage as a
+// lane mask and the color blended in 16-bit lanes; the row's tail and other targets take
+// the scalar loop, which gives the same bytes. Sprites fetch each texel on its own (SSE2
+// has no gather). The Image's row 0 is the bottom, like GL's: a capture of the same
+// scene compares pixel for pixel, rounding at the edges aside.
+//
+// Not thread-safe; one target per rasterizer.
+class SoftRasterizer {
+public:
+    enum class Blend : std::uint8_t { Opaque, Alpha };
+
+    static constexpr float kQuadHalfExtent = 0.25f;
+
+    struct Stats {
+        std::uint64_t quads = 0;       // drawn (sprites included), culled ones not
+        std::uint64_t pixelsTested = 0;
+        std::uint64_t pixelsCovered = 0;
+    };
+
+    void resize(int width, int height);
+    void clear(std::uint32_t color);
+    void setCamera(const Ortho2D& viewProjection) { camera_ = viewProjection; }
+
+    void drawQuads(const Affine2D* models, const std::uint32_t* colors, std::size_t count, Blend blend);
+    // uvRects: (u0, v0, u1, v1) per sprite, of `texture` (v = 0 is its row 0).
+    void drawSprites(const Affine2D* models, const glm::vec4* uvRects, const std::uint32_t* tints,
+                     std::size_t count, const Image& texture, Blend blend);
+
+    const Image& image() const { return target_; }
+    const Stats& stats() const { return stats_; }
+    void resetStats() { stats_ = Stats{}; }
+
+private:
+    // The quad's pixel rectangle and the inverse transform; false: off the target or
+    // degenerate.
+    struct Span {
+        int x0, y0, x1, y1;            // inclusive
+        Affine2D local;                // pixel → the quad's own space
+    };
+    bool setup(const Affine2D& model, Span& span) const;
+    void fillSolid(const Span& span, std::uint32_t color, Blend blend);
+
+    Image target_;
+    Ortho2D camera_;
+    Stats stats_;
+};
@@ -0,0 +1,84 @@
+#include "render/sprite_animation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include "render/gl_buffer.h"
+#include "render/gl_state.h"
+#include "render/gpu_memory.h"
+
+namespace {
+
+// The block's size: the time's 16-byte slot, then the clips (offsets generated from
+// animation.glsl: render/shader_layout.h).
+using Block = shaderlayout::animation::AnimationClips;
+constexpr GLsizeiptr kClipsOffset = Block::clips;
+constexpr GLsizeiptr kBlockBytes = Block::kSize;
+static_assert(Block::animationTime == 0, "upload() writes the time first");
+static_assert(sizeof(AnimationClipEntry) == Block::clipsStride, "AnimationClipEntry must match the array stride");
+static_assert(kClipsOffset + AnimationClipTable::kMaxClips * sizeof(AnimationClipEntry) == Block::kSize,
+              "kMaxClips must match the GLSL array's length");
+
+} // namespace
+
+int AnimationClipTable::add(const AnimationClip& clip) {
+    if (clips_.size() >= kMaxClips) {
+        return -1;
+    }
+    AnimationClip c = clip;
+    c.frames = std::max(c.frames, 1u);  // the shader divides by it
+    clips_.push_back(c);
+    return static_cast<int>(clips_.size() - 1);
+}
+
+std::uint32_t AnimationClipTable::layerAt(std::uint32_t sprite, float start, float rate, float time) const {
+    if (!isAnimatedSprite(sprite)) {
+        return sprite;
+    }
+    const std::uint32_t id = sprite & 0x7fffu;
+    if (id >= clips_.size()) {
+        return 0;
+    }
+    const AnimationClip& c = clips_[id];
+    const std::uint32_t frame = static_cast<std::uint32_t>(std::max((time - start) * rate * c.fps, 0.0f));
+    return c.firstLayer + (c.loop ? frame % c.frames : std::min(frame, c.frames - 1));
+}
+
+bool AnimationClipTable::init() {
+    const gpumemory::Owner owner("sprite clips");
+    ubo_ = GlBuffer::create();
+    glbuffer::data(GL_UNIFORM_BUFFER, ubo_.get(), kBlockBytes, nullptr, GL_DYNAMIC_DRAW);
+    if (!ubo_) {
+        std::cerr << "Failed to create animation clip buffer\n";
+        return false;
+    }
+    uploaded_ = 0;
+    glstate::bindBufferBase(GL_UNIFORM_BUFFER, kBindingPoint, ubo_.get());
+    return true;
+}
+
+void AnimationClipTable::shutdown() {
+    ubo_.reset();
+    uploaded_ = 0;
+}
+
+void AnimationClipTable::upload(float time) {
+    if (!ubo_) {
+        return;
+    }
+    glbuffer::subData(GL_UNIFORM_BUFFER, ubo_.get(), 0, sizeof(float), &time);
+    // Clips are only ever added, so only the new ones go up.
+    if (uploaded_ < clips_.size()) {
+        std::vector<AnimationClipEntry> entries;
+        entries.reserve(clips_.size() - uploaded_);
+        for (std::size_t i = uploaded_; i < clips_.size(); ++i) {
+            const AnimationClip& c = clips_[i];
+            entries.push_back(AnimationClipEntry{c.firstLayer, c.frames, c.fps, c.loop ? 1u : 0u});
+        }
+        glbuffer::subData(GL_UNIFORM_BUFFER, ubo_.get(),
+                          kClipsOffset + static_cast<GLsizeiptr>(uploaded_ * sizeof(AnimationClipEntry)),
+                          static_cast<GLsizeiptr>(entries.size() * sizeof(AnimationClipEntry)), entries.data());
+        uploaded_ = clips_.size();
+    }
+}
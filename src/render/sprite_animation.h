@@ -0,0 +1,97 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "render/gl_resource.h"
+#include "render/shader_layout.h"
+
+// Sprite animation
+// ----------------
+// A clip is a run of consecutive TextureArray layers played at some frame rate. An
+// animated sprite is a clip id instead of a layer, plus when it started and how fast it
+// plays—and nothing else: shaders/vertex.glsl ANIMATED picks the frame from the clip
+// table and the time, so the instance only changes when an animation (re)starts, never
+// from one frame of it to the next.
+//
+//     frame = floor(max(time - start, 0) * rate * fps)
+//     layer = first + (loop ? frame % frames : min(frame, frames - 1))
+//
+// | Piece                       | Where                                                   |
+// | --------------------------- | ------------------------------------------------------- |
+// | animatedSprite(clip)        | the sprite id (SpriteRef.id; a LayeredInstance's layer) |
+// | start, rate                 | SpriteRef.start / .rate → AnimatedInstance              |
+// | the clips and the time      | AnimationClipTable: one std140 UBO, "AnimationClips"    |
+// | frame selection             | vertex.glsl ANIMATED (GPU); layerAt() (CPU: sprite      |
+// |                             | batch and picking, which have no clip table)            |
+//
+// An animated id sets bit 15 of the 16-bit array layer, so the two can't be confused
+// while the array stays under 32768 layers (GL 3.3 guarantees 256).
+constexpr std::uint32_t kAnimatedSprite = 0x8000u;
+
+constexpr std::uint32_t animatedSprite(std::uint32_t clip) { return kAnimatedSprite | (clip & 0x7fffu); }
+constexpr bool isAnimatedSprite(std::uint32_t sprite) { return (sprite & kAnimatedSprite) != 0; }
+
+struct AnimationClip {
+    std::uint32_t firstLayer = 0;
+    std::uint32_t frames = 1;
+    float fps = 10.0f;
+    bool loop = true;
+};
+
+// AnimationClipBlock
+// ------------------
+// CPU mirror of the block in shaders/animation.glsl:
+//
+//     layout (std140, binding = 1) uniform AnimationClips {
+//         float animationTime;
+//         Clip clips[256];   // struct Clip { uint first; uint frames; float fps; uint loop; }
+//     };
+//
+// std140 rounds a struct array's start and stride up to 16 bytes: the time takes a whole
+// vec4 slot, every clip exactly one (checked against the GLSL in the .cpp).
+struct AnimationClipEntry {
+    std::uint32_t first;
+    std::uint32_t frames;
+    float fps;
+    std::uint32_t loop;
+};
+
+// AnimationClipTable
+// ------------------
+// The clips, and the UBO the animated programs read them from.
+//
+// | Step                           | When                                           |
+// | ------------------------------ | ---------------------------------------------- |
+// | add(clip)                      | at start-up (before or after init)             |
+// | init()                         | once, on the GL thread                         |
+// | upload(time)                   | once per frame: 4 bytes, + the clips if added  |
+//
+// add() and layerAt() touch no GL state, so the simulation can define clips and the CPU
+// paths can resolve frames on any thread, as long as no clip is added meanwhile.
+class AnimationClipTable {
+public:
+    // animation.glsl's `binding = 1` (0 is the camera's); no program attaches it.
+    static constexpr GLuint kBindingPoint = shaderlayout::animation::AnimationClips::kBinding;
+    static constexpr std::size_t kMaxClips = 256;
+
+    // The clip's id for animatedSprite(), or -1 when the table is full.
+    int add(const AnimationClip& clip);
+    std::size_t size() const { return clips_.size(); }
+    const AnimationClip& clip(std::uint32_t id) const { return clips_[id]; }
+
+    // The array layer `sprite` shows at `time`: itself if it isn't animated, the clip's
+    // current frame if it is (the shader's math, for the paths that draw without it).
+    std::uint32_t layerAt(std::uint32_t sprite, float start, float rate, float time) const;
+
+    bool init();
+    void shutdown();
+    void upload(float time);
+
+private:
+    std::vector<AnimationClip> clips_;
+    std::size_t uploaded_ = 0;          // clips the UBO already has
+    GlBuffer ubo_;
+};
@@ -0,0 +1,248 @@
+#include "render/sprite_batch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#include "render/gl_buffer.h"
+#include "render/gl_state.h"
+#include "render/gpu_memory.h"
+#include "render/vertex_layout.h"
+
+namespace {
+
+namespace input = shaderlayout::sprite_vertex;
+
+const VertexLayout kVertexLayout(sizeof(SpriteVertex), {
+    shaderInput(input::aPos, 2, GL_FLOAT, VertexAttribute::Kind::Float, offsetof(SpriteVertex, pos)),
+    shaderInput(input::aUV, 2, GL_UNSIGNED_SHORT, VertexAttribute::Kind::Normalized, offsetof(SpriteVertex, uv)),
+    // Normalized: bytes 0..255 arrive in the shader as floats 0..1.
+    shaderInput(input::aColor, 4, GL_UNSIGNED_BYTE, VertexAttribute::Kind::Normalized, offsetof(SpriteVertex, color)),
+});
+
+void appendQuad(std::vector<SpriteVertex>& out, const glm::vec2 corners[4], const glm::vec4& uvRect,
+                std::uint32_t color) {
+    // The rect's four edges to unorm16 once; each corner pairs two of them.
+    const glm::uvec4 uv(glm::clamp(uvRect, 0.0f, 1.0f) * 65535.0f + 0.5f);
+    out.push_back({corners[0], uv.x | (uv.y << 16), color});
+    out.push_back({corners[1], uv.z | (uv.y << 16), color});
+    out.push_back({corners[2], uv.z | (uv.w << 16), color});
+    out.push_back({corners[3], uv.x | (uv.w << 16), color});
+}
+
+} // namespace
+
+std::uint32_t packColor(const glm::vec4& rgba) {
+    glm::vec4 c = glm::clamp(rgba, 0.0f, 1.0f) * 255.0f + 0.5f;
+    return (static_cast<std::uint32_t>(c.r)) |
+           (static_cast<std::uint32_t>(c.g) << 8) |
+           (static_cast<std::uint32_t>(c.b) << 16) |
+           (static_cast<std::uint32_t>(c.a) << 24);
+}
+
+bool SpriteBatch::init() {
+    const gpumemory::Owner owner("sprite batch");
+    vertices_.reserve(kMaxSprites * 4);
+
+    // Index pattern for every quad is the same as the quad in main(): 0 1 2, 2 3 0.
+    // Built once for the maximum batch and never touched again.
+    // 16-bit: the last quad's vertices are still below 65536, and the EBO is half the size.
+    static_assert(kMaxSprites * 4 <= 65536, "sprite batch indices are GL_UNSIGNED_SHORT");
+    std::vector<std::uint16_t> indices(kMaxSprites * 6);
+    for (std::size_t i = 0; i < kMaxSprites; ++i) {
+        const auto base = static_cast<std::uint16_t>(i * 4);
+        indices[i * 6 + 0] = base + 0;
+        indices[i * 6 + 1] = base + 1;
+        indices[i * 6 + 2] = base + 2;
+        indices[i * 6 + 3] = base + 2;
+        indices[i * 6 + 4] = base + 3;
+        indices[i * 6 + 5] = base + 0;
+    }
+
+    if (!stream_.init(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(kMaxSprites * 4 * sizeof(SpriteVertex)))) {
+        std::cerr << "SpriteBatch: failed to create vertex stream\n";
+        return false;
+    }
+
+    ebo_ = GlBuffer::create();
+    glbuffer::data(GL_ELEMENT_ARRAY_BUFFER, ebo_.get(), indices.size() * sizeof(std::uint16_t), indices.data(),
+                   GL_STATIC_DRAW);
+
+    vao_ = GlVertexArray::create();
+    glstate::bindVertexArray(vao_.get());
+    glstate::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_.get());   // recorded into the VAO
+
+    glstate::bindBuffer(GL_ARRAY_BUFFER, stream_.buffer());
+    kVertexLayout.enable();
+    glstate::bindVertexArray(0);
+
+    // 1x1 white texture so untextured sprites go through the same shader (texture * colour).
+    const std::uint32_t white = 0xFFFFFFFFu;
+    whiteTexture_ = GlTexture::create();
+    glstate::bindTexture(GL_TEXTURE_2D, whiteTexture_.get());
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, &white);
+    gpumemory::track(GlObject::Texture, whiteTexture_.get(), 4, gpumemory::Category::Texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glstate::bindTexture(GL_TEXTURE_2D, 0);
+    return true;
+}
+
+void SpriteBatch::shutdown() {
+    stream_.shutdown();
+    ebo_.reset();
+    vao_.reset();
+    whiteTexture_.reset();
+}
+
+// Assumes vao_ is bound.
+void SpriteBatch::bindVertexAttributes(GLintptr offset) {
+    glstate::bindBuffer(GL_ARRAY_BUFFER, stream_.buffer());
+    kVertexLayout.pointers(offset);
+}
+
+void SpriteBatch::begin() {
+    vertices_.clear();
+    stats_ = Stats{};
+    program_ = 0;
+    boundProgram_ = 0;
+    texture_ = 0;
+}
+
+void SpriteBatch::setProgram(GLuint program) {
+    if (program == program_) {
+        return;
+    }
+    if (!vertices_.empty()) {
+        stats_.programBreaks++;
+        flush();
+    }
+    program_ = program;
+}
+
+void SpriteBatch::submit(const Sprite& sprite) {
+    const glm::vec2 half = sprite.size * 0.5f;
+    const float c = std::cos(sprite.rotation);
+    const float s = std::sin(sprite.rotation);
+    const glm::vec2 axisX(c * half.x, s * half.x);
+    const glm::vec2 axisY(-s * half.y, c * half.y);
+
+    // Same winding as the quad in main(): bottom-left, bottom-right, top-right, top-left.
+    const glm::vec2 corners[4] = {
+        sprite.position - axisX - axisY,
+        sprite.position + axisX - axisY,
+        sprite.position + axisX + axisY,
+        sprite.position - axisX + axisY,
+    };
+    pushQuad(corners, sprite.uvRect, sprite.color, sprite.texture);
+}
+
+void SpriteBatch::submit(const glm::mat4& model, GLuint texture, const glm::vec4& uvRect, std::uint32_t color) {
+    const glm::vec2 corners[4] = {
+        glm::vec2(model * glm::vec4(-0.5f, -0.5f, 0.0f, 1.0f)),
+        glm::vec2(model * glm::vec4( 0.5f, -0.5f, 0.0f, 1.0f)),
+        glm::vec2(model * glm::vec4( 0.5f,  0.5f, 0.0f, 1.0f)),
+        glm::vec2(model * glm::vec4(-0.5f,  0.5f, 0.0f, 1.0f)),
+    };
+    pushQuad(corners, uvRect, color, texture);
+}
+
+void SpriteBatch::pushQuad(const glm::vec2 corners[4], const glm::vec4& uvRect, std::uint32_t color, GLuint texture) {
+    appendQuad(quadTarget(texture), corners, uvRect, color);
+}
+
+std::vector<SpriteVertex>& SpriteBatch::quadTarget(GLuint texture) {
+    if (recording_) {
+        return *recording_;
+    }
+    if (texture != texture_) {
+        if (!vertices_.empty()) {
+            stats_.textureBreaks++;
+            flush();
+        }
+        texture_ = texture;
+    }
+    if (vertices_.size() + 4 > kMaxSprites * 4) {
+        stats_.capacityBreaks++;
+        flush();
+    }
+    stats_.sprites++;
+    return vertices_;
+}
+
+void SpriteBatch::submitTriangles(const glm::mat4& model, const glm::vec2* positions, const std::uint16_t* indices,
+                                  std::size_t indexCount, GLuint texture, const glm::vec4& uvRect,
+                                  std::uint32_t color) {
+    // The quad's indices are 0 1 2, 2 3 0: with corner 3 = corner 2 the second triangle
+    // has no area and rasterizes nothing.
+    const glm::vec2 uvMin(uvRect.x, uvRect.y);
+    const glm::vec2 uvSpan(uvRect.z - uvRect.x, uvRect.w - uvRect.y);
+    for (std::size_t i = 0; i + 3 <= indexCount; i += 3) {
+        std::vector<SpriteVertex>& out = quadTarget(texture);
+        for (std::size_t k = 0; k < 4; ++k) {
+            const glm::vec2& p = positions[indices[i + std::min<std::size_t>(k, 2)]];
+            const glm::uvec2 uv(glm::clamp(uvMin + (p + 0.5f) * uvSpan, 0.0f, 1.0f) * 65535.0f + 0.5f);
+            out.push_back({glm::vec2(model * glm::vec4(p, 0.0f, 1.0f)), uv.x | (uv.y << 16), color});
+        }
+    }
+}
+
+void SpriteBatch::submitQuads(const SpriteVertex* vertices, std::size_t quads, GLuint texture) {
+    if (quads > 0 && texture != texture_) {
+        if (!vertices_.empty()) {
+            stats_.textureBreaks++;
+            flush();
+        }
+        texture_ = texture;
+    }
+    while (quads > 0) {
+        if (vertices_.size() == kMaxSprites * 4) {
+            stats_.capacityBreaks++;
+            flush();
+        }
+        const std::size_t n = std::min(quads, kMaxSprites - vertices_.size() / 4);
+        vertices_.insert(vertices_.end(), vertices, vertices + n * 4);
+        stats_.sprites += n;
+        vertices += n * 4;
+        quads -= n;
+    }
+}
+
+void SpriteBatch::end() {
+    flush();
+    lastStats_ = stats_;
+}
+
+void SpriteBatch::flush() {
+    if (vertices_.empty() || program_ == 0) {
+        vertices_.clear();
+        return;
+    }
+
+    const GLsizeiptr bytes = static_cast<GLsizeiptr>(vertices_.size() * sizeof(SpriteVertex));
+    StreamAllocation allocation = stream_.allocate(bytes, sizeof(SpriteVertex));
+    if (!allocation.valid()) {
+        // The frame's segment is exhausted (more than kMaxSprites in one frame across
+        // batches). Drop the rest instead of stalling; raise kMaxSprites if this shows up.
+        std::cerr << "SpriteBatch: stream segment full, dropping " << vertices_.size() / 4 << " sprites\n";
+        vertices_.clear();
+        return;
+    }
+    std::memcpy(allocation.ptr, vertices_.data(), bytes);
+    stream_.commit(allocation);
+
+    if (boundProgram_ != program_) {
+        glstate::useProgram(program_);
+        boundProgram_ = program_;
+    }
+    glstate::activeTexture(GL_TEXTURE0);
+    glstate::bindTexture(GL_TEXTURE_2D, texture_ ? texture_ : whiteTexture_.get());
+
+    glstate::bindVertexArray(vao_.get());
+    bindVertexAttributes(allocation.offset);
+    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(vertices_.size() / 4 * 6), GL_UNSIGNED_SHORT, 0);
+
+    stats_.batches++;
+    vertices_.clear();
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "render/gl_resource.h"
+#include "render/stream_buffer.h"
+
+// SpriteVertex
+// ------------
+// One corner of a batched quad, already in world space. 16 bytes (20 with float UVs,
+// see render/vertex_layout.h): UVs are always in [0, 1], where unorm16 is exact to
+// 1/65535—finer than a texel of any atlas page.
+//
+// | Location | Field   | Format                          |
+// | -------- | ------- | ------------------------------- |
+// | 0        | pos     | 2 x float                       |
+// | 1        | uv      | 2 x unsigned short, normalized  |
+// | 2        | color   | 4 x unsigned byte, normalized   |
+struct SpriteVertex {
+    glm::vec2 pos;
+    std::uint32_t uv;    // u in the low half, v in the high half
+    std::uint32_t color; // 0xAABBGGRR (R in the lowest byte, matching GL's RGBA byte order)
+};
+static_assert(sizeof(SpriteVertex) == 16, "SpriteVertex is a vertex attribute stride");
+
+// Packs 0..1 floats into the SpriteVertex colour format.
+std::uint32_t packColor(const glm::vec4& rgba);
+
+// Sprite
+// ------
+// Convenience description of a sprite; submit() also accepts a raw model matrix.
+struct Sprite {
+    glm::vec2 position{0.0f};
+    glm::vec2 size{1.0f};
+    float rotation = 0.0f;                        // radians, around the centre
+    glm::vec4 uvRect{0.0f, 0.0f, 1.0f, 1.0f};     // (u0, v0, u1, v1)
+    std::uint32_t color = 0xFFFFFFFFu;
+    GLuint texture = 0;                           // 0 = untextured (white)
+};
+
+// SpriteBatch
+// -----------
+// Immediate-style 2D batcher: sprites are transformed on the CPU into a staging array
+// of SpriteVertex and drawn with as few glDrawElements calls as possible.
+//
+// A batch ends (and a draw is issued) ONLY when:
+// - the program changes (setProgram),
+// - the texture changes between consecutive submits,
+// - the staging array is full (kMaxSprites), or
+// - end() is called.
+//
+// Usage per frame:
+//     batch.begin();
+//     batch.setProgram(spriteProgram);
+//     batch.submit(sprite);  // many times
+//     batch.end();           // flushes whatever is left
+//     batch.endFrame();      // after the last flush of the frame (fences the stream)
+//
+// Geometry that rarely changes (render/ui_renderer.h) is built once with record() and
+// replayed with submitQuads(): a copy into the staging array, nothing transformed.
+class SpriteBatch {
+public:
+    // 16384 quads * 4 vertices = 65536 vertices per flush.
+    static constexpr std::size_t kMaxSprites = 16384;
+
+    struct Stats {
+        std::size_t sprites = 0;
+        std::size_t batches = 0;      // draw calls issued
+        std::size_t programBreaks = 0;
+        std::size_t textureBreaks = 0;
+        std::size_t capacityBreaks = 0;
+    };
+
+    bool init();
+    void shutdown();
+
+    void begin();
+    void setProgram(GLuint program);
+    void submit(const Sprite& sprite);
+    // Model matrix applied to a unit quad centred on the origin ([-0.5, 0.5]^2).
+    void submit(const glm::mat4& model, GLuint texture = 0,
+                const glm::vec4& uvRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f),
+                std::uint32_t color = 0xFFFFFFFFu);
+    // Indexed triangles (render/shape_cache.h) in the unit quad's space, `model` applied
+    // as above; uvRect spans that space like a sprite's. Each triangle goes in as a quad
+    // with its last corner doubled, so shapes share the batch (and its quad index
+    // buffer) with the sprites around them.
+    void submitTriangles(const glm::mat4& model, const glm::vec2* positions, const std::uint16_t* indices,
+                         std::size_t indexCount, GLuint texture = 0,
+                         const glm::vec4& uvRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f),
+                         std::uint32_t color = 0xFFFFFFFFu);
+    // Quads built earlier, 4 vertices each as record() keeps them, all with `texture`.
+    void submitQuads(const SpriteVertex* vertices, std::size_t quads, GLuint texture);
+    // Until record(nullptr), submits append their quads to `vertices` instead of the
+    // staging array (their texture is the caller's to remember). Not cleared here.
+    void record(std::vector<SpriteVertex>* vertices) { recording_ = vertices; }
+    void end();
+    void endFrame() { stream_.endFrame(); }
+
+    // Statistics of the last completed begin()/end() pair.
+    const Stats& stats() const { return lastStats_; }
+
+private:
+    void flush();
+    void pushQuad(const glm::vec2 corners[4], const glm::vec4& uvRect, std::uint32_t color, GLuint texture);
+    // Where the next quad's 4 vertices go: the recording, else the staging array (flushed
+    // first on a texture change or when full).
+    std::vector<SpriteVertex>& quadTarget(GLuint texture);
+    void bindVertexAttributes(GLintptr offset);
+
+    GlVertexArray vao_;
+    GlBuffer ebo_;
+    GlTexture whiteTexture_;
+    StreamBuffer stream_;
+
+    GLuint program_ = 0;
+    GLuint boundProgram_ = 0;
+    GLuint texture_ = 0;
+    std::vector<SpriteVertex> vertices_;
+    std::vector<SpriteVertex>* recording_ = nullptr;
+
+    Stats stats_;
+    Stats lastStats_;
+};
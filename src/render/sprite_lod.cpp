@@ -0,0 +1,254 @@
+#include "render/sprite_lod.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "core/job_system.h"
+#include "core/radix_sort.h"
+#include "render/sprite_animation.h"
+
+namespace {
+
+constexpr std::uint64_t kNoCell = ~std::uint64_t{0};
+constexpr std::uint64_t kIndexMask = 0xffffffu;   // 24 bits of index under the cell
+
+// Channel c (0 = R .. 3 = A) of an 0xAABBGGRR colour, 0..255.
+float channel(std::uint32_t rgba, int c) {
+    return static_cast<float>((rgba >> (c * 8)) & 0xffu);
+}
+
+std::uint32_t pack(const float rgba[4]) {
+    std::uint32_t out = 0;
+    for (int c = 0; c < 4; ++c) {
+        out |= static_cast<std::uint32_t>(std::min(255.0f, std::max(0.0f, rgba[c])) + 0.5f) << (c * 8);
+    }
+    return out;
+}
+
+// Per-channel a * b / 255.
+std::uint32_t modulate(std::uint32_t a, std::uint32_t b) {
+    std::uint32_t out = 0;
+    for (int c = 0; c < 4; ++c) {
+        const std::uint32_t x = ((a >> (c * 8)) & 0xffu) * ((b >> (c * 8)) & 0xffu);
+        out |= ((x + 127u) / 255u) << (c * 8);
+    }
+    return out;
+}
+
+} // namespace
+
+void SpriteLod::describe(std::uint32_t sprite, const std::uint32_t* pixels, int width, int height) {
+    double alpha = 0.0;
+    double rgb[3] = {0.0, 0.0, 0.0};
+    const std::size_t texels = static_cast<std::size_t>(width) * height;
+    for (std::size_t t = 0; t < texels; ++t) {
+        const float a = channel(pixels[t], 3);
+        alpha += a;
+        for (int c = 0; c < 3; ++c) {
+            rgb[c] += channel(pixels[t], c) * a;
+        }
+    }
+    Type& type = typeFor(sprite);
+    if (texels == 0 || alpha <= 0.0) {
+        type.side = 0.0f;
+        type.tint = 0xffffffffu;
+        return;
+    }
+    type.side = static_cast<float>(std::sqrt(alpha / (255.0 * static_cast<double>(texels))));
+    const float tint[4] = {static_cast<float>(rgb[0] / alpha), static_cast<float>(rgb[1] / alpha),
+                           static_cast<float>(rgb[2] / alpha), 255.0f};
+    type.tint = pack(tint);
+}
+
+void SpriteLod::setFlatPx(std::uint32_t sprite, float pixels) {
+    typeFor(sprite).flatPx = std::max(0.0f, pixels);
+}
+
+void SpriteLod::setClip(std::uint32_t clip, std::uint32_t firstLayer) {
+    if (clip >= clipTypes_.size()) {
+        clipTypes_.resize(clip + 1);
+    }
+    clipTypes_[clip] = type(firstLayer);
+}
+
+void SpriteLod::setClustering(float cellPx, int minSprites) {
+    cellPx_ = std::max(0.0f, cellPx);
+    minSprites_ = static_cast<std::size_t>(std::max(2, minSprites));
+}
+
+const SpriteLod::Type& SpriteLod::type(std::uint32_t sprite) const {
+    if (isAnimatedSprite(sprite)) {
+        const std::uint32_t clip = sprite & ~kAnimatedSprite;
+        return clip < clipTypes_.size() ? clipTypes_[clip] : unknown_;
+    }
+    return sprite < types_.size() ? types_[sprite] : unknown_;
+}
+
+SpriteLod::Type& SpriteLod::typeFor(std::uint32_t sprite) {
+    if (sprite >= types_.size()) {
+        types_.resize(sprite + 1);
+    }
+    return types_[sprite];
+}
+
+std::size_t SpriteLod::apply(JobSystem& jobs, float pixelsPerUnit, Transforms2D& transforms,
+                             std::vector<std::uint32_t>& colors, std::vector<std::uint32_t>& sprites,
+                             std::vector<std::uint16_t>& zLayers, std::vector<glm::vec2>* animations) {
+    const std::size_t n = transforms.size();
+    ++stats_.frames;
+    if (n == 0 || pixelsPerUnit <= 0.0f) {
+        return n;
+    }
+    // A sprite's side on screen is 0.5 * scale world units (the [-0.25, 0.25] quad).
+    const float sidePx = 0.5f * pixelsPerUnit;
+    const bool cluster = cellPx_ > 0.0f && n <= kIndexMask;
+    const float cellsPerUnit = cluster ? pixelsPerUnit / cellPx_ : 0.0f;
+
+    // Flatten what is too small for its type; the flat ones get their screen cell.
+    const std::size_t ranges = (n + kRange - 1) / kRange;
+    cells_.resize(n);
+    rangeCandidates_.assign(ranges + 1, 0);
+    rangeFlat_.resize(ranges);
+    jobs.parallelFor(ranges, 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t r = begin; r < end; ++r) {
+            const std::size_t last = std::min(n, (r + 1) * kRange);
+            std::size_t flat = 0, candidates = 0;
+            for (std::size_t i = r * kRange; i < last; ++i) {
+                cells_[i] = kNoCell;
+                const Type& t = type(sprites[i]);
+                const float px = std::max(std::fabs(transforms.scaleX[i]), std::fabs(transforms.scaleY[i])) * sidePx;
+                if (t.flatPx <= 0.0f || px >= t.flatPx) {
+                    continue;
+                }
+                sprites[i] = flatSprite_;
+                colors[i] = modulate(colors[i], t.tint);
+                transforms.scaleX[i] *= t.side;
+                transforms.scaleY[i] *= t.side;
+                if (animations != nullptr) {
+                    (*animations)[i] = glm::vec2(0.0f);
+                }
+                ++flat;
+                if (cluster) {
+                    // Cell coordinates wrap at 16 bits: far more cells than a screen holds.
+                    const auto cx = static_cast<std::uint32_t>(static_cast<std::int32_t>(
+                                        std::floor(transforms.x[i] * cellsPerUnit))) & 0xffffu;
+                    const auto cy = static_cast<std::uint32_t>(static_cast<std::int32_t>(
+                                        std::floor(transforms.y[i] * cellsPerUnit))) & 0xffffu;
+                    cells_[i] = static_cast<std::uint64_t>(cy << 16 | cx) << 24 | i;
+                    ++candidates;
+                }
+            }
+            rangeFlat_[r] = flat;
+            rangeCandidates_[r + 1] = candidates;
+        }
+    });
+    for (std::size_t r = 0; r < ranges; ++r) {
+        stats_.flattened += rangeFlat_[r];
+        rangeCandidates_[r + 1] += rangeCandidates_[r];
+    }
+    const std::size_t candidates = rangeCandidates_[ranges];
+    if (candidates < minSprites_) {
+        return n;
+    }
+
+    // The flat ones by cell: equal cells end up next to each other, in index order.
+    keys_.resize(candidates);
+    sortScratch_.resize(candidates);
+    jobs.parallelFor(ranges, 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t r = begin; r < end; ++r) {
+            const std::size_t last = std::min(n, (r + 1) * kRange);
+            std::size_t k = rangeCandidates_[r];
+            for (std::size_t i = r * kRange; i < last; ++i) {
+                if (cells_[i] != kNoCell) {
+                    keys_[k++] = cells_[i];
+                }
+            }
+        }
+    });
+    const std::uint64_t* sorted = radixSort(jobs, keys_.data(), sortScratch_.data(), candidates, 3, 7);
+
+    // Each crowded cell's members folded into one impostor, written over its first member
+    // (the lowest index); the rest are dropped below.
+    removed_.assign(n, 0);
+    std::size_t removedCount = 0;
+    const float cellArea = 1.0f / (cellsPerUnit * cellsPerUnit);
+    for (std::size_t begin = 0; begin < candidates;) {
+        const std::uint64_t cell = sorted[begin] >> 24;
+        std::size_t end = begin + 1;
+        while (end < candidates && (sorted[end] >> 24) == cell) {
+            ++end;
+        }
+        if (end - begin >= minSprites_) {
+            float area = 0.0f, weight = 0.0f;
+            glm::vec2 centroid(0.0f);
+            float rgba[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+            std::uint16_t z = 0;
+            for (std::size_t k = begin; k < end; ++k) {
+                const std::size_t i = static_cast<std::size_t>(sorted[k] & kIndexMask);
+                const float a = std::fabs(transforms.scaleX[i] * transforms.scaleY[i]) * 0.25f;
+                const float w = a * channel(colors[i], 3);
+                area += a;
+                weight += w;
+                centroid += a * glm::vec2(transforms.x[i], transforms.y[i]);
+                for (int c = 0; c < 3; ++c) {
+                    rgba[c] += w * channel(colors[i], c);
+                }
+                rgba[3] += w;
+                z = std::max(z, zLayers[i]);
+            }
+            if (area > 0.0f) {
+                const std::size_t first = static_cast<std::size_t>(sorted[begin] & kIndexMask);
+                const float side = 2.0f * std::sqrt(std::min(area, cellArea));  // scale of a 0.5 quad
+                const float rgb = weight > 0.0f ? 1.0f / weight : 0.0f;
+                const float color[4] = {rgba[0] * rgb, rgba[1] * rgb, rgba[2] * rgb, rgba[3] / area};
+                transforms.x[first] = centroid.x / area;
+                transforms.y[first] = centroid.y / area;
+                transforms.rotation[first] = 0.0f;
+                transforms.scaleX[first] = side;
+                transforms.scaleY[first] = side;
+                colors[first] = pack(color);
+                zLayers[first] = z;
+                for (std::size_t k = begin + 1; k < end; ++k) {
+                    removed_[sorted[k] & kIndexMask] = 1;
+                }
+                removedCount += end - begin - 1;
+                ++stats_.clusters;
+                stats_.clustered += end - begin;
+            }
+        }
+        begin = end;
+    }
+    if (removedCount == 0) {
+        return n;
+    }
+
+    // Stable compaction: the order the paths draw in stays the cull's.
+    std::size_t w = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (removed_[i]) {
+            continue;
+        }
+        if (w != i) {
+            transforms.x[w] = transforms.x[i];
+            transforms.y[w] = transforms.y[i];
+            transforms.rotation[w] = transforms.rotation[i];
+            transforms.scaleX[w] = transforms.scaleX[i];
+            transforms.scaleY[w] = transforms.scaleY[i];
+            colors[w] = colors[i];
+            sprites[w] = sprites[i];
+            zLayers[w] = zLayers[i];
+            if (animations != nullptr) {
+                (*animations)[w] = (*animations)[i];
+            }
+        }
+        ++w;
+    }
+    transforms.resize(w);
+    colors.resize(w);
+    sprites.resize(w);
+    zLayers.resize(w);
+    if (animations != nullptr) {
+        animations->resize(w);
+    }
+    return w;
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "core/batch_transform.h"
+
+class JobSystem;
+
+// SpriteLod
+// ---------
+// Level of detail for the visible sprites, on their size on screen: zoomed out, most of
+// them cover a few pixels, where sampling a texture (and, in a crowd, drawing each one)
+// buys nothing the eye can tell apart.
+//
+// | On screen                          | Becomes                                         |
+// | ---------------------------------- | ----------------------------------------------- |
+// | >= its type's flat size            | itself                                          |
+// | < flat size                        | the flat sprite (a solid square) tinted by the  |
+// |                                    | image's average colour, shrunk to the image's   |
+// |                                    | coverage: same colour, same area, no texture    |
+// | flat, and >= clusterMin flat ones  | ONE impostor quad for the cell: their summed    |
+// | in one clusterPx² screen cell      | area (up to the cell's) at their centroid,      |
+// |                                    | their area-weighted colour, topmost z-layer     |
+//
+// A flat quad keeps its sprite's alpha, so opaque sprites stay on the opaque (depth-
+// tested, unsorted) path of the layered renderer. Impostors are built every frame from
+// whatever is in the cell, so moving crowds need no invalidation.
+//
+// The flat size is per sprite type (setFlatPx; 0 never flattens: the player's square).
+// describe() measures an image once: coverage (mean alpha) and the colour its covered
+// texels average to. An animated sprite (render/sprite_animation.h) is described by its
+// clip's first frame (setClip).
+//
+// | Pass                                  | Work                                        |
+// | ------------------------------------- | ------------------------------------------- |
+// | classify + flatten                    | one parallel pass over the visible sprites  |
+// | cluster (only with enough candidates) | radix sort of (cell, index) of the flat     |
+// |                                       | ones, one scan of the runs                  |
+// | compact (only if a cluster formed)    | one serial pass; each impostor takes its    |
+// |                                       | cell's first sprite's place                 |
+class SpriteLod {
+public:
+    static constexpr std::size_t kRange = 4096;    // sprites per parallel classify job
+
+    struct Stats {
+        std::uint64_t frames = 0;
+        std::uint64_t flattened = 0;               // sprites drawn as flat quads
+        std::uint64_t clusters = 0;                // impostors drawn
+        std::uint64_t clustered = 0;               // ... and the flat quads they replaced
+    };
+
+    // The solid image flat quads and impostors are drawn with.
+    explicit SpriteLod(std::uint32_t flatSprite = 0) : flatSprite_(flatSprite) {}
+
+    // Image `sprite`: width x height RGBA8 texels (0xAABBGGRR).
+    void describe(std::uint32_t sprite, const std::uint32_t* pixels, int width, int height);
+    // Sprites of `sprite` smaller than `pixels` on screen are flattened (0: never).
+    void setFlatPx(std::uint32_t sprite, float pixels);
+    // animatedSprite(clip) as its first frame `firstLayer` (already described).
+    void setClip(std::uint32_t clip, std::uint32_t firstLayer);
+    // Screen cells of cellPx² pixels; minSprites or more flat quads in one become an
+    // impostor. cellPx 0: no clustering.
+    void setClustering(float cellPx, int minSprites);
+
+    // The visible sprites in place; returns how many there are now. `pixelsPerUnit`
+    // is the main view's scale; the quads are the [-0.25, 0.25] of every path.
+    // `animations` may be null (no clips).
+    std::size_t apply(JobSystem& jobs, float pixelsPerUnit, Transforms2D& transforms,
+                      std::vector<std::uint32_t>& colors, std::vector<std::uint32_t>& sprites,
+                      std::vector<std::uint16_t>& zLayers, std::vector<glm::vec2>* animations);
+
+    const Stats& stats() const { return stats_; }
+    void resetStats() { stats_ = Stats{}; }
+
+private:
+    struct Type {
+        float flatPx = 0.0f;
+        float side = 1.0f;                         // sqrt(coverage): the flat quad's scale
+        std::uint32_t tint = 0xffffffffu;          // the covered texels' average, alpha 255
+    };
+
+    const Type& type(std::uint32_t sprite) const;
+    Type& typeFor(std::uint32_t sprite);
+
+    std::uint32_t flatSprite_;
+    std::vector<Type> types_;                      // by sprite id
+    std::vector<Type> clipTypes_;                  // by clip
+    Type unknown_;
+    float cellPx_ = 0.0f;
+    std::size_t minSprites_ = 0;
+
+    // Scratch.
+    std::vector<std::uint64_t> cells_;             // per sprite: (cell << 24 | index), or kNoCell
+    std::vector<std::size_t> rangeFlat_;           // per range: flattened
+    std::vector<std::size_t> rangeCandidates_;     // [r + 1]: flat ones in a cell up to range r
+    std::vector<std::uint64_t> keys_;
+    std::vector<std::uint64_t> sortScratch_;
+    std::vector<std::uint8_t> removed_;
+
+    Stats stats_;
+};
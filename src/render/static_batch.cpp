@@ -0,0 +1,169 @@
+#include "render/static_batch.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "core/level_file.h"
+#include "render/gl_buffer.h"
+#include "render/gl_state.h"
+#include "render/gpu_memory.h"
+#include "render/texture_atlas.h"
+#include "render/vertex_layout.h"
+
+namespace {
+
+static_assert(StaticBatch::kMaxQuads * 4 <= 65536, "a draw's vertices must fit GL_UNSIGNED_SHORT indices");
+
+// SpriteBatch's layout (render/sprite_batch.cpp): the same program reads both.
+namespace input = shaderlayout::sprite_vertex;
+
+const VertexLayout kVertexLayout(sizeof(SpriteVertex), {
+    shaderInput(input::aPos, 2, GL_FLOAT, VertexAttribute::Kind::Float, offsetof(SpriteVertex, pos)),
+    shaderInput(input::aUV, 2, GL_UNSIGNED_SHORT, VertexAttribute::Kind::Normalized, offsetof(SpriteVertex, uv)),
+    shaderInput(input::aColor, 4, GL_UNSIGNED_BYTE, VertexAttribute::Kind::Normalized, offsetof(SpriteVertex, color)),
+});
+
+} // namespace
+
+bool StaticBatch::init(std::size_t chunks, VertexArrayCache& vaos) {
+    const gpumemory::Owner owner("static batch");
+    shutdown();
+    if (chunks == 0) {
+        return false;
+    }
+    vaos_ = &vaos;
+    chunks_.resize(chunks);
+
+    // Quad k is vertices 4k .. 4k + 3: every run (or piece of one) starts at index 0.
+    std::vector<std::uint16_t> indices(kMaxQuads * 6);
+    for (std::size_t q = 0; q < kMaxQuads; ++q) {
+        const std::uint16_t v = static_cast<std::uint16_t>(q * 4);
+        const std::uint16_t quad[6] = {v, static_cast<std::uint16_t>(v + 1), static_cast<std::uint16_t>(v + 2),
+                                       static_cast<std::uint16_t>(v + 2), static_cast<std::uint16_t>(v + 3), v};
+        std::copy(quad, quad + 6, indices.begin() + static_cast<std::ptrdiff_t>(q * 6));
+    }
+    indices_ = GlBuffer::create();
+    glbuffer::data(GL_ELEMENT_ARRAY_BUFFER, indices_.get(),
+                   static_cast<GLsizeiptr>(indices.size() * sizeof(std::uint16_t)), indices.data(), GL_STATIC_DRAW);
+    return true;
+}
+
+void StaticBatch::shutdown() {
+    for (std::size_t c = 0; c < chunks_.size(); ++c) {
+        release(c);
+    }
+    if (vaos_ != nullptr) {
+        vaos_->forget(indices_.get());
+    }
+    vaos_ = nullptr;
+    chunks_.clear();
+    indices_.reset();                  // handles queue their names (render/gl_resource.h)
+    stats_ = Stats{};
+}
+
+void StaticBatch::bake(std::size_t chunk, const LevelEntities& props, const std::vector<std::uint32_t>& sprites,
+                       const TextureAtlas& atlas) {
+    if (chunk >= chunks_.size() || atlas.pageCount() == 0) {
+        return;
+    }
+    const gpumemory::Owner owner("static batch");
+    release(chunk);
+    Chunk& c = chunks_[chunk];
+    scratch_.clear();
+    scratch_.reserve(props.count * 4);
+    glm::vec2 lo(INFINITY), hi(-INFINITY);
+    for (std::size_t i = 0; i < props.count; ++i) {
+        const std::uint32_t sprite = props.asset[i] < sprites.size() ? sprites[props.asset[i]] : 0u;
+        const AtlasRegion& region = atlas.region(sprite);
+        const GLuint texture = atlas.pageTexture(region.page);
+        if (c.runs.empty() || c.runs.back().texture != texture) {
+            c.runs.push_back(Run{texture, static_cast<GLint>(scratch_.size()), 0});
+        }
+        ++c.runs.back().quads;
+
+        // A unit-scale entity's quad is [-0.25, 0.25] (SpriteBatch::submit(Sprite)'s math).
+        const glm::vec2 position(props.x[i], props.y[i]);
+        const glm::vec2 half = glm::vec2(props.scaleX[i], props.scaleY[i]) * 0.25f;
+        const float cs = std::cos(props.rotation[i]);
+        const float sn = std::sin(props.rotation[i]);
+        const glm::vec2 axisX(cs * half.x, sn * half.x);
+        const glm::vec2 axisY(-sn * half.y, cs * half.y);
+        const glm::vec2 corners[4] = {
+            position - axisX - axisY,
+            position + axisX - axisY,
+            position + axisX + axisY,
+            position - axisX + axisY,
+        };
+        const glm::uvec4 uv(glm::clamp(region.uvRect, 0.0f, 1.0f) * 65535.0f + 0.5f);
+        const std::uint32_t color = props.color[i];
+        scratch_.push_back({corners[0], uv.x | (uv.y << 16), color});
+        scratch_.push_back({corners[1], uv.z | (uv.y << 16), color});
+        scratch_.push_back({corners[2], uv.z | (uv.w << 16), color});
+        scratch_.push_back({corners[3], uv.x | (uv.w << 16), color});
+        for (const glm::vec2& corner : corners) {
+            lo = glm::min(lo, corner);
+            hi = glm::max(hi, corner);
+        }
+    }
+    if (scratch_.empty()) {
+        c.runs.clear();
+        return;
+    }
+    const std::size_t bytes = scratch_.size() * sizeof(SpriteVertex);
+    c.vertices = GlBuffer::create();
+    glbuffer::data(GL_ARRAY_BUFFER, c.vertices.get(), static_cast<GLsizeiptr>(bytes), scratch_.data(),
+                   GL_STATIC_DRAW);
+    c.vao = vaos_->get({{&kVertexLayout, c.vertices.get()}}, indices_.get());
+    c.bounds = Aabb{lo, hi};
+    c.quads = props.count;
+    ++stats_.chunks;
+    stats_.quads += c.quads;
+    stats_.vertexBytes += bytes;
+    ++stats_.bakes;
+}
+
+void StaticBatch::release(std::size_t chunk) {
+    if (chunk >= chunks_.size()) {
+        return;
+    }
+    Chunk& c = chunks_[chunk];
+    if (c.vertices) {
+        vaos_->forget(c.vertices.get());
+        c.vertices.reset();
+        --stats_.chunks;
+        stats_.quads -= c.quads;
+        stats_.vertexBytes -= c.quads * 4 * sizeof(SpriteVertex);
+    }
+    c.vao = 0;
+    c.runs.clear();
+    c.quads = 0;
+}
+
+void StaticBatch::draw(const CullRect& view, MultiDraw& draws) {
+    stats_.draws = 0;
+    stats_.drawnQuads = 0;
+    const Aabb rect{view.min, view.max};
+    GLuint bound = 0;
+    for (const Chunk& c : chunks_) {
+        if (c.vao == 0 || !c.bounds.overlaps(rect)) {
+            continue;
+        }
+        for (const Run& run : c.runs) {
+            if (run.texture != bound) {
+                draws.flush();         // the pending runs sample the previous page
+                glstate::bindTexture(GL_TEXTURE_2D, run.texture);
+                bound = run.texture;
+            }
+            for (GLsizei first = 0; first < run.quads; first += static_cast<GLsizei>(kMaxQuads)) {
+                const GLsizei quads = std::min<GLsizei>(run.quads - first, static_cast<GLsizei>(kMaxQuads));
+                Mesh mesh;
+                mesh.baseVertex = run.firstVertex + first * 4;
+                mesh.vertexCount = quads * 4;
+                mesh.indexCount = quads * 6;
+                draws.add(c.vao, mesh);
+                ++stats_.draws;
+                stats_.drawnQuads += static_cast<std::size_t>(quads);
+            }
+        }
+    }
+}
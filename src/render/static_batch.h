@@ -0,0 +1,107 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "core/spatial_index.h"
+#include "render/culling.h"
+#include "render/gl_resource.h"
+#include "render/multi_draw.h"
+#include "render/sprite_batch.h"
+#include "render/vertex_array_cache.h"
+
+class TextureAtlas;
+struct LevelEntities;
+
+// One chunk coming or going. The simulation side makes them as level regions stream in
+// and out and sends them to the render thread in the FramePacket (render/frame_packet.h);
+// StaticBatch::bake() / release() act on them.
+struct StaticBatchEdit {
+    std::int32_t chunk = 0;            // the level region
+    bool bake = false;                 // false: release
+};
+
+// StaticBatch
+// -----------
+// Scenery that never moves, pre-transformed into SpriteVertex quads (world-space corners,
+// atlas UVs, colour: what SpriteBatch would stream for it every frame) once, when its
+// chunk arrives, and drawn from a static VBO until the chunk goes:
+//
+//     chunk (a level region):  VBO  | page 0 quads | page 1 quads | ...   baked once
+//                              runs   texture, first vertex, quads        one draw each
+//     indices:                 0 1 2  2 3 0  4 5 6  6 7 4 ...             one EBO, all chunks
+//
+// A run is a stretch of quads on one atlas page, in the order given: a level's props are
+// sorted by (zLayer, asset), so a region is a few runs and z-layers stay in order within
+// it. Runs past kMaxQuads are drawn in pieces (16-bit indices, base vertex per piece).
+//
+// | Props as entities                        | Baked chunks                              |
+// | ---------------------------------------- | ----------------------------------------- |
+// | extracted, culled, composed and streamed | nothing per prop per frame: the vertices  |
+// | every frame                              | stay on the GPU                           |
+// | batched by texture each frame            | one draw per run of a visible chunk       |
+// | culled per prop                          | culled per chunk, by its baked bounds     |
+// | pickable, collidable, depth-sorted with  | drawn first in the world layer: under the |
+// | everything else                          | dynamic sprites whatever their z-layers   |
+//
+// Drawn with the SpriteBatch program (sprite_vertex.glsl + fragment.glsl): same vertex
+// layout, same atlas pages. Like the other GL objects in main, a StaticBatch belongs to
+// the render side once the render thread runs.
+class StaticBatch {
+public:
+    static constexpr std::size_t kMaxQuads = 16384;   // per draw: 65536 vertices, 16-bit indices
+
+    struct Stats {
+        std::size_t chunks = 0;        // baked
+        std::size_t quads = 0;         // ... and the quads in them
+        std::size_t vertexBytes = 0;
+        std::size_t draws = 0;         // by the last draw()
+        std::size_t drawnQuads = 0;
+        std::uint64_t bakes = 0;       // chunks baked so far
+    };
+
+    StaticBatch() = default;
+    StaticBatch(const StaticBatch&) = delete;
+    StaticBatch& operator=(const StaticBatch&) = delete;
+
+    // GL thread: room for `chunks` chunks (none baked) and the shared index buffer. The
+    // VAOs come from `vaos`, which must outlive the batch.
+    bool init(std::size_t chunks, VertexArrayCache& vaos);
+    void shutdown();
+    bool initialized() const { return !chunks_.empty(); }
+
+    // GL thread: replaces `chunk` with `props`, each drawn as sprite sprites[asset] of
+    // `atlas` (0 for an unknown asset), the quad SpriteBatch gives a unit-scale entity.
+    void bake(std::size_t chunk, const LevelEntities& props, const std::vector<std::uint32_t>& sprites,
+              const TextureAtlas& atlas);
+    void release(std::size_t chunk);
+
+    // GL thread: every run of every baked chunk overlapping `view`, through `draws`. The
+    // caller binds the program and blending; draw() binds the pages (DrawStaticBatchCommand
+    // in main) and leaves the last one bound.
+    void draw(const CullRect& view, MultiDraw& draws);
+
+    const Stats& stats() const { return stats_; }
+
+private:
+    struct Run {
+        GLuint texture = 0;
+        GLint firstVertex = 0;
+        GLsizei quads = 0;
+    };
+    struct Chunk {
+        GlBuffer vertices;
+        GLuint vao = 0;
+        Aabb bounds{};
+        std::vector<Run> runs;
+        std::size_t quads = 0;
+    };
+
+    std::vector<Chunk> chunks_;
+    std::vector<SpriteVertex> scratch_;    // one chunk's vertices while baking
+    GlBuffer indices_;
+    VertexArrayCache* vaos_ = nullptr;
+    Stats stats_;
+};
@@ -0,0 +1,140 @@
+#include "render/stream_buffer.h"
+#include "render/gl_buffer.h"
+#include "render/gl_ext.h"
+#include "render/gl_state.h"
+#include "render/gl_stall.h"
+
+#include <iostream>
+
+namespace {
+
+thread_local std::uint64_t gBytesStreamed = 0;  // per GL thread (render/context_pool.h)
+
+} // namespace
+
+bool StreamBuffer::init(GLenum target, GLsizeiptr bytesPerFrame, bool allowPersistent) {
+    target_ = target;
+    segmentSize_ = bytesPerFrame;
+    head_ = 0;
+    segment_ = 0;
+
+    const GLsizeiptr totalSize = segmentSize_ * kFrames;
+
+    // With DSA (render/gl_buffer.h) nothing below binds anything.
+    buffer_ = GlBuffer::create();
+
+    if (allowPersistent && glext::caps().bufferStorage) {
+        // Immutable storage that stays mapped for the buffer's whole lifetime.
+        // COHERENT: writes become visible to the GPU without explicit flushes.
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glbuffer::storage(target_, buffer_.get(), totalSize, nullptr, flags);
+        persistentPtr_ = glbuffer::mapRange(target_, buffer_.get(), 0, totalSize, flags);
+        if (!persistentPtr_) {
+            std::cerr << "Persistent map failed, falling back to unsynchronized mapping\n";
+            buffer_ = GlBuffer::create(); // the failed one is queued for deletion
+        }
+    }
+
+    if (!persistentPtr_) {
+        glbuffer::data(target_, buffer_.get(), totalSize, nullptr, GL_STREAM_DRAW);
+    }
+
+    if (!glbuffer::direct()) {
+        glstate::bindBuffer(target_, 0);
+    }
+    return static_cast<bool>(buffer_);
+}
+
+void StreamBuffer::shutdown() {
+    for (GLsync& fence : fences_) {
+        if (fence) {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+    if (buffer_) {
+        if (persistentPtr_) {
+            glbuffer::unmap(target_, buffer_.get());
+            if (!glbuffer::direct()) {
+                glstate::bindBuffer(target_, 0);
+            }
+            persistentPtr_ = nullptr;
+        }
+        buffer_.reset();            // deleted after the GPU's last read of it
+    }
+}
+
+StreamAllocation StreamBuffer::allocate(GLsizeiptr bytes, GLsizeiptr alignment) {
+    GLsizeiptr start = (head_ + alignment - 1) / alignment * alignment;
+    if (bytes <= 0 || start + bytes > segmentSize_) {
+        return StreamAllocation{};
+    }
+    head_ = start + bytes;
+    gBytesStreamed += static_cast<std::uint64_t>(bytes);
+
+    StreamAllocation allocation;
+    allocation.offset = segment_ * segmentSize_ + start;
+    allocation.size = bytes;
+
+    if (persistentPtr_) {
+        allocation.ptr = static_cast<char*>(persistentPtr_) + allocation.offset;
+    } else {
+        // UNSYNCHRONIZED: don't wait for the GPU (the fences already guarantee it's done
+        // with this segment). INVALIDATE_RANGE: old contents needn't be preserved.
+        const glstall::Wait wait("stream buffer map");
+        allocation.ptr = glbuffer::mapRange(target_, buffer_.get(), allocation.offset, bytes,
+                                            GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT |
+                                                GL_MAP_INVALIDATE_RANGE_BIT);
+        if (!allocation.ptr) {
+            std::cerr << "StreamBuffer: glMapBufferRange failed\n";
+            if (!glbuffer::direct()) {
+                glstate::bindBuffer(target_, 0);
+            }
+            return StreamAllocation{};
+        }
+    }
+    return allocation;
+}
+
+void StreamBuffer::commit(const StreamAllocation& allocation) {
+    if (!allocation.valid() || persistentPtr_) {
+        return;
+    }
+    glbuffer::unmap(target_, buffer_.get());
+    if (!glbuffer::direct()) {
+        glstate::bindBuffer(target_, 0);
+    }
+}
+
+void StreamBuffer::endFrame() {
+    // Everything the GPU will read from this segment has been submitted by now.
+    if (fences_[segment_]) {
+        glDeleteSync(fences_[segment_]);
+    }
+    fences_[segment_] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    segment_ = (segment_ + 1) % kFrames;
+    head_ = 0;
+    waitForSegment(segment_);
+}
+
+void StreamBuffer::waitForSegment(int segment) {
+    GLsync fence = fences_[segment];
+    if (!fence) {
+        return;
+    }
+    const glstall::Wait wait("stream buffer fence");
+    // First try without blocking; the fence normally signalled frames ago.
+    GLenum result = glClientWaitSync(fence, 0, 0);
+    while (result == GL_TIMEOUT_EXPIRED) {
+        // FLUSH_COMMANDS makes sure the fence actually reaches the GPU so we can't
+        // deadlock waiting on a command that is still sitting in the driver's queue.
+        result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000); // 1 ms
+    }
+    glDeleteSync(fence);
+    fences_[segment] = nullptr;
+}
+
+std::uint64_t StreamBuffer::bytesStreamed() {
+    return gBytesStreamed;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+
+#include "render/gl_resource.h"
+
+// StreamAllocation
+// ----------------
+// A region of the stream buffer handed out for this frame. Write through ptr, then
+// point vertex attributes / draws at `offset` inside StreamBuffer::buffer().
+struct StreamAllocation {
+    void* ptr = nullptr;
+    GLintptr offset = 0;
+    GLsizeiptr size = 0;
+    bool valid() const { return ptr != nullptr; }
+};
+
+// StreamBuffer
+// ------------
+// Ring buffer for geometry that changes every frame (instances, sprites, particles).
+//
+// The buffer is split into kFrames equal segments. Frame N writes into segment N % kFrames
+// while the GPU is still reading segments N-1 and N-2. Before a segment is reused we wait
+// on the fence (glFenceSync) that was placed after the last draw that read it, so the CPU
+// never overwrites data the GPU hasn't consumed—and in practice never waits at all,
+// because that fence signalled two frames ago.
+//
+// | Mode        | Requirement            | How writes reach the GPU                          |
+// | ----------- | ---------------------- | ------------------------------------------------- |
+// | Persistent  | ARB_buffer_storage/4.4 | Mapped ONCE with PERSISTENT|COHERENT; plain memcpy |
+// | Unsynced    | GL 3.3 core            | glMapBufferRange(UNSYNCHRONIZED|INVALIDATE_RANGE)  |
+//
+// Both modes skip the driver's implicit synchronization (that's what the fences are for)
+// and avoid the extra copy glBufferSubData makes.
+// With direct state access the Unsynced maps and unmaps go by name (render/gl_buffer.h):
+// no bind before each one and no unbind after.
+//
+// Usage per frame:
+//     StreamAllocation a = stream.allocate(bytes);
+//     memcpy(a.ptr, data, bytes);
+//     stream.commit(a);          // unmaps in Unsynced mode, no-op when persistent
+//     ... draw using a.offset ...
+//     stream.endFrame();         // after the frame's last draw from this buffer
+class StreamBuffer {
+public:
+    static constexpr int kFrames = 3; // triple buffering
+
+    // target:       GL_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER, GL_UNIFORM_BUFFER, ...
+    // bytesPerFrame: capacity of ONE segment; allocate() fails beyond it.
+    bool init(GLenum target, GLsizeiptr bytesPerFrame, bool allowPersistent = true);
+    void shutdown();
+
+    // Returns a writable region in the current frame's segment, or an invalid
+    // allocation if the segment is full.
+    StreamAllocation allocate(GLsizeiptr bytes, GLsizeiptr alignment = 16);
+    void commit(const StreamAllocation& allocation);
+
+    // Fences the current segment and moves on to the next one, waiting (rarely) for
+    // the GPU to release it.
+    void endFrame();
+
+    GLuint buffer() const { return buffer_.get(); }
+    GLenum target() const { return target_; }
+    GLsizeiptr bytesPerFrame() const { return segmentSize_; }
+    bool persistent() const { return persistentPtr_ != nullptr; }
+
+    // Bytes every StreamBuffer has handed out so far on this thread (allocate()): take the
+    // difference over a frame for what it uploaded (render/render_stats.h).
+    static std::uint64_t bytesStreamed();
+
+private:
+    void waitForSegment(int segment);
+
+    GlBuffer buffer_;
+    GLenum target_ = GL_ARRAY_BUFFER;
+    GLsizeiptr segmentSize_ = 0;
+    GLsizeiptr head_ = 0;         // bytes used in the current segment
+    int segment_ = 0;             // current segment index
+    void* persistentPtr_ = nullptr;
+    GLsync fences_[kFrames] = {};
+};
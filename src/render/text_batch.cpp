@@ -0,0 +1,142 @@
+#include "render/text_batch.h"
+
+#include <cstring>
+
+namespace {
+
+// The code point starting at text[i], i moved past it. Malformed bytes are U+FFFD, one
+// byte each.
+std::uint32_t decodeUtf8(const char* text, std::size_t length, std::size_t& i) {
+    const auto byte = [&](std::size_t k) { return static_cast<std::uint32_t>(static_cast<unsigned char>(text[k])); };
+    const std::uint32_t lead = byte(i++);
+    if (lead < 0x80) {
+        return lead;
+    }
+    const int extra = lead >= 0xF0 && lead < 0xF8 ? 3 : lead >= 0xE0 ? 2 : lead >= 0xC0 ? 1 : -1;
+    if (extra < 0 || i + extra > length) {
+        return 0xFFFD;
+    }
+    std::uint32_t codepoint = lead & (0x3Fu >> extra);
+    for (int k = 0; k < extra; ++k) {
+        if ((byte(i + k) & 0xC0) != 0x80) {
+            return 0xFFFD;
+        }
+        codepoint = codepoint << 6 | (byte(i + k) & 0x3F);
+    }
+    i += extra;
+    return codepoint;
+}
+
+} // namespace
+
+void TextBatch::begin(SpriteBatch& batch, const SdfFont& font, int viewportWidth, int viewportHeight) {
+    batch_ = &batch;
+    font_ = &font;
+    cache_ = nullptr;
+    toClip_ = glm::vec2(2.0f / static_cast<float>(viewportWidth > 0 ? viewportWidth : 1),
+                        -2.0f / static_cast<float>(viewportHeight > 0 ? viewportHeight : 1));
+    glyphs_ = 0;
+}
+
+void TextBatch::begin(SpriteBatch& batch, GlyphCache& glyphs, int viewportWidth, int viewportHeight) {
+    batch_ = &batch;
+    font_ = nullptr;
+    cache_ = &glyphs;
+    toClip_ = glm::vec2(2.0f / static_cast<float>(viewportWidth > 0 ? viewportWidth : 1),
+                        -2.0f / static_cast<float>(viewportHeight > 0 ? viewportHeight : 1));
+    glyphs_ = 0;
+}
+
+void TextBatch::submit(const glm::vec2& center, const glm::vec2& size, const glm::vec4& uvRect, GLuint texture,
+                       std::uint32_t color) {
+    Sprite sprite;
+    sprite.position = glm::vec2(center.x * toClip_.x - 1.0f, center.y * toClip_.y + 1.0f);
+    sprite.size = size * glm::abs(toClip_);
+    sprite.uvRect = uvRect;
+    sprite.color = color;
+    sprite.texture = texture;
+    batch_->submit(sprite);
+    ++glyphs_;
+}
+
+glm::vec2 TextBatch::print(const glm::vec2& pixel, float height, const char* text, std::size_t length,
+                           std::uint32_t color) {
+    if (cache_) {
+        return printCached(pixel, height, text, length, color);
+    }
+    if (!batch_ || !font_ || font_->texture() == 0) {
+        return pixel;
+    }
+    const float unit = height / static_cast<float>(SdfFont::kGlyphRows); // pixels per font pixel
+    const glm::vec2 cell = font_->cellSize() * unit;
+    const glm::vec2 offset = font_->cellOffset() * unit;
+    glm::vec2 pen = pixel;
+    for (std::size_t i = 0; i < length; ++i) {
+        const char c = text[i];
+        if (c == '\n') {
+            pen = glm::vec2(pixel.x, pen.y + SdfFont::kLineHeight * unit);
+            continue;
+        }
+        if (c != ' ') {
+            // The cell's centre: the glyph box starts at the pen, the border around it.
+            submit(pen + offset + 0.5f * cell, cell, font_->uvRect(c), font_->texture(), color);
+        }
+        pen.x += SdfFont::kAdvance * unit;
+    }
+    return pen;
+}
+
+// The pen is at the top of the capitals, as above: the glyph box starts kCapTop rows
+// higher, its border around it.
+glm::vec2 TextBatch::printCached(const glm::vec2& pixel, float height, const char* text, std::size_t length,
+                                 std::uint32_t color) {
+    if (!batch_ || !cache_->initialized()) {
+        return pixel;
+    }
+    const float unit = height / static_cast<float>(BitmapFont::kCapRows);
+    const float border = cache_->border();
+    const glm::vec2 offset = glm::vec2(-border, -border - BitmapFont::kCapTop) * unit;
+    glm::vec2 pen = pixel;
+    for (std::size_t i = 0; i < length;) {
+        const std::uint32_t c = decodeUtf8(text, length, i);
+        if (c == '\n') {
+            pen = glm::vec2(pixel.x, pen.y + lineHeight(height));
+            continue;
+        }
+        glm::vec4 uvRect;
+        int advance = 0;
+        if (c != ' ' && cache_->lookup(c, uvRect, advance)) {
+            const glm::vec2 cell = glm::vec2(advance + 2.0f * border, BitmapFont::kRows + 2.0f * border) * unit;
+            submit(pen + offset + 0.5f * cell, cell, uvRect, cache_->texture(), color);
+        }
+        pen.x += (c == ' ' ? 8 : advance) * unit;
+    }
+    return pen;
+}
+
+glm::vec2 TextBatch::print(const glm::vec2& pixel, float height, const char* text, std::uint32_t color) {
+    return print(pixel, height, text, std::strlen(text), color);
+}
+
+void TextBatch::rect(const glm::vec2& pixel, const glm::vec2& size, std::uint32_t color) {
+    if (!batch_) {
+        return;
+    }
+    if (cache_) {
+        if (cache_->initialized()) {
+            submit(pixel + 0.5f * size, size, cache_->solidUv(), cache_->texture(), color);
+        }
+        return;
+    }
+    if (!font_ || font_->texture() == 0) {
+        return;
+    }
+    submit(pixel + 0.5f * size, size, font_->solidUv(), font_->texture(), color);
+}
+
+float TextBatch::lineHeight(float height) const {
+    if (cache_) {
+        return height * BitmapFont::kRows / BitmapFont::kCapRows;
+    }
+    return height * SdfFont::kLineHeight / SdfFont::kGlyphRows;
+}
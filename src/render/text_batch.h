@@ -0,0 +1,65 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+
+#include "render/glyph_cache.h"
+#include "render/sdf_font.h"
+#include "render/sprite_batch.h"
+
+// TextBatch
+// ---------
+// Lays strings out as glyph quads and submits them to a SpriteBatch. Every glyph samples
+// the same SdfFont atlas, so the batch never breaks on a texture change: a whole screen
+// of text is one glDrawElements (up to SpriteBatch::kMaxSprites glyphs).
+//
+// Positions are in window pixels, (0, 0) at the top-left like the cursor, and converted
+// to clip space here: the program is sprite_vertex.glsl built with SCREEN_SPACE (no
+// camera) and fragment.glsl with TEXTURED + SDF.
+//
+// Usage (GL thread):
+//     batch.begin();
+//     batch.setProgram(textProgram);
+//     text.begin(batch, font, viewportWidth, viewportHeight);
+//     text.print({8, 8}, 14.0f, "frame 16.6 ms", color);   // as many as needed
+//     batch.end();
+//
+// '\n' starts a new line under the first; characters the font lacks print as '?'.
+// rect() fills boxes from the same atlas, so a HUD's graphs don't cost a draw either.
+//
+// Begun with a GlyphCache instead (--font), text is UTF-8 and any character of its
+// BitmapFont prints, still from one texture: the cache's. A character on its way there
+// takes its place but draws nothing until a later frame.
+class TextBatch {
+public:
+    void begin(SpriteBatch& batch, const SdfFont& font, int viewportWidth, int viewportHeight);
+    void begin(SpriteBatch& batch, GlyphCache& glyphs, int viewportWidth, int viewportHeight);
+
+    // `height`: pixels from the top of a capital to the baseline (the font's 7 rows, or
+    // a BitmapFont's kCapRows).
+    // Returns the pen position after the last character.
+    glm::vec2 print(const glm::vec2& pixel, float height, const char* text, std::size_t length,
+                    std::uint32_t color);
+    glm::vec2 print(const glm::vec2& pixel, float height, const char* text, std::uint32_t color);
+
+    // A filled box, `pixel` its top-left corner, from the font's solidUv(): it stays in
+    // the same batch as the text around it (graphs, backgrounds).
+    void rect(const glm::vec2& pixel, const glm::vec2& size, std::uint32_t color);
+
+    // Pixels from one line's top to the next's, for text `height` high.
+    float lineHeight(float height) const;
+    std::size_t glyphs() const { return glyphs_; }   // submitted since begin(), boxes included
+
+private:
+    glm::vec2 printCached(const glm::vec2& pixel, float height, const char* text, std::size_t length,
+                          std::uint32_t color);
+    void submit(const glm::vec2& center, const glm::vec2& size, const glm::vec4& uvRect, GLuint texture,
+                std::uint32_t color);
+
+    SpriteBatch* batch_ = nullptr;
+    const SdfFont* font_ = nullptr;
+    GlyphCache* cache_ = nullptr;
+    glm::vec2 toClip_{0.0f};           // pixels → clip space scale (y flipped)
+    std::size_t glyphs_ = 0;
+};
@@ -0,0 +1,67 @@
+#include "render/texture_array.h"
+
+#include <iostream>
+
+#include "render/gl_state.h"
+#include "render/gpu_memory.h"
+
+bool TextureArray::init(int width, int height, int layers, bool mipmaps) {
+    const gpumemory::Owner owner("texture array");
+    GLint maxLayers = 0;
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+    if (width <= 0 || height <= 0 || layers <= 0 || layers > maxLayers) {
+        std::cerr << "TextureArray: " << width << "x" << height << " x " << layers
+                  << " layers not supported (max " << maxLayers << " layers)\n";
+        return false;
+    }
+    width_ = width;
+    height_ = height;
+    layers_ = layers;
+    mipmaps_ = mipmaps;
+
+    texture_ = GlTexture::create();
+    glstate::activeTexture(GL_TEXTURE0);
+    glstate::bindTexture(GL_TEXTURE_2D_ARRAY, texture_.get());
+    // Storage for all layers at once (GL 3.3 has no glTexStorage3D); the mip levels are
+    // allocated by glGenerateMipmap in finish().
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, width, height, layers, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+                 nullptr);
+    // With the levels finish() will generate: a full chain.
+    int levels = 1;
+    for (int size = width > height ? width : height; mipmaps && size > 1; size >>= 1) {
+        ++levels;
+    }
+    gpumemory::track(GlObject::Texture, texture_.get(), gpumemory::textureBytes(GL_RGBA8, width, height, layers, levels),
+                     gpumemory::Category::Texture);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, mipmaps ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glstate::bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    return true;
+}
+
+void TextureArray::setLayer(int layer, const std::uint32_t* rgba) {
+    if (!texture_ || layer < 0 || layer >= layers_) {
+        return;
+    }
+    glstate::activeTexture(GL_TEXTURE0);
+    glstate::bindTexture(GL_TEXTURE_2D_ARRAY, texture_.get());
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, width_, height_, 1, GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+    glstate::bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+void TextureArray::finish() {
+    if (!texture_ || !mipmaps_) {
+        return;
+    }
+    glstate::activeTexture(GL_TEXTURE0);
+    glstate::bindTexture(GL_TEXTURE_2D_ARRAY, texture_.get());
+    glGenerateMipmap(GL_TEXTURE_2D_ARRAY); // per layer: levels never mix two layers
+    glstate::bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+void TextureArray::shutdown() {
+    texture_.reset();
+    width_ = height_ = layers_ = 0;
+}
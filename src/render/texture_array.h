@@ -0,0 +1,49 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstdint>
+
+#include "render/gl_resource.h"
+
+// TextureArray
+// ------------
+// A GL_TEXTURE_2D_ARRAY: `layers` images of the same size in one texture object. A
+// shader picks the image with the third texture coordinate (sampler2DArray), so draws
+// that use different images still bind ONE texture—the alternative to a TextureAtlas
+// (render/texture_atlas.h) for sprites that all have the same size:
+//
+// |                      | TextureAtlas                  | TextureArray                 |
+// | -------------------- | ----------------------------- | ---------------------------- |
+// | image sizes          | any                           | all the same                 |
+// | selects the image by | UV rect per sprite            | layer index per instance     |
+// | bleeding             | padding / edge extrusion      | none: layers never filter    |
+// |                      |                               | into each other              |
+// | mipmaps              | off (levels mix neighbours)   | on: each layer has its own   |
+// | limit                | page size                     | GL_MAX_ARRAY_TEXTURE_LAYERS  |
+// |                      |                               | (≥ 256 in GL 3.3)            |
+//
+//     TextureArray array;
+//     array.init(64, 64, layerCount);
+//     array.setLayer(i, pixels);   // each layer once
+//     array.finish();              // builds the mipmap chain
+//
+// Pixels are width * height RGBA8 values (packColor), row 0 at t = 0.
+class TextureArray {
+public:
+    bool init(int width, int height, int layers, bool mipmaps = true);
+    void setLayer(int layer, const std::uint32_t* rgba);
+    void finish();
+    void shutdown();
+
+    GLuint texture() const { return texture_.get(); }
+    int width() const { return width_; }
+    int height() const { return height_; }
+    int layers() const { return layers_; }
+
+private:
+    GlTexture texture_;
+    int width_ = 0;
+    int height_ = 0;
+    int layers_ = 0;
+    bool mipmaps_ = true;
+};
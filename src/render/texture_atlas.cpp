@@ -0,0 +1,218 @@
+#include "render/texture_atlas.h"
+
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+
+#include "render/gl_state.h"
+#include "render/gpu_memory.h"
+
+void SkylinePacker::reset(int width, int height) {
+    width_ = width;
+    height_ = height;
+    usedArea_ = 0;
+    skyline_.clear();
+    skyline_.push_back(Segment{0, 0, width});
+}
+
+int SkylinePacker::fit(std::size_t index, int width, int height) const {
+    const int x = skyline_[index].x;
+    if (x + width > width_) {
+        return -1;
+    }
+    int y = 0;
+    int remaining = width;
+    for (std::size_t i = index; remaining > 0; ++i) {
+        y = std::max(y, skyline_[i].y);
+        if (y + height > height_) {
+            return -1;
+        }
+        remaining -= skyline_[i].width;
+    }
+    return y;
+}
+
+bool SkylinePacker::insert(int width, int height, int& x, int& y) {
+    if (width <= 0 || height <= 0) {
+        return false;
+    }
+
+    std::size_t best = skyline_.size();
+    int bestTop = height_ + 1;
+    int bestWidth = width_ + 1;
+    for (std::size_t i = 0; i < skyline_.size(); ++i) {
+        const int at = fit(i, width, height);
+        if (at < 0) {
+            continue;
+        }
+        const int top = at + height;
+        if (top < bestTop || (top == bestTop && skyline_[i].width < bestWidth)) {
+            best = i;
+            bestTop = top;
+            bestWidth = skyline_[i].width;
+        }
+    }
+    if (best == skyline_.size()) {
+        return false;
+    }
+
+    x = skyline_[best].x;
+    y = bestTop - height;
+
+    // The new segment replaces whatever it covers; a partly covered one is shortened.
+    skyline_.insert(skyline_.begin() + static_cast<std::ptrdiff_t>(best), Segment{x, bestTop, width});
+    const int right = x + width;
+    std::size_t i = best + 1;
+    while (i < skyline_.size() && skyline_[i].x < right) {
+        Segment& s = skyline_[i];
+        const int end = s.x + s.width;
+        if (end <= right) {
+            skyline_.erase(skyline_.begin() + static_cast<std::ptrdiff_t>(i));
+            continue;
+        }
+        s.width = end - right;
+        s.x = right;
+        break;
+    }
+
+    // Neighbours at the same height are one segment: fewer positions to try next time.
+    for (std::size_t k = 0; k + 1 < skyline_.size();) {
+        if (skyline_[k].y == skyline_[k + 1].y) {
+            skyline_[k].width += skyline_[k + 1].width;
+            skyline_.erase(skyline_.begin() + static_cast<std::ptrdiff_t>(k + 1));
+        } else {
+            ++k;
+        }
+    }
+
+    usedArea_ += static_cast<std::size_t>(width) * static_cast<std::size_t>(height);
+    return true;
+}
+
+std::uint32_t TextureAtlas::add(int width, int height, const std::uint32_t* rgba) {
+    Image image{width, height, {}};
+    image.pixels.assign(rgba, rgba + static_cast<std::size_t>(width) * static_cast<std::size_t>(height));
+    images_.push_back(std::move(image));
+    regions_.emplace_back();
+    return static_cast<std::uint32_t>(regions_.size() - 1);
+}
+
+void TextureAtlas::blit(Page& page, const Image& image, int x, int y, int padding) {
+    // Every destination texel of the padded rectangle reads the nearest image texel, so
+    // the border is the image's edge pixels repeated outwards (corners included).
+    const int size = page.packer.width();
+    for (int dy = -padding; dy < image.height + padding; ++dy) {
+        const int sy = std::min(std::max(dy, 0), image.height - 1);
+        std::uint32_t* row = page.pixels.data() + static_cast<std::size_t>(y + dy) * size;
+        const std::uint32_t* src = image.pixels.data() + static_cast<std::size_t>(sy) * image.width;
+        for (int dx = -padding; dx < image.width + padding; ++dx) {
+            const int sx = std::min(std::max(dx, 0), image.width - 1);
+            row[x + dx] = src[sx];
+        }
+    }
+}
+
+bool TextureAtlas::pack(const Options& options) {
+    options_ = options;
+    const int size = options.pageSize;
+    const int border = 2 * options.padding;
+
+    // Tallest first (then widest): keeps the skyline flat.
+    std::vector<std::uint32_t> order(images_.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::sort(order.begin(), order.end(), [this](std::uint32_t a, std::uint32_t b) {
+        const Image& ia = images_[a];
+        const Image& ib = images_[b];
+        return ia.height != ib.height ? ia.height > ib.height : ia.width > ib.width;
+    });
+
+    for (const std::uint32_t id : order) {
+        const Image& image = images_[id];
+        const int w = image.width + border;
+        const int h = image.height + border;
+        if (image.width <= 0 || image.height <= 0 || w > size || h > size) {
+            std::cerr << "TextureAtlas: image " << id << " (" << image.width << "x" << image.height
+                      << ") does not fit a " << size << "x" << size << " page\n";
+            return false;
+        }
+
+        // First open page with room, else a new one.
+        int x = 0, y = 0;
+        std::size_t p = 0;
+        while (p < pages_.size() && !pages_[p].packer.insert(w, h, x, y)) {
+            ++p;
+        }
+        if (p == pages_.size()) {
+            pages_.emplace_back();
+            pages_.back().packer.reset(size, size);
+            pages_.back().pixels.assign(static_cast<std::size_t>(size) * size, 0u);
+            pages_.back().packer.insert(w, h, x, y);
+        }
+
+        Page& page = pages_[p];
+        x += options.padding;
+        y += options.padding;
+        blit(page, image, x, y, options.padding);
+
+        AtlasRegion& region = regions_[id];
+        region.page = static_cast<std::uint32_t>(p);
+        region.x = x;
+        region.y = y;
+        region.width = image.width;
+        region.height = image.height;
+        const float scale = 1.0f / static_cast<float>(size);
+        region.uvRect = glm::vec4(static_cast<float>(x), static_cast<float>(y),
+                                  static_cast<float>(x + image.width), static_cast<float>(y + image.height)) * scale;
+    }
+
+    std::size_t used = 0;
+    for (const Page& page : pages_) {
+        used += page.packer.usedArea();
+    }
+    stats_.images = images_.size();
+    stats_.pages = pages_.size();
+    stats_.occupancy = pages_.empty() ? 0.0f
+        : static_cast<float>(used) / (static_cast<float>(size) * static_cast<float>(size) * pages_.size());
+
+    images_.clear();
+    images_.shrink_to_fit();
+    return true;
+}
+
+bool TextureAtlas::upload() {
+    const gpumemory::Owner owner("texture atlas");
+    GLint maxSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+    if (options_.pageSize > maxSize) {
+        std::cerr << "TextureAtlas: " << options_.pageSize << " px pages exceed GL_MAX_TEXTURE_SIZE ("
+                  << maxSize << ")\n";
+        return false;
+    }
+
+    for (Page& page : pages_) {
+        page.texture = GlTexture::create();
+        glstate::activeTexture(GL_TEXTURE0);
+        glstate::bindTexture(GL_TEXTURE_2D, page.texture.get());
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, options_.pageSize, options_.pageSize, 0, GL_RGBA,
+                     GL_UNSIGNED_BYTE, page.pixels.data());
+        gpumemory::track(GlObject::Texture, page.texture.get(),
+                         gpumemory::textureBytes(GL_RGBA8, options_.pageSize, options_.pageSize), gpumemory::Category::Texture);
+        // No mipmaps: a smaller level would average neighbouring images together, and the
+        // padding only protects the full-resolution level.
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        page.pixels.clear();
+        page.pixels.shrink_to_fit();
+    }
+    glstate::bindTexture(GL_TEXTURE_2D, 0);
+    return true;
+}
+
+void TextureAtlas::shutdown() {
+    pages_.clear();                          // their textures are queued for deletion
+    regions_.clear();
+    images_.clear();
+    stats_ = Stats{};
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "render/gl_resource.h"
+
+// SkylinePacker
+// -------------
+// Places rectangles into one fixed-size page, bottom-left first. The packed area is
+// described by its "skyline": the top edge of everything placed so far, as a list of
+// horizontal segments from left to right.
+//
+//     y ▲
+//       │      ┌──┐
+//       │ ┌────┤  │        skyline = (0, 3, w=5) (5, 4, w=3) (8, 1, w=4)
+//       │ │    │  │  ┌───
+//       └─┴────┴──┴──┴───► x
+//
+// A new rectangle is tried at the left edge of every segment; its y is the highest
+// segment it would cover. The position with the lowest top wins (ties: the narrower
+// segment, which leaves the wider gaps open). Space under the skyline that a placement
+// jumps over is lost, which is why the builder inserts the tallest images first: the
+// skyline then stays flat and the waste is typically a few percent.
+//
+// O(segments) per try, O(segments²) per insert—segments stay in the tens for sprites.
+class SkylinePacker {
+public:
+    void reset(int width, int height);
+
+    // false = doesn't fit anywhere on this page.
+    bool insert(int width, int height, int& x, int& y);
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+    std::size_t usedArea() const { return usedArea_; }
+
+private:
+    struct Segment {
+        int x, y, width;
+    };
+
+    // y the rectangle would sit at if placed at segment `index`'s left edge, or -1.
+    int fit(std::size_t index, int width, int height) const;
+
+    int width_ = 0;
+    int height_ = 0;
+    std::size_t usedArea_ = 0;
+    std::vector<Segment> skyline_;
+};
+
+// Where an image ended up: its page and (u0, v0, u1, v1), the same layout as
+// Sprite::uvRect (render/sprite_batch.h).
+struct AtlasRegion {
+    std::uint32_t page = 0;
+    glm::vec4 uvRect{0.0f, 0.0f, 1.0f, 1.0f};
+    int x = 0, y = 0;           // texels, in the page
+    int width = 0, height = 0;
+};
+
+// TextureAtlas
+// ------------
+// Many small RGBA8 images packed into a few large textures ("pages"), so sprites that use
+// different images still share a texture—and therefore a SpriteBatch draw call:
+//
+//     TextureAtlas atlas;
+//     const std::uint32_t id = atlas.add(w, h, pixels);  // any number, any order
+//     atlas.build();                                     // pack + upload the pages
+//     const AtlasRegion& r = atlas.region(id);
+//     batch.submit(model, atlas.pageTexture(r.page), r.uvRect, color);
+//
+// | Step     | Does                                                                   |
+// | -------- | ---------------------------------------------------------------------- |
+// | add()    | copies the pixels; ids are returned in order (0, 1, 2, ...)            |
+// | pack()   | CPU only: tallest first into SkylinePackers, a new page when the open  |
+// |          | ones are full; copies every image into its page's pixels               |
+// | upload() | one GL texture per page (needs the GL context), then frees the pixels  |
+// | build()  | pack() + upload()                                                      |
+//
+// pack() has no GL dependency, so the same code can run in an offline tool and write the
+// pages to disk; the game just packs at startup.
+//
+// Each image gets `padding` texels of its own edge pixels repeated around it. Without
+// that, linear filtering at a sprite's border samples the neighbouring image.
+class TextureAtlas {
+public:
+    struct Options {
+        int pageSize = 1024;    // square; upload() fails above GL_MAX_TEXTURE_SIZE (≥ 1024 in GL 3.3)
+        int padding = 1;        // texels of edge extrusion on every side
+    };
+
+    struct Stats {
+        std::size_t images = 0;
+        std::size_t pages = 0;
+        float occupancy = 0.0f; // packed texels (with padding) / page texels
+    };
+
+    // rgba: width * height pixels, row-major with row 0 at v0 (the bottom, as GL uploads
+    // it), 0xAABBGGRR (packColor). Returns the id.
+    std::uint32_t add(int width, int height, const std::uint32_t* rgba);
+
+    bool pack(const Options& options);
+    bool upload();
+    bool build(const Options& options) { return pack(options) && upload(); }
+    bool build() { return build(Options{}); }
+    void shutdown();
+
+    std::size_t size() const { return regions_.size(); }
+    std::size_t pageCount() const { return pages_.size(); }
+    const AtlasRegion& region(std::uint32_t id) const { return regions_[id]; }
+    GLuint pageTexture(std::uint32_t page) const { return pages_[page].texture.get(); }
+    const Stats& stats() const { return stats_; }
+
+private:
+    struct Image {
+        int width, height;
+        std::vector<std::uint32_t> pixels;
+    };
+    struct Page {
+        SkylinePacker packer;
+        std::vector<std::uint32_t> pixels;   // freed by upload()
+        GlTexture texture;
+    };
+
+    void blit(Page& page, const Image& image, int x, int y, int padding);
+
+    Options options_;
+    std::vector<Image> images_;              // freed by pack()
+    std::vector<AtlasRegion> regions_;
+    std::vector<Page> pages_;
+    Stats stats_;
+};
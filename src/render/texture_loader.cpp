@@ -0,0 +1,501 @@
+#include "render/texture_loader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#include "asset/block_decode.h"
+#include "asset/image.h"
+#include "asset/ktx2.h"
+#include "core/lz4.h"
+#include "core/vfs.h"
+#include "profile/trace.h"
+#include "render/gl_ext.h"
+#include "render/gl_state.h"
+#include "render/gpu_memory.h"
+
+namespace {
+
+// GL internal format for each PixelFormat (RGBA8: the uncompressed GL_RGBA8).
+GLenum glFormat(PixelFormat format) {
+    switch (format) {
+        case PixelFormat::RGBA8:      return GL_RGBA8;
+        case PixelFormat::BC1_RGB:    return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        case PixelFormat::BC1_RGBA:   return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+        case PixelFormat::BC3:        return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        case PixelFormat::BC7:        return GL_COMPRESSED_RGBA_BPTC_UNORM;
+        case PixelFormat::ETC2_RGB8:  return GL_COMPRESSED_RGB8_ETC2;
+        case PixelFormat::ETC2_RGBA8: return GL_COMPRESSED_RGBA8_ETC2_EAC;
+    }
+    return GL_RGBA8;
+}
+
+std::uint32_t formatBit(PixelFormat format) {
+    return 1u << static_cast<unsigned>(format);
+}
+
+std::uint32_t supportedFormats(const glext::Caps& caps) {
+    std::uint32_t bits = formatBit(PixelFormat::RGBA8);
+    if (caps.textureS3tc) {
+        bits |= formatBit(PixelFormat::BC1_RGB) | formatBit(PixelFormat::BC1_RGBA) | formatBit(PixelFormat::BC3);
+    }
+    if (caps.textureBptc) {
+        bits |= formatBit(PixelFormat::BC7);
+    }
+    if (caps.textureEtc2) {
+        bits |= formatBit(PixelFormat::ETC2_RGB8) | formatBit(PixelFormat::ETC2_RGBA8);
+    }
+    return bits;
+}
+
+// A decoded TGA / PPM as a one-level RGBA8 texture (Image rows are already bottom-up).
+void fromImage(Image&& image, TextureData& out) {
+    out = TextureData{};
+    out.format = PixelFormat::RGBA8;
+    out.levels.resize(1);
+    TextureLevel& level = out.levels[0];
+    level.width = image.width;
+    level.height = image.height;
+    level.bytes.resize(image.bytes());
+    std::memcpy(level.bytes.data(), image.pixels.data(), level.bytes.size());
+}
+
+} // namespace
+
+bool TextureLoader::init(GLuint placeholder, const Options& options) {
+    const gpumemory::Owner owner("texture loader");
+    options_ = options;
+    placeholder_ = placeholder;
+    gpuFormats_ = supportedFormats(glext::caps());
+    if (!staging_.init(GL_PIXEL_UNPACK_BUFFER, options.uploadBytesPerFrame)) {
+        std::cerr << "TextureLoader: failed to create the pixel upload ring\n";
+        return false;
+    }
+    stopping_ = false;
+    const int threads = std::max(1, options.decodeThreads);
+    for (int i = 0; i < threads; ++i) {
+        threads_.emplace_back(&TextureLoader::decodeLoop, this);
+    }
+    return true;
+}
+
+void TextureLoader::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        jobs_.clear();
+    }
+    wake_.notify_all();
+    for (std::thread& t : threads_) {
+        t.join();
+    }
+    threads_.clear();
+
+    uploads_.clear();           // the textures are queued for deletion (render/gl_resource.h)
+    entries_.clear();
+    decoded_.clear();
+    incoming_.clear();
+    records_.clear();
+    handles_.clear();
+    rerequested_.clear();
+    cache_.clear();
+    cachedBytes_ = 0;
+    staging_.shutdown();
+}
+
+TextureLoader::Handle TextureLoader::request(const std::string& path) {
+    Handle handle;
+    bool load = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto known = handles_.find(path);
+        if (known != handles_.end()) {
+            handle = known->second;
+            if (options_.gpuBudgetBytes > 0) {
+                rerequested_.push_back(handle);     // update() reloads it if it was evicted
+            }
+        } else {
+            handle = static_cast<Handle>(records_.size());
+            records_.push_back(Record{path, 0});
+            handles_.emplace(path, handle);
+            jobs_.push_back(Job{handle, path});
+            load = true;
+        }
+        ++records_[handle].refs;
+    }
+    if (load) {
+        wake_.notify_one();
+    }
+    return handle;
+}
+
+void TextureLoader::release(Handle handle) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (handle < records_.size() && records_[handle].refs > 0) {
+        --records_[handle].refs;
+    }
+}
+
+void TextureLoader::decodeLoop() {
+    trace::setThreadName("texture decode");
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        wake_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+        if (stopping_) {
+            return;
+        }
+        Job job = std::move(jobs_.front());
+        jobs_.pop_front();
+        lock.unlock();
+
+        Decoded result{job.handle, std::move(job.path), TextureData{}, false, false, std::string()};
+        if (fromCache(job.handle, result.data)) {
+            result.ok = true;
+        } else {
+            {
+                trace::Scope scope("decode image");
+                result.ok = decode(result);
+            }
+            if (result.ok && options_.cpuBudgetBytes > 0) {
+                cache(job.handle, result.data);
+            }
+        }
+
+        lock.lock();
+        decoded_.push_back(std::move(result));
+    }
+}
+
+// Decode thread: file → TextureData in a format this GPU samples.
+bool TextureLoader::decode(Decoded& result) const {
+    vfs::Blob bytes; // read in place when the file is stored uncompressed in a pack
+    if (!vfs::read(result.path, bytes)) {
+        result.error = "cannot open file";
+        return false;
+    }
+    if (!isKtx2(bytes.data(), bytes.size())) {
+        Image image;
+        if (!decodeImage(bytes.data(), bytes.size(), image, &result.error)) {
+            return false;
+        }
+        fromImage(std::move(image), result.data);
+        return true;
+    }
+    if (!decodeKtx2(bytes.data(), bytes.size(), result.data, &result.error)) {
+        return false;
+    }
+    if ((gpuFormats_ & formatBit(result.data.format)) == 0) {
+        const PixelFormat format = result.data.format;
+        trace::Scope scope("transcode");
+        if (!transcodeToRgba8(result.data, &result.error)) {
+            result.error += std::string(" (the GPU can't sample ") + pixelFormatName(format) + " either)";
+            return false;
+        }
+        result.transcoded = true;
+    }
+    return true;
+}
+
+// Decode thread: a reload of an evicted texture, from its compressed copy. The copy is
+// taken under the lock, the decompression isn't.
+bool TextureLoader::fromCache(Handle handle, TextureData& data) {
+    Cached copy;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto found = cache_.find(handle);
+        if (found == cache_.end()) {
+            return false;
+        }
+        found->second.lastUsed = ++cacheClock_;
+        copy = found->second;
+    }
+    trace::Scope scope("decompress cached image");
+    data = TextureData{};
+    data.format = copy.format;
+    data.topDown = copy.topDown;
+    data.levels.resize(copy.levels.size());
+    const unsigned char* packed = copy.compressed.data();
+    for (std::size_t i = 0; i < copy.levels.size(); ++i) {
+        const CachedLevel& from = copy.levels[i];
+        TextureLevel& level = data.levels[i];
+        level.width = from.width;
+        level.height = from.height;
+        level.bytes.resize(from.bytes);
+        if (!lz4Decompress(packed, from.packed, level.bytes.data(), from.bytes)) {
+            return false;               // can't happen to our own blocks; decode the file instead
+        }
+        packed += from.packed;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++cacheHits_;
+    return true;
+}
+
+// Decode thread: keeps a compressed copy of what is about to be uploaded, then trims the
+// cache back to its budget, least recently used first.
+void TextureLoader::cache(Handle handle, const TextureData& data) {
+    Cached entry;
+    entry.format = data.format;
+    entry.topDown = data.topDown;
+    std::vector<unsigned char> block;
+    {
+        trace::Scope scope("compress image");
+        for (const TextureLevel& level : data.levels) {
+            lz4Compress(level.bytes.data(), level.bytes.size(), block);
+            entry.levels.push_back(CachedLevel{level.width, level.height, level.bytes.size(), block.size()});
+            entry.compressed.insert(entry.compressed.end(), block.begin(), block.end());
+        }
+    }
+    const std::size_t size = entry.compressed.size();
+    if (size > options_.cpuBudgetBytes) {
+        return;                         // would evict everything and still not fit
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    entry.lastUsed = ++cacheClock_;
+    cachedBytes_ += size;
+    const auto old = cache_.find(handle);
+    if (old != cache_.end()) {
+        cachedBytes_ -= old->second.compressed.size();
+    }
+    cache_[handle] = std::move(entry);
+    while (cachedBytes_ > options_.cpuBudgetBytes) {
+        auto oldest = cache_.begin();
+        for (auto it = cache_.begin(); it != cache_.end(); ++it) {
+            if (it->second.lastUsed < oldest->second.lastUsed) {
+                oldest = it;
+            }
+        }
+        cachedBytes_ -= oldest->second.compressed.size();
+        cache_.erase(oldest);
+    }
+}
+
+TextureLoader::Entry& TextureLoader::entry(Handle handle) {
+    if (handle >= entries_.size()) {
+        entries_.resize(handle + 1);
+    }
+    return entries_[handle];
+}
+
+// Copies as many whole rows (block rows, for compressed levels) as fit in `budget` into
+// the PBO and queues the copies into the texture, level after level. true = the last
+// row of the last level is in.
+bool TextureLoader::uploadBand(Upload& upload, GLsizeiptr& budget) {
+    const PixelFormat format = upload.data.format;
+    const int block = blockSize(format);
+    while (upload.level < upload.data.levels.size()) {
+        const TextureLevel& level = upload.data.levels[upload.level];
+        const GLsizeiptr rowBytes = static_cast<GLsizeiptr>(imageBytes(format, level.width, block));
+        const int blockRows = (level.height + block - 1) / block;
+        const int rows = std::min(blockRows - upload.nextRow, static_cast<int>(budget / rowBytes));
+        if (rows <= 0) {
+            return false;
+        }
+        const GLsizeiptr bytes = rowBytes * rows;
+        StreamAllocation staging = staging_.allocate(bytes, 4);
+        if (!staging.valid()) {
+            return false;
+        }
+        std::memcpy(staging.ptr, level.bytes.data() + static_cast<std::size_t>(upload.nextRow) * rowBytes, bytes);
+        staging_.commit(staging);
+
+        // With a PIXEL_UNPACK buffer bound, the last argument is an offset into it: the call
+        // only records a GPU-side copy and returns. A compressed band's height may stop
+        // short of a block only at the level's bottom edge.
+        const GLint mip = static_cast<GLint>(upload.level);
+        const GLint y = upload.nextRow * block;
+        const GLsizei height = std::min(rows * block, level.height - y);
+        const void* offset = reinterpret_cast<const void*>(staging.offset);
+        glstate::bindBuffer(GL_PIXEL_UNPACK_BUFFER, staging_.buffer());
+        glstate::activeTexture(GL_TEXTURE0);
+        glstate::bindTexture(GL_TEXTURE_2D, upload.texture.get());
+        if (isBlockCompressed(format)) {
+            glCompressedTexSubImage2D(GL_TEXTURE_2D, mip, 0, y, level.width, height, glFormat(format),
+                                      static_cast<GLsizei>(bytes), offset);
+        } else {
+            glTexSubImage2D(GL_TEXTURE_2D, mip, 0, y, level.width, height, GL_RGBA, GL_UNSIGNED_BYTE, offset);
+        }
+        glstate::bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+        upload.nextRow += rows;
+        budget -= bytes;
+        uploadedBytes_ += static_cast<std::size_t>(bytes);
+        if (upload.nextRow < blockRows) {
+            return false; // budget spent mid-level
+        }
+        ++upload.level;
+        upload.nextRow = 0;
+    }
+    return true;
+}
+
+void TextureLoader::update() {
+    const gpumemory::Owner owner("texture loader");
+    ++frame_;
+    bool reload = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        incoming_.swap(decoded_);
+        for (Handle handle : rerequested_) {
+            if (handle < entries_.size() && entries_[handle].state == State::Evicted) {
+                entries_[handle].state = State::Loading;
+                --evictedCount_;
+                jobs_.push_back(Job{handle, records_[handle].path});
+                reload = true;
+            }
+        }
+        rerequested_.clear();
+    }
+    if (reload) {
+        wake_.notify_all();
+    }
+    for (Decoded& d : incoming_) {
+        Entry& e = entry(d.handle);
+        if (!d.ok) {
+            std::cerr << "TextureLoader: " << d.path << ": " << d.error << "\n";
+            e.state = State::Failed;
+            ++failedCount_;
+            continue;
+        }
+        // Storage for every level now (no data: nothing to wait for), the texels band by
+        // band from the PBO. A file's own mip chain is used as is; a single RGBA8 level
+        // gets one generated if options_.mipmaps asks for it.
+        const TextureData& data = d.data;
+        const GLenum format = glFormat(data.format);
+        const bool mipmapped = data.levels.size() > 1 || (options_.mipmaps && !isBlockCompressed(data.format));
+        GlTexture texture = GlTexture::create();
+        glstate::activeTexture(GL_TEXTURE0);
+        glstate::bindTexture(GL_TEXTURE_2D, texture.get());
+        for (std::size_t i = 0; i < data.levels.size(); ++i) {
+            const TextureLevel& level = data.levels[i];
+            if (isBlockCompressed(data.format)) {
+                glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(i), format, level.width, level.height, 0,
+                                       static_cast<GLsizei>(level.bytes.size()), nullptr);
+            } else {
+                glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(i), GL_RGBA8, level.width, level.height, 0, GL_RGBA,
+                             GL_UNSIGNED_BYTE, nullptr);
+            }
+        }
+        // A generated chain (below, once uploaded) adds a third.
+        const bool generated = options_.mipmaps && data.levels.size() == 1 && !isBlockCompressed(data.format);
+        gpumemory::track(GlObject::Texture, texture.get(), generated ? data.bytes() * 4 / 3 : data.bytes(), gpumemory::Category::Texture);
+        if (data.levels.size() > 1) {
+            // A chain that stops short of 1x1 is still complete up to its last level.
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(data.levels.size() - 1));
+        }
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mipmapped ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        e.width = data.width();
+        e.height = data.height();
+        e.topDown = data.topDown;
+        if (d.transcoded) {
+            ++transcodedCount_;
+        }
+        uploads_.push_back(Upload{d.handle, std::move(d.data), std::move(texture), 0, 0});
+    }
+    incoming_.clear();
+
+    // Oldest first, until this frame's budget is spent.
+    GLsizeiptr budget = staging_.bytesPerFrame();
+    while (!uploads_.empty()) {
+        Upload& upload = uploads_.front();
+        const TextureData& data = upload.data;
+        const int block = blockSize(data.format);
+        if (static_cast<GLsizeiptr>(imageBytes(data.format, data.width(), block)) > staging_.bytesPerFrame()) {
+            std::cerr << "TextureLoader: rows of " << data.width()
+                      << " px exceed the per-frame upload budget\n";
+            upload.texture.reset();
+            entry(upload.handle).state = State::Failed;
+            ++failedCount_;
+            uploads_.pop_front();
+            continue;
+        }
+        if (!uploadBand(upload, budget)) {
+            break; // budget spent: the rest next frame
+        }
+        if (options_.mipmaps && data.levels.size() == 1 && !isBlockCompressed(data.format)) {
+            glstate::bindTexture(GL_TEXTURE_2D, upload.texture.get());
+            glGenerateMipmap(GL_TEXTURE_2D);
+        }
+        residentBytes_ += data.bytes();
+        Entry& e = entry(upload.handle);
+        e.texture = std::move(upload.texture);
+        e.state = State::Ready;
+        e.bytes = data.bytes();
+        e.lastUsed = frame_;            // just arrived: not the first to go
+        ++readyCount_;
+        uploads_.pop_front();
+    }
+    staging_.endFrame();
+    evict();
+}
+
+// Over the GPU budget: unreferenced textures go, the one drawn longest ago first, until
+// it fits or none are left. The names go through the deletion queue like any other.
+void TextureLoader::evict() {
+    if (options_.gpuBudgetBytes == 0 || residentBytes_ <= options_.gpuBudgetBytes) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        refs_.resize(records_.size());
+        for (std::size_t h = 0; h < records_.size(); ++h) {
+            refs_[h] = records_[h].refs;
+        }
+    }
+    victims_.clear();
+    for (Handle h = 0; h < entries_.size(); ++h) {
+        if (entries_[h].state == State::Ready && (h >= refs_.size() || refs_[h] == 0)) {
+            victims_.push_back(h);
+        }
+    }
+    std::sort(victims_.begin(), victims_.end(),
+              [this](Handle a, Handle b) { return entries_[a].lastUsed < entries_[b].lastUsed; });
+    for (Handle h : victims_) {
+        if (residentBytes_ <= options_.gpuBudgetBytes) {
+            break;
+        }
+        Entry& e = entries_[h];
+        e.texture.reset();
+        residentBytes_ -= e.bytes;
+        e.bytes = 0;
+        e.state = State::Evicted;
+        --readyCount_;
+        ++evictedCount_;
+    }
+}
+
+GLuint TextureLoader::texture(Handle handle) const {
+    if (handle < entries_.size() && entries_[handle].state == State::Ready) {
+        entries_[handle].lastUsed = frame_;
+        return entries_[handle].texture.get();
+    }
+    return placeholder_;
+}
+
+bool TextureLoader::ready(Handle handle) const {
+    return handle < entries_.size() && entries_[handle].state == State::Ready;
+}
+
+bool TextureLoader::topDown(Handle handle) const {
+    return ready(handle) && entries_[handle].topDown;
+}
+
+TextureLoader::Stats TextureLoader::stats() const {
+    Stats s;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        s.requested = records_.size();
+        s.cachedBytes = cachedBytes_;
+        s.cacheHits = cacheHits_;
+    }
+    s.ready = readyCount_;
+    s.failed = failedCount_;
+    s.evicted = evictedCount_;
+    s.uploadedBytes = uploadedBytes_;
+    s.residentBytes = residentBytes_;
+    s.transcoded = transcodedCount_;
+    return s;
+}
@@ -0,0 +1,225 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "asset/texture_data.h"
+#include "render/gl_resource.h"
+#include "render/stream_buffer.h"
+
+// TextureLoader
+// -------------
+// Loads image files into GL textures without blocking a frame:
+//
+//     decode threads:  read file → decodeImage / decodeKtx2 ─┐
+//                                                            ▼ (mutex-protected queue)
+//     GL thread, update() each frame:  copy ≤ budget bytes into the PBO ring
+//                                      → glTexSubImage2D from the PBO (DMA, no stall)
+//                                      → last rows uploaded: texture(handle) switches
+//
+//     const TextureLoader::Handle h = loader.request("assets/hero.tga"); // any thread
+//     ...
+//     loader.update();                 // GL thread, once per frame
+//     glBindTexture(GL_TEXTURE_2D, loader.texture(h)); // placeholder until it's ready
+//
+// | Stage     | Where                 | Cost on the frame                               |
+// | --------- | --------------------- | ----------------------------------------------- |
+// | read +    | own decode thread(s)  | none                                            |
+// | decode    |                       |                                                 |
+// | upload    | GL thread, update()   | memcpy of at most uploadBytesPerFrame into      |
+// |           |                       | mapped memory + glTexSubImage2D calls that only |
+// |           |                       | queue a copy from the PBO                       |
+// | swap      | GL thread             | none: texture(h) returns the real name          |
+//
+// The staging buffer is a StreamBuffer (render/stream_buffer.h) on GL_PIXEL_UNPACK_BUFFER:
+// the same fenced three-segment ring the instance data uses, so a segment is only
+// rewritten after the GPU has finished copying out of it. An image larger than one
+// frame's budget goes up in bands of rows over several frames; texture(h) keeps
+// returning the placeholder until the last band is in, so a half-uploaded texture is
+// never sampled. A level's worth of requests costs each frame at most one budget.
+//
+// Compressed textures
+// -------------------
+// A .ktx2 file (asset/ktx2.h) brings its own mip chain, often block-compressed. Blocks the
+// GPU can sample go up as they are, with glCompressedTexSubImage2D from the same PBO ring,
+// a band of whole block rows at a time; the rest are expanded on the decode thread:
+//
+// | File format      | GPU has it (gl_ext caps) | GPU lacks it                         |
+// | ---------------- | ------------------------ | ------------------------------------ |
+// | BC1 / BC3        | textureS3tc: as is       | transcodeToRgba8 (asset/block_decode)|
+// | ETC2 / EAC       | textureEtc2: as is       | transcodeToRgba8                     |
+// | BC7              | textureBptc: as is       | fails: no CPU decoder                |
+// | RGBA8, TGA, PPM  | always                   | —                                    |
+//
+// Transcoding costs the decode thread a few ms per megatexel and the texture 4-8x the
+// VRAM, but nothing on the frame. KTX2 stores rows top-down; those textures are uploaded
+// unflipped and topDown(h) tells the caller to sample with v flipped.
+//
+// Residency
+// ---------
+// Handles are per path and reference counted: request() of a path already known returns
+// its handle (+1), release() gives one up. With budgets set, textures nobody references
+// can go, least recently drawn (texture()) first:
+//
+// | Budget         | Over it, after each update()              | Coming back                |
+// | -------------- | ----------------------------------------- | -------------------------- |
+// | gpuBudgetBytes | unreferenced Ready textures are deleted,  | request() again: reloaded  |
+// |                | oldest texture() call first               | (CPU cache first)          |
+// | cpuBudgetBytes | the decode threads keep every decoded     | an LZ4 decode (GB/s), no   |
+// |                | texture LZ4-compressed; oldest dropped    | file read, decode or       |
+// |                |                                           | transcode                  |
+//
+// Referenced textures are never evicted: everything referenced can exceed the GPU
+// budget, and then nothing else stays resident. The CPU copy is of the data as uploaded
+// (after any transcode), so an RGBA8 sprite compresses well and a BC block much less.
+//
+// The decoders are this class's own threads, NOT JobSystem jobs: JobSystem::wait() runs
+// whatever is queued, so a frame waiting on its parallelFor could pick up a 20 ms file
+// read and hitch—exactly what this is meant to prevent.
+//
+// request() and release() may be called from any thread; init(), update(), texture(),
+// shutdown() only on the thread that owns the GL context.
+class TextureLoader {
+public:
+    using Handle = std::uint32_t;
+    static constexpr Handle kInvalidHandle = 0xffffffffu;
+
+    struct Options {
+        int decodeThreads = 1;
+        GLsizeiptr uploadBytesPerFrame = 4 << 20;  // 4 MiB: a 1024² RGBA8 image per frame
+        bool mipmaps = false;                      // glGenerateMipmap after the last band
+        std::size_t gpuBudgetBytes = 0;            // resident texel bytes; 0: no limit, no eviction
+        std::size_t cpuBudgetBytes = 0;            // compressed copies for reloads; 0: none kept
+    };
+
+    struct Stats {
+        std::size_t requested = 0;       // paths (handles)
+        std::size_t ready = 0;
+        std::size_t failed = 0;
+        std::size_t evicted = 0;         // not resident now: dropped for the GPU budget
+        std::size_t uploadedBytes = 0;   // since the last resetFrameStats()
+        std::size_t residentBytes = 0;   // level data of the ready textures, as stored in VRAM
+        std::size_t transcoded = 0;      // compressed files the GPU couldn't take as they were
+        std::size_t cachedBytes = 0;     // the CPU cache's compressed copies
+        std::size_t cacheHits = 0;       // loads served from it
+    };
+
+    // placeholder: what texture() returns until an image is ready (or if it failed).
+    bool init(GLuint placeholder, const Options& options);
+    bool init(GLuint placeholder) { return init(placeholder, Options{}); }
+    void shutdown();
+
+    // The path's handle, with one more reference (the first request starts the load).
+    Handle request(const std::string& path);
+    // One reference fewer; at none, the texture may be evicted (it stays until the
+    // budget needs the room).
+    void release(Handle handle);
+
+    void update();
+    GLuint texture(Handle handle) const;
+    bool ready(Handle handle) const;
+    // The texture's first row is its top (KTX2): sample it with v flipped. false until ready.
+    bool topDown(Handle handle) const;
+
+    Stats stats() const;
+    void resetFrameStats() { uploadedBytes_ = 0; }
+
+private:
+    enum class State : std::uint8_t { Loading, Ready, Failed, Evicted };
+
+    struct Entry {
+        State state = State::Loading;
+        GlTexture texture;
+        int width = 0, height = 0;
+        bool topDown = false;
+        std::size_t bytes = 0;           // in VRAM, while Ready
+        mutable std::uint64_t lastUsed = 0; // frame_ of the last texture() call
+    };
+    // Under mutex_: what request() / release() touch.
+    struct Record {
+        std::string path;
+        std::uint32_t refs = 0;
+    };
+    // A decoded texture, every level LZ4-compressed back to back.
+    struct CachedLevel {
+        int width = 0, height = 0;
+        std::size_t bytes = 0;               // decompressed
+        std::size_t packed = 0;              // its block in `compressed`
+    };
+    struct Cached {
+        PixelFormat format = PixelFormat::RGBA8;
+        bool topDown = false;
+        std::vector<CachedLevel> levels;
+        std::vector<unsigned char> compressed;
+        std::uint64_t lastUsed = 0;          // cacheClock_
+    };
+    struct Job {
+        Handle handle;
+        std::string path;
+    };
+    struct Decoded {
+        Handle handle;
+        std::string path;
+        TextureData data;
+        bool ok;
+        bool transcoded;
+        std::string error;
+    };
+    struct Upload {
+        Handle handle;
+        TextureData data;
+        GlTexture texture;
+        std::size_t level;
+        int nextRow;    // in block rows (texel rows for RGBA8)
+    };
+
+    void decodeLoop();
+    bool decode(Decoded& result) const;
+    bool fromCache(Handle handle, TextureData& data);
+    void cache(Handle handle, const TextureData& data);
+    bool uploadBand(Upload& upload, GLsizeiptr& budget);
+    void evict();
+    Entry& entry(Handle handle);
+
+    Options options_;
+    GLuint placeholder_ = 0;
+    StreamBuffer staging_;
+    std::uint32_t gpuFormats_ = 0;       // bit per PixelFormat the GPU samples; set before the threads start
+
+    // Shared with the decode threads.
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::deque<Job> jobs_;
+    std::vector<Decoded> decoded_;
+    std::vector<Record> records_;        // by handle
+    std::unordered_map<std::string, Handle> handles_;
+    std::vector<Handle> rerequested_;    // known paths asked for again: reload if evicted
+    std::unordered_map<Handle, Cached> cache_;
+    std::size_t cachedBytes_ = 0;
+    std::size_t cacheHits_ = 0;
+    std::uint64_t cacheClock_ = 0;
+    bool stopping_ = false;
+    std::vector<std::thread> threads_;
+
+    // GL thread only.
+    std::vector<Entry> entries_;
+    std::deque<Upload> uploads_;
+    std::vector<Decoded> incoming_;      // swapped with decoded_ under the lock
+    std::vector<Handle> victims_;        // evict()'s candidates
+    std::vector<std::uint32_t> refs_;    // records_' counts, copied for evict()
+    std::uint64_t frame_ = 0;            // update() calls
+    std::size_t readyCount_ = 0;
+    std::size_t failedCount_ = 0;
+    std::size_t evictedCount_ = 0;
+    std::size_t uploadedBytes_ = 0;
+    std::size_t residentBytes_ = 0;
+    std::size_t transcodedCount_ = 0;
+};
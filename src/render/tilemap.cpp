@@ -0,0 +1,301 @@
+#include "render/tilemap.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include "render/gl_buffer.h"
+#include "render/gl_state.h"
+#include "render/gpu_memory.h"
+#include "render/shader_layout.h"
+#include "render/vertex_layout.h"
+
+namespace {
+
+constexpr std::size_t kChunkQuads = static_cast<std::size_t>(Tilemap::kChunkTiles) * Tilemap::kChunkTiles *
+                                    Tilemap::kMaxLayers;
+// The most vertices a chunk can have fit 16-bit indices.
+static_assert(kChunkQuads * 4 <= 65536, "chunk too large for GL_UNSIGNED_SHORT indices");
+
+// Same locations as vertex.glsl TILEMAP: aPos (0), aUV (1), aLayer (3).
+namespace input = shaderlayout::vertex;     // TILEMAP
+
+const VertexLayout kVertexLayout(sizeof(Tilemap::Vertex), {
+    shaderInput(input::aPos, 2, GL_SHORT, VertexAttribute::Kind::Float, offsetof(Tilemap::Vertex, x)),
+    shaderInput(input::aUV, 2, GL_UNSIGNED_SHORT, VertexAttribute::Kind::Normalized, offsetof(Tilemap::Vertex, uv)),
+    shaderInput(input::aLayer, 1, GL_UNSIGNED_SHORT, VertexAttribute::Kind::Integer, offsetof(Tilemap::Vertex, layer)),
+});
+
+Tilemap::Vertex vertex(int x, int y, const glm::vec2& uv, std::uint32_t layer) {
+    return Tilemap::Vertex{static_cast<std::int16_t>(x), static_cast<std::int16_t>(y), vertexpack::unorm16x2(uv),
+                           static_cast<std::uint16_t>(layer), 0};
+}
+
+} // namespace
+
+bool Tilemap::init(const Options& options, VertexArrayCache& vaos) {
+    const gpumemory::Owner owner("tilemap");
+    if (options.width <= 0 || options.height <= 0 || options.width > kMaxTiles || options.height > kMaxTiles ||
+        options.layers <= 0 || options.layers > kMaxLayers || options.tileSize <= 0.0f) {
+        std::cerr << "Tilemap: invalid size " << options.width << "x" << options.height << ", " << options.layers
+                  << " layer(s)\n";
+        return false;
+    }
+    shutdown();
+    options_ = options;
+    vaos_ = &vaos;
+    chunksX_ = (options.width + kChunkTiles - 1) / kChunkTiles;
+    chunksY_ = (options.height + kChunkTiles - 1) / kChunkTiles;
+    tiles_.assign(static_cast<std::size_t>(options.layers) * options.width * options.height, kEmpty);
+    chunks_.resize(static_cast<std::size_t>(chunksX_) * chunksY_);
+    dirty_.reserve(chunks_.size());
+    scratch_.reserve(kChunkQuads * 4);
+    stats_.chunks = chunks_.size();
+
+    // Quad k is vertices 4k .. 4k + 3: the same two triangles for every chunk.
+    std::vector<std::uint16_t> indices(kChunkQuads * 6);
+    for (std::size_t q = 0; q < kChunkQuads; ++q) {
+        const std::uint16_t v = static_cast<std::uint16_t>(q * 4);
+        const std::uint16_t quad[6] = {v, static_cast<std::uint16_t>(v + 1), static_cast<std::uint16_t>(v + 2),
+                                       static_cast<std::uint16_t>(v + 2), static_cast<std::uint16_t>(v + 3), v};
+        std::copy(quad, quad + 6, indices.begin() + static_cast<std::ptrdiff_t>(q * 6));
+    }
+    indices_ = GlBuffer::create();
+    glbuffer::data(GL_ELEMENT_ARRAY_BUFFER, indices_.get(),
+                   static_cast<GLsizeiptr>(indices.size() * sizeof(std::uint16_t)), indices.data(), GL_STATIC_DRAW);
+
+    if (options.mode == Mode::Chunks) {
+        // One slot of the most vertices a chunk can have for each chunk, in one buffer:
+        // the chunks differ only in their base vertex, so they share one VAO and a whole
+        // view of them is one multi-draw.
+        slotVertices_ = static_cast<std::size_t>(kChunkTiles) * kChunkTiles * options.layers * 4;
+        vertices_ = GlBuffer::create();
+        glbuffer::data(GL_ARRAY_BUFFER, vertices_.get(),
+                       static_cast<GLsizeiptr>(chunks_.size() * slotVertices_ * sizeof(Vertex)), nullptr,
+                       GL_STATIC_DRAW);
+        chunkVao_ = vaos.get({{&kVertexLayout, vertices_.get()}}, indices_.get());
+    }
+    if (options.mode == Mode::IndexTexture) {
+        // Integer texture: no filtering (and no mipmaps) between tile ids.
+        indexTexture_ = GlTexture::create();
+        glstate::activeTexture(kIndexTextureUnit);
+        glstate::bindTexture(GL_TEXTURE_2D_ARRAY, indexTexture_.get());
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, 0);
+        glstate::bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_R16UI, options.width, options.height, options.layers, 0,
+                     GL_RED_INTEGER, GL_UNSIGNED_SHORT, tiles_.data());
+        gpumemory::track(GlObject::Texture, indexTexture_.get(),
+                         gpumemory::textureBytes(GL_R16UI, options.width, options.height, options.layers), gpumemory::Category::Texture);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glstate::activeTexture(GL_TEXTURE0);
+
+        // The whole map. Its fragments' tile coordinates are the interpolated aPos
+        // itself (TILE_INDEX), so the UVs are unused.
+        const Vertex quad[4] = {
+            vertex(0, 0, glm::vec2(0.0f), 0u),
+            vertex(options.width, 0, glm::vec2(0.0f), 0u),
+            vertex(options.width, options.height, glm::vec2(0.0f), 0u),
+            vertex(0, options.height, glm::vec2(0.0f), 0u),
+        };
+        quadVbo_ = GlBuffer::create();
+        glbuffer::data(GL_ARRAY_BUFFER, quadVbo_.get(), sizeof(quad), quad, GL_STATIC_DRAW);
+        quadVao_ = vaos.get({{&kVertexLayout, quadVbo_.get()}}, indices_.get());
+    }
+    return true;
+}
+
+void Tilemap::shutdown() {
+    if (vaos_ != nullptr) {
+        vaos_->forget(indices_.get());  // every chunk's VAO and the quad's read it
+    }
+    vaos_ = nullptr;
+    quadVao_ = 0;
+    chunkVao_ = 0;
+    chunks_.clear();
+    vertices_.reset();                 // handles queue their names (render/gl_resource.h)
+    slotVertices_ = 0;
+    indices_.reset();
+    indexTexture_.reset();
+    quadVbo_.reset();
+    tiles_.clear();
+    dirty_.clear();
+    chunksX_ = chunksY_ = 0;
+    stats_ = Stats{};
+}
+
+void Tilemap::setTile(int layer, int x, int y, std::uint16_t tile) {
+    if (layer < 0 || layer >= options_.layers || x < 0 || x >= options_.width || y < 0 || y >= options_.height) {
+        return;
+    }
+    std::uint16_t& slot = tiles_[(static_cast<std::size_t>(layer) * options_.height + y) * options_.width + x];
+    if (slot == tile) {
+        return;
+    }
+    slot = tile;
+    const int chunk = (y / kChunkTiles) * chunksX_ + x / kChunkTiles;
+    if (!chunks_[chunk].dirty) {
+        chunks_[chunk].dirty = true;
+        dirty_.push_back(chunk);
+    }
+}
+
+std::uint16_t Tilemap::tile(int layer, int x, int y) const {
+    if (layer < 0 || layer >= options_.layers || x < 0 || x >= options_.width || y < 0 || y >= options_.height) {
+        return kEmpty;
+    }
+    return tiles_[(static_cast<std::size_t>(layer) * options_.height + y) * options_.width + x];
+}
+
+void Tilemap::apply(const TileEdit* edits, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        setTile(edits[i].layer, edits[i].x, edits[i].y, edits[i].tile);
+    }
+}
+
+bool Tilemap::tileAt(const glm::vec2& world, int& x, int& y) const {
+    const glm::vec2 local = (world - options_.origin) / options_.tileSize;
+    if (local.x < 0.0f || local.y < 0.0f || local.x >= static_cast<float>(options_.width) ||
+        local.y >= static_cast<float>(options_.height)) {
+        return false;
+    }
+    x = static_cast<int>(local.x);
+    y = static_cast<int>(local.y);
+    return true;
+}
+
+void Tilemap::update(std::uint32_t arrayLayers) {
+    for (int chunk : dirty_) {
+        if (options_.mode == Mode::IndexTexture) {
+            upload(chunk);
+        } else {
+            bake(chunk, arrayLayers);
+        }
+        chunks_[chunk].dirty = false;
+    }
+    dirty_.clear();
+}
+
+void Tilemap::bake(int chunk, std::uint32_t arrayLayers) {
+    Chunk& c = chunks_[chunk];
+    const int x0 = (chunk % chunksX_) * kChunkTiles;
+    const int y0 = (chunk / chunksX_) * kChunkTiles;
+    const int x1 = std::min(x0 + kChunkTiles, options_.width);
+    const int y1 = std::min(y0 + kChunkTiles, options_.height);
+
+    scratch_.clear();
+    for (int layer = 0; layer < options_.layers; ++layer) {
+        for (int y = y0; y < y1; ++y) {
+            const std::uint16_t* row = &tiles_[(static_cast<std::size_t>(layer) * options_.height + y) * options_.width];
+            for (int x = x0; x < x1; ++x) {
+                if (row[x] == kEmpty) {
+                    continue;
+                }
+                const std::uint32_t image = arrayLayers > 0 ? row[x] % arrayLayers : 0u;
+                scratch_.push_back(vertex(x, y, glm::vec2(0.0f, 0.0f), image));
+                scratch_.push_back(vertex(x + 1, y, glm::vec2(1.0f, 0.0f), image));
+                scratch_.push_back(vertex(x + 1, y + 1, glm::vec2(1.0f, 1.0f), image));
+                scratch_.push_back(vertex(x, y + 1, glm::vec2(0.0f, 1.0f), image));
+            }
+        }
+    }
+    ++stats_.rebuilds;
+
+    const std::size_t bytes = scratch_.size() * sizeof(Vertex);
+    stats_.vertexBytes -= static_cast<std::size_t>(c.indexCount / 6) * 4 * sizeof(Vertex);
+    stats_.vertexBytes += bytes;
+    c.indexCount = static_cast<GLsizei>(scratch_.size() / 4 * 6);
+    if (scratch_.empty()) {
+        return;                        // an emptied chunk is just not drawn
+    }
+    // Into the chunk's slot of the shared buffer. Frames still in flight may be reading
+    // it; the driver copies the data aside rather than wait for them (and edits are rare,
+    // so the buffer is GL_STATIC_DRAW all the same).
+    glbuffer::subData(GL_ARRAY_BUFFER, vertices_.get(),
+                      static_cast<GLintptr>(static_cast<std::size_t>(chunk) * slotVertices_ * sizeof(Vertex)),
+                      static_cast<GLsizeiptr>(bytes), scratch_.data());
+}
+
+void Tilemap::upload(int chunk) {
+    const int x0 = (chunk % chunksX_) * kChunkTiles;
+    const int y0 = (chunk / chunksX_) * kChunkTiles;
+    const int w = std::min(kChunkTiles, options_.width - x0);
+    const int h = std::min(kChunkTiles, options_.height - y0);
+    // A sub-rectangle of [layer][y][x]: row length and image height say how to step.
+    glstate::activeTexture(kIndexTextureUnit);
+    glstate::bindTexture(GL_TEXTURE_2D_ARRAY, indexTexture_.get());
+    glstate::bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, options_.width);
+    glPixelStorei(GL_UNPACK_IMAGE_HEIGHT, options_.height);
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, x0, y0, 0, w, h, options_.layers, GL_RED_INTEGER, GL_UNSIGNED_SHORT,
+                    &tiles_[static_cast<std::size_t>(y0) * options_.width + x0]);
+    glPixelStorei(GL_UNPACK_IMAGE_HEIGHT, 0);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glstate::activeTexture(GL_TEXTURE0);
+    ++stats_.rebuilds;
+}
+
+void Tilemap::draw(const CullRect& view, MultiDraw& draws) {
+    stats_.draws = 0;
+    stats_.drawnQuads = 0;
+    if (chunks_.empty()) {
+        return;
+    }
+    if (options_.mode == Mode::Chunks) {
+        drawChunks(view, draws);
+        return;
+    }
+    const glm::vec2 extent = glm::vec2(static_cast<float>(options_.width), static_cast<float>(options_.height)) *
+                             options_.tileSize;
+    const CullRect map{options_.origin, options_.origin + extent};
+    if (map.max.x < view.min.x || map.min.x > view.max.x || map.max.y < view.min.y || map.min.y > view.max.y) {
+        return;
+    }
+    // One quad, clipped to the screen by the rasterizer: the fragments do the rest.
+    glstate::activeTexture(kIndexTextureUnit);
+    glstate::bindTexture(GL_TEXTURE_2D_ARRAY, indexTexture_.get());
+    glstate::activeTexture(GL_TEXTURE0);
+    glstate::bindVertexArray(quadVao_);
+    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, nullptr);
+    stats_.draws = 1;
+}
+
+void Tilemap::drawChunks(const CullRect& view, MultiDraw& draws) {
+    // The chunks overlapping the view, straight from its corners: no per-chunk test.
+    const float chunkSize = options_.tileSize * kChunkTiles;
+    const glm::vec2 lo = glm::floor((view.min - options_.origin) / chunkSize);
+    const glm::vec2 hi = glm::floor((view.max - options_.origin) / chunkSize);
+    const int cx0 = std::max(0, static_cast<int>(std::max(lo.x, -1.0f)));
+    const int cy0 = std::max(0, static_cast<int>(std::max(lo.y, -1.0f)));
+    const int cx1 = std::min(chunksX_ - 1, static_cast<int>(std::min(hi.x, static_cast<float>(chunksX_))));
+    const int cy1 = std::min(chunksY_ - 1, static_cast<int>(std::min(hi.y, static_cast<float>(chunksY_))));
+    for (int cy = cy0; cy <= cy1; ++cy) {
+        for (int cx = cx0; cx <= cx1; ++cx) {
+            const std::size_t chunk = static_cast<std::size_t>(cy) * chunksX_ + cx;
+            const Chunk& c = chunks_[chunk];
+            if (c.indexCount == 0) {
+                continue;
+            }
+            // Every chunk starts at index 0 of the shared quad pattern; only its slot differs.
+            Mesh mesh;
+            mesh.baseVertex = static_cast<GLint>(chunk * slotVertices_);
+            mesh.vertexCount = c.indexCount / 6 * 4;
+            mesh.indexCount = c.indexCount;
+            draws.add(chunkVao_, mesh);
+            ++stats_.draws;
+            stats_.drawnQuads += static_cast<std::size_t>(c.indexCount / 6);
+        }
+    }
+}
+
+void Tilemap::setUniforms(GLuint program) const {
+    glstate::useProgram(program);
+    const GLint grid = glGetUniformLocation(program, shaderlayout::vertex::uTileGrid.name);
+    if (grid >= 0) {
+        glUniform3f(grid, options_.origin.x, options_.origin.y, options_.tileSize);
+    }
+}
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "render/culling.h"
+#include "render/gl_resource.h"
+#include "render/multi_draw.h"
+#include "render/shader_layout.h"
+#include "render/vertex_array_cache.h"
+
+// One tile change. The simulation side makes them and sends them to the render thread in
+// the FramePacket (render/frame_packet.h); Tilemap::apply() writes them.
+struct TileEdit {
+    std::int32_t x = 0;
+    std::int32_t y = 0;
+    std::uint16_t layer = 0;
+    std::uint16_t tile = 0;            // Tilemap::kEmpty clears it
+};
+
+// Tilemap
+// -------
+// Tile layers baked into static meshes, one per CHUNK of kChunkTiles x kChunkTiles tiles.
+// A chunk's vertices are tile-grid positions (location 0, the same `vec2 aPos` as every
+// other program) plus UV and array layer, written once and drawn as they are until a tile
+// in that chunk changes:
+//
+//     vertices:  | chunk 0's slot | chunk 1's slot | ...     one VBO, a fixed slot per chunk
+//     slot:      layer 0 quads | layer 1 quads | ...         drawn bottom to top
+//     indices:   0 1 2  2 3 0  4 5 6  6 7 4 ...              one EBO shared by all chunks
+//
+// A chunk is a base vertex (its slot) into the shared buffers, so all of them are drawn
+// through one VAO, and draw() hands the visible ones to a MultiDraw: one
+// glMultiDrawElementsIndirect for the view where the driver has it (render/multi_draw.h).
+// Each slot holds a full chunk's worth of quads, so a re-bake never moves a chunk.
+//
+// | Tiles as entities                        | Chunk meshes                              |
+// | ---------------------------------------- | ----------------------------------------- |
+// | every tile extracted, culled, composed   | nothing per tile per frame: the vertices  |
+// | and streamed, every frame                | stay on the GPU                           |
+// | one instance per tile on screen          | one multi-draw of the visible chunks      |
+// | culled per tile                          | culled per chunk: the view rectangle      |
+// |                                          | gives the chunk range directly            |
+// | an edit is a component write             | an edit re-bakes its one chunk, once, in  |
+// |                                          | the next update()                         |
+//
+// Tile ids are images of a TextureArray: tile t samples layer t % layers, and kEmpty (0)
+// emits no quad (so layer 0 is never a tile). Drawn with the TILEMAP + TEXTURE_ARRAY
+// variant of vertex.glsl / fragment.glsl.
+//
+// Mode::IndexTexture keeps no meshes at all. The tile ids go to an R16UI array texture
+// (one texel per tile, one layer per tile layer) and the map is ONE quad over its whole
+// rectangle, whose fragments look their tile up (TILE_INDEX in fragment.glsl):
+//
+// | Mode         | Per frame                       | Edit                    | Hurts when      |
+// | ------------ | ------------------------------- | ----------------------- | --------------- |
+// | Chunks       | a draw per visible chunk, every | re-bake the chunk's     | zoomed out over |
+// |              | visible tile's vertices         | vertices                | a huge map      |
+// | IndexTexture | one draw; every covered pixel   | glTexSubImage3D of the  | every pixel     |
+// |              | fetches an id per tile layer    | chunk's texels          | pays the lookup |
+//
+// The cost of IndexTexture depends on the pixels covered, never on how many tiles they
+// show. The index texture is bound to kIndexTextureUnit.
+//
+// Vertex is 12 bytes instead of the 20 that float positions and UVs take (render/
+// vertex_layout.h): corners are whole tile coordinates, so two shorts hold them exactly
+// at any map position, and the shader scales them into the world with uTileGrid (origin,
+// tile size). UVs are unorm16. setUniforms() sets uTileGrid; main calls it whenever the
+// program is (re)linked. uTileIndex's unit is fragment.glsl's own (layout (binding = 1)).
+//
+// Like the other GL objects in main, a Tilemap belongs to the render side once the render
+// thread runs: edits arrive through apply(). tileAt() only reads the options, which never
+// change after init(), so the simulation may call it at any time.
+class Tilemap {
+public:
+    static constexpr int kChunkTiles = 32;
+    static constexpr int kMaxLayers = 4;
+    static constexpr std::uint16_t kEmpty = 0;
+    static constexpr GLenum kIndexTextureUnit = GL_TEXTURE0 + shaderlayout::fragment::uTileIndex.binding;
+
+    enum class Mode : std::uint8_t { Chunks, IndexTexture };
+
+    struct Options {
+        Mode mode = Mode::Chunks;
+        int width = 0;                 // in tiles
+        int height = 0;
+        int layers = 1;                // up to kMaxLayers; layer 0 is drawn first
+        float tileSize = 0.25f;        // world units per tile
+        glm::vec2 origin{0.0f};        // world position of tile (0, 0)'s lower-left corner
+    };
+
+    struct Stats {
+        std::size_t chunks = 0;
+        std::size_t draws = 0;         // by the last draw(): chunks (or the quad)
+        std::size_t drawnQuads = 0;    // ... and the tile quads in them (Chunks)
+        std::uint64_t rebuilds = 0;    // chunks baked / uploaded so far
+        std::size_t vertexBytes = 0;   // baked, in the chunks' slots (Chunks)
+    };
+
+    // Tiles per side: corner coordinates are shorts.
+    static constexpr int kMaxTiles = 32767;
+
+    struct Vertex {
+        std::int16_t x, y;             // tile grid corner: world = origin + (x, y) * tileSize
+        std::uint32_t uv;              // 2 x unorm16 (vertexpack::unorm16x2)
+        std::uint16_t layer;           // TextureArray layer
+        std::uint16_t unused;          // keeps the stride a multiple of 4
+    };
+    static_assert(sizeof(Vertex) == 12, "Tilemap::Vertex is a vertex attribute stride");
+
+    Tilemap() = default;
+    Tilemap(const Tilemap&) = delete;
+    Tilemap& operator=(const Tilemap&) = delete;
+
+    // GL thread: empty tile layers, and the shared index buffer (Chunks: no chunk has GL
+    // objects yet) or the index texture and its quad (IndexTexture).
+    // The VAOs come from `vaos`, which must outlive the map.
+    bool init(const Options& options, VertexArrayCache& vaos);
+    void shutdown();
+
+    // Out-of-range coordinates are ignored (and read as kEmpty).
+    void setTile(int layer, int x, int y, std::uint16_t tile);
+    std::uint16_t tile(int layer, int x, int y) const;
+    void apply(const TileEdit* edits, std::size_t count);
+
+    // The tile under a world position; false outside the map.
+    bool tileAt(const glm::vec2& world, int& x, int& y) const;
+
+    // GL thread: re-bakes (or re-uploads) the chunks edited since the last call, once each.
+    void update(std::uint32_t arrayLayers);
+    // GL thread: adds each non-empty chunk overlapping `view` to `draws` (the caller
+    // flushes them), or draws the one quad. The caller binds the program and texture
+    // array (DrawTilemapCommand in main).
+    void draw(const CullRect& view, MultiDraw& draws);
+
+    // GL thread: uTileGrid of a tilemap program, once after each link.
+    void setUniforms(GLuint program) const;
+
+    const Options& options() const { return options_; }
+    const Stats& stats() const { return stats_; }
+
+private:
+    struct Chunk {
+        GLsizei indexCount = 0;
+        bool dirty = false;
+    };
+
+    void bake(int chunk, std::uint32_t arrayLayers);
+    void upload(int chunk);            // IndexTexture: the chunk's texels, every layer
+    void drawChunks(const CullRect& view, MultiDraw& draws);
+
+    Options options_;
+    int chunksX_ = 0;
+    int chunksY_ = 0;
+    std::vector<std::uint16_t> tiles_; // [layer][y][x]
+    std::vector<Chunk> chunks_;        // [cy][cx]
+    std::vector<int> dirty_;           // chunks waiting for update(), each once
+    std::vector<Vertex> scratch_;      // one chunk's vertices while baking
+    GlBuffer vertices_;                // Chunks: every chunk's slot
+    std::size_t slotVertices_ = 0;
+    GLuint chunkVao_ = 0;
+    GlBuffer indices_;
+    GlTexture indexTexture_;           // IndexTexture: R16UI, width x height x layers
+    GLuint quadVao_ = 0;               // ... and the map-sized quad
+    VertexArrayCache* vaos_ = nullptr;
+    GlBuffer quadVbo_;
+    Stats stats_;
+};
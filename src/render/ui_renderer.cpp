@@ -0,0 +1,111 @@
+#include "render/ui_renderer.h"
+
+#include <iterator>
+
+namespace {
+
+// 0xAABBGGRR, as SpriteVertex colours.
+constexpr std::uint32_t kPanel = 0xD0201A18u;
+constexpr std::uint32_t kTitle = 0xF0604030u;
+constexpr std::uint32_t kControl = 0xFF403430u;
+constexpr std::uint32_t kHot = 0xFF605048u;
+constexpr std::uint32_t kActive = 0xFF806858u;
+constexpr std::uint32_t kFill = 0xFFE0A060u;
+constexpr std::uint32_t kText = 0xFFFFFFFFu;
+
+std::uint64_t mixKey(std::uint64_t key, std::uint64_t value) {
+    key = (key ^ value) * 0xff51afd7ed558ccdull;
+    return key ^ key >> 32;
+}
+
+std::uint32_t controlColor(const UiWidget& widget) {
+    return (widget.state & UiWidget::kActive) ? kActive : (widget.state & UiWidget::kHot) ? kHot : kControl;
+}
+
+} // namespace
+
+void UiRenderer::draw(SpriteBatch& batch, TextBatch& text, GLuint program, const SdfFont& font, GlyphCache& glyphs,
+                      const UiWidget* widgets, std::size_t count, const char* strings, int width, int height) {
+    ++frame_;
+    stats_ = Stats{};
+    const bool cached = glyphs.initialized();
+    const GLuint texture = cached ? glyphs.texture() : font.texture();
+    std::uint64_t source = mixKey(static_cast<std::uint64_t>(width) << 32 | static_cast<std::uint32_t>(height),
+                                  texture);
+    source = mixKey(source, cached ? glyphs.generation() : 0);
+
+    batch.begin();
+    batch.setProgram(program);
+    if (cached) {
+        text.begin(batch, glyphs, width, height);
+    } else {
+        text.begin(batch, font, width, height);
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        const UiWidget& widget = widgets[i];
+        const std::uint64_t key = mixKey(source, widget.hash);
+        Entry& entry = cache_[widget.id];
+        if (entry.key != key) {
+            entry.vertices.clear();
+            batch.record(&entry.vertices);
+            build(text, widget, strings);
+            batch.record(nullptr);
+            entry.key = key;
+            ++stats_.rebuilt;
+        }
+        entry.lastDrawn = frame_;
+        batch.submitQuads(entry.vertices.data(), entry.vertices.size() / 4, texture);
+        stats_.quads += entry.vertices.size() / 4;
+    }
+    batch.end();
+
+    if (frame_ % kKeepFrames == 0) {
+        for (auto it = cache_.begin(); it != cache_.end();) {
+            it = it->second.lastDrawn + kKeepFrames < frame_ ? cache_.erase(it) : std::next(it);
+        }
+    }
+    stats_.widgets = count;
+    stats_.cached = cache_.size();
+}
+
+// One widget's quads, in window pixels; the text row centred in the widget's.
+void UiRenderer::build(TextBatch& text, const UiWidget& widget, const char* strings) {
+    constexpr float kTextHeight = ImmediateUi::kTextHeight;
+    const char* label = strings + widget.text;
+    const float textTop = widget.min.y + 0.5f * (widget.size.y - kTextHeight);
+    switch (widget.kind) {
+        case UiKind::Panel: {
+            text.rect(widget.min, widget.size, kPanel);
+            text.rect(widget.min, glm::vec2(widget.size.x, ImmediateUi::kRowHeight), kTitle);
+            const float titleTop = widget.min.y + 0.5f * (ImmediateUi::kRowHeight - kTextHeight);
+            text.print(glm::vec2(widget.min.x + ImmediateUi::kPadding, titleTop), kTextHeight, label,
+                       widget.textLength, kText);
+            break;
+        }
+        case UiKind::Label:
+            text.print(glm::vec2(widget.min.x, textTop), kTextHeight, label, widget.textLength, kText);
+            break;
+        case UiKind::Button:
+            text.rect(widget.min, widget.size, controlColor(widget));
+            text.print(glm::vec2(widget.min.x + ImmediateUi::kPadding, textTop), kTextHeight, label,
+                       widget.textLength, kText);
+            break;
+        case UiKind::Checkbox: {
+            const float box = widget.size.y - 6.0f;
+            const glm::vec2 boxMin(widget.min.x, widget.min.y + 3.0f);
+            text.rect(boxMin, glm::vec2(box), controlColor(widget));
+            if (widget.state & UiWidget::kOn) {
+                text.rect(boxMin + 4.0f, glm::vec2(box - 8.0f), kFill);
+            }
+            text.print(glm::vec2(widget.min.x + box + ImmediateUi::kPadding, textTop), kTextHeight, label,
+                       widget.textLength, kText);
+            break;
+        }
+        case UiKind::Slider:
+            text.rect(widget.min, widget.size, controlColor(widget));
+            text.rect(widget.min, glm::vec2(widget.size.x * widget.value, widget.size.y), kFill & 0x80FFFFFFu);
+            text.print(glm::vec2(widget.min.x + ImmediateUi::kPadding, textTop), kTextHeight, label,
+                       widget.textLength, kText);
+            break;
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "render/glyph_cache.h"
+#include "render/sdf_font.h"
+#include "render/sprite_batch.h"
+#include "render/text_batch.h"
+#include "ui/immediate_ui.h"
+
+// UiRenderer
+// ----------
+// Draws a frame's UiWidgets (ui/immediate_ui.h) through the sprite batch and the HUD's
+// text path, keeping each widget's quads from frame to frame:
+//
+//     widget hash, viewport, font texture (+ GlyphCache::generation()) as last built?
+//         yes: its SpriteVertex quads copied into the batch as they are
+//         no:  rebuilt through TextBatch with SpriteBatch::record(), then copied
+//
+// Building a widget is text layout, a font lookup per character and a transform per
+// quad; replaying is one memcpy of 64 bytes per quad. Everything samples the one font
+// texture, so the whole UI is still one draw (up to SpriteBatch::kMaxSprites quads).
+//
+// Widgets not drawn for kKeepFrames frames lose their quads. GL thread only.
+class UiRenderer {
+public:
+    static constexpr std::uint64_t kKeepFrames = 120;
+
+    struct Stats {
+        std::size_t widgets = 0;       // last draw()
+        std::size_t rebuilt = 0;       // ... of them built again
+        std::size_t quads = 0;
+        std::size_t cached = 0;        // widgets with quads kept
+    };
+
+    // `font` unless `glyphs` is initialized (--font). Leaves the batch ended.
+    void draw(SpriteBatch& batch, TextBatch& text, GLuint program, const SdfFont& font, GlyphCache& glyphs,
+              const UiWidget* widgets, std::size_t count, const char* strings, int width, int height);
+    void clear() { cache_.clear(); }
+    const Stats& stats() const { return stats_; }
+
+private:
+    struct Entry {
+        std::uint64_t key = 0;         // the widget's hash with everything else it was built from
+        std::uint64_t lastDrawn = 0;
+        std::vector<SpriteVertex> vertices;
+    };
+
+    static void build(TextBatch& text, const UiWidget& widget, const char* strings);
+
+    std::unordered_map<std::uint32_t, Entry> cache_;   // widget id → its quads
+    std::uint64_t frame_ = 0;
+    Stats stats_;
+};
@@ -0,0 +1,100 @@
+#include "render/vertex_array_cache.h"
+
+#include <algorithm>
+#include <ostream>
+
+#include "render/gl_buffer.h"
+#include "render/gl_ext.h"
+#include "render/gl_state.h"
+
+GLuint VertexArrayCache::get(std::initializer_list<VertexStream> streams, GLuint indexBuffer) {
+    if (streams.size() > static_cast<std::size_t>(kMaxStreams)) {
+        return 0;
+    }
+    const std::uint64_t hash = hashOf(streams, indexBuffer);
+    for (const Entry& e : entries_) {
+        if (e.hash == hash && matches(e, streams, indexBuffer)) {
+            ++stats_.hits;
+            return e.vao.get();
+        }
+    }
+
+    Entry entry;
+    entry.hash = hash;
+    entry.indexBuffer = indexBuffer;
+    entry.vao = GlVertexArray::create();
+    if (glbuffer::direct()) {
+        // By name: no VAO or buffer binding changes hands.
+        glext::vertexArrayElementBuffer(entry.vao.get(), indexBuffer);
+        for (const VertexStream& s : streams) {
+            s.layout->enableOn(entry.vao.get(), s.buffer, s.offset);
+            entry.streams[entry.streamCount++] = Binding{*s.layout, s.buffer, s.offset};
+        }
+    } else {
+        glstate::bindVertexArray(entry.vao.get());
+        glstate::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer); // recorded into the VAO
+        for (const VertexStream& s : streams) {
+            glstate::bindBuffer(GL_ARRAY_BUFFER, s.buffer);
+            s.layout->enable(s.offset);
+            entry.streams[entry.streamCount++] = Binding{*s.layout, s.buffer, s.offset};
+        }
+        glstate::bindVertexArray(0);
+    }
+    const GLuint name = entry.vao.get();
+    entries_.push_back(std::move(entry));
+    ++stats_.created;
+    stats_.vaos = entries_.size();
+    return name;
+}
+
+void VertexArrayCache::forget(GLuint buffer) {
+    if (buffer == 0) {
+        return;
+    }
+    auto reads = [buffer](const Entry& e) {
+        if (e.indexBuffer == buffer) {
+            return true;
+        }
+        for (int i = 0; i < e.streamCount; ++i) {
+            if (e.streams[i].buffer == buffer) {
+                return true;
+            }
+        }
+        return false;
+    };
+    entries_.erase(std::remove_if(entries_.begin(), entries_.end(), reads), entries_.end());
+    stats_.vaos = entries_.size();
+}
+
+void VertexArrayCache::shutdown() {
+    entries_.clear();                  // handles queue their names (render/gl_resource.h)
+    stats_ = Stats{};
+}
+
+void VertexArrayCache::report(std::ostream& out) const {
+    out << "VAO cache: " << stats_.vaos << " VAOs, " << stats_.created << " created, " << stats_.hits << " hits\n";
+}
+
+std::uint64_t VertexArrayCache::hashOf(std::initializer_list<VertexStream> streams, GLuint indexBuffer) {
+    std::uint64_t h = indexBuffer;
+    for (const VertexStream& s : streams) {
+        h = h * 1099511628211ull ^ s.layout->hash();
+        h = h * 1099511628211ull ^ s.buffer;
+        h = h * 1099511628211ull ^ static_cast<std::uint64_t>(s.offset);
+    }
+    return h;
+}
+
+bool VertexArrayCache::matches(const Entry& entry, std::initializer_list<VertexStream> streams, GLuint indexBuffer) {
+    if (entry.indexBuffer != indexBuffer || entry.streamCount != static_cast<int>(streams.size())) {
+        return false;
+    }
+    int i = 0;
+    for (const VertexStream& s : streams) {
+        const Binding& b = entry.streams[i++];
+        if (b.buffer != s.buffer || b.offset != s.offset || b.layout != *s.layout) {
+            return false;
+        }
+    }
+    return true;
+}
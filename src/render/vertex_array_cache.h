@@ -0,0 +1,99 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iosfwd>
+#include <vector>
+
+#include "render/gl_resource.h"
+#include "render/vertex_layout.h"
+
+// VertexStream
+// ------------
+// One vertex buffer as a VAO reads it: its layout (divisors included) and where in the
+// buffer the first vertex is.
+struct VertexStream {
+    const VertexLayout* layout = nullptr;
+    GLuint buffer = 0;
+    GLintptr offset = 0;
+};
+
+// VertexArrayCache
+// ----------------
+// A VAO is nothing but (attribute formats, the buffers they read, the index buffer), so
+// two draws with the same of all three can share one. The cache keeps one per distinct
+// combination and creates it on first use:
+//
+//     GLuint vao = vaos.get({{&kQuadLayout, quadVbo}, {&kInstanceLayout, instances}}, quadEbo);
+//     ...
+//     glstate::bindVertexArray(vao);     // switching meshes: one bind, nothing re-specified
+//
+// | Per draw                                 | Hand-built VAOs      | VertexArrayCache      |
+// | ---------------------------------------- | -------------------- | --------------------- |
+// | switch geometry                          | one bind             | one bind              |
+// | a second user of the same buffers        | a second VAO, set up | the same VAO          |
+// |                                          | attribute by attrib. |                       |
+// | a new geometry type                      | glVertexAttrib* code | a VertexLayout        |
+//
+// Layouts are compared by value (VertexLayout::operator==), so two modules declaring the
+// same format for the same buffer share a VAO. get() is a lookup, not a per-draw call:
+// callers keep the name it returns.
+//
+// Only for buffers whose offsets are fixed. Streams that move their attribute pointers
+// every frame (StreamBuffer users: InstancedQuadRenderer, SpriteBatch, DebugDrawRenderer)
+// rewrite their VAO's state and keep their own.
+//
+// A VAO holds on to its buffers' storage, and a buffer name may be reused once it is
+// deleted: whoever deletes a buffer calls forget(buffer) first, which drops every VAO
+// that reads it (deferred, like every GL name: render/gl_resource.h).
+class VertexArrayCache {
+public:
+    static constexpr int kMaxStreams = 4;
+
+    struct Stats {
+        std::size_t vaos = 0;          // alive
+        std::uint64_t hits = 0;        // get() answered with an existing VAO
+        std::uint64_t created = 0;
+    };
+
+    VertexArrayCache() = default;
+    VertexArrayCache(const VertexArrayCache&) = delete;
+    VertexArrayCache& operator=(const VertexArrayCache&) = delete;
+
+    // GL thread. The VAO reading `streams` (at most kMaxStreams) with `indexBuffer` as its
+    // GL_ELEMENT_ARRAY_BUFFER (0: none); 0 if there are too many streams. When it has to
+    // create one it leaves VAO 0 bound—or, with direct state access (render/gl_buffer.h),
+    // builds it by name and leaves every binding alone.
+    GLuint get(std::initializer_list<VertexStream> streams, GLuint indexBuffer = 0);
+
+    // Drops the VAOs that read `buffer` (as vertices or indices).
+    void forget(GLuint buffer);
+    void shutdown();
+
+    const Stats& stats() const { return stats_; }
+    // "VAO cache: 6 VAOs, 4 created, 11 hits".
+    void report(std::ostream& out) const;
+
+private:
+    struct Binding {
+        VertexLayout layout{0, {}};
+        GLuint buffer = 0;
+        GLintptr offset = 0;
+    };
+
+    struct Entry {
+        std::uint64_t hash = 0;
+        Binding streams[kMaxStreams];
+        int streamCount = 0;
+        GLuint indexBuffer = 0;
+        GlVertexArray vao;
+    };
+
+    static std::uint64_t hashOf(std::initializer_list<VertexStream> streams, GLuint indexBuffer);
+    static bool matches(const Entry& entry, std::initializer_list<VertexStream> streams, GLuint indexBuffer);
+
+    std::vector<Entry> entries_;
+    Stats stats_;
+};
@@ -0,0 +1,81 @@
+#include "render/vertex_layout.h"
+
+#include "render/gl_ext.h"
+
+VertexLayout::VertexLayout(GLsizei stride, std::initializer_list<VertexAttribute> attributes) : stride_(stride) {
+    for (const VertexAttribute& a : attributes) {
+        if (count_ < kMaxAttributes) {
+            attributes_[count_++] = a;
+        }
+    }
+}
+
+void VertexLayout::enable(GLintptr base, GLuint divisor) const {
+    for (int i = 0; i < count_; ++i) {
+        glEnableVertexAttribArray(attributes_[i].location);
+        glVertexAttribDivisor(attributes_[i].location, divisor != 0 ? divisor : attributes_[i].divisor);
+    }
+    pointers(base);
+}
+
+void VertexLayout::pointers(GLintptr base) const {
+    for (int i = 0; i < count_; ++i) {
+        const VertexAttribute& a = attributes_[i];
+        const void* at = reinterpret_cast<const void*>(base + static_cast<GLintptr>(a.offset));
+        if (a.kind == VertexAttribute::Kind::Integer) {
+            glVertexAttribIPointer(a.location, a.components, a.type, stride_, at);
+        } else {
+            glVertexAttribPointer(a.location, a.components, a.type,
+                                  a.kind == VertexAttribute::Kind::Normalized ? GL_TRUE : GL_FALSE, stride_, at);
+        }
+    }
+}
+
+void VertexLayout::enableOn(GLuint vao, GLuint buffer, GLintptr base, GLuint divisor) const {
+    for (int i = 0; i < count_; ++i) {
+        const VertexAttribute& a = attributes_[i];
+        const GLuint offset = static_cast<GLuint>(a.offset);
+        glext::enableVertexArrayAttrib(vao, a.location);
+        if (a.kind == VertexAttribute::Kind::Integer) {
+            glext::vertexArrayAttribIFormat(vao, a.location, a.components, a.type, offset);
+        } else {
+            glext::vertexArrayAttribFormat(vao, a.location, a.components, a.type,
+                                           a.kind == VertexAttribute::Kind::Normalized ? GL_TRUE : GL_FALSE, offset);
+        }
+        glext::vertexArrayAttribBinding(vao, a.location, a.location);
+        glext::vertexArrayVertexBuffer(vao, a.location, buffer, base, stride_);
+        glext::vertexArrayBindingDivisor(vao, a.location, divisor != 0 ? divisor : a.divisor);
+    }
+}
+
+bool VertexLayout::operator==(const VertexLayout& o) const {
+    if (stride_ != o.stride_ || count_ != o.count_) {
+        return false;
+    }
+    for (int i = 0; i < count_; ++i) {
+        if (!(attributes_[i] == o.attributes_[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::uint64_t VertexLayout::hash() const {
+    // FNV-1a over the fields (not the bytes: the struct has padding).
+    std::uint64_t h = 14695981039346656037ull;
+    auto mix = [&h](std::uint64_t v) {
+        h ^= v;
+        h *= 1099511628211ull;
+    };
+    mix(static_cast<std::uint64_t>(stride_));
+    for (int i = 0; i < count_; ++i) {
+        const VertexAttribute& a = attributes_[i];
+        mix(a.location);
+        mix(static_cast<std::uint64_t>(a.components));
+        mix(a.type);
+        mix(static_cast<std::uint64_t>(a.kind));
+        mix(a.offset);
+        mix(a.divisor);
+    }
+    return h;
+}
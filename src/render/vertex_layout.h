@@ -0,0 +1,135 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+
+#include "render/shader_layout.h"
+
+// Vertex formats
+// --------------
+// Vertex bandwidth is bytes per vertex times vertices per frame (and, for static meshes
+// like the tilemap's chunks, GPU memory). A 2D position or UV rarely needs 32-bit floats:
+//
+// | Format            | GL type / normalized              | Bytes | Good for                  |
+// | ----------------- | --------------------------------- | ----- | ------------------------- |
+// | 2 x float         | GL_FLOAT                          | 8     | world positions           |
+// | 2 x half          | GL_HALF_FLOAT (packHalf2x16)      | 4     | small local offsets,      |
+// |                   |                                   |       | screen space              |
+// | 2 x unorm16       | GL_UNSIGNED_SHORT, normalized     | 4     | UVs in [0, 1]             |
+// | 2 x short         | GL_SHORT, NOT normalized: arrives | 4     | grid positions (tiles)    |
+// |                   | as the integer value, as a float  |       |                           |
+// | 4 x unorm8        | GL_UNSIGNED_BYTE, normalized      | 4     | colours (packColor)       |
+// | 10_10_10_2        | GL_UNSIGNED_INT_2_10_10_10_REV /  | 4     | normals, HDR-ish colours  |
+// |                   | GL_INT_..., normalized            |       | (packSnorm3x10_1x2)       |
+// | uint / ushort     | glVertexAttribIPointer            | 4 / 2 | array layers, ids         |
+//
+// The shader side never changes with the format: a `vec2` input reads any of the float
+// formats; only integer inputs (uint, ivec) need the I variant.
+//
+// VertexLayout describes one buffer's interleaved layout once, so the code that sets the
+// attribute pointers can't disagree with the struct:
+//
+//     namespace input = shaderlayout::vertex;    // the shader's inputs, generated
+//     static const VertexLayout kLayout(sizeof(Vertex), {
+//         shaderInput(input::aPos, 2, GL_SHORT, VertexAttribute::Kind::Float, offsetof(Vertex, x)),
+//         shaderInput(input::aUV, 2, GL_UNSIGNED_SHORT, VertexAttribute::Kind::Normalized, offsetof(Vertex, u)),
+//     });
+//     kLayout.enable();            // once, into the bound VAO
+//     kLayout.pointers(offset);    // whenever the buffer offset changes (streams)
+//
+// Buffers whose offset never changes don't need a VAO of their own at all:
+// VertexArrayCache (render/vertex_array_cache.h) hands out one per (layouts, buffers).
+struct VertexAttribute {
+    enum class Kind : std::uint8_t {
+        Float,          // converted to float as is (GL_FALSE)
+        Normalized,     // integer types scaled to [0, 1] / [-1, 1] (GL_TRUE)
+        Integer,        // glVertexAttribIPointer: stays an integer in the shader
+    };
+
+    GLuint location;
+    GLint components;
+    GLenum type;
+    Kind kind;
+    std::size_t offset;             // within one vertex
+    GLuint divisor = 0;             // 0: per vertex, 1: per instance, n: per n instances
+
+    bool operator==(const VertexAttribute& o) const {
+        return location == o.location && components == o.components && type == o.type && kind == o.kind &&
+               offset == o.offset && divisor == o.divisor;
+    }
+};
+
+// An attribute that feeds one of a shader's inputs (render/shader_layout.h): the location
+// is the GLSL's `layout (location = N)`, and it must be evaluated at compile time, so
+// these fail the BUILD instead of drawing garbage:
+//
+// | Mismatch                                        | Why                                   |
+// | ----------------------------------------------- | ------------------------------------- |
+// | more components than the input has              | the rest would land in another input  |
+// | Kind::Integer for a float input, or the reverse | glVertexAttribIPointer vs Pointer: an |
+// |                                                 | int read as float bits is undefined   |
+// | a matrix input                                  | it spans several locations: one       |
+// |                                                 | VertexAttribute per column            |
+//
+// Fewer components are fine: GL fills the rest in with (0, 0, 0, 1).
+consteval VertexAttribute shaderInput(const shaderlayout::Attribute& input, GLint components, GLenum type,
+                                      VertexAttribute::Kind kind, std::size_t offset, GLuint divisor = 0) {
+    if (components < 1 || components > input.components) {
+        throw "shaderInput: more components than the shader's input has";
+    }
+    if ((kind == VertexAttribute::Kind::Integer) != input.integer) {
+        throw "shaderInput: integer inputs need Kind::Integer, float ones Float or Normalized";
+    }
+    if (input.locations != 1) {
+        throw "shaderInput: a matrix input takes one attribute per column";
+    }
+    return VertexAttribute{input.location, components, type, kind, offset, divisor};
+}
+
+class VertexLayout {
+public:
+    static constexpr int kMaxAttributes = 8;
+
+    VertexLayout(GLsizei stride, std::initializer_list<VertexAttribute> attributes);
+
+    // Into the bound VAO: enables every location, sets its divisor (`divisor`, when not 0,
+    // overrides the attributes' own) and points them at the bound GL_ARRAY_BUFFER from
+    // `base` on.
+    void enable(GLintptr base = 0, GLuint divisor = 0) const;
+    // The pointers alone, e.g. at a stream buffer's new offset each frame.
+    void pointers(GLintptr base) const;
+    // enable() by name, with direct state access (glext::caps().directStateAccess): into
+    // `vao`, reading `buffer` from `base` on, nothing bound. Each attribute gets the
+    // buffer binding point of its own location, so divisors stay per attribute.
+    void enableOn(GLuint vao, GLuint buffer, GLintptr base = 0, GLuint divisor = 0) const;
+
+    GLsizei stride() const { return stride_; }
+    int count() const { return count_; }
+    const VertexAttribute& attribute(int i) const { return attributes_[i]; }
+
+    // Same stride and attributes, in the same order.
+    bool operator==(const VertexLayout& o) const;
+    bool operator!=(const VertexLayout& o) const { return !(*this == o); }
+    std::uint64_t hash() const;
+
+private:
+    GLsizei stride_ = 0;
+    int count_ = 0;
+    VertexAttribute attributes_[kMaxAttributes] = {};
+};
+
+// Packing helpers for the formats above (GLM does the bit work).
+namespace vertexpack {
+
+// Two floats in [0, 1] → two unorm16, as one uint32 (x in the low half).
+inline std::uint32_t unorm16x2(const glm::vec2& v) { return glm::packUnorm2x16(v); }
+// Two floats → two IEEE half floats (x in the low half). ~3 significant digits.
+inline std::uint32_t half2(const glm::vec2& v) { return glm::packHalf2x16(v); }
+// xyz in [-1, 1] → 10 bits each, w in {-1, 0, 1} → 2 bits (GL_INT_2_10_10_10_REV).
+inline std::uint32_t snorm10x3_2(const glm::vec4& v) { return glm::packSnorm3x10_1x2(v); }
+
+} // namespace vertexpack
@@ -0,0 +1,519 @@
+#include "render/virtual_texture.h"
+
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#include "profile/trace.h"
+#include "render/gl_buffer.h"
+#include "render/gl_state.h"
+#include "render/gl_stall.h"
+#include "render/gpu_memory.h"
+#include "render/shader_layout.h"
+#include "render/vertex_array_cache.h"
+#include "render/vertex_layout.h"
+
+namespace {
+
+// The image's quad: corners on the level 0 page grid (placed by uTileGrid, as a tilemap's
+// are) and the virtual UV, 0..1 over the whole image.
+struct QuadVertex {
+    std::int16_t x, y;
+    std::uint32_t uv;                  // 2 x unorm16
+};
+
+// Same locations as vertex.glsl TILEMAP: aPos (0), aUV (1).
+namespace input = shaderlayout::vertex;     // TILEMAP VIRTUAL_TEXTURE
+
+const VertexLayout kVertexLayout(sizeof(QuadVertex), {
+    shaderInput(input::aPos, 2, GL_SHORT, VertexAttribute::Kind::Float, offsetof(QuadVertex, x)),
+    shaderInput(input::aUV, 2, GL_UNSIGNED_SHORT, VertexAttribute::Kind::Normalized, offsetof(QuadVertex, uv)),
+});
+
+constexpr GLsizeiptr kPageBytes = VirtualTexture::kSlotSize * VirtualTexture::kSlotSize * sizeof(std::uint32_t);
+constexpr std::uint32_t kFeedbackValid = 1u << 31;
+
+bool powerOfTwo(int n) {
+    return n > 0 && (n & (n - 1)) == 0;
+}
+
+} // namespace
+
+bool VirtualTexture::init(const Options& options, PageSource source, VertexArrayCache& vaos) {
+    const gpumemory::Owner owner("virtual texture");
+    shutdown();
+    if (!powerOfTwo(options.pagesX) || !powerOfTwo(options.pagesY) || !source) {
+        std::cerr << "VirtualTexture: " << options.pagesX << "x" << options.pagesY
+                  << " pages: needs powers of two and a page source\n";
+        return false;
+    }
+    levels_ = 1;
+    while ((std::max(options.pagesX, options.pagesY) >> (levels_ - 1)) > 1) {
+        ++levels_;
+    }
+    if (levels_ > kMaxLevels) {
+        std::cerr << "VirtualTexture: more than " << (1 << (kMaxLevels - 1)) << " pages per side\n";
+        return false;
+    }
+    options_ = options;
+    GLint maxSize = 4096;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+    options_.cacheSlots = std::max(2, std::min({options.cacheSlots, 256, static_cast<int>(maxSize) / kSlotSize}));
+    options_.uploadsPerFrame = std::max(1, options.uploadsPerFrame);
+    source_ = std::move(source);
+
+    // The cache: one level, filtered bilinearly inside a slot (the apron covers the edge).
+    const int cacheTexels = options_.cacheSlots * kSlotSize;
+    physical_ = GlTexture::create();
+    glstate::bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glstate::activeTexture(GL_TEXTURE0);
+    glstate::bindTexture(GL_TEXTURE_2D, physical_.get());
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, cacheTexels, cacheTexels, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    gpumemory::track(GlObject::Texture, physical_.get(), gpumemory::textureBytes(GL_RGBA8, cacheTexels, cacheTexels),
+                     gpumemory::Category::Texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+
+    // The page table: integer texels, a mip level per image level, read with texelFetch.
+    pageTable_ = GlTexture::create();
+    glstate::activeTexture(kPageTableUnit);
+    glstate::bindTexture(GL_TEXTURE_2D, pageTable_.get());
+    table_.resize(static_cast<std::size_t>(levels_));
+    for (int level = 0; level < levels_; ++level) {
+        table_[level].assign(static_cast<std::size_t>(pagesX(level)) * pagesY(level), 0u);
+        glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8UI, pagesX(level), pagesY(level), 0, GL_RGBA_INTEGER,
+                     GL_UNSIGNED_BYTE, nullptr);
+    }
+    gpumemory::track(GlObject::Texture, pageTable_.get(),
+                     gpumemory::textureBytes(GL_RGBA8UI, pagesX(0), pagesY(0), 1, levels_), gpumemory::Category::Texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels_ - 1);
+    glstate::activeTexture(GL_TEXTURE0);
+    tableDirty_ = true;
+
+    slots_.assign(static_cast<std::size_t>(options_.cacheSlots) * options_.cacheSlots, Slot{});
+    freeSlots_.clear();
+    for (int s = static_cast<int>(slots_.size()) - 1; s >= 0; --s) {
+        freeSlots_.push_back(s);
+    }
+    if (!staging_.init(GL_PIXEL_UNPACK_BUFFER, kPageBytes * options_.uploadsPerFrame)) {
+        std::cerr << "VirtualTexture: no page upload ring\n";
+        shutdown();
+        return false;
+    }
+
+    const QuadVertex quad[4] = {
+        {0, 0, vertexpack::unorm16x2(glm::vec2(0.0f, 0.0f))},
+        {static_cast<std::int16_t>(options.pagesX), 0, vertexpack::unorm16x2(glm::vec2(1.0f, 0.0f))},
+        {static_cast<std::int16_t>(options.pagesX), static_cast<std::int16_t>(options.pagesY),
+         vertexpack::unorm16x2(glm::vec2(1.0f, 1.0f))},
+        {0, static_cast<std::int16_t>(options.pagesY), vertexpack::unorm16x2(glm::vec2(0.0f, 1.0f))},
+    };
+    const std::uint16_t indices[6] = {0, 1, 2, 2, 3, 0};
+    quadVbo_ = GlBuffer::create();
+    glbuffer::data(GL_ARRAY_BUFFER, quadVbo_.get(), sizeof(quad), quad, GL_STATIC_DRAW);
+    quadEbo_ = GlBuffer::create();
+    glbuffer::data(GL_ELEMENT_ARRAY_BUFFER, quadEbo_.get(), sizeof(indices), indices, GL_STATIC_DRAW);
+    vaos_ = &vaos;
+    quadVao_ = vaos.get({{&kVertexLayout, quadVbo_.get()}}, quadEbo_.get());
+
+    // The top level's one page first: from then on every pixel has something to show.
+    stopping_ = false;
+    queue_.push_back(key(levels_ - 1, 0, 0));
+    for (int i = 0; i < std::max(1, options.loadThreads); ++i) {
+        threads_.emplace_back(&VirtualTexture::loadLoop, this);
+    }
+    return true;
+}
+
+void VirtualTexture::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        queue_.clear();
+    }
+    wake_.notify_all();
+    for (std::thread& t : threads_) {
+        t.join();
+    }
+    threads_.clear();
+    loading_.clear();
+    loaded_.clear();
+    incoming_.clear();
+
+    for (Readback& readback : readbacks_) {
+        if (readback.fence) {
+            glDeleteSync(readback.fence);
+        }
+        readback = Readback{};
+    }
+    nextReadback_ = 0;
+    feedbackTarget_.shutdown();
+    if (vaos_ != nullptr) {
+        vaos_->forget(quadVbo_.get());
+    }
+    vaos_ = nullptr;
+    quadVao_ = 0;
+    quadVbo_.reset();                  // handles queue their names (render/gl_resource.h)
+    quadEbo_.reset();
+    physical_.reset();
+    pageTable_.reset();
+    staging_.shutdown();
+    slots_.clear();
+    freeSlots_.clear();
+    resident_.clear();
+    table_.clear();
+    wanted_.clear();
+    levels_ = 0;
+    feedbacks_ = 0;
+    loads_ = 0;
+    stats_ = Stats{};
+}
+
+void VirtualTexture::setUniforms(GLuint program, bool feedback) const {
+    glstate::useProgram(program);
+    const GLint grid = glGetUniformLocation(program, shaderlayout::vertex::uTileGrid.name);
+    if (grid >= 0) {
+        glUniform3f(grid, options_.origin.x, options_.origin.y, options_.pageWorldSize);
+    }
+    // The feedback target has 1/kFeedbackDivisor of the pixels per side: its derivatives
+    // are that much larger, so its level is biased back to what the window samples.
+    const GLint image = glGetUniformLocation(program, shaderlayout::fragment::uVirtual.name);
+    if (image >= 0) {
+        glUniform4f(image, static_cast<float>(options_.pagesX * kPageSize),
+                    static_cast<float>(options_.pagesY * kPageSize), static_cast<float>(levels_ - 1),
+                    feedback ? -std::log2(static_cast<float>(kFeedbackDivisor)) : 0.0f);
+    }
+    const GLint layout = glGetUniformLocation(program, shaderlayout::fragment::uPhysicalLayout.name);
+    if (layout >= 0) {
+        glUniform4f(layout, static_cast<float>(kPageSize), static_cast<float>(kBorder), static_cast<float>(kSlotSize),
+                    static_cast<float>(options_.cacheSlots * kSlotSize));
+    }
+}
+
+void VirtualTexture::loadLoop() {
+    trace::setThreadName("virtual texture");
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        wake_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+        if (stopping_) {
+            return;
+        }
+        const std::uint32_t page = queue_.front();
+        queue_.pop_front();
+        loading_.push_back(page);
+        lock.unlock();
+
+        LoadedPage loaded{page, std::vector<std::uint32_t>(static_cast<std::size_t>(kSlotSize) * kSlotSize)};
+        {
+            trace::Scope scope("virtual texture page");
+            source_(levelOf(page), xOf(page) * kPageSize - kBorder, yOf(page) * kPageSize - kBorder,
+                    loaded.texels.data());
+        }
+
+        lock.lock();
+        loading_.erase(std::find(loading_.begin(), loading_.end(), page));
+        loaded_.push_back(std::move(loaded));
+        ++loads_;
+    }
+}
+
+void VirtualTexture::update() {
+    const gpumemory::Owner owner("virtual texture");
+    if (!initialized()) {
+        return;
+    }
+    // The oldest readback, if it has arrived (they complete in order).
+    for (int i = 0; i < static_cast<int>(std::size(readbacks_)); ++i) {
+        Readback& readback = readbacks_[(nextReadback_ + i) % std::size(readbacks_)];
+        if (!readback.fence) {
+            continue;
+        }
+        if (glClientWaitSync(readback.fence, 0, 0) != GL_TIMEOUT_EXPIRED) {
+            readFeedback(readback);
+        }
+        break;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (LoadedPage& page : loaded_) {
+            incoming_.push_back(std::move(page));
+        }
+        loaded_.clear();
+    }
+    uploadPages();
+    if (tableDirty_) {
+        rebuildPageTable();
+    }
+}
+
+void VirtualTexture::feedback(GLuint program, int viewWidth, int viewHeight) {
+    if (!initialized()) {
+        return;
+    }
+    const int width = std::max(1, viewWidth / kFeedbackDivisor);
+    const int height = std::max(1, viewHeight / kFeedbackDivisor);
+    Readback& readback = readbacks_[nextReadback_];
+    if (readback.fence) {
+        return;                        // all three still in flight: skip one, never wait
+    }
+    if (feedbackTarget_.framebuffer() == 0) {
+        RenderTargetDesc desc;
+        desc.width = width;
+        desc.height = height;
+        desc.colorFormat = GL_R32UI;
+        if (!feedbackTarget_.init(desc)) {
+            return;
+        }
+    } else if (!feedbackTarget_.resize(width, height)) {
+        return;
+    }
+    nextReadback_ = (nextReadback_ + 1) % static_cast<int>(std::size(readbacks_));
+
+    feedbackTarget_.bind();
+    const GLuint nothing[4] = {0u, 0u, 0u, 0u};
+    glClearBufferuiv(GL_COLOR, 0, nothing);
+    glstate::useProgram(program);
+    glstate::disable(GL_BLEND);        // page ids don't blend
+    glstate::disable(GL_DEPTH_TEST);
+    glstate::bindVertexArray(quadVao_);
+    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, nullptr);
+
+    const GLsizeiptr bytes = static_cast<GLsizeiptr>(width) * height * sizeof(std::uint32_t);
+    if (readback.buffer.get() == 0 || readback.width != width || readback.height != height) {
+        readback.buffer = GlBuffer::create();
+        glstate::bindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer.get());
+        glBufferData(GL_PIXEL_PACK_BUFFER, bytes, nullptr, GL_STREAM_READ);
+        gpumemory::trackBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer.get(), static_cast<std::size_t>(bytes));
+        readback.width = width;
+        readback.height = height;
+    }
+    glstate::bindFramebuffer(GL_READ_FRAMEBUFFER, feedbackTarget_.framebuffer());
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glstate::bindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer.get());
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    {
+        const glstall::Wait wait("virtual texture readback");
+        glReadPixels(0, 0, width, height, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+    }
+    glstate::bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+// The feedback's pages and their ancestors become this round's wanted list, coarse
+// first; the loaders' queue is replaced by the ones not in the cache or on their way.
+void VirtualTexture::readFeedback(Readback& readback) {
+    glDeleteSync(readback.fence);
+    readback.fence = nullptr;
+    const std::size_t pixels = static_cast<std::size_t>(readback.width) * readback.height;
+    feedbackPixels_.resize(pixels);
+    glstate::bindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer.get());
+    const void* mapped = nullptr;
+    {
+        const glstall::Wait wait("virtual texture map");
+        mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(pixels * sizeof(std::uint32_t)),
+                                  GL_MAP_READ_BIT);
+    }
+    if (!mapped) {
+        glstate::bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        return;
+    }
+    std::memcpy(feedbackPixels_.data(), mapped, pixels * sizeof(std::uint32_t));
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glstate::bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    ++feedbacks_;
+    ++stats_.feedbacks;
+
+    std::sort(feedbackPixels_.begin(), feedbackPixels_.end());
+    feedbackPixels_.erase(std::unique(feedbackPixels_.begin(), feedbackPixels_.end()), feedbackPixels_.end());
+    wanted_.clear();
+    for (std::uint32_t pixel : feedbackPixels_) {
+        if (pixel & kFeedbackValid) {
+            want(pixel & ~kFeedbackValid);
+        }
+    }
+    // Keys sort by level first: descending is coarse to fine.
+    std::sort(wanted_.begin(), wanted_.end(), [](std::uint32_t a, std::uint32_t b) { return a > b; });
+    wanted_.erase(std::unique(wanted_.begin(), wanted_.end()), wanted_.end());
+    for (std::uint32_t page : wanted_) {
+        const auto found = resident_.find(page);
+        if (found != resident_.end()) {
+            slots_[found->second].lastWanted = feedbacks_;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.clear();
+        for (std::uint32_t page : wanted_) {
+            const bool onItsWay =
+                std::find(loading_.begin(), loading_.end(), page) != loading_.end() ||
+                std::find_if(incoming_.begin(), incoming_.end(),
+                             [page](const LoadedPage& p) { return p.page == page; }) != incoming_.end();
+            if (resident_.count(page) == 0 && !onItsWay) {
+                queue_.push_back(page);
+            }
+        }
+    }
+    wake_.notify_all();
+}
+
+// The page and every level above it: a page's ancestors are its fallback while it loads.
+void VirtualTexture::want(std::uint32_t page) {
+    const int level = levelOf(page);
+    const int x = xOf(page), y = yOf(page);
+    if (level >= levels_ || x >= pagesX(level) || y >= pagesY(level)) {
+        return;
+    }
+    for (int l = level; l < levels_; ++l) {
+        wanted_.push_back(key(l, x >> (l - level), y >> (l - level)));
+    }
+}
+
+// Loaded pages into cache slots, at most uploadsPerFrame of them, through the PBO ring.
+void VirtualTexture::uploadPages() {
+    std::size_t used = 0;
+    int budget = options_.uploadsPerFrame;
+    while (used < incoming_.size() && budget > 0) {
+        const LoadedPage& page = incoming_[used];
+        if (resident_.count(page.page) != 0) {
+            ++used;
+            continue;
+        }
+        StreamAllocation staging = staging_.allocate(kPageBytes, 4);
+        if (!staging.valid()) {
+            break;
+        }
+        const int slot = takeSlot();
+        if (slot < 0) {
+            ++stats_.dropped;          // everything in the cache is on screen: asked again later
+            ++used;
+            continue;
+        }
+        std::memcpy(staging.ptr, page.texels.data(), kPageBytes);
+        staging_.commit(staging);
+        glstate::bindBuffer(GL_PIXEL_UNPACK_BUFFER, staging_.buffer());
+        glstate::activeTexture(GL_TEXTURE0);
+        glstate::bindTexture(GL_TEXTURE_2D, physical_.get());
+        glTexSubImage2D(GL_TEXTURE_2D, 0, slot % options_.cacheSlots * kSlotSize, slot / options_.cacheSlots * kSlotSize,
+                        kSlotSize, kSlotSize, GL_RGBA, GL_UNSIGNED_BYTE, reinterpret_cast<const void*>(staging.offset));
+        slots_[slot] = Slot{page.page, feedbacks_};
+        resident_[page.page] = slot;
+        tableDirty_ = true;
+        ++stats_.uploads;
+        --budget;
+        ++used;
+    }
+    glstate::bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    incoming_.erase(incoming_.begin(), incoming_.begin() + static_cast<std::ptrdiff_t>(used));
+    staging_.endFrame();
+}
+
+// A free slot, or the one wanted longest ago. Never one the latest feedback named, nor
+// the top level's page. -1: none to spare.
+int VirtualTexture::takeSlot() {
+    if (!freeSlots_.empty()) {
+        const int slot = freeSlots_.back();
+        freeSlots_.pop_back();
+        return slot;
+    }
+    int oldest = -1;
+    for (int s = 0; s < static_cast<int>(slots_.size()); ++s) {
+        const Slot& slot = slots_[s];
+        if (slot.lastWanted >= feedbacks_ || levelOf(slot.page) == levels_ - 1) {
+            continue;
+        }
+        if (oldest < 0 || slot.lastWanted < slots_[oldest].lastWanted) {
+            oldest = s;
+        }
+    }
+    if (oldest >= 0) {
+        resident_.erase(slots_[oldest].page);
+        ++stats_.evictions;
+        tableDirty_ = true;
+    }
+    return oldest;
+}
+
+// Every level from the top down: a resident page points at its slot, any other at what
+// the page above it points at. Then all levels go up in one go.
+void VirtualTexture::rebuildPageTable() {
+    tableDirty_ = false;
+    for (int level = levels_ - 1; level >= 0; --level) {
+        std::vector<std::uint32_t>& entries = table_[level];
+        const int width = pagesX(level), height = pagesY(level);
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                std::uint32_t entry = 0;
+                const auto found = resident_.find(key(level, x, y));
+                if (found != resident_.end()) {
+                    const std::uint32_t slot = static_cast<std::uint32_t>(found->second);
+                    const std::uint32_t slots = static_cast<std::uint32_t>(options_.cacheSlots);
+                    entry = slot % slots | (slot / slots) << 8 | static_cast<std::uint32_t>(level) << 16 | 1u << 24;
+                } else if (level + 1 < levels_) {
+                    entry = table_[level + 1][static_cast<std::size_t>(y >> 1) * pagesX(level + 1) + (x >> 1)];
+                }
+                entries[static_cast<std::size_t>(y) * width + x] = entry;
+            }
+        }
+    }
+    glstate::bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glstate::activeTexture(kPageTableUnit);
+    glstate::bindTexture(GL_TEXTURE_2D, pageTable_.get());
+    for (int level = 0; level < levels_; ++level) {
+        glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, pagesX(level), pagesY(level), GL_RGBA_INTEGER, GL_UNSIGNED_BYTE,
+                        table_[level].data());
+    }
+    glstate::activeTexture(GL_TEXTURE0);
+}
+
+void VirtualTexture::draw(const CullRect& view) {
+    if (!initialized()) {
+        return;
+    }
+    const CullRect image = imageRect();
+    if (image.max.x < view.min.x || image.min.x > view.max.x || image.max.y < view.min.y ||
+        image.min.y > view.max.y) {
+        return;
+    }
+    glstate::activeTexture(kPageTableUnit);
+    glstate::bindTexture(GL_TEXTURE_2D, pageTable_.get());
+    glstate::activeTexture(GL_TEXTURE0);
+    glstate::bindVertexArray(quadVao_);
+    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, nullptr);
+}
+
+bool VirtualTexture::covers(const CullRect& view) const {
+    // Until the top level's page arrives a pixel with no page is written transparent black.
+    if (!initialized() || resident_.count(key(levels_ - 1, 0, 0)) == 0) {
+        return false;
+    }
+    const CullRect image = imageRect();
+    return image.min.x <= view.min.x && image.min.y <= view.min.y && image.max.x >= view.max.x &&
+           image.max.y >= view.max.y;
+}
+
+CullRect VirtualTexture::imageRect() const {
+    const glm::vec2 extent = glm::vec2(static_cast<float>(options_.pagesX), static_cast<float>(options_.pagesY)) *
+                             options_.pageWorldSize;
+    return CullRect{options_.origin, options_.origin + extent};
+}
+
+bool VirtualTexture::busy() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return !queue_.empty() || !loading_.empty() || !loaded_.empty() || !incoming_.empty();
+}
+
+VirtualTexture::Stats VirtualTexture::stats() const {
+    Stats s = stats_;
+    s.resident = resident_.size();
+    s.wanted = wanted_.size();
+    std::lock_guard<std::mutex> lock(mutex_);
+    s.pending = queue_.size() + loading_.size() + loaded_.size() + incoming_.size();
+    s.loads = loads_;
+    return s;
+}
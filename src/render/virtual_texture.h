@@ -0,0 +1,208 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "render/culling.h"
+#include "render/gl_resource.h"
+#include "render/render_target.h"
+#include "render/shader_layout.h"
+#include "render/stream_buffer.h"
+
+class VertexArrayCache;
+
+// VirtualTexture
+// --------------
+// An image far larger than VRAM (a gigapixel world background), of which only the pages
+// the screen shows are on the GPU. The image and its mip chain are cut into PAGES of
+// kPageSize² texels; a fixed PHYSICAL cache texture holds cacheSlots² of them, and a
+// PAGE TABLE texture says where each page is:
+//
+//     virtual image (level 0..top)          page table (RGBA8UI, a mip level per level)
+//     ┌──┬──┬──┬──┐                         texel (x, y) of level L: the cache slot of
+//     │  │▓▓│  │  │  page (1, 0) of L0 ──▶  page (x, y) of L, or of its nearest loaded
+//     ├──┼──┼──┼──┤                         ancestor (slot x, slot y, its level, 1)
+//     │  │  │  │  │                                │
+//     └──┴──┴──┴──┘                                ▼
+//                                           physical cache (RGBA8): slots of kSlotSize²,
+//                                           each a page plus a kBorder texel apron
+//
+// Which pages are needed comes from the GPU itself. A FEEDBACK pass draws the image at
+// 1/kFeedbackDivisor of the window's size into an R32UI target, each pixel the page (x,
+// y, level) it would sample; the frame after next reads that back (fenced pixel pack
+// buffers, as GpuPicker does) and everything it names, plus their ancestors, is wanted:
+//
+// | Step                    | Where          | Per frame                                 |
+// | ----------------------- | -------------- | ----------------------------------------- |
+// | feedback draw + readback| GL thread      | one quad into ~1/64 of the pixels, a copy |
+// | feedback → wanted pages | GL thread      | a sort of the few thousand pixels         |
+// | page contents           | own threads    | PageSource per page (file, generator)     |
+// | upload                  | GL thread      | ≤ uploadsPerFrame pages, via a PBO ring   |
+// | page table              | GL thread      | rebuilt + uploaded when a page came or    |
+// |                         |                | went (a few hundred KB at most)           |
+//
+// The cache is LRU: a page no feedback has asked for since the last readback makes room
+// for a new one; the top level's single page never leaves, so every pixel always has
+// something to show while the sharper pages stream in, coarse ones first.
+//
+// Drawn as one quad with the TILEMAP + VIRTUAL_TEXTURE variant of vertex.glsl /
+// fragment.glsl (+ the FEEDBACK define for the feedback pass): the fragment picks its
+// level from the derivatives, looks its page up and samples the slot with plain
+// bilinear filtering (no blending between levels). The physical texture goes to unit 0
+// (the caller binds it), the page table to kPageTableUnit.
+//
+// VRAM is bounded by the cache and the page table, whatever the image's size:
+// cacheSlots = 32 is 1024 pages, 69 MB, for any image.
+//
+// GL thread only, apart from the PageSource, which runs on the loader threads.
+class VirtualTexture {
+public:
+    static constexpr int kPageSize = 128;
+    static constexpr int kBorder = 1;          // texels around a page, for bilinear filtering
+    static constexpr int kSlotSize = kPageSize + 2 * kBorder;
+    static constexpr int kFeedbackDivisor = 8;
+    static constexpr int kMaxLevels = 13;      // 4096 pages per side: 512K texels
+    static constexpr GLenum kPageTableUnit = GL_TEXTURE0 + shaderlayout::fragment::uPageTable.binding;
+
+    // Fills kSlotSize² RGBA8 texels (0xAABBGGRR, rows bottom-up) of `level`, starting at
+    // level texel (x, y): a page with its border. x, y may be outside the image at the
+    // edges (-kBorder, or a page's width past the end); clamp them. Loader threads.
+    using PageSource = std::function<void(int level, int x, int y, std::uint32_t* texels)>;
+
+    struct Options {
+        int pagesX = 256;              // level 0 pages per side: powers of two
+        int pagesY = 256;
+        int cacheSlots = 16;           // per side of the physical texture
+        int uploadsPerFrame = 16;
+        int loadThreads = 1;
+        glm::vec2 origin{0.0f};        // world position of the image's lower-left corner
+        float pageWorldSize = 0.05f;   // world units per level 0 page
+    };
+
+    struct Stats {
+        std::size_t resident = 0;      // pages in the cache
+        std::size_t wanted = 0;        // named by the last feedback (with ancestors)
+        std::size_t pending = 0;       // queued or loading
+        std::uint64_t loads = 0;       // pages produced so far
+        std::uint64_t uploads = 0;
+        std::uint64_t evictions = 0;
+        std::uint64_t feedbacks = 0;   // readbacks processed
+        std::uint64_t dropped = 0;     // loaded, but the cache had no slot to spare
+    };
+
+    VirtualTexture() = default;
+    VirtualTexture(const VirtualTexture&) = delete;
+    VirtualTexture& operator=(const VirtualTexture&) = delete;
+
+    // GL thread. The quad's VAO comes from `vaos`, which must outlive this. Starts the
+    // loader threads; shutdown() joins them.
+    bool init(const Options& options, PageSource source, VertexArrayCache& vaos);
+    void shutdown();
+
+    // GL thread, once after each link of the drawing or the feedback program.
+    void setUniforms(GLuint program, bool feedback) const;
+
+    // GL thread, once per frame before drawing: the oldest feedback that has arrived →
+    // loads; loaded pages → the cache; the page table, if that changed anything.
+    void update();
+    // GL thread: the feedback pass for a viewWidth x viewHeight view, with the Camera
+    // block bound to the view to sample for. Leaves its own target bound: rebind yours.
+    void feedback(GLuint program, int viewWidth, int viewHeight);
+    // GL thread, with the program bound and the physical texture on unit 0: the quad, if
+    // `view` overlaps it.
+    void draw(const CullRect& view);
+    // GL thread: draw() fills every pixel of `view` with opaque texels, the image spans
+    // all of it and its top page is resident. A colour clear under it would never show
+    // (render/gl_framebuffer.h).
+    bool covers(const CullRect& view) const;
+
+    bool initialized() const { return physical_.get() != 0; }
+    GLuint physicalTexture() const { return physical_.get(); }
+    // Pages still on their way: the picture is not final yet.
+    bool busy() const;
+    Stats stats() const;
+
+private:
+    struct Slot {
+        std::uint32_t page = kNoPage;  // key() of what it holds
+        std::uint64_t lastWanted = 0;  // feedbacks_ when last named
+    };
+    struct Readback {
+        GlBuffer buffer;
+        GLsync fence = nullptr;        // null: free
+        int width = 0, height = 0;
+    };
+    struct LoadedPage {
+        std::uint32_t page;
+        std::vector<std::uint32_t> texels;
+    };
+
+    static constexpr std::uint32_t kNoPage = 0xffffffffu;
+    // Level in bits 24..27, y in 12..23, x in 0..11: also what the feedback pass writes
+    // (with bit 31 set, so 0 is "no page").
+    static std::uint32_t key(int level, int x, int y) {
+        return static_cast<std::uint32_t>(level) << 24 | static_cast<std::uint32_t>(y) << 12 |
+               static_cast<std::uint32_t>(x);
+    }
+    static int levelOf(std::uint32_t page) { return static_cast<int>(page >> 24 & 0xfu); }
+    static int xOf(std::uint32_t page) { return static_cast<int>(page & 0xfffu); }
+    static int yOf(std::uint32_t page) { return static_cast<int>(page >> 12 & 0xfffu); }
+    int pagesX(int level) const { return std::max(1, options_.pagesX >> level); }
+    int pagesY(int level) const { return std::max(1, options_.pagesY >> level); }
+    CullRect imageRect() const;        // the image's world rectangle
+
+    void loadLoop();
+    void readFeedback(Readback& readback);
+    void want(std::uint32_t page);
+    void uploadPages();
+    int takeSlot();
+    void rebuildPageTable();
+
+    Options options_;
+    PageSource source_;
+    int levels_ = 0;
+    GlTexture physical_;
+    GlTexture pageTable_;
+    GlBuffer quadVbo_;
+    GlBuffer quadEbo_;
+    VertexArrayCache* vaos_ = nullptr;
+    GLuint quadVao_ = 0;
+    StreamBuffer staging_;
+
+    RenderTarget feedbackTarget_;
+    Readback readbacks_[3];
+    int nextReadback_ = 0;             // written next, read first
+    std::vector<std::uint32_t> feedbackPixels_;
+
+    // GL thread: the cache and the table.
+    std::vector<Slot> slots_;
+    std::vector<int> freeSlots_;
+    std::unordered_map<std::uint32_t, int> resident_;   // page → slot
+    std::vector<std::vector<std::uint32_t>> table_;     // per level, pagesX(l) * pagesY(l)
+    std::vector<std::uint32_t> wanted_;                 // this feedback's pages, coarse first
+    bool tableDirty_ = false;
+    std::uint64_t feedbacks_ = 0;
+
+    // Shared with the loader threads.
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::deque<std::uint32_t> queue_;                   // replaced by each feedback
+    std::vector<std::uint32_t> loading_;                // taken from queue_, not yet done
+    std::vector<LoadedPage> loaded_;
+    std::vector<LoadedPage> incoming_;                  // GL thread: swapped with loaded_
+    bool stopping_ = false;
+    std::vector<std::thread> threads_;
+    std::uint64_t loads_ = 0;
+
+    Stats stats_;
+};
@@ -0,0 +1,191 @@
+#include "render/visible_set.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "core/job_system.h"
+
+namespace {
+
+constexpr float kSqrt2 = 1.41421356f;  // the bounding circle of render/culling.cpp
+
+// a minus b as up to four rects (closed: they may share edges with b).
+int subtract(const Aabb& a, const Aabb& b, Aabb* out) {
+    if (!a.overlaps(b)) {
+        out[0] = a;
+        return 1;
+    }
+    int count = 0;
+    if (a.min.y < b.min.y) out[count++] = Aabb{a.min, glm::vec2(a.max.x, b.min.y)};
+    if (a.max.y > b.max.y) out[count++] = Aabb{glm::vec2(a.min.x, b.max.y), a.max};
+    const float y0 = std::max(a.min.y, b.min.y);
+    const float y1 = std::min(a.max.y, b.max.y);
+    if (a.min.x < b.min.x) out[count++] = Aabb{glm::vec2(a.min.x, y0), glm::vec2(b.min.x, y1)};
+    if (a.max.x > b.max.x) out[count++] = Aabb{glm::vec2(b.max.x, y0), glm::vec2(a.max.x, y1)};
+    return count;
+}
+
+float area(const Aabb& a) {
+    return std::max(0.0f, a.max.x - a.min.x) * std::max(0.0f, a.max.y - a.min.y);
+}
+
+} // namespace
+
+void VisibleSet::update(JobSystem& jobs, const Transforms2D& transforms, float localHalfExtent,
+                        const CullRect& view) {
+    const std::size_t n = transforms.size();
+    const std::size_t old = bounds_.size();
+    const Aabb rect{view.min, view.max};
+    entered_.clear();
+    left_ = 0;
+
+    // Rows gone since the last update: out of the list (the merge skips them), out of the grid.
+    for (std::size_t i = n; i < old; ++i) {
+        left_ += inView_[i];
+        if (gridValid_) {
+            grid_.remove(static_cast<ObjectId>(i));
+        }
+    }
+    inView_.resize(n, 0);
+    bounds_.resize(n);
+
+    // The bounds that changed (new rows included), each range into its own slice.
+    const std::size_t ranges = (n + kRange - 1) / kRange;
+    changed_.resize(n);
+    rangeChanged_.resize(ranges);
+    const float radiusScale = localHalfExtent * kSqrt2;
+    jobs.parallelFor(ranges, compareGrain_, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t r = begin; r < end; ++r) {
+            const std::size_t first = r * kRange;
+            const std::size_t last = std::min(n, first + kRange);
+            std::size_t count = 0;
+            for (std::size_t i = first; i < last; ++i) {
+                const float radius =
+                    std::max(std::fabs(transforms.scaleX[i]), std::fabs(transforms.scaleY[i])) * radiusScale;
+                const Aabb b = Aabb::around(glm::vec2(transforms.x[i], transforms.y[i]), radius);
+                Aabb& stored = bounds_[i];
+                if (i >= old || b.min != stored.min || b.max != stored.max) {
+                    stored = b;
+                    changed_[first + count++] = static_cast<std::uint32_t>(i);
+                }
+            }
+            rangeChanged_[r] = count;
+        }
+    });
+    std::size_t changed = 0;
+    for (std::size_t r = 0; r < ranges; ++r) {
+        changed += rangeChanged_[r];
+    }
+
+    // Few changes keep the grid current; many make it stale (rebuilt once things settle).
+    const bool quiet = changed <= n / kChangedShare;
+    quietFrames_ = quiet ? quietFrames_ + 1 : 0;
+    if (!quiet) {
+        gridValid_ = false;
+    } else if (gridValid_) {
+        for (std::size_t r = 0; r < ranges; ++r) {
+            for (std::size_t k = 0; k < rangeChanged_[r]; ++k) {
+                const std::uint32_t i = changed_[r * kRange + k];
+                grid_.update(i, bounds_[i]);
+            }
+        }
+    }
+
+    if (!gridValid_ || !hasView_ || !bandsSmall(rect)) {
+        cullAll(jobs, transforms, localHalfExtent, view);
+        if (!gridValid_ && quietFrames_ >= kQuietFrames) {
+            grid_.rebuild(bounds_.data(), n);
+            gridValid_ = true;
+        }
+        view_ = rect;
+        hasView_ = true;
+        ++stats_.full;
+        return;
+    }
+
+    // Changed objects, then whatever the view's edges swept over.
+    for (std::size_t r = 0; r < ranges; ++r) {
+        for (std::size_t k = 0; k < rangeChanged_[r]; ++k) {
+            test(changed_[r * kRange + k], rect);
+        }
+    }
+    candidates_.clear();
+    Aabb bands[8];
+    int bandCount = subtract(rect, view_, bands);
+    bandCount += subtract(view_, rect, bands + bandCount);
+    for (int b = 0; b < bandCount; ++b) {
+        grid_.queryRect(bands[b], candidates_);
+    }
+    for (const std::uint32_t i : candidates_) {
+        test(i, rect);
+    }
+    view_ = rect;
+    ++stats_.incremental;
+    stats_.tested += changed + candidates_.size();
+    stats_.entered += entered_.size();
+    stats_.left += left_;
+    if (entered_.empty() && left_ == 0) {
+        return;
+    }
+
+    // Patch: drop what left, merge in what entered, still ascending.
+    std::sort(entered_.begin(), entered_.end());
+    merged_.clear();
+    merged_.reserve(visible_.size() + entered_.size());
+    std::size_t e = 0;
+    for (const std::uint32_t i : visible_) {
+        if (i >= n || !inView_[i]) {
+            continue;
+        }
+        while (e < entered_.size() && entered_[e] < i) {
+            merged_.push_back(entered_[e++]);
+        }
+        merged_.push_back(i);
+    }
+    merged_.insert(merged_.end(), entered_.begin() + static_cast<std::ptrdiff_t>(e), entered_.end());
+    visible_.swap(merged_);
+}
+
+void VisibleSet::cullAll(JobSystem& jobs, const Transforms2D& transforms, float localHalfExtent,
+                         const CullRect& view) {
+    const std::size_t n = transforms.size();
+    const std::size_t ranges = (n + kRange - 1) / kRange;
+    jobs.parallelFor(ranges, cullGrain_, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t r = begin; r < end; ++r) {
+            const std::size_t first = r * kRange;
+            rangeChanged_[r] = cullTransforms(transforms, first, std::min(kRange, n - first), localHalfExtent, view,
+                                              changed_.data() + first);
+        }
+    });
+    visible_.clear();
+    std::fill(inView_.begin(), inView_.end(), 0);
+    for (std::size_t r = 0; r < ranges; ++r) {
+        const std::uint32_t* culled = changed_.data() + r * kRange;
+        visible_.insert(visible_.end(), culled, culled + rangeChanged_[r]);
+        for (std::size_t k = 0; k < rangeChanged_[r]; ++k) {
+            inView_[culled[k]] = 1;
+        }
+    }
+}
+
+void VisibleSet::test(std::uint32_t i, const Aabb& view) {
+    const std::uint8_t in = bounds_[i].overlaps(view) ? 1 : 0;
+    if (in == inView_[i]) {
+        return;
+    }
+    inView_[i] = in;
+    if (in) {
+        entered_.push_back(i);
+    } else {
+        ++left_;
+    }
+}
+
+// The swept bands are no bigger than the view: past that (a zoom, a teleport) the grid
+// would visit about as much as a cull of everything.
+bool VisibleSet::bandsSmall(const Aabb& view) const {
+    const float overlap = view.overlaps(view_)
+                              ? area(Aabb{glm::max(view.min, view_.min), glm::min(view.max, view_.max)})
+                              : 0.0f;
+    return area(view) + area(view_) - 2.0f * overlap <= area(view);
+}
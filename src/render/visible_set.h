@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "core/batch_transform.h"
+#include "core/job_system.h"
+#include "core/spatial_index.h"
+#include "core/uniform_grid.h"
+#include "render/culling.h"
+
+// VisibleSet
+// ----------
+// The indices of the objects that touch the view, kept from frame to frame instead of
+// culled from scratch: most objects and the camera move little per frame, so only a few
+// objects cross the view's edges and the list only needs patching.
+//
+//     frame N-1 view ┌───────┐                 Re-tested this frame:
+//                    │  ┌────┼──┐ frame N view  - objects whose bounds changed
+//                    │  │    │  │               - objects in the two L-shaped bands the
+//                    └──┼────┘  │                 edges swept (old minus new, new minus
+//                       └───────┘                 old), found through a UniformGrid
+//
+// Everything else keeps last frame's answer. The ones that flipped are merged into (or
+// dropped from) the index list, which stays in ascending index order: the same list, in
+// the same order, that cullTransforms gives.
+//
+// | Frame                                | Work                                        |
+// | ------------------------------------ | ------------------------------------------- |
+// | incremental                          | bounds compared (parallel, one pass) +      |
+// |                                      | grid updates and tests of changed + swept   |
+// |                                      | objects + one merge of the list             |
+// | full: no grid yet, > 1/kChangedShare | cullTransforms of everything, as before     |
+// | changed, or the view jumped          | (parallel); the grid is left to go stale    |
+//
+// The grid is built once kQuietFrames incremental-sized frames follow each other, and
+// dropped when a busy frame would cost more to keep it current than to cull: a scene
+// where everything moves every frame costs a bounds compare over the plain cull.
+//
+// Rows are only the caller's indices: an entity taking another's row (a spawn after a
+// despawn) is the row's bounds changing, so no identity tracking is needed.
+class VisibleSet {
+public:
+    static constexpr std::size_t kRange = 512;         // objects per compare / cull range; jobs
+                                                       // take as many ranges as their AdaptiveGrain
+    static constexpr std::size_t kChangedShare = 8;    // more changed than 1/8: a full cull
+    static constexpr int kQuietFrames = 8;             // frames below that before building the grid
+
+    // The objects of `transforms` (quads of half extent `localHalfExtent`, as
+    // cullTransforms) that touch `view`.
+    void update(JobSystem& jobs, const Transforms2D& transforms, float localHalfExtent, const CullRect& view);
+
+    const std::vector<std::uint32_t>& indices() const { return visible_; }
+    std::size_t size() const { return visible_.size(); }
+
+    struct Stats {
+        std::uint64_t incremental = 0;         // frames patched
+        std::uint64_t full = 0;                // frames culled from scratch
+        std::uint64_t tested = 0;              // objects re-tested by the patched frames
+        std::uint64_t entered = 0;
+        std::uint64_t left = 0;
+    };
+    const Stats& stats() const { return stats_; }
+    const AdaptiveGrain& compareGrain() const { return compareGrain_; }
+    void resetStats() { stats_ = Stats{}; }
+
+private:
+    void cullAll(JobSystem& jobs, const Transforms2D& transforms, float localHalfExtent, const CullRect& view);
+    void test(std::uint32_t i, const Aabb& view);
+    bool bandsSmall(const Aabb& view) const;
+
+    std::vector<Aabb> bounds_;                 // per object, as of the last update
+    std::vector<std::uint8_t> inView_;         // per object: in visible_
+    std::vector<std::uint32_t> visible_;       // ascending
+    Aabb view_{};
+    bool hasView_ = false;
+
+    UniformGrid grid_{1.0f};
+    bool gridValid_ = false;
+    int quietFrames_ = 0;
+
+    // Scratch.
+    std::vector<std::uint32_t> changed_;       // range r's changed objects start at r * kRange
+    std::vector<std::size_t> rangeChanged_;    // per range: how many
+    std::vector<std::uint32_t> candidates_;
+    std::vector<std::uint32_t> entered_;
+    std::vector<std::uint32_t> merged_;
+    std::size_t left_ = 0;                     // this update
+    // Ranges per job (core/job_system.h); a range's bounds read and written, its indices.
+    AdaptiveGrain compareGrain_{kRange * (5 * sizeof(float) + sizeof(Aabb) + sizeof(std::uint32_t))};
+    AdaptiveGrain cullGrain_{kRange * (5 * sizeof(float) + sizeof(std::uint32_t))};
+
+    Stats stats_;
+};
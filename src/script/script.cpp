@@ -0,0 +1,460 @@
+#include "script/script.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <unordered_map>
+
+// Recursive descent over one line at a time, emitting ops as it goes: every expression
+// node gets a fresh register (a block's statements are few; kMaxRegisters is plenty).
+class ScriptCompiler {
+public:
+    ScriptCompiler(const ScriptBindings& bindings, Script& script) : bindings_(bindings), script_(script) {}
+
+    bool compile(const std::string& source, std::string* error) {
+        std::size_t lineStart = 0;
+        while (lineStart <= source.size() && ok_) {
+            std::size_t lineEnd = source.find('\n', lineStart);
+            if (lineEnd == std::string::npos) {
+                lineEnd = source.size();
+            }
+            ++line_;
+            tokenize(source.substr(lineStart, lineEnd - lineStart));
+            if (ok_ && tokens_.front().kind != Kind::End) {
+                statement();
+            }
+            lineStart = lineEnd + 1;
+        }
+        if (!ok_ && error) {
+            *error = "line " + std::to_string(line_) + ": " + why_;
+        }
+        return ok_;
+    }
+
+private:
+    using Code = Script::Code;
+    using Op = Script::Op;
+
+    enum class Kind { Name, Number, Symbol, End };
+    struct Token {
+        Kind kind;
+        std::string text;
+        float number = 0.0f;
+    };
+
+    bool fail(const std::string& why) {
+        if (ok_) {
+            ok_ = false;
+            why_ = why;
+        }
+        return false;
+    }
+
+    void tokenize(const std::string& text) {
+        tokens_.clear();
+        at_ = 0;
+        std::size_t i = 0;
+        while (i < text.size()) {
+            const char ch = text[i];
+            if (ch == '#') {
+                break;
+            }
+            if (std::isspace(static_cast<unsigned char>(ch))) {
+                ++i;
+            } else if (std::isalpha(static_cast<unsigned char>(ch)) || ch == '_') {
+                std::size_t j = i;
+                while (j < text.size() && (std::isalnum(static_cast<unsigned char>(text[j])) || text[j] == '_')) ++j;
+                tokens_.push_back(Token{Kind::Name, text.substr(i, j - i)});
+                i = j;
+            } else if (std::isdigit(static_cast<unsigned char>(ch)) || (ch == '.' && i + 1 < text.size() &&
+                                                                         std::isdigit(static_cast<unsigned char>(text[i + 1])))) {
+                char* end = nullptr;
+                const float value = std::strtof(text.c_str() + i, &end);
+                const std::size_t j = static_cast<std::size_t>(end - text.c_str());
+                tokens_.push_back(Token{Kind::Number, text.substr(i, j - i), value});
+                i = j;
+            } else {
+                // Two-character operators first.
+                static const char* const kPairs[] = {"+=", "-=", "*=", "/=", "<=", ">="};
+                std::string symbol(1, ch);
+                for (const char* pair : kPairs) {
+                    if (text.compare(i, 2, pair) == 0) {
+                        symbol = pair;
+                    }
+                }
+                if (std::strchr("+-*/()<>=,.", ch) == nullptr) {
+                    fail(std::string("unexpected '") + ch + "'");
+                    return;
+                }
+                tokens_.push_back(Token{Kind::Symbol, symbol});
+                i += symbol.size();
+            }
+        }
+        tokens_.push_back(Token{Kind::End, ""});
+    }
+
+    const Token& peek() const { return tokens_[at_]; }
+    const Token& next() {
+        const Token& t = tokens_[at_];
+        if (t.kind != Kind::End) ++at_;
+        return t;
+    }
+    bool isSymbol(const char* s) const { return peek().kind == Kind::Symbol && peek().text == s; }
+    bool expect(const char* s) {
+        if (!isSymbol(s)) {
+            return fail(std::string("expected '") + s + "'");
+        }
+        next();
+        return true;
+    }
+
+    int newRegister() {
+        if (!block_) {
+            fail("statement outside an 'each' block");
+            return 0;
+        }
+        if (block_->registers >= Script::kMaxRegisters) {
+            fail("block too long (out of registers)");
+            return 0;
+        }
+        return block_->registers++;
+    }
+    int emit(Code code, int a = 0, int b = 0, int c = 0) {
+        Op op;
+        op.code = code;
+        op.dst = static_cast<std::uint16_t>(newRegister());
+        op.a = static_cast<std::uint16_t>(a);
+        op.b = static_cast<std::uint16_t>(b);
+        op.c = static_cast<std::uint16_t>(c);
+        if (block_) block_->ops.push_back(op);
+        return op.dst;
+    }
+
+    // Component.member of the current block: which column, and the member.
+    bool member(const std::string& componentName, int& column, const ScriptBindings::Member*& out) {
+        if (!block_) {
+            return fail("statement outside an 'each' block");
+        }
+        if (!expect(".")) return false;
+        const Token memberName = next();
+        if (memberName.kind != Kind::Name) {
+            return fail("expected a member after '" + componentName + ".'");
+        }
+        const auto it = std::find(blockNames_.begin(), blockNames_.end(), componentName);
+        if (it == blockNames_.end()) {
+            return fail(componentName + " is not in this block's 'each'");
+        }
+        column = static_cast<int>(it - blockNames_.begin());
+        const ScriptBindings::Component& component = *blockComponents_[static_cast<std::size_t>(column)];
+        for (const ScriptBindings::Member& m : component.members) {
+            if (memberName.text == m.name) {
+                out = &m;
+                return true;
+            }
+        }
+        return fail(componentName + " has no member '" + memberName.text + "'");
+    }
+
+    int load(int column, const ScriptBindings::Member& m) {
+        const int r = emit(m.kind == ScriptBindings::Member::Kind::Unorm8 ? Code::LoadUnorm8 : Code::Load);
+        if (block_ && !block_->ops.empty()) {
+            block_->ops.back().column = static_cast<std::uint8_t>(column);
+            block_->ops.back().offset = m.offset;
+        }
+        return r;
+    }
+
+    int primary() {
+        const Token t = next();
+        if (t.kind == Kind::Number) {
+            const int r = emit(Code::Const);
+            if (block_ && !block_->ops.empty()) block_->ops.back().value = t.number;
+            return r;
+        }
+        if (t.kind == Kind::Symbol && t.text == "(") {
+            const int r = expression();
+            expect(")");
+            return r;
+        }
+        if (t.kind != Kind::Name) {
+            fail(t.kind == Kind::End ? "expression ends early" : "unexpected '" + t.text + "'");
+            return 0;
+        }
+        if (isSymbol(".")) {
+            int column = 0;
+            const ScriptBindings::Member* m = nullptr;
+            return member(t.text, column, m) ? load(column, *m) : 0;
+        }
+        if (isSymbol("(")) {
+            return call(t.text);
+        }
+        if (t.text == "dt") return emit(Code::Dt);
+        if (t.text == "time") return emit(Code::Time);
+        const auto local = locals_.find(t.text);
+        if (local == locals_.end()) {
+            fail("unknown name '" + t.text + "'");
+            return 0;
+        }
+        return local->second;
+    }
+
+    int call(const std::string& name) {
+        next(); // (
+        if (name == "action") {
+            const Token action = next();
+            for (const auto& bound : bindings_.actions) {
+                if (bound.first == action.text) {
+                    const int r = emit(Code::Action);
+                    if (block_ && !block_->ops.empty()) block_->ops.back().offset = bound.second;
+                    expect(")");
+                    return r;
+                }
+            }
+            fail("unknown action '" + action.text + "'");
+            return 0;
+        }
+        struct Function {
+            const char* name;
+            Code code;
+            int arguments;
+        };
+        static const Function kFunctions[] = {
+            {"sin", Code::Sin, 1},     {"cos", Code::Cos, 1},       {"abs", Code::Abs, 1},
+            {"sqrt", Code::Sqrt, 1},   {"floor", Code::Floor, 1},   {"fract", Code::Fract, 1},
+            {"min", Code::Min, 2},     {"max", Code::Max, 2},       {"length", Code::Length, 2},
+            {"clamp", Code::Clamp, 3}, {"select", Code::Select, 3},
+        };
+        for (const Function& f : kFunctions) {
+            if (name != f.name) continue;
+            int args[3] = {0, 0, 0};
+            for (int k = 0; k < f.arguments; ++k) {
+                if (k > 0 && !expect(",")) return 0;
+                args[k] = expression();
+            }
+            expect(")");
+            return emit(f.code, args[0], args[1], args[2]);
+        }
+        fail("unknown function '" + name + "'");
+        return 0;
+    }
+
+    int unary() {
+        if (isSymbol("-")) {
+            next();
+            return emit(Code::Neg, unary());
+        }
+        return primary();
+    }
+    int product() {
+        int r = unary();
+        while (ok_ && (isSymbol("*") || isSymbol("/"))) {
+            const Code code = next().text == "*" ? Code::Mul : Code::Div;
+            r = emit(code, r, unary());
+        }
+        return r;
+    }
+    int sum() {
+        int r = product();
+        while (ok_ && (isSymbol("+") || isSymbol("-"))) {
+            const Code code = next().text == "+" ? Code::Add : Code::Sub;
+            r = emit(code, r, product());
+        }
+        return r;
+    }
+    int expression() {
+        int r = sum();
+        if (ok_ && (isSymbol("<") || isSymbol(">") || isSymbol("<=") || isSymbol(">="))) {
+            const std::string op = next().text;
+            const Code code = op == "<" ? Code::Lt : op == ">" ? Code::Gt : op == "<=" ? Code::Le : Code::Ge;
+            r = emit(code, r, sum());
+        }
+        return r;
+    }
+
+    void statement() {
+        const Token first = next();
+        if (first.kind != Kind::Name) {
+            fail("a line starts with 'each', 'let', 'budget' or Component.member");
+            return;
+        }
+        if (first.text == "budget") {
+            const Token value = next();
+            if (value.kind != Kind::Number || value.number <= 0.0f) {
+                fail("budget takes a number of milliseconds");
+                return;
+            }
+            script_.budgetMs_ = value.number;
+        } else if (first.text == "each") {
+            script_.blocks_.emplace_back();
+            block_ = &script_.blocks_.back();
+            blockNames_.clear();
+            blockComponents_.clear();
+            locals_.clear();
+            while (peek().kind == Kind::Name) {
+                const std::string name = next().text;
+                const ScriptBindings::Component* found = nullptr;
+                for (const ScriptBindings::Component& c : bindings_.components) {
+                    if (c.name == name) found = &c;
+                }
+                if (!found) {
+                    fail("unknown component '" + name + "'");
+                    return;
+                }
+                blockNames_.push_back(name);
+                blockComponents_.push_back(found);
+                block_->components.push_back(found->id);
+                block_->strides.push_back(found->size);
+            }
+            if (blockNames_.empty()) {
+                fail("'each' needs at least one component");
+                return;
+            }
+        } else if (first.text == "let") {
+            const Token name = next();
+            if (name.kind != Kind::Name || !expect("=")) {
+                fail("expected: let name = expression");
+                return;
+            }
+            locals_[name.text] = expression();
+        } else {
+            int column = 0;
+            const ScriptBindings::Member* m = nullptr;
+            if (!member(first.text, column, m)) return;
+            const Token op = next();
+            static const char* const kAssignments[] = {"=", "+=", "-=", "*=", "/="};
+            if (op.kind != Kind::Symbol ||
+                std::find_if(std::begin(kAssignments), std::end(kAssignments),
+                             [&op](const char* s) { return op.text == s; }) == std::end(kAssignments)) {
+                fail("expected an assignment after " + first.text + "." + m->name);
+                return;
+            }
+            int value = expression();
+            if (op.text != "=") {
+                const Code code = op.text == "+=" ? Code::Add : op.text == "-=" ? Code::Sub
+                                : op.text == "*=" ? Code::Mul : Code::Div;
+                value = emit(code, load(column, *m), value);
+            }
+            Op store;
+            store.code = m->kind == ScriptBindings::Member::Kind::Unorm8 ? Code::StoreUnorm8 : Code::Store;
+            store.column = static_cast<std::uint8_t>(column);
+            store.offset = m->offset;
+            store.a = static_cast<std::uint16_t>(value);
+            if (block_) block_->ops.push_back(store);
+        }
+        if (ok_ && peek().kind != Kind::End) {
+            fail("unexpected '" + peek().text + "' at the end of the line");
+        }
+    }
+
+    const ScriptBindings& bindings_;
+    Script& script_;
+    Script::Block* block_ = nullptr;
+    std::vector<std::string> blockNames_;
+    std::vector<const ScriptBindings::Component*> blockComponents_;
+    std::unordered_map<std::string, int> locals_;
+    std::vector<Token> tokens_;
+    std::size_t at_ = 0;
+    int line_ = 0;
+    bool ok_ = true;
+    std::string why_;
+};
+
+bool Script::compile(const std::string& source, const ScriptBindings& bindings, std::string* error) {
+    blocks_.clear();
+    budgetMs_ = kDefaultBudgetMs;
+    ScriptCompiler compiler(bindings, *this);
+    if (!compiler.compile(source, error)) {
+        blocks_.clear();
+        return false;
+    }
+    int registers = 0;
+    for (const Block& b : blocks_) {
+        registers = std::max(registers, b.registers);
+    }
+    registers_.assign(static_cast<std::size_t>(registers) * kLanes, 0.0f);
+    return true;
+}
+
+std::size_t Script::opCount() const {
+    std::size_t n = 0;
+    for (const Block& b : blocks_) {
+        n += b.ops.size();
+    }
+    return n;
+}
+
+void Script::run(World& world, const ScriptContext& context) {
+    for (const Block& block : blocks_) {
+        world.forEachChunkOf(block.components.data(), block.components.size(),
+                             [&](std::size_t count, unsigned char* const* columns) {
+                                 for (std::size_t first = 0; first < count; first += kLanes) {
+                                     execute(block, columns, first, std::min(kLanes, count - first), context);
+                                 }
+                             });
+    }
+}
+
+void Script::execute(const Block& block, unsigned char* const* columns, std::size_t first, std::size_t n,
+                     const ScriptContext& context) {
+    float* const r = registers_.data();
+    for (const Op& op : block.ops) {
+        float* d = r + op.dst * kLanes;
+        const float* a = r + op.a * kLanes;
+        const float* b = r + op.b * kLanes;
+        const float* c = r + op.c * kLanes;
+        switch (op.code) {
+            case Code::Const: std::fill(d, d + n, op.value); break;
+            case Code::Dt: std::fill(d, d + n, context.dt); break;
+            case Code::Time: std::fill(d, d + n, context.time); break;
+            case Code::Action: std::fill(d, d + n, ((context.actions >> op.offset) & 1u) ? 1.0f : 0.0f); break;
+            case Code::Load: {
+                const std::uint32_t stride = block.strides[op.column];
+                const unsigned char* src = columns[op.column] + first * stride + op.offset;
+                for (std::size_t i = 0; i < n; ++i) std::memcpy(&d[i], src + i * stride, sizeof(float));
+                break;
+            }
+            case Code::LoadUnorm8: {
+                const std::uint32_t stride = block.strides[op.column];
+                const unsigned char* src = columns[op.column] + first * stride + op.offset;
+                for (std::size_t i = 0; i < n; ++i) d[i] = static_cast<float>(src[i * stride]) * (1.0f / 255.0f);
+                break;
+            }
+            case Code::Store: {
+                const std::uint32_t stride = block.strides[op.column];
+                unsigned char* dst = columns[op.column] + first * stride + op.offset;
+                for (std::size_t i = 0; i < n; ++i) std::memcpy(dst + i * stride, &a[i], sizeof(float));
+                break;
+            }
+            case Code::StoreUnorm8: {
+                const std::uint32_t stride = block.strides[op.column];
+                unsigned char* dst = columns[op.column] + first * stride + op.offset;
+                for (std::size_t i = 0; i < n; ++i) {
+                    dst[i * stride] = static_cast<unsigned char>(std::clamp(a[i], 0.0f, 1.0f) * 255.0f + 0.5f);
+                }
+                break;
+            }
+            case Code::Add: for (std::size_t i = 0; i < n; ++i) d[i] = a[i] + b[i]; break;
+            case Code::Sub: for (std::size_t i = 0; i < n; ++i) d[i] = a[i] - b[i]; break;
+            case Code::Mul: for (std::size_t i = 0; i < n; ++i) d[i] = a[i] * b[i]; break;
+            case Code::Div: for (std::size_t i = 0; i < n; ++i) d[i] = a[i] / b[i]; break;
+            case Code::Neg: for (std::size_t i = 0; i < n; ++i) d[i] = -a[i]; break;
+            case Code::Lt: for (std::size_t i = 0; i < n; ++i) d[i] = a[i] < b[i] ? 1.0f : 0.0f; break;
+            case Code::Gt: for (std::size_t i = 0; i < n; ++i) d[i] = a[i] > b[i] ? 1.0f : 0.0f; break;
+            case Code::Le: for (std::size_t i = 0; i < n; ++i) d[i] = a[i] <= b[i] ? 1.0f : 0.0f; break;
+            case Code::Ge: for (std::size_t i = 0; i < n; ++i) d[i] = a[i] >= b[i] ? 1.0f : 0.0f; break;
+            case Code::Sin: for (std::size_t i = 0; i < n; ++i) d[i] = std::sin(a[i]); break;
+            case Code::Cos: for (std::size_t i = 0; i < n; ++i) d[i] = std::cos(a[i]); break;
+            case Code::Abs: for (std::size_t i = 0; i < n; ++i) d[i] = std::fabs(a[i]); break;
+            case Code::Sqrt: for (std::size_t i = 0; i < n; ++i) d[i] = std::sqrt(std::max(a[i], 0.0f)); break;
+            case Code::Floor: for (std::size_t i = 0; i < n; ++i) d[i] = std::floor(a[i]); break;
+            case Code::Fract: for (std::size_t i = 0; i < n; ++i) d[i] = a[i] - std::floor(a[i]); break;
+            case Code::Min: for (std::size_t i = 0; i < n; ++i) d[i] = std::min(a[i], b[i]); break;
+            case Code::Max: for (std::size_t i = 0; i < n; ++i) d[i] = std::max(a[i], b[i]); break;
+            case Code::Length: for (std::size_t i = 0; i < n; ++i) d[i] = std::sqrt(a[i] * a[i] + b[i] * b[i]); break;
+            case Code::Clamp: for (std::size_t i = 0; i < n; ++i) d[i] = std::min(std::max(a[i], b[i]), c[i]); break;
+            case Code::Select: for (std::size_t i = 0; i < n; ++i) d[i] = a[i] != 0.0f ? b[i] : c[i]; break;
+        }
+    }
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+#include "ecs/world.h"
+#include "input/input_state.h"
+
+// Gameplay scripts
+// ----------------
+// Small scripts that change component arrays in BULK: each statement runs over every
+// entity of every chunk that has the listed components, one operation at a time across
+// a whole batch of entities, never one entity at a time through an interpreter.
+//
+//     # Wanderers spin with their speed and breathe.
+//     budget 0.2                                  ms per step this script may take
+//     each Position Rotation Velocity Color       the entities with all of these
+//         let speed = length(Velocity.x, Velocity.y)
+//         Rotation.radians += dt * 3 * speed
+//         Color.a = 0.7 + 0.3 * sin(time * 2 + Position.x)
+//
+// A script compiles to a register program per `each` block. Running it walks the
+// chunks (World::forEachChunkOf) and executes every op over up to kLanes entities before
+// the next op: the dispatch cost is per op per batch, and each op is a plain loop over
+// float arrays the compiler vectorizes. Member loads and stores read and write the
+// chunk's columns in place.
+//
+// | Syntax                       | Meaning                                                  |
+// | ---------------------------- | -------------------------------------------------------- |
+// | each C1 C2 ...               | starts a block over the entities that have all of them   |
+// | C.member = += -= *= /= expr  | writes a bound member (ScriptBindings) of a listed C     |
+// | let name = expr              | a per-entity temporary, until the block ends             |
+// | budget ms                    | the script's CPU budget per step (default 0.5)           |
+// | + - * / < > <= >=  ( )       | arithmetic; comparisons give 1 or 0                      |
+// | dt, time                     | the step's length, seconds simulated so far              |
+// | action(Name)                 | 1 while the bound action is active, else 0               |
+// | sin cos abs sqrt floor fract | per element                                              |
+// | min max length(x, y)         | two arguments                                            |
+// | clamp(v, lo, hi)             | three                                                    |
+// | select(c, a, b)              | a where c is non-zero, else b                            |
+//
+// Everything is float: Unorm8 members (a packed colour's channels) read as 0..1 and are
+// clamped and rounded back on store. `#` starts a comment.
+
+// What scripts can name: components (with the members they may read and write) and
+// actions. Filled once by the game, which is the only code that knows its component
+// structs.
+struct ScriptBindings {
+    struct Member {
+        enum class Kind : std::uint8_t { Float, Unorm8 };
+        const char* name;
+        std::uint32_t offset;              // bytes into the component
+        Kind kind = Kind::Float;
+    };
+    struct Component {
+        std::string name;
+        ComponentId id;
+        std::uint32_t size;
+        std::vector<Member> members;
+    };
+
+    template <typename T>
+    void bind(const char* name, std::initializer_list<Member> members) {
+        components.push_back(Component{name, componentId<T>(), static_cast<std::uint32_t>(sizeof(T)), members});
+    }
+    void bindAction(const char* name, ActionId action) { actions.push_back({name, action}); }
+
+    std::vector<Component> components;
+    std::vector<std::pair<std::string, ActionId>> actions;
+};
+
+// What a step gives the scripts.
+struct ScriptContext {
+    float dt = 0.0f;
+    float time = 0.0f;
+    ActionMask actions = 0;
+};
+
+class Script {
+public:
+    static constexpr std::size_t kLanes = 256;         // entities per op
+    static constexpr int kMaxRegisters = 128;           // per block
+    static constexpr float kDefaultBudgetMs = 0.5f;
+
+    // false with "line N: why" in error; the script is left empty.
+    bool compile(const std::string& source, const ScriptBindings& bindings, std::string* error = nullptr);
+    void run(World& world, const ScriptContext& context);
+
+    float budgetMs() const { return budgetMs_; }
+    std::size_t blockCount() const { return blocks_.size(); }
+    std::size_t opCount() const;
+
+private:
+    enum class Code : std::uint8_t {
+        Const, Dt, Time, Action,
+        Load, LoadUnorm8, Store, StoreUnorm8,
+        Add, Sub, Mul, Div, Neg, Lt, Gt, Le, Ge,
+        Sin, Cos, Abs, Sqrt, Floor, Fract,
+        Min, Max, Length, Clamp, Select,
+    };
+    struct Op {
+        Code code;
+        std::uint8_t column = 0;           // Load / Store: which of the block's components
+        std::uint16_t dst = 0, a = 0, b = 0, c = 0;
+        std::uint32_t offset = 0;          // Load / Store: member offset; Action: the bit
+        float value = 0.0f;                // Const
+    };
+    struct Block {
+        std::vector<ComponentId> components;
+        std::vector<std::uint32_t> strides;    // each component's size
+        std::vector<Op> ops;
+        int registers = 0;
+    };
+    friend class ScriptCompiler;
+
+    void execute(const Block& block, unsigned char* const* columns, std::size_t first, std::size_t n,
+                 const ScriptContext& context);
+
+    std::vector<Block> blocks_;
+    float budgetMs_ = kDefaultBudgetMs;
+    std::vector<float> registers_;
+};
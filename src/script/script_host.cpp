@@ -0,0 +1,144 @@
+#include "script/script_host.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+
+#include "core/file_io.h"
+#include "core/log.h"
+
+namespace {
+
+constexpr const char* kExtension = ".script";
+
+double nowSeconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool isScript(const std::string& name) {
+    const std::size_t n = std::char_traits<char>::length(kExtension);
+    return name.size() > n && name.compare(name.size() - n, n, kExtension) == 0;
+}
+
+} // namespace
+
+bool ScriptHost::init(const std::string& directory, const ScriptBindings& bindings, Profiler* profiler) {
+    directory_ = directory;
+    bindings_ = &bindings;
+    profiler_ = profiler;
+    std::error_code ec;
+    std::vector<std::string> files;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, ec)) {
+        const std::string name = entry.path().filename().string();
+        if (entry.is_regular_file() && isScript(name)) {
+            files.push_back(name);
+        }
+    }
+    if (ec) {
+        logging::warn("Scripts: cannot read %s (%s)", directory.c_str(), ec.message().c_str());
+        return false;
+    }
+    std::sort(files.begin(), files.end());
+    for (const std::string& file : files) {
+        Loaded loaded;
+        loaded.file = file;
+        load(loaded);
+        scripts_.push_back(std::move(loaded));
+    }
+    if (!watcher_.init(directory)) {
+        logging::warn("Scripts: not watching %s; saved scripts will not reload", directory.c_str());
+    }
+    logging::info("Scripts: %zu from %s", scripts_.size(), directory.c_str());
+    return true;
+}
+
+void ScriptHost::shutdown() {
+    watcher_.shutdown();
+    scripts_.clear();
+}
+
+bool ScriptHost::load(Loaded& loaded) {
+    if (!loaded.label) {
+        const std::string stem = loaded.file.substr(0, loaded.file.size() - std::char_traits<char>::length(kExtension));
+        loaded.label = std::make_unique<std::string>("script:" + stem);
+        loaded.stats.name = stem;
+        if (profiler_) {
+            loaded.section = profiler_->section(loaded.label->c_str());
+        }
+    }
+    std::string source;
+    if (!readFile(directory_ + "/" + loaded.file, source)) {
+        logging::warn("Scripts: cannot read %s", loaded.file.c_str());
+        return false;
+    }
+    Script script;
+    std::string error;
+    if (!script.compile(source, *bindings_, &error)) {
+        logging::warn("Scripts: %s: %s%s", loaded.file.c_str(), error.c_str(),
+                      loaded.script.blockCount() > 0 ? " (keeping the previous version)" : "");
+        return false;
+    }
+    loaded.script = std::move(script);
+    loaded.stats.budgetMs = loaded.script.budgetMs();
+    loaded.stats.ops = loaded.script.opCount();
+    return true;
+}
+
+void ScriptHost::reload() {
+    for (const std::string& name : watcher_.poll()) {
+        if (!isScript(name)) {
+            continue;
+        }
+        auto it = std::find_if(scripts_.begin(), scripts_.end(), [&name](const Loaded& l) { return l.file == name; });
+        if (it == scripts_.end()) {
+            Loaded loaded;
+            loaded.file = name;
+            scripts_.push_back(std::move(loaded));
+            it = scripts_.end() - 1;
+        }
+        if (load(*it)) {
+            logging::info("Scripts: reloaded %s (%zu ops)", name.c_str(), it->stats.ops);
+        }
+    }
+}
+
+void ScriptHost::run(World& world, const ScriptContext& context) {
+    for (Loaded& loaded : scripts_) {
+        if (loaded.script.blockCount() == 0) {
+            continue;
+        }
+        // A full profiler hands out kFrameSection; that one is the frame's own.
+        const bool profiled = profiler_ && loaded.section != Profiler::kFrameSection;
+        if (profiled) {
+            profiler_->cpuBegin(loaded.section);
+        }
+        const double start = nowSeconds();
+        loaded.script.run(world, context);
+        const double end = nowSeconds();
+        if (profiled) {
+            profiler_->cpuEnd(loaded.section);
+        }
+
+        Stats& s = loaded.stats;
+        s.lastMs = (end - start) * 1000.0;
+        s.worstMs = std::max(s.worstMs, s.lastMs);
+        ++s.runs;
+        if (s.lastMs > s.budgetMs) {
+            ++s.overruns;
+            if (loaded.lastWarning < 0.0 || end - loaded.lastWarning >= 1.0) {
+                loaded.lastWarning = end;
+                logging::warn("Scripts: %s took %.3f ms, over its %.3f ms budget (%llu times so far)",
+                              loaded.file.c_str(), s.lastMs, static_cast<double>(s.budgetMs),
+                              static_cast<unsigned long long>(s.overruns));
+            }
+        }
+    }
+}
+
+std::vector<ScriptHost::Stats> ScriptHost::stats() const {
+    std::vector<Stats> out;
+    for (const Loaded& loaded : scripts_) {
+        out.push_back(loaded.stats);
+    }
+    return out;
+}
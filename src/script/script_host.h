@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/file_watcher.h"
+#include "profile/profiler.h"
+#include "script/script.h"
+
+// ScriptHost
+// ----------
+// Every *.script in one directory (script/script.h), run once per simulation step in
+// name order, and reloaded when saved:
+//
+// | Event                 | What happens                                                 |
+// | --------------------- | ------------------------------------------------------------ |
+// | load / save           | compiled; on an error the message is logged and the script   |
+// |                       | that was running keeps running (none, for a new file)        |
+// | every step            | run() times each script and records it under its own        |
+// |                       | Profiler section ("script:wander"), so it shows in the HUD   |
+// | over its budget       | counted; a warning at most once a second per script          |
+//
+// Scripts change the World directly (World::forEachChunkOf); they are a system like any
+// other and run where the game registers them.
+class ScriptHost {
+public:
+    struct Stats {
+        std::string name;
+        std::uint64_t runs = 0;
+        std::uint64_t overruns = 0;       // steps over its budget
+        double lastMs = 0.0;
+        double worstMs = 0.0;
+        float budgetMs = 0.0f;
+        std::size_t ops = 0;
+    };
+
+    // profiler: where each script's time goes; may be null.
+    bool init(const std::string& directory, const ScriptBindings& bindings, Profiler* profiler = nullptr);
+    void shutdown();
+
+    // Once a frame: recompiles the scripts saved since the last call.
+    void reload();
+    void run(World& world, const ScriptContext& context);
+
+    std::size_t size() const { return scripts_.size(); }
+    std::vector<Stats> stats() const;
+
+private:
+    struct Loaded {
+        std::string file;                 // "wander.script"
+        std::unique_ptr<std::string> label;   // "script:wander", kept for Profiler::section
+        Profiler::SectionId section = Profiler::kFrameSection;
+        Script script;
+        Stats stats;
+        double lastWarning = -1.0;
+    };
+
+    bool load(Loaded& loaded);
+
+    std::string directory_;
+    FileWatcher watcher_;
+    const ScriptBindings* bindings_ = nullptr;
+    Profiler* profiler_ = nullptr;
+    std::vector<Loaded> scripts_;
+};
@@ -0,0 +1,291 @@
+// bench_runner: the renderer regression benchmark. Runs the game's headless benchmark
+// (src/bench/bench.h) over a fixed matrix of stress scenes and renderer paths, and
+// compares every result with a stored baseline for the same GPU and driver.
+//
+//     ./bench_runner [--game=./game] [--baseline=bench_baseline.json] [--threshold=PCT]
+//                    [--frames=N] [--quads=N] [--update] [-- GAME ARGS...]
+//
+// | Case                         | Game arguments                                         |
+// | ---------------------------- | ------------------------------------------------------ |
+// | {moving, static, overlap} x  | --bench-scene=S --bench-path=P --bench-quads=N         |
+// | {instanced, affine, layered, | (batched: capped at the sprite batch's size, as the    |
+// | batched}                     | game does)                                             |
+// | tilemap, per chunk / MDI     | --bench-scene=tilemap --bench-tiles=512x512, with      |
+// |                              | --gl-tier=streaming (one draw per chunk) and           |
+// |                              | gpu-driven (one glMultiDrawElementsIndirect)           |
+// | particles                    | --bench-scene=particles --bench-quads=N*10             |
+//
+// Every case is its own run of the game (its --bench-frames measured after the warmup).
+// The device is the game's "GL device: RENDERER | VERSION" line: renderer and driver
+// version, so a driver update gets baselines of its own rather than being compared with
+// the old driver's. The baseline file holds any number of devices:
+//
+//     { "<renderer> | <version>": { "moving/instanced/20000": { "avg": 1.234,
+//                                   "p50": 1.2, "p99": 1.9, "draws": 1 }, ... }, ... }
+//
+// A case regresses when its avg or p99 frame ms is more than --threshold percent (default
+// 5) over the baseline's. Exit status: 0 all within, 1 a regression (or a run failed), 2
+// no baseline yet for this device. --update writes this run's results as the device's
+// baseline (other devices' entries are kept) and exits 0.
+//
+// Like `make pgo`, it needs a display (the bench opens a hidden window): BENCH_RUN=xvfb-run
+// in `make bench-regress`. Build the game with CONFIG=release first: -O0 numbers don't
+// say anything about the release build.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "core/file_io.h"
+#include "core/json.h"
+
+namespace {
+
+struct Case {
+    std::string key;                   // "scene/path/N": the baseline's name for it
+    std::string args;
+};
+
+struct Result {
+    std::string key;
+    double avg = 0.0, p50 = 0.0, p99 = 0.0, draws = 0.0;
+};
+
+struct Settings {
+    std::string game = "./game";
+    std::string baseline = "bench_baseline.json";
+    std::string extra;                 // after --: appended to every run
+    double threshold = 5.0;            // percent
+    int frames = 500;
+    int quads = 20000;
+    bool update = false;
+};
+
+std::vector<Case> cases(const Settings& settings) {
+    std::vector<Case> list;
+    const std::string n = std::to_string(settings.quads);
+    for (const char* scene : {"moving", "static", "overlap"}) {
+        for (const char* path : {"instanced", "affine", "layered", "batched"}) {
+            list.push_back(Case{std::string(scene) + "/" + path + "/" + n,
+                                std::string("--bench-scene=") + scene + " --bench-path=" + path + " --bench-quads=" + n});
+        }
+    }
+    for (const char* tier : {"streaming", "gpu-driven"}) {
+        list.push_back(Case{std::string("tilemap/") + (std::strcmp(tier, "streaming") == 0 ? "chunks" : "mdi") +
+                                "/512x512",
+                            std::string("--bench-scene=tilemap --bench-tiles=512x512 --gl-tier=") + tier});
+    }
+    const std::string particles = std::to_string(settings.quads * 10);
+    list.push_back(Case{"particles/gpu/" + particles, "--bench-scene=particles --bench-quads=" + particles});
+    return list;
+}
+
+// One run of the game; its device line and report parsed into `device` / `result`.
+bool run(const Settings& settings, const Case& c, std::string& device, Result& result) {
+    const std::string command = settings.game + " --bench --bench-frames=" + std::to_string(settings.frames) + " " +
+                                c.args + settings.extra + " 2>&1";
+    FILE* pipe = popen(command.c_str(), "r");
+    if (!pipe) {
+        std::fprintf(stderr, "bench_runner: cannot run %s\n", command.c_str());
+        return false;
+    }
+    result.key = c.key;
+    bool measured = false;
+    char line[1024];
+    while (std::fgets(line, sizeof(line), pipe)) {
+        double p90 = 0.0, max = 0.0;
+        if (std::strncmp(line, "GL device: ", 11) == 0) {
+            device.assign(line + 11);
+            while (!device.empty() && (device.back() == '\n' || device.back() == '\r')) device.pop_back();
+        } else if (std::sscanf(line, " frame ms avg %lf p50 %lf p90 %lf p99 %lf max %lf", &result.avg, &result.p50,
+                               &p90, &result.p99, &max) == 5) {
+            measured = true;
+        } else {
+            std::sscanf(line, " draw calls %lf", &result.draws);
+        }
+    }
+    const int status = pclose(pipe);
+    if (status != 0 || !measured) {
+        std::fprintf(stderr, "bench_runner: %s: %s\n", c.key.c_str(),
+                     measured ? "the game exited with an error" : "no bench report in its output");
+        return false;
+    }
+    return true;
+}
+
+bool loadBaseline(const std::string& path, Json& out) {
+    std::string text;
+    if (!readFile(path, text)) {
+        out.type = Json::Type::Object;   // none yet
+        return true;
+    }
+    std::string error;
+    if (!parseJson(text, out, error) || out.type != Json::Type::Object) {
+        std::fprintf(stderr, "bench_runner: %s: %s\n", path.c_str(), error.empty() ? "not an object" : error.c_str());
+        return false;
+    }
+    return true;
+}
+
+void appendNumber(std::string& out, const char* name, double value, bool last) {
+    char text[64];
+    std::snprintf(text, sizeof(text), "\"%s\": %.4f%s", name, value, last ? "" : ", ");
+    out += text;
+}
+
+bool saveBaseline(const std::string& path, const Json& baseline, const std::string& device,
+                  const std::vector<Result>& results) {
+    std::string out = "{\n";
+    bool first = true;
+    auto openDevice = [&](const std::string& name) {
+        out += first ? "  " : ",\n  ";
+        first = false;
+        appendJsonString(out, name);
+        out += ": {\n";
+    };
+    for (const auto& member : baseline.object) {
+        if (member.first == device || member.second.type != Json::Type::Object) {
+            continue;
+        }
+        openDevice(member.first);
+        for (std::size_t i = 0; i < member.second.object.size(); ++i) {
+            const auto& entry = member.second.object[i];
+            out += "    ";
+            appendJsonString(out, entry.first);
+            out += ": {";
+            appendNumber(out, "avg", entry.second.numberOr("avg", 0.0), false);
+            appendNumber(out, "p50", entry.second.numberOr("p50", 0.0), false);
+            appendNumber(out, "p99", entry.second.numberOr("p99", 0.0), false);
+            appendNumber(out, "draws", entry.second.numberOr("draws", 0.0), true);
+            out += i + 1 < member.second.object.size() ? "},\n" : "}\n";
+        }
+        out += "  }";
+    }
+    openDevice(device);
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        out += "    ";
+        appendJsonString(out, r.key);
+        out += ": {";
+        appendNumber(out, "avg", r.avg, false);
+        appendNumber(out, "p50", r.p50, false);
+        appendNumber(out, "p99", r.p99, false);
+        appendNumber(out, "draws", r.draws, true);
+        out += i + 1 < results.size() ? "},\n" : "}\n";
+    }
+    out += "  }\n}\n";
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file || std::fwrite(out.data(), 1, out.size(), file) != out.size() || std::fclose(file) != 0) {
+        std::fprintf(stderr, "bench_runner: cannot write %s\n", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+double change(double now, double before) {
+    return before > 0.0 ? (now - before) / before * 100.0 : 0.0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Settings settings;
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (std::strcmp(arg, "--") == 0) {
+            for (++i; i < argc; ++i) {
+                settings.extra += std::string(" ") + argv[i];
+            }
+        } else if (std::strncmp(arg, "--game=", 7) == 0) {
+            settings.game = arg + 7;
+        } else if (std::strncmp(arg, "--baseline=", 11) == 0) {
+            settings.baseline = arg + 11;
+        } else if (std::strncmp(arg, "--threshold=", 12) == 0) {
+            settings.threshold = std::atof(arg + 12);
+        } else if (std::strncmp(arg, "--frames=", 9) == 0) {
+            settings.frames = std::max(1, std::atoi(arg + 9));
+        } else if (std::strncmp(arg, "--quads=", 8) == 0) {
+            settings.quads = std::max(1, std::atoi(arg + 8));
+        } else if (std::strcmp(arg, "--update") == 0) {
+            settings.update = true;
+        } else {
+            std::fprintf(stderr,
+                         "usage: %s [--game=./game] [--baseline=FILE] [--threshold=PCT] [--frames=N] [--quads=N] "
+                         "[--update] [-- GAME ARGS...]\n",
+                         argv[0]);
+            return 1;
+        }
+    }
+
+    Json baseline;
+    if (!loadBaseline(settings.baseline, baseline)) {
+        return 1;
+    }
+    std::string device;
+    std::vector<Result> results;
+    bool failed = false;
+    for (const Case& c : cases(settings)) {
+        Result result;
+        std::string caseDevice;
+        if (!run(settings, c, caseDevice, result)) {
+            failed = true;
+            continue;
+        }
+        if (!device.empty() && caseDevice != device) {
+            std::fprintf(stderr, "bench_runner: %s ran on \"%s\", not \"%s\"\n", c.key.c_str(), caseDevice.c_str(),
+                         device.c_str());
+            return 1;
+        }
+        device = caseDevice;
+        results.push_back(result);
+    }
+    if (results.empty()) {
+        std::fprintf(stderr, "bench_runner: no case ran\n");
+        return 1;
+    }
+    if (device.empty()) {
+        device = "unknown";
+    }
+
+    std::printf("device: %s\n", device.c_str());
+    const Json* reference = baseline.find(device.c_str());
+    if (settings.update) {
+        for (const Result& r : results) {
+            std::printf("  %-28s avg %8.3f  p99 %8.3f  draws %6.1f\n", r.key.c_str(), r.avg, r.p99, r.draws);
+        }
+        if (!saveBaseline(settings.baseline, baseline, device, results)) {
+            return 1;
+        }
+        std::printf("baseline %s: %zu cases %s\n", settings.baseline.c_str(), results.size(),
+                    reference ? "replaced" : "added");
+        return failed ? 1 : 0;
+    }
+    if (!reference || reference->type != Json::Type::Object) {
+        for (const Result& r : results) {
+            std::printf("  %-28s avg %8.3f  p99 %8.3f  draws %6.1f\n", r.key.c_str(), r.avg, r.p99, r.draws);
+        }
+        std::printf("no baseline for this device in %s: run with --update to store one\n", settings.baseline.c_str());
+        return 2;
+    }
+
+    int regressions = 0;
+    std::printf("  %-28s %21s %21s\n", "case", "avg ms (change)", "p99 ms (change)");
+    for (const Result& r : results) {
+        const Json* before = reference->find(r.key.c_str());
+        if (!before) {
+            std::printf("  %-28s %8.3f %12s %8.3f\n", r.key.c_str(), r.avg, "(new)", r.p99);
+            continue;
+        }
+        const double avgChange = change(r.avg, before->numberOr("avg", 0.0));
+        const double p99Change = change(r.p99, before->numberOr("p99", 0.0));
+        const bool regressed = avgChange > settings.threshold || p99Change > settings.threshold;
+        regressions += regressed ? 1 : 0;
+        std::printf("  %-28s %8.3f (%+7.1f%%) %8.3f (%+7.1f%%)%s\n", r.key.c_str(), r.avg, avgChange, r.p99, p99Change,
+                    regressed ? "  REGRESSION" : "");
+    }
+    std::printf("%d of %zu cases over +%.1f%%\n", regressions, results.size(), settings.threshold);
+    return regressions > 0 || failed ? 1 : 0;
+}
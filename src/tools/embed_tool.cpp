@@ -0,0 +1,75 @@
+// embed_tool: turns files into C++ byte arrays (src/core/embedded_files.h).
+//
+//     ./embed_tool OUT.cpp TABLE FILE...
+//
+// Writes one `alignas(16) const unsigned char` array per FILE and `TABLE[]` /
+// `TABLE` + "Count", the EmbeddedFile entries sorted by path (vfs::mountEmbedded
+// binary-searches them). Paths are stored as given: run it from the directory the game
+// runs in, e.g. `./embed_tool src/generated/embedded_shaders.cpp kEmbeddedShaders
+// shaders/*.glsl`. The Makefile does that for EMBED_SHADERS=1 builds.
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "core/file_io.h"
+#include "core/vfs.h"
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::fprintf(stderr, "usage: %s OUT.cpp TABLE FILE...\n", argv[0]);
+        return 1;
+    }
+    const std::string output = argv[1];
+    const std::string table = argv[2];
+    std::vector<std::string> files;
+    for (int i = 3; i < argc; ++i) {
+        files.push_back(vfs::normalize(argv[i]));
+    }
+    std::sort(files.begin(), files.end());
+    files.erase(std::unique(files.begin(), files.end()), files.end());
+
+    std::string text = "// Generated by embed_tool (src/tools/embed_tool.cpp). Do not edit.\n\n"
+                       "#include \"core/embedded_files.h\"\n\nnamespace {\n\n";
+    std::vector<std::size_t> sizes;
+    char hex[16];
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        std::vector<unsigned char> bytes;
+        if (!readFile(files[i], bytes)) {
+            std::fprintf(stderr, "cannot read %s\n", files[i].c_str());
+            return 1;
+        }
+        sizes.push_back(bytes.size());
+        text += "// " + files[i] + "\nalignas(16) const unsigned char kFile" + std::to_string(i) + "[] = {";
+        bytes.push_back(0); // the terminator mentioned in embedded_files.h
+        for (std::size_t k = 0; k < bytes.size(); ++k) {
+            std::snprintf(hex, sizeof(hex), "%s0x%02x,", k % 16 == 0 ? "\n    " : "", bytes[k]);
+            text += hex;
+        }
+        text += "\n};\n\n";
+    }
+    text += "} // namespace\n\nextern const EmbeddedFile " + table + "[] = {\n";
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        // The path goes in as a string literal: escape what could break one.
+        std::string literal;
+        for (char c : files[i]) {
+            if (c == '"' || c == '\\') literal += '\\';
+            literal += c;
+        }
+        text += "    {\"" + literal + "\", kFile" + std::to_string(i) + ", " + std::to_string(sizes[i]) + "},\n";
+    }
+    if (files.empty()) {
+        text += "    {\"\", nullptr, 0},\n"; // no zero-length arrays; Count stays 0
+    }
+    text += "};\nextern const std::size_t " + table + "Count = " + std::to_string(files.size()) + ";\n";
+
+    std::FILE* file = std::fopen(output.c_str(), "wb");
+    if (!file || std::fwrite(text.data(), 1, text.size(), file) != text.size()) {
+        std::fprintf(stderr, "cannot write %s\n", output.c_str());
+        if (file) std::fclose(file);
+        return 1;
+    }
+    std::fclose(file);
+    return 0;
+}
@@ -0,0 +1,244 @@
+// golden_runner: the renderer's visual regression test. Renders one frame of every stress
+// scene on every renderer path (the game's headless benchmark, src/bench/bench.h, captured
+// by --capture, render/frame_capture.h) and compares each with a stored golden frame by
+// a perceptual diff (asset/image_diff.h), so a batching, format or resolution change that
+// alters the picture fails here instead of shipping.
+//
+//     ./golden_runner [--game=./game | --soft=./soft_bench] [--goldens=goldens] [--out=DIR]
+//                     [--threshold=T] [--tolerance=PCT] [--quads=N] [--update] [-- GAME ARGS...]
+//
+// | Case                         | Game arguments                                         |
+// | ---------------------------- | ------------------------------------------------------ |
+// | {moving, static, overlap} x  | --bench-scene=S --bench-path=P --bench-quads=N         |
+// | {instanced, affine, layered, |                                                        |
+// | batched}                     |                                                        |
+// | tilemap, per chunk / MDI     | --bench-scene=tilemap --bench-tiles=256x256, with      |
+// |                              | --gl-tier=streaming and gpu-driven                     |
+// | moving, half resolution      | --render-scale=0.5: the offscreen scene and its        |
+// |                              | upscale                                                |
+// | --soft: {moving, static,     | soft_bench's CPU rasterizer (render/soft_raster.h): no |
+// | overlap}                     | GPU needed, its own goldens (soft-*.png)               |
+//
+// Every case is its own run, frame 0 of the bench (the scenes are deterministic: the same
+// frame every run). The golden is GOLDENS/<case>.png, the case's key with '/' as '-'. A
+// case fails when more than --tolerance percent (default 0.01) of its pixels are over
+// the perceptual --threshold (default 0.1; 0 is byte equality), or the sizes differ; its
+// capture and a picture of the difference (red: the failing pixels) are left in --out
+// (default golden_out) as <case>.png and <case>-diff.png.
+//
+// Exit status: 0 every case matches, 1 a mismatch (or a run failed), 2 a case has no
+// golden yet. --update stores this run's frames as the goldens and exits 0. Goldens are
+// one set for every device: the threshold absorbs rounding differences between GPUs,
+// a real change of the picture is far over it.
+//
+// Like bench_runner, it needs a display for the game: BENCH_RUN=xvfb-run in `make
+// visual-regress`. --soft doesn't.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "asset/image.h"
+#include "asset/image_diff.h"
+#include "core/file_io.h"
+
+namespace {
+
+struct Case {
+    std::string key;                   // "scene/path": the golden's name for it
+    std::string args;
+};
+
+struct Settings {
+    std::string game = "./game";
+    std::string soft;                  // soft_bench instead of the game
+    std::string goldens = "goldens";
+    std::string out = "golden_out";
+    std::string extra;                 // after --: appended to every run
+    double threshold = 0.1;            // perceptual, 0..1
+    double tolerance = 0.01;           // percent of the pixels
+    int quads = 2000;
+    bool update = false;
+};
+
+std::vector<Case> cases(const Settings& settings) {
+    std::vector<Case> list;
+    const std::string n = " --bench-quads=" + std::to_string(settings.quads);
+    if (!settings.soft.empty()) {
+        for (const char* scene : {"moving", "static", "overlap"}) {
+            list.push_back(Case{std::string("soft/") + scene, std::string("--bench-scene=") + scene + n});
+        }
+        return list;
+    }
+    for (const char* scene : {"moving", "static", "overlap"}) {
+        for (const char* path : {"instanced", "affine", "layered", "batched"}) {
+            list.push_back(Case{std::string(scene) + "/" + path,
+                                std::string("--bench-scene=") + scene + " --bench-path=" + path + n});
+        }
+    }
+    list.push_back(Case{"tilemap/chunks", "--bench-scene=tilemap --bench-tiles=256x256 --gl-tier=streaming"});
+    list.push_back(Case{"tilemap/mdi", "--bench-scene=tilemap --bench-tiles=256x256 --gl-tier=gpu-driven"});
+    list.push_back(Case{"moving/half-resolution", "--bench-scene=moving --bench-path=instanced --render-scale=0.5" + n});
+    return list;
+}
+
+std::string fileName(const std::string& key) {
+    std::string name = key;
+    std::replace(name.begin(), name.end(), '/', '-');
+    return name;
+}
+
+bool loadPng(const std::string& path, Image& image, std::string& error) {
+    std::vector<unsigned char> bytes;
+    if (!readFile(path, bytes)) {
+        error = "cannot open " + path;
+        return false;
+    }
+    if (!decodeImage(bytes.data(), bytes.size(), image, &error)) {
+        error = path + ": " + error;
+        return false;
+    }
+    return true;
+}
+
+bool savePng(const std::string& path, const Image& image) {
+    std::vector<unsigned char> png;
+    encodePng(image, png);
+    FILE* file = std::fopen(path.c_str(), "wb");
+    return file && std::fwrite(png.data(), 1, png.size(), file) == png.size() && std::fclose(file) == 0;
+}
+
+// One run: the case's frame rendered and written to `path`.
+bool render(const Settings& settings, const Case& c, const std::string& path) {
+    std::error_code ec;
+    std::string command;
+    std::string written;               // where the run writes it
+    if (!settings.soft.empty()) {
+        written = path;
+        command = settings.soft + " --bench-warmup=0 --bench-frames=1 --out=" + path + " " + c.args;
+    } else {
+        const std::string directory = settings.out + "/" + fileName(c.key) + ".capture";
+        std::filesystem::remove_all(directory, ec);
+        written = directory + "/frame_000000.png";
+        command = settings.game + " --bench --bench-warmup=0 --bench-frames=1 --capture=png --capture-frames=1" +
+                  " --capture-dir=" + directory + " " + c.args + settings.extra;
+    }
+    std::filesystem::remove(path, ec);
+    command += " > /dev/null 2>&1";
+    if (std::system(command.c_str()) != 0) {
+        std::fprintf(stderr, "golden_runner: %s: the run failed (%s)\n", c.key.c_str(), command.c_str());
+        return false;
+    }
+    if (written != path) {
+        std::filesystem::rename(written, path, ec);
+        std::filesystem::remove_all(std::filesystem::path(written).parent_path(), ec);
+    }
+    if (!std::filesystem::exists(path)) {
+        std::fprintf(stderr, "golden_runner: %s: no frame was captured\n", c.key.c_str());
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Settings settings;
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (std::strcmp(arg, "--") == 0) {
+            for (++i; i < argc; ++i) {
+                settings.extra += std::string(" ") + argv[i];
+            }
+        } else if (std::strncmp(arg, "--game=", 7) == 0) {
+            settings.game = arg + 7;
+        } else if (std::strncmp(arg, "--soft=", 7) == 0) {
+            settings.soft = arg + 7;
+        } else if (std::strncmp(arg, "--goldens=", 10) == 0) {
+            settings.goldens = arg + 10;
+        } else if (std::strncmp(arg, "--out=", 6) == 0) {
+            settings.out = arg + 6;
+        } else if (std::strncmp(arg, "--threshold=", 12) == 0) {
+            settings.threshold = std::clamp(std::atof(arg + 12), 0.0, 1.0);
+        } else if (std::strncmp(arg, "--tolerance=", 12) == 0) {
+            settings.tolerance = std::max(0.0, std::atof(arg + 12));
+        } else if (std::strncmp(arg, "--quads=", 8) == 0) {
+            settings.quads = std::max(1, std::atoi(arg + 8));
+        } else if (std::strcmp(arg, "--update") == 0) {
+            settings.update = true;
+        } else {
+            std::fprintf(stderr,
+                         "usage: %s [--game=./game | --soft=./soft_bench] [--goldens=DIR] [--out=DIR] [--threshold=T] "
+                         "[--tolerance=PCT] [--quads=N] [--update] [-- GAME ARGS...]\n",
+                         argv[0]);
+            return 1;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(settings.out, ec);
+    std::filesystem::create_directories(settings.goldens, ec);
+    int failures = 0, missing = 0, passed = 0;
+    std::printf("  %-28s %12s %12s\n", "case", "different", "max distance");
+    for (const Case& c : cases(settings)) {
+        const std::string name = fileName(c.key);
+        const std::string actualPath = settings.out + "/" + name + ".png";
+        const std::string goldenPath = settings.goldens + "/" + name + ".png";
+        if (!render(settings, c, actualPath)) {
+            ++failures;
+            continue;
+        }
+        if (settings.update) {
+            std::filesystem::copy_file(actualPath, goldenPath, std::filesystem::copy_options::overwrite_existing, ec);
+            if (ec) {
+                std::fprintf(stderr, "golden_runner: cannot write %s\n", goldenPath.c_str());
+                ++failures;
+                continue;
+            }
+            std::printf("  %-28s %12s\n", c.key.c_str(), "(stored)");
+            continue;
+        }
+        if (!std::filesystem::exists(goldenPath)) {
+            std::printf("  %-28s %12s\n", c.key.c_str(), "(no golden)");
+            ++missing;
+            continue;
+        }
+        Image golden, actual, visual;
+        std::string error;
+        if (!loadPng(goldenPath, golden, error) || !loadPng(actualPath, actual, error)) {
+            std::fprintf(stderr, "golden_runner: %s: %s\n", c.key.c_str(), error.c_str());
+            ++failures;
+            continue;
+        }
+        ImageDiff diff;
+        if (!diffImages(golden, actual, static_cast<float>(settings.threshold), diff, &visual)) {
+            std::printf("  %-28s %dx%d, the golden is %dx%d  FAIL\n", c.key.c_str(), actual.width, actual.height,
+                        golden.width, golden.height);
+            ++failures;
+            continue;
+        }
+        const double percent = diff.pixels > 0 ? 100.0 * static_cast<double>(diff.different) / diff.pixels : 0.0;
+        const bool failed = percent > settings.tolerance;
+        std::printf("  %-28s %11.3f%% %12.4f%s\n", c.key.c_str(), percent, diff.maxDistance, failed ? "  FAIL" : "");
+        if (failed) {
+            ++failures;
+            savePng(settings.out + "/" + name + "-diff.png", visual);
+        } else {
+            ++passed;
+        }
+    }
+    if (settings.update) {
+        std::printf("goldens %s/: stored%s\n", settings.goldens.c_str(), failures > 0 ? ", some runs failed" : "");
+        return failures > 0 ? 1 : 0;
+    }
+    std::printf("%d passed, %d failed, %d without a golden (differences in %s/)\n", passed, failures, missing,
+                settings.out.c_str());
+    if (missing > 0 && failures == 0) {
+        std::printf("run with --update to store the missing goldens\n");
+    }
+    return failures > 0 ? 1 : (missing > 0 ? 2 : 0);
+}
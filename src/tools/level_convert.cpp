@@ -0,0 +1,300 @@
+// level_convert: converts a Tiled map (JSON, .tmj) into a level file (src/core/level_file.h).
+//
+//     ./level_convert [--tiles-per-region=N] [--tile-size=U] MAP.tmj OUT.lvl
+//
+// Everything the game would otherwise work out at load time is done here, once:
+//
+// | Tiled                              | Level file                                       |
+// | ---------------------------------- | ------------------------------------------------ |
+// | tile layers (CSV data, any number) | tile layers, rows flipped to the game's y-up     |
+// | gids, tilesets (embedded or .tsj)  | asset names: a tile's "asset" property, else     |
+// |                                    | "<tileset name>/<id + 1>" ("shape/3"), resolved  |
+// |                                    | once; a tileset named "shape" is the game's own  |
+// | tile objects in object layers      | entities at their centre (Tiled's pivot is the   |
+// |                                    | bottom-left corner, rotation clockwise degrees), |
+// |                                    | bucketed into regions, stored in draw order      |
+// | object "color" / "z" properties    | Color, ZLayer; "z" on the layer for all of its   |
+// |                                    | objects, else the object layer's index           |
+//
+// Pixels become world units through the tile grid: one tile is --tile-size units (default
+// 0.25), and --tiles-per-region tiles (default 16) make a region's side. The map is
+// centred on the origin. Group layers are walked; flip bits are dropped (the tilemap and
+// the sprite path draw tiles unflipped), as are objects without a gid.
+//
+// `make level_convert` builds it.
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "core/file_io.h"
+#include "core/json.h"
+#include "core/level_file.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+bool loadJson(const std::string& path, Json& out) {
+    std::string text;
+    if (!readFile(path, text)) {
+        std::fprintf(stderr, "cannot read %s\n", path.c_str());
+        return false;
+    }
+    std::string error;
+    if (!parseJson(text, out, error)) {
+        std::fprintf(stderr, "%s: %s\n", path.c_str(), error.c_str());
+        return false;
+    }
+    return true;
+}
+
+// Tiled's gid flag bits (flips, hex rotation); the rest is the gid.
+constexpr std::uint32_t kGidFlags = 0xf0000000u;
+
+// Tiled "properties": [{"name", "type", "value"}].
+const Json* property(const Json& owner, const char* name) {
+    for (const Json& p : owner.arrayOf("properties")) {
+        if (p.stringOr("name", "") == name) return p.find("value");
+    }
+    return nullptr;
+}
+
+// "#AARRGGBB" or "#RRGGBB" (Tiled's color properties) to 0xAABBGGRR, as Color.
+bool parseColor(const std::string& text, std::uint32_t& rgba) {
+    if (text.size() != 7 && text.size() != 9) return false;
+    if (text[0] != '#') return false;
+    char* end = nullptr;
+    const unsigned long argb = std::strtoul(text.c_str() + 1, &end, 16);
+    if (*end != '\0') return false;
+    const std::uint32_t a = text.size() == 9 ? (argb >> 24) & 0xffu : 0xffu;
+    const std::uint32_t r = (argb >> 16) & 0xffu, g = (argb >> 8) & 0xffu, b = argb & 0xffu;
+    rgba = r | g << 8 | b << 16 | a << 24;
+    return true;
+}
+
+struct Converter {
+    LevelWriter* writer = nullptr;
+    // gid → asset index, or ~0u for an unknown gid.
+    std::vector<std::uint32_t> assets;
+    int mapHeight = 0;                 // tiles
+    float tileSize = 0.25f;
+    glm::vec2 tilePixels{16.0f};
+    glm::vec2 origin{0.0f};
+    int tileLayer = 0;
+    int objectLayer = 0;
+    std::size_t tiles = 0, entities = 0, flipped = 0, skipped = 0, unknown = 0;
+
+    bool tilesets(const Json& map, const std::string& mapPath) {
+        for (const Json& ref : map.arrayOf("tilesets")) {
+            const double firstGid = ref.numberOr("firstgid", 0.0);
+            Json external;
+            const Json* tileset = &ref;
+            const std::string source = ref.stringOr("source", "");
+            if (!source.empty()) {
+                const std::string path = (fs::path(mapPath).parent_path() / source).generic_string();
+                if (!loadJson(path, external)) return false;
+                tileset = &external;
+            }
+            const int count = static_cast<int>(tileset->numberOr("tilecount", 0.0));
+            if (firstGid < 1.0 || count <= 0 || firstGid + count > double(kGidFlags)) {
+                std::fprintf(stderr, "tileset '%s': bad firstgid or tilecount\n",
+                             tileset->stringOr("name", source).c_str());
+                return false;
+            }
+            const std::string name = tileset->stringOr("name", "tileset");
+            const std::size_t first = static_cast<std::size_t>(firstGid);
+            if (assets.size() < first + count) assets.resize(first + count, ~0u);
+            for (int id = 0; id < count; ++id) {
+                assets[first + id] = writer->asset(name + "/" + std::to_string(id + 1));
+            }
+            // Per-tile overrides: "tiles": [{"id", "properties"}].
+            for (const Json& tile : tileset->arrayOf("tiles")) {
+                const int id = static_cast<int>(tile.numberOr("id", -1.0));
+                const Json* asset = property(tile, "asset");
+                if (id >= 0 && id < count && asset && asset->type == Json::Type::String) {
+                    assets[first + id] = writer->asset(asset->string);
+                }
+            }
+        }
+        return true;
+    }
+
+    std::uint32_t resolve(double value) {
+        const std::uint32_t raw = static_cast<std::uint32_t>(value);
+        flipped += (raw & kGidFlags) != 0;
+        const std::uint32_t gid = raw & ~kGidFlags;
+        if (gid >= assets.size() || assets[gid] == ~0u) {
+            ++unknown;
+            return ~0u;
+        }
+        return assets[gid];
+    }
+
+    bool layers(const std::vector<Json>& list) {
+        for (const Json& layer : list) {
+            const std::string type = layer.stringOr("type", "");
+            const std::string name = layer.stringOr("name", "");
+            if (type == "group") {
+                if (!layers(layer.arrayOf("layers"))) return false;
+            } else if (type == "tilelayer") {
+                if (!tileLayerData(layer, name)) return false;
+            } else if (type == "objectgroup") {
+                objects(layer);
+            }
+        }
+        return true;
+    }
+
+    bool tileLayerData(const Json& layer, const std::string& name) {
+        if (layer.find("chunks")) {
+            std::fprintf(stderr, "layer '%s': infinite maps are not supported\n", name.c_str());
+            return false;
+        }
+        const Json* data = layer.find("data");
+        if (!data || data->type != Json::Type::Array) {
+            std::fprintf(stderr, "layer '%s': save the map with CSV tile layer format\n", name.c_str());
+            return false;
+        }
+        const int width = static_cast<int>(layer.numberOr("width", 0.0));
+        for (std::size_t i = 0; i < data->array.size() && width > 0; ++i) {
+            if (data->array[i].number == 0.0) continue;
+            const std::uint32_t asset = resolve(data->array[i].number);
+            if (asset == ~0u) continue;
+            const int x = static_cast<int>(i % width);
+            const int y = mapHeight - 1 - static_cast<int>(i / width);   // Tiled's rows go down
+            writer->setTile(tileLayer, x, y, static_cast<std::uint16_t>(asset + 1));
+            ++tiles;
+        }
+        ++tileLayer;
+        return true;
+    }
+
+    void objects(const Json& layer) {
+        const Json* layerZ = property(layer, "z");
+        const std::uint16_t z = static_cast<std::uint16_t>(
+            layerZ && layerZ->type == Json::Type::Number ? layerZ->number : objectLayer);
+        ++objectLayer;
+        for (const Json& object : layer.arrayOf("objects")) {
+            if (!object.find("gid")) {
+                ++skipped;
+                continue;
+            }
+            const std::uint32_t asset = resolve(object.numberOr("gid", 0.0));
+            if (asset == ~0u) continue;
+            // The pivot is the bottom-left corner in Tiled's y-down pixels; the centre is
+            // half a size up and right of it, turned with the object.
+            const glm::vec2 size(object.numberOr("width", tilePixels.x), object.numberOr("height", tilePixels.y));
+            const float degrees = static_cast<float>(object.numberOr("rotation", 0.0));
+            const float radians = degrees * 3.14159265f / 180.0f;
+            const glm::vec2 half(0.5f * size.x, -0.5f * size.y);
+            const glm::vec2 turned(half.x * std::cos(radians) - half.y * std::sin(radians),
+                                   half.x * std::sin(radians) + half.y * std::cos(radians));
+            const glm::vec2 centre =
+                glm::vec2(object.numberOr("x", 0.0), object.numberOr("y", 0.0)) + turned;
+
+            LevelWriter::Entity entity;
+            entity.position = origin + glm::vec2(centre.x / tilePixels.x, mapHeight - centre.y / tilePixels.y) * tileSize;
+            entity.rotation = -radians;   // clockwise on screen in y-down: counter-clockwise negated
+            entity.scale = size / tilePixels * tileSize;
+            entity.asset = asset;
+            entity.zLayer = z;
+            const Json* zValue = property(object, "z");
+            if (zValue && zValue->type == Json::Type::Number) {
+                entity.zLayer = static_cast<std::uint16_t>(zValue->number);
+            }
+            const Json* color = property(object, "color");
+            if (color && color->type == Json::Type::String && !parseColor(color->string, entity.color)) {
+                std::fprintf(stderr, "object %d: bad color '%s', white used\n",
+                             static_cast<int>(object.numberOr("id", 0.0)), color->string.c_str());
+            }
+            writer->add(entity);
+            ++entities;
+        }
+    }
+};
+
+int countTileLayers(const std::vector<Json>& list) {
+    int count = 0;
+    for (const Json& layer : list) {
+        const std::string type = layer.stringOr("type", "");
+        count += type == "tilelayer" ? 1 : type == "group" ? countTileLayers(layer.arrayOf("layers")) : 0;
+    }
+    return count;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int tilesPerRegion = 16;
+    float tileSize = 0.25f;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg.rfind("--tiles-per-region=", 0) == 0) {
+            tilesPerRegion = std::atoi(arg.c_str() + 19);
+        } else if (arg.rfind("--tile-size=", 0) == 0) {
+            tileSize = static_cast<float>(std::atof(arg.c_str() + 12));
+        } else {
+            paths.push_back(arg);
+        }
+    }
+    if (paths.size() != 2 || tilesPerRegion < 1 || tilesPerRegion > 256 || !(tileSize > 0.0f)) {
+        std::fprintf(stderr, "usage: %s [--tiles-per-region=N (1..256)] [--tile-size=U] MAP.tmj OUT.lvl\n", argv[0]);
+        return 1;
+    }
+    const std::string& input = paths[0];
+    const std::string& output = paths[1];
+
+    Json map;
+    if (!loadJson(input, map)) {
+        return 1;
+    }
+    const int width = static_cast<int>(map.numberOr("width", 0.0));
+    const int height = static_cast<int>(map.numberOr("height", 0.0));
+    if (map.stringOr("orientation", "orthogonal") != "orthogonal" || width <= 0 || height <= 0 ||
+        (map.find("infinite") && map.find("infinite")->boolean)) {
+        std::fprintf(stderr, "%s: only finite orthogonal maps are supported\n", input.c_str());
+        return 1;
+    }
+
+    const int regionsX = (width + tilesPerRegion - 1) / tilesPerRegion;
+    const int regionsY = (height + tilesPerRegion - 1) / tilesPerRegion;
+    const int tileLayers = countTileLayers(map.arrayOf("layers"));
+    const glm::vec2 origin = -0.5f * glm::vec2(width, height) * tileSize;
+    LevelWriter writer(regionsX, regionsY, tilesPerRegion * tileSize, origin, tileLayers > 0 ? tilesPerRegion : 0,
+                       tileLayers);
+
+    Converter converter;
+    converter.writer = &writer;
+    converter.mapHeight = height;
+    converter.tileSize = tileSize;
+    converter.tilePixels = glm::vec2(map.numberOr("tilewidth", 16.0), map.numberOr("tileheight", 16.0));
+    converter.origin = origin;
+    if (!converter.tilesets(map, input) || !converter.layers(map.arrayOf("layers"))) {
+        return 1;
+    }
+    if (converter.flipped > 0) {
+        std::fprintf(stderr, "%zu flipped tiles or objects: drawn unflipped\n", converter.flipped);
+    }
+    if (converter.unknown > 0) {
+        std::fprintf(stderr, "%zu gids in no tileset: dropped\n", converter.unknown);
+    }
+    if (converter.skipped > 0) {
+        std::fprintf(stderr, "%zu objects without a tile (gid): dropped\n", converter.skipped);
+    }
+
+    std::string error;
+    if (!writer.write(output, &error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    std::printf("%s: %d x %d regions, %d tile layers, %zu tiles, %zu entities\n", output.c_str(), regionsX,
+                regionsY, tileLayers, converter.tiles, converter.entities);
+    return 0;
+}
@@ -0,0 +1,97 @@
+// level_tool: generates a level file (src/core/level_file.h) to stream with --level.
+//
+//     ./level_tool [--regions=N] [--props=N] OUT.lvl
+//
+// An N x N grid (default 16) of 4 x 4-unit regions centred on the origin. Every region
+// gets a two-layer tile floor (16 x 16 tiles: a checkerboard of rings and diamonds, and
+// now and then a disc on the upper layer) and --props=N (default 400) scattered shapes.
+// Assets are named "shape/K", the sprite ids the game generates (main.cpp's
+// buildSpriteAtlas), so the game resolves them without loading anything.
+//
+// `make level` writes world.lvl with the defaults: 256 regions, ~100k props, ~3 MB.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "core/level_file.h"
+
+namespace {
+
+constexpr int kShapes = 96;            // main.cpp's kSpriteShapes
+constexpr float kRegionSize = 4.0f;
+constexpr int kTilesPerRegion = 16;
+
+std::uint32_t packRgba(float r, float g, float b, float a) {
+    auto byte = [](float v) { return static_cast<std::uint32_t>(v * 255.0f + 0.5f); };
+    return byte(r) | byte(g) << 8 | byte(b) << 16 | byte(a) << 24;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int regions = 16;
+    int props = 400;
+    std::string output;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg.rfind("--regions=", 0) == 0) {
+            regions = std::atoi(arg.c_str() + 10);
+        } else if (arg.rfind("--props=", 0) == 0) {
+            props = std::atoi(arg.c_str() + 8);
+        } else {
+            output = arg;
+        }
+    }
+    if (output.empty() || regions < 1 || regions > 1024 || props < 0) {
+        std::fprintf(stderr, "usage: %s [--regions=N (1..1024)] [--props=N] OUT.lvl\n", argv[0]);
+        return 1;
+    }
+
+    const glm::vec2 origin(-0.5f * kRegionSize * regions);
+    LevelWriter writer(regions, regions, kRegionSize, origin, kTilesPerRegion, 2);
+    std::uint32_t shapes[kShapes + 1];
+    for (int k = 1; k <= kShapes; ++k) {
+        shapes[k] = writer.asset("shape/" + std::to_string(k));
+    }
+
+    // Tiles: asset + 1 (0 is empty), the same pattern as --tilemap's.
+    const int tiles = regions * kTilesPerRegion;
+    for (int y = 0; y < tiles; ++y) {
+        for (int x = 0; x < tiles; ++x) {
+            writer.setTile(0, x, y, static_cast<std::uint16_t>(shapes[((x + y) & 1) ? 2 : 3] + 1));
+            const std::uint32_t hash = (static_cast<std::uint32_t>(x) * 73856093u) ^
+                                       (static_cast<std::uint32_t>(y) * 19349663u);
+            if ((hash >> 4) % 16 == 0) {
+                writer.setTile(1, x, y, static_cast<std::uint16_t>(shapes[1 + 3 * (hash % 32)] + 1));
+            }
+        }
+    }
+
+    std::uint32_t rng = 4321u;
+    auto next = [&rng] { // [0, 1)
+        rng = rng * 1664525u + 1013904223u;
+        return static_cast<float>(rng >> 8) * (1.0f / 16777216.0f);
+    };
+    const float extent = kRegionSize * regions;
+    const long long total = static_cast<long long>(props) * regions * regions;
+    for (long long i = 0; i < total; ++i) {
+        LevelWriter::Entity entity;
+        entity.position = origin + glm::vec2(next(), next()) * extent;
+        entity.rotation = next() * 6.2831853f;
+        entity.scale = glm::vec2(0.04f + 0.08f * next());
+        entity.color = packRgba(0.6f + 0.4f * next(), 0.6f + 0.4f * next(), next(), 1.0f);
+        entity.asset = shapes[1 + i % kShapes];
+        entity.zLayer = static_cast<std::uint16_t>(i % 4);
+        writer.add(entity);
+    }
+
+    std::string error;
+    if (!writer.write(output, &error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    std::printf("%s: %d x %d regions, %lld props\n", output.c_str(), regions, regions, total);
+    return 0;
+}
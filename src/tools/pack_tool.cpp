@@ -0,0 +1,94 @@
+// pack_tool: builds a pack file (src/core/pack_file.h) from loose asset files.
+//
+//     ./pack_tool [--store] OUT.pak PATH...
+//
+// Each PATH is a file or a directory (walked recursively, dot-files skipped). Entries
+// are named by the path as given, so run it from the directory the game runs in:
+// `./pack_tool assets.pak shaders textures` stores "shaders/vertex.glsl" etc., the same
+// strings the loaders ask the VFS for. Files are LZ4-compressed where that saves at
+// least 1/16 of their size; --store keeps everything uncompressed (zero-copy reads).
+//
+// `make pack` runs it on shaders/ into assets.pak; the game reads it with --pack=FILE.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "core/file_io.h"
+#include "core/pack_file.h"
+#include "core/vfs.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+bool hidden(const fs::path& path) {
+    const std::string name = path.filename().string();
+    return !name.empty() && name[0] == '.';
+}
+
+void collect(const fs::path& path, std::vector<std::string>& files) {
+    std::error_code ec;
+    if (fs::is_directory(path, ec)) {
+        for (fs::recursive_directory_iterator it(path, ec), end; it != end; it.increment(ec)) {
+            if (hidden(it->path())) {
+                if (it->is_directory(ec)) it.disable_recursion_pending();
+                continue;
+            }
+            if (it->is_regular_file(ec)) files.push_back(vfs::normalize(it->path().generic_string()));
+        }
+    } else {
+        files.push_back(vfs::normalize(path.generic_string()));
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bool compress = true;
+    int first = 1;
+    if (first < argc && std::strcmp(argv[first], "--store") == 0) {
+        compress = false;
+        ++first;
+    }
+    if (argc - first < 2) {
+        std::fprintf(stderr, "usage: %s [--store] OUT.pak PATH...\n", argv[0]);
+        return 1;
+    }
+    const std::string output = argv[first];
+
+    std::vector<std::string> files;
+    for (int i = first + 1; i < argc; ++i) {
+        collect(argv[i], files);
+    }
+    std::sort(files.begin(), files.end());
+    files.erase(std::unique(files.begin(), files.end()), files.end());
+
+    PackWriter writer;
+    std::size_t original = 0, stored = 0;
+    for (const std::string& file : files) {
+        std::vector<unsigned char> bytes;
+        if (!readFile(file, bytes)) {
+            std::fprintf(stderr, "cannot read %s\n", file.c_str());
+            return 1;
+        }
+        if (bytes.size() > 0xFFFFFFFFu || file.size() > 0xFFFFu) {
+            std::fprintf(stderr, "%s: too large for a pack entry\n", file.c_str());
+            return 1;
+        }
+        original += bytes.size();
+        writer.add(file, std::move(bytes), compress);
+    }
+    std::string error;
+    if (!writer.write(output, &error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    std::error_code ec;
+    stored = static_cast<std::size_t>(fs::file_size(output, ec));
+    std::printf("%s: %zu files, %zu bytes -> %zu bytes\n", output.c_str(), files.size(), original, stored);
+    return 0;
+}
@@ -0,0 +1,612 @@
+// shader_reflect: the interface shaders/*.glsl declare, as C++ constants
+// (render/shader_layout.h).
+//
+//     ./shader_reflect OUT.h FILE.glsl...
+//
+// Reads every top-level declaration of every FILE, whatever #if it sits under (a file's
+// variants all land in one namespace, named after it), and writes:
+//
+// | GLSL                                        | C++, in namespace shaderlayout::<file>     |
+// | ------------------------------------------- | ------------------------------------------ |
+// | layout (location = N) in TYPE NAME;         | Attribute NAME: location, components, ...  |
+// | uniform TYPE NAME; / uniform TYPE NAME[N];  | Uniform<C++ type> NAME                     |
+// | layout (binding = N) uniform SAMPLER NAME;  | Sampler NAME, its texture unit included    |
+// | layout (std140, binding = N) uniform BLOCK  | struct BLOCK: kName, kBinding, kSize,      |
+// |                                             | member offsets                             |
+// | layout (std430, binding = N) buffer BLOCK   | struct BLOCK: the same, plus a runtime     |
+// |                                             | array's stride                             |
+// | layout (local_size_x = N) in;               | kLocalSizeX (Y, Z)                         |
+//
+// and kUniformNames, every default-block uniform of every file, sorted: a uniform's slot
+// is its index there; and kSamplerBindings / kBlockBindings, every binding by name, for
+// the contexts that can't take them from the GLSL. Offsets and sizes follow std140 /
+// std430, structs included.
+//
+// Variants may reuse a location for different inputs (vertex.glsl's location 1 is a
+// different input in each); what it rejects is one name declared twice differently in a
+// file, a sampler or uniform block without its binding, one name bound two ways, and
+// types it doesn't know. The output is rewritten only when it changes, so a
+// comment edit in a shader rebuilds nothing. The Makefile runs it before any compile:
+// `./shader_reflect src/generated/shader_reflection.h shaders/*.glsl`.
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "core/file_io.h"
+
+namespace {
+
+struct TypeInfo {
+    const char* glsl;
+    const char* cpp;        // nullptr: a sampler
+    const char* glEnum;     // samplers: the GL_SAMPLER_* type
+    int columns;            // 1, or a matrix's
+    int rows;               // components per column
+    bool integer;
+};
+
+const TypeInfo kTypes[] = {
+    {"float", "float", "", 1, 1, false},
+    {"vec2", "glm::vec2", "", 1, 2, false},
+    {"vec3", "glm::vec3", "", 1, 3, false},
+    {"vec4", "glm::vec4", "", 1, 4, false},
+    {"int", "GLint", "", 1, 1, true},
+    {"ivec2", "glm::ivec2", "", 1, 2, true},
+    {"ivec3", "glm::ivec3", "", 1, 3, true},
+    {"ivec4", "glm::ivec4", "", 1, 4, true},
+    {"uint", "GLuint", "", 1, 1, true},
+    {"uvec2", "glm::uvec2", "", 1, 2, true},
+    {"uvec3", "glm::uvec3", "", 1, 3, true},
+    {"uvec4", "glm::uvec4", "", 1, 4, true},
+    {"mat2", "glm::mat2", "", 2, 2, false},
+    {"mat3", "glm::mat3", "", 3, 3, false},
+    {"mat4", "glm::mat4", "", 4, 4, false},
+    {"sampler2D", nullptr, "GL_SAMPLER_2D", 1, 1, true},
+    {"sampler2DArray", nullptr, "GL_SAMPLER_2D_ARRAY", 1, 1, true},
+    {"sampler3D", nullptr, "GL_SAMPLER_3D", 1, 1, true},
+    {"samplerCube", nullptr, "GL_SAMPLER_CUBE", 1, 1, true},
+    {"samplerBuffer", nullptr, "GL_SAMPLER_BUFFER", 1, 1, true},
+    {"isampler2D", nullptr, "GL_INT_SAMPLER_2D", 1, 1, true},
+    {"isamplerBuffer", nullptr, "GL_INT_SAMPLER_BUFFER", 1, 1, true},
+    {"usampler2D", nullptr, "GL_UNSIGNED_INT_SAMPLER_2D", 1, 1, true},
+    {"usampler2DArray", nullptr, "GL_UNSIGNED_INT_SAMPLER_2D_ARRAY", 1, 1, true},
+    {"usamplerBuffer", nullptr, "GL_UNSIGNED_INT_SAMPLER_BUFFER", 1, 1, true},
+};
+
+const TypeInfo* findType(const std::string& name) {
+    for (const TypeInfo& t : kTypes) {
+        if (name == t.glsl) return &t;
+    }
+    return nullptr;
+}
+
+// Qualifiers that say nothing about the layout.
+bool skippable(const std::string& token) {
+    static const std::set<std::string> kWords = {"flat", "smooth", "noperspective", "highp", "mediump", "lowp",
+                                                 "readonly", "writeonly", "coherent", "volatile", "restrict",
+                                                 "const", "invariant", "centroid"};
+    return kWords.count(token) != 0;
+}
+
+struct Member {
+    std::string type;
+    std::string name;
+    int count = 1;          // array length; 0: a runtime array ([])
+    bool array = false;
+};
+
+struct Struct {
+    std::vector<Member> members;
+};
+
+// Size and base alignment of a type under std140 or std430.
+struct Layout {
+    std::size_t size = 0;
+    std::size_t align = 1;
+};
+
+std::size_t roundUp(std::size_t value, std::size_t to) { return (value + to - 1) / to * to; }
+
+struct Attribute {
+    std::string name;
+    int location;
+    const TypeInfo* type;
+};
+
+struct Uniform {
+    std::string name;
+    const TypeInfo* type;
+    int count;
+    int binding;            // samplers: the texture unit; -1 otherwise
+};
+
+struct BlockMember {
+    std::string name;
+    std::size_t offset;
+    std::size_t stride;     // arrays; 0 otherwise
+    bool runtime;
+};
+
+struct Block {
+    std::string name;
+    bool storage = false;   // std430 buffer; otherwise a std140 uniform block
+    int binding = -1;
+    std::size_t size = 0;
+    std::vector<BlockMember> members;
+};
+
+struct File {
+    std::string space;      // the namespace: the file's stem
+    std::vector<Attribute> attributes;
+    std::vector<Uniform> uniforms;
+    std::vector<Block> blocks;
+    int localSize[3] = {0, 0, 0};
+};
+
+class Reflector {
+public:
+    Reflector(std::string path, File& file) : path_(std::move(path)), file_(file) {}
+
+    bool run(const std::string& source) {
+        tokenize(source);
+        while (pos_ < tokens_.size() && ok_) {
+            statement();
+        }
+        return ok_;
+    }
+
+private:
+    // Comments and preprocessor lines out; identifiers, numbers and single characters.
+    void tokenize(const std::string& source) {
+        std::size_t i = 0;
+        bool lineStart = true;
+        while (i < source.size()) {
+            const char c = source[i];
+            if (c == '\n') {
+                lineStart = true;
+                ++i;
+            } else if (c == ' ' || c == '\t' || c == '\r') {
+                ++i;
+            } else if (c == '/' && i + 1 < source.size() && source[i + 1] == '/') {
+                while (i < source.size() && source[i] != '\n') ++i;
+            } else if (c == '/' && i + 1 < source.size() && source[i + 1] == '*') {
+                const std::size_t end = source.find("*/", i + 2);
+                i = end == std::string::npos ? source.size() : end + 2;
+            } else if (c == '#' && lineStart) {
+                // #if, #define, #include...: every branch is read, so none of it matters.
+                while (i < source.size() && source[i] != '\n') {
+                    i += source[i] == '\\' && i + 1 < source.size() ? 2 : 1;
+                }
+            } else if (std::isalnum(static_cast<unsigned char>(c)) || c == '_') {
+                std::size_t end = i;
+                while (end < source.size() &&
+                       (std::isalnum(static_cast<unsigned char>(source[end])) || source[end] == '_' || source[end] == '.')) {
+                    ++end;
+                }
+                tokens_.push_back(source.substr(i, end - i));
+                i = end;
+                lineStart = false;
+            } else {
+                tokens_.push_back(std::string(1, c));
+                ++i;
+                lineStart = false;
+            }
+        }
+    }
+
+    const std::string& peek(std::size_t ahead = 0) const {
+        static const std::string kEnd;
+        return pos_ + ahead < tokens_.size() ? tokens_[pos_ + ahead] : kEnd;
+    }
+    std::string next() { return pos_ < tokens_.size() ? tokens_[pos_++] : std::string(); }
+
+    void fail(const std::string& message) {
+        if (ok_) std::fprintf(stderr, "%s: %s\n", path_.c_str(), message.c_str());
+        ok_ = false;
+    }
+
+    bool expect(const char* token) {
+        if (peek() != token) {
+            fail(std::string("expected '") + token + "', found '" + peek() + "'");
+            return false;
+        }
+        ++pos_;
+        return true;
+    }
+
+    static bool number(const std::string& token, int& out) {
+        if (token.empty() || !std::isdigit(static_cast<unsigned char>(token[0]))) return false;
+        out = std::stoi(token, nullptr, 0);
+        return true;
+    }
+
+    // Skips to the end of the statement: past its ';', or past the braces of a function
+    // body (which have none).
+    void skipStatement() {
+        int depth = 0;
+        while (pos_ < tokens_.size()) {
+            const std::string& t = tokens_[pos_++];
+            if (t == "(" || t == "[") {
+                ++depth;
+            } else if (t == ")" || t == "]") {
+                --depth;
+            } else if (t == ";" && depth == 0) {
+                return;
+            } else if (t == "{" && depth == 0) {
+                skipBraces();
+                if (peek() == ";") ++pos_;
+                return;
+            }
+        }
+    }
+
+    void skipBraces() {
+        int depth = 1;
+        while (pos_ < tokens_.size() && depth > 0) {
+            const std::string& t = tokens_[pos_++];
+            if (t == "{") ++depth;
+            if (t == "}") --depth;
+        }
+    }
+
+    // `( a = 1, b )` into a map; a bare identifier maps to -1.
+    std::map<std::string, int> qualifiers() {
+        std::map<std::string, int> out;
+        if (!expect("(")) return out;
+        while (ok_ && peek() != ")" && pos_ < tokens_.size()) {
+            const std::string key = next();
+            int value = -1;
+            if (peek() == "=") {
+                ++pos_;
+                if (!number(next(), value)) fail("layout qualifier " + key + " needs a literal number");
+            }
+            out[key] = value;
+            if (peek() == ",") ++pos_;
+        }
+        expect(")");
+        return out;
+    }
+
+    // `TYPE NAME;` / `TYPE NAME[N];` / `TYPE NAME[];`, qualifiers skipped.
+    bool member(Member& out) {
+        while (skippable(peek())) ++pos_;
+        out.type = next();
+        out.name = next();
+        if (peek() == "[") {
+            ++pos_;
+            out.array = true;
+            out.count = 0;
+            if (peek() != "]" && !number(next(), out.count)) {
+                fail(out.name + ": array sizes must be literal numbers");
+                return false;
+            }
+            if (!expect("]")) return false;
+        }
+        return expect(";");
+    }
+
+    void statement() {
+        if (peek() == "struct") {
+            ++pos_;
+            const std::string name = next();
+            Struct s;
+            if (!expect("{")) return;
+            while (ok_ && peek() != "}" && pos_ < tokens_.size()) {
+                Member m;
+                if (member(m)) s.members.push_back(m);
+            }
+            expect("}");
+            expect(";");
+            structs_[name] = s;
+            return;
+        }
+        std::map<std::string, int> layout;
+        const bool hasLayout = peek() == "layout";
+        if (hasLayout) {
+            ++pos_;
+            layout = qualifiers();
+        }
+        while (skippable(peek())) ++pos_;
+        const std::string storage = peek();
+        if (storage == "in" && hasLayout && peek(1) == ";") {
+            pos_ += 2;
+            const char* axes[3] = {"local_size_x", "local_size_y", "local_size_z"};
+            for (int i = 0; i < 3; ++i) {
+                if (layout.count(axes[i])) file_.localSize[i] = layout[axes[i]];
+            }
+        } else if (storage == "in" && layout.count("location")) {
+            ++pos_;
+            Member m;
+            if (member(m)) input(m, layout["location"]);
+        } else if (storage == "uniform" && peek(2) == "{") {
+            ++pos_;
+            block(false, layout);
+        } else if (storage == "buffer") {
+            ++pos_;
+            block(true, layout);
+        } else if (storage == "uniform") {
+            ++pos_;
+            Member m;
+            if (member(m)) uniform(m, layout);
+        } else {
+            skipStatement();       // outputs, varyings, constants, functions
+        }
+    }
+
+    void input(const Member& m, int location) {
+        const TypeInfo* type = findType(m.type);
+        if (!type || !type->cpp || m.array) {
+            fail("input " + m.name + ": unsupported type " + m.type + (m.array ? "[]" : ""));
+            return;
+        }
+        for (const Attribute& a : file_.attributes) {
+            if (a.name == m.name) {
+                if (a.location != location || a.type != type) {
+                    fail("input " + m.name + " is declared twice, differently");
+                }
+                return;
+            }
+        }
+        file_.attributes.push_back({m.name, location, type});
+    }
+
+    void uniform(const Member& m, std::map<std::string, int>& layout) {
+        const TypeInfo* type = findType(m.type);
+        if (!type || (m.array && m.count == 0)) {
+            fail("uniform " + m.name + ": unsupported type " + m.type);
+            return;
+        }
+        int binding = -1;
+        if (!type->cpp) {
+            if (!layout.count("binding") || layout["binding"] < 0) {
+                fail("sampler " + m.name + ": needs its texture unit, layout (binding = N)");
+                return;
+            }
+            binding = layout["binding"];
+        }
+        for (const Uniform& u : file_.uniforms) {
+            if (u.name == m.name) {
+                if (u.type != type || u.count != m.count || u.binding != binding) {
+                    fail("uniform " + m.name + " is declared twice, differently");
+                }
+                return;
+            }
+        }
+        file_.uniforms.push_back({m.name, type, m.count, binding});
+    }
+
+    Layout layoutOf(const std::string& typeName, bool std140) {
+        if (const TypeInfo* type = findType(typeName)) {
+            if (!type->cpp) {
+                fail("a sampler can't be a block member");
+                return {};
+            }
+            const std::size_t vecAlign = type->rows == 1 ? 4 : type->rows == 2 ? 8 : 16;
+            if (type->columns == 1) return {4u * type->rows, vecAlign};
+            // A matrix: an array of its columns.
+            const std::size_t stride = std140 ? 16 : vecAlign;
+            return {stride * type->columns, stride};
+        }
+        auto it = structs_.find(typeName);
+        if (it == structs_.end()) {
+            fail("unknown type " + typeName);
+            return {};
+        }
+        Layout s;
+        for (const Member& m : it->second.members) {
+            const Layout member = memberLayout(m, std140);
+            s.size = roundUp(s.size, member.align) + member.size;
+            s.align = std::max(s.align, member.align);
+        }
+        if (std140) s.align = roundUp(s.align, 16);
+        s.size = roundUp(s.size, s.align);
+        return s;
+    }
+
+    // Arrays: element stride times count (a runtime array counts 0).
+    Layout memberLayout(const Member& m, bool std140, std::size_t* stride = nullptr) {
+        Layout element = layoutOf(m.type, std140);
+        if (!m.array) return element;
+        const std::size_t align = std140 ? roundUp(element.align, 16) : element.align;
+        const std::size_t elementStride = roundUp(element.size, align);
+        if (stride) *stride = elementStride;
+        return {elementStride * static_cast<std::size_t>(m.count), align};
+    }
+
+    void block(bool storage, std::map<std::string, int>& layout) {
+        Block b;
+        b.name = next();
+        b.storage = storage;
+        const bool std140 = !storage || layout.count("std140");
+        if (!storage && !layout.count("std140")) {
+            fail("uniform block " + b.name + ": only std140 blocks have a layout to reflect");
+        }
+        if (layout.count("binding")) b.binding = layout["binding"];
+        if (!storage && b.binding < 0) {
+            fail("uniform block " + b.name + ": needs its binding point, layout (std140, binding = N)");
+        }
+        if (!expect("{")) return;
+        std::size_t offset = 0, align = 16;
+        while (ok_ && peek() != "}" && pos_ < tokens_.size()) {
+            Member m;
+            if (!member(m)) return;
+            std::size_t stride = 0;
+            const Layout l = memberLayout(m, std140, &stride);
+            offset = roundUp(offset, l.align);
+            b.members.push_back({m.name, offset, stride, m.array && m.count == 0});
+            offset += l.size;
+            align = std::max(align, l.align);
+        }
+        expect("}");
+        if (peek() != ";") ++pos_;     // an instance name
+        expect(";");
+        b.size = storage ? offset : roundUp(offset, std140 ? 16 : align);
+        for (const Block& other : file_.blocks) {
+            if (other.name == b.name) return;
+        }
+        file_.blocks.push_back(b);
+    }
+
+    std::string path_;
+    File& file_;
+    std::vector<std::string> tokens_;
+    std::size_t pos_ = 0;
+    std::map<std::string, Struct> structs_;
+    bool ok_ = true;
+};
+
+std::string stem(const std::string& path) {
+    const std::size_t slash = path.find_last_of("/\\");
+    std::string name = path.substr(slash == std::string::npos ? 0 : slash + 1);
+    const std::size_t dot = name.find('.');
+    return dot == std::string::npos ? name : name.substr(0, dot);
+}
+
+// Every sampler's and uniform block's `binding = N`, by name: what bindingTable() emits.
+// A name bound differently in two files is an error (the fallback sets it by name).
+bool collectBindings(const std::vector<File>& files, std::map<std::string, int>& samplers,
+                     std::map<std::string, int>& blocks) {
+    auto add = [](std::map<std::string, int>& table, const std::string& name, int binding) {
+        const auto [it, added] = table.emplace(name, binding);
+        if (!added && it->second != binding) {
+            std::fprintf(stderr, "%s is bound to both %d and %d\n", name.c_str(), it->second, binding);
+            return false;
+        }
+        return true;
+    };
+    for (const File& f : files) {
+        for (const Uniform& u : f.uniforms) {
+            if (!u.type->cpp && !add(samplers, u.name, u.binding)) return false;
+        }
+        for (const Block& b : f.blocks) {
+            if (!b.storage && !add(blocks, b.name, b.binding)) return false;
+        }
+    }
+    return true;
+}
+
+std::string bindingTable(const char* name, const std::map<std::string, int>& table) {
+    std::string text = "inline constexpr Binding " + std::string(name) + "[] = {\n";
+    for (const auto& [key, binding] : table) text += "    {\"" + key + "\", " + std::to_string(binding) + "},\n";
+    return text + "};\n";
+}
+
+std::string generate(const std::vector<File>& files, const std::map<std::string, int>& samplers,
+                     const std::map<std::string, int>& blocks) {
+    std::set<std::string> names;
+    for (const File& f : files) {
+        for (const Uniform& u : f.uniforms) names.insert(u.name);
+    }
+    auto slot = [&](const std::string& name) { return std::distance(names.begin(), names.find(name)); };
+
+    std::string text = "// Generated by shader_reflect (src/tools/shader_reflect.cpp) from shaders/*.glsl. Do not edit.\n"
+                       "// Included by render/shader_layout.h, which declares the types.\n\n"
+                       "#pragma once\n\nnamespace shaderlayout {\n\n";
+    text += "// Every default-block uniform, sorted: Uniform::slot indexes it.\n";
+    text += "inline constexpr int kUniformCount = " + std::to_string(names.size()) + ";\n";
+    text += "inline constexpr const char* kUniformNames[kUniformCount] = {\n";
+    for (const std::string& name : names) text += "    \"" + name + "\",\n";
+    text += "};\n\n";
+    text += "// Every sampler's and std140 block's `layout (binding = N)`, sorted: what applyBindings\n"
+            "// (render/shader_build.h) sets after link where the GLSL can't say it.\n";
+    text += bindingTable("kSamplerBindings", samplers);
+    text += bindingTable("kBlockBindings", blocks);
+
+    for (const File& f : files) {
+        if (f.attributes.empty() && f.uniforms.empty() && f.blocks.empty() && f.localSize[0] == 0) {
+            continue;              // functions only (noise.glsl)
+        }
+        text += "\nnamespace " + f.space + " {\n";
+        for (int i = 0; i < 3; ++i) {
+            if (f.localSize[i] > 0) {
+                text += "inline constexpr GLuint kLocalSize" + std::string(1, "XYZ"[i]) + " = " +
+                        std::to_string(f.localSize[i]) + ";\n";
+            }
+        }
+        for (const Attribute& a : f.attributes) {
+            text += "inline constexpr Attribute " + a.name + "{\"" + a.name + "\", " + std::to_string(a.location) + ", " +
+                    std::to_string(a.type->rows) + ", " + std::to_string(a.type->columns) + ", " +
+                    (a.type->integer ? "true" : "false") + "};\n";
+        }
+        for (const Uniform& u : f.uniforms) {
+            const std::string where = std::to_string(slot(u.name)) + ", " + std::to_string(u.count);
+            if (u.type->cpp) {
+                text += "inline constexpr Uniform<" + std::string(u.type->cpp) + "> " + u.name + "{\"" + u.name +
+                        "\", " + where + "};\n";
+            } else {
+                text += "inline constexpr Sampler " + u.name + "{\"" + u.name + "\", " + where + ", " +
+                        u.type->glEnum + ", " + std::to_string(u.binding) + "};\n";
+            }
+        }
+        for (const Block& b : f.blocks) {
+            text += "struct " + b.name + " {\n";
+            text += "    static constexpr const char* kName = \"" + b.name + "\";\n";
+            if (b.binding >= 0) text += "    static constexpr GLuint kBinding = " + std::to_string(b.binding) + ";\n";
+            const bool runtime = !b.members.empty() && b.members.back().runtime;
+            text += "    static constexpr std::size_t kSize = " + std::to_string(b.size) +
+                    (runtime ? ";   // without the runtime array's elements\n" : ";\n");
+            for (const BlockMember& m : b.members) {
+                text += "    static constexpr std::size_t " + m.name + " = " + std::to_string(m.offset) + ";\n";
+                if (m.stride) {
+                    text += "    static constexpr std::size_t " + m.name + "Stride = " + std::to_string(m.stride) + ";\n";
+                }
+            }
+            text += "};\n";
+        }
+        text += "} // namespace " + f.space + "\n";
+    }
+    text += "\n} // namespace shaderlayout\n";
+    return text;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::fprintf(stderr, "usage: %s OUT.h FILE.glsl...\n", argv[0]);
+        return 1;
+    }
+    const std::string output = argv[1];
+    std::vector<std::string> paths(argv + 2, argv + argc);
+    std::sort(paths.begin(), paths.end());
+    paths.erase(std::unique(paths.begin(), paths.end()), paths.end());
+
+    std::vector<File> files;
+    for (const std::string& path : paths) {
+        std::vector<unsigned char> bytes;
+        if (!readFile(path, bytes)) {
+            std::fprintf(stderr, "cannot read %s\n", path.c_str());
+            return 1;
+        }
+        File file;
+        file.space = stem(path);
+        Reflector reflector(path, file);
+        if (!reflector.run(std::string(bytes.begin(), bytes.end()))) {
+            return 1;
+        }
+        files.push_back(std::move(file));
+    }
+    std::map<std::string, int> samplers, blocks;
+    if (!collectBindings(files, samplers, blocks)) {
+        return 1;
+    }
+    const std::string text = generate(files, samplers, blocks);
+
+    std::vector<unsigned char> old;
+    if (readFile(output, old) && std::string(old.begin(), old.end()) == text) {
+        return 0;                  // unchanged: leave the timestamp, rebuild nothing
+    }
+    std::FILE* file = std::fopen(output.c_str(), "wb");
+    if (!file || std::fwrite(text.data(), 1, text.size(), file) != text.size()) {
+        std::fprintf(stderr, "cannot write %s\n", output.c_str());
+        if (file) std::fclose(file);
+        return 1;
+    }
+    std::fclose(file);
+    return 0;
+}
@@ -0,0 +1,147 @@
+#include "ui/immediate_ui.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+constexpr std::uint64_t kFnvOffset = 0xcbf29ce484222325ull;
+constexpr std::uint64_t kFnvPrime = 0x100000001b3ull;
+
+std::uint64_t fnv(std::uint64_t hash, const void* data, std::size_t bytes) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < bytes; ++i) {
+        hash = (hash ^ p[i]) * kFnvPrime;
+    }
+    return hash;
+}
+
+std::uint32_t idOf(std::uint32_t parent, const char* label) {
+    const std::uint64_t hash = fnv(kFnvOffset ^ parent, label, std::strlen(label));
+    return static_cast<std::uint32_t>(hash ^ hash >> 32);
+}
+
+bool inside(const glm::vec2& p, const glm::vec2& min, const glm::vec2& size) {
+    return p.x >= min.x && p.y >= min.y && p.x < min.x + size.x && p.y < min.y + size.y;
+}
+
+} // namespace
+
+void ImmediateUi::begin(const Input& input, FrameVector<UiWidget>& widgets, FrameString& text) {
+    input_ = input;
+    widgets_ = &widgets;
+    text_ = &text;
+    overPanel_ = false;
+}
+
+void ImmediateUi::end() {
+    wantsMouse_ = overPanel_ || active_ != 0;
+    if (!input_.down) {
+        active_ = 0;                   // released: clicks were answered by the widgets
+    }
+    widgets_ = nullptr;
+    text_ = nullptr;
+}
+
+void ImmediateUi::beginPanel(const char* title, const glm::vec2& position, float width) {
+    UiWidget panel;
+    panel.kind = UiKind::Panel;
+    panel.id = idOf(0, title);
+    panel.min = position;
+    panel.size = glm::vec2(width, 0.0f);
+    panel_ = widgets_->size();
+    panelId_ = panel.id;
+    widgets_->push_back(panel);
+    setText(widgets_->back(), title, std::strlen(title));
+    cursor_ = position.y + kRowHeight + 0.5f * kPadding;   // under the title bar
+}
+
+void ImmediateUi::endPanel() {
+    UiWidget& panel = (*widgets_)[panel_];
+    panel.size.y = cursor_ + 0.5f * kPadding - panel.min.y;
+    overPanel_ = overPanel_ || inside(input_.mouse, panel.min, panel.size);
+    seal(panel);
+}
+
+void ImmediateUi::label(const char* text) {
+    UiWidget& widget = row(UiKind::Label, text);
+    widget.state = 0;                  // nothing to hover: no rebuild for it
+    setText(widget, text, std::strlen(text));
+    seal(widget);
+}
+
+bool ImmediateUi::button(const char* label) {
+    UiWidget& widget = row(UiKind::Button, label);
+    const bool clicked = active_ == widget.id && !input_.down && (widget.state & UiWidget::kHot) != 0;
+    setText(widget, label, std::strlen(label));
+    seal(widget);
+    return clicked;
+}
+
+bool ImmediateUi::checkbox(const char* label, bool& value) {
+    UiWidget& widget = row(UiKind::Checkbox, label);
+    const bool clicked = active_ == widget.id && !input_.down && (widget.state & UiWidget::kHot) != 0;
+    if (clicked) {
+        value = !value;
+    }
+    if (value) {
+        widget.state |= UiWidget::kOn;
+    }
+    setText(widget, label, std::strlen(label));
+    seal(widget);
+    return clicked;
+}
+
+bool ImmediateUi::slider(const char* label, float& value, float min, float max) {
+    UiWidget& widget = row(UiKind::Slider, label);
+    const float before = value;
+    if (active_ == widget.id && max > min) {
+        const float t = std::clamp((input_.mouse.x - widget.min.x) / widget.size.x, 0.0f, 1.0f);
+        value = min + t * (max - min);
+    }
+    widget.value = max > min ? std::clamp((value - min) / (max - min), 0.0f, 1.0f) : 0.0f;
+    char text[96];
+    const int length = std::snprintf(text, sizeof(text), "%s: %.1f", label, value);
+    setText(widget, text, static_cast<std::size_t>(std::clamp(length, 0, static_cast<int>(sizeof(text)) - 1)));
+    seal(widget);
+    return value != before;
+}
+
+UiWidget& ImmediateUi::row(UiKind kind, const char* label) {
+    const UiWidget& panel = (*widgets_)[panel_];
+    UiWidget widget;
+    widget.kind = kind;
+    widget.id = idOf(panelId_, label);
+    widget.min = glm::vec2(panel.min.x + kPadding, cursor_);
+    widget.size = glm::vec2(panel.size.x - 2.0f * kPadding, kRowHeight - 4.0f);
+    cursor_ += kRowHeight;
+    if (inside(input_.mouse, widget.min, widget.size) && (active_ == 0 || active_ == widget.id)) {
+        widget.state |= UiWidget::kHot;
+        if (input_.pressed) {
+            active_ = widget.id;
+        }
+    }
+    if (active_ == widget.id) {
+        widget.state |= UiWidget::kActive;
+    }
+    widgets_->push_back(widget);
+    return widgets_->back();
+}
+
+void ImmediateUi::setText(UiWidget& widget, const char* text, std::size_t length) {
+    length = std::min<std::size_t>(length, 0xffff);
+    widget.text = static_cast<std::uint32_t>(text_->size());
+    widget.textLength = static_cast<std::uint16_t>(length);
+    text_->append(text, length);
+}
+
+// The hash covers the text itself, not where it is in this frame's uiText.
+void ImmediateUi::seal(UiWidget& widget) const {
+    const std::uint32_t offset = widget.text;
+    widget.text = 0;
+    std::uint64_t hash = fnv(kFnvOffset, &widget.id, sizeof(UiWidget) - offsetof(UiWidget, id));
+    hash = fnv(hash, text_->data() + offset, widget.textLength);
+    widget.text = offset;
+    widget.hash = hash;
+}
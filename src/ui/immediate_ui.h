@@ -0,0 +1,103 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+
+#include "core/frame_arena.h"
+
+// UiWidget
+// --------
+// One widget as the render thread draws it (render/ui_renderer.h): plain values in the
+// frame packet, its text in the packet's uiText. No padding: contentHash() hashes the
+// array as bytes.
+enum class UiKind : std::uint8_t { Panel, Label, Button, Checkbox, Slider };
+
+struct UiWidget {
+    static constexpr std::uint8_t kHot = 1;       // under the mouse
+    static constexpr std::uint8_t kActive = 2;    // pressed on, the button still held
+    static constexpr std::uint8_t kOn = 4;        // a ticked checkbox
+
+    std::uint64_t hash = 0;            // of everything below and the text: equal, same geometry
+    std::uint32_t id = 0;              // its panel's and label's hash: the same every frame
+    UiKind kind = UiKind::Label;
+    std::uint8_t state = 0;
+    std::uint16_t textLength = 0;
+    std::uint32_t text = 0;            // offset into uiText
+    float value = 0.0f;                // Slider: 0..1 along the track
+    glm::vec2 min{0.0f};               // window pixels, (0, 0) top-left like the cursor
+    glm::vec2 size{0.0f};
+};
+static_assert(sizeof(UiWidget) == 40, "UiWidget is hashed as bytes: no padding");
+
+// ImmediateUi
+// -----------
+// Immediate-mode widgets for menus and tools, on main: the code that shows a widget is
+// the code that handles it, with no widget objects to create, keep in sync or destroy:
+//
+//     ui.begin(input, packet.uiWidgets, packet.uiText);
+//     ui.beginPanel("Tools", {8, 8}, 240);
+//     if (ui.checkbox("HUD (F2)", hudVisible)) { ... }
+//     ui.slider("Camera speed", gameConfig.cameraSpeed, 0, 20);
+//     ui.endPanel();
+//     ui.end();
+//
+// Each call lays its widget out (one row under the last, in its panel), answers from
+// this frame's mouse, and appends a UiWidget to the packet: a few hundred nanoseconds,
+// no text measured, no geometry. The render side turns widgets into quads and keeps
+// them per widget id, rebuilding only those whose hash changed (a hover, a new value),
+// so an idle panel costs its replay (render/ui_renderer.h):
+//
+// | Per frame, a 20-widget panel | Main (here)           | Render thread              |
+// | ---------------------------- | --------------------- | -------------------------- |
+// | idle                         | 20 rows laid out      | 20 cache hits: quad copies |
+// | hovering one button          | likewise              | 1 widget rebuilt           |
+// | dragging a slider            | likewise + its text   | 1 widget rebuilt           |
+//
+// A button clicks on release over it, after being pressed on it; a slider follows the
+// mouse while pressed on. Widgets go in panels; labels must be unique within one (they
+// are the ids). wantsMouse() tells the game's own click handling to keep out.
+class ImmediateUi {
+public:
+    static constexpr float kTextHeight = 12.0f;   // capitals, pixels
+    static constexpr float kRowHeight = 24.0f;
+    static constexpr float kPadding = 8.0f;
+
+    struct Input {
+        glm::vec2 mouse{-1.0f};        // window pixels
+        bool down = false;             // the left button is held
+        bool pressed = false;          // ... went down since the last frame (maybe up again)
+    };
+
+    // The widgets of this frame go into `widgets` and `text` (the packet's arrays).
+    void begin(const Input& input, FrameVector<UiWidget>& widgets, FrameString& text);
+    void end();
+
+    // Widgets go into the panel at `position` (top-left), `width` wide, until endPanel().
+    void beginPanel(const char* title, const glm::vec2& position, float width);
+    void endPanel();
+
+    void label(const char* text);
+    bool button(const char* label);                       // clicked
+    bool checkbox(const char* label, bool& value);        // toggled
+    bool slider(const char* label, float& value, float min, float max); // moved
+
+    // At end(): the mouse was over a panel, or a widget holds it.
+    bool wantsMouse() const { return wantsMouse_; }
+
+private:
+    // The next row of the open panel, appended: its kHot and kActive from the mouse.
+    UiWidget& row(UiKind kind, const char* label);
+    void setText(UiWidget& widget, const char* text, std::size_t length);
+    void seal(UiWidget& widget) const;
+
+    Input input_;
+    FrameVector<UiWidget>* widgets_ = nullptr;
+    FrameString* text_ = nullptr;
+    std::size_t panel_ = 0;            // index of the open panel's widget
+    std::uint32_t panelId_ = 0;
+    float cursor_ = 0.0f;              // the next row's top
+    std::uint32_t active_ = 0;         // the widget pressed on, while the button is held
+    bool overPanel_ = false;
+    bool wantsMouse_ = false;
+};